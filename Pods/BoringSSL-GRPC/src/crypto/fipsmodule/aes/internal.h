@@ -65,6 +65,13 @@ OPENSSL_INLINE int vpaes_capable(void) { return CRYPTO_is_NEON_capable(); }
 
 #endif  // !NO_ASM
 
+#if defined(OPENSSL_AARCH64_INTRINSICS)
+// The |aes_hw_*| functions are provided by aes_armv8.c.inc.
+#define HWAES
+
+OPENSSL_INLINE int hwaes_capable(void) { return CRYPTO_is_ARMv8_AES_capable(); }
+#endif  // OPENSSL_AARCH64_INTRINSICS
+
 
 #if defined(HWAES)
 
@@ -34,6 +34,7 @@
 // TODO(crbug.com/362530616): When delocate is removed, build these files as
 // separate compilation units again.
 #include "aes/aes.c.inc"
+#include "aes/aes_armv8.c.inc"
 #include "aes/aes_nohw.c.inc"
 #include "aes/key_wrap.c.inc"
 #include "aes/mode_wrappers.c.inc"
@@ -91,6 +92,7 @@
 #include "modes/cfb.c.inc"
 #include "modes/ctr.c.inc"
 #include "modes/gcm.c.inc"
+#include "modes/gcm_armv8.c.inc"
 #include "modes/gcm_nohw.c.inc"
 #include "modes/ofb.c.inc"
 #include "modes/polyval.c.inc"
@@ -105,6 +107,7 @@
 #include "service_indicator/service_indicator.c.inc"
 #include "sha/sha1.c.inc"
 #include "sha/sha256.c.inc"
+#include "sha/sha256_armv8.c.inc"
 #include "sha/sha512.c.inc"
 #include "tls/kdf.c.inc"
 
@@ -328,6 +328,21 @@ void aes_gcm_dec_kernel(const uint8_t *in, uint64_t in_bits, void *out,
 #endif
 #endif  // OPENSSL_NO_ASM
 
+#if defined(OPENSSL_AARCH64_INTRINSICS)
+#define GHASH_PMULL
+#define GCM_FUNCREF
+
+OPENSSL_INLINE int gcm_pmull_capable(void) {
+  return CRYPTO_is_ARMv8_PMULL_capable();
+}
+
+// These functions are defined in gcm_armv8.c.inc.
+void gcm_init_pmull(u128 Htable[16], const uint64_t H[2]);
+void gcm_gmult_pmull(uint8_t Xi[16], const u128 Htable[16]);
+void gcm_ghash_pmull(uint8_t Xi[16], const u128 Htable[16], const uint8_t *inp,
+                     size_t len);
+#endif  // OPENSSL_AARCH64_INTRINSICS
+
 
 // CBC.
 
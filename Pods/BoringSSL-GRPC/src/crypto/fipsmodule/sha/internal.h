@@ -205,6 +205,14 @@ void sha512_block_data_order_avx(uint64_t state[8], const uint8_t *data,
 
 #endif
 
+#if defined(OPENSSL_AARCH64_INTRINSICS)
+// |sha256_block_data_order_hw| is provided by sha256_armv8.c.inc.
+#define SHA256_ASM_HW
+OPENSSL_INLINE int sha256_hw_capable(void) {
+  return CRYPTO_is_ARMv8_SHA256_capable();
+}
+#endif  // OPENSSL_AARCH64_INTRINSICS
+
 #if defined(SHA1_ASM_HW)
 void sha1_block_data_order_hw(uint32_t state[5], const uint8_t *data,
                               size_t num);
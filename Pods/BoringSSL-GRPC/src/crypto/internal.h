@@ -1643,6 +1643,16 @@ OPENSSL_ATTR_CONST uint32_t OPENSSL_get_armcap(void);
 #endif
 #endif
 
+// Without assembly, AArch64 builds that target the cryptography extensions, as
+// all Apple arm64 builds do, implement AES, GHASH and SHA-256 with the ACLE
+// intrinsics in place of the portable C code. Define
+// OPENSSL_NO_AARCH64_INTRINSICS to keep the portable code.
+#if defined(OPENSSL_NO_ASM) && defined(OPENSSL_AARCH64) && \
+    defined(__ARM_FEATURE_AES) && defined(__ARM_FEATURE_SHA2) && \
+    !defined(OPENSSL_NO_AARCH64_INTRINSICS)
+#define OPENSSL_AARCH64_INTRINSICS
+#endif
+
 // CRYPTO_is_NEON_capable returns true if the current CPU has a NEON unit. If
 // this is known statically, it is a constant inline function.
 OPENSSL_INLINE int CRYPTO_is_NEON_capable(void) {
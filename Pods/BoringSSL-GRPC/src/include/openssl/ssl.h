@@ -2586,6 +2586,24 @@ OPENSSL_EXPORT const char *SSL_get_group_name(uint16_t group_id);
 // list, so this does not apply if, say, sending strings across services.
 OPENSSL_EXPORT size_t SSL_get_all_group_names(const char **out, size_t max_out);
 
+// SSL_MAX_PREGENERATED_KEY_SHARES is the most key shares that
+// |SSL_pregenerate_key_shares| keeps for each group.
+#define SSL_MAX_PREGENERATED_KEY_SHARES 8
+
+// SSL_pregenerate_key_shares generates key shares for |group_id| until the
+// process-wide pool for that group holds |count| of them, or
+// |SSL_MAX_PREGENERATED_KEY_SHARES|, whichever is fewer. A handshake that
+// generates a key share for the group takes one from the pool, if there is
+// one, instead of generating it then. Each key share is used at most once.
+// Callers may run this on a background thread, before connecting, to take key
+// generation off the handshake's critical path.
+//
+// Only |SSL_GROUP_X25519| and |SSL_GROUP_X25519_MLKEM768| are supported. It
+// returns the number of key shares in the pool for |group_id|, or zero if the
+// group is not supported.
+OPENSSL_EXPORT size_t SSL_pregenerate_key_shares(uint16_t group_id,
+                                                 size_t count);
+
 // The following APIs also configure Diffie-Hellman groups, but use |NID_*|
 // constants instead of |SSL_GROUP_*| constants. These are provided for OpenSSL
 // compatibility. Where NIDs are unstable constants specific to OpenSSL and
@@ -129,6 +129,9 @@ BSSL_NAMESPACE_BEGIN
 static int do_tls_write(SSL *ssl, size_t *out_bytes_written, uint8_t type,
                         Span<const uint8_t> in);
 
+// kMaxWriteBufferLen is the largest capacity |SSLBuffer| supports.
+static const size_t kMaxWriteBufferLen = 0xffff;
+
 int tls_write_app_data(SSL *ssl, bool *out_needs_handshake,
                        size_t *out_bytes_written, Span<const uint8_t> in) {
   assert(ssl_can_write(ssl));
@@ -172,7 +175,12 @@ int tls_write_app_data(SSL *ssl, bool *out_needs_handshake,
                                     hs->early_data_written});
     }
 
-    const size_t to_write = std::min(max_send_fragment, in.size());
+    size_t to_write = std::min(max_send_fragment, in.size());
+    if (!is_early_data_write && !(ssl->mode & SSL_MODE_ENABLE_PARTIAL_WRITE)) {
+      // Only the total is reported to the caller, so let |do_tls_write| seal
+      // as many records as fit in the write buffer before flushing.
+      to_write = in.size();
+    }
     size_t bytes_written;
     int ret = do_tls_write(ssl, &bytes_written, SSL3_RT_APPLICATION_DATA,
                            in.subspan(0, to_write));
@@ -218,9 +226,11 @@ static size_t tls_seal_align_prefix_len(const SSL *ssl) {
   return ret;
 }
 
-// do_tls_write writes an SSL record of the given type. On success, it sets
-// |*out_bytes_written| to number of bytes successfully written and returns one.
-// On error, it returns a value <= 0 from the underlying |BIO|.
+// do_tls_write writes SSL records of the given type. |in| is split into records
+// of at most |ssl->max_send_fragment| bytes, and as many of them as fit in the
+// write buffer are sealed back to back and flushed together. On success, it
+// sets |*out_bytes_written| to number of bytes successfully written and returns
+// one. On error, it returns a value <= 0 from the underlying |BIO|.
 static int do_tls_write(SSL *ssl, size_t *out_bytes_written, uint8_t type,
                         Span<const uint8_t> in) {
   // If there is a pending write, the retry must be consistent.
@@ -248,7 +258,7 @@ static int do_tls_write(SSL *ssl, size_t *out_bytes_written, uint8_t type,
   }
 
   SSLBuffer *buf = &ssl->s3->write_buffer;
-  if (in.size() > SSL3_RT_MAX_PLAIN_LENGTH || buf->size() > 0) {
+  if (buf->size() > 0) {
     OPENSSL_PUT_ERROR(SSL, ERR_R_INTERNAL_ERROR);
     return -1;
   }
@@ -268,16 +278,26 @@ static int do_tls_write(SSL *ssl, size_t *out_bytes_written, uint8_t type,
     pending_flight = pending_flight.subspan(ssl->s3->pending_flight_offset);
   }
 
+  // Take whole records from |in| while their worst-case ciphertext fits in the
+  // write buffer. The first record is always taken.
+  const size_t record_len = ssl->max_send_fragment;
+  const size_t max_seal_overhead = SSL_max_seal_overhead(ssl);
   size_t max_out = pending_flight.size();
-  if (!in.empty()) {
-    const size_t max_ciphertext_len = in.size() + SSL_max_seal_overhead(ssl);
-    if (max_ciphertext_len < in.size() ||
-        max_out + max_ciphertext_len < max_out) {
+  size_t in_len = 0;
+  while (in_len < in.size()) {
+    const size_t len = std::min(record_len, in.size() - in_len);
+    const size_t max_ciphertext_len = len + max_seal_overhead;
+    if (max_out + max_ciphertext_len < max_out) {
       OPENSSL_PUT_ERROR(SSL, ERR_R_OVERFLOW);
       return -1;
     }
+    if (in_len > 0 && max_out + max_ciphertext_len > kMaxWriteBufferLen) {
+      break;
+    }
     max_out += max_ciphertext_len;
+    in_len += len;
   }
+  in = in.subspan(0, in_len);
 
   if (max_out == 0) {
     // Nothing to write.
@@ -299,10 +319,13 @@ static int do_tls_write(SSL *ssl, size_t *out_bytes_written, uint8_t type,
     buf->DidWrite(pending_flight.size());
   }
 
-  if (!in.empty()) {
+  for (Span<const uint8_t> rest = in; !rest.empty();
+       rest = rest.subspan(std::min(record_len, rest.size()))) {
+    Span<const uint8_t> record = rest.subspan(0, record_len);
     size_t ciphertext_len;
     if (!tls_seal_record(ssl, buf->remaining().data(), &ciphertext_len,
-                         buf->remaining().size(), type, in.data(), in.size())) {
+                         buf->remaining().size(), type, record.data(),
+                         record.size())) {
       return -1;
     }
     buf->DidWrite(ciphertext_len);
@@ -17,6 +17,7 @@
 #include <assert.h>
 #include <string.h>
 
+#include <algorithm>
 #include <utility>
 
 #include <openssl_grpc/bn.h>
@@ -137,6 +138,80 @@ class ECKeyShare : public SSLKeyShare {
   uint16_t group_id_;
 };
 
+// Key pairs made ahead of time by |SSL_pregenerate_key_shares|. Each pool is
+// shared by every |SSL_CTX| in the process, and an entry is removed, and wiped,
+// when a handshake takes it, so that no key pair is used twice.
+struct PregeneratedX25519 {
+  uint8_t public_key[X25519_PUBLIC_VALUE_LEN];
+  uint8_t private_key[X25519_PRIVATE_KEY_LEN];
+};
+
+struct PregeneratedX25519MLKEM768 {
+  uint8_t mlkem_public_key[MLKEM768_PUBLIC_KEY_BYTES];
+  MLKEM768_private_key mlkem_private_key;
+  PregeneratedX25519 x25519;
+};
+
+template <typename T>
+struct PregeneratedPool {
+  T entries[SSL_MAX_PREGENERATED_KEY_SHARES];
+  size_t num;
+};
+
+CRYPTO_MUTEX g_pregenerated_lock = CRYPTO_MUTEX_INIT;
+PregeneratedPool<PregeneratedX25519> g_pregenerated_x25519;
+PregeneratedPool<PregeneratedX25519MLKEM768> g_pregenerated_x25519_mlkem768;
+
+void GenerateKeyPair(PregeneratedX25519 *out) {
+  X25519_keypair(out->public_key, out->private_key);
+}
+
+void GenerateKeyPair(PregeneratedX25519MLKEM768 *out) {
+  MLKEM768_generate_key(out->mlkem_public_key, /*optional_out_seed=*/nullptr,
+                        &out->mlkem_private_key);
+  GenerateKeyPair(&out->x25519);
+}
+
+// TakeOrGenerateKeyPair sets |*out| to a key pair from |pool|, or to a new one
+// if |pool| is empty. The caller must wipe |*out| once done with it.
+template <typename T>
+void TakeOrGenerateKeyPair(PregeneratedPool<T> *pool, T *out) {
+  {
+    MutexWriteLock lock(&g_pregenerated_lock);
+    if (pool->num > 0) {
+      pool->num--;
+      OPENSSL_memcpy(out, &pool->entries[pool->num], sizeof(T));
+      OPENSSL_cleanse(&pool->entries[pool->num], sizeof(T));
+      return;
+    }
+  }
+  GenerateKeyPair(out);
+}
+
+// FillPool generates key pairs until |pool| holds |count| of them, up to its
+// capacity, and returns how many it holds. Keys are generated without holding
+// the lock, so that handshakes can take entries in the meantime.
+template <typename T>
+size_t FillPool(PregeneratedPool<T> *pool, size_t count) {
+  count = std::min(count, size_t{SSL_MAX_PREGENERATED_KEY_SHARES});
+  for (;;) {
+    {
+      MutexReadLock lock(&g_pregenerated_lock);
+      if (pool->num >= count) {
+        return pool->num;
+      }
+    }
+    T key_pair;
+    GenerateKeyPair(&key_pair);
+    MutexWriteLock lock(&g_pregenerated_lock);
+    if (pool->num < count) {
+      OPENSSL_memcpy(&pool->entries[pool->num], &key_pair, sizeof(T));
+      pool->num++;
+    }
+    OPENSSL_cleanse(&key_pair, sizeof(key_pair));
+  }
+}
+
 class X25519KeyShare : public SSLKeyShare {
  public:
   X25519KeyShare() {}
@@ -144,9 +219,13 @@ class X25519KeyShare : public SSLKeyShare {
   uint16_t GroupID() const override { return SSL_GROUP_X25519; }
 
   bool Generate(CBB *out) override {
-    uint8_t public_key[32];
-    X25519_keypair(public_key, private_key_);
-    return !!CBB_add_bytes(out, public_key, sizeof(public_key));
+    PregeneratedX25519 key_pair;
+    TakeOrGenerateKeyPair(&g_pregenerated_x25519, &key_pair);
+    OPENSSL_memcpy(private_key_, key_pair.private_key, sizeof(private_key_));
+    bool ok = !!CBB_add_bytes(out, key_pair.public_key,
+                              sizeof(key_pair.public_key));
+    OPENSSL_cleanse(&key_pair, sizeof(key_pair));
+    return ok;
   }
 
   bool Encap(CBB *out_ciphertext, Array<uint8_t> *out_secret,
@@ -290,19 +369,19 @@ class X25519MLKEM768KeyShare : public SSLKeyShare {
   uint16_t GroupID() const override { return SSL_GROUP_X25519_MLKEM768; }
 
   bool Generate(CBB *out) override {
-    uint8_t mlkem_public_key[MLKEM768_PUBLIC_KEY_BYTES];
-    MLKEM768_generate_key(mlkem_public_key, /*optional_out_seed=*/nullptr,
-                          &mlkem_private_key_);
-
-    uint8_t x25519_public_key[X25519_PUBLIC_VALUE_LEN];
-    X25519_keypair(x25519_public_key, x25519_private_key_);
-
-    if (!CBB_add_bytes(out, mlkem_public_key, sizeof(mlkem_public_key)) ||
-        !CBB_add_bytes(out, x25519_public_key, sizeof(x25519_public_key))) {
-      return false;
-    }
-
-    return true;
+    PregeneratedX25519MLKEM768 key_pair;
+    TakeOrGenerateKeyPair(&g_pregenerated_x25519_mlkem768, &key_pair);
+    OPENSSL_memcpy(&mlkem_private_key_, &key_pair.mlkem_private_key,
+                   sizeof(mlkem_private_key_));
+    OPENSSL_memcpy(x25519_private_key_, key_pair.x25519.private_key,
+                   sizeof(x25519_private_key_));
+
+    bool ok = CBB_add_bytes(out, key_pair.mlkem_public_key,
+                            sizeof(key_pair.mlkem_public_key)) &&
+              CBB_add_bytes(out, key_pair.x25519.public_key,
+                            sizeof(key_pair.x25519.public_key));
+    OPENSSL_cleanse(&key_pair, sizeof(key_pair));
+    return ok;
   }
 
   bool Encap(CBB *out_ciphertext, Array<uint8_t> *out_secret,
@@ -463,3 +542,14 @@ size_t SSL_get_all_group_names(const char **out, size_t max_out) {
   return GetAllNames(out, max_out, Span<const char *>(), &NamedGroup::name,
                      MakeConstSpan(kNamedGroups));
 }
+
+size_t SSL_pregenerate_key_shares(uint16_t group_id, size_t count) {
+  switch (group_id) {
+    case SSL_GROUP_X25519:
+      return FillPool(&g_pregenerated_x25519, count);
+    case SSL_GROUP_X25519_MLKEM768:
+      return FillPool(&g_pregenerated_x25519_mlkem768, count);
+    default:
+      return 0;
+  }
+}
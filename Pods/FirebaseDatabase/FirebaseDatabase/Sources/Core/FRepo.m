@@ -146,6 +146,8 @@
         } else {
             FLevelDBStorageEngine *levelDBEngine =
                 [[FLevelDBStorageEngine alloc] initWithPath:persistencePrefix];
+            levelDBEngine.storesBinaryValues =
+                self.config.persistenceStoresBinaryValues;
             // We need the repo info to run the legacy migration. Future
             // migrations will be managed by the database itself Remove this
             // once we are confident that no-one is using legacy migration
@@ -33,6 +33,9 @@
 #import "FirebaseDatabase/Sources/Snapshot/FNode.h"
 #import "FirebaseDatabase/Sources/Utilities/Tuples/FTupleRemovedQueriesEvents.h"
 
+// Operations are applied concurrently to this many views or more.
+static const NSUInteger kFMinViewsForConcurrentApply = 4;
+
 /**
  * SyncPoint represents a single location in a SyncTree with 1 or more event
  * registrations, meaning we need to maintain 1 or more Views at this location
@@ -75,13 +78,8 @@
     return [self.views count] == 0;
 }
 
-- (NSArray *)applyOperation:(id<FOperation>)operation
-                     toView:(FView *)view
-                writesCache:(FWriteTreeRef *)writesCache
-                serverCache:(id<FNode>)optCompleteServerCache {
-    FViewOperationResult *result = [view applyOperation:operation
-                                            writesCache:writesCache
-                                            serverCache:optCompleteServerCache];
+- (void)trackChangedKeysInResult:(FViewOperationResult *)result
+                         forView:(FView *)view {
     if (!view.query.loadsAllData) {
         NSMutableSet *removed = [NSMutableSet set];
         NSMutableSet *added = [NSMutableSet set];
@@ -100,9 +98,55 @@
                                            forQuery:view.query];
         }
     }
+}
+
+- (NSArray *)applyOperation:(id<FOperation>)operation
+                     toView:(FView *)view
+                writesCache:(FWriteTreeRef *)writesCache
+                serverCache:(id<FNode>)optCompleteServerCache {
+    FViewOperationResult *result = [view applyOperation:operation
+                                            writesCache:writesCache
+                                            serverCache:optCompleteServerCache];
+    [self trackChangedKeysInResult:result forView:view];
     return result.events;
 }
 
+/**
+ * Applies the operation to the views on concurrent threads. A view only reads
+ * the operation, the write tree and the server cache, which are immutable, and
+ * otherwise only changes its own state. Persistence is not thread safe, so it
+ * is updated afterwards on the calling queue, and the events are returned in
+ * the order of the views.
+ */
+- (NSArray *)applyOperationConcurrently:(id<FOperation>)operation
+                                toViews:(NSArray *)views
+                            writesCache:(FWriteTreeRef *)writesCache
+                            serverCache:(id<FNode>)optCompleteServerCache {
+    NSMutableArray *results = [NSMutableArray arrayWithCapacity:views.count];
+    for (NSUInteger i = 0; i < views.count; i++) {
+        [results addObject:[NSNull null]];
+    }
+    dispatch_apply(
+        views.count, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0),
+        ^(size_t i) {
+          FViewOperationResult *result =
+              [views[i] applyOperation:operation
+                           writesCache:writesCache
+                           serverCache:optCompleteServerCache];
+          @synchronized(results) {
+              results[i] = result;
+          }
+        });
+    NSMutableArray *events = [[NSMutableArray alloc] init];
+    [views enumerateObjectsUsingBlock:^(FView *view, NSUInteger idx,
+                                        BOOL *stop) {
+      FViewOperationResult *result = results[idx];
+      [self trackChangedKeysInResult:result forView:view];
+      [events addObjectsFromArray:result.events];
+    }];
+    return events;
+}
+
 - (NSArray *)applyOperation:(id<FOperation>)operation
                 writesCache:(FWriteTreeRef *)writesCache
                 serverCache:(id<FNode>)optCompleteServerCache {
@@ -114,6 +158,11 @@
                              toView:view
                         writesCache:writesCache
                         serverCache:optCompleteServerCache];
+    } else if (self.views.count >= kFMinViewsForConcurrentApply) {
+        return [self applyOperationConcurrently:operation
+                                        toViews:self.views.allValues
+                                    writesCache:writesCache
+                                    serverCache:optCompleteServerCache];
     } else {
         NSMutableArray *events = [[NSMutableArray alloc] init];
         [self.views enumerateKeysAndObjectsUsingBlock:^(
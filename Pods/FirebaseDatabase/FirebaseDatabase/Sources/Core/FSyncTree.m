@@ -57,6 +57,11 @@ static const NSUInteger kFSizeThresholdForCompoundHash = 1024;
 
 @property(nonatomic, strong) FView *view;
 @property(nonatomic, copy) fbt_nsarray_nsstring onComplete;
+// The compound hash last sent for the listen, which is sent again on every
+// reconnect, and the cache it was computed from. Nodes are immutable, so the
+// hash stays valid for as long as the view keeps that cache.
+@property(nonatomic, strong) FCompoundHash *lastCompoundHash;
+@property(nonatomic, weak) id<FNode> lastHashedServerCache;
 
 @end
 
@@ -77,7 +82,13 @@ static const NSUInteger kFSizeThresholdForCompoundHash = 1024;
 }
 
 - (FCompoundHash *)compoundHash {
-    return [FCompoundHash fromNode:[self serverCache]];
+    id<FNode> serverCache = [self serverCache];
+    if (self.lastCompoundHash == nil ||
+        self.lastHashedServerCache != serverCache) {
+        self.lastCompoundHash = [FCompoundHash fromNode:serverCache];
+        self.lastHashedServerCache = serverCache;
+    }
+    return self.lastCompoundHash;
 }
 
 - (NSString *)simpleHash {
@@ -85,7 +96,9 @@ static const NSUInteger kFSizeThresholdForCompoundHash = 1024;
 }
 
 - (BOOL)includeCompoundHash {
-    return [FSnapshotUtilities estimateSerializedNodeSize:[self serverCache]] >
+    return [FSnapshotUtilities
+               estimateSerializedNodeSize:[self serverCache]
+                                    limit:kFSizeThresholdForCompoundHash] >
            kFSizeThresholdForCompoundHash;
 }
 
@@ -23,6 +23,7 @@
 #import "FirebaseDatabase/Sources/Snapshot/FEmptyNode.h"
 #import "FirebaseDatabase/Sources/Snapshot/FIndexedNode.h"
 #import "FirebaseDatabase/Sources/Snapshot/FNode.h"
+#import "FirebaseDatabase/Sources/Utilities/FUtilities.h"
 
 @interface FIndexedFilter ()
 @property(nonatomic, strong, readwrite) id<FIndex> index;
@@ -106,23 +107,41 @@
                      accumulator:
                          (FChildChangeAccumulator *)optChangeAccumulator {
     if (optChangeAccumulator) {
+        // Both nodes enumerate their children in key order, so walk them in
+        // tandem instead of looking up every child in the other node. Shared
+        // subtrees are skipped by the identity check.
+        NSMutableArray *oldKeys = [NSMutableArray array];
+        NSMutableArray *oldChildren = [NSMutableArray array];
         [oldSnap.node enumerateChildrenUsingBlock:^(
                           NSString *childKey, id<FNode> childNode, BOOL *stop) {
-          if (![newSnap.node hasChild:childKey]) {
-              FChange *change = [[FChange alloc]
-                  initWithType:FIRDataEventTypeChildRemoved
-                   indexedNode:[FIndexedNode indexedNodeWithNode:childNode]
-                      childKey:childKey];
-              [optChangeAccumulator trackChildChange:change];
-          }
+          [oldKeys addObject:childKey];
+          [oldChildren addObject:childNode];
         }];
+        NSUInteger oldCount = oldKeys.count;
+        __block NSUInteger oldIndex = 0;
+        void (^trackRemoved)(void) = ^{
+          FChange *change = [[FChange alloc]
+              initWithType:FIRDataEventTypeChildRemoved
+               indexedNode:[FIndexedNode
+                               indexedNodeWithNode:oldChildren[oldIndex]]
+                  childKey:oldKeys[oldIndex]];
+          [optChangeAccumulator trackChildChange:change];
+          oldIndex++;
+        };
 
         [newSnap.node enumerateChildrenUsingBlock:^(
                           NSString *childKey, id<FNode> childNode, BOOL *stop) {
-          if ([oldSnap.node hasChild:childKey]) {
-              id<FNode> oldChildSnap =
-                  [oldSnap.node getImmediateChild:childKey];
-              if (![oldChildSnap isEqual:childNode]) {
+          NSComparisonResult order = NSOrderedAscending;
+          while (oldIndex < oldCount &&
+                 (order = [FUtilities compareKey:oldKeys[oldIndex]
+                                           toKey:childKey]) ==
+                     NSOrderedAscending) {
+              trackRemoved();
+          }
+          if (oldIndex < oldCount && order == NSOrderedSame) {
+              id<FNode> oldChildSnap = oldChildren[oldIndex++];
+              if (oldChildSnap != childNode &&
+                  ![oldChildSnap isEqual:childNode]) {
                   FChange *change = [[FChange alloc]
                         initWithType:FIRDataEventTypeChildChanged
                          indexedNode:[FIndexedNode
@@ -140,6 +159,9 @@
               [optChangeAccumulator trackChildChange:change];
           }
         }];
+        while (oldIndex < oldCount) {
+            trackRemoved();
+        }
     }
     return newSnap;
 }
@@ -27,6 +27,8 @@
 @property(nonatomic, strong) id<FIRDatabaseConnectionContextProvider>
     contextProvider;
 @property(nonatomic, strong) id<FStorageEngine> forceStorageEngine;
+// See FLevelDBStorageEngine's storesBinaryValues, off by default.
+@property(nonatomic) BOOL persistenceStoresBinaryValues;
 
 - (void)freeze;
 
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2024 Google
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * A compact binary encoding of JSON compatible values (NSDictionary, NSArray,
+ * NSString, NSNumber and NSNull), which FLevelDBStorageEngine can persist
+ * cached leaves and tracked queries in instead of JSON.
+ *
+ * Every encoded value starts with a type tag below 0x20, which JSON text
+ * never starts with, so values written as JSON can still be told apart and
+ * read.
+ */
+@interface FBinaryValueCoder : NSObject
+
+/** Returns YES if the bytes hold a value encoded by this class. */
++ (BOOL)isEncodedValue:(const void *)bytes length:(NSUInteger)length;
+
++ (NSData *)dataWithValue:(id)value;
+
+/** Decodes a value, or returns nil if the bytes are malformed. */
++ (nullable id)valueWithBytes:(const void *)bytes length:(NSUInteger)length;
+
+@end
+
+NS_ASSUME_NONNULL_END
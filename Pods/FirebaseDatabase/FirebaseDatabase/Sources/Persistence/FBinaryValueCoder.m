@@ -0,0 +1,283 @@
+/*
+ * Copyright 2024 Google
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import "FirebaseDatabase/Sources/Persistence/FBinaryValueCoder.h"
+
+#include <math.h>
+#include <string.h>
+
+// WARNING: These are persisted, do not change existing values.
+typedef NS_ENUM(uint8_t, FBinaryValueTag) {
+    FBinaryValueTagNull = 0x01,
+    FBinaryValueTagFalse = 0x02,
+    FBinaryValueTagTrue = 0x03,
+    // Followed by a zigzag encoded varint.
+    FBinaryValueTagInteger = 0x04,
+    // Followed by the 8 bytes of an IEEE 754 double, little-endian.
+    FBinaryValueTagDouble = 0x05,
+    // Followed by the varint length and the UTF-8 bytes of the string.
+    FBinaryValueTagString = 0x06,
+    // Followed by the varint number of entries, and then the key of each
+    // entry (encoded like a string, without the tag) followed by its value.
+    FBinaryValueTagDictionary = 0x07,
+    // Followed by the varint number of elements, and then the elements.
+    FBinaryValueTagArray = 0x08,
+};
+
+// Values nest at most this deep, so that a corrupted value can not exhaust
+// the stack while it is decoded.
+static const NSUInteger kFMaxNestingDepth = 512;
+
+#pragma mark - Encoding
+
+static void appendByte(NSMutableData *data, uint8_t byte) {
+    [data appendBytes:&byte length:1];
+}
+
+static void appendVarint(NSMutableData *data, uint64_t value) {
+    uint8_t buffer[10];
+    NSUInteger length = 0;
+    while (value >= 0x80) {
+        buffer[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    buffer[length++] = (uint8_t)value;
+    [data appendBytes:buffer length:length];
+}
+
+static void appendInteger(NSMutableData *data, int64_t value) {
+    appendByte(data, FBinaryValueTagInteger);
+    appendVarint(data, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+static void appendDouble(NSMutableData *data, double value) {
+    // Integral doubles are read back as integers, as they were from JSON.
+    // 2^63 is exactly representable, so the range check is exact.
+    if (value == floor(value) && value >= -9223372036854775808.0 &&
+        value < 9223372036854775808.0) {
+        appendInteger(data, (int64_t)value);
+        return;
+    }
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint8_t buffer[8];
+    for (int i = 0; i < 8; i++) {
+        buffer[i] = (uint8_t)(bits >> (8 * i));
+    }
+    appendByte(data, FBinaryValueTagDouble);
+    [data appendBytes:buffer length:sizeof(buffer)];
+}
+
+static void appendStringBytes(NSMutableData *data, NSString *string) {
+    NSUInteger length = [string lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+    appendVarint(data, length);
+    NSUInteger offset = data.length;
+    [data increaseLengthBy:length];
+    [string getBytes:(uint8_t *)data.mutableBytes + offset
+             maxLength:length
+            usedLength:NULL
+              encoding:NSUTF8StringEncoding
+               options:0
+                 range:NSMakeRange(0, string.length)
+        remainingRange:NULL];
+}
+
+static void appendNumber(NSMutableData *data, NSNumber *number) {
+    if (CFGetTypeID((__bridge CFTypeRef)number) == CFBooleanGetTypeID()) {
+        appendByte(data, number.boolValue ? FBinaryValueTagTrue
+                                          : FBinaryValueTagFalse);
+    } else if ([number isKindOfClass:[NSDecimalNumber class]]) {
+        // Decimals may be more precise than doubles, so test for integral
+        // values with NSDecimal logic, as they are read back from JSON.
+        NSDecimal original = [(NSDecimalNumber *)number decimalValue];
+        NSDecimal rounded;
+        NSDecimalRound(&rounded, &original, 0, NSRoundPlain);
+        if (NSDecimalCompare(&original, &rounded) == NSOrderedSame) {
+            appendInteger(data, number.longLongValue);
+        } else {
+            appendDouble(data, number.stringValue.doubleValue);
+        }
+    } else if (CFNumberIsFloatType((__bridge CFNumberRef)number)) {
+        appendDouble(data, number.doubleValue);
+    } else if (strcmp(number.objCType, @encode(unsigned long long)) == 0 &&
+               number.unsignedLongLongValue > INT64_MAX) {
+        appendDouble(data, (double)number.unsignedLongLongValue);
+    } else {
+        appendInteger(data, number.longLongValue);
+    }
+}
+
+static void appendValue(NSMutableData *data, id value) {
+    if ([value isKindOfClass:[NSString class]]) {
+        appendByte(data, FBinaryValueTagString);
+        appendStringBytes(data, value);
+    } else if ([value isKindOfClass:[NSNumber class]]) {
+        appendNumber(data, value);
+    } else if ([value isKindOfClass:[NSDictionary class]]) {
+        NSDictionary *dictionary = value;
+        appendByte(data, FBinaryValueTagDictionary);
+        appendVarint(data, dictionary.count);
+        [dictionary enumerateKeysAndObjectsUsingBlock:^(
+                        id key, id object, BOOL *stop) {
+          appendStringBytes(data, [key description]);
+          appendValue(data, object);
+        }];
+    } else if ([value isKindOfClass:[NSArray class]]) {
+        NSArray *array = value;
+        appendByte(data, FBinaryValueTagArray);
+        appendVarint(data, array.count);
+        for (id element in array) {
+            appendValue(data, element);
+        }
+    } else if (value == nil || [value isKindOfClass:[NSNull class]]) {
+        appendByte(data, FBinaryValueTagNull);
+    } else {
+        [NSException raise:NSInvalidArgumentException
+                    format:@"Can not encode value of class %@: %@",
+                           [value class], value];
+    }
+}
+
+#pragma mark - Decoding
+
+typedef struct {
+    const uint8_t *pos;
+    const uint8_t *end;
+} FBinaryValueReader;
+
+static BOOL readVarint(FBinaryValueReader *reader, uint64_t *value) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64 && reader->pos < reader->end; shift += 7) {
+        uint8_t byte = *reader->pos++;
+        result |= (uint64_t)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return YES;
+        }
+    }
+    return NO;
+}
+
+static NSString *readStringBytes(FBinaryValueReader *reader) {
+    uint64_t length;
+    if (!readVarint(reader, &length) ||
+        length > (uint64_t)(reader->end - reader->pos)) {
+        return nil;
+    }
+    NSString *string = [[NSString alloc] initWithBytes:reader->pos
+                                                length:(NSUInteger)length
+                                              encoding:NSUTF8StringEncoding];
+    reader->pos += length;
+    return string;
+}
+
+static id readValue(FBinaryValueReader *reader, NSUInteger depth) {
+    if (reader->pos >= reader->end || depth > kFMaxNestingDepth) {
+        return nil;
+    }
+    uint8_t tag = *reader->pos++;
+    switch (tag) {
+        case FBinaryValueTagNull:
+            return [NSNull null];
+        case FBinaryValueTagFalse:
+            return @NO;
+        case FBinaryValueTagTrue:
+            return @YES;
+        case FBinaryValueTagInteger: {
+            uint64_t zigzag;
+            if (!readVarint(reader, &zigzag)) {
+                return nil;
+            }
+            int64_t value = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+            return [NSNumber numberWithLongLong:value];
+        }
+        case FBinaryValueTagDouble: {
+            if (reader->end - reader->pos < 8) {
+                return nil;
+            }
+            uint64_t bits = 0;
+            for (int i = 0; i < 8; i++) {
+                bits |= (uint64_t)reader->pos[i] << (8 * i);
+            }
+            reader->pos += 8;
+            double value;
+            memcpy(&value, &bits, sizeof(value));
+            return [NSNumber numberWithDouble:value];
+        }
+        case FBinaryValueTagString:
+            return readStringBytes(reader);
+        case FBinaryValueTagDictionary: {
+            uint64_t count;
+            // Every entry takes at least two bytes.
+            if (!readVarint(reader, &count) ||
+                count > (uint64_t)(reader->end - reader->pos) / 2) {
+                return nil;
+            }
+            NSMutableDictionary *dictionary =
+                [NSMutableDictionary dictionaryWithCapacity:(NSUInteger)count];
+            for (uint64_t i = 0; i < count; i++) {
+                NSString *key = readStringBytes(reader);
+                id value = key == nil ? nil : readValue(reader, depth + 1);
+                if (value == nil) {
+                    return nil;
+                }
+                dictionary[key] = value;
+            }
+            return dictionary;
+        }
+        case FBinaryValueTagArray: {
+            uint64_t count;
+            if (!readVarint(reader, &count) ||
+                count > (uint64_t)(reader->end - reader->pos)) {
+                return nil;
+            }
+            NSMutableArray *array =
+                [NSMutableArray arrayWithCapacity:(NSUInteger)count];
+            for (uint64_t i = 0; i < count; i++) {
+                id element = readValue(reader, depth + 1);
+                if (element == nil) {
+                    return nil;
+                }
+                [array addObject:element];
+            }
+            return array;
+        }
+        default:
+            return nil;
+    }
+}
+
+@implementation FBinaryValueCoder
+
++ (BOOL)isEncodedValue:(const void *)bytes length:(NSUInteger)length {
+    return length > 0 && *(const uint8_t *)bytes < 0x20;
+}
+
++ (NSData *)dataWithValue:(id)value {
+    NSMutableData *data = [NSMutableData data];
+    appendValue(data, value);
+    return data;
+}
+
++ (id)valueWithBytes:(const void *)bytes length:(NSUInteger)length {
+    FBinaryValueReader reader = {(const uint8_t *)bytes,
+                                 (const uint8_t *)bytes + length};
+    id value = readValue(&reader, 0);
+    // Trailing bytes mean that the value is corrupted.
+    return reader.pos == reader.end ? value : nil;
+}
+
+@end
@@ -33,6 +33,14 @@
 
 - (id)initWithPath:(NSString *)path;
 
+/**
+ * Whether cached values and tracked queries are saved in the binary encoding
+ * of FBinaryValueCoder rather than as JSON. Both are read either way, but SDKs
+ * that predate the binary encoding can't read binary values, so this is off by
+ * default. User writes are always saved as JSON.
+ */
+@property(nonatomic) BOOL storesBinaryValues;
+
 - (void)runLegacyMigration:(FRepoInfo *)info;
 - (void)purgeEverything;
 
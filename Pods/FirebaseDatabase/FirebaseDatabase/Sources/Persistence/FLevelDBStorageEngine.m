@@ -19,12 +19,16 @@
 #import "FirebaseDatabase/Sources/Persistence/FLevelDBStorageEngine.h"
 
 #import "FirebaseCore/Extension/FirebaseCoreInternal.h"
+#import "FirebaseDatabase/Sources/Constants/FConstants.h"
 #import "FirebaseDatabase/Sources/Core/FQueryParams.h"
 #import "FirebaseDatabase/Sources/Core/FWriteRecord.h"
+#import "FirebaseDatabase/Sources/Persistence/FBinaryValueCoder.h"
 #import "FirebaseDatabase/Sources/Persistence/FPendingPut.h"
 #import "FirebaseDatabase/Sources/Persistence/FPruneForest.h"
 #import "FirebaseDatabase/Sources/Persistence/FTrackedQuery.h"
+#import "FirebaseDatabase/Sources/Snapshot/FChildrenNode.h"
 #import "FirebaseDatabase/Sources/Snapshot/FEmptyNode.h"
+#import "FirebaseDatabase/Sources/Snapshot/FLeafNode.h"
 #import "FirebaseDatabase/Sources/Snapshot/FSnapshotUtilities.h"
 #import "FirebaseDatabase/Sources/Utilities/FUtilities.h"
 #import "FirebaseDatabase/Sources/third_party/Wrap-leveldb/APLevelDB.h"
@@ -34,6 +38,9 @@
 @property(nonatomic, strong) NSString *basePath;
 @property(nonatomic, strong) APLevelDB *writesDB;
 @property(nonatomic, strong) APLevelDB *serverCacheDB;
+// The total size of the values in the server cache. It never falls below the
+// exact size, see serverCacheSizeInBytes.
+@property(nonatomic) NSUInteger serverCacheSize;
 
 @end
 
@@ -60,16 +67,32 @@ static NSString *const kFServerCachePrefix = @"/server_cache/";
 // We wan't the entire range of thing stored in the DB
 static NSString *const kFServerCacheRangeEnd = @"/server_cache~";
 static NSString *const kFTrackedQueriesPrefix = @"/tracked_queries/";
+// Outside of the server cache range, so that it isn't counted itself.
+static NSString *const kFServerCacheSizeKey = @"/cache_size";
 static NSString *const kFTrackedQueryKeysPrefix = @"/tracked_query_keys/";
 
 // Failed to load JSON because a valid JSON turns out to be NaN while
 // deserializing
 static const NSInteger kFNanFailureCode = 3840;
 
+// Failed to load a value because its binary encoding is malformed
+static NSString *const kFCorruptValueErrorDomain =
+    @"com.firebase.database.CorruptValue";
+
+// Whether a value that failed to load should be dropped rather than treated
+// as a fatal error
+static BOOL isUnreadableValueError(NSError *error) {
+    return error.code == kFNanFailureCode ||
+           [error.domain isEqualToString:kFCorruptValueErrorDomain];
+}
+
 static NSString *writeRecordKey(NSUInteger writeId) {
     return [NSString stringWithFormat:@"%lu", (unsigned long)(writeId)];
 }
 
+// Pruning deletes at most this many keys per write batch.
+static const NSUInteger kFPruneBatchSize = 1000;
+
 static NSString *serverCacheKey(FPath *path) {
     return [NSString stringWithFormat:@"%@%@", kFServerCachePrefix,
                                       ([path toStringWithTrailingSlash])];
@@ -239,6 +262,17 @@ static NSString *trackedQueryKeysKey(NSUInteger trackedQueryId, NSString *key) {
 - (void)openDatabases {
     self.serverCacheDB = [self createDB:kFServerDBPath];
     self.writesDB = [self createDB:kFWritesDBPath];
+    [self loadServerCacheSize];
+}
+
+- (void)loadServerCacheSize {
+    NSString *size = [self.serverCacheDB stringForKey:kFServerCacheSizeKey];
+    if (size != nil) {
+        self.serverCacheSize = (NSUInteger)size.longLongValue;
+    } else {
+        // Written by a version that didn't keep track of the size.
+        [self serverCacheSizeInBytes];
+    }
 }
 
 - (void)purgeDatabase:(NSString *)dbPath {
@@ -327,12 +361,7 @@ static NSString *trackedQueryKeysKey(NSUInteger trackedQueryId, NSString *key) {
         kFUserWritePath : [path toStringWithTrailingSlash],
         kFUserWriteOverwrite : [node valForExport:YES]
     };
-    NSError *error = nil;
-    NSData *data = [NSJSONSerialization dataWithJSONObject:write
-                                                   options:0
-                                                     error:&error];
-    NSAssert(data, @"Failed to serialize user overwrite: %@, (Error: %@)",
-             write, error);
+    NSData *data = [self serializeJSONRecord:write];
     [self.writesDB setData:data forKey:writeRecordKey(writeId)];
 }
 
@@ -344,12 +373,7 @@ static NSString *trackedQueryKeysKey(NSUInteger trackedQueryId, NSString *key) {
         kFUserWritePath : [path toStringWithTrailingSlash],
         kFUserWriteMerge : [merge valForExport:YES]
     };
-    NSError *error = nil;
-    NSData *data = [NSJSONSerialization dataWithJSONObject:write
-                                                   options:0
-                                                     error:&error];
-    NSAssert(data, @"Failed to serialize user merge: %@ (Error: %@)", write,
-             error);
+    NSData *data = [self serializeJSONRecord:write];
     [self.writesDB setData:data forKey:writeRecordKey(writeId)];
 }
 
@@ -377,19 +401,21 @@ static NSString *trackedQueryKeysKey(NSUInteger trackedQueryId, NSString *key) {
 - (NSArray *)userWrites {
     NSDate *date = [NSDate date];
     NSMutableArray *writes = [NSMutableArray array];
-    [self.writesDB enumerateKeysAndValuesAsData:^(NSString *key, NSData *data,
-                                                  BOOL *stop) {
+    [self.writesDB enumerateKeysWithPrefix:@""
+                                   asBytes:^(NSString *key, const void *bytes,
+                                             NSUInteger length, BOOL *stop) {
       NSError *error = nil;
-      NSDictionary *writeJSON = [NSJSONSerialization JSONObjectWithData:data
-                                                                options:0
-                                                                  error:&error];
+      NSDictionary *writeJSON = [self deserializeRecord:bytes
+                                                 length:length
+                                                  error:&error];
       if (writeJSON == nil) {
-          if (error.code == kFNanFailureCode) {
+          if (isUnreadableValueError(error)) {
               FFWarn(@"I-RDB076012",
                      @"Failed to deserialize write (%@), likely because of out "
-                     @"of range doubles (Error: %@)",
-                     [[NSString alloc] initWithData:data
-                                           encoding:NSUTF8StringEncoding],
+                     @"of range doubles or corruption (Error: %@)",
+                     [[NSString alloc] initWithBytes:bytes
+                                              length:length
+                                            encoding:NSUTF8StringEncoding],
                      error);
               FFWarn(@"I-RDB076013", @"Removing failed write with key %@", key);
               [self.writesDB removeKey:key];
@@ -441,8 +467,7 @@ static NSString *trackedQueryKeysKey(NSUInteger trackedQueryId, NSString *key) {
 
 - (id<FNode>)serverCacheAtPath:(FPath *)path {
     NSDate *start = [NSDate date];
-    id data = [self internalNestedDataForPath:path];
-    id<FNode> node = [FSnapshotUtilities nodeFrom:data];
+    id<FNode> node = [self internalNodeForPath:path keys:nil];
     FFDebug(@"I-RDB076015", @"Loaded node with %d children at %@ in %fms",
             [node numChildren], path, [start timeIntervalSinceNow] * -1000);
     return node;
@@ -450,12 +475,7 @@ static NSString *trackedQueryKeysKey(NSUInteger trackedQueryId, NSString *key) {
 
 - (id<FNode>)serverCacheForKeys:(NSSet *)keys atPath:(FPath *)path {
     NSDate *start = [NSDate date];
-    __block id<FNode> node = [FEmptyNode emptyNode];
-    [keys enumerateObjectsUsingBlock:^(NSString *key, BOOL *stop) {
-      id data = [self internalNestedDataForPath:[path childFromString:key]];
-      node = [node updateImmediateChild:key
-                           withNewChild:[FSnapshotUtilities nodeFrom:data]];
-    }];
+    id<FNode> node = [self internalNodeForPath:path keys:keys];
     FFDebug(@"I-RDB076016",
             @"Loaded node with %d children for %lu keys at %@ in %fms",
             [node numChildren], (unsigned long)keys.count, path,
@@ -467,6 +487,7 @@ static NSString *trackedQueryKeysKey(NSUInteger trackedQueryId, NSString *key) {
                    atPath:(FPath *)path
                     merge:(BOOL)merge {
     NSDate *start = [NSDate date];
+    NSUInteger previousSize = self.serverCacheSize;
     id<APLevelDBWriteBatch> batch = [self.serverCacheDB beginWriteBatch];
     // Remove any leaf nodes that might be higher up
     [self removeAllLeafNodesOnPath:path batch:batch];
@@ -491,8 +512,10 @@ static NSString *trackedQueryKeysKey(NSUInteger trackedQueryId, NSString *key) {
                          database:self.serverCacheDB];
         [self saveNodeInternal:node atPath:path batch:batch counter:&counter];
     }
+    [self saveServerCacheSizeInBatch:batch];
     BOOL success = [batch commit];
     if (!success) {
+        self.serverCacheSize = previousSize;
         FFWarn(@"I-RDB076017", @"Failed to update server cache on disk!");
     } else {
         FFDebug(@"I-RDB076018", @"Saved %lu leaf nodes for overwrite in %fms",
@@ -504,6 +527,7 @@ static NSString *trackedQueryKeysKey(NSUInteger trackedQueryId, NSString *key) {
                             atPath:(FPath *)path {
     NSDate *start = [NSDate date];
     __block NSUInteger counter = 0;
+    NSUInteger previousSize = self.serverCacheSize;
     id<APLevelDBWriteBatch> batch = [self.serverCacheDB beginWriteBatch];
     // Remove any leaf nodes that might be higher up
     [self removeAllLeafNodesOnPath:path batch:batch];
@@ -517,8 +541,10 @@ static NSString *trackedQueryKeysKey(NSUInteger trackedQueryId, NSString *key) {
                        batch:batch
                      counter:&counter];
     }];
+    [self saveServerCacheSizeInBatch:batch];
     BOOL success = [batch commit];
     if (!success) {
+        self.serverCacheSize = previousSize;
         FFWarn(@"I-RDB076019", @"Failed to update server cache on disk!");
     } else {
         FFDebug(@"I-RDB076020", @"Saved %lu leaf nodes for merge in %fms",
@@ -540,45 +566,85 @@ static NSString *trackedQueryKeysKey(NSUInteger trackedQueryId, NSString *key) {
 }
 
 - (NSUInteger)serverCacheEstimatedSizeInBytes {
+    return self.serverCacheSize;
+}
+
+- (NSUInteger)serverCacheSizeInBytes {
     // Use the exact size, because for pruning the approximate size can lead to
     // weird situations where we prune everything because no compaction is ever
     // run
-    return [self.serverCacheDB exactSizeFrom:kFServerCachePrefix
-                                          to:kFServerCacheRangeEnd];
+    NSUInteger size = [self.serverCacheDB exactSizeFrom:kFServerCachePrefix
+                                                     to:kFServerCacheRangeEnd];
+    if (size != self.serverCacheSize) {
+        self.serverCacheSize = size;
+        id<APLevelDBWriteBatch> batch = [self.serverCacheDB beginWriteBatch];
+        [self saveServerCacheSizeInBatch:batch];
+        [batch commit];
+    }
+    return size;
 }
 
 - (void)pruneCache:(FPruneForest *)pruneForest atPath:(FPath *)path {
+    NSString *cursor = nil;
+    do {
+        cursor = [self pruneCache:pruneForest
+                           atPath:path
+                       startingAt:cursor
+                          maxKeys:kFPruneBatchSize];
+    } while (cursor != nil);
+}
+
+- (NSString *)pruneCache:(FPruneForest *)pruneForest
+                  atPath:(FPath *)path
+              startingAt:(NSString *)cursor
+                 maxKeys:(NSUInteger)maxKeys {
     // TODO: be more intelligent, don't scan entire database...
 
-    __block NSUInteger pruned = 0;
-    __block NSUInteger kept = 0;
+    NSUInteger pruned = 0;
+    NSUInteger kept = 0;
     NSDate *start = [NSDate date];
 
     NSString *prefix = serverCacheKey(path);
+    NSUInteger previousSize = self.serverCacheSize;
     id<APLevelDBWriteBatch> batch = [self.serverCacheDB beginWriteBatch];
 
-    [self.serverCacheDB
-        enumerateKeysWithPrefix:prefix
-                     usingBlock:^(NSString *dbKey, BOOL *stop) {
-                       NSString *pathStr =
-                           [dbKey substringFromIndex:prefix.length];
-                       FPath *relativePath = [[FPath alloc] initWith:pathStr];
-                       if ([pruneForest shouldPruneUnkeptDescendantsAtPath:
-                                            relativePath]) {
-                           pruned++;
-                           [batch removeKey:dbKey];
-                       } else {
-                           kept++;
-                       }
-                     }];
+    NSString *next = nil;
+    // See internalNodeForPath:keys: for why the iterator is freed right away.
+    @autoreleasepool {
+        APLevelDBIterator *iter =
+            [APLevelDBIterator iteratorWithLevelDB:self.serverCacheDB];
+        [iter seekToKey:cursor ?: prefix];
+        NSString *dbKey = iter.key;
+        while (dbKey != nil && [dbKey hasPrefix:prefix]) {
+            if (pruned + kept == maxKeys) {
+                next = dbKey;
+                break;
+            }
+            NSString *pathStr = [dbKey substringFromIndex:prefix.length];
+            FPath *relativePath = [[FPath alloc] initWith:pathStr];
+            if ([pruneForest shouldPruneUnkeptDescendantsAtPath:relativePath]) {
+                NSUInteger length = 0;
+                [iter valueBytesWithLength:&length];
+                [self shrinkServerCacheSizeBy:length];
+                pruned++;
+                [batch removeKey:dbKey];
+            } else {
+                kept++;
+            }
+            dbKey = [iter nextKey];
+        }
+    }
+    [self saveServerCacheSizeInBatch:batch];
     BOOL success = [batch commit];
     if (!success) {
+        self.serverCacheSize = previousSize;
         FFWarn(@"I-RDB076021", @"Failed to prune cache on disk!");
     } else {
         FFDebug(@"I-RDB076022", @"Pruned %lu paths, kept %lu paths in %fms",
                 (unsigned long)pruned, (unsigned long)kept,
                 [start timeIntervalSinceNow] * -1000);
     }
+    return next;
 }
 
 #pragma mark - Tracked Queries
@@ -588,69 +654,71 @@ static NSString *trackedQueryKeysKey(NSUInteger trackedQueryId, NSString *key) {
     NSMutableArray *trackedQueries = [NSMutableArray array];
     [self.serverCacheDB
         enumerateKeysWithPrefix:kFTrackedQueriesPrefix
-                         asData:^(NSString *key, NSData *data, BOOL *stop) {
-                           NSError *error = nil;
-                           NSDictionary *queryJSON =
-                               [NSJSONSerialization JSONObjectWithData:data
-                                                               options:0
-                                                                 error:&error];
-                           if (queryJSON == nil) {
-                               if (error.code == kFNanFailureCode) {
-                                   FFWarn(
-                                       @"I-RDB076023",
-                                       @"Failed to deserialize tracked query "
-                                       @"(%@), likely because of out of range "
-                                       @"doubles (Error: %@)",
-                                       [[NSString alloc]
-                                           initWithData:data
+                        asBytes:^(NSString *key, const void *bytes,
+                                  NSUInteger length, BOOL *stop) {
+                          NSError *error = nil;
+                          NSDictionary *queryJSON =
+                              [self deserializeRecord:bytes
+                                               length:length
+                                                error:&error];
+                          if (queryJSON == nil) {
+                              if (isUnreadableValueError(error)) {
+                                  FFWarn(
+                                      @"I-RDB076023",
+                                      @"Failed to deserialize tracked query "
+                                      @"(%@), likely because of out of range "
+                                      @"doubles or corruption (Error: %@)",
+                                      [[NSString alloc]
+                                          initWithBytes:bytes
+                                                 length:length
                                                encoding:NSUTF8StringEncoding],
-                                       error);
-                                   FFWarn(@"I-RDB076024",
-                                          @"Removing failed tracked query with "
-                                          @"key %@",
-                                          key);
-                                   [self.serverCacheDB removeKey:key];
-                               } else {
-                                   [NSException
-                                        raise:NSInternalInconsistencyException
-                                       format:@"Failed to deserialize tracked "
-                                              @"query: %@",
-                                              error];
-                               }
-                           } else {
-                               NSUInteger queryId =
-                                   ((NSNumber *)queryJSON[kFTrackedQueryId])
-                                       .unsignedIntegerValue;
-                               FPath *path =
-                                   [FPath pathWithString:
-                                              queryJSON[kFTrackedQueryPath]];
-                               FQueryParams *params = [FQueryParams
-                                   fromQueryObject:queryJSON
-                                                       [kFTrackedQueryParams]];
-                               FQuerySpec *query =
-                                   [[FQuerySpec alloc] initWithPath:path
-                                                             params:params];
-                               BOOL isComplete =
-                                   [queryJSON[kFTrackedQueryIsComplete]
-                                       boolValue];
-                               BOOL isActive =
-                                   [queryJSON[kFTrackedQueryIsActive]
-                                       boolValue];
-                               NSTimeInterval lastUse =
-                                   [queryJSON[kFTrackedQueryLastUse]
-                                       doubleValue];
-
-                               FTrackedQuery *trackedQuery =
-                                   [[FTrackedQuery alloc]
-                                       initWithId:queryId
-                                            query:query
-                                          lastUse:lastUse
-                                         isActive:isActive
-                                       isComplete:isComplete];
-
-                               [trackedQueries addObject:trackedQuery];
-                           }
-                         }];
+                                      error);
+                                  FFWarn(@"I-RDB076024",
+                                         @"Removing failed tracked query with "
+                                         @"key %@",
+                                         key);
+                                  [self.serverCacheDB removeKey:key];
+                              } else {
+                                  [NSException
+                                       raise:NSInternalInconsistencyException
+                                      format:@"Failed to deserialize tracked "
+                                             @"query: %@",
+                                             error];
+                              }
+                          } else {
+                              NSUInteger queryId =
+                                  ((NSNumber *)queryJSON[kFTrackedQueryId])
+                                      .unsignedIntegerValue;
+                              FPath *path =
+                                  [FPath pathWithString:
+                                             queryJSON[kFTrackedQueryPath]];
+                              FQueryParams *params = [FQueryParams
+                                  fromQueryObject:queryJSON
+                                                      [kFTrackedQueryParams]];
+                              FQuerySpec *query =
+                                  [[FQuerySpec alloc] initWithPath:path
+                                                            params:params];
+                              BOOL isComplete =
+                                  [queryJSON[kFTrackedQueryIsComplete]
+                                      boolValue];
+                              BOOL isActive =
+                                  [queryJSON[kFTrackedQueryIsActive]
+                                      boolValue];
+                              NSTimeInterval lastUse =
+                                  [queryJSON[kFTrackedQueryLastUse]
+                                      doubleValue];
+
+                              FTrackedQuery *trackedQuery =
+                                  [[FTrackedQuery alloc]
+                                      initWithId:queryId
+                                           query:query
+                                         lastUse:lastUse
+                                        isActive:isActive
+                                      isComplete:isComplete];
+
+                              [trackedQueries addObject:trackedQuery];
+                          }
+                        }];
     FFDebug(@"I-RDB076025", @"Loaded %lu tracked queries in %fms",
             (unsigned long)trackedQueries.count,
             [date timeIntervalSinceNow] * -1000);
@@ -690,11 +758,7 @@ static NSString *trackedQueryKeysKey(NSUInteger trackedQueryId, NSString *key) {
         kFTrackedQueryIsComplete : @(query.isComplete),
         kFTrackedQueryIsActive : @(query.isActive)
     };
-    NSError *error = nil;
-    NSData *data = [NSJSONSerialization dataWithJSONObject:trackedQuery
-                                                   options:0
-                                                     error:&error];
-    NSAssert(data, @"Failed to serialize tracked query (Error: %@)", error);
+    NSData *data = [self serializeRecord:trackedQuery];
     [self.serverCacheDB setData:data forKey:trackedQueryKey(query.queryId)];
     FFDebug(@"I-RDB076028", @"Saved tracked query %lu in %fms",
             (unsigned long)query.queryId, [start timeIntervalSinceNow] * -1000);
@@ -782,6 +846,8 @@ static NSString *trackedQueryKeysKey(NSUInteger trackedQueryId, NSString *key) {
 
 #pragma mark - Internal methods
 
+// These leaves rarely exist, so they are left out of serverCacheSize rather
+// than reading each of them to find its size.
 - (void)removeAllLeafNodesOnPath:(FPath *)path
                            batch:(id<APLevelDBWriteBatch>)batch {
     while (!path.isEmpty) {
@@ -798,9 +864,25 @@ static NSString *trackedQueryKeysKey(NSUInteger trackedQueryId, NSString *key) {
     assert(prefix != nil);
 
     [database enumerateKeysWithPrefix:prefix
-                           usingBlock:^(NSString *key, BOOL *stop) {
-                             [batch removeKey:key];
-                           }];
+                              asBytes:^(NSString *key, const void *bytes,
+                                        NSUInteger length, BOOL *stop) {
+                                [batch removeKey:key];
+                                if (database == self.serverCacheDB) {
+                                    [self shrinkServerCacheSizeBy:length];
+                                }
+                              }];
+}
+
+- (void)shrinkServerCacheSizeBy:(NSUInteger)length {
+    self.serverCacheSize -= MIN(length, self.serverCacheSize);
+}
+
+// Stores the size along with the changes that it accounts for.
+- (void)saveServerCacheSizeInBatch:(id<APLevelDBWriteBatch>)batch {
+    [batch setString:[NSString stringWithFormat:@"%lu",
+                                                (unsigned long)
+                                                    self.serverCacheSize]
+              forKey:kFServerCacheSizeKey];
 }
 
 #pragma mark - Internal helper methods
@@ -824,11 +906,12 @@ static NSString *trackedQueryKeysKey(NSUInteger trackedQueryId, NSString *key) {
     } else {
         NSData *data = [self serializePrimitive:value];
         [batch setData:data forKey:key];
+        self.serverCacheSize += data.length;
         (*counter)++;
     }
 }
 
-- (id)internalNestedDataForPath:(FPath *)path {
+- (id<FNode>)internalNodeForPath:(FPath *)path keys:(NSSet *)keys {
     NSAssert(path != nil, @"Path was nil!");
 
     NSString *baseKey = serverCacheKey(path);
@@ -839,46 +922,131 @@ static NSString *trackedQueryKeysKey(NSUInteger trackedQueryId, NSString *key) {
         APLevelDBIterator *iter =
             [APLevelDBIterator iteratorWithLevelDB:self.serverCacheDB];
 
-        [iter seekToKey:baseKey];
-        if (iter.key == nil || ![iter.key hasPrefix:baseKey]) {
-            // No data.
-            return nil;
-        } else {
-            return [self internalNestedDataFromIterator:iter
-                                           andKeyPrefix:baseKey];
+        if (keys == nil) {
+            [iter seekToKey:baseKey];
+            if (iter.key == nil || ![iter.key hasPrefix:baseKey]) {
+                // No data.
+                return [FEmptyNode emptyNode];
+            }
+            return [self internalNodeFromIterator:iter andKeyPrefix:baseKey];
+        }
+
+        // Only the requested children are read, seeking to each of them in
+        // sorted order so that the iterator mostly moves forward.
+        NSArray *sortedKeys =
+            [keys.allObjects sortedArrayUsingSelector:@selector(compare:)];
+        NSMutableDictionary *children =
+            [NSMutableDictionary dictionaryWithCapacity:sortedKeys.count];
+        for (NSString *key in sortedKeys) {
+            NSString *childKey =
+                [NSString stringWithFormat:@"%@%@/", baseKey, key];
+            [iter seekToKey:childKey];
+            if (iter.key != nil && [iter.key hasPrefix:childKey]) {
+                id<FNode> child = [self internalNodeFromIterator:iter
+                                                    andKeyPrefix:childKey];
+                if (![child isEmpty]) {
+                    children[key] = child;
+                }
+            }
         }
+        return [self childrenNodeWithChildren:children priority:nil];
     }
 }
 
-- (id)internalNestedDataFromIterator:(APLevelDBIterator *)iterator
-                        andKeyPrefix:(NSString *)prefix {
+// Builds the node stored under the prefix straight from the iterator, which
+// must be positioned at the first key with that prefix, and leaves the
+// iterator at the first key after them. The node is assembled bottom-up, so
+// at no point is a second copy of the subtree held in memory.
+- (id<FNode>)internalNodeFromIterator:(APLevelDBIterator *)iterator
+                         andKeyPrefix:(NSString *)prefix {
     NSString *key = iterator.key;
 
     if ([key isEqualToString:prefix]) {
-        id result = [self deserializePrimitive:iterator.valueAsData];
+        NSUInteger length = 0;
+        const void *bytes = [iterator valueBytesWithLength:&length];
+        id value = [self deserializePrimitive:bytes length:length];
         [iterator nextKey];
-        return result;
-    } else {
-        NSMutableDictionary *dict = [[NSMutableDictionary alloc] init];
-        while (key != nil && [key hasPrefix:prefix]) {
-            NSString *relativePath = [key substringFromIndex:prefix.length];
-            NSArray *pathPieces =
-                [relativePath componentsSeparatedByString:@"/"];
-            assert(pathPieces.count > 0);
-            NSString *childName = pathPieces[0];
-            NSString *childPath =
-                [NSString stringWithFormat:@"%@%@/", prefix, childName];
-            id childValue = [self internalNestedDataFromIterator:iterator
-                                                    andKeyPrefix:childPath];
-            [dict setValue:childValue forKey:childName];
-
-            key = iterator.key;
+        if ([value isKindOfClass:[NSString class]] ||
+            [value isKindOfClass:[NSNumber class]]) {
+            return [[FLeafNode alloc] initWithValue:value];
         }
-        return dict;
+        // Null and corrupted values.
+        return [FSnapshotUtilities nodeFrom:value];
+    }
+
+    NSMutableDictionary *children = [NSMutableDictionary dictionary];
+    id<FNode> priority = nil;
+    id<FNode> leaf = nil;
+    while (key != nil && [key hasPrefix:prefix]) {
+        NSUInteger start = prefix.length;
+        NSRange separator =
+            [key rangeOfString:@"/"
+                       options:NSLiteralSearch
+                         range:NSMakeRange(start, key.length - start)];
+        assert(separator.location != NSNotFound);
+        NSString *childName =
+            [key substringWithRange:NSMakeRange(start,
+                                                separator.location - start)];
+        NSString *childPath = [key substringToIndex:NSMaxRange(separator)];
+        id<FNode> child = [self internalNodeFromIterator:iterator
+                                            andKeyPrefix:childPath];
+        if ([childName isEqualToString:kPayloadPriority]) {
+            priority = child;
+        } else if ([childName isEqualToString:kPayloadValue]) {
+            leaf = child;
+        } else if (![childName hasPrefix:kPayloadMetadataPrefix] &&
+                   ![child isEmpty]) {
+            children[childName] = child;
+        }
+
+        key = iterator.key;
+    }
+
+    if (leaf != nil && [leaf isLeafNode]) {
+        return priority == nil ? leaf : [leaf updatePriority:priority];
+    }
+    return [self childrenNodeWithChildren:children priority:priority];
+}
+
+- (id<FNode>)childrenNodeWithChildren:(NSDictionary *)children
+                             priority:(id<FNode>)priority {
+    if (children.count == 0) {
+        return [FEmptyNode emptyNode];
+    }
+    // leveldb orders keys bytewise, which is not the order of keyComparator
+    // (e.g. for integer keys), so the children are sorted once per level.
+    FImmutableSortedDictionary *childrenDict = [FImmutableSortedDictionary
+        fromDictionary:children
+        withComparator:[FUtilities keyComparator]];
+    return [[FChildrenNode alloc]
+        initWithPriority:priority ?: [FEmptyNode emptyNode]
+                children:childrenDict];
+}
+
+// Writes a tracked query, which is a dictionary.
+- (NSData *)serializeRecord:(NSDictionary *)record {
+    if (self.storesBinaryValues) {
+        return [FBinaryValueCoder dataWithValue:record];
     }
+    return [self serializeJSONRecord:record];
+}
+
+// User writes are always saved as JSON: they can't be fetched from the server
+// again, so older SDKs must still read them after a downgrade.
+- (NSData *)serializeJSONRecord:(NSDictionary *)record {
+    NSError *error = nil;
+    NSData *data = [NSJSONSerialization dataWithJSONObject:record
+                                                   options:0
+                                                     error:&error];
+    NSAssert(data, @"Failed to serialize record: %@ (Error: %@)", record,
+             error);
+    return data;
 }
 
 - (NSData *)serializePrimitive:(id)value {
+    if (self.storesBinaryValues) {
+        return [FBinaryValueCoder dataWithValue:value];
+    }
     // HACK: The built-in serialization only works on dicts and arrays.  So we
     // create an array and then strip off the leading / trailing byte (the [ and
     // ]).
@@ -891,6 +1059,28 @@ static NSString *trackedQueryKeysKey(NSUInteger trackedQueryId, NSString *key) {
     return [data subdataWithRange:NSMakeRange(1, data.length - 2)];
 }
 
+// Reads a user write or tracked query, which are dictionaries, in either
+// encoding. Returns nil and sets *error if it can't be read.
+- (id)deserializeRecord:(const void *)bytes
+                 length:(NSUInteger)length
+                  error:(NSError **)error {
+    if ([FBinaryValueCoder isEncodedValue:bytes length:length]) {
+        id result = [FBinaryValueCoder valueWithBytes:bytes length:length];
+        if (![result isKindOfClass:[NSDictionary class]]) {
+            *error = [NSError errorWithDomain:kFCorruptValueErrorDomain
+                                         code:0
+                                     userInfo:nil];
+            return nil;
+        }
+        return result;
+    }
+    // Written as JSON by an older version.
+    NSData *data = [NSData dataWithBytesNoCopy:(void *)bytes
+                                        length:length
+                                  freeWhenDone:NO];
+    return [NSJSONSerialization JSONObjectWithData:data options:0 error:error];
+}
+
 - (id)fixDoubleParsing:(id)value
     __attribute__((no_sanitize("float-cast-overflow"))) {
     if ([value isKindOfClass:[NSDecimalNumber class]]) {
@@ -951,7 +1141,19 @@ static NSString *trackedQueryKeysKey(NSUInteger trackedQueryId, NSString *key) {
     return value;
 }
 
-- (id)deserializePrimitive:(NSData *)data {
+- (id)deserializePrimitive:(const void *)bytes length:(NSUInteger)length {
+    if ([FBinaryValueCoder isEncodedValue:bytes length:length]) {
+        id result = [FBinaryValueCoder valueWithBytes:bytes length:length];
+        if (result == nil) {
+            FFWarn(@"I-RDB076037", @"Failed to load corrupted primitive");
+            return [NSNull null];
+        }
+        return result;
+    }
+    // Written as JSON by an older version, whose doubles need to be fixed up.
+    NSData *data = [NSData dataWithBytesNoCopy:(void *)bytes
+                                        length:length
+                                  freeWhenDone:NO];
     NSError *error = nil;
     id result =
         [NSJSONSerialization JSONObjectWithData:data
@@ -16,6 +16,7 @@
 
 #import "FirebaseDatabase/Sources/Persistence/FPersistenceManager.h"
 #import "FirebaseCore/Extension/FirebaseCoreInternal.h"
+#import "FirebaseDatabase/Sources/Api/Private/FIRDatabaseQuery_Private.h"
 #import "FirebaseDatabase/Sources/Core/View/FCacheNode.h"
 #import "FirebaseDatabase/Sources/FClock.h"
 #import "FirebaseDatabase/Sources/Persistence/FLevelDBStorageEngine.h"
@@ -31,9 +32,21 @@
 @property(nonatomic, strong) id<FCachePolicy> cachePolicy;
 @property(nonatomic, strong) FTrackedQueryManager *trackedQueryManager;
 @property(nonatomic) NSUInteger serverCacheUpdatesSinceLastPruneCheck;
+// The queries being pruned, and where in the cache pruning them continues.
+// Nil when no pruning round is running.
+@property(nonatomic, strong) FPruneForest *pruneForest;
+@property(nonatomic, strong) NSString *pruneCursor;
+@property(nonatomic, strong) NSDate *pruneStart;
+@property(nonatomic) BOOL pruneSliceScheduled;
 
 @end
 
+// Pruning visits at most this many cached leaves at a time...
+static const NSUInteger kFPruneKeysPerStep = 1000;
+// ...and yields the queue once it has run for this long, so that a large cache
+// is pruned in the background without stalling other work.
+static const NSTimeInterval kFPruneSliceDuration = 0.01;
+
 @implementation FPersistenceManager
 
 - (id)initWithStorageEngine:(id<FStorageEngine>)storageEngine
@@ -50,6 +63,7 @@
 }
 
 - (void)close {
+    self.pruneForest = nil;
     [self.storageEngine close];
     self.storageEngine = nil;
     self.trackedQueryManager = nil;
@@ -80,6 +94,7 @@
 }
 
 - (FCacheNode *)serverCacheForQuery:(FQuerySpec *)query {
+    [self finishPruningAffectingPath:query.path];
     NSSet *trackedKeys;
     BOOL complete;
     // TODO[offline]: Should we use trackedKeys to find out if this location is
@@ -117,6 +132,7 @@
 
 - (void)updateServerCacheWithNode:(id<FNode>)node forQuery:(FQuerySpec *)query {
     BOOL merge = !query.loadsAllData;
+    [self finishPruningAffectingPath:query.path];
     [self.storageEngine updateServerCache:node atPath:query.path merge:merge];
     [self setQueryComplete:query];
     [self doPruneCheckAfterServerUpdate];
@@ -124,6 +140,7 @@
 
 - (void)updateServerCacheWithMerge:(FCompoundWrite *)merge
                             atPath:(FPath *)path {
+    [self finishPruningAffectingPath:path];
     [self.storageEngine updateServerCacheWithMerge:merge atPath:path];
     [self doPruneCheckAfterServerUpdate];
 }
@@ -147,6 +164,7 @@
     // server resolved it to a different value).
     // TODO[offline]: Consider reworking.
     if (![self.trackedQueryManager hasActiveDefaultQueryAtPath:path]) {
+        [self finishPruningAffectingPath:path];
         [self.storageEngine updateServerCache:write atPath:path merge:NO];
         [self.trackedQueryManager ensureCompleteTrackedQueryAtPath:path];
     }
@@ -170,35 +188,96 @@
 
 - (void)doPruneCheckAfterServerUpdate {
     self.serverCacheUpdatesSinceLastPruneCheck++;
-    if ([self.cachePolicy
+    if (self.pruneForest == nil &&
+        [self.cachePolicy
             shouldCheckCacheSize:self.serverCacheUpdatesSinceLastPruneCheck]) {
         FFDebug(@"I-RDB078001", @"Reached prune check threshold. Checking...");
-        NSDate *date = [NSDate date];
+        self.pruneStart = [NSDate date];
         self.serverCacheUpdatesSinceLastPruneCheck = 0;
-        BOOL canPrune = YES;
-        NSUInteger cacheSize =
-            [self.storageEngine serverCacheEstimatedSizeInBytes];
-        FFDebug(@"I-RDB078002", @"Server cache size: %lu",
-                (unsigned long)cacheSize);
-        while (canPrune &&
-               [self.cachePolicy
-                   shouldPruneCacheWithSize:cacheSize
-                     numberOfTrackedQueries:self.trackedQueryManager
-                                                .numberOfPrunableQueries]) {
-            FPruneForest *pruneForest =
-                [self.trackedQueryManager pruneOldQueries:self.cachePolicy];
-            if (pruneForest.prunesAnything) {
-                [self.storageEngine pruneCache:pruneForest
-                                        atPath:[FPath empty]];
-            } else {
-                canPrune = NO;
-            }
-            cacheSize = [self.storageEngine serverCacheEstimatedSizeInBytes];
-            FFDebug(@"I-RDB078003", @"Cache size after pruning: %lu",
-                    (unsigned long)cacheSize);
+        if ([self pruneNextQueriesWithExactSize:YES]) {
+            [self schedulePruneSlice];
+        }
+    }
+}
+
+// Picks the queries to prune next if the cache is too large, and returns NO
+// (ending the pruning round) otherwise.
+- (BOOL)pruneNextQueriesWithExactSize:(BOOL)exactSize {
+    self.pruneForest = nil;
+    self.pruneCursor = nil;
+    NSUInteger cacheSize = [self.storageEngine serverCacheEstimatedSizeInBytes];
+    if (exactSize && [self shouldPruneCacheWithSize:cacheSize]) {
+        // The estimate can be too large, so confirm it before pruning. Pruning
+        // keeps it exact for the rest of the round.
+        cacheSize = [self.storageEngine serverCacheSizeInBytes];
+    }
+    FFDebug(@"I-RDB078002", @"Server cache size: %lu",
+            (unsigned long)cacheSize);
+    if ([self shouldPruneCacheWithSize:cacheSize]) {
+        FPruneForest *pruneForest =
+            [self.trackedQueryManager pruneOldQueries:self.cachePolicy];
+        if (pruneForest.prunesAnything) {
+            self.pruneForest = pruneForest;
+            return YES;
+        }
+    }
+    FFDebug(@"I-RDB078004", @"Pruning round took %fms",
+            [self.pruneStart timeIntervalSinceNow] * -1000);
+    return NO;
+}
+
+- (BOOL)shouldPruneCacheWithSize:(NSUInteger)cacheSize {
+    return [self.cachePolicy
+          shouldPruneCacheWithSize:cacheSize
+            numberOfTrackedQueries:self.trackedQueryManager
+                                       .numberOfPrunableQueries];
+}
+
+// Prunes the next keys of the cache, and reports whether the round goes on.
+- (BOOL)pruneStep {
+    self.pruneCursor = [self.storageEngine pruneCache:self.pruneForest
+                                               atPath:[FPath empty]
+                                           startingAt:self.pruneCursor
+                                              maxKeys:kFPruneKeysPerStep];
+    if (self.pruneCursor != nil) {
+        return YES;
+    }
+    FFDebug(
+        @"I-RDB078003", @"Cache size after pruning: %lu",
+        (unsigned long)[self.storageEngine serverCacheEstimatedSizeInBytes]);
+    return [self pruneNextQueriesWithExactSize:NO];
+}
+
+- (void)schedulePruneSlice {
+    if (self.pruneSliceScheduled) {
+        return;
+    }
+    self.pruneSliceScheduled = YES;
+    __weak FPersistenceManager *weakSelf = self;
+    dispatch_async([FIRDatabaseQuery sharedQueue], ^{
+      [weakSelf runPruneSlice];
+    });
+}
+
+- (void)runPruneSlice {
+    self.pruneSliceScheduled = NO;
+    NSDate *start = [NSDate date];
+    while (self.pruneForest != nil) {
+        if (![self pruneStep]) {
+            return;
+        }
+        if ([start timeIntervalSinceNow] * -1 >= kFPruneSliceDuration) {
+            [self schedulePruneSlice];
+            return;
         }
-        FFDebug(@"I-RDB078004", @"Pruning round took %fms",
-                [date timeIntervalSinceNow] * -1000);
+    }
+}
+
+// Pruning the cache at a path deletes whatever is cached there, so a pruning
+// round that may do so is finished before the cache at the path is used.
+- (void)finishPruningAffectingPath:(FPath *)path {
+    while (self.pruneForest != nil && [self.pruneForest affectsPath:path]) {
+        [self pruneStep];
     }
 }
 
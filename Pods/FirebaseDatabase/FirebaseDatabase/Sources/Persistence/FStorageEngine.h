@@ -43,9 +43,25 @@
                    atPath:(FPath *)path
                     merge:(BOOL)merge;
 - (void)updateServerCacheWithMerge:(FCompoundWrite *)merge atPath:(FPath *)path;
+/**
+ * Returns the size of the server cache without reading it. The estimate may
+ * be larger than the actual size, but never smaller.
+ */
 - (NSUInteger)serverCacheEstimatedSizeInBytes;
+/** Returns the exact size of the server cache, which reads all of it. */
+- (NSUInteger)serverCacheSizeInBytes;
 
 - (void)pruneCache:(FPruneForest *)pruneForest atPath:(FPath *)path;
+/**
+ * Prunes like pruneCache:atPath:, but visits at most maxKeys cached leaves,
+ * starting at the cursor returned by the previous call for the same forest
+ * (nil to start at the beginning). Returns the cursor to continue from, or nil
+ * once everything at the path has been visited.
+ */
+- (NSString *)pruneCache:(FPruneForest *)pruneForest
+                  atPath:(FPath *)path
+              startingAt:(NSString *)cursor
+                 maxKeys:(NSUInteger)maxKeys;
 
 - (NSArray *)loadTrackedQueries;
 - (void)removeTrackedQuery:(NSUInteger)queryId;
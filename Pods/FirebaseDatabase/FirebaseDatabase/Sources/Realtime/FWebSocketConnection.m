@@ -42,7 +42,7 @@ static NSString *const kUserAgentHeader = @"User-Agent";
 static NSString *const kGoogleAppIDHeader = @"X-Firebase-GMPID";
 
 @interface FWebSocketConnection () {
-    NSMutableString *frame;
+    NSMutableData *frame;
     BOOL everConnected;
     BOOL isClosed;
     NSTimer *keepAlive;
@@ -133,6 +133,8 @@ static NSString *const kGoogleAppIDHeader = @"X-Firebase-GMPID";
                                                       googleAppID:googleAppID
                                                      andUserAgent:userAgent];
         [self.webSocket setDelegateDispatchQueue:queue];
+        self.webSocket.enablesPerMessageDeflate = YES;
+        self.webSocket.deliversTextMessagesAsData = YES;
         self.webSocket.delegate = self;
 #endif // TARGET_OS_WATCH
     }
@@ -270,14 +272,22 @@ static NSString *const kGoogleAppIDHeader = @"X-Firebase-GMPID";
 
 - (void)handleNewFrameCount:(int)numFrames {
     self.totalFrames = numFrames;
-    frame = [[NSMutableString alloc] initWithString:@""];
+    frame = [[NSMutableData alloc] init];
     FFLog(@"I-RDB083006", @"(wsc:%@) handleNewFrameCount: %d",
           self.connectionId, self.totalFrames);
 }
 
-- (NSString *)extractFrameCount:(NSString *)message {
+- (NSData *)extractFrameCount:(NSData *)message {
     if ([message length] <= 4) {
-        int frameCount = [message intValue];
+        // Like -[NSString intValue], read the leading digits.
+        const char *bytes = message.bytes;
+        int frameCount = 0;
+        for (NSUInteger i = 0; i < message.length; i++) {
+            if (bytes[i] < '0' || bytes[i] > '9') {
+                break;
+            }
+            frameCount = frameCount * 10 + (bytes[i] - '0');
+        }
         if (frameCount > 0) {
             [self handleNewFrameCount:frameCount];
             return nil;
@@ -287,16 +297,21 @@ static NSString *const kGoogleAppIDHeader = @"X-Firebase-GMPID";
     return message;
 }
 
-- (void)appendFrame:(NSString *)message {
-    [frame appendString:message];
+- (void)appendFrame:(NSData *)message {
     self.totalFrames = self.totalFrames - 1;
 
     if (self.totalFrames == 0) {
+        // Unsegmented messages, the common case, are parsed without copying
+        // them into the frame buffer.
+        NSData *data = message;
+        if (frame.length > 0) {
+            [frame appendData:message];
+            data = frame;
+        }
         // Call delegate and pass an immutable version of the frame
-        NSDictionary *json = [NSJSONSerialization
-            JSONObjectWithData:[frame dataUsingEncoding:NSUTF8StringEncoding]
-                       options:kNilOptions
-                         error:nil];
+        NSDictionary *json = [NSJSONSerialization JSONObjectWithData:data
+                                                             options:kNilOptions
+                                                               error:nil];
         frame = nil;
         FFLog(@"I-RDB083007",
               @"(wsc:%@) handleIncomingFrame sending complete frame: %d",
@@ -305,21 +320,31 @@ static NSString *const kGoogleAppIDHeader = @"X-Firebase-GMPID";
         @autoreleasepool {
             [self.delegate onMessage:self withMessage:json];
         }
+    } else {
+        [frame appendData:message];
     }
 }
 
-- (void)handleIncomingFrame:(NSString *)message {
+- (void)handleIncomingFrame:(NSData *)message {
     [self resetKeepAlive];
     if (self.buffering) {
         [self appendFrame:message];
     } else {
-        NSString *remaining = [self extractFrameCount:message];
+        NSData *remaining = [self extractFrameCount:message];
         if (remaining) {
             [self appendFrame:remaining];
         }
     }
 }
 
+/** Returns the bytes of a text or binary message. */
++ (NSData *)dataFromMessage:(id)message {
+    if ([message isKindOfClass:[NSString class]]) {
+        return [message dataUsingEncoding:NSUTF8StringEncoding];
+    }
+    return message;
+}
+
 #pragma mark -
 #pragma mark URLSessionWebSocketDelegate watchOS implementation
 #if TARGET_OS_WATCH
@@ -350,7 +375,11 @@ static NSString *const kGoogleAppIDHeader = @"X-Firebase-GMPID";
       }
 
       if (message) {
-          [strongSelf handleIncomingFrame:message.string];
+          [strongSelf
+              handleIncomingFrame:
+                  message.type == NSURLSessionWebSocketMessageTypeData
+                      ? message.data
+                      : [[strongSelf class] dataFromMessage:message.string]];
       } else if (error && !strongSelf->isClosed) {
           FFWarn(@"I-RDB083020",
                  @"Error received from web socket, closing the connection. %@",
@@ -368,7 +397,7 @@ static NSString *const kGoogleAppIDHeader = @"X-Firebase-GMPID";
 #pragma mark SRWebSocketDelegate implementation
 
 - (void)webSocket:(FSRWebSocket *)webSocket didReceiveMessage:(id)message {
-    [self handleIncomingFrame:message];
+    [self handleIncomingFrame:[[self class] dataFromMessage:message]];
 }
 
 - (void)webSocket:(FSRWebSocket *)webSocket didFailWithError:(NSError *)error {
@@ -311,6 +311,13 @@
         return YES;
     } else {
         FChildrenNode *otherChildrenNode = other;
+        // The hash covers the priority and all values, so if both are known
+        // and match there is no need to walk the children. Differing hashes
+        // are not conclusive, since e.g. @YES and @1 hash differently.
+        if (self.lazyHash != nil &&
+            [self.lazyHash isEqualToString:otherChildrenNode.lazyHash]) {
+            return YES;
+        }
         if (![self.getPriority isEqual:other.getPriority]) {
             return NO;
         } else if (self.children.count == otherChildrenNode.children.count) {
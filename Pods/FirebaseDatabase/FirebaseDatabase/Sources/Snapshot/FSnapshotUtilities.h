@@ -45,5 +45,11 @@ typedef NS_ENUM(NSInteger, FDataHashVersion) {
                                    toString:(NSMutableString *)mutableString;
 
 + (NSUInteger)estimateSerializedNodeSize:(id<FNode>)node;
+/**
+ * Like estimateSerializedNodeSize:, but stops once the estimate exceeds the
+ * limit, returning a size that is only known to be larger than it.
+ */
++ (NSUInteger)estimateSerializedNodeSize:(id<FNode>)node
+                                   limit:(NSUInteger)limit;
 
 @end
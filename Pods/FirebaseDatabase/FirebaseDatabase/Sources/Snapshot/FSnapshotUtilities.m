@@ -371,6 +371,12 @@
 }
 
 + (NSUInteger)estimateSerializedNodeSize:(id<FNode>)node {
+    return [FSnapshotUtilities estimateSerializedNodeSize:node
+                                                    limit:NSUIntegerMax];
+}
+
++ (NSUInteger)estimateSerializedNodeSize:(id<FNode>)node
+                                   limit:(NSUInteger)limit {
     if ([node isEmpty]) {
         return 4; // null keyword
     } else if ([node isLeafNode]) {
@@ -385,7 +391,10 @@
           sum += key.length;
           sum +=
               4; // quotes around key and colon and (comma or closing bracket)
-          sum += [FSnapshotUtilities estimateSerializedNodeSize:child];
+          sum += [FSnapshotUtilities
+              estimateSerializedNodeSize:child
+                                   limit:sum < limit ? limit - sum : 0];
+          *stop = sum > limit;
         }];
         return sum;
     }
@@ -43,6 +43,14 @@ extern NSString *const FSRWebSocketErrorDomain;
 // It will be niluntil after the handshake completes.
 @property (nonatomic, readonly, copy) NSString *protocol;
 
+// Offer the permessage-deflate extension (RFC 7692) during the handshake, so
+// that the server may compress the messages it sends. Must be set before open.
+@property (nonatomic) BOOL enablesPerMessageDeflate;
+
+// Pass text messages to the delegate as their UTF-8 NSData rather than as
+// NSString, like binary ones. They are still validated as UTF-8.
+@property (nonatomic) BOOL deliversTextMessagesAsData;
+
 // Protocols should be an array of strings that turn into Sec-WebSocket-Protocol
 - (id)initWithURLRequest:(NSURLRequest *)request protocols:(NSArray *)protocols queue:(dispatch_queue_t)queue googleAppID:(NSString*)googleAppID andUserAgent:(NSString *)userAgent;
 - (id)initWithURLRequest:(NSURLRequest *)request protocols:(NSArray *)protocols;
@@ -36,6 +36,7 @@
 
 #import <CommonCrypto/CommonDigest.h>
 #import <Security/SecRandom.h>
+#import <zlib.h>
 #import "FirebaseDatabase/Sources/third_party/SocketRocket/fbase64.h"
 #import "FirebaseDatabase/Sources/third_party/SocketRocket/NSData+SRB64Additions.h"
 
@@ -210,6 +211,8 @@ typedef void (^data_callback)(FSRWebSocket *webSocket,  NSData *data);
 - (void)_sendFrameWithOpcode:(FSROpCode)opcode data:(id)data;
 
 - (BOOL)_checkHandshake:(CFHTTPMessageRef)httpMessage;
+- (BOOL)_negotiatePerMessageDeflate:(CFHTTPMessageRef)httpMessage;
+- (NSData *)_inflateMessage:(NSData *)data;
 - (void)_SR_commonInit;
 
 - (void)_initializeStreams;
@@ -281,12 +284,22 @@ typedef void (^data_callback)(FSRWebSocket *webSocket,  NSData *data);
 
     NSArray *_requestedProtocols;
     FSRIOConsumerPool *_consumerPool;
+
+    // Set once the server accepted permessage-deflate (RFC 7692).
+    BOOL _perMessageDeflate;
+    BOOL _currentMessageCompressed;
+    // Servers may compress each message with the window of the ones before
+    // it, so a single inflater is used for the whole connection.
+    z_stream _inflater;
+    BOOL _inflaterInitialized;
 }
 
 @synthesize delegate = _delegate;
 @synthesize url = _url;
 @synthesize readyState = _readyState;
 @synthesize protocol = _protocol;
+@synthesize enablesPerMessageDeflate = _enablesPerMessageDeflate;
+@synthesize deliversTextMessagesAsData = _deliversTextMessagesAsData;
 
 static __strong NSData *CRLFCRLF;
 
@@ -411,6 +424,11 @@ static __strong NSData *CRLFCRLF;
         sr_dispatch_release(_delegateDispatchQueue);
         _delegateDispatchQueue = NULL;
     }
+
+    if (_inflaterInitialized) {
+        inflateEnd(&_inflater);
+        _inflaterInitialized = NO;
+    }
 }
 
 #ifndef NDEBUG
@@ -473,6 +491,44 @@ static __strong NSData *CRLFCRLF;
     return [acceptHeader isEqualToString:expectedAccept];
 }
 
+// Messages are only ever sent uncompressed, which the extension allows, so
+// only the parameters for the direction from the server matter.
+- (BOOL)_negotiatePerMessageDeflate:(CFHTTPMessageRef)httpMessage;
+{
+    if (!_enablesPerMessageDeflate) {
+        return YES;
+    }
+
+    NSString *extensions = CFBridgingRelease(CFHTTPMessageCopyHeaderFieldValue(httpMessage, CFSTR("Sec-WebSocket-Extensions")));
+    NSCharacterSet *whitespace = [NSCharacterSet whitespaceCharacterSet];
+    for (NSString *extension in [extensions componentsSeparatedByString:@","]) {
+        NSArray *parameters = [extension componentsSeparatedByString:@";"];
+        NSString *name = [parameters[0] stringByTrimmingCharactersInSet:whitespace];
+        if (![name isEqualToString:@"permessage-deflate"]) {
+            continue;
+        }
+        // A smaller server_max_window_bits than the default of 15 needs no
+        // special handling, as the inflater window is always large enough.
+        for (NSUInteger i = 1; i < parameters.count; i++) {
+            NSString *parameter = [[parameters[i] componentsSeparatedByString:@"="][0] stringByTrimmingCharactersInSet:whitespace];
+            if (![parameter isEqualToString:@"server_no_context_takeover"] &&
+                ![parameter isEqualToString:@"client_no_context_takeover"] &&
+                ![parameter isEqualToString:@"server_max_window_bits"] &&
+                ![parameter isEqualToString:@"client_max_window_bits"]) {
+                return NO;
+            }
+        }
+        if (inflateInit2(&_inflater, -MAX_WBITS) != Z_OK) {
+            return NO;
+        }
+        _inflaterInitialized = YES;
+        _perMessageDeflate = YES;
+        SRFastLog(@"Negotiated permessage-deflate: %@", extension);
+        return YES;
+    }
+    return YES;
+}
+
 - (void)_HTTPHeadersDidFinish;
 {
     NSInteger responseCode = CFHTTPMessageGetResponseStatusCode(_receivedHTTPHeaders);
@@ -500,6 +556,11 @@ static __strong NSData *CRLFCRLF;
         _protocol = negotiatedProtocol;
     }
 
+    if (![self _negotiatePerMessageDeflate:_receivedHTTPHeaders]) {
+        [self _failWithError:[NSError errorWithDomain:FSRWebSocketErrorDomain code:2133 userInfo:[NSDictionary dictionaryWithObject:[NSString stringWithFormat:@"Server specified permessage-deflate parameters that can't be used"] forKey:NSLocalizedDescriptionKey]]];
+        return;
+    }
+
     self.readyState = SR_OPEN;
 
     if (!_didFail) {
@@ -568,6 +629,10 @@ static __strong NSData *CRLFCRLF;
         CFHTTPMessageSetHeaderFieldValue(request, CFSTR("Sec-WebSocket-Protocol"), (__bridge CFStringRef)[_requestedProtocols componentsJoinedByString:@", "]);
     }
 
+    if (_enablesPerMessageDeflate) {
+        CFHTTPMessageSetHeaderFieldValue(request, CFSTR("Sec-WebSocket-Extensions"), CFSTR("permessage-deflate"));
+    }
+
     [_urlRequest.allHTTPHeaderFields enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop) {
         CFHTTPMessageSetHeaderFieldValue(request, (__bridge CFStringRef)key, (__bridge CFStringRef)obj);
     }];
@@ -879,11 +944,59 @@ static inline BOOL closeCodeIsValid(int closeCode) {
     [self _pumpWriting];
 }
 
+- (NSData *)_inflateMessage:(NSData *)data;
+{
+    // Senders strip the empty stored block that ends each message.
+    static const uint8_t trailer[] = {0x00, 0x00, 0xff, 0xff};
+
+    NSMutableData *output = [[NSMutableData alloc] initWithLength:MAX(data.length * 4, 1024)];
+    size_t written = 0;
+    const Bytef *inputs[] = {data.bytes, trailer};
+    const size_t inputLengths[] = {data.length, sizeof(trailer)};
+    for (int i = 0; i < 2; i++) {
+        _inflater.next_in = (Bytef *)inputs[i];
+        _inflater.avail_in = (uInt)inputLengths[i];
+        do {
+            if (written == output.length) {
+                output.length *= 2;
+            }
+            _inflater.next_out = (Bytef *)output.mutableBytes + written;
+            _inflater.avail_out = (uInt)(output.length - written);
+            int result = inflate(&_inflater, Z_SYNC_FLUSH);
+            written = output.length - _inflater.avail_out;
+            if (result == Z_STREAM_END) {
+                // The message ended the deflate stream, so start a new one
+                // for the next message.
+                inflateReset(&_inflater);
+                output.length = written;
+                return output;
+            }
+            if (result == Z_BUF_ERROR && _inflater.avail_in == 0) {
+                // Everything buffered has been inflated.
+                break;
+            }
+            if (result != Z_OK) {
+                return nil;
+            }
+        } while (_inflater.avail_in > 0 || _inflater.avail_out == 0);
+    }
+    output.length = written;
+    return output;
+}
+
 - (void)_handleFrameWithData:(NSData *)frameData opCode:(NSInteger)opcode;
 {
     // Check that the current data is valid UTF8
 
     BOOL isControlFrame = (opcode == SROpCodePing || opcode == SROpCodePong || opcode == SROpCodeConnectionClose);
+    BOOL wasCompressed = !isControlFrame && _currentMessageCompressed;
+    if (wasCompressed) {
+        frameData = [self _inflateMessage:frameData];
+        if (frameData == nil) {
+            [self _closeWithProtocolError:@"Invalid compressed message"];
+            return;
+        }
+    }
     if (!isControlFrame) {
         [self _readFrameNew];
     } else {
@@ -894,6 +1007,22 @@ static inline BOOL closeCodeIsValid(int closeCode) {
 
     switch (opcode) {
         case SROpCodeTextFrame: {
+            if (_deliversTextMessagesAsData) {
+                // Uncompressed messages were validated while they were read,
+                // except for a truncated character at their end.
+                NSUInteger length = frameData.length;
+                BOOL valid = wasCompressed ? (length == 0 || validate_dispatch_data_partial_string(frameData) == (int32_t)length)
+                                           : _currentStringScanPosition == length;
+                if (!valid) {
+                    [self closeWithCode:SRStatusCodeInvalidUTF8 reason:@"Text frames must be valid UTF-8"];
+                    dispatch_async(_workQueue, ^{
+                        [self _disconnect];
+                    });
+                    return;
+                }
+                [self _handleMessage:[frameData copy]];
+                break;
+            }
             NSString *str = [[NSString alloc] initWithData:frameData encoding:NSUTF8StringEncoding];
             if (str == nil && frameData) {
                 [self closeWithCode:SRStatusCodeInvalidUTF8 reason:@"Text frames must be valid UTF-8"];
@@ -1004,6 +1133,7 @@ static inline BOOL closeCodeIsValid(int closeCode) {
 static const uint8_t SRFinMask          = 0x80;
 static const uint8_t SROpCodeMask       = 0x0F;
 static const uint8_t SRRsvMask          = 0x70;
+static const uint8_t SRRsv1Mask         = 0x40;
 static const uint8_t SRMaskMask         = 0x80;
 static const uint8_t SRPayloadLenMask   = 0x7F;
 
@@ -1018,15 +1148,20 @@ static const uint8_t SRPayloadLenMask   = 0x7F;
         const uint8_t *headerBuffer = data.bytes;
         assert(data.length >= 2);
 
-        if (headerBuffer[0] & SRRsvMask) {
-            [self _closeWithProtocolError:@"Server used RSV bits"];
-            return;
-        }
-
         uint8_t receivedOpcode = (SROpCodeMask & headerBuffer[0]);
 
         BOOL isControlFrame = (receivedOpcode == SROpCodePing || receivedOpcode == SROpCodePong || receivedOpcode == SROpCodeConnectionClose);
 
+        // With permessage-deflate, RSV1 marks the first frame of a compressed
+        // message.
+        uint8_t rsv = headerBuffer[0] & SRRsvMask;
+        BOOL isFirstDataFrame = !isControlFrame && receivedOpcode != 0;
+        BOOL compressed = self->_perMessageDeflate && isFirstDataFrame && rsv == SRRsv1Mask;
+        if (rsv && !compressed) {
+            [self _closeWithProtocolError:@"Server used RSV bits"];
+            return;
+        }
+
         if (!isControlFrame && receivedOpcode != 0 && self->_currentFrameCount > 0) {
             [self _closeWithProtocolError:@"all data frames after the initial data frame must have opcode 0"];
             return;
@@ -1038,6 +1173,9 @@ static const uint8_t SRPayloadLenMask   = 0x7F;
         }
 
         header.opcode = receivedOpcode == 0 ? self->_currentFrameOpcode : receivedOpcode;
+        if (isFirstDataFrame) {
+            self->_currentMessageCompressed = compressed;
+        }
 
         header.fin = !!(SRFinMask & headerBuffer[0]);
 
@@ -1101,6 +1239,7 @@ static const uint8_t SRPayloadLenMask   = 0x7F;
         self->_currentFrameCount = 0;
         self->_readOpCount = 0;
         self->_currentStringScanPosition = 0;
+        self->_currentMessageCompressed = NO;
 
         [self _readFrameContinue];
     });
@@ -1307,7 +1446,8 @@ static const char CRLFCRLFBytes[] = {'\r', '\n', '\r', '\n'};
 
             _readOpCount += 1;
 
-            if (_currentFrameOpcode == SROpCodeTextFrame) {
+            // Compressed text is validated once it has been inflated.
+            if (_currentFrameOpcode == SROpCodeTextFrame && !_currentMessageCompressed) {
                 // Validate UTF8 stuff.
                 size_t currentDataSize = _currentFrameData.length;
                 if (_currentFrameOpcode == SROpCodeTextFrame && currentDataSize > 0) {
@@ -55,6 +55,9 @@ extern NSString * const APLevelDBErrorDomain;
 - (void)enumerateKeysAndValuesAsData:(void (^)(NSString *key, NSData *value, BOOL *stop))block;
 - (void)enumerateKeysWithPrefix:(NSString *)prefix asData:(void (^)(NSString *key, NSData *value, BOOL *stop))block;
 
+// The bytes passed to the block are only valid until it returns.
+- (void)enumerateKeysWithPrefix:(NSString *)prefix asBytes:(void (^)(NSString *key, const void *bytes, NSUInteger length, BOOL *stop))block;
+
 - (NSUInteger)approximateSizeFrom:(NSString *)from to:(NSString *)to;
 - (NSUInteger)exactSizeFrom:(NSString *)from to:(NSString *)to;
 
@@ -88,6 +91,11 @@ extern NSString * const APLevelDBErrorDomain;
 - (NSString *)valueAsString;
 - (NSData *)valueAsData;
 
+// Returns the bytes of the current value without copying them, or NULL if the
+// iterator is not positioned on a key. They are only valid until the iterator
+// is moved.
+- (const void *)valueBytesWithLength:(NSUInteger *)length;
+
 @end
 
 
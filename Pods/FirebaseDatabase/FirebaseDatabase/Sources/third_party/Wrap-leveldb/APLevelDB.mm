@@ -141,6 +141,9 @@ NSString * const APLevelDBErrorDomain = @"APLevelDBErrorDomain";
 {
     leveldb::Options options;
     options.create_if_missing = true;
+    // The leveldb of older SDKs has no Snappy codec and could not read
+    // compressed blocks back after an app downgrade.
+    options.compression = leveldb::kNoCompression;
     return options;
 }
 
@@ -285,6 +288,28 @@ NSString * const APLevelDBErrorDomain = @"APLevelDBErrorDomain";
     }
 }
 
+- (void)enumerateKeysWithPrefix:(NSString *)prefixString asBytes:(void (^)(NSString *, const void *, NSUInteger, BOOL *))block
+{
+    @autoreleasepool {
+        BOOL stop = NO;
+        leveldb::Iterator* iter = _db->NewIterator(leveldb::ReadOptions());
+        leveldb::Slice prefix = SliceFromString(prefixString);
+        for (iter->Seek(prefix); iter->Valid(); iter->Next()) {
+            leveldb::Slice key = iter->key(), value = iter->value();
+            if (key.starts_with(prefix)) {
+                NSString *k = StringFromSlice(key);
+                block(k, value.data(), (NSUInteger)value.size(), &stop);
+                if (stop)
+                    break;
+            } else {
+                break;
+            }
+        }
+
+        delete iter;
+    }
+}
+
 - (NSUInteger)exactSizeFrom:(NSString *)from to:(NSString *)to {
     NSUInteger size = 0;
     leveldb::Iterator* iter = _db->NewIterator(leveldb::ReadOptions());
@@ -452,6 +477,15 @@ NSString * const APLevelDBErrorDomain = @"APLevelDBErrorDomain";
     return [NSData dataWithBytes:value.data() length:value.size()];
 }
 
+- (const void *)valueBytesWithLength:(NSUInteger *)length
+{
+    if (_iter->Valid() == false)
+        return NULL;
+    leveldb::Slice value = _iter->value();
+    *length = (NSUInteger)value.size();
+    return value.data();
+}
+
 @end
 
 
@@ -20,6 +20,8 @@
 #import "Firestore/Source/API/FIRAggregateQuerySnapshot+Internal.h"
 #import "Firestore/Source/API/FIRQuery+Internal.h"
 
+#include <utility>
+
 #include "Firestore/core/src/api/aggregate_query.h"
 #include "Firestore/core/src/util/error_apple.h"
 
@@ -76,14 +78,19 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)aggregationWithSource:(FIRAggregateSource)source
                    completion:(void (^)(FIRAggregateQuerySnapshot *_Nullable snapshot,
                                         NSError *_Nullable error))completion {
-  _aggregateQuery->GetAggregate([self, completion](const StatusOr<ObjectValue> &result) {
+  auto callback = [self, completion](const StatusOr<ObjectValue> &result) {
     if (result.ok()) {
       completion([[FIRAggregateQuerySnapshot alloc] initWithObject:result.ValueOrDie() query:self],
                  nil);
     } else {
       completion(nil, MakeNSError(result.status()));
     }
-  });
+  };
+  if (source == FIRAggregateSourceCache) {
+    _aggregateQuery->GetAggregateFromCache(std::move(callback));
+  } else {
+    _aggregateQuery->GetAggregate(std::move(callback));
+  }
 }
 
 @end
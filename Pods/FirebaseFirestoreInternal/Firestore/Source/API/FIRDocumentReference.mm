@@ -16,6 +16,7 @@
 
 #import "FIRDocumentReference+Internal.h"
 
+#include <chrono>  // NOLINT(build/c++11)
 #include <memory>
 #include <utility>
 
@@ -217,7 +218,9 @@ NS_ASSUME_NONNULL_BEGIN
 - (id<FIRListenerRegistration>)addSnapshotListenerWithOptions:(FIRSnapshotListenOptions *)options
                                                      listener:(FIRDocumentSnapshotBlock)listener {
   ListenOptions listenOptions =
-      ListenOptions::FromOptions(options.includeMetadataChanges, MakeListenSource(options.source));
+      ListenOptions::FromOptions(options.includeMetadataChanges, MakeListenSource(options.source))
+          .WithMinEventInterval(std::chrono::milliseconds(
+              static_cast<int64_t>(options.minimumEventInterval * 1000)));
   return [self addSnapshotListenerInternalWithOptions:listenOptions listener:listener];
 }
 
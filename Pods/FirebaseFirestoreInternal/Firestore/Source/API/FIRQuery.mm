@@ -16,6 +16,7 @@
 
 #import "FIRQuery.h"
 
+#include <chrono>  // NOLINT(build/c++11)
 #include <memory>
 #include <utility>
 #include <vector>
@@ -197,7 +198,9 @@ int32_t SaturatedLimitValue(NSInteger limit) {
 - (id<FIRListenerRegistration>)addSnapshotListenerWithOptions:(FIRSnapshotListenOptions *)options
                                                      listener:(FIRQuerySnapshotBlock)listener {
   ListenOptions listenOptions =
-      ListenOptions::FromOptions(options.includeMetadataChanges, MakeListenSource(options.source));
+      ListenOptions::FromOptions(options.includeMetadataChanges, MakeListenSource(options.source))
+          .WithMinEventInterval(std::chrono::milliseconds(
+              static_cast<int64_t>(options.minimumEventInterval * 1000)));
   return [self addSnapshotListenerInternalWithOptions:listenOptions listener:listener];
 }
 
@@ -26,11 +26,13 @@ NS_ASSUME_NONNULL_BEGIN
 @implementation FIRSnapshotListenOptions
 
 - (instancetype)initPrivate:(FIRListenSource)source
-     includeMetadataChanges:(BOOL)includeMetadataChanges {
+     includeMetadataChanges:(BOOL)includeMetadataChanges
+       minimumEventInterval:(NSTimeInterval)minimumEventInterval {
   self = [self init];
   if (self) {
     _source = source;
     _includeMetadataChanges = includeMetadataChanges;
+    _minimumEventInterval = minimumEventInterval;
   }
   return self;
 }
@@ -40,6 +42,7 @@ NS_ASSUME_NONNULL_BEGIN
   if (self) {
     _source = FIRListenSourceDefault;
     _includeMetadataChanges = NO;
+    _minimumEventInterval = 0;
   }
   return self;
 }
@@ -47,14 +50,24 @@ NS_ASSUME_NONNULL_BEGIN
 - (FIRSnapshotListenOptions *)optionsWithIncludeMetadataChanges:(BOOL)includeMetadataChanges {
   FIRSnapshotListenOptions *newOptions =
       [[FIRSnapshotListenOptions alloc] initPrivate:self.source
-                             includeMetadataChanges:includeMetadataChanges];
+                             includeMetadataChanges:includeMetadataChanges
+                               minimumEventInterval:self.minimumEventInterval];
   return newOptions;
 }
 
 - (FIRSnapshotListenOptions *)optionsWithSource:(FIRListenSource)source {
   FIRSnapshotListenOptions *newOptions =
       [[FIRSnapshotListenOptions alloc] initPrivate:source
-                             includeMetadataChanges:self.includeMetadataChanges];
+                             includeMetadataChanges:self.includeMetadataChanges
+                               minimumEventInterval:self.minimumEventInterval];
+  return newOptions;
+}
+
+- (FIRSnapshotListenOptions *)optionsWithMinimumEventInterval:(NSTimeInterval)minimumEventInterval {
+  FIRSnapshotListenOptions *newOptions =
+      [[FIRSnapshotListenOptions alloc] initPrivate:self.source
+                             includeMetadataChanges:self.includeMetadataChanges
+                               minimumEventInterval:minimumEventInterval];
   return newOptions;
 }
 
@@ -87,6 +87,7 @@ using firebase::firestore::model::NumericIncrementTransform;
 using firebase::firestore::model::ObjectValue;
 using firebase::firestore::model::ResourcePath;
 using firebase::firestore::model::ServerTimestampTransform;
+using firebase::firestore::model::TransformMap;
 using firebase::firestore::model::TransformOperation;
 using firebase::firestore::nanopb::CheckedSize;
 using firebase::firestore::nanopb::Message;
@@ -214,7 +215,9 @@ NS_ASSUME_NONNULL_BEGIN
 
   ParseAccumulator accumulator{UserDataSource::Update};
   __block ParseContext context = accumulator.RootContext();
-  __block ObjectValue updateData;
+  // Collect the fields and set them all at once, so that the data is built in
+  // a single pass rather than rebuilding its map for every key.
+  __block TransformMap fields;
 
   [dict enumerateKeysAndObjectsUsingBlock:^(id key, id value, BOOL *) {
     FieldPath path;
@@ -235,11 +238,13 @@ NS_ASSUME_NONNULL_BEGIN
       auto parsedValue = [self parseData:value context:context.ChildContext(path)];
       if (parsedValue) {
         context.AddToFieldMask(path);
-        updateData.Set(path, std::move(*parsedValue));
+        fields[std::move(path)] = std::move(*parsedValue);
       }
     }
   }];
 
+  ObjectValue updateData;
+  updateData.SetAll(std::move(fields));
   return std::move(accumulator).UpdateData(std::move(updateData));
 }
 
@@ -330,9 +335,10 @@ NS_ASSUME_NONNULL_BEGIN
 
     __block pb_size_t index = 0;
     [dict enumerateKeysAndObjectsUsingBlock:^(NSString *key, id value, BOOL *) {
-      auto parsedValue = [self parseData:value context:context.ChildContext(MakeString(key))];
+      std::string fieldName = MakeString(key);
+      auto parsedValue = [self parseData:value context:context.ChildContext(fieldName)];
       if (parsedValue) {
-        result->map_value.fields[index].key = nanopb::MakeBytesArray(MakeString(key));
+        result->map_value.fields[index].key = nanopb::MakeBytesArray(fieldName);
         result->map_value.fields[index].value = *parsedValue->release();
         ++index;
       }
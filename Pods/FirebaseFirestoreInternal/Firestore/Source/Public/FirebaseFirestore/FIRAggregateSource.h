@@ -37,6 +37,15 @@ typedef NS_ENUM(NSUInteger, FIRAggregateSource) {
    * offline.
    */
   FIRAggregateSourceServer,
+
+  /**
+   * Perform the aggregation on the documents in the local cache.
+   *
+   * The result takes local modifications not yet synchronized with the server into account, and
+   * is available while the client is offline. It only covers the documents that have been
+   * downloaded before, so it can differ from the result computed by the server.
+   */
+  FIRAggregateSourceCache,
 } NS_SWIFT_NAME(AggregateSource);
 
 NS_ASSUME_NONNULL_END
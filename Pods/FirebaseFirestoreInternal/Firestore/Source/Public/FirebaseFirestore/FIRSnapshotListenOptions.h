@@ -52,6 +52,12 @@ NS_SWIFT_NAME(SnapshotListenOptions)
 @property(nonatomic, readonly) FIRListenSource source;
 /** Indicates whether metadata-only changes should trigger snapshot events. */
 @property(nonatomic, readonly) BOOL includeMetadataChanges;
+/**
+ * The minimum time, in seconds, between two snapshot events after the first one. Changes that
+ * arrive sooner are merged into a single event. Zero, the default, raises an event for every
+ * change.
+ */
+@property(nonatomic, readonly) NSTimeInterval minimumEventInterval;
 
 /**
  * Creates and returns a new `SnapshotListenOptions` object with all properties initialized to their
@@ -79,6 +85,16 @@ NS_SWIFT_NAME(SnapshotListenOptions)
  */
 - (FIRSnapshotListenOptions *)optionsWithSource:(FIRListenSource)source;
 
+/**
+ * Creates and returns a new `SnapshotListenOptions` object with all properties of the current
+ * `SnapshotListenOptions` object plus the new property specifying the minimum time between two
+ * snapshot events. Use it for listeners on queries that change more often than they need to be
+ * rendered.
+ *
+ * @return The created `SnapshotListenOptions` object.
+ */
+- (FIRSnapshotListenOptions *)optionsWithMinimumEventInterval:(NSTimeInterval)minimumEventInterval;
+
 @end
 
 NS_ASSUME_NONNULL_END
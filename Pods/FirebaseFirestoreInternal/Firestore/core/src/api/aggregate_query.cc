@@ -48,6 +48,11 @@ void AggregateQuery::GetAggregate(AggregateQueryCallback&& callback) {
                                                   std::move(callback));
 }
 
+void AggregateQuery::GetAggregateFromCache(AggregateQueryCallback&& callback) {
+  query_.firestore()->client()->RunAggregateQueryFromLocalCache(
+      query_.query(), aggregates_, std::move(callback));
+}
+
 // TODO(b/280805906) Remove this count specific API after the c++ SDK migrates
 // to the new Aggregate API
 void AggregateQuery::Get(CountQueryCallback&& callback) {
@@ -39,6 +39,7 @@
 #include "Firestore/core/src/util/hashing.h"
 #include "Firestore/core/src/util/status.h"
 #include "Firestore/core/src/util/statusor.h"
+#include "Firestore/core/src/util/trace.h"
 
 namespace firebase {
 namespace firestore {
@@ -114,6 +115,7 @@ void DocumentReference::DeleteDocument(util::StatusCallback callback) {
 
 void DocumentReference::GetDocument(Source source,
                                     DocumentSnapshotListener&& callback) {
+  util::TraceScope trace_scope(util::OperationTrace::Start("GetDocument"));
   if (source == Source::Cache) {
     firestore_->client()->GetDocumentFromLocalCache(*this, std::move(callback));
     return;
@@ -258,7 +258,8 @@ void Firestore::EnsureClientConfigured() {
 
 DatabaseInfo Firestore::MakeDatabaseInfo() const {
   return DatabaseInfo(database_id_, persistence_key_, settings_.host(),
-                      settings_.ssl_enabled());
+                      settings_.ssl_enabled(), settings_.network_compression(),
+                      settings_.network_compression_threshold_bytes());
 }
 
 void Firestore::SetIndexConfiguration(const std::string& config,
@@ -309,14 +310,34 @@ void Firestore::SetIndexConfiguration(const std::string& config,
       }
     }
 
+    // Fields whose values the index entries store, so that reads of only
+    // these fields are answered from the index.
+    std::vector<FieldPath> stored_fields;
+    const auto& json_stored_fields =
+        reader.OptionalArray("storedFields", json_index, default_vector);
+    for (const auto& json_stored_field : json_stored_fields) {
+      if (!json_stored_field.is_string()) {
+        callback(Status(Error::kErrorInvalidArgument,
+                        "'storedFields' must be an array of field paths."));
+        return;
+      }
+      auto field_path =
+          FieldPath::FromServerFormat(json_stored_field.get<std::string>());
+      if (!field_path.ok()) {
+        callback(field_path.status());
+        return;
+      }
+      stored_fields.push_back(std::move(field_path).ValueOrDie());
+    }
+
     if (reader.status() != util::Status::OK()) {
       callback(reader.status());
       return;
     }
 
-    parsed_indexes.emplace_back(
-        FieldIndex(FieldIndex::UnknownId(), collection_group,
-                   std::move(segments), FieldIndex::InitialState()));
+    parsed_indexes.emplace_back(FieldIndex(
+        FieldIndex::UnknownId(), collection_group, std::move(segments),
+        FieldIndex::InitialState(), std::move(stored_fields)));
   }
 
   client_->ConfigureFieldIndexes(std::move(parsed_indexes));
@@ -38,6 +38,7 @@
 #include "Firestore/core/src/model/value_util.h"
 #include "Firestore/core/src/nanopb/nanopb_util.h"
 #include "Firestore/core/src/util/exception.h"
+#include "Firestore/core/src/util/trace.h"
 #include "absl/algorithm/container.h"
 #include "absl/strings/match.h"
 #include "absl/types/span.h"
@@ -118,6 +119,7 @@ size_t Query::Hash() const {
 
 void Query::GetDocuments(Source source, QuerySnapshotListener&& callback) {
   ValidateHasExplicitOrderByForLimitToLast();
+  util::TraceScope trace_scope(util::OperationTrace::Start("GetDocuments"));
   if (source == Source::Cache) {
     firestore_->client()->GetDocumentsFromLocalCache(*this,
                                                      std::move(callback));
@@ -31,12 +31,21 @@ constexpr bool Settings::DefaultSslEnabled;
 constexpr bool Settings::DefaultPersistenceEnabled;
 constexpr int64_t Settings::DefaultCacheSizeBytes;
 constexpr int64_t Settings::MinimumCacheSizeBytes;
+constexpr size_t Settings::DefaultNetworkCompressionThresholdBytes;
 
 Settings::Settings(const Settings& other)
     : host_(other.host_),
       ssl_enabled_(other.ssl_enabled_),
       persistence_enabled_(other.persistence_enabled_),
-      cache_size_bytes_(other.cache_size_bytes_) {
+      cache_size_bytes_(other.cache_size_bytes_),
+      persistence_profile_(other.persistence_profile_),
+      cache_snapshot_path_(other.cache_snapshot_path_),
+      network_compression_(other.network_compression_),
+      network_compression_threshold_bytes_(
+          other.network_compression_threshold_bytes_),
+      write_coalescing_enabled_(other.write_coalescing_enabled_),
+      last_results_persistence_enabled_(
+          other.last_results_persistence_enabled_) {
   if (other.cache_settings_ != nullptr) {
     cache_settings_ = CopyCacheSettings(*other.cache_settings_);
   }
@@ -51,6 +60,13 @@ Settings& Settings::operator=(const Settings& other) {
   ssl_enabled_ = other.ssl_enabled_;
   persistence_enabled_ = other.persistence_enabled_;
   cache_size_bytes_ = other.cache_size_bytes_;
+  persistence_profile_ = other.persistence_profile_;
+  cache_snapshot_path_ = other.cache_snapshot_path_;
+  network_compression_ = other.network_compression_;
+  network_compression_threshold_bytes_ =
+      other.network_compression_threshold_bytes_;
+  write_coalescing_enabled_ = other.write_coalescing_enabled_;
+  last_results_persistence_enabled_ = other.last_results_persistence_enabled_;
   if (other.cache_settings_ != nullptr) {
     cache_settings_ = CopyCacheSettings(*other.cache_settings_);
   }
@@ -115,13 +131,26 @@ MemoryCacheSettings MemoryCacheSettings::WithMemoryGarbageCollectorSettings(
 
 size_t Settings::Hash() const {
   return util::Hash(host_, ssl_enabled_, persistence_enabled_,
-                    cache_size_bytes_, cache_settings_);
+                    cache_size_bytes_, static_cast<int>(persistence_profile_),
+                    cache_snapshot_path_,
+                    static_cast<int>(network_compression_),
+                    network_compression_threshold_bytes_,
+                    write_coalescing_enabled_,
+                    last_results_persistence_enabled_, cache_settings_);
 }
 
 bool operator==(const Settings& lhs, const Settings& rhs) {
   bool eq = lhs.host_ == rhs.host_ && lhs.ssl_enabled_ == rhs.ssl_enabled_ &&
             lhs.persistence_enabled_ == rhs.persistence_enabled_ &&
-            lhs.cache_size_bytes_ == rhs.cache_size_bytes_;
+            lhs.cache_size_bytes_ == rhs.cache_size_bytes_ &&
+            lhs.persistence_profile_ == rhs.persistence_profile_ &&
+            lhs.cache_snapshot_path_ == rhs.cache_snapshot_path_ &&
+            lhs.network_compression_ == rhs.network_compression_ &&
+            lhs.network_compression_threshold_bytes_ ==
+                rhs.network_compression_threshold_bytes_ &&
+            lhs.write_coalescing_enabled_ == rhs.write_coalescing_enabled_ &&
+            lhs.last_results_persistence_enabled_ ==
+                rhs.last_results_persistence_enabled_;
   if (!eq) {
     return eq;
   }
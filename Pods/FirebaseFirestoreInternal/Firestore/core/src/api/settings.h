@@ -46,6 +46,38 @@ class Settings {
   static constexpr int64_t DefaultCacheSizeBytes = 100 * 1024 * 1024;
   static constexpr int64_t MinimumCacheSizeBytes = 1 * 1024 * 1024;
   static constexpr int64_t CacheSizeUnlimited = -1;
+  static constexpr size_t DefaultNetworkCompressionThresholdBytes = 1024;
+
+  /**
+   * Selects how the LevelDB instance backing persistence trades memory for
+   * read and write throughput. The block cache of every profile is sized
+   * from `cache_size_bytes()`.
+   */
+  enum class PersistenceProfile {
+    /** Balanced defaults suitable for most apps. */
+    kDefault,
+    /**
+     * Keeps the block cache, memtable and open tables small, for devices
+     * where the app is at risk of being terminated for memory use.
+     */
+    kLowMemoryDevice,
+    /**
+     * Gives a cache of many documents that is mostly read offline a larger
+     * block cache and larger tables, so that fewer of them must be opened.
+     */
+    kLargeOfflineCache,
+  };
+
+  /**
+   * The message encoding that the watch and write streams ask the backend to
+   * use. Responses are compressed by the backend with any encoding the client
+   * accepts; requests are compressed with the selected one.
+   */
+  enum class NetworkCompression {
+    kNone,
+    kGzip,
+    kDeflate,
+  };
 
   Settings() = default;
   Settings(const Settings& other);
@@ -73,8 +105,69 @@ class Settings {
 
   void set_cache_size_bytes(int64_t value);
   int64_t cache_size_bytes() const;
+
+  void set_persistence_profile(PersistenceProfile value) {
+    persistence_profile_ = value;
+  }
+  PersistenceProfile persistence_profile() const {
+    return persistence_profile_;
+  }
+
+  /**
+   * The path of a prebuilt cache snapshot, written by
+   * `LevelDbPersistence::ExportSnapshot()`, that an empty persistent cache is
+   * seeded from when it is opened. An empty path seeds nothing.
+   */
+  void set_cache_snapshot_path(const std::string& value) {
+    cache_snapshot_path_ = value;
+  }
+  const std::string& cache_snapshot_path() const {
+    return cache_snapshot_path_;
+  }
   bool gc_enabled() const;
 
+  void set_network_compression(NetworkCompression value) {
+    network_compression_ = value;
+  }
+  NetworkCompression network_compression() const {
+    return network_compression_;
+  }
+
+  /**
+   * Outgoing messages smaller than this are sent uncompressed, since their
+   * compressed form would save too little to be worth the CPU time.
+   */
+  void set_network_compression_threshold_bytes(size_t value) {
+    network_compression_threshold_bytes_ = value;
+  }
+  size_t network_compression_threshold_bytes() const {
+    return network_compression_threshold_bytes_;
+  }
+
+  /**
+   * Whether consecutive writes that are waiting to be uploaded are coalesced
+   * into a single write where that does not change their outcome, such as
+   * several updates of the same document. Off by default.
+   */
+  void set_write_coalescing_enabled(bool value) {
+    write_coalescing_enabled_ = value;
+  }
+  bool write_coalescing_enabled() const {
+    return write_coalescing_enabled_;
+  }
+
+  /**
+   * Whether the documents each listener last showed are remembered in the
+   * cache, in order, so that a listener of the same query shows them again
+   * straight away after a restart while its query runs. Off by default.
+   */
+  void set_last_results_persistence_enabled(bool value) {
+    last_results_persistence_enabled_ = value;
+  }
+  bool last_results_persistence_enabled() const {
+    return last_results_persistence_enabled_;
+  }
+
   const LocalCacheSettings* local_cache_settings() const;
   void set_local_cache_settings(const LocalCacheSettings& settings);
 
@@ -90,6 +183,13 @@ class Settings {
   bool ssl_enabled_ = DefaultSslEnabled;
   bool persistence_enabled_ = DefaultPersistenceEnabled;
   int64_t cache_size_bytes_ = DefaultCacheSizeBytes;
+  PersistenceProfile persistence_profile_ = PersistenceProfile::kDefault;
+  std::string cache_snapshot_path_;
+  NetworkCompression network_compression_ = NetworkCompression::kNone;
+  size_t network_compression_threshold_bytes_ =
+      DefaultNetworkCompressionThresholdBytes;
+  bool write_coalescing_enabled_ = false;
+  bool last_results_persistence_enabled_ = false;
   std::unique_ptr<LocalCacheSettings> cache_settings_ = nullptr;
 };
 
@@ -579,34 +579,52 @@ model::PipelineInputOutputVector LimitStage::Evaluate(
 model::PipelineInputOutputVector SortStage::Evaluate(
     const EvaluateContext& context,
     const model::PipelineInputOutputVector& inputs) const {
-  model::PipelineInputOutputVector input_copy = inputs;
-  std::sort(
-      input_copy.begin(), input_copy.end(),
-      [this, &context](const model::PipelineInputOutput& left,
-                       const model::PipelineInputOutput& right) -> bool {
-        for (const auto& ordering : this->orders_) {
-          const auto left_result =
-              ordering.expr()->ToEvaluable()->Evaluate(context, left);
-          const auto right_result =
-              ordering.expr()->ToEvaluable()->Evaluate(context, right);
-
-          auto left_val = left_result.IsErrorOrUnset() ? model::MinValue()
-                                                       : *left_result.value();
-          auto right_val = right_result.IsErrorOrUnset()
-                               ? model::MinValue()
-                               : *right_result.value();
-          const auto compare_result = model::Compare(left_val, right_val);
-          if (compare_result != util::ComparisonResult::Same) {
-            return ordering.direction() == Ordering::ASCENDING
-                       ? compare_result == util::ComparisonResult::Ascending
-                       : compare_result == util::ComparisonResult::Descending;
-          }
-        }
-
-        return false;
-      });
+  std::vector<std::unique_ptr<core::EvaluableExpr>> evaluables;
+  evaluables.reserve(orders_.size());
+  for (const auto& ordering : orders_) {
+    evaluables.push_back(ordering.expr()->ToEvaluable());
+  }
+
+  // Evaluate the sort keys of each document once, rather than on every
+  // comparison.
+  std::vector<std::vector<core::EvaluateResult>> keys(inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    keys[i].reserve(evaluables.size());
+    for (const auto& evaluable : evaluables) {
+      keys[i].push_back(evaluable->Evaluate(context, inputs[i]));
+    }
+  }
+
+  std::vector<size_t> order(inputs.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&](size_t left, size_t right) {
+    for (size_t i = 0; i < orders_.size(); ++i) {
+      const core::EvaluateResult& left_result = keys[left][i];
+      const core::EvaluateResult& right_result = keys[right][i];
+
+      const auto compare_result = model::Compare(
+          left_result.IsErrorOrUnset() ? model::MinValue()
+                                       : *left_result.value(),
+          right_result.IsErrorOrUnset() ? model::MinValue()
+                                        : *right_result.value());
+      if (compare_result != util::ComparisonResult::Same) {
+        return orders_[i].direction() == Ordering::ASCENDING
+                   ? compare_result == util::ComparisonResult::Ascending
+                   : compare_result == util::ComparisonResult::Descending;
+      }
+    }
+
+    return false;
+  });
 
-  return input_copy;
+  model::PipelineInputOutputVector results;
+  results.reserve(inputs.size());
+  for (size_t i : order) {
+    results.push_back(inputs[i]);
+  }
+  return results;
 }
 
 }  // namespace api
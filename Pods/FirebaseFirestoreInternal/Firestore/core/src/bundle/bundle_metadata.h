@@ -33,6 +33,17 @@ namespace bundle {
  */
 class BundleMetadata : public BundleElement {
  public:
+  /** How the elements that follow the metadata in a bundle are encoded. */
+  enum class ElementEncoding {
+    /** Length-prefixed JSON, the format of bundles built by the server SDKs. */
+    kJson,
+    /**
+     * Serialized `BundleElement` protos, each prefixed with its length as a
+     * varint (as written by `writeDelimitedTo`).
+     */
+    kProtobuf,
+  };
+
   BundleMetadata() = default;
 
   BundleMetadata(std::string bundle_id,
@@ -47,12 +58,14 @@ class BundleMetadata : public BundleElement {
                  int version,
                  model::SnapshotVersion create_time,
                  uint32_t total_documents,
-                 uint64_t total_bytes)
+                 uint64_t total_bytes,
+                 ElementEncoding element_encoding = ElementEncoding::kJson)
       : bundle_id_(std::move(bundle_id)),
         version_(version),
         create_time_(create_time),
         total_documents_(total_documents),
-        total_bytes_(total_bytes) {
+        total_bytes_(total_bytes),
+        element_encoding_(element_encoding) {
   }
 
   Type element_type() const override {
@@ -91,6 +104,14 @@ class BundleMetadata : public BundleElement {
     return total_bytes_;
   }
 
+  /**
+   * @return The encoding of the elements that follow the metadata. It is not
+   * persisted with the metadata.
+   */
+  ElementEncoding element_encoding() const {
+    return element_encoding_;
+  }
+
  private:
   std::string bundle_id_;
   uint32_t version_ = 0;
@@ -98,6 +119,7 @@ class BundleMetadata : public BundleElement {
 
   uint32_t total_documents_ = 0;
   uint64_t total_bytes_ = 0;
+  ElementEncoding element_encoding_ = ElementEncoding::kJson;
 };
 
 inline bool operator==(const BundleMetadata& lhs, const BundleMetadata& rhs) {
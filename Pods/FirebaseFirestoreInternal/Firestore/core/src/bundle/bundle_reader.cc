@@ -18,6 +18,8 @@
 
 #include <algorithm>
 
+#include "Firestore/core/src/util/background_queue.h"
+#include "Firestore/core/src/util/hard_assert.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/string_view.h"
@@ -27,11 +29,18 @@ namespace firestore {
 namespace bundle {
 
 using nlohmann::json;
+using util::BackgroundQueue;
 using util::ByteStream;
+using util::Executor;
 using util::StreamReadResult;
 
 namespace {
 
+// Parallel decoding frames elements until a batch has this many elements or
+// bytes, which bounds the memory held by decoded elements not yet returned.
+const size_t kMaxDecodeBatchElements = 256;
+const size_t kMaxDecodeBatchBytes = 4 * 1024 * 1024;
+
 json Parse(absl::string_view s) {
   return json::parse(s.begin(), s.end(), /*callback=*/nullptr,
                      /*allow_exceptions=*/false);
@@ -44,6 +53,16 @@ BundleReader::BundleReader(BundleSerializer serializer,
     : serializer_(std::move(serializer)), input_(std::move(input)) {
 }
 
+// Out of line because of the unique_ptr to Executor.
+BundleReader::~BundleReader() = default;
+
+void BundleReader::EnableParallelDecode(int threads) {
+  HARD_ASSERT(bytes_read_ == 0 && decoded_elements_.empty(),
+              "EnableParallelDecode must be called before reading elements");
+  decode_executor_ = Executor::CreateConcurrent(
+      "com.google.firebase.firestore.bundle", threads);
+}
+
 BundleMetadata BundleReader::GetBundleMetadata() {
   if (metadata_loaded_) {
     return metadata_;
@@ -64,38 +83,106 @@ std::unique_ptr<BundleElement> BundleReader::GetNextElement() {
   // Makes sure metadata is read before proceeding. The metadata element is the
   // first element in the bundle stream.
   GetBundleMetadata();
-  return ReadNextElement();
-}
+  if (!decode_executor_ || !reader_status_.ok()) {
+    return ReadNextElement();
+  }
 
-std::unique_ptr<BundleElement> BundleReader::ReadNextElement() {
-  auto length_prefix = ReadLengthPrefix();
-  if (!length_prefix.has_value()) {
+  if (decoded_elements_.empty()) {
+    DecodeNextBatch();
+  }
+  if (decoded_elements_.empty()) {
     return nullptr;
   }
 
-  size_t prefix_value = 0;
-  auto ok = absl::SimpleAtoi<size_t>(length_prefix.value(), &prefix_value);
-  if (!ok) {
-    Fail("Prefix string is not a valid number");
+  DecodedElement decoded = std::move(decoded_elements_.front());
+  decoded_elements_.pop_front();
+  reader_status_.Update(decoded.status);
+  if (!reader_status_.ok()) {
+    decoded_elements_.clear();
     return nullptr;
   }
+  bytes_read_ += decoded.size;
+  return std::move(decoded.element);
+}
 
-  buffer_.clear();
-  ReadJsonToBuffer(prefix_value);
-  if (!reader_status_.ok()) {
+std::unique_ptr<BundleElement> BundleReader::ReadNextElement() {
+  size_t size = ReadNextFrame();
+  if (size == 0) {
     return nullptr;
   }
 
   // metadata's size does not count in `bytes_read_`.
   if (metadata_loaded_) {
-    bytes_read_ += length_prefix.value().size() + buffer_.size();
+    bytes_read_ += size;
   }
-  auto result = DecodeBundleElementFromBuffer();
+  auto result = DecodeBundleElement(json_reader_, buffer_);
   reader_status_.Update(json_reader_.status());
 
   return result;
 }
 
+size_t BundleReader::ReadNextFrame() {
+  size_t prefix_size = 0;
+  size_t prefix_value = 0;
+  if (HasProtobufElements()) {
+    auto length_prefix = ReadVarintLengthPrefix(&prefix_size);
+    if (!length_prefix.has_value()) {
+      return 0;
+    }
+    prefix_value = length_prefix.value();
+  } else {
+    auto length_prefix = ReadLengthPrefix();
+    if (!length_prefix.has_value()) {
+      return 0;
+    }
+
+    auto ok = absl::SimpleAtoi<size_t>(length_prefix.value(), &prefix_value);
+    if (!ok) {
+      Fail("Prefix string is not a valid number");
+      return 0;
+    }
+    prefix_size = length_prefix.value().size();
+  }
+
+  buffer_.clear();
+  ReadElementToBuffer(prefix_value);
+  if (!reader_status_.ok()) {
+    return 0;
+  }
+
+  return prefix_size + buffer_.size();
+}
+
+void BundleReader::DecodeNextBatch() {
+  // Framing only scans the stream for the length prefixes, so it stays on
+  // this thread and keeps the elements in order; parsing the JSON of each
+  // element is what takes the time.
+  size_t batch_bytes = 0;
+  while (decoded_elements_.size() < kMaxDecodeBatchElements &&
+         batch_bytes < kMaxDecodeBatchBytes) {
+    size_t size = ReadNextFrame();
+    if (size == 0) {
+      break;
+    }
+    DecodedElement decoded;
+    decoded.data = std::move(buffer_);
+    decoded.size = size;
+    decoded_elements_.push_back(std::move(decoded));
+    batch_bytes += size;
+  }
+
+  BackgroundQueue tasks(decode_executor_.get());
+  for (DecodedElement& decoded : decoded_elements_) {
+    tasks.Execute([this, &decoded] {
+      util::JsonReader reader;
+      decoded.element = DecodeBundleElement(reader, decoded.data);
+      decoded.status = reader.status();
+      decoded.data = {};
+    });
+  }
+  tasks.AwaitAll();
+}
+
 absl::optional<std::string> BundleReader::ReadLengthPrefix() {
   // length string of size 16 indicates an element about 1PB, which is
   // impossible for valid bundles.
@@ -114,14 +201,48 @@ absl::optional<std::string> BundleReader::ReadLengthPrefix() {
   return absl::make_optional(std::move(result).ValueOrDie());
 }
 
-void BundleReader::ReadJsonToBuffer(size_t required_size) {
+absl::optional<size_t> BundleReader::ReadVarintLengthPrefix(
+    size_t* prefix_size) {
+  uint64_t value = 0;
+  // The prefix is at most 10 bytes, so reading it a byte at a time costs
+  // little next to reading the element.
+  for (int shift = 0; shift < 64; shift += 7) {
+    StreamReadResult result = input_->Read(1);
+    if (!result.ok()) {
+      reader_status_.Update(result.status());
+      return absl::nullopt;
+    }
+    const std::string& byte = result.ValueOrDie();
+    if (byte.empty()) {
+      // The stream may only end between elements.
+      if (shift > 0) {
+        Fail("Bundle ended in the middle of an element length prefix");
+      }
+      return absl::nullopt;
+    }
+
+    *prefix_size += 1;
+    auto bits = static_cast<uint8_t>(byte[0]);
+    value |= static_cast<uint64_t>(bits & 0x7f) << shift;
+    if ((bits & 0x80) == 0) {
+      return static_cast<size_t>(value);
+    }
+  }
+
+  Fail("Element length prefix is not a valid varint");
+  return absl::nullopt;
+}
+
+void BundleReader::ReadElementToBuffer(size_t required_size) {
   if (!reader_status_.ok()) {
     return;
   }
   while (buffer_.size() < required_size) {
-    // Read at most 1024 bytes every time, to avoid allocating a huge buffer
-    // when corruption leads to large `required_size`.
-    auto size = std::min<size_t>(1024ul, required_size - buffer_.size());
+    // Read at most as much as has been read so far (and at least 1024 bytes)
+    // every time, to avoid allocating a huge buffer when corruption leads to
+    // large `required_size`, while reading large elements in few steps.
+    auto size = std::min<size_t>(std::max<size_t>(1024ul, buffer_.size()),
+                                 required_size - buffer_.size());
     StreamReadResult result = input_->Read(size);
     if (!result.ok()) {
       reader_status_.Update(result.status());
@@ -139,29 +260,33 @@ void BundleReader::ReadJsonToBuffer(size_t required_size) {
   }
 }
 
-std::unique_ptr<BundleElement> BundleReader::DecodeBundleElementFromBuffer() {
-  auto json_object = Parse(buffer_);
+std::unique_ptr<BundleElement> BundleReader::DecodeBundleElement(
+    util::JsonReader& reader, absl::string_view data) const {
+  if (HasProtobufElements()) {
+    return serializer_.DecodeBundleElement(&reader, data);
+  }
+
+  auto json_object = Parse(data);
   if (json_object.is_discarded()) {
-    Fail("Failed to parse string into json");
+    reader.Fail("Failed to parse string into json");
     return nullptr;
   }
 
   if (json_object.contains("metadata")) {
     return absl::make_unique<BundleMetadata>(serializer_.DecodeBundleMetadata(
-        json_reader_, json_object.at("metadata")));
+        reader, json_object.at("metadata")));
   } else if (json_object.contains("namedQuery")) {
-    auto q = serializer_.DecodeNamedQuery(json_reader_,
-                                          json_object.at("namedQuery"));
+    auto q = serializer_.DecodeNamedQuery(reader, json_object.at("namedQuery"));
     return absl::make_unique<NamedQuery>(std::move(q));
   } else if (json_object.contains("documentMetadata")) {
     return absl::make_unique<BundledDocumentMetadata>(
-        serializer_.DecodeDocumentMetadata(json_reader_,
+        serializer_.DecodeDocumentMetadata(reader,
                                            json_object.at("documentMetadata")));
   } else if (json_object.contains("document")) {
     return absl::make_unique<BundleDocument>(
-        serializer_.DecodeDocument(json_reader_, json_object.at("document")));
+        serializer_.DecodeDocument(reader, json_object.at("document")));
   } else {
-    Fail("Unrecognized BundleElement");
+    reader.Fail("Unrecognized BundleElement");
     return nullptr;
   }
 }
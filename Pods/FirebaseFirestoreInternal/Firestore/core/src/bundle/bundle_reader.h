@@ -17,6 +17,7 @@
 #define FIRESTORE_CORE_SRC_BUNDLE_BUNDLE_READER_H_
 
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <string>
 #include <utility>
@@ -24,7 +25,9 @@
 #include "Firestore/core/src/bundle/bundle_metadata.h"
 #include "Firestore/core/src/bundle/bundle_serializer.h"
 #include "Firestore/core/src/util/byte_stream.h"
+#include "Firestore/core/src/util/executor.h"
 #include "Firestore/core/src/util/json_reader.h"
+#include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
 
 namespace firebase {
@@ -36,12 +39,28 @@ namespace bundle {
  *
  * The class takes a bundle stream and presents abstractions to read bundled
  * elements out of the underlying content.
+ *
+ * The metadata element is always JSON. If it declares the `PROTOBUF` element
+ * encoding, the elements that follow are read as varint-prefixed
+ * `BundleElement` protos instead.
  */
 class BundleReader {
  public:
   BundleReader(BundleSerializer serializer,
                std::unique_ptr<util::ByteStream> input);
 
+  ~BundleReader();
+
+  /**
+   * Makes the reader decode elements on `threads` background threads.
+   *
+   * The reader then frames a batch of elements from the stream at a time and
+   * decodes the batch in parallel, while `GetNextElement` still returns the
+   * elements in bundle order. Must be called before the first element is
+   * read.
+   */
+  void EnableParallelDecode(int threads);
+
   /**
    * Returns the metadata element from the bundle.
    *
@@ -70,7 +89,10 @@ class BundleReader {
     reader_status_.Update(util::Status(Error::kErrorDataLoss, std::move(msg)));
   }
 
-  /** How many bytes have we read from the bundle. */
+  /**
+   * How many bytes of the elements returned by `GetNextElement` have been read
+   * from the bundle.
+   */
   int64_t bytes_read() const {
     return bytes_read_;
   }
@@ -88,6 +110,18 @@ class BundleReader {
    */
   std::unique_ptr<BundleElement> ReadNextElement();
 
+  /**
+   * Reads the next complete element into `buffer_`, and returns the number of
+   * bytes it takes in the bundle, or 0 at the end of the stream or on error.
+   */
+  size_t ReadNextFrame();
+
+  /**
+   * Frames up to a batch of elements from the stream, and decodes them on
+   * `decode_executor_` into `decoded_elements_`.
+   */
+  void DecodeNextBatch();
+
   /**
    * Reads the length prefix string from bundle stream. Returns `nullopt` when
    * at the end of stream.
@@ -98,18 +132,42 @@ class BundleReader {
    */
   absl::optional<std::string> ReadLengthPrefix();
 
+  /**
+   * Reads the varint length prefix of a protobuf element, and adds the number
+   * of bytes it takes to `prefix_size`. Returns `nullopt` when at the end of
+   * stream or on error.
+   */
+  absl::optional<size_t> ReadVarintLengthPrefix(size_t* prefix_size);
+
+  /** Whether the elements after the metadata are protobuf encoded. */
+  bool HasProtobufElements() const {
+    return metadata_loaded_ && metadata_.element_encoding() ==
+                                   BundleMetadata::ElementEncoding::kProtobuf;
+  }
+
   /**
    * Reads `required_size` number of chars from stream into internal `buffer_`.
    */
-  void ReadJsonToBuffer(size_t required_size);
+  void ReadElementToBuffer(size_t required_size);
 
   /**
-   * Decodes internal `buffer_` into a `BundleElement`, returned as a unique_ptr
-   * pointing to the element. Returns nullptr if fails.
+   * Decodes `data`, in the encoding of elements that follow the metadata once
+   * it has been read, into a `BundleElement`, returned as a unique_ptr pointing
+   * to the element. Returns nullptr and fails `reader` if decoding fails.
    *
-   * Note this method will leave `buffer_` unchanged.
+   * Only reads the state of this instance, and is called concurrently when
+   * decoding in parallel.
    */
-  std::unique_ptr<BundleElement> DecodeBundleElementFromBuffer();
+  std::unique_ptr<BundleElement> DecodeBundleElement(
+      util::JsonReader& reader, absl::string_view data) const;
+
+  /** An element decoded ahead of being returned by `GetNextElement`. */
+  struct DecodedElement {
+    std::string data;
+    size_t size = 0;
+    std::unique_ptr<BundleElement> element;
+    util::Status status;
+  };
 
   BundleSerializer serializer_;
   util::JsonReader json_reader_;
@@ -126,6 +184,11 @@ class BundleReader {
 
   util::Status reader_status_;
   int64_t bytes_read_ = 0;
+
+  // Set when decoding in parallel; `decoded_elements_` holds the rest of the
+  // batch decoded last.
+  std::unique_ptr<util::Executor> decode_executor_;
+  std::deque<DecodedElement> decoded_elements_;
 };
 
 }  // namespace bundle
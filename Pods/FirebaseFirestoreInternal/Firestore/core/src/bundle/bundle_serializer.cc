@@ -33,11 +33,13 @@
 #include "Firestore/core/src/nanopb/byte_string.h"
 #include "Firestore/core/src/nanopb/message.h"
 #include "Firestore/core/src/nanopb/nanopb_util.h"
+#include "Firestore/core/src/nanopb/reader.h"
 #include "Firestore/core/src/timestamp_internal.h"
 #include "Firestore/core/src/util/no_destructor.h"
 #include "Firestore/core/src/util/statusor.h"
 #include "Firestore/core/src/util/string_format.h"
 #include "Firestore/core/src/util/string_util.h"
+#include "absl/memory/memory.h"
 #include "absl/strings/escaping.h"
 #include "absl/strings/numbers.h"
 #include "absl/time/time.h"
@@ -70,8 +72,10 @@ using nanopb::MakeSharedMessage;
 using nanopb::Message;
 using nanopb::SetRepeatedField;
 using nanopb::SharedMessage;
+using nanopb::StringReader;
 using nlohmann::json;
 using util::JsonReader;
+using util::ReadContext;
 using util::NoDestructor;
 using util::StatusOr;
 using util::StringFormat;
@@ -321,13 +325,23 @@ pb_bytes_array_t* DecodeBytesValue(JsonReader& reader,
 
 BundleMetadata BundleSerializer::DecodeBundleMetadata(
     JsonReader& reader, const json& metadata) const {
+  auto element_encoding = BundleMetadata::ElementEncoding::kJson;
+  const std::string& encoding =
+      reader.OptionalString("elementEncoding", metadata, "JSON");
+  if (encoding == "PROTOBUF") {
+    element_encoding = BundleMetadata::ElementEncoding::kProtobuf;
+  } else if (encoding != "JSON") {
+    reader.Fail("Unsupported bundle element encoding '%s'", encoding);
+  }
+
   return BundleMetadata(
       reader.RequiredString("id", metadata),
       reader.RequiredInt<uint32_t>("version", metadata),
       DecodeSnapshotVersion(reader,
                             reader.RequiredObject("createTime", metadata)),
       reader.OptionalInt<uint32_t>("totalDocuments", metadata, 0),
-      reader.OptionalInt<uint64_t>("totalBytes", metadata, 0));
+      reader.OptionalInt<uint64_t>("totalBytes", metadata, 0),
+      element_encoding);
 }
 
 NamedQuery BundleSerializer::DecodeNamedQuery(JsonReader& reader,
@@ -690,6 +704,120 @@ BundleDocument BundleSerializer::DecodeDocument(JsonReader& reader,
       ObjectValue::FromMapValue(std::move(map_value))));
 }
 
+std::unique_ptr<BundleElement> BundleSerializer::DecodeBundleElement(
+    ReadContext* context, absl::string_view bytes) const {
+  StringReader reader{bytes};
+  auto element = Message<firestore_BundleElement>::TryParse(&reader);
+  if (!reader.ok()) {
+    context->Fail(StringFormat("Failed to parse bundle element: %s",
+                               reader.status().error_message()));
+    return nullptr;
+  }
+
+  switch (element->which_element_type) {
+    case firestore_BundleElement_metadata_tag:
+      return absl::make_unique<BundleMetadata>(
+          DecodeBundleMetadata(context, element->metadata));
+    case firestore_BundleElement_named_query_tag:
+      return absl::make_unique<NamedQuery>(
+          DecodeNamedQuery(context, element->named_query));
+    case firestore_BundleElement_document_metadata_tag:
+      return absl::make_unique<BundledDocumentMetadata>(
+          DecodeDocumentMetadata(context, element->document_metadata));
+    case firestore_BundleElement_document_tag:
+      return absl::make_unique<BundleDocument>(
+          DecodeDocument(context, element->document));
+    default:
+      context->Fail("Unrecognized BundleElement");
+      return nullptr;
+  }
+}
+
+BundleMetadata BundleSerializer::DecodeBundleMetadata(
+    ReadContext* context, const firestore_BundleMetadata& metadata) const {
+  return BundleMetadata(
+      remote::Serializer::DecodeString(metadata.id), metadata.version,
+      remote::Serializer::DecodeVersion(context, metadata.create_time),
+      metadata.total_documents, metadata.total_bytes,
+      BundleMetadata::ElementEncoding::kProtobuf);
+}
+
+NamedQuery BundleSerializer::DecodeNamedQuery(
+    ReadContext* context, firestore_NamedQuery& named_query) const {
+  return NamedQuery(
+      remote::Serializer::DecodeString(named_query.name),
+      DecodeBundledQuery(context, named_query.bundled_query),
+      remote::Serializer::DecodeVersion(context, named_query.read_time));
+}
+
+BundledQuery BundleSerializer::DecodeBundledQuery(
+    ReadContext* context, firestore_BundledQuery& query) const {
+  // The QueryTarget oneof only has a single valid value.
+  if (query.which_query_type != firestore_BundledQuery_structured_query_tag) {
+    context->Fail(
+        StringFormat("Unknown bundled query_type: %s", query.which_query_type));
+    return {};
+  }
+  // Matches the checks of `VerifyStructuredQuery` for JSON bundles.
+  const google_firestore_v1_StructuredQuery& structured_query =
+      query.structured_query;
+  if (structured_query.select.fields_count > 0) {
+    context->Fail(
+        "Queries with 'select' statements are not supported in bundles");
+    return {};
+  }
+  if (structured_query.from_count == 0) {
+    context->Fail("Query does not have a 'from' collection");
+    return {};
+  }
+  if (structured_query.offset != 0) {
+    context->Fail("Queries with 'offset' are not supported in bundles");
+    return {};
+  }
+
+  LimitType limit_type =
+      query.limit_type == firestore_BundledQuery_LimitType_LAST
+          ? LimitType::Last
+          : LimitType::First;
+  return BundledQuery(rpc_serializer_.DecodeStructuredQuery(
+                          context, query.parent, query.structured_query),
+                      limit_type);
+}
+
+BundledDocumentMetadata BundleSerializer::DecodeDocumentMetadata(
+    ReadContext* context,
+    const firestore_BundledDocumentMetadata& document_metadata) const {
+  DocumentKey key = rpc_serializer_.DecodeKey(context, document_metadata.name);
+  SnapshotVersion read_time =
+      remote::Serializer::DecodeVersion(context, document_metadata.read_time);
+
+  std::vector<std::string> queries;
+  queries.reserve(document_metadata.queries_count);
+  for (pb_size_t i = 0; i < document_metadata.queries_count; ++i) {
+    queries.push_back(
+        remote::Serializer::DecodeString(document_metadata.queries[i]));
+  }
+
+  return BundledDocumentMetadata(std::move(key), read_time,
+                                 document_metadata.exists, std::move(queries));
+}
+
+BundleDocument BundleSerializer::DecodeDocument(
+    ReadContext* context, google_firestore_v1_Document& document) const {
+  DocumentKey key = rpc_serializer_.DecodeKey(context, document.name);
+  SnapshotVersion update_time =
+      remote::Serializer::DecodeVersion(context, document.update_time);
+  if (!context->ok()) {
+    return {};
+  }
+
+  // Takes ownership of the fields, so that they are not freed with the
+  // element proto.
+  return BundleDocument(MutableDocument::FoundDocument(
+      std::move(key), update_time,
+      ObjectValue::FromFieldsEntry(document.fields, document.fields_count)));
+}
+
 }  // namespace bundle
 }  // namespace firestore
 }  // namespace firebase
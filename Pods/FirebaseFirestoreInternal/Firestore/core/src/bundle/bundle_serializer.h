@@ -17,10 +17,12 @@
 #ifndef FIRESTORE_CORE_SRC_BUNDLE_BUNDLE_SERIALIZER_H_
 #define FIRESTORE_CORE_SRC_BUNDLE_BUNDLE_SERIALIZER_H_
 
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "Firestore/Protos/nanopb/firestore/bundle.nanopb.h"
 #include "Firestore/core/src/bundle/bundle_document.h"
 #include "Firestore/core/src/bundle/bundle_metadata.h"
 #include "Firestore/core/src/bundle/bundled_document_metadata.h"
@@ -34,13 +36,17 @@
 #include "Firestore/core/src/util/json_reader.h"
 #include "Firestore/core/src/util/read_context.h"
 #include "Firestore/third_party/nlohmann_json/json.hpp"
+#include "absl/strings/string_view.h"
 
 namespace firebase {
 namespace firestore {
 
 namespace bundle {
 
-/** A JSON serializer to deserialize Firestore Bundles. */
+/**
+ * A serializer to deserialize Firestore Bundles, from either their JSON or
+ * their binary protobuf encoding.
+ */
 class BundleSerializer {
  public:
   explicit BundleSerializer(remote::Serializer serializer)
@@ -58,7 +64,27 @@ class BundleSerializer {
   BundleDocument DecodeDocument(util::JsonReader& reader,
                                 const nlohmann::json& document) const;
 
+  /**
+   * Decodes a serialized `BundleElement` proto. Returns nullptr and fails
+   * `context` if the bytes are not a valid element.
+   */
+  std::unique_ptr<BundleElement> DecodeBundleElement(
+      util::ReadContext* context, absl::string_view bytes) const;
+
  private:
+  BundleMetadata DecodeBundleMetadata(
+      util::ReadContext* context,
+      const firestore_BundleMetadata& metadata) const;
+  NamedQuery DecodeNamedQuery(util::ReadContext* context,
+                              firestore_NamedQuery& named_query) const;
+  BundledQuery DecodeBundledQuery(util::ReadContext* context,
+                                  firestore_BundledQuery& query) const;
+  BundledDocumentMetadata DecodeDocumentMetadata(
+      util::ReadContext* context,
+      const firestore_BundledDocumentMetadata& document_metadata) const;
+  BundleDocument DecodeDocument(util::ReadContext* context,
+                                google_firestore_v1_Document& document) const;
+
   BundledQuery DecodeBundledQuery(util::JsonReader& reader,
                                   const nlohmann::json& query) const;
   std::vector<core::Filter> DecodeWhere(util::JsonReader& reader,
@@ -55,7 +55,8 @@ ArrayContainsFilter::ArrayContainsFilter(
 }
 
 bool ArrayContainsFilter::Rep::Matches(const Document& doc) const {
-  absl::optional<google_firestore_v1_Value> maybe_lhs = doc->field(field());
+  absl::optional<google_firestore_v1_Value> maybe_lhs =
+      doc->field(field_accessor());
   if (!maybe_lhs) return false;
 
   const google_firestore_v1_Value& lhs = *maybe_lhs;
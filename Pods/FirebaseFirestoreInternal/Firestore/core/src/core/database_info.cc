@@ -22,14 +22,20 @@ namespace firebase {
 namespace firestore {
 namespace core {
 
-DatabaseInfo::DatabaseInfo(model::DatabaseId database_id,
-                           std::string persistence_key,
-                           std::string host,
-                           bool ssl_enabled)
+DatabaseInfo::DatabaseInfo(
+    model::DatabaseId database_id,
+    std::string persistence_key,
+    std::string host,
+    bool ssl_enabled,
+    api::Settings::NetworkCompression network_compression,
+    size_t network_compression_threshold_bytes)
     : database_id_{std::move(database_id)},
       persistence_key_{std::move(persistence_key)},
       host_{std::move(host)},
-      ssl_enabled_{ssl_enabled} {
+      ssl_enabled_{ssl_enabled},
+      network_compression_{network_compression},
+      network_compression_threshold_bytes_{
+          network_compression_threshold_bytes} {
 }
 
 }  // namespace core
@@ -17,8 +17,10 @@
 #ifndef FIRESTORE_CORE_SRC_CORE_DATABASE_INFO_H_
 #define FIRESTORE_CORE_SRC_CORE_DATABASE_INFO_H_
 
+#include <cstddef>
 #include <string>
 
+#include "Firestore/core/src/api/settings.h"
 #include "Firestore/core/src/model/database_id.h"
 
 namespace firebase {
@@ -36,11 +38,19 @@ class DatabaseInfo {
    *        storage. Usually derived from -[FIRApp appName].
    * @param host The hostname of the Firestore backend.
    * @param ssl_enabled Whether to use SSL when connecting.
+   * @param network_compression The encoding of messages on the watch and write
+   *        streams.
+   * @param network_compression_threshold_bytes The size under which outgoing
+   *        messages are sent uncompressed.
    */
   DatabaseInfo(model::DatabaseId database_id,
                std::string persistence_key,
                std::string host,
-               bool ssl_enabled);
+               bool ssl_enabled,
+               api::Settings::NetworkCompression network_compression =
+                   api::Settings::NetworkCompression::kNone,
+               size_t network_compression_threshold_bytes =
+                   api::Settings::DefaultNetworkCompressionThresholdBytes);
 
   DatabaseInfo() = default;
 
@@ -60,11 +70,23 @@ class DatabaseInfo {
     return ssl_enabled_;
   }
 
+  api::Settings::NetworkCompression network_compression() const {
+    return network_compression_;
+  }
+
+  size_t network_compression_threshold_bytes() const {
+    return network_compression_threshold_bytes_;
+  }
+
  private:
   model::DatabaseId database_id_;
   std::string persistence_key_;
   std::string host_;
   bool ssl_enabled_ = false;
+  api::Settings::NetworkCompression network_compression_ =
+      api::Settings::NetworkCompression::kNone;
+  size_t network_compression_threshold_bytes_ =
+      api::Settings::DefaultNetworkCompressionThresholdBytes;
 };
 
 }  // namespace core
@@ -29,8 +29,10 @@ namespace core {
 
 using util::Empty;
 
-EventManager::EventManager(QueryEventSource* query_event_source)
-    : query_event_source_(query_event_source) {
+EventManager::EventManager(QueryEventSource* query_event_source,
+                           std::shared_ptr<util::AsyncQueue> worker_queue)
+    : query_event_source_(query_event_source),
+      worker_queue_(std::move(worker_queue)) {
   query_event_source->SetCallback(this);
 }
 
@@ -59,6 +61,7 @@ model::TargetId EventManager::AddQueryListener(
     listener_action = ListenerSetupAction::RequireWatchConnectionOnly;
   }
 
+  listener->set_worker_queue(worker_queue_);
   query_info.listeners.push_back(listener);
 
   bool raised_event = listener->OnOnlineStateChanged(online_state_);
@@ -96,6 +99,7 @@ void EventManager::RemoveQueryListener(
   const auto& query_or_pipeline = listener->query();
   ListenerRemovalAction listener_action =
       ListenerRemovalAction::NoRemovalActionRequired;
+  listener->CancelPendingEvent();
 
   auto found_iter = queries_.find(query_or_pipeline);
   if (found_iter != queries_.end()) {
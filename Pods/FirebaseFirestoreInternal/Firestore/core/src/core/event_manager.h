@@ -27,6 +27,7 @@
 #include "Firestore/core/src/core/sync_engine_callback.h"
 #include "Firestore/core/src/core/view_snapshot.h"
 #include "Firestore/core/src/model/model_fwd.h"
+#include "Firestore/core/src/util/async_queue.h"
 #include "Firestore/core/src/util/empty.h"
 #include "Firestore/core/src/util/status_fwd.h"
 #include "absl/types/optional.h"
@@ -44,7 +45,12 @@ class QueryEventSource;
  */
 class EventManager : public SyncEngineCallback {
  public:
-  explicit EventManager(QueryEventSource* query_event_source_);
+  /**
+   * Creates an EventManager. Listeners whose options set a minimum event
+   * interval raise their coalesced events on `worker_queue`.
+   */
+  EventManager(QueryEventSource* query_event_source_,
+               std::shared_ptr<util::AsyncQueue> worker_queue);
 
   /**
    * Adds a query listener that will be called with new snapshots for the query.
@@ -128,6 +134,7 @@ class EventManager : public SyncEngineCallback {
   };
 
   QueryEventSource* query_event_source_ = nullptr;
+  std::shared_ptr<util::AsyncQueue> worker_queue_;
   model::OnlineState online_state_ = model::OnlineState::Unknown;
   std::unordered_map<core::QueryOrPipeline, QueryListenersInfo> queries_;
   std::unordered_set<std::shared_ptr<EventListener<util::Empty>>>
@@ -32,6 +32,7 @@
 #include "Firestore/core/src/api/stages.h"
 #include "Firestore/core/src/model/mutable_document.h"
 #include "Firestore/core/src/model/server_timestamp_util.h"
+#include "Firestore/core/src/model/vector_distance.h"
 #include "Firestore/core/src/model/value_util.h"  // For value helpers like IsArray, DeepClone
 #include "Firestore/core/src/nanopb/message.h"  // Added for MakeMessage
 #include "Firestore/core/src/remote/serializer.h"
@@ -233,6 +234,12 @@ std::unique_ptr<EvaluableExpr> FunctionToEvaluable(
     return std::make_unique<CoreArrayContainsAny>(function);
   } else if (function.name() == "array_length") {
     return std::make_unique<CoreArrayLength>(function);
+  } else if (function.name() == "cosine_distance") {
+    return std::make_unique<CoreCosineDistance>(function);
+  } else if (function.name() == "dot_product") {
+    return std::make_unique<CoreDotProduct>(function);
+  } else if (function.name() == "euclidean_distance") {
+    return std::make_unique<CoreEuclideanDistance>(function);
   } else if (function.name() == "exists") {
     return std::make_unique<CoreExists>(function);
   } else if (function.name() == "not") {
@@ -312,6 +319,15 @@ std::unique_ptr<EvaluableExpr> FunctionToEvaluable(
   HARD_FAIL("Unsupported function name: %s", function.name());
 }
 
+EvaluableParams ToEvaluableParams(const api::FunctionExpr& function) {
+  EvaluableParams params;
+  params.reserve(function.params().size());
+  for (const auto& param : function.params()) {
+    params.push_back(param->ToEvaluable());
+  }
+  return params;
+}
+
 namespace {
 
 nanopb::Message<google_firestore_v1_Value> GetServerTimestampValue(
@@ -392,8 +408,7 @@ EvaluateResult ComparisonBase::Evaluate(
   HARD_ASSERT(expr_->params().size() == 2,
               "%s() function requires exactly 2 params", expr_->name());
 
-  std::unique_ptr<EvaluableExpr> left_evaluable =
-      expr_->params()[0]->ToEvaluable();
+  const std::unique_ptr<EvaluableExpr>& left_evaluable = params_[0];
   EvaluateResult left = left_evaluable->Evaluate(context, document);
 
   switch (left.type()) {
@@ -405,8 +420,7 @@ EvaluateResult ComparisonBase::Evaluate(
       break;
   }
 
-  std::unique_ptr<EvaluableExpr> right_evaluable =
-      expr_->params()[1]->ToEvaluable();
+  const std::unique_ptr<EvaluableExpr>& right_evaluable = params_[1];
   EvaluateResult right = right_evaluable->Evaluate(context, document);
   switch (right.type()) {
     case EvaluateResult::ResultType::kError:
@@ -733,8 +747,7 @@ EvaluateResult StringSearchBase::Evaluate(
               "%s() function requires exactly 2 params", expr_->name());
 
   bool has_null = false;
-  EvaluateResult op1 =
-      expr_->params()[0]->ToEvaluable()->Evaluate(context, document);
+  EvaluateResult op1 = params_[0]->Evaluate(context, document);
   switch (op1.type()) {
     case EvaluateResult::ResultType::kString: {
       break;
@@ -748,8 +761,7 @@ EvaluateResult StringSearchBase::Evaluate(
     }
   }
 
-  EvaluateResult op2 =
-      expr_->params()[1]->ToEvaluable()->Evaluate(context, document);
+  EvaluateResult op2 = params_[1]->Evaluate(context, document);
   switch (op2.type()) {
     case EvaluateResult::ResultType::kString: {
       break;
@@ -819,8 +831,7 @@ EvaluateResult CoreByteLength::Evaluate(
     const model::PipelineInputOutput& document) const {
   HARD_ASSERT(expr_->params().size() == 1,
               "byte_length() requires exactly 1 param");
-  EvaluateResult evaluated =
-      expr_->params()[0]->ToEvaluable()->Evaluate(context, document);
+  EvaluateResult evaluated = params_[0]->Evaluate(context, document);
 
   switch (evaluated.type()) {
     case EvaluateResult::ResultType::kString: {
@@ -855,8 +866,7 @@ EvaluateResult CoreCharLength::Evaluate(
     const model::PipelineInputOutput& document) const {
   HARD_ASSERT(expr_->params().size() == 1,
               "char_length() requires exactly 1 param");
-  EvaluateResult evaluated =
-      expr_->params()[0]->ToEvaluable()->Evaluate(context, document);
+  EvaluateResult evaluated = params_[0]->Evaluate(context, document);
 
   switch (evaluated.type()) {
     case EvaluateResult::ResultType::kString: {
@@ -886,9 +896,8 @@ EvaluateResult CoreStrConcat::Evaluate(
   std::string result_string;
 
   bool found_null = false;
-  for (const auto& param : expr_->params()) {
-    EvaluateResult evaluated =
-        param->ToEvaluable()->Evaluate(context, document);
+  for (const auto& param : params_) {
+    EvaluateResult evaluated = param->Evaluate(context, document);
     switch (evaluated.type()) {
       case EvaluateResult::ResultType::kString: {
         absl::StrAppend(&result_string,
@@ -940,8 +949,7 @@ EvaluateResult CoreToLower::Evaluate(
     const model::PipelineInputOutput& document) const {
   HARD_ASSERT(expr_->params().size() == 1,
               "to_lower() requires exactly 1 param");
-  EvaluateResult evaluated =
-      expr_->params()[0]->ToEvaluable()->Evaluate(context, document);
+  EvaluateResult evaluated = params_[0]->Evaluate(context, document);
 
   switch (evaluated.type()) {
     case EvaluateResult::ResultType::kString: {
@@ -964,8 +972,7 @@ EvaluateResult CoreToUpper::Evaluate(
     const model::PipelineInputOutput& document) const {
   HARD_ASSERT(expr_->params().size() == 1,
               "to_upper() requires exactly 1 param");
-  EvaluateResult evaluated =
-      expr_->params()[0]->ToEvaluable()->Evaluate(context, document);
+  EvaluateResult evaluated = params_[0]->Evaluate(context, document);
 
   switch (evaluated.type()) {
     case EvaluateResult::ResultType::kString: {
@@ -988,8 +995,7 @@ EvaluateResult CoreTrim::Evaluate(
     const api::EvaluateContext& context,
     const model::PipelineInputOutput& document) const {
   HARD_ASSERT(expr_->params().size() == 1, "trim() requires exactly 1 param");
-  EvaluateResult evaluated =
-      expr_->params()[0]->ToEvaluable()->Evaluate(context, document);
+  EvaluateResult evaluated = params_[0]->Evaluate(context, document);
 
   switch (evaluated.type()) {
     case EvaluateResult::ResultType::kString: {
@@ -1009,8 +1015,7 @@ EvaluateResult CoreReverse::Evaluate(
     const model::PipelineInputOutput& document) const {
   HARD_ASSERT(expr_->params().size() == 1,
               "reverse() requires exactly 1 param");
-  EvaluateResult evaluated =
-      expr_->params()[0]->ToEvaluable()->Evaluate(context, document);
+  EvaluateResult evaluated = params_[0]->Evaluate(context, document);
 
   switch (evaluated.type()) {
     case EvaluateResult::ResultType::kString: {
@@ -1044,8 +1049,7 @@ EvaluateResult CoreMapGet::Evaluate(
               "map_get() function requires exactly 2 params (map and key)");
 
   // Evaluate the map operand (param 0)
-  std::unique_ptr<EvaluableExpr> map_evaluable =
-      expr_->params()[0]->ToEvaluable();
+  const std::unique_ptr<EvaluableExpr>& map_evaluable = params_[0];
   EvaluateResult map_result = map_evaluable->Evaluate(context, document);
 
   switch (map_result.type()) {
@@ -1064,8 +1068,7 @@ EvaluateResult CoreMapGet::Evaluate(
   }
 
   // Evaluate the key operand (param 1)
-  std::unique_ptr<EvaluableExpr> key_evaluable =
-      expr_->params()[1]->ToEvaluable();
+  const std::unique_ptr<EvaluableExpr>& key_evaluable = params_[1];
   EvaluateResult key_result = key_evaluable->Evaluate(context, document);
 
   absl::optional<std::string> key_string;
@@ -1100,8 +1103,7 @@ EvaluateResult ArithmeticBase::Evaluate(
   HARD_ASSERT(expr_->params().size() >= 2,
               "%s() function requires at least 2 params", expr_->name());
 
-  EvaluateResult current_result =
-      expr_->params()[0]->ToEvaluable()->Evaluate(context, document);
+  EvaluateResult current_result = params_[0]->Evaluate(context, document);
 
   for (size_t i = 1; i < expr_->params().size(); ++i) {
     // Check current accumulated result before evaluating next operand
@@ -1112,8 +1114,7 @@ EvaluateResult ArithmeticBase::Evaluate(
     }
     // Null check happens inside ApplyOperation
 
-    EvaluateResult next_operand =
-        expr_->params()[i]->ToEvaluable()->Evaluate(context, document);
+    EvaluateResult next_operand = params_[i]->Evaluate(context, document);
 
     // Apply the operation
     current_result = ApplyOperation(current_result, next_operand);
@@ -1260,8 +1261,7 @@ EvaluateResult CoreArrayReverse::Evaluate(
   HARD_ASSERT(expr_->params().size() == 1,
               "array_reverse() function requires exactly 1 param");
 
-  std::unique_ptr<EvaluableExpr> operand_evaluable =
-      expr_->params()[0]->ToEvaluable();
+  const std::unique_ptr<EvaluableExpr>& operand_evaluable = params_[0];
   EvaluateResult evaluated = operand_evaluable->Evaluate(context, document);
 
   switch (evaluated.type()) {
@@ -1288,17 +1288,21 @@ EvaluateResult CoreArrayReverse::Evaluate(
   }
 }
 
+CoreArrayContains::CoreArrayContains(const api::FunctionExpr& expr)
+    : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+  std::vector<std::shared_ptr<api::Expr>> reversed_params(
+      expr_->params().rbegin(), expr_->params().rend());
+  equivalent_ = std::make_unique<CoreEqAny>(
+      api::FunctionExpr("equal_any", std::move(reversed_params)));
+}
+
 EvaluateResult CoreArrayContains::Evaluate(
     const api::EvaluateContext& context,
     const model::PipelineInputOutput& document) const {
   HARD_ASSERT(expr_->params().size() == 2,
               "array_contains() function requires exactly 2 params");
 
-  std::vector<std::shared_ptr<api::Expr>> reversed_params(
-      expr_->params().rbegin(), expr_->params().rend());
-  auto const eq_any =
-      CoreEqAny(api::FunctionExpr("equal_any", std::move(reversed_params)));
-  return eq_any.Evaluate(context, document);
+  return equivalent_->Evaluate(context, document);
 }
 
 EvaluateResult CoreArrayContainsAll::Evaluate(
@@ -1310,8 +1314,7 @@ EvaluateResult CoreArrayContainsAll::Evaluate(
   bool found_null = false;
 
   // Evaluate the array to search (param 0)
-  std::unique_ptr<EvaluableExpr> array_to_search_evaluable =
-      expr_->params()[0]->ToEvaluable();
+  const std::unique_ptr<EvaluableExpr>& array_to_search_evaluable = params_[0];
   EvaluateResult array_to_search =
       array_to_search_evaluable->Evaluate(context, document);
 
@@ -1329,8 +1332,7 @@ EvaluateResult CoreArrayContainsAll::Evaluate(
   }
 
   // Evaluate the elements to find (param 1)
-  std::unique_ptr<EvaluableExpr> elements_to_find_evaluable =
-      expr_->params()[1]->ToEvaluable();
+  const std::unique_ptr<EvaluableExpr>& elements_to_find_evaluable = params_[1];
   EvaluateResult elements_to_find =
       elements_to_find_evaluable->Evaluate(context, document);
 
@@ -1432,8 +1434,7 @@ EvaluateResult CoreArrayContainsAny::Evaluate(
   bool found_null = false;
 
   // Evaluate the array to search (param 0)
-  std::unique_ptr<EvaluableExpr> array_to_search_evaluable =
-      expr_->params()[0]->ToEvaluable();
+  const std::unique_ptr<EvaluableExpr>& array_to_search_evaluable = params_[0];
   EvaluateResult array_to_search =
       array_to_search_evaluable->Evaluate(context, document);
 
@@ -1451,8 +1452,7 @@ EvaluateResult CoreArrayContainsAny::Evaluate(
   }
 
   // Evaluate the elements to find (param 1)
-  std::unique_ptr<EvaluableExpr> elements_to_find_evaluable =
-      expr_->params()[1]->ToEvaluable();
+  const std::unique_ptr<EvaluableExpr>& elements_to_find_evaluable = params_[1];
   EvaluateResult elements_to_find =
       elements_to_find_evaluable->Evaluate(context, document);
 
@@ -1529,8 +1529,7 @@ EvaluateResult CoreArrayLength::Evaluate(
   HARD_ASSERT(expr_->params().size() == 1,
               "array_length() function requires exactly 1 param");
 
-  std::unique_ptr<EvaluableExpr> operand_evaluable =
-      expr_->params()[0]->ToEvaluable();
+  const std::unique_ptr<EvaluableExpr>& operand_evaluable = params_[0];
   EvaluateResult operand_result =
       operand_evaluable->Evaluate(context, document);
 
@@ -1548,6 +1547,59 @@ EvaluateResult CoreArrayLength::Evaluate(
   }
 }
 
+// --- Vector Expression Implementations ---
+
+EvaluateResult VectorDistanceBase::Evaluate(
+    const api::EvaluateContext& context,
+    const model::PipelineInputOutput& document) const {
+  HARD_ASSERT(expr_->params().size() == 2,
+              "%s() function requires exactly 2 params", expr_->name());
+
+  EvaluateResult left = params_[0]->Evaluate(context, document);
+  EvaluateResult right = params_[1]->Evaluate(context, document);
+  if (left.IsErrorOrUnset() || right.IsErrorOrUnset()) {
+    return EvaluateResult::NewError();
+  }
+  if (left.IsNull() || right.IsNull()) {
+    return EvaluateResult::NewNull();
+  }
+
+  // The components are copied into contiguous storage once, so that the
+  // distance kernels run over plain arrays.
+  std::vector<double> left_components;
+  std::vector<double> right_components;
+  if (!model::GetVectorComponents(*left.value(), &left_components) ||
+      !model::GetVectorComponents(*right.value(), &right_components) ||
+      left_components.size() != right_components.size() ||
+      left_components.empty()) {
+    return EvaluateResult::NewError();
+  }
+
+  absl::optional<double> distance =
+      ComputeDistance(left_components.data(), right_components.data(),
+                      left_components.size());
+  if (!distance.has_value()) {
+    return EvaluateResult::NewError();
+  }
+  return EvaluateResult::NewValue(DoubleValue(distance.value()));
+}
+
+absl::optional<double> CoreCosineDistance::ComputeDistance(
+    const double* left, const double* right, size_t size) const {
+  return model::CosineDistance(left, right, size);
+}
+
+absl::optional<double> CoreDotProduct::ComputeDistance(const double* left,
+                                                       const double* right,
+                                                       size_t size) const {
+  return model::DotProduct(left, right, size);
+}
+
+absl::optional<double> CoreEuclideanDistance::ComputeDistance(
+    const double* left, const double* right, size_t size) const {
+  return model::EuclideanDistance(left, right, size);
+}
+
 // --- Logical Expression Implementations ---
 
 // Constructor definitions removed as they are now inline in the header
@@ -1557,9 +1609,8 @@ EvaluateResult CoreAnd::Evaluate(
     const model::PipelineInputOutput& document) const {
   bool has_null = false;
   bool has_error = false;
-  for (const auto& param : expr_->params()) {
-    EvaluateResult const result =
-        param->ToEvaluable()->Evaluate(context, document);
+  for (const auto& param : params_) {
+    EvaluateResult const result = param->Evaluate(context, document);
     switch (result.type()) {
       case EvaluateResult::ResultType::kBoolean:
         if (!result.value()->boolean_value) {
@@ -1595,9 +1646,8 @@ EvaluateResult CoreOr::Evaluate(
     const model::PipelineInputOutput& document) const {
   bool has_null = false;
   bool has_error = false;
-  for (const auto& param : expr_->params()) {
-    EvaluateResult const result =
-        param->ToEvaluable()->Evaluate(context, document);
+  for (const auto& param : params_) {
+    EvaluateResult const result = param->Evaluate(context, document);
     switch (result.type()) {
       case EvaluateResult::ResultType::kBoolean:
         if (result.value()->boolean_value) {
@@ -1633,9 +1683,8 @@ EvaluateResult CoreXor::Evaluate(
     const model::PipelineInputOutput& document) const {
   bool current_xor_result = false;
   bool has_null = false;
-  for (const auto& param : expr_->params()) {
-    EvaluateResult const evaluated =
-        param->ToEvaluable()->Evaluate(context, document);
+  for (const auto& param : params_) {
+    EvaluateResult const evaluated = param->Evaluate(context, document);
     switch (evaluated.type()) {
       case EvaluateResult::ResultType::kBoolean: {
         bool operand_value = evaluated.value()->boolean_value;
@@ -1667,22 +1716,21 @@ EvaluateResult CoreCond::Evaluate(
   HARD_ASSERT(expr_->params().size() == 3,
               "cond() function requires exactly 3 params");
 
-  EvaluateResult condition =
-      expr_->params()[0]->ToEvaluable()->Evaluate(context, document);
+  EvaluateResult condition = params_[0]->Evaluate(context, document);
 
   switch (condition.type()) {
     case EvaluateResult::ResultType::kBoolean: {
       if (condition.value()->boolean_value) {
         // Condition is true, evaluate the second parameter
-        return expr_->params()[1]->ToEvaluable()->Evaluate(context, document);
+        return params_[1]->Evaluate(context, document);
       } else {
         // Condition is false, evaluate the third parameter
-        return expr_->params()[2]->ToEvaluable()->Evaluate(context, document);
+        return params_[2]->Evaluate(context, document);
       }
     }
     case EvaluateResult::ResultType::kNull: {
       // Condition is null, evaluate the third parameter (false case)
-      return expr_->params()[2]->ToEvaluable()->Evaluate(context, document);
+      return params_[2]->Evaluate(context, document);
     }
     default:
       // Condition is error, unset, or non-boolean/non-null type
@@ -1700,8 +1748,7 @@ EvaluateResult CoreEqAny::Evaluate(
   bool found_null = false;
 
   // Evaluate the search value (param 0)
-  EvaluateResult const search_result =
-      expr_->params()[0]->ToEvaluable()->Evaluate(context, document);
+  EvaluateResult const search_result = params_[0]->Evaluate(context, document);
   switch (search_result.type()) {
     case EvaluateResult::ResultType::kNull: {
       found_null = true;
@@ -1714,8 +1761,7 @@ EvaluateResult CoreEqAny::Evaluate(
       break;  // Valid value
   }
 
-  EvaluateResult const array_result =
-      expr_->params()[1]->ToEvaluable()->Evaluate(context, document);
+  EvaluateResult const array_result = params_[1]->Evaluate(context, document);
   switch (array_result.type()) {
     case EvaluateResult::ResultType::kNull: {
       found_null = true;
@@ -1757,6 +1803,13 @@ EvaluateResult CoreEqAny::Evaluate(
   return EvaluateResult::NewValue(nanopb::MakeMessage(model::FalseValue()));
 }
 
+CoreNotEqAny::CoreNotEqAny(const api::FunctionExpr& expr)
+    : expr_(std::make_unique<api::FunctionExpr>(expr)),
+      equivalent_(std::make_unique<CoreNot>(api::FunctionExpr(
+          "not", {std::make_shared<api::FunctionExpr>("equal_any",
+                                                      expr.params())}))) {
+}
+
 EvaluateResult CoreNotEqAny::Evaluate(
     const api::EvaluateContext& context,
     const model::PipelineInputOutput& document) const {
@@ -1765,10 +1818,7 @@ EvaluateResult CoreNotEqAny::Evaluate(
       "not_eq_any() function requires exactly 2 params (search value and "
       "array value)");
 
-  CoreNot equivalent(api::FunctionExpr(
-      "not",
-      {std::make_shared<api::FunctionExpr>("equal_any", expr_->params())}));
-  return equivalent.Evaluate(context, document);
+  return equivalent_->Evaluate(context, document);
 }
 
 EvaluateResult CoreIsNan::Evaluate(
@@ -1777,8 +1827,7 @@ EvaluateResult CoreIsNan::Evaluate(
   HARD_ASSERT(expr_->params().size() == 1,
               "is_nan() function requires exactly 1 param");
 
-  EvaluateResult evaluated =
-      expr_->params()[0]->ToEvaluable()->Evaluate(context, document);
+  EvaluateResult evaluated = params_[0]->Evaluate(context, document);
   switch (evaluated.type()) {
     case EvaluateResult::ResultType::kInt:
       // Integers are never NaN
@@ -1797,15 +1846,20 @@ EvaluateResult CoreIsNan::Evaluate(
   }
 }
 
+CoreIsNotNan::CoreIsNotNan(const api::FunctionExpr& expr)
+    : expr_(std::make_unique<api::FunctionExpr>(expr)),
+      equivalent_(std::make_unique<CoreNot>(api::FunctionExpr(
+          "not",
+          {std::make_shared<api::FunctionExpr>("is_nan", expr.params())}))) {
+}
+
 EvaluateResult CoreIsNotNan::Evaluate(
     const api::EvaluateContext& context,
     const model::PipelineInputOutput& document) const {
   HARD_ASSERT(expr_->params().size() == 1,
               "is_not_nan() function requires exactly 1 param");
 
-  CoreNot equivalent(api::FunctionExpr(
-      "not", {std::make_shared<api::FunctionExpr>("is_nan", expr_->params())}));
-  return equivalent.Evaluate(context, document);
+  return equivalent_->Evaluate(context, document);
 }
 
 EvaluateResult CoreIsNull::Evaluate(
@@ -1814,8 +1868,7 @@ EvaluateResult CoreIsNull::Evaluate(
   HARD_ASSERT(expr_->params().size() == 1,
               "is_null() function requires exactly 1 param");
 
-  EvaluateResult evaluated =
-      expr_->params()[0]->ToEvaluable()->Evaluate(context, document);
+  EvaluateResult evaluated = params_[0]->Evaluate(context, document);
   switch (evaluated.type()) {
     case EvaluateResult::ResultType::kNull:
       return EvaluateResult::NewValue(nanopb::MakeMessage(model::TrueValue()));
@@ -1829,16 +1882,20 @@ EvaluateResult CoreIsNull::Evaluate(
   }
 }
 
+CoreIsNotNull::CoreIsNotNull(const api::FunctionExpr& expr)
+    : expr_(std::make_unique<api::FunctionExpr>(expr)),
+      equivalent_(std::make_unique<CoreNot>(api::FunctionExpr(
+          "not",
+          {std::make_shared<api::FunctionExpr>("is_null", expr.params())}))) {
+}
+
 EvaluateResult CoreIsNotNull::Evaluate(
     const api::EvaluateContext& context,
     const model::PipelineInputOutput& document) const {
   HARD_ASSERT(expr_->params().size() == 1,
               "is_not_null() function requires exactly 1 param");
 
-  CoreNot equivalent(api::FunctionExpr(
-      "not",
-      {std::make_shared<api::FunctionExpr>("is_null", expr_->params())}));
-  return equivalent.Evaluate(context, document);
+  return equivalent_->Evaluate(context, document);
 }
 
 EvaluateResult CoreIsError::Evaluate(
@@ -1847,8 +1904,7 @@ EvaluateResult CoreIsError::Evaluate(
   HARD_ASSERT(expr_->params().size() == 1,
               "is_error() function requires exactly 1 param");
 
-  EvaluateResult evaluated =
-      expr_->params()[0]->ToEvaluable()->Evaluate(context, document);
+  EvaluateResult evaluated = params_[0]->Evaluate(context, document);
   switch (evaluated.type()) {
     case EvaluateResult::ResultType::kError:
       return EvaluateResult::NewValue(nanopb::MakeMessage(model::TrueValue()));
@@ -1863,8 +1919,8 @@ EvaluateResult CoreLogicalMaximum::Evaluate(
   // Store the underlying Value proto in the optional, not EvaluateResult
   absl::optional<nanopb::Message<google_firestore_v1_Value>> max_value_proto;
 
-  for (const auto& param : expr_->params()) {
-    EvaluateResult result = param->ToEvaluable()->Evaluate(context, document);
+  for (const auto& param : params_) {
+    EvaluateResult result = param->Evaluate(context, document);
 
     switch (result.type()) {
       case EvaluateResult::ResultType::kError:
@@ -1897,8 +1953,8 @@ EvaluateResult CoreLogicalMinimum::Evaluate(
   // Store the underlying Value proto in the optional, not EvaluateResult
   absl::optional<nanopb::Message<google_firestore_v1_Value>> min_value_proto;
 
-  for (const auto& param : expr_->params()) {
-    EvaluateResult result = param->ToEvaluable()->Evaluate(context, document);
+  for (const auto& param : params_) {
+    EvaluateResult result = param->Evaluate(context, document);
 
     switch (result.type()) {
       case EvaluateResult::ResultType::kError:
@@ -1932,8 +1988,7 @@ EvaluateResult CoreExists::Evaluate(
   HARD_ASSERT(expr_->params().size() == 1,
               "exists() function requires exactly 1 param");
 
-  std::unique_ptr<EvaluableExpr> operand_evaluable =
-      expr_->params()[0]->ToEvaluable();
+  const std::unique_ptr<EvaluableExpr>& operand_evaluable = params_[0];
   EvaluateResult evaluated = operand_evaluable->Evaluate(context, document);
 
   switch (evaluated.type()) {
@@ -1954,8 +2009,7 @@ EvaluateResult CoreNot::Evaluate(
   HARD_ASSERT(expr_->params().size() == 1,
               "not() function requires exactly 1 param");
 
-  std::unique_ptr<EvaluableExpr> operand_evaluable =
-      expr_->params()[0]->ToEvaluable();
+  const std::unique_ptr<EvaluableExpr>& operand_evaluable = params_[0];
   EvaluateResult evaluated = operand_evaluable->Evaluate(context, document);
 
   switch (evaluated.type()) {
@@ -2154,8 +2208,7 @@ EvaluateResult UnixToTimestampBase::Evaluate(
   HARD_ASSERT(expr_->params().size() == 1,
               "%s() function requires exactly 1 param", expr_->name());
 
-  EvaluateResult evaluated =
-      expr_->params()[0]->ToEvaluable()->Evaluate(context, document);
+  EvaluateResult evaluated = params_[0]->Evaluate(context, document);
 
   switch (evaluated.type()) {
     case EvaluateResult::ResultType::kInt: {
@@ -2177,8 +2230,7 @@ EvaluateResult TimestampToUnixBase::Evaluate(
   HARD_ASSERT(expr_->params().size() == 1,
               "%s() function requires exactly 1 param", expr_->name());
 
-  EvaluateResult evaluated =
-      expr_->params()[0]->ToEvaluable()->Evaluate(context, document);
+  EvaluateResult evaluated = params_[0]->Evaluate(context, document);
 
   switch (evaluated.type()) {
     case EvaluateResult::ResultType::kTimestamp: {
@@ -2207,8 +2259,7 @@ EvaluateResult TimestampArithmeticBase::Evaluate(
   bool has_null = false;
 
   // 1. Evaluate Timestamp operand
-  EvaluateResult timestamp_result =
-      expr_->params()[0]->ToEvaluable()->Evaluate(context, document);
+  EvaluateResult timestamp_result = params_[0]->Evaluate(context, document);
   switch (timestamp_result.type()) {
     case EvaluateResult::ResultType::kTimestamp:
       // Check initial timestamp bounds
@@ -2224,8 +2275,7 @@ EvaluateResult TimestampArithmeticBase::Evaluate(
   }
 
   // 2. Evaluate Unit operand (must be string)
-  EvaluateResult unit_result =
-      expr_->params()[1]->ToEvaluable()->Evaluate(context, document);
+  EvaluateResult unit_result = params_[1]->Evaluate(context, document);
   absl::optional<TimeUnit> time_unit;
   switch (unit_result.type()) {
     case EvaluateResult::ResultType::kString: {
@@ -2245,8 +2295,7 @@ EvaluateResult TimestampArithmeticBase::Evaluate(
   }
 
   // 3. Evaluate Amount operand (must be integer)
-  EvaluateResult amount_result =
-      expr_->params()[2]->ToEvaluable()->Evaluate(context, document);
+  EvaluateResult amount_result = params_[2]->Evaluate(context, document);
   absl::optional<int64_t> amount;
   switch (amount_result.type()) {
     case EvaluateResult::ResultType::kInt:
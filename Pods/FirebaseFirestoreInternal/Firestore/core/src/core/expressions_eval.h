@@ -20,6 +20,8 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
+
 #include "Firestore/Protos/nanopb/google/firestore/v1/document.nanopb.h"
 
 #include "Firestore/core/src/api/expressions.h"
@@ -141,11 +143,20 @@ class CoreConstant : public EvaluableExpr {
   std::unique_ptr<api::Expr> expr_;
 };
 
+/**
+ * The evaluable forms of the parameters of a function. Functions compile their
+ * parameters once, when they are created, instead of on every evaluation.
+ */
+using EvaluableParams = std::vector<std::unique_ptr<EvaluableExpr>>;
+
+EvaluableParams ToEvaluableParams(const api::FunctionExpr& function);
+
 /** Base class for binary comparison expressions (==, !=, <, <=, >, >=). */
 class ComparisonBase : public EvaluableExpr {
  public:
   explicit ComparisonBase(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
 
   EvaluateResult Evaluate(
@@ -161,6 +172,7 @@ class ComparisonBase : public EvaluableExpr {
                                          const EvaluateResult& right) const = 0;
 
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 class CoreEq : public ComparisonBase {
@@ -227,7 +239,8 @@ class CoreGte : public ComparisonBase {
 class ArithmeticBase : public EvaluableExpr {
  public:
   explicit ArithmeticBase(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
   ~ArithmeticBase() override = default;
 
@@ -255,6 +268,7 @@ class ArithmeticBase : public EvaluableExpr {
                                 const EvaluateResult& right) const;
 
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 // --- End Base Class for Arithmetic Operations ---
 
@@ -318,7 +332,8 @@ class CoreMod : public ArithmeticBase {
 class CoreArrayReverse : public EvaluableExpr {
  public:
   explicit CoreArrayReverse(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
@@ -326,25 +341,28 @@ class CoreArrayReverse : public EvaluableExpr {
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 class CoreArrayContains : public EvaluableExpr {
  public:
-  explicit CoreArrayContains(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
-  }
+  explicit CoreArrayContains(const api::FunctionExpr& expr);
+
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
       const model::PipelineInputOutput& document) const override;
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  // The equivalent expression this one is evaluated as, built once.
+  std::unique_ptr<EvaluableExpr> equivalent_;
 };
 
 class CoreArrayContainsAll : public EvaluableExpr {
  public:
   explicit CoreArrayContainsAll(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
@@ -352,12 +370,14 @@ class CoreArrayContainsAll : public EvaluableExpr {
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 class CoreArrayContainsAny : public EvaluableExpr {
  public:
   explicit CoreArrayContainsAny(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
@@ -365,12 +385,14 @@ class CoreArrayContainsAny : public EvaluableExpr {
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 class CoreArrayLength : public EvaluableExpr {
  public:
   explicit CoreArrayLength(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
@@ -378,6 +400,69 @@ class CoreArrayLength : public EvaluableExpr {
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
+};
+
+// --- Vector Expressions ---
+
+// Base class for functions that compute a distance between two vectors.
+class VectorDistanceBase : public EvaluableExpr {
+ public:
+  explicit VectorDistanceBase(const api::FunctionExpr& expr)
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
+  }
+  ~VectorDistanceBase() override = default;
+
+  EvaluateResult Evaluate(
+      const api::EvaluateContext& context,
+      const model::PipelineInputOutput& document) const override;
+
+ protected:
+  // Computes the distance between two vectors of the same, non-zero number
+  // of components. Returns absl::nullopt if the distance is undefined.
+  virtual absl::optional<double> ComputeDistance(const double* left,
+                                                 const double* right,
+                                                 size_t size) const = 0;
+
+  std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
+};
+
+class CoreCosineDistance : public VectorDistanceBase {
+ public:
+  explicit CoreCosineDistance(const api::FunctionExpr& expr)
+      : VectorDistanceBase(expr) {
+  }
+
+ protected:
+  absl::optional<double> ComputeDistance(const double* left,
+                                         const double* right,
+                                         size_t size) const override;
+};
+
+class CoreDotProduct : public VectorDistanceBase {
+ public:
+  explicit CoreDotProduct(const api::FunctionExpr& expr)
+      : VectorDistanceBase(expr) {
+  }
+
+ protected:
+  absl::optional<double> ComputeDistance(const double* left,
+                                         const double* right,
+                                         size_t size) const override;
+};
+
+class CoreEuclideanDistance : public VectorDistanceBase {
+ public:
+  explicit CoreEuclideanDistance(const api::FunctionExpr& expr)
+      : VectorDistanceBase(expr) {
+  }
+
+ protected:
+  absl::optional<double> ComputeDistance(const double* left,
+                                         const double* right,
+                                         size_t size) const override;
 };
 
 // --- String Expressions ---
@@ -387,7 +472,8 @@ class CoreArrayLength : public EvaluableExpr {
 class StringSearchBase : public EvaluableExpr {
  public:
   explicit StringSearchBase(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
 
   EvaluateResult Evaluate(
@@ -403,12 +489,14 @@ class StringSearchBase : public EvaluableExpr {
                                        const std::string& search) const = 0;
 
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 class CoreByteLength : public EvaluableExpr {
  public:
   explicit CoreByteLength(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
@@ -416,12 +504,14 @@ class CoreByteLength : public EvaluableExpr {
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 class CoreCharLength : public EvaluableExpr {
  public:
   explicit CoreCharLength(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
@@ -429,12 +519,14 @@ class CoreCharLength : public EvaluableExpr {
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 class CoreStrConcat : public EvaluableExpr {
  public:
   explicit CoreStrConcat(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
@@ -442,6 +534,7 @@ class CoreStrConcat : public EvaluableExpr {
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 class CoreEndsWith : public StringSearchBase {
@@ -480,7 +573,8 @@ class CoreStrContains : public StringSearchBase {
 class CoreToLower : public EvaluableExpr {
  public:
   explicit CoreToLower(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
@@ -488,12 +582,14 @@ class CoreToLower : public EvaluableExpr {
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 class CoreToUpper : public EvaluableExpr {
  public:
   explicit CoreToUpper(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
@@ -501,12 +597,14 @@ class CoreToUpper : public EvaluableExpr {
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 class CoreTrim : public EvaluableExpr {
  public:
   explicit CoreTrim(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
@@ -514,12 +612,14 @@ class CoreTrim : public EvaluableExpr {
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 class CoreReverse : public EvaluableExpr {
  public:
   explicit CoreReverse(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
@@ -527,6 +627,7 @@ class CoreReverse : public EvaluableExpr {
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 class CoreRegexContains : public StringSearchBase {
@@ -566,7 +667,8 @@ class CoreLike : public StringSearchBase {
 class CoreMapGet : public EvaluableExpr {
  public:
   explicit CoreMapGet(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
@@ -574,6 +676,7 @@ class CoreMapGet : public EvaluableExpr {
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 // --- Logical Expressions ---
@@ -581,7 +684,8 @@ class CoreMapGet : public EvaluableExpr {
 class CoreAnd : public EvaluableExpr {
  public:
   explicit CoreAnd(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
@@ -589,12 +693,14 @@ class CoreAnd : public EvaluableExpr {
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 class CoreOr : public EvaluableExpr {
  public:
   explicit CoreOr(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
@@ -602,12 +708,14 @@ class CoreOr : public EvaluableExpr {
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 class CoreXor : public EvaluableExpr {
  public:
   explicit CoreXor(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
@@ -615,12 +723,14 @@ class CoreXor : public EvaluableExpr {
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 class CoreCond : public EvaluableExpr {
  public:
   explicit CoreCond(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
@@ -628,12 +738,14 @@ class CoreCond : public EvaluableExpr {
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 class CoreEqAny : public EvaluableExpr {
  public:
   explicit CoreEqAny(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
@@ -641,25 +753,28 @@ class CoreEqAny : public EvaluableExpr {
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 class CoreNotEqAny : public EvaluableExpr {
  public:
-  explicit CoreNotEqAny(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
-  }
+  explicit CoreNotEqAny(const api::FunctionExpr& expr);
+
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
       const model::PipelineInputOutput& document) const override;
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  // The equivalent expression this one is evaluated as, built once.
+  std::unique_ptr<EvaluableExpr> equivalent_;
 };
 
 class CoreIsNan : public EvaluableExpr {
  public:
   explicit CoreIsNan(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
@@ -667,25 +782,28 @@ class CoreIsNan : public EvaluableExpr {
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 class CoreIsNotNan : public EvaluableExpr {
  public:
-  explicit CoreIsNotNan(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
-  }
+  explicit CoreIsNotNan(const api::FunctionExpr& expr);
+
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
       const model::PipelineInputOutput& document) const override;
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  // The equivalent expression this one is evaluated as, built once.
+  std::unique_ptr<EvaluableExpr> equivalent_;
 };
 
 class CoreIsNull : public EvaluableExpr {
  public:
   explicit CoreIsNull(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
@@ -693,25 +811,28 @@ class CoreIsNull : public EvaluableExpr {
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 class CoreIsNotNull : public EvaluableExpr {
  public:
-  explicit CoreIsNotNull(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
-  }
+  explicit CoreIsNotNull(const api::FunctionExpr& expr);
+
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
       const model::PipelineInputOutput& document) const override;
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  // The equivalent expression this one is evaluated as, built once.
+  std::unique_ptr<EvaluableExpr> equivalent_;
 };
 
 class CoreIsError : public EvaluableExpr {
  public:
   explicit CoreIsError(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
@@ -719,12 +840,14 @@ class CoreIsError : public EvaluableExpr {
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 class CoreLogicalMaximum : public EvaluableExpr {
  public:
   explicit CoreLogicalMaximum(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
@@ -732,12 +855,14 @@ class CoreLogicalMaximum : public EvaluableExpr {
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 class CoreLogicalMinimum : public EvaluableExpr {
  public:
   explicit CoreLogicalMinimum(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
@@ -745,6 +870,7 @@ class CoreLogicalMinimum : public EvaluableExpr {
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 // --- Debugging Expressions ---
@@ -752,7 +878,8 @@ class CoreLogicalMinimum : public EvaluableExpr {
 class CoreExists : public EvaluableExpr {
  public:
   explicit CoreExists(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
@@ -760,12 +887,14 @@ class CoreExists : public EvaluableExpr {
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 class CoreNot : public EvaluableExpr {
  public:
   explicit CoreNot(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
   EvaluateResult Evaluate(
       const api::EvaluateContext& context,
@@ -773,6 +902,7 @@ class CoreNot : public EvaluableExpr {
 
  private:
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 // --- Timestamp Expressions ---
@@ -781,7 +911,8 @@ class CoreNot : public EvaluableExpr {
 class UnixToTimestampBase : public EvaluableExpr {
  public:
   explicit UnixToTimestampBase(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
 
   EvaluateResult Evaluate(
@@ -793,6 +924,7 @@ class UnixToTimestampBase : public EvaluableExpr {
   virtual EvaluateResult ToTimestamp(int64_t value) const = 0;
 
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 // Note: Implementations are in expressions_eval.cc
@@ -824,7 +956,8 @@ class CoreUnixSecondsToTimestamp : public UnixToTimestampBase {
 class TimestampToUnixBase : public EvaluableExpr {
  public:
   explicit TimestampToUnixBase(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
 
   EvaluateResult Evaluate(
@@ -837,6 +970,7 @@ class TimestampToUnixBase : public EvaluableExpr {
       const google_protobuf_Timestamp& ts) const = 0;  // Use protobuf type
 
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 // Note: Implementations are in expressions_eval.cc
@@ -868,7 +1002,8 @@ class CoreTimestampToUnixSeconds : public TimestampToUnixBase {
 class TimestampArithmeticBase : public EvaluableExpr {
  public:
   explicit TimestampArithmeticBase(const api::FunctionExpr& expr)
-      : expr_(std::make_unique<api::FunctionExpr>(expr)) {
+      : expr_(std::make_unique<api::FunctionExpr>(expr)),
+        params_(ToEvaluableParams(expr)) {
   }
 
   EvaluateResult Evaluate(
@@ -882,6 +1017,7 @@ class TimestampArithmeticBase : public EvaluableExpr {
       int64_t initial_micros, int64_t micros_to_operate) const = 0;
 
   std::unique_ptr<api::FunctionExpr> expr_;
+  EvaluableParams params_;
 };
 
 // Note: Implementations are in expressions_eval.cc
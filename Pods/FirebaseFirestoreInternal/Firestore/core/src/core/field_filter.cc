@@ -188,7 +188,7 @@ bool FieldFilter::Rep::MatchesComparison(ComparisonResult comparison) const {
 }
 
 std::string FieldFilter::Rep::CanonicalId() const {
-  return absl::StrCat(field_.CanonicalString(), CanonicalName(op_),
+  return absl::StrCat(field().CanonicalString(), CanonicalName(op_),
                       model::CanonicalId(*value_rhs_));
 }
 
@@ -200,7 +200,7 @@ bool FieldFilter::Rep::Equals(const Filter::Rep& other) const {
   if (type() != other.type()) return false;
 
   const auto& other_rep = static_cast<const FieldFilter::Rep&>(other);
-  return op_ == other_rep.op_ && field_ == other_rep.field_ &&
+  return op_ == other_rep.op_ && field() == other_rep.field() &&
          *value_rhs_ == *other_rep.value_rhs_;
 }
 
@@ -23,6 +23,7 @@
 
 #include "Firestore/Protos/nanopb/google/firestore/v1/document.nanopb.h"
 #include "Firestore/core/src/core/filter.h"
+#include "Firestore/core/src/model/field_accessor.h"
 #include "Firestore/core/src/model/field_path.h"
 #include "Firestore/core/src/nanopb/message.h"
 
@@ -70,7 +71,7 @@ class FieldFilter : public Filter {
   explicit FieldFilter(const Filter& other);
 
   const model::FieldPath& field() const {
-    return field_filter_rep().field_;
+    return field_filter_rep().field();
   }
 
   Operator op() const {
@@ -96,7 +97,7 @@ class FieldFilter : public Filter {
 
     /** Returns the field the Filter operates over. */
     const model::FieldPath& field() const {
-      return field_;
+      return field_.path();
     }
 
     Operator op() const {
@@ -138,6 +139,11 @@ class FieldFilter : public Filter {
 
     bool MatchesComparison(util::ComparisonResult comparison) const;
 
+    /** Looks up the field the Filter operates over in documents. */
+    const model::FieldAccessor& field_accessor() const {
+      return field_;
+    }
+
     std::shared_ptr<std::vector<FieldFilter>> CalculateFlattenedFilters()
         const override;
 
@@ -147,7 +153,7 @@ class FieldFilter : public Filter {
     bool Equals(const Filter::Rep& other) const override;
 
     /** The left hand side of the relation. A path into a document field. */
-    model::FieldPath field_;
+    model::FieldAccessor field_;
 
     /** The type of equality/inequality operator to use in the relation. */
     Operator op_;
@@ -16,10 +16,12 @@
 
 #include "Firestore/core/src/core/firestore_client.h"
 
+#include <algorithm>
 #include <functional>
 #include <future>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 
 #include "Firestore/core/src/api/document_reference.h"
@@ -30,6 +32,7 @@
 #include "Firestore/core/src/bundle/bundle_reader.h"
 #include "Firestore/core/src/core/database_info.h"
 #include "Firestore/core/src/core/event_manager.h"
+#include "Firestore/core/src/core/local_aggregate.h"
 #include "Firestore/core/src/core/query_listener.h"
 #include "Firestore/core/src/core/sync_engine.h"
 #include "Firestore/core/src/core/view.h"
@@ -63,6 +66,7 @@
 #include "Firestore/core/src/util/status.h"
 #include "Firestore/core/src/util/statusor.h"
 #include "Firestore/core/src/util/string_apple.h"
+#include "Firestore/core/src/util/trace.h"
 #include "absl/memory/memory.h"
 
 namespace firebase {
@@ -80,6 +84,7 @@ using credentials::AuthCredentialsProvider;
 using credentials::User;
 using firestore::Error;
 using local::LevelDbOpener;
+using local::LevelDbProfile;
 using local::LocalStore;
 using local::LruParams;
 using local::MemoryPersistence;
@@ -101,12 +106,15 @@ using remote::Serializer;
 using util::AsyncQueue;
 using util::Empty;
 using util::Executor;
+using util::MemoryPressureMonitor;
 using util::Status;
 using util::StatusCallback;
 using util::StatusOr;
 using util::StatusOrCallback;
+using util::OperationTrace;
 using util::ThrowIllegalState;
 using util::TimerId;
+using util::TraceScope;
 
 namespace {
 
@@ -114,11 +122,21 @@ static const size_t kMaxConcurrentLimboResolutions = 100;
 
 static const auto kInitialGCDelay = std::chrono::minutes(1);
 static const auto kRegularGCDelay = std::chrono::minutes(5);
+/** Delay between the slices of an incremental garbage collection. */
+static const auto kGCSliceDelay = std::chrono::milliseconds(100);
 
 /** How long we wait to try running index backfill after SDK initialization. */
 static const auto kInitialBackfillDelay = std::chrono::seconds(15);
 /** Minimum amount of time between backfill checks, after the first one. */
 static const auto kRegularBackfillDelay = std::chrono::minutes(1);
+/**
+ * Time between backfill checks while the last check found documents to index
+ * and the backfill budget is adaptive.
+ */
+static const auto kBusyBackfillDelay = std::chrono::seconds(1);
+
+/** Delay between the slices of the migrations deferred past startup. */
+static const auto kDeferredMigrationDelay = std::chrono::milliseconds(100);
 
 }  // namespace
 
@@ -204,11 +222,15 @@ void FirestoreClient::Initialize(const User& user, const Settings& settings) {
   // Note: The initialization work must all be synchronous (we can't dispatch
   // more work) since external write/listen operations could get queued to run
   // before that subsequent work completes.
+  size_t remote_event_chunk_size = 0;
   if (settings.persistence_enabled()) {
     LevelDbOpener opener(database_info_);
 
-    auto created =
-        opener.Create(LruParams::WithCacheSize(settings.cache_size_bytes()));
+    LevelDbProfile profile = LevelDbProfile::ForSettings(settings);
+    remote_event_chunk_size = profile.remote_event_chunk_size;
+    LruParams lru_params = LruParams::WithCacheSize(settings.cache_size_bytes());
+    lru_params.slice_duration_ms = profile.gc_slice_duration_ms;
+    auto created = opener.Create(lru_params, profile);
     // If leveldb fails to start then just throw up our hands: the error is
     // unrecoverable. There's nothing an end-user can do and nearly all
     // failures indicate the developer is doing something grossly wrong so we
@@ -244,6 +266,29 @@ void FirestoreClient::Initialize(const User& user, const Settings& settings) {
   query_engine_ = absl::make_unique<QueryEngine>();
   local_store_ = absl::make_unique<LocalStore>(persistence_.get(),
                                                query_engine_.get(), user);
+  local_store_->SetRemoteEventChunkSize(remote_event_chunk_size);
+  // Only LevelDB persistence indexes in the background.
+  local_store_->SetAdaptiveBackfillEnabled(settings.persistence_enabled());
+  adaptive_backfill_ = settings.persistence_enabled();
+
+  // Background work gives way to user-facing operations that queue up behind
+  // it. The queue outlives both the local store and the garbage collector.
+  util::AsyncQueue* queue = worker_queue_.get();
+  auto should_yield = [queue] { return queue->HasPendingOperations(); };
+  local_store_->SetBackfillShouldYield(should_yield);
+  if (lru_delegate_) {
+    lru_delegate_->garbage_collector()->SetShouldYield(should_yield);
+  }
+  // Caches that can be rebuilt from storage give memory back to the system
+  // when it runs short, and gRPC bounds what the network may use.
+  memory_pressure_monitor_ = MemoryPressureMonitor::Create(
+      worker_queue_, [this](util::MemoryPressure pressure) {
+        persistence_->ReleaseMemory(pressure);
+        if (remote_store_) {
+          remote_store_->ReleaseMemory(pressure);
+        }
+      });
+
   connectivity_monitor_ = ConnectivityMonitor::Create(worker_queue_);
   auto datastore = std::make_shared<Datastore>(
       database_info_, worker_queue_, auth_credentials_provider_,
@@ -259,18 +304,39 @@ void FirestoreClient::Initialize(const User& user, const Settings& settings) {
   sync_engine_ =
       absl::make_unique<SyncEngine>(local_store_.get(), remote_store_.get(),
                                     user, kMaxConcurrentLimboResolutions);
+  // View changes are computed concurrently when many queries are listened to.
+  auto hw_concurrency = std::thread::hardware_concurrency();
+  if (hw_concurrency > 1) {
+    sync_engine_->EnableParallelViewComputation(
+        static_cast<int>(hw_concurrency));
+  }
+  if (settings.last_results_persistence_enabled()) {
+    sync_engine_->EnableLastResultPersistence();
+  }
 
-  event_manager_ = absl::make_unique<EventManager>(sync_engine_.get());
+  event_manager_ =
+      absl::make_unique<EventManager>(sync_engine_.get(), worker_queue_);
 
   // Setup wiring for remote store.
   remote_store_->set_sync_engine(sync_engine_.get());
+  if (settings.write_coalescing_enabled()) {
+    remote_store_->EnableWriteCoalescing();
+  }
 
   // NOTE: RemoteStore depends on LocalStore (for persisting stream tokens,
   // refilling mutation queue, etc.) so must be started after LocalStore.
   local_store_->Start();
   remote_store_->Start();
 
+  if (local_store_->SupportsConcurrentReads()) {
+    read_executor_ = Executor::CreateConcurrent(
+        "com.google.firebase.firestore.read",
+        std::max(static_cast<int>(hw_concurrency), 2));
+    concurrent_reads_.store(true, std::memory_order_release);
+  }
+
   ScheduleIndexBackfiller();
+  ScheduleDeferredMigrations();
 }
 
 FirestoreClient::~FirestoreClient() {
@@ -333,7 +399,17 @@ void FirestoreClient::TerminateInternal() {
 
   backfiller_callback_.Cancel();
 
+  migration_callback_.Cancel();
+
+  memory_pressure_monitor_.reset();
   remote_store_->Shutdown();
+
+  // Reads that are still running use the local store, so wait for them
+  // before it goes away. Reads issued from now on are rejected.
+  concurrent_reads_.store(false, std::memory_order_release);
+  if (read_executor_) {
+    read_executor_->Dispose();
+  }
   persistence_->Shutdown();
 
   local_store_.reset();
@@ -347,11 +423,16 @@ void FirestoreClient::TerminateInternal() {
 void FirestoreClient::ScheduleLruGarbageCollection() {
   std::chrono::milliseconds delay =
       gc_has_run_ ? kRegularGCDelay : kInitialGCDelay;
+  if (gc_in_progress_) {
+    delay = kGCSliceDelay;
+  }
 
   lru_callback_ = worker_queue_->EnqueueAfterDelay(
       delay, TimerId::GarbageCollectionDelay, [this] {
-        local_store_->CollectGarbage(lru_delegate_->garbage_collector());
+        local::LruResults results =
+            local_store_->CollectGarbage(lru_delegate_->garbage_collector());
         gc_has_run_ = true;
+        gc_in_progress_ = !results.complete;
         ScheduleLruGarbageCollection();
       });
 }
@@ -359,15 +440,27 @@ void FirestoreClient::ScheduleLruGarbageCollection() {
 void FirestoreClient::ScheduleIndexBackfiller() {
   std::chrono::milliseconds delay =
       backfiller_has_run_ ? kRegularBackfillDelay : kInitialBackfillDelay;
+  if (backfiller_has_run_ && adaptive_backfill_ && backfiller_found_work_) {
+    delay = kBusyBackfillDelay;
+  }
 
   backfiller_callback_ = worker_queue_->EnqueueAfterDelay(
       delay, TimerId::IndexBackfillDelay, [this] {
-        local_store_->Backfill();
+        backfiller_found_work_ = local_store_->Backfill() > 0;
         backfiller_has_run_ = true;
         ScheduleIndexBackfiller();
       });
 }
 
+void FirestoreClient::ScheduleDeferredMigrations() {
+  migration_callback_ = worker_queue_->EnqueueAfterDelay(
+      kDeferredMigrationDelay, TimerId::DeferredMigrationDelay, [this] {
+        if (persistence_->RunDeferredMigrations()) {
+          ScheduleDeferredMigrations();
+        }
+      });
+}
+
 void FirestoreClient::DisableNetwork(StatusCallback callback) {
   VerifyNotTerminated();
 
@@ -426,6 +519,13 @@ std::shared_ptr<QueryListener> FirestoreClient::ListenToQuery(
     ViewSnapshotSharedListener&& listener) {
   VerifyNotTerminated();
 
+  // Traces the listen up to its first snapshot, unless the caller traces it.
+  std::shared_ptr<OperationTrace> trace = OperationTrace::Current();
+  if (!trace) {
+    trace = OperationTrace::Start("Listen");
+  }
+  TraceScope trace_scope(std::move(trace));
+
   auto query_listener = QueryListener::Create(
       std::move(query), std::move(options), std::move(listener));
 
@@ -453,8 +553,10 @@ void FirestoreClient::GetDocumentFromLocalCache(
 
   // TODO(c++14): move `callback` into lambda.
   auto shared_callback = absl::ShareUniquePtr(std::move(callback));
-  worker_queue_->Enqueue([this, doc, shared_callback] {
-    Document document = local_store_->ReadDocument(doc.key());
+  ReadFromLocalCache([this, doc, shared_callback](bool concurrently) {
+    Document document = concurrently
+                            ? local_store_->ReadDocumentConcurrently(doc.key())
+                            : local_store_->ReadDocument(doc.key());
     StatusOr<DocumentSnapshot> maybe_snapshot;
 
     if (document->is_found_document()) {
@@ -475,6 +577,11 @@ void FirestoreClient::GetDocumentFromLocalCache(
                  "FirestoreSourceCache to attempt to retrieve the document "};
     }
 
+    if (const std::shared_ptr<OperationTrace>& trace =
+            OperationTrace::Current()) {
+      trace->Finish();
+    }
+
     if (shared_callback) {
       user_executor_->Execute(
           [=] { shared_callback->OnEvent(std::move(maybe_snapshot)); });
@@ -482,38 +589,92 @@ void FirestoreClient::GetDocumentFromLocalCache(
   });
 }
 
+QueryResult FirestoreClient::ExecuteQueryFromLocalCache(const Query& query,
+                                                        bool concurrently) {
+  if (concurrently) {
+    return local_store_->ExecuteQueryConcurrently(query);
+  }
+
+  // A listener on the query, or on a broader one, already holds the
+  // documents, which saves running the query against the local store again.
+  absl::optional<QueryResult> from_views =
+      sync_engine_->ExecuteQueryFromViews(query);
+  if (from_views.has_value()) {
+    return std::move(from_views).value();
+  }
+  return local_store_->ExecuteQuery(QueryOrPipeline(query),
+                                    /* use_previous_results= */ true);
+}
+
+void FirestoreClient::ReadFromLocalCache(
+    std::function<bool()> can_run_concurrently,
+    std::function<void(bool concurrently)> read) {
+  if (concurrent_reads_.load(std::memory_order_acquire)) {
+    // The worker queue carries the trace of the operation along, but the
+    // executor does not. `can_run_concurrently` may use the local store, which
+    // the executor outlives, so it runs there rather than on this thread.
+    std::shared_ptr<OperationTrace> trace = OperationTrace::Current();
+    read_executor_->Execute([this, can_run_concurrently, read, trace] {
+      TraceScope trace_scope(trace);
+      if (!can_run_concurrently()) {
+        worker_queue_->Enqueue([read] { read(/* concurrently= */ false); });
+        return;
+      }
+      read(/* concurrently= */ true);
+    });
+  } else {
+    worker_queue_->Enqueue([read] { read(/* concurrently= */ false); });
+  }
+}
+
+void FirestoreClient::ReadFromLocalCache(
+    std::function<void(bool concurrently)> read) {
+  ReadFromLocalCache([] { return true; }, std::move(read));
+}
+
 void FirestoreClient::GetDocumentsFromLocalCache(
     const api::Query& query, QuerySnapshotListener&& callback) {
   VerifyNotTerminated();
 
   // TODO(c++14): move `callback` into lambda.
   auto shared_callback = absl::ShareUniquePtr(std::move(callback));
-  worker_queue_->Enqueue([this, query, shared_callback] {
-    QueryResult query_result = local_store_->ExecuteQuery(
-        QueryOrPipeline(query.query()), /* use_previous_results= */ true);
-
-    View view(QueryOrPipeline(query.query()), query_result.remote_keys());
-    ViewDocumentChanges view_doc_changes =
-        view.ComputeDocumentChanges(query_result.documents());
-    ViewChange view_change = view.ApplyChanges(view_doc_changes);
-    HARD_ASSERT(
-        view_change.limbo_changes().empty(),
-        "View returned limbo documents during local-only query execution.");
-
-    HARD_ASSERT(view_change.snapshot().has_value(), "Expected a snapshot");
-
-    ViewSnapshot snapshot = std::move(view_change.snapshot()).value();
-    SnapshotMetadata metadata(snapshot.has_pending_writes(),
-                              snapshot.from_cache());
-
-    QuerySnapshot result(query.firestore(), query.query(), std::move(snapshot),
-                         std::move(metadata));
+  ReadFromLocalCache(
+      [this, query] {
+        return local_store_->CanExecuteQueryConcurrently(query.query());
+      },
+      [this, query, shared_callback](bool concurrently) {
+        QueryResult query_result =
+            ExecuteQueryFromLocalCache(query.query(), concurrently);
+
+        View view(QueryOrPipeline(query.query()),
+                  query_result.remote_keys());
+        ViewDocumentChanges view_doc_changes =
+            view.ComputeDocumentChanges(query_result.documents());
+        ViewChange view_change = view.ApplyChanges(view_doc_changes);
+        HARD_ASSERT(view_change.limbo_changes().empty(),
+                    "View returned limbo documents during local-only query "
+                    "execution.");
+
+        HARD_ASSERT(view_change.snapshot().has_value(),
+                    "Expected a snapshot");
+
+        ViewSnapshot snapshot = std::move(view_change.snapshot()).value();
+        SnapshotMetadata metadata(snapshot.has_pending_writes(),
+                                  snapshot.from_cache());
+
+        QuerySnapshot result(query.firestore(), query.query(),
+                             std::move(snapshot), std::move(metadata));
+
+        if (const std::shared_ptr<OperationTrace>& trace =
+                OperationTrace::Current()) {
+          trace->Finish();
+        }
 
-    if (shared_callback) {
-      user_executor_->Execute(
-          [=] { shared_callback->OnEvent(std::move(result)); });
-    }
-  });
+        if (shared_callback) {
+          user_executor_->Execute(
+              [=] { shared_callback->OnEvent(std::move(result)); });
+        }
+      });
 }
 
 void FirestoreClient::WriteMutations(std::vector<Mutation>&& mutations,
@@ -577,6 +738,38 @@ void FirestoreClient::RunAggregateQuery(
   });
 }
 
+void FirestoreClient::RunAggregateQueryFromLocalCache(
+    const Query& query,
+    const std::vector<AggregateField>& aggregates,
+    api::AggregateQueryCallback&& result_callback) {
+  VerifyNotTerminated();
+
+  // Dispatch the result back onto the user dispatch queue.
+  auto async_callback = [this,
+                         result_callback](const StatusOr<ObjectValue>& status) {
+    if (result_callback) {
+      user_executor_->Execute([=] { result_callback(std::move(status)); });
+    }
+  };
+
+  ReadFromLocalCache(
+      [this, query] {
+        return local_store_->CanExecuteQueryConcurrently(query);
+      },
+      [this, query, aggregates, async_callback](bool concurrently) {
+        QueryResult query_result =
+            ExecuteQueryFromLocalCache(query, concurrently);
+
+        // Run the results through a view so that the limit and bounds of the
+        // query apply as they do when the documents themselves are read.
+        View view(QueryOrPipeline(query), query_result.remote_keys());
+        ViewDocumentChanges view_doc_changes =
+            view.ComputeDocumentChanges(query_result.documents());
+        async_callback(ComputeLocalAggregates(view_doc_changes.document_set(),
+                                              aggregates));
+      });
+}
+
 void FirestoreClient::RunPipeline(
     const api::Pipeline& pipeline,
     util::StatusOrCallback<api::PipelineSnapshot> callback) {
@@ -639,6 +832,12 @@ void FirestoreClient::LoadBundle(
       remote::Serializer(database_info_.database_id()));
   auto reader = std::make_shared<bundle::BundleReader>(
       std::move(bundle_serializer), std::move(bundle_data));
+  // Parsing the JSON of the documents dominates the time it takes to load a
+  // large bundle, so it is spread over the cores.
+  auto hw_concurrency = std::thread::hardware_concurrency();
+  if (hw_concurrency > 1) {
+    reader->EnableParallelDecode(static_cast<int>(hw_concurrency));
+  }
   worker_queue_->Enqueue([this, reader, result_task] {
     sync_engine_->LoadBundle(std::move(reader), std::move(result_task));
   });
@@ -668,8 +867,9 @@ void FirestoreClient::GetNamedQuery(const std::string& name,
         }
       };
 
-  worker_queue_->Enqueue([this, name, async_callback] {
-    async_callback(local_store_->GetNamedQuery(name));
+  ReadFromLocalCache([this, name, async_callback](bool concurrently) {
+    async_callback(concurrently ? local_store_->GetNamedQueryConcurrently(name)
+                                : local_store_->GetNamedQuery(name));
   });
 }
 
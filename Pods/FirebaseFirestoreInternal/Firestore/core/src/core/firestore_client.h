@@ -17,6 +17,8 @@
 #ifndef FIRESTORE_CORE_SRC_CORE_FIRESTORE_CLIENT_H_
 #define FIRESTORE_CORE_SRC_CORE_FIRESTORE_CLIENT_H_
 
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -35,6 +37,7 @@
 #include "Firestore/core/src/util/delayed_constructor.h"
 #include "Firestore/core/src/util/empty.h"
 #include "Firestore/core/src/util/executor.h"
+#include "Firestore/core/src/util/memory_pressure_monitor.h"
 #include "Firestore/core/src/util/nullability.h"
 #include "Firestore/core/src/util/status_fwd.h"
 
@@ -46,6 +49,7 @@ class LocalStore;
 class LruDelegate;
 class Persistence;
 class QueryEngine;
+class QueryResult;
 }  // namespace local
 
 namespace model {
@@ -161,6 +165,15 @@ class FirestoreClient : public std::enable_shared_from_this<FirestoreClient> {
                          const std::vector<model::AggregateField>& aggregates,
                          api::AggregateQueryCallback&& result_callback);
 
+  /**
+   * Computes the aggregates over the results of the given query in the local
+   * cache, without contacting the backend.
+   */
+  void RunAggregateQueryFromLocalCache(
+      const Query& query,
+      const std::vector<model::AggregateField>& aggregates,
+      api::AggregateQueryCallback&& result_callback);
+
   void RunPipeline(const api::Pipeline& pipeline,
                    util::StatusOrCallback<api::PipelineSnapshot> callback);
 
@@ -224,6 +237,26 @@ class FirestoreClient : public std::enable_shared_from_this<FirestoreClient> {
 
   void TerminateInternal();
 
+  /**
+   * Reads the documents that can match `query` from the local cache, for
+   * reads that do not go to the backend. If `concurrently`, runs off the
+   * worker queue; see `LocalStore::ExecuteQueryConcurrently`.
+   */
+  local::QueryResult ExecuteQueryFromLocalCache(const Query& query,
+                                                bool concurrently);
+
+  /**
+   * Runs `read` on `read_executor_` if the local store supports concurrent
+   * reads and `can_run_concurrently` returns true there, and on the worker
+   * queue otherwise. `read` is told which, and must only use the concurrent
+   * `LocalStore` reads if it runs concurrently.
+   */
+  void ReadFromLocalCache(std::function<bool()> can_run_concurrently,
+                          std::function<void(bool concurrently)> read);
+
+  /** Like above, for reads that can always run concurrently. */
+  void ReadFromLocalCache(std::function<void(bool concurrently)> read);
+
   /**
    * Schedules a callback to try running LRU garbage collection. Reschedules
    * itself after the GC has run.
@@ -236,6 +269,12 @@ class FirestoreClient : public std::enable_shared_from_this<FirestoreClient> {
    */
   void ScheduleIndexBackfiller();
 
+  /**
+   * Schedules a callback to run a slice of the schema migrations left to be
+   * done after startup. Reschedules itself until they are complete.
+   */
+  void ScheduleDeferredMigrations();
+
   DatabaseInfo database_info_;
   std::shared_ptr<credentials::AppCheckCredentialsProvider>
       app_check_credentials_provider_;
@@ -257,16 +296,31 @@ class FirestoreClient : public std::enable_shared_from_this<FirestoreClient> {
   std::unique_ptr<local::LocalStore> local_store_;
   std::unique_ptr<local::QueryEngine> query_engine_;
   std::unique_ptr<remote::ConnectivityMonitor> connectivity_monitor_;
+  std::unique_ptr<util::MemoryPressureMonitor> memory_pressure_monitor_;
   std::unique_ptr<remote::RemoteStore> remote_store_;
   std::unique_ptr<SyncEngine> sync_engine_;
   std::unique_ptr<EventManager> event_manager_;
 
+  /**
+   * Runs the reads of the local cache that do not need the worker queue, so
+   * that they neither wait behind remote events and writes nor behind each
+   * other. Created by `Initialize` if the local store supports concurrent
+   * reads, which `concurrent_reads_` then publishes to the API threads;
+   * disposed of on termination.
+   */
+  std::unique_ptr<util::Executor> read_executor_;
+  std::atomic<bool> concurrent_reads_{false};
+
   bool gc_has_run_ = false;
+  bool gc_in_progress_ = false;
   bool backfiller_has_run_ = false;
+  bool backfiller_found_work_ = false;
+  bool adaptive_backfill_ = false;
   bool credentials_initialized_ = false;
-  local::LruDelegate* _Nullable lru_delegate_;
+  local::LruDelegate* _Nullable lru_delegate_ = nullptr;
   util::DelayedOperation lru_callback_;
   util::DelayedOperation backfiller_callback_;
+  util::DelayedOperation migration_callback_;
 };
 
 }  // namespace core
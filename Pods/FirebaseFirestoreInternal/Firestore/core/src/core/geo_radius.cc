@@ -0,0 +1,112 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/core/geo_radius.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "Firestore/Protos/nanopb/google/firestore/v1/document.nanopb.h"
+#include "Firestore/core/src/core/field_filter.h"
+#include "Firestore/core/src/model/document.h"
+#include "Firestore/core/src/model/mutable_document.h"
+#include "Firestore/core/src/nanopb/message.h"
+#include "Firestore/core/src/util/hard_assert.h"
+
+namespace firebase {
+namespace firestore {
+namespace core {
+namespace {
+
+using model::FieldPath;
+using nanopb::MakeSharedMessage;
+using Operator = FieldFilter::Operator;
+using nanopb::SharedMessage;
+
+/** The mean radius of the earth, in meters. */
+constexpr double kEarthRadiusMeters = 6371008.8;
+
+constexpr double kPi = 3.14159265358979323846;
+
+double ToRadians(double degrees) {
+  return degrees * kPi / 180;
+}
+
+SharedMessage<google_firestore_v1_Value> GeoPointValue(double latitude,
+                                                       double longitude) {
+  google_firestore_v1_Value value{};
+  value.which_value_type = google_firestore_v1_Value_geo_point_value_tag;
+  value.geo_point_value.latitude = latitude;
+  value.geo_point_value.longitude = longitude;
+  return MakeSharedMessage(value);
+}
+
+}  // namespace
+
+GeoRadius::GeoRadius(FieldPath field, GeoPoint center, double radius_meters)
+    : field_(std::move(field)),
+      center_(std::move(center)),
+      radius_meters_(radius_meters) {
+  HARD_ASSERT(radius_meters_ >= 0, "Radius must not be negative: %s",
+              radius_meters_);
+}
+
+Query GeoRadius::BoundingQuery(const Query& query) const {
+  HARD_ASSERT(!query.has_limit(),
+              "A radius query can't be limited before filtering");
+
+  // Every point within the radius is at most this many degrees of latitude
+  // away from the center: a meridian is a great circle.
+  double delta = radius_meters_ / kEarthRadiusMeters * 180 / kPi;
+  double lower = std::max(-90.0, center_.latitude() - delta);
+  double upper = std::min(90.0, center_.latitude() + delta);
+
+  return query
+      .AddingFilter(FieldFilter::Create(field_, Operator::GreaterThanOrEqual,
+                                        GeoPointValue(lower, -180)))
+      .AddingFilter(FieldFilter::Create(field_, Operator::LessThanOrEqual,
+                                        GeoPointValue(upper, 180)));
+}
+
+bool GeoRadius::Matches(const model::Document& doc) const {
+  absl::optional<google_firestore_v1_Value> value = doc->field(field_);
+  if (!value || value->which_value_type !=
+                    google_firestore_v1_Value_geo_point_value_tag) {
+    return false;
+  }
+
+  GeoPoint point(value->geo_point_value.latitude,
+                 value->geo_point_value.longitude);
+  return DistanceMeters(center_, point) <= radius_meters_;
+}
+
+double GeoRadius::DistanceMeters(const GeoPoint& from, const GeoPoint& to) {
+  // The haversine formula, which stays accurate for small distances.
+  double from_latitude = ToRadians(from.latitude());
+  double to_latitude = ToRadians(to.latitude());
+  double sin_latitude = std::sin((to_latitude - from_latitude) / 2);
+  double sin_longitude =
+      std::sin(ToRadians(to.longitude() - from.longitude()) / 2);
+  double h = sin_latitude * sin_latitude + std::cos(from_latitude) *
+                                               std::cos(to_latitude) *
+                                               sin_longitude * sin_longitude;
+  return 2 * kEarthRadiusMeters * std::asin(std::min(1.0, std::sqrt(h)));
+}
+
+}  // namespace core
+}  // namespace firestore
+}  // namespace firebase
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_CORE_GEO_RADIUS_H_
+#define FIRESTORE_CORE_SRC_CORE_GEO_RADIUS_H_
+
+#include "Firestore/core/include/firebase/firestore/geo_point.h"
+#include "Firestore/core/src/core/query.h"
+#include "Firestore/core/src/model/field_path.h"
+
+namespace firebase {
+namespace firestore {
+
+namespace model {
+class Document;
+}  // namespace model
+
+namespace core {
+
+/**
+ * A circle on the surface of the earth, matching the documents whose GeoPoint
+ * field lies within it.
+ *
+ * GeoPoints sort by latitude first, so the latitudes a circle spans form a
+ * single range of values. `BoundingQuery()` narrows a query to that range,
+ * which an ascending index on the field serves as one scan (on the server as
+ * well as locally); `Matches()` then drops the documents outside the circle.
+ */
+class GeoRadius {
+ public:
+  GeoRadius(model::FieldPath field, GeoPoint center, double radius_meters);
+
+  const model::FieldPath& field() const {
+    return field_;
+  }
+
+  const GeoPoint& center() const {
+    return center_;
+  }
+
+  double radius_meters() const {
+    return radius_meters_;
+  }
+
+  /**
+   * Returns `query` with filters restricting the field to the latitudes the
+   * circle spans. `query` must not have a limit, since some of the documents
+   * in the range may lie outside the circle.
+   */
+  Query BoundingQuery(const Query& query) const;
+
+  /** Returns true if the field of `doc` is a GeoPoint within the circle. */
+  bool Matches(const model::Document& doc) const;
+
+  /** Returns the great-circle distance between two points, in meters. */
+  static double DistanceMeters(const GeoPoint& from, const GeoPoint& to);
+
+ private:
+  model::FieldPath field_;
+  GeoPoint center_;
+  double radius_meters_ = 0;
+};
+
+}  // namespace core
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_CORE_GEO_RADIUS_H_
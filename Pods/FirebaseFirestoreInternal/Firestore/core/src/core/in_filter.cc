@@ -57,7 +57,8 @@ InFilter::InFilter(const FieldPath& field,
 
 bool InFilter::Rep::Matches(const Document& doc) const {
   const google_firestore_v1_ArrayValue& array_value = value().array_value;
-  absl::optional<google_firestore_v1_Value> maybe_lhs = doc->field(field());
+  absl::optional<google_firestore_v1_Value> maybe_lhs =
+      doc->field(field_accessor());
   if (!maybe_lhs) return false;
   return Contains(array_value, *maybe_lhs);
 }
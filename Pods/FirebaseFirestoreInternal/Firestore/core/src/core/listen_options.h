@@ -17,6 +17,7 @@
 #ifndef FIRESTORE_CORE_SRC_CORE_LISTEN_OPTIONS_H_
 #define FIRESTORE_CORE_SRC_CORE_LISTEN_OPTIONS_H_
 
+#include <chrono>  // NOLINT(build/c++11)
 #include <utility>
 #include "Firestore/core/src/api/listen_source.h"
 namespace firebase {
@@ -155,12 +156,32 @@ class ListenOptions {
     return server_timestamp_;
   }
 
+  /**
+   * The minimum time between two events raised after the initial one. Changes
+   * that arrive sooner are merged into a single event raised once the interval
+   * has passed. Zero, the default, raises every event as it happens.
+   */
+  std::chrono::milliseconds min_event_interval() const {
+    return min_event_interval_;
+  }
+
+  /**
+   * Returns a copy of these options that raises events at most once per
+   * `interval`.
+   */
+  ListenOptions WithMinEventInterval(std::chrono::milliseconds interval) const {
+    ListenOptions result = *this;
+    result.min_event_interval_ = interval;
+    return result;
+  }
+
  private:
   bool include_query_metadata_changes_ = false;
   bool include_document_metadata_changes_ = false;
   bool wait_for_sync_when_online_ = false;
   ListenSource source_ = ListenSource::Default;
   ServerTimestampBehavior server_timestamp_ = ServerTimestampBehavior::kNone;
+  std::chrono::milliseconds min_event_interval_{0};
 };
 
 }  // namespace core
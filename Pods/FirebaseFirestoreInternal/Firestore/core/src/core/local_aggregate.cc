@@ -0,0 +1,129 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "Firestore/core/src/core/local_aggregate.h"
+
+#include <cstdint>
+#include <limits>
+
+#include "Firestore/core/src/model/document.h"
+#include "Firestore/core/src/model/value_util.h"
+#include "Firestore/core/src/nanopb/message.h"
+#include "Firestore/core/src/util/hard_assert.h"
+#include "absl/types/optional.h"
+
+namespace firebase {
+namespace firestore {
+namespace core {
+
+using model::AggregateField;
+using model::Document;
+using model::DocumentSet;
+using model::FieldPath;
+using model::ObjectValue;
+using nanopb::Message;
+
+namespace {
+
+/** Accumulates the numeric values of a field the way the backend does. */
+class NumericAccumulator {
+ public:
+  void Add(const google_firestore_v1_Value& value) {
+    ++count_;
+    if (value.which_value_type == google_firestore_v1_Value_double_value_tag) {
+      is_double_ = true;
+      double_sum_ += value.double_value;
+      return;
+    }
+
+    int64_t addend = value.integer_value;
+    double_sum_ += static_cast<double>(addend);
+    if (is_double_) return;
+
+    bool overflows =
+        addend > 0
+            ? integer_sum_ > std::numeric_limits<int64_t>::max() - addend
+            : integer_sum_ < std::numeric_limits<int64_t>::min() - addend;
+    if (overflows) {
+      is_double_ = true;
+    } else {
+      integer_sum_ += addend;
+    }
+  }
+
+  Message<google_firestore_v1_Value> Sum() const {
+    Message<google_firestore_v1_Value> result;
+    if (is_double_) {
+      result->which_value_type = google_firestore_v1_Value_double_value_tag;
+      result->double_value = double_sum_;
+    } else {
+      result->which_value_type = google_firestore_v1_Value_integer_value_tag;
+      result->integer_value = integer_sum_;
+    }
+    return result;
+  }
+
+  Message<google_firestore_v1_Value> Average() const {
+    Message<google_firestore_v1_Value> result;
+    if (count_ == 0) {
+      *result = model::NullValue();
+    } else {
+      result->which_value_type = google_firestore_v1_Value_double_value_tag;
+      result->double_value = double_sum_ / static_cast<double>(count_);
+    }
+    return result;
+  }
+
+ private:
+  int64_t count_ = 0;
+  int64_t integer_sum_ = 0;
+  double double_sum_ = 0;
+  bool is_double_ = false;
+};
+
+}  // namespace
+
+ObjectValue ComputeLocalAggregates(
+    const DocumentSet& documents,
+    const std::vector<AggregateField>& aggregates) {
+  ObjectValue result;
+  for (const AggregateField& aggregate : aggregates) {
+    Message<google_firestore_v1_Value> value;
+    if (aggregate.op == AggregateField::OpKind::Count) {
+      value->which_value_type = google_firestore_v1_Value_integer_value_tag;
+      value->integer_value = static_cast<int64_t>(documents.size());
+    } else {
+      NumericAccumulator accumulator;
+      for (const Document& doc : documents) {
+        absl::optional<google_firestore_v1_Value> field =
+            doc->field(aggregate.fieldPath);
+        if (model::IsNumber(field)) {
+          accumulator.Add(*field);
+        }
+      }
+      value = aggregate.op == AggregateField::OpKind::Sum
+                  ? accumulator.Sum()
+                  : accumulator.Average();
+    }
+    result.Set(FieldPath{aggregate.alias.StringValue()}, std::move(value));
+  }
+  return result;
+}
+
+}  // namespace core
+}  // namespace firestore
+}  // namespace firebase
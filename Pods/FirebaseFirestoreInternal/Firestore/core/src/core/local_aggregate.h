@@ -0,0 +1,53 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef FIRESTORE_CORE_SRC_CORE_LOCAL_AGGREGATE_H_
+#define FIRESTORE_CORE_SRC_CORE_LOCAL_AGGREGATE_H_
+
+#include <vector>
+
+#include "Firestore/core/src/model/aggregate_field.h"
+#include "Firestore/core/src/model/document_set.h"
+#include "Firestore/core/src/model/object_value.h"
+
+namespace firebase {
+namespace firestore {
+namespace core {
+
+/**
+ * Computes `aggregates` over `documents`, the results of an aggregate query's
+ * base query, the way the backend does.
+ *
+ * The result maps the alias of each aggregate to its value, like the result
+ * of an aggregate query that ran on the backend:
+ *
+ *   - count() is the number of documents.
+ *   - sum() adds up the numeric values of the field, skipping documents where
+ *     it is missing or not a number. It is an integer unless a value is a
+ *     double or the sum overflows, and zero if there are no values.
+ *   - average() is the mean of the same values as a double, or null if there
+ *     are none.
+ */
+model::ObjectValue ComputeLocalAggregates(
+    const model::DocumentSet& documents,
+    const std::vector<model::AggregateField>& aggregates);
+
+}  // namespace core
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_CORE_LOCAL_AGGREGATE_H_
@@ -61,7 +61,8 @@ bool NotInFilter::Rep::Matches(const Document& doc) const {
   if (Contains(array_value, NullValue())) {
     return false;
   }
-  absl::optional<google_firestore_v1_Value> maybe_lhs = doc->field(field());
+  absl::optional<google_firestore_v1_Value> maybe_lhs =
+      doc->field(field_accessor());
   return maybe_lhs &&
          maybe_lhs->which_value_type !=
              google_firestore_v1_Value_null_value_tag &&
@@ -67,12 +67,12 @@ void AssertBothOptionalsHaveValues(
 ComparisonResult OrderBy::Compare(const Document& lhs,
                                   const Document& rhs) const {
   ComparisonResult result;
-  if (field_.IsKeyFieldPath()) {
+  if (field().IsKeyFieldPath()) {
     result = lhs->key().CompareTo(rhs->key());
   } else {
     absl::optional<google_firestore_v1_Value> value1 = lhs->field(field_);
     absl::optional<google_firestore_v1_Value> value2 = rhs->field(field_);
-    AssertBothOptionalsHaveValues(field_, value1, value2, lhs, rhs);
+    AssertBothOptionalsHaveValues(field(), value1, value2, lhs, rhs);
     result = model::Compare(*value1, *value2);
   }
 
@@ -80,12 +80,13 @@ ComparisonResult OrderBy::Compare(const Document& lhs,
 }
 
 std::string OrderBy::CanonicalId() const {
-  return absl::StrCat(field_.CanonicalString(), direction_.CanonicalId());
+  return absl::StrCat(field().CanonicalString(), direction_.CanonicalId());
 }
 
 std::string OrderBy::ToString() const {
   return util::StringFormat("OrderBy(path=%s, dir=%s)",
-                            field_.CanonicalString(), direction_.CanonicalId());
+                            field().CanonicalString(),
+                            direction_.CanonicalId());
 }
 
 std::ostream& operator<<(std::ostream& os, const OrderBy& order) {
@@ -23,6 +23,7 @@
 #include <utility>
 
 #include "Firestore/core/src/core/direction.h"
+#include "Firestore/core/src/model/field_accessor.h"
 #include "Firestore/core/src/model/field_path.h"
 
 namespace firebase {
@@ -60,7 +61,7 @@ class OrderBy {
 
   /** The field by which to sort. */
   const model::FieldPath& field() const {
-    return field_;
+    return field_.path();
   }
 
   /** The direction of the sort. */
@@ -85,7 +86,7 @@ class OrderBy {
   std::string ToString() const;
 
  private:
-  model::FieldPath field_;
+  model::FieldAccessor field_;
   Direction direction_;
 };
 
@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include <map>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -338,22 +339,29 @@ model::DocumentComparator QueryOrPipeline::Comparator() const {
     // Capture pipeline by reference. Orderings captured by value inside lambda.
     const api::RealtimePipeline& p = pipeline();
     const auto& orderings = GetLastEffectiveSortOrderings(p);
+
+    // Compile the ordering expressions once for all comparisons.
+    auto evaluables =
+        std::make_shared<std::vector<std::unique_ptr<EvaluableExpr>>>();
+    for (const auto& ordering : orderings) {
+      const api::Expr* expr = ordering.expr();
+      HARD_ASSERT(expr != nullptr, "Ordering expression cannot be null");
+      evaluables->push_back(expr->ToEvaluable());
+    }
+
     return model::DocumentComparator(
-        [p, orderings](const model::Document& d1,
-                       const model::Document& d2) -> util::ComparisonResult {
+        [p, orderings, evaluables](
+            const model::Document& d1,
+            const model::Document& d2) -> util::ComparisonResult {
           auto context =
               const_cast<api::RealtimePipeline&>(p).evaluate_context();
 
-          for (const auto& ordering : orderings) {
-            const api::Expr* expr = ordering.expr();
-            HARD_ASSERT(expr != nullptr, "Ordering expression cannot be null");
+          for (size_t i = 0; i < orderings.size(); ++i) {
+            const api::Ordering& ordering = orderings[i];
+            const EvaluableExpr& evaluable = *(*evaluables)[i];
 
-            // Evaluate expression for both documents using expr->Evaluate
-            // (assuming this method exists) Pass const references to documents.
-            EvaluateResult left_value =
-                expr->ToEvaluable()->Evaluate(context, d1.get());
-            EvaluateResult right_value =
-                expr->ToEvaluable()->Evaluate(context, d2.get());
+            EvaluateResult left_value = evaluable.Evaluate(context, d1.get());
+            EvaluateResult right_value = evaluable.Evaluate(context, d2.get());
 
             // Compare results, using MinValue for error
             util::ComparisonResult comparison = model::Compare(
@@ -279,16 +279,19 @@ model::DocumentComparator Query::Comparator() const {
       });
 }
 
-std::string Query::CanonicalId() const {
+std::shared_ptr<const std::string> Query::CalculateCanonicalId() const {
   if (limit_type_ != LimitType::None) {
-    return absl::StrCat(ToTarget().CanonicalId(),
-                        "|lt:", (limit_type_ == LimitType::Last) ? "l" : "f");
+    return std::make_shared<const std::string>(
+        absl::StrCat(ToTarget().CanonicalId(), "|lt:",
+                     (limit_type_ == LimitType::Last) ? "l" : "f"));
   }
-  return ToTarget().CanonicalId();
+  return std::make_shared<const std::string>(ToTarget().CanonicalId());
 }
 
 size_t Query::Hash() const {
-  return util::Hash(CanonicalId());
+  return memoized_hash_.value([this] {
+    return std::make_shared<const size_t>(util::Hash(CanonicalId()));
+  });
 }
 
 std::string Query::ToString() const {
@@ -242,7 +242,10 @@ class Query {
    */
   model::DocumentComparator Comparator() const;
 
-  std::string CanonicalId() const;
+  const std::string& CanonicalId() const {
+    const auto func = std::bind(&Query::CalculateCanonicalId, this);
+    return memoized_canonical_id_.value(func);
+  }
 
   std::string ToString() const;
 
@@ -314,6 +317,12 @@ class Query {
   // normalized order-bys, they only contain explicit order-bys.
   std::shared_ptr<Target> CalculateAggregateTarget() const;
   mutable util::ThreadSafeMemoizer<Target> memoized_aggregate_target_;
+
+  // The canonical ID and hash of this Query instance, which are looked up on
+  // every listen and unlisten.
+  std::shared_ptr<const std::string> CalculateCanonicalId() const;
+  mutable util::ThreadSafeMemoizer<const std::string> memoized_canonical_id_;
+  mutable util::ThreadSafeMemoizer<const size_t> memoized_hash_;
 };
 
 bool operator==(const Query& lhs, const Query& rhs);
@@ -31,6 +31,36 @@ namespace core {
 using model::OnlineState;
 using model::TargetId;
 using util::Status;
+using util::TimerId;
+
+namespace {
+
+/**
+ * Merges two consecutive snapshots of a query into one that describes the
+ * changes from the documents before `earlier` to the documents of `later`.
+ */
+ViewSnapshot MergeSnapshots(const ViewSnapshot& earlier,
+                            const ViewSnapshot& later) {
+  DocumentViewChangeSet change_set;
+  for (const ViewSnapshot* snapshot : {&earlier, &later}) {
+    for (const DocumentViewChange& change : snapshot->document_changes()) {
+      change_set.AddChange(DocumentViewChange{change});
+    }
+  }
+
+  return ViewSnapshot{
+      later.query_or_pipeline(),
+      later.documents(),
+      earlier.old_documents(),
+      change_set.GetSortedChanges(later.documents().comparator()),
+      later.mutated_keys(),
+      later.from_cache(),
+      earlier.sync_state_changed() || later.sync_state_changed(),
+      later.excludes_metadata_changes(),
+      later.has_cached_results()};
+}
+
+}  // namespace
 
 std::shared_ptr<QueryListener> QueryListener::Create(
     QueryOrPipeline query,
@@ -67,7 +97,8 @@ QueryListener::QueryListener(QueryOrPipeline query,
                              ViewSnapshotSharedListener&& listener)
     : query_(std::move(query)),
       options_(std::move(options)),
-      listener_(std::move(listener)) {
+      listener_(std::move(listener)),
+      trace_(util::OperationTrace::Current()) {
   if (query_.IsPipeline()) {
     query_ = QueryOrPipeline(query_.pipeline().WithListenOptions(options_));
   }
@@ -104,7 +135,7 @@ bool QueryListener::OnViewSnapshot(ViewSnapshot snapshot) {
       raised_event = true;
     }
   } else if (ShouldRaiseEvent(snapshot)) {
-    listener_->OnEvent(snapshot);
+    RaiseEvent(snapshot);
     raised_event = true;
   }
 
@@ -113,7 +144,16 @@ bool QueryListener::OnViewSnapshot(ViewSnapshot snapshot) {
 }
 
 void QueryListener::OnError(Status error) {
+  CancelPendingEvent();
   listener_->OnEvent(std::move(error));
+  FinishTrace();
+}
+
+void QueryListener::FinishTrace() {
+  if (trace_) {
+    trace_->Finish();
+    trace_.reset();
+  }
 }
 
 /**
@@ -194,7 +234,64 @@ void QueryListener::RaiseInitialEvent(const ViewSnapshot& snapshot) {
       snapshot.mutated_keys(), snapshot.from_cache(),
       snapshot.excludes_metadata_changes(), snapshot.has_cached_results());
   raised_initial_event_ = true;
+  last_event_time_ = std::chrono::steady_clock::now();
   listener_->OnEvent(std::move(modified_snapshot));
+  FinishTrace();
+}
+
+void QueryListener::RaiseEvent(const ViewSnapshot& snapshot) {
+  std::chrono::milliseconds interval = options_.min_event_interval();
+  if (interval.count() <= 0 || !worker_queue_) {
+    listener_->OnEvent(snapshot);
+    return;
+  }
+
+  if (pending_event_) {
+    pending_event_ = MergeSnapshots(*pending_event_, snapshot);
+    return;
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  auto next_event_time = last_event_time_ + interval;
+  if (now >= next_event_time) {
+    last_event_time_ = now;
+    listener_->OnEvent(snapshot);
+    return;
+  }
+
+  pending_event_ = snapshot;
+  std::weak_ptr<QueryListener> weak_this = shared_from_this();
+  pending_event_operation_ = worker_queue_->EnqueueAfterDelay(
+      std::chrono::duration_cast<std::chrono::milliseconds>(next_event_time -
+                                                            now),
+      TimerId::ListenerEventCoalescingDelay, [weak_this] {
+        if (auto self = weak_this.lock()) {
+          self->RaisePendingEvent();
+        }
+      });
+}
+
+void QueryListener::RaisePendingEvent() {
+  HARD_ASSERT(pending_event_.has_value(), "No pending event to raise");
+  ViewSnapshot snapshot = std::move(*pending_event_);
+  pending_event_.reset();
+  pending_event_operation_ = {};
+
+  // Changes that were coalesced can cancel out, e.g. a document that was
+  // added and then removed again.
+  if (snapshot.document_changes().empty() &&
+      !options_.include_query_metadata_changes()) {
+    return;
+  }
+
+  last_event_time_ = std::chrono::steady_clock::now();
+  listener_->OnEvent(std::move(snapshot));
+}
+
+void QueryListener::CancelPendingEvent() {
+  pending_event_operation_.Cancel();
+  pending_event_operation_ = {};
+  pending_event_.reset();
 }
 
 }  // namespace core
@@ -17,6 +17,7 @@
 #ifndef FIRESTORE_CORE_SRC_CORE_QUERY_LISTENER_H_
 #define FIRESTORE_CORE_SRC_CORE_QUERY_LISTENER_H_
 
+#include <chrono>  // NOLINT(build/c++11)
 #include <memory>
 #include <utility>
 
@@ -25,7 +26,9 @@
 #include "Firestore/core/src/core/query.h"
 #include "Firestore/core/src/core/view_snapshot.h"
 #include "Firestore/core/src/model/types.h"
+#include "Firestore/core/src/util/async_queue.h"
 #include "Firestore/core/src/util/status_fwd.h"
+#include "Firestore/core/src/util/trace.h"
 #include "absl/types/optional.h"
 
 namespace firebase {
@@ -36,7 +39,7 @@ namespace core {
  * QueryListener takes a series of internal view snapshots and determines when
  * to raise user-facing events.
  */
-class QueryListener {
+class QueryListener : public std::enable_shared_from_this<QueryListener> {
  public:
   static std::shared_ptr<QueryListener> Create(
       QueryOrPipeline query,
@@ -90,12 +93,33 @@ class QueryListener {
   /** Returns whether a snapshot was raised. */
   virtual bool OnOnlineStateChanged(model::OnlineState online_state);
 
+  /**
+   * Sets the queue on which the events held back by the options' minimum event
+   * interval are raised. Without a queue, every event is raised as it happens.
+   */
+  void set_worker_queue(std::shared_ptr<util::AsyncQueue> worker_queue) {
+    worker_queue_ = std::move(worker_queue);
+  }
+
+  /** Drops the coalesced event that has not been raised yet, if any. */
+  void CancelPendingEvent();
+
  private:
   bool ShouldRaiseInitialEvent(const ViewSnapshot& snapshot,
                                model::OnlineState online_state) const;
   bool ShouldRaiseEvent(const ViewSnapshot& snapshot) const;
   void RaiseInitialEvent(const ViewSnapshot& snapshot);
 
+  /**
+   * Raises the event for `snapshot`, or merges it into the pending event if
+   * the last one was raised less than the minimum event interval ago.
+   */
+  void RaiseEvent(const ViewSnapshot& snapshot);
+  void RaisePendingEvent();
+
+  /** Finishes the trace of the listen, if any, once it raised an event. */
+  void FinishTrace();
+
   QueryOrPipeline query_;
   ListenOptions options_;
 
@@ -116,6 +140,21 @@ class QueryListener {
   model::OnlineState online_state_ = model::OnlineState::Unknown;
 
   absl::optional<ViewSnapshot> snapshot_;
+
+  std::shared_ptr<util::AsyncQueue> worker_queue_;
+
+  /** When the last event was raised to `listener_`. */
+  std::chrono::steady_clock::time_point last_event_time_;
+
+  /**
+   * The changes held back by the minimum event interval, merged into a single
+   * snapshot, and the operation that raises them.
+   */
+  absl::optional<ViewSnapshot> pending_event_;
+  util::DelayedOperation pending_event_operation_;
+
+  /** The trace of the listen, until its first event is raised. */
+  std::shared_ptr<util::OperationTrace> trace_;
 };
 
 }  // namespace core
@@ -16,6 +16,8 @@
 
 #include "Firestore/core/src/core/sync_engine.h"
 
+#include <algorithm>
+
 #include "Firestore/core/include/firebase/firestore/firestore_errors.h"
 #include "Firestore/core/src/bundle/bundle_element.h"
 #include "Firestore/core/src/bundle/bundle_loader.h"
@@ -36,6 +38,7 @@
 #include "Firestore/core/src/model/mutable_document.h"
 #include "Firestore/core/src/model/mutation_batch_result.h"
 #include "Firestore/core/src/util/async_queue.h"
+#include "Firestore/core/src/util/background_queue.h"
 #include "Firestore/core/src/util/log.h"
 #include "Firestore/core/src/util/status.h"
 #include "absl/strings/match.h"
@@ -60,6 +63,7 @@ using local::QueryResult;
 using local::TargetData;
 using model::AggregateField;
 using model::BatchId;
+using model::Document;
 using model::DocumentKey;
 using model::DocumentKeySet;
 using model::DocumentMap;
@@ -67,11 +71,14 @@ using model::DocumentUpdateMap;
 using model::kBatchIdUnknown;
 using model::ListenSequenceNumber;
 using model::MutableDocument;
+using model::MutationBatchResult;
 using model::SnapshotVersion;
 using model::TargetId;
 using remote::RemoteEvent;
 using remote::TargetChange;
 using util::AsyncQueue;
+using util::BackgroundQueue;
+using util::Executor;
 using util::Status;
 using util::StatusCallback;
 
@@ -79,6 +86,48 @@ using util::StatusCallback;
 // them don't need real sequence numbers.
 const ListenSequenceNumber kIrrelevantSequenceNumber = -1;
 
+// Below this many views, computing their changes serially is cheaper than
+// handing them to other threads.
+const size_t kMinViewsForParallelComputation = 8;
+
+// Documents in limbo are looked up in batches once this many are enqueued; a
+// single one is cheaper to listen to, as it needs no second round trip if it
+// stays in limbo.
+const size_t kMinLimboLookupBatchSize = 2;
+
+// The largest number of documents in limbo looked up by a single
+// BatchGetDocuments call.
+const size_t kMaxLimboLookupBatchSize = 100;
+
+/**
+ * Whether the results of `superset` without a limit include every document
+ * that can match `query`.
+ */
+bool IsSupersetQuery(const Query& superset, const Query& query) {
+  if (superset.has_limit() || superset.start_at() || superset.end_at() ||
+      !superset.explicit_order_bys().empty()) {
+    return false;
+  }
+  if (superset.path() != query.path()) {
+    return false;
+  }
+  const auto& superset_group = superset.collection_group();
+  const auto& query_group = query.collection_group();
+  if ((superset_group == nullptr) != (query_group == nullptr) ||
+      (superset_group && *superset_group != *query_group)) {
+    return false;
+  }
+
+  // Each filter of `superset` must also restrict `query`.
+  const std::vector<Filter>& filters = query.filters();
+  for (const Filter& filter : superset.filters()) {
+    if (std::find(filters.begin(), filters.end(), filter) == filters.end()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool ErrorIsInteresting(const Status& error) {
   bool missing_index =
       (error.code() == Error::kErrorFailedPrecondition &&
@@ -100,6 +149,11 @@ SyncEngine::SyncEngine(LocalStore* local_store,
       max_concurrent_limbo_resolutions_(max_concurrent_limbo_resolutions) {
 }
 
+void SyncEngine::EnableParallelViewComputation(int threads) {
+  view_executor_ = Executor::CreateConcurrent(
+      "com.google.firebase.firestore.views", threads);
+}
+
 void SyncEngine::AssertCallbackExists(absl::string_view source) {
   HARD_ASSERT(sync_engine_callback_,
               "Tried to call '%s' before callback was registered.", source);
@@ -117,12 +171,15 @@ TargetId SyncEngine::Listen(QueryOrPipeline query,
   TargetId target_id = target_data.target_id();
   nanopb::ByteString resume_token = target_data.resume_token();
 
-  ViewSnapshot view_snapshot = InitializeViewAndComputeSnapshot(
-      query, target_id, std::move(resume_token));
-  std::vector<ViewSnapshot> snapshots;
-  // Not using the `std::initializer_list` constructor to avoid extra copies.
-  snapshots.push_back(std::move(view_snapshot));
-  sync_engine_callback_->OnViewSnapshots(std::move(snapshots));
+  absl::optional<ViewSnapshot> view_snapshot =
+      InitializeViewAndComputeSnapshot(query, target_id,
+                                       std::move(resume_token));
+  if (view_snapshot) {
+    std::vector<ViewSnapshot> snapshots;
+    // Not using the `std::initializer_list` constructor to avoid extra copies.
+    snapshots.push_back(std::move(view_snapshot).value());
+    sync_engine_callback_->OnViewSnapshots(std::move(snapshots));
+  }
 
   if (should_listen_to_remote) {
     remote_store_->Listen(std::move(target_data));
@@ -130,18 +187,17 @@ TargetId SyncEngine::Listen(QueryOrPipeline query,
   return target_id;
 }
 
-ViewSnapshot SyncEngine::InitializeViewAndComputeSnapshot(
+absl::optional<ViewSnapshot> SyncEngine::InitializeViewAndComputeSnapshot(
     const QueryOrPipeline& query,
     TargetId target_id,
     nanopb::ByteString resume_token) {
-  QueryResult query_result =
-      local_store_->ExecuteQuery(query, /* use_previous_results= */ true);
-
   // If there are already queries mapped to the target id, create a synthesized
   // target change to apply the sync state from those queries to the new query.
   auto current_sync_state = SyncState::None;
   absl::optional<TargetChange> synthesized_current_change;
-  if (queries_by_target_.find(target_id) != queries_by_target_.end()) {
+  bool is_new_target =
+      queries_by_target_.find(target_id) == queries_by_target_.end();
+  if (!is_new_target) {
     const QueryOrPipeline& mirror_query = queries_by_target_[target_id][0];
     current_sync_state =
         query_views_by_query_[mirror_query]->view().sync_state();
@@ -149,23 +205,49 @@ ViewSnapshot SyncEngine::InitializeViewAndComputeSnapshot(
   synthesized_current_change = TargetChange::CreateSynthesizedTargetChange(
       current_sync_state == SyncState::Synced, std::move(resume_token));
 
-  View view(query, query_result.remote_keys());
+  absl::optional<QueryResult> last_result;
+  if (last_result_persistence_enabled_ && is_new_target) {
+    last_result = local_store_->ReadLastResult(query);
+  }
+
+  absl::optional<View> view;
+  if (last_result) {
+    // Show the documents of the last result before running the query. Every
+    // one of them that still matches is found by the query as well, so what
+    // follows only brings in the documents that started to match since.
+    view.emplace(query, last_result->remote_keys());
+    ViewChange view_change = view->ApplyChanges(
+        view->ComputeDocumentChanges(last_result->documents()),
+        synthesized_current_change);
+    UpdateTrackedLimboDocuments(view_change.limbo_changes(), target_id);
+    if (view_change.snapshot().has_value()) {
+      std::vector<ViewSnapshot> snapshots;
+      snapshots.push_back(std::move(view_change.snapshot()).value());
+      sync_engine_callback_->OnViewSnapshots(std::move(snapshots));
+    }
+  }
+
+  QueryResult query_result =
+      local_store_->ExecuteQuery(query, /* use_previous_results= */ true);
+  if (!view) {
+    view.emplace(query, query_result.remote_keys());
+  }
   ViewDocumentChanges view_doc_changes =
-      view.ComputeDocumentChanges(query_result.documents());
+      view->ComputeDocumentChanges(query_result.documents());
   ViewChange view_change =
-      view.ApplyChanges(view_doc_changes, synthesized_current_change);
+      view->ApplyChanges(view_doc_changes, synthesized_current_change);
   UpdateTrackedLimboDocuments(view_change.limbo_changes(), target_id);
 
   auto query_view =
-      std::make_shared<QueryView>(query, target_id, std::move(view));
+      std::make_shared<QueryView>(query, target_id, std::move(*view));
   query_views_by_query_[query] = query_view;
 
   queries_by_target_[target_id].push_back(query);
 
   HARD_ASSERT(
-      view_change.snapshot().has_value(),
+      last_result || view_change.snapshot().has_value(),
       "ApplyChanges to documents for new view should always return a snapshot");
-  return view_change.snapshot().value();
+  return view_change.snapshot();
 }
 
 void SyncEngine::ListenToRemoteStore(QueryOrPipeline query) {
@@ -296,11 +378,44 @@ void SyncEngine::RunAggregateQuery(
                                    std::move(result_callback));
 }
 
+absl::optional<QueryResult> SyncEngine::ExecuteQueryFromViews(
+    const Query& query) {
+  auto exact = query_views_by_query_.find(QueryOrPipeline(query));
+  QueryView* source = nullptr;
+  if (exact != query_views_by_query_.end()) {
+    source = exact->second.get();
+  } else {
+    for (const auto& entry : query_views_by_query_) {
+      if (!entry.first.IsPipeline() &&
+          IsSupersetQuery(entry.first.query(), query)) {
+        source = entry.second.get();
+        break;
+      }
+    }
+  }
+  if (source == nullptr) {
+    return absl::nullopt;
+  }
+
+  View& view = source->view();
+  DocumentMap documents;
+  for (const Document& doc : view.document_set()) {
+    if (query.Matches(doc)) {
+      documents = documents.insert(doc->key(), doc);
+    }
+  }
+  return QueryResult(std::move(documents), view.synced_documents());
+}
+
 void SyncEngine::HandleCredentialChange(const credentials::User& user) {
   bool user_changed = (current_user_ != user);
   current_user_ = user;
 
   if (user_changed) {
+    // Writes acknowledged by the previous user's stream belong to their
+    // mutation queue.
+    remote_store_->AcknowledgePendingWrites();
+
     // Fails callbacks waiting for pending writes requested by previous user.
     FailOutstandingPendingWriteCallbacks(
         "'waitForPendingWrites' callback is cancelled due to a user change.");
@@ -363,6 +478,7 @@ void SyncEngine::HandleRejectedListen(TargetId target_id, Status error) {
     // Since this query failed, we won't want to manually unlisten to it.
     // So go ahead and remove it from bookkeeping.
     active_limbo_targets_by_key_.erase(limbo_key);
+    looked_up_limbo_documents_.erase(limbo_key);
     active_limbo_resolutions_by_target_.erase(target_id);
     PumpEnqueuedLimboResolutions();
 
@@ -396,17 +512,26 @@ void SyncEngine::HandleRejectedListen(TargetId target_id, Status error) {
 
 void SyncEngine::HandleSuccessfulWrite(
     model::MutationBatchResult batch_result) {
-  AssertCallbackExists("HandleSuccessfulWrite");
+  std::vector<MutationBatchResult> batch_results;
+  batch_results.push_back(std::move(batch_result));
+  HandleSuccessfulWrites(std::move(batch_results));
+}
+
+void SyncEngine::HandleSuccessfulWrites(
+    std::vector<model::MutationBatchResult> batch_results) {
+  AssertCallbackExists("HandleSuccessfulWrites");
 
   // The local store may or may not be able to apply the write result and
   // raise events immediately (depending on whether the watcher is caught up),
   // so we raise user callbacks first so that they consistently happen before
   // listen events.
-  NotifyUser(batch_result.batch().batch_id(), Status::OK());
+  for (const MutationBatchResult& batch_result : batch_results) {
+    NotifyUser(batch_result.batch().batch_id(), Status::OK());
 
-  TriggerPendingWriteCallbacks(batch_result.batch().batch_id());
+    TriggerPendingWriteCallbacks(batch_result.batch().batch_id());
+  }
 
-  DocumentMap changes = local_store_->AcknowledgeBatch(batch_result);
+  DocumentMap changes = local_store_->AcknowledgeBatches(batch_results);
   EmitNewSnapshotsAndNotifyLocalStore(changes, absl::nullopt);
 }
 
@@ -436,6 +561,8 @@ void SyncEngine::HandleRejectedWrite(
 void SyncEngine::HandleOnlineStateChange(model::OnlineState online_state) {
   AssertCallbackExists("HandleOnlineStateChange");
 
+  online_state_ = online_state;
+
   std::vector<ViewSnapshot> new_view_snapshot;
   for (const auto& entry : query_views_by_query_) {
     const auto& query_view = entry.second;
@@ -516,10 +643,38 @@ void SyncEngine::EmitNewSnapshotsAndNotifyLocalStore(
   std::vector<ViewSnapshot> new_snapshots;
   std::vector<LocalViewChanges> document_changes_in_all_views;
 
+  std::vector<QueryView*> query_views;
+  query_views.reserve(query_views_by_query_.size());
   for (const auto& entry : query_views_by_query_) {
-    const auto& query_view = entry.second;
+    query_views.push_back(entry.second.get());
+  }
+
+  // Computing the changes of a view only reads the view and `changes`, so the
+  // views can be computed concurrently. Everything else below touches the
+  // local store or the state of this SyncEngine and stays on the queue.
+  std::vector<absl::optional<ViewDocumentChanges>> computed_changes(
+      query_views.size());
+  auto compute_changes = [&](size_t i) {
+    computed_changes[i] =
+        query_views[i]->view().ComputeDocumentChanges(changes);
+  };
+  if (view_executor_ &&
+      query_views.size() >= kMinViewsForParallelComputation) {
+    BackgroundQueue tasks(view_executor_.get());
+    for (size_t i = 0; i < query_views.size(); ++i) {
+      tasks.Execute([&compute_changes, i] { compute_changes(i); });
+    }
+    tasks.AwaitAll();
+  } else {
+    for (size_t i = 0; i < query_views.size(); ++i) {
+      compute_changes(i);
+    }
+  }
+
+  for (size_t i = 0; i < query_views.size(); ++i) {
+    QueryView* query_view = query_views[i];
     View& view = query_view->view();
-    ViewDocumentChanges view_doc_changes = view.ComputeDocumentChanges(changes);
+    ViewDocumentChanges view_doc_changes = std::move(*computed_changes[i]);
     if (view_doc_changes.needs_refill()) {
       // The query has a limit and some docs were removed/updated, so we need to
       // re-run the query against the local store to make sure we didn't lose
@@ -556,7 +711,8 @@ void SyncEngine::EmitNewSnapshotsAndNotifyLocalStore(
     if (view_change.snapshot().has_value()) {
       new_snapshots.push_back(*view_change.snapshot());
       LocalViewChanges doc_changes = LocalViewChanges::FromViewSnapshot(
-          *view_change.snapshot(), query_view->target_id());
+          *view_change.snapshot(), query_view->target_id(),
+          last_result_persistence_enabled_);
       document_changes_in_all_views.push_back(std::move(doc_changes));
     }
   }
@@ -588,23 +744,35 @@ void SyncEngine::UpdateTrackedLimboDocuments(
         HARD_FAIL("Unknown limbo change type: %s", limbo_change.type());
     }
   }
+
+  // Enqueue all the new documents in limbo before starting to resolve them,
+  // so that they can be looked up together.
+  PumpEnqueuedLimboResolutions();
 }
 
 void SyncEngine::TrackLimboChange(const LimboDocumentChange& limbo_change) {
   const DocumentKey& key = limbo_change.key();
   if (active_limbo_targets_by_key_.find(key) ==
           active_limbo_targets_by_key_.end() &&
+      active_limbo_lookups_by_key_.find(key) ==
+          active_limbo_lookups_by_key_.end() &&
       enqueued_limbo_resolutions_.push_back(key)) {
     LOG_DEBUG("New document in limbo: %s", key.ToString());
-    PumpEnqueuedLimboResolutions();
   }
 }
 
 void SyncEngine::PumpEnqueuedLimboResolutions() {
   while (!enqueued_limbo_resolutions_.empty() &&
-         active_limbo_targets_by_key_.size() <
+         active_limbo_targets_by_key_.size() + active_limbo_lookup_count_ <
              max_concurrent_limbo_resolutions_) {
     DocumentKey key = enqueued_limbo_resolutions_.front();
+    if (online_state_ == model::OnlineState::Online &&
+        enqueued_limbo_resolutions_.size() >= kMinLimboLookupBatchSize &&
+        looked_up_limbo_documents_.count(key) == 0) {
+      LookupEnqueuedLimboDocuments();
+      continue;
+    }
+
     enqueued_limbo_resolutions_.pop_front();
     TargetId limbo_target_id = target_id_generator_.NextId();
     active_limbo_resolutions_by_target_.emplace(limbo_target_id,
@@ -616,8 +784,88 @@ void SyncEngine::PumpEnqueuedLimboResolutions() {
   }
 }
 
+void SyncEngine::LookupEnqueuedLimboDocuments() {
+  int lookup_id = next_limbo_lookup_id_++;
+  std::vector<DocumentKey> keys;
+  while (!enqueued_limbo_resolutions_.empty() &&
+         keys.size() < kMaxLimboLookupBatchSize) {
+    DocumentKey key = enqueued_limbo_resolutions_.front();
+    if (looked_up_limbo_documents_.count(key) != 0) {
+      break;
+    }
+    enqueued_limbo_resolutions_.pop_front();
+    active_limbo_lookups_by_key_.emplace(key, lookup_id);
+    keys.push_back(std::move(key));
+  }
+
+  LOG_DEBUG("Looking up %s documents in limbo", keys.size());
+  ++active_limbo_lookup_count_;
+  remote_store_->LookupDocuments(
+      keys, [this, lookup_id, keys](
+                const util::StatusOr<std::vector<Document>>& maybe_documents) {
+        HandleLimboLookup(lookup_id, keys, maybe_documents);
+      });
+}
+
+void SyncEngine::HandleLimboLookup(
+    int lookup_id,
+    const std::vector<DocumentKey>& keys,
+    const util::StatusOr<std::vector<Document>>& maybe_documents) {
+  --active_limbo_lookup_count_;
+
+  // Documents that stopped being in limbo while they were looked up, and
+  // possibly started again since, are not this lookup's to resolve.
+  DocumentKeySet resolved_keys;
+  for (const DocumentKey& key : keys) {
+    auto found = active_limbo_lookups_by_key_.find(key);
+    if (found != active_limbo_lookups_by_key_.end() &&
+        found->second == lookup_id) {
+      active_limbo_lookups_by_key_.erase(found);
+      resolved_keys = resolved_keys.insert(key);
+    }
+  }
+
+  if (maybe_documents.ok()) {
+    DocumentUpdateMap document_updates;
+    for (const Document& document : maybe_documents.ValueOrDie()) {
+      if (resolved_keys.contains(document->key())) {
+        document_updates.emplace(document->key(), document.get());
+      }
+    }
+    if (!document_updates.empty()) {
+      DocumentMap changes =
+          local_store_->ApplyLimboDocumentLookup(document_updates);
+      EmitNewSnapshotsAndNotifyLocalStore(changes, absl::nullopt);
+    }
+  } else {
+    LOG_DEBUG("Lookup of documents in limbo failed: %s",
+              maybe_documents.status().ToString());
+  }
+
+  // A document that exists and still matches a query locally stays in limbo
+  // until watch sends it for the query. Listening to it keeps it up to date
+  // until then, as well as resolving the documents of a failed lookup.
+  for (const DocumentKey& key : resolved_keys) {
+    if (limbo_document_refs_.ContainsKey(key) &&
+        active_limbo_targets_by_key_.find(key) ==
+            active_limbo_targets_by_key_.end() &&
+        active_limbo_lookups_by_key_.find(key) ==
+            active_limbo_lookups_by_key_.end()) {
+      looked_up_limbo_documents_.insert(key);
+      enqueued_limbo_resolutions_.push_back(key);
+    }
+  }
+  PumpEnqueuedLimboResolutions();
+}
+
 void SyncEngine::RemoveLimboTarget(const DocumentKey& key) {
   enqueued_limbo_resolutions_.remove(key);
+  looked_up_limbo_documents_.erase(key);
+  if (active_limbo_lookups_by_key_.erase(key) != 0) {
+    // The lookup of the document is still in flight; its result is ignored.
+    return;
+  }
+
   auto it = active_limbo_targets_by_key_.find(key);
   if (it == active_limbo_targets_by_key_.end()) {
     // This target already got removed, because the query failed.
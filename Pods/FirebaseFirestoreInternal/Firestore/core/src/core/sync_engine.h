@@ -21,6 +21,7 @@
 #include <deque>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -32,12 +33,16 @@
 #include "Firestore/core/src/core/query.h"
 #include "Firestore/core/src/core/target_id_generator.h"
 #include "Firestore/core/src/core/view.h"
+#include "Firestore/core/src/local/query_result.h"
 #include "Firestore/core/src/local/reference_set.h"
 #include "Firestore/core/src/model/model_fwd.h"
 #include "Firestore/core/src/remote/remote_store.h"
+#include "Firestore/core/src/util/executor.h"
 #include "Firestore/core/src/util/random_access_queue.h"
 #include "Firestore/core/src/util/status.h"
+#include "Firestore/core/src/util/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 
 namespace firebase {
 namespace firestore {
@@ -121,6 +126,25 @@ class SyncEngine : public remote::RemoteStoreCallback, public QueryEventSource {
              const credentials::User& initial_user,
              size_t max_concurrent_limbo_resolutions);
 
+  /**
+   * Makes the SyncEngine compute the document changes of its views on
+   * `threads` background threads when there are many active views.
+   *
+   * The changes are still applied to the views, and snapshots raised, on the
+   * worker queue and in the same order as when computed serially.
+   */
+  void EnableParallelViewComputation(int threads);
+
+  /**
+   * Makes the SyncEngine remember the result of each view in the local store.
+   * A new view of a target with a remembered result emits a snapshot of the
+   * result's documents first, and then the changes that running its query
+   * finds.
+   */
+  void EnableLastResultPersistence() {
+    last_result_persistence_enabled_ = true;
+  }
+
   // Implements `QueryEventSource`.
   void SetCallback(SyncEngineCallback* callback) override {
     sync_engine_callback_ = callback;
@@ -171,6 +195,20 @@ class SyncEngine : public remote::RemoteStoreCallback, public QueryEventSource {
                          const std::vector<model::AggregateField>& aggregates,
                          api::AggregateQueryCallback&& result_callback);
 
+  /**
+   * Reads the documents of `query` from the view of a listened-to query
+   * instead of from the local store, if there is a view that holds them:
+   * either the view of `query` itself, or of a query without limits, bounds
+   * or explicit orders on the same collection whose filters are a subset of
+   * those of `query`.
+   *
+   * Views are kept up to date with the local store, so the documents are the
+   * same as those `LocalStore::ExecuteQuery` returns, before the limits and
+   * bounds of `query` are applied.
+   */
+  absl::optional<local::QueryResult> ExecuteQueryFromViews(
+      const core::Query& query);
+
   void HandleCredentialChange(const credentials::User& user);
 
   // Implements `RemoteStoreCallback`
@@ -178,6 +216,8 @@ class SyncEngine : public remote::RemoteStoreCallback, public QueryEventSource {
   void HandleRejectedListen(model::TargetId target_id,
                             util::Status error) override;
   void HandleSuccessfulWrite(model::MutationBatchResult batch_result) override;
+  void HandleSuccessfulWrites(
+      std::vector<model::MutationBatchResult> batch_results) override;
   void HandleRejectedWrite(model::BatchId batch_id,
                            util::Status error) override;
   void HandleOnlineStateChange(model::OnlineState online_state) override;
@@ -260,7 +300,12 @@ class SyncEngine : public remote::RemoteStoreCallback, public QueryEventSource {
 
   void AssertCallbackExists(absl::string_view source);
 
-  ViewSnapshot InitializeViewAndComputeSnapshot(
+  /**
+   * Creates the view of a query that is newly listened to and returns its
+   * snapshot. Returns `nullopt` if the view emitted a snapshot of its target's
+   * last result already and running the query has not changed it.
+   */
+  absl::optional<ViewSnapshot> InitializeViewAndComputeSnapshot(
       const QueryOrPipeline& query,
       model::TargetId target_id,
       nanopb::ByteString resume_token);
@@ -285,7 +330,9 @@ class SyncEngine : public remote::RemoteStoreCallback, public QueryEventSource {
 
   /**
    * Starts listens for documents in limbo that are enqueued for resolution,
-   * subject to a maximum number of concurrent resolutions.
+   * subject to a maximum number of concurrent resolutions. While online, runs
+   * of several enqueued documents are instead looked up in batches of up to
+   * `kMaxLimboLookupBatchSize`, with each batch counting as one resolution.
    *
    * The maximum number of concurrent limbo resolutions is defined in
    * max_concurrent_limbo_resolutions_.
@@ -296,6 +343,24 @@ class SyncEngine : public remote::RemoteStoreCallback, public QueryEventSource {
    */
   void PumpEnqueuedLimboResolutions();
 
+  /**
+   * Looks up a batch of documents in limbo from the front of
+   * `enqueued_limbo_resolutions_` with a single `BatchGetDocuments` call, so
+   * that resolving many of them needs neither a target each nor the watch
+   * stream.
+   */
+  void LookupEnqueuedLimboDocuments();
+
+  /**
+   * Applies the result of a lookup of documents in limbo. The documents that
+   * are still in limbo afterwards, including all of them if the lookup failed,
+   * are enqueued to be resolved by listening to them.
+   */
+  void HandleLimboLookup(
+      int lookup_id,
+      const std::vector<model::DocumentKey>& keys,
+      const util::StatusOr<std::vector<model::Document>>& maybe_documents);
+
   void NotifyUser(model::BatchId batch_id, util::Status status);
 
   /**
@@ -367,8 +432,31 @@ class SyncEngine : public remote::RemoteStoreCallback, public QueryEventSource {
   std::map<model::TargetId, LimboResolution>
       active_limbo_resolutions_by_target_;
 
+  /**
+   * Keeps track of the lookup that is resolving each document in limbo that
+   * is part of a batched lookup.
+   */
+  std::map<model::DocumentKey, int> active_limbo_lookups_by_key_;
+
+  /** The number of batched lookups of documents in limbo in flight. */
+  size_t active_limbo_lookup_count_ = 0;
+  int next_limbo_lookup_id_ = 0;
+
+  /**
+   * The documents in limbo that were looked up and are still in limbo, which
+   * are resolved by listening to them instead.
+   */
+  std::set<model::DocumentKey> looked_up_limbo_documents_;
+
   /** Used to track any documents that are currently in limbo. */
   local::ReferenceSet limbo_document_refs_;
+
+  model::OnlineState online_state_ = model::OnlineState::Unknown;
+
+  /** Computes view changes in parallel when set. */
+  std::unique_ptr<util::Executor> view_executor_;
+
+  bool last_result_persistence_enabled_ = false;
 };
 
 }  // namespace core
@@ -16,6 +16,7 @@
 
 #include "Firestore/core/src/core/target.h"
 
+#include <functional>
 #include <ostream>
 #include <set>
 #include <unordered_map>
@@ -336,8 +337,11 @@ Target::IndexBoundValue Target::GetDescendingBound(
 
 // MARK: - Utilities
 const std::string& Target::CanonicalId() const {
-  if (!canonical_id_.empty()) return canonical_id_;
+  const auto func = std::bind(&Target::CalculateCanonicalId, this);
+  return memoized_canonical_id_.value(func);
+}
 
+std::shared_ptr<const std::string> Target::CalculateCanonicalId() const {
   std::string result;
   absl::StrAppend(&result, path_.CanonicalString());
 
@@ -372,12 +376,13 @@ const std::string& Target::CanonicalId() const {
     absl::StrAppend(&result, end_at_->PositionString());
   }
 
-  canonical_id_ = std::move(result);
-  return canonical_id_;
+  return std::make_shared<const std::string>(std::move(result));
 }
 
 size_t Target::Hash() const {
-  return util::Hash(CanonicalId());
+  return memoized_hash_.value([this] {
+    return std::make_shared<const size_t>(util::Hash(CanonicalId()));
+  });
 }
 
 std::string Target::ToString() const {
@@ -31,6 +31,7 @@
 #include "Firestore/core/src/model/field_index.h"
 #include "Firestore/core/src/model/resource_path.h"
 #include "Firestore/core/src/remote/serializer.h"
+#include "Firestore/core/src/util/thread_safe_memoizer.h"
 
 namespace firebase {
 namespace firestore {
@@ -225,7 +226,11 @@ class Target {
   absl::optional<Bound> start_at_;
   absl::optional<Bound> end_at_;
 
-  mutable std::string canonical_id_;
+  // The canonical ID and hash are memoized since targets are used as map keys
+  // on every listen and unlisten, and building the ID walks all the values.
+  std::shared_ptr<const std::string> CalculateCanonicalId() const;
+  mutable util::ThreadSafeMemoizer<const std::string> memoized_canonical_id_;
+  mutable util::ThreadSafeMemoizer<const size_t> memoized_hash_;
 };
 
 bool operator==(const Target& lhs, const Target& rhs);
@@ -27,6 +27,7 @@
 #include "Firestore/core/src/model/document.h"
 #include "Firestore/core/src/model/verify_mutation.h"
 #include "Firestore/core/src/remote/datastore.h"
+#include "Firestore/core/src/util/async_queue.h"
 #include "Firestore/core/src/util/hard_assert.h"
 
 using firebase::firestore::Error;
@@ -41,6 +42,7 @@ using firebase::firestore::model::Precondition;
 using firebase::firestore::model::SnapshotVersion;
 using firebase::firestore::model::VerifyMutation;
 using firebase::firestore::remote::Datastore;
+using firebase::firestore::util::AsyncQueue;
 using firebase::firestore::util::Status;
 using firebase::firestore::util::StatusOr;
 
@@ -52,6 +54,11 @@ Transaction::Transaction(std::shared_ptr<Datastore> datastore)
     : datastore_{datastore} {
 }
 
+Transaction::Transaction(std::shared_ptr<Datastore> datastore,
+                         std::shared_ptr<AsyncQueue> worker_queue)
+    : datastore_{datastore}, worker_queue_{std::move(worker_queue)} {
+}
+
 Status Transaction::RecordVersion(const Document& doc) {
   SnapshotVersion doc_version;
 
@@ -91,18 +98,75 @@ void Transaction::Lookup(const std::vector<DocumentKey>& keys,
     return;
   }
 
-  std::shared_ptr<Datastore> datastore = datastore_.lock();
-  if (!datastore) {
+  if (datastore_.expired()) {
     callback(Status(Error::kErrorFailedPrecondition,
                     "The client has already been terminated."));
     return;
   }
 
+  bool first_pending = false;
+  {
+    std::lock_guard<std::mutex> lock(pending_lookups_mutex_);
+    first_pending = pending_lookups_.empty();
+    pending_lookups_.push_back(PendingLookup{keys, std::move(callback)});
+  }
+  if (!first_pending) {
+    // Already scheduled to be sent.
+    return;
+  }
+
+  if (worker_queue_) {
+    // Sending on the next queue turn lets the lookups the transaction makes
+    // in the meantime share the request.
+    auto shared_this = shared_from_this();
+    worker_queue_->EnqueueRelaxed(
+        [shared_this] { shared_this->SendPendingLookups(); });
+  } else {
+    SendPendingLookups();
+  }
+}
+
+void Transaction::SendPendingLookups() {
+  std::vector<PendingLookup> lookups;
+  {
+    std::lock_guard<std::mutex> lock(pending_lookups_mutex_);
+    lookups.swap(pending_lookups_);
+  }
+
+  std::vector<DocumentKey> unread_keys;
+  std::unordered_set<DocumentKey, DocumentKeyHash> requested_keys;
+  for (const PendingLookup& lookup : lookups) {
+    for (const DocumentKey& key : lookup.keys) {
+      if (read_documents_.find(key) == read_documents_.end() &&
+          requested_keys.insert(key).second) {
+        unread_keys.push_back(key);
+      }
+    }
+  }
+
+  if (unread_keys.empty()) {
+    for (const PendingLookup& lookup : lookups) {
+      CompleteLookup(lookup);
+    }
+    return;
+  }
+
+  std::shared_ptr<Datastore> datastore = datastore_.lock();
+  if (!datastore) {
+    for (const PendingLookup& lookup : lookups) {
+      lookup.callback(Status(Error::kErrorFailedPrecondition,
+                             "The client has already been terminated."));
+    }
+    return;
+  }
+
   datastore->LookupDocuments(
-      keys,
-      [this, callback](const StatusOr<std::vector<Document>>& maybe_documents) {
+      unread_keys,
+      [this, lookups](const StatusOr<std::vector<Document>>& maybe_documents) {
         if (!maybe_documents.ok()) {
-          callback(maybe_documents.status());
+          for (const PendingLookup& lookup : lookups) {
+            lookup.callback(maybe_documents.status());
+          }
           return;
         }
 
@@ -110,17 +174,32 @@ void Transaction::Lookup(const std::vector<DocumentKey>& keys,
         for (const Document& doc : documents) {
           Status record_error = RecordVersion(doc);
           if (!record_error.ok()) {
-            callback(record_error);
+            for (const PendingLookup& lookup : lookups) {
+              lookup.callback(record_error);
+            }
             return;
           }
+          read_documents_[doc->key()] = doc;
         }
 
-        // TODO(varconst): see if `maybe_documents` can be moved into the
-        // callback.
-        callback(maybe_documents);
+        for (const PendingLookup& lookup : lookups) {
+          CompleteLookup(lookup);
+        }
       });
 }
 
+void Transaction::CompleteLookup(const PendingLookup& lookup) const {
+  std::vector<Document> documents;
+  documents.reserve(lookup.keys.size());
+  for (const DocumentKey& key : lookup.keys) {
+    auto found = read_documents_.find(key);
+    HARD_ASSERT(found != read_documents_.end(),
+                "Document %s missing from lookup response", key.ToString());
+    documents.push_back(found->second);
+  }
+  lookup.callback(std::move(documents));
+}
+
 void Transaction::WriteMutations(std::vector<Mutation>&& mutations) {
   EnsureCommitNotCalled();
   // `move` will become appropriate once `Mutation` is replaced by the C++
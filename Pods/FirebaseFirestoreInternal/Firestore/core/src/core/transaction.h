@@ -19,10 +19,12 @@
 
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "Firestore/core/src/model/document.h"
 #include "Firestore/core/src/model/document_key.h"
 #include "Firestore/core/src/model/mutation.h"
 #include "Firestore/core/src/model/snapshot_version.h"
@@ -36,19 +38,22 @@ namespace firestore {
 
 namespace model {
 class Precondition;
-class Document;
 }  // namespace model
 
 namespace remote {
 class Datastore;
 }  // namespace remote
 
+namespace util {
+class AsyncQueue;
+}  // namespace util
+
 namespace core {
 
 class ParsedSetData;
 class ParsedUpdateData;
 
-class Transaction {
+class Transaction : public std::enable_shared_from_this<Transaction> {
  public:
   using LookupCallback =
       std::function<void(const util::StatusOr<std::vector<model::Document>>&)>;
@@ -56,9 +61,20 @@ class Transaction {
   Transaction() = default;
   explicit Transaction(std::shared_ptr<remote::Datastore> datastore);
 
+  /**
+   * Creates a transaction that batches its lookups on `worker_queue`, the
+   * queue of `datastore`. Must be owned by a `shared_ptr`.
+   */
+  Transaction(std::shared_ptr<remote::Datastore> datastore,
+              std::shared_ptr<util::AsyncQueue> worker_queue);
+
   /**
    * Takes a set of keys and asynchronously attempts to fetch all the documents
    * from the backend, ignoring any local changes.
+   *
+   * Lookups made before the previous ones have been sent are fetched with a
+   * single request, and documents that were already read in this transaction
+   * are returned as they were read, without fetching them again.
    */
   void Lookup(const std::vector<model::DocumentKey>& keys,
               LookupCallback&& callback);
@@ -129,7 +145,30 @@ class Transaction {
   absl::optional<model::SnapshotVersion> GetVersion(
       const model::DocumentKey& key) const;
 
+  struct PendingLookup {
+    std::vector<model::DocumentKey> keys;
+    LookupCallback callback;
+  };
+
+  /** Fetches the documents of all pending lookups that were not read yet. */
+  void SendPendingLookups();
+
+  /** Calls the callback of `lookup` with the documents read for its keys. */
+  void CompleteLookup(const PendingLookup& lookup) const;
+
   std::weak_ptr<remote::Datastore> datastore_;
+  std::shared_ptr<util::AsyncQueue> worker_queue_;
+
+  // Lookups are made on the thread running the transaction, and sent from
+  // the worker queue.
+  std::mutex pending_lookups_mutex_;
+  std::vector<PendingLookup> pending_lookups_;
+
+  /** The documents read in this transaction; only used on the worker queue. */
+  std::unordered_map<model::DocumentKey,
+                     model::Document,
+                     model::DocumentKeyHash>
+      read_documents_;
 
   std::vector<model::Mutation> mutations_;
   bool committed_ = false;
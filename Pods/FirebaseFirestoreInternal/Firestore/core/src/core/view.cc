@@ -16,7 +16,6 @@
 
 #include "Firestore/core/src/core/view.h"
 
-#include <algorithm>  // For std::sort
 #include <utility>
 #include <valarray>
 
@@ -117,33 +116,24 @@ bool operator==(const LimboDocumentChange& lhs,
 ViewDocumentChanges::ViewDocumentChanges(model::DocumentSet new_documents,
                                          DocumentViewChangeSet changes,
                                          model::DocumentKeySet mutated_keys,
-                                         bool needs_refill)
+                                         bool needs_refill,
+                                         DocumentSet overflow_documents)
     : document_set_(std::move(new_documents)),
       change_set_(std::move(changes)),
       mutated_keys_(std::move(mutated_keys)),
-      needs_refill_(needs_refill) {
+      needs_refill_(needs_refill),
+      overflow_documents_(std::move(overflow_documents)) {
 }
 
 // MARK: - View
 
 namespace {
 
-int GetDocumentViewChangeTypePosition(DocumentViewChange::Type change_type) {
-  switch (change_type) {
-    case DocumentViewChange::Type::Removed:
-      return 0;
-    case DocumentViewChange::Type::Added:
-      return 1;
-    case DocumentViewChange::Type::Modified:
-      return 2;
-    case DocumentViewChange::Type::Metadata:
-      // A metadata change is converted to a modified change at the public API
-      // layer. Since we sort by document key and then change type, metadata and
-      // modified changes must be sorted equivalently.
-      return 2;
-  }
-  HARD_FAIL("Unknown DocumentViewChange::Type %s", change_type);
-}
+/**
+ * The maximum number of documents past the limit that a limit query keeps
+ * around to backfill its results with.
+ */
+const size_t kMaxOverflowDocuments = 100;
 
 }  // namespace
 
@@ -151,6 +141,7 @@ View::View(QueryOrPipeline query, DocumentKeySet remote_documents)
     : query_(std::move(query)),
       document_set_(query_.Comparator()),  // QueryOrPipeline must provide a
                                            // valid comparator
+      overflow_documents_(query_.Comparator()),
       synced_documents_(std::move(remote_documents)) {
 }
 
@@ -174,13 +165,36 @@ ViewDocumentChanges View::ComputeDocumentChanges(
   DocumentSet new_document_set = old_document_set;
   bool needs_refill = false;
 
+  // The first documents of a view are only added, so they are collected and
+  // built into a set at once.
+  bool build_new_documents = old_document_set.empty();
+  std::vector<Document> new_documents;
+
   auto limit_edges = GetLimitEdges(query_, old_document_set);
   absl::optional<Document> last_doc_in_limit = limit_edges.first;
   absl::optional<Document> first_doc_in_limit = limit_edges.second;
 
+  // When the limit is full, the matching documents are only known up to the
+  // last of the overflow documents, or up to the limit if there are none.
+  DocumentSet overflow = previous_changes
+                             ? previous_changes->overflow_documents()
+                             : overflow_documents_;
+  absl::optional<Document> known_edge;
+  if (last_doc_in_limit) {
+    known_edge =
+        overflow.empty() ? last_doc_in_limit : overflow.GetLastDocument();
+  } else if (first_doc_in_limit) {
+    known_edge =
+        overflow.empty() ? first_doc_in_limit : overflow.GetFirstDocument();
+  }
+
   for (const auto& kv : doc_changes) {
     const DocumentKey& key = kv.first;
 
+    // A changed overflow document is handled like one new to the view, and
+    // goes back to the overflow below if it is still past the limit.
+    overflow = overflow.erase(key);
+
     absl::optional<Document> old_doc = old_document_set.GetDocument(key);
     absl::optional<Document> new_doc = query_.Matches(kv.second)
                                            ? absl::optional<Document>{kv.second}
@@ -245,7 +259,11 @@ ViewDocumentChanges View::ComputeDocumentChanges(
 
     if (change_applied) {
       if (new_doc) {
-        new_document_set = new_document_set.insert(new_doc);
+        if (build_new_documents) {
+          new_documents.push_back(*new_doc);
+        } else {
+          new_document_set = new_document_set.insert(new_doc);
+        }
         if ((*new_doc)->has_local_mutations()) {
           new_mutated_keys = new_mutated_keys.insert(key);
         } else {
@@ -258,6 +276,11 @@ ViewDocumentChanges View::ComputeDocumentChanges(
     }
   }
 
+  if (build_new_documents) {
+    new_document_set =
+        DocumentSet(query_.Comparator(), std::move(new_documents));
+  }
+
   // Drop documents out to meet limitToFirst/limitToLast requirement.
   auto limit = GetLimit(query_);
   if (limit.has_value()) {
@@ -272,10 +295,8 @@ ViewDocumentChanges View::ComputeDocumentChanges(
 
       auto results = RunPipeline(
           const_cast<api::RealtimePipeline&>(query_.pipeline()), candidates);
-      DocumentSet new_result = DocumentSet(query_.Comparator());
-      for (auto doc : results) {
-        new_result = new_result.insert(doc);
-      }
+      std::vector<Document> result_documents(results.begin(), results.end());
+      DocumentSet new_result(query_.Comparator(), std::move(result_documents));
 
       for (Document doc : new_document_set) {
         if (!new_result.ContainsKey(doc->key())) {
@@ -287,21 +308,69 @@ ViewDocumentChanges View::ComputeDocumentChanges(
 
       new_document_set = new_result;
     } else {
-      auto limit_type = GetLimitType(query_);
+      bool limit_to_first = GetLimitType(query_) == LimitType::First;
       auto abs_limit = std::abs(limit.value());
+
+      // Fill the places of documents that left the limit with the overflow
+      // documents that follow it.
+      while (static_cast<int64_t>(new_document_set.size()) < abs_limit &&
+             !overflow.empty()) {
+        Document doc = limit_to_first ? *overflow.GetFirstDocument()
+                                      : *overflow.GetLastDocument();
+        overflow = overflow.erase(doc->key());
+        new_document_set = new_document_set.insert(doc);
+        if (doc->has_local_mutations()) {
+          new_mutated_keys = new_mutated_keys.insert(doc->key());
+        }
+        change_set.AddChange(
+            DocumentViewChange{doc, DocumentViewChange::Type::Added});
+      }
+
       if (abs_limit < static_cast<int64_t>(new_document_set.size())) {
         for (size_t i = new_document_set.size() - abs_limit; i > 0; --i) {
           absl::optional<Document> found =
-              limit_type == LimitType::First
-                  ? new_document_set.GetLastDocument()
-                  : new_document_set.GetFirstDocument();
+              limit_to_first ? new_document_set.GetLastDocument()
+                             : new_document_set.GetFirstDocument();
           const Document& old_doc = *found;
           new_document_set = new_document_set.erase(old_doc->key());
           new_mutated_keys = new_mutated_keys.erase(old_doc->key());
+          overflow = overflow.insert(old_doc);
           change_set.AddChange(
               DocumentViewChange{old_doc, DocumentViewChange::Type::Removed});
         }
       }
+
+      auto past_known_edge = [&](const Document& doc) {
+        return limit_to_first
+                   ? util::Descending(Compare(doc, *known_edge))
+                   : util::Ascending(Compare(doc, *known_edge));
+      };
+      auto drop_farthest_overflow_document = [&] {
+        absl::optional<Document> farthest = limit_to_first
+                                                ? overflow.GetLastDocument()
+                                                : overflow.GetFirstDocument();
+        overflow = overflow.erase((*farthest)->key());
+      };
+
+      if (known_edge) {
+        // There may be unknown documents in the local cache before any
+        // document past the known edge, so those cannot be kept and, if they
+        // are needed to fill the limit, the view needs a refill.
+        while (!overflow.empty() &&
+               past_known_edge(limit_to_first ? *overflow.GetLastDocument()
+                                              : *overflow.GetFirstDocument())) {
+          drop_farthest_overflow_document();
+        }
+        absl::optional<Document> limit_end =
+            limit_to_first ? new_document_set.GetLastDocument()
+                           : new_document_set.GetFirstDocument();
+        needs_refill =
+            static_cast<int64_t>(new_document_set.size()) < abs_limit ||
+            (limit_end && past_known_edge(*limit_end));
+      }
+      while (overflow.size() > kMaxOverflowDocuments) {
+        drop_farthest_overflow_document();
+      }
     }
   }
 
@@ -309,7 +378,8 @@ ViewDocumentChanges View::ComputeDocumentChanges(
               "View was refilled using docs that themselves needed refilling.");
 
   return ViewDocumentChanges(std::move(new_document_set), std::move(change_set),
-                             new_mutated_keys, needs_refill);
+                             new_mutated_keys, needs_refill,
+                             std::move(overflow));
 }
 
 bool View::ShouldWaitForSyncedDocument(const Document& new_doc,
@@ -334,21 +404,12 @@ ViewChange View::ApplyChanges(const ViewDocumentChanges& doc_changes,
 
   DocumentSet old_documents = document_set_;
   document_set_ = doc_changes.document_set();
+  overflow_documents_ = doc_changes.overflow_documents();
   mutated_keys_ = doc_changes.mutated_keys();
 
   // Sort changes based on type and query comparator.
   std::vector<DocumentViewChange> changes =
-      doc_changes.change_set().GetChanges();
-  std::sort(
-      changes.begin(), changes.end(),
-      [this](const DocumentViewChange& lhs, const DocumentViewChange& rhs) {
-        int pos1 = GetDocumentViewChangeTypePosition(lhs.type());
-        int pos2 = GetDocumentViewChangeTypePosition(rhs.type());
-        if (pos1 != pos2) {
-          return pos1 < pos2;
-        }
-        return util::Ascending(Compare(lhs.document(), rhs.document()));
-      });
+      doc_changes.change_set().GetSortedChanges(document_set_.comparator());
 
   ApplyTargetChange(target_change);
   std::vector<LimboDocumentChange> limbo_changes =
@@ -392,7 +453,8 @@ ViewChange View::ApplyOnlineStateChange(OnlineState online_state) {
     current_ = false;
     return ApplyChanges(
         ViewDocumentChanges(document_set_, DocumentViewChangeSet{},
-                            mutated_keys_, /* needs_refill= */ false));
+                            mutated_keys_, /* needs_refill= */ false,
+                            overflow_documents_));
   } else {
     // No effect, just return a no-op ViewChange.
     return ViewChange(absl::nullopt, {});
@@ -71,7 +71,8 @@ class ViewDocumentChanges {
   ViewDocumentChanges(model::DocumentSet new_documents,
                       DocumentViewChangeSet changes,
                       model::DocumentKeySet mutated_keys,
-                      bool needs_refill);
+                      bool needs_refill,
+                      model::DocumentSet overflow_documents);
 
   /** The new set of docs that should be in the view. */
   const model::DocumentSet& document_set() const {
@@ -96,11 +97,20 @@ class ViewDocumentChanges {
     return needs_refill_;
   }
 
+  /**
+   * The documents that follow the new set of docs past the limit of a limit
+   * query, which can take the place of docs that later leave the view.
+   */
+  const model::DocumentSet& overflow_documents() const {
+    return overflow_documents_;
+  }
+
  private:
   model::DocumentSet document_set_;
   core::DocumentViewChangeSet change_set_;
   model::DocumentKeySet mutated_keys_;
   bool needs_refill_ = false;
+  model::DocumentSet overflow_documents_;
 };
 
 /** A set of changes to a view. */
@@ -146,6 +156,11 @@ class View {
     return synced_documents_;
   }
 
+  /** The documents currently in the view, with the query limit applied. */
+  const model::DocumentSet& document_set() const {
+    return document_set_;
+  }
+
   /**
    * Iterates over a set of doc changes, applies the query limit, and computes
    * what the new results should be, what the changes were, and whether we may
@@ -215,6 +230,13 @@ class View {
 
   model::DocumentSet document_set_;
 
+  /**
+   * A bounded number of documents that follow `document_set_` past the limit
+   * of a (non-pipeline) limit query. There is no other matching document
+   * between the last document in the limit and the last of these.
+   */
+  model::DocumentSet overflow_documents_;
+
   /** Documents included in the remote target. */
   model::DocumentKeySet synced_documents_;
 
@@ -16,6 +16,7 @@
 
 #include "Firestore/core/src/core/view_snapshot.h"
 
+#include <algorithm>
 #include <ostream>
 
 #include "Firestore/core/src/model/document_set.h"
@@ -28,6 +29,7 @@ namespace firestore {
 namespace core {
 
 using model::Document;
+using model::DocumentComparator;
 using model::DocumentKey;
 using model::DocumentKeySet;
 using model::DocumentSet;
@@ -58,6 +60,27 @@ bool operator==(const DocumentViewChange& lhs, const DocumentViewChange& rhs) {
 
 // DocumentViewChangeSet
 
+namespace {
+
+int GetDocumentViewChangeTypePosition(DocumentViewChange::Type change_type) {
+  switch (change_type) {
+    case DocumentViewChange::Type::Removed:
+      return 0;
+    case DocumentViewChange::Type::Added:
+      return 1;
+    case DocumentViewChange::Type::Modified:
+      return 2;
+    case DocumentViewChange::Type::Metadata:
+      // A metadata change is converted to a modified change at the public API
+      // layer. Since we sort by document key and then change type, metadata and
+      // modified changes must be sorted equivalently.
+      return 2;
+  }
+  HARD_FAIL("Unknown DocumentViewChange::Type %s", change_type);
+}
+
+}  // namespace
+
 void DocumentViewChangeSet::AddChange(DocumentViewChange&& change) {
   const DocumentKey& key = change.document()->key();
   auto old_change_iter = change_map_.find(key);
@@ -130,6 +153,23 @@ std::vector<DocumentViewChange> DocumentViewChangeSet::GetChanges() const {
   return changes;
 }
 
+std::vector<DocumentViewChange> DocumentViewChangeSet::GetSortedChanges(
+    const DocumentComparator& comparator) const {
+  std::vector<DocumentViewChange> changes = GetChanges();
+  std::sort(changes.begin(), changes.end(),
+            [&comparator](const DocumentViewChange& lhs,
+                          const DocumentViewChange& rhs) {
+              int pos1 = GetDocumentViewChangeTypePosition(lhs.type());
+              int pos2 = GetDocumentViewChangeTypePosition(rhs.type());
+              if (pos1 != pos2) {
+                return pos1 < pos2;
+              }
+              return util::Ascending(
+                  comparator.Compare(lhs.document(), rhs.document()));
+            });
+  return changes;
+}
+
 std::string DocumentViewChangeSet::ToString() const {
   return util::ToString(change_map_);
 }
@@ -163,6 +203,7 @@ ViewSnapshot ViewSnapshot::FromInitialDocuments(QueryOrPipeline query,
                                                 bool excludes_metadata_changes,
                                                 bool has_cached_results) {
   std::vector<DocumentViewChange> view_changes;
+  view_changes.reserve(documents.size());
   for (const Document& doc : documents) {
     view_changes.emplace_back(doc, DocumentViewChange::Type::Added);
   }
@@ -85,6 +85,14 @@ class DocumentViewChangeSet {
   /** Returns the set of all changes tracked in this set. */
   std::vector<DocumentViewChange> GetChanges() const;
 
+  /**
+   * Returns the set of all changes tracked in this set in the order in which
+   * snapshots present them: removals, then additions, then modifications, each
+   * sorted by the given comparator.
+   */
+  std::vector<DocumentViewChange> GetSortedChanges(
+      const model::DocumentComparator& comparator) const;
+
   std::string ToString() const;
 
  private:
@@ -25,11 +25,13 @@
 
 #include <memory>
 #include <mutex>
+#include <string>
 #include <utility>
 
 #include "Firestore/core/src/credentials/credentials_provider.h"
 #include "Firestore/core/src/credentials/user.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 
 @class FIRApp;
 @protocol FIRAuthInterop;
@@ -102,9 +104,38 @@ class FirebaseAuthCredentialsProvider
      */
     int token_counter = 0;
 
+    /**
+     * The last token received for `current_user`. It is returned by
+     * GetToken() without asking FirebaseAuth again until shortly before it
+     * expires, and refreshed in the background before then.
+     */
+    absl::optional<AuthToken> cached_token;
+
+    /** When `cached_token` expires, in seconds since 1970. */
+    NSTimeInterval cached_token_expiration = 0;
+
+    /** The `token_counter` when `cached_token` was received. */
+    int cached_token_counter = 0;
+
+    /** Counts cached tokens, so that only the latest refresh runs. */
+    int refresh_generation = 0;
+
     std::mutex mutex;
   };
 
+  /**
+   * Caches `token` for the current user and schedules its refresh, if it
+   * carries an expiration time. `contents->mutex` must be held.
+   */
+  static void CacheToken(const std::shared_ptr<Contents>& contents,
+                         const std::string& token);
+
+  /**
+   * Fetches a new token shortly before the cached one expires, so that the
+   * streams do not have to wait for the refresh when they next start.
+   */
+  static void ScheduleTokenRefresh(const std::shared_ptr<Contents>& contents);
+
   /**
    * Handle used to stop receiving auth changes once CredentialChangeListener is
    * removed.
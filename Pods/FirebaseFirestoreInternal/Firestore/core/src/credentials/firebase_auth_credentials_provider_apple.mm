@@ -29,6 +29,58 @@ namespace firebase {
 namespace firestore {
 namespace credentials {
 
+namespace {
+
+// Cached tokens are not used once they are this close to expiring, and they
+// are refreshed a little before that. FirebaseAuth refreshes its own tokens
+// within the same margin.
+const NSTimeInterval kTokenExpirationMargin = 5 * 60;
+const NSTimeInterval kTokenRefreshLead = 30;
+
+/**
+ * Returns the expiration time of an ID token in seconds since 1970, read from
+ * the `exp` claim of the JWT, or 0 if it cannot be read.
+ */
+NSTimeInterval TokenExpiration(const std::string& token) {
+  NSArray<NSString*>* parts =
+      [util::MakeNSString(token) componentsSeparatedByString:@"."];
+  if (parts.count != 3) {
+    return 0;
+  }
+
+  // The payload is unpadded base64url.
+  NSMutableString* payload = [parts[1] mutableCopy];
+  [payload replaceOccurrencesOfString:@"-"
+                           withString:@"+"
+                              options:0
+                                range:NSMakeRange(0, payload.length)];
+  [payload replaceOccurrencesOfString:@"_"
+                           withString:@"/"
+                              options:0
+                                range:NSMakeRange(0, payload.length)];
+  while (payload.length % 4 != 0) {
+    [payload appendString:@"="];
+  }
+
+  NSData* data = [[NSData alloc] initWithBase64EncodedString:payload options:0];
+  if (!data) {
+    return 0;
+  }
+  id claims = [NSJSONSerialization JSONObjectWithData:data
+                                              options:0
+                                                error:nil];
+  if (![claims isKindOfClass:[NSDictionary class]]) {
+    return 0;
+  }
+  id expiration = claims[@"exp"];
+  if (![expiration isKindOfClass:[NSNumber class]]) {
+    return 0;
+  }
+  return [expiration doubleValue];
+}
+
+}  // namespace
+
 FirebaseAuthCredentialsProvider::FirebaseAuthCredentialsProvider(
     FIRApp* app, id<FIRAuthInterop> auth) {
   contents_ =
@@ -77,6 +129,22 @@ void FirebaseAuthCredentialsProvider::GetToken(
   HARD_ASSERT(auth_listener_handle_,
               "GetToken cannot be called after listener removed.");
 
+  {
+    std::unique_lock<std::mutex> lock(contents_->mutex);
+    Contents& contents = *contents_;
+    if (force_refresh_) {
+      contents.cached_token.reset();
+    } else if (contents.cached_token.has_value() &&
+               contents.cached_token_counter == contents.token_counter &&
+               contents.cached_token_expiration - kTokenExpirationMargin >
+                   [[NSDate date] timeIntervalSince1970]) {
+      AuthToken token = *contents.cached_token;
+      lock.unlock();
+      completion(std::move(token));
+      return;
+    }
+  }
+
   // Take note of the current value of the token_counter so that this method can
   // fail if there is a token change while the request is outstanding.
   int initial_token_counter = contents_->token_counter;
@@ -96,7 +164,9 @@ void FirebaseAuthCredentialsProvider::GetToken(
         } else {
           if (error == nil) {
             if (token != nil) {
-              completion(AuthToken{util::MakeString(token),
+              std::string token_string = util::MakeString(token);
+              CacheToken(self->contents_, token_string);
+              completion(AuthToken{std::move(token_string),
                                    self->contents_->current_user});
             } else {
               completion(AuthToken::Unauthenticated());
@@ -124,6 +194,69 @@ void FirebaseAuthCredentialsProvider::GetToken(
   force_refresh_ = false;
 }
 
+void FirebaseAuthCredentialsProvider::CacheToken(
+    const std::shared_ptr<Contents>& contents, const std::string& token) {
+  NSTimeInterval expiration = TokenExpiration(token);
+  if (expiration == 0) {
+    contents->cached_token.reset();
+    return;
+  }
+
+  contents->cached_token = AuthToken{token, contents->current_user};
+  contents->cached_token_expiration = expiration;
+  contents->cached_token_counter = contents->token_counter;
+  contents->refresh_generation++;
+  ScheduleTokenRefresh(contents);
+}
+
+void FirebaseAuthCredentialsProvider::ScheduleTokenRefresh(
+    const std::shared_ptr<Contents>& contents) {
+  if (!contents->auth) {
+    return;
+  }
+  NSTimeInterval delay = contents->cached_token_expiration -
+                         kTokenExpirationMargin - kTokenRefreshLead -
+                         [[NSDate date] timeIntervalSince1970];
+  if (delay <= 0) {
+    return;
+  }
+
+  std::weak_ptr<Contents> weak_contents = contents;
+  int token_counter = contents->token_counter;
+  int refresh_generation = contents->refresh_generation;
+  auto refresh_callback = ^(NSString* _Nullable token,
+                            NSError* _Nullable error) {
+    std::shared_ptr<Contents> contents = weak_contents.lock();
+    if (!contents || error != nil || token == nil) {
+      return;
+    }
+    std::unique_lock<std::mutex> lock(contents->mutex);
+    if (contents->token_counter == token_counter) {
+      CacheToken(contents, util::MakeString(token));
+    }
+  };
+  dispatch_after(
+      dispatch_time(DISPATCH_TIME_NOW,
+                    static_cast<int64_t>(delay * NSEC_PER_SEC)),
+      dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        std::shared_ptr<Contents> contents = weak_contents.lock();
+        if (!contents) {
+          return;
+        }
+        {
+          std::unique_lock<std::mutex> lock(contents->mutex);
+          // Only the refresh scheduled for the token still cached runs.
+          if (contents->token_counter != token_counter ||
+              contents->refresh_generation != refresh_generation ||
+              !contents->cached_token.has_value()) {
+            return;
+          }
+        }
+        [contents->auth getTokenForcingRefresh:YES
+                                  withCallback:refresh_callback];
+      });
+}
+
 void FirebaseAuthCredentialsProvider::SetCredentialChangeListener(
     CredentialChangeListener<User> change_listener) {
   std::unique_lock<std::mutex> lock(contents_->mutex);
@@ -27,6 +27,7 @@
 
 #include "Firestore/core/src/immutable/keys_view.h"
 #include "Firestore/core/src/immutable/sorted_container.h"
+#include "Firestore/core/src/util/allocation_stats.h"
 #include "Firestore/core/src/util/comparison.h"
 #include "Firestore/core/src/util/hard_assert.h"
 #include "Firestore/core/src/util/range.h"
@@ -191,7 +192,8 @@ class ArraySortedMap : public SortedMapBase {
 
     // Copy the segment before the found position. If not found, this is
     // everything.
-    auto copy = std::make_shared<array_type>(begin(), pos);
+    auto copy = util::MakeSharedCounted<array_type>(
+        util::AllocationSubsystem::kSortedMap, begin(), pos);
 
     // Copy the value to be inserted.
     copy->append({key, value});
@@ -221,7 +223,8 @@ class ArraySortedMap : public SortedMapBase {
       // the result empty.
       return wrap(EmptyArray());
     } else {
-      auto copy = std::make_shared<array_type>(begin(), pos);
+      auto copy = util::MakeSharedCounted<array_type>(
+        util::AllocationSubsystem::kSortedMap, begin(), pos);
       copy->append(pos + 1, current_end);
       return wrap(copy);
     }
@@ -341,7 +344,8 @@ class ArraySortedMap : public SortedMapBase {
         [&comparator](const value_type& lhs, const value_type& rhs) {
           return util::Ascending(comparator.Compare(lhs.first, rhs.first));
         });
-    return std::make_shared<const array_type>(sorted.begin(), sorted.end());
+    return util::MakeSharedCounted<array_type>(
+        util::AllocationSubsystem::kSortedMap, sorted.begin(), sorted.end());
   }
 
   ArraySortedMap(const array_pointer& array, const C& comparator) noexcept
@@ -0,0 +1,401 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef FIRESTORE_CORE_SRC_IMMUTABLE_BTREE_NODE_H_
+#define FIRESTORE_CORE_SRC_IMMUTABLE_BTREE_NODE_H_
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Firestore/core/src/immutable/btree_node_iterator.h"
+#include "Firestore/core/src/immutable/sorted_container.h"
+#include "Firestore/core/src/util/allocation_stats.h"
+#include "Firestore/core/src/util/comparison.h"
+
+namespace firebase {
+namespace firestore {
+namespace immutable {
+namespace impl {
+
+/**
+ * The maximum number of entries in a leaf BTreeNode, and of children in an
+ * inner one.
+ */
+constexpr SortedContainer::size_type kBTreeMaxSlots = 32;
+
+/**
+ * The minimum number of entries or children of any BTreeNode but the root.
+ */
+constexpr SortedContainer::size_type kBTreeMinSlots = kBTreeMaxSlots / 2;
+
+/**
+ * BTreeNode is a node in a BTreeSortedMap, a B+-tree. Leaves hold up to
+ * `kBTreeMaxSlots` entries in a contiguous array. Inner nodes hold up to as
+ * many children, along with the first key of each, so that a lookup only
+ * visits one node per level.
+ *
+ * Nodes are immutable and shared between the versions of a tree, so that
+ * mutations only copy the nodes on the path from the root to the entry they
+ * change. The tree is held through `node_pointer`s, and an empty tree is a
+ * null pointer.
+ */
+template <typename K, typename V>
+class BTreeNode : public SortedMapBase {
+ public:
+  using first_type = K;
+  using second_type = V;
+
+  /**
+   * The type of the entries stored in the map.
+   */
+  using value_type = std::pair<K, V>;
+  using node_pointer = std::shared_ptr<const BTreeNode>;
+  using const_iterator = BTreeNodeIterator<BTreeNode<K, V>>;
+
+  /** Constructs a leaf containing the given entries. */
+  explicit BTreeNode(std::vector<value_type>&& entries)
+      : size_(static_cast<size_type>(entries.size())),
+        entries_(std::move(entries)) {
+    util::RecordAllocation(util::AllocationSubsystem::kSortedMap, SlotBytes());
+  }
+
+  /** Constructs an inner node containing the given children. */
+  explicit BTreeNode(std::vector<node_pointer>&& children)
+      : size_(0), children_(std::move(children)) {
+    keys_.reserve(children_.size());
+    for (const node_pointer& child : children_) {
+      size_ += child->size();
+      keys_.push_back(child->first_key());
+    }
+    util::RecordAllocation(util::AllocationSubsystem::kSortedMap, SlotBytes());
+  }
+
+  ~BTreeNode() {
+    util::RecordFree(util::AllocationSubsystem::kSortedMap, SlotBytes());
+  }
+
+  /** Returns true if this node holds entries rather than children. */
+  bool leaf() const {
+    return children_.empty();
+  }
+
+  /** Returns the number of entries in this node or beneath it in the tree. */
+  size_type size() const {
+    return size_;
+  }
+
+  const std::vector<value_type>& entries() const {
+    return entries_;
+  }
+
+  const std::vector<node_pointer>& children() const {
+    return children_;
+  }
+
+  /** Returns the smallest key in this node or beneath it in the tree. */
+  const K& first_key() const {
+    return leaf() ? entries_.front().first : keys_.front();
+  }
+
+  /**
+   * Returns the index of the first entry of this leaf whose key is not less
+   * than the given key.
+   */
+  template <typename Comparator>
+  size_type LowerBoundIndex(const K& key, const Comparator& comparator) const {
+    auto found = std::lower_bound(
+        entries_.begin(), entries_.end(), key,
+        [&](const value_type& entry, const K& k) {
+          return util::Ascending(comparator.Compare(entry.first, k));
+        });
+    return static_cast<size_type>(found - entries_.begin());
+  }
+
+  /**
+   * Returns the index of the child of this inner node that the given key
+   * belongs in: the last one whose first key is not greater than it.
+   */
+  template <typename Comparator>
+  size_type ChildIndex(const K& key, const Comparator& comparator) const {
+    auto found = std::upper_bound(
+        keys_.begin(), keys_.end(), key, [&](const K& k, const K& first) {
+          return util::Ascending(comparator.Compare(k, first));
+        });
+    return found == keys_.begin()
+               ? 0
+               : static_cast<size_type>(found - keys_.begin()) - 1;
+  }
+
+  /** Returns the root of a tree with the given key-value pair set/updated. */
+  template <typename Comparator>
+  static node_pointer Insert(const node_pointer& root,
+                             const K& key,
+                             const V& value,
+                             const Comparator& comparator) {
+    if (!root) {
+      std::vector<value_type> entries;
+      entries.emplace_back(key, value);
+      return NewNode(std::move(entries));
+    }
+
+    node_pointer split;
+    node_pointer result = InsertInto(*root, key, value, comparator, &split);
+    if (!split) {
+      return result;
+    }
+
+    // The root was split, so the tree grows a level.
+    std::vector<node_pointer> children;
+    children.push_back(std::move(result));
+    children.push_back(std::move(split));
+    return NewNode(std::move(children));
+  }
+
+  /**
+   * Returns the root of a tree without the given key, or `root` itself if the
+   * tree does not contain it.
+   */
+  template <typename Comparator>
+  static node_pointer Erase(const node_pointer& root,
+                            const K& key,
+                            const Comparator& comparator) {
+    if (!root) {
+      return root;
+    }
+
+    node_pointer result = EraseFrom(root, key, comparator);
+    if (result == root) {
+      return root;
+    }
+
+    if (result->leaf() && result->entries().empty()) {
+      return nullptr;
+    } else if (!result->leaf() && result->children().size() == 1) {
+      // The last two children of the root were merged, so the tree shrinks
+      // by a level.
+      return result->children().front();
+    }
+    return result;
+  }
+
+  /**
+   * Returns the root of a tree containing `size` entries taken from `begin`,
+   * whose keys must be in strictly ascending order. The tree is built bottom
+   * up, in linear time.
+   */
+  template <typename Iterator>
+  static node_pointer BuildFromSorted(Iterator begin, size_type size) {
+    if (size == 0) {
+      return nullptr;
+    }
+
+    std::vector<node_pointer> level;
+    Distribute(size, [&](size_type slots) {
+      std::vector<value_type> entries;
+      entries.reserve(slots);
+      for (size_type i = 0; i < slots; ++i, ++begin) {
+        entries.push_back(*begin);
+      }
+      level.push_back(NewNode(std::move(entries)));
+    });
+
+    while (level.size() > 1) {
+      std::vector<node_pointer> parents;
+      auto child = std::make_move_iterator(level.begin());
+      Distribute(static_cast<size_type>(level.size()), [&](size_type slots) {
+        std::vector<node_pointer> children(child, child + slots);
+        child += slots;
+        parents.push_back(NewNode(std::move(children)));
+      });
+      level = std::move(parents);
+    }
+    return std::move(level.front());
+  }
+
+ private:
+  template <typename Comparator>
+  static node_pointer InsertInto(const BTreeNode& node,
+                                 const K& key,
+                                 const V& value,
+                                 const Comparator& comparator,
+                                 node_pointer* split) {
+    if (node.leaf()) {
+      size_type index = node.LowerBoundIndex(key, comparator);
+      auto position = node.entries_.begin() + index;
+      bool replace = index < node.entries_.size() &&
+                     util::Same(comparator.Compare(key, position->first));
+
+      std::vector<value_type> entries;
+      entries.reserve(node.entries_.size() + 1);
+      entries.insert(entries.end(), node.entries_.begin(), position);
+      entries.emplace_back(key, value);
+      entries.insert(entries.end(), replace ? position + 1 : position,
+                     node.entries_.end());
+      return MakeNode(std::move(entries), split);
+    }
+
+    size_type index = node.ChildIndex(key, comparator);
+    node_pointer child_split;
+    node_pointer child = InsertInto(*node.children_[index], key, value,
+                                    comparator, &child_split);
+
+    std::vector<node_pointer> children;
+    children.reserve(node.children_.size() + 1);
+    children = node.children_;
+    children[index] = std::move(child);
+    if (child_split) {
+      children.insert(children.begin() + index + 1, std::move(child_split));
+    }
+    return MakeNode(std::move(children), split);
+  }
+
+  template <typename Comparator>
+  static node_pointer EraseFrom(const node_pointer& node,
+                                const K& key,
+                                const Comparator& comparator) {
+    if (node->leaf()) {
+      size_type index = node->LowerBoundIndex(key, comparator);
+      auto position = node->entries_.begin() + index;
+      if (index == node->entries_.size() ||
+          !util::Same(comparator.Compare(key, position->first))) {
+        return node;
+      }
+
+      std::vector<value_type> entries;
+      entries.reserve(node->entries_.size() - 1);
+      entries.insert(entries.end(), node->entries_.begin(), position);
+      entries.insert(entries.end(), position + 1, node->entries_.end());
+      return NewNode(std::move(entries));
+    }
+
+    size_type index = node->ChildIndex(key, comparator);
+    const node_pointer& child = node->children_[index];
+    node_pointer erased = EraseFrom(child, key, comparator);
+    if (erased == child) {
+      return node;
+    }
+
+    std::vector<node_pointer> children = node->children_;
+    children[index] = std::move(erased);
+    if (Slots(*children[index]) < kBTreeMinSlots) {
+      Rebalance(&children, index);
+    }
+    return NewNode(std::move(children));
+  }
+
+  /**
+   * Merges the underfull child at `index` with a sibling, splitting the result
+   * evenly again if it holds more than `kBTreeMaxSlots`, so that every child
+   * has at least `kBTreeMinSlots` once more.
+   */
+  static void Rebalance(std::vector<node_pointer>* children, size_type index) {
+    size_type left = index > 0 ? index - 1 : index;
+    const BTreeNode& first = *(*children)[left];
+    const BTreeNode& second = *(*children)[left + 1];
+
+    node_pointer merged;
+    node_pointer split;
+    if (first.leaf()) {
+      std::vector<value_type> entries;
+      entries.reserve(first.entries_.size() + second.entries_.size());
+      entries = first.entries_;
+      entries.insert(entries.end(), second.entries_.begin(),
+                     second.entries_.end());
+      merged = MakeNode(std::move(entries), &split);
+    } else {
+      std::vector<node_pointer> grandchildren;
+      grandchildren.reserve(first.children_.size() + second.children_.size());
+      grandchildren = first.children_;
+      grandchildren.insert(grandchildren.end(), second.children_.begin(),
+                           second.children_.end());
+      merged = MakeNode(std::move(grandchildren), &split);
+    }
+
+    (*children)[left] = std::move(merged);
+    if (split) {
+      (*children)[left + 1] = std::move(split);
+    } else {
+      children->erase(children->begin() + left + 1);
+    }
+  }
+
+  /**
+   * Makes a node of the given slots, or, if there are too many, two nodes of
+   * half of them each, the second of which is stored in `split`.
+   */
+  template <typename T>
+  static node_pointer MakeNode(std::vector<T>&& slots, node_pointer* split) {
+    if (slots.size() > kBTreeMaxSlots) {
+      size_t half = slots.size() / 2;
+      std::vector<T> second(std::make_move_iterator(slots.begin() + half),
+                            std::make_move_iterator(slots.end()));
+      while (slots.size() > half) {
+        slots.pop_back();
+      }
+      *split = NewNode(std::move(second));
+    }
+    return NewNode(std::move(slots));
+  }
+
+  /** Allocates a node, counting it toward the sorted map allocations. */
+  template <typename T>
+  static node_pointer NewNode(std::vector<T>&& slots) {
+    return util::MakeSharedCounted<BTreeNode>(
+        util::AllocationSubsystem::kSortedMap, std::move(slots));
+  }
+
+  /**
+   * Splits `size` slots into the fewest nodes that can hold them, as evenly
+   * as possible, calling `make_node` with the number of slots of each.
+   */
+  template <typename MakeNodeFn>
+  static void Distribute(size_type size, const MakeNodeFn& make_node) {
+    size_type nodes = (size + kBTreeMaxSlots - 1) / kBTreeMaxSlots;
+    size_type per_node = size / nodes;
+    size_type remainder = size % nodes;
+    for (size_type i = 0; i < nodes; ++i) {
+      make_node(per_node + (i < remainder ? 1 : 0));
+    }
+  }
+
+  static size_type Slots(const BTreeNode& node) {
+    return static_cast<size_type>(node.leaf() ? node.entries_.size()
+                                              : node.children_.size());
+  }
+
+  /** The heap memory held by the slot vectors, which never change size. */
+  size_t SlotBytes() const {
+    return entries_.capacity() * sizeof(value_type) +
+           children_.capacity() * sizeof(node_pointer) +
+           keys_.capacity() * sizeof(K);
+  }
+
+  size_type size_;
+  std::vector<value_type> entries_;
+  std::vector<node_pointer> children_;
+  std::vector<K> keys_;
+};
+
+}  // namespace impl
+}  // namespace immutable
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_IMMUTABLE_BTREE_NODE_H_
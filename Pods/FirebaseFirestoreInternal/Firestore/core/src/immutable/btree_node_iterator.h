@@ -0,0 +1,252 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef FIRESTORE_CORE_SRC_IMMUTABLE_BTREE_NODE_ITERATOR_H_
+#define FIRESTORE_CORE_SRC_IMMUTABLE_BTREE_NODE_ITERATOR_H_
+
+#include <array>
+#include <iterator>
+#include <utility>
+
+#include "Firestore/core/src/immutable/sorted_container.h"
+#include "Firestore/core/src/util/hard_assert.h"
+
+namespace firebase {
+namespace firestore {
+namespace immutable {
+namespace impl {
+
+/**
+ * The maximum depth of a tree of BTreeNodes. Every node but the root has at
+ * least half of the maximum number of slots, so this many levels are enough
+ * for any tree whose size fits in a `size_type`.
+ */
+constexpr SortedContainer::size_type kBTreeMaxDepth = 8;
+
+/**
+ * A forward iterator for traversing BTreeNodes. BTreeNodes represent the nodes
+ * in a B+-tree implementing a sorted map so iterating with BTreeNodeIterator is
+ * an in-order traversal of the map.
+ *
+ * ## Complexity
+ *
+ * Like LlrbNode, BTreeNode is immutable and shared between versions of a tree,
+ * so it cannot contain parent or sibling pointers and this iterator keeps an
+ * explicit stack of the path from the root. The stack is a fixed-size array,
+ * so copying an iterator does not allocate.
+ *
+ * Incrementing an iterator moves to the next entry of the same leaf, which is
+ * stored contiguously with it, except once per leaf, when it takes `O(lg(n))`
+ * to move to the next leaf.
+ *
+ * ## Invalidation and Comparison
+ *
+ * BTreeNodeIterators compare based on the identity of the entries they point
+ * to, and are not invalidated by mutations, which create new trees. See
+ * LlrbNodeIterator for details.
+ *
+ * Note: BTreeNodeIterator does not extend the lifetime of its underlying tree.
+ */
+template <typename N>
+class BTreeNodeIterator : public SortedContainer {
+ public:
+  using node_type = N;
+  using key_type = typename node_type::first_type;
+
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = typename node_type::value_type;
+
+  using pointer = typename node_type::value_type const*;
+  using reference = typename node_type::value_type const&;
+  using difference_type = std::ptrdiff_t;
+
+  // Default constructor to conform to the requirements of ForwardIterator
+  BTreeNodeIterator() {
+  }
+
+  /**
+   * Constructs an iterator pointing at the first entry of the tree with the
+   * given root, which may be null for an empty tree.
+   */
+  static BTreeNodeIterator Begin(const node_type* root) {
+    BTreeNodeIterator result;
+    if (root != nullptr) {
+      result.AccumulateLeft(root);
+    }
+    return result;
+  }
+
+  /** Constructs an iterator pointing past the end of any tree. */
+  static BTreeNodeIterator End() {
+    return BTreeNodeIterator{};
+  }
+
+  /**
+   * Constructs an iterator pointing at the last entry of the tree with the
+   * given root, which may be null for an empty tree.
+   */
+  static BTreeNodeIterator Last(const node_type* root) {
+    BTreeNodeIterator result;
+    const node_type* node = root;
+    while (node != nullptr) {
+      if (node->leaf()) {
+        result.Push(node, node->entries().size() - 1);
+        break;
+      }
+      size_type last = node->children().size() - 1;
+      result.Push(node, last);
+      node = node->children()[last].get();
+    }
+    return result;
+  }
+
+  /**
+   * Constructs an iterator pointing to the first entry whose key is not less
+   * than the given key, or an equivalent to `End()` if there is none.
+   */
+  template <typename C>
+  static BTreeNodeIterator LowerBound(const node_type* root,
+                                      const key_type& key,
+                                      const C& comparator) {
+    BTreeNodeIterator result;
+    if (root == nullptr) {
+      return result;
+    }
+
+    const node_type* node = root;
+    while (!node->leaf()) {
+      size_type index = node->ChildIndex(key, comparator);
+      result.Push(node, index);
+      node = node->children()[index].get();
+    }
+
+    size_type index = node->LowerBoundIndex(key, comparator);
+    result.Push(node, index);
+    if (index == node->entries().size()) {
+      // All keys in this leaf are less than the key, so the lower bound is
+      // the first entry of the next leaf.
+      result.NextLeaf();
+    }
+    return result;
+  }
+
+  /**
+   * Returns true if this iterator points at the end of the iteration sequence.
+   */
+  bool is_end() const {
+    return depth_ == 0;
+  }
+
+  /**
+   * Returns the address of the entry that this iterator points to. This can
+   * only be called if `end()` is false.
+   */
+  pointer get() const {
+    HARD_ASSERT(!is_end());
+    const Frame& leaf = stack_[depth_ - 1];
+    return &leaf.node->entries()[leaf.index];
+  }
+
+  reference operator*() const {
+    return *get();
+  }
+
+  pointer operator->() const {
+    return get();
+  }
+
+  BTreeNodeIterator& operator++() {
+    HARD_ASSERT(!is_end());
+
+    Frame& leaf = stack_[depth_ - 1];
+    ++leaf.index;
+    if (leaf.index == leaf.node->entries().size()) {
+      NextLeaf();
+    }
+    return *this;
+  }
+
+  BTreeNodeIterator operator++(int /*unused*/) {
+    BTreeNodeIterator result = *this;
+    ++*this;
+    return result;
+  }
+
+  friend bool operator==(const BTreeNodeIterator& a,
+                         const BTreeNodeIterator& b) {
+    if (a.is_end()) {
+      return b.is_end();
+    } else if (b.is_end()) {
+      return false;
+    } else {
+      return a.get() == b.get();
+    }
+  }
+
+  bool operator!=(const BTreeNodeIterator& b) const {
+    return !(*this == b);
+  }
+
+ private:
+  struct Frame {
+    const node_type* node;
+    size_type index;
+  };
+
+  void Push(const node_type* node, size_type index) {
+    HARD_ASSERT(depth_ < kBTreeMaxDepth, "BTree is deeper than expected");
+    stack_[depth_] = Frame{node, index};
+    ++depth_;
+  }
+
+  void AccumulateLeft(const node_type* node) {
+    for (;;) {
+      Push(node, 0);
+      if (node->leaf()) {
+        break;
+      }
+      node = node->children().front().get();
+    }
+  }
+
+  /**
+   * Pops the exhausted leaf at the top of the stack and moves to the first
+   * entry of the next leaf, or to the end if there is none.
+   */
+  void NextLeaf() {
+    --depth_;
+    while (depth_ > 0) {
+      Frame& parent = stack_[depth_ - 1];
+      ++parent.index;
+      if (parent.index < parent.node->children().size()) {
+        AccumulateLeft(parent.node->children()[parent.index].get());
+        return;
+      }
+      --depth_;
+    }
+  }
+
+  std::array<Frame, kBTreeMaxDepth> stack_{};
+  size_type depth_ = 0;
+};
+
+}  // namespace impl
+}  // namespace immutable
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_IMMUTABLE_BTREE_NODE_ITERATOR_H_
@@ -22,6 +22,7 @@
 
 #include "Firestore/core/src/immutable/llrb_node_iterator.h"
 #include "Firestore/core/src/immutable/sorted_container.h"
+#include "Firestore/core/src/util/allocation_stats.h"
 #include "Firestore/core/src/util/comparison.h"
 
 namespace firebase {
@@ -149,7 +150,9 @@ class LlrbNode : public SortedMapBase {
     LlrbNode right_;
   };
 
-  explicit LlrbNode(Rep rep) : rep_{std::make_shared<Rep>(std::move(rep))} {
+  explicit LlrbNode(Rep rep)
+      : rep_{util::MakeSharedCounted<Rep>(util::AllocationSubsystem::kSortedMap,
+                                          std::move(rep))} {
   }
 
   explicit LlrbNode(const std::shared_ptr<Rep>& rep) : rep_{rep} {
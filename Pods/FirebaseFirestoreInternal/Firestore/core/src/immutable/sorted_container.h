@@ -70,6 +70,15 @@ class SortedMapBase : public SortedContainer {
    * but don't expect much gain in real world performance.
    */
   static constexpr size_type kFixedSize = 25;
+
+  /**
+   * The maximum size of a TreeSortedMap in a SortedMap.
+   *
+   * Past this size a SortedMap uses a BTreeSortedMap instead, whose wide nodes
+   * make lookups and iteration over large maps cheaper. Below it, the single
+   * entry nodes of the tree make insertions cheaper.
+   */
+  static constexpr size_type kMaxTreeSize = 1024;
 };
 
 }  // namespace immutable
@@ -17,9 +17,11 @@
 #ifndef FIRESTORE_CORE_SRC_IMMUTABLE_SORTED_MAP_H_
 #define FIRESTORE_CORE_SRC_IMMUTABLE_SORTED_MAP_H_
 
+#include <iterator>
 #include <utility>
 
 #include "Firestore/core/src/immutable/array_sorted_map.h"
+#include "Firestore/core/src/immutable/btree_sorted_map.h"
 #include "Firestore/core/src/immutable/keys_view.h"
 #include "Firestore/core/src/immutable/sorted_container.h"
 #include "Firestore/core/src/immutable/sorted_map_iterator.h"
@@ -45,11 +47,13 @@ class SortedMap : public SortedMapBase {
   using value_type = std::pair<K, V>;
   using array_type = impl::ArraySortedMap<K, V, C>;
   using tree_type = impl::TreeSortedMap<K, V, C>;
+  using btree_type = impl::BTreeSortedMap<K, V, C>;
 
   using const_iterator = impl::SortedMapIterator<
       value_type,
       typename impl::FixedArray<value_type>::const_iterator,
-      typename impl::LlrbNode<K, V>::const_iterator>;
+      typename impl::LlrbNode<K, V>::const_iterator,
+      typename impl::BTreeNode<K, V>::const_iterator>;
 
   using const_key_iterator = util::iterator_first<const_iterator>;
 
@@ -73,6 +77,39 @@ class SortedMap : public SortedMapBase {
     }
   }
 
+  /**
+   * Creates a SortedMap containing the given range of entries, whose keys are
+   * expected to be in strictly ascending order. Large maps are then built in
+   * linear time rather than by inserting the entries one at a time, which is
+   * still what happens if the keys turn out not to be in order.
+   */
+  template <typename Range>
+  static SortedMap FromSorted(const Range& entries, const C& comparator = {}) {
+    size_type size = 0;
+    bool sorted = true;
+    auto begin = std::begin(entries);
+    auto end = std::end(entries);
+    for (auto iter = begin, previous = begin; iter != end; ++iter, ++size) {
+      if (iter != begin) {
+        const K& previous_key = previous->first;
+        if (!util::Ascending(comparator.Compare(previous_key, iter->first))) {
+          sorted = false;
+          break;
+        }
+        ++previous;
+      }
+    }
+
+    if (!sorted || size <= kFixedSize) {
+      SortedMap result{comparator};
+      for (auto&& entry : entries) {
+        result = result.insert(entry.first, entry.second);
+      }
+      return result;
+    }
+    return SortedMap{btree_type::CreateFromSorted(entries, comparator)};
+  }
+
   SortedMap(const SortedMap& other) : tag_{other.tag_} {
     switch (tag_) {
       case Tag::Array:
@@ -81,6 +118,9 @@ class SortedMap : public SortedMapBase {
       case Tag::Tree:
         new (&tree_) tree_type{other.tree_};
         break;
+      case Tag::BTree:
+        new (&btree_) btree_type{other.btree_};
+        break;
     }
   }
 
@@ -92,6 +132,9 @@ class SortedMap : public SortedMapBase {
       case Tag::Tree:
         new (&tree_) tree_type{std::move(other.tree_)};
         break;
+      case Tag::BTree:
+        new (&btree_) btree_type{std::move(other.btree_)};
+        break;
     }
   }
 
@@ -103,6 +146,9 @@ class SortedMap : public SortedMapBase {
       case Tag::Tree:
         tree_.~TreeSortedMap();
         break;
+      case Tag::BTree:
+        btree_.~BTreeSortedMap();
+        break;
     }
   }
 
@@ -115,6 +161,9 @@ class SortedMap : public SortedMapBase {
         case Tag::Tree:
           tree_ = other.tree_;
           break;
+        case Tag::BTree:
+          btree_ = other.btree_;
+          break;
       }
     } else {
       this->~SortedMap();
@@ -132,6 +181,9 @@ class SortedMap : public SortedMapBase {
         case Tag::Tree:
           tree_ = std::move(other.tree_);
           break;
+        case Tag::BTree:
+          btree_ = std::move(other.btree_);
+          break;
       }
     } else {
       this->~SortedMap();
@@ -147,6 +199,8 @@ class SortedMap : public SortedMapBase {
         return array_.empty();
       case Tag::Tree:
         return tree_.empty();
+      case Tag::BTree:
+        return btree_.empty();
     }
     UNREACHABLE();
   }
@@ -158,6 +212,8 @@ class SortedMap : public SortedMapBase {
         return array_.size();
       case Tag::Tree:
         return tree_.size();
+      case Tag::BTree:
+        return btree_.size();
     }
     UNREACHABLE();
   }
@@ -168,6 +224,8 @@ class SortedMap : public SortedMapBase {
         return array_.comparator();
       case Tag::Tree:
         return tree_.comparator();
+      case Tag::BTree:
+        return btree_.comparator();
     }
     UNREACHABLE();
   }
@@ -196,7 +254,16 @@ class SortedMap : public SortedMapBase {
           return SortedMap{array_.insert(key, value)};
         }
       case Tag::Tree:
-        return SortedMap{tree_.insert(key, value)};
+        if (tree_.size() >= kMaxTreeSize) {
+          // As with the array above, convert before the insertion that could
+          // take the tree past its maximum size.
+          btree_type btree = btree_type::CreateFromSorted(tree_, comparator());
+          return SortedMap{btree.insert(key, value)};
+        } else {
+          return SortedMap{tree_.insert(key, value)};
+        }
+      case Tag::BTree:
+        return SortedMap{btree_.insert(key, value)};
     }
     UNREACHABLE();
   }
@@ -211,13 +278,21 @@ class SortedMap : public SortedMapBase {
     switch (tag_) {
       case Tag::Array:
         return SortedMap{array_.erase(key)};
-      case Tag::Tree:
+      case Tag::Tree: {
         tree_type result = tree_.erase(key);
         if (result.empty()) {
           // Flip back to the array representation for empty arrays.
           return SortedMap{comparator()};
         }
         return SortedMap{std::move(result)};
+      }
+      case Tag::BTree: {
+        btree_type result = btree_.erase(key);
+        if (result.empty()) {
+          return SortedMap{comparator()};
+        }
+        return SortedMap{std::move(result)};
+      }
     }
     UNREACHABLE();
   }
@@ -228,6 +303,8 @@ class SortedMap : public SortedMapBase {
         return array_.contains(key);
       case Tag::Tree:
         return tree_.contains(key);
+      case Tag::BTree:
+        return btree_.contains(key);
     }
     UNREACHABLE();
   }
@@ -245,6 +322,8 @@ class SortedMap : public SortedMapBase {
         return const_iterator(array_.find(key));
       case Tag::Tree:
         return const_iterator{tree_.find(key)};
+      case Tag::BTree:
+        return const_iterator{btree_.find(key)};
     }
     UNREACHABLE();
   }
@@ -261,6 +340,8 @@ class SortedMap : public SortedMapBase {
         return array_.find_index(key);
       case Tag::Tree:
         return tree_.find_index(key);
+      case Tag::BTree:
+        return btree_.find_index(key);
     }
     UNREACHABLE();
   }
@@ -289,6 +370,8 @@ class SortedMap : public SortedMapBase {
         return const_iterator(array_.lower_bound(key));
       case Tag::Tree:
         return const_iterator{tree_.lower_bound(key)};
+      case Tag::BTree:
+        return const_iterator{btree_.lower_bound(key)};
     }
     UNREACHABLE();
   }
@@ -299,6 +382,8 @@ class SortedMap : public SortedMapBase {
         return const_iterator(array_.min());
       case Tag::Tree:
         return const_iterator{tree_.min()};
+      case Tag::BTree:
+        return const_iterator{btree_.min()};
     }
     UNREACHABLE();
   }
@@ -309,6 +394,8 @@ class SortedMap : public SortedMapBase {
         return const_iterator(array_.max());
       case Tag::Tree:
         return const_iterator{tree_.max()};
+      case Tag::BTree:
+        return const_iterator{btree_.max()};
     }
     UNREACHABLE();
   }
@@ -323,6 +410,8 @@ class SortedMap : public SortedMapBase {
         return const_iterator{array_.begin()};
       case Tag::Tree:
         return const_iterator{tree_.begin()};
+      case Tag::BTree:
+        return const_iterator{btree_.begin()};
     }
     UNREACHABLE();
   }
@@ -336,6 +425,8 @@ class SortedMap : public SortedMapBase {
         return const_iterator{array_.end()};
       case Tag::Tree:
         return const_iterator{tree_.end()};
+      case Tag::BTree:
+        return const_iterator{btree_.end()};
     }
     UNREACHABLE();
   }
@@ -375,15 +466,21 @@ class SortedMap : public SortedMapBase {
       : tag_{Tag::Tree}, tree_{std::move(tree)} {
   }
 
+  explicit SortedMap(btree_type&& btree)
+      : tag_{Tag::BTree}, btree_{std::move(btree)} {
+  }
+
   enum class Tag {
     Array,
     Tree,
+    BTree,
   };
 
   Tag tag_;
   union {
     array_type array_;
     tree_type tree_;
+    btree_type btree_;
   };
 };
 
@@ -19,6 +19,7 @@
 
 #include <algorithm>
 #include <utility>
+#include <vector>
 
 #include "Firestore/core/src/immutable/sorted_container.h"
 #include "Firestore/core/src/immutable/sorted_map.h"
@@ -141,13 +142,22 @@ class SortedSet : public SortedContainer {
     return map_.keys_in(start_key, end_key);
   }
 
+  /**
+   * Creates a SortedSet containing the given range of keys, which are expected
+   * to be in strictly ascending order. See SortedMap::FromSorted.
+   */
+  template <typename Range>
+  static SortedSet FromSorted(const Range& keys, const C& comparator = C()) {
+    std::vector<std::pair<K, util::Empty>> entries;
+    for (const K& key : keys) {
+      entries.emplace_back(key, util::Empty{});
+    }
+    return SortedSet{map_type::FromSorted(entries, comparator)};
+  }
+
   template <typename MapType>
   static SortedSet FromKeysOf(const MapType& map) {
-    SortedSet result;
-    for (const K& key : map.keys()) {
-      result = result.insert(key);
-    }
-    return result;
+    return FromSorted(map.keys());
   }
 
   friend bool operator==(const SortedSet& lhs, const SortedSet& rhs) {
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/local/decoded_document_cache.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace firebase {
+namespace firestore {
+namespace local {
+
+using model::DocumentKey;
+using model::MutableDocument;
+using model::SnapshotVersion;
+
+DecodedDocumentCache::DecodedDocumentCache(size_t capacity)
+    : capacity_(capacity), limit_(capacity) {
+}
+
+absl::optional<MutableDocument> DecodedDocumentCache::Lookup(
+    const DocumentKey& key, const SnapshotVersion& read_time) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = index_.find(key);
+  if (found == index_.end() ||
+      found->second->document.read_time() != read_time) {
+    return absl::nullopt;
+  }
+  entries_.splice(entries_.begin(), entries_, found->second);
+  return found->second->document.Clone();
+}
+
+absl::optional<MutableDocument> DecodedDocumentCache::Lookup(
+    const DocumentKey& key) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = index_.find(key);
+  if (found == index_.end()) {
+    return absl::nullopt;
+  }
+  entries_.splice(entries_.begin(), entries_, found->second);
+  return found->second->document.Clone();
+}
+
+void DecodedDocumentCache::Insert(const MutableDocument& document,
+                                  size_t charge) {
+  if (charge > capacity_) {
+    Erase(document.key());
+    return;
+  }
+  MutableDocument copy = document.Clone();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = index_.find(copy.key());
+  if (found != index_.end()) {
+    EraseLocked(found->second);
+  }
+  if (charge > limit_) {
+    return;
+  }
+  while (usage_ + charge > limit_) {
+    EraseLocked(std::prev(entries_.end()));
+  }
+
+  entries_.push_front(Entry{std::move(copy), charge});
+  index_.emplace(entries_.front().document.key(), entries_.begin());
+  usage_ += charge;
+}
+
+absl::optional<size_t> DecodedDocumentCache::Erase(const DocumentKey& key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = index_.find(key);
+  if (found == index_.end()) {
+    return absl::nullopt;
+  }
+  size_t charge = found->second->charge;
+  EraseLocked(found->second);
+  return charge;
+}
+
+void DecodedDocumentCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  index_.clear();
+  entries_.clear();
+  usage_ = 0;
+}
+
+void DecodedDocumentCache::SetUsageLimit(size_t limit) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  limit_ = std::min(limit, capacity_);
+  while (usage_ > limit_) {
+    EraseLocked(std::prev(entries_.end()));
+  }
+}
+
+void DecodedDocumentCache::EraseLocked(EntryList::iterator entry) {
+  usage_ -= entry->charge;
+  index_.erase(entry->document.key());
+  entries_.erase(entry);
+}
+
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_LOCAL_DECODED_DOCUMENT_CACHE_H_
+#define FIRESTORE_CORE_SRC_LOCAL_DECODED_DOCUMENT_CACHE_H_
+
+#include <cstddef>
+#include <list>
+#include <mutex>  // NOLINT(build/c++11)
+#include <unordered_map>
+
+#include "Firestore/core/src/model/document_key.h"
+#include "Firestore/core/src/model/mutable_document.h"
+#include "Firestore/core/src/model/snapshot_version.h"
+#include "absl/types/optional.h"
+
+namespace firebase {
+namespace firestore {
+namespace local {
+
+/**
+ * A size-bounded cache of decoded documents, evicting the least recently
+ * used entries once the total charge exceeds its capacity.
+ *
+ * Documents are stored and returned as deep copies, since callers apply
+ * mutations to the documents they read in place.
+ *
+ * DecodedDocumentCache is thread-safe.
+ */
+class DecodedDocumentCache {
+ public:
+  /** Creates a cache holding up to `capacity` bytes; zero disables it. */
+  explicit DecodedDocumentCache(size_t capacity);
+
+  /**
+   * Returns a copy of the document cached for `key` if it was read at
+   * `read_time`, or nullopt.
+   */
+  absl::optional<model::MutableDocument> Lookup(
+      const model::DocumentKey& key,
+      const model::SnapshotVersion& read_time) const;
+
+  /** Returns a copy of the document cached for `key`, whatever its read time. */
+  absl::optional<model::MutableDocument> Lookup(
+      const model::DocumentKey& key) const;
+
+  /**
+   * Caches a copy of `document`, replacing any earlier entry for its key.
+   * `charge` is the approximate number of bytes it occupies.
+   */
+  void Insert(const model::MutableDocument& document, size_t charge);
+
+  /**
+   * Drops the entry for `key`, if any, and returns the charge it was inserted
+   * with.
+   */
+  absl::optional<size_t> Erase(const model::DocumentKey& key);
+
+  void Clear();
+
+  /**
+   * Keeps the cache under `limit` bytes, evicting entries as needed, until the
+   * limit is changed again. Limits above the capacity restore the capacity.
+   */
+  void SetUsageLimit(size_t limit);
+
+  size_t capacity() const {
+    return capacity_;
+  }
+
+ private:
+  struct Entry {
+    model::MutableDocument document;
+    size_t charge;
+  };
+
+  using EntryList = std::list<Entry>;
+
+  void EraseLocked(EntryList::iterator entry);
+
+  const size_t capacity_;
+
+  mutable std::mutex mutex_;
+  size_t limit_;
+  // Most recently used first.
+  mutable EntryList entries_;
+  std::unordered_map<model::DocumentKey,
+                     EntryList::iterator,
+                     model::DocumentKeyHash>
+      index_;
+  size_t usage_ = 0;
+};
+
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_LOCAL_DECODED_DOCUMENT_CACHE_H_
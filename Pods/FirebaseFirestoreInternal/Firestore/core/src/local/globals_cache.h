@@ -18,7 +18,10 @@
 #ifndef FIRESTORE_CORE_SRC_LOCAL_GLOBALS_CACHE_H_
 #define FIRESTORE_CORE_SRC_LOCAL_GLOBALS_CACHE_H_
 
+#include <cstdint>
+
 #include "Firestore/core/src/nanopb/byte_string.h"
+#include "absl/types/optional.h"
 
 using firebase::firestore::nanopb::ByteString;
 
@@ -34,6 +37,10 @@ namespace local {
  *
  * `sessionToken` tracks server interaction across Listen and Write streams.
  * This facilitates cache synchronization and invalidation.
+ *
+ * `byteSize` is the running total of the encoded size of the cached documents,
+ * targets and mutation batches, used as the size of the cache by garbage
+ * collection.
  */
 class GlobalsCache {
  public:
@@ -48,6 +55,16 @@ class GlobalsCache {
    * Sets session token.
    */
   virtual void SetSessionToken(const ByteString& session_token) = 0;
+
+  /**
+   * Gets the byte size of the cache, or `nullopt` if it was never recorded.
+   */
+  virtual absl::optional<int64_t> GetByteSize() const = 0;
+
+  /**
+   * Sets the byte size of the cache.
+   */
+  virtual void SetByteSize(int64_t byte_size) = 0;
 };
 
 }  // namespace local
@@ -14,6 +14,7 @@
 
 #include <algorithm>
 #include <string>
+#include <algorithm>
 #include <unordered_set>
 #include <utility>
 
@@ -39,17 +40,38 @@ using model::IndexOffset;
  */
 static const size_t kMaxDocumentsToProcess = 50;
 
+/** The most documents an adaptive budget lets Backfill() process at once. */
+static const size_t kMaxAdaptiveDocumentsToProcess = 2000;
+
+/**
+ * How long a call to Backfill() may hold the queue when the budget is
+ * adaptive.
+ */
+static const auto kAdaptiveTargetRunTime = std::chrono::milliseconds(100);
+
 }  // namespace
 
 IndexBackfiller::IndexBackfiller() {
   max_documents_to_process_ = kMaxDocumentsToProcess;
 }
 
+void IndexBackfiller::SetAdaptiveBudgetEnabled(bool enabled) {
+  adaptive_budget_enabled_ = enabled;
+  if (!enabled) {
+    max_documents_to_process_ = kMaxDocumentsToProcess;
+  }
+}
+
 size_t IndexBackfiller::WriteIndexEntries(const LocalStore* local_store) {
+  const auto start = std::chrono::steady_clock::now();
   IndexManager* index_manager = local_store->index_manager();
   std::unordered_set<std::string> processed_collection_groups;
   size_t documents_remaining = max_documents_to_process_;
   while (documents_remaining > 0) {
+    if (!processed_collection_groups.empty() && should_yield_ &&
+        should_yield_()) {
+      break;
+    }
     const auto collection_group =
         index_manager->GetNextCollectionGroupToUpdate();
     if (!collection_group ||
@@ -62,7 +84,25 @@ size_t IndexBackfiller::WriteIndexEntries(const LocalStore* local_store) {
         local_store, collection_group.value(), documents_remaining);
     processed_collection_groups.insert(collection_group.value());
   }
-  return max_documents_to_process_ - documents_remaining;
+
+  size_t processed = max_documents_to_process_ - documents_remaining;
+  if (adaptive_budget_enabled_) {
+    AdaptBudget(processed, std::chrono::steady_clock::now() - start);
+  }
+  return processed;
+}
+
+void IndexBackfiller::AdaptBudget(size_t processed,
+                                  std::chrono::steady_clock::duration elapsed) {
+  if (elapsed > kAdaptiveTargetRunTime) {
+    max_documents_to_process_ =
+        std::max(max_documents_to_process_ / 2, kMaxDocumentsToProcess);
+  } else if (processed == max_documents_to_process_ &&
+             elapsed < kAdaptiveTargetRunTime / 2) {
+    // Only a call that ran out of budget shows that a larger one has work.
+    max_documents_to_process_ = std::min(max_documents_to_process_ * 2,
+                                         kMaxAdaptiveDocumentsToProcess);
+  }
 }
 
 size_t IndexBackfiller::WriteEntriesForCollectionGroup(
@@ -15,8 +15,11 @@
 #ifndef FIRESTORE_CORE_SRC_LOCAL_INDEX_BACKFILLER_H_
 #define FIRESTORE_CORE_SRC_LOCAL_INDEX_BACKFILLER_H_
 
+#include <chrono>
 #include <cstddef>
+#include <functional>
 #include <string>
+#include <utility>
 
 namespace firebase {
 namespace firestore {
@@ -46,6 +49,24 @@ class IndexBackfiller {
    */
   size_t WriteIndexEntries(const LocalStore* local_store);
 
+  /**
+   * Enables or disables the adaptive budget. When enabled, the number of
+   * documents processed per call doubles after calls that finish well within
+   * their time target and halves after calls that overrun it, so that large
+   * backfills use the time the queue would otherwise spend idle.
+   */
+  void SetAdaptiveBudgetEnabled(bool enabled);
+
+  /**
+   * Sets a check that tells `WriteIndexEntries()` to stop before its next
+   * collection group, because more urgent work is waiting. The first
+   * collection group is always processed, so that the backfill makes
+   * progress.
+   */
+  void SetShouldYield(std::function<bool()> should_yield) {
+    should_yield_ = std::move(should_yield);
+  }
+
  private:
   friend class IndexBackfillerTest;
   friend class LocalStoreTestBase;
@@ -59,6 +80,13 @@ class IndexBackfiller {
       const std::string& collection_group,
       size_t documents_remaining_under_cap) const;
 
+  /**
+   * Grows or shrinks the budget after a call that processed `processed`
+   * documents in `elapsed`.
+   */
+  void AdaptBudget(size_t processed,
+                   std::chrono::steady_clock::duration elapsed);
+
   /** Returns the next offset based on the provided documents. */
   model::IndexOffset GetNewOffset(const model::IndexOffset& existing_offset,
                                   const LocalWriteResult& lookup_result) const;
@@ -69,6 +97,8 @@ class IndexBackfiller {
   }
 
   size_t max_documents_to_process_;
+  bool adaptive_budget_enabled_ = false;
+  std::function<bool()> should_yield_;
 };
 
 }  // namespace local
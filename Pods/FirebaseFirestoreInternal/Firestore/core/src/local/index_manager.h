@@ -18,6 +18,7 @@
 #define FIRESTORE_CORE_SRC_LOCAL_INDEX_MANAGER_H_
 
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "Firestore/core/src/model/model_fwd.h"
@@ -112,6 +113,12 @@ class IndexManager {
   /** Returns all configured field indexes. */
   virtual std::vector<model::FieldIndex> GetFieldIndexes() const = 0;
 
+  /**
+   * Returns true if any field index is configured for the collection group.
+   * Unlike the other methods, this may be called on any thread.
+   */
+  virtual bool HasFieldIndexes(const std::string& collection_group) const = 0;
+
   /** Removes all field indexes and deletes all index values. */
   virtual void DeleteAllFieldIndexes() = 0;
 
@@ -140,6 +147,29 @@ class IndexManager {
   virtual absl::optional<std::vector<model::DocumentKey>>
   GetDocumentsMatchingTarget(const core::Target& target) = 0;
 
+  /**
+   * Returns the documents that match the given target based on the provided
+   * index, each with the values of the index's stored fields, or `nullopt` if
+   * the query cannot be served from indexes that store all of `fields`.
+   *
+   * Like the keys returned by `GetDocumentsMatchingTarget()`, the values are
+   * only as up to date as the index offset of the indexes used.
+   */
+  virtual absl::optional<
+      std::vector<std::pair<model::DocumentKey, model::ObjectValue>>>
+  GetStoredValuesMatchingTarget(
+      const core::Target& target,
+      const std::vector<model::FieldPath>& fields) = 0;
+
+  /**
+   * Returns an estimate of the number of index entries that
+   * `GetDocumentsMatchingTarget()` reads to serve the given target, or
+   * `nullopt` if the target cannot be served from an index or no estimate is
+   * available.
+   */
+  virtual absl::optional<size_t> EstimateIndexEntriesRead(
+      const core::Target& target) = 0;
+
   /**
    * Returns the next collection group to update. Returns `nullopt` if no
    * group exists.
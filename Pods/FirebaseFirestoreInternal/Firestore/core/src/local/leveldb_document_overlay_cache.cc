@@ -88,12 +88,27 @@ void LevelDbDocumentOverlayCache::RemoveOverlaysForBatchId(int batch_id) {
 OverlayByDocumentKeyMap LevelDbDocumentOverlayCache::GetOverlays(
     const ResourcePath& collection, int since_batch_id) const {
   OverlayByDocumentKeyMap result;
-  ForEachKeyInCollection(
-      collection, since_batch_id, [&](LevelDbDocumentOverlayKey&& key) {
-        absl::optional<Overlay> overlay = GetOverlay(key);
-        HARD_ASSERT(overlay.has_value());
-        result[std::move(key).document_key()] = std::move(overlay).value();
-      });
+  if (db_->current_transaction()->reads_snapshot()) {
+    // The loaded overlays follow the latest state, not the snapshot, and are
+    // only ever touched by the worker queue.
+    ForEachKeyInCollection(
+        collection, since_batch_id, [&](LevelDbDocumentOverlayKey&& key) {
+          absl::optional<Overlay> overlay = GetOverlay(key);
+          HARD_ASSERT(overlay.has_value());
+          result[std::move(key).document_key()] = std::move(overlay).value();
+        });
+    return result;
+  }
+
+  const CollectionOverlays& loaded = LoadCollectionOverlays(collection);
+  for (auto it = loaded.keys_by_batch_id.upper_bound(since_batch_id);
+       it != loaded.keys_by_batch_id.end(); ++it) {
+    for (const DocumentKey& document_key : it->second) {
+      const auto overlay_iter = loaded.overlays.find(document_key);
+      HARD_ASSERT(overlay_iter != loaded.overlays.end());
+      result[document_key] = overlay_iter->second;
+    }
+  }
   return result;
 }
 
@@ -185,6 +200,9 @@ void LevelDbDocumentOverlayCache::SaveOverlay(int largest_batch_id,
   if (collection_group_index_key.has_value()) {
     transaction->Put(std::move(collection_group_index_key).value(), "");
   }
+
+  const Overlay overlay(largest_batch_id, mutation);
+  UpdateCollectionOverlays(key, &overlay);
 }
 
 void LevelDbDocumentOverlayCache::DeleteOverlay(
@@ -217,6 +235,8 @@ void LevelDbDocumentOverlayCache::DeleteOverlay(
   if (collection_group_index_key.has_value()) {
     transaction->Delete(std::move(collection_group_index_key).value());
   }
+
+  UpdateCollectionOverlays(key, nullptr);
 }
 
 void LevelDbDocumentOverlayCache::ForEachKeyWithLargestBatchId(
@@ -298,6 +318,55 @@ absl::optional<Overlay> LevelDbDocumentOverlayCache::GetOverlay(
   return ParseOverlay(key, it->value());
 }
 
+const LevelDbDocumentOverlayCache::CollectionOverlays&
+LevelDbDocumentOverlayCache::LoadCollectionOverlays(
+    const ResourcePath& collection) const {
+  auto found = collection_overlays_.find(collection);
+  if (found != collection_overlays_.end()) {
+    return found->second;
+  }
+
+  CollectionOverlays& loaded = collection_overlays_[collection];
+  ForEachKeyInCollection(
+      collection, model::kBatchIdUnknown, [&](LevelDbDocumentOverlayKey&& key) {
+        absl::optional<Overlay> overlay = GetOverlay(key);
+        HARD_ASSERT(overlay.has_value());
+        loaded.keys_by_batch_id[key.largest_batch_id()].insert(
+            key.document_key());
+        loaded.overlays.emplace(std::move(key).document_key(),
+                                std::move(overlay).value());
+      });
+  return loaded;
+}
+
+void LevelDbDocumentOverlayCache::UpdateCollectionOverlays(
+    const LevelDbDocumentOverlayKey& key, const Overlay* overlay) {
+  const DocumentKey& document_key = key.document_key();
+  auto found = collection_overlays_.find(document_key.path().PopLast());
+  if (found == collection_overlays_.end()) {
+    // Not loaded yet; it will be read from LevelDB when it is.
+    return;
+  }
+
+  CollectionOverlays& loaded = found->second;
+  auto existing = loaded.overlays.find(document_key);
+  if (existing != loaded.overlays.end()) {
+    auto batch_iter =
+        loaded.keys_by_batch_id.find(existing->second.largest_batch_id());
+    HARD_ASSERT(batch_iter != loaded.keys_by_batch_id.end());
+    batch_iter->second.erase(document_key);
+    if (batch_iter->second.empty()) {
+      loaded.keys_by_batch_id.erase(batch_iter);
+    }
+    loaded.overlays.erase(existing);
+  }
+
+  if (overlay != nullptr) {
+    loaded.keys_by_batch_id[overlay->largest_batch_id()].insert(document_key);
+    loaded.overlays.emplace(document_key, *overlay);
+  }
+}
+
 }  // namespace local
 }  // namespace firestore
 }  // namespace firebase
@@ -19,9 +19,15 @@
 
 #include <cstdlib>
 #include <functional>
+#include <map>
+#include <set>
 #include <string>
+#include <unordered_map>
 
 #include "Firestore/core/src/local/document_overlay_cache.h"
+#include "Firestore/core/src/model/document_key.h"
+#include "Firestore/core/src/model/overlay.h"
+#include "Firestore/core/src/model/resource_path.h"
 #include "absl/strings/string_view.h"
 
 namespace firebase {
@@ -112,6 +118,31 @@ class LevelDbDocumentOverlayCache final : public DocumentOverlayCache {
   absl::optional<model::Overlay> GetOverlay(
       const LevelDbDocumentOverlayKey& decoded_key) const;
 
+  /**
+   * The decoded overlays of a collection, with their keys by largest batch
+   * ID.
+   */
+  struct CollectionOverlays {
+    std::map<int, std::set<model::DocumentKey>> keys_by_batch_id;
+    std::unordered_map<model::DocumentKey, model::Overlay,
+                       model::DocumentKeyHash>
+        overlays;
+  };
+
+  /**
+   * Returns the overlays of `collection`, reading and decoding them on first
+   * use.
+   */
+  const CollectionOverlays& LoadCollectionOverlays(
+      const model::ResourcePath& collection) const;
+
+  /**
+   * Brings the loaded overlays of the collection of `key` in line with a
+   * write of `overlay` for it, or with its removal if `overlay` is null.
+   */
+  void UpdateCollectionOverlays(const LevelDbDocumentOverlayKey& key,
+                                const model::Overlay* overlay);
+
   // The LevelDbDocumentOverlayCache instance is owned by LevelDbPersistence.
   LevelDbPersistence* db_;
 
@@ -123,6 +154,15 @@ class LevelDbDocumentOverlayCache final : public DocumentOverlayCache {
    * LevelDB keys.
    */
   std::string user_id_;
+
+  /**
+   * The overlays of the collections queried so far. Offline clients with many
+   * pending writes look up the overlays of the same collections for every
+   * query, and would otherwise decode them from LevelDB each time. Kept in
+   * step with the overlays saved and deleted through this cache.
+   */
+  mutable std::map<model::ResourcePath, CollectionOverlays>
+      collection_overlays_;
 };
 
 }  // namespace local
@@ -19,6 +19,8 @@
 #include "Firestore/core/src/local/leveldb_globals_cache.h"
 #include "Firestore/core/src/local/leveldb_key.h"
 #include "Firestore/core/src/local/leveldb_persistence.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
 
 namespace firebase {
 namespace firestore {
@@ -27,6 +29,7 @@ namespace local {
 namespace {
 
 const char* kSessionToken = "session_token";
+const char* kByteSize = "byte_size";
 
 }
 
@@ -52,6 +55,23 @@ void LevelDbGlobalsCache::SetSessionToken(const ByteString& session_token) {
   db_->current_transaction()->Put(key, session_token.ToString());
 }
 
+absl::optional<int64_t> LevelDbGlobalsCache::GetByteSize() const {
+  auto key = LevelDbGlobalKey::Key(kByteSize);
+
+  std::string encoded;
+  int64_t byte_size;
+  if (!db_->current_transaction()->Get(key, &encoded).ok() ||
+      !absl::SimpleAtoi(encoded, &byte_size)) {
+    return absl::nullopt;
+  }
+  return byte_size;
+}
+
+void LevelDbGlobalsCache::SetByteSize(int64_t byte_size) {
+  auto key = LevelDbGlobalKey::Key(kByteSize);
+  db_->current_transaction()->Put(key, absl::StrCat(byte_size));
+}
+
 }  // namespace local
 }  // namespace firestore
 }  // namespace firebase
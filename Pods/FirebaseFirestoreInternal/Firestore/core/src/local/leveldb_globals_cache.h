@@ -40,6 +40,10 @@ class LevelDbGlobalsCache : public GlobalsCache {
    */
   void SetSessionToken(const ByteString& session_token) override;
 
+  absl::optional<int64_t> GetByteSize() const override;
+
+  void SetByteSize(int64_t byte_size) override;
+
  private:
   // The LevelDbGlobalsCache is owned by LevelDbPersistence.
   LevelDbPersistence* db_ = nullptr;
@@ -19,8 +19,8 @@
 #include <algorithm>
 #include <functional>
 #include <memory>
-#include <set>
 #include <string>
+#include <thread>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -38,13 +38,19 @@
 #include "Firestore/core/src/model/document_set.h"
 #include "Firestore/core/src/model/field_index.h"
 #include "Firestore/core/src/model/model_fwd.h"
+#include "Firestore/core/src/model/object_value.h"
 #include "Firestore/core/src/model/resource_path.h"
 #include "Firestore/core/src/model/target_index_matcher.h"
+#include "Firestore/core/src/model/value_util.h"
+#include "Firestore/core/src/nanopb/message.h"
+#include "Firestore/core/src/nanopb/reader.h"
+#include "Firestore/core/src/nanopb/writer.h"
+#include "Firestore/core/src/util/background_queue.h"
 #include "Firestore/core/src/util/comparison.h"
+#include "Firestore/core/src/util/executor.h"
 #include "Firestore/core/src/util/hard_assert.h"
 #include "Firestore/core/src/util/log.h"
 #include "Firestore/core/src/util/logic_utils.h"
-#include "Firestore/core/src/util/set_util.h"
 #include "Firestore/core/src/util/string_util.h"
 #include "Firestore/third_party/nlohmann_json/json.hpp"
 #include "absl/strings/match.h"
@@ -64,15 +70,58 @@ using index::IndexEntry;
 using model::DocumentKey;
 using model::DocumentMap;
 using model::FieldIndex;
+using model::FieldPath;
 using model::IndexState;
+using model::ObjectValue;
 using model::ResourcePath;
 using model::SnapshotVersion;
 using model::TargetIndexMatcher;
+using model::TransformMap;
 using nlohmann::json;
+using util::BackgroundQueue;
+using util::Executor;
 using util::LogicUtils;
 
 namespace {
 
+/**
+ * Batches of fewer documents than this compute their index entries on the
+ * calling thread, since handing them to the workers would cost more.
+ */
+const size_t kMinDocumentsForParallelIndexing = 8;
+
+/** The number of buckets in the histogram of an index's entries. */
+const size_t kStatisticsHistogramBuckets = 32;
+
+/** Returns the histogram bucket that holds `key`. */
+size_t FindBucket(const std::vector<std::string>& bucket_bounds,
+                  absl::string_view key) {
+  auto it = std::upper_bound(
+      bucket_bounds.begin(), bucket_bounds.end(), key,
+      [](absl::string_view lhs, const std::string& rhs) { return lhs < rhs; });
+  return it == bucket_bounds.begin() ? 0 : it - bucket_bounds.begin() - 1;
+}
+
+/**
+ * Returns true if `index` stores the values of all of `fields`, as stored
+ * fields or fields nested in them.
+ */
+bool StoresFields(const FieldIndex& index,
+                  const std::vector<FieldPath>& fields) {
+  const std::vector<FieldPath>& stored_fields = index.stored_fields();
+  for (const FieldPath& field : fields) {
+    auto stored = std::find_if(
+        stored_fields.begin(), stored_fields.end(),
+        [&field](const FieldPath& path) {
+          return path.IsPrefixOf(field);
+        });
+    if (stored == stored_fields.end()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 struct DbIndexState {
   int64_t seconds;
   int32_t nanos;
@@ -137,6 +186,7 @@ std::vector<IndexEncodingBuffer> ExpandIndexValues(
     const model::Segment& segment,
     const google_firestore_v1_Value& value) {
   std::vector<IndexEncodingBuffer> results;
+  results.reserve(value.array_value.values_count * buffers.size());
   for (size_t idx = 0; idx < value.array_value.values_count; ++idx) {
     for (const IndexEncodingBuffer& buf : buffers) {
       IndexEncodingBuffer cloned_buf;
@@ -153,6 +203,7 @@ std::vector<IndexEncodingBuffer> ExpandIndexValues(
 std::vector<std::string> GetEncodedBytes(
     const std::vector<IndexEncodingBuffer>& buffers) {
   std::vector<std::string> result;
+  result.reserve(buffers.size());
   for (const auto& buf : buffers) {
     result.push_back(buf.GetEncodedBytes());
   }
@@ -204,8 +255,19 @@ LevelDbIndexManager::LevelDbIndexManager(const User& user,
   next_index_to_update_ = std::priority_queue<
       FieldIndex*, std::vector<FieldIndex*>,
       std::function<bool(model::FieldIndex*, model::FieldIndex*)>>(cmp);
+
+  auto hw_concurrency = std::thread::hardware_concurrency();
+  if (hw_concurrency == 0) {
+    // If the standard library doesn't know, guess something reasonable.
+    hw_concurrency = 4;
+  }
+  executor_ = Executor::CreateConcurrent("com.google.firebase.firestore.index",
+                                         static_cast<int>(hw_concurrency));
 }
 
+// Out of line because of unique_ptrs to incomplete types.
+LevelDbIndexManager::~LevelDbIndexManager() = default;
+
 void LevelDbIndexManager::AddToCollectionParentIndex(
     const ResourcePath& collection_path) {
   HARD_ASSERT(collection_path.size() % 2 == 1, "Expected a collection path.");
@@ -284,6 +346,8 @@ void LevelDbIndexManager::Start() {
       }
 
       auto segments = serializer_->DecodeFieldIndexSegments(&reader, *message);
+      auto stored_fields =
+          serializer_->DecodeFieldIndexStoredFields(&reader, *message);
       if (!reader.ok()) {
         HARD_FAIL("Index proto failed to decode: %s",
                   reader.status().ToString());
@@ -301,7 +365,8 @@ void LevelDbIndexManager::Start() {
       // `memoized_max_sequence_number_`.
       MemoizeIndex(FieldIndex(config_key.index_id(),
                               config_key.collection_group(),
-                              std::move(segments), state));
+                              std::move(segments), state,
+                              std::move(stored_fields)));
     }
   }
 
@@ -334,6 +399,7 @@ void LevelDbIndexManager::MemoizeIndex(FieldIndex index) {
   // later.
   auto index_id = index.index_id();
   auto sequence_number = index.index_state().sequence_number();
+  std::string collection_group = index.collection_group();
 
   auto existing_index_iter = existing_indexes.find(index_id);
 
@@ -350,6 +416,20 @@ void LevelDbIndexManager::MemoizeIndex(FieldIndex index) {
   memoized_max_index_id_ = std::max(memoized_max_index_id_, index_id);
   memoized_max_sequence_number_ =
       std::max(memoized_max_sequence_number_, sequence_number);
+  UpdateIndexedCollectionGroup(collection_group);
+}
+
+void LevelDbIndexManager::UpdateIndexedCollectionGroup(
+    const std::string& collection_group) {
+  auto iter = memoized_indexes_.find(collection_group);
+  bool indexed = iter != memoized_indexes_.end() && !iter->second.empty();
+
+  std::lock_guard<std::mutex> lock(indexed_collection_groups_mutex_);
+  if (indexed) {
+    indexed_collection_groups_.insert(collection_group);
+  } else {
+    indexed_collection_groups_.erase(collection_group);
+  }
 }
 
 void LevelDbIndexManager::AddFieldIndex(const FieldIndex& index) {
@@ -357,12 +437,14 @@ void LevelDbIndexManager::AddFieldIndex(const FieldIndex& index) {
 
   int next_index_id = memoized_max_index_id_ + 1;
   FieldIndex new_index(next_index_id, index.collection_group(),
-                       index.segments(), index.index_state());
+                       index.segments(), index.index_state(),
+                       index.stored_fields());
 
   auto config_key = LevelDbIndexConfigurationKey::Key(
       new_index.index_id(), new_index.collection_group());
   db_->current_transaction()->Put(
-      config_key, serializer_->EncodeFieldIndexSegments(new_index.segments()));
+      config_key, serializer_->EncodeFieldIndexSegments(
+                      new_index.segments(), new_index.stored_fields()));
 
   MemoizeIndex(std::move(new_index));
 }
@@ -402,6 +484,8 @@ void LevelDbIndexManager::DeleteFieldIndex(const FieldIndex& index) {
     }
   }
 
+  index_statistics_.erase(index.index_id());
+
   auto group_index_iter = memoized_indexes_.find(index.collection_group());
   if (group_index_iter != memoized_indexes_.end()) {
     auto& index_map = group_index_iter->second;
@@ -411,6 +495,7 @@ void LevelDbIndexManager::DeleteFieldIndex(const FieldIndex& index) {
       index_map.erase(index_iter);
     }
   }
+  UpdateIndexedCollectionGroup(index.collection_group());
 }
 
 std::vector<FieldIndex> LevelDbIndexManager::GetFieldIndexes(
@@ -439,6 +524,12 @@ std::vector<model::FieldIndex> LevelDbIndexManager::GetFieldIndexes() const {
   return result;
 }
 
+bool LevelDbIndexManager::HasFieldIndexes(
+    const std::string& collection_group) const {
+  std::lock_guard<std::mutex> lock(indexed_collection_groups_mutex_);
+  return indexed_collection_groups_.count(collection_group) > 0;
+}
+
 absl::optional<model::FieldIndex> LevelDbIndexManager::GetFieldIndex(
     const core::Target& target) const {
   HARD_ASSERT(started_, "IndexManager not started");
@@ -474,6 +565,11 @@ void LevelDbIndexManager::DeleteAllFieldIndexes() {
 
   db_->DeleteAllFieldIndexes();
   memoized_indexes_.clear();
+  {
+    std::lock_guard<std::mutex> lock(indexed_collection_groups_mutex_);
+    indexed_collection_groups_.clear();
+  }
+  index_statistics_.clear();
   next_index_to_update_ = QueueForNextIndexToUpdate();
 }
 
@@ -565,16 +661,63 @@ IndexManager::IndexType LevelDbIndexManager::GetIndexType(
 
 absl::optional<std::vector<model::DocumentKey>>
 LevelDbIndexManager::GetDocumentsMatchingTarget(const core::Target& target) {
+  std::vector<DocumentKey> result;
+  bool served = VisitEntriesMatchingTarget(
+      target, {},
+      [&result](const LevelDbIndexEntryKey& entry_key, absl::string_view) {
+        result.push_back(DocumentKey::FromPathString(entry_key.document_key()));
+      });
+  if (!served) {
+    return absl::nullopt;
+  }
+
+  return result;
+}
+
+absl::optional<std::vector<std::pair<model::DocumentKey, model::ObjectValue>>>
+LevelDbIndexManager::GetStoredValuesMatchingTarget(
+    const core::Target& target, const std::vector<model::FieldPath>& fields) {
+  std::vector<std::pair<DocumentKey, ObjectValue>> result;
+  bool served = VisitEntriesMatchingTarget(
+      target, fields,
+      [&result](const LevelDbIndexEntryKey& entry_key,
+                absl::string_view value) {
+        ObjectValue stored_values;
+        if (!value.empty()) {
+          nanopb::StringReader reader{value};
+          auto message =
+              nanopb::Message<google_firestore_v1_Value>::TryParse(&reader);
+          if (!reader.ok()) {
+            HARD_FAIL("Stored index values failed to parse: %s",
+                      reader.status().ToString());
+          }
+          stored_values = ObjectValue(std::move(message));
+        }
+        result.emplace_back(
+            DocumentKey::FromPathString(entry_key.document_key()),
+            std::move(stored_values));
+      });
+  if (!served) {
+    return absl::nullopt;
+  }
+
+  return result;
+}
+
+bool LevelDbIndexManager::VisitEntriesMatchingTarget(
+    const core::Target& target,
+    const std::vector<model::FieldPath>& fields,
+    const std::function<void(const LevelDbIndexEntryKey&, absl::string_view)>&
+        visitor) {
   std::vector<std::pair<core::Target, model::FieldIndex>> indexes;
   for (const auto& sub_target : GetSubTargets(target)) {
     auto index_opt = GetFieldIndex(sub_target);
-    if (!index_opt.has_value()) {
-      return absl::nullopt;
+    if (!index_opt.has_value() || !StoresFields(index_opt.value(), fields)) {
+      return false;
     }
     indexes.emplace_back(sub_target, index_opt.value());
   }
 
-  std::vector<DocumentKey> result;
   std::unordered_set<std::string> existing_keys;
   for (const auto& entry : indexes) {
     const Target& sub_target = entry.first;
@@ -583,18 +726,7 @@ LevelDbIndexManager::GetDocumentsMatchingTarget(const core::Target& target) {
     LOG_DEBUG("Using index %s to execute target %s", index.collection_group(),
               sub_target.CanonicalId());
 
-    auto array_values = sub_target.GetArrayValues(index);
-    auto not_in_values = sub_target.GetNotInValues(index);
-    auto lower_bound = sub_target.GetLowerBound(index);
-    auto upper_bound = sub_target.GetUpperBound(index);
-
-    auto encoded_lower = EncodeBound(index, sub_target, lower_bound);
-    auto encoded_upper = EncodeBound(index, sub_target, upper_bound);
-    auto encoded_not_in = EncodeValues(index, sub_target, not_in_values);
-
-    auto index_ranges = GenerateIndexRanges(
-        index.index_id(), array_values, encoded_lower, lower_bound.inclusive,
-        encoded_upper, upper_bound.inclusive, encoded_not_in);
+    auto index_ranges = GetIndexRanges(sub_target, index);
 
     auto iter = db_->current_transaction()->NewIterator();
     for (const auto& range : index_ranges) {
@@ -608,19 +740,187 @@ LevelDbIndexManager::GetDocumentsMatchingTarget(const core::Target& target) {
         }
 
         ++count;
-        if (existing_keys.find(entry_key.document_key()) ==
-            existing_keys.end()) {
-          result.push_back(
-              DocumentKey::FromPathString(entry_key.document_key()));
-          existing_keys.insert(entry_key.document_key());
+        if (existing_keys.insert(entry_key.document_key()).second) {
+          visitor(entry_key, iter->value());
         }
       }
     }
   }
 
+  return true;
+}
+
+absl::optional<size_t> LevelDbIndexManager::EstimateIndexEntriesRead(
+    const core::Target& target) {
+  std::vector<std::pair<core::Target, model::FieldIndex>> indexes;
+  for (const auto& sub_target : GetSubTargets(target)) {
+    auto index_opt = GetFieldIndex(sub_target);
+    if (!index_opt.has_value()) {
+      return absl::nullopt;
+    }
+    indexes.emplace_back(sub_target, index_opt.value());
+  }
+
+  size_t result = 0;
+  for (const auto& entry : indexes) {
+    const IndexStatistics& stats = GetIndexStatistics(entry.second);
+    if (stats.bucket_bounds.empty()) {
+      continue;
+    }
+
+    for (const auto& range : GetIndexRanges(entry.first, entry.second)) {
+      if (range.upper < stats.bucket_bounds.front()) {
+        continue;
+      }
+
+      // Buckets that lie inside the range are read in full, and half of each
+      // bucket the range starts or ends in.
+      size_t first = FindBucket(stats.bucket_bounds, range.lower);
+      size_t last = FindBucket(stats.bucket_bounds, range.upper);
+      size_t estimate;
+      if (first == last) {
+        // A range inside one bucket is often a single value, which is assumed
+        // to have the average number of entries.
+        size_t per_value =
+            stats.entry_count / std::max<size_t>(stats.distinct_values, 1);
+        estimate = std::min(stats.bucket_counts[first],
+                            std::max(per_value, stats.bucket_counts[first] / 2));
+      } else {
+        estimate =
+            stats.bucket_counts[first] / 2 + stats.bucket_counts[last] / 2;
+        for (size_t i = first + 1; i < last; ++i) {
+          estimate += stats.bucket_counts[i];
+        }
+      }
+
+      // `GetDocumentsMatchingTarget()` stops reading a range at the limit.
+      if (target.HasLimit()) {
+        estimate =
+            std::min(estimate, static_cast<size_t>(std::max(target.limit(), 0)));
+      }
+      result += estimate;
+    }
+  }
+
   return result;
 }
 
+const LevelDbIndexManager::IndexStatistics&
+LevelDbIndexManager::GetIndexStatistics(const FieldIndex& index) {
+  auto existing = index_statistics_.find(index.index_id());
+  if (existing != index_statistics_.end()) {
+    const IndexStatistics& stats = existing->second;
+    // Small indexes are not rebuilt for every few entries they gain.
+    size_t slack = kStatisticsHistogramBuckets;
+    if (stats.entry_count <= 2 * stats.built_entry_count + slack &&
+        2 * stats.entry_count + slack >= stats.built_entry_count) {
+      return stats;
+    }
+  }
+
+  IndexStatistics stats;
+  // A bound is taken every `stride` entries. Once there are twice as many
+  // buckets as needed, neighboring buckets are merged and the stride doubles,
+  // which builds the histogram in one pass without knowing the entry count.
+  size_t stride = 1;
+  std::string last_directional_value;
+
+  auto entry_prefix = LevelDbIndexEntryKey::KeyPrefix(index.index_id());
+  LevelDbIndexEntryKey entry_key;
+  auto iter = db_->current_transaction()->NewIterator();
+  for (iter->Seek(entry_prefix); iter->Valid(); iter->Next()) {
+    if (!absl::StartsWith(iter->key(), entry_prefix) ||
+        !entry_key.Decode(iter->key())) {
+      break;
+    }
+    if (entry_key.user_id() != uid_) {
+      continue;
+    }
+
+    size_t n = stats.entry_count++;
+    if (n % stride == 0) {
+      if (stats.bucket_bounds.size() == 2 * kStatisticsHistogramBuckets) {
+        for (size_t i = 0; i < kStatisticsHistogramBuckets; ++i) {
+          if (i > 0) {
+            stats.bucket_bounds[i] = std::move(stats.bucket_bounds[2 * i]);
+          }
+          stats.bucket_counts[i] =
+              stats.bucket_counts[2 * i] + stats.bucket_counts[2 * i + 1];
+        }
+        stats.bucket_bounds.resize(kStatisticsHistogramBuckets);
+        stats.bucket_counts.resize(kStatisticsHistogramBuckets);
+        stride *= 2;
+      }
+      if (n % stride == 0) {
+        stats.bucket_bounds.push_back(iter->key());
+        stats.bucket_counts.push_back(0);
+      }
+    }
+    ++stats.bucket_counts.back();
+
+    if (n == 0 || entry_key.directional_value() != last_directional_value) {
+      ++stats.distinct_values;
+      last_directional_value = entry_key.directional_value();
+    }
+  }
+  stats.built_entry_count = stats.entry_count;
+
+  LOG_DEBUG("Built statistics for index %s: %s entries, %s distinct values",
+            index.collection_group(), stats.entry_count,
+            stats.distinct_values);
+
+  IndexStatistics& result = index_statistics_[index.index_id()];
+  result = std::move(stats);
+  return result;
+}
+
+void LevelDbIndexManager::UpdateIndexStatistics(int32_t index_id,
+                                                absl::string_view entry_key,
+                                                int delta) {
+  auto it = index_statistics_.find(index_id);
+  if (it == index_statistics_.end()) {
+    // Statistics are only built once they are needed.
+    return;
+  }
+
+  IndexStatistics& stats = it->second;
+  if (stats.bucket_bounds.empty()) {
+    if (delta > 0) {
+      stats.bucket_bounds.emplace_back(entry_key);
+      stats.bucket_counts.push_back(0);
+    } else {
+      return;
+    }
+  }
+
+  size_t& bucket_count = stats.bucket_counts[FindBucket(stats.bucket_bounds,
+                                                        entry_key)];
+  if (delta > 0) {
+    ++stats.entry_count;
+    ++bucket_count;
+  } else {
+    if (stats.entry_count > 0) --stats.entry_count;
+    if (bucket_count > 0) --bucket_count;
+  }
+}
+
+std::vector<LevelDbIndexManager::IndexRange>
+LevelDbIndexManager::GetIndexRanges(const Target& sub_target,
+                                    const FieldIndex& index) {
+  auto array_values = sub_target.GetArrayValues(index);
+  auto not_in_values = sub_target.GetNotInValues(index);
+  auto lower_bound = sub_target.GetLowerBound(index);
+  auto upper_bound = sub_target.GetUpperBound(index);
+
+  auto encoded_lower = EncodeBound(index, sub_target, lower_bound);
+  auto encoded_upper = EncodeBound(index, sub_target, upper_bound);
+  auto encoded_not_in = EncodeValues(index, sub_target, not_in_values);
+
+  return GenerateIndexRanges(index.index_id(), array_values, encoded_lower,
+                             lower_bound.inclusive, encoded_upper,
+                             upper_bound.inclusive, encoded_not_in);
+}
+
 std::vector<std::string> LevelDbIndexManager::EncodeBound(
     const FieldIndex& index,
     const Target& target,
@@ -781,59 +1081,198 @@ void LevelDbIndexManager::UpdateCollectionGroup(
   }
 }
 
+/**
+ * The entries of one document in one index share their index id and document
+ * key, so only their encoded array and directional values are kept. The
+ * values are appended to a single buffer and the entries refer to them by
+ * offset; `Clear()` keeps both allocations, so one instance serves every
+ * document in a call to `UpdateIndexEntries()`.
+ */
+class LevelDbIndexManager::EncodedIndexEntries {
+ public:
+  void Clear() {
+    buffer_.clear();
+    entries_.clear();
+  }
+
+  void Add(absl::string_view array_value, absl::string_view directional_value) {
+    Entry entry;
+    entry.array_offset = buffer_.size();
+    entry.array_size = array_value.size();
+    buffer_.append(array_value.data(), array_value.size());
+    entry.directional_offset = buffer_.size();
+    entry.directional_size = directional_value.size();
+    buffer_.append(directional_value.data(), directional_value.size());
+    entries_.push_back(entry);
+  }
+
+  /**
+   * Sorts the entries in the order of `IndexEntry::CompareTo()` and drops
+   * duplicates.
+   */
+  void Sort() {
+    auto less = [this](const Entry& lhs, const Entry& rhs) {
+      return Compare(lhs, *this, rhs) < 0;
+    };
+    auto equal = [this](const Entry& lhs, const Entry& rhs) {
+      return Compare(lhs, *this, rhs) == 0;
+    };
+    std::sort(entries_.begin(), entries_.end(), less);
+    entries_.erase(std::unique(entries_.begin(), entries_.end(), equal),
+                   entries_.end());
+  }
+
+  size_t size() const {
+    return entries_.size();
+  }
+
+  absl::string_view array_value(size_t i) const {
+    return {buffer_.data() + entries_[i].array_offset, entries_[i].array_size};
+  }
+
+  absl::string_view directional_value(size_t i) const {
+    return {buffer_.data() + entries_[i].directional_offset,
+            entries_[i].directional_size};
+  }
+
+  /** Compares entry `i` of this list with entry `j` of `other`. */
+  int Compare(size_t i, const EncodedIndexEntries& other, size_t j) const {
+    return Compare(entries_[i], other, other.entries_[j]);
+  }
+
+  bool operator==(const EncodedIndexEntries& other) const {
+    if (size() != other.size()) return false;
+    for (size_t i = 0; i < size(); ++i) {
+      if (Compare(i, other, i) != 0) return false;
+    }
+    return true;
+  }
+
+ private:
+  struct Entry {
+    size_t array_offset;
+    size_t array_size;
+    size_t directional_offset;
+    size_t directional_size;
+  };
+
+  int Compare(const Entry& lhs,
+              const EncodedIndexEntries& other,
+              const Entry& rhs) const {
+    absl::string_view lhs_directional(buffer_.data() + lhs.directional_offset,
+                                      lhs.directional_size);
+    absl::string_view rhs_directional(
+        other.buffer_.data() + rhs.directional_offset, rhs.directional_size);
+    int cmp = lhs_directional.compare(rhs_directional);
+    if (cmp != 0) return cmp;
+    absl::string_view lhs_array(buffer_.data() + lhs.array_offset,
+                                lhs.array_size);
+    absl::string_view rhs_array(other.buffer_.data() + rhs.array_offset,
+                                rhs.array_size);
+    return lhs_array.compare(rhs_array);
+  }
+
+  std::string buffer_;
+  std::vector<Entry> entries_;
+};
+
 void LevelDbIndexManager::UpdateIndexEntries(
     const model::DocumentMap& documents) {
   HARD_ASSERT(started_, "IndexManager not started");
 
+  struct PendingDocument {
+    const model::Document* document;
+    std::vector<FieldIndex> indexes;
+    // The entries of the document for each of `indexes`.
+    std::vector<EncodedIndexEntries> new_entries;
+    // The values each of `indexes` stores for the document.
+    std::vector<std::string> stored_values;
+  };
+
+  // The index lookups read the memoized indexes, so they are made here.
+  std::vector<PendingDocument> pending;
+  pending.reserve(documents.size());
   for (const auto& kv : documents) {
     const auto group = kv.first.GetCollectionGroup();
     HARD_ASSERT(group.has_value(),
                 "Document key is expected to have a collection group");
-    std::vector<FieldIndex> indexes;
-    indexes = GetFieldIndexes(group.value());
+    pending.push_back({&kv.second, GetFieldIndexes(group.value()), {}, {}});
+  }
 
-    for (const auto& index : indexes) {
-      auto existing_entries = GetExistingIndexEntries(kv.first, index);
-      auto new_entries = ComputeIndexEntries(kv.second, index);
-      if (existing_entries != new_entries) {
-        UpdateEntries(kv.second, index, existing_entries, new_entries);
+  // Encoding the entries only reads the document and the index. Each
+  // document is handled by a single worker, and only the writes below go
+  // through the transaction.
+  auto compute_entries = [this](PendingDocument* p) {
+    p->new_entries.resize(p->indexes.size());
+    p->stored_values.resize(p->indexes.size());
+    for (size_t i = 0; i < p->indexes.size(); ++i) {
+      ComputeIndexEntries(*p->document, p->indexes[i], &p->new_entries[i]);
+      p->stored_values[i] = EncodeStoredValues(p->indexes[i], *p->document);
+    }
+  };
+  if (pending.size() >= kMinDocumentsForParallelIndexing) {
+    BackgroundQueue tasks(executor_.get());
+    for (PendingDocument& p : pending) {
+      if (!p.indexes.empty()) {
+        tasks.Execute([&compute_entries, &p] { compute_entries(&p); });
+      }
+    }
+    tasks.AwaitAll();
+  } else {
+    for (PendingDocument& p : pending) {
+      compute_entries(&p);
+    }
+  }
+
+  EncodedIndexEntries existing_entries;
+  for (const PendingDocument& p : pending) {
+    const model::Document& document = *p.document;
+    for (size_t i = 0; i < p.indexes.size(); ++i) {
+      const FieldIndex& index = p.indexes[i];
+      GetExistingIndexEntries(document->key(), index, &existing_entries);
+      const EncodedIndexEntries& new_entries = p.new_entries[i];
+      const std::string& stored_values = p.stored_values[i];
+      // Entries that are kept still need the document's new stored values.
+      if (!(existing_entries == new_entries) || !stored_values.empty()) {
+        UpdateEntries(document, index, existing_entries, new_entries,
+                      stored_values);
       }
     }
   }
 }
 
-std::set<IndexEntry> LevelDbIndexManager::GetExistingIndexEntries(
-    const DocumentKey& key, const FieldIndex& index) {
+void LevelDbIndexManager::GetExistingIndexEntries(
+    const DocumentKey& key,
+    const FieldIndex& index,
+    EncodedIndexEntries* result) {
+  result->Clear();
   auto document_key_index_prefix =
       LevelDbIndexEntryDocumentKeyIndexKey::KeyPrefix(
           index.index_id(), uid_, key.path().CanonicalString());
   LevelDbIndexEntryDocumentKeyIndexKey document_key_index_key;
+  LevelDbIndexEntryKey entry_key;
   auto iter = db_->current_transaction()->NewIterator();
-  std::set<IndexEntry> index_entries;
   for (iter->Seek(document_key_index_prefix); iter->Valid(); iter->Next()) {
     if (!absl::StartsWith(iter->key(), document_key_index_prefix) ||
         !document_key_index_key.Decode(iter->key())) {
       break;
     }
-    LevelDbIndexEntryKey entry_key;
     bool decoded = entry_key.Decode(iter->value());
     HARD_ASSERT(decoded,
                 "LevelDbIndexEntryKey cannot be decoded from document key "
                 "index table.");
-    index_entries.insert({entry_key.index_id(), key, entry_key.array_value(),
-                          entry_key.directional_value()});
+    result->Add(entry_key.array_value(), entry_key.directional_value());
   }
-
-  return index_entries;
+  result->Sort();
 }
 
-std::set<IndexEntry> LevelDbIndexManager::ComputeIndexEntries(
-    const model::Document& document, const FieldIndex& index) {
-  std::set<IndexEntry> results;
-
+void LevelDbIndexManager::ComputeIndexEntries(const model::Document& document,
+                                              const FieldIndex& index,
+                                              EncodedIndexEntries* result) {
+  result->Clear();
   auto directional_value = EncodeDirectionalElements(index, document);
   if (directional_value == absl::nullopt) {
-    return results;
+    return;
   }
 
   auto array_segment = index.GetArraySegment();
@@ -844,18 +1283,15 @@ std::set<IndexEntry> LevelDbIndexManager::ComputeIndexEntries(
             google_firestore_v1_Value_array_value_tag) {
       for (pb_size_t i = 0; i < field_value.value().array_value.values_count;
            ++i) {
-        results.insert(IndexEntry(
-            index.index_id(), document->key(),
+        result->Add(
             EncodeSingleElement(field_value.value().array_value.values[i]),
-            directional_value.value()));
+            directional_value.value());
       }
     }
   } else {
-    results.insert(IndexEntry(index.index_id(), document->key(), "",
-                              directional_value.value()));
+    result->Add("", directional_value.value());
   }
-
-  return results;
+  result->Sort();
 }
 
 absl::optional<std::string> LevelDbIndexManager::EncodeDirectionalElements(
@@ -868,7 +1304,29 @@ absl::optional<std::string> LevelDbIndexManager::EncodeDirectionalElements(
     }
     index::WriteIndexValue(field.value(), index_buffer.ForKind(segment.kind()));
   }
-  return index_buffer.GetEncodedBytes();
+  return index_buffer.Release();
+}
+
+std::string LevelDbIndexManager::EncodeStoredValues(
+    const FieldIndex& index, const model::Document& document) {
+  if (index.stored_fields().empty()) {
+    return "";
+  }
+
+  TransformMap fields;
+  for (const FieldPath& path : index.stored_fields()) {
+    auto field = document->field(path);
+    if (field.has_value()) {
+      fields[path] = model::DeepClone(field.value());
+    }
+  }
+  ObjectValue stored_values;
+  stored_values.SetAll(std::move(fields));
+
+  google_firestore_v1_Value proto = stored_values.Get();
+  nanopb::StringWriter writer;
+  writer.Write(google_firestore_v1_Value_fields, &proto);
+  return writer.Release();
 }
 
 std::string LevelDbIndexManager::EncodeSingleElement(
@@ -876,38 +1334,67 @@ std::string LevelDbIndexManager::EncodeSingleElement(
   IndexEncodingBuffer index_buffer;
   index::WriteIndexValue(value,
                          index_buffer.ForKind(model::Segment::kAscending));
-  return index_buffer.GetEncodedBytes();
+  return index_buffer.Release();
 }
 
 void LevelDbIndexManager::UpdateEntries(
     const model::Document& document,
     const FieldIndex& index,
-    const std::set<IndexEntry>& existing_entries,
-    const std::set<IndexEntry>& new_entries) {
-  util::DiffSets<IndexEntry>(
-      existing_entries, new_entries,
-      [](const IndexEntry& left, const IndexEntry& right) {
-        return left.CompareTo(right);
-      },
-      [this, document, index](const IndexEntry& entry) {
-        this->AddIndexEntry(document, index, entry);
-      },
-      [this, document, index](const IndexEntry& entry) {
-        this->DeleteIndexEntry(document, index, entry);
-      });
+    const EncodedIndexEntries& existing_entries,
+    const EncodedIndexEntries& new_entries,
+    absl::string_view stored_values) {
+  // Walk through both sorted lists at the same time. An entry is added if
+  // the next one in the walk is only in `new_entries`, and removed if it is
+  // only in `existing_entries`.
+  size_t i = 0;
+  size_t j = 0;
+  while (i < existing_entries.size() || j < new_entries.size()) {
+    int cmp;
+    if (i == existing_entries.size()) {
+      cmp = 1;
+    } else if (j == new_entries.size()) {
+      cmp = -1;
+    } else {
+      cmp = existing_entries.Compare(i, new_entries, j);
+    }
+
+    if (cmp > 0) {
+      AddIndexEntry(document, index, new_entries.array_value(j),
+                    new_entries.directional_value(j), stored_values);
+      ++j;
+    } else if (cmp < 0) {
+      DeleteIndexEntry(document, index, existing_entries.array_value(i),
+                       existing_entries.directional_value(i));
+      ++i;
+    } else {
+      if (!stored_values.empty()) {
+        auto entry_key = LevelDbIndexEntryKey::Key(
+            index.index_id(), uid_, existing_entries.array_value(i),
+            existing_entries.directional_value(i),
+            EncodedDirectionalKey(index, document->key()),
+            document->key().path().CanonicalString());
+        db_->current_transaction()->Put(entry_key, stored_values);
+      }
+      ++i;
+      ++j;
+    }
+  }
 }
 
 void LevelDbIndexManager::AddIndexEntry(const model::Document& document,
                                         const FieldIndex& index,
-                                        const IndexEntry& entry) {
+                                        absl::string_view array_value,
+                                        absl::string_view directional_value,
+                                        absl::string_view stored_values) {
   std::string document_key = document->key().path().CanonicalString();
   auto entry_key = LevelDbIndexEntryKey::Key(
-      entry.index_id(), uid_, entry.array_value(), entry.directional_value(),
+      index.index_id(), uid_, array_value, directional_value,
       EncodedDirectionalKey(index, document->key()), document_key);
-  db_->current_transaction()->Put(entry_key, "");
+  db_->current_transaction()->Put(entry_key, stored_values);
+  UpdateIndexStatistics(index.index_id(), entry_key, 1);
 
   auto document_key_index_prefix =
-      LevelDbIndexEntryDocumentKeyIndexKey::KeyPrefix(entry.index_id(), uid_,
+      LevelDbIndexEntryDocumentKeyIndexKey::KeyPrefix(index.index_id(), uid_,
                                                       document_key);
   std::unique_ptr<leveldb::Iterator> iter(
       db_->ptr()->NewIterator(LevelDbTransaction::DefaultReadOptions()));
@@ -920,7 +1407,7 @@ void LevelDbIndexManager::AddIndexEntry(const model::Document& document,
   }
 
   LevelDbIndexEntryDocumentKeyIndexKey document_key_index_key(
-      entry.index_id(), uid_, document_key, 0);
+      index.index_id(), uid_, document_key, 0);
   if (!raw_key.empty()) {
     bool decoded = document_key_index_key.Decode(raw_key);
     HARD_ASSERT(decoded,
@@ -940,20 +1427,23 @@ std::string LevelDbIndexManager::EncodedDirectionalKey(
   IndexEncodingBuffer buffer;
   index::WriteIndexValue(*model::RefValue(serializer_->database_id(), key),
                          buffer.ForKind(kind));
-  return buffer.GetEncodedBytes();
+  return buffer.Release();
 }
 
-void LevelDbIndexManager::DeleteIndexEntry(const model::Document& document,
-                                           const FieldIndex& index,
-                                           const IndexEntry& entry) {
+void LevelDbIndexManager::DeleteIndexEntry(
+    const model::Document& document,
+    const FieldIndex& index,
+    absl::string_view array_value,
+    absl::string_view directional_value) {
   std::string document_key = document->key().path().CanonicalString();
   auto entry_key = LevelDbIndexEntryKey::Key(
-      entry.index_id(), uid_, entry.array_value(), entry.directional_value(),
+      index.index_id(), uid_, array_value, directional_value,
       EncodedDirectionalKey(index, document->key()), document_key);
   db_->current_transaction()->Delete(entry_key);
+  UpdateIndexStatistics(index.index_id(), entry_key, -1);
 
   auto document_key_index_prefix =
-      LevelDbIndexEntryDocumentKeyIndexKey::KeyPrefix(entry.index_id(), uid_,
+      LevelDbIndexEntryDocumentKeyIndexKey::KeyPrefix(index.index_id(), uid_,
                                                       document_key);
   LevelDbIndexEntryDocumentKeyIndexKey document_key_index_key;
   auto iter = db_->current_transaction()->NewIterator();
@@ -17,10 +17,14 @@
 #ifndef FIRESTORE_CORE_SRC_LOCAL_LEVELDB_INDEX_MANAGER_H_
 #define FIRESTORE_CORE_SRC_LOCAL_LEVELDB_INDEX_MANAGER_H_
 
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 #include <queue>
-#include <set>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "Firestore/core/src/core/target.h"
@@ -28,6 +32,7 @@
 #include "Firestore/core/src/local/leveldb_key.h"
 #include "Firestore/core/src/local/memory_index_manager.h"
 #include "Firestore/core/src/model/field_index.h"
+#include "absl/strings/string_view.h"
 
 namespace firebase {
 namespace firestore {
@@ -40,6 +45,10 @@ namespace index {
 class IndexEntry;
 }  // namespace index
 
+namespace util {
+class Executor;
+}  // namespace util
+
 namespace local {
 
 class LevelDbPersistence;
@@ -52,6 +61,8 @@ class LevelDbIndexManager : public IndexManager {
                                LevelDbPersistence* db,
                                LocalSerializer* serializer);
 
+  ~LevelDbIndexManager() override;
+
   void Start() override;
 
   void AddToCollectionParentIndex(
@@ -69,6 +80,8 @@ class LevelDbIndexManager : public IndexManager {
 
   std::vector<model::FieldIndex> GetFieldIndexes() const override;
 
+  bool HasFieldIndexes(const std::string& collection_group) const override;
+
   void DeleteAllFieldIndexes() override;
 
   void CreateTargetIndexes(const core::Target& target) override;
@@ -83,6 +96,15 @@ class LevelDbIndexManager : public IndexManager {
   absl::optional<std::vector<model::DocumentKey>> GetDocumentsMatchingTarget(
       const core::Target& target) override;
 
+  absl::optional<
+      std::vector<std::pair<model::DocumentKey, model::ObjectValue>>>
+  GetStoredValuesMatchingTarget(
+      const core::Target& target,
+      const std::vector<model::FieldPath>& fields) override;
+
+  absl::optional<size_t> EstimateIndexEntriesRead(
+      const core::Target& target) override;
+
   absl::optional<std::string> GetNextCollectionGroupToUpdate() const override;
 
   void UpdateCollectionGroup(const std::string& collection_group,
@@ -102,6 +124,41 @@ class LevelDbIndexManager : public IndexManager {
     std::string upper;
   };
 
+  /**
+   * Statistics about the entries of one index for the current user, used to
+   * estimate how many entries a target reads.
+   *
+   * The histogram is over the encoded entry keys, which order by the array
+   * value and then by the leading directional segment. Bucket `i` holds the
+   * entries from `bucket_bounds[i]` up to the next bound.
+   */
+  struct IndexStatistics {
+    /** The number of entries, kept up to date as entries are written. */
+    size_t entry_count = 0;
+    /** The number of entries when the statistics were built. */
+    size_t built_entry_count = 0;
+    /** The number of distinct directional values when they were built. */
+    size_t distinct_values = 0;
+    std::vector<std::string> bucket_bounds;
+    std::vector<size_t> bucket_counts;
+  };
+
+  /**
+   * Returns the statistics of the given index, building them with a scan of
+   * its entries if they are missing or the number of entries has changed by
+   * more than a factor of two since they were built.
+   */
+  const IndexStatistics& GetIndexStatistics(const model::FieldIndex& index);
+
+  /** Accounts for an added (`delta` = 1) or removed (-1) index entry. */
+  void UpdateIndexStatistics(int32_t index_id,
+                             absl::string_view entry_key,
+                             int delta);
+
+  /** Returns the key ranges that serve `sub_target` from `index`. */
+  std::vector<IndexRange> GetIndexRanges(const core::Target& sub_target,
+                                         const model::FieldIndex& index);
+
   /**
    * Stores the index in the memoized indexes table and updates
    * `next_index_to_update_` `memoized_max_index_id_` and
@@ -111,12 +168,30 @@ class LevelDbIndexManager : public IndexManager {
 
   void DeleteFromUpdateQueue(model::FieldIndex* index);
 
-  std::set<index::IndexEntry> GetExistingIndexEntries(
-      const model::DocumentKey& key, const model::FieldIndex& index);
+  /**
+   * Updates `indexed_collection_groups_` after the memoized indexes of
+   * `collection_group` changed.
+   */
+  void UpdateIndexedCollectionGroup(const std::string& collection_group);
 
-  /** Creates the index entries for the given document. */
-  std::set<index::IndexEntry> ComputeIndexEntries(
-      const model::Document& document, const model::FieldIndex& index);
+  /** The encoded values of the entries of one document in one index. */
+  class EncodedIndexEntries;
+
+  /**
+   * Replaces the contents of `result` with the sorted entries stored for the
+   * given document in the given index.
+   */
+  void GetExistingIndexEntries(const model::DocumentKey& key,
+                               const model::FieldIndex& index,
+                               EncodedIndexEntries* result);
+
+  /**
+   * Replaces the contents of `result` with the sorted index entries for the
+   * given document.
+   */
+  void ComputeIndexEntries(const model::Document& document,
+                           const model::FieldIndex& index,
+                           EncodedIndexEntries* result);
 
   /**
    * Updates the index entries for the provided document by deleting entries
@@ -125,16 +200,20 @@ class LevelDbIndexManager : public IndexManager {
    */
   void UpdateEntries(const model::Document& document,
                      const model::FieldIndex& index,
-                     const std::set<index::IndexEntry>& existing_entries,
-                     const std::set<index::IndexEntry>& new_entries);
+                     const EncodedIndexEntries& existing_entries,
+                     const EncodedIndexEntries& new_entries,
+                     absl::string_view stored_values);
 
   void AddIndexEntry(const model::Document& document,
                      const model::FieldIndex& index,
-                     const index::IndexEntry& entry);
+                     absl::string_view array_value,
+                     absl::string_view directional_value,
+                     absl::string_view stored_values);
 
   void DeleteIndexEntry(const model::Document& document,
                         const model::FieldIndex& index,
-                        const index::IndexEntry& entry);
+                        absl::string_view array_value,
+                        absl::string_view directional_value);
 
   /**
    * Returns the byte encoded form of the directional values in the field index.
@@ -144,6 +223,14 @@ class LevelDbIndexManager : public IndexManager {
   absl::optional<std::string> EncodeDirectionalElements(
       const model::FieldIndex& index, const model::Document& document);
 
+  /**
+   * Returns the encoded values of the index's stored fields in the document,
+   * which are kept as the value of each of its index entries. Returns an
+   * empty string if the index does not store any fields.
+   */
+  std::string EncodeStoredValues(const model::FieldIndex& index,
+                                 const model::Document& document);
+
   /** Encodes a single value to the ascending index format. */
   std::string EncodeSingleElement(const _google_firestore_v1_Value& value);
 
@@ -202,6 +289,17 @@ class LevelDbIndexManager : public IndexManager {
       const index::IndexEntry& upper_bound,
       std::vector<index::IndexEntry> not_in_bounds) const;
 
+  /**
+   * Calls `visitor` with the key and value of every index entry that matches
+   * the given target, at most once per document. Returns false if the target
+   * cannot be served from an index.
+   */
+  bool VisitEntriesMatchingTarget(
+      const core::Target& target,
+      const std::vector<model::FieldPath>& fields,
+      const std::function<void(const LevelDbIndexEntryKey&,
+                               absl::string_view)>& visitor);
+
   /**
    * Returns an index that can be used to serve the provided target. Returns
    * `nullopt` if no index is configured.
@@ -240,6 +338,16 @@ class LevelDbIndexManager : public IndexManager {
                      std::unordered_map<int32_t, model::FieldIndex>>
       memoized_indexes_;
 
+  /**
+   * The collection groups that have entries in `memoized_indexes_`, for
+   * `HasFieldIndexes`, which may be called on any thread.
+   */
+  mutable std::mutex indexed_collection_groups_mutex_;
+  std::unordered_set<std::string> indexed_collection_groups_;
+
+  /** Maps from an index_id to the statistics of its entries. */
+  std::unordered_map<int32_t, IndexStatistics> index_statistics_;
+
   QueueForNextIndexToUpdate next_index_to_update_;
   int32_t memoized_max_index_id_ = -1;
   int64_t memoized_max_sequence_number_ = -1;
@@ -250,6 +358,9 @@ class LevelDbIndexManager : public IndexManager {
   bool started_ = false;
 
   std::string uid_;
+
+  // Computes the index entries of large batches of documents in parallel.
+  std::unique_ptr<util::Executor> executor_;
 };
 
 }  // namespace local
@@ -46,6 +46,7 @@ const char* kMutationQueuesTable = "mutation_queue";
 const char* kTargetGlobalTable = "target_global";
 const char* kTargetsTable = "target";
 const char* kQueryTargetsTable = "query_target";
+const char* kTargetResultsTable = "target_result";
 const char* kTargetDocumentsTable = "target_document";
 const char* kDocumentTargetsTable = "document_target";
 const char* kRemoteDocumentsTable = "remote_document";
@@ -550,7 +551,7 @@ DocumentKey Reader::ReadDocumentKey() {
 
   // Avoid assertion failures in DocumentKey if path is invalid.
   if (ok_ && !path.empty() && DocumentKey::IsDocumentKey(path)) {
-    return DocumentKey{std::move(path)};
+    return DocumentKey::Intern(std::move(path));
   }
 
   Fail();
@@ -1006,6 +1007,28 @@ bool LevelDbTargetKey::Decode(leveldb::Slice key) {
   return reader.ok();
 }
 
+std::string LevelDbTargetResultKey::KeyPrefix() {
+  Writer writer;
+  writer.WriteTableName(kTargetResultsTable);
+  return writer.result();
+}
+
+std::string LevelDbTargetResultKey::Key(model::TargetId target_id) {
+  Writer writer;
+  writer.WriteTableName(kTargetResultsTable);
+  writer.WriteTargetId(target_id);
+  writer.WriteTerminator();
+  return writer.result();
+}
+
+bool LevelDbTargetResultKey::Decode(leveldb::Slice key) {
+  Reader reader{key};
+  reader.ReadTableNameMatching(kTargetResultsTable);
+  target_id_ = reader.ReadTargetId();
+  reader.ReadTerminator();
+  return reader.ok();
+}
+
 std::string LevelDbQueryTargetKey::KeyPrefix() {
   Writer writer;
   writer.WriteTableName(kQueryTargetsTable);
@@ -1646,6 +1669,11 @@ std::string LevelDbDataMigrationKey::Key(absl::string_view migration_name) {
   return writer.result();
 }
 
+std::string LevelDbDataMigrationKey::OverlayMigrationKey(
+    absl::string_view uid) {
+  return Key(absl::StrCat("overlay_migration:", uid));
+}
+
 bool LevelDbDataMigrationKey::Decode(absl::string_view key) {
   Reader reader{key};
   reader.ReadTableNameMatching(kDataMigrationTable);
@@ -369,6 +369,39 @@ class LevelDbTargetKey {
   model::TargetId target_id_ = 0;
 };
 
+/**
+ * A key in the target results table, which holds the keys of the documents in
+ * the last result of a target's listener, in order.
+ */
+class LevelDbTargetResultKey {
+ public:
+  /**
+   * Creates a key prefix that points just before the first key in the table.
+   */
+  static std::string KeyPrefix();
+
+  /** Creates a complete key that points to the last result of a target. */
+  static std::string Key(model::TargetId target_id);
+
+  /**
+   * Decodes the contents of a target result key, storing the decoded values
+   * in this instance.
+   *
+   * @return true if the key successfully decoded, false otherwise. If false is
+   * returned, this instance is in an undefined state until the next call to
+   * `Decode()`.
+   */
+  ABSL_MUST_USE_RESULT
+  bool Decode(leveldb::Slice key);
+
+  model::TargetId target_id() {
+    return target_id_;
+  }
+
+ private:
+  model::TargetId target_id_ = 0;
+};
+
 /**
  * A key in the query targets table, an index of canonical_ids to the targets
  * they may match. This is not a unique mapping because canonical_id does not
@@ -1350,6 +1383,20 @@ class LevelDbDataMigrationKey {
     return Key("overlay_migration");
   }
 
+  /**
+   * Migration to create overlays from the local mutations of the given user,
+   * left pending until the user is next signed in.
+   */
+  static std::string OverlayMigrationKey(absl::string_view uid);
+
+  /**
+   * Migration to add missing sentinel rows to the document target index. Its
+   * value is the key of the next remote document to check.
+   */
+  static std::string SentinelRowsMigrationKey() {
+    return Key("sentinel_rows");
+  }
+
   /**
    * Decodes the given complete key, storing the decoded values in this
    * instance.
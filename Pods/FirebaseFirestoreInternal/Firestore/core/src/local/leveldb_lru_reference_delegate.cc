@@ -145,6 +145,39 @@ int LevelDbLruReferenceDelegate::RemoveOrphanedDocuments(
   return count;
 }
 
+absl::optional<int64_t> LevelDbLruReferenceDelegate::RemoveOrphanedDocument(
+    const DocumentKey& key, ListenSequenceNumber upper_bound) {
+  // The sentinel row of a document sorts before the rows of its targets.
+  std::string prefix = LevelDbDocumentTargetKey::KeyPrefix(key.path());
+  LevelDbDocumentTargetKey row;
+  ListenSequenceNumber sequence_number = kListenSequenceNumberInvalid;
+  auto it = db_->current_transaction()->NewIterator();
+  for (it->Seek(prefix); it->Valid() && absl::StartsWith(it->key(), prefix);
+       it->Next()) {
+    if (!row.Decode(it->key()) || row.document_key() != key) {
+      break;
+    }
+    if (!row.IsSentinel()) {
+      return absl::nullopt;
+    }
+    sequence_number = LevelDbDocumentTargetKey::DecodeSentinelValue(it->value());
+  }
+  if (sequence_number == kListenSequenceNumberInvalid ||
+      sequence_number > upper_bound || IsPinned(key)) {
+    return absl::nullopt;
+  }
+
+  std::string document_key = LevelDbRemoteDocumentKey::Key(key);
+  std::string contents;
+  int64_t size = 0;
+  if (db_->current_transaction()->Get(document_key, &contents).ok()) {
+    size = static_cast<int64_t>(document_key.size() + contents.size());
+  }
+  db_->remote_document_cache()->Remove(key);
+  RemoveSentinel(key);
+  return size;
+}
+
 int LevelDbLruReferenceDelegate::RemoveTargets(
     ListenSequenceNumber sequence_number, const LiveQueryMap& live_queries) {
   return static_cast<int>(
@@ -16,6 +16,7 @@
 
 #include "Firestore/core/src/local/leveldb_migrations.h"
 
+#include <cstddef>
 #include <string>
 #include <utility>
 
@@ -193,31 +194,61 @@ void EnsureSentinelRow(LevelDbTransaction* transaction,
 /**
  * Migration 4.
  *
- * Ensure each document in the remote document table has a corresponding
- * sentinel row in the document target index.
+ * Marks the sentinel rows migration as required. The rows are added in slices
+ * by `RunDeferredMigrations` once the client has started, since the remote
+ * document cache can be large and nothing but garbage collection depends on
+ * them.
  */
-void EnsureSentinelRows(leveldb::DB* db) {
-  LevelDbTransaction transaction(db, "Ensure sentinel rows");
+void EnsureSentinelRowsMigrationIsRequired(leveldb::DB* db) {
+  LevelDbTransaction transaction(
+      db, "Ensure sentinel rows migration is marked as required");
+
+  transaction.Put(LevelDbDataMigrationKey::SentinelRowsMigrationKey(), "");
+  SaveVersion(4, &transaction);
+  transaction.Commit();
+}
+
+/**
+ * Ensures that up to `max_documents` documents in the remote document table,
+ * starting from the one recorded in the sentinel rows migration, have a
+ * corresponding sentinel row in the document target index.
+ *
+ * @return true if documents remain to be checked.
+ */
+bool EnsureSentinelRows(LevelDbTransaction* transaction,
+                        size_t max_documents) {
+  std::string migration_key =
+      LevelDbDataMigrationKey::SentinelRowsMigrationKey();
+  std::string start_key;
+  if (!transaction->Get(migration_key, &start_key).ok()) {
+    return false;
+  }
 
   // Get the value we'll use for anything that's missing a row.
   model::ListenSequenceNumber sequence_number =
-      GetHighestSequenceNumber(&transaction);
+      GetHighestSequenceNumber(transaction);
   std::string sentinel_value =
       LevelDbDocumentTargetKey::EncodeSentinelValue(sequence_number);
 
   std::string documents_prefix = LevelDbRemoteDocumentKey::KeyPrefix();
-  auto it = transaction.NewIterator();
-  it->Seek(documents_prefix);
+  auto it = transaction->NewIterator();
+  it->Seek(start_key.empty() ? documents_prefix : start_key);
   LevelDbRemoteDocumentKey document_key;
-  for (; it->Valid() && absl::StartsWith(it->key(), documents_prefix);
-       it->Next()) {
+  for (size_t count = 0;
+       it->Valid() && absl::StartsWith(it->key(), documents_prefix);
+       it->Next(), count++) {
+    if (count == max_documents) {
+      transaction->Put(migration_key, it->key());
+      return true;
+    }
     HARD_ASSERT(document_key.Decode(it->key()),
                 "Failed to decode document key");
-    EnsureSentinelRow(&transaction, document_key.document_key(),
+    EnsureSentinelRow(transaction, document_key.document_key(),
                       sentinel_value);
   }
-  SaveVersion(4, &transaction);
-  transaction.Commit();
+
+  transaction->Delete(migration_key);
+  return false;
 }
 
 // Helper to add an index entry iff we haven't already written it (as determined
@@ -365,7 +396,7 @@ void EnsureOverlayDataMigrationIsRequired(leveldb::DB* db) {
       db, "Ensure overlay data migration is marked as required");
 
   std::string key = LevelDbDataMigrationKey::OverlayMigrationKey();
-  transaction.Put(key, {});
+  transaction.Put(key, "");
   SaveVersion(8, &transaction);
   transaction.Commit();
 }
@@ -415,7 +446,7 @@ void LevelDbMigrations::RunMigrations(leveldb::DB* db,
   }
 
   if (from_version < 4 && to_version >= 4) {
-    EnsureSentinelRows(db);
+    EnsureSentinelRowsMigrationIsRequired(db);
   }
 
   if (from_version < 5 && to_version >= 5) {
@@ -435,6 +466,11 @@ void LevelDbMigrations::RunMigrations(leveldb::DB* db,
   }
 }
 
+bool LevelDbMigrations::RunDeferredMigrations(LevelDbTransaction* transaction,
+                                              size_t max_documents) {
+  return EnsureSentinelRows(transaction, max_documents);
+}
+
 }  // namespace local
 }  // namespace firestore
 }  // namespace firebase
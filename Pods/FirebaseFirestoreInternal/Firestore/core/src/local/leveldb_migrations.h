@@ -17,6 +17,7 @@
 #ifndef FIRESTORE_CORE_SRC_LOCAL_LEVELDB_MIGRATIONS_H_
 #define FIRESTORE_CORE_SRC_LOCAL_LEVELDB_MIGRATIONS_H_
 
+#include <cstddef>
 #include <cstdint>
 
 #include "Firestore/core/src/local/leveldb_transaction.h"
@@ -49,6 +50,16 @@ class LevelDbMigrations {
   static void RunMigrations(leveldb::DB* db,
                             SchemaVersion version,
                             const LocalSerializer& serializer);
+
+  /**
+   * Runs a slice of the migrations that `RunMigrations` leaves to be done
+   * after startup, processing up to `max_documents` documents in the given
+   * transaction.
+   *
+   * @return true if work remains and this should be called again.
+   */
+  static bool RunDeferredMigrations(LevelDbTransaction* transaction,
+                                    size_t max_documents);
 };
 
 /**
@@ -68,7 +79,8 @@ class LevelDbMigrations {
  *     related to limbo resolution. Addresses
  *     https://github.com/firebase/firebase-ios-sdk/issues/1548.
  *   * Migration 4 ensures that every document in the remote document cache
- *     has a sentinel row with a sequence number.
+ *     has a sentinel row with a sequence number. The rows are added after
+ *     startup, see `RunDeferredMigrations`.
  *   * Migration 5 drops held write acks.
  *   * Migration 6 populates the collection_parents index.
  *   * Migration 7 rewrites query_targets canonical ids in new format.
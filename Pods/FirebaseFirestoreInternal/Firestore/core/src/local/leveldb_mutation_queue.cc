@@ -167,7 +167,10 @@ MutationBatch LevelDbMutationQueue::AddMutationBatch(
   MutationBatch batch(batch_id, local_write_time, std::move(base_mutations),
                       std::move(mutations));
   std::string key = mutation_batch_key(batch_id);
-  db_->current_transaction()->Put(key, serializer_->EncodeMutationBatch(batch));
+  std::string encoded =
+      nanopb::MakeStdString(serializer_->EncodeMutationBatch(batch));
+  db_->AdjustByteSize(static_cast<int64_t>(encoded.size()));
+  db_->current_transaction()->Put(key, encoded);
 
   // Store an empty value in the index which is equivalent to serializing a
   // GPBEmpty message. In the future if we wanted to store some other kind of
@@ -201,6 +204,7 @@ void LevelDbMutationQueue::RemoveMutationBatch(const MutationBatch& batch) {
               "Mutation batch %s not found; found %s", DescribeKey(key),
               DescribeKey(check_iterator->key()));
 
+  db_->AdjustByteSize(-static_cast<int64_t>(check_iterator->value().size()));
   db_->current_transaction()->Delete(key);
 
   for (const Mutation& mutation : batch.mutations()) {
@@ -425,7 +429,7 @@ ByteString LevelDbMutationQueue::GetLastStreamToken() {
 }
 
 void LevelDbMutationQueue::SetLastStreamToken(ByteString stream_token) {
-  std::free(metadata_->last_stream_token);
+  pb_free(metadata_->last_stream_token);
 
   metadata_->last_stream_token = stream_token.release();
   db_->current_transaction()->Put(mutation_queue_key(), metadata_);
@@ -57,45 +57,60 @@ void RemovePendingOverlayMigrations(LevelDbPersistence* db) {
 }  // namespace
 
 bool LevelDbOverlayMigrationManager::HasPendingOverlayMigration() {
-  auto key = LevelDbDataMigrationKey::OverlayMigrationKey();
+  auto key = LevelDbDataMigrationKey::OverlayMigrationKey(uid_);
   std::string to_discard;
   return db_->current_transaction()->Get(key, &to_discard).ok();
 }
 
+void LevelDbOverlayMigrationManager::SplitPendingOverlayMigration() {
+  auto key = LevelDbDataMigrationKey::OverlayMigrationKey();
+  std::string to_discard;
+  if (!db_->current_transaction()->Get(key, &to_discard).ok()) {
+    return;
+  }
+
+  for (const auto& uid : GetAllUserIds(db_)) {
+    db_->current_transaction()->Put(
+        LevelDbDataMigrationKey::OverlayMigrationKey(uid), "");
+  }
+  RemovePendingOverlayMigrations(db_);
+}
+
 void LevelDbOverlayMigrationManager::Run() {
   db_->Run("migrate overlays", [this] {
+    SplitPendingOverlayMigration();
     if (!HasPendingOverlayMigration()) {
       return;
     }
 
-    std::unordered_set<std::string> user_ids = GetAllUserIds(db_);
-    auto* remote_document_cache = db_->remote_document_cache();
-    for (const auto& uid : user_ids) {
-      User user = User::Unauthenticated();
-      if (!uid.empty()) {
-        user = User(uid);
-      }
-      auto* index_manager = db_->GetIndexManager(user);
-      auto* mutation_queue = db_->GetMutationQueue(user, index_manager);
-
-      // Get all document keys that have local mutations
-      model::DocumentKeySet all_document_keys;
-      for (const auto& batch : mutation_queue->AllMutationBatches()) {
-        all_document_keys = all_document_keys.union_with(batch.keys());
-      }
-
-      // Recalculate and save overlays
-      auto* document_overlay_cache = db_->GetDocumentOverlayCache(user);
-      LocalDocumentsView local_view(remote_document_cache, mutation_queue,
-                                    document_overlay_cache, index_manager);
-      local_view.RecalculateAndSaveOverlays(std::move(all_document_keys));
-    }
-
-    db_->ReleaseOtherUserSpecificComponents(uid_);
-    RemovePendingOverlayMigrations(db_);
+    MigrateUser(uid_);
+    db_->current_transaction()->Delete(
+        LevelDbDataMigrationKey::OverlayMigrationKey(uid_));
   });
 }
 
+void LevelDbOverlayMigrationManager::MigrateUser(const std::string& uid) {
+  User user = User::Unauthenticated();
+  if (!uid.empty()) {
+    user = User(uid);
+  }
+  auto* remote_document_cache = db_->remote_document_cache();
+  auto* index_manager = db_->GetIndexManager(user);
+  auto* mutation_queue = db_->GetMutationQueue(user, index_manager);
+
+  // Get all document keys that have local mutations
+  model::DocumentKeySet all_document_keys;
+  for (const auto& batch : mutation_queue->AllMutationBatches()) {
+    all_document_keys = all_document_keys.union_with(batch.keys());
+  }
+
+  // Recalculate and save overlays
+  auto* document_overlay_cache = db_->GetDocumentOverlayCache(user);
+  LocalDocumentsView local_view(remote_document_cache, mutation_queue,
+                                document_overlay_cache, index_manager);
+  local_view.RecalculateAndSaveOverlays(std::move(all_document_keys));
+}
+
 }  // namespace local
 }  // namespace firestore
 }  // namespace firebase
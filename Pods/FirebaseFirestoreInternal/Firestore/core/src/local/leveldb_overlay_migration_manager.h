@@ -48,6 +48,16 @@ class LevelDbOverlayMigrationManager : public OverlayMigrationManager {
 
   bool HasPendingOverlayMigration();
 
+  /**
+   * Splits the pending migration of all users into one per user, so that the
+   * overlays of users other than the current one are only created once they
+   * sign in.
+   */
+  void SplitPendingOverlayMigration();
+
+  /** Creates the overlays of the user with the given ID. */
+  void MigrateUser(const std::string& uid);
+
   // The LevelDbOverlayMigrationManager is owned by LevelDbPersistence.
   LevelDbPersistence* db_;
 
@@ -16,7 +16,7 @@
 
 #include "Firestore/core/src/local/leveldb_persistence.h"
 
-#include <limits>
+#include <algorithm>
 #include <utility>
 
 #include "Firestore/core/src/core/database_info.h"
@@ -36,6 +36,9 @@
 #include "Firestore/core/src/util/string_util.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/match.h"
+#include "leveldb/cache.h"
+#include "leveldb/filter_policy.h"
+#include "leveldb/sst_file_writer.h"
 
 namespace firebase {
 namespace firestore {
@@ -46,11 +49,18 @@ using credentials::User;
 using leveldb::DB;
 using model::ListenSequenceNumber;
 using util::Filesystem;
+using util::MemoryPressure;
 using util::Path;
 using util::Status;
 using util::StatusOr;
 using util::StringFormat;
 
+/**
+ * The number of documents a slice of the deferred migrations processes, so
+ * that they don't hold up the worker queue for long.
+ */
+const size_t kDeferredMigrationSliceSize = 1000;
+
 /**
  * Finds all user ids in the database based on the existence of a mutation
  * queue.
@@ -74,13 +84,28 @@ std::set<std::string> CollectUserSet(LevelDbTransaction* transaction) {
   return result;
 }
 
+/** A read-only transaction, and the persistence that it reads. */
+struct ReadOnlyTransaction {
+  const LevelDbPersistence* persistence;
+  LevelDbTransaction* transaction;
+};
+
+/**
+ * The read-only transaction running on this thread, if any. While it runs,
+ * the caches of its persistence read through it instead of the transaction
+ * of the worker queue.
+ */
+thread_local ReadOnlyTransaction current_read_only_transaction = {nullptr,
+                                                                  nullptr};
+
 }  // namespace
 
 StatusOr<std::unique_ptr<LevelDbPersistence>> LevelDbPersistence::Create(
     util::Path dir,
     LevelDbMigrations::SchemaVersion version,
     LocalSerializer serializer,
-    const LruParams& lru_params) {
+    const LruParams& lru_params,
+    const LevelDbProfile& profile) {
   auto* fs = Filesystem::Default();
   Status status = EnsureDirectory(dir);
   if (!status.ok()) return status;
@@ -88,10 +113,15 @@ StatusOr<std::unique_ptr<LevelDbPersistence>> LevelDbPersistence::Create(
   status = fs->ExcludeFromBackups(dir);
   if (!status.ok()) return status;
 
-  StatusOr<std::unique_ptr<DB>> created = OpenDb(dir);
+  DbResources resources;
+  StatusOr<std::unique_ptr<DB>> created = OpenDb(dir, profile, &resources);
   if (!created.ok()) return created.status();
 
   std::unique_ptr<DB> db = std::move(created).ValueOrDie();
+  if (!profile.snapshot_path.empty()) {
+    status = SeedFromSnapshot(db.get(), profile.snapshot_path);
+    if (!status.ok()) return status;
+  }
   LevelDbMigrations::RunMigrations(db.get(), version, serializer);
 
   LevelDbTransaction transaction(db.get(), "Start LevelDB");
@@ -100,29 +130,37 @@ StatusOr<std::unique_ptr<LevelDbPersistence>> LevelDbPersistence::Create(
 
   // Explicit conversion is required to allow the StatusOr to be created.
   std::unique_ptr<LevelDbPersistence> result(
-      new LevelDbPersistence(std::move(db), std::move(dir), std::move(users),
-                             std::move(serializer), lru_params));
+      new LevelDbPersistence(std::move(resources), std::move(db),
+                             std::move(dir), std::move(users),
+                             std::move(serializer), lru_params, profile));
   return {std::move(result)};
 }
 
 StatusOr<std::unique_ptr<LevelDbPersistence>> LevelDbPersistence::Create(
-    util::Path dir, LocalSerializer serializer, const LruParams& lru_params) {
+    util::Path dir,
+    LocalSerializer serializer,
+    const LruParams& lru_params,
+    const LevelDbProfile& profile) {
   return Create(std::move(dir), kSchemaVersion, std::move(serializer),
-                lru_params);
+                lru_params, profile);
 }
 
-LevelDbPersistence::LevelDbPersistence(std::unique_ptr<leveldb::DB> db,
+LevelDbPersistence::LevelDbPersistence(DbResources resources,
+                                       std::unique_ptr<leveldb::DB> db,
                                        util::Path directory,
                                        std::set<std::string> users,
                                        LocalSerializer serializer,
-                                       const LruParams& lru_params)
-    : db_(std::move(db)),
+                                       const LruParams& lru_params,
+                                       const LevelDbProfile& profile)
+    : resources_(std::move(resources)),
+      db_(std::move(db)),
       directory_(std::move(directory)),
       users_(std::move(users)),
-      serializer_(std::move(serializer)) {
+      serializer_(std::move(serializer)),
+      range_deletions_(profile.range_deletions) {
   target_cache_ = absl::make_unique<LevelDbTargetCache>(this, &serializer_);
-  document_cache_ =
-      absl::make_unique<LevelDbRemoteDocumentCache>(this, &serializer_);
+  document_cache_ = absl::make_unique<LevelDbRemoteDocumentCache>(
+      this, &serializer_, profile.decoded_document_cache_size);
   reference_delegate_ =
       absl::make_unique<LevelDbLruReferenceDelegate>(this, lru_params);
   bundle_cache_ = absl::make_unique<LevelDbBundleCache>(this, &serializer_);
@@ -132,6 +170,8 @@ LevelDbPersistence::LevelDbPersistence(std::unique_ptr<leveldb::DB> db,
   target_cache_->Start();
   reference_delegate_->Start();
   started_ = true;
+
+  Run("Load byte size", [&] { LoadByteSize(); });
 }
 
 // Handle unique_ptrs to forward declarations
@@ -151,9 +191,33 @@ Status LevelDbPersistence::EnsureDirectory(const Path& dir) {
   return Status::OK();
 }
 
-StatusOr<std::unique_ptr<DB>> LevelDbPersistence::OpenDb(const Path& dir) {
-  leveldb::Options options;
+StatusOr<std::unique_ptr<DB>> LevelDbPersistence::OpenDb(
+    const Path& dir, const LevelDbProfile& profile, DbResources* resources) {
+  leveldb::Options options = profile.ToOptions();
   options.create_if_missing = true;
+  resources->table_format_version = options.format_version;
+  // Commits are not synced, so syncing the MANIFEST only has to keep it
+  // ordered after the tables it lists, not flush the drive cache each time.
+  options.sync_mode = leveldb::kSyncBarrier;
+  // Apps are usually killed rather than shut down, leaving a log to replay
+  // on the next start. Its table is written after the open returns, and a
+  // clean shutdown leaves no log to replay at all.
+  options.defer_recovery_flush = true;
+  options.flush_on_close = true;
+  if (profile.block_cache_size > 0) {
+    // Midpoint insertion keeps the blocks of documents that are read again
+    // and again cached through the scans of queries without an index.
+    resources->block_cache.reset(
+        leveldb::NewScanResistantLRUCache(profile.block_cache_size));
+    options.block_cache = resources->block_cache.get();
+  }
+  // A whole-table filter lets lookups for documents that are not cached
+  // skip most tables without reading their index.
+  if (profile.bloom_filter_bits_per_key > 0) {
+    resources->filter_policy.reset(leveldb::NewBlockedBloomFilterPolicy(
+        profile.bloom_filter_bits_per_key));
+    options.filter_policy = resources->filter_policy.get();
+  }
 
   DB* database = nullptr;
   leveldb::Status status = DB::Open(options, dir.ToUtf8String(), &database);
@@ -167,9 +231,71 @@ StatusOr<std::unique_ptr<DB>> LevelDbPersistence::OpenDb(const Path& dir) {
   return std::unique_ptr<DB>(database);
 }
 
+Status LevelDbPersistence::SeedFromSnapshot(DB* db,
+                                            const std::string& snapshot_path) {
+  {
+    std::unique_ptr<leveldb::Iterator> it(
+        db->NewIterator(leveldb::ReadOptions()));
+    it->SeekToFirst();
+    if (it->Valid()) {
+      // Already seeded, or in use since.
+      return Status::OK();
+    }
+  }
+
+  LOG_DEBUG("Seeding LevelDB from snapshot %s", snapshot_path);
+  leveldb::Status status = db->IngestExternalFile(
+      leveldb::IngestExternalFileOptions(), {snapshot_path});
+  if (!status.ok()) {
+    return Status{Error::kErrorInternal,
+                  StringFormat("Failed to seed LevelDB from snapshot %s",
+                               snapshot_path)}
+        .CausedBy(ConvertStatus(status));
+  }
+  return Status::OK();
+}
+
+Status LevelDbPersistence::ExportSnapshot(const Path& file) {
+  // The table is ingested as it is, so it must match the filter policy and
+  // format that the database is opened with. Blocks are left uncompressed so
+  // that reads can point straight into the memory-mapped file.
+  leveldb::Options options;
+  options.format_version = resources_.table_format_version;
+  options.compression = leveldb::kNoCompression;
+  options.filter_policy = resources_.filter_policy.get();
+
+  const leveldb::Snapshot* snapshot = db_->GetSnapshot();
+  leveldb::ReadOptions read_options;
+  read_options.snapshot = snapshot;
+  read_options.fill_cache = false;
+  std::unique_ptr<leveldb::Iterator> it(db_->NewIterator(read_options));
+
+  leveldb::SstFileWriter writer(options);
+  leveldb::Status status = writer.Open(file.ToUtf8String());
+  for (it->SeekToFirst(); status.ok() && it->Valid(); it->Next()) {
+    status = writer.Put(it->key(), it->value());
+  }
+  if (status.ok()) status = it->status();
+  if (status.ok()) status = writer.Finish();
+
+  it.reset();
+  db_->ReleaseSnapshot(snapshot);
+
+  if (!status.ok()) {
+    return Status{Error::kErrorInternal,
+                  StringFormat("Failed to export LevelDB snapshot to %s",
+                               file.ToUtf8String())}
+        .CausedBy(ConvertStatus(status));
+  }
+  return Status::OK();
+}
+
 // MARK: - LevelDB utilities
 
 LevelDbTransaction* LevelDbPersistence::current_transaction() {
+  if (current_read_only_transaction.persistence == this) {
+    return current_read_only_transaction.transaction;
+  }
   HARD_ASSERT(transaction_ != nullptr,
               "Attempting to access transaction before one has started");
   return transaction_.get();
@@ -189,36 +315,34 @@ util::Status LevelDbPersistence::ClearPersistence(
 }
 
 StatusOr<int64_t> LevelDbPersistence::CalculateByteSize() {
-  auto* fs = Filesystem::Default();
+  return byte_size_;
+}
 
-  // Accumulate the total size in an unsigned integer to avoid undefined
-  // behavior on overflow.
-  uint64_t count = 0;
-  auto iter = util::DirectoryIterator::Create(directory_);
-  for (; iter->Valid(); iter->Next()) {
-    StatusOr<int64_t> maybe_size = fs->FileSize(iter->file());
-    if (!maybe_size.ok()) {
-      return Status::FromCause("Failed to size LevelDB directory",
-                               maybe_size.status());
-    }
+void LevelDbPersistence::AdjustByteSize(int64_t delta) {
+  pending_byte_size_delta_ += delta;
+}
 
-    uint64_t old_count = count;
-    int64_t file_size = maybe_size.ValueOrDie();
-    count += file_size;
+void LevelDbPersistence::LoadByteSize() {
+  absl::optional<int64_t> stored = globals_cache_->GetByteSize();
+  if (stored.has_value()) {
+    byte_size_ = stored.value();
+    return;
+  }
 
-    auto max_signed_value =
-        static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
-    if (count < old_count || count > max_signed_value) {
-      return Status(Error::kErrorOutOfRange,
-                    "Failed to size LevelDB: count overflowed");
+  int64_t byte_size = 0;
+  auto it = transaction_->NewIterator();
+  for (const std::string& prefix :
+       {LevelDbRemoteDocumentKey::KeyPrefix(), LevelDbTargetKey::KeyPrefix(),
+        LevelDbMutationKey::KeyPrefix()}) {
+    for (it->Seek(prefix); it->Valid() && absl::StartsWith(it->key(), prefix);
+         it->Next()) {
+      byte_size += static_cast<int64_t>(it->value().size());
     }
   }
+  LOG_DEBUG("Measured the LevelDB cache at %s bytes", byte_size);
 
-  if (!iter->status().ok()) {
-    return Status::FromCause("Failed to iterate over LevelDB files",
-                             iter->status());
-  }
-  return static_cast<int64_t>(count);
+  byte_size_ = byte_size;
+  globals_cache_->SetByteSize(byte_size_);
 }
 
 // MARK: - Persistence
@@ -231,6 +355,8 @@ model::ListenSequenceNumber LevelDbPersistence::current_sequence_number()
 void LevelDbPersistence::Shutdown() {
   HARD_ASSERT(started_, "LevelDbPersistence shutdown without start!");
   started_ = false;
+  // Waits for the read-only transactions that are still running.
+  absl::MutexLock lock(&read_only_mutex_);
   db_.reset();
 }
 
@@ -302,6 +428,9 @@ LevelDbOverlayMigrationManager* LevelDbPersistence::GetOverlayMigrationManager(
 
 void LevelDbPersistence::ReleaseOtherUserSpecificComponents(
     const std::string& target_uid) {
+  // Read-only transactions that started before the user changed may still
+  // read through the components of the previous user.
+  absl::MutexLock lock(&read_only_mutex_);
   for (const auto& uid : users_) {
     if (target_uid != uid) {
       document_overlay_caches_.erase(uid);
@@ -312,6 +441,37 @@ void LevelDbPersistence::ReleaseOtherUserSpecificComponents(
   }
 }
 
+bool LevelDbPersistence::RunDeferredMigrations() {
+  return Run("Run deferred migrations", [&] {
+    return LevelDbMigrations::RunDeferredMigrations(
+        current_transaction(), kDeferredMigrationSliceSize);
+  });
+}
+
+void LevelDbPersistence::ReleaseMemory(MemoryPressure pressure) {
+  // Documents and blocks dropped here are read back from disk as needed.
+  size_t capacity = document_cache_->decoded_cache_capacity();
+  switch (pressure) {
+    case MemoryPressure::kNormal:
+      document_cache_->SetDecodedCacheLimit(capacity);
+      return;
+    case MemoryPressure::kWarning:
+      document_cache_->SetDecodedCacheLimit(capacity / 4);
+      break;
+    case MemoryPressure::kCritical:
+      document_cache_->SetDecodedCacheLimit(0);
+      break;
+  }
+
+  target_cache_->ReleaseMatchingKeys();
+  // Only blocks that no iterator or table holds on to are dropped; the
+  // pinned index and filter blocks of open tables stay.
+  if (resources_.block_cache) {
+    resources_.block_cache->Prune();
+  }
+  LOG_DEBUG("Released cached documents and blocks under memory pressure");
+}
+
 void LevelDbPersistence::DeleteAllFieldIndexes() {
   DeleteEverythingWithPrefix("Delete All Index Configuration",
                              LevelDbIndexConfigurationKey::KeyPrefix());
@@ -334,10 +494,34 @@ void LevelDbPersistence::RunInternal(absl::string_view label,
   block();
 
   reference_delegate_->OnTransactionCommitted();
+  if (pending_byte_size_delta_ != 0) {
+    byte_size_ = std::max<int64_t>(byte_size_ + pending_byte_size_delta_, 0);
+    pending_byte_size_delta_ = 0;
+    globals_cache_->SetByteSize(byte_size_);
+  }
   transaction_->Commit();
   transaction_.reset();
 }
 
+void LevelDbPersistence::RunReadOnlyInternal(absl::string_view label,
+                                             std::function<void()> block) {
+  absl::ReaderMutexLock lock(&read_only_mutex_);
+
+  const leveldb::Snapshot* snapshot = db_->GetSnapshot();
+  leveldb::ReadOptions read_options = LevelDbTransaction::DefaultReadOptions();
+  read_options.snapshot = snapshot;
+  LevelDbTransaction transaction(db_.get(), label, read_options);
+
+  ReadOnlyTransaction previous = current_read_only_transaction;
+  current_read_only_transaction = {this, &transaction};
+  block();
+  current_read_only_transaction = previous;
+
+  HARD_ASSERT(transaction.changed_keys() == 0,
+              "Read-only transaction %s made changes", label);
+  db_->ReleaseSnapshot(snapshot);
+}
+
 leveldb::ReadOptions StandardReadOptions() {
   // For now this is paranoid, but perhaps disable that in production builds.
   leveldb::ReadOptions options;
@@ -347,6 +531,13 @@ leveldb::ReadOptions StandardReadOptions() {
 
 void LevelDbPersistence::DeleteEverythingWithPrefix(absl::string_view label,
                                                     const std::string& prefix) {
+  if (range_deletions_) {
+    RunInternal(label, [&]() {
+      transaction_->DeleteRange(prefix, util::PrefixSuccessor(prefix));
+    });
+    return;
+  }
+
   bool more_deletes = true;
 
   auto fun = [&]() {
@@ -31,6 +31,7 @@
 #include "Firestore/core/src/local/leveldb_migrations.h"
 #include "Firestore/core/src/local/leveldb_mutation_queue.h"
 #include "Firestore/core/src/local/leveldb_overlay_migration_manager.h"
+#include "Firestore/core/src/local/leveldb_profile.h"
 #include "Firestore/core/src/local/leveldb_remote_document_cache.h"
 #include "Firestore/core/src/local/leveldb_target_cache.h"
 #include "Firestore/core/src/local/leveldb_transaction.h"
@@ -38,6 +39,9 @@
 #include "Firestore/core/src/local/persistence.h"
 #include "Firestore/core/src/util/path.h"
 #include "Firestore/core/src/util/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "leveldb/cache.h"
+#include "leveldb/filter_policy.h"
 
 namespace firebase {
 namespace firestore {
@@ -57,9 +61,15 @@ class LevelDbPersistence : public Persistence {
   /**
    * Creates a LevelDB in the given directory and returns it or a Status object
    * containing details of the failure.
+   *
+   * @param profile The LevelDB tuning to open the database with.
    */
   static util::StatusOr<std::unique_ptr<LevelDbPersistence>> Create(
-      util::Path dir, LocalSerializer serializer, const LruParams& lru_params);
+      util::Path dir,
+      LocalSerializer serializer,
+      const LruParams& lru_params,
+      const LevelDbProfile& profile = LevelDbProfile::Default(
+          api::Settings::DefaultCacheSizeBytes));
 
   ~LevelDbPersistence();
 
@@ -73,10 +83,35 @@ class LevelDbPersistence : public Persistence {
     return users_;
   }
 
+  /** Whether bulk removals are written as range deletions. */
+  bool range_deletions() const {
+    return range_deletions_;
+  }
+
   static util::Status ClearPersistence(const core::DatabaseInfo& database_info);
 
+  /**
+   * Returns the encoded size of the cached documents, targets and mutation
+   * batches. This is a running total kept in the globals cache, so it does not
+   * touch the disk.
+   */
   util::StatusOr<int64_t> CalculateByteSize();
 
+  /**
+   * Adds `delta` to the byte size of the cache when the current transaction
+   * commits. The caches call this with the change in encoded size whenever
+   * they write or remove a document, target or mutation batch.
+   */
+  void AdjustByteSize(int64_t delta);
+
+  /**
+   * Writes the whole database to `file` as a single sorted, uncompressed
+   * table, for shipping as a prebuilt cache. A database opened with the file
+   * as `LevelDbProfile::snapshot_path` takes the table as it is, and serves
+   * reads from it through a memory map without copying the blocks.
+   */
+  util::Status ExportSnapshot(const util::Path& file);
+
   // MARK: Persistence overrides
 
   model::ListenSequenceNumber current_sequence_number() const override;
@@ -105,20 +140,48 @@ class LevelDbPersistence : public Persistence {
 
   void ReleaseOtherUserSpecificComponents(const std::string& uid) override;
 
+  bool RunDeferredMigrations() override;
+
+  void ReleaseMemory(util::MemoryPressure pressure) override;
+
+  /**
+   * Read-only blocks read a leveldb snapshot, through a transaction of their
+   * own, so they run on any thread alongside the worker queue's transaction.
+   */
+  bool SupportsConcurrentReads() const override {
+    return true;
+  }
+
  protected:
   void RunInternal(absl::string_view label,
                    std::function<void()> block) override;
 
+  void RunReadOnlyInternal(absl::string_view label,
+                           std::function<void()> block) override;
+
  private:
   friend class LevelDbOverlayMigrationManagerTest;
   friend class LevelDbLocalStoreTest;
   friend class LevelDbIndexManager;
 
-  LevelDbPersistence(std::unique_ptr<leveldb::DB> db,
+  /**
+   * The block cache and filter policy the database was opened with; both
+   * are null if LevelDB's defaults were used. Also the table format version
+   * that its tables are written in.
+   */
+  struct DbResources {
+    std::unique_ptr<leveldb::Cache> block_cache;
+    std::unique_ptr<const leveldb::FilterPolicy> filter_policy;
+    int table_format_version = 0;
+  };
+
+  LevelDbPersistence(DbResources resources,
+                     std::unique_ptr<leveldb::DB> db,
                      util::Path directory,
                      std::set<std::string> users,
                      LocalSerializer serializer,
-                     const LruParams& lru_params);
+                     const LruParams& lru_params,
+                     const LevelDbProfile& profile);
 
   /**
    * The maximum number of operation per transaction.
@@ -130,32 +193,64 @@ class LevelDbPersistence : public Persistence {
    */
   static util::Status EnsureDirectory(const util::Path& dir);
 
-  /** Opens the database within the given directory. */
+  /**
+   * Opens the database within the given directory, tuned by `profile`. The
+   * block cache and filter policy created for it are stored in `resources`
+   * and must outlive the database.
+   */
   static util::StatusOr<std::unique_ptr<leveldb::DB>> OpenDb(
-      const util::Path& dir);
+      const util::Path& dir,
+      const LevelDbProfile& profile,
+      DbResources* resources);
+
+  /**
+   * Adds the table at `snapshot_path` to `db` if the database is still empty.
+   * The table becomes the bottom level of the database, and later writes are
+   * layered on top of it.
+   */
+  static util::Status SeedFromSnapshot(leveldb::DB* db,
+                                       const std::string& snapshot_path);
 
   static util::StatusOr<std::unique_ptr<LevelDbPersistence>> Create(
       util::Path dir,
       LevelDbMigrations::SchemaVersion schema_version,
       LocalSerializer serializer,
-      const LruParams& lru_params);
+      const LruParams& lru_params,
+      const LevelDbProfile& profile = LevelDbProfile::Default(
+          api::Settings::DefaultCacheSizeBytes));
 
   void DeleteAllFieldIndexes() override;
 
+  /**
+   * Loads the byte size of the cache from the globals cache. Databases that
+   * predate it are measured once with a scan of their documents, targets and
+   * mutation batches.
+   */
+  void LoadByteSize();
+
   /**
    * Remove the database entry (if any) for all "key" starting with given
-   * prefix. It is a no-op if the key does not exist.
+   * prefix, as a single range deletion if the profile asks for them. It is a
+   * no-op if the key does not exist.
    */
   void DeleteEverythingWithPrefix(absl::string_view label,
                                   const std::string& prefix);
 
+  // Declared before db_ so that they are destroyed after it.
+  DbResources resources_;
   std::unique_ptr<leveldb::DB> db_;
 
   util::Path directory_;
   std::set<std::string> users_;
   LocalSerializer serializer_;
+  bool range_deletions_ = false;
   bool started_ = false;
 
+  /** The byte size of the cache as of the last committed transaction. */
+  int64_t byte_size_ = 0;
+  /** The change in byte size made by the current transaction. */
+  int64_t pending_byte_size_delta_ = 0;
+
   std::unique_ptr<LevelDbBundleCache> bundle_cache_;
   std::unique_ptr<LevelDbGlobalsCache> globals_cache_;
   std::unordered_map<std::string, std::unique_ptr<LevelDbDocumentOverlayCache>>
@@ -172,6 +267,12 @@ class LevelDbPersistence : public Persistence {
   std::unique_ptr<LevelDbLruReferenceDelegate> reference_delegate_;
 
   std::unique_ptr<LevelDbTransaction> transaction_;
+
+  /**
+   * Held shared by read-only transactions, and exclusively while the
+   * components of other users are released.
+   */
+  absl::Mutex read_only_mutex_;
 };
 
 /** Returns a standard set of read options. */
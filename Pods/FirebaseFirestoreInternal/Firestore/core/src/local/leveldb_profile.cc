@@ -0,0 +1,144 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/local/leveldb_profile.h"
+
+#include <algorithm>
+
+#include "Firestore/core/src/util/hard_assert.h"
+
+namespace firebase {
+namespace firestore {
+namespace local {
+
+namespace {
+
+using api::Settings;
+
+constexpr size_t kMiB = 1024 * 1024;
+
+/**
+ * Returns `1 / divisor` of the cache size, clamped to `[min_size, max_size]`.
+ * An unlimited cache gets `max_size`.
+ */
+size_t FractionOfCacheSize(int64_t cache_size_bytes,
+                           int64_t divisor,
+                           size_t min_size,
+                           size_t max_size) {
+  if (cache_size_bytes == Settings::CacheSizeUnlimited) {
+    return max_size;
+  }
+  auto size = static_cast<size_t>(std::max<int64_t>(cache_size_bytes, 0) /
+                                  divisor);
+  return std::min(std::max(size, min_size), max_size);
+}
+
+}  // namespace
+
+LevelDbProfile LevelDbProfile::Default(int64_t cache_size_bytes) {
+  LevelDbProfile profile;
+  profile.bloom_filter_bits_per_key = 10;
+  profile.block_cache_size =
+      FractionOfCacheSize(cache_size_bytes, 32, 4 * kMiB, 32 * kMiB);
+  profile.write_buffer_size = 4 * kMiB;
+  profile.max_file_size = 2 * kMiB;
+  profile.max_open_files = 1000;
+  profile.compression = leveldb::kNoCompression;
+  profile.table_format_version = 0;
+  profile.range_deletions = false;
+  profile.compaction_style = leveldb::kLeveledCompaction;
+  // The first queries after launch read all over the cache; let them find
+  // their tables already open.
+  profile.preload_tables = true;
+  profile.decoded_document_cache_size =
+      FractionOfCacheSize(cache_size_bytes, 32, 1 * kMiB, 8 * kMiB);
+  profile.remote_event_chunk_size = 1000;
+  profile.gc_slice_duration_ms = 0;
+  return profile;
+}
+
+LevelDbProfile LevelDbProfile::LowMemoryDevice(int64_t cache_size_bytes) {
+  LevelDbProfile profile = Default(cache_size_bytes);
+  profile.block_cache_size =
+      FractionOfCacheSize(cache_size_bytes, 64, 1 * kMiB, 4 * kMiB);
+  profile.write_buffer_size = 1 * kMiB;
+  profile.max_file_size = 1 * kMiB;
+  // Each open table holds its index and filter on the heap.
+  profile.max_open_files = 100;
+  profile.preload_tables = false;
+  // Slow flash wears out with every rewrite of the cache.
+  profile.compaction_style = leveldb::kTieredCompaction;
+  profile.decoded_document_cache_size =
+      FractionOfCacheSize(cache_size_bytes, 128, 256 * 1024, 1 * kMiB);
+  profile.remote_event_chunk_size = 250;
+  // Slow storage makes a single collection block the queue for long.
+  profile.gc_slice_duration_ms = 20;
+  return profile;
+}
+
+LevelDbProfile LevelDbProfile::LargeOfflineCache(int64_t cache_size_bytes) {
+  LevelDbProfile profile = Default(cache_size_bytes);
+  profile.block_cache_size =
+      FractionOfCacheSize(cache_size_bytes, 16, 8 * kMiB, 64 * kMiB);
+  // Larger memtables and tables mean fewer level-0 files per burst of
+  // remote changes, and fewer tables to open for the same cache.
+  profile.write_buffer_size = 8 * kMiB;
+  profile.max_file_size = 8 * kMiB;
+  // Initial syncs and bundle loads write most of the cache at once, which
+  // leveled compaction would then rewrite level by level.
+  profile.compaction_style = leveldb::kTieredCompaction;
+  profile.decoded_document_cache_size =
+      FractionOfCacheSize(cache_size_bytes, 16, 4 * kMiB, 32 * kMiB);
+  profile.remote_event_chunk_size = 5000;
+  profile.gc_slice_duration_ms = 50;
+  return profile;
+}
+
+LevelDbProfile LevelDbProfile::ForSettings(const Settings& settings) {
+  LevelDbProfile profile =
+      ForProfile(settings.persistence_profile(), settings.cache_size_bytes());
+  profile.snapshot_path = settings.cache_snapshot_path();
+  return profile;
+}
+
+LevelDbProfile LevelDbProfile::ForProfile(
+    Settings::PersistenceProfile profile, int64_t cache_size_bytes) {
+  switch (profile) {
+    case Settings::PersistenceProfile::kDefault:
+      return Default(cache_size_bytes);
+    case Settings::PersistenceProfile::kLowMemoryDevice:
+      return LowMemoryDevice(cache_size_bytes);
+    case Settings::PersistenceProfile::kLargeOfflineCache:
+      return LargeOfflineCache(cache_size_bytes);
+  }
+  UNREACHABLE();
+}
+
+leveldb::Options LevelDbProfile::ToOptions() const {
+  leveldb::Options options;
+  options.write_buffer_size = write_buffer_size;
+  options.max_file_size = max_file_size;
+  options.max_open_files = max_open_files;
+  options.compression = compression;
+  options.format_version = table_format_version;
+  options.compaction_style = compaction_style;
+  options.preload_tables = preload_tables;
+  return options;
+}
+
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_LOCAL_LEVELDB_PROFILE_H_
+#define FIRESTORE_CORE_SRC_LOCAL_LEVELDB_PROFILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "Firestore/core/src/api/settings.h"
+#include "leveldb/options.h"
+
+namespace firebase {
+namespace firestore {
+namespace local {
+
+/**
+ * The LevelDB tuning used by LevelDbPersistence, derived from the
+ * persistence profile and cache size in the Firestore settings.
+ */
+struct LevelDbProfile {
+  static LevelDbProfile Default(int64_t cache_size_bytes);
+
+  static LevelDbProfile LowMemoryDevice(int64_t cache_size_bytes);
+
+  static LevelDbProfile LargeOfflineCache(int64_t cache_size_bytes);
+
+  static LevelDbProfile ForSettings(const api::Settings& settings);
+
+  static LevelDbProfile ForProfile(api::Settings::PersistenceProfile profile,
+                                   int64_t cache_size_bytes);
+
+  /**
+   * Returns LevelDB options with every field of this profile applied. The
+   * caller supplies the block cache and filter policy, which must outlive
+   * the database.
+   */
+  leveldb::Options ToOptions() const;
+
+  /** Bits per key of the table bloom filters; zero disables them. */
+  int bloom_filter_bits_per_key;
+
+  /** Capacity of the shared block cache; zero uses LevelDB's own. */
+  size_t block_cache_size;
+
+  size_t write_buffer_size;
+  size_t max_file_size;
+  int max_open_files;
+
+  /**
+   * The built-in profiles only write tables that the LevelDB of older SDK
+   * versions can read, so that an app that downgrades its SDK can still
+   * open its cache: Firestore cannot start if it can't. Older SDKs have no
+   * Snappy codec, so blocks are stored uncompressed by default, and tables
+   * use format version 0. Snappy compression and format version 1, which
+   * stores keys more compactly, give up that guarantee.
+   */
+  leveldb::CompressionType compression;
+  int table_format_version;
+
+  /**
+   * Whether bulk removals are written as single range deletions rather than
+   * one deletion per key. Older SDKs drop the log records of range deletions,
+   * together with the rest of their batch, and ignore them in tables, which
+   * brings the deleted keys back; so the built-in profiles leave this off.
+   */
+  bool range_deletions;
+
+  /**
+   * Tiered compaction rewrites each document far fewer times than leveled
+   * compaction, at the cost of reads that look at more tables.
+   */
+  leveldb::CompactionStyle compaction_style;
+
+  /** Whether tables are opened in the background right after startup. */
+  bool preload_tables;
+
+  /**
+   * Capacity of the cache of decoded remote documents, in encoded bytes;
+   * zero disables it.
+   */
+  size_t decoded_document_cache_size;
+
+  /**
+   * The maximum number of documents of a remote event committed per
+   * transaction; see `LocalStore::SetRemoteEventChunkSize()`.
+   */
+  size_t remote_event_chunk_size;
+
+  /**
+   * The length of the slices garbage collection is split into; zero collects
+   * in one go. See `LruParams::slice_duration_ms`.
+   */
+  int64_t gc_slice_duration_ms;
+
+  /**
+   * A prebuilt snapshot that an empty database is seeded from; see
+   * `api::Settings::cache_snapshot_path()`. Empty if there is none.
+   */
+  std::string snapshot_path;
+};
+
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_LOCAL_LEVELDB_PROFILE_H_
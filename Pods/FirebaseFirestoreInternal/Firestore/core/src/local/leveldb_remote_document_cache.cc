@@ -16,9 +16,12 @@
 
 #include "Firestore/core/src/local/leveldb_remote_document_cache.h"
 
+#include <algorithm>
+#include <set>
 #include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include "Firestore/Protos/nanopb/firestore/local/maybe_document.nanopb.h"
 #include "Firestore/core/src/core/pipeline_util.h"  // Added
@@ -36,8 +39,11 @@
 #include "Firestore/core/src/util/background_queue.h"
 #include "Firestore/core/src/util/executor.h"
 #include "Firestore/core/src/util/log.h"
+#include "Firestore/core/src/util/mutex_contention.h"
 #include "Firestore/core/src/util/status.h"
 #include "Firestore/core/src/util/string_util.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
 #include "leveldb/db.h"
 
 namespace firebase {
@@ -45,6 +51,9 @@ namespace firestore {
 namespace local {
 namespace {
 
+using core::FieldFilter;
+using core::Filter;
+using core::OrderBy;
 using core::Query;
 using leveldb::Status;
 using model::DocumentKey;
@@ -59,6 +68,40 @@ using nanopb::StringReader;
 using util::BackgroundQueue;
 using util::Executor;
 
+/**
+ * The least number of documents worth handing to a thread of the query
+ * executor. Smaller reads are decoded on the calling thread.
+ */
+const size_t kMinDocumentsPerDecodeTask = 32;
+
+/**
+ * Returns the names of the top-level fields that decide whether a document
+ * matches `query`, or nothing if the query is not selective enough for it to
+ * pay to match documents before decoding them in full.
+ */
+absl::optional<std::set<std::string>> FilterFieldNames(
+    const core::QueryOrPipeline& query) {
+  if (query.IsPipeline()) {
+    return absl::nullopt;
+  }
+  const Query& filtered = query.query();
+  if (filtered.filters().empty() && !filtered.start_at() &&
+      !filtered.end_at()) {
+    return absl::nullopt;
+  }
+
+  std::set<std::string> names;
+  for (const Filter& filter : filtered.filters()) {
+    for (const FieldFilter& field_filter : filter.GetFlattenedFilters()) {
+      names.insert(field_filter.field().first_segment());
+    }
+  }
+  for (const OrderBy& order_by : filtered.normalized_order_bys()) {
+    names.insert(order_by.field().first_segment());
+  }
+  return names;
+}
+
 /**
  * An accumulator for results produced asynchronously. This accumulates
  * values in a vector to avoid contention caused by accumulating into more
@@ -68,12 +111,12 @@ template <typename T>
 class AsyncResults {
  public:
   void Insert(T&& value) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    absl::MutexLock lock(&mutex_);
     values_.push_back(std::move(value));
   }
 
   void Insert(const T& value) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    absl::MutexLock lock(&mutex_);
     values_.push_back(value);
   }
 
@@ -82,25 +125,32 @@ class AsyncResults {
    * AsyncResults object should not be reused.
    */
   std::vector<T> Result() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    absl::MutexLock lock(&mutex_);
     return std::move(values_);
   }
 
  private:
   std::vector<T> values_;
-  std::mutex mutex_;
+  absl::Mutex mutex_;
+  util::MutexContentionSite mutex_site_{
+      &mutex_, "firestore.LevelDbRemoteDocumentCache.AsyncResults"};
 };
 
 }  // namespace
 
 LevelDbRemoteDocumentCache::LevelDbRemoteDocumentCache(
-    LevelDbPersistence* db, LocalSerializer* serializer)
-    : db_(db), serializer_(NOT_NULL(serializer)) {
+    LevelDbPersistence* db,
+    LocalSerializer* serializer,
+    size_t decoded_cache_size)
+    : db_(db),
+      serializer_(NOT_NULL(serializer)),
+      decoded_cache_(decoded_cache_size) {
   auto hw_concurrency = std::thread::hardware_concurrency();
   if (hw_concurrency == 0) {
     // If the standard library doesn't know, guess something reasonable.
     hw_concurrency = 4;
   }
+  executor_concurrency_ = hw_concurrency;
   executor_ = Executor::CreateConcurrent("com.google.firebase.firestore.query",
                                          static_cast<int>(hw_concurrency));
 }
@@ -114,8 +164,11 @@ void LevelDbRemoteDocumentCache::Add(const MutableDocument& document,
   const ResourcePath& path = key.path();
 
   std::string ldb_document_key = LevelDbRemoteDocumentKey::Key(key);
-  db_->current_transaction()->Put(ldb_document_key,
-                                  serializer_->EncodeMaybeDocument(document));
+  std::string encoded =
+      nanopb::MakeStdString(serializer_->EncodeMaybeDocument(document));
+  db_->AdjustByteSize(static_cast<int64_t>(encoded.size()) -
+                      EraseStoredDocument(key, ldb_document_key));
+  db_->current_transaction()->Put(ldb_document_key, encoded);
 
   std::string ldb_read_time_key = LevelDbRemoteDocumentReadTimeKey::Key(
       path.PopLast(), read_time, path.last_segment());
@@ -127,42 +180,123 @@ void LevelDbRemoteDocumentCache::Add(const MutableDocument& document,
 
 void LevelDbRemoteDocumentCache::Remove(const DocumentKey& key) {
   std::string ldb_key = LevelDbRemoteDocumentKey::Key(key);
+  db_->AdjustByteSize(-EraseStoredDocument(key, ldb_key));
   db_->current_transaction()->Delete(ldb_key);
 }
 
+int64_t LevelDbRemoteDocumentCache::EraseStoredDocument(
+    const DocumentKey& key, const std::string& ldb_key) {
+  // Documents are usually read before they are written, so their size is
+  // mostly known without another read.
+  absl::optional<size_t> charge = decoded_cache_.Erase(key);
+  if (charge.has_value()) {
+    return static_cast<int64_t>(charge.value());
+  }
+
+  std::string contents;
+  if (db_->current_transaction()->Get(ldb_key, &contents).ok()) {
+    return static_cast<int64_t>(contents.size());
+  }
+  return 0;
+}
+
 MutableDocument LevelDbRemoteDocumentCache::Get(const DocumentKey& key) const {
+  LevelDbTransaction* transaction = db_->current_transaction();
+  // The cached copy may be newer than the document in a snapshot.
+  if (!transaction->reads_snapshot()) {
+    absl::optional<MutableDocument> cached = decoded_cache_.Lookup(key);
+    if (cached) {
+      return *std::move(cached);
+    }
+  }
+  return ReadDocument(key, transaction);
+}
+
+MutableDocument LevelDbRemoteDocumentCache::ReadDocument(
+    const DocumentKey& key, LevelDbTransaction* transaction) const {
   std::string ldb_key = LevelDbRemoteDocumentKey::Key(key);
-  std::string value;
-  Status status = db_->current_transaction()->Get(ldb_key, &value);
+  // Documents can be large, so decode them straight from the block cache.
+  leveldb::PinnableSlice value;
+  Status status = transaction->Get(ldb_key, &value);
   if (status.IsNotFound()) {
     return MutableDocument::InvalidDocument(key);
   } else if (status.ok()) {
-    return DecodeMaybeDocument(value, key);
+    return DecodeAndCache(absl::string_view(value.data(), value.size()), key,
+                          *transaction);
   } else {
     HARD_FAIL("Fetch document for key (%s) failed with status: %s",
               key.ToString(), status.ToString());
   }
 }
 
+absl::optional<MutableDocument>
+LevelDbRemoteDocumentCache::ReadDocumentIfMatches(
+    const DocumentKey& key,
+    const Query& query,
+    const std::set<std::string>& field_names,
+    LevelDbTransaction* transaction) const {
+  std::string ldb_key = LevelDbRemoteDocumentKey::Key(key);
+  leveldb::PinnableSlice value;
+  Status status = transaction->Get(ldb_key, &value);
+  if (status.IsNotFound()) {
+    return absl::nullopt;
+  } else if (!status.ok()) {
+    HARD_FAIL("Fetch document for key (%s) failed with status: %s",
+              key.ToString(), status.ToString());
+  }
+
+  absl::string_view encoded(value.data(), value.size());
+  absl::optional<MutableDocument> partial =
+      serializer_->DecodePartialDocument(encoded, key, field_names);
+  // A document that cannot be taken apart is left to the full decoding to
+  // report.
+  if (partial && !query.Matches(*partial)) {
+    return absl::nullopt;
+  }
+  return DecodeAndCache(encoded, key, *transaction);
+}
+
 MutableDocumentMap LevelDbRemoteDocumentCache::GetAll(
     const DocumentKeySet& keys) const {
   BackgroundQueue tasks(executor_.get());
   AsyncResults<std::pair<DocumentKey, MutableDocument>> results;
+  LevelDbTransaction* transaction = db_->current_transaction();
 
-  LevelDbRemoteDocumentKey current_key;
-  auto it = db_->current_transaction()->NewIterator();
-
+  // Look the documents that are not decoded already up with one batched
+  // read, which shares table and block reads between keys instead of
+  // seeking once per key.
+  std::vector<const DocumentKey*> missing;
+  std::vector<std::string> ldb_keys;
   for (const DocumentKey& key : keys) {
-    it->Seek(LevelDbRemoteDocumentKey::Key(key));
-    if (!it->Valid() || !current_key.Decode(it->key()) ||
-        current_key.document_key() != key) {
+    absl::optional<MutableDocument> cached;
+    if (!transaction->reads_snapshot()) {
+      cached = decoded_cache_.Lookup(key);
+    }
+    if (cached) {
+      results.Insert(std::make_pair(key, *std::move(cached)));
+    } else {
+      missing.push_back(&key);
+      ldb_keys.push_back(LevelDbRemoteDocumentKey::Key(key));
+    }
+  }
+  std::vector<std::string> contents;
+  std::vector<Status> statuses = transaction->MultiGet(ldb_keys, &contents);
+
+  for (size_t i = 0; i < missing.size(); ++i) {
+    const DocumentKey& key = *missing[i];
+    const Status& status = statuses[i];
+    if (status.IsNotFound()) {
       results.Insert(
           std::make_pair(key, MutableDocument::InvalidDocument(key)));
-    } else {
-      const std::string& contents = it->value();
-      tasks.Execute([this, &results, &key, contents] {
-        results.Insert(std::make_pair(key, DecodeMaybeDocument(contents, key)));
+    } else if (status.ok()) {
+      const std::string& value = contents[i];
+      tasks.Execute([this, &results, &key, &value, transaction] {
+        results.Insert(
+            std::make_pair(key, DecodeAndCache(value, key, *transaction)));
       });
+    } else {
+      HARD_FAIL("Fetch document for key (%s) failed with status: %s",
+                key.ToString(), status.ToString());
     }
   }
 
@@ -179,24 +313,73 @@ MutableDocumentMap LevelDbRemoteDocumentCache::GetAllExisting(
     DocumentVersionMap&& remote_map,
     const core::QueryOrPipeline& query,
     const model::OverlayByDocumentKeyMap& mutated_docs) const {
-  BackgroundQueue tasks(executor_.get());
-  AsyncResults<std::pair<DocumentKey, MutableDocument>> results;
+  using Entry = std::pair<DocumentKey, MutableDocument>;
+
+  std::vector<const DocumentVersionMap::value_type*> key_versions;
+  key_versions.reserve(remote_map.size());
   for (const auto& key_version : remote_map) {
-    tasks.Execute([this, &results, &key_version, query, &mutated_docs] {
-      auto document = Get(key_version.first).WithReadTime(key_version.second);
-      if (document.is_found_document() &&
+    key_versions.push_back(&key_version);
+  }
+
+  // Documents that are not mutated are only decoded in full if the fields
+  // the query filters on match.
+  absl::optional<std::set<std::string>> field_names = FilterFieldNames(query);
+
+  // Tasks run on other threads, which do not see the transaction of this
+  // one as their current transaction.
+  LevelDbTransaction* transaction = db_->current_transaction();
+  auto read_matching = [&](size_t begin, size_t end,
+                           std::vector<Entry>* results) {
+    for (size_t i = begin; i < end; ++i) {
+      const DocumentKey& key = key_versions[i]->first;
+      const SnapshotVersion& read_time = key_versions[i]->second;
+      bool mutated = mutated_docs.find(key) != mutated_docs.end();
+      // The read time index names the version of the document to expect, so
+      // a cached copy with any other read time is not used.
+      absl::optional<MutableDocument> document =
+          decoded_cache_.Lookup(key, read_time);
+      if (!document && field_names && !mutated) {
+        document = ReadDocumentIfMatches(key, query.query(), *field_names,
+                                         transaction);
+        if (!document) continue;
+      } else if (!document) {
+        document = ReadDocument(key, transaction);
+      }
+      document->WithReadTime(read_time);
+      if (document->is_found_document() &&
           // Either the document matches the given query, or it is mutated.
-          (query.Matches(document) ||
-           mutated_docs.find(key_version.first) != mutated_docs.end())) {
-        results.Insert(std::make_pair(key_version.first, std::move(document)));
+          (query.Matches(*document) || mutated)) {
+        results->emplace_back(key, *std::move(document));
       }
-    });
+    }
+  };
+
+  // Each task reads a contiguous run of keys into its own buffer, so the
+  // buffers hold the results in key order without any locking.
+  size_t count = key_versions.size();
+  size_t task_count =
+      std::min(executor_concurrency_, count / kMinDocumentsPerDecodeTask);
+  std::vector<std::vector<Entry>> buffers(std::max<size_t>(task_count, 1));
+  if (task_count <= 1) {
+    read_matching(0, count, &buffers[0]);
+  } else {
+    BackgroundQueue tasks(executor_.get());
+    for (size_t t = 0; t < task_count; ++t) {
+      size_t begin = count * t / task_count;
+      size_t end = count * (t + 1) / task_count;
+      std::vector<Entry>* buffer = &buffers[t];
+      tasks.Execute([&read_matching, begin, end, buffer] {
+        read_matching(begin, end, buffer);
+      });
+    }
+    tasks.AwaitAll();
   }
-  tasks.AwaitAll();
 
   MutableDocumentMap map;
-  for (const auto& entry : results.Result()) {
-    map = map.insert(entry.first, entry.second);
+  for (std::vector<Entry>& buffer : buffers) {
+    for (Entry& entry : buffer) {
+      map = map.insert(entry.first, std::move(entry.second));
+    }
   }
   return map;
 }
@@ -213,6 +396,11 @@ MutableDocumentMap LevelDbRemoteDocumentCache::GetAll(
     collections.push_back(parent.Append(collection_group));
   }
 
+  // Only index backfill reads documents by collection group.
+  LevelDbTransaction::ScopedReadProfile profile(
+      db_->current_transaction(),
+      LevelDbTransaction::ReadProfile::kBackground);
+
   MutableDocumentMap result;
   for (auto path = collections.cbegin();
        path != collections.cend() && result.size() < limit; path++) {
@@ -263,7 +451,19 @@ MutableDocumentMap LevelDbRemoteDocumentCache::GetDocumentsMatchingQuery(
   // set.
   std::string start_key =
       LevelDbRemoteDocumentReadTimeKey::KeyPrefix(path, offset.read_time());
-  auto it = db_->current_transaction()->NewIterator();
+
+  // Reading from the start of the collection is a full collection scan, so
+  // its blocks are not cached; the documents it decodes still are. Nested in
+  // a background read, the background profile is kept.
+  LevelDbTransaction* transaction = db_->current_transaction();
+  absl::optional<LevelDbTransaction::ScopedReadProfile> profile;
+  if (offset.read_time() == SnapshotVersion::None() &&
+      transaction->read_profile() ==
+          LevelDbTransaction::ReadProfile::kDefault) {
+    profile.emplace(transaction, LevelDbTransaction::ReadProfile::kScan);
+  }
+
+  auto it = transaction->NewIterator();
   it->Seek(util::ImmediateSuccessor(start_key));
 
   DocumentVersionMap remote_map;
@@ -304,19 +504,28 @@ MutableDocument LevelDbRemoteDocumentCache::DecodeMaybeDocument(
 
   auto message = Message<firestore_client_MaybeDocument>::TryParse(&reader);
   MutableDocument maybe_document =
-      serializer_->DecodeMaybeDocument(&reader, *message);
+      serializer_->DecodeMaybeDocument(&reader, *message, key);
 
   if (!reader.ok()) {
     HARD_FAIL("MaybeDocument proto failed to parse: %s",
               reader.status().ToString());
   }
-  HARD_ASSERT(maybe_document.key() == key,
-              "Read document has key (%s) instead of expected key (%s).",
-              maybe_document.key().ToString(), key.ToString());
 
   return maybe_document;
 }
 
+MutableDocument LevelDbRemoteDocumentCache::DecodeAndCache(
+    absl::string_view encoded,
+    const DocumentKey& key,
+    const LevelDbTransaction& transaction) const {
+  MutableDocument document = DecodeMaybeDocument(encoded, key);
+  if (!transaction.reads_snapshot()) {
+    // The encoded size is a fair proxy for the memory the decoded copy holds.
+    decoded_cache_.Insert(document, encoded.size());
+  }
+  return document;
+}
+
 void LevelDbRemoteDocumentCache::SetIndexManager(IndexManager* manager) {
   index_manager_ = NOT_NULL(manager);
 }
@@ -18,12 +18,14 @@
 #define FIRESTORE_CORE_SRC_LOCAL_LEVELDB_REMOTE_DOCUMENT_CACHE_H_
 
 #include <memory>
+#include <set>
 #include <string>
 #include <thread>
 #include <vector>
 
 #include "Firestore/core/src/core/pipeline_util.h"  // Added
 #include "Firestore/core/src/core/query.h"
+#include "Firestore/core/src/local/decoded_document_cache.h"
 #include "Firestore/core/src/local/leveldb_index_manager.h"
 #include "Firestore/core/src/local/remote_document_cache.h"
 #include "Firestore/core/src/model/model_fwd.h"
@@ -47,13 +49,19 @@ class SnapshotVersion;
 namespace local {
 
 class LevelDbPersistence;
+class LevelDbTransaction;
 class LocalSerializer;
 
 /** Cached Remote Documents backed by leveldb. */
 class LevelDbRemoteDocumentCache : public RemoteDocumentCache {
  public:
+  /**
+   * Creates a cache that keeps up to `decoded_cache_size` bytes of
+   * recently read documents decoded.
+   */
   LevelDbRemoteDocumentCache(LevelDbPersistence* db,
-                             LocalSerializer* serializer);
+                             LocalSerializer* serializer,
+                             size_t decoded_cache_size = 0);
   ~LevelDbRemoteDocumentCache();
 
   void Add(const model::MutableDocument& document,
@@ -80,6 +88,18 @@ class LevelDbRemoteDocumentCache : public RemoteDocumentCache {
 
   void SetIndexManager(IndexManager* manager) override;
 
+  /**
+   * Keeps at most `limit` bytes of decoded documents until the limit is
+   * changed again; see `DecodedDocumentCache::SetUsageLimit()`.
+   */
+  void SetDecodedCacheLimit(size_t limit) {
+    decoded_cache_.SetUsageLimit(limit);
+  }
+
+  size_t decoded_cache_capacity() const {
+    return decoded_cache_.capacity();
+  }
+
  private:
   /**
    * Looks up a set of entries in the cache, returning only existing entries of
@@ -93,6 +113,41 @@ class LevelDbRemoteDocumentCache : public RemoteDocumentCache {
   model::MutableDocument DecodeMaybeDocument(
       absl::string_view encoded, const model::DocumentKey& key) const;
 
+  /**
+   * Decodes `encoded` and remembers the result in `decoded_cache_`, unless it
+   * was read by `transaction` from a snapshot: newer versions of the document
+   * may have been written since, and dropped from the cache.
+   */
+  model::MutableDocument DecodeAndCache(
+      absl::string_view encoded,
+      const model::DocumentKey& key,
+      const LevelDbTransaction& transaction) const;
+
+  /**
+   * Reads the document for `key` from LevelDB through `transaction`,
+   * bypassing `decoded_cache_`.
+   */
+  model::MutableDocument ReadDocument(const model::DocumentKey& key,
+                                      LevelDbTransaction* transaction) const;
+
+  /**
+   * Like `ReadDocument`, but first decodes only the top-level fields in
+   * `field_names`, which `query` must not need any others of to be matched,
+   * and returns nothing without decoding the rest if they do not match.
+   */
+  absl::optional<model::MutableDocument> ReadDocumentIfMatches(
+      const model::DocumentKey& key,
+      const core::Query& query,
+      const std::set<std::string>& field_names,
+      LevelDbTransaction* transaction) const;
+
+  /**
+   * Drops `key` from `decoded_cache_` and returns the encoded size of the
+   * document stored at `ldb_key`, or zero if there is none.
+   */
+  int64_t EraseStoredDocument(const model::DocumentKey& key,
+                              const std::string& ldb_key);
+
   // The LevelDbRemoteDocumentCache instance is owned by LevelDbPersistence.
   LevelDbPersistence* db_;
   // The LevelDbIndexManager instance is owned by LevelDbPersistence.
@@ -101,6 +156,12 @@ class LevelDbRemoteDocumentCache : public RemoteDocumentCache {
   LocalSerializer* serializer_ = nullptr;
 
   std::unique_ptr<util::Executor> executor_;
+  // The number of threads of `executor_`.
+  size_t executor_concurrency_ = 0;
+
+  // Decoded copies of recently read documents. Entries are dropped when
+  // their document is written, so they always match the current value.
+  mutable DecodedDocumentCache decoded_cache_;
 };
 
 }  // namespace local
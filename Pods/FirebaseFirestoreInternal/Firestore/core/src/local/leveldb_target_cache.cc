@@ -16,9 +16,12 @@
 
 #include "Firestore/core/src/local/leveldb_target_cache.h"
 
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "Firestore/core/src/local/leveldb_key.h"
 #include "Firestore/core/src/local/leveldb_persistence.h"
@@ -31,7 +34,9 @@
 #include "Firestore/core/src/nanopb/byte_string.h"
 #include "Firestore/core/src/nanopb/reader.h"
 #include "Firestore/core/src/util/log.h"
+#include "Firestore/core/src/util/ordered_code.h"
 #include "Firestore/core/src/util/string_apple.h"
+#include "Firestore/core/src/util/string_util.h"
 #include "absl/strings/match.h"
 
 namespace firebase {
@@ -47,6 +52,7 @@ using model::SnapshotVersion;
 using model::TargetId;
 using nanopb::Message;
 using nanopb::StringReader;
+using util::OrderedCode;
 
 absl::optional<Message<firestore_client_TargetGlobal>>
 LevelDbTargetCache::TryReadMetadata(leveldb::DB* db) {
@@ -97,6 +103,19 @@ void LevelDbTargetCache::Start() {
     HARD_FAIL("Failed to decode last remote snapshot version, reason: '%s'",
               reader.status().ToString());
   }
+
+  std::unique_ptr<leveldb::Iterator> it(
+      db_->ptr()->NewIterator(StandardReadOptions()));
+  std::string index_prefix = LevelDbQueryTargetKey::KeyPrefix();
+  LevelDbQueryTargetKey row_key;
+  for (it->Seek(index_prefix);
+       it->Valid() && absl::StartsWith(MakeStringView(it->key()), index_prefix);
+       it->Next()) {
+    if (!row_key.Decode(MakeStringView(it->key()))) {
+      break;
+    }
+    IndexTarget(row_key.canonical_id(), row_key.target_id());
+  }
 }
 
 void LevelDbTargetCache::AddTarget(const TargetData& target_data) {
@@ -108,6 +127,7 @@ void LevelDbTargetCache::AddTarget(const TargetData& target_data) {
       LevelDbQueryTargetKey::Key(canonical_id, target_data.target_id());
   std::string empty_buffer;
   db_->current_transaction()->Put(index_key, empty_buffer);
+  IndexTarget(canonical_id, target_data.target_id());
 
   metadata_->target_count++;
   UpdateMetadata(target_data);
@@ -128,11 +148,17 @@ void LevelDbTargetCache::RemoveTarget(const TargetData& target_data) {
   RemoveMatchingKeysForTarget(target_id);
 
   std::string key = LevelDbTargetKey::Key(target_id);
+  std::string existing;
+  if (db_->current_transaction()->Get(key, &existing).ok()) {
+    db_->AdjustByteSize(-static_cast<int64_t>(existing.size()));
+  }
   db_->current_transaction()->Delete(key);
 
   std::string index_key = LevelDbQueryTargetKey::Key(
       target_data.target_or_pipeline().CanonicalId(), target_id);
   db_->current_transaction()->Delete(index_key);
+  db_->current_transaction()->Delete(LevelDbTargetResultKey::Key(target_id));
+  ForgetTarget(target_id);
 
   metadata_->target_count--;
   SaveMetadata();
@@ -140,52 +166,18 @@ void LevelDbTargetCache::RemoveTarget(const TargetData& target_data) {
 
 absl::optional<TargetData> LevelDbTargetCache::GetTarget(
     const core::TargetOrPipeline& target_or_pipeline) {
-  // Scan the query-target index starting with a prefix starting with the given
-  // target's or pipeline's canonical_id. Note that this is a scan rather than
-  // a get because canonical_ids are not required to be unique per target.
-  const std::string& canonical_id = target_or_pipeline.CanonicalId();
-  auto index_iterator = db_->current_transaction()->NewIterator();
-  std::string index_prefix = LevelDbQueryTargetKey::KeyPrefix(canonical_id);
-  index_iterator->Seek(index_prefix);
-
-  // Simultaneously scan the targets table. This works because each
-  // (canonical_id, target_id) pair is unique and ordered, so when scanning a
-  // table prefixed by exactly one canonical_id, all the target_ids will be
-  // unique and in order.
-  std::string target_prefix = LevelDbTargetKey::KeyPrefix();
-  auto target_iterator = db_->current_transaction()->NewIterator();
-
-  LevelDbQueryTargetKey row_key;
-  for (; index_iterator->Valid(); index_iterator->Next()) {
-    // Only consider rows matching exactly the specific canonical_id of
-    // interest.
-    auto kk = index_iterator->key();
-    (void)kk;
-
-    if (!absl::StartsWith(index_iterator->key(), index_prefix) ||
-        !row_key.Decode(index_iterator->key()) ||
-        canonical_id != row_key.canonical_id()) {
-      // End of this canonical_id's possible targets.
-      break;
-    }
-
-    // Each row is a unique combination of canonical_id and target_id, so this
-    // foreign key reference can only occur once.
-    std::string target_key = LevelDbTargetKey::Key(row_key.target_id());
-    target_iterator->Seek(target_key);
-    if (!target_iterator->Valid() || target_iterator->key() != target_key) {
-      LOG_WARN(
-          "Dangling query-target reference found: "
-          "%s points to %s; seeking there found %s",
-          DescribeKey(index_iterator), DescribeKey(target_key),
-          DescribeKey(target_iterator));
-      continue;
-    }
+  // Canonical IDs are not required to be unique per target, so check each
+  // target with this one's canonical ID for actual equality.
+  auto found =
+      target_ids_by_canonical_id_.find(target_or_pipeline.CanonicalId());
+  if (found == target_ids_by_canonical_id_.end()) {
+    return absl::nullopt;
+  }
 
-    // Finally after finding a potential match, check that the target or
-    // pipeline is actually equal to the requested one.
-    TargetData target_data = DecodeTarget(target_iterator->value());
-    if (target_data.target_or_pipeline() == target_or_pipeline) {
+  for (TargetId target_id : found->second) {
+    absl::optional<TargetData> target_data = ReadTarget(target_id);
+    if (target_data &&
+        target_data->target_or_pipeline() == target_or_pipeline) {
       return target_data;
     }
   }
@@ -196,6 +188,9 @@ absl::optional<TargetData> LevelDbTargetCache::GetTarget(
 void LevelDbTargetCache::EnumerateSequenceNumbers(
     const SequenceNumberCallback& callback) {
   // Enumerate all targets, give their sequence numbers.
+  LevelDbTransaction::ScopedReadProfile profile(
+      db_->current_transaction(),
+      LevelDbTransaction::ReadProfile::kBackground);
   std::string target_prefix = LevelDbTargetKey::KeyPrefix();
   auto it = db_->current_transaction()->NewIterator();
   it->Seek(target_prefix);
@@ -210,6 +205,9 @@ void LevelDbTargetCache::EnumerateSequenceNumbers(
 size_t LevelDbTargetCache::RemoveTargets(
     ListenSequenceNumber upper_bound,
     const std::unordered_map<model::TargetId, TargetData>& live_targets) {
+  LevelDbTransaction::ScopedReadProfile profile(
+      db_->current_transaction(),
+      LevelDbTransaction::ReadProfile::kBackground);
   std::string target_prefix = LevelDbTargetKey::KeyPrefix();
   auto it = db_->current_transaction()->NewIterator();
   it->Seek(target_prefix);
@@ -231,7 +229,10 @@ size_t LevelDbTargetCache::RemoveTargets(
       // Remove the DocumentKey to TargetId mapping
       RemoveMatchingKeysForTarget(target_id);
       // Remove the TargetId to Target mapping
+      db_->AdjustByteSize(-static_cast<int64_t>(it->value().size()));
       db_->current_transaction()->Delete(it->key());
+      db_->current_transaction()->Delete(
+          LevelDbTargetResultKey::Key(target_id));
 
       removed_targets.insert(target_id);
     }
@@ -254,27 +255,37 @@ void LevelDbTargetCache::AddMatchingKeys(const DocumentKeySet& keys,
   // buffer (and the parser will see all default values).
   std::string empty_buffer;
 
+  auto cached = matching_keys_.find(target_id);
   for (const DocumentKey& key : keys) {
     db_->current_transaction()->Put(
         LevelDbTargetDocumentKey::Key(target_id, key), empty_buffer);
     db_->current_transaction()->Put(
         LevelDbDocumentTargetKey::Key(key, target_id), empty_buffer);
     db_->reference_delegate()->AddReference(key);
+    if (cached != matching_keys_.end()) {
+      cached->second = cached->second.insert(key);
+    }
   }
 }
 
 void LevelDbTargetCache::RemoveMatchingKeys(const DocumentKeySet& keys,
                                             TargetId target_id) {
+  auto cached = matching_keys_.find(target_id);
   for (const DocumentKey& key : keys) {
     db_->current_transaction()->Delete(
         LevelDbTargetDocumentKey::Key(target_id, key));
     db_->current_transaction()->Delete(
         LevelDbDocumentTargetKey::Key(key, target_id));
     db_->reference_delegate()->RemoveReference(key);
+    if (cached != matching_keys_.end()) {
+      cached->second = cached->second.erase(key);
+    }
   }
 }
 
 void LevelDbTargetCache::RemoveMatchingKeysForTarget(TargetId target_id) {
+  matching_keys_.erase(target_id);
+
   std::string index_prefix = LevelDbTargetDocumentKey::KeyPrefix(target_id);
   auto index_iterator = db_->current_transaction()->NewIterator();
   index_iterator->Seek(index_prefix);
@@ -289,32 +300,39 @@ void LevelDbTargetCache::RemoveMatchingKeysForTarget(TargetId target_id) {
     }
     const DocumentKey& document_key = row_key.document_key();
 
-    // Delete both index rows
-    db_->current_transaction()->Delete(index_key);
+    // Delete both index rows. The rows of the target are contiguous, so they
+    // can go as one range deletion instead.
+    if (!db_->range_deletions()) {
+      db_->current_transaction()->Delete(index_key);
+    }
     db_->current_transaction()->Delete(
         LevelDbDocumentTargetKey::Key(document_key, target_id));
   }
+
+  if (db_->range_deletions()) {
+    db_->current_transaction()->DeleteRange(
+        index_prefix, util::PrefixSuccessor(index_prefix));
+  }
 }
 
 void LevelDbTargetCache::RemoveQueryTargetKeyForTargets(
     const std::unordered_set<TargetId>& target_ids) {
-  std::string index_prefix = LevelDbQueryTargetKey::KeyPrefix();
-  auto index_iterator = db_->current_transaction()->NewIterator();
-  index_iterator->Seek(index_prefix);
-
-  LevelDbQueryTargetKey row_key;
-  for (; index_iterator->Valid(); index_iterator->Next()) {
-    if (!row_key.Decode(index_iterator->key())) {
-      break;
-    }
-
-    if (target_ids.find(row_key.target_id()) != target_ids.end()) {
-      db_->current_transaction()->Delete(index_iterator->key());
+  for (TargetId target_id : target_ids) {
+    auto found = canonical_ids_by_target_id_.find(target_id);
+    if (found != canonical_ids_by_target_id_.end()) {
+      db_->current_transaction()->Delete(
+          LevelDbQueryTargetKey::Key(found->second, target_id));
     }
+    ForgetTarget(target_id);
   }
 }
 
 DocumentKeySet LevelDbTargetCache::GetMatchingKeys(TargetId target_id) {
+  auto cached = matching_keys_.find(target_id);
+  if (cached != matching_keys_.end()) {
+    return cached->second;
+  }
+
   std::string index_prefix = LevelDbTargetDocumentKey::KeyPrefix(target_id);
   auto index_iterator = db_->current_transaction()->NewIterator();
   index_iterator->Seek(index_prefix);
@@ -332,9 +350,14 @@ DocumentKeySet LevelDbTargetCache::GetMatchingKeys(TargetId target_id) {
     result = result.insert(row_key.document_key());
   }
 
+  matching_keys_[target_id] = result;
   return result;
 }
 
+void LevelDbTargetCache::ReleaseMatchingKeys() {
+  matching_keys_.clear();
+}
+
 bool LevelDbTargetCache::Contains(const DocumentKey& key) {
   // ignore sentinel rows when determining if a key belongs to a target.
   // Sentinel row just says the document exists, not that it's a member of any
@@ -356,6 +379,38 @@ bool LevelDbTargetCache::Contains(const DocumentKey& key) {
   return false;
 }
 
+void LevelDbTargetCache::SetLastResultKeys(
+    TargetId target_id, const std::vector<DocumentKey>& keys) {
+  std::string encoded;
+  for (const DocumentKey& key : keys) {
+    OrderedCode::WriteString(&encoded, key.path().CanonicalString());
+  }
+  db_->current_transaction()->Put(LevelDbTargetResultKey::Key(target_id),
+                                  encoded);
+}
+
+std::vector<DocumentKey> LevelDbTargetCache::GetLastResultKeys(
+    TargetId target_id) {
+  std::string encoded;
+  Status status = db_->current_transaction()->Get(
+      LevelDbTargetResultKey::Key(target_id), &encoded);
+  if (!status.ok()) {
+    return {};
+  }
+
+  std::vector<DocumentKey> result;
+  absl::string_view src = encoded;
+  std::string path;
+  while (!src.empty()) {
+    if (!OrderedCode::ReadString(&src, &path)) {
+      LOG_WARN("Ignoring the unreadable last result of target %s", target_id);
+      return {};
+    }
+    result.push_back(DocumentKey::FromPathString(path));
+  }
+  return result;
+}
+
 const SnapshotVersion& LevelDbTargetCache::GetLastRemoteSnapshotVersion()
     const {
   return last_remote_snapshot_version_;
@@ -370,6 +425,11 @@ void LevelDbTargetCache::SetLastRemoteSnapshotVersion(SnapshotVersion version) {
 
 void LevelDbTargetCache::EnumerateOrphanedDocuments(
     const OrphanedDocumentCallback& callback) {
+  // Garbage collection walks every document's targets, including within
+  // RemoveOrphanedDocuments() while it removes them.
+  LevelDbTransaction::ScopedReadProfile profile(
+      db_->current_transaction(),
+      LevelDbTransaction::ReadProfile::kBackground);
   std::string document_target_prefix = LevelDbDocumentTargetKey::KeyPrefix();
   auto it = db_->current_transaction()->NewIterator();
   it->Seek(document_target_prefix);
@@ -407,8 +467,17 @@ void LevelDbTargetCache::EnumerateOrphanedDocuments(
 void LevelDbTargetCache::Save(const TargetData& target_data) {
   TargetId target_id = target_data.target_id();
   std::string key = LevelDbTargetKey::Key(target_id);
-  db_->current_transaction()->Put(key,
-                                  serializer_->EncodeTargetData(target_data));
+  std::string encoded =
+      nanopb::MakeStdString(serializer_->EncodeTargetData(target_data));
+
+  std::string existing;
+  int64_t existing_size = 0;
+  if (db_->current_transaction()->Get(key, &existing).ok()) {
+    existing_size = static_cast<int64_t>(existing.size());
+  }
+  db_->AdjustByteSize(static_cast<int64_t>(encoded.size()) - existing_size);
+  db_->current_transaction()->Put(key, encoded);
+  targets_[target_id] = target_data;
 }
 
 bool LevelDbTargetCache::UpdateMetadata(const TargetData& target_data) {
@@ -452,6 +521,59 @@ TargetData LevelDbTargetCache::DecodeTarget(absl::string_view encoded) {
   return result;
 }
 
+absl::optional<TargetData> LevelDbTargetCache::ReadTarget(TargetId target_id) {
+  auto cached = targets_.find(target_id);
+  if (cached != targets_.end()) {
+    return cached->second;
+  }
+
+  std::string target_key = LevelDbTargetKey::Key(target_id);
+  std::string encoded;
+  if (!db_->current_transaction()->Get(target_key, &encoded).ok()) {
+    LOG_WARN("Dangling query-target reference found: target %s is missing",
+             DescribeKey(target_key));
+    return absl::nullopt;
+  }
+
+  TargetData target_data = DecodeTarget(encoded);
+  targets_[target_id] = target_data;
+  return target_data;
+}
+
+void LevelDbTargetCache::IndexTarget(const std::string& canonical_id,
+                                     TargetId target_id) {
+  std::vector<TargetId>& target_ids = target_ids_by_canonical_id_[canonical_id];
+  if (std::find(target_ids.begin(), target_ids.end(), target_id) ==
+      target_ids.end()) {
+    // Keep the order of the index rows, which are sorted by target ID.
+    target_ids.insert(
+        std::upper_bound(target_ids.begin(), target_ids.end(), target_id),
+        target_id);
+  }
+  canonical_ids_by_target_id_[target_id] = canonical_id;
+}
+
+void LevelDbTargetCache::ForgetTarget(TargetId target_id) {
+  targets_.erase(target_id);
+
+  auto found = canonical_ids_by_target_id_.find(target_id);
+  if (found == canonical_ids_by_target_id_.end()) {
+    return;
+  }
+
+  auto ids_iter = target_ids_by_canonical_id_.find(found->second);
+  if (ids_iter != target_ids_by_canonical_id_.end()) {
+    std::vector<TargetId>& target_ids = ids_iter->second;
+    target_ids.erase(
+        std::remove(target_ids.begin(), target_ids.end(), target_id),
+        target_ids.end());
+    if (target_ids.empty()) {
+      target_ids_by_canonical_id_.erase(ids_iter);
+    }
+  }
+  canonical_ids_by_target_id_.erase(found);
+}
+
 }  // namespace local
 }  // namespace firestore
 }  // namespace firebase
@@ -17,11 +17,15 @@
 #ifndef FIRESTORE_CORE_SRC_LOCAL_LEVELDB_TARGET_CACHE_H_
 #define FIRESTORE_CORE_SRC_LOCAL_LEVELDB_TARGET_CACHE_H_
 
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "Firestore/Protos/nanopb/firestore/local/target.nanopb.h"
 #include "Firestore/core/src/local/target_cache.h"
+#include "Firestore/core/src/local/target_data.h"
+#include "Firestore/core/src/model/document_key_set.h"
 #include "Firestore/core/src/model/model_fwd.h"
 #include "Firestore/core/src/model/snapshot_version.h"
 #include "Firestore/core/src/nanopb/message.h"
@@ -99,11 +103,23 @@ class LevelDbTargetCache : public TargetCache {
 
   model::DocumentKeySet GetMatchingKeys(model::TargetId target_id) override;
 
+  /**
+   * Forgets the matching keys kept in memory; they are read back from the
+   * target-document index when next needed.
+   */
+  void ReleaseMatchingKeys();
+
   /**
    * Checks to see if there are any references to a document with the given key.
    */
   bool Contains(const model::DocumentKey& key) override;
 
+  void SetLastResultKeys(model::TargetId target_id,
+                         const std::vector<model::DocumentKey>& keys) override;
+
+  std::vector<model::DocumentKey> GetLastResultKeys(
+      model::TargetId target_id) override;
+
   // Other methods and accessors
   size_t size() const override {
     return metadata_->target_count;
@@ -141,6 +157,18 @@ class LevelDbTargetCache : public TargetCache {
    */
   TargetData DecodeTarget(absl::string_view encoded);
 
+  /**
+   * Returns the target with the given ID, decoding it only if it hasn't been
+   * read or written since startup.
+   */
+  absl::optional<TargetData> ReadTarget(model::TargetId target_id);
+
+  /** Adds a row of the query-target index to the in-memory copy. */
+  void IndexTarget(const std::string& canonical_id, model::TargetId target_id);
+
+  /** Removes the target from the in-memory targets and query-target index. */
+  void ForgetTarget(model::TargetId target_id);
+
   /** Removes the given targets from the query to target mapping. */
   void RemoveQueryTargetKeyForTargets(
       const std::unordered_set<model::TargetId>& target_id);
@@ -154,6 +182,25 @@ class LevelDbTargetCache : public TargetCache {
   nanopb::Message<firestore_client_TargetGlobal> metadata_;
 
   model::SnapshotVersion last_remote_snapshot_version_;
+
+  /**
+   * An in-memory copy of the query-target index, loaded in `Start()`, so that
+   * looking up a target by its canonical ID doesn't scan LevelDB. Canonical
+   * IDs are not required to be unique, so each may map to several targets.
+   */
+  std::unordered_map<std::string, std::vector<model::TargetId>>
+      target_ids_by_canonical_id_;
+  std::unordered_map<model::TargetId, std::string> canonical_ids_by_target_id_;
+
+  /** The targets read or written since startup, by target ID. */
+  std::unordered_map<model::TargetId, TargetData> targets_;
+
+  /**
+   * The keys matching each target whose keys were read since startup, kept in
+   * step with the target-document index. DocumentKeySet shares its structure
+   * between copies, so returning one of these doesn't rebuild it.
+   */
+  std::unordered_map<model::TargetId, model::DocumentKeySet> matching_keys_;
 };
 
 }  // namespace local
@@ -38,10 +38,10 @@ namespace firestore {
 namespace local {
 
 LevelDbTransaction::Iterator::Iterator(LevelDbTransaction* txn)
-    : db_iter_(txn->db_->NewIterator(txn->read_options_)),
+    : db_iter_(txn->db_->NewIterator(txn->profile_read_options_)),
       last_version_(txn->version_),
       txn_(txn),
-      mutations_iter_(txn->mutations_.begin()),
+      mutation_index_(0),
       current_(),
       is_mutation_(false),
       // Iterator doesn't really point to anything yet, so is
@@ -49,8 +49,20 @@ LevelDbTransaction::Iterator::Iterator(LevelDbTransaction* txn)
       is_valid_(false) {
 }
 
+bool LevelDbTransaction::Iterator::MutationValid() {
+  return mutation_index_ < txn_->write_set_.SortedEntries().size();
+}
+
+void LevelDbTransaction::Iterator::SkipDeletedMutations() {
+  const auto& entries = txn_->write_set_.SortedEntries();
+  while (mutation_index_ < entries.size() &&
+         entries[mutation_index_].deleted) {
+    ++mutation_index_;
+  }
+}
+
 void LevelDbTransaction::Iterator::UpdateCurrent() {
-  bool mutation_is_valid = mutations_iter_ != txn_->mutations_.end();
+  bool mutation_is_valid = MutationValid();
   is_valid_ = mutation_is_valid || db_iter_->Valid();
 
   if (is_valid_) {
@@ -63,10 +75,15 @@ void LevelDbTransaction::Iterator::UpdateCurrent() {
       // than the current mutation key, we are looking at a mutation next. It's
       // either sooner in the iteration or directly shadowing the underlying
       // committed value in leveldb.
-      is_mutation_ = db_iter_->key().compare(mutations_iter_->first) >= 0;
+      const LevelDbWriteSet::Entry& mutation =
+          txn_->write_set_.SortedEntries()[mutation_index_];
+      is_mutation_ = db_iter_->key().compare(Slice(
+                         mutation.key.data(), mutation.key.size())) >= 0;
     }
     if (is_mutation_) {
-      current_ = *mutations_iter_;
+      const LevelDbWriteSet::Entry& mutation =
+          txn_->write_set_.SortedEntries()[mutation_index_];
+      current_ = {std::string(mutation.key), std::string(mutation.value)};
     } else {
       current_ = {db_iter_->key().ToString(), db_iter_->value().ToString()};
     }
@@ -77,11 +94,11 @@ void LevelDbTransaction::Iterator::Seek(const std::string& key) {
   db_iter_->Seek(key);
   HARD_ASSERT(db_iter_->status().ok(), "leveldb iterator reported an error: %s",
               db_iter_->status().ToString());
-  for (; db_iter_->Valid() && IsDeleted(db_iter_->key()); db_iter_->Next()) {
-  }
+  SkipDeletedLDB();
   HARD_ASSERT(db_iter_->status().ok(), "leveldb iterator reported an error: %s",
               db_iter_->status().ToString());
-  mutations_iter_ = txn_->mutations_.lower_bound(key);
+  mutation_index_ = txn_->write_set_.LowerBound(key);
+  SkipDeletedMutations();
   UpdateCurrent();
   last_version_ = txn_->version_;
 }
@@ -96,8 +113,26 @@ const std::string& LevelDbTransaction::Iterator::value() const {
   return current_.second;
 }
 
-bool LevelDbTransaction::Iterator::IsDeleted(leveldb::Slice slice) {
-  return txn_->deletions_.find(slice.ToString()) != txn_->deletions_.end();
+void LevelDbTransaction::Iterator::SkipDeletedLDB() {
+  const LevelDbWriteSet& write_set = txn_->write_set_;
+  while (db_iter_->Valid()) {
+    Slice slice = db_iter_->key();
+    absl::string_view key(slice.data(), slice.size());
+    const LevelDbWriteSet::Entry* entry = write_set.Find(key);
+    if (entry != nullptr) {
+      if (!entry->deleted) {
+        return;
+      }
+      db_iter_->Next();
+      continue;
+    }
+    const LevelDbWriteSet::Range* range = write_set.FindDeletedRange(key);
+    if (range == nullptr) {
+      return;
+    }
+    // Pending puts in the range are returned from the write set.
+    db_iter_->Seek(Slice(range->end.data(), range->end.size()));
+  }
 }
 
 bool LevelDbTransaction::Iterator::SyncToTransaction() {
@@ -114,9 +149,8 @@ bool LevelDbTransaction::Iterator::SyncToTransaction() {
 }
 
 void LevelDbTransaction::Iterator::AdvanceLDB() {
-  do {
-    db_iter_->Next();
-  } while (db_iter_->Valid() && IsDeleted(db_iter_->key()));
+  db_iter_->Next();
+  SkipDeletedLDB();
   HARD_ASSERT(db_iter_->status().ok(), "leveldb iterator reported an error: %s",
               db_iter_->status().ToString());
 }
@@ -127,10 +161,14 @@ void LevelDbTransaction::Iterator::Next() {
   if (!advanced && is_valid_) {
     if (is_mutation_) {
       // A mutation might be shadowing leveldb. If so, advance both.
-      if (db_iter_->Valid() && db_iter_->key() == mutations_iter_->first) {
+      const LevelDbWriteSet::Entry& mutation =
+          txn_->write_set_.SortedEntries()[mutation_index_];
+      if (db_iter_->Valid() &&
+          db_iter_->key() == Slice(mutation.key.data(), mutation.key.size())) {
         AdvanceLDB();
       }
-      ++mutations_iter_;
+      ++mutation_index_;
+      SkipDeletedMutations();
     } else {
       AdvanceLDB();
     }
@@ -144,10 +182,37 @@ LevelDbTransaction::LevelDbTransaction(DB* db,
                                        const WriteOptions& write_options)
     : db_(NOT_NULL(db)),
       read_options_(read_options),
+      profile_read_options_(read_options),
       write_options_(write_options),
       label_(label) {
 }
 
+LevelDbTransaction::ScopedReadProfile::ScopedReadProfile(
+    LevelDbTransaction* txn, ReadProfile profile)
+    : txn_(NOT_NULL(txn)), previous_(txn->read_profile()) {
+  txn_->SetReadProfile(profile);
+}
+
+LevelDbTransaction::ScopedReadProfile::~ScopedReadProfile() {
+  txn_->SetReadProfile(previous_);
+}
+
+void LevelDbTransaction::SetReadProfile(ReadProfile profile) {
+  read_profile_ = profile;
+  profile_read_options_ = read_options_;
+  switch (profile) {
+    case ReadProfile::kDefault:
+      break;
+    case ReadProfile::kScan:
+      profile_read_options_.fill_cache = false;
+      break;
+    case ReadProfile::kBackground:
+      profile_read_options_.fill_cache = false;
+      profile_read_options_.verify_checksums = false;
+      break;
+  }
+}
+
 const ReadOptions& LevelDbTransaction::DefaultReadOptions() {
   static_assert(std::is_trivially_destructible<ReadOptions>::value,
                 "ReadOptions should be trivially-destructible; otherwise, it "
@@ -155,6 +220,9 @@ const ReadOptions& LevelDbTransaction::DefaultReadOptions() {
   static ReadOptions options = [] {
     ReadOptions read_options;
     read_options.verify_checksums = true;
+    // Collection scans walk many consecutive blocks; read them in batches
+    // once an iterator is seen moving through them in order.
+    read_options.readahead_blocks = 8;
     return read_options;
   }();
   return options;
@@ -168,9 +236,13 @@ const WriteOptions& LevelDbTransaction::DefaultWriteOptions() {
   return options;
 }
 
-void LevelDbTransaction::Put(std::string key, std::string value) {
-  deletions_.erase(key);
-  mutations_[std::move(key)] = std::move(value);
+void LevelDbTransaction::Put(absl::string_view key, absl::string_view value) {
+  write_set_.Put(key, value);
+  version_++;
+}
+
+void LevelDbTransaction::Put(absl::string_view key, const absl::Cord& value) {
+  write_set_.Put(key, value);
   version_++;
 }
 
@@ -180,35 +252,103 @@ LevelDbTransaction::NewIterator() {
 }
 
 Status LevelDbTransaction::Get(absl::string_view key, std::string* value) {
-  std::string key_string(key);
-  if (deletions_.find(key_string) != deletions_.end()) {
-    return Status::NotFound(key_string + " is not present in the transaction");
+  const LevelDbWriteSet::Entry* entry = write_set_.Find(key);
+  if (entry == nullptr && write_set_.FindDeletedRange(key) != nullptr) {
+    return Status::NotFound(
+        absl::StrCat(key, " is not present in the transaction"));
+  } else if (entry == nullptr) {
+    return db_->Get(profile_read_options_, Slice(key.data(), key.size()),
+                    value);
+  } else if (entry->deleted) {
+    return Status::NotFound(
+        absl::StrCat(key, " is not present in the transaction"));
   } else {
-    Mutations::iterator iter{mutations_.find(key_string)};
-    if (iter != mutations_.end()) {
-      *value = iter->second;
-      return Status::OK();
+    value->assign(entry->value.data(), entry->value.size());
+    return Status::OK();
+  }
+}
+
+Status LevelDbTransaction::Get(absl::string_view key,
+                               leveldb::PinnableSlice* value) {
+  const LevelDbWriteSet::Entry* entry = write_set_.Find(key);
+  if (entry == nullptr && write_set_.FindDeletedRange(key) != nullptr) {
+    return Status::NotFound(
+        absl::StrCat(key, " is not present in the transaction"));
+  } else if (entry == nullptr) {
+    return db_->Get(profile_read_options_, Slice(key.data(), key.size()),
+                    value);
+  } else if (entry->deleted) {
+    return Status::NotFound(
+        absl::StrCat(key, " is not present in the transaction"));
+  } else {
+    value->PinSelf(Slice(entry->value.data(), entry->value.size()));
+    return Status::OK();
+  }
+}
+
+std::vector<Status> LevelDbTransaction::MultiGet(
+    const std::vector<std::string>& keys, std::vector<std::string>* values) {
+  values->clear();
+  values->resize(keys.size());
+  std::vector<Status> statuses(keys.size());
+
+  std::vector<leveldb::Slice> db_keys;
+  std::vector<size_t> db_indices;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    const std::string& key = keys[i];
+    const LevelDbWriteSet::Entry* entry = write_set_.Find(key);
+    if (entry == nullptr && write_set_.FindDeletedRange(key) != nullptr) {
+      statuses[i] =
+          Status::NotFound(key + " is not present in the transaction");
+    } else if (entry == nullptr) {
+      db_keys.emplace_back(key);
+      db_indices.push_back(i);
+    } else if (entry->deleted) {
+      statuses[i] =
+          Status::NotFound(key + " is not present in the transaction");
     } else {
-      return db_->Get(read_options_, key_string, value);
+      (*values)[i].assign(entry->value.data(), entry->value.size());
+    }
+  }
+
+  if (!db_keys.empty()) {
+    std::vector<std::string> db_values;
+    std::vector<Status> db_statuses =
+        db_->MultiGet(profile_read_options_, db_keys, &db_values);
+    for (size_t j = 0; j < db_indices.size(); ++j) {
+      statuses[db_indices[j]] = db_statuses[j];
+      (*values)[db_indices[j]] = std::move(db_values[j]);
     }
   }
+  return statuses;
 }
 
 void LevelDbTransaction::Delete(absl::string_view key) {
-  std::string to_delete(key);
-  deletions_.insert(to_delete);
-  mutations_.erase(to_delete);
+  write_set_.Delete(key);
+  version_++;
+}
+
+void LevelDbTransaction::DeleteRange(absl::string_view begin,
+                                     absl::string_view end) {
+  write_set_.DeleteRange(begin, end);
   version_++;
 }
 
 void LevelDbTransaction::Commit() {
+  // Writing the batch in key order also inserts into the memtable in order.
+  // Range deletions come first, as the entries override them.
   WriteBatch batch;
-  for (const auto& deletion : deletions_) {
-    batch.Delete(deletion);
+  for (const LevelDbWriteSet::Range& range : write_set_.deleted_ranges()) {
+    batch.DeleteRange(Slice(range.begin.data(), range.begin.size()),
+                      Slice(range.end.data(), range.end.size()));
   }
-
-  for (const auto& entry : mutations_) {
-    batch.Put(entry.first, entry.second);
+  for (const LevelDbWriteSet::Entry& entry : write_set_.SortedEntries()) {
+    Slice key(entry.key.data(), entry.key.size());
+    if (entry.deleted) {
+      batch.Delete(key);
+    } else {
+      batch.Put(key, Slice(entry.value.data(), entry.value.size()));
+    }
   }
 
   LOG_DEBUG("Committing transaction: %s", ToString());
@@ -220,18 +360,27 @@ void LevelDbTransaction::Commit() {
 
 std::string LevelDbTransaction::ToString() {
   std::string dest = absl::StrCat("<LevelDbTransaction ", label_, ": ");
-  size_t changes = deletions_.size() + mutations_.size();
+  const auto& entries = write_set_.SortedEntries();
+  size_t changes = entries.size();
   size_t bytes = 0;  // accumulator for size of individual mutations.
   dest += std::to_string(changes) + " changes ";
   std::string items;  // accumulator for individual changes.
-  for (const auto& deletion : deletions_) {
-    absl::StrAppend(&items, "\n  - Delete ", DescribeKey(deletion));
-  }
-  for (const auto& entry : mutations_) {
-    size_t change_bytes = entry.second.size();
-    bytes += change_bytes;
-    absl::StrAppend(&items, "\n  - Put ", DescribeKey(entry.first), " (",
-                    change_bytes, " bytes)");
+  for (const auto& range : write_set_.deleted_ranges()) {
+    absl::StrAppend(&items, "\n  - DeleteRange ", DescribeKey(range.begin),
+                    " to ", DescribeKey(range.end));
+  }
+  for (const auto& entry : entries) {
+    if (entry.deleted) {
+      absl::StrAppend(&items, "\n  - Delete ", DescribeKey(entry.key));
+    }
+  }
+  for (const auto& entry : entries) {
+    if (!entry.deleted) {
+      size_t change_bytes = entry.value.size();
+      bytes += change_bytes;
+      absl::StrAppend(&items, "\n  - Put ", DescribeKey(entry.key), " (",
+                      change_bytes, " bytes)");
+    }
   }
   absl::StrAppend(&dest, "(", bytes, " bytes):", items, ">");
   return dest;
@@ -18,17 +18,19 @@
 #define FIRESTORE_CORE_SRC_LOCAL_LEVELDB_TRANSACTION_H_
 
 #include <cstdint>
-#include <map>
 #include <memory>
-#include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "Firestore/core/src/local/leveldb_write_set.h"
 #include "Firestore/core/src/nanopb/byte_string.h"
 #include "Firestore/core/src/nanopb/message.h"
 #include "Firestore/core/src/nanopb/writer.h"
+#include "absl/strings/cord.h"
 #include "absl/strings/string_view.h"
 #include "leveldb/db.h"
+#include "leveldb/pinnable_slice.h"
 
 namespace firebase {
 namespace firestore {
@@ -40,9 +42,6 @@ namespace local {
  * changes and committed values.
  */
 class LevelDbTransaction {
-  using Deletions = std::set<std::string>;
-  using Mutations = std::map<std::string, std::string>;
-
  public:
   /**
    * Iterator iterates over a merged view of pending changes from the
@@ -87,10 +86,20 @@ class LevelDbTransaction {
     void AdvanceLDB();
 
     /**
-     * Returns true if the given slice matches a key present in the deletions_
-     * set.
+     * Moves the leveldb iterator forward past the keys the transaction
+     * deletes, seeking past each deleted range rather than stepping through
+     * it.
+     */
+    void SkipDeletedLDB();
+
+    /**
+     * Moves `mutation_index_` forward past deletions, which shadow leveldb
+     * entries but are not entries themselves.
      */
-    bool IsDeleted(leveldb::Slice slice);
+    void SkipDeletedMutations();
+
+    /** Returns true if `mutation_index_` points to a pending put. */
+    bool MutationValid();
 
     /**
      * Syncs with the underlying transaction. If the transaction has been
@@ -112,19 +121,60 @@ class LevelDbTransaction {
     int32_t last_version_;
     // The underlying transaction.
     LevelDbTransaction* txn_;
-    Mutations::iterator mutations_iter_;
+    // Index of the next pending put in the sorted entries of the write set.
+    size_t mutation_index_;
     // We save the current key and value so that once an iterator is Valid(), it
     // remains so at least until the next call to Seek() or Next(), even if the
     // underlying data is deleted.
     std::pair<std::string, std::string> current_;
-    // True if current_ represents an entry in the mutations_ map, rather than
-    // committed data.
+    // True if current_ represents a pending put, rather than committed data.
     bool is_mutation_;
     // True if the iterator pointed to a valid entry the last time Next() or
     // Seek() was called.
     bool is_valid_;
   };
 
+  /**
+   * How the reads of an operation use leveldb's block cache, so that
+   * operations that read much of the database once do not push out the
+   * blocks that point lookups keep coming back to.
+   */
+  enum class ReadProfile {
+    /** Point lookups and short range reads, whose blocks are cached. */
+    kDefault,
+    /**
+     * Scans of a whole collection, which read each block once: blocks that
+     * are not cached already are not added to the cache.
+     */
+    kScan,
+    /**
+     * Scans by background work like garbage collection and index backfill.
+     * Like `kScan`, and blocks read from disk are not checksummed either.
+     * Cached blocks were verified when they were read, the ones read here
+     * are not cached for other reads, and records that do not decode are
+     * still reported by the callers.
+     */
+    kBackground,
+  };
+
+  /**
+   * Sets the read profile of a transaction while in scope, and restores the
+   * previous one afterwards. Must be used on the thread that runs the
+   * transaction, outside of any reads running in parallel.
+   */
+  class ScopedReadProfile {
+   public:
+    ScopedReadProfile(LevelDbTransaction* txn, ReadProfile profile);
+    ~ScopedReadProfile();
+
+    ScopedReadProfile(const ScopedReadProfile&) = delete;
+    ScopedReadProfile& operator=(const ScopedReadProfile&) = delete;
+
+   private:
+    LevelDbTransaction* txn_;
+    ReadProfile previous_;
+  };
+
   explicit LevelDbTransaction(
       leveldb::DB* db,
       absl::string_view label,
@@ -146,28 +196,60 @@ class LevelDbTransaction {
   static const leveldb::WriteOptions& DefaultWriteOptions();
 
   size_t changed_keys() const {
-    return mutations_.size() + deletions_.size();
+    return write_set_.size();
+  }
+
+  ReadProfile read_profile() const {
+    return read_profile_;
+  }
+
+  /**
+   * Returns true if the transaction reads a leveldb snapshot rather than the
+   * latest committed state.
+   */
+  bool reads_snapshot() const {
+    return read_options_.snapshot != nullptr;
   }
 
+  /**
+   * Applies `profile` to the reads made through this transaction from now
+   * on, including the ones of iterators created after the call.
+   */
+  void SetReadProfile(ReadProfile profile);
+
   /**
    * Remove the database entry (if any) for "key".  It is not an error if "key"
    * did not exist in the database.
    */
   void Delete(absl::string_view key);
 
+  /**
+   * Removes every database entry in [begin, end), and the pending changes to
+   * those keys, with a single range deletion rather than one per key. Keys
+   * in the range that are set afterwards are kept.
+   */
+  void DeleteRange(absl::string_view begin, absl::string_view end);
+
   /**
    * Schedules the row identified by `key` to be set to `value` when this
    * transaction commits.
    */
-  void Put(std::string key, std::string value);
+  void Put(absl::string_view key, absl::string_view value);
+
+  /**
+   * Like `Put(key, value)` for a value held in a `Cord`, such as one that
+   * shares the buffers of a network response. The chunks are copied once,
+   * into the transaction, without flattening the cord first.
+   */
+  void Put(absl::string_view key, const absl::Cord& value);
 
   /**
    * Schedules the row identified by `key` to be set to the given protocol
    * buffer message when this transaction commits.
    */
   template <typename T>
-  void Put(std::string key, const nanopb::Message<T>& message) {
-    Put(std::move(key), MakeStdString(message));
+  void Put(absl::string_view key, const nanopb::Message<T>& message) {
+    Put(key, MakeStdString(message));
   }
 
   /**
@@ -178,6 +260,21 @@ class LevelDbTransaction {
    */
   leveldb::Status Get(absl::string_view key, std::string* value);
 
+  /**
+   * Like `Get`, but a value read from leveldb points straight into the block
+   * cache rather than at a copy of it, which is kept in memory until `value`
+   * is reset or destroyed. Suits large values that are decoded in place.
+   */
+  leveldb::Status Get(absl::string_view key, leveldb::PinnableSlice* value);
+
+  /**
+   * Like `Get`, for all of the given keys at once. Sets `(*values)[i]` to the
+   * value of `keys[i]` and returns the status of each lookup. Keys without
+   * pending changes are read from leveldb with a single `DB::MultiGet` call.
+   */
+  std::vector<leveldb::Status> MultiGet(const std::vector<std::string>& keys,
+                                        std::vector<std::string>* values);
+
   /**
    * Returns a new Iterator over the pending changes in this transaction, merged
    * with the existing values already in leveldb.
@@ -194,9 +291,11 @@ class LevelDbTransaction {
 
  private:
   leveldb::DB* db_ = nullptr;
-  Mutations mutations_;
-  Deletions deletions_;
+  LevelDbWriteSet write_set_;
   leveldb::ReadOptions read_options_;
+  // read_options_ with read_profile_ applied.
+  leveldb::ReadOptions profile_read_options_;
+  ReadProfile read_profile_ = ReadProfile::kDefault;
   leveldb::WriteOptions write_options_;
   int32_t version_ = 0;
   std::string label_;
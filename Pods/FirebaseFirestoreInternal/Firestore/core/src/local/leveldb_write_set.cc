@@ -0,0 +1,190 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/local/leveldb_write_set.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+
+namespace firebase {
+namespace firestore {
+namespace local {
+namespace {
+
+constexpr size_t kBlockSize = 4096;
+
+/** The tail is never merged while it is smaller than this. */
+constexpr size_t kMinTailSize = 16;
+
+bool KeyLess(const LevelDbWriteSet::Entry& entry, absl::string_view key) {
+  return entry.key < key;
+}
+
+bool EntryLess(const LevelDbWriteSet::Entry& lhs,
+               const LevelDbWriteSet::Entry& rhs) {
+  return lhs.key < rhs.key;
+}
+
+/**
+ * Returns the entry for `key` in the sorted `entries`, or nullptr. Works on
+ * both const and mutable vectors.
+ */
+template <typename Entries>
+auto FindIn(Entries& entries, absl::string_view key) -> decltype(&entries[0]) {
+  auto found = std::lower_bound(entries.begin(), entries.end(), key, KeyLess);
+  if (found == entries.end() || found->key != key) {
+    return nullptr;
+  }
+  return &*found;
+}
+
+}  // namespace
+
+const LevelDbWriteSet::Entry* LevelDbWriteSet::Find(
+    absl::string_view key) const {
+  const Entry* entry = FindIn(tail_, key);
+  return entry != nullptr ? entry : FindIn(run_, key);
+}
+
+void LevelDbWriteSet::Put(absl::string_view key, absl::string_view value) {
+  Set(key, value, /* deleted= */ false);
+}
+
+void LevelDbWriteSet::Put(absl::string_view key, const absl::Cord& value) {
+  SetStored(key, Store(value), /* deleted= */ false);
+}
+
+void LevelDbWriteSet::Delete(absl::string_view key) {
+  Set(key, absl::string_view(), /* deleted= */ true);
+}
+
+void LevelDbWriteSet::DeleteRange(absl::string_view begin,
+                                  absl::string_view end) {
+  if (begin >= end) {
+    return;
+  }
+  MergeTail();
+  auto first = std::lower_bound(run_.begin(), run_.end(), begin, KeyLess);
+  auto last = std::lower_bound(first, run_.end(), end, KeyLess);
+  run_.erase(first, last);
+  deleted_ranges_.push_back(Range{Store(begin), Store(end)});
+}
+
+const LevelDbWriteSet::Range* LevelDbWriteSet::FindDeletedRange(
+    absl::string_view key) const {
+  for (const Range& range : deleted_ranges_) {
+    if (key >= range.begin && key < range.end) {
+      return &range;
+    }
+  }
+  return nullptr;
+}
+
+void LevelDbWriteSet::SetStored(absl::string_view key,
+                                absl::string_view stored_value,
+                                bool deleted) {
+  // Tails are short, so look there first.
+  Entry* entry = FindIn(tail_, key);
+  if (entry == nullptr) {
+    entry = FindIn(run_, key);
+  }
+  if (entry != nullptr) {
+    // The bytes of the previous value stay allocated until the write set is
+    // destroyed.
+    entry->value = stored_value;
+    entry->deleted = deleted;
+    return;
+  }
+
+  Entry added{Store(key), stored_value, deleted};
+  tail_.insert(std::lower_bound(tail_.begin(), tail_.end(), key, KeyLess),
+               added);
+  size_t tail_limit = std::max(
+      kMinTailSize,
+      static_cast<size_t>(std::sqrt(static_cast<double>(run_.size()))));
+  if (tail_.size() > tail_limit) {
+    MergeTail();
+  }
+}
+
+const std::vector<LevelDbWriteSet::Entry>& LevelDbWriteSet::SortedEntries() {
+  MergeTail();
+  return run_;
+}
+
+size_t LevelDbWriteSet::LowerBound(absl::string_view key) {
+  const std::vector<Entry>& entries = SortedEntries();
+  return static_cast<size_t>(
+      std::lower_bound(entries.begin(), entries.end(), key, KeyLess) -
+      entries.begin());
+}
+
+void LevelDbWriteSet::MergeTail() {
+  if (tail_.empty()) {
+    return;
+  }
+  size_t middle = run_.size();
+  run_.insert(run_.end(), tail_.begin(), tail_.end());
+  std::inplace_merge(run_.begin(), run_.begin() + middle, run_.end(),
+                     EntryLess);
+  tail_.clear();
+}
+
+absl::string_view LevelDbWriteSet::Store(absl::string_view bytes) {
+  if (bytes.empty()) {
+    return absl::string_view();
+  }
+  char* result = Allocate(bytes.size());
+  std::memcpy(result, bytes.data(), bytes.size());
+  return absl::string_view(result, bytes.size());
+}
+
+absl::string_view LevelDbWriteSet::Store(const absl::Cord& bytes) {
+  if (bytes.empty()) {
+    return absl::string_view();
+  }
+  char* result = Allocate(bytes.size());
+  char* out = result;
+  for (absl::string_view chunk : bytes.Chunks()) {
+    std::memcpy(out, chunk.data(), chunk.size());
+    out += chunk.size();
+  }
+  return absl::string_view(result, bytes.size());
+}
+
+char* LevelDbWriteSet::Allocate(size_t size) {
+  if (size > alloc_bytes_remaining_) {
+    if (size > kBlockSize / 4) {
+      // Large values get a block of their own, so that the rest of the
+      // current block is not wasted.
+      blocks_.emplace_back(new char[size]);
+      return blocks_.back().get();
+    }
+    blocks_.emplace_back(new char[kBlockSize]);
+    alloc_ptr_ = blocks_.back().get();
+    alloc_bytes_remaining_ = kBlockSize;
+  }
+  char* result = alloc_ptr_;
+  alloc_ptr_ += size;
+  alloc_bytes_remaining_ -= size;
+  return result;
+}
+
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_LOCAL_LEVELDB_WRITE_SET_H_
+#define FIRESTORE_CORE_SRC_LOCAL_LEVELDB_WRITE_SET_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "absl/strings/cord.h"
+#include "absl/strings/string_view.h"
+
+namespace firebase {
+namespace firestore {
+namespace local {
+
+/**
+ * The pending puts and deletes of a LevelDbTransaction, sorted by key, and
+ * the ranges of keys it deletes.
+ *
+ * Keys and values are copied into large blocks owned by the write set, and
+ * entries are kept in sorted vectors, so a write costs no allocation of its
+ * own. New keys are added to a small sorted tail, which is merged into the
+ * main run once it grows past the square root of the run's size; writes to
+ * keys that already have an entry update it in place.
+ */
+class LevelDbWriteSet {
+ public:
+  struct Entry {
+    absl::string_view key;
+    absl::string_view value;
+    /** True if the key is to be deleted rather than set to `value`. */
+    bool deleted;
+  };
+
+  /** The keys in [begin, end). */
+  struct Range {
+    absl::string_view begin;
+    absl::string_view end;
+  };
+
+  LevelDbWriteSet() = default;
+
+  LevelDbWriteSet(const LevelDbWriteSet& other) = delete;
+
+  LevelDbWriteSet& operator=(const LevelDbWriteSet& other) = delete;
+
+  /** Returns the entry for `key`, or nullptr if there is none. */
+  const Entry* Find(absl::string_view key) const;
+
+  /** Schedules `key` to be set to `value`. */
+  void Put(absl::string_view key, absl::string_view value);
+
+  /**
+   * Schedules `key` to be set to `value`, copying the chunks of `value`
+   * straight into the write set rather than flattening it first.
+   */
+  void Put(absl::string_view key, const absl::Cord& value);
+
+  /** Schedules `key` to be deleted. */
+  void Delete(absl::string_view key);
+
+  /**
+   * Schedules every key in [begin, end) to be deleted, and drops the pending
+   * changes of those keys. The range is deleted before any of the entries
+   * are written, so keys in it that are set later still end up set.
+   */
+  void DeleteRange(absl::string_view begin, absl::string_view end);
+
+  /**
+   * Returns a range scheduled for deletion that holds `key`, or nullptr if
+   * there is none. Keys with an entry of their own are not affected by the
+   * ranges, so look those up with `Find()` first.
+   */
+  const Range* FindDeletedRange(absl::string_view key) const;
+
+  const std::vector<Range>& deleted_ranges() const {
+    return deleted_ranges_;
+  }
+
+  /** Returns the number of keys with pending changes. */
+  size_t size() const {
+    return run_.size() + tail_.size();
+  }
+
+  /**
+   * Returns every entry in key order. Invalidated by the next call to
+   * `Put()` or `Delete()`.
+   */
+  const std::vector<Entry>& SortedEntries();
+
+  /**
+   * Returns the index in `SortedEntries()` of the first entry whose key is
+   * not less than `key`.
+   */
+  size_t LowerBound(absl::string_view key);
+
+ private:
+  /** Adds or updates the entry for `key`. */
+  void Set(absl::string_view key, absl::string_view value, bool deleted) {
+    SetStored(key, Store(value), deleted);
+  }
+
+  /**
+   * Like `Set()`, for a `stored_value` that is already in storage owned by
+   * this write set.
+   */
+  void SetStored(absl::string_view key,
+                 absl::string_view stored_value,
+                 bool deleted);
+
+  /** Merges `tail_` into `run_`. */
+  void MergeTail();
+
+  /** Copies `bytes` into storage owned by this write set. */
+  absl::string_view Store(absl::string_view bytes);
+  absl::string_view Store(const absl::Cord& bytes);
+
+  /** Returns `size` uninitialized bytes owned by this write set. */
+  char* Allocate(size_t size);
+
+  std::vector<Entry> run_;
+  // Entries for keys that are not in run_, sorted by key.
+  std::vector<Entry> tail_;
+  // Usually empty; transactions delete few ranges, if any.
+  std::vector<Range> deleted_ranges_;
+
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  char* alloc_ptr_ = nullptr;
+  size_t alloc_bytes_remaining_ = 0;
+};
+
+}  // namespace local
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_LOCAL_LEVELDB_WRITE_SET_H_
@@ -383,7 +383,9 @@ DocumentMap LocalDocumentsView::RetrieveMatchingLocalDocuments(
     }
   }
 
-  DocumentMap results;
+  // The remote documents are in key order, so the results can be built in one
+  // pass.
+  std::vector<std::pair<DocumentKey, Document>> results;
   for (const auto& entry : remote_documents) {
     const DocumentKey& key = entry.first;
     MutableDocument doc = entry.second;  // Make a copy to modify
@@ -397,11 +399,11 @@ DocumentMap LocalDocumentsView::RetrieveMatchingLocalDocuments(
 
     // Finally, insert the documents that match the filter
     if (matcher(doc)) {
-      results = results.insert(key, std::move(doc));
+      results.emplace_back(key, std::move(doc));
     }
   }
 
-  return results;
+  return DocumentMap::FromSorted(results);
 }
 
 // Handles querying the local view for pipelines.
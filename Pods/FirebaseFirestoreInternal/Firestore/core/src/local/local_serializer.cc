@@ -19,6 +19,7 @@
 #include <cstdlib>
 #include <limits>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 
@@ -36,13 +37,16 @@
 #include "Firestore/core/src/model/field_path.h"
 #include "Firestore/core/src/model/mutable_document.h"
 #include "Firestore/core/src/model/mutation_batch.h"
+#include "Firestore/core/src/model/object_value.h"
 #include "Firestore/core/src/model/snapshot_version.h"
 #include "Firestore/core/src/nanopb/byte_string.h"
 #include "Firestore/core/src/nanopb/message.h"
 #include "Firestore/core/src/nanopb/nanopb_util.h"
+#include "Firestore/core/src/nanopb/reader.h"
 #include "Firestore/core/src/util/hard_assert.h"
 #include "Firestore/core/src/util/statusor.h"
 #include "Firestore/core/src/util/string_format.h"
+#include "Firestore/core/src/util/trace.h"
 #include "absl/types/span.h"
 
 namespace firebase {
@@ -55,6 +59,7 @@ using bundle::BundleMetadata;
 using bundle::NamedQuery;
 using core::Target;
 using model::DeepClone;
+using model::DocumentKey;
 using model::FieldPath;
 using model::FieldTransform;
 using model::MutableDocument;
@@ -67,6 +72,7 @@ using nanopb::ByteString;
 using nanopb::CheckedSize;
 using nanopb::CopyBytesArray;
 using nanopb::MakeArray;
+using nanopb::MakeStringView;
 using nanopb::Message;
 using nanopb::Reader;
 using nanopb::ReleaseFieldOwnership;
@@ -76,10 +82,67 @@ using nanopb::Writer;
 using util::Status;
 using util::StringFormat;
 
+/**
+ * Takes the next field of a protobuf message off the front of `bytes`,
+ * setting `contents` to the bytes of a length-delimited field. Returns false
+ * if `bytes` does not start with a well-formed field.
+ */
+bool ReadField(absl::string_view* bytes,
+               uint32_t* tag,
+               pb_wire_type_t* wire_type,
+               absl::string_view* contents) {
+  auto read_varint = [bytes](uint64_t* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64 && !bytes->empty(); shift += 7) {
+      auto byte = static_cast<uint8_t>(bytes->front());
+      bytes->remove_prefix(1);
+      *value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  uint64_t key;
+  if (!read_varint(&key)) {
+    return false;
+  }
+  *tag = static_cast<uint32_t>(key >> 3);
+  *wire_type = static_cast<pb_wire_type_t>(key & 0x07);
+
+  uint64_t size;
+  switch (*wire_type) {
+    case PB_WT_VARINT:
+      *contents = {};
+      return read_varint(&size);
+    case PB_WT_64BIT:
+      size = 8;
+      break;
+    case PB_WT_32BIT:
+      size = 4;
+      break;
+    case PB_WT_STRING:
+      if (!read_varint(&size)) {
+        return false;
+      }
+      break;
+    default:
+      return false;
+  }
+  if (size > bytes->size()) {
+    return false;
+  }
+  *contents = bytes->substr(0, static_cast<size_t>(size));
+  bytes->remove_prefix(static_cast<size_t>(size));
+  return true;
+}
+
 }  // namespace
 
 Message<firestore_client_MaybeDocument> LocalSerializer::EncodeMaybeDocument(
     const MutableDocument& document) const {
+  util::TraceSpan span(util::OperationTrace::Stage::kSerializer);
   Message<firestore_client_MaybeDocument> result;
 
   if (document.is_found_document()) {
@@ -108,19 +171,102 @@ Message<firestore_client_MaybeDocument> LocalSerializer::EncodeMaybeDocument(
 
 MutableDocument LocalSerializer::DecodeMaybeDocument(
     Reader* reader, firestore_client_MaybeDocument& proto) const {
+  return DecodeMaybeDocument(reader, proto, nullptr);
+}
+
+MutableDocument LocalSerializer::DecodeMaybeDocument(
+    Reader* reader,
+    firestore_client_MaybeDocument& proto,
+    const DocumentKey& key) const {
+  return DecodeMaybeDocument(reader, proto, &key);
+}
+
+absl::optional<MutableDocument> LocalSerializer::DecodePartialDocument(
+    absl::string_view encoded,
+    const DocumentKey& key,
+    const std::set<std::string>& field_names) const {
+  uint32_t tag;
+  pb_wire_type_t wire_type;
+  absl::string_view contents;
+
+  // MaybeDocument.document, unless a later field of the oneof replaces it.
+  absl::optional<absl::string_view> document;
+  while (!encoded.empty()) {
+    if (!ReadField(&encoded, &tag, &wire_type, &contents)) {
+      return absl::nullopt;
+    }
+    if (tag == firestore_client_MaybeDocument_document_tag) {
+      document = contents;
+    } else if (tag == firestore_client_MaybeDocument_no_document_tag ||
+               tag == firestore_client_MaybeDocument_unknown_document_tag) {
+      document = absl::nullopt;
+    }
+  }
+  if (!document) {
+    return MutableDocument::InvalidDocument(key);
+  }
+
+  model::TransformMap fields;
+  while (!document->empty()) {
+    if (!ReadField(&*document, &tag, &wire_type, &contents)) {
+      return absl::nullopt;
+    }
+    if (tag != google_firestore_v1_Document_fields_tag) {
+      continue;
+    }
+
+    // Document.FieldsEntry, whose value is only decoded if it is named.
+    absl::string_view entry = contents;
+    absl::optional<std::string> name;
+    absl::string_view value;
+    while (!entry.empty()) {
+      if (!ReadField(&entry, &tag, &wire_type, &contents)) {
+        return absl::nullopt;
+      }
+      if (tag == google_firestore_v1_Document_FieldsEntry_key_tag) {
+        name = std::string(contents);
+      } else if (tag == google_firestore_v1_Document_FieldsEntry_value_tag) {
+        value = contents;
+      }
+    }
+    if (!name || field_names.find(*name) == field_names.end()) {
+      continue;
+    }
+
+    nanopb::StringReader reader{value};
+    auto message = Message<google_firestore_v1_Value>::TryParse(&reader);
+    if (!reader.ok()) {
+      return absl::nullopt;
+    }
+    fields[FieldPath{*std::move(name)}] = std::move(message);
+  }
+
+  ObjectValue data;
+  data.SetAll(std::move(fields));
+  return MutableDocument::FoundDocument(key, SnapshotVersion::None(),
+                                        std::move(data));
+}
+
+MutableDocument LocalSerializer::DecodeMaybeDocument(
+    Reader* reader,
+    firestore_client_MaybeDocument& proto,
+    const DocumentKey* known_key) const {
   if (!reader->status().ok()) return {};
 
+  util::TraceSpan span(util::OperationTrace::Stage::kSerializer);
   switch (proto.which_document_type) {
     case firestore_client_MaybeDocument_document_tag:
       return DecodeDocument(reader, proto.document,
-                            SafeReadBoolean(proto.has_committed_mutations));
+                            SafeReadBoolean(proto.has_committed_mutations),
+                            known_key);
 
     case firestore_client_MaybeDocument_no_document_tag:
       return DecodeNoDocument(reader, proto.no_document,
-                              SafeReadBoolean(proto.has_committed_mutations));
+                              SafeReadBoolean(proto.has_committed_mutations),
+                              known_key);
 
     case firestore_client_MaybeDocument_unknown_document_tag:
-      return DecodeUnknownDocument(reader, proto.unknown_document);
+      return DecodeUnknownDocument(reader, proto.unknown_document, known_key);
 
     default:
       reader->Fail(
@@ -161,17 +307,33 @@ google_firestore_v1_Document LocalSerializer::EncodeDocument(
   return result;
 }
 
+DocumentKey LocalSerializer::DecodeDocumentName(
+    Reader* reader,
+    const pb_bytes_array_t* name,
+    const DocumentKey* known_key) const {
+  if (known_key == nullptr) {
+    return rpc_serializer_.DecodeKey(reader->context(), name);
+  }
+
+  if (!rpc_serializer_.IsEncodedKey(MakeStringView(name), *known_key)) {
+    reader->Fail(StringFormat("Read document has name '%s' instead of '%s'",
+                              MakeStringView(name), known_key->ToString()));
+  }
+  return *known_key;
+}
+
 MutableDocument LocalSerializer::DecodeDocument(
     Reader* reader,
     google_firestore_v1_Document& proto,
-    bool has_committed_mutations) const {
+    bool has_committed_mutations,
+    const DocumentKey* known_key) const {
   ObjectValue fields =
       ObjectValue::FromFieldsEntry(proto.fields, proto.fields_count);
   SnapshotVersion version =
       rpc_serializer_.DecodeVersion(reader->context(), proto.update_time);
 
   MutableDocument document = MutableDocument::FoundDocument(
-      rpc_serializer_.DecodeKey(reader->context(), proto.name), version,
+      DecodeDocumentName(reader, proto.name, known_key), version,
       std::move(fields));
   if (has_committed_mutations) {
     document.SetHasCommittedMutations();
@@ -192,12 +354,13 @@ firestore_client_NoDocument LocalSerializer::EncodeNoDocument(
 MutableDocument LocalSerializer::DecodeNoDocument(
     Reader* reader,
     const firestore_client_NoDocument& proto,
-    bool has_committed_mutations) const {
+    bool has_committed_mutations,
+    const DocumentKey* known_key) const {
   SnapshotVersion version =
       rpc_serializer_.DecodeVersion(reader->context(), proto.read_time);
 
   MutableDocument document = MutableDocument::NoDocument(
-      rpc_serializer_.DecodeKey(reader->context(), proto.name), version);
+      DecodeDocumentName(reader, proto.name, known_key), version);
   if (has_committed_mutations) {
     document.SetHasCommittedMutations();
   }
@@ -215,12 +378,14 @@ firestore_client_UnknownDocument LocalSerializer::EncodeUnknownDocument(
 }
 
 MutableDocument LocalSerializer::DecodeUnknownDocument(
-    Reader* reader, const firestore_client_UnknownDocument& proto) const {
+    Reader* reader,
+    const firestore_client_UnknownDocument& proto,
+    const DocumentKey* known_key) const {
   SnapshotVersion version =
       rpc_serializer_.DecodeVersion(reader->context(), proto.version);
 
   return MutableDocument::UnknownDocument(
-      rpc_serializer_.DecodeKey(reader->context(), proto.name), version);
+      DecodeDocumentName(reader, proto.name, known_key), version);
 }
 
 Message<firestore_client_Target> LocalSerializer::EncodeTargetData(
@@ -481,6 +646,10 @@ std::vector<model::Segment> LocalSerializer::DecodeFieldIndexSegments(
   std::vector<model::Segment> result;
   for (size_t i = 0; i < index.fields_count; ++i) {
     const auto& field = index.fields[i];
+    if (field.which_value_mode == 0) {
+      // A stored field, see `DecodeFieldIndexStoredFields()`.
+      continue;
+    }
 
     util::StatusOr<FieldPath> field_path =
         FieldPath::FromServerFormat(nanopb::MakeString(field.field_path));
@@ -508,9 +677,33 @@ std::vector<model::Segment> LocalSerializer::DecodeFieldIndexSegments(
   return result;
 }
 
+std::vector<model::FieldPath> LocalSerializer::DecodeFieldIndexStoredFields(
+    nanopb::Reader* reader, google_firestore_admin_v1_Index& index) const {
+  std::vector<model::FieldPath> result;
+  for (size_t i = 0; i < index.fields_count; ++i) {
+    const auto& field = index.fields[i];
+    if (field.which_value_mode != 0) {
+      continue;
+    }
+
+    util::StatusOr<FieldPath> field_path =
+        FieldPath::FromServerFormat(nanopb::MakeString(field.field_path));
+    if (!field_path.ok()) {
+      reader->Fail(
+          StringFormat("Failed to read field path for stored field: %s",
+                       nanopb::MakeString(field.field_path)));
+      return {};
+    }
+    result.push_back(std::move(field_path).ValueOrDie());
+  }
+
+  return result;
+}
+
 nanopb::Message<google_firestore_admin_v1_Index>
 LocalSerializer::EncodeFieldIndexSegments(
-    const std::vector<model::Segment>& segments) const {
+    const std::vector<model::Segment>& segments,
+    const std::vector<model::FieldPath>& stored_fields) const {
   Message<google_firestore_admin_v1_Index> result;
 
   result->query_scope =
@@ -518,10 +711,11 @@ LocalSerializer::EncodeFieldIndexSegments(
 
   // Explicitly cast the result of segments.size() to suppress compiler warnings
   // about implicit conversion resulting in potential loss of precision.
-  const auto segments_size = static_cast<pb_size_t>(segments.size());
-  result->fields_count = segments_size;
+  const auto fields_size =
+      static_cast<pb_size_t>(segments.size() + stored_fields.size());
+  result->fields_count = fields_size;
   result->fields =
-      MakeArray<google_firestore_admin_v1_Index_IndexField>(segments_size);
+      MakeArray<google_firestore_admin_v1_Index_IndexField>(fields_size);
   int i = 0;
   for (const auto& segment : segments) {
     google_firestore_admin_v1_Index_IndexField field;
@@ -557,6 +751,13 @@ LocalSerializer::EncodeFieldIndexSegments(
     ++i;
   }
 
+  for (const auto& field_path : stored_fields) {
+    google_firestore_admin_v1_Index_IndexField field{};
+    field.field_path = nanopb::MakeBytesArray(field_path.CanonicalString());
+    result->fields[i] = std::move(field);
+    ++i;
+  }
+
   return result;
 }
 
@@ -18,6 +18,8 @@
 #define FIRESTORE_CORE_SRC_LOCAL_LOCAL_SERIALIZER_H_
 
 #include <memory>
+#include <set>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -26,6 +28,8 @@
 #include "Firestore/core/src/model/types.h"
 #include "Firestore/core/src/remote/serializer.h"
 #include "Firestore/core/src/util/status_fwd.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 
 namespace firebase {
 namespace firestore {
@@ -100,6 +104,31 @@ class LocalSerializer {
   model::MutableDocument DecodeMaybeDocument(
       nanopb::Reader* reader, firestore_client_MaybeDocument& proto) const;
 
+  /**
+   * Decodes a MaybeDocument that was stored under `key`. The name in the proto
+   * is checked against `key` rather than parsed, which saves copying each of
+   * its segments for every document read back from the cache.
+   */
+  model::MutableDocument DecodeMaybeDocument(
+      nanopb::Reader* reader,
+      firestore_client_MaybeDocument& proto,
+      const model::DocumentKey& key) const;
+
+  /**
+   * Decodes only the top-level fields in `field_names` of the document in an
+   * encoded MaybeDocument stored under `key`, skipping over the bytes of the
+   * other fields. Suits testing a document against a query before decoding
+   * it in full.
+   *
+   * Returns a found document with just those fields and no version, an
+   * invalid document if the MaybeDocument does not hold a found document, or
+   * nothing if it cannot be parsed.
+   */
+  absl::optional<model::MutableDocument> DecodePartialDocument(
+      absl::string_view encoded,
+      const model::DocumentKey& key,
+      const std::set<std::string>& field_names) const;
+
   /**
    * @brief Encodes a TargetData to the equivalent nanopb proto, representing a
    * ::firestore::proto::Target, for local storage.
@@ -151,12 +180,22 @@ class LocalSerializer {
   bundle::NamedQuery DecodeNamedQuery(nanopb::Reader* reader,
                                       firestore_NamedQuery& proto) const;
 
+  /**
+   * Encodes the segments of a field index and the fields it stores. Stored
+   * fields are encoded as index fields without an order or array config,
+   * after the segments.
+   */
   nanopb::Message<google_firestore_admin_v1_Index> EncodeFieldIndexSegments(
-      const std::vector<model::Segment>& segments) const;
+      const std::vector<model::Segment>& segments,
+      const std::vector<model::FieldPath>& stored_fields = {}) const;
 
   std::vector<model::Segment> DecodeFieldIndexSegments(
       nanopb::Reader* reader, google_firestore_admin_v1_Index& index) const;
 
+  /** Decodes the stored fields of a field index. */
+  std::vector<model::FieldPath> DecodeFieldIndexStoredFields(
+      nanopb::Reader* reader, google_firestore_admin_v1_Index& index) const;
+
   /**
    * @brief Encodes a `Mutation` to the equivalent nanopb proto for local
    * storage.
@@ -184,9 +223,25 @@ class LocalSerializer {
   google_firestore_v1_Document EncodeDocument(
       const model::MutableDocument& doc) const;
 
-  model::MutableDocument DecodeDocument(nanopb::Reader* reader,
-                                        google_firestore_v1_Document& proto,
-                                        bool has_committed_mutations) const;
+  model::MutableDocument DecodeMaybeDocument(
+      nanopb::Reader* reader,
+      firestore_client_MaybeDocument& proto,
+      const model::DocumentKey* known_key) const;
+
+  /**
+   * Decodes the name of a document, or only validates it against `known_key`
+   * if that is not null.
+   */
+  model::DocumentKey DecodeDocumentName(
+      nanopb::Reader* reader,
+      const pb_bytes_array_t* name,
+      const model::DocumentKey* known_key) const;
+
+  model::MutableDocument DecodeDocument(
+      nanopb::Reader* reader,
+      google_firestore_v1_Document& proto,
+      bool has_committed_mutations,
+      const model::DocumentKey* known_key) const;
 
   firestore_client_NoDocument EncodeNoDocument(
       const model::MutableDocument& no_doc) const;
@@ -194,13 +249,15 @@ class LocalSerializer {
   model::MutableDocument DecodeNoDocument(
       nanopb::Reader* reader,
       const firestore_client_NoDocument& proto,
-      bool has_committed_mutations) const;
+      bool has_committed_mutations,
+      const model::DocumentKey* known_key) const;
 
   firestore_client_UnknownDocument EncodeUnknownDocument(
       const model::MutableDocument& unknown_doc) const;
   model::MutableDocument DecodeUnknownDocument(
       nanopb::Reader* reader,
-      const firestore_client_UnknownDocument& proto) const;
+      const firestore_client_UnknownDocument& proto,
+      const model::DocumentKey* known_key) const;
 
   firestore_BundledQuery EncodeBundledQuery(
       const bundle::BundledQuery& query) const;
@@ -16,6 +16,7 @@
 
 #include "Firestore/core/src/local/local_store.h"
 
+#include <algorithm>
 #include <set>
 #include <string>
 #include <unordered_set>
@@ -40,6 +41,7 @@
 #include "Firestore/core/src/model/mutation_batch_result.h"
 #include "Firestore/core/src/model/patch_mutation.h"
 #include "Firestore/core/src/remote/remote_event.h"
+#include "Firestore/core/src/util/defer.h"
 #include "Firestore/core/src/util/log.h"
 #include "Firestore/core/src/util/set_util.h"
 #include "Firestore/core/src/util/to_string.h"
@@ -116,6 +118,7 @@ LocalStore::LocalStore(Persistence* persistence,
   local_documents_ = absl::make_unique<LocalDocumentsView>(
       remote_document_cache_, mutation_queue_, document_overlay_cache_,
       index_manager_);
+  ResetConcurrentDocuments();
   remote_document_cache_->SetIndexManager(index_manager_);
   overlay_migration_manager_ =
       persistence_->GetOverlayMigrationManager(initial_user);
@@ -161,6 +164,14 @@ DocumentMap LocalStore::HandleUserChange(const User& user) {
   StartMutationQueue();
   StartIndexManager();
 
+  // The overlays of users other than the one the client started with are
+  // only created once they are needed.
+  overlay_migration_manager_ = persistence_->GetOverlayMigrationManager(user);
+  overlay_migration_manager_->Run();
+
+  // Concurrent reads that started before this point keep their view of the
+  // previous user; releasing its components waits for them.
+  ResetConcurrentDocuments();
   persistence_->ReleaseOtherUserSpecificComponents(user.uid());
 
   return persistence_->Run("NewBatches", [&] {
@@ -266,6 +277,34 @@ DocumentMap LocalStore::AcknowledgeBatch(
   });
 }
 
+DocumentMap LocalStore::AcknowledgeBatches(
+    const std::vector<MutationBatchResult>& batch_results) {
+  return persistence_->Run("Acknowledge batches", [&] {
+    DocumentKeySet changed_keys;
+    DocumentKeySet keys_with_transform_results;
+    for (const MutationBatchResult& batch_result : batch_results) {
+      const MutationBatch& batch = batch_result.batch();
+      mutation_queue_->AcknowledgeBatch(batch, batch_result.stream_token());
+      ApplyBatchResult(batch_result);
+      document_overlay_cache_->RemoveOverlaysForBatchId(batch.batch_id());
+
+      for (const DocumentKey& key : batch.keys()) {
+        changed_keys = changed_keys.insert(key);
+      }
+      for (const DocumentKey& key : GetKeysWithTransformResults(batch_result)) {
+        keys_with_transform_results = keys_with_transform_results.insert(key);
+      }
+    }
+    mutation_queue_->PerformConsistencyCheck();
+
+    // Overlays only depend on the batches that are still queued, so the keys
+    // of all acknowledged batches can be recalculated together.
+    local_documents_->RecalculateAndSaveOverlays(keys_with_transform_results);
+
+    return local_documents_->GetDocuments(changed_keys);
+  });
+}
+
 void LocalStore::ApplyBatchResult(const MutationBatchResult& batch_result) {
   const MutationBatch& batch = batch_result.batch();
   DocumentKeySet doc_keys = batch.keys();
@@ -324,6 +363,24 @@ model::DocumentMap LocalStore::ApplyRemoteEvent(
   const SnapshotVersion& last_remote_version =
       target_cache_->GetLastRemoteSnapshotVersion();
 
+  // Large events commit their documents ahead of the targets, so that the
+  // transactions stay small. Until the targets are written, the persisted
+  // resume tokens still predate the event, and a restart replays it; the
+  // documents committed already are then ignored as outdated.
+  const DocumentUpdateMap& document_updates = remote_event.document_updates();
+  bool chunked = remote_event_chunk_size_ > 0 &&
+                 document_updates.size() > remote_event_chunk_size_;
+  DocumentChangeResult chunked_result;
+  if (chunked) {
+    chunked_apply_mutex_.WriterLock();
+    chunked_result = PopulateDocumentChangesInChunks(
+        document_updates, DocumentVersionMap(),
+        remote_event.snapshot_version());
+  }
+  util::Defer unlock([&] {
+    if (chunked) chunked_apply_mutex_.WriterUnlock();
+  });
+
   return persistence_->Run("Apply remote event", [&] {
     // TODO(gsoltis): move the sequence number into the reference delegate.
     ListenSequenceNumber sequence_number =
@@ -363,22 +420,30 @@ model::DocumentMap LocalStore::ApplyRemoteEvent(
       target_data_by_target_[target_id] = new_target_data;
 
       // Update the target data if there are target changes (or if sufficient
-      // time has passed since the last update).
-      if (ShouldPersistTargetData(new_target_data, old_target_data, change)) {
+      // time has passed since the last update). Every resume token of a target
+      // that is not current yet is a checkpoint of its initial sync, so it is
+      // always persisted: an initial sync interrupted by the app being
+      // terminated then resumes from the last consistent snapshot instead of
+      // from the last one that happened to be written.
+      bool is_sync_checkpoint = !change.current() && !resume_token.empty();
+      if (is_sync_checkpoint ||
+          ShouldPersistTargetData(new_target_data, old_target_data, change)) {
         target_cache_->UpdateTarget(new_target_data);
       }
     }
 
     const DocumentKeySet& limbo_documents =
         remote_event.limbo_document_changes();
-    for (const auto& kv : remote_event.document_updates()) {
+    for (const auto& kv : document_updates) {
       // If this was a limbo resolution, make sure we mark when it was accessed.
       if (limbo_documents.contains(kv.first)) {
         persistence_->reference_delegate()->UpdateLimboDocument(kv.first);
       }
     }
 
-    auto result = PopulateDocumentChanges(remote_event.document_updates(),
+    DocumentChangeResult result =
+        chunked ? std::move(chunked_result)
+                : PopulateDocumentChanges(document_updates,
                                           DocumentVersionMap(),
                                           remote_event.snapshot_version());
 
@@ -400,6 +465,29 @@ model::DocumentMap LocalStore::ApplyRemoteEvent(
   });
 }
 
+DocumentMap LocalStore::ApplyLimboDocumentLookup(
+    const DocumentUpdateMap& documents) {
+  DocumentVersionMap read_times;
+  for (const auto& kv : documents) {
+    const MutableDocument& doc = kv.second;
+    read_times.emplace(kv.first, doc.read_time() != SnapshotVersion::None()
+                                     ? doc.read_time()
+                                     : doc.version());
+  }
+
+  return persistence_->Run("Apply limbo document lookup", [&] {
+    for (const auto& kv : documents) {
+      persistence_->reference_delegate()->UpdateLimboDocument(kv.first);
+    }
+
+    DocumentChangeResult result = PopulateDocumentChanges(
+        documents, read_times, SnapshotVersion::None());
+    return local_documents_->GetLocalViewOfDocuments(
+        std::move(result.changed_docs),
+        std::move(result.existence_changed_keys));
+  });
+}
+
 bool LocalStore::ShouldPersistTargetData(const TargetData& new_target_data,
                                          const TargetData& old_target_data,
                                          const TargetChange& change) const {
@@ -460,6 +548,11 @@ void LocalStore::NotifyLocalViewChanges(
       local_view_references_.RemoveReferences(view_change.removed_keys(),
                                               target_id);
 
+      if (view_change.result_keys()) {
+        target_cache_->SetLastResultKeys(target_id,
+                                         *view_change.result_keys());
+      }
+
       if (!view_change.is_from_cache()) {
         const auto& entry = target_data_by_target_.find(target_id);
         HARD_ASSERT(
@@ -496,6 +589,68 @@ const Document LocalStore::ReadDocument(const DocumentKey& key) {
                            [&] { return local_documents_->GetDocument(key); });
 }
 
+bool LocalStore::SupportsConcurrentReads() const {
+  return persistence_->SupportsConcurrentReads();
+}
+
+template <typename F>
+auto LocalStore::RunConcurrentRead(absl::string_view label, F block)
+    -> decltype(block()) {
+  // Once the snapshot is taken, a chunked application may start: the snapshot
+  // does not see any of it.
+  chunked_apply_mutex_.ReaderLock();
+  bool locked = true;
+  util::Defer unlock([&] {
+    if (locked) chunked_apply_mutex_.ReaderUnlock();
+  });
+  return persistence_->RunReadOnly(label, [&] {
+    chunked_apply_mutex_.ReaderUnlock();
+    locked = false;
+    return block();
+  });
+}
+
+Document LocalStore::ReadDocumentConcurrently(const DocumentKey& key) {
+  return RunConcurrentRead("ReadDocumentConcurrently", [&] {
+    return concurrent_documents()->GetDocument(key);
+  });
+}
+
+bool LocalStore::CanExecuteQueryConcurrently(const Query& query) {
+  if (query.IsCollectionGroupQuery()) return false;
+
+  const std::string& canonical_id = query.ToTarget().CanonicalId();
+  std::lock_guard<std::mutex> lock(concurrent_documents_mutex_);
+  return !concurrent_index_manager_->HasFieldIndexes(
+             query.path().last_segment()) &&
+         active_target_canonical_ids_.count(canonical_id) == 0;
+}
+
+QueryResult LocalStore::ExecuteQueryConcurrently(const Query& query) {
+  HARD_ASSERT(!query.IsCollectionGroupQuery(),
+              "Query can not be executed concurrently: %s", query.ToString());
+  return RunConcurrentRead("ExecuteQueryConcurrently", [&] {
+    DocumentMap documents =
+        concurrent_documents()->GetDocumentsMatchingQuery(
+            core::QueryOrPipeline(query), model::IndexOffset::None());
+    return QueryResult(std::move(documents), DocumentKeySet{});
+  });
+}
+
+std::shared_ptr<LocalDocumentsView> LocalStore::concurrent_documents() {
+  std::lock_guard<std::mutex> lock(concurrent_documents_mutex_);
+  return concurrent_documents_;
+}
+
+void LocalStore::ResetConcurrentDocuments() {
+  auto documents = std::make_shared<LocalDocumentsView>(
+      remote_document_cache_, mutation_queue_, document_overlay_cache_,
+      index_manager_);
+  std::lock_guard<std::mutex> lock(concurrent_documents_mutex_);
+  concurrent_documents_ = std::move(documents);
+  concurrent_index_manager_ = index_manager_;
+}
+
 BatchId LocalStore::GetHighestUnacknowledgedBatchId() {
   return persistence_->Run("GetHighestUnacknowledgedBatchId", [&] {
     return mutation_queue_->GetHighestUnacknowledgedBatchId();
@@ -523,6 +678,11 @@ TargetData LocalStore::AllocateTarget(
   if (target_data_by_target_.find(target_id) == target_data_by_target_.end()) {
     target_data_by_target_[target_id] = target_data;
     target_id_by_target_[target_data.target_or_pipeline()] = target_id;
+    if (!target_data.target_or_pipeline().IsPipeline()) {
+      std::lock_guard<std::mutex> lock(concurrent_documents_mutex_);
+      active_target_canonical_ids_.insert(
+          target_data.target_or_pipeline().target().CanonicalId());
+    }
   }
 
   return target_data;
@@ -550,6 +710,11 @@ void LocalStore::ReleaseTarget(TargetId target_id) {
     persistence_->reference_delegate()->RemoveTarget(target_data);
     target_data_by_target_.erase(target_id);
     target_id_by_target_.erase(target_data.target_or_pipeline());
+    if (!target_data.target_or_pipeline().IsPipeline()) {
+      std::lock_guard<std::mutex> lock(concurrent_documents_mutex_);
+      active_target_canonical_ids_.erase(
+          target_data.target_or_pipeline().target().CanonicalId());
+    }
   });
 }
 
@@ -576,6 +741,32 @@ QueryResult LocalStore::ExecuteQuery(
   });
 }
 
+absl::optional<QueryResult> LocalStore::ReadLastResult(
+    const core::QueryOrPipeline& query_or_pipeline) {
+  return persistence_->Run(
+      "ReadLastResult", [&]() -> absl::optional<QueryResult> {
+        absl::optional<TargetData> target_data =
+            GetTargetData(query_or_pipeline.ToTargetOrPipeline());
+        if (!target_data) {
+          return absl::nullopt;
+        }
+
+        TargetId target_id = target_data->target_id();
+        std::vector<DocumentKey> keys =
+            target_cache_->GetLastResultKeys(target_id);
+        if (keys.empty()) {
+          return absl::nullopt;
+        }
+
+        DocumentKeySet key_set;
+        for (const DocumentKey& key : keys) {
+          key_set = key_set.insert(key);
+        }
+        return QueryResult(local_documents_->GetDocuments(key_set),
+                           target_cache_->GetMatchingKeys(target_id));
+      });
+}
+
 DocumentKeySet LocalStore::GetRemoteDocumentKeys(TargetId target_id) {
   return persistence_->Run("RemoteDocumentKeysForTarget", [&] {
     return target_cache_->GetMatchingKeys(target_id);
@@ -594,6 +785,14 @@ size_t LocalStore::Backfill() const {
   });
 }
 
+void LocalStore::SetAdaptiveBackfillEnabled(bool enabled) {
+  index_backfiller_->SetAdaptiveBudgetEnabled(enabled);
+}
+
+void LocalStore::SetBackfillShouldYield(std::function<bool()> should_yield) {
+  index_backfiller_->SetShouldYield(std::move(should_yield));
+}
+
 bool LocalStore::HasNewerBundle(const bundle::BundleMetadata& metadata) {
   return persistence_->Run("Has newer bundle", [&] {
     absl::optional<bundle::BundleMetadata> cached_metadata =
@@ -614,25 +813,43 @@ DocumentMap LocalStore::ApplyBundledDocuments(
   // they will not get garbage collected right away.
   TargetData umbrella_target =
       AllocateTarget(core::TargetOrPipeline(NewUmbrellaTarget(bundle_id)));
-  return persistence_->Run("Apply bundle documents", [&] {
-    DocumentKeySet keys;
-    DocumentUpdateMap document_updates;
-    DocumentVersionMap versions;
-
-    for (const auto& kv : bundled_documents) {
-      const DocumentKey& key = kv.first;
-      const auto& doc = kv.second;
-      if (doc.is_found_document()) {
-        keys = keys.insert(key);
-      }
-      document_updates.emplace(key, doc);
-      versions.emplace(key, doc.version());
+
+  DocumentKeySet keys;
+  DocumentUpdateMap document_updates;
+  DocumentVersionMap versions;
+  for (const auto& kv : bundled_documents) {
+    const DocumentKey& key = kv.first;
+    const auto& doc = kv.second;
+    if (doc.is_found_document()) {
+      keys = keys.insert(key);
     }
+    document_updates.emplace(key, doc);
+    versions.emplace(key, doc.version());
+  }
+
+  // Large bundles commit their documents ahead of the umbrella target, like
+  // large remote events. The bundle is only saved once it has been applied,
+  // so a restart loads it again; the documents committed already are then
+  // ignored as outdated.
+  bool chunked = remote_event_chunk_size_ > 0 &&
+                 document_updates.size() > remote_event_chunk_size_;
+  DocumentChangeResult chunked_result;
+  if (chunked) {
+    chunked_apply_mutex_.WriterLock();
+    chunked_result = PopulateDocumentChangesInChunks(document_updates, versions,
+                                                     SnapshotVersion::None());
+  }
+  util::Defer unlock([&] {
+    if (chunked) chunked_apply_mutex_.WriterUnlock();
+  });
 
+  return persistence_->Run("Apply bundle documents", [&] {
     target_cache_->RemoveMatchingKeysForTarget(umbrella_target.target_id());
     target_cache_->AddMatchingKeys(keys, umbrella_target.target_id());
 
-    auto result = PopulateDocumentChanges(document_updates, versions,
+    DocumentChangeResult result =
+        chunked ? std::move(chunked_result)
+                : PopulateDocumentChanges(document_updates, versions,
                                           SnapshotVersion::None());
     return local_documents_->GetLocalViewOfDocuments(
         std::move(result.changed_docs),
@@ -679,6 +896,12 @@ absl::optional<bundle::NamedQuery> LocalStore::GetNamedQuery(
                            [&] { return bundle_cache_->GetNamedQuery(query); });
 }
 
+absl::optional<bundle::NamedQuery> LocalStore::GetNamedQueryConcurrently(
+    const std::string& query) {
+  return RunConcurrentRead("Get named query concurrently",
+                           [&] { return bundle_cache_->GetNamedQuery(query); });
+}
+
 void LocalStore::ConfigureFieldIndexes(
     std::vector<FieldIndex> new_field_indexes) {
   // This lambda function takes a rvalue vector as parameter,
@@ -780,6 +1003,54 @@ LocalStore::DocumentChangeResult LocalStore::PopulateDocumentChanges(
   return {std::move(changed_docs), std::move(condition_changed)};
 }
 
+LocalStore::DocumentChangeResult LocalStore::PopulateDocumentChangesInChunks(
+    const DocumentUpdateMap& documents,
+    const DocumentVersionMap& document_versions,
+    const SnapshotVersion& global_version) {
+  MutableDocumentMap changed_docs;
+  DocumentKeySet condition_changed;
+
+  DocumentUpdateMap chunk;
+  auto commit_chunk = [&] {
+    persistence_->Run("Apply remote event documents", [&] {
+      DocumentChangeResult result =
+          PopulateDocumentChanges(chunk, document_versions, global_version);
+      for (const auto& kv : result.changed_docs) {
+        changed_docs = changed_docs.insert(kv.first, kv.second);
+      }
+      for (const DocumentKey& key : result.existence_changed_keys) {
+        condition_changed = condition_changed.insert(key);
+      }
+    });
+    chunk.clear();
+  };
+
+  // Chunks of contiguous keys write to disjoint ranges of the remote document
+  // table, which keeps the tables that LevelDB flushes for them from
+  // overlapping.
+  std::vector<const DocumentUpdateMap::value_type*> sorted;
+  sorted.reserve(documents.size());
+  for (const auto& kv : documents) {
+    sorted.push_back(&kv);
+  }
+  std::sort(sorted.begin(), sorted.end(),
+            [](const DocumentUpdateMap::value_type* lhs,
+               const DocumentUpdateMap::value_type* rhs) {
+              return lhs->first < rhs->first;
+            });
+
+  for (const DocumentUpdateMap::value_type* kv : sorted) {
+    chunk.insert(*kv);
+    if (chunk.size() >= remote_event_chunk_size_) {
+      commit_chunk();
+    }
+  }
+  if (!chunk.empty()) {
+    commit_chunk();
+  }
+  return {std::move(changed_docs), std::move(condition_changed)};
+}
+
 }  // namespace local
 }  // namespace firestore
 }  // namespace firebase
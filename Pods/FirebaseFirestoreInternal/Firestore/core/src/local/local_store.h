@@ -17,9 +17,12 @@
 #ifndef FIRESTORE_CORE_SRC_LOCAL_LOCAL_STORE_H_
 #define FIRESTORE_CORE_SRC_LOCAL_LOCAL_STORE_H_
 
+#include <functional>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "Firestore/core/src/bundle/bundle_callback.h"
@@ -33,6 +36,8 @@
 #include "Firestore/core/src/local/target_data.h"
 #include "Firestore/core/src/model/document.h"
 #include "Firestore/core/src/model/model_fwd.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/optional.h"
 
 namespace firebase {
@@ -141,6 +146,40 @@ class LocalStore : public bundle::BundleCallback {
    */
   const model::Document ReadDocument(const model::DocumentKey& key);
 
+  /**
+   * Returns true if the `...Concurrently()` reads may be called on any thread,
+   * while the other operations of the local store run on the worker queue.
+   */
+  bool SupportsConcurrentReads() const;
+
+  /**
+   * Like `ReadDocument()`, against a snapshot of the local store that changes
+   * made while it runs do not affect. The snapshot is never taken while a
+   * remote event or bundle is committed in chunks, and waits for it instead.
+   */
+  model::Document ReadDocumentConcurrently(const model::DocumentKey& key);
+
+  /**
+   * Returns true if `query` should run through `ExecuteQueryConcurrently()`,
+   * which is only the case where `ExecuteQuery()` would scan its collection
+   * too: no field index is configured for the collection, and no listen is
+   * active for the query. The parents of collection groups are only tracked
+   * on the worker queue, so collection group queries never run concurrently.
+   *
+   * May be called on any thread. An index or listen that is added right
+   * after this returns true only makes the concurrent query slower than it
+   * could be, not wrong.
+   */
+  bool CanExecuteQueryConcurrently(const core::Query& query);
+
+  /**
+   * Like `ExecuteQuery()` without previous results, against a snapshot of the
+   * local store that changes made while it runs do not affect. The query
+   * scans its collection, since targets and field indexes are only kept on
+   * the worker queue, and the result has no remote keys.
+   */
+  QueryResult ExecuteQueryConcurrently(const core::Query& query);
+
   /**
    * Acknowledges the given batch.
    *
@@ -158,6 +197,18 @@ class LocalStore : public bundle::BundleCallback {
   model::DocumentMap AcknowledgeBatch(
       const model::MutationBatchResult& batch_result);
 
+  /**
+   * Acknowledges the given batches, in order, in a single transaction.
+   *
+   * This is equivalent to acknowledging each batch on its own, but the
+   * latency compensated view of the affected documents is only recalculated
+   * once, after all batches have been removed from the mutation queue.
+   *
+   * @return The resulting (modified) documents.
+   */
+  model::DocumentMap AcknowledgeBatches(
+      const std::vector<model::MutationBatchResult>& batch_results);
+
   /**
    * Removes mutations from the MutationQueue for the specified batch.
    * LocalDocuments will be recalculated.
@@ -192,6 +243,15 @@ class LocalStore : public bundle::BundleCallback {
    */
   model::DocumentMap ApplyRemoteEvent(const remote::RemoteEvent& remote_event);
 
+  /**
+   * Updates the "ground-state" (remote) documents with documents in limbo that
+   * were looked up from the backend rather than listened to. Each document is
+   * applied as of the read time of its lookup; unlike a remote event, this
+   * does not advance the last remote snapshot version.
+   */
+  model::DocumentMap ApplyLimboDocumentLookup(
+      const model::DocumentUpdateMap& documents);
+
   /**
    * Returns the keys of the documents that are associated with the given
    * target_id in the remote table.
@@ -226,6 +286,18 @@ class LocalStore : public bundle::BundleCallback {
   QueryResult ExecuteQuery(const core::QueryOrPipeline& query_or_pipeline,
                            bool use_previous_results);
 
+  /**
+   * Returns the documents of the last result stored for the target of the
+   * given query, as they are now in the local store, with the remote keys of
+   * the target. Returns `nullopt` if no result has been stored.
+   *
+   * This only reads the stored documents, so it is much faster than
+   * `ExecuteQuery()`. It also misses the documents that have started to match
+   * the query since the result was stored.
+   */
+  absl::optional<QueryResult> ReadLastResult(
+      const core::QueryOrPipeline& query_or_pipeline);
+
   /**
    * Notify the local store of the changed views to locally pin / unpin
    * documents.
@@ -258,6 +330,18 @@ class LocalStore : public bundle::BundleCallback {
    */
   size_t Backfill() const;
 
+  /**
+   * Lets each backfill operation process more documents while they can be
+   * indexed quickly; see `IndexBackfiller::SetAdaptiveBudgetEnabled()`.
+   */
+  void SetAdaptiveBackfillEnabled(bool enabled);
+
+  /**
+   * Lets each backfill operation stop early when more urgent work is waiting;
+   * see `IndexBackfiller::SetShouldYield()`.
+   */
+  void SetBackfillShouldYield(std::function<bool()> should_yield);
+
   /**
    * Returns whether the given bundle has already been loaded and its create
    * time is newer or equal to the currently loading bundle.
@@ -288,10 +372,28 @@ class LocalStore : public bundle::BundleCallback {
   absl::optional<bundle::NamedQuery> GetNamedQuery(
       const std::string& query_name);
 
+  /**
+   * Like `GetNamedQuery()`, against a snapshot of the local store that changes
+   * made while it runs do not affect.
+   */
+  absl::optional<bundle::NamedQuery> GetNamedQueryConcurrently(
+      const std::string& query_name);
+
   void ConfigureFieldIndexes(std::vector<model::FieldIndex> new_field_indexes);
 
   void SetIndexAutoCreationEnabled(bool is_enabled) const;
 
+  /**
+   * Makes `ApplyRemoteEvent()` and `ApplyBundledDocuments()` commit the
+   * document changes of events and bundles that change more than
+   * `max_documents` documents in transactions of at most that many, instead
+   * of holding them all in a single transaction. Zero, the default, disables
+   * chunking.
+   */
+  void SetRemoteEventChunkSize(size_t max_documents) {
+    remote_event_chunk_size_ = max_documents;
+  }
+
   void DeleteAllFieldIndexes() const;
 
  private:
@@ -313,6 +415,23 @@ class LocalStore : public bundle::BundleCallback {
     return index_backfiller_.get();
   }
 
+  /** Returns the view of the current user's documents for concurrent reads. */
+  std::shared_ptr<LocalDocumentsView> concurrent_documents();
+
+  /**
+   * Runs `block` in a read-only transaction, like `RunReadOnly()`, with its
+   * snapshot taken outside of chunked applications.
+   */
+  template <typename F>
+  auto RunConcurrentRead(absl::string_view label, F block)
+      -> decltype(block());
+
+  /**
+   * Makes concurrent reads layer the overlays of the current user's
+   * components over the remote documents.
+   */
+  void ResetConcurrentDocuments();
+
   struct DocumentChangeResult {
     model::MutableDocumentMap changed_docs;
     model::DocumentKeySet existence_changed_keys;
@@ -373,12 +492,28 @@ class LocalStore : public bundle::BundleCallback {
       const model::DocumentVersionMap& document_versions,
       const model::SnapshotVersion& global_version);
 
+  /**
+   * Like `PopulateDocumentChanges()`, but commits the changes in transactions
+   * of at most `remote_event_chunk_size_` documents, each covering a
+   * contiguous range of keys. Must not be called from within a transaction.
+   */
+  DocumentChangeResult PopulateDocumentChangesInChunks(
+      const model::DocumentUpdateMap& documents,
+      const model::DocumentVersionMap& document_versions,
+      const model::SnapshotVersion& global_version);
+
   // For testing
   std::vector<model::FieldIndex> GetFieldIndexes();
 
   /** Manages our in-memory or durable persistence. Owned by FirestoreClient. */
   Persistence* persistence_ = nullptr;
 
+  /**
+   * The maximum number of documents of a remote event committed per
+   * transaction, or zero to apply each event in one transaction.
+   */
+  size_t remote_event_chunk_size_ = 0;
+
   /** Used to generate target IDs for queries tracked locally. */
   core::TargetIdGenerator target_id_generator_;
 
@@ -425,6 +560,36 @@ class LocalStore : public bundle::BundleCallback {
    */
   std::unique_ptr<LocalDocumentsView> local_documents_;
 
+  /**
+   * Guards `concurrent_documents_`, `concurrent_index_manager_` and
+   * `active_target_canonical_ids_`.
+   */
+  std::mutex concurrent_documents_mutex_;
+
+  /**
+   * The view that concurrent reads use, kept apart from `local_documents_`,
+   * which is only used on the worker queue. Reads copy the pointer when they
+   * start, and keep the view of the previous user if the user changes while
+   * they run.
+   */
+  std::shared_ptr<LocalDocumentsView> concurrent_documents_;
+
+  /** The index manager of the current user, for concurrent reads. */
+  IndexManager* concurrent_index_manager_ = nullptr;
+
+  /**
+   * The canonical ids of the targets in `target_id_by_target_` that are not
+   * pipelines, for concurrent reads.
+   */
+  std::unordered_set<std::string> active_target_canonical_ids_;
+
+  /**
+   * Held exclusively while a remote event or bundle commits its documents
+   * over several transactions, and shared by concurrent reads while they
+   * take their snapshot, so that no snapshot holds part of one.
+   */
+  absl::Mutex chunked_apply_mutex_;
+
   /**
    * Implements the steps for backfilling indexes.
    */
@@ -28,7 +28,9 @@ using model::DocumentKeySet;
 using model::TargetId;
 
 LocalViewChanges LocalViewChanges::FromViewSnapshot(
-    const core::ViewSnapshot& snapshot, model::TargetId target_id) {
+    const core::ViewSnapshot& snapshot,
+    model::TargetId target_id,
+    bool with_result_keys) {
   DocumentKeySet added_keys;
   DocumentKeySet removed_keys;
 
@@ -48,8 +50,18 @@ LocalViewChanges LocalViewChanges::FromViewSnapshot(
     }
   }
 
-  return LocalViewChanges(target_id, snapshot.from_cache(),
+  LocalViewChanges result(target_id, snapshot.from_cache(),
                           std::move(added_keys), std::move(removed_keys));
+  if (with_result_keys && (!snapshot.document_changes().empty() ||
+                           snapshot.sync_state_changed())) {
+    std::vector<model::DocumentKey> result_keys;
+    result_keys.reserve(snapshot.documents().size());
+    for (const model::Document& doc : snapshot.documents()) {
+      result_keys.push_back(doc->key());
+    }
+    result.result_keys_ = std::move(result_keys);
+  }
+  return result;
 }
 
 }  // namespace local
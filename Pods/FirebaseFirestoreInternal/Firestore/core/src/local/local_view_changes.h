@@ -18,10 +18,13 @@
 #define FIRESTORE_CORE_SRC_LOCAL_LOCAL_VIEW_CHANGES_H_
 
 #include <utility>
+#include <vector>
 
 #include "Firestore/core/src/core/core_fwd.h"
+#include "Firestore/core/src/model/document_key.h"
 #include "Firestore/core/src/model/document_key_set.h"
 #include "Firestore/core/src/model/types.h"
+#include "absl/types/optional.h"
 
 namespace firebase {
 namespace firestore {
@@ -36,8 +39,14 @@ namespace local {
  */
 class LocalViewChanges {
  public:
+  /**
+   * Creates the changes of the given snapshot. With `with_result_keys`, they
+   * also carry the keys of the snapshot's documents in order if its
+   * documents or sync state changed.
+   */
   static LocalViewChanges FromViewSnapshot(const core::ViewSnapshot& snapshot,
-                                           model::TargetId target_id);
+                                           model::TargetId target_id,
+                                           bool with_result_keys = false);
 
   LocalViewChanges(model::TargetId target_id,
                    bool from_cache,
@@ -67,11 +76,20 @@ class LocalViewChanges {
     return removed_keys_;
   }
 
+  /**
+   * The keys of the documents in view after the changes, in order, if they
+   * are to be remembered as the last result of the target.
+   */
+  const absl::optional<std::vector<model::DocumentKey>>& result_keys() const {
+    return result_keys_;
+  }
+
  private:
   model::TargetId target_id_ = 0;
   bool from_cache_ = false;
   model::DocumentKeySet added_keys_;
   model::DocumentKeySet removed_keys_;
+  absl::optional<std::vector<model::DocumentKey>> result_keys_;
 };
 
 }  // namespace local
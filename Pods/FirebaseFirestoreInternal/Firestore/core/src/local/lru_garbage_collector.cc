@@ -16,6 +16,7 @@
 
 #include "Firestore/core/src/local/lru_garbage_collector.h"
 
+#include <algorithm>
 #include <chrono>
 #include <queue>
 #include <string>
@@ -117,9 +118,15 @@ StatusOr<int64_t> LruGarbageCollector::CalculateByteSize() const {
 LruResults LruGarbageCollector::Collect(const LiveQueryMap& live_targets) {
   if (params_.min_bytes_threshold == Settings::CacheSizeUnlimited) {
     LOG_DEBUG("Garbage collection skipped; disabled");
+    incremental_.reset();
     return LruResults::DidNotRun();
   }
 
+  if (incremental_) {
+    // A started collection runs to its end, whatever the size of the cache.
+    return ContinueIncrementalCollection();
+  }
+
   StatusOr<int64_t> maybe_current_size = CalculateByteSize();
   if (!maybe_current_size.ok()) {
     LOG_ERROR(
@@ -139,9 +146,93 @@ LruResults LruGarbageCollector::Collect(const LiveQueryMap& live_targets) {
   }
 
   LOG_DEBUG("Running garbage collection on cache of size: %s", current_size);
+  if (params_.slice_duration_ms > 0) {
+    return StartIncrementalCollection(live_targets);
+  }
   return RunGarbageCollection(live_targets);
 }
 
+LruResults LruGarbageCollector::StartIncrementalCollection(
+    const LiveQueryMap& live_targets) {
+  Timestamp start = Timestamp::Now();
+
+  IncrementalCollection collection;
+  collection.sequence_numbers =
+      std::min(QueryCountForPercentile(params_.percentile_to_collect),
+               params_.maximum_sequence_numbers_to_collect);
+  collection.upper_bound =
+      SequenceNumberForQueryCount(collection.sequence_numbers);
+  collection.targets_removed =
+      RemoveTargets(collection.upper_bound, live_targets);
+  collection.documents_removed = 0;
+  collection.bytes_reclaimed = 0;
+
+  ListenSequenceNumber upper_bound = collection.upper_bound;
+  delegate_->EnumerateOrphanedDocuments(
+      [&](const DocumentKey& key, ListenSequenceNumber sequence_number) {
+        if (sequence_number <= upper_bound) {
+          collection.documents.emplace_back(sequence_number, key);
+        }
+      });
+  std::sort(collection.documents.begin(), collection.documents.end(),
+            [](const std::pair<ListenSequenceNumber, DocumentKey>& lhs,
+               const std::pair<ListenSequenceNumber, DocumentKey>& rhs) {
+              return lhs.first > rhs.first;
+            });
+
+  LOG_DEBUG(
+      "LRU Garbage Collection: removed %s targets and found %s orphaned "
+      "documents up to sequence number %s in %sms",
+      collection.targets_removed, collection.documents.size(), upper_bound,
+      MillisecondsBetween(start, Timestamp::Now()));
+
+  incremental_ = std::move(collection);
+  return ContinueIncrementalCollection();
+}
+
+LruResults LruGarbageCollector::ContinueIncrementalCollection() {
+  auto deadline = std::chrono::steady_clock::now() +
+                  std::chrono::milliseconds(params_.slice_duration_ms);
+  IncrementalCollection& collection = *incremental_;
+
+  int removed = 0;
+  bool examined_any = false;
+  while (!collection.documents.empty() &&
+         std::chrono::steady_clock::now() < deadline) {
+    if (examined_any && should_yield_ && should_yield_()) {
+      break;
+    }
+    examined_any = true;
+
+    // The document may have been used or referenced since the collection
+    // started, in which case the delegate keeps it.
+    absl::optional<int64_t> bytes = delegate_->RemoveOrphanedDocument(
+        collection.documents.back().second, collection.upper_bound);
+    collection.documents.pop_back();
+    if (bytes) {
+      ++removed;
+      collection.bytes_reclaimed += *bytes;
+    }
+  }
+  collection.documents_removed += removed;
+
+  LruResults results{/* did_run= */ true, collection.sequence_numbers,
+                     collection.targets_removed, collection.documents_removed};
+  results.complete = collection.documents.empty();
+  results.bytes_reclaimed = collection.bytes_reclaimed;
+
+  LOG_DEBUG(
+      "LRU Garbage Collection: removed %s documents in this slice, %s in "
+      "total (%s bytes); %s documents left",
+      removed, collection.documents_removed, collection.bytes_reclaimed,
+      collection.documents.size());
+
+  if (results.complete) {
+    incremental_.reset();
+  }
+  return results;
+}
+
 LruResults LruGarbageCollector::RunGarbageCollection(
     const LiveQueryMap& live_targets) {
   Timestamp start = Timestamp::Now();
@@ -17,13 +17,18 @@
 #ifndef FIRESTORE_CORE_SRC_LOCAL_LRU_GARBAGE_COLLECTOR_H_
 #define FIRESTORE_CORE_SRC_LOCAL_LRU_GARBAGE_COLLECTOR_H_
 
+#include <functional>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "Firestore/core/src/local/reference_delegate.h"
 #include "Firestore/core/src/local/target_cache.h"
 #include "Firestore/core/src/local/target_data.h"
+#include "Firestore/core/src/model/document_key.h"
 #include "Firestore/core/src/model/types.h"
 #include "Firestore/core/src/util/status_fwd.h"
+#include "absl/types/optional.h"
 
 namespace firebase {
 namespace firestore {
@@ -45,6 +50,13 @@ struct LruParams {
   int64_t min_bytes_threshold;
   int percentile_to_collect;
   int maximum_sequence_numbers_to_collect;
+
+  /**
+   * If positive, each call to `LruGarbageCollector::Collect()` spends about
+   * this many milliseconds removing documents, and a collection spans as many
+   * calls as it needs.
+   */
+  int64_t slice_duration_ms = 0;
 };
 
 struct LruResults {
@@ -56,6 +68,18 @@ struct LruResults {
   int sequence_numbers_collected;
   int targets_removed;
   int documents_removed;
+
+  /**
+   * False if an incremental collection has documents left to remove in later
+   * calls to `Collect()`. The other counts cover the collection so far.
+   */
+  bool complete = true;
+
+  /**
+   * The bytes taken by the removed documents. Only incremental collections
+   * report this.
+   */
+  int64_t bytes_reclaimed = 0;
 };
 
 using LiveQueryMap = std::unordered_map<model::TargetId, TargetData>;
@@ -98,6 +122,15 @@ class LruDelegate : public ReferenceDelegate {
   virtual int RemoveOrphanedDocuments(
       model::ListenSequenceNumber sequence_number) = 0;
 
+  /**
+   * Removes the given document if it is still unreferenced, is not pinned and
+   * has a sequence number less than or equal to the given sequence number.
+   * Returns the number of bytes it took, or `nullopt` if it was kept.
+   */
+  virtual absl::optional<int64_t> RemoveOrphanedDocument(
+      const model::DocumentKey& key,
+      model::ListenSequenceNumber sequence_number) = 0;
+
   /**
    * Removes all targets that are not currently being listened to and have a
    * sequence number less than or equal to the given sequence number. Returns
@@ -145,8 +178,26 @@ class LruGarbageCollector {
    */
   int RemoveOrphanedDocuments(model::ListenSequenceNumber sequence_number);
 
+  /**
+   * Removes the least recently used targets and documents if the cache is
+   * larger than the threshold.
+   *
+   * If `LruParams::slice_duration_ms` is set, a call only removes documents
+   * for about that long and returns results that are not `complete`; the
+   * caller should then call again soon, yielding to other work in between.
+   * The first call removes the targets in one go.
+   */
   local::LruResults Collect(const LiveQueryMap& live_targets);
 
+  /**
+   * Sets a check that tells an incremental collection to end its slice
+   * early, because more urgent work is waiting. Each slice still removes at
+   * least one document, so that the collection makes progress.
+   */
+  void SetShouldYield(std::function<bool()> should_yield) {
+    should_yield_ = std::move(should_yield);
+  }
+
   /**
    * Visible for testing only!
    */
@@ -155,12 +206,37 @@ class LruGarbageCollector {
   }
 
  private:
+  /** The state of an incremental collection between calls to `Collect()`. */
+  struct IncrementalCollection {
+    model::ListenSequenceNumber upper_bound;
+    int sequence_numbers;
+    int targets_removed;
+    int documents_removed;
+    int64_t bytes_reclaimed;
+
+    /**
+     * The documents that were orphaned when the collection started, with the
+     * least recently used last.
+     */
+    std::vector<std::pair<model::ListenSequenceNumber, model::DocumentKey>>
+        documents;
+  };
+
   LruResults RunGarbageCollection(const LiveQueryMap& live_targets);
 
+  LruResults StartIncrementalCollection(const LiveQueryMap& live_targets);
+
+  /** Removes documents of `incremental_` for one slice. */
+  LruResults ContinueIncrementalCollection();
+
   // Delegate owns the LruGarbageCollector; this is a back pointer.
   LruDelegate* delegate_;
 
   LruParams params_ = LruParams::Default();
+
+  absl::optional<IncrementalCollection> incremental_;
+
+  std::function<bool()> should_yield_;
 };
 
 }  // namespace local
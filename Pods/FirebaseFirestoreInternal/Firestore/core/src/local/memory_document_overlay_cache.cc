@@ -56,6 +56,7 @@ void MemoryDocumentOverlayCache::RemoveOverlaysForBatchId(int batch_id) {
     const DocumentKeySet& keys = overlay_by_batch_id_iter->second;
     for (const auto& key : keys) {
       overlays_ = overlays_.erase(key);
+      RemoveFromCollectionIndex(key, batch_id);
     }
     overlay_by_batch_id_.erase(overlay_by_batch_id_iter);
   }
@@ -64,26 +65,19 @@ void MemoryDocumentOverlayCache::RemoveOverlaysForBatchId(int batch_id) {
 OverlayByDocumentKeyMap MemoryDocumentOverlayCache::GetOverlays(
     const ResourcePath& collection, int since_batch_id) const {
   OverlayByDocumentKeyMap result;
+  const auto collection_iter = overlays_by_collection_.find(collection);
+  if (collection_iter == overlays_by_collection_.end()) {
+    return result;
+  }
 
-  std::size_t immediate_children_path_length{collection.size() + 1};
-  DocumentKey prefix(collection.Append(""));
-  auto overlays_iter = overlays_.lower_bound(prefix);
-
-  while (overlays_iter != overlays_.end()) {
-    const Overlay& overlay = overlays_iter->second;
-    ++overlays_iter;
-
-    const DocumentKey& key = overlay.key();
-    if (!collection.IsPrefixOf(key.path())) {
-      break;
-    }
-    // Documents from sub-collections
-    if (key.path().size() != immediate_children_path_length) {
-      continue;
-    }
-
-    if (overlay.largest_batch_id() > since_batch_id) {
-      result[key] = overlay;
+  const DocumentKeysBySortedBatchIdMap& keys_by_batch_id =
+      collection_iter->second;
+  for (auto it = keys_by_batch_id.upper_bound(since_batch_id);
+       it != keys_by_batch_id.end(); ++it) {
+    for (const DocumentKey& key : it->second) {
+      const auto overlays_iter = overlays_.find(key);
+      HARD_ASSERT(overlays_iter != overlays_.end());
+      result[key] = overlays_iter->second;
     }
   }
 
@@ -140,6 +134,7 @@ void MemoryDocumentOverlayCache::SaveOverlay(int largest_batch_id,
       HARD_ASSERT(overlay_by_batch_id_iter != overlay_by_batch_id_.end());
       DocumentKeySet& existing_keys = overlay_by_batch_id_iter->second;
       existing_keys.erase(mutation.key());
+      RemoveFromCollectionIndex(mutation.key(), existing.largest_batch_id());
     }
   }
 
@@ -147,6 +142,26 @@ void MemoryDocumentOverlayCache::SaveOverlay(int largest_batch_id,
       overlays_.insert(mutation.key(), Overlay(largest_batch_id, mutation));
 
   overlay_by_batch_id_[largest_batch_id].insert(mutation.key());
+  overlays_by_collection_[mutation.key().path().PopLast()][largest_batch_id]
+      .insert(mutation.key());
+}
+
+void MemoryDocumentOverlayCache::RemoveFromCollectionIndex(
+    const DocumentKey& key, int batch_id) {
+  const auto collection_iter =
+      overlays_by_collection_.find(key.path().PopLast());
+  HARD_ASSERT(collection_iter != overlays_by_collection_.end());
+  DocumentKeysBySortedBatchIdMap& keys_by_batch_id = collection_iter->second;
+
+  const auto batch_iter = keys_by_batch_id.find(batch_id);
+  HARD_ASSERT(batch_iter != keys_by_batch_id.end());
+  batch_iter->second.erase(key);
+  if (batch_iter->second.empty()) {
+    keys_by_batch_id.erase(batch_iter);
+    if (keys_by_batch_id.empty()) {
+      overlays_by_collection_.erase(collection_iter);
+    }
+  }
 }
 
 }  // namespace local
@@ -17,6 +17,7 @@
 #ifndef FIRESTORE_CORE_SRC_LOCAL_MEMORY_DOCUMENT_OVERLAY_CACHE_H_
 #define FIRESTORE_CORE_SRC_LOCAL_MEMORY_DOCUMENT_OVERLAY_CACHE_H_
 
+#include <map>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -60,13 +61,25 @@ class MemoryDocumentOverlayCache final : public DocumentOverlayCache {
   using DocumentKeySet =
       std::unordered_set<model::DocumentKey, model::DocumentKeyHash>;
   using DocumentKeysByBatchIdMap = std::unordered_map<int, DocumentKeySet>;
+  using DocumentKeysBySortedBatchIdMap = std::map<int, DocumentKeySet>;
 
   int GetOverlayCount() const override;
 
   void SaveOverlay(int largest_batch_id, const model::Mutation& mutation);
 
+  /** Removes `key` from the index entry of its collection for `batch_id`. */
+  void RemoveFromCollectionIndex(const model::DocumentKey& key, int batch_id);
+
   OverlayByDocumentKeySortedMap overlays_;
   DocumentKeysByBatchIdMap overlay_by_batch_id_;
+
+  /**
+   * The keys of the overlays of each collection by largest batch ID, so that
+   * a query only visits the overlays of its collection that are newer than
+   * the documents it has read.
+   */
+  std::map<model::ResourcePath, DocumentKeysBySortedBatchIdMap>
+      overlays_by_collection_;
 };
 
 }  // namespace local
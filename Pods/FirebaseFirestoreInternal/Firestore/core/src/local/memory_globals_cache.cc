@@ -28,6 +28,14 @@ void MemoryGlobalsCache::SetSessionToken(const ByteString& session_token) {
   session_token_ = session_token;
 }
 
+absl::optional<int64_t> MemoryGlobalsCache::GetByteSize() const {
+  return byte_size_;
+}
+
+void MemoryGlobalsCache::SetByteSize(int64_t byte_size) {
+  byte_size_ = byte_size;
+}
+
 }  // namespace local
 }  // namespace firestore
 }  // namespace firebase
@@ -38,8 +38,13 @@ class MemoryGlobalsCache : public GlobalsCache {
    */
   void SetSessionToken(const ByteString& session_token) override;
 
+  absl::optional<int64_t> GetByteSize() const override;
+
+  void SetByteSize(int64_t byte_size) override;
+
  private:
   ByteString session_token_;
+  absl::optional<int64_t> byte_size_;
 };
 
 }  // namespace local
@@ -24,6 +24,7 @@
 #include "Firestore/core/src/core/target.h"
 #include "Firestore/core/src/model/field_index.h"
 #include "Firestore/core/src/model/model_fwd.h"
+#include "Firestore/core/src/model/object_value.h"
 #include "Firestore/core/src/model/resource_path.h"
 #include "Firestore/core/src/util/hard_assert.h"
 
@@ -89,6 +90,12 @@ std::vector<model::FieldIndex> MemoryIndexManager::GetFieldIndexes() const {
   return {};
 }
 
+bool MemoryIndexManager::HasFieldIndexes(
+    const std::string& collection_group) const {
+  (void)collection_group;
+  return false;
+}
+
 void MemoryIndexManager::DeleteAllFieldIndexes() {
 }
 
@@ -113,6 +120,17 @@ MemoryIndexManager::GetDocumentsMatchingTarget(const core::Target&) {
   return absl::nullopt;
 }
 
+absl::optional<std::vector<std::pair<model::DocumentKey, model::ObjectValue>>>
+MemoryIndexManager::GetStoredValuesMatchingTarget(
+    const core::Target&, const std::vector<model::FieldPath>&) {
+  return absl::nullopt;
+}
+
+absl::optional<size_t> MemoryIndexManager::EstimateIndexEntriesRead(
+    const core::Target&) {
+  return absl::nullopt;
+}
+
 absl::optional<std::string> MemoryIndexManager::GetNextCollectionGroupToUpdate()
     const {
   return absl::nullopt;
@@ -67,6 +67,8 @@ class MemoryIndexManager : public IndexManager {
 
   std::vector<model::FieldIndex> GetFieldIndexes() const override;
 
+  bool HasFieldIndexes(const std::string& collection_group) const override;
+
   void DeleteAllFieldIndexes() override;
 
   void CreateTargetIndexes(const core::Target&) override;
@@ -80,6 +82,14 @@ class MemoryIndexManager : public IndexManager {
   absl::optional<std::vector<model::DocumentKey>> GetDocumentsMatchingTarget(
       const core::Target&) override;
 
+  absl::optional<
+      std::vector<std::pair<model::DocumentKey, model::ObjectValue>>>
+  GetStoredValuesMatchingTarget(
+      const core::Target&, const std::vector<model::FieldPath>&) override;
+
+  absl::optional<size_t> EstimateIndexEntriesRead(
+      const core::Target&) override;
+
   absl::optional<std::string> GetNextCollectionGroupToUpdate() const override;
 
   void UpdateCollectionGroup(const std::string&, model::IndexOffset) override;
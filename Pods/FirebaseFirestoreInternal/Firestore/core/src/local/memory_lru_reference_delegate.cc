@@ -27,6 +27,7 @@
 #include "Firestore/core/src/local/remote_document_cache.h"
 #include "Firestore/core/src/local/sizer.h"
 #include "Firestore/core/src/local/target_data.h"
+#include "Firestore/core/src/model/mutable_document.h"
 #include "Firestore/core/src/util/statusor.h"
 #include "absl/memory/memory.h"
 
@@ -131,6 +132,22 @@ int MemoryLruReferenceDelegate::RemoveOrphanedDocuments(
   return static_cast<int>(removed.size());
 }
 
+absl::optional<int64_t> MemoryLruReferenceDelegate::RemoveOrphanedDocument(
+    const DocumentKey& key, model::ListenSequenceNumber upper_bound) {
+  if (IsPinnedAtSequenceNumber(upper_bound, key)) {
+    return absl::nullopt;
+  }
+  model::MutableDocument document = persistence_->remote_document_cache()->Get(key);
+  if (!document.is_valid_document()) {
+    return absl::nullopt;
+  }
+
+  int64_t size = sizer_->CalculateByteSize(document);
+  persistence_->remote_document_cache()->Remove(key);
+  sequence_numbers_.erase(key);
+  return size;
+}
+
 void MemoryLruReferenceDelegate::AddReference(const DocumentKey& key) {
   sequence_numbers_[key] = current_sequence_number_;
 }
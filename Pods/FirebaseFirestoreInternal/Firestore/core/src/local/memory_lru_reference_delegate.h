@@ -74,6 +74,9 @@ class MemoryLruReferenceDelegate : public LruDelegate {
       const OrphanedDocumentCallback& callback) override;
 
   int RemoveOrphanedDocuments(model::ListenSequenceNumber upper_bound) override;
+  absl::optional<int64_t> RemoveOrphanedDocument(
+      const model::DocumentKey& key,
+      model::ListenSequenceNumber upper_bound) override;
   int RemoveTargets(model::ListenSequenceNumber sequence_number,
                     const LiveQueryMap& live_queries) override;
 
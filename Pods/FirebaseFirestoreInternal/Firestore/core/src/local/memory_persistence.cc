@@ -142,6 +142,14 @@ ReferenceDelegate* MemoryPersistence::reference_delegate() {
 void MemoryPersistence::ReleaseOtherUserSpecificComponents(const std::string&) {
 }
 
+bool MemoryPersistence::RunDeferredMigrations() {
+  return false;
+}
+
+void MemoryPersistence::ReleaseMemory(util::MemoryPressure) {
+  // Everything held in memory is the cache itself.
+}
+
 void MemoryPersistence::DeleteAllFieldIndexes() {
 }
 
@@ -107,6 +107,10 @@ class MemoryPersistence : public Persistence {
 
   void ReleaseOtherUserSpecificComponents(const std::string& uid) override;
 
+  bool RunDeferredMigrations() override;
+
+  void ReleaseMemory(util::MemoryPressure pressure) override;
+
  protected:
   void RunInternal(absl::string_view label,
                    std::function<void()> block) override;
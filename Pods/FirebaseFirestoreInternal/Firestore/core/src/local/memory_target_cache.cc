@@ -125,6 +125,16 @@ bool MemoryTargetCache::Contains(const DocumentKey& key) {
   return references_.ContainsKey(key);
 }
 
+void MemoryTargetCache::SetLastResultKeys(TargetId,
+                                          const std::vector<DocumentKey>&) {
+  // The cache does not outlive the process, so there is no restart that the
+  // keys could be shown again after.
+}
+
+std::vector<DocumentKey> MemoryTargetCache::GetLastResultKeys(TargetId) {
+  return {};
+}
+
 int64_t MemoryTargetCache::CalculateByteSize(const Sizer& sizer) {
   int64_t count = 0;
   for (const auto& kv : targets_) {
@@ -20,6 +20,7 @@
 #include <cstdint>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "Firestore/core/src/core/target.h"
 #include "Firestore/core/src/local/reference_set.h"
@@ -70,6 +71,12 @@ class MemoryTargetCache : public TargetCache {
 
   bool Contains(const model::DocumentKey& key) override;
 
+  void SetLastResultKeys(model::TargetId target_id,
+                         const std::vector<model::DocumentKey>& keys) override;
+
+  std::vector<model::DocumentKey> GetLastResultKeys(
+      model::TargetId target_id) override;
+
   // Other methods and accessors
   int64_t CalculateByteSize(const Sizer& sizer);
 
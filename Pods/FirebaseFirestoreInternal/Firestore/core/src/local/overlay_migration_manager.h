@@ -26,6 +26,11 @@ class OverlayMigrationManager {
  public:
   virtual ~OverlayMigrationManager() = default;
 
+  /**
+   * Creates the overlays of the user this manager was created for, if they
+   * have not been created yet. Must be run before the user's overlays are
+   * read.
+   */
   virtual void Run() = 0;
 };
 
@@ -22,6 +22,8 @@
 #include <utility>
 
 #include "Firestore/core/src/model/types.h"
+#include "Firestore/core/src/util/memory_pressure_monitor.h"
+#include "Firestore/core/src/util/trace.h"
 #include "absl/strings/string_view.h"
 
 namespace firebase {
@@ -158,6 +160,29 @@ class Persistence {
   virtual void ReleaseOtherUserSpecificComponents(
       const std::string& target_uid) = 0;
 
+  /**
+   * Runs a slice of the schema migrations that are not needed to serve reads
+   * and are left to be done after startup.
+   *
+   * @return true if work remains and this should be called again.
+   */
+  virtual bool RunDeferredMigrations() = 0;
+
+  /**
+   * Shrinks the in-memory caches that can be rebuilt from storage while the
+   * system is short on memory, and lets them grow back to their configured
+   * sizes once `pressure` is back to normal.
+   */
+  virtual void ReleaseMemory(util::MemoryPressure pressure) = 0;
+
+  /**
+   * Returns true if `RunReadOnly()` may be called on any thread, while a
+   * transaction or other read-only blocks run on other threads.
+   */
+  virtual bool SupportsConcurrentReads() const {
+    return false;
+  }
+
   /**
    * Accepts a function and runs it within a transaction. When called, a
    * transaction will be started before a block is run, and committed after the
@@ -171,6 +196,7 @@ class Persistence {
   auto Run(absl::string_view label, F block) ->
       typename std::enable_if<std::is_same<void, decltype(block())>::value,
                               void>::type {
+    util::TraceSpan span(util::OperationTrace::Stage::kLocalStore);
     RunInternal(label, std::forward<F>(block));
   }
 
@@ -191,15 +217,47 @@ class Persistence {
                               decltype(block())>::type {
     decltype(block()) result;
 
+    util::TraceSpan span(util::OperationTrace::Stage::kLocalStore);
     RunInternal(label, [&]() mutable { result = block(); });
 
     return result;
   }
 
+  /**
+   * Accepts a function that only reads, and runs it against a consistent
+   * snapshot of the persisted state: changes committed by transactions while
+   * it runs are not visible to it. Unless `SupportsConcurrentReads()`, this
+   * is the same as `Run()`.
+   *
+   * A change that its caller commits over several transactions can be seen
+   * in part; `LocalStore` keeps its reads out of the remote events and
+   * bundles that it commits in chunks.
+   *
+   * @param label A semi-unique name for the read, for logging.
+   * @param block A function that reads within the snapshot and returns the
+   *     result of the read. The type of the return value must be default
+   *     constructible and copy- or move-assignable.
+   * @return The value returned from the invocation of `block`.
+   */
+  template <typename F>
+  auto RunReadOnly(absl::string_view label, F block) -> decltype(block()) {
+    decltype(block()) result;
+
+    util::TraceSpan span(util::OperationTrace::Stage::kLocalStore);
+    RunReadOnlyInternal(label, [&]() mutable { result = block(); });
+
+    return result;
+  }
+
  private:
   virtual void RunInternal(absl::string_view label,
                            std::function<void()> block) = 0;
 
+  virtual void RunReadOnlyInternal(absl::string_view label,
+                                   std::function<void()> block) {
+    RunInternal(label, std::move(block));
+  }
+
   /**
    * Removes all persistent cache indexes. This feature is implemented in
    * `Persistence` instead of `IndexManager` like other SDKs. The reason for
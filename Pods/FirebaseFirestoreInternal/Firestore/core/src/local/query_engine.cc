@@ -16,10 +16,14 @@
 
 #include "Firestore/core/src/local/query_engine.h"
 
+#include <algorithm>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "Firestore/core/src/core/query.h"
 #include "Firestore/core/src/core/target.h"
+#include "Firestore/core/src/local/index_manager.h"
 #include "Firestore/core/src/local/local_documents_view.h"
 #include "Firestore/core/src/local/query_context.h"
 #include "Firestore/core/src/model/document.h"
@@ -27,6 +31,7 @@
 #include "Firestore/core/src/model/mutable_document.h"
 #include "Firestore/core/src/model/snapshot_version.h"
 #include "Firestore/core/src/util/log.h"
+#include "absl/strings/str_cat.h"
 
 namespace firebase {
 namespace firestore {
@@ -71,10 +76,13 @@ const DocumentMap QueryEngine::GetDocumentsMatchingQuery(
   HARD_ASSERT(local_documents_view_ && index_manager_,
               "Initialize() not called");
 
-  const absl::optional<DocumentMap> index_result =
-      PerformQueryUsingIndex(query_or_pipeline);
-  if (index_result.has_value()) {
-    return index_result.value();
+  if (ShouldUseIndex(query_or_pipeline, remote_keys,
+                     last_limbo_free_snapshot_version)) {
+    const absl::optional<DocumentMap> index_result =
+        PerformQueryUsingIndex(query_or_pipeline);
+    if (index_result.has_value()) {
+      return index_result.value();
+    }
   }
 
   const absl::optional<DocumentMap> key_result = PerformQueryUsingRemoteKeys(
@@ -85,6 +93,10 @@ const DocumentMap QueryEngine::GetDocumentsMatchingQuery(
 
   absl::optional<QueryContext> context = QueryContext();
   auto full_scan_result = ExecuteFullCollectionScan(query_or_pipeline, context);
+  if (!query_or_pipeline.IsPipeline()) {
+    collection_sizes_[CollectionSizeKey(query_or_pipeline.query())] =
+        context->GetDocumentReadCount();
+  }
   if (index_auto_creation_enabled_) {
     CreateCacheIndexes(query_or_pipeline, context.value(),
                        full_scan_result.size());
@@ -125,6 +137,62 @@ void QueryEngine::CreateCacheIndexes(const core::QueryOrPipeline& query,
   }
 }
 
+bool QueryEngine::ShouldUseIndex(
+    const core::QueryOrPipeline& query_or_pipeline,
+    const DocumentKeySet& remote_keys,
+    const SnapshotVersion& last_limbo_free_snapshot_version) const {
+  if (query_or_pipeline.IsPipeline() ||
+      query_or_pipeline.query().MatchesAllDocuments()) {
+    // `PerformQueryUsingIndex()` does not use an index for these.
+    return true;
+  }
+
+  Query query = query_or_pipeline.query();
+  if (query.has_limit() && index_manager_->GetIndexType(query.ToTarget()) ==
+                               IndexManager::IndexType::PARTIAL) {
+    // The limit is dropped for partial indexes, see `PerformQueryUsingIndex()`.
+    query = query.WithLimitToFirst(core::Target::kNoLimit);
+  }
+
+  absl::optional<size_t> entries_read =
+      index_manager_->EstimateIndexEntriesRead(query.ToTarget());
+  if (!entries_read.has_value()) {
+    return true;
+  }
+  const double index_cost =
+      static_cast<double>(entries_read.value()) *
+      relative_index_read_cost_per_document_;
+
+  // Both alternatives read every document they consider once.
+  if (last_limbo_free_snapshot_version != SnapshotVersion::None() &&
+      static_cast<double>(remote_keys.size()) < index_cost) {
+    LOG_DEBUG(
+        "Skipping the index for query %s: it reads about %s entries, and the "
+        "previous result has %s documents.",
+        query.ToString(), entries_read.value(), remote_keys.size());
+    return false;
+  }
+
+  auto collection_size = collection_sizes_.find(CollectionSizeKey(query));
+  if (collection_size != collection_sizes_.end() &&
+      static_cast<double>(collection_size->second) < index_cost) {
+    LOG_DEBUG(
+        "Skipping the index for query %s: it reads about %s entries, and the "
+        "collection scan read %s documents.",
+        query.ToString(), entries_read.value(), collection_size->second);
+    return false;
+  }
+
+  return true;
+}
+
+std::string QueryEngine::CollectionSizeKey(const Query& query) {
+  if (query.IsCollectionGroupQuery()) {
+    return absl::StrCat("group:", *query.collection_group());
+  }
+  return query.path().CanonicalString();
+}
+
 void QueryEngine::SetIndexAutoCreationEnabled(bool is_enabled) {
   index_auto_creation_enabled_ = is_enabled;
 }
@@ -165,24 +233,44 @@ absl::optional<DocumentMap> QueryEngine::PerformQueryUsingIndex(
     return PerformQueryUsingIndex(core::QueryOrPipeline(query_with_limit));
   }
 
-  auto keys = index_manager_->GetDocumentsMatchingTarget(target);
-  HARD_ASSERT(
-      keys.has_value(),
-      "index manager must return results for partial and full indexes.");
-
+  // The index is read in query order. For limit-to-first queries, only as
+  // many entries are read as needed to find `limit` documents that still
+  // match once local edits are applied.
+  core::Target read_target = target;
   DocumentKeySet remote_keys;
-  for (auto key : keys.value()) {
-    remote_keys = remote_keys.insert(key);
+  DocumentSet previous_results(query_or_pipeline.Comparator());
+  bool read_enough = false;
+  for (;;) {
+    auto keys = index_manager_->GetDocumentsMatchingTarget(read_target);
+    HARD_ASSERT(
+        keys.has_value(),
+        "index manager must return results for partial and full indexes.");
+
+    remote_keys = DocumentKeySet();
+    for (auto key : keys.value()) {
+      remote_keys = remote_keys.insert(key);
+    }
+
+    DocumentMap indexedDocuments =
+        local_documents_view_->GetDocuments(remote_keys);
+    previous_results = ApplyQuery(query_or_pipeline, indexedDocuments);
+
+    absl::optional<int32_t> read_limit =
+        NextIndexReadLimit(query, read_target, remote_keys.size(),
+                           previous_results.size(), &read_enough);
+    if (!read_limit.has_value()) {
+      break;
+    }
+    read_target = query.WithLimitToFirst(read_limit.value()).ToTarget();
   }
 
-  DocumentMap indexedDocuments =
-      local_documents_view_->GetDocuments(remote_keys);
   model::IndexOffset offset = index_manager_->GetMinOffset(target);
-
-  DocumentSet previous_results =
-      ApplyQuery(query_or_pipeline, indexedDocuments);
-  if (NeedsRefill(query_or_pipeline, previous_results, remote_keys,
-                  offset.read_time())) {
+  bool needs_refill =
+      read_enough
+          ? LimitEdgeChanged(query, previous_results, offset.read_time())
+          : NeedsRefill(query_or_pipeline, previous_results, remote_keys,
+                        offset.read_time());
+  if (needs_refill) {
     // A limit query whose boundaries change due to local edits can be re-run
     // against the cache by excluding the limit. This ensures that all documents
     // that match the query's filters are included in the result set. The SDK
@@ -197,6 +285,47 @@ absl::optional<DocumentMap> QueryEngine::PerformQueryUsingIndex(
   return AppendRemainingResults(previous_results, query_or_pipeline, offset);
 }
 
+absl::optional<int32_t> QueryEngine::NextIndexReadLimit(
+    const Query& query,
+    const core::Target& read_target,
+    size_t keys_read,
+    size_t matches,
+    bool* read_enough) const {
+  *read_enough = false;
+  if (!query.has_limit_to_first() || keys_read == matches) {
+    // Either no limit is applied or the usual refill check suffices.
+    return absl::nullopt;
+  }
+
+  const auto read_limit = static_cast<size_t>(read_target.limit());
+  if (keys_read < read_limit) {
+    // Every range of the index has been read to its end.
+    *read_enough = true;
+    return absl::nullopt;
+  }
+
+  // Each index range yields up to `read_limit` entries, of which at most
+  // `keys_read - matches` no longer match. If that still leaves `limit`
+  // entries per range, the first `limit` matches of every range were read.
+  const size_t non_matching = keys_read - matches;
+  const auto limit = static_cast<size_t>(query.limit());
+  if (read_limit >= limit + non_matching) {
+    *read_enough = true;
+    return absl::nullopt;
+  }
+
+  // Reading at least twice as far each time bounds the number of rounds.
+  size_t next_limit = std::max(2 * read_limit, limit + non_matching);
+  if (next_limit >= static_cast<size_t>(core::Target::kNoLimit)) {
+    return absl::nullopt;
+  }
+  LOG_DEBUG(
+      "Reading %s index entries for query %s, since %s of %s entries no "
+      "longer match.",
+      next_limit, query.ToString(), non_matching, keys_read);
+  return static_cast<int32_t>(next_limit);
+}
+
 absl::optional<DocumentMap> QueryEngine::PerformQueryUsingRemoteKeys(
     const core::QueryOrPipeline& query,
     const DocumentKeySet& remote_keys,
@@ -236,17 +365,16 @@ DocumentSet QueryEngine::ApplyQuery(const core::QueryOrPipeline& query,
                                     const DocumentMap& documents) const {
   // Sort the documents and re-apply the query filter since previously matching
   // documents do not necessarily still match the query.
-  DocumentSet query_results(query.Comparator());
-
+  std::vector<Document> matches;
   for (const auto& document_entry : documents) {
     const Document& doc = document_entry.second;
     if (doc->is_found_document()) {
       if (query.Matches(doc)) {
-        query_results = query_results.insert(doc);
+        matches.push_back(doc);
       }
     }
   }
-  return query_results;
+  return DocumentSet(query.Comparator(), std::move(matches));
 }
 
 bool QueryEngine::NeedsRefill(
@@ -273,6 +401,14 @@ bool QueryEngine::NeedsRefill(
     return true;
   }
 
+  return LimitEdgeChanged(query, sorted_previous_results,
+                          limbo_free_snapshot_version);
+}
+
+bool QueryEngine::LimitEdgeChanged(
+    const Query& query,
+    const DocumentSet& sorted_previous_results,
+    const SnapshotVersion& limbo_free_snapshot_version) const {
   // Limit queries are not eligible for index-free query execution if there is a
   // potential that an older document from cache now sorts before a document
   // that was previously part of the limit.
@@ -17,6 +17,9 @@
 #ifndef FIRESTORE_CORE_SRC_LOCAL_QUERY_ENGINE_H_
 #define FIRESTORE_CORE_SRC_LOCAL_QUERY_ENGINE_H_
 
+#include <string>
+#include <unordered_map>
+
 #include "Firestore/core/src/core/pipeline_util.h"  // Added for QueryOrPipeline
 #include "Firestore/core/src/model/model_fwd.h"
 
@@ -46,7 +49,10 @@ class QueryContext;
  * optimize the query by re-using a previously persisted query result. If that
  * is not possible, the query will be executed via a full collection scan.
  *
- * Index-based execution is the default when available. The query engine
+ * Index-based execution is the default when available, unless the index
+ * statistics estimate that the index reads more documents than one of the
+ * other modes, based on the size of the previous result or of the last scan
+ * of the collection. The query engine
  * supports partial indexed execution and merges the result from the index
  * lookup with documents that have not yet been indexed. The index evaluation
  * matches the backend's format and as such, the SDK can use indexing for all
@@ -86,6 +92,19 @@ class QueryEngine {
   friend class IndexManagerTest;
   friend class LocalStoreTestBase;
 
+  /**
+   * Returns whether an index scan is estimated to be cheaper than a scan of the
+   * previous result or of the whole collection. Returns true if there are no
+   * statistics to base the estimate on.
+   */
+  bool ShouldUseIndex(
+      const core::QueryOrPipeline& query_or_pipeline,
+      const model::DocumentKeySet& remote_keys,
+      const model::SnapshotVersion& last_limbo_free_snapshot_version) const;
+
+  /** Returns the key of the query's collection in `collection_sizes_`. */
+  static std::string CollectionSizeKey(const core::Query& query);
+
   /**
    * Performs an indexed query that evaluates the query based on a collection's
    * persisted index values. Returns nullopt if an index is not available.
@@ -124,6 +143,28 @@ class QueryEngine {
       const model::DocumentKeySet& remote_keys,
       const model::SnapshotVersion& limbo_free_snapshot_version) const;
 
+  /**
+   * Returns whether the edge of a limit query's results was modified after
+   * `limbo_free_snapshot_version`, in which case documents beyond it may now
+   * sort within the limit.
+   */
+  bool LimitEdgeChanged(
+      const core::Query& query,
+      const model::DocumentSet& sorted_previous_results,
+      const model::SnapshotVersion& limbo_free_snapshot_version) const;
+
+  /**
+   * Returns the number of index entries per range to read for a limit query
+   * whose index scan of `read_target` read `keys_read` documents, of which
+   * `matches` still match, or `nullopt` to stop reading. Sets `read_enough` if
+   * the entries read contain every document the limit can select.
+   */
+  absl::optional<int32_t> NextIndexReadLimit(const core::Query& query,
+                                             const core::Target& read_target,
+                                             size_t keys_read,
+                                             size_t matches,
+                                             bool* read_enough) const;
+
   const model::DocumentMap ExecuteFullCollectionScan(
       const core::QueryOrPipeline& query_or_pipeline,
       absl::optional<QueryContext>& context) const;
@@ -153,6 +194,12 @@ class QueryEngine {
 
   double relative_index_read_cost_per_document_;
 
+  /**
+   * The number of documents read by the last full scan of each collection or
+   * collection group.
+   */
+  mutable std::unordered_map<std::string, size_t> collection_sizes_;
+
   // For testing
   void SetIndexAutoCreationMinCollectionSize(size_t new_min) {
     index_auto_creation_min_collection_size_ = new_min;
@@ -19,6 +19,7 @@
 
 #include <functional>
 #include <unordered_map>
+#include <vector>
 
 #include "Firestore/core/src/core/pipeline_util.h"  // Added for TargetOrPipeline
 #include "Firestore/core/src/model/model_fwd.h"
@@ -124,6 +125,22 @@ class TargetCache {
 
   virtual bool Contains(const model::DocumentKey& key) = 0;
 
+  /**
+   * Stores the keys of the documents in the last result of a listener of the
+   * given target, in the order of the result. They are removed with the
+   * target.
+   */
+  virtual void SetLastResultKeys(
+      model::TargetId target_id,
+      const std::vector<model::DocumentKey>& keys) = 0;
+
+  /**
+   * Returns the keys stored by `SetLastResultKeys()` for the given target, or
+   * an empty list if there are none.
+   */
+  virtual std::vector<model::DocumentKey> GetLastResultKeys(
+      model::TargetId target_id) = 0;
+
   // Accessors
 
   /** Returns the number of targets cached. */
@@ -16,7 +16,10 @@
 
 #include "Firestore/core/src/model/document_key.h"
 
+#include <algorithm>
+#include <mutex>
 #include <ostream>
+#include <unordered_map>
 #include <utility>
 
 #include "Firestore/core/src/model/resource_path.h"
@@ -34,6 +37,58 @@ void AssertValidPath(const ResourcePath& path) {
               path.CanonicalString());
 }
 
+/**
+ * The paths of the interned document keys, by hash. Entries are weak so that
+ * a path is freed with its last key. The entries of freed paths are dropped
+ * as lookups find them, and all at once whenever the pool doubles in size.
+ */
+class InternedPaths {
+ public:
+  std::shared_ptr<const ResourcePath> Intern(ResourcePath&& path) {
+    size_t hash = path.Hash();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto range = paths_.equal_range(hash);
+    for (auto iter = range.first; iter != range.second;) {
+      std::shared_ptr<const ResourcePath> existing = iter->second.lock();
+      if (!existing) {
+        iter = paths_.erase(iter);
+      } else if (*existing == path) {
+        return existing;
+      } else {
+        ++iter;
+      }
+    }
+
+    auto result = std::make_shared<const ResourcePath>(std::move(path));
+    paths_.emplace(hash, result);
+    if (paths_.size() > sweep_threshold_) {
+      Sweep();
+    }
+    return result;
+  }
+
+ private:
+  static constexpr size_t kMinSweepThreshold = 1024;
+
+  void Sweep() {
+    for (auto iter = paths_.begin(); iter != paths_.end();) {
+      if (iter->second.expired()) {
+        iter = paths_.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+    sweep_threshold_ = std::max(kMinSweepThreshold, paths_.size() * 2);
+  }
+
+  std::mutex mutex_;
+  std::unordered_multimap<size_t, std::weak_ptr<const ResourcePath>> paths_;
+  size_t sweep_threshold_ = kMinSweepThreshold;
+};
+
+constexpr size_t InternedPaths::kMinSweepThreshold;
+
 }  // namespace
 
 DocumentKey::DocumentKey() : path_{std::make_shared<ResourcePath>()} {
@@ -49,6 +104,10 @@ DocumentKey::DocumentKey(ResourcePath&& path)
   AssertValidPath(*path_);
 }
 
+DocumentKey::DocumentKey(std::shared_ptr<const ResourcePath> path)
+    : path_{std::move(path)} {
+}
+
 DocumentKey DocumentKey::FromPathString(const std::string& path) {
   return DocumentKey{ResourcePath::FromString(path)};
 }
@@ -66,6 +125,12 @@ DocumentKey DocumentKey::FromName(const std::string& name) {
   return DocumentKey{resource_name.PopFirst(5)};
 }
 
+DocumentKey DocumentKey::Intern(ResourcePath&& path) {
+  AssertValidPath(path);
+  static auto* interned_paths = new InternedPaths();
+  return DocumentKey{interned_paths->Intern(std::move(path))};
+}
+
 const DocumentKey& DocumentKey::Empty() {
   static const DocumentKey* empty = new DocumentKey();
   return *empty;
@@ -76,11 +141,14 @@ bool DocumentKey::IsDocumentKey(const ResourcePath& path) {
 }
 
 util::ComparisonResult DocumentKey::CompareTo(const DocumentKey& other) const {
+  if (path_ == other.path_) {
+    return util::ComparisonResult::Same;
+  }
   return path().CompareTo(other.path());
 }
 
 bool operator==(const DocumentKey& lhs, const DocumentKey& rhs) {
-  return lhs.path() == rhs.path();
+  return lhs.path_ == rhs.path_ || lhs.path() == rhs.path();
 }
 
 bool operator<(const DocumentKey& lhs, const DocumentKey& rhs) {
@@ -91,7 +159,7 @@ bool operator>(const DocumentKey& lhs, const DocumentKey& rhs) {
 }
 
 size_t DocumentKey::Hash() const {
-  return util::Hash(ToString());
+  return path().Hash();
 }
 
 std::string DocumentKey::ToString() const {
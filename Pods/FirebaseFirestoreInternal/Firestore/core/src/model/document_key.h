@@ -63,6 +63,15 @@ class DocumentKey {
   /** Returns a DocumentKey from a fully qualified resource name. */
   static DocumentKey FromName(const std::string& name);
 
+  /**
+   * Creates a document key for the given path that shares its storage with
+   * every other live interned key for an equal path, so that keys decoded
+   * repeatedly take no extra memory and compare equal by identity.
+   *
+   * This is thread-safe.
+   */
+  static DocumentKey Intern(ResourcePath&& path);
+
   /** Returns a shared instance of an empty document key. */
   static const DocumentKey& Empty();
 
@@ -89,6 +98,8 @@ class DocumentKey {
   absl::optional<std::string> GetCollectionGroup() const;
 
  private:
+  explicit DocumentKey(std::shared_ptr<const ResourcePath> path);
+
   // This is an optimization to make passing DocumentKey around cheaper (it's
   // copied often).
   std::shared_ptr<const ResourcePath> path_;
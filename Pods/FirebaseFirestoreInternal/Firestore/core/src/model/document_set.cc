@@ -16,8 +16,10 @@
 
 #include "Firestore/core/src/model/document_set.h"
 
+#include <algorithm>
 #include <ostream>
 #include <utility>
+#include <vector>
 
 #include "Firestore/core/src/immutable/sorted_set.h"
 #include "Firestore/core/src/model/document_key.h"
@@ -46,6 +48,30 @@ DocumentSet::DocumentSet(DocumentComparator&& comparator)
     : index_{}, sorted_set_{std::move(comparator)} {
 }
 
+DocumentSet::DocumentSet(DocumentComparator&& comparator,
+                         std::vector<Document> documents)
+    : index_{}, sorted_set_{comparator} {
+  // Documents usually come from a DocumentMap, already in key order.
+  auto by_key = [](const Document& lhs, const Document& rhs) {
+    return lhs->key() < rhs->key();
+  };
+  if (!std::is_sorted(documents.begin(), documents.end(), by_key)) {
+    std::sort(documents.begin(), documents.end(), by_key);
+  }
+  std::vector<std::pair<DocumentKey, Document>> entries;
+  entries.reserve(documents.size());
+  for (const Document& doc : documents) {
+    entries.emplace_back(doc->key(), doc);
+  }
+  index_ = DocumentMap::FromSorted(entries);
+
+  std::sort(documents.begin(), documents.end(),
+            [&comparator](const Document& lhs, const Document& rhs) {
+              return util::Ascending(comparator.Compare(lhs, rhs));
+            });
+  sorted_set_ = SetType::FromSorted(documents, std::move(comparator));
+}
+
 bool operator==(const DocumentSet& lhs, const DocumentSet& rhs) {
   return absl::c_equal(lhs.sorted_set_, rhs.sorted_set_);
 }
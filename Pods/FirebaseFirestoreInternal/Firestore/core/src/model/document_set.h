@@ -69,6 +69,15 @@ class DocumentSet : public immutable::SortedContainer {
    */
   explicit DocumentSet(DocumentComparator&& comparator);
 
+  /**
+   * Creates a new DocumentSet sorted by the given comparator, then by keys,
+   * containing the given documents, which must have distinct keys. Both
+   * collections of the set are built in a single pass after sorting, rather
+   * than by inserting documents one at a time.
+   */
+  DocumentSet(DocumentComparator&& comparator,
+              std::vector<Document> documents);
+
   size_t size() const {
     return index_.size();
   }
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "Firestore/core/src/model/field_accessor.h"
+
+#include "Firestore/core/src/model/object_value.h"
+#include "Firestore/core/src/model/value_util.h"
+#include "Firestore/core/src/nanopb/nanopb_util.h"
+
+namespace firebase {
+namespace firestore {
+namespace model {
+
+FieldAccessor::FieldAccessor(FieldPath path)
+    : path_(std::move(path)),
+      hints_(std::make_shared<std::vector<std::atomic<pb_size_t>>>(
+          path_.size())) {
+}
+
+absl::optional<google_firestore_v1_Value> FieldAccessor::Get(
+    const ObjectValue& object_value) const {
+  google_firestore_v1_Value nested_value = object_value.Get();
+  for (size_t i = 0; i < path_.size(); ++i) {
+    if (!IsMap(nested_value)) return absl::nullopt;
+    const google_firestore_v1_MapValue& map_value = nested_value.map_value;
+    absl::string_view segment = path_[i];
+
+    std::atomic<pb_size_t>& hint = (*hints_)[i];
+    pb_size_t index = hint.load(std::memory_order_relaxed);
+    if (index >= map_value.fields_count ||
+        nanopb::MakeStringView(map_value.fields[index].key) != segment) {
+      index = ObjectValue::FindSortedEntry(map_value, segment);
+      if (index == map_value.fields_count) return absl::nullopt;
+      hint.store(index, std::memory_order_relaxed);
+    }
+
+    nested_value = map_value.fields[index].value;
+  }
+  return nested_value;
+}
+
+}  // namespace model
+}  // namespace firestore
+}  // namespace firebase
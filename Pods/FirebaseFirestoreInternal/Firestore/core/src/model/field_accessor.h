@@ -0,0 +1,77 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef FIRESTORE_CORE_SRC_MODEL_FIELD_ACCESSOR_H_
+#define FIRESTORE_CORE_SRC_MODEL_FIELD_ACCESSOR_H_
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Firestore/Protos/nanopb/google/firestore/v1/document.nanopb.h"
+#include "Firestore/core/src/model/field_path.h"
+#include "absl/types/optional.h"
+
+namespace firebase {
+namespace firestore {
+namespace model {
+
+class ObjectValue;
+
+/**
+ * Looks up the value of a field path in the data of many documents, as a
+ * filter or sort order does.
+ *
+ * The documents of a collection usually have the same fields, and since an
+ * ObjectValue keeps the fields of its maps sorted, each segment of the path is
+ * usually found at the same position in every document. A FieldAccessor
+ * remembers where it last found each segment and looks there first, falling
+ * back to a binary search.
+ *
+ * Copies of a FieldAccessor share these positions. They are only ever used as
+ * a guess, so a FieldAccessor may be used from several threads at once.
+ */
+class FieldAccessor {
+ public:
+  FieldAccessor() = default;
+
+  explicit FieldAccessor(FieldPath path);
+
+  const FieldPath& path() const {
+    return path_;
+  }
+
+  /**
+   * Returns the value at this accessor's path in `object_value`, or nullopt if
+   * there is none. If the path is empty, the whole value is returned.
+   */
+  absl::optional<google_firestore_v1_Value> Get(
+      const ObjectValue& object_value) const;
+
+ private:
+  FieldPath path_;
+
+  /** For each segment of `path_`, the index at which it was last found. */
+  std::shared_ptr<std::vector<std::atomic<pb_size_t>>> hints_;
+};
+
+}  // namespace model
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_MODEL_FIELD_ACCESSOR_H_
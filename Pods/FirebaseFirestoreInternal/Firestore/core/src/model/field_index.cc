@@ -115,7 +115,9 @@ util::ComparisonResult FieldIndex::SemanticCompare(const FieldIndex& left,
                : util::ComparisonResult::Descending;
   }
 
-  return util::ComparisonResult::Same;
+  // Indexes that store different fields hold different entries, so changing
+  // the stored fields of an index replaces it.
+  return util::CompareContainer(left.stored_fields(), right.stored_fields());
 }
 
 absl::optional<Segment> FieldIndex::GetArraySegment() const {
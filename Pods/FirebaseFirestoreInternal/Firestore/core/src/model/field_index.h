@@ -251,11 +251,13 @@ class FieldIndex {
   FieldIndex(int32_t index_id,
              std::string collection_group,
              std::vector<Segment> segments,
-             IndexState state)
+             IndexState state,
+             std::vector<FieldPath> stored_fields = {})
       : index_id_(index_id),
         collection_group_(std::move(collection_group)),
         segments_(std::move(segments)),
         state_(std::move(state)),
+        stored_fields_(std::move(stored_fields)),
         unique_id_(ref_count_.fetch_add(1, std::memory_order_acq_rel)) {
   }
 
@@ -265,6 +267,7 @@ class FieldIndex {
         collection_group_(other.collection_group_),
         segments_(other.segments_),
         state_(other.state_),
+        stored_fields_(other.stored_fields_),
         unique_id_(ref_count_.fetch_add(1, std::memory_order_acq_rel)) {
   }
 
@@ -275,6 +278,7 @@ class FieldIndex {
       collection_group_ = other.collection_group_;
       segments_ = other.segments_;
       state_ = other.state_;
+      stored_fields_ = other.stored_fields_;
       unique_id_ = ref_count_.fetch_add(1, std::memory_order_acq_rel);
     }
     return *this;
@@ -286,6 +290,7 @@ class FieldIndex {
         collection_group_(std::move(other.collection_group_)),
         segments_(std::move(other.segments_)),
         state_(std::move(other.state_)),
+        stored_fields_(std::move(other.stored_fields_)),
         unique_id_(ref_count_.fetch_add(1, std::memory_order_acq_rel)) {
   }
 
@@ -296,6 +301,7 @@ class FieldIndex {
       collection_group_ = std::move(other.collection_group_);
       segments_ = std::move(other.segments_);
       state_ = std::move(other.state_);
+      stored_fields_ = std::move(other.stored_fields_);
       unique_id_ = ref_count_.fetch_add(1, std::memory_order_acq_rel);
     }
     return *this;
@@ -324,6 +330,15 @@ class FieldIndex {
     return state_;
   }
 
+  /**
+   * Returns the fields whose values are stored in the entries of this index,
+   * in addition to the values of its segments. Reads that only need these
+   * fields can be answered from the index without reading the documents.
+   */
+  const std::vector<FieldPath>& stored_fields() const {
+    return stored_fields_;
+  }
+
   /** Returns all directional (ascending/descending) segments for this index. */
   std::vector<Segment> GetDirectionalSegments() const;
 
@@ -361,6 +376,7 @@ class FieldIndex {
   std::string collection_group_;
   std::vector<Segment> segments_;
   IndexState state_;
+  std::vector<FieldPath> stored_fields_;
   int unique_id_;
 
   // TODO(C++17): Replace with inline static std::atomic<int> ref_count_ = 0;
@@ -370,7 +386,8 @@ class FieldIndex {
 inline bool operator==(const FieldIndex& lhs, const FieldIndex& rhs) {
   return lhs.index_id_ == rhs.index_id_ &&
          lhs.collection_group_ == rhs.collection_group_ &&
-         lhs.segments_ == rhs.segments_ && lhs.state_ == rhs.state_;
+         lhs.segments_ == rhs.segments_ && lhs.state_ == rhs.state_ &&
+         lhs.stored_fields_ == rhs.stored_fields_;
 }
 
 inline bool operator!=(const FieldIndex& lhs, const FieldIndex& rhs) {
@@ -24,6 +24,7 @@
 
 #include "Firestore/Protos/nanopb/google/firestore/v1/document.nanopb.h"
 #include "Firestore/core/src/model/document_key.h"
+#include "Firestore/core/src/model/field_accessor.h"
 #include "Firestore/core/src/model/object_value.h"
 #include "Firestore/core/src/model/snapshot_version.h"
 
@@ -193,6 +194,15 @@ class MutableDocument {
     return value_->Get(field_path);
   }
 
+  /**
+   * Returns the value at the path of the given accessor or absl::nullopt. Use
+   * this to look up the same field in many documents.
+   */
+  absl::optional<google_firestore_v1_Value> field(
+      const FieldAccessor& accessor) const {
+    return accessor.Get(*value_);
+  }
+
   bool is_valid_document() const {
     return document_type_ != DocumentType ::kInvalid;
   }
@@ -147,7 +147,7 @@ void ApplyChanges(
     FreeFieldsArray(&source_fields[source_index]);
   }
 
-  free(parent->fields);
+  pb_free(parent->fields);
   parent->fields = target_fields;
   parent->fields_count = CheckedSize(target_count);
 }
@@ -269,19 +269,21 @@ absl::optional<google_firestore_v1_Value> ObjectValue::Get(
 
   google_firestore_v1_Value nested_value = *value_;
   for (const std::string& segment : path) {
-    google_firestore_v1_MapValue_FieldsEntry* entry =
-        FindEntry(nested_value, segment);
-    if (!entry) return absl::nullopt;
-    nested_value = entry->value;
+    if (!IsMap(nested_value)) return absl::nullopt;
+    const google_firestore_v1_MapValue& map_value = nested_value.map_value;
+    pb_size_t index = FindSortedEntry(map_value, segment);
+    if (index == map_value.fields_count) return absl::nullopt;
+    nested_value = map_value.fields[index].value;
   }
   return nested_value;
 }
 
 absl::optional<google_firestore_v1_Value> ObjectValue::Get(
     const std::string& key) const {
-  google_firestore_v1_MapValue_FieldsEntry* entry = FindEntry(*value_, key);
-  if (!entry) return absl::nullopt;
-  return entry->value;
+  const google_firestore_v1_MapValue& map_value = value_->map_value;
+  pb_size_t index = FindSortedEntry(map_value, key);
+  if (index == map_value.fields_count) return absl::nullopt;
+  return map_value.fields[index].value;
 }
 
 google_firestore_v1_Value ObjectValue::Get() const {
@@ -357,6 +359,21 @@ size_t ObjectValue::Hash() const {
   return util::Hash(CanonicalId(*value_));
 }
 
+pb_size_t ObjectValue::FindSortedEntry(
+    const google_firestore_v1_MapValue& map_value, absl::string_view key) {
+  const google_firestore_v1_MapValue_FieldsEntry* begin = map_value.fields;
+  const google_firestore_v1_MapValue_FieldsEntry* end =
+      begin + map_value.fields_count;
+  const auto* entry = std::lower_bound(
+      begin, end, key,
+      [](const google_firestore_v1_MapValue_FieldsEntry& entry,
+         absl::string_view key) { return MakeStringView(entry.key) < key; });
+  if (entry == end || MakeStringView(entry->key) != key) {
+    return map_value.fields_count;
+  }
+  return static_cast<pb_size_t>(entry - begin);
+}
+
 google_firestore_v1_MapValue* ObjectValue::ParentMap(const FieldPath& path) {
   google_firestore_v1_Value* parent = value_.get();
 
@@ -33,6 +33,7 @@
 #include "Firestore/core/src/util/hard_assert.h"
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
 
 namespace firebase {
@@ -146,6 +147,16 @@ class ObjectValue {
                                   const ObjectValue& object_value);
 
  private:
+  friend class FieldAccessor;
+
+  /**
+   * Returns the index of the entry with the given key in `map_value`, or
+   * `map_value.fields_count` if there is none. The maps of an ObjectValue
+   * always keep their fields sorted by key, so this is a binary search.
+   */
+  static pb_size_t FindSortedEntry(
+      const google_firestore_v1_MapValue& map_value, absl::string_view key);
+
   /** Returns the field mask for the provided map value. */
   FieldMask ExtractFieldMask(const google_firestore_v1_MapValue& value) const;
 
@@ -116,12 +116,17 @@ void SortFields(google_firestore_v1_ArrayValue& value) {
 }
 
 void SortFields(google_firestore_v1_MapValue& value) {
-  std::sort(value.fields, value.fields + value.fields_count,
-            [](const google_firestore_v1_MapValue_FieldsEntry& lhs,
-               const google_firestore_v1_MapValue_FieldsEntry& rhs) {
-              return nanopb::MakeStringView(lhs.key) <
-                     nanopb::MakeStringView(rhs.key);
-            });
+  auto less = [](const google_firestore_v1_MapValue_FieldsEntry& lhs,
+                 const google_firestore_v1_MapValue_FieldsEntry& rhs) {
+    return nanopb::MakeStringView(lhs.key) < nanopb::MakeStringView(rhs.key);
+  };
+  // The backend and the local cache both send the fields of a map sorted by
+  // key, which is much cheaper to check for than to sort again.
+  google_firestore_v1_MapValue_FieldsEntry* end =
+      value.fields + value.fields_count;
+  if (!std::is_sorted(value.fields, end, less)) {
+    std::sort(value.fields, end, less);
+  }
 
   for (pb_size_t i = 0; i < value.fields_count; ++i) {
     SortFields(value.fields[i].value);
@@ -278,7 +283,7 @@ ComparisonResult CompareVectors(const google_firestore_v1_Value& left,
 
   pb_size_t rightArrayLength = 0;
   google_firestore_v1_Value rightArray;
-  if (leftIndex.has_value()) {
+  if (rightIndex.has_value()) {
     rightArray = right.map_value.fields[rightIndex.value()].value;
     rightArrayLength = rightArray.array_value.values_count;
   }
@@ -293,7 +298,28 @@ ComparisonResult CompareVectors(const google_firestore_v1_Value& left,
     return lengthCompare;
   }
 
-  return CompareArrays(leftArray, rightArray);
+  // Vector components are almost always doubles, which are compared directly
+  // rather than through the type ordering of Compare().
+  for (pb_size_t i = 0; i < leftArrayLength; ++i) {
+    const google_firestore_v1_Value& leftComponent =
+        leftArray.array_value.values[i];
+    const google_firestore_v1_Value& rightComponent =
+        rightArray.array_value.values[i];
+    ComparisonResult cmp;
+    if (leftComponent.which_value_type ==
+            google_firestore_v1_Value_double_value_tag &&
+        rightComponent.which_value_type ==
+            google_firestore_v1_Value_double_value_tag) {
+      cmp = util::Compare(leftComponent.double_value,
+                          rightComponent.double_value);
+    } else {
+      cmp = Compare(leftComponent, rightComponent);
+    }
+    if (cmp != ComparisonResult::Same) {
+      return cmp;
+    }
+  }
+  return ComparisonResult::Same;
 }
 
 ComparisonResult Compare(const google_firestore_v1_Value& left,
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/model/vector_distance.h"
+
+#include <cmath>
+
+#include "Firestore/core/src/model/value_util.h"
+
+namespace firebase {
+namespace firestore {
+namespace model {
+namespace {
+
+/**
+ * The number of independent partial sums the kernels keep. Partial sums break
+ * the dependency between successive additions, which lets the compiler keep
+ * them in SIMD lanes.
+ */
+constexpr size_t kLanes = 4;
+
+}  // namespace
+
+bool GetVectorComponents(const google_firestore_v1_Value& value,
+                         std::vector<double>* components) {
+  components->clear();
+  if (!IsVectorValue(value)) {
+    return false;
+  }
+
+  absl::optional<pb_size_t> index = IndexOfKey(
+      value.map_value, kRawVectorValueFieldKey, kVectorValueFieldKey);
+  const google_firestore_v1_ArrayValue& array =
+      value.map_value.fields[index.value()].value.array_value;
+  components->reserve(array.values_count);
+  for (pb_size_t i = 0; i < array.values_count; ++i) {
+    const google_firestore_v1_Value& component = array.values[i];
+    if (component.which_value_type ==
+        google_firestore_v1_Value_double_value_tag) {
+      components->push_back(component.double_value);
+    } else if (component.which_value_type ==
+               google_firestore_v1_Value_integer_value_tag) {
+      components->push_back(static_cast<double>(component.integer_value));
+    } else {
+      components->clear();
+      return false;
+    }
+  }
+  return true;
+}
+
+double DotProduct(const double* left, const double* right, size_t size) {
+  double sums[kLanes] = {};
+  size_t i = 0;
+  for (; i + kLanes <= size; i += kLanes) {
+    for (size_t lane = 0; lane < kLanes; ++lane) {
+      sums[lane] += left[i + lane] * right[i + lane];
+    }
+  }
+  for (; i < size; ++i) {
+    sums[0] += left[i] * right[i];
+  }
+  return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+
+double EuclideanDistance(const double* left, const double* right, size_t size) {
+  double sums[kLanes] = {};
+  size_t i = 0;
+  for (; i + kLanes <= size; i += kLanes) {
+    for (size_t lane = 0; lane < kLanes; ++lane) {
+      double difference = left[i + lane] - right[i + lane];
+      sums[lane] += difference * difference;
+    }
+  }
+  for (; i < size; ++i) {
+    double difference = left[i] - right[i];
+    sums[0] += difference * difference;
+  }
+  return std::sqrt((sums[0] + sums[1]) + (sums[2] + sums[3]));
+}
+
+absl::optional<double> CosineDistance(const double* left,
+                                      const double* right,
+                                      size_t size) {
+  // The dot product and both magnitudes are summed in a single pass.
+  double dot[kLanes] = {};
+  double left_squares[kLanes] = {};
+  double right_squares[kLanes] = {};
+  size_t i = 0;
+  for (; i + kLanes <= size; i += kLanes) {
+    for (size_t lane = 0; lane < kLanes; ++lane) {
+      double l = left[i + lane];
+      double r = right[i + lane];
+      dot[lane] += l * r;
+      left_squares[lane] += l * l;
+      right_squares[lane] += r * r;
+    }
+  }
+  for (; i < size; ++i) {
+    dot[0] += left[i] * right[i];
+    left_squares[0] += left[i] * left[i];
+    right_squares[0] += right[i] * right[i];
+  }
+
+  double magnitudes =
+      std::sqrt((left_squares[0] + left_squares[1]) +
+                (left_squares[2] + left_squares[3])) *
+      std::sqrt((right_squares[0] + right_squares[1]) +
+                (right_squares[2] + right_squares[3]));
+  if (magnitudes == 0) {
+    return absl::nullopt;
+  }
+  return 1 - ((dot[0] + dot[1]) + (dot[2] + dot[3])) / magnitudes;
+}
+
+}  // namespace model
+}  // namespace firestore
+}  // namespace firebase
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_MODEL_VECTOR_DISTANCE_H_
+#define FIRESTORE_CORE_SRC_MODEL_VECTOR_DISTANCE_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "Firestore/Protos/nanopb/google/firestore/v1/document.nanopb.h"
+#include "absl/types/optional.h"
+
+namespace firebase {
+namespace firestore {
+namespace model {
+
+/**
+ * Copies the components of the VectorValue `value` into `components`, so that
+ * distances can be computed over contiguous storage.
+ *
+ * @return false if `value` is not a VectorValue or has a component that is not
+ *     a number.
+ */
+bool GetVectorComponents(const google_firestore_v1_Value& value,
+                         std::vector<double>* components);
+
+/** Returns the dot product of two vectors of `size` components. */
+double DotProduct(const double* left, const double* right, size_t size);
+
+/** Returns the euclidean distance between two vectors of `size` components. */
+double EuclideanDistance(const double* left, const double* right, size_t size);
+
+/**
+ * Returns the cosine distance, one minus the cosine similarity, between two
+ * vectors of `size` components, or `absl::nullopt` if either has a magnitude
+ * of zero.
+ */
+absl::optional<double> CosineDistance(const double* left,
+                                      const double* right,
+                                      size_t size);
+
+}  // namespace model
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_MODEL_VECTOR_DISTANCE_H_
@@ -46,6 +46,28 @@ ByteString::ByteString(absl::string_view value)
     : ByteString(value.data(), value.size()) {
 }
 
+ByteString::ByteString(const absl::Cord& value) {
+  if (value.empty()) return;
+
+  absl::optional<absl::string_view> flat = value.TryFlat();
+  if (flat) {
+    bytes_ = MakeBytesArray(flat->data(), flat->size());
+    return;
+  }
+
+  // Like MakeBytesArray, leave room for a null terminator.
+  pb_size_t size = CheckedSize(value.size());
+  bytes_ = static_cast<pb_bytes_array_t*>(
+      pb_realloc(nullptr, PB_BYTES_ARRAY_T_ALLOCSIZE(size + 1)));
+  bytes_->size = size;
+  pb_byte_t* out = bytes_->bytes;
+  for (absl::string_view chunk : value.Chunks()) {
+    std::memcpy(out, chunk.data(), chunk.size());
+    out += chunk.size();
+  }
+  bytes_->bytes[size] = '\0';
+}
+
 ByteString::ByteString(std::initializer_list<uint8_t> value)
     : ByteString(value.begin(), value.size()) {
 }
@@ -60,12 +82,12 @@ ByteString::ByteString(ByteString&& other) noexcept {
 }
 
 ByteString::~ByteString() {
-  std::free(bytes_);
+  pb_free(bytes_);
 }
 
 ByteString& ByteString::operator=(const ByteString& other) {
   if (bytes_ != other.bytes_) {
-    std::free(bytes_);
+    pb_free(bytes_);
     bytes_ = MakeBytesArray(other.data(), other.size());
   }
   return *this;
@@ -73,7 +95,7 @@ ByteString& ByteString::operator=(const ByteString& other) {
 
 ByteString& ByteString::operator=(ByteString&& other) noexcept {
   if (bytes_ != other.bytes_) {
-    std::free(bytes_);
+    pb_free(bytes_);
     bytes_ = other.bytes_;
     other.bytes_ = nullptr;
   }
@@ -95,6 +117,15 @@ pb_bytes_array_t* ByteString::release() {
   return result;
 }
 
+absl::Cord ByteString::ReleaseAsCord() {
+  pb_bytes_array_t* bytes = release();
+  if (bytes == nullptr) return absl::Cord();
+
+  absl::string_view contents(reinterpret_cast<const char*>(bytes->bytes),
+                             bytes->size);
+  return absl::MakeCordFromExternal(contents, [bytes] { pb_free(bytes); });
+}
+
 void swap(ByteString& lhs, ByteString& rhs) noexcept {
   std::swap(lhs.bytes_, rhs.bytes_);
 }
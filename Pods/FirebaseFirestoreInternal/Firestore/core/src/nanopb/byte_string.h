@@ -27,6 +27,7 @@
 #include <vector>
 
 #include "Firestore/core/src/util/comparison.h"
+#include "absl/strings/cord.h"
 #include "absl/strings/string_view.h"
 
 namespace firebase {
@@ -68,6 +69,12 @@ class ByteString : public util::Comparable<ByteString> {
    */
   explicit ByteString(absl::string_view value);
 
+  /**
+   * Creates a new `ByteString` whose backing byte array is a copy of the given
+   * cord. The chunks of the cord are copied straight into the byte array.
+   */
+  explicit ByteString(const absl::Cord& value);
+
   ByteString(std::initializer_list<uint8_t> value);
 
   ByteString(const ByteString& other);
@@ -134,6 +141,13 @@ class ByteString : public util::Comparable<ByteString> {
    */
   pb_bytes_array_t* release();
 
+  /**
+   * Releases ownership of the backing byte array into a `Cord` that refers to
+   * it without copying, for large values that are handed on as `Cord`s. This
+   * `ByteString` becomes empty.
+   */
+  absl::Cord ReleaseAsCord();
+
   /**
    * Performs a lexicographical comparison between this and the other bytes.
    */
@@ -25,6 +25,7 @@
 #include "Firestore/Protos/nanopb/google/firestore/v1/aggregation_result.nanopb.h"
 #include "Firestore/Protos/nanopb/google/firestore/v1/document.nanopb.h"
 #include "Firestore/Protos/nanopb/google/firestore/v1/firestore.nanopb.h"
+#include "Firestore/Protos/nanopb/google/rpc/status.nanopb.h"
 #include "Firestore/Protos/nanopb/google/type/latlng.nanopb.h"
 
 namespace firebase {
@@ -181,6 +182,11 @@ inline const pb_field_t* FieldsArray<firestore_NamedQuery>() {
   return firestore_NamedQuery_fields;
 }
 
+template <>
+inline const pb_field_t* FieldsArray<firestore_BundleElement>() {
+  return firestore_BundleElement_fields;
+}
+
 template <>
 inline const pb_field_t* FieldsArray<google_firestore_admin_v1_Index>() {
   return google_firestore_admin_v1_Index_fields;
@@ -191,6 +197,11 @@ inline const pb_field_t* FieldsArray<google_protobuf_Empty>() {
   return google_protobuf_Empty_fields;
 }
 
+template <>
+inline const pb_field_t* FieldsArray<google_rpc_Status>() {
+  return google_rpc_Status_fields;
+}
+
 template <>
 inline const pb_field_t* FieldsArray<google_firestore_v1_AggregationResult>() {
   return google_firestore_v1_AggregationResult_fields;
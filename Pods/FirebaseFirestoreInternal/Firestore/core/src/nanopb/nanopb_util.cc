@@ -49,7 +49,7 @@ pb_bytes_array_t* _Nullable MakeBytesArray(const void* _Nullable data,
   // embedded nulls so we shouldn't be using this as a C string under normal
   // circumstances.
   auto result = static_cast<pb_bytes_array_t*>(
-      std::malloc(PB_BYTES_ARRAY_T_ALLOCSIZE(pb_size + 1)));
+      pb_realloc(nullptr, PB_BYTES_ARRAY_T_ALLOCSIZE(pb_size + 1)));
   result->size = pb_size;
   std::memcpy(result->bytes, data, pb_size);
   result->bytes[pb_size] = '\0';
@@ -20,6 +20,7 @@
 #include <pb.h>
 
 #include <cstdlib>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
@@ -103,12 +104,13 @@ inline bool SafeReadBoolean(const bool& nanopb_boolean) {
 
 template <typename T>
 T* _Nonnull MakeArray(pb_size_t count) {
-  return static_cast<T*>(calloc(count, sizeof(T)));
+  size_t size = count * sizeof(T);
+  return static_cast<T*>(std::memset(pb_realloc(nullptr, size), 0, size));
 }
 
 template <typename T>
 T* _Nonnull ResizeArray(void* _Nonnull ptr, size_t count) {
-  return static_cast<T*>(realloc(ptr, CheckedSize(count) * sizeof(T)));
+  return static_cast<T*>(pb_realloc(ptr, CheckedSize(count) * sizeof(T)));
 }
 
 /**
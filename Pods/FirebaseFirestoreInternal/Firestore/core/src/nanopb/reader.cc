@@ -16,6 +16,9 @@
 
 #include "Firestore/core/src/nanopb/reader.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace firebase {
 namespace firestore {
 namespace nanopb {
@@ -44,6 +47,45 @@ void StringReader::Read(const pb_field_t fields[], void* dest_struct) {
   }
 }
 
+CordReader::CordReader(absl::Cord cord)
+    : cord_(std::move(cord)), position_(cord_.char_begin()) {
+  absl::optional<absl::string_view> flat = cord_.TryFlat();
+  if (flat) {
+    stream_ = pb_istream_from_buffer(
+        reinterpret_cast<const pb_byte_t*>(flat->data()), flat->size());
+    return;
+  }
+
+  stream_.callback = ReadFromChunks;
+  stream_.state = this;
+  stream_.bytes_left = cord_.size();
+}
+
+bool CordReader::ReadFromChunks(pb_istream_t* stream,
+                                pb_byte_t* buf,
+                                size_t count) {
+  auto reader = static_cast<CordReader*>(stream->state);
+  while (count > 0) {
+    if (reader->position_ == reader->cord_.char_end()) return false;
+
+    absl::string_view chunk = absl::Cord::ChunkRemaining(reader->position_);
+    size_t n = std::min(count, chunk.size());
+    std::memcpy(buf, chunk.data(), n);
+    buf += n;
+    count -= n;
+    absl::Cord::Advance(&reader->position_, n);
+  }
+  return true;
+}
+
+void CordReader::Read(const pb_field_t fields[], void* dest_struct) {
+  if (!ok()) return;
+
+  if (!pb_decode(&stream_, fields, dest_struct)) {
+    Fail(PB_GET_ERROR(&stream_));
+  }
+}
+
 }  // namespace nanopb
 }  // namespace firestore
 }  // namespace firebase
@@ -28,6 +28,7 @@
 #include "Firestore/core/src/nanopb/byte_string.h"
 #include "Firestore/core/src/util/read_context.h"
 #include "Firestore/core/src/util/status.h"
+#include "absl/strings/cord.h"
 #include "absl/strings/string_view.h"
 
 namespace firebase {
@@ -142,6 +143,33 @@ class StringReader : public Reader {
   pb_istream_t stream_{};
 };
 
+/**
+ * A `Reader` that reads from an `absl::Cord`. The chunks of the cord are
+ * shared rather than copied: a flat cord is decoded in place, and otherwise
+ * the stream reads across the chunks in turn, so that the cord is never
+ * flattened.
+ */
+class CordReader : public Reader {
+ public:
+  explicit CordReader(absl::Cord cord);
+
+  // The stream refers back to this reader.
+  CordReader(const CordReader&) = delete;
+  CordReader& operator=(const CordReader&) = delete;
+
+  void Read(const pb_field_t fields[], void* dest_struct) override;
+
+ private:
+  static bool ReadFromChunks(pb_istream_t* stream,
+                             pb_byte_t* buf,
+                             size_t count);
+
+  absl::Cord cord_;
+  /** The position of the next byte to read in `cord_`. */
+  absl::Cord::CharIterator position_;
+  pb_istream_t stream_{};
+};
+
 }  // namespace nanopb
 }  // namespace firestore
 }  // namespace firebase
@@ -40,7 +40,19 @@ bool AppendToBytesArray(pb_ostream_t* stream,
 }  // namespace
 
 void Writer::Write(const pb_field_t fields[], const void* src_struct) {
-  if (!pb_encode(&stream_, fields, src_struct)) {
+  // Size all submessages up front, so that nested values are not sized again
+  // for every message that encloses them.
+  pb_size_cache_t cache = PB_SIZE_CACHE_INIT;
+  size_t size = 0;
+  if (!pb_get_encoded_size_cached(&size, &cache, fields, src_struct)) {
+    pb_release_size_cache(&cache);
+    HARD_FAIL("Failed to compute the encoded size of a proto");
+  }
+
+  bool encoded =
+      pb_encode_with_size_cache(&stream_, &cache, fields, src_struct);
+  pb_release_size_cache(&cache);
+  if (!encoded) {
     HARD_FAIL(PB_GET_ERROR(&stream_));
   }
 }
@@ -52,7 +64,7 @@ ByteStringWriter::ByteStringWriter() {
 }
 
 ByteStringWriter::~ByteStringWriter() {
-  std::free(buffer_);
+  pb_free(buffer_);
 }
 
 void ByteStringWriter::Append(const void* data, size_t size) {
@@ -80,11 +92,12 @@ void ByteStringWriter::Reserve(size_t min_capacity) {
 
   if (buffer_) {
     buffer_ = static_cast<pb_bytes_array_t*>(
-        std::realloc(buffer_, PB_BYTES_ARRAY_T_ALLOCSIZE(desired)));
+        pb_realloc(buffer_, PB_BYTES_ARRAY_T_ALLOCSIZE(desired)));
   } else {
     // initialize on the first allocation.
     buffer_ = static_cast<pb_bytes_array_t*>(
-        std::calloc(1, PB_BYTES_ARRAY_T_ALLOCSIZE(desired)));
+        pb_realloc(nullptr, PB_BYTES_ARRAY_T_ALLOCSIZE(desired)));
+    buffer_->size = 0;
   }
 
   capacity_ = desired;
@@ -16,7 +16,9 @@
 
 #include "Firestore/core/src/remote/bloom_filter.h"
 
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "Firestore/core/src/util/hard_assert.h"
 #include "Firestore/core/src/util/md5.h"
@@ -60,8 +62,10 @@ bool HasSameBits(const BloomFilter& lhs, const BloomFilter& rhs) {
 }  // namespace
 
 BloomFilter::Hash BloomFilter::Md5HashDigest(absl::string_view key) const {
-  std::array<uint8_t, 16> md5_digest{util::CalculateMd5Digest(key)};
+  return ToHash(util::CalculateMd5Digest(key));
+}
 
+BloomFilter::Hash BloomFilter::ToHash(std::array<uint8_t, 16> md5_digest) {
   // TODO(Mila): Handle big endian processor b/271174523.
   uint64_t* hash128 = reinterpret_cast<uint64_t*>(md5_digest.data());
   static_assert(sizeof(uint64_t[2]) == sizeof(uint8_t[16]), "");
@@ -126,10 +130,7 @@ StatusOr<BloomFilter> BloomFilter::Create(ByteString bitmap,
   return BloomFilter(std::move(bitmap), padding, hash_count);
 }
 
-bool BloomFilter::MightContain(absl::string_view value) const {
-  // Empty bitmap should return false on membership check.
-  if (bit_count_ == 0) return false;
-  Hash hash = Md5HashDigest(value);
+bool BloomFilter::MightContainHash(const Hash& hash) const {
   // The `hash_count_` and `bit_count_` fields are guaranteed to be
   // non-negative when the `BloomFilter` object is constructed.
   for (int32_t i = 0; i < hash_count_; ++i) {
@@ -141,6 +142,29 @@ bool BloomFilter::MightContain(absl::string_view value) const {
   return true;
 }
 
+bool BloomFilter::MightContain(absl::string_view value) const {
+  // Empty bitmap should return false on membership check.
+  if (bit_count_ == 0) return false;
+  return MightContainHash(Md5HashDigest(value));
+}
+
+std::vector<bool> BloomFilter::MightContainAll(
+    absl::string_view common_prefix,
+    const std::vector<std::string>& suffixes) const {
+  std::vector<bool> result(suffixes.size(), false);
+  // Empty bitmap should return false on membership check.
+  if (bit_count_ == 0) return result;
+
+  util::Md5Hasher prefix_hasher;
+  prefix_hasher.Update(common_prefix);
+  for (size_t i = 0; i < suffixes.size(); ++i) {
+    util::Md5Hasher hasher = prefix_hasher;
+    hasher.Update(suffixes[i]);
+    result[i] = MightContainHash(ToHash(hasher.Digest()));
+  }
+  return result;
+}
+
 bool operator==(const BloomFilter& lhs, const BloomFilter& rhs) {
   return lhs.hash_count() == rhs.hash_count() && HasSameBits(lhs, rhs);
 }
@@ -18,6 +18,8 @@
 #define FIRESTORE_CORE_SRC_REMOTE_BLOOM_FILTER_H_
 
 #include <string>
+#include <vector>
+
 #include "Firestore/core/src/nanopb/byte_string.h"
 #include "Firestore/core/src/util/statusor.h"
 #include "absl/strings/string_view.h"
@@ -57,6 +59,20 @@ class BloomFilter final {
    */
   bool MightContain(absl::string_view value) const;
 
+  /**
+   * Checks the membership of many strings that share a common prefix, for
+   * example the document names of one database. The prefix is hashed only
+   * once, instead of once per string.
+   *
+   * @param common_prefix the prefix of every string to be tested.
+   * @param suffixes the rest of each string to be tested.
+   * @return for each suffix, whether `common_prefix` followed by it might be
+   * contained in the bloom filter, as returned by `MightContain`.
+   */
+  std::vector<bool> MightContainAll(
+      absl::string_view common_prefix,
+      const std::vector<std::string>& suffixes) const;
+
   /**
    * The number of bits in the bloom filter. Guaranteed to be non-negative, and
    * less than the max number of bits the bitmap can represent, i.e.,
@@ -95,6 +111,12 @@ class BloomFilter final {
    */
   Hash Md5HashDigest(absl::string_view key) const;
 
+  /** Converts the given md5 digest to a Hash object. */
+  static Hash ToHash(std::array<uint8_t, 16> md5_digest);
+
+  /** Return whether all the bits that the given hash maps to are set. */
+  bool MightContainHash(const Hash& hash) const;
+
   /**
    * Calculate the ith hash value based on the hashed 64 bit unsigned integers,
    * and calculate its corresponding bit index in the bitmap to be checked.
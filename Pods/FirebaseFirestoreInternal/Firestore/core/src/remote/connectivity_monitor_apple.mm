@@ -24,6 +24,7 @@
 
 #include <SystemConfiguration/SystemConfiguration.h>
 #include <dispatch/dispatch.h>
+#include <grpc/grpc.h>
 #include <netinet/in.h>
 
 #include <memory>
@@ -120,12 +121,23 @@ class ConnectivityMonitorApple : public ConnectivityMonitor {
                 usingBlock:^(NSNotification* note) {
                   this->OnEnteredForeground();
                 }];
+    // While in the background, gRPC skips the keepalive pings of idle
+    // connections so that they do not keep waking the radio.
+    this->background_observer_ = [[NSNotificationCenter defaultCenter]
+        addObserverForName:UIApplicationDidEnterBackgroundNotification
+                    object:nil
+                     queue:[NSOperationQueue mainQueue]
+                usingBlock:^(NSNotification* note) {
+                  grpc_set_application_backgrounded(1);
+                }];
 #endif
   }
 
   ~ConnectivityMonitorApple() {
 #if TARGET_OS_IOS || TARGET_OS_TV || TARGET_OS_VISION
     [[NSNotificationCenter defaultCenter] removeObserver:this->observer_];
+    [[NSNotificationCenter defaultCenter]
+        removeObserver:this->background_observer_];
 #endif
 
     if (reachability_) {
@@ -141,6 +153,8 @@ class ConnectivityMonitorApple : public ConnectivityMonitor {
 
 #if TARGET_OS_IOS || TARGET_OS_TV || TARGET_OS_VISION
   void OnEnteredForeground() {
+    grpc_set_application_backgrounded(0);
+
     SCNetworkReachabilityFlags flags{};
     if (!SCNetworkReachabilityGetFlags(reachability_, &flags)) return;
 
@@ -169,6 +183,7 @@ class ConnectivityMonitorApple : public ConnectivityMonitor {
   SCNetworkReachabilityRef reachability_ = nil;
 #if TARGET_OS_IOS || TARGET_OS_TV || TARGET_OS_VISION
   id<NSObject> observer_ = nil;
+  id<NSObject> background_observer_ = nil;
 #endif
 };
 
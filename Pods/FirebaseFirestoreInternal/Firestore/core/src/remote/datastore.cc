@@ -16,6 +16,8 @@
 
 #include "Firestore/core/src/remote/datastore.h"
 
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -57,6 +59,7 @@ using model::Mutation;
 using util::AsyncQueue;
 using util::Executor;
 using util::LogIsDebugEnabled;
+using util::MemoryPressure;
 using util::Status;
 using util::StatusOr;
 
@@ -104,10 +107,10 @@ Datastore::Datastore(
     : worker_queue_{NOT_NULL(worker_queue)},
       app_check_credentials_{std::move(app_check_credentials)},
       auth_credentials_{std::move(auth_credentials)},
-      rpc_executor_{CreateExecutor()},
+      grpc_queue_{GrpcQueue::Acquire()},
       connectivity_monitor_{connectivity_monitor},
       database_info_{database_info},
-      grpc_connection_{database_info, worker_queue, &grpc_queue_,
+      grpc_connection_{database_info, worker_queue, grpc_queue_->queue(),
                        connectivity_monitor_, firebase_metadata_provider},
       datastore_serializer_{database_info} {
   if (!database_info.ssl_enabled()) {
@@ -115,35 +118,44 @@ Datastore::Datastore(
   }
 }
 
-void Datastore::Start() {
-  rpc_executor_->Execute([this] { PollGrpcQueue(); });
-}
+std::shared_ptr<Datastore::GrpcQueue> Datastore::GrpcQueue::Acquire() {
+  struct SharedQueue {
+    std::mutex mutex;
+    std::weak_ptr<GrpcQueue> queue;
+  };
+  static util::NoDestructor<SharedQueue> shared;
 
-void Datastore::Shutdown() {
-  is_shut_down_ = true;
+  std::lock_guard<std::mutex> lock(shared->mutex);
+  std::shared_ptr<GrpcQueue> queue = shared->queue.lock();
+  if (!queue) {
+    queue = std::make_shared<GrpcQueue>();
+    shared->queue = queue;
+  }
+  return queue;
+}
 
-  // Order matters here: shutting down `grpc_connection_`, which will quickly
-  // finish any pending gRPC calls, must happen before shutting down the gRPC
-  // queue.
-  grpc_connection_.Shutdown();
+Datastore::GrpcQueue::GrpcQueue() : rpc_executor_{CreateExecutor()} {
+  rpc_executor_->Execute([this] { Poll(); });
+}
 
+Datastore::GrpcQueue::~GrpcQueue() {
   // `grpc::CompletionQueue::Next` will only return `false` once `Shutdown` has
   // been called and all submitted tags have been extracted. Without this call,
   // `rpc_executor_` will never finish.
-  grpc_queue_.Shutdown();
+  queue_.Shutdown();
   // Drain the executor to make sure it extracted all the operations from gRPC
   // completion queue.
   rpc_executor_->ExecuteBlocking([] {});
 }
 
-void Datastore::PollGrpcQueue() {
+void Datastore::GrpcQueue::Poll() {
   HARD_ASSERT(rpc_executor_->IsCurrentExecutor(),
-              "PollGrpcQueue should only be called on the "
-              "dedicated Datastore executor");
+              "GrpcQueue::Poll should only be called on the "
+              "dedicated gRPC queue executor");
 
   void* tag = nullptr;
   bool ok = false;
-  while (grpc_queue_.Next(&tag, &ok)) {
+  while (queue_.Next(&tag, &ok)) {
     auto completion = static_cast<GrpcCompletion*>(tag);
     // While it's valid in principle, we never deliberately pass a null pointer
     // to gRPC completion queue and expect it back. This assertion might be
@@ -153,6 +165,25 @@ void Datastore::PollGrpcQueue() {
   }
 }
 
+void Datastore::Start() {
+  grpc_connection_.WarmUp();
+}
+
+void Datastore::ReleaseMemory(MemoryPressure pressure) {
+  grpc_connection_.ReleaseMemory(pressure);
+}
+
+void Datastore::Shutdown() {
+  is_shut_down_ = true;
+
+  // Order matters here: shutting down `grpc_connection_`, which will quickly
+  // finish any pending gRPC calls and wait for their completions to come off
+  // the gRPC queue, must happen before releasing the queue. The last datastore
+  // to release it shuts it down.
+  grpc_connection_.Shutdown();
+  grpc_queue_.reset();
+}
+
 std::shared_ptr<WatchStream> Datastore::CreateWatchStream(
     WatchStreamCallback* callback) {
   return std::make_shared<WatchStream>(
@@ -36,6 +36,7 @@
 #include "Firestore/core/src/remote/write_stream.h"
 #include "Firestore/core/src/util/async_queue.h"
 #include "Firestore/core/src/util/executor.h"
+#include "Firestore/core/src/util/memory_pressure_monitor.h"
 #include "Firestore/core/src/util/status_fwd.h"
 #include "absl/strings/string_view.h"
 #include "grpcpp/completion_queue.h"
@@ -86,7 +87,9 @@ class Datastore : public std::enable_shared_from_this<Datastore> {
 
   virtual ~Datastore() = default;
 
-  /** Starts polling the gRPC completion queue. */
+  /**
+   * Starts polling the gRPC completion queue and connecting to the backend.
+   */
   void Start();
   /** Cancels any pending gRPC calls and drains the gRPC completion queue. */
   void Shutdown();
@@ -117,6 +120,9 @@ class Datastore : public std::enable_shared_from_this<Datastore> {
       const api::Pipeline& pipeline,
       util::StatusOrCallback<api::PipelineSnapshot>&& result_callback);
 
+  /** Bounds the memory used by gRPC while the system is short on memory. */
+  void ReleaseMemory(util::MemoryPressure pressure);
+
   /** Returns true if the given error is a gRPC ABORTED error. */
   static bool IsAbortedError(const util::Status& error);
 
@@ -158,7 +164,7 @@ class Datastore : public std::enable_shared_from_this<Datastore> {
  protected:
   /** Test-only method */
   grpc::CompletionQueue* grpc_queue() {
-    return &grpc_queue_;
+    return grpc_queue_->queue();
   }
   /** Test-only method */
   GrpcCall* LastCall() {
@@ -171,6 +177,30 @@ class Datastore : public std::enable_shared_from_this<Datastore> {
   }
 
  private:
+  /**
+   * The gRPC completion queue of all the streams and calls of the process's
+   * datastores, and the executor dedicated to polling it. It is shut down once
+   * the last datastore releases it.
+   */
+  class GrpcQueue {
+   public:
+    /** Returns the queue of the process, creating it if there is none. */
+    static std::shared_ptr<GrpcQueue> Acquire();
+
+    GrpcQueue();
+    ~GrpcQueue();
+
+    grpc::CompletionQueue* queue() {
+      return &queue_;
+    }
+
+   private:
+    void Poll();
+
+    std::unique_ptr<util::Executor> rpc_executor_;
+    grpc::CompletionQueue queue_;
+  };
+
   struct CallCredentials {
     mutable std::mutex mutex;
     std::string app_check;
@@ -179,8 +209,6 @@ class Datastore : public std::enable_shared_from_this<Datastore> {
     bool auth_received = false;
   };
 
-  void PollGrpcQueue();
-
   void CommitMutationsWithCredentials(
       const credentials::AuthToken& auth_token,
       const std::string& app_check_token,
@@ -223,10 +251,8 @@ class Datastore : public std::enable_shared_from_this<Datastore> {
       app_check_credentials_;
   std::shared_ptr<credentials::AuthCredentialsProvider> auth_credentials_;
 
-  // A separate executor dedicated to polling gRPC completion queue (which is
-  // shared for all spawned gRPC streams and calls).
-  std::unique_ptr<util::Executor> rpc_executor_;
-  grpc::CompletionQueue grpc_queue_;
+  // Shared with the other datastores of the process; released on shutdown.
+  std::shared_ptr<GrpcQueue> grpc_queue_;
   ConnectivityMonitor* connectivity_monitor_ = nullptr;
   core::DatabaseInfo database_info_;
   GrpcConnection grpc_connection_;
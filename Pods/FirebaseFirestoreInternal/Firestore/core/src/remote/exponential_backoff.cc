@@ -82,7 +82,9 @@ void ExponentialBackoff::BackoffAndRun(AsyncQueue::Operation&& operation) {
 
   // First schedule the block using the current base (which may be 0 and should
   // be honored as such).
-  Milliseconds desired_delay_with_jitter = current_base_ + GetDelayWithJitter();
+  Milliseconds desired_delay_with_jitter =
+      std::max(current_base_ + GetDelayWithJitter(), minimum_delay_);
+  minimum_delay_ = Milliseconds::zero();
 
   Milliseconds delay_so_far = chr::duration_cast<Milliseconds>(
       chr::steady_clock::now() - last_attempt_time_);
@@ -91,7 +93,7 @@ void ExponentialBackoff::BackoffAndRun(AsyncQueue::Operation&& operation) {
   auto remaining_delay =
       std::max(Milliseconds::zero(), desired_delay_with_jitter - delay_so_far);
 
-  if (current_base_.count() > 0) {
+  if (desired_delay_with_jitter.count() > 0) {
     LOG_DEBUG(
         "Backing off for %s ms "
         "(base delay: %s ms, "
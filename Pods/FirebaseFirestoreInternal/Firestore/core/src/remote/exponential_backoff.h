@@ -17,6 +17,7 @@
 #ifndef FIRESTORE_CORE_SRC_REMOTE_EXPONENTIAL_BACKOFF_H_
 #define FIRESTORE_CORE_SRC_REMOTE_EXPONENTIAL_BACKOFF_H_
 
+#include <algorithm>
 #include <chrono>
 #include <memory>
 
@@ -41,6 +42,8 @@ namespace remote {
  */
 class ExponentialBackoff {
  public:
+  using Milliseconds = util::AsyncQueue::Milliseconds;
+
   /**
    * @param queue The queue to run operations on.
    * @param timer_id The id to use when scheduling backoff operations on the
@@ -86,6 +89,15 @@ class ExponentialBackoff {
     current_base_ = max_delay_;
   }
 
+  /**
+   * Makes the next `BackoffAndRun` wait at least `delay` (e.g. because the
+   * server asked clients to wait that long before retrying). Delays longer
+   * than `max_delay` are shortened to it.
+   */
+  void SetMinimumDelay(Milliseconds delay) {
+    minimum_delay_ = std::min(delay, max_delay_);
+  }
+
   /**
    * Waits for `current_base` seconds (which may be zero), increases the delay
    * and runs the specified operation. If there was a pending operation waiting
@@ -99,7 +111,6 @@ class ExponentialBackoff {
   }
 
  private:
-  using Milliseconds = util::AsyncQueue::Milliseconds;
   // Returns a random value in the range [-current_base_/2, current_base_/2].
   Milliseconds GetDelayWithJitter();
   Milliseconds ClampDelay(Milliseconds delay) const;
@@ -110,6 +121,7 @@ class ExponentialBackoff {
 
   const double backoff_factor_;
   Milliseconds current_base_{0};
+  Milliseconds minimum_delay_{0};
   const Milliseconds initial_delay_;
   const Milliseconds max_delay_;
   util::SecureRandom secure_random_;
@@ -19,8 +19,11 @@
 #include <cstdlib>
 
 #include <algorithm>
+#include <functional>
+#include <limits>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <utility>
 
 #include "Firestore/core/include/firebase/firestore/firestore_errors.h"
@@ -28,7 +31,8 @@
 #include "Firestore/core/src/credentials/auth_token.h"
 #include "Firestore/core/src/model/database_id.h"
 #include "Firestore/core/src/remote/firebase_metadata_provider.h"
-#include "Firestore/core/src/remote/grpc_root_certificate_finder.h"
+#include "Firestore/core/src/remote/grpc_root_certificate_verifier.h"
+#include "Firestore/core/src/remote/ssl_session_store.h"
 #include "Firestore/core/src/util/filesystem.h"
 #include "Firestore/core/src/util/hard_assert.h"
 #include "Firestore/core/src/util/log.h"
@@ -38,6 +42,7 @@
 #include "Firestore/core/src/util/warnings.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 
 SUPPRESS_DOCUMENTATION_WARNINGS_BEGIN()
 #include "grpcpp/create_channel.h"
@@ -49,10 +54,12 @@ namespace firestore {
 namespace remote {
 namespace {
 
+using api::Settings;
 using core::DatabaseInfo;
 using credentials::AuthToken;
 using model::DatabaseId;
 using util::Filesystem;
+using util::MemoryPressure;
 using util::Path;
 using util::Status;
 using util::StatusOr;
@@ -64,10 +71,29 @@ const char* const kXGoogApiClientHeader = "x-goog-api-client";
 const char* const kGoogleCloudResourcePrefix = "google-cloud-resource-prefix";
 const char* const kXGoogRequestParams = "x-goog-request-params";
 
+// How much memory gRPC may use for the connection while the system is short
+// on memory. Going over the bound makes gRPC close idle connections and, as a
+// last resort, cancel streams, which Firestore retries.
+const size_t kWarningResourceQuotaSize = 32 * 1024 * 1024;
+const size_t kCriticalResourceQuotaSize = 8 * 1024 * 1024;
+
 std::string MakeString(absl::string_view view) {
   return view.data() ? std::string{view.data(), view.size()} : std::string{};
 }
 
+grpc_compression_algorithm ToGrpcCompression(
+    Settings::NetworkCompression compression) {
+  switch (compression) {
+    case Settings::NetworkCompression::kNone:
+      return GRPC_COMPRESS_NONE;
+    case Settings::NetworkCompression::kGzip:
+      return GRPC_COMPRESS_GZIP;
+    case Settings::NetworkCompression::kDeflate:
+      return GRPC_COMPRESS_DEFLATE;
+  }
+  UNREACHABLE();
+}
+
 std::shared_ptr<grpc::ChannelCredentials> CreateSslCredentials(
     const std::string& certificate) {
   grpc::SslCredentialsOptions options;
@@ -229,6 +255,93 @@ class DisableGrpcCFStream {
 } disable;
 #endif  // __APPLE__
 
+// Enough for the production host and an emulator or test host.
+constexpr size_t kSslSessionCacheSize = 4;
+
+grpc_ssl_session_cache* CreateSslSessionCache() {
+#if __APPLE__
+  return grpc_ssl_session_cache_create_lru_with_store(
+      kSslSessionCacheSize, CreateKeychainSslSessionStore());
+#else
+  return grpc_ssl_session_cache_create_lru(kSslSessionCacheSize);
+#endif  // __APPLE__
+}
+
+/**
+ * The channels of the process, by host and the way the host is configured.
+ * Connections to the same host share a channel, so that all the databases and
+ * Firestore instances of the app multiplex their calls over one HTTP/2
+ * connection and one TLS session. Each call still carries the headers of the
+ * database it is made for.
+ */
+class ChannelMap {
+  using Guard = std::lock_guard<std::mutex>;
+
+ public:
+  /**
+   * Returns the channel to `key` that a connection still holds, or the one
+   * `create` returns if none does.
+   */
+  std::shared_ptr<grpc::Channel> GetOrCreate(
+      const std::string& key,
+      const std::function<std::shared_ptr<grpc::Channel>()>& create) {
+    Guard guard{mutex_};
+    std::shared_ptr<grpc::Channel> channel = map_[key].lock();
+    if (!channel) {
+      channel = create();
+      map_[key] = channel;
+    }
+    return channel;
+  }
+
+  /**
+   * Stops handing out `channel` for `key`, so that the next connection that
+   * asks for it gets a new channel. Does nothing if another connection has
+   * already replaced it.
+   */
+  void Forget(const std::string& key, const grpc::Channel* channel) {
+    Guard guard{mutex_};
+    auto iter = map_.find(key);
+    if (iter != map_.end() && iter->second.lock().get() == channel) {
+      map_.erase(iter);
+    }
+  }
+
+ private:
+  std::unordered_map<std::string, std::weak_ptr<grpc::Channel>> map_;
+  std::mutex mutex_;
+};
+
+ChannelMap& Channels() {
+  static util::NoDestructor<ChannelMap> channels;
+  return *channels;
+}
+
+// Shared by every channel, so that a new channel resumes the TLS session of
+// the one before it.
+grpc_ssl_session_cache* SslSessionCache() {
+  static grpc_ssl_session_cache* ssl_session_cache = CreateSslSessionCache();
+  return ssl_session_cache;
+}
+
+// Shared by every channel, since they serve all the connections of the
+// process.
+grpc::ResourceQuota& ResourceQuota() {
+  static util::NoDestructor<grpc::ResourceQuota> resource_quota{"firestore"};
+  return *resource_quota;
+}
+
+/** The key of the channel to `host` in `Channels()`. */
+std::string ChannelKey(const std::string& host) {
+  const HostConfig* host_config = Config().find(host);
+  if (!host_config) {
+    return host;
+  }
+  return absl::StrCat(host, "|", host_config->use_insecure_channel(), "|",
+                      host_config->certificate_path().ToUtf8String(), "|",
+                      host_config->target_name());
+}
+
 }  // namespace
 
 GrpcConnection::GrpcConnection(
@@ -254,6 +367,29 @@ void GrpcConnection::Shutdown() {
   }
 }
 
+void GrpcConnection::ReleaseMemory(MemoryPressure pressure) {
+  switch (pressure) {
+    case MemoryPressure::kNormal:
+      // The size gRPC gives a quota that nothing has bounded.
+      ResourceQuota().Resize(std::numeric_limits<intptr_t>::max());
+      break;
+    case MemoryPressure::kWarning:
+      ResourceQuota().Resize(kWarningResourceQuotaSize);
+      break;
+    case MemoryPressure::kCritical:
+      ResourceQuota().Resize(kCriticalResourceQuotaSize);
+      break;
+  }
+}
+
+void GrpcConnection::WarmUp() {
+  EnsureActiveStub();
+  // Asking for the state with `try_to_connect` moves an idle channel into
+  // CONNECTING without blocking; gRPC does the DNS, TCP, TLS and HTTP/2 setup
+  // on its own threads.
+  grpc_channel_->GetState(/*try_to_connect=*/true);
+}
+
 std::unique_ptr<grpc::ClientContext> GrpcConnection::CreateContext(
     const AuthToken& auth_token, const std::string& app_check_token) const {
   auto context = absl::make_unique<grpc::ClientContext>();
@@ -292,7 +428,9 @@ void GrpcConnection::EnsureActiveStub() {
   if (!grpc_channel_ || grpc_channel_->GetState(/*try_to_connect=*/false) ==
                             GRPC_CHANNEL_SHUTDOWN) {
     LOG_DEBUG("Creating Firestore stub.");
-    grpc_channel_ = CreateChannel();
+    channel_key_ = ChannelKey(database_info_->host());
+    grpc_channel_ = Channels().GetOrCreate(channel_key_,
+                                           [this] { return CreateChannel(); });
     grpc_stub_ = absl::make_unique<grpc::GenericStub>(grpc_channel_);
   }
 }
@@ -305,12 +443,71 @@ std::shared_ptr<grpc::Channel> GrpcConnection::CreateChannel() const {
   // the OS will usually notify gRPC when a connection dies. But not always.
   // This acts as a failsafe.)
   args.SetInt(GRPC_ARG_KEEPALIVE_TIME_MS, 30 * 1000);
+  // Let the pings drift by up to 10 seconds so that they share radio wakeups
+  // with other traffic and with each other.
+  args.SetInt(GRPC_ARG_KEEPALIVE_TOLERANCE_MS, 10 * 1000);
+  // Calls fail right away while the channel waits to reconnect, so keep its
+  // own backoff no longer than the one streams use after network errors.
+  args.SetInt(GRPC_ARG_MAX_RECONNECT_BACKOFF_MS, 10 * 1000);
+  // On dual-stack networks where one family is broken, reconnects go to the
+  // address that answered last time instead of waiting out the broken one.
+  args.SetInt(GRPC_ARG_HAPPY_EYEBALLS_SORT_BY_CONNECT_TIME, 1);
+  // Reconnects and channels created after an app launch use the last DNS
+  // answer right away, and refresh it in the background once it is older than
+  // the TTL. The cache is disposable, so it lives in the temporary directory.
+  args.SetInt(GRPC_ARG_DNS_CACHE_TTL_MS, 5 * 60 * 1000);
+  args.SetString(GRPC_ARG_DNS_CACHE_PATH,
+                 Filesystem::Default()
+                     ->TempDir()
+                     .AppendUtf8("firestore_dns_cache")
+                     .ToUtf8String());
+  // These headers are sent on every call with the same values, so intern
+  // their keys, and index them in the HPACK table from the first call instead
+  // of resending them in full.
+  const std::string header_keys = absl::StrJoin(
+      {kAuthorizationHeader, kAppCheckHeader, kXGoogApiClientHeader,
+       kGoogleCloudResourcePrefix, kXGoogRequestParams},
+      ",");
+  args.SetString(GRPC_ARG_INTERNED_METADATA_KEYS, header_keys);
+  args.SetString(GRPC_ARG_HTTP2_HPACK_PINNED_KEYS, header_keys);
+  // Reconnects, and the first connection after an app launch, resume an
+  // earlier TLS session, which saves a round trip and the certificate
+  // verification. The channel holds its own reference to the cache.
+  grpc_arg ssl_session_cache_arg =
+      grpc_ssl_session_cache_create_channel_arg(SslSessionCache());
+  args.SetPointerWithVtable(ssl_session_cache_arg.key,
+                            ssl_session_cache_arg.value.pointer.p,
+                            ssl_session_cache_arg.value.pointer.vtable);
+  // Lets `ReleaseMemory` bound the memory the channel uses.
+  args.SetResourceQuota(ResourceQuota());
+  // Document lookups and aggregations are idempotent reads, so a second
+  // attempt is sent if the first one has not answered within half a second,
+  // and whichever answers first wins. The throttle stops hedging while the
+  // backend is failing.
+  args.SetInt(GRPC_ARG_EXPERIMENTAL_ENABLE_HEDGING, 1);
+  args.SetServiceConfigJSON(R"json({
+    "methodConfig": [{
+      "name": [
+        {"service": "google.firestore.v1.Firestore",
+         "method": "BatchGetDocuments"},
+        {"service": "google.firestore.v1.Firestore",
+         "method": "RunAggregationQuery"}
+      ],
+      "hedgingPolicy": {
+        "maxAttempts": 2,
+        "hedgingDelay": "0.5s",
+        "nonFatalStatusCodes": ["UNAVAILABLE"]
+      }
+    }],
+    "retryThrottling": {"maxTokens": 10, "tokenRatio": 0.1}
+  })json");
 
   const HostConfig* host_config = Config().find(host);
   if (!host_config) {
-    std::string root_certificate = LoadGrpcRootCertificate();
-    return grpc::CreateCustomChannel(
-        host, CreateSslCredentials(root_certificate), args);
+    // The embedded roots are parsed lazily, during verification, rather than
+    // handed to gRPC as one PEM bundle that every channel would parse.
+    return grpc::CreateCustomChannel(host, CreateEmbeddedRootsCredentials(),
+                                     args);
   }
 
   // For the case when `Settings.set_ssl_enabled(false)`.
@@ -341,12 +538,22 @@ std::unique_ptr<GrpcStream> GrpcConnection::CreateStream(
   EnsureActiveStub();
 
   auto context = CreateContext(auth_token, app_check_token);
+  // Watch and write streams carry most of the traffic, so only they negotiate
+  // a message encoding. The backend compresses its responses with any
+  // encoding that the stream lists as accepted.
+  context->set_compression_algorithm(
+      ToGrpcCompression(database_info_->network_compression()));
   auto call =
       grpc_stub_->PrepareCall(context.get(), MakeString(rpc_name), grpc_queue_);
   return absl::make_unique<GrpcStream>(std::move(context), std::move(call),
                                        worker_queue_, this, observer);
 }
 
+bool GrpcConnection::ShouldCompress(const grpc::ByteBuffer& message) const {
+  return message.Length() >=
+         database_info_->network_compression_threshold_bytes();
+}
+
 std::unique_ptr<GrpcUnaryCall> GrpcConnection::CreateUnaryCall(
     absl::string_view rpc_name,
     const AuthToken& auth_token,
@@ -377,7 +584,7 @@ std::unique_ptr<GrpcStreamingReader> GrpcConnection::CreateStreamingReader(
 
 void GrpcConnection::RegisterConnectivityMonitor() {
   connectivity_monitor_->AddCallback(
-      [this](ConnectivityMonitor::NetworkStatus /*ignored*/) {
+      [this](ConnectivityMonitor::NetworkStatus network_status) {
         // Calls may unregister themselves on finish, so make a protective copy.
         auto calls = active_calls_;
         for (GrpcCall* call : calls) {
@@ -389,7 +596,18 @@ void GrpcConnection::RegisterConnectivityMonitor() {
         // connection before eventually failing. Note that gRPC Objective-C
         // client does the same thing:
         // https://github.com/grpc/grpc/blob/fe11db09575f2dfbe1f88cd44bd417acc168e354/src/objective-c/GRPCClient/private/GRPCHost.m#L309-L314
+        // The other connections that share the channel drop it on their own
+        // callbacks; whichever of them warms up first creates the new one.
+        if (grpc_channel_) {
+          Channels().Forget(channel_key_, grpc_channel_.get());
+        }
         grpc_channel_.reset();
+
+        // Start connecting over the new network right away rather than when
+        // the streams are restarted.
+        if (network_status != ConnectivityMonitor::NetworkStatus::Unavailable) {
+          WarmUp();
+        }
       });
 }
 
@@ -30,12 +30,15 @@
 #include "Firestore/core/src/remote/grpc_stream_observer.h"
 #include "Firestore/core/src/remote/grpc_streaming_reader.h"
 #include "Firestore/core/src/remote/grpc_unary_call.h"
+#include "Firestore/core/src/util/memory_pressure_monitor.h"
 #include "Firestore/core/src/util/path.h"
 #include "Firestore/core/src/util/warnings.h"
 #include "absl/strings/string_view.h"
+#include "grpc/credentials.h"
 #include "grpcpp/channel.h"
 #include "grpcpp/client_context.h"
 #include "grpcpp/completion_queue.h"
+#include "grpcpp/resource_quota.h"
 
 SUPPRESS_DOCUMENTATION_WARNINGS_BEGIN()
 #include "grpcpp/generic/generic_stub.h"
@@ -65,6 +68,13 @@ class GrpcConnection {
 
   void Shutdown();
 
+  /**
+   * Creates the channel, if necessary, and starts resolving the host and
+   * connecting to it in the background, so that the first stream or call
+   * does not have to wait for the connection to be set up.
+   */
+  void WarmUp();
+
   /**
    * Creates a stream to the given stream RPC endpoint. The resulting stream
    * needs to be `Start`ed before it can be used.
@@ -89,6 +99,20 @@ class GrpcConnection {
       const std::string& app_check_token,
       const grpc::ByteBuffer& message);
 
+  /**
+   * Whether the given outgoing stream message is large enough to be sent
+   * compressed, if the stream compresses messages at all.
+   */
+  bool ShouldCompress(const grpc::ByteBuffer& message) const;
+
+  /**
+   * Bounds the memory gRPC may use for all connections while the system is
+   * short on memory. gRPC shrinks its read buffers, flow control windows and
+   * HPACK tables as the bound nears, and grows them back once `pressure` is
+   * back to normal.
+   */
+  void ReleaseMemory(util::MemoryPressure pressure);
+
   void Register(GrpcCall* call);
   void Unregister(GrpcCall* call);
 
@@ -121,7 +145,10 @@ class GrpcConnection {
   std::shared_ptr<util::AsyncQueue> worker_queue_;
   grpc::CompletionQueue* grpc_queue_ = nullptr;
 
+  // Shared with the other connections to the same host; `channel_key_` is
+  // the key it is shared under.
   std::shared_ptr<grpc::Channel> grpc_channel_;
+  std::string channel_key_;
   std::unique_ptr<grpc::GenericStub> grpc_stub_;
 
   ConnectivityMonitor* connectivity_monitor_ = nullptr;
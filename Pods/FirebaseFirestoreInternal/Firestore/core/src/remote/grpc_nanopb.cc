@@ -16,11 +16,17 @@
 
 #include "Firestore/core/src/remote/grpc_nanopb.h"
 
+#include <pb_encode.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <vector>
 
 #include "Firestore/core/include/firebase/firestore/firestore_errors.h"
 #include "Firestore/core/src/nanopb/writer.h"
 #include "Firestore/core/src/remote/grpc_util.h"
+#include "Firestore/core/src/util/hard_assert.h"
 #include "Firestore/core/src/util/status.h"
 #include "grpcpp/support/status.h"
 
@@ -28,13 +34,10 @@ namespace firebase {
 namespace firestore {
 namespace remote {
 
-using nanopb::ByteString;
-using nanopb::ByteStringWriter;
 using util::Status;
 
 ByteBufferReader::ByteBufferReader(const grpc::ByteBuffer& buffer) {
-  std::vector<grpc::Slice> slices;
-  grpc::Status status = buffer.Dump(&slices);
+  grpc::Status status = buffer.Dump(&slices_);
   // Conversion may fail if compression is used and gRPC tries to decompress an
   // ill-formed buffer.
   if (!status.ok()) {
@@ -45,14 +48,37 @@ ByteBufferReader::ByteBufferReader(const grpc::ByteBuffer& buffer) {
     return;
   }
 
-  ByteStringWriter writer;
-  writer.Reserve(buffer.Length());
-  for (const auto& slice : slices) {
-    writer.Append(slice.begin(), slice.size());
+  if (slices_.size() == 1) {
+    stream_ = pb_istream_from_buffer(slices_[0].begin(), slices_[0].size());
+    return;
   }
 
-  bytes_ = writer.Release();
-  stream_ = pb_istream_from_buffer(bytes_.data(), bytes_.size());
+  stream_.callback = ReadFromSlices;
+  stream_.state = this;
+  stream_.bytes_left = buffer.Length();
+}
+
+bool ByteBufferReader::ReadFromSlices(pb_istream_t* stream,
+                                      pb_byte_t* buf,
+                                      size_t count) {
+  auto reader = static_cast<ByteBufferReader*>(stream->state);
+  while (count > 0) {
+    if (reader->slice_index_ == reader->slices_.size()) return false;
+
+    const grpc::Slice& slice = reader->slices_[reader->slice_index_];
+    size_t available = slice.size() - reader->slice_offset_;
+    size_t n = std::min(count, available);
+    std::memcpy(buf, slice.begin() + reader->slice_offset_, n);
+    buf += n;
+    count -= n;
+
+    reader->slice_offset_ += n;
+    if (reader->slice_offset_ == slice.size()) {
+      ++reader->slice_index_;
+      reader->slice_offset_ = 0;
+    }
+  }
+  return true;
 }
 
 void ByteBufferReader::Read(const pb_field_t* fields, void* dest_struct) {
@@ -65,6 +91,28 @@ void ByteBufferReader::Read(const pb_field_t* fields, void* dest_struct) {
 
 namespace {
 
+/** Keeps a reference to the slice that a chunk of a `Cord` points into. */
+struct SliceReleaser {
+  grpc::Slice slice;
+
+  void operator()() const {
+  }
+};
+
+}  // namespace
+
+absl::Cord ByteBufferReader::ToCord() const {
+  absl::Cord result;
+  for (const grpc::Slice& slice : slices_) {
+    absl::string_view contents(reinterpret_cast<const char*>(slice.begin()),
+                               slice.size());
+    result.Append(absl::MakeCordFromExternal(contents, SliceReleaser{slice}));
+  }
+  return result;
+}
+
+namespace {
+
 bool AppendToGrpcBuffer(pb_ostream_t* stream,
                         const pb_byte_t* buf,
                         size_t count) {
@@ -87,6 +135,35 @@ grpc::ByteBuffer ByteBufferWriter::Release() {
   return result;
 }
 
+grpc::ByteBuffer MakeByteBuffer(const pb_field_t* fields,
+                                const void* src_struct) {
+  // The submessage sizes found while sizing the proto are reused to encode
+  // it, so that each submessage is only sized once.
+  pb_size_cache_t cache = PB_SIZE_CACHE_INIT;
+  size_t size = 0;
+  if (!pb_get_encoded_size_cached(&size, &cache, fields, src_struct)) {
+    pb_release_size_cache(&cache);
+    HARD_FAIL("Failed to compute the encoded size of a proto");
+  }
+
+  grpc::Slice slice{size};
+  // The slice has just been allocated and is not shared yet, so it can be
+  // written to.
+  auto data = const_cast<uint8_t*>(slice.begin());
+  pb_ostream_t stream = pb_ostream_from_buffer(data, size);
+  bool encoded =
+      pb_encode_with_size_cache(&stream, &cache, fields, src_struct);
+  pb_release_size_cache(&cache);
+  if (!encoded) {
+    HARD_FAIL(PB_GET_ERROR(&stream));
+  }
+  HARD_ASSERT(stream.bytes_written == size,
+              "Encoded %s bytes of a proto of %s bytes", stream.bytes_written,
+              size);
+
+  return grpc::ByteBuffer{&slice, 1};
+}
+
 }  // namespace remote
 }  // namespace firestore
 }  // namespace firebase
@@ -20,12 +20,14 @@
 #include <pb.h>
 #include <pb_decode.h>
 
+#include <cstddef>
 #include <vector>
 
 #include "Firestore/core/src/nanopb/byte_string.h"
 #include "Firestore/core/src/nanopb/message.h"
 #include "Firestore/core/src/nanopb/reader.h"
 #include "Firestore/core/src/nanopb/writer.h"
+#include "absl/strings/cord.h"
 #include "grpcpp/support/byte_buffer.h"
 
 namespace firebase {
@@ -36,16 +38,35 @@ namespace remote {
 class ByteBufferReader : public nanopb::Reader {
  public:
   /**
-   * Copies the given `buffer` and associates the resulting stream with this
-   * `ByteBufferReader`.
+   * Associates the slices of the given `buffer` with this `ByteBufferReader`.
+   * The slices are shared with `buffer` rather than copied: a buffer made of a
+   * single slice is decoded in place, and otherwise the stream reads across
+   * the slices in turn.
    */
-  // TODO(varconst): avoid copying the buffer.
   explicit ByteBufferReader(const grpc::ByteBuffer& buffer);
 
+  // The stream refers back to this reader.
+  ByteBufferReader(const ByteBufferReader&) = delete;
+  ByteBufferReader& operator=(const ByteBufferReader&) = delete;
+
   void Read(const pb_field_t* fields, void* dest_struct) override;
 
+  /**
+   * Returns the whole buffer as a `Cord` whose chunks are the slices of the
+   * buffer, without copying them. The result stays valid after this reader
+   * and the buffer are gone. Empty if the buffer could not be read.
+   */
+  absl::Cord ToCord() const;
+
  private:
-  nanopb::ByteString bytes_;
+  static bool ReadFromSlices(pb_istream_t* stream,
+                             pb_byte_t* buf,
+                             size_t count);
+
+  std::vector<grpc::Slice> slices_;
+  /** The position of the next byte to read in `slices_`. */
+  size_t slice_index_ = 0;
+  size_t slice_offset_ = 0;
   pb_istream_t stream_{};
 };
 
@@ -60,6 +81,15 @@ class ByteBufferWriter : public nanopb::Writer {
   std::vector<grpc::Slice> buffer_;
 };
 
+/**
+ * Serializes the given proto into a `grpc::ByteBuffer` made of a single slice.
+ *
+ * The encoded size is computed first, so the slice is allocated once at its
+ * final size and encoded into in place.
+ */
+grpc::ByteBuffer MakeByteBuffer(const pb_field_t* fields,
+                                const void* src_struct);
+
 /**
  * Serializes the given `message` into a `grpc::ByteBuffer`.
  *
@@ -67,9 +97,7 @@ class ByteBufferWriter : public nanopb::Writer {
  */
 template <typename T>
 grpc::ByteBuffer MakeByteBuffer(const nanopb::Message<T>& message) {
-  ByteBufferWriter writer;
-  writer.Write(message.fields(), message.get());
-  return writer.Release();
+  return MakeByteBuffer(message.fields(), message.get());
 }
 
 }  // namespace remote
@@ -17,9 +17,12 @@
 #ifndef FIRESTORE_CORE_SRC_REMOTE_GRPC_ROOT_CERTIFICATE_FINDER_H_
 #define FIRESTORE_CORE_SRC_REMOTE_GRPC_ROOT_CERTIFICATE_FINDER_H_
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include "Firestore/core/src/util/path.h"
+#include "absl/strings/string_view.h"
 
 namespace firebase {
 namespace firestore {
@@ -32,6 +35,13 @@ namespace remote {
  */
 std::string LoadGrpcRootCertificate();
 
+/**
+ * Returns the DER encodings of the embedded root certificates whose subject
+ * name has the given `X509_NAME_hash`, without parsing any of them. The views
+ * point into static storage.
+ */
+std::vector<absl::string_view> FindGrpcRootCertificates(uint32_t subject_hash);
+
 }  // namespace remote
 }  // namespace firestore
 }  // namespace firebase
@@ -15,22 +15,64 @@
  */
 
 /**
- * This implementation presumes that `roots.pem` has been embedded into the
- * binary during the build and is accessible as a char array named
- * `grpc_root_certificates`.
+ * This implementation presumes that the certificates of `roots.pem` have been
+ * embedded into the binary during the build in DER form, together with an
+ * index sorted by subject hash.
  */
 
 #include "Firestore/core/src/remote/grpc_root_certificate_finder.h"
 
+#include <algorithm>
+
 #include "Firestore/core/src/remote/grpc_root_certificates_generated.h"
+#include "absl/strings/escaping.h"
 
 namespace firebase {
 namespace firestore {
 namespace remote {
+namespace {
+
+// The length of a line of base64 in a PEM block.
+const size_t kPemLineLength = 64;
+
+absl::string_view CertificateDer(const GrpcRootCertificate& certificate) {
+  return {reinterpret_cast<const char*>(grpc_root_certificates_generated_der) +
+              certificate.offset,
+          certificate.size};
+}
+
+}  // namespace
 
 std::string LoadGrpcRootCertificate() {
-  return {reinterpret_cast<const char*>(grpc_root_certificates_generated_data),
-          grpc_root_certificates_generated_size};
+  std::string result;
+  for (size_t i = 0; i != grpc_root_certificates_generated_count; ++i) {
+    std::string base64 = absl::Base64Escape(
+        CertificateDer(grpc_root_certificates_generated_index[i]));
+    result += "-----BEGIN CERTIFICATE-----\n";
+    for (size_t pos = 0; pos < base64.size(); pos += kPemLineLength) {
+      result.append(base64, pos, kPemLineLength);
+      result += '\n';
+    }
+    result += "-----END CERTIFICATE-----\n";
+  }
+  return result;
+}
+
+std::vector<absl::string_view> FindGrpcRootCertificates(uint32_t subject_hash) {
+  const GrpcRootCertificate* begin = grpc_root_certificates_generated_index;
+  const GrpcRootCertificate* end =
+      begin + grpc_root_certificates_generated_count;
+  const GrpcRootCertificate* it = std::lower_bound(
+      begin, end, subject_hash,
+      [](const GrpcRootCertificate& certificate, uint32_t hash) {
+        return certificate.subject_hash < hash;
+      });
+
+  std::vector<absl::string_view> result;
+  for (; it != end && it->subject_hash == subject_hash; ++it) {
+    result.push_back(CertificateDer(*it));
+  }
+  return result;
 }
 
 }  // namespace remote
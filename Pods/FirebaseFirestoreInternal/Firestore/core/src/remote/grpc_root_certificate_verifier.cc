@@ -0,0 +1,201 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/remote/grpc_root_certificate_verifier.h"
+
+#if COCOAPODS==1
+  #include <openssl_grpc/bio.h>
+  #include <openssl_grpc/err.h>
+  #include <openssl_grpc/pem.h>
+  #include <openssl_grpc/x509.h>
+#else
+  #include <openssl/bio.h>
+  #include <openssl/err.h>
+  #include <openssl/pem.h>
+  #include <openssl/x509.h>
+#endif
+
+#include <string>
+#include <unordered_set>
+#include <utility>
+
+#include "Firestore/core/src/remote/grpc_root_certificate_finder.h"
+#include "Firestore/core/src/util/no_destructor.h"
+#include "absl/strings/str_cat.h"
+
+namespace firebase {
+namespace firestore {
+namespace remote {
+namespace {
+
+using grpc::experimental::TlsCustomVerificationCheckRequest;
+using util::NoDestructor;
+
+struct X509Deleter {
+  void operator()(X509* cert) const {
+    X509_free(cert);
+  }
+};
+
+struct X509StoreDeleter {
+  void operator()(X509_STORE* store) const {
+    X509_STORE_free(store);
+  }
+};
+
+struct X509StoreCtxDeleter {
+  void operator()(X509_STORE_CTX* ctx) const {
+    X509_STORE_CTX_free(ctx);
+  }
+};
+
+struct BioDeleter {
+  void operator()(BIO* bio) const {
+    BIO_free(bio);
+  }
+};
+
+struct X509StackDeleter {
+  void operator()(STACK_OF(X509) * stack) const {
+    sk_X509_free(stack);
+  }
+};
+
+using UniqueX509 = std::unique_ptr<X509, X509Deleter>;
+
+grpc::Status Unauthenticated(std::string message) {
+  return grpc::Status(grpc::StatusCode::UNAUTHENTICATED, std::move(message));
+}
+
+// Parses the PEM chain that the server sent, leaf first.
+std::vector<UniqueX509> ParseChain(grpc::string_ref pem) {
+  std::vector<UniqueX509> chain;
+  std::unique_ptr<BIO, BioDeleter> bio(
+      BIO_new_mem_buf(pem.data(), static_cast<int>(pem.size())));
+  if (!bio) return chain;
+  while (X509* cert = PEM_read_bio_X509(bio.get(), nullptr, nullptr, nullptr)) {
+    chain.emplace_back(cert);
+  }
+  // Reading past the last certificate leaves an error on the queue.
+  ERR_clear_error();
+  return chain;
+}
+
+}  // namespace
+
+GrpcRootCertificateVerifier::GrpcRootCertificateVerifier() = default;
+
+GrpcRootCertificateVerifier::~GrpcRootCertificateVerifier() {
+  for (auto& entry : roots_) {
+    for (X509* root : entry.second) {
+      X509_free(root);
+    }
+  }
+}
+
+bool GrpcRootCertificateVerifier::Verify(
+    TlsCustomVerificationCheckRequest* request,
+    std::function<void(grpc::Status)> callback,
+    grpc::Status* sync_status) {
+  *sync_status = VerifyChain(request);
+  if (!sync_status->ok()) return true;
+  return host_name_verifier_.Verify(request, std::move(callback), sync_status);
+}
+
+void GrpcRootCertificateVerifier::Cancel(TlsCustomVerificationCheckRequest*) {
+  // Verification always completes synchronously, so there is nothing to cancel.
+}
+
+grpc::Status GrpcRootCertificateVerifier::VerifyChain(
+    TlsCustomVerificationCheckRequest* request) {
+  std::vector<UniqueX509> chain = ParseChain(request->peer_cert_full_chain());
+  if (chain.empty()) {
+    return Unauthenticated("The server did not send a certificate chain.");
+  }
+
+  // Only the roots that could have issued a certificate of the chain are
+  // trusted for this handshake.
+  std::unique_ptr<X509_STORE, X509StoreDeleter> store(X509_STORE_new());
+  std::unique_ptr<STACK_OF(X509), X509StackDeleter> untrusted(
+      sk_X509_new_null());
+  if (!store || !untrusted) {
+    return Unauthenticated("Out of memory verifying the server certificate.");
+  }
+  std::unordered_set<uint32_t> issuer_hashes;
+  for (size_t i = 0; i != chain.size(); ++i) {
+    uint32_t issuer_hash = static_cast<uint32_t>(
+        X509_NAME_hash(X509_get_issuer_name(chain[i].get())));
+    if (issuer_hashes.insert(issuer_hash).second) {
+      for (X509* root : FindRoots(issuer_hash)) {
+        X509_STORE_add_cert(store.get(), root);
+      }
+    }
+    if (i != 0) {
+      sk_X509_push(untrusted.get(), chain[i].get());
+    }
+  }
+
+  std::unique_ptr<X509_STORE_CTX, X509StoreCtxDeleter> ctx(
+      X509_STORE_CTX_new());
+  if (!ctx || !X509_STORE_CTX_init(ctx.get(), store.get(), chain[0].get(),
+                                   untrusted.get()) ||
+      !X509_STORE_CTX_set_default(ctx.get(), "ssl_server")) {
+    return Unauthenticated("Failed to set up server certificate verification.");
+  }
+  if (X509_verify_cert(ctx.get()) != 1) {
+    int error = X509_STORE_CTX_get_error(ctx.get());
+    ERR_clear_error();
+    return Unauthenticated(
+        absl::StrCat("Server certificate verification failed: ",
+                     X509_verify_cert_error_string(error)));
+  }
+  return grpc::Status::OK;
+}
+
+const std::vector<X509*>& GrpcRootCertificateVerifier::FindRoots(
+    uint32_t subject_hash) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = roots_.find(subject_hash);
+  if (found != roots_.end()) return found->second;
+
+  // Entries are never removed, so references to them stay valid once the
+  // lock is released.
+  std::vector<X509*>& roots = roots_[subject_hash];
+  for (absl::string_view der : FindGrpcRootCertificates(subject_hash)) {
+    const auto* data = reinterpret_cast<const unsigned char*>(der.data());
+    X509* root = d2i_X509(nullptr, &data, static_cast<long>(der.size()));
+    if (root != nullptr) {
+      roots.push_back(root);
+    }
+  }
+  return roots;
+}
+
+std::shared_ptr<grpc::ChannelCredentials> CreateEmbeddedRootsCredentials() {
+  static NoDestructor<std::shared_ptr<grpc::experimental::CertificateVerifier>>
+      verifier(grpc::experimental::ExternalCertificateVerifier::Create<
+               GrpcRootCertificateVerifier>());
+
+  grpc::experimental::TlsChannelCredentialsOptions options;
+  // gRPC has no roots to verify against; the verifier does it instead.
+  options.set_verify_server_certs(false);
+  options.set_certificate_verifier(*verifier);
+  return grpc::experimental::TlsCredentials(options);
+}
+
+}  // namespace remote
+}  // namespace firestore
+}  // namespace firebase
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_REMOTE_GRPC_ROOT_CERTIFICATE_VERIFIER_H_
+#define FIRESTORE_CORE_SRC_REMOTE_GRPC_ROOT_CERTIFICATE_VERIFIER_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "Firestore/core/src/util/warnings.h"
+
+SUPPRESS_DOCUMENTATION_WARNINGS_BEGIN()
+#include "grpcpp/security/credentials.h"
+#include "grpcpp/security/tls_certificate_verifier.h"
+SUPPRESS_END()
+
+typedef struct x509_st X509;
+
+namespace firebase {
+namespace firestore {
+namespace remote {
+
+/**
+ * Verifies server certificate chains against the root certificates embedded in
+ * the binary. Instead of parsing the whole bundle up front, a root is only
+ * parsed once a server chain names it as an issuer; parsed roots are kept for
+ * the lifetime of the verifier. The host name is then checked as gRPC does by
+ * default.
+ */
+class GrpcRootCertificateVerifier
+    : public grpc::experimental::ExternalCertificateVerifier {
+ public:
+  GrpcRootCertificateVerifier();
+  ~GrpcRootCertificateVerifier() override;
+
+  bool Verify(grpc::experimental::TlsCustomVerificationCheckRequest* request,
+              std::function<void(grpc::Status)> callback,
+              grpc::Status* sync_status) override;
+
+  void Cancel(
+      grpc::experimental::TlsCustomVerificationCheckRequest* request) override;
+
+ private:
+  grpc::Status VerifyChain(
+      grpc::experimental::TlsCustomVerificationCheckRequest* request);
+
+  // Returns the embedded roots whose subject has the given hash, parsing them
+  // on first use. The verifier keeps ownership of the returned certificates.
+  const std::vector<X509*>& FindRoots(uint32_t subject_hash);
+
+  grpc::experimental::HostNameCertificateVerifier host_name_verifier_;
+
+  std::mutex mutex_;
+  std::unordered_map<uint32_t, std::vector<X509*>> roots_;
+};
+
+/**
+ * Creates channel credentials that verify servers with a process-wide
+ * `GrpcRootCertificateVerifier`, so that channels never load the embedded
+ * root certificates as a PEM bundle.
+ */
+std::shared_ptr<grpc::ChannelCredentials> CreateEmbeddedRootsCredentials();
+
+}  // namespace remote
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_REMOTE_GRPC_ROOT_CERTIFICATE_VERIFIER_H_
@@ -3,14 +3,26 @@
 #ifndef FIRESTORE_CORE_SRC_REMOTE_GRPC_ROOT_CERTIFICATES_GENERATED_H_
 #define FIRESTORE_CORE_SRC_REMOTE_GRPC_ROOT_CERTIFICATES_GENERATED_H_
 
+#include <cstdint>
 #include <cstdlib>
 
 namespace firebase {
 namespace firestore {
 namespace remote {
 
-extern const size_t grpc_root_certificates_generated_size;
-extern const unsigned char grpc_root_certificates_generated_data[];
+/**
+ * Locates one root certificate in `grpc_root_certificates_generated_der`.
+ * `subject_hash` is the OpenSSL `X509_NAME_hash` of the certificate's subject.
+ */
+struct GrpcRootCertificate {
+  uint32_t subject_hash;
+  uint32_t offset;
+  uint32_t size;
+};
+
+extern const size_t grpc_root_certificates_generated_count;
+extern const unsigned char grpc_root_certificates_generated_der[];
+extern const GrpcRootCertificate grpc_root_certificates_generated_index[];
 extern const char roots_filename[];
 
 }  // namespace remote
@@ -136,15 +136,25 @@ void GrpcStream::Read() {
 }
 
 void GrpcStream::Write(grpc::ByteBuffer&& message) {
-  MaybeWrite(buffered_writer_.EnqueueWrite(std::move(message)));
+  grpc::WriteOptions options = MakeWriteOptions(message);
+  MaybeWrite(buffered_writer_.EnqueueWrite(std::move(message), options));
 }
 
 void GrpcStream::WriteLast(grpc::ByteBuffer&& message) {
-  grpc::WriteOptions options;
+  grpc::WriteOptions options = MakeWriteOptions(message);
   options.set_last_message();
   MaybeWrite(buffered_writer_.EnqueueWrite(std::move(message), options));
 }
 
+grpc::WriteOptions GrpcStream::MakeWriteOptions(
+    const grpc::ByteBuffer& message) const {
+  grpc::WriteOptions options;
+  if (!grpc_connection_->ShouldCompress(message)) {
+    options.set_no_compression();
+  }
+  return options;
+}
+
 void GrpcStream::MaybeWrite(absl::optional<BufferedWrite> maybe_write) {
   if (!maybe_write) {
     return;
@@ -261,8 +271,9 @@ bool GrpcStream::WriteAndFinish(grpc::ByteBuffer&& message) {
 }
 
 bool GrpcStream::TryLastWrite(grpc::ByteBuffer&& message) {
+  grpc::WriteOptions options = MakeWriteOptions(message);
   absl::optional<BufferedWrite> maybe_write =
-      buffered_writer_.EnqueueWrite(std::move(message));
+      buffered_writer_.EnqueueWrite(std::move(message), options);
   // Only bother with the last write if there is no active write at the moment.
   if (!maybe_write) {
     return false;
@@ -271,7 +282,7 @@ bool GrpcStream::TryLastWrite(grpc::ByteBuffer&& message) {
   BufferedWrite last_write = std::move(maybe_write).value();
   auto completion = NewCompletion(Type::Write, {});
   *completion->message() = last_write.message;
-  call_->WriteLast(*completion->message(), grpc::WriteOptions{},
+  call_->WriteLast(*completion->message(), last_write.options,
                    completion.get());
 
   // Empirically, the write normally takes less than a millisecond to finish
@@ -318,6 +329,7 @@ void GrpcStream::OnOperationFailed() {
 
   FinishGrpcCall([this](const std::shared_ptr<GrpcCompletion>& completion) {
     Status status = ConvertStatus(*completion->status());
+    retry_delay_ = GetRetryDelay(*completion->status());
     FinishAndNotify(status);
   });
 }
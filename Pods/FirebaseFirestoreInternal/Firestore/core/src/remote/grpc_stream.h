@@ -17,6 +17,7 @@
 #ifndef FIRESTORE_CORE_SRC_REMOTE_GRPC_STREAM_H_
 #define FIRESTORE_CORE_SRC_REMOTE_GRPC_STREAM_H_
 
+#include <chrono>
 #include <functional>
 #include <map>
 #include <memory>
@@ -176,6 +177,14 @@ class GrpcStream : public GrpcCall {
    */
   Metadata GetResponseHeaders() const override;
 
+  /**
+   * Returns how long the server asked the client to wait before retrying, if
+   * the stream failed with a `google.rpc.RetryInfo` in its error details.
+   */
+  absl::optional<std::chrono::milliseconds> retry_delay() const {
+    return retry_delay_;
+  }
+
   /** For tests only */
   grpc::ClientContext* context() override {
     return context_.get();
@@ -183,6 +192,7 @@ class GrpcStream : public GrpcCall {
 
  private:
   void Read();
+  grpc::WriteOptions MakeWriteOptions(const grpc::ByteBuffer& message) const;
   void MaybeWrite(absl::optional<internal::BufferedWrite> maybe_write);
   bool TryLastWrite(grpc::ByteBuffer&& message);
 
@@ -237,6 +247,8 @@ class GrpcStream : public GrpcCall {
 
   std::vector<std::shared_ptr<GrpcCompletion>> completions_;
 
+  absl::optional<std::chrono::milliseconds> retry_delay_;
+
   // gRPC asserts that a call is finished exactly once.
   bool is_grpc_call_finished_ = false;
 };
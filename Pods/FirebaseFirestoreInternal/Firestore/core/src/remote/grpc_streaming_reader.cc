@@ -29,7 +29,9 @@ namespace firestore {
 namespace remote {
 
 using util::AsyncQueue;
+using util::OperationTrace;
 using util::Status;
+using util::TraceScope;
 
 GrpcStreamingReader::GrpcStreamingReader(
     std::unique_ptr<grpc::ClientContext> context,
@@ -51,6 +53,10 @@ void GrpcStreamingReader::Start(util::StatusOr<size_t> expected_response_count,
   expected_response_count_ = std::move(expected_response_count);
   responses_callback_ = std::move(responses_callback);
   close_callback_ = std::move(close_callback);
+  trace_ = OperationTrace::Current();
+  if (trace_) {
+    start_time_ = OperationTrace::Clock::now();
+  }
   stream_->Start();
 }
 
@@ -75,6 +81,7 @@ void GrpcStreamingReader::OnStreamRead(const grpc::ByteBuffer& message) {
   if (expected_response_count_.ok() &&
       responses_.size() == expected_response_count_.ValueOrDie()) {
     callback_fired_ = true;
+    TraceScope scope(FinishTrace());
     responses_callback_(responses_);
   }
 }
@@ -83,6 +90,7 @@ void GrpcStreamingReader::OnStreamFinish(const util::Status& status) {
   // Handle the case where 0 document reads required.
   // OnStreamRead will never be triggered,
   // but we still need to return an empty vector of documents.
+  TraceScope scope(FinishTrace());
   if (status.ok() && !callback_fired_) {
     callback_fired_ = true;
     responses_callback_(responses_);
@@ -92,6 +100,15 @@ void GrpcStreamingReader::OnStreamFinish(const util::Status& status) {
   close_callback_(status, callback_fired_);
 }
 
+std::shared_ptr<OperationTrace> GrpcStreamingReader::FinishTrace() {
+  std::shared_ptr<OperationTrace> trace = std::move(trace_);
+  if (trace) {
+    trace->Add(OperationTrace::Stage::kGrpcCall,
+               OperationTrace::Clock::now() - start_time_);
+  }
+  return trace;
+}
+
 }  // namespace remote
 }  // namespace firestore
 }  // namespace firebase
@@ -27,6 +27,7 @@
 #include "Firestore/core/src/util/status.h"
 #include "Firestore/core/src/util/status_fwd.h"
 #include "Firestore/core/src/util/statusor.h"
+#include "Firestore/core/src/util/trace.h"
 #include "Firestore/core/src/util/warnings.h"
 #include "grpcpp/client_context.h"
 #include "grpcpp/support/byte_buffer.h"
@@ -101,6 +102,10 @@ class GrpcStreamingReader : public GrpcCall, public GrpcStreamObserver {
   }
 
  private:
+  // Adds the time since `Start` to the trace of the call, if any, and hands
+  // the trace over to the caller.
+  std::shared_ptr<util::OperationTrace> FinishTrace();
+
   std::unique_ptr<GrpcStream> stream_;
   grpc::ByteBuffer request_;
 
@@ -109,6 +114,11 @@ class GrpcStreamingReader : public GrpcCall, public GrpcStreamObserver {
   ResponsesCallback responses_callback_;
   CloseCallback close_callback_;
   std::vector<ResponsesT> responses_;
+
+  // The trace of the operation that started the call, continued by the
+  // callbacks.
+  std::shared_ptr<util::OperationTrace> trace_;
+  util::OperationTrace::Clock::time_point start_time_;
 };
 
 }  // namespace remote
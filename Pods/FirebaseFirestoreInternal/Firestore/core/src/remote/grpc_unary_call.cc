@@ -28,7 +28,9 @@ namespace firestore {
 namespace remote {
 
 using util::AsyncQueue;
+using util::OperationTrace;
 using util::Status;
+using util::TraceScope;
 using Type = GrpcCompletion::Type;
 
 GrpcUnaryCall::GrpcUnaryCall(
@@ -53,6 +55,10 @@ GrpcUnaryCall::~GrpcUnaryCall() {
 
 void GrpcUnaryCall::Start(Callback&& callback) {
   callback_ = std::move(callback);
+  trace_ = OperationTrace::Current();
+  if (trace_) {
+    start_time_ = OperationTrace::Clock::now();
+  }
   call_->StartCall();
 
   // For lifetime details, see `GrpcCompletion` class comment.
@@ -64,6 +70,13 @@ void GrpcUnaryCall::Start(Callback&& callback) {
         finish_completion_.reset();
         Shutdown();
 
+        std::shared_ptr<OperationTrace> trace = std::move(trace_);
+        if (trace) {
+          trace->Add(OperationTrace::Stage::kGrpcCall,
+                     OperationTrace::Clock::now() - start_time_);
+        }
+        TraceScope scope(std::move(trace));
+
         auto callback = std::move(callback_);
         if (completion->status()->ok()) {
           callback(*completion->message());
@@ -25,6 +25,7 @@
 #include "Firestore/core/src/remote/grpc_completion.h"
 #include "Firestore/core/src/util/async_queue.h"
 #include "Firestore/core/src/util/status_fwd.h"
+#include "Firestore/core/src/util/trace.h"
 #include "Firestore/core/src/util/warnings.h"
 #include "grpcpp/client_context.h"
 #include "grpcpp/support/byte_buffer.h"
@@ -104,6 +105,11 @@ class GrpcUnaryCall : public GrpcCall {
 
   std::shared_ptr<GrpcCompletion> finish_completion_;
   Callback callback_;
+
+  // The trace of the operation that started the call, continued by the
+  // callback.
+  std::shared_ptr<util::OperationTrace> trace_;
+  util::OperationTrace::Clock::time_point start_time_;
 };
 
 }  // namespace remote
@@ -16,15 +16,91 @@
 
 #include "Firestore/core/src/remote/grpc_util.h"
 
+#include <pb_decode.h>
+
+#include <cstring>
+#include <string>
+
+#include "Firestore/Protos/nanopb/google/rpc/status.nanopb.h"
+#include "Firestore/core/src/nanopb/message.h"
+#include "Firestore/core/src/nanopb/reader.h"
 #include "Firestore/core/src/util/hard_assert.h"
 #include "Firestore/core/src/util/status.h"
 
 namespace firebase {
 namespace firestore {
 namespace remote {
+namespace {
 
+using nanopb::Message;
+using nanopb::StringReader;
 using util::Status;
 
+namespace chr = std::chrono;
+
+const char* const kRetryInfoTypeUrl =
+    "type.googleapis.com/google.rpc.RetryInfo";
+
+bool HasTypeUrl(const google_protobuf_Any& any, const char* type_url) {
+  size_t size = std::strlen(type_url);
+  return any.type_url && any.type_url->size == size &&
+         std::memcmp(any.type_url->bytes, type_url, size) == 0;
+}
+
+/**
+ * Reads the `retry_delay` duration out of a serialized `google.rpc.RetryInfo`.
+ * There is no generated code for RetryInfo, so the two levels of the message
+ * are taken apart by hand.
+ */
+absl::optional<chr::milliseconds> DecodeRetryInfo(
+    const pb_bytes_array_t* bytes) {
+  if (!bytes) {
+    return absl::nullopt;
+  }
+
+  pb_istream_t stream = pb_istream_from_buffer(bytes->bytes, bytes->size);
+  pb_wire_type_t wire_type;
+  uint32_t tag;
+  bool eof;
+  while (pb_decode_tag(&stream, &wire_type, &tag, &eof)) {
+    // RetryInfo.retry_delay
+    if (tag != 1 || wire_type != PB_WT_STRING) {
+      if (!pb_skip_field(&stream, wire_type)) {
+        return absl::nullopt;
+      }
+      continue;
+    }
+
+    pb_istream_t duration;
+    if (!pb_make_string_substream(&stream, &duration)) {
+      return absl::nullopt;
+    }
+    int64_t seconds = 0;
+    int64_t nanos = 0;
+    while (pb_decode_tag(&duration, &wire_type, &tag, &eof)) {
+      // Duration.seconds and Duration.nanos
+      uint64_t value;
+      if ((tag == 1 || tag == 2) && wire_type == PB_WT_VARINT) {
+        if (!pb_decode_varint(&duration, &value)) {
+          return absl::nullopt;
+        }
+        (tag == 1 ? seconds : nanos) = static_cast<int64_t>(value);
+      } else if (!pb_skip_field(&duration, wire_type)) {
+        return absl::nullopt;
+      }
+    }
+    if (!pb_close_string_substream(&stream, &duration) || seconds < 0 ||
+        nanos < 0) {
+      return absl::nullopt;
+    }
+    return chr::duration_cast<chr::milliseconds>(chr::seconds(seconds) +
+                                                 chr::nanoseconds(nanos));
+  }
+  return absl::nullopt;
+}
+
+}  // namespace
+
 Status ConvertStatus(const grpc::Status& from) {
   if (from.ok()) {
     return Status::OK();
@@ -43,6 +119,27 @@ Status ConvertStatus(const grpc::Status& from) {
   return {static_cast<Error>(error_code), from.error_message()};
 }
 
+absl::optional<chr::milliseconds> GetRetryDelay(const grpc::Status& status) {
+  const std::string& details = status.error_details();
+  if (status.ok() || details.empty()) {
+    return absl::nullopt;
+  }
+
+  StringReader reader{reinterpret_cast<const uint8_t*>(details.data()),
+                      details.size()};
+  auto rpc_status = Message<google_rpc_Status>::TryParse(&reader);
+  if (!reader.ok()) {
+    return absl::nullopt;
+  }
+  for (pb_size_t i = 0; i < rpc_status->details_count; ++i) {
+    const google_protobuf_Any& detail = rpc_status->details[i];
+    if (HasTypeUrl(detail, kRetryInfoTypeUrl)) {
+      return DecodeRetryInfo(detail.value);
+    }
+  }
+  return absl::nullopt;
+}
+
 }  // namespace remote
 }  // namespace firestore
 }  // namespace firebase
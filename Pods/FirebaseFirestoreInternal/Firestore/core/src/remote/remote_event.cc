@@ -18,6 +18,7 @@
 
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "Firestore/core/src/local/target_data.h"
 #include "Firestore/core/src/util/log.h"
@@ -384,14 +385,23 @@ int WatchChangeAggregator::FilterRemovedDocuments(
     const BloomFilter& bloom_filter, int target_id) {
   const DocumentKeySet existing_keys =
       target_metadata_provider_->GetRemoteKeysForTarget(target_id);
-  int removalCount = 0;
+  const DatabaseId& database_id = target_metadata_provider_->GetDatabaseId();
+  std::string documents_path =
+      util::StringFormat("projects/%s/databases/%s/documents/",
+                         database_id.project_id(), database_id.database_id());
+
+  std::vector<std::string> key_paths;
+  key_paths.reserve(existing_keys.size());
   for (const DocumentKey& key : existing_keys) {
-    const DatabaseId& database_id = target_metadata_provider_->GetDatabaseId();
-    std::string document_path = util::StringFormat(
-        "projects/%s/databases/%s/documents/%s", database_id.project_id(),
-        database_id.database_id(), key.ToString());
+    key_paths.push_back(key.ToString());
+  }
+  std::vector<bool> might_contain =
+      bloom_filter.MightContainAll(documents_path, key_paths);
 
-    if (!bloom_filter.MightContain(document_path)) {
+  int removalCount = 0;
+  size_t i = 0;
+  for (const DocumentKey& key : existing_keys) {
+    if (!might_contain[i++]) {
       RemoveDocumentFromTarget(target_id, key,
                                /*updatedDocument=*/absl::nullopt);
       removalCount++;
@@ -16,6 +16,7 @@
 
 #include "Firestore/core/src/remote/remote_store.h"
 
+#include <algorithm>
 #include <string>
 #include <utility>
 
@@ -25,6 +26,7 @@
 #include "Firestore/core/src/model/mutation_batch.h"
 #include "Firestore/core/src/model/mutation_batch_result.h"
 #include "Firestore/core/src/nanopb/nanopb_util.h"
+#include "Firestore/core/src/remote/write_coalescer.h"
 #include "Firestore/core/src/util/error_apple.h"
 #include "Firestore/core/src/util/hard_assert.h"
 #include "Firestore/core/src/util/log.h"
@@ -51,13 +53,10 @@ using model::SnapshotVersion;
 using model::TargetId;
 using nanopb::ByteString;
 using util::AsyncQueue;
+using util::MemoryPressure;
+using util::OperationTrace;
 using util::Status;
-
-/**
- * The maximum number of pending writes to allow.
- * TODO(b/35853402): Negotiate this value with the backend.
- */
-constexpr int kMaxPendingWrites = 10;
+using util::TraceScope;
 
 RemoteStore::RemoteStore(
     LocalStore* local_store,
@@ -67,6 +66,7 @@ RemoteStore::RemoteStore(
     std::function<void(model::OnlineState)> online_state_handler)
     : local_store_{local_store},
       datastore_{std::move(datastore)},
+      worker_queue_{worker_queue},
       online_state_tracker_{worker_queue, std::move(online_state_handler)},
       connectivity_monitor_{NOT_NULL(connectivity_monitor)} {
   datastore_->Start();
@@ -126,6 +126,8 @@ void RemoteStore::DisableNetwork() {
 }
 
 void RemoteStore::DisableNetworkInternal() {
+  AcknowledgePendingWrites();
+
   watch_stream_->Stop();
   write_stream_->Stop();
 
@@ -133,7 +135,9 @@ void RemoteStore::DisableNetworkInternal() {
     LOG_DEBUG("Stopping write stream with %s pending writes",
               write_pipeline_.size());
     write_pipeline_.clear();
+    coalesced_batches_.clear();
   }
+  write_window_.OnWritesInterrupted();
 
   CleanUpWatchStreamState();
 }
@@ -161,11 +165,18 @@ void RemoteStore::Listen(TargetData target_data) {
   // Mark this as something the client is currently listening for.
   listen_targets_[target_key] = std::move(target_data);
 
+  if (const std::shared_ptr<OperationTrace>& trace =
+          OperationTrace::Current()) {
+    TracedListen& traced = traced_listens_[target_key];
+    traced.trace = trace;
+    traced.listen_time = OperationTrace::Clock::now();
+  }
+
   if (ShouldStartWatchStream()) {
     // The listen will be sent in `OnWatchStreamOpen`
     StartWatchStream();
   } else if (watch_stream_->IsOpen()) {
-    SendWatchRequest(listen_targets_[target_key]);
+    QueueWatchRequest(target_key);
   }
 }
 
@@ -173,10 +184,11 @@ void RemoteStore::StopListening(TargetId target_id) {
   size_t num_erased = listen_targets_.erase(target_id);
   HARD_ASSERT(num_erased == 1,
               "StopListening: target not currently watched: %s", target_id);
+  traced_listens_.erase(target_id);
 
   // The watch stream might not be started if we're in a disconnected state
   if (watch_stream_->IsOpen()) {
-    SendUnwatchRequest(target_id);
+    QueueUnwatchRequest(target_id);
   }
   if (listen_targets_.empty()) {
     if (watch_stream_->IsOpen()) {
@@ -191,6 +203,20 @@ void RemoteStore::StopListening(TargetId target_id) {
 }
 
 void RemoteStore::SendWatchRequest(const TargetData& target_data) {
+  // Requests sent when the stream opens are encoded for their own trace.
+  std::shared_ptr<OperationTrace> trace;
+  auto traced = traced_listens_.find(target_data.target_id());
+  if (traced != traced_listens_.end()) {
+    trace = traced->second.trace;
+    if (!traced->second.send_time) {
+      auto now = OperationTrace::Clock::now();
+      trace->Add(OperationTrace::Stage::kRemoteStore,
+                 now - traced->second.listen_time);
+      traced->second.send_time = now;
+    }
+  }
+  TraceScope scope(std::move(trace));
+
   // We need to increment the expected number of pending responses we're due
   // from watch so we wait for the ack to process any messages from this target.
   watch_change_aggregator_->RecordPendingTargetRequest(target_data.target_id());
@@ -214,6 +240,60 @@ void RemoteStore::SendUnwatchRequest(TargetId target_id) {
   watch_stream_->UnwatchTargetId(target_id);
 }
 
+void RemoteStore::QueueWatchRequest(TargetId target_id) {
+  bool was_empty =
+      pending_watch_targets_.empty() && pending_unwatch_targets_.empty();
+  pending_watch_targets_.push_back(target_id);
+  if (was_empty) {
+    // Requests made before this runs are sent along with this one. This runs
+    // on the worker queue already, which `Enqueue` does not allow.
+    worker_queue_->EnqueueRelaxed([this] { SendPendingWatchRequests(); });
+  }
+}
+
+void RemoteStore::QueueUnwatchRequest(TargetId target_id) {
+  auto found = std::find(pending_watch_targets_.begin(),
+                         pending_watch_targets_.end(), target_id);
+  if (found != pending_watch_targets_.end()) {
+    // The backend never heard of this listen.
+    pending_watch_targets_.erase(found);
+    return;
+  }
+
+  bool was_empty =
+      pending_watch_targets_.empty() && pending_unwatch_targets_.empty();
+  pending_unwatch_targets_.push_back(target_id);
+  if (was_empty) {
+    worker_queue_->EnqueueRelaxed([this] { SendPendingWatchRequests(); });
+  }
+}
+
+void RemoteStore::SendPendingWatchRequests() {
+  std::vector<TargetId> unwatch_targets;
+  std::vector<TargetId> watch_targets;
+  unwatch_targets.swap(pending_unwatch_targets_);
+  watch_targets.swap(pending_watch_targets_);
+
+  // Both lists are cleared when the stream closes, and a new stream sends all
+  // of `listen_targets_` when it opens.
+  if (!watch_stream_->IsOpen()) {
+    return;
+  }
+
+  // Removals go first, so that a target that was unlistened and listened to
+  // again is reset on the backend.
+  for (TargetId target_id : unwatch_targets) {
+    SendUnwatchRequest(target_id);
+  }
+  for (TargetId target_id : watch_targets) {
+    auto found = listen_targets_.find(target_id);
+    HARD_ASSERT(found != listen_targets_.end(),
+                "Queued listen of a target that is not watched: %s",
+                target_id);
+    SendWatchRequest(found->second);
+  }
+}
+
 bool RemoteStore::ShouldStartWatchStream() const {
   return CanUseNetwork() && !watch_stream_->IsStarted() &&
          !listen_targets_.empty();
@@ -230,6 +310,8 @@ void RemoteStore::StartWatchStream() {
 
 void RemoteStore::CleanUpWatchStreamState() {
   watch_change_aggregator_.reset();
+  pending_watch_targets_.clear();
+  pending_unwatch_targets_.clear();
 }
 
 void RemoteStore::OnWatchStreamOpen() {
@@ -277,6 +359,9 @@ void RemoteStore::OnWatchStreamChange(const WatchChange& change,
       return ProcessTargetError(watch_target_change);
     } else {
       watch_change_aggregator_->HandleTargetChange(watch_target_change);
+      if (!traced_listens_.empty()) {
+        TraceCurrentTargets(watch_target_change);
+      }
     }
   } else if (change.type() == WatchChange::Type::Document) {
     watch_change_aggregator_->HandleDocumentChange(
@@ -297,10 +382,43 @@ void RemoteStore::OnWatchStreamChange(const WatchChange& change,
   }
 }
 
+void RemoteStore::TraceCurrentTargets(const WatchTargetChange& change) {
+  if (change.state() != WatchTargetChangeState::Current) {
+    return;
+  }
+  for (TargetId target_id : change.target_ids()) {
+    auto traced = traced_listens_.find(target_id);
+    if (traced == traced_listens_.end() || !traced->second.send_time ||
+        traced->second.current) {
+      continue;
+    }
+    traced->second.current = true;
+    traced->second.trace->Add(
+        OperationTrace::Stage::kGrpcCall,
+        OperationTrace::Clock::now() - *traced->second.send_time);
+  }
+}
+
 void RemoteStore::RaiseWatchSnapshot(const SnapshotVersion& snapshot_version) {
   HARD_ASSERT(snapshot_version != SnapshotVersion::None(),
               "Can't raise event for unknown SnapshotVersion");
 
+  // Applying the event continues the trace of a listen that it makes current.
+  // Only one trace can be current, so if there are several, the others only
+  // get their time in the backend.
+  std::shared_ptr<OperationTrace> trace;
+  for (auto it = traced_listens_.begin(); it != traced_listens_.end();) {
+    if (it->second.current) {
+      if (!trace) {
+        trace = std::move(it->second.trace);
+      }
+      it = traced_listens_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  TraceScope scope(std::move(trace));
+
   RemoteEvent remote_event =
       watch_change_aggregator_->CreateRemoteEvent(snapshot_version);
 
@@ -390,6 +508,16 @@ void RemoteStore::RunAggregateQuery(
   }
 }
 
+void RemoteStore::LookupDocuments(const std::vector<model::DocumentKey>& keys,
+                                  Datastore::LookupCallback&& callback) {
+  if (CanUseNetwork()) {
+    datastore_->LookupDocuments(keys, std::move(callback));
+  } else {
+    callback(Status::FromErrno(Error::kErrorUnavailable,
+                               "Failed to get documents from server."));
+  }
+}
+
 void RemoteStore::RunPipeline(
     const api::Pipeline& pipeline,
     util::StatusOrCallback<api::PipelineSnapshot> result_callback) {
@@ -416,6 +544,9 @@ void RemoteStore::FillWritePipeline() {
       }
       break;
     }
+    if (write_coalescing_enabled_) {
+      batch = CoalesceWrites(std::move(batch).value());
+    }
     AddToWritePipeline(*batch);
     last_batch_id_retrieved = batch->batch_id();
   }
@@ -425,8 +556,31 @@ void RemoteStore::FillWritePipeline() {
   }
 }
 
+MutationBatch RemoteStore::CoalesceWrites(MutationBatch batch) {
+  WriteCoalescer coalescer;
+  if (!coalescer.Add(batch)) {
+    return batch;
+  }
+  while (absl::optional<MutationBatch> next =
+             local_store_->GetNextMutationBatch(
+                 coalescer.batches().back().batch_id())) {
+    if (!coalescer.Add(*next)) {
+      break;
+    }
+  }
+  if (coalescer.batches().size() == 1) {
+    return batch;
+  }
+
+  MutationBatch write = coalescer.ToWrite();
+  LOG_DEBUG("Coalesced %s batches into one write of %s mutations",
+            coalescer.batches().size(), write.mutations().size());
+  coalesced_batches_[write.batch_id()] = coalescer.batches();
+  return write;
+}
+
 bool RemoteStore::CanAddToWritePipeline() const {
-  return CanUseNetwork() && write_pipeline_.size() < kMaxPendingWrites;
+  return CanUseNetwork() && write_pipeline_.size() < write_window_.size();
 }
 
 void RemoteStore::AddToWritePipeline(const MutationBatch& batch) {
@@ -437,6 +591,7 @@ void RemoteStore::AddToWritePipeline(const MutationBatch& batch) {
 
   if (write_stream_->IsOpen() && write_stream_->handshake_complete()) {
     write_stream_->WriteMutations(batch.mutations());
+    write_window_.OnWriteSent();
   }
 }
 
@@ -462,6 +617,7 @@ void RemoteStore::OnWriteStreamHandshakeComplete() {
   // Send the write pipeline now that the stream is established.
   for (const MutationBatch& write : write_pipeline_) {
     write_stream_->WriteMutations(write.mutations());
+    write_window_.OnWriteSent();
   }
 }
 
@@ -472,20 +628,70 @@ void RemoteStore::OnWriteStreamMutationResult(
   // to the first write in our write pipeline.
   HARD_ASSERT(!write_pipeline_.empty(), "Got result for empty write pipeline");
 
+  write_window_.OnWriteAcknowledged(
+      /*pipeline_full=*/write_pipeline_.size() >= write_window_.size());
   MutationBatch batch = write_pipeline_.front();
   write_pipeline_.erase(write_pipeline_.begin());
 
-  MutationBatchResult batch_result(std::move(batch), commit_version,
-                                   std::move(mutation_results),
-                                   write_stream_->last_stream_token());
-  sync_engine_->HandleSuccessfulWrite(std::move(batch_result));
+  auto coalesced = coalesced_batches_.find(batch.batch_id());
+  if (coalesced != coalesced_batches_.end()) {
+    // Acknowledge each of the batches that the write was made from, so that
+    // their callbacks run as if they had been written one by one.
+    for (MutationBatch& original : coalesced->second) {
+      std::vector<MutationResult> results =
+          WriteCoalescer::SplitResults(original, batch, mutation_results);
+      QueueWriteResult(MutationBatchResult(std::move(original), commit_version,
+                                           std::move(results),
+                                           write_stream_->last_stream_token()));
+    }
+    coalesced_batches_.erase(coalesced);
+  } else {
+    MutationBatchResult batch_result(std::move(batch), commit_version,
+                                     std::move(mutation_results),
+                                     write_stream_->last_stream_token());
+    QueueWriteResult(std::move(batch_result));
+  }
 
   // It's possible that with the completion of this mutation another slot has
   // freed up.
   FillWritePipeline();
 }
 
+void RemoteStore::QueueWriteResult(MutationBatchResult batch_result) {
+  pending_write_results_.push_back(std::move(batch_result));
+  if (pending_write_results_.size() > 1) {
+    return;
+  }
+
+  // Results that arrive before this runs are acknowledged along with this one.
+  // Once the queue is shutting down this is a no-op; `Shutdown` acknowledges
+  // the pending results itself. This runs on the worker queue already, which
+  // `Enqueue` does not allow.
+  worker_queue_->EnqueueRelaxed([this] { AcknowledgePendingWrites(); });
+}
+
+void RemoteStore::AcknowledgePendingWrites() {
+  if (pending_write_results_.empty()) {
+    return;
+  }
+
+  std::vector<MutationBatchResult> batch_results;
+  batch_results.swap(pending_write_results_);
+  sync_engine_->HandleSuccessfulWrites(std::move(batch_results));
+}
+
+void RemoteStore::ReleaseMemory(MemoryPressure pressure) {
+  datastore_->ReleaseMemory(pressure);
+}
+
 void RemoteStore::OnWriteStreamClose(const Status& status) {
+  // A rejected write must not be handled before the writes that were
+  // acknowledged ahead of it.
+  AcknowledgePendingWrites();
+
+  // Whatever is left in the pipeline is sent again on the next stream.
+  write_window_.OnWritesInterrupted();
+
   if (status.ok()) {
     // Graceful stop (due to Stop() or idle timeout). Make sure that's
     // desirable.
@@ -555,6 +761,19 @@ void RemoteStore::HandleWriteError(const Status& status) {
   // down--this was just a bad request so inhibit backoff on the next restart.
   write_stream_->InhibitBackoff();
 
+  auto coalesced = coalesced_batches_.find(batch.batch_id());
+  if (coalesced != coalesced_batches_.end()) {
+    // The whole write was rejected, which may be down to any one of the
+    // batches it was made from. Send them one by one instead, so that only
+    // the batches that are at fault are rejected.
+    LOG_DEBUG("Coalesced write rejected; retrying its %s batches one by one",
+              coalesced->second.size());
+    write_pipeline_.insert(write_pipeline_.begin(), coalesced->second.begin(),
+                           coalesced->second.end());
+    coalesced_batches_.erase(coalesced);
+    return;
+  }
+
   sync_engine_->HandleRejectedWrite(batch.batch_id(), status);
 
   // It's possible that with the completion of this mutation another slot has
@@ -569,7 +788,7 @@ bool RemoteStore::CanUseNetwork() const {
 }
 
 std::shared_ptr<Transaction> RemoteStore::CreateTransaction() {
-  return std::make_shared<Transaction>(datastore_);
+  return std::make_shared<Transaction>(datastore_, worker_queue_);
 }
 
 DocumentKeySet RemoteStore::GetRemoteKeysForTarget(TargetId target_id) const {
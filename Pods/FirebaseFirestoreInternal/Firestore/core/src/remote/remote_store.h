@@ -26,15 +26,20 @@
 #include "Firestore/core/src/local/target_data.h"
 #include "Firestore/core/src/model/model_fwd.h"
 #include "Firestore/core/src/model/mutation_batch.h"
+#include "Firestore/core/src/model/mutation_batch_result.h"
 #include "Firestore/core/src/model/types.h"
 #include "Firestore/core/src/remote/datastore.h"
 #include "Firestore/core/src/remote/online_state_tracker.h"
 #include "Firestore/core/src/remote/remote_event.h"
 #include "Firestore/core/src/remote/watch_change.h"
 #include "Firestore/core/src/remote/watch_stream.h"
+#include "Firestore/core/src/remote/write_pipeline_window.h"
 #include "Firestore/core/src/remote/write_stream.h"
 #include "Firestore/core/src/util/async_queue.h"
+#include "Firestore/core/src/util/memory_pressure_monitor.h"
 #include "Firestore/core/src/util/status_fwd.h"
+#include "Firestore/core/src/util/trace.h"
+#include "absl/types/optional.h"
 
 namespace firebase {
 namespace firestore {
@@ -86,6 +91,14 @@ class RemoteStoreCallback {
   virtual void HandleSuccessfulWrite(
       model::MutationBatchResult batch_result) = 0;
 
+  /**
+   * Applies the results of several successful writes at once, in order. This
+   * is equivalent to calling `HandleSuccessfulWrite` for each of them, but
+   * lets the local store recalculate the affected documents only once.
+   */
+  virtual void HandleSuccessfulWrites(
+      std::vector<model::MutationBatchResult> batch_results) = 0;
+
   /**
    * Rejects the batch, removing the batch from the mutation queue, recomputing
    * the local view of any documents affected by the batch and then, emitting
@@ -158,6 +171,16 @@ class RemoteStore : public TargetMetadataProvider,
    */
   void HandleCredentialChange();
 
+  /**
+   * Passes the write results that are still waiting to be coalesced on to the
+   * `SyncEngine`. Must be called before the mutation queue they belong to is
+   * swapped out, e.g. on a user change.
+   */
+  void AcknowledgePendingWrites();
+
+  /** Bounds the memory used by the network while the system is short on it. */
+  void ReleaseMemory(util::MemoryPressure pressure);
+
   /**
    * Listens to the target identified by the given `TargetData`.
    *
@@ -189,6 +212,15 @@ class RemoteStore : public TargetMetadataProvider,
    */
   void AddToWritePipeline(const model::MutationBatch& batch);
 
+  /**
+   * Makes `FillWritePipeline` coalesce runs of consecutive batches into a
+   * single write where `WriteCoalescer` finds that safe. Each batch is still
+   * acknowledged, or rejected, on its own.
+   */
+  void EnableWriteCoalescing() {
+    write_coalescing_enabled_ = true;
+  }
+
   /** Returns a new transaction backed by this remote store. */
   // TODO(c++14): return a plain value when it becomes possible to move
   // `Transaction` into lambdas.
@@ -204,6 +236,14 @@ class RemoteStore : public TargetMetadataProvider,
                          const std::vector<model::AggregateField>& aggregates,
                          api::AggregateQueryCallback&& result_callback);
 
+  /**
+   * Reads the current versions of the given documents from the backend once,
+   * without listening to them. Fails with `Error::kErrorUnavailable` if the
+   * network is disabled.
+   */
+  void LookupDocuments(const std::vector<model::DocumentKey>& keys,
+                       Datastore::LookupCallback&& callback);
+
   void RunPipeline(const api::Pipeline& pipeline,
                    util::StatusOrCallback<api::PipelineSnapshot> callback);
 
@@ -227,6 +267,15 @@ class RemoteStore : public TargetMetadataProvider,
   void SendWatchRequest(const local::TargetData& target_data);
   void SendUnwatchRequest(model::TargetId target_id);
 
+  /**
+   * Queues the listen or unlisten request of a target to be sent along with
+   * the others made by the current operation on the worker queue. A listen
+   * that is unlistened before it was sent cancels out.
+   */
+  void QueueWatchRequest(model::TargetId target_id);
+  void QueueUnwatchRequest(model::TargetId target_id);
+  void SendPendingWatchRequests();
+
   /**
    * Takes a batch of changes from the `Datastore`, repackages them as a
    * `RemoteEvent`, and passes that on to the `SyncEngine`.
@@ -250,9 +299,22 @@ class RemoteStore : public TargetMetadataProvider,
    */
   bool ShouldStartWriteStream() const;
 
+  /**
+   * Queues the result of a write for `AcknowledgePendingWrites`, which runs
+   * once the results that have already arrived on the worker queue have
+   * been queued as well.
+   */
+  void QueueWriteResult(model::MutationBatchResult batch_result);
+
   void HandleHandshakeError(const util::Status& status);
   void HandleWriteError(const util::Status& status);
 
+  /**
+   * Returns a write that coalesces `batch` with the batches queued after it,
+   * or `batch` if it can not be coalesced with the next one.
+   */
+  model::MutationBatch CoalesceWrites(model::MutationBatch batch);
+
   void StartWatchStream();
 
   /**
@@ -263,6 +325,12 @@ class RemoteStore : public TargetMetadataProvider,
 
   void CleanUpWatchStreamState();
 
+  /**
+   * Records the time since the first `SendWatchRequest` of the target in its
+   * trace once the target is current, if it is traced.
+   */
+  void TraceCurrentTargets(const WatchTargetChange& change);
+
   RemoteStoreCallback* sync_engine_ = nullptr;
 
   /**
@@ -285,6 +353,29 @@ class RemoteStore : public TargetMetadataProvider,
    */
   std::unordered_map<model::TargetId, local::TargetData> listen_targets_;
 
+  /**
+   * Targets of `listen_targets_` whose listen requests are queued to be sent
+   * on the open watch stream, and removed targets whose unlisten requests
+   * are. Both are dropped when the stream closes, since a new stream sends
+   * all of `listen_targets_` once it opens.
+   */
+  std::vector<model::TargetId> pending_watch_targets_;
+  std::vector<model::TargetId> pending_unwatch_targets_;
+
+  /**
+   * The traces of listens made by traced operations, kept until their targets
+   * become current and the remote event that they are current in is applied.
+   */
+  struct TracedListen {
+    std::shared_ptr<util::OperationTrace> trace;
+    util::OperationTrace::Clock::time_point listen_time;
+    absl::optional<util::OperationTrace::Clock::time_point> send_time;
+    bool current = false;
+  };
+  std::unordered_map<model::TargetId, TracedListen> traced_listens_;
+
+  std::shared_ptr<util::AsyncQueue> worker_queue_;
+
   OnlineStateTracker online_state_tracker_;
 
   ConnectivityMonitor* connectivity_monitor_ = nullptr;
@@ -300,7 +391,7 @@ class RemoteStore : public TargetMetadataProvider,
   std::unique_ptr<WatchChangeAggregator> watch_change_aggregator_;
 
   /**
-   * A list of up to `kMaxPendingWrites` writes that we have fetched from the
+   * A list of up to `write_window_.size()` writes that we have fetched from the
    * `LocalStore` via `FillWritePipeline` and have or will send to the write
    * stream.
    *
@@ -317,6 +408,26 @@ class RemoteStore : public TargetMetadataProvider,
    * the `write_pipeline_` as we receive responses.
    */
   std::vector<model::MutationBatch> write_pipeline_;
+
+  /** Sizes `write_pipeline_` from how quickly writes are acknowledged. */
+  WritePipelineWindow write_window_;
+
+  bool write_coalescing_enabled_ = false;
+
+  /**
+   * The batches that each coalesced write in `write_pipeline_` was made from,
+   * by the batch ID of the write, which is that of its last batch.
+   */
+  std::unordered_map<model::BatchId, std::vector<model::MutationBatch>>
+      coalesced_batches_;
+
+  /**
+   * Results of writes that have been acknowledged by the backend and removed
+   * from `write_pipeline_` but not yet passed on to the `SyncEngine`. Bursts
+   * of acknowledgements are applied together so that the documents they
+   * touch are only recalculated once.
+   */
+  std::vector<model::MutationBatchResult> pending_write_results_;
 };
 
 }  // namespace remote
@@ -58,6 +58,7 @@
 #include "Firestore/core/src/util/statusor.h"
 #include "Firestore/core/src/util/string_format.h"
 #include "absl/algorithm/container.h"
+#include "absl/strings/strip.h"
 #include "absl/types/span.h"
 
 namespace firebase {
@@ -242,7 +243,7 @@ DocumentKey Serializer::DecodeKey(ReadContext* context,
 
   // Avoid assertion failures in DocumentKey if local_path is invalid.
   if (!context->status().ok()) return DocumentKey{};
-  return DocumentKey{std::move(local_path)};
+  return DocumentKey::Intern(std::move(local_path));
 }
 
 pb_bytes_array_t* Serializer::EncodeQueryPath(const ResourcePath& path) const {
@@ -339,8 +340,13 @@ MutableDocument Serializer::DecodeFoundDocument(
     context->Fail("Got a document response with no snapshot version");
   }
 
-  return MutableDocument::FoundDocument(std::move(key), version,
-                                        std::move(value));
+  // The read time lets the document be cached as of the lookup, as it is
+  // when it arrives on a watch target.
+  SnapshotVersion read_time = DecodeVersion(context, response.read_time);
+  MutableDocument document = MutableDocument::FoundDocument(
+      std::move(key), version, std::move(value));
+  document.WithReadTime(read_time);
+  return document;
 }
 
 MutableDocument Serializer::DecodeMissingDocument(
@@ -357,7 +363,10 @@ MutableDocument Serializer::DecodeMissingDocument(
     context->Fail("Got a no document response with no snapshot version");
   }
 
-  return MutableDocument::NoDocument(std::move(key), version);
+  MutableDocument document =
+      MutableDocument::NoDocument(std::move(key), version);
+  document.WithReadTime(version);
+  return document;
 }
 
 google_firestore_v1_Write Serializer::EncodeMutation(
@@ -1525,6 +1534,29 @@ bool Serializer::IsLocalDocumentKey(absl::string_view path) const {
          DocumentKey::IsDocumentKey(resource.PopFirst(5));
 }
 
+bool Serializer::IsEncodedKey(absl::string_view name,
+                              const DocumentKey& key) const {
+  for (absl::string_view segment :
+       {absl::string_view("projects"),
+        absl::string_view(database_id_.project_id()),
+        absl::string_view("databases"),
+        absl::string_view(database_id_.database_id()),
+        absl::string_view("documents")}) {
+    if (!absl::ConsumePrefix(&name, segment) ||
+        !absl::ConsumePrefix(&name, "/")) {
+      return false;
+    }
+  }
+
+  bool first = true;
+  for (const std::string& segment : key.path()) {
+    if (!first && !absl::ConsumePrefix(&name, "/")) return false;
+    if (!absl::ConsumePrefix(&name, segment)) return false;
+    first = false;
+  }
+  return name.empty();
+}
+
 api::PipelineSnapshot Serializer::DecodePipelineResponse(
     util::ReadContext* context,
     const nanopb::Message<google_firestore_v1_ExecutePipelineResponse>& message)
@@ -250,6 +250,13 @@ class Serializer {
 
   bool IsLocalDocumentKey(absl::string_view path) const;
 
+  /**
+   * Returns true if `name` is the fully qualified name of `key` in this
+   * database. Unlike decoding the name, this doesn't allocate.
+   */
+  bool IsEncodedKey(absl::string_view name,
+                    const model::DocumentKey& key) const;
+
   const model::DatabaseId& database_id() const {
     return database_id_;
   }
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_REMOTE_SSL_SESSION_STORE_H_
+#define FIRESTORE_CORE_SRC_REMOTE_SSL_SESSION_STORE_H_
+
+#if defined(__APPLE__)
+
+#include "grpc/credentials.h"
+
+namespace firebase {
+namespace firestore {
+namespace remote {
+
+/**
+ * Creates a store that keeps TLS sessions in the keychain, so that the first
+ * connection after an app launch can resume the session of the previous run
+ * instead of doing a full handshake. The items are only readable by this app,
+ * on this device, once it has been unlocked after a restart.
+ */
+grpc_ssl_session_store CreateKeychainSslSessionStore();
+
+}  // namespace remote
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // defined(__APPLE__)
+
+#endif  // FIRESTORE_CORE_SRC_REMOTE_SSL_SESSION_STORE_H_
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/remote/ssl_session_store.h"
+
+#if defined(__APPLE__)
+
+#import <Foundation/Foundation.h>
+#import <Security/Security.h>
+
+#include "Firestore/core/src/util/log.h"
+#include "grpc/slice.h"
+
+namespace firebase {
+namespace firestore {
+namespace remote {
+
+namespace {
+
+NSString* const kKeychainService = @"com.google.firestore.tls-sessions";
+
+NSMutableDictionary* ItemQuery(const char* key) {
+  return [@{
+    (__bridge id)kSecClass : (__bridge id)kSecClassGenericPassword,
+    (__bridge id)kSecAttrService : kKeychainService,
+    (__bridge id)kSecAttrAccount : @(key),
+  } mutableCopy];
+}
+
+grpc_slice LoadSession(void*, const char* key) {
+  @autoreleasepool {
+    NSMutableDictionary* query = ItemQuery(key);
+    query[(__bridge id)kSecReturnData] = @YES;
+    query[(__bridge id)kSecMatchLimit] = (__bridge id)kSecMatchLimitOne;
+
+    CFTypeRef result = nullptr;
+    OSStatus status =
+        SecItemCopyMatching((__bridge CFDictionaryRef)query, &result);
+    if (status != errSecSuccess) {
+      if (status != errSecItemNotFound) {
+        LOG_DEBUG("Failed to load TLS session from the keychain: %s", status);
+      }
+      return grpc_empty_slice();
+    }
+
+    NSData* data = (__bridge_transfer NSData*)result;
+    return grpc_slice_from_copied_buffer(static_cast<const char*>(data.bytes),
+                                         data.length);
+  }
+}
+
+void StoreSession(void*, const char* key, grpc_slice session) {
+  @autoreleasepool {
+    NSData* data = [NSData dataWithBytes:GRPC_SLICE_START_PTR(session)
+                                  length:GRPC_SLICE_LENGTH(session)];
+    NSMutableDictionary* query = ItemQuery(key);
+    NSDictionary* update = @{(__bridge id)kSecValueData : data};
+
+    OSStatus status = SecItemUpdate((__bridge CFDictionaryRef)query,
+                                    (__bridge CFDictionaryRef)update);
+    if (status == errSecItemNotFound) {
+      query[(__bridge id)kSecValueData] = data;
+      query[(__bridge id)kSecAttrAccessible] =
+          (__bridge id)kSecAttrAccessibleAfterFirstUnlockThisDeviceOnly;
+      status = SecItemAdd((__bridge CFDictionaryRef)query, nullptr);
+    }
+    if (status != errSecSuccess) {
+      LOG_DEBUG("Failed to store TLS session in the keychain: %s", status);
+    }
+  }
+}
+
+}  // namespace
+
+grpc_ssl_session_store CreateKeychainSslSessionStore() {
+  grpc_ssl_session_store store;
+  store.load = LoadSession;
+  store.store = StoreSession;
+  store.destroy = nullptr;
+  store.user_data = nullptr;
+  return store;
+}
+
+}  // namespace remote
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // defined(__APPLE__)
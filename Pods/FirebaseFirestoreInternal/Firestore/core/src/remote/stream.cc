@@ -51,6 +51,14 @@ using AuthCredentialsProvider = CredentialsProvider<AuthToken, User>;
 const double kBackoffFactor = 1.5;
 const AsyncQueue::Milliseconds kBackoffInitialDelay{std::chrono::seconds(1)};
 const AsyncQueue::Milliseconds kBackoffMaxDelay{std::chrono::seconds(60)};
+/**
+ * The maximum backoff after network errors. Attempts to reach the backend
+ * while the network is down are cheap, and a short delay lets the stream
+ * reconnect soon after the network comes back even if the connectivity
+ * monitor doesn't notice.
+ */
+const AsyncQueue::Milliseconds kNetworkBackoffMaxDelay{
+    std::chrono::seconds(10)};
 /** The time a stream stays open after it is marked idle. */
 const AsyncQueue::Milliseconds kIdleTimeout{std::chrono::seconds(60)};
 /** The time a stream stays open until we consider it healthy. */
@@ -69,6 +77,8 @@ Stream::Stream(const std::shared_ptr<AsyncQueue>& worker_queue,
                TimerId health_check_timer_id)
     : backoff_{worker_queue, backoff_timer_id, kBackoffFactor,
                kBackoffInitialDelay, kBackoffMaxDelay},
+      network_backoff_{worker_queue, backoff_timer_id, kBackoffFactor,
+                       kBackoffInitialDelay, kNetworkBackoffMaxDelay},
       app_check_credentials_provider_{
           std::move(app_check_credentials_provider)},
       auth_credentials_provider_{std::move(auth_credentials_provider)},
@@ -208,7 +218,7 @@ void Stream::BackoffAndTryRestarting() {
               "Should only perform backoff in an error case");
 
   state_ = State::Backoff;
-  backoff_.BackoffAndRun([this] {
+  BackoffFor(last_error_class_).BackoffAndRun([this] {
     HARD_ASSERT(state_ == State::Backoff,
                 "Backoff elapsed but state is now: %s", state_);
 
@@ -226,7 +236,16 @@ void Stream::InhibitBackoff() {
 
   // Clear the error condition.
   state_ = State::Initial;
+  ResetBackoff();
+}
+
+void Stream::ResetBackoff() {
   backoff_.Reset();
+  network_backoff_.Reset();
+}
+
+ExponentialBackoff& Stream::BackoffFor(ErrorClass error_class) {
+  return error_class == ErrorClass::kNetwork ? network_backoff_ : backoff_;
 }
 
 // Idleness
@@ -297,6 +316,7 @@ void Stream::Close(const Status& status) {
   // execute).
   CancelIdleCheck();
   backoff_.Cancel();
+  network_backoff_.Cancel();
   health_check_.Cancel();
 
   // Step 3 (both): increment close count, which invalidates long-lived
@@ -309,7 +329,7 @@ void Stream::Close(const Status& status) {
   if (graceful_stop) {
     // If this is an intentional close, ensure we don't delay our next
     // connection attempt.
-    backoff_.Reset();
+    ResetBackoff();
   } else {
     HandleErrorStatus(status);
   }
@@ -332,11 +352,26 @@ void Stream::Close(const Status& status) {
 }
 
 void Stream::HandleErrorStatus(const Status& status) {
+  last_error_class_ = status.code() == Error::kErrorUnavailable
+                          ? ErrorClass::kNetwork
+                          : ErrorClass::kServer;
+  ExponentialBackoff& backoff = BackoffFor(last_error_class_);
+
+  absl::optional<AsyncQueue::Milliseconds> retry_delay =
+      grpc_stream_ ? grpc_stream_->retry_delay() : absl::nullopt;
+  if (retry_delay) {
+    LOG_DEBUG("%s Server asked to retry after %s ms", GetDebugDescription(),
+              retry_delay->count());
+    backoff.SetMinimumDelay(*retry_delay);
+  }
+
   if (status.code() == Error::kErrorResourceExhausted) {
-    LOG_DEBUG(
-        "%s Using maximum backoff delay to prevent overloading the backend.",
-        GetDebugDescription());
-    backoff_.ResetToMax();
+    if (!retry_delay) {
+      LOG_DEBUG(
+          "%s Using maximum backoff delay to prevent overloading the backend.",
+          GetDebugDescription());
+      backoff.ResetToMax();
+    }
   } else if (status.code() == Error::kErrorUnauthenticated &&
              state_ != State::Healthy) {
     // "unauthenticated" error means the token was rejected. This should rarely
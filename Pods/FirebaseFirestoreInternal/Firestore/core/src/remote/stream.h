@@ -209,9 +209,28 @@ class Stream : public GrpcStreamObserver,
   void Write(grpc::ByteBuffer&& message);
   std::string GetDebugDescription() const;
 
-  ExponentialBackoff backoff_;
+  /** Resets the backoff delays of all kinds of errors. */
+  void ResetBackoff();
 
  private:
+  /**
+   * Kinds of errors whose backoff delays grow independently, so that, for
+   * example, a server asking clients to slow down doesn't hold back
+   * reconnecting after the network comes back.
+   */
+  enum class ErrorClass {
+    /** The backend couldn't be reached or dropped the connection. */
+    kNetwork,
+    /** All other errors, typically returned by the backend. */
+    kServer,
+  };
+
+  ExponentialBackoff& BackoffFor(ErrorClass error_class);
+
+  ExponentialBackoff backoff_;
+  ExponentialBackoff network_backoff_;
+  ErrorClass last_error_class_ = ErrorClass::kServer;
+
   struct CallCredentials {
     mutable std::mutex mutex;
     std::string app_check;
@@ -25,6 +25,7 @@
 #include "Firestore/core/src/util/hard_assert.h"
 #include "Firestore/core/src/util/log.h"
 #include "Firestore/core/src/util/status.h"
+#include "Firestore/core/src/util/trace.h"
 
 namespace firebase {
 namespace firestore {
@@ -62,6 +63,7 @@ WatchStream::WatchStream(
 void WatchStream::WatchQuery(const TargetData& query) {
   EnsureOnQueue();
 
+  util::TraceSpan span(util::OperationTrace::Stage::kSerializer);
   auto request = watch_serializer_.EncodeWatchRequest(query);
   LOG_DEBUG("%s watch: %s", GetDebugDescription(), request.ToString());
   Write(MakeByteBuffer(request));
@@ -102,7 +104,7 @@ Status WatchStream::NotifyStreamResponse(const grpc::ByteBuffer& message) {
   LOG_DEBUG("%s response: %s", GetDebugDescription(), response.ToString());
 
   // A successful response means the stream is healthy.
-  backoff_.Reset();
+  ResetBackoff();
 
   auto watch_change = watch_serializer_.DecodeWatchChange(&reader, *response);
   auto version = watch_serializer_.DecodeSnapshotVersion(&reader, *response);
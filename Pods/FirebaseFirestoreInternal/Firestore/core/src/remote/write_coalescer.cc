@@ -0,0 +1,231 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/remote/write_coalescer.h"
+
+#include <set>
+#include <utility>
+
+#include "Firestore/core/src/model/delete_mutation.h"
+#include "Firestore/core/src/model/field_mask.h"
+#include "Firestore/core/src/model/field_path.h"
+#include "Firestore/core/src/model/object_value.h"
+#include "Firestore/core/src/model/patch_mutation.h"
+#include "Firestore/core/src/model/precondition.h"
+#include "Firestore/core/src/model/set_mutation.h"
+#include "Firestore/core/src/model/value_util.h"
+#include "Firestore/core/src/nanopb/message.h"
+#include "Firestore/core/src/util/hard_assert.h"
+#include "absl/types/optional.h"
+
+namespace firebase {
+namespace firestore {
+namespace remote {
+
+namespace {
+
+using model::DeleteMutation;
+using model::DocumentKey;
+using model::FieldMask;
+using model::FieldPath;
+using model::Mutation;
+using model::MutationBatch;
+using model::MutationResult;
+using model::ObjectValue;
+using model::PatchMutation;
+using model::Precondition;
+using model::SetMutation;
+using model::SnapshotVersion;
+using model::TransformMap;
+using nanopb::Message;
+
+/**
+ * Returns true if `mutation` is of a kind that squashes with the other
+ * mutations of its document: a set, update, merge or delete as written
+ * through the API, without field transforms.
+ */
+bool CanSquash(const Mutation& mutation) {
+  if (!mutation.field_transforms().empty()) {
+    return false;
+  }
+
+  const Precondition& precondition = mutation.precondition();
+  switch (mutation.type()) {
+    case Mutation::Type::Set:
+    case Mutation::Type::Delete:
+      return precondition.is_none();
+    case Mutation::Type::Patch:
+      return precondition.is_none() ||
+             precondition == Precondition::Exists(true);
+    default:
+      return false;
+  }
+}
+
+/** Returns true if a path of `lhs` is a proper prefix of one of `rhs`. */
+bool Overlaps(const FieldMask& lhs, const FieldMask& rhs) {
+  for (const FieldPath& left : lhs) {
+    for (const FieldPath& right : rhs) {
+      if (left != right &&
+          (left.IsPrefixOf(right) || right.IsPrefixOf(left))) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/** Applies the fields of `patch` to `value`, as it does to a document. */
+void ApplyPatch(const PatchMutation& patch, ObjectValue& value) {
+  TransformMap fields;
+  for (const FieldPath& path : patch.field_mask().value()) {
+    if (path.empty()) continue;
+
+    absl::optional<google_firestore_v1_Value> field = patch.value().Get(path);
+    if (field) {
+      fields[path] = model::DeepClone(*field);
+    } else {
+      fields[path] = absl::nullopt;
+    }
+  }
+  value.SetAll(std::move(fields));
+}
+
+/**
+ * Returns the mutation that has the effect of `first` followed by `second`,
+ * mutations of the same document, or nothing if there is none that is safe
+ * to send instead.
+ */
+absl::optional<Mutation> Squash(const Mutation& first, const Mutation& second) {
+  const DocumentKey& key = first.key();
+  const Precondition& precondition = first.precondition();
+
+  switch (second.type()) {
+    case Mutation::Type::Set:
+      return SetMutation(key, SetMutation(second).value(), precondition);
+
+    case Mutation::Type::Delete:
+      return DeleteMutation(key, precondition);
+
+    case Mutation::Type::Patch: {
+      PatchMutation patch(second);
+      if (first.type() == Mutation::Type::Set) {
+        ObjectValue value = SetMutation(first).value();
+        ApplyPatch(patch, value);
+        return SetMutation(key, std::move(value), precondition);
+      }
+
+      // After a delete, an update fails on the backend while a merge creates
+      // the document; either is left to the backend to apply on its own.
+      if (first.type() != Mutation::Type::Patch) {
+        return absl::nullopt;
+      }
+
+      PatchMutation previous(first);
+      const FieldMask& previous_mask = previous.field_mask().value();
+      const FieldMask& mask = patch.field_mask().value();
+      if (Overlaps(previous_mask, mask)) {
+        return absl::nullopt;
+      }
+
+      ObjectValue value = previous.value();
+      ApplyPatch(patch, value);
+      std::set<FieldPath> fields(previous_mask.begin(), previous_mask.end());
+      fields.insert(mask.begin(), mask.end());
+      return PatchMutation(key, std::move(value), FieldMask(std::move(fields)),
+                           precondition);
+    }
+
+    default:
+      return absl::nullopt;
+  }
+}
+
+}  // namespace
+
+constexpr size_t WriteCoalescer::kMaxMutations;
+
+bool WriteCoalescer::Add(const MutationBatch& batch) {
+  std::vector<Mutation> mutations = mutations_;
+  auto mutation_index_by_key = mutation_index_by_key_;
+
+  for (const Mutation& mutation : batch.mutations()) {
+    if (!CanSquash(mutation)) {
+      return false;
+    }
+
+    auto found = mutation_index_by_key.find(mutation.key());
+    if (found == mutation_index_by_key.end()) {
+      mutation_index_by_key.emplace(mutation.key(), mutations.size());
+      mutations.push_back(mutation);
+      continue;
+    }
+
+    absl::optional<Mutation> squashed =
+        Squash(mutations[found->second], mutation);
+    if (!squashed) {
+      return false;
+    }
+    mutations[found->second] = std::move(squashed).value();
+  }
+
+  if (!batches_.empty() && mutations.size() > kMaxMutations) {
+    return false;
+  }
+
+  batches_.push_back(batch);
+  mutations_ = std::move(mutations);
+  mutation_index_by_key_ = std::move(mutation_index_by_key);
+  return true;
+}
+
+MutationBatch WriteCoalescer::ToWrite() const {
+  HARD_ASSERT(!batches_.empty(), "Coalesced write without batches");
+  return MutationBatch(batches_.back().batch_id(),
+                       batches_.front().local_write_time(), {}, mutations_);
+}
+
+std::vector<MutationResult> WriteCoalescer::SplitResults(
+    const MutationBatch& batch,
+    const MutationBatch& write,
+    const std::vector<MutationResult>& write_results) {
+  HARD_ASSERT(write.mutations().size() == write_results.size(),
+              "Coalesced write has %s mutations but %s results",
+              write.mutations().size(), write_results.size());
+
+  std::unordered_map<DocumentKey, SnapshotVersion, model::DocumentKeyHash>
+      versions;
+  for (size_t i = 0; i < write_results.size(); ++i) {
+    versions.emplace(write.mutations()[i].key(), write_results[i].version());
+  }
+
+  std::vector<MutationResult> results;
+  for (const Mutation& mutation : batch.mutations()) {
+    auto found = versions.find(mutation.key());
+    HARD_ASSERT(found != versions.end(),
+                "Coalesced write has no result for %s",
+                mutation.key().ToString());
+    // None of the mutations has field transforms, so there are no results
+    // of transforms to hand on.
+    results.emplace_back(found->second,
+                         Message<google_firestore_v1_ArrayValue>{});
+  }
+  return results;
+}
+
+}  // namespace remote
+}  // namespace firestore
+}  // namespace firebase
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_REMOTE_WRITE_COALESCER_H_
+#define FIRESTORE_CORE_SRC_REMOTE_WRITE_COALESCER_H_
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "Firestore/core/src/model/document_key.h"
+#include "Firestore/core/src/model/mutation.h"
+#include "Firestore/core/src/model/mutation_batch.h"
+
+namespace firebase {
+namespace firestore {
+namespace remote {
+
+/**
+ * Squashes consecutive mutation batches into a single write with one mutation
+ * per document, which `RemoteStore` uploads in place of the batches.
+ *
+ * Batches are only coalesced where the write has the same effect as the
+ * batches applied in order: none of them has field transforms, whose results
+ * depend on what they are applied to, and the mutations of each document
+ * squash into one that keeps the precondition of the first. Writing the
+ * batches as one is atomic, though, so a coalesced write that is rejected has
+ * to be retried batch by batch to tell which of them the backend rejects.
+ */
+class WriteCoalescer {
+ public:
+  /** The most mutations that a coalesced write holds. */
+  static constexpr size_t kMaxMutations = 500;
+
+  /**
+   * Adds `batch` to the write and returns true if it can be coalesced with
+   * the batches added so far. Otherwise returns false and leaves the write
+   * unchanged.
+   */
+  bool Add(const model::MutationBatch& batch);
+
+  /** The batches added to the write, in order. */
+  const std::vector<model::MutationBatch>& batches() const {
+    return batches_;
+  }
+
+  /**
+   * Returns the coalesced write as a batch with the ID of the last batch
+   * added, so that the batches after it are the next to send.
+   */
+  model::MutationBatch ToWrite() const;
+
+  /**
+   * Returns the results of the mutations of `batch`, one of the batches
+   * coalesced into `write`, given the results of the mutations of `write`.
+   * Each mutation of a document gets the version that the write committed the
+   * document at.
+   */
+  static std::vector<model::MutationResult> SplitResults(
+      const model::MutationBatch& batch,
+      const model::MutationBatch& write,
+      const std::vector<model::MutationResult>& write_results);
+
+ private:
+  std::vector<model::MutationBatch> batches_;
+
+  /** The squashed mutations, in the order their documents were written. */
+  std::vector<model::Mutation> mutations_;
+  std::unordered_map<model::DocumentKey, size_t, model::DocumentKeyHash>
+      mutation_index_by_key_;
+};
+
+}  // namespace remote
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_REMOTE_WRITE_COALESCER_H_
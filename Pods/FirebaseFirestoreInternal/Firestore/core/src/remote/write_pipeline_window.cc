@@ -0,0 +1,56 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "Firestore/core/src/remote/write_pipeline_window.h"
+
+#include <algorithm>
+
+namespace firebase {
+namespace firestore {
+namespace remote {
+
+constexpr size_t WritePipelineWindow::kMinWritePipelineSize;
+constexpr size_t WritePipelineWindow::kMaxWritePipelineSize;
+
+void WritePipelineWindow::OnWriteSent() {
+  send_times_.push_back(Clock::now());
+}
+
+void WritePipelineWindow::OnWriteAcknowledged(bool pipeline_full) {
+  ++acks_since_shrink_;
+
+  // The batch was sent on a stream that has since been reopened, so there is
+  // nothing to learn from it.
+  if (send_times_.empty()) return;
+
+  Clock::duration latency = Clock::now() - send_times_.front();
+  send_times_.pop_front();
+  min_latency_ = std::min(min_latency_, latency);
+
+  if (latency > 2 * min_latency_) {
+    if (acks_since_shrink_ >= size_) {
+      size_ = std::max(kMinWritePipelineSize, size_ / 2);
+      acks_since_shrink_ = 0;
+    }
+  } else if (pipeline_full) {
+    size_ = std::min(kMaxWritePipelineSize, size_ + 1);
+  }
+}
+
+}  // namespace remote
+}  // namespace firestore
+}  // namespace firebase
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef FIRESTORE_CORE_SRC_REMOTE_WRITE_PIPELINE_WINDOW_H_
+#define FIRESTORE_CORE_SRC_REMOTE_WRITE_PIPELINE_WINDOW_H_
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstddef>
+#include <deque>
+
+namespace firebase {
+namespace firestore {
+namespace remote {
+
+/**
+ * Decides how many mutation batches `RemoteStore` keeps in flight on the
+ * write stream.
+ *
+ * On a high-latency link a fixed number of batches per round trip drains a
+ * backlog of offline writes slowly, while sending everything at once only
+ * queues the writes up on the backend. The window starts at
+ * `kMinWritePipelineSize` and grows by one with every acknowledgement that
+ * arrives while it is full, as long as the acknowledgements come back about
+ * as fast as the fastest one seen. Once they take more than twice as long,
+ * which means writes are queueing up, the window is halved, at most once
+ * per window's worth of acknowledgements.
+ */
+class WritePipelineWindow {
+ public:
+  /** The size of the window before anything is known about the link. */
+  static constexpr size_t kMinWritePipelineSize = 10;
+
+  /** The largest the window ever grows. */
+  static constexpr size_t kMaxWritePipelineSize = 100;
+
+  /** The number of batches that may be in flight. */
+  size_t size() const {
+    return size_;
+  }
+
+  /** Records that a batch has been sent on the write stream. */
+  void OnWriteSent();
+
+  /**
+   * Records that the oldest batch in flight has been acknowledged and adapts
+   * the window to how long that took.
+   *
+   * @param pipeline_full Whether the pipeline had as many batches as the
+   *     window allowed when the acknowledgement arrived.
+   */
+  void OnWriteAcknowledged(bool pipeline_full);
+
+  /**
+   * Forgets the batches in flight, as when the write stream closes and they
+   * are sent again once it is reopened.
+   */
+  void OnWritesInterrupted() {
+    send_times_.clear();
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  size_t size_ = kMinWritePipelineSize;
+
+  /** When each batch still in flight was sent, oldest first. */
+  std::deque<Clock::time_point> send_times_;
+
+  /** The shortest time a batch took to be acknowledged. */
+  Clock::duration min_latency_ = Clock::duration::max();
+
+  /** Acknowledgements received since the window last shrank. */
+  size_t acks_since_shrink_ = 0;
+};
+
+}  // namespace remote
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_REMOTE_WRITE_PIPELINE_WINDOW_H_
@@ -148,7 +148,7 @@ Status WriteStream::NotifyStreamResponse(const grpc::ByteBuffer& message) {
     // A successful first write response means the stream is healthy.
     // Note that we could consider a successful handshake healthy, however, the
     // write itself might be causing an error we want to back off from.
-    backoff_.Reset();
+    ResetBackoff();
 
     auto version = write_serializer_.DecodeCommitVersion(&reader, *response);
     auto results = write_serializer_.DecodeMutationResults(&reader, *response);
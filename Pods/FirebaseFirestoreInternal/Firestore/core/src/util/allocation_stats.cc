@@ -0,0 +1,171 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/util/allocation_stats.h"
+
+#include <atomic>
+#include <cstdlib>
+
+#include "Firestore/core/src/util/string_format.h"
+
+#if defined(PB_ALLOCATION_HOOKS)
+#include <pb.h>
+
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#elif defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#endif  // defined(PB_ALLOCATION_HOOKS)
+
+namespace firebase {
+namespace firestore {
+namespace util {
+
+#if defined(FIRESTORE_ALLOCATION_STATS)
+
+namespace {
+
+struct SubsystemCounters {
+  std::atomic<int64_t> live_bytes{0};
+  std::atomic<int64_t> peak_bytes{0};
+  std::atomic<int64_t> live_allocations{0};
+  std::atomic<int64_t> total_allocations{0};
+};
+
+// Trivially destructible, so that frees during static destruction are safe.
+SubsystemCounters counters[kAllocationSubsystemCount];
+
+}  // namespace
+
+namespace internal {
+
+void RecordAllocation(AllocationSubsystem subsystem,
+                      int64_t bytes,
+                      int64_t count) {
+  SubsystemCounters& c = counters[static_cast<int>(subsystem)];
+  int64_t live =
+      c.live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  c.live_allocations.fetch_add(count, std::memory_order_relaxed);
+  if (count <= 0) return;
+
+  c.total_allocations.fetch_add(count, std::memory_order_relaxed);
+  int64_t peak = c.peak_bytes.load(std::memory_order_relaxed);
+  while (live > peak && !c.peak_bytes.compare_exchange_weak(
+                            peak, live, std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace internal
+
+bool AllocationStatsAvailable() {
+  return true;
+}
+
+AllocationCounters GetAllocationCounters(AllocationSubsystem subsystem) {
+  const SubsystemCounters& c = counters[static_cast<int>(subsystem)];
+  AllocationCounters result;
+  result.live_bytes = c.live_bytes.load(std::memory_order_relaxed);
+  result.peak_bytes = c.peak_bytes.load(std::memory_order_relaxed);
+  result.live_allocations = c.live_allocations.load(std::memory_order_relaxed);
+  result.total_allocations =
+      c.total_allocations.load(std::memory_order_relaxed);
+  return result;
+}
+
+#else  // !defined(FIRESTORE_ALLOCATION_STATS)
+
+bool AllocationStatsAvailable() {
+  return false;
+}
+
+AllocationCounters GetAllocationCounters(AllocationSubsystem) {
+  return AllocationCounters();
+}
+
+#endif  // defined(FIRESTORE_ALLOCATION_STATS)
+
+std::string AllocationStatsReport() {
+  if (!AllocationStatsAvailable()) {
+    return "allocation stats are not compiled in; build with "
+           "-DFIRESTORE_ALLOCATION_STATS\n";
+  }
+
+  static const char* const kNames[kAllocationSubsystemCount] = {"nanopb",
+                                                                "sorted_map"};
+  std::string result;
+  for (int i = 0; i < kAllocationSubsystemCount; ++i) {
+    AllocationCounters c =
+        GetAllocationCounters(static_cast<AllocationSubsystem>(i));
+    result += StringFormat(
+        "%s: live_bytes=%s peak_bytes=%s live_allocations=%s "
+        "total_allocations=%s\n",
+        kNames[i], c.live_bytes, c.peak_bytes, c.live_allocations,
+        c.total_allocations);
+  }
+  return result;
+}
+
+}  // namespace util
+}  // namespace firestore
+}  // namespace firebase
+
+#if defined(PB_ALLOCATION_HOOKS)
+
+namespace {
+
+using firebase::firestore::util::AllocationSubsystem;
+using firebase::firestore::util::RecordAllocation;
+using firebase::firestore::util::RecordFree;
+
+// The size of the allocation at `ptr`, which the hooks can not otherwise know
+// when it is freed. Where the allocator can not tell, only the number of
+// allocations is counted.
+size_t AllocatedSize(void* ptr) {
+#if defined(__APPLE__)
+  return malloc_size(ptr);
+#elif defined(__GLIBC__)
+  return malloc_usable_size(ptr);
+#else
+  (void)ptr;
+  return 0;
+#endif
+}
+
+}  // namespace
+
+void* pb_hooked_realloc(void* ptr, size_t size) {
+  if (ptr) {
+    RecordFree(AllocationSubsystem::kNanopb, AllocatedSize(ptr));
+  }
+  void* result = std::realloc(ptr, size);
+  if (result) {
+    RecordAllocation(AllocationSubsystem::kNanopb, AllocatedSize(result));
+  } else if (ptr) {
+    // A failed realloc leaves the original allocation in place.
+    RecordAllocation(AllocationSubsystem::kNanopb, AllocatedSize(ptr));
+  }
+  return result;
+}
+
+void pb_hooked_free(void* ptr) {
+  if (ptr) {
+    RecordFree(AllocationSubsystem::kNanopb, AllocatedSize(ptr));
+  }
+  std::free(ptr);
+}
+
+#endif  // defined(PB_ALLOCATION_HOOKS)
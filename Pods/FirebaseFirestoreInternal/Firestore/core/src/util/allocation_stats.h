@@ -0,0 +1,156 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_UTIL_ALLOCATION_STATS_H_
+#define FIRESTORE_CORE_SRC_UTIL_ALLOCATION_STATS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace firebase {
+namespace firestore {
+namespace util {
+
+/**
+ * Process wide accounting of the memory held by Firestore, by subsystem, to
+ * show where arena and pooling work would pay off.
+ *
+ * The accounting is compiled out unless Firestore is built with
+ * `-DFIRESTORE_ALLOCATION_STATS`, in which case the recording functions are
+ * empty and the counters stay at zero. Counting nanopb allocations also
+ * requires building both nanopb and Firestore with `-DPB_ALLOCATION_HOOKS`.
+ */
+enum class AllocationSubsystem {
+  // Decoded and encoded protos, and the byte strings they hold.
+  kNanopb,
+  // Nodes of the immutable maps and sets backing documents and views.
+  kSortedMap,
+};
+constexpr int kAllocationSubsystemCount = 2;
+
+struct AllocationCounters {
+  // Bytes held now, and the most held at any time since the process started.
+  int64_t live_bytes = 0;
+  int64_t peak_bytes = 0;
+  // Number of allocations held now, and made in total.
+  int64_t live_allocations = 0;
+  int64_t total_allocations = 0;
+};
+
+#if defined(FIRESTORE_ALLOCATION_STATS)
+
+namespace internal {
+void RecordAllocation(AllocationSubsystem subsystem,
+                      int64_t bytes,
+                      int64_t count);
+}  // namespace internal
+
+inline void RecordAllocation(AllocationSubsystem subsystem, size_t bytes) {
+  internal::RecordAllocation(subsystem, static_cast<int64_t>(bytes), 1);
+}
+
+inline void RecordFree(AllocationSubsystem subsystem, size_t bytes) {
+  internal::RecordAllocation(subsystem, -static_cast<int64_t>(bytes), -1);
+}
+
+#else  // !defined(FIRESTORE_ALLOCATION_STATS)
+
+inline void RecordAllocation(AllocationSubsystem, size_t) {
+}
+
+inline void RecordFree(AllocationSubsystem, size_t) {
+}
+
+#endif  // defined(FIRESTORE_ALLOCATION_STATS)
+
+/** Returns true if the accounting is compiled in. */
+bool AllocationStatsAvailable();
+
+AllocationCounters GetAllocationCounters(AllocationSubsystem subsystem);
+
+/** Formats the counters of every subsystem, one per line. */
+std::string AllocationStatsReport();
+
+/**
+ * A `std::allocator` that records what it allocates in the given subsystem,
+ * for use with `std::allocate_shared`.
+ */
+template <typename T>
+class CountingAllocator {
+ public:
+  using value_type = T;
+
+  explicit CountingAllocator(AllocationSubsystem subsystem)
+      : subsystem_(subsystem) {
+  }
+
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U>& other)  // NOLINT
+      : subsystem_(other.subsystem()) {
+  }
+
+  T* allocate(size_t n) {
+    RecordAllocation(subsystem_, n * sizeof(T));
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* ptr, size_t n) {
+    RecordFree(subsystem_, n * sizeof(T));
+    std::allocator<T>().deallocate(ptr, n);
+  }
+
+  AllocationSubsystem subsystem() const {
+    return subsystem_;
+  }
+
+  template <typename U>
+  bool operator==(const CountingAllocator<U>& other) const {
+    return subsystem_ == other.subsystem();
+  }
+
+  template <typename U>
+  bool operator!=(const CountingAllocator<U>& other) const {
+    return subsystem_ != other.subsystem();
+  }
+
+ private:
+  AllocationSubsystem subsystem_;
+};
+
+/**
+ * Like `std::make_shared`, but records the allocation, including the control
+ * block, in the given subsystem.
+ */
+template <typename T, typename... Args>
+std::shared_ptr<T> MakeSharedCounted(AllocationSubsystem subsystem,
+                                     Args&&... args) {
+#if defined(FIRESTORE_ALLOCATION_STATS)
+  return std::allocate_shared<T>(CountingAllocator<T>(subsystem),
+                                 std::forward<Args>(args)...);
+#else
+  (void)subsystem;
+  return std::make_shared<T>(std::forward<Args>(args)...);
+#endif  // defined(FIRESTORE_ALLOCATION_STATS)
+}
+
+}  // namespace util
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_UTIL_ALLOCATION_STATS_H_
@@ -16,10 +16,14 @@
 
 #include "Firestore/core/src/util/async_queue.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
 #include <utility>
 
 #include "Firestore/core/src/util/hard_assert.h"
+#include "Firestore/core/src/util/string_format.h"
 #include "Firestore/core/src/util/task.h"
+#include "Firestore/core/src/util/trace.h"
 #include "absl/algorithm/container.h"
 #include "absl/memory/memory.h"
 
@@ -99,7 +103,7 @@ bool AsyncQueue::EnqueueEvenWhileRestricted(const Operation& operation) {
   std::lock_guard<std::mutex> lock(mutex_);
   if (mode_ == Mode::kDisposed) return false;
 
-  executor_->Execute(Wrap(operation));
+  executor_->Execute(WrapImmediate(operation));
   return true;
 }
 
@@ -112,10 +116,15 @@ bool AsyncQueue::EnqueueRelaxed(const Operation& operation) {
   std::lock_guard<std::mutex> lock(mutex_);
   if (mode_ != Mode::kRunning) return false;
 
-  executor_->Execute(Wrap(operation));
+  executor_->Execute(WrapImmediate(operation));
   return true;
 }
 
+AsyncQueue::QueueWaitStats AsyncQueue::queue_wait_stats() const {
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  return queue_wait_stats_;
+}
+
 DelayedOperation AsyncQueue::EnqueueAfterDelay(Milliseconds delay,
                                                const TimerId timer_id,
                                                const Operation& operation) {
@@ -132,7 +141,8 @@ DelayedOperation AsyncQueue::EnqueueAfterDelay(Milliseconds delay,
   }
 
   auto tag = static_cast<Executor::Tag>(timer_id);
-  return executor_->Schedule(delay, tag, Wrap(operation));
+  return executor_->Schedule(delay, tag,
+                             WrapDelayed(operation, timer_id, delay));
 }
 
 AsyncQueue::Operation AsyncQueue::Wrap(const Operation& operation) {
@@ -144,6 +154,92 @@ AsyncQueue::Operation AsyncQueue::Wrap(const Operation& operation) {
   return [this, operation] { this->ExecuteBlocking(operation); };
 }
 
+AsyncQueue::Operation AsyncQueue::WrapImmediate(const Operation& operation) {
+  int depth = pending_operations_++;
+  if (instrumentation_enabled_) {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    instrumentation_stats_.queue_depth.Add(depth);
+  }
+
+  // The operation continues the trace of the one that enqueued it. Delayed
+  // operations are timers and retries, so they don't.
+  std::shared_ptr<OperationTrace> trace = OperationTrace::Current();
+  auto enqueued = std::chrono::steady_clock::now();
+  return [this, operation, enqueued, trace] {
+    --pending_operations_;
+    auto wait = std::chrono::steady_clock::now() - enqueued;
+    if (trace) {
+      trace->Add(OperationTrace::Stage::kQueue, wait);
+    }
+    TraceScope scope(trace);
+    {
+      auto wait_ms = std::chrono::duration_cast<Milliseconds>(wait);
+      std::lock_guard<std::mutex> lock(stats_mutex_);
+      ++queue_wait_stats_.operations;
+      queue_wait_stats_.total_wait += wait_ms;
+      queue_wait_stats_.max_wait =
+          std::max(queue_wait_stats_.max_wait, wait_ms);
+    }
+    this->ExecuteInstrumented(operation, wait, absl::nullopt);
+  };
+}
+
+AsyncQueue::Operation AsyncQueue::WrapDelayed(const Operation& operation,
+                                              TimerId timer_id,
+                                              Milliseconds delay) {
+  auto due = std::chrono::steady_clock::now() + delay;
+  return [this, operation, timer_id, due] {
+    auto wait = std::chrono::steady_clock::now() - due;
+    this->ExecuteInstrumented(operation, wait, timer_id);
+  };
+}
+
+void AsyncQueue::ExecuteInstrumented(const Operation& operation,
+                                     std::chrono::steady_clock::duration wait,
+                                     absl::optional<TimerId> timer_id) {
+  if (!instrumentation_enabled_) {
+    ExecuteBlocking(operation);
+    return;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  ExecuteBlocking(operation);
+  auto run = std::chrono::steady_clock::now() - start;
+
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  OperationStats& stats = timer_id
+                              ? instrumentation_stats_.delayed[*timer_id]
+                              : instrumentation_stats_.immediate;
+  stats.wait_micros.Add(duration_cast<microseconds>(wait).count());
+  stats.run_micros.Add(duration_cast<microseconds>(run).count());
+}
+
+void AsyncQueue::SetInstrumentationEnabled(bool enabled) {
+  instrumentation_enabled_ = enabled;
+}
+
+AsyncQueue::InstrumentationStats AsyncQueue::instrumentation_stats() const {
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  return instrumentation_stats_;
+}
+
+std::string AsyncQueue::InstrumentationStats::ToString() const {
+  std::string result = StringFormat(
+      "queue depth: %s\nimmediate wait us: %s\nimmediate run us: %s\n",
+      queue_depth.ToString(), immediate.wait_micros.ToString(),
+      immediate.run_micros.ToString());
+  for (const auto& entry : delayed) {
+    result += StringFormat("timer %s wait us: %s\ntimer %s run us: %s\n",
+                           static_cast<int>(entry.first),
+                           entry.second.wait_micros.ToString(),
+                           static_cast<int>(entry.first),
+                           entry.second.run_micros.ToString());
+  }
+  return result;
+}
+
 void AsyncQueue::VerifySequentialOrder() const {
   // This is the inverse of `VerifyIsCurrentQueue`.
   HARD_ASSERT(!is_operation_in_progress_ || !executor_->IsCurrentExecutor(),
@@ -20,11 +20,15 @@
 #include <atomic>
 #include <chrono>
 #include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <vector>
 
 #include "Firestore/core/src/util/executor.h"
+#include "Firestore/core/src/util/histogram.h"
+#include "absl/types/optional.h"
 
 namespace firebase {
 namespace firestore {
@@ -73,7 +77,19 @@ enum class TimerId {
   /**
    * A timer used to periodically attempt Index Backfill
    */
-  IndexBackfillDelay
+  IndexBackfillDelay,
+
+  /**
+   * A timer used to run the schema migrations that are deferred until after
+   * startup, one slice at a time.
+   */
+  DeferredMigrationDelay,
+
+  /**
+   * A timer used to raise the changes a listener with a minimum event interval
+   * has coalesced once the interval has passed.
+   */
+  ListenerEventCoalescingDelay
 };
 
 // A serial queue that executes given operations asynchronously, one at a time.
@@ -169,6 +185,51 @@ class AsyncQueue : public std::enable_shared_from_this<AsyncQueue> {
   // restricted or disposed).
   bool is_running() const;
 
+  // Returns true if operations enqueued for immediate execution are waiting
+  // for the current one to finish. Long-running background operations, such
+  // as garbage collection and index backfill, check this between units of
+  // work and yield to the waiting operations by rescheduling the rest.
+  bool HasPendingOperations() const {
+    return pending_operations_.load() > 0;
+  }
+
+  // How long operations enqueued for immediate execution have waited before
+  // they started to run, since the queue was created.
+  struct QueueWaitStats {
+    int64_t operations = 0;
+    Milliseconds total_wait{0};
+    Milliseconds max_wait{0};
+  };
+
+  QueueWaitStats queue_wait_stats() const;
+
+  // Histograms of the operations that have run since instrumentation was
+  // enabled. Times are in microseconds. The wait of a delayed operation is
+  // counted from the time it was due.
+  struct OperationStats {
+    Histogram wait_micros;
+    Histogram run_micros;
+  };
+
+  struct InstrumentationStats {
+    // Operations enqueued for immediate execution.
+    OperationStats immediate;
+    // Operations enqueued with `EnqueueAfterDelay`, by their `TimerId`.
+    std::map<TimerId, OperationStats> delayed;
+    // The number of immediate operations that were already waiting whenever
+    // another one was enqueued.
+    Histogram queue_depth;
+
+    std::string ToString() const;
+  };
+
+  // Debug API: starts or stops recording `instrumentation_stats()`. Recording
+  // costs two clock reads and a lock for every operation, so it is off by
+  // default. Enabling it again does not clear the histograms.
+  void SetInstrumentationEnabled(bool enabled);
+
+  InstrumentationStats instrumentation_stats() const;
+
   // Puts the `operation` on the queue to be executed `delay` milliseconds from
   // now, and returns a handle that allows to cancel the operation (provided it
   // hasn't run already).
@@ -233,6 +294,22 @@ class AsyncQueue : public std::enable_shared_from_this<AsyncQueue> {
 
   Operation Wrap(const Operation& operation);
 
+  // Like `Wrap`, but also counts the operation as pending until it starts and
+  // records how long it waited to start.
+  Operation WrapImmediate(const Operation& operation);
+
+  // Like `Wrap`, but records instrumentation for an operation scheduled with
+  // `EnqueueAfterDelay`.
+  Operation WrapDelayed(const Operation& operation,
+                        TimerId timer_id,
+                        Milliseconds delay);
+
+  // Runs `operation` with `ExecuteBlocking`, recording its wait and run time
+  // if instrumentation is enabled.
+  void ExecuteInstrumented(const Operation& operation,
+                           std::chrono::steady_clock::duration wait,
+                           absl::optional<TimerId> timer_id);
+
   // Asserts that the current invocation happens asynchronously on the queue.
   void VerifyIsCurrentExecutor() const;
   void VerifySequentialOrder() const;
@@ -244,6 +321,14 @@ class AsyncQueue : public std::enable_shared_from_this<AsyncQueue> {
   Mode mode_ = Mode::kRunning;
 
   std::vector<TimerId> timer_ids_to_skip_;
+
+  std::atomic<int> pending_operations_{0};
+
+  std::atomic<bool> instrumentation_enabled_{false};
+
+  mutable std::mutex stats_mutex_;
+  QueueWaitStats queue_wait_stats_;
+  InstrumentationStats instrumentation_stats_;
 };
 
 }  // namespace util
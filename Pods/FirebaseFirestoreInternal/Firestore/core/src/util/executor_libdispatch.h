@@ -45,9 +45,17 @@ namespace util {
 
 // A serial queue built on top of libdispatch. The operations are run on
 // a dedicated serial dispatch queue.
+//
+// By default, every operation is dispatched as a block of its own. If
+// `drain_in_batches` is true, operations instead wait in a lock-free queue
+// of the executor's own, and a single dispatched block runs them in order,
+// up to a limit on their number and on its running time before it yields
+// the dispatch queue. This is only valid for a serial dispatch queue that
+// nothing but the executor dispatches to.
 class ExecutorLibdispatch : public Executor {
  public:
-  explicit ExecutorLibdispatch(dispatch_queue_t dispatch_queue);
+  explicit ExecutorLibdispatch(dispatch_queue_t dispatch_queue,
+                               bool drain_in_batches = false);
   ~ExecutorLibdispatch() override;
 
   void Dispose() override;
@@ -74,6 +82,8 @@ class ExecutorLibdispatch : public Executor {
   using ScheduleMap = std::unordered_map<Id, Task*>;
   using ScheduleEntry = ScheduleMap::value_type;
 
+  class DrainQueue;
+
   void OnCompletion(Task* task) override;
   void Cancel(Id operation_id) override;
 
@@ -89,6 +99,10 @@ class ExecutorLibdispatch : public Executor {
 
   dispatch_queue_t dispatch_queue_;
 
+  // The queue of operations waiting for a drain, if draining in batches.
+  // Shared with the drain block in flight, which can outlive the executor.
+  std::shared_ptr<DrainQueue> drain_queue_;
+
   // A map of `Schedule`d tasks by their Id, allowing `Cancel` to be able to
   // find tasks quickly.
   ScheduleMap schedule_;
@@ -18,6 +18,8 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <thread>
 #include <vector>
 
 #include "Firestore/core/src/util/defer.h"
@@ -31,6 +33,11 @@ namespace firestore {
 namespace util {
 namespace {
 
+// The most operations that one drain block runs, and the longest that it
+// keeps running them, before it yields the dispatch queue to the system.
+constexpr int kMaxTasksPerDrain = 128;
+constexpr std::chrono::microseconds kDrainTimeSlice{2000};
+
 absl::string_view StringViewFromDispatchLabel(const char* const label) {
   // Make sure string_view's data is not null, because it's used for logging.
   return label ? absl::string_view{label} : absl::string_view{""};
@@ -50,10 +57,133 @@ absl::string_view GetCurrentQueueLabel() {
 
 }  // namespace
 
+// MARK: - DrainQueue
+
+/**
+ * The tasks of a draining executor that are waiting to run, as a lock-free
+ * multi-producer, single-consumer queue: any thread can push to it, and a
+ * drain block on the dispatch queue pops and runs them. A drain block is
+ * dispatched when a push finds the queue empty, and there is never more than
+ * one at a time.
+ *
+ * The queue holds a reference to each of its tasks, and each drain block
+ * holds a reference to the queue, so that tasks pushed before the executor
+ * was disposed are still released.
+ */
+class ExecutorLibdispatch::DrainQueue
+    : public std::enable_shared_from_this<DrainQueue> {
+ public:
+  explicit DrainQueue(const dispatch_queue_t dispatch_queue)
+      : dispatch_queue_{dispatch_queue} {
+  }
+
+  ~DrainQueue() {
+    // No drain block holds the queue any more, so it must be empty.
+    if (tail_ != &stub_) {
+      delete tail_;
+    }
+  }
+
+  /** Adds `task` to the queue, taking over one of its references. */
+  void Push(Task* task) {
+    auto* node = new Node{task};
+    Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+    if (size_.fetch_add(1, std::memory_order_acq_rel) == 0) {
+      Dispatch(new std::shared_ptr<DrainQueue>(shared_from_this()));
+    }
+  }
+
+  /** Pushes `task` to the queue at `time`. */
+  void PushAfter(dispatch_time_t time, Task* task) {
+    dispatch_after_f(time, dispatch_queue_,
+                     new DelayedPush{shared_from_this(), task},
+                     InvokeDelayedPush);
+  }
+
+ private:
+  struct Node {
+    Task* task = nullptr;
+    std::atomic<Node*> next{nullptr};
+  };
+
+  struct DelayedPush {
+    std::shared_ptr<DrainQueue> queue;
+    Task* task = nullptr;
+  };
+
+  static void InvokeDelayedPush(void* raw_push) {
+    std::unique_ptr<DelayedPush> push{static_cast<DelayedPush*>(raw_push)};
+    push->queue->Push(push->task);
+  }
+
+  void Dispatch(std::shared_ptr<DrainQueue>* self) {
+    dispatch_async_f(dispatch_queue_, self, InvokeDrain);
+  }
+
+  static void InvokeDrain(void* raw_self) {
+    auto* self = static_cast<std::shared_ptr<DrainQueue>*>(raw_self);
+    if ((*self)->Drain()) {
+      // Give the blocks queued behind this one their turn, then carry on.
+      (*self)->Dispatch(self);
+    } else {
+      delete self;
+    }
+  }
+
+  // Runs tasks until the queue is empty, then returns false, or until this
+  // drain has reached its limits with tasks left, then returns true.
+  bool Drain() {
+    const auto deadline = std::chrono::steady_clock::now() + kDrainTimeSlice;
+    for (int ran = 1;; ++ran) {
+      Pop()->ExecuteAndRelease();
+      if (size_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        return false;
+      }
+      if (ran == kMaxTasksPerDrain ||
+          std::chrono::steady_clock::now() >= deadline) {
+        return true;
+      }
+    }
+  }
+
+  // Only called with at least one task counted in `size_`, which is counted
+  // after it has been swapped into `head_`.
+  Task* Pop() {
+    Node* next = tail_->next.load(std::memory_order_acquire);
+    while (next == nullptr) {
+      // The push has swapped in its node but not yet linked it.
+      std::this_thread::yield();
+      next = tail_->next.load(std::memory_order_acquire);
+    }
+    // The node that was popped last is now done with, and `next` takes its
+    // place.
+    if (tail_ != &stub_) {
+      delete tail_;
+    }
+    tail_ = next;
+    return next->task;
+  }
+
+  dispatch_queue_t dispatch_queue_;
+
+  Node stub_;
+  // The most recently pushed node, where producers link new ones.
+  std::atomic<Node*> head_{&stub_};
+  // The most recently popped node, or the stub. Only used by the drain.
+  Node* tail_ = &stub_;
+
+  std::atomic<size_t> size_{0};
+};
+
 // MARK: - ExecutorLibdispatch
 
-ExecutorLibdispatch::ExecutorLibdispatch(const dispatch_queue_t dispatch_queue)
+ExecutorLibdispatch::ExecutorLibdispatch(const dispatch_queue_t dispatch_queue,
+                                         bool drain_in_batches)
     : dispatch_queue_{dispatch_queue} {
+  if (drain_in_batches) {
+    drain_queue_ = std::make_shared<DrainQueue>(dispatch_queue);
+  }
 }
 
 ExecutorLibdispatch::~ExecutorLibdispatch() {
@@ -111,6 +241,12 @@ void ExecutorLibdispatch::Execute(Operation&& operation) {
     tasks_.insert(task);
   }
 
+  if (drain_queue_) {
+    task->Retain();  // For the drain queue's ownership
+    drain_queue_->Push(task);
+    return;
+  }
+
   task->Retain();  // For libdispatch's ownership
   dispatch_async_f(dispatch_queue_, task, InvokeAsync);
 }
@@ -130,6 +266,18 @@ void ExecutorLibdispatch::ExecuteBlocking(Operation&& operation) {
     tasks_.insert(task);
   }
 
+  if (drain_queue_) {
+    // Going through the drain queue keeps the operation in order with those
+    // already waiting there. Await returns once the operation has run, or has
+    // been cancelled by `Dispose`.
+    task->Retain();  // For the drain queue's ownership
+    task->Retain();  // For this method's ownership
+    drain_queue_->Push(task);
+    task->Await();
+    task->Release();
+    return;
+  }
+
   task->Retain();  // For libdispatch's ownership
   dispatch_sync_f(dispatch_queue_, task, InvokeSync);
 }
@@ -162,6 +310,12 @@ DelayedOperation ExecutorLibdispatch::Schedule(Milliseconds delay,
     schedule_[id] = task;
   }
 
+  if (drain_queue_) {
+    task->Retain();  // For the drain queue's ownership
+    drain_queue_->PushAfter(delay_ns, task);
+    return DelayedOperation(this, id);
+  }
+
   task->Retain();  // For libdispatch's ownership
   dispatch_after_f(delay_ns, dispatch_queue_, task, InvokeAsync);
 
@@ -360,7 +514,10 @@ ExecutorLibdispatch::Id ExecutorLibdispatch::NextIdLocked() {
 
 std::unique_ptr<Executor> Executor::CreateSerial(const char* label) {
   dispatch_queue_t queue = dispatch_queue_create(label, DISPATCH_QUEUE_SERIAL);
-  return absl::make_unique<ExecutorLibdispatch>(queue);
+  // The queue is the executor's alone, so its operations can be drained in
+  // batches.
+  return absl::make_unique<ExecutorLibdispatch>(queue,
+                                                /*drain_in_batches=*/true);
 }
 
 std::unique_ptr<Executor> Executor::CreateConcurrent(const char* label,
@@ -74,7 +74,7 @@ ExecutorStd::~ExecutorStd() {
 
 void ExecutorStd::Dispose() {
   {
-    std::lock_guard<std::mutex> lock(mutex_);
+    absl::MutexLock lock(&mutex_);
 
     // Do nothing if already disposed.
     if (state_ == nullptr) {
@@ -113,7 +113,7 @@ void ExecutorStd::Dispose() {
 }
 
 void ExecutorStd::Execute(Operation&& operation) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  absl::MutexLock lock(&mutex_);
   if (!state_) return;
 
   PushOnScheduleLocked(Immediate(), kNoTag, std::move(operation));
@@ -122,7 +122,7 @@ void ExecutorStd::Execute(Operation&& operation) {
 DelayedOperation ExecutorStd::Schedule(const Milliseconds delay,
                                        Tag tag,
                                        Operation&& operation) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  absl::MutexLock lock(&mutex_);
   if (!state_) return {};
 
   // While negative delay can be interpreted as a request for immediate
@@ -142,7 +142,7 @@ void ExecutorStd::OnCompletion(Task*) {
 void ExecutorStd::Cancel(const Id operation_id) {
   Task* removed = nullptr;
   {
-    std::lock_guard<std::mutex> lock(mutex_);
+    absl::MutexLock lock(&mutex_);
     if (!state_) return;
 
     removed = state_->schedule_.RemoveIf(
@@ -19,16 +19,16 @@
 
 #include <algorithm>
 #include <atomic>
-#include <condition_variable>
 #include <deque>
 #include <memory>
-#include <mutex>
 #include <string>
 #include <thread>
 #include <utility>
 #include <vector>
 
 #include "Firestore/core/src/util/executor.h"
+#include "Firestore/core/src/util/mutex_contention.h"
+#include "absl/synchronization/mutex.h"
 
 namespace firebase {
 namespace firestore {
@@ -77,7 +77,8 @@ class ExecutorStd : public Executor {
   // A mutex that provides mutual exclusion to users of the Executor interface.
   // Worker threads do not acquire this mutex--they only operate on the
   // SharedState.
-  std::mutex mutex_;
+  absl::Mutex mutex_;
+  MutexContentionSite mutex_site_{&mutex_, "firestore.ExecutorStd"};
 
   std::vector<std::thread> worker_thread_pool_;
 
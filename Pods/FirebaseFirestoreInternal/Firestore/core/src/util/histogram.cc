@@ -0,0 +1,66 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "Firestore/core/src/util/histogram.h"
+
+#include <algorithm>
+
+#include "Firestore/core/src/util/string_format.h"
+
+namespace firebase {
+namespace firestore {
+namespace util {
+
+constexpr int Histogram::kBucketCount;
+
+void Histogram::Add(int64_t value) {
+  value = std::max<int64_t>(value, 0);
+  int bucket = 0;
+  for (uint64_t rest = static_cast<uint64_t>(value); rest != 0; rest >>= 1) {
+    ++bucket;
+  }
+  ++buckets_[std::min(bucket, kBucketCount - 1)];
+  ++count_;
+  sum_ += value;
+  max_ = std::max(max_, value);
+}
+
+int64_t Histogram::Percentile(double percentile) const {
+  if (count_ == 0) {
+    return 0;
+  }
+
+  double rank = count_ * std::min(std::max(percentile, 0.0), 100.0) / 100.0;
+  int64_t seen = 0;
+  for (int i = 0; i < kBucketCount; ++i) {
+    seen += buckets_[i];
+    if (seen > 0 && seen >= rank) {
+      int64_t upper = i == 0 ? 0 : (int64_t{1} << i) - 1;
+      return std::min(upper, max_);
+    }
+  }
+  return max_;
+}
+
+std::string Histogram::ToString() const {
+  return StringFormat("count=%s p50<=%s p90<=%s p99<=%s max=%s", count_,
+                      Percentile(50), Percentile(90), Percentile(99), max_);
+}
+
+}  // namespace util
+}  // namespace firestore
+}  // namespace firebase
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef FIRESTORE_CORE_SRC_UTIL_HISTOGRAM_H_
+#define FIRESTORE_CORE_SRC_UTIL_HISTOGRAM_H_
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace firebase {
+namespace firestore {
+namespace util {
+
+/**
+ * Counts non-negative samples in buckets that double in width, so that the
+ * same small histogram covers latencies from microseconds to minutes.
+ * Percentiles are reported as the upper end of the bucket they fall in.
+ */
+class Histogram {
+ public:
+  void Add(int64_t value);
+
+  int64_t count() const {
+    return count_;
+  }
+
+  int64_t sum() const {
+    return sum_;
+  }
+
+  int64_t max() const {
+    return max_;
+  }
+
+  /**
+   * Returns an upper bound of the given percentile, between 0 and 100, of the
+   * samples, or 0 if there are none.
+   */
+  int64_t Percentile(double percentile) const;
+
+  /** Summarizes the histogram as its count, median, p90, p99 and maximum. */
+  std::string ToString() const;
+
+ private:
+  // Bucket 0 counts zeros and bucket `i` counts values in [2^(i-1), 2^i).
+  static constexpr int kBucketCount = 48;
+
+  std::array<int64_t, kBucketCount> buckets_{};
+  int64_t count_ = 0;
+  int64_t sum_ = 0;
+  int64_t max_ = 0;
+};
+
+}  // namespace util
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_UTIL_HISTOGRAM_H_
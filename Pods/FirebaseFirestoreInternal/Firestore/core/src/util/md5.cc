@@ -289,6 +289,8 @@ void MD5Final(MD5Digest* digest, MD5Context* context) {
   memset(ctx, 0, sizeof(*ctx)); /* In case it's sensitive */
 }
 
+static_assert(sizeof(uint32_t[22]) == sizeof(MD5Context), "");
+
 }  // namespace
 
 std::array<uint8_t, 16> CalculateMd5Digest(absl::string_view s) {
@@ -301,6 +303,23 @@ std::array<uint8_t, 16> CalculateMd5Digest(absl::string_view s) {
   return digest;
 }
 
+Md5Hasher::Md5Hasher() {
+  MD5Init(reinterpret_cast<MD5Context*>(context_));
+}
+
+void Md5Hasher::Update(absl::string_view data) {
+  MD5Update(reinterpret_cast<MD5Context*>(context_), data);
+}
+
+std::array<uint8_t, 16> Md5Hasher::Digest() const {
+  // `MD5Final` clobbers the context it finishes.
+  Md5Hasher copy = *this;
+  std::array<uint8_t, 16> digest;
+  MD5Final(reinterpret_cast<MD5Digest*>(digest.data()),
+           reinterpret_cast<MD5Context*>(copy.context_));
+  return digest;
+}
+
 }  // namespace util
 }  // namespace firestore
 }  // namespace firebase
@@ -31,6 +31,26 @@ namespace util {
  */
 std::array<uint8_t, 16> CalculateMd5Digest(absl::string_view);
 
+/**
+ * Calculates an md5 digest incrementally. Copying an `Md5Hasher` copies the
+ * state of the calculation, so that the digests of many strings that share a
+ * prefix can be calculated by hashing the prefix only once.
+ */
+class Md5Hasher {
+ public:
+  Md5Hasher();
+
+  /** Appends the given bytes to the hashed data. */
+  void Update(absl::string_view data);
+
+  /** Returns the digest of the data so far, leaving this hasher unchanged. */
+  std::array<uint8_t, 16> Digest() const;
+
+ private:
+  // Large enough for, and aligned as, the context of the implementation.
+  uint32_t context_[22];
+};
+
 }  // namespace util
 }  // namespace firestore
 }  // namespace firebase
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef FIRESTORE_CORE_SRC_UTIL_MEMORY_PRESSURE_MONITOR_H_
+#define FIRESTORE_CORE_SRC_UTIL_MEMORY_PRESSURE_MONITOR_H_
+
+#include <functional>
+#include <memory>
+
+#include "Firestore/core/src/util/async_queue.h"
+
+namespace firebase {
+namespace firestore {
+namespace util {
+
+/** How short the system is on memory, as reported by the platform. */
+enum class MemoryPressure {
+  kNormal,
+  /** The app should free what it can rebuild cheaply. */
+  kWarning,
+  /** The app is about to be terminated unless it frees memory. */
+  kCritical,
+};
+
+/**
+ * Reports changes in system memory pressure; it is expected that each
+ * platform will have its own system-dependent implementation.
+ */
+class MemoryPressureMonitor {
+ public:
+  using Callback = std::function<void(MemoryPressure)>;
+
+  /**
+   * Creates a platform-specific monitor that invokes `callback` on the worker
+   * queue whenever the memory pressure changes. The callback is not invoked
+   * once the monitor has been destroyed.
+   */
+  static std::unique_ptr<MemoryPressureMonitor> Create(
+      const std::shared_ptr<AsyncQueue>& worker_queue, Callback callback);
+
+  virtual ~MemoryPressureMonitor() = default;
+};
+
+}  // namespace util
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_UTIL_MEMORY_PRESSURE_MONITOR_H_
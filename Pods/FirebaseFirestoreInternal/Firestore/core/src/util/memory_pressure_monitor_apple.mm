@@ -0,0 +1,105 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "Firestore/core/src/util/memory_pressure_monitor.h"
+
+#if defined(__APPLE__)
+
+#include <dispatch/dispatch.h>
+
+#include <memory>
+#include <utility>
+
+#include "Firestore/core/src/util/log.h"
+#include "absl/memory/memory.h"
+
+namespace firebase {
+namespace firestore {
+namespace util {
+
+namespace {
+
+MemoryPressure ToMemoryPressure(uintptr_t flags) {
+  if (flags & DISPATCH_MEMORYPRESSURE_CRITICAL) {
+    return MemoryPressure::kCritical;
+  }
+  if (flags & DISPATCH_MEMORYPRESSURE_WARN) {
+    return MemoryPressure::kWarning;
+  }
+  return MemoryPressure::kNormal;
+}
+
+}  // namespace
+
+/**
+ * Implementation of `MemoryPressureMonitor` based on a libdispatch memory
+ * pressure source, which also backs the memory warnings of UIKit.
+ */
+class MemoryPressureMonitorApple : public MemoryPressureMonitor {
+ public:
+  MemoryPressureMonitorApple(const std::shared_ptr<AsyncQueue>& worker_queue,
+                             Callback callback)
+      : callback_{std::make_shared<Callback>(std::move(callback))} {
+    source_ = dispatch_source_create(
+        DISPATCH_SOURCE_TYPE_MEMORYPRESSURE, 0,
+        DISPATCH_MEMORYPRESSURE_NORMAL | DISPATCH_MEMORYPRESSURE_WARN |
+            DISPATCH_MEMORYPRESSURE_CRITICAL,
+        dispatch_get_global_queue(QOS_CLASS_UTILITY, 0));
+    if (!source_) {
+      LOG_DEBUG("Failed to create memory pressure monitor.");
+      return;
+    }
+
+    // The source may fire after the monitor is gone, and so may the
+    // operation it enqueues; neither keeps the callback alive.
+    std::weak_ptr<Callback> weak_callback = callback_;
+    std::shared_ptr<AsyncQueue> queue = worker_queue;
+    dispatch_source_t source = source_;
+    dispatch_source_set_event_handler(source_, ^{
+      MemoryPressure pressure =
+          ToMemoryPressure(dispatch_source_get_data(source));
+      queue->Enqueue([weak_callback, pressure] {
+        if (std::shared_ptr<Callback> callback = weak_callback.lock()) {
+          (*callback)(pressure);
+        }
+      });
+    });
+    dispatch_resume(source_);
+  }
+
+  ~MemoryPressureMonitorApple() override {
+    if (source_) {
+      dispatch_source_cancel(source_);
+    }
+  }
+
+ private:
+  std::shared_ptr<Callback> callback_;
+  dispatch_source_t source_ = nullptr;
+};
+
+std::unique_ptr<MemoryPressureMonitor> MemoryPressureMonitor::Create(
+    const std::shared_ptr<AsyncQueue>& worker_queue, Callback callback) {
+  return absl::make_unique<MemoryPressureMonitorApple>(worker_queue,
+                                                       std::move(callback));
+}
+
+}  // namespace util
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // defined(__APPLE__)
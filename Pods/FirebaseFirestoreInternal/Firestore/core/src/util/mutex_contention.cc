@@ -0,0 +1,42 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/util/mutex_contention.h"
+
+#include "grpcpp/support/mutex_contention.h"
+
+namespace firebase {
+namespace firestore {
+namespace util {
+
+MutexContentionSite::MutexContentionSite(const absl::Mutex* mutex,
+                                         const char* site) {
+  // Only mutexes that were named have to be forgotten, which keeps the
+  // destructor free when profiling is off.
+  if (grpc::experimental::NameMutexContentionSite(mutex, site)) {
+    mutex_ = mutex;
+  }
+}
+
+MutexContentionSite::~MutexContentionSite() {
+  if (mutex_ != nullptr) {
+    grpc::experimental::ForgetMutexContentionSite(mutex_);
+  }
+}
+
+}  // namespace util
+}  // namespace firestore
+}  // namespace firebase
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_UTIL_MUTEX_CONTENTION_H_
+#define FIRESTORE_CORE_SRC_UTIL_MUTEX_CONTENTION_H_
+
+#include "absl/synchronization/mutex.h"
+
+namespace firebase {
+namespace firestore {
+namespace util {
+
+/**
+ * Names an `absl::Mutex` in the lock contention report that gRPC keeps while
+ * its mutex contention profiling is enabled, for as long as the
+ * `MutexContentionSite` lives. Declare it right after the mutex it names, so
+ * that it is destroyed first.
+ *
+ * Contention profiling is opt-in, through
+ * `grpc::experimental::EnableMutexContentionProfiling`. Mutexes created
+ * before it is enabled are reported by address rather than by name.
+ */
+class MutexContentionSite {
+ public:
+  MutexContentionSite(const absl::Mutex* mutex, const char* site);
+  ~MutexContentionSite();
+
+  MutexContentionSite(const MutexContentionSite&) = delete;
+  MutexContentionSite& operator=(const MutexContentionSite&) = delete;
+
+ private:
+  const absl::Mutex* mutex_ = nullptr;
+};
+
+}  // namespace util
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_UTIL_MUTEX_CONTENTION_H_
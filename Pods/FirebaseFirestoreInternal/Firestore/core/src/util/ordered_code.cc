@@ -26,8 +26,17 @@
 #include "absl/base/internal/endian.h"
 #include "absl/base/internal/unaligned_access.h"
 #include "absl/base/port.h"
+#include "absl/numeric/bits.h"
 #include "absl/strings/internal/resize_uninitialized.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define FIRESTORE_ORDERED_CODE_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define FIRESTORE_ORDERED_CODE_NEON 1
+#endif
+
 #if !defined(ABSL_IS_LITTLE_ENDIAN) && !defined(ABSL_IS_BIG_ENDIAN)
 #error \
     "Unsupported byte order: Either ABSL_IS_BIG_ENDIAN or " \
@@ -271,6 +280,38 @@ inline const char* SkipToNextSpecialByte(const char* start, const char* limit) {
   static_assert(kEscape1 == 0, "bit fiddling needs readjusting");
   static_assert((kEscape2 & 0xff) == 255, "bit fiddling needs readjusting");
   const char* p = start;
+#if defined(FIRESTORE_ORDERED_CODE_SSE2)
+  // Compare 16 bytes at a time against both special values; the movemask
+  // has one bit per byte, so the first set bit is the offset of the first
+  // special byte.
+  const __m128i escape1 = _mm_set1_epi8(static_cast<char>(kEscape1));
+  const __m128i escape2 = _mm_set1_epi8(static_cast<char>(kEscape2));
+  while (p + 16 <= limit) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i special =
+        _mm_or_si128(_mm_cmpeq_epi8(v, escape1), _mm_cmpeq_epi8(v, escape2));
+    uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(special));
+    if (mask != 0) {
+      return p + absl::countr_zero(mask);
+    }
+    p += 16;
+  }
+#elif defined(FIRESTORE_ORDERED_CODE_NEON)
+  // Compare 16 bytes at a time against both special values, then narrow the
+  // 0x00/0xff byte lanes to a 64-bit mask with four bits per byte.
+  const uint8x16_t escape1 = vdupq_n_u8(static_cast<uint8_t>(kEscape1));
+  const uint8x16_t escape2 = vdupq_n_u8(static_cast<uint8_t>(kEscape2));
+  while (p + 16 <= limit) {
+    uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+    uint8x16_t special = vorrq_u8(vceqq_u8(v, escape1), vceqq_u8(v, escape2));
+    uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(special), 4);
+    uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(narrowed), 0);
+    if (mask != 0) {
+      return p + (absl::countr_zero(mask) >> 2);
+    }
+    p += 16;
+  }
+#endif
   while (p + 8 <= limit) {
     // Find out if any of the next 8 bytes are either 0 or 255 (our
     // two characters that require special handling).  We do this using
@@ -17,6 +17,7 @@
 #ifndef FIRESTORE_CORE_SRC_UTIL_RANDOM_ACCESS_QUEUE_H_
 #define FIRESTORE_CORE_SRC_UTIL_RANDOM_ACCESS_QUEUE_H_
 
+#include <cstddef>
 #include <deque>
 #include <unordered_map>
 #include <vector>
@@ -158,6 +159,15 @@ class RandomAccessQueue {
     return queue_.empty();
   }
 
+  /**
+   * Returns the number of elements in the queue.
+   *
+   * This method has constant-time complexity.
+   */
+  size_t size() const {
+    return queue_entries_by_element_.size();
+  }
+
   /**
    * Returns whether or not this queue contains the given element.
    *
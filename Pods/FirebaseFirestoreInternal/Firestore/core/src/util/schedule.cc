@@ -28,7 +28,7 @@ Schedule::~Schedule() {
 }
 
 void Schedule::Clear() {
-  std::lock_guard<std::mutex> lock{mutex_};
+  absl::MutexLock lock{&mutex_};
 
   for (Task* task : scheduled_) {
     task->Release();
@@ -42,7 +42,7 @@ void Schedule::Push(Task* task) {
 }
 
 Task* Schedule::PopIfDue() {
-  std::lock_guard<std::mutex> lock{mutex_};
+  absl::MutexLock lock{&mutex_};
 
   if (HasDueLocked()) {
     return ExtractLocked(scheduled_.begin());
@@ -51,26 +51,29 @@ Task* Schedule::PopIfDue() {
 }
 
 Task* Schedule::PopBlocking() {
-  std::unique_lock<std::mutex> lock{mutex_};
+  absl::MutexLock lock{&mutex_};
 
   while (true) {
-    cv_.wait(lock, [this] { return !scheduled_.empty(); });
+    while (scheduled_.empty()) {
+      cv_.Wait(&mutex_);
+    }
 
     // To minimize busy waiting, sleep until either the nearest entry in the
-    // future either changes, or else becomes due.
-
-    // Workaround for Visual Studio 2015: cast to a time point with resolution
-    // that's at least as fine-grained as the clock on which `wait_until` is
-    // parametrized.
-    const auto until = std::chrono::time_point_cast<Clock::duration>(
-        scheduled_.front()->target_time());
-    cv_.wait_until(lock, until, [this, until] {
-      return scheduled_.empty() || scheduled_.front()->target_time() != until;
-    });
-
-    // There are 3 possibilities why `wait_until` has returned:
-    // - `wait_until` has timed out, in which case the current time is at
-    //   least `until`, so there must be an overdue entry;
+    // future either changes, or else becomes due. `Clock` is a steady clock,
+    // which `absl::CondVar` cannot wait on directly, so the deadline is
+    // turned into a timeout.
+    const TimePoint until = scheduled_.front()->target_time();
+    while (!scheduled_.empty() && scheduled_.front()->target_time() == until) {
+      const auto timeout = until - Clock::now();
+      if (timeout <= Clock::duration::zero() ||
+          cv_.WaitWithTimeout(&mutex_, absl::FromChrono(timeout))) {
+        break;
+      }
+    }
+
+    // There are 3 possibilities why the wait has ended:
+    // - it has timed out, in which case the current time is at least
+    //   `until`, so there must be an overdue entry;
     // - a new entry has been added which comes before `until`. It must be
     //   either overdue (in which case `HasDueLocked` will break the cycle),
     //   or else `until` must be reevaluated (on the next iteration of the
@@ -86,17 +89,17 @@ Task* Schedule::PopBlocking() {
 }
 
 bool Schedule::empty() const {
-  std::lock_guard<std::mutex> lock{mutex_};
+  absl::MutexLock lock{&mutex_};
   return scheduled_.empty();
 }
 
 size_t Schedule::size() const {
-  std::lock_guard<std::mutex> lock{mutex_};
+  absl::MutexLock lock{&mutex_};
   return scheduled_.size();
 }
 
 void Schedule::InsertPreservingOrder(Task* new_entry) {
-  std::lock_guard<std::mutex> lock{mutex_};
+  absl::MutexLock lock{&mutex_};
 
   const auto insertion_point =
       std::upper_bound(scheduled_.begin(), scheduled_.end(), new_entry,
@@ -105,7 +108,7 @@ void Schedule::InsertPreservingOrder(Task* new_entry) {
                        });
   scheduled_.insert(insertion_point, new_entry);
 
-  cv_.notify_one();
+  cv_.Signal();
 }
 
 // This function expects the mutex to be already locked.
@@ -122,7 +125,7 @@ Task* Schedule::ExtractLocked(const Iterator where) {
 
   Task* result = *where;
   scheduled_.erase(where);
-  cv_.notify_one();
+  cv_.Signal();
 
   return result;
 }
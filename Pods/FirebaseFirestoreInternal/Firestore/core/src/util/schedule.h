@@ -18,12 +18,12 @@
 #define FIRESTORE_CORE_SRC_UTIL_SCHEDULE_H_
 
 #include <algorithm>
-#include <condition_variable>
 #include <deque>
-#include <mutex>
 #include <vector>
 
 #include "Firestore/core/src/util/executor.h"
+#include "Firestore/core/src/util/mutex_contention.h"
+#include "absl/synchronization/mutex.h"
 
 namespace firebase {
 namespace firestore {
@@ -84,7 +84,7 @@ class Schedule {
   // is past its due time.
   template <typename Pred>
   Task* RemoveIf(const Pred pred) {
-    std::lock_guard<std::mutex> lock{mutex_};
+    absl::MutexLock lock{&mutex_};
 
     for (auto iter = scheduled_.begin(), end = scheduled_.end(); iter != end;
          ++iter) {
@@ -99,7 +99,7 @@ class Schedule {
   // Checks whether the queue contains an entry satisfying the given predicate.
   template <typename Pred>
   bool Contains(const Pred pred) const {
-    std::lock_guard<std::mutex> lock{mutex_};
+    absl::MutexLock lock{&mutex_};
     return std::any_of(scheduled_.begin(), scheduled_.end(),
                        [&pred](Task* t) { return pred(*t); });
   }
@@ -118,8 +118,9 @@ class Schedule {
   // This function expects the mutex to be already locked.
   Task* ExtractLocked(const Iterator where);
 
-  mutable std::mutex mutex_;
-  std::condition_variable cv_;
+  mutable absl::Mutex mutex_;
+  MutexContentionSite mutex_site_{&mutex_, "firestore.Schedule"};
+  absl::CondVar cv_;
   Container scheduled_;
 };
 
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Firestore/core/src/util/trace.h"
+
+#include <atomic>
+#include <utility>
+
+#include "Firestore/core/src/util/log.h"
+#include "Firestore/core/src/util/no_destructor.h"
+#include "Firestore/core/src/util/string_format.h"
+
+namespace firebase {
+namespace firestore {
+namespace util {
+
+namespace {
+
+std::atomic<bool> tracing_enabled{false};
+
+thread_local std::shared_ptr<OperationTrace> current_trace;
+
+struct ExporterHolder {
+  std::mutex mutex;
+  OperationTrace::Exporter exporter;
+};
+
+ExporterHolder& GetExporterHolder() {
+  static NoDestructor<ExporterHolder> holder;
+  return *holder;
+}
+
+const char* StageName(int stage) {
+  static const char* const kNames[OperationTrace::kStageCount] = {
+      "queue", "local_store", "serializer", "remote_store", "grpc"};
+  return kNames[stage];
+}
+
+int64_t ToMicros(OperationTrace::Clock::duration duration) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(duration)
+      .count();
+}
+
+}  // namespace
+
+constexpr int OperationTrace::kStageCount;
+
+OperationTrace::OperationTrace(std::string name)
+    : name_(std::move(name)), start_(Clock::now()) {
+}
+
+std::shared_ptr<OperationTrace> OperationTrace::Start(std::string name) {
+  if (!tracing_enabled) {
+    return nullptr;
+  }
+  return std::make_shared<OperationTrace>(std::move(name));
+}
+
+const std::shared_ptr<OperationTrace>& OperationTrace::Current() {
+  return current_trace;
+}
+
+void OperationTrace::SetEnabled(bool enabled) {
+  tracing_enabled = enabled;
+}
+
+bool OperationTrace::IsEnabled() {
+  return tracing_enabled;
+}
+
+void OperationTrace::SetExporter(Exporter exporter) {
+  ExporterHolder& holder = GetExporterHolder();
+  std::lock_guard<std::mutex> lock(holder.mutex);
+  holder.exporter = std::move(exporter);
+}
+
+void OperationTrace::Add(Stage stage, Clock::duration duration) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (finished_) {
+    return;
+  }
+  times_[static_cast<int>(stage)] += duration;
+  ++spans_[static_cast<int>(stage)];
+}
+
+void OperationTrace::Finish() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (finished_) {
+      return;
+    }
+    finished_ = true;
+    finish_ = Clock::now();
+  }
+
+  Exporter exporter;
+  {
+    ExporterHolder& holder = GetExporterHolder();
+    std::lock_guard<std::mutex> lock(holder.mutex);
+    exporter = holder.exporter;
+  }
+  if (exporter) {
+    exporter(*this);
+  } else {
+    LOG_DEBUG("Trace: %s", ToString());
+  }
+}
+
+OperationTrace::Clock::duration OperationTrace::elapsed() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return (finished_ ? finish_ : Clock::now()) - start_;
+}
+
+OperationTrace::Clock::duration OperationTrace::time_in(Stage stage) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return times_[static_cast<int>(stage)];
+}
+
+int64_t OperationTrace::spans_in(Stage stage) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return spans_[static_cast<int>(stage)];
+}
+
+std::string OperationTrace::ToString() const {
+  std::string result =
+      StringFormat("%s total_us=%s", name_, ToMicros(elapsed()));
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (int i = 0; i < kStageCount; ++i) {
+    if (spans_[i] == 0) {
+      continue;
+    }
+    result += StringFormat(" %s_us=%s(%s)", StageName(i), ToMicros(times_[i]),
+                           spans_[i]);
+  }
+  return result;
+}
+
+TraceScope::TraceScope(std::shared_ptr<OperationTrace> trace)
+    : previous_(std::move(current_trace)) {
+  current_trace = std::move(trace);
+}
+
+TraceScope::~TraceScope() {
+  current_trace = std::move(previous_);
+}
+
+TraceSpan::TraceSpan(OperationTrace::Stage stage)
+    : trace_(current_trace), stage_(stage) {
+  if (trace_) {
+    start_ = OperationTrace::Clock::now();
+  }
+}
+
+TraceSpan::~TraceSpan() {
+  if (trace_) {
+    trace_->Add(stage_, OperationTrace::Clock::now() - start_);
+  }
+}
+
+}  // namespace util
+}  // namespace firestore
+}  // namespace firebase
@@ -0,0 +1,169 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRESTORE_CORE_SRC_UTIL_TRACE_H_
+#define FIRESTORE_CORE_SRC_UTIL_TRACE_H_
+
+#include <array>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+
+namespace firebase {
+namespace firestore {
+namespace util {
+
+/**
+ * Records where the time of one user-visible operation, such as a document
+ * get or the first snapshot of a listener, is spent, from the API call until
+ * its result is delivered.
+ *
+ * The trace of the operation being worked on is held in a thread local (see
+ * `TraceScope`), and is carried across the hops of the operation: from the
+ * API to the worker queue, from the `RemoteStore` to the watch stream, and
+ * from a gRPC call to its completion. `TraceSpan`s add the time spent in each
+ * stage to the current trace, if there is one.
+ *
+ * Tracing is a debug API and is off by default, in which case no trace is
+ * ever started and each span costs a thread local read.
+ */
+class OperationTrace {
+ public:
+  // Stages may nest: decoding within a `LocalStore` transaction counts toward
+  // both.
+  enum class Stage {
+    // Waiting on the worker queue.
+    kQueue,
+    // Running `LocalStore` transactions.
+    kLocalStore,
+    // Encoding and decoding protos.
+    kSerializer,
+    // Waiting in the `RemoteStore` for the watch stream to send a listen.
+    kRemoteStore,
+    // Waiting for the backend; for a listen, until its target is current.
+    kGrpcCall,
+  };
+  static constexpr int kStageCount = 5;
+
+  using Clock = std::chrono::steady_clock;
+  using Exporter = std::function<void(const OperationTrace&)>;
+
+  explicit OperationTrace(std::string name);
+
+  /**
+   * Returns a new trace of an operation called `name`, or null if tracing is
+   * disabled.
+   */
+  static std::shared_ptr<OperationTrace> Start(std::string name);
+
+  /** Returns the trace of the operation running on this thread, if any. */
+  static const std::shared_ptr<OperationTrace>& Current();
+
+  /**
+   * Debug API: starts or stops tracing new operations. Operations that are
+   * already traced keep recording.
+   */
+  static void SetEnabled(bool enabled);
+  static bool IsEnabled();
+
+  /**
+   * Sets the function that each trace is handed to when it finishes, or
+   * resets it if `exporter` is empty. Without an exporter, traces are logged
+   * at debug level.
+   */
+  static void SetExporter(Exporter exporter);
+
+  const std::string& name() const {
+    return name_;
+  }
+
+  /** Adds `duration` to the time spent in `stage`. */
+  void Add(Stage stage, Clock::duration duration);
+
+  /**
+   * Marks the operation as done and exports the trace. Later calls, and time
+   * added after the first one, are ignored.
+   */
+  void Finish();
+
+  /** The time from the start of the trace until it finished, or until now. */
+  Clock::duration elapsed() const;
+
+  /** The time spent in `stage` so far. */
+  Clock::duration time_in(Stage stage) const;
+
+  /** The number of spans of `stage` so far. */
+  int64_t spans_in(Stage stage) const;
+
+  /**
+   * Summarizes the trace as its name, total time and the time and span count
+   * of each stage, in microseconds.
+   */
+  std::string ToString() const;
+
+ private:
+  std::string name_;
+  Clock::time_point start_;
+
+  mutable std::mutex mutex_;
+  Clock::time_point finish_;
+  bool finished_ = false;
+  std::array<Clock::duration, kStageCount> times_{};
+  std::array<int64_t, kStageCount> spans_{};
+};
+
+/**
+ * Makes `trace` the current trace of this thread for the lifetime of the
+ * scope, and restores the previous one afterwards. `trace` may be null.
+ */
+class TraceScope {
+ public:
+  explicit TraceScope(std::shared_ptr<OperationTrace> trace);
+  ~TraceScope();
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+ private:
+  std::shared_ptr<OperationTrace> previous_;
+};
+
+/**
+ * Adds the lifetime of the span to the given stage of the current trace, if
+ * there is one when the span is created.
+ */
+class TraceSpan {
+ public:
+  explicit TraceSpan(OperationTrace::Stage stage);
+  ~TraceSpan();
+
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+ private:
+  std::shared_ptr<OperationTrace> trace_;
+  OperationTrace::Stage stage_;
+  OperationTrace::Clock::time_point start_;
+};
+
+}  // namespace util
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIRESTORE_CORE_SRC_UTIL_TRACE_H_
@@ -255,4 +255,27 @@
 
 #define ABSL_OPTION_HARDENED 0
 
+// ABSL_OPTION_HASHTABLEZ_SAMPLING
+//
+// This option compiles in the hashtablez sampler, which records statistics
+// (size, capacity, probe lengths, rehashes) for a random subset of Swiss tables
+// (`absl::flat_hash_map`, `absl::flat_hash_set`, `absl::node_hash_map` and
+// `absl::node_hash_set`).
+//
+// A value of 0 means that sampling is compiled out and costs nothing.
+//
+// A value of 1 means that sampling is compiled in. It is still off until
+// `absl::container_internal::SetHashtablezEnabled(true)` is called, and then
+// costs a thread-local decrement per table construction, plus bookkeeping on
+// every operation of the sampled tables.
+//
+// Unlike the other options, this one may also be set on the command line
+// (`-DABSL_OPTION_HASHTABLEZ_SAMPLING=1`) for a profiling build. It must then
+// be set for every target that includes Abseil, as it changes the layout of the
+// Swiss tables.
+
+#ifndef ABSL_OPTION_HASHTABLEZ_SAMPLING
+#define ABSL_OPTION_HASHTABLEZ_SAMPLING 0
+#endif
+
 #endif  // ABSL_BASE_OPTIONS_H_
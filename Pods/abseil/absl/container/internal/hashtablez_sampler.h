@@ -139,6 +139,11 @@ void UnsampleSlow(HashtablezInfo* info);
 #error ABSL_INTERNAL_HASHTABLEZ_SAMPLE cannot be directly set
 #endif  // defined(ABSL_INTERNAL_HASHTABLEZ_SAMPLE)
 
+#if ABSL_OPTION_HASHTABLEZ_SAMPLING == 1 && ABSL_PER_THREAD_TLS == 1 && \
+    !defined(ABSL_BUILD_DLL) && !defined(ABSL_BUILD_TEST_DLL)
+#define ABSL_INTERNAL_HASHTABLEZ_SAMPLE
+#endif
+
 #if defined(ABSL_INTERNAL_HASHTABLEZ_SAMPLE)
 class HashtablezInfoHandle {
  public:
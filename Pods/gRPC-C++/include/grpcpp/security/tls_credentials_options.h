@@ -126,6 +126,16 @@ class TlsCredentialsOptions {
   // handshake. If not set, the underlying SSL library will use TLS v1.3.
   // @param tls_version: The maximum TLS version.
   void set_max_tls_version(grpc_tls_version tls_version);
+  // Sets whether the cipher suites are ordered by this machine's hardware:
+  // AES-GCM is preferred when AES acceleration is available, and
+  // ChaCha20-Poly1305 otherwise. If not set, the configured order is used.
+  // @param prefer_hardware_ciphers: Whether to order by hardware support.
+  void set_prefer_hardware_ciphers(bool prefer_hardware_ciphers);
+  // Sets the key exchange groups, as a colon-separated list in order of
+  // preference, e.g. "X25519MLKEM768:X25519:P-256". If not set, only P-256 is
+  // used.
+  // @param key_exchange_groups: The key exchange groups.
+  void set_key_exchange_groups(const std::string& key_exchange_groups);
 
   // ----- Getters for member fields ----
   // Returns a deep copy of the internal c options. The caller takes ownership
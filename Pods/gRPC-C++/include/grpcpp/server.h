@@ -171,6 +171,10 @@ class Server : public ServerInterface, private internal::GrpcLibrary {
   ///
   /// \param sync_cq_timeout_msec The timeout to use when calling AsyncNext() on
   /// server completion queues passed via sync_server_cqs param.
+  ///
+  /// \param sync_handlers_on_event_engine Whether sync methods are served from
+  /// the callback completion queue, with their handlers run on the EventEngine,
+  /// instead of from sync_server_cqs by polling threads
   Server(ChannelArguments* args,
          std::shared_ptr<std::vector<std::unique_ptr<ServerCompletionQueue>>>
              sync_server_cqs,
@@ -183,7 +187,8 @@ class Server : public ServerInterface, private internal::GrpcLibrary {
              std::unique_ptr<experimental::ServerInterceptorFactoryInterface>>
              interceptor_creators = std::vector<std::unique_ptr<
                  experimental::ServerInterceptorFactoryInterface>>(),
-         experimental::ServerMetricRecorder* server_metric_recorder = nullptr);
+         experimental::ServerMetricRecorder* server_metric_recorder = nullptr,
+         bool sync_handlers_on_event_engine = false);
 
   /// Start the server.
   ///
@@ -297,6 +302,10 @@ class Server : public ServerInterface, private internal::GrpcLibrary {
   /// the \a sync_server_cqs)
   std::vector<std::unique_ptr<SyncRequestThreadManager>> sync_req_mgrs_;
 
+  /// If set, there are no \a sync_server_cqs and sync methods are served from
+  /// the callback CQ instead
+  const bool sync_handlers_on_event_engine_;
+
   // Server status
   internal::Mutex mu_;
   bool started_;
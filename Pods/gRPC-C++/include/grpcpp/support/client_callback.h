@@ -30,6 +30,8 @@
 
 #include <atomic>
 #include <functional>
+#include <utility>
+#include <vector>
 
 #include "absl/log/absl_check.h"
 
@@ -155,6 +157,8 @@ class ClientCallbackReaderWriter {
   virtual ~ClientCallbackReaderWriter() {}
   virtual void StartCall() = 0;
   virtual void Write(const Request* req, grpc::WriteOptions options) = 0;
+  virtual void WriteBatch(std::vector<const Request*> reqs,
+                          grpc::WriteOptions options) = 0;
   virtual void WritesDone() = 0;
   virtual void Read(Response* resp) = 0;
   virtual void AddHold(int holds) = 0;
@@ -191,6 +195,8 @@ class ClientCallbackWriter {
   void WriteLast(const Request* req, grpc::WriteOptions options) {
     Write(req, options.set_last_message());
   }
+  virtual void WriteBatch(std::vector<const Request*> reqs,
+                          grpc::WriteOptions options) = 0;
   virtual void WritesDone() = 0;
 
   virtual void AddHold(int holds) = 0;
@@ -274,6 +280,26 @@ class ClientBidiReactor : public internal::ClientReactor {
     StartWrite(req, options.set_last_message());
   }
 
+  /// Initiate/post a corked write of several messages, completed by a single
+  /// OnWriteDone. Every message but the last is written with the buffer hint,
+  /// so the transport coalesces them into as few writes as it can; the last
+  /// one uses \a options, so adding set_buffer_hint() there keeps the stream
+  /// corked across batches and set_last_message() ends it. If a write fails,
+  /// the rest of the batch is dropped and OnWriteDone reports the failure.
+  ///
+  /// \param[in] reqs The messages to be written, in order. Must not be empty.
+  ///                 The library does not take ownership but the caller must
+  ///                 ensure that the messages are not deleted or modified
+  ///                 until OnWriteDone is called.
+  /// \param[in] options The WriteOptions to use for the last message
+  void StartWriteBatch(std::vector<const Request*> reqs) {
+    StartWriteBatch(std::move(reqs), grpc::WriteOptions());
+  }
+  void StartWriteBatch(std::vector<const Request*> reqs,
+                       grpc::WriteOptions options) {
+    stream_->WriteBatch(std::move(reqs), options);
+  }
+
   /// Indicate that the RPC will have no more write operations. This can only be
   /// issued once for a given RPC. This is not required or allowed if
   /// StartWriteLast is used since that already has the same implication.
@@ -334,8 +360,8 @@ class ClientBidiReactor : public internal::ClientReactor {
   ///               will succeed.
   virtual void OnReadDone(bool /*ok*/) {}
 
-  /// Notifies the application that a StartWrite or StartWriteLast operation
-  /// completed.
+  /// Notifies the application that a StartWrite, StartWriteLast or
+  /// StartWriteBatch operation completed.
   ///
   /// \param[in] ok Was it successful? If false, no new read/write operation
   ///               will succeed.
@@ -396,6 +422,13 @@ class ClientWriteReactor : public internal::ClientReactor {
   void StartWriteLast(const Request* req, grpc::WriteOptions options) {
     StartWrite(req, options.set_last_message());
   }
+  void StartWriteBatch(std::vector<const Request*> reqs) {
+    StartWriteBatch(std::move(reqs), grpc::WriteOptions());
+  }
+  void StartWriteBatch(std::vector<const Request*> reqs,
+                       grpc::WriteOptions options) {
+    writer_->WriteBatch(std::move(reqs), options);
+  }
   void StartWritesDone() { writer_->WritesDone(); }
 
   void AddHold() { AddMultipleHolds(1); }
@@ -522,27 +555,17 @@ class ClientCallbackReaderWriterImpl
 
   void Write(const Request* msg, grpc::WriteOptions options)
       ABSL_LOCKS_EXCLUDED(start_mu_) override {
-    if (options.is_last_message()) {
-      options.set_buffer_hint();
-      write_ops_.ClientSendClose();
-    }
-    // TODO(vjpai): don't assert
-    ABSL_CHECK(write_ops_.SendMessagePtr(msg, options).ok());
     callbacks_outstanding_.fetch_add(1, std::memory_order_relaxed);
-    if (GPR_UNLIKELY(corked_write_needed_)) {
-      write_ops_.SendInitialMetadata(&context_->send_initial_metadata_,
-                                     context_->initial_metadata_flags());
-      corked_write_needed_ = false;
-    }
-
-    if (GPR_UNLIKELY(!started_.load(std::memory_order_acquire))) {
-      grpc::internal::MutexLock lock(&start_mu_);
-      if (GPR_LIKELY(!started_.load(std::memory_order_relaxed))) {
-        backlog_.write_ops = true;
-        return;
-      }
-    }
-    call_.PerformOps(&write_ops_);
+    StartWriteOp(msg, options);
+  }
+  void WriteBatch(std::vector<const Request*> msgs, grpc::WriteOptions options)
+      ABSL_LOCKS_EXCLUDED(start_mu_) override {
+    ABSL_CHECK(!msgs.empty());
+    batch_ = std::move(msgs);
+    batch_next_ = 0;
+    batch_options_ = options;
+    callbacks_outstanding_.fetch_add(1, std::memory_order_relaxed);
+    StartNextBatchWrite();
   }
   void WritesDone() ABSL_LOCKS_EXCLUDED(start_mu_) override {
     writes_done_ops_.ClientSendClose();
@@ -603,6 +626,12 @@ class ClientCallbackReaderWriterImpl
     write_tag_.Set(
         call_.call(),
         [this](bool ok) {
+          if (ok && batch_next_ < batch_.size()) {
+            StartNextBatchWrite();
+            return;
+          }
+          batch_.clear();
+          batch_next_ = 0;
           reactor_->OnWriteDone(ok);
           MaybeFinish(/*from_reaction=*/true);
         },
@@ -628,6 +657,45 @@ class ClientCallbackReaderWriterImpl
     finish_ops_.set_core_cq_tag(&finish_tag_);
   }
 
+  // Issues one write op. The caller accounts for its completion in
+  // callbacks_outstanding_.
+  void StartWriteOp(const Request* msg, grpc::WriteOptions options)
+      ABSL_LOCKS_EXCLUDED(start_mu_) {
+    if (options.is_last_message()) {
+      options.set_buffer_hint();
+      write_ops_.ClientSendClose();
+    }
+    // TODO(vjpai): don't assert
+    ABSL_CHECK(write_ops_.SendMessagePtr(msg, options).ok());
+    if (GPR_UNLIKELY(corked_write_needed_)) {
+      write_ops_.SendInitialMetadata(&context_->send_initial_metadata_,
+                                     context_->initial_metadata_flags());
+      corked_write_needed_ = false;
+    }
+
+    if (GPR_UNLIKELY(!started_.load(std::memory_order_acquire))) {
+      grpc::internal::MutexLock lock(&start_mu_);
+      if (GPR_LIKELY(!started_.load(std::memory_order_relaxed))) {
+        backlog_.write_ops = true;
+        return;
+      }
+    }
+    call_.PerformOps(&write_ops_);
+  }
+
+  // Writes the next message of the current batch. Only the last one carries
+  // the batch's own options; the others ask the transport to buffer them.
+  void StartNextBatchWrite() {
+    const Request* msg = batch_[batch_next_++];
+    if (batch_next_ == batch_.size()) {
+      StartWriteOp(msg, batch_options_);
+    } else {
+      StartWriteOp(msg, grpc::WriteOptions(batch_options_)
+                            .clear_last_message()
+                            .set_buffer_hint());
+    }
+  }
+
   // MaybeFinish can be called from reactions or from user-initiated operations
   // like StartCall or RemoveHold. If this is the last operation or hold on this
   // object, it will invoke the OnDone reaction. If MaybeFinish was called from
@@ -673,6 +741,11 @@ class ClientCallbackReaderWriterImpl
                             grpc::internal::CallOpClientSendClose>
       write_ops_;
   grpc::internal::CallbackWithSuccessTag write_tag_;
+  // The StartWriteBatch in progress, if any. Only accessed by the write flow,
+  // which has at most one write outstanding.
+  std::vector<const Request*> batch_;
+  size_t batch_next_ = 0;
+  grpc::WriteOptions batch_options_;
 
   grpc::internal::CallOpSet<grpc::internal::CallOpSendInitialMetadata,
                             grpc::internal::CallOpClientSendClose>
@@ -924,28 +997,17 @@ class ClientCallbackWriterImpl : public ClientCallbackWriter<Request> {
 
   void Write(const Request* msg, grpc::WriteOptions options)
       ABSL_LOCKS_EXCLUDED(start_mu_) override {
-    if (GPR_UNLIKELY(options.is_last_message())) {
-      options.set_buffer_hint();
-      write_ops_.ClientSendClose();
-    }
-    // TODO(vjpai): don't assert
-    ABSL_CHECK(write_ops_.SendMessagePtr(msg, options).ok());
     callbacks_outstanding_.fetch_add(1, std::memory_order_relaxed);
-
-    if (GPR_UNLIKELY(corked_write_needed_)) {
-      write_ops_.SendInitialMetadata(&context_->send_initial_metadata_,
-                                     context_->initial_metadata_flags());
-      corked_write_needed_ = false;
-    }
-
-    if (GPR_UNLIKELY(!started_.load(std::memory_order_acquire))) {
-      grpc::internal::MutexLock lock(&start_mu_);
-      if (GPR_LIKELY(!started_.load(std::memory_order_relaxed))) {
-        backlog_.write_ops = true;
-        return;
-      }
-    }
-    call_.PerformOps(&write_ops_);
+    StartWriteOp(msg, options);
+  }
+  void WriteBatch(std::vector<const Request*> msgs, grpc::WriteOptions options)
+      ABSL_LOCKS_EXCLUDED(start_mu_) override {
+    ABSL_CHECK(!msgs.empty());
+    batch_ = std::move(msgs);
+    batch_next_ = 0;
+    batch_options_ = options;
+    callbacks_outstanding_.fetch_add(1, std::memory_order_relaxed);
+    StartNextBatchWrite();
   }
 
   void WritesDone() ABSL_LOCKS_EXCLUDED(start_mu_) override {
@@ -1010,6 +1072,12 @@ class ClientCallbackWriterImpl : public ClientCallbackWriter<Request> {
     write_tag_.Set(
         call_.call(),
         [this](bool ok) {
+          if (ok && batch_next_ < batch_.size()) {
+            StartNextBatchWrite();
+            return;
+          }
+          batch_.clear();
+          batch_next_ = 0;
           reactor_->OnWriteDone(ok);
           MaybeFinish(/*from_reaction=*/true);
         },
@@ -1028,6 +1096,45 @@ class ClientCallbackWriterImpl : public ClientCallbackWriter<Request> {
     finish_ops_.set_core_cq_tag(&finish_tag_);
   }
 
+  // Issues one write op. The caller accounts for its completion in
+  // callbacks_outstanding_.
+  void StartWriteOp(const Request* msg, grpc::WriteOptions options)
+      ABSL_LOCKS_EXCLUDED(start_mu_) {
+    if (GPR_UNLIKELY(options.is_last_message())) {
+      options.set_buffer_hint();
+      write_ops_.ClientSendClose();
+    }
+    // TODO(vjpai): don't assert
+    ABSL_CHECK(write_ops_.SendMessagePtr(msg, options).ok());
+    if (GPR_UNLIKELY(corked_write_needed_)) {
+      write_ops_.SendInitialMetadata(&context_->send_initial_metadata_,
+                                     context_->initial_metadata_flags());
+      corked_write_needed_ = false;
+    }
+
+    if (GPR_UNLIKELY(!started_.load(std::memory_order_acquire))) {
+      grpc::internal::MutexLock lock(&start_mu_);
+      if (GPR_LIKELY(!started_.load(std::memory_order_relaxed))) {
+        backlog_.write_ops = true;
+        return;
+      }
+    }
+    call_.PerformOps(&write_ops_);
+  }
+
+  // Writes the next message of the current batch. Only the last one carries
+  // the batch's own options; the others ask the transport to buffer them.
+  void StartNextBatchWrite() {
+    const Request* msg = batch_[batch_next_++];
+    if (batch_next_ == batch_.size()) {
+      StartWriteOp(msg, batch_options_);
+    } else {
+      StartWriteOp(msg, grpc::WriteOptions(batch_options_)
+                            .clear_last_message()
+                            .set_buffer_hint());
+    }
+  }
+
   // MaybeFinish behaves as in ClientCallbackReaderWriterImpl.
   void MaybeFinish(bool from_reaction) {
     if (GPR_UNLIKELY(callbacks_outstanding_.fetch_sub(
@@ -1070,6 +1177,11 @@ class ClientCallbackWriterImpl : public ClientCallbackWriter<Request> {
                             grpc::internal::CallOpClientSendClose>
       write_ops_;
   grpc::internal::CallbackWithSuccessTag write_tag_;
+  // The StartWriteBatch in progress, if any. Only accessed by the write flow,
+  // which has at most one write outstanding.
+  std::vector<const Request*> batch_;
+  size_t batch_next_ = 0;
+  grpc::WriteOptions batch_options_;
 
   grpc::internal::CallOpSet<grpc::internal::CallOpSendInitialMetadata,
                             grpc::internal::CallOpClientSendClose>
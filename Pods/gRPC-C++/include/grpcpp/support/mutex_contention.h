@@ -0,0 +1,52 @@
+//
+//
+// Copyright 2024 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//
+
+#ifndef GRPCPP_SUPPORT_MUTEX_CONTENTION_H
+#define GRPCPP_SUPPORT_MUTEX_CONTENTION_H
+
+#include <grpcpp/support/config.h>
+#include <stdint.h>
+
+namespace grpc {
+
+namespace experimental {
+
+/// Starts sampling lock contention in the process: one in every
+/// \a sample_every contended acquisitions of an absl::Mutex, or of a gRPC
+/// internal mutex, records how long the thread waited for the lock. Stops
+/// sampling if \a sample_every is zero. The waits are recorded in the
+/// mutex_contention_wait_us histogram of gRPC's global stats, and by lock
+/// site.
+void EnableMutexContentionProfiling(uint32_t sample_every);
+
+/// Records the contention on \a mutex under \a site, until
+/// ForgetMutexContentionSite() is called for it before the mutex is
+/// destroyed. Does nothing while profiling is disabled. Returns whether the
+/// mutex was named.
+bool NameMutexContentionSite(const void* mutex, const char* site);
+void ForgetMutexContentionSite(const void* mutex);
+
+/// Returns the contentions sampled so far, and how long they waited, by lock
+/// site, one per line.
+std::string MutexContentionReport();
+
+}  // namespace experimental
+
+}  // namespace grpc
+
+#endif  // GRPCPP_SUPPORT_MUTEX_CONTENTION_H
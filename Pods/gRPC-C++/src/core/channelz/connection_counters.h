@@ -0,0 +1,118 @@
+// Copyright 2024 The gRPC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GRPC_SRC_CORE_CHANNELZ_CONNECTION_COUNTERS_H
+#define GRPC_SRC_CORE_CHANNELZ_CONNECTION_COUNTERS_H
+
+#include <grpc/support/port_platform.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "src/core/util/ref_counted.h"
+
+namespace grpc_core {
+namespace channelz {
+
+// A counters-only alternative to channelz, enabled with
+// GRPC_ARG_ENABLE_CHANNELZ_COUNTERS. There are no nodes, uuids, traces or
+// JSON: each socket and subchannel just keeps a few relaxed atomics that can
+// be read back as plain structs. Counters of closed sockets and destroyed
+// subchannels are dropped.
+
+class SocketCounters final : public RefCounted<SocketCounters> {
+ public:
+  struct Snapshot {
+    std::string local;
+    std::string remote;
+    uint64_t bytes_sent = 0;
+    uint64_t bytes_received = 0;
+    uint64_t streams_started = 0;
+    uint64_t streams_succeeded = 0;
+    uint64_t streams_failed = 0;
+    uint64_t messages_sent = 0;
+    uint64_t flow_control_stalls = 0;
+    uint64_t keepalives_sent = 0;
+  };
+
+  SocketCounters(std::string local, std::string remote);
+  ~SocketCounters() override;
+
+  void RecordBytesSent(uint64_t bytes) { Add(bytes_sent_, bytes); }
+  void RecordBytesReceived(uint64_t bytes) { Add(bytes_received_, bytes); }
+  void RecordStreamStarted() { Add(streams_started_, 1); }
+  void RecordStreamSucceeded() { Add(streams_succeeded_, 1); }
+  void RecordStreamFailed() { Add(streams_failed_, 1); }
+  void RecordMessagesSent(uint64_t num_sent) {
+    Add(messages_sent_, num_sent);
+  }
+  void RecordFlowControlStall() { Add(flow_control_stalls_, 1); }
+  void RecordKeepaliveSent() { Add(keepalives_sent_, 1); }
+
+  Snapshot GetSnapshot() const;
+
+ private:
+  static void Add(std::atomic<uint64_t>& counter, uint64_t n) {
+    counter.fetch_add(n, std::memory_order_relaxed);
+  }
+
+  const std::string local_;
+  const std::string remote_;
+  std::atomic<uint64_t> bytes_sent_{0};
+  std::atomic<uint64_t> bytes_received_{0};
+  std::atomic<uint64_t> streams_started_{0};
+  std::atomic<uint64_t> streams_succeeded_{0};
+  std::atomic<uint64_t> streams_failed_{0};
+  std::atomic<uint64_t> messages_sent_{0};
+  std::atomic<uint64_t> flow_control_stalls_{0};
+  std::atomic<uint64_t> keepalives_sent_{0};
+};
+
+class SubchannelCounters final : public RefCounted<SubchannelCounters> {
+ public:
+  struct Snapshot {
+    std::string target;
+    uint64_t connection_attempts = 0;
+    uint64_t connection_failures = 0;
+  };
+
+  explicit SubchannelCounters(std::string target);
+  ~SubchannelCounters() override;
+
+  void RecordConnectionAttempt() {
+    connection_attempts_.fetch_add(1, std::memory_order_relaxed);
+  }
+  void RecordConnectionFailure() {
+    connection_failures_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  Snapshot GetSnapshot() const;
+
+ private:
+  const std::string target_;
+  std::atomic<uint64_t> connection_attempts_{0};
+  std::atomic<uint64_t> connection_failures_{0};
+};
+
+// Return the counters of every live socket and subchannel. Safe to call
+// from any thread.
+std::vector<SocketCounters::Snapshot> GetAllSocketCounters();
+std::vector<SubchannelCounters::Snapshot> GetAllSubchannelCounters();
+
+}  // namespace channelz
+}  // namespace grpc_core
+
+#endif  // GRPC_SRC_CORE_CHANNELZ_CONNECTION_COUNTERS_H
@@ -0,0 +1,135 @@
+// Copyright 2024 The gRPC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GRPC_SRC_CORE_CLIENT_CHANNEL_CLIENT_ADMISSION_CONTROL_FILTER_H
+#define GRPC_SRC_CORE_CLIENT_CHANNEL_CLIENT_ADMISSION_CONTROL_FILTER_H
+
+#include <grpc/support/port_platform.h>
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/random/random.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "src/core/lib/channel/channel_args.h"
+#include "src/core/lib/channel/channel_fwd.h"
+#include "src/core/lib/channel/promise_based_filter.h"
+#include "src/core/lib/transport/transport.h"
+#include "src/core/util/random_early_detection.h"
+#include "src/core/util/ref_counted.h"
+#include "src/core/util/ref_counted_ptr.h"
+#include "src/core/util/sync.h"
+#include "src/core/util/time.h"
+
+namespace grpc_core {
+
+/// Tracks how a target has been answering recent calls, shared by every
+/// channel to that target.
+///
+/// Calls are rejected on the client with the adaptive throttling rule: with
+/// "requests" the calls attempted (admitted or not) and "accepts" the calls
+/// the target did not answer with an overload status, a new call is rejected
+/// with probability (requests - kAcceptsMultiplier * accepts) /
+/// (requests + 1). A healthy target is never throttled, and a target that
+/// fails everything still sees a trickle of calls to notice its recovery.
+/// Both counts are halved every kDecayPeriod so that old results fade.
+class AdmissionControlTargetData final
+    : public RefCounted<AdmissionControlTargetData> {
+ public:
+  static constexpr uint64_t kAcceptsMultiplier = 2;
+  static constexpr Duration kDecayPeriod = Duration::Seconds(5);
+
+  /// Returns OK if a call with \a deadline may be started. While the target
+  /// is being throttled, calls whose deadline is closer than the target's
+  /// typical latency are failed straight away, since they would most likely
+  /// time out anyway.
+  absl::Status AdmitCall(Timestamp deadline);
+
+  /// Records the outcome of an admitted call.
+  void RecordCallFinished(bool overloaded, Duration latency);
+
+ private:
+  void MaybeDecayLocked(Timestamp now) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Mutex mu_;
+  uint64_t requests_ ABSL_GUARDED_BY(mu_) = 0;
+  uint64_t accepts_ ABSL_GUARDED_BY(mu_) = 0;
+  Timestamp next_decay_ ABSL_GUARDED_BY(mu_) = Timestamp::InfPast();
+  // EWMA of the latency of accepted calls, zero until one finishes.
+  Duration latency_ ABSL_GUARDED_BY(mu_) = Duration::Zero();
+  RandomEarlyDetection red_ ABSL_GUARDED_BY(mu_);
+  absl::InsecureBitGen bitgen_ ABSL_GUARDED_BY(mu_);
+};
+
+/// Global map of target to admission control data.
+class AdmissionControlMap final {
+ public:
+  static AdmissionControlMap* Get();
+
+  /// Returns the data for \a target, creating a new entry if needed.
+  RefCountedPtr<AdmissionControlTargetData> GetDataForTarget(
+      const std::string& target);
+
+ private:
+  Mutex mu_;
+  std::map<std::string, RefCountedPtr<AdmissionControlTargetData>> map_
+      ABSL_GUARDED_BY(mu_);
+};
+
+/// Rejects calls on the client when their target looks saturated, before
+/// they are queued for a pick or a stream. Enabled with
+/// GRPC_ARG_ENABLE_CLIENT_ADMISSION_CONTROL.
+class ClientAdmissionControlFilter final
+    : public ImplementChannelFilter<ClientAdmissionControlFilter> {
+ public:
+  static const grpc_channel_filter kFilter;
+
+  static absl::string_view TypeName() { return "client_admission_control"; }
+
+  static absl::StatusOr<std::unique_ptr<ClientAdmissionControlFilter>> Create(
+      const ChannelArgs& args, ChannelFilter::Args filter_args);
+
+  explicit ClientAdmissionControlFilter(
+      RefCountedPtr<AdmissionControlTargetData> target_data)
+      : target_data_(std::move(target_data)) {}
+
+  class Call {
+   public:
+    absl::Status OnClientInitialMetadata(ClientMetadata& md,
+                                         ClientAdmissionControlFilter* filter);
+    void OnServerTrailingMetadata(ServerMetadata& md,
+                                  ClientAdmissionControlFilter* filter);
+    static const NoInterceptor OnServerInitialMetadata;
+    static const NoInterceptor OnClientToServerMessage;
+    static const NoInterceptor OnClientToServerHalfClose;
+    static const NoInterceptor OnServerToClientMessage;
+    static const NoInterceptor OnFinalize;
+
+   private:
+    // Set once the call is admitted; rejected calls record nothing more.
+    Timestamp start_time_ = Timestamp::InfPast();
+  };
+
+ private:
+  const RefCountedPtr<AdmissionControlTargetData> target_data_;
+};
+
+}  // namespace grpc_core
+
+#endif  // GRPC_SRC_CORE_CLIENT_CHANNEL_CLIENT_ADMISSION_CONTROL_FILTER_H
@@ -92,6 +92,12 @@ class RetryFilter::LegacyCallData final {
     // Cancels the call attempt.
     void CancelFromSurface(grpc_transport_stream_op_batch* cancel_batch);
 
+    // Adds whatever batches are needed on this attempt to closures.
+    void AddRetriableBatches(CallCombinerClosureList* closures);
+
+    // Cancels and abandons a hedged attempt that lost to another one.
+    void CancelLosingHedge(CallCombinerClosureList* closures);
+
    private:
     // State used for starting a retryable batch on the call attempt's LB call.
     // This provides its own grpc_transport_stream_op_batch and other data
@@ -225,9 +231,6 @@ class RetryFilter::LegacyCallData final {
     // Adds batches for pending batches to closures.
     void AddBatchesForPendingBatches(CallCombinerClosureList* closures);
 
-    // Adds whatever batches are needed on this attempt to closures.
-    void AddRetriableBatches(CallCombinerClosureList* closures);
-
     // Returns true if any send op in the batch was not yet started on this
     // attempt.
     bool PendingBatchContainsUnstartedSendOps(PendingBatch* pending);
@@ -244,6 +247,12 @@ class RetryFilter::LegacyCallData final {
     bool ShouldRetry(absl::optional<grpc_status_code> status,
                      absl::optional<Duration> server_pushback_ms);
 
+    // ShouldRetry() for hedged calls: returns true if the call should carry
+    // on without this attempt, on the other attempts still in flight or on
+    // a new one.
+    bool ShouldContinueHedging(absl::optional<grpc_status_code> status,
+                               absl::optional<Duration> server_pushback);
+
     // Abandons the call attempt.  Unrefs any deferred batches.
     void Abandon();
 
@@ -254,6 +263,8 @@ class RetryFilter::LegacyCallData final {
     LegacyCallData* calld_;
     OrphanablePtr<ClientChannelFilter::FilterBasedLoadBalancedCall> lb_call_;
     bool lb_call_committed_ = false;
+    // Value of the grpc-previous-rpc-attempts header.
+    const int num_previous_attempts_;
 
     grpc_closure on_per_attempt_recv_timer_;
     absl::optional<grpc_event_engine::experimental::EventEngine::TaskHandle>
@@ -357,6 +368,25 @@ class RetryFilter::LegacyCallData final {
   void OnRetryTimer();
   static void OnRetryTimerLocked(void* arg, grpc_error_handle /*error*/);
 
+  // Hedging: starts (or restarts) the timer for the next hedged attempt.
+  void StartHedgeTimer(Duration delay);
+  void CancelHedgeTimer();
+  void OnHedgeTimer();
+  static void OnHedgeTimerLocked(void* arg, grpc_error_handle /*error*/);
+  // Returns true if another hedged attempt may be started now.
+  bool CanStartHedgedAttempt() const;
+  // Forgets a hedged attempt that is no longer in flight.
+  void RemoveHedgedAttempt(CallAttempt* call_attempt);
+  // Forgets a hedged attempt that failed and, unless hedging has run out of
+  // attempts, schedules its replacement.
+  void OnHedgedAttemptFailed(CallAttempt* call_attempt,
+                             absl::optional<Duration> server_pushback);
+  // Makes winner the current attempt and cancels all the others.
+  void CancelLosingHedges(CallAttempt* winner);
+  size_t NumAttemptsInFlight() const {
+    return (call_attempt_ != nullptr) + hedged_attempts_.size();
+  }
+
   // Adds a closure to closures to start a transparent retry.
   void AddClosureToStartTransparentRetry(CallCombinerClosureList* closures);
   static void StartTransparentRetry(void* arg, grpc_error_handle error);
@@ -371,6 +401,8 @@ class RetryFilter::LegacyCallData final {
   grpc_polling_entity* pollent_;
   RefCountedPtr<internal::ServerRetryThrottleData> retry_throttle_data_;
   const internal::RetryMethodConfig* retry_policy_ = nullptr;
+  // Set if the call is hedged rather than retried.
+  const internal::HedgingPolicy* hedging_policy_ = nullptr;
   BackOff retry_backoff_;
 
   grpc_slice path_;  // Request path.
@@ -383,10 +415,11 @@ class RetryFilter::LegacyCallData final {
 
   RefCountedPtr<CallStackDestructionBarrier> call_stack_destruction_barrier_;
 
-  // TODO(roth): As part of implementing hedging, we will need to maintain a
-  // list of all pending attempts, so that we can cancel them all if the call
-  // gets cancelled.
+  // The current call attempt.  When hedging, this is the most recently
+  // started one, and hedged_attempts_ holds the earlier ones that are still
+  // in flight; batches from the surface are started on all of them.
   RefCountedPtr<CallAttempt> call_attempt_;
+  absl::InlinedVector<RefCountedPtr<CallAttempt>, 2> hedged_attempts_;
 
   // LB call used when we've committed to a call attempt and the retry
   // state for that attempt is no longer needed.  This provides a fast
@@ -409,10 +442,16 @@ class RetryFilter::LegacyCallData final {
   bool retry_committed_ : 1;
   bool retry_codepath_started_ : 1;
   bool sent_transparent_retry_not_seen_by_server_ : 1;
+  // Set once no more hedged attempts may be started, because of throttling
+  // or server push-back.
+  bool hedging_stopped_ : 1;
   int num_attempts_completed_ = 0;
+  int num_attempts_started_ = 0;
   absl::optional<grpc_event_engine::experimental::EventEngine::TaskHandle>
       retry_timer_handle_;
   grpc_closure retry_closure_;
+  absl::optional<grpc_event_engine::experimental::EventEngine::TaskHandle>
+      hedge_timer_handle_;
 
   // Cached data for retrying send ops.
   // send_initial_metadata
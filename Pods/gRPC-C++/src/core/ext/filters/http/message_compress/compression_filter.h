@@ -99,6 +99,10 @@ class ChannelCompression {
   CompressionAlgorithmSet enabled_compression_algorithms_;
   // Is compression enabled?
   bool enable_compression_;
+  // Messages below this size are not compressed.
+  size_t min_message_size_to_compress_;
+  // Whether to sample messages and skip those that look incompressible.
+  bool skip_incompressible_messages_;
   // Is decompression enabled?
   bool enable_decompression_;
 };
@@ -29,6 +29,7 @@
 #include "src/core/lib/iomgr/closure.h"
 #include "src/core/lib/iomgr/endpoint.h"
 #include "src/core/lib/iomgr/error.h"
+#include "src/core/util/orphanable.h"
 #include "src/core/util/ref_counted_ptr.h"
 #include "src/core/util/sync.h"
 
@@ -38,6 +39,9 @@ class Chttp2Connector : public SubchannelConnector {
  public:
   void Connect(const Args& args, Result* result, grpc_closure* notify) override;
   void Shutdown(grpc_error_handle error) override;
+  OrphanablePtr<SubchannelConnector> Clone() const override {
+    return MakeOrphanable<Chttp2Connector>();
+  }
 
  private:
   void OnHandshakeDone(absl::StatusOr<HandshakerArgs*> result);
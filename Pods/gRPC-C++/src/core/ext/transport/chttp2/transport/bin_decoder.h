@@ -40,6 +40,15 @@ struct grpc_base64_decode_context {
 // than 3. Returns false if decoding is failed.
 bool grpc_base64_decode_partial(struct grpc_base64_decode_context* ctx);
 
+// base64 decode whole groups of 4 characters from the start of input, as many
+// at a time as the CPU's vector unit handles (NEON or SSSE3), stopping before
+// the first group that is not entirely valid base64, which includes padding.
+// Returns the number of input characters decoded, a multiple of 4; output
+// receives 3 bytes for each 4 of them. Returns 0 without a vector unit, so
+// callers always finish with a scalar decoder.
+size_t grpc_chttp2_base64_decode_blocks(const uint8_t* input, size_t length,
+                                        uint8_t* output);
+
 // base64 decode a slice with pad chars. Returns a new slice, does not take
 // ownership of the input. Returns an empty slice if decoding is failed.
 grpc_slice grpc_chttp2_base64_decode(const grpc_slice& input);
@@ -24,6 +24,7 @@
 #include <stddef.h>
 
 #include <cstdint>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -276,6 +277,45 @@ class Compressor<MetadataTrait, SmallSetOfValuesCompressor> {
   SliceIndex index_;
 };
 
+// Decides which metadata without a compression trait of its own goes into the
+// HPACK table. A key/value pair is indexed once it has been sent
+// kHotThreshold times on the connection, or the first time it is sent if its
+// key is pinned. Metadata that is the same on every call, such as
+// credentials, then costs a byte or two per call for as long as it stays in
+// the peer's table.
+class UnknownMetadataIndex {
+ public:
+  void SetPinnedKeys(std::vector<std::string> keys) {
+    pinned_keys_ = std::move(keys);
+  }
+
+  void EmitTo(const Slice& key, const Slice& value, Encoder* encoder);
+
+ private:
+  static constexpr size_t kMaxTrackedValues = 32;
+  static constexpr uint32_t kHotThreshold = 2;
+
+  struct TrackedValue {
+    Slice key;
+    Slice value;
+    bool pinned;
+    uint32_t uses;
+    uint64_t last_used;
+    // Index in the HPACK table, or 0 if never indexed.
+    uint32_t index;
+  };
+
+  bool IsPinned(absl::string_view key) const;
+  // Makes room for one more value, preferring to forget values that are not
+  // yet hot and then the least recently used ones. Returns false if every
+  // tracked value is pinned.
+  bool EvictOne();
+
+  std::vector<std::string> pinned_keys_;
+  std::vector<TrackedValue> values_;
+  uint64_t clock_ = 0;
+};
+
 struct PreviousTimeout {
   Timeout timeout = Timeout::FromDuration(Duration::Zero());
   // Dynamic table index of a previously sent timeout
@@ -342,6 +382,11 @@ class HPackCompressor {
 
   void SetMaxTableSize(uint32_t max_table_size);
   void SetMaxUsableSize(uint32_t max_table_size);
+  // Metadata keys whose values are indexed the first time they are sent,
+  // rather than once they have been seen to repeat.
+  void SetPinnedKeys(std::vector<std::string> keys) {
+    unknown_index_.SetPinnedKeys(std::move(keys));
+  }
 
   uint32_t test_only_table_size() const {
     return table_.test_only_table_size();
@@ -389,6 +434,7 @@ class HPackCompressor {
   bool advertise_table_size_change_ = false;
   HPackEncoderTable table_;
 
+  hpack_encoder_detail::UnknownMetadataIndex unknown_index_;
   grpc_metadata_batch::StatefulCompressor<hpack_encoder_detail::Compressor>
       compression_state_;
 };
@@ -29,10 +29,38 @@
 int grpc_msg_compress(grpc_compression_algorithm algorithm,
                       grpc_slice_buffer* input, grpc_slice_buffer* output);
 
+// Returns 1 if a sample of 'input' has so little redundancy that compressing
+// it would most likely cost CPU time and save nothing; 0 otherwise.
+int grpc_msg_looks_incompressible(const grpc_slice_buffer* input);
+
 // decompress 'input' to 'output' using 'algorithm'.
 // On success, appends slices to output and returns 1.
 // On failure, output is unchanged, and returns 0.
 int grpc_msg_decompress(grpc_compression_algorithm algorithm,
                         grpc_slice_buffer* input, grpc_slice_buffer* output);
 
+// As grpc_msg_decompress(), but stops decompressing and returns -1, leaving
+// output unchanged, as soon as the output would grow beyond
+// 'max_output_size' bytes.
+int grpc_msg_decompress_bounded(grpc_compression_algorithm algorithm,
+                                grpc_slice_buffer* input,
+                                grpc_slice_buffer* output,
+                                size_t max_output_size);
+
+// Receives the decompressed data chunk by chunk, taking ownership of each
+// slice. Returns 0 to stop decompression.
+typedef int (*grpc_msg_decompress_chunk_func)(void* arg, grpc_slice chunk);
+
+// decompress 'input' using 'algorithm', handing the output to 'on_chunk' in
+// slices of at most 'chunk_size' bytes as soon as each one is full, so that
+// only one chunk is buffered here. Returns 1 on success, 0 on failure or if
+// 'on_chunk' stopped it, and -1 as soon as the output would grow beyond
+// 'max_output_size' bytes. Chunks handed out before a failure are valid
+// decompressed data, but not all of it.
+int grpc_msg_decompress_streaming(grpc_compression_algorithm algorithm,
+                                  grpc_slice_buffer* input, size_t chunk_size,
+                                  size_t max_output_size,
+                                  grpc_msg_decompress_chunk_func on_chunk,
+                                  void* arg);
+
 #endif  // GRPC_SRC_CORE_LIB_COMPRESSION_MESSAGE_COMPRESS_H
@@ -95,6 +95,7 @@ extern TraceFlag metadata_query_trace;
 extern TraceFlag op_failure_trace;
 extern TraceFlag orca_client_trace;
 extern TraceFlag outlier_detection_lb_trace;
+extern TraceFlag peak_ewma_lb_trace;
 extern TraceFlag pick_first_trace;
 extern TraceFlag plugin_credentials_trace;
 extern TraceFlag priority_lb_trace;
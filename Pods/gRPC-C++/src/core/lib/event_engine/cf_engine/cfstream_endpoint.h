@@ -100,7 +100,7 @@ class CFStreamEndpointImpl
   LockfreeEvent write_event_;
 };
 
-class CFStreamEndpoint : public EventEngine::Endpoint {
+class CFStreamEndpoint : public CFEngineClientEndpoint {
  public:
   CFStreamEndpoint(std::shared_ptr<CFEventEngine> engine,
                    MemoryAllocator memory_allocator) {
@@ -127,10 +127,10 @@ class CFStreamEndpoint : public EventEngine::Endpoint {
 
  public:
   void Connect(absl::AnyInvocable<void(absl::Status)> on_connect,
-               EventEngine::ResolvedAddress addr) {
+               EventEngine::ResolvedAddress addr) override {
     impl_->Connect(std::move(on_connect), std::move(addr));
   }
-  bool CancelConnect(absl::Status status) {
+  bool CancelConnect(absl::Status status) override {
     return impl_->CancelConnect(std::move(status));
   }
 
@@ -24,6 +24,7 @@
 #include <grpc/event_engine/slice_buffer.h>
 #include <grpc/support/alloc.h>
 
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
 #include <memory>
@@ -168,12 +169,16 @@ class TcpZerocopySendCtx {
  public:
   static constexpr int kDefaultMaxSends = 4;
   static constexpr size_t kDefaultSendBytesThreshold = 16 * 1024;  // 16KB
+  // The threshold never adapts past this, so that a path that copies today can
+  // still be found to pin pages again later.
+  static constexpr size_t kMaxAdaptiveSendBytesThreshold = 1024 * 1024;  // 1MB
 
   explicit TcpZerocopySendCtx(
       bool zerocopy_enabled, int max_sends = kDefaultMaxSends,
       size_t send_bytes_threshold = kDefaultSendBytesThreshold)
       : max_sends_(max_sends),
         free_send_records_size_(max_sends),
+        min_threshold_bytes_(send_bytes_threshold),
         threshold_bytes_(send_bytes_threshold) {
     send_records_ = static_cast<TcpZerocopySendRecord*>(
         gpr_malloc(max_sends * sizeof(*send_records_)));
@@ -294,7 +299,29 @@ class TcpZerocopySendCtx {
   // Only use zerocopy if we are sending at least this many bytes. The
   // additional overhead of reading the error queue for notifications means that
   // zerocopy is not useful for small transfers.
-  size_t ThresholdBytes() const { return threshold_bytes_; }
+  // The threshold starts at the configured value and adapts to what the
+  // kernel reports for each completed send; see NoteCompletion.
+  size_t ThresholdBytes() const {
+    return threshold_bytes_.load(std::memory_order_relaxed);
+  }
+
+  // Expected to be called by handler reading messages from the err queue, once
+  // per zerocopy notification. When the kernel had to copy the data anyway
+  // (e.g. over loopback, or a device without scatter-gather), the send paid
+  // for page pinning and the notification for nothing, so the threshold
+  // doubles. Sends that did go out without copying pull it back towards the
+  // configured value.
+  void NoteCompletion(bool copied) {
+    const size_t threshold = threshold_bytes_.load(std::memory_order_relaxed);
+    size_t next;
+    if (copied) {
+      next = std::min(threshold * 2, std::max(kMaxAdaptiveSendBytesThreshold,
+                                              min_threshold_bytes_));
+    } else {
+      next = threshold - (threshold - min_threshold_bytes_) / 4;
+    }
+    threshold_bytes_.store(next, std::memory_order_relaxed);
+  }
 
   // Expected to be called by handler reading messages from the err queue.
   // It is used to indicate that some optmem memory is now available. It returns
@@ -455,7 +482,8 @@ class TcpZerocopySendCtx {
   uint32_t last_send_ = 0;
   std::atomic<bool> shutdown_{false};
   bool enabled_ = false;
-  size_t threshold_bytes_ = kDefaultSendBytesThreshold;
+  const size_t min_threshold_bytes_;
+  std::atomic<size_t> threshold_bytes_;
   absl::flat_hash_map<uint32_t, TcpZerocopySendRecord*> ctx_lookup_
       ABSL_GUARDED_BY(mu_);
   bool memory_limited_ = false;
@@ -22,6 +22,7 @@
 #include <grpc/support/port_platform.h>
 #include <grpc/support/sync.h>
 #include <grpc/support/time.h>
+#include <stdint.h>
 
 #include "src/core/lib/iomgr/exec_ctx.h"
 #include "src/core/lib/iomgr/iomgr_fwd.h"
@@ -87,6 +88,11 @@ grpc_error_handle grpc_pollset_work(grpc_pollset* pollset,
                                     grpc_pollset_worker** worker,
                                     grpc_core::Timestamp deadline);
 
+// Returns how many times grpc_pollset_work has been called, on any pollset.
+// The backup poller uses it to tell whether pollsets are being polled without
+// its help.
+uint64_t grpc_pollset_work_count(void);
+
 // Break one polling thread out of polling work for this pollset.
 // If specific_worker is non-NULL, then kick that worker.
 grpc_error_handle grpc_pollset_kick(grpc_pollset* pollset,
@@ -66,6 +66,8 @@ struct grpc_tls_credentials_options
   // Returns the CRL Provider
   std::shared_ptr<grpc_core::experimental::CrlProvider> crl_provider() const { return crl_provider_; }
   bool send_client_ca_list() const { return send_client_ca_list_; }
+  bool prefer_hardware_ciphers() const { return prefer_hardware_ciphers_; }
+  const std::string& key_exchange_groups() const { return key_exchange_groups_; }
 
   // Setters for member fields.
   void set_cert_request_type(grpc_ssl_client_certificate_request_type cert_request_type) { cert_request_type_ = cert_request_type; }
@@ -88,6 +90,10 @@ struct grpc_tls_credentials_options
   void set_crl_directory(std::string crl_directory) { crl_directory_ = std::move(crl_directory); }
   void set_crl_provider(std::shared_ptr<grpc_core::experimental::CrlProvider> crl_provider) { crl_provider_ = std::move(crl_provider); }
   void set_send_client_ca_list(bool send_client_ca_list) { send_client_ca_list_ = send_client_ca_list; }
+  // If true, the cipher suites are reordered to prefer AES-GCM when AES hardware acceleration is available and ChaCha20-Poly1305 otherwise. The default value is false.
+  void set_prefer_hardware_ciphers(bool prefer_hardware_ciphers) { prefer_hardware_ciphers_ = prefer_hardware_ciphers; }
+  // A colon-separated list of key exchange groups in order of preference, e.g. "X25519MLKEM768:X25519:P-256". If empty, the TSI default (P-256) is used.
+  void set_key_exchange_groups(std::string key_exchange_groups) { key_exchange_groups_ = std::move(key_exchange_groups); }
 
   bool operator==(const grpc_tls_credentials_options& other) const {
     return cert_request_type_ == other.cert_request_type_ &&
@@ -104,7 +110,9 @@ struct grpc_tls_credentials_options
       tls_session_key_log_file_path_ == other.tls_session_key_log_file_path_ &&
       crl_directory_ == other.crl_directory_ &&
       (crl_provider_ == other.crl_provider_) &&
-      send_client_ca_list_ == other.send_client_ca_list_;
+      send_client_ca_list_ == other.send_client_ca_list_ &&
+      prefer_hardware_ciphers_ == other.prefer_hardware_ciphers_ &&
+      key_exchange_groups_ == other.key_exchange_groups_;
   }
 
   grpc_tls_credentials_options(grpc_tls_credentials_options& other) :
@@ -122,7 +130,9 @@ struct grpc_tls_credentials_options
       tls_session_key_log_file_path_(other.tls_session_key_log_file_path_),
       crl_directory_(other.crl_directory_),
       crl_provider_(other.crl_provider_),
-      send_client_ca_list_(other.send_client_ca_list_)  {}
+      send_client_ca_list_(other.send_client_ca_list_),
+      prefer_hardware_ciphers_(other.prefer_hardware_ciphers_),
+      key_exchange_groups_(other.key_exchange_groups_)  {}
 
  private:
   grpc_ssl_client_certificate_request_type cert_request_type_ = GRPC_SSL_DONT_REQUEST_CLIENT_CERTIFICATE;
@@ -140,6 +150,8 @@ struct grpc_tls_credentials_options
   std::string crl_directory_;
   std::shared_ptr<grpc_core::experimental::CrlProvider> crl_provider_;
   bool send_client_ca_list_ = false;
+  bool prefer_hardware_ciphers_ = false;
+  std::string key_exchange_groups_;
 };
 
 #endif  // GRPC_SRC_CORE_LIB_SECURITY_CREDENTIALS_TLS_GRPC_TLS_CREDENTIALS_OPTIONS_H
@@ -85,7 +85,9 @@ grpc_security_status grpc_ssl_tsi_client_handshaker_factory_init(
     tsi::TlsSessionKeyLoggerCache::TlsSessionKeyLogger* tls_session_key_logger,
     const char* crl_directory,
     std::shared_ptr<grpc_core::experimental::CrlProvider> crl_provider,
-    tsi_ssl_client_handshaker_factory** handshaker_factory);
+    tsi_ssl_client_handshaker_factory** handshaker_factory,
+    bool prefer_hardware_ciphers = false,
+    const char* key_exchange_groups = nullptr);
 
 grpc_security_status grpc_ssl_tsi_server_handshaker_factory_init(
     tsi_ssl_pem_key_cert_pair* key_cert_pairs, size_t num_key_cert_pairs,
@@ -95,7 +97,9 @@ grpc_security_status grpc_ssl_tsi_server_handshaker_factory_init(
     tsi::TlsSessionKeyLoggerCache::TlsSessionKeyLogger* tls_session_key_logger,
     const char* crl_directory, bool send_client_ca_list,
     std::shared_ptr<grpc_core::experimental::CrlProvider> crl_provider,
-    tsi_ssl_server_handshaker_factory** handshaker_factory);
+    tsi_ssl_server_handshaker_factory** handshaker_factory,
+    bool prefer_hardware_ciphers = false,
+    const char* key_exchange_groups = nullptr);
 
 // Free the memory occupied by key cert pairs.
 void grpc_tsi_ssl_pem_key_cert_pairs_destroy(tsi_ssl_pem_key_cert_pair* kp,
@@ -143,6 +147,22 @@ class DefaultSslRootStore {
   static grpc_slice default_pem_root_certs_;
 };
 
+// Parses each distinct set of PEM root certificates once per process, so that
+// channels created with the same custom roots share one root store instead of
+// parsing the bundle again for every SSL context.
+class SslRootStoreCache {
+ public:
+  // Gets the root store for pem_root_certs. Returns nullptr if the PEM could
+  // not be parsed or the cache is full, in which case callers parse the PEM
+  // themselves. The returned store lives until the process exits.
+  static const tsi_ssl_root_certs_store* GetRootStore(
+      absl::string_view pem_root_certs);
+
+ private:
+  // Construct me not!
+  SslRootStoreCache();
+};
+
 class PemKeyCertPair {
  public:
   PemKeyCertPair(absl::string_view private_key, absl::string_view cert_chain)
@@ -24,6 +24,7 @@
 #include <memory>
 #include <string>
 
+#include "absl/strings/string_view.h"
 #include "src/core/lib/slice/slice.h"
 
 // Copy the first n bytes of src into memory pointed to by dst.
@@ -36,6 +37,12 @@ void grpc_slice_buffer_move_first_no_inline(grpc_slice_buffer* src, size_t n,
 void grpc_slice_buffer_trim_end_no_inline(grpc_slice_buffer* sb, size_t n,
                                           grpc_slice_buffer* garbage);
 
+// Like grpc_slice_buffer_add(), but a slice shorter than a few hundred bytes
+// is copied into a pooled 4KB block at the end of sb, together with the small
+// slices added after it. This keeps fragmented input from turning into long
+// chains of tiny slices.
+void grpc_slice_buffer_add_coalesced(grpc_slice_buffer* sb, grpc_slice s);
+
 namespace grpc_core {
 
 /// A slice buffer holds the memory for a collection of slices.
@@ -157,6 +164,11 @@ class SliceBuffer {
   /// Concatenate all slices and return the resulting slice.
   Slice JoinIntoSlice() const;
 
+  /// Returns the contents as one contiguous range. This is free when they are
+  /// already in one slice; otherwise they are first joined into a single
+  /// slice, which then replaces the others.
+  absl::string_view ContiguousView();
+
   // Return a copy of the slice buffer
   SliceBuffer Copy() const {
     SliceBuffer copy;
@@ -64,6 +64,12 @@ struct grpc_slice_refcount {
   // instance, no other instance could be created during this call.
   bool IsUnique() const { return ref_.load(std::memory_order_relaxed) == 1; }
 
+  // Was this refcount created with destroyer_fn? Lets slice implementations
+  // recognize their own slices.
+  bool HasDestroyer(DestroyerFn destroyer_fn) const {
+    return destroyer_fn_ == destroyer_fn;
+  }
+
  private:
   std::atomic<size_t> ref_{1};
   DestroyerFn destroyer_fn_ = nullptr;
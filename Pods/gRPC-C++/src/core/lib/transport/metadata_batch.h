@@ -36,6 +36,7 @@
 #include "absl/strings/numbers.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "src/core/lib/compression/compression_internal.h"
 #include "src/core/lib/experiments/experiments.h"
 #include "src/core/lib/promise/poll.h"
@@ -571,6 +572,11 @@ struct GrpcTarPit {
 
 namespace metadata_detail {
 
+// Returns a slice of an interned key equal to \a key, or a copy of \a key if
+// there is none. Slices of interned keys need neither an allocation nor a
+// refcount.
+Slice InternedKeyOrCopy(absl::string_view key);
+
 // Build a key/value formatted debug string.
 // Output looks like 'key1: value1, key2: value2'
 // The string is expected to be readable, but not necessarily parsable.
@@ -690,7 +696,7 @@ class ParseHelper {
       absl::string_view key) {
     return ParsedMetadata<Container>(
         typename ParsedMetadata<Container>::FromSlicePair{},
-        Slice::FromCopiedString(key),
+        InternedKeyOrCopy(key),
         will_keep_past_request_lifetime_ ? value_.TakeUniquelyOwned()
                                          : std::move(value_),
         transport_size_);
@@ -1169,6 +1175,13 @@ struct StatefulCompressor<Factory> {};
 
 }  // namespace metadata_detail
 
+// Interns \a keys, so that metadata with these keys that has no trait of its
+// own can be added to a batch without copying its key. Meant for the handful
+// of application-defined keys sent on most calls: interned keys are never
+// freed. Called with GRPC_ARG_INTERNED_METADATA_KEYS when a channel is
+// created. Thread-safe.
+void InternMetadataKeys(absl::Span<const absl::string_view> keys);
+
 // Helper function for encoders
 // Given a metadata trait, convert the value to a slice.
 template <typename Which>
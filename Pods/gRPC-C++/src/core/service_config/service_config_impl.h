@@ -29,6 +29,7 @@
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 #include "src/core/lib/channel/channel_args.h"
 #include "src/core/lib/slice/slice_internal.h"
 #include "src/core/service_config/service_config.h"
@@ -100,6 +101,8 @@ class ServiceConfigImpl final : public ServiceConfig {
  private:
   std::string json_string_;
   Json json_;
+  // The args this config is cached under, if it was created from a string.
+  absl::optional<ChannelArgs> cache_key_args_;
 
   ServiceConfigParser::ParsedConfigVector parsed_global_configs_;
   // A map from the method name to the parsed config vector. Note that we are
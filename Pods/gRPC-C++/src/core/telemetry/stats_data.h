@@ -263,6 +263,8 @@ struct GlobalStats {
     kWorkSerializerWorkTimeMs,
     kWorkSerializerWorkTimePerItemMs,
     kWorkSerializerItemsPerRun,
+    kWorkSerializerQueueLatencyMs,
+    kMutexContentionWaitUs,
     kChaoticGoodSendmsgsPerWriteControl,
     kChaoticGoodRecvmsgsPerReadControl,
     kChaoticGoodSendmsgsPerWriteData,
@@ -353,6 +355,8 @@ struct GlobalStats {
   Histogram_100000_20 work_serializer_work_time_ms;
   Histogram_100000_20 work_serializer_work_time_per_item_ms;
   Histogram_10000_20 work_serializer_items_per_run;
+  Histogram_100000_20 work_serializer_queue_latency_ms;
+  Histogram_100000_20 mutex_contention_wait_us;
   Histogram_100_20 chaotic_good_sendmsgs_per_write_control;
   Histogram_100_20 chaotic_good_recvmsgs_per_read_control;
   Histogram_100_20 chaotic_good_sendmsgs_per_write_data;
@@ -575,6 +579,12 @@ class GlobalStatsCollector {
   void IncrementWorkSerializerItemsPerRun(int value) {
     data_.this_cpu().work_serializer_items_per_run.Increment(value);
   }
+  void IncrementWorkSerializerQueueLatencyMs(int value) {
+    data_.this_cpu().work_serializer_queue_latency_ms.Increment(value);
+  }
+  void IncrementMutexContentionWaitUs(int value) {
+    data_.this_cpu().mutex_contention_wait_us.Increment(value);
+  }
   void IncrementChaoticGoodSendmsgsPerWriteControl(int value) {
     data_.this_cpu().chaotic_good_sendmsgs_per_write_control.Increment(value);
   }
@@ -683,6 +693,8 @@ class GlobalStatsCollector {
     HistogramCollector_100000_20 work_serializer_work_time_ms;
     HistogramCollector_100000_20 work_serializer_work_time_per_item_ms;
     HistogramCollector_10000_20 work_serializer_items_per_run;
+    HistogramCollector_100000_20 work_serializer_queue_latency_ms;
+    HistogramCollector_100000_20 mutex_contention_wait_us;
     HistogramCollector_100_20 chaotic_good_sendmsgs_per_write_control;
     HistogramCollector_100_20 chaotic_good_recvmsgs_per_read_control;
     HistogramCollector_100_20 chaotic_good_sendmsgs_per_write_data;
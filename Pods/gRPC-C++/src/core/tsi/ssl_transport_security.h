@@ -19,6 +19,7 @@
 #ifndef GRPC_SRC_CORE_TSI_SSL_TRANSPORT_SECURITY_H
 #define GRPC_SRC_CORE_TSI_SSL_TRANSPORT_SECURITY_H
 
+#include <grpc/credentials.h>
 #include <grpc/grpc_crl_provider.h>
 #include <grpc/grpc_security_constants.h>
 #include <grpc/support/port_platform.h>
@@ -77,6 +78,10 @@ typedef struct tsi_ssl_session_cache tsi_ssl_session_cache;
 // Create LRU cache for SSL sessions with \a capacity.
 tsi_ssl_session_cache* tsi_ssl_session_cache_create_lru(size_t capacity);
 
+// Create LRU cache for SSL sessions with \a capacity, backed by \a store.
+tsi_ssl_session_cache* tsi_ssl_session_cache_create_lru_with_store(
+    size_t capacity, grpc_ssl_session_store store);
+
 // Increment reference counter of \a cache.
 void tsi_ssl_session_cache_ref(tsi_ssl_session_cache* cache);
 
@@ -194,6 +199,18 @@ struct tsi_ssl_client_handshaker_options {
   // options as a shared_ptr.
   std::shared_ptr<grpc_core::experimental::CrlProvider> crl_provider;
 
+  // If true, cipher_suites is reordered for this machine: AES-GCM suites are
+  // preferred when the SSL library has AES hardware acceleration, and
+  // ChaCha20-Poly1305 suites otherwise.
+  bool prefer_hardware_ciphers;
+
+  // key_exchange_groups contains an optional colon-separated list of the
+  // key exchange groups that the client offers, in order of preference, e.g.
+  // "X25519MLKEM768:X25519:P-256". If not set, only P-256 is offered. With
+  // BoringSSL, the key shares the client sends first are generated ahead of
+  // handshakes on a background thread, for X25519 and X25519MLKEM768.
+  const char* key_exchange_groups;
+
   tsi_ssl_client_handshaker_options()
       : pem_key_cert_pair(nullptr),
         pem_root_certs(nullptr),
@@ -206,7 +223,9 @@ struct tsi_ssl_client_handshaker_options {
         skip_server_certificate_verification(false),
         min_tls_version(tsi_tls_version::TSI_TLS1_2),
         max_tls_version(tsi_tls_version::TSI_TLS1_3),
-        crl_directory(nullptr) {}
+        crl_directory(nullptr),
+        prefer_hardware_ciphers(false),
+        key_exchange_groups(nullptr) {}
 };
 
 // Creates a client handshaker factory.
@@ -359,6 +378,15 @@ struct tsi_ssl_server_handshaker_options {
   // will be unusable.
   bool send_client_ca_list;
 
+  // If true, cipher_suites is reordered for this machine, as for
+  // tsi_ssl_client_handshaker_options.
+  bool prefer_hardware_ciphers;
+
+  // key_exchange_groups contains an optional colon-separated list of the
+  // key exchange groups that the server accepts, in order of preference, as
+  // for tsi_ssl_client_handshaker_options.
+  const char* key_exchange_groups;
+
   tsi_ssl_server_handshaker_options()
       : pem_key_cert_pairs(nullptr),
         num_key_cert_pairs(0),
@@ -373,7 +401,9 @@ struct tsi_ssl_server_handshaker_options {
         max_tls_version(tsi_tls_version::TSI_TLS1_3),
         key_logger(nullptr),
         crl_directory(nullptr),
-        send_client_ca_list(true) {}
+        send_client_ca_list(true),
+        prefer_hardware_ciphers(false),
+        key_exchange_groups(nullptr) {}
 };
 
 // Creates a server handshaker factory.
@@ -398,6 +428,12 @@ tsi_result tsi_ssl_server_handshaker_factory_create_handshaker(
     tsi_ssl_server_handshaker_factory* factory, size_t network_bio_buf_size,
     size_t ssl_bio_buf_size, tsi_handshaker** handshaker);
 
+// Returns the ssl_bio_buf_size to create a handshaker with so that its frame
+// protector can use frames of up to max_frame_size bytes. Frames larger than
+// one TLS record let a single SSL_write seal several records at once. Returns
+// 0, the default size, if max_frame_size fits in one record.
+size_t tsi_ssl_bio_buf_size_for_max_frame_size(size_t max_frame_size);
+
 // Decrements reference count of the handshaker factory. Handshaker factory will
 // be destroyed once no references exist.
 void tsi_ssl_server_handshaker_factory_unref(
@@ -0,0 +1,86 @@
+// Copyright 2024 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GRPC_SRC_CORE_UTIL_ALLOCATION_STATS_H
+#define GRPC_SRC_CORE_UTIL_ALLOCATION_STATS_H
+
+#include <grpc/support/port_platform.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+// Process wide accounting of the memory held by gRPC's allocators, by
+// subsystem, to show where arena and pooling work would pay off.
+//
+// The accounting is compiled out unless gRPC is built with
+// -DGRPC_ENABLE_ALLOCATION_STATS, in which case the recording functions are
+// empty inlines and the counters stay at zero.
+
+namespace grpc_core {
+
+enum class AllocationSubsystem : uint8_t {
+  // Heap memory of call and channel arenas: initial zones and overflow zones.
+  kArena,
+  // Bytes reserved from resource quotas through MemoryAllocators (slices,
+  // transport buffers and arenas), whether or not they are in use.
+  kMemoryAllocator,
+  kCount,
+};
+
+struct AllocationCounters {
+  // Bytes held now, and the most held at any time since the process started.
+  int64_t live_bytes = 0;
+  int64_t peak_bytes = 0;
+  // Number of allocations (or reservations) held now, and made in total.
+  // Reservations may be released in several parts, so live_allocations is
+  // only indicative for kMemoryAllocator.
+  int64_t live_allocations = 0;
+  int64_t total_allocations = 0;
+};
+
+#ifdef GRPC_ENABLE_ALLOCATION_STATS
+
+namespace allocation_stats_detail {
+void Record(AllocationSubsystem subsystem, int64_t bytes, int64_t count);
+}  // namespace allocation_stats_detail
+
+inline void RecordAllocation(AllocationSubsystem subsystem, size_t bytes) {
+  allocation_stats_detail::Record(subsystem, static_cast<int64_t>(bytes), 1);
+}
+// Records that `count` allocations totalling `bytes` were freed.
+inline void RecordFree(AllocationSubsystem subsystem, size_t bytes,
+                       size_t count = 1) {
+  allocation_stats_detail::Record(subsystem, -static_cast<int64_t>(bytes),
+                                  -static_cast<int64_t>(count));
+}
+
+#else  // !GRPC_ENABLE_ALLOCATION_STATS
+
+inline void RecordAllocation(AllocationSubsystem, size_t) {}
+inline void RecordFree(AllocationSubsystem, size_t, size_t = 1) {}
+
+#endif  // GRPC_ENABLE_ALLOCATION_STATS
+
+// Returns true if the accounting is compiled in.
+bool AllocationStatsAvailable();
+
+AllocationCounters GetAllocationCounters(AllocationSubsystem subsystem);
+
+// Formats the counters of every subsystem, one per line.
+std::string AllocationStatsReport();
+
+}  // namespace grpc_core
+
+#endif  // GRPC_SRC_CORE_UTIL_ALLOCATION_STATS_H
@@ -17,6 +17,24 @@
 
 #include <grpc/support/port_platform.h>
 
+#if defined(GRPC_ENABLE_LATENT_SEE) || defined(GRPC_ENABLE_LATENT_SEE_RING)
+#include <cstdint>
+
+namespace grpc_core {
+namespace latent_see {
+
+struct Metadata {
+  const char* file;
+  int line;
+  const char* name;
+};
+
+enum class EventType : uint8_t { kBegin, kEnd, kFlowStart, kFlowEnd, kMark };
+
+}  // namespace latent_see
+}  // namespace grpc_core
+#endif
+
 #ifdef GRPC_ENABLE_LATENT_SEE
 #include <sys/syscall.h>
 #include <unistd.h>
@@ -44,14 +62,6 @@
 namespace grpc_core {
 namespace latent_see {
 
-struct Metadata {
-  const char* file;
-  int line;
-  const char* name;
-};
-
-enum class EventType : uint8_t { kBegin, kEnd, kFlowStart, kFlowEnd, kMark };
-
 // A bin collects all events that occur within a parent scope.
 struct Bin {
   struct Event {
@@ -274,6 +284,149 @@ GPR_ATTRIBUTE_ALWAYS_INLINE_FUNCTION auto Promise(const Metadata* md_poll,
 
 }  // namespace latent_see
 }  // namespace grpc_core
+#elif defined(GRPC_ENABLE_LATENT_SEE_RING)
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace grpc_core {
+namespace latent_see {
+
+// Production mode. Where the full mode keeps every event until it is
+// flushed, this mode keeps only the most recent events of each thread, in a
+// fixed-size ring that overwrites the oldest. Memory stays bounded, and the
+// recent past can be exported at any time, e.g. when a stall is detected.
+// To keep the cost low, only one in SetSampleEvery() outermost parent scopes
+// is recorded, together with everything nested in it.
+class RingLog {
+ public:
+  // Per thread. A thread that exits hands its ring to the next new thread.
+  static constexpr size_t kEventsPerThread = 2048;
+  static constexpr uint32_t kDefaultSampleEvery = 8;
+
+  GPR_ATTRIBUTE_ALWAYS_INLINE_FUNCTION static void EnterParentScope() {
+    if (parent_depth_++ > 0) return;
+    recording_ =
+        ++sample_counter_ % sample_every_.load(std::memory_order_relaxed) == 0;
+  }
+  GPR_ATTRIBUTE_ALWAYS_INLINE_FUNCTION static void ExitParentScope() {
+    if (--parent_depth_ == 0) recording_ = false;
+  }
+  GPR_ATTRIBUTE_ALWAYS_INLINE_FUNCTION static bool recording() {
+    return recording_;
+  }
+
+  // Records an event in this thread's ring.
+  static void Append(const Metadata* metadata, EventType type, uint64_t id);
+
+  // Records one in sample_every outermost parent scopes; 1 records all.
+  static void SetSampleEvery(uint32_t sample_every);
+
+  // Returns the events recorded in the last window, in Chrome trace format.
+  // Can be called from any thread, without pausing the threads recording.
+  static std::string GenerateJson(std::chrono::nanoseconds window);
+
+ private:
+  static thread_local int parent_depth_;
+  static thread_local bool recording_;
+  static thread_local uint32_t sample_counter_;
+  static std::atomic<uint32_t> sample_every_;
+};
+
+template <bool kParent>
+class Scope {
+ public:
+  GPR_ATTRIBUTE_ALWAYS_INLINE_FUNCTION explicit Scope(const Metadata* metadata)
+      : metadata_(metadata) {
+    if (kParent) RingLog::EnterParentScope();
+    if (RingLog::recording()) {
+      RingLog::Append(metadata_, EventType::kBegin, 0);
+    }
+  }
+  GPR_ATTRIBUTE_ALWAYS_INLINE_FUNCTION ~Scope() {
+    if (RingLog::recording()) RingLog::Append(metadata_, EventType::kEnd, 0);
+    if (kParent) RingLog::ExitParentScope();
+  }
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+ private:
+  const Metadata* const metadata_;
+};
+
+using ParentScope = Scope<true>;
+using InnerScope = Scope<false>;
+
+// A flow starts only in a recorded scope, but once started its end is
+// recorded wherever it happens, so that sampled flows are complete.
+class Flow {
+ public:
+  GPR_ATTRIBUTE_ALWAYS_INLINE_FUNCTION Flow() : metadata_(nullptr) {}
+  GPR_ATTRIBUTE_ALWAYS_INLINE_FUNCTION explicit Flow(const Metadata* metadata)
+      : metadata_(nullptr) {
+    Begin(metadata);
+  }
+  GPR_ATTRIBUTE_ALWAYS_INLINE_FUNCTION ~Flow() { End(); }
+
+  Flow(const Flow&) = delete;
+  Flow& operator=(const Flow&) = delete;
+  Flow(Flow&& other) noexcept
+      : metadata_(std::exchange(other.metadata_, nullptr)), id_(other.id_) {}
+  Flow& operator=(Flow&& other) noexcept {
+    End();
+    metadata_ = std::exchange(other.metadata_, nullptr);
+    id_ = other.id_;
+    return *this;
+  }
+
+  GPR_ATTRIBUTE_ALWAYS_INLINE_FUNCTION bool is_active() const {
+    return metadata_ != nullptr;
+  }
+  GPR_ATTRIBUTE_ALWAYS_INLINE_FUNCTION void End() {
+    if (metadata_ == nullptr) return;
+    RingLog::Append(metadata_, EventType::kFlowEnd, id_);
+    metadata_ = nullptr;
+  }
+  GPR_ATTRIBUTE_ALWAYS_INLINE_FUNCTION void Begin(const Metadata* metadata) {
+    End();
+    if (metadata == nullptr || !RingLog::recording()) return;
+    metadata_ = metadata;
+    id_ = next_flow_id_.fetch_add(1, std::memory_order_relaxed);
+    RingLog::Append(metadata_, EventType::kFlowStart, id_);
+  }
+
+ private:
+  const Metadata* metadata_;
+  uint64_t id_ = 0;
+  static std::atomic<uint64_t> next_flow_id_;
+};
+
+GPR_ATTRIBUTE_ALWAYS_INLINE_FUNCTION inline void Mark(const Metadata* md) {
+  if (RingLog::recording()) RingLog::Append(md, EventType::kMark, 0);
+}
+
+template <typename P>
+GPR_ATTRIBUTE_ALWAYS_INLINE_FUNCTION auto Promise(const Metadata* md_poll,
+                                                  const Metadata* md_flow,
+                                                  P promise) {
+  return [md_poll, md_flow, promise = std::move(promise),
+          flow = Flow(md_flow)]() mutable {
+    InnerScope scope(md_poll);
+    flow.End();
+    auto r = promise();
+    flow.Begin(md_flow);
+    return r;
+  };
+}
+
+}  // namespace latent_see
+}  // namespace grpc_core
+#endif
+
+#if defined(GRPC_ENABLE_LATENT_SEE) || defined(GRPC_ENABLE_LATENT_SEE_RING)
 #define GRPC_LATENT_SEE_METADATA(name)                                     \
   []() {                                                                   \
     static grpc_core::latent_see::Metadata metadata = {__FILE__, __LINE__, \
@@ -300,7 +453,7 @@ GPR_ATTRIBUTE_ALWAYS_INLINE_FUNCTION auto Promise(const Metadata* md_poll,
 #define GRPC_LATENT_SEE_PROMISE(name, promise)                           \
   grpc_core::latent_see::Promise(GRPC_LATENT_SEE_METADATA("Poll:" name), \
                                  GRPC_LATENT_SEE_METADATA(name), promise)
-#else  // !def(GRPC_ENABLE_LATENT_SEE)
+#else  // !def(GRPC_ENABLE_LATENT_SEE) && !def(GRPC_ENABLE_LATENT_SEE_RING)
 namespace grpc_core {
 namespace latent_see {
 struct Metadata {};
@@ -329,6 +482,6 @@ struct InnerScope {
   do {                             \
   } while (0)
 #define GRPC_LATENT_SEE_PROMISE(name, promise) promise
-#endif  // GRPC_ENABLE_LATENT_SEE
+#endif
 
 #endif  // GRPC_SRC_CORE_UTIL_LATENT_SEE_H
@@ -0,0 +1,45 @@
+//
+//
+// Copyright 2024 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//
+
+#include <grpcpp/support/mutex_contention.h>
+
+#include <string>
+
+#include "src/core/util/mutex_contention.h"
+
+namespace grpc {
+namespace experimental {
+
+void EnableMutexContentionProfiling(uint32_t sample_every) {
+  grpc_core::EnableMutexContentionProfiling(sample_every);
+}
+
+bool NameMutexContentionSite(const void* mutex, const char* site) {
+  return grpc_core::NameMutexContentionSite(mutex, site);
+}
+
+void ForgetMutexContentionSite(const void* mutex) {
+  grpc_core::ForgetMutexContentionSite(mutex);
+}
+
+std::string MutexContentionReport() {
+  return grpc_core::MutexContentionReport();
+}
+
+}  // namespace experimental
+}  // namespace grpc
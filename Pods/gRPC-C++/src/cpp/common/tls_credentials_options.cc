@@ -115,6 +115,22 @@ void TlsCredentialsOptions::set_max_tls_version(grpc_tls_version tls_version) {
   grpc_tls_credentials_options_set_max_tls_version(options, tls_version);
 }
 
+void TlsCredentialsOptions::set_prefer_hardware_ciphers(
+    bool prefer_hardware_ciphers) {
+  grpc_tls_credentials_options* options = mutable_c_credentials_options();
+  CHECK_NE(options, nullptr);
+  grpc_tls_credentials_options_set_prefer_hardware_ciphers(
+      options, prefer_hardware_ciphers);
+}
+
+void TlsCredentialsOptions::set_key_exchange_groups(
+    const std::string& key_exchange_groups) {
+  grpc_tls_credentials_options* options = mutable_c_credentials_options();
+  CHECK_NE(options, nullptr);
+  grpc_tls_credentials_options_set_key_exchange_groups(
+      options, key_exchange_groups.c_str());
+}
+
 grpc_tls_credentials_options* TlsCredentialsOptions::c_credentials_options()
     const {
   return grpc_tls_credentials_options_copy(c_credentials_options_);
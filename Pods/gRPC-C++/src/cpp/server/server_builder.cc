@@ -211,6 +211,9 @@ ServerBuilder& ServerBuilder::SetSyncServerOption(
     case CQ_TIMEOUT_MSEC:
       sync_server_settings_.cq_timeout_msec = val;
       break;
+    case RUN_ON_EVENT_ENGINE:
+      sync_server_settings_.run_on_event_engine = val != 0;
+      break;
   }
   return *this;
 }
@@ -370,8 +373,14 @@ std::unique_ptr<grpc::Server> ServerBuilder::BuildAndStart() {
   }
 
   const bool is_hybrid_server = has_sync_methods && has_frequently_polled_cqs;
+  // Sync methods are then served from the callback CQ, as callback methods.
+  const bool sync_on_event_engine =
+      has_sync_methods && sync_server_settings_.run_on_event_engine;
+  if (sync_on_event_engine) {
+    has_frequently_polled_cqs = true;
+  }
 
-  if (has_sync_methods) {
+  if (has_sync_methods && !sync_on_event_engine) {
     grpc_cq_polling_type polling_type =
         is_hybrid_server ? GRPC_CQ_NON_POLLING : GRPC_CQ_DEFAULT_POLLING;
 
@@ -385,7 +394,9 @@ std::unique_ptr<grpc::Server> ServerBuilder::BuildAndStart() {
   // TODO(vjpai): Add a section here for plugins once they can support callback
   // methods
 
-  if (has_sync_methods) {
+  if (sync_on_event_engine) {
+    VLOG(2) << "Synchronous server running handlers on the EventEngine.";
+  } else if (has_sync_methods) {
     // This is a Sync server
     VLOG(2) << "Synchronous server. Num CQs: " << sync_server_settings_.num_cqs
             << ", Min pollers: " << sync_server_settings_.min_pollers
@@ -401,7 +412,8 @@ std::unique_ptr<grpc::Server> ServerBuilder::BuildAndStart() {
       &args, sync_server_cqs, sync_server_settings_.min_pollers,
       sync_server_settings_.max_pollers, sync_server_settings_.cq_timeout_msec,
       std::move(acceptors_), server_config_fetcher_, resource_quota_,
-      std::move(interceptor_creators_), server_metric_recorder_));
+      std::move(interceptor_creators_), server_metric_recorder_,
+      sync_on_event_engine));
 
   ServerInitializer* initializer = server->initializer();
 
@@ -415,7 +427,8 @@ std::unique_ptr<grpc::Server> ServerBuilder::BuildAndStart() {
     has_frequently_polled_cqs = true;
   }
 
-  if (has_callback_methods || callback_generic_service_ != nullptr) {
+  if (has_callback_methods || callback_generic_service_ != nullptr ||
+      sync_on_event_engine) {
     auto* cq = server->CallbackCQ();
     grpc_server_register_completion_queue(server->server_, cq->cq(), nullptr);
   }
@@ -389,6 +389,16 @@ class Server::SyncRequest final : public grpc::internal::CompletionQueueTag {
     data->details = call_details_;
   }
 
+  // For servers that run sync handlers on the EventEngine: the request is
+  // delivered to the callback CQ, which runs the handler from callback_tag_.
+  SyncRequest(Server* server, grpc::internal::RpcServiceMethod* method,
+              grpc::CompletionQueue* callback_cq,
+              grpc_core::Server::RegisteredCallAllocation* data)
+      : SyncRequest(server, method, data) {
+    data->tag = static_cast<void*>(&callback_tag_);
+    data->cq = callback_cq->cq();
+  }
+
   ~SyncRequest() override {
     // The destructor should only cleanup those objects created in the
     // constructor, since some paths may or may not actually go through the
@@ -514,6 +524,32 @@ class Server::SyncRequest final : public grpc::internal::CompletionQueueTag {
     data->cq = cq_.cq();
   }
 
+  class CallbackTag : public grpc_completion_queue_functor {
+   public:
+    explicit CallbackTag(SyncRequest* req) : req_(req) {
+      functor_run = &CallbackTag::StaticRun;
+      // The handler may block, so it must not run inline on the thread that
+      // completed the request.
+      inlineable = false;
+    }
+
+   private:
+    static void StaticRun(grpc_completion_queue_functor* cb, int ok) {
+      static_cast<CallbackTag*>(cb)->Run(static_cast<bool>(ok));
+    }
+    void Run(bool ok) {
+      void* ignored = req_;
+      // On failure, FinalizeResult deletes the request.
+      if (req_->FinalizeResult(&ignored, &ok)) {
+        // There are no polling threads to run out of, so the resource
+        // exhausted handler is never needed.
+        req_->Run(req_->server_->global_callbacks_, /*resources=*/true);
+      }
+    }
+
+    SyncRequest* const req_;
+  };
+
   Server* const server_;
   grpc::internal::RpcServiceMethod* const method_;
   const bool has_request_payload_;
@@ -540,6 +576,7 @@ class Server::SyncRequest final : public grpc::internal::CompletionQueueTag {
 
   grpc_core::ManualConstructor<ServerContextWrapper> ctx_;
   grpc_core::ManualConstructor<internal::Call> wrapped_call_;
+  CallbackTag callback_tag_{this};
 };
 
 template <class ServerContextType>
@@ -896,11 +933,13 @@ Server::Server(
     std::vector<
         std::unique_ptr<grpc::experimental::ServerInterceptorFactoryInterface>>
         interceptor_creators,
-    experimental::ServerMetricRecorder* server_metric_recorder)
+    experimental::ServerMetricRecorder* server_metric_recorder,
+    bool sync_handlers_on_event_engine)
     : acceptors_(std::move(acceptors)),
       interceptor_creators_(std::move(interceptor_creators)),
       max_receive_message_size_(INT_MIN),
       sync_server_cqs_(std::move(sync_server_cqs)),
+      sync_handlers_on_event_engine_(sync_handlers_on_event_engine),
       started_(false),
       shutdown_(false),
       shutdown_notified_(false),
@@ -1062,6 +1101,20 @@ bool Server::RegisterService(const std::string* addr, grpc::Service* service) {
 
     if (method->handler() == nullptr) {  // Async method without handler
       method->set_server_tag(method_registration_tag);
+    } else if (method->api_type() ==
+                   grpc::internal::RpcServiceMethod::ApiType::SYNC &&
+               sync_handlers_on_event_engine_) {
+      // Served like a callback method, so unknown methods are too.
+      has_callback_methods_ = true;
+      grpc::internal::RpcServiceMethod* method_value = method.get();
+      grpc::CompletionQueue* cq = CallbackCQ();
+      grpc_server_register_completion_queue(server_, cq->cq(), nullptr);
+      grpc_core::Server::FromC(server_)->SetRegisteredMethodAllocator(
+          cq->cq(), method_registration_tag, [this, cq, method_value] {
+            grpc_core::Server::RegisteredCallAllocation result;
+            new SyncRequest(this, method_value, cq, &result);
+            return result;
+          });
     } else if (method->api_type() ==
                grpc::internal::RpcServiceMethod::ApiType::SYNC) {
       for (const auto& value : sync_req_mgrs_) {
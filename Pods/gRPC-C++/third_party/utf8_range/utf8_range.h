@@ -15,6 +15,15 @@ int utf8_range_IsValid(const char* data, size_t len);
 // structurally valid UTF-8.
 size_t utf8_range_ValidPrefix(const char* data, size_t len);
 
+typedef struct {
+  const char* data;
+  size_t len;
+} utf8_range_Span;
+
+// Returns 1 if every span is a valid UTF-8 sequence, otherwise 0. This is
+// faster than checking the spans one by one when most of them are ASCII.
+int utf8_range_IsValidSpans(const utf8_range_Span* spans, size_t count);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
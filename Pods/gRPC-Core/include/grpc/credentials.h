@@ -924,6 +924,30 @@ GRPCAPI void grpc_tls_credentials_options_set_min_tls_version(
 GRPCAPI void grpc_tls_credentials_options_set_max_tls_version(
     grpc_tls_credentials_options* options, grpc_tls_version max_tls_version);
 
+/**
+ * EXPERIMENTAL API - Subject to change
+ *
+ * Sets whether the cipher suites should be ordered by the hardware
+ * capabilities of this machine. If true, AES-GCM suites are preferred when the
+ * SSL library has AES acceleration, and ChaCha20-Poly1305 suites otherwise, so
+ * that devices without crypto extensions negotiate the faster cipher. If not
+ * set, the configured cipher suite order is used as is.
+ */
+GRPCAPI void grpc_tls_credentials_options_set_prefer_hardware_ciphers(
+    grpc_tls_credentials_options* options, int prefer_hardware_ciphers);
+
+/**
+ * EXPERIMENTAL API - Subject to change
+ *
+ * Sets the key exchange groups to use, as a colon-separated list in order of
+ * preference, e.g. "X25519MLKEM768:X25519:P-256" for a post-quantum hybrid key
+ * exchange with classical fallbacks. If not set, only P-256 is used. With
+ * BoringSSL, clients generate the key shares of their first ClientHello ahead
+ * of the handshake, off the handshake path.
+ */
+GRPCAPI void grpc_tls_credentials_options_set_key_exchange_groups(
+    grpc_tls_credentials_options* options, const char* key_exchange_groups);
+
 /**
  * EXPERIMENTAL API - Subject to change
  *
@@ -1063,6 +1087,28 @@ typedef struct grpc_ssl_session_cache grpc_ssl_session_cache;
 GRPCAPI grpc_ssl_session_cache* grpc_ssl_session_cache_create_lru(
     size_t capacity);
 
+/** Storage for client-side SSL sessions that outlives the process, so that
+    sessions can be resumed after a restart. Sessions are passed serialized,
+    and hold secrets: the application must store them where only it can read
+    them. The functions may be called from any thread, and may block. */
+typedef struct {
+  /** Returns the session stored for \a key, or an empty slice if there is
+      none. Ownership of the returned slice passes to the caller. */
+  grpc_slice (*load)(void* user_data, const char* key);
+  /** Stores \a session for \a key, replacing any session stored before.
+      \a session is only valid for the duration of the call. */
+  void (*store)(void* user_data, const char* key, grpc_slice session);
+  /** Called once when the cache is destroyed. May be NULL. */
+  void (*destroy)(void* user_data);
+  void* user_data;
+} grpc_ssl_session_store;
+
+/** Create LRU cache for client-side SSL sessions with the given capacity, as
+    grpc_ssl_session_cache_create_lru does. Sessions are also written to
+    \a store, which is consulted when a session is not in the cache. */
+GRPCAPI grpc_ssl_session_cache* grpc_ssl_session_cache_create_lru_with_store(
+    size_t capacity, grpc_ssl_session_store store);
+
 /** Destroy SSL session cache. */
 GRPCAPI void grpc_ssl_session_cache_destroy(grpc_ssl_session_cache* cache);
 
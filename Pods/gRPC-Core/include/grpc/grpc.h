@@ -277,6 +277,13 @@ GRPCAPI void grpc_channel_get_info(grpc_channel* channel,
     to non-experimental or remove it. */
 GRPCAPI void grpc_channel_reset_connect_backoff(grpc_channel* channel);
 
+/** EXPERIMENTAL.  Tells gRPC whether the application is in the background.
+    While it is, HTTP/2 transports without active calls skip the keepalive
+    pings they would otherwise send, even with
+    GRPC_ARG_KEEPALIVE_PERMIT_WITHOUT_CALLS set, so that the radio can sleep.
+    Transports with active calls keep pinging. */
+GRPCAPI void grpc_set_application_backgrounded(int backgrounded);
+
 /** --- grpc_channel_credentials object. ---
 
    A channel credentials object represents a way to authenticate a client on a
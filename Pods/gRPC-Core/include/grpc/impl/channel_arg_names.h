@@ -67,6 +67,16 @@
    application will see the compressed message in the byte buffer. */
 #define GRPC_ARG_ENABLE_PER_MESSAGE_DECOMPRESSION \
   "grpc.per_message_decompression"
+/** Messages smaller than this many bytes are sent uncompressed, since
+    compressing them costs more CPU time than the bytes it saves are worth.
+    Int valued, defaults to 0. */
+#define GRPC_ARG_MIN_MESSAGE_SIZE_TO_COMPRESS \
+  "grpc.min_message_size_to_compress"
+/** If enabled, a sample of each outgoing message is checked first, and
+    messages that look incompressible (such as images or encrypted data) are
+    sent uncompressed without attempting to compress them. Defaults to 0. */
+#define GRPC_ARG_SKIP_COMPRESSING_INCOMPRESSIBLE_MESSAGES \
+  "grpc.skip_compressing_incompressible_messages"
 /** Initial stream ID for http2 transports. Int valued. */
 #define GRPC_ARG_HTTP2_INITIAL_SEQUENCE_NUMBER \
   "grpc.http2.initial_sequence_number"
@@ -81,6 +91,16 @@
 /** How much memory to use for hpack encoding. Int valued, bytes. */
 #define GRPC_ARG_HTTP2_HPACK_TABLE_SIZE_ENCODER \
   "grpc.http2.hpack_table_size.encoder"
+/** Comma separated metadata keys whose values are added to the hpack table
+    the first time they are sent on a connection, instead of once they have
+    repeated. Meant for metadata that is the same on every call. String
+    valued. */
+#define GRPC_ARG_HTTP2_HPACK_PINNED_KEYS "grpc.http2.hpack_pinned_keys"
+/** Comma separated metadata keys that the application sends on most calls.
+    Interning them when the channel is created lets calls add this metadata
+    without copying its key. Interned keys are never freed, so this is meant
+    for a handful of fixed keys. String valued. */
+#define GRPC_ARG_INTERNED_METADATA_KEYS "grpc.interned_metadata_keys"
 /** How big a frame are we willing to receive via HTTP2.
     Min 16384, max 16777215. Larger values give lower CPU usage for large
     messages, but more head of line blocking for small messages. */
@@ -125,6 +145,12 @@
 /** How much data are we willing to queue up per stream if
     GRPC_WRITE_BUFFER_HINT is set? This is an upper bound */
 #define GRPC_ARG_HTTP2_WRITE_BUFFER_SIZE "grpc.http2.write_buffer_size"
+/** How long, in milliseconds, a write of stream data may wait for data from
+    other streams so that it goes out in the same endpoint write. Pings,
+    settings and other control frames are never held back. Defaults to 0,
+    which writes as soon as possible. Int valued. */
+#define GRPC_ARG_HTTP2_WRITE_COALESCING_DELAY_MS \
+  "grpc.http2.write_coalescing_delay_ms"
 /** Should we allow receipt of true-binary data on http2 connections?
     Defaults to on (1) */
 #define GRPC_ARG_HTTP2_ENABLE_TRUE_BINARY "grpc.http2.true_binary"
@@ -146,6 +172,13 @@
    outstanding streams. Int valued, 0(false)/1(true). */
 #define GRPC_ARG_KEEPALIVE_PERMIT_WITHOUT_CALLS \
   "grpc.keepalive_permit_without_calls"
+/** If set, keepalive pings may be sent up to this many ms early or late, so
+    that they cost fewer radio wakeups: the pings of all transports are
+    aligned to a common schedule with this spacing, and a ping that is nearly
+    due goes out with the next write instead of waking the radio by itself.
+    Int valued, milliseconds. Defaults to 0, meaning pings are sent exactly
+    GRPC_ARG_KEEPALIVE_TIME_MS apart. */
+#define GRPC_ARG_KEEPALIVE_TOLERANCE_MS "grpc.keepalive_tolerance_ms"
 /** Default authority to pass if none specified on call construction. A string.
  * */
 #define GRPC_ARG_DEFAULT_AUTHORITY "grpc.default_authority"
@@ -162,9 +195,26 @@
 /** The time between the first and second connection attempts, in ms */
 #define GRPC_ARG_INITIAL_RECONNECT_BACKOFF_MS \
   "grpc.initial_reconnect_backoff_ms"
+/** The most connections a subchannel keeps open to its address.  Once every
+    connection carries as many calls as the server's MAX_CONCURRENT_STREAMS
+    allows, so that new calls would wait for a stream, the subchannel opens
+    another one, and closes the extra connections again once they have been
+    idle for a while.  Only supported by the HTTP/2 transport on the filter
+    stack.  Defaults to 1. */
+#define GRPC_ARG_MAX_CONNECTIONS_PER_SUBCHANNEL \
+  "grpc.max_connections_per_subchannel"
 /** Minimum amount of time between DNS resolutions, in ms */
 #define GRPC_ARG_DNS_MIN_TIME_BETWEEN_RESOLUTIONS_MS \
   "grpc.dns_min_time_between_resolutions_ms"
+/** If set, DNS answers for the channel's target are kept in a process-wide
+    cache shared with other channels. Answers younger than this many ms are
+    used without a lookup; older ones are still used, for up to a day, while a
+    lookup refreshes them in the background. Only the native DNS resolver
+    uses the cache. */
+#define GRPC_ARG_DNS_CACHE_TTL_MS "grpc.dns_cache_ttl_ms"
+/** Path of a file to save the DNS cache to, so that answers remain available
+    across process restarts. Used only with GRPC_ARG_DNS_CACHE_TTL_MS. */
+#define GRPC_ARG_DNS_CACHE_PATH "grpc.dns_cache_path"
 /** The timeout used on servers for finishing handshaking on an incoming
     connection.  Defaults to 120 seconds. */
 #define GRPC_ARG_SERVER_HANDSHAKE_TIMEOUT_MS "grpc.server_handshake_timeout_ms"
@@ -230,10 +280,22 @@
  * level. Disabling channelz naturally disables channel tracing. The default
  * is for channelz to be enabled. */
 #define GRPC_ARG_ENABLE_CHANNELZ "grpc.enable_channelz"
+/** If non-zero, each socket and subchannel keeps a few counters (bytes,
+ * streams, flow-control stalls, connection attempts) that can be read
+ * without the channelz registry, even when channelz itself is disabled.
+ * Defaults to 0. */
+#define GRPC_ARG_ENABLE_CHANNELZ_COUNTERS "grpc.enable_channelz_counters"
 /** If non-zero, Cronet transport will coalesce packets to fewer frames
  * when possible. */
 #define GRPC_ARG_USE_CRONET_PACKET_COALESCING \
   "grpc.use_cronet_packet_coalescing"
+/** If non-zero, the CFStream event engine connects with Network.framework
+ * (nw_connection) instead of CFStream, where the OS supports it. */
+#define GRPC_ARG_USE_NETWORK_FRAMEWORK "grpc.experimental.use_network_framework"
+/** Server name (string) for which Network.framework connections do TLS in the
+ * OS. Only meant for use with insecure channel credentials. */
+#define GRPC_ARG_NETWORK_FRAMEWORK_TLS_SERVER_NAME \
+  "grpc.experimental.network_framework_tls_server_name"
 /** Channel arg (integer) setting how large a slice to try and read from the
    wire each time recvmsg (or equivalent) is called **/
 #define GRPC_ARG_TCP_READ_CHUNK_SIZE "grpc.experimental.tcp_read_chunk_size"
@@ -275,6 +337,10 @@
    the future. */
 #define GRPC_ARG_TEST_ONLY_DO_NOT_USE_IN_PROD_XDS_BOOTSTRAP_CONFIG \
   "grpc.TEST_ONLY_DO_NOT_USE_IN_PROD.xds_bootstrap_config"
+/** Path of a file to save the xDS resources received by the process-wide
+    XdsClient to. On the next start, saved resources are given to watchers
+    right away while the XdsClient waits for the xDS server's answer. */
+#define GRPC_ARG_XDS_RESOURCE_CACHE_PATH "grpc.xds_resource_cache_path"
 /* Timeout in milliseconds to wait for the serverlist from the grpclb load
    balancer before using fallback backend addresses from the resolver.
    If 0, enter fallback mode immediately. Default value is 10000. */
@@ -306,15 +372,14 @@
     retries are enabled when they are configured via the service config.
     For details, see:
       https://github.com/grpc/proposal/blob/master/A6-client-retries.md
-    NOTE: Hedging functionality is not yet implemented, so those
-          fields in the service config will currently be ignored.  See
-          also the GRPC_ARG_EXPERIMENTAL_ENABLE_HEDGING arg below.
+    NOTE: The hedgingPolicy field in the service config is ignored unless
+          the GRPC_ARG_EXPERIMENTAL_ENABLE_HEDGING arg below is also set.
  */
 #define GRPC_ARG_ENABLE_RETRIES "grpc.enable_retries"
 /** Enables hedging functionality, as described in:
       https://github.com/grpc/proposal/blob/master/A6-client-retries.md
-    Default is currently false, since this functionality is not yet
-    fully implemented.
+    Default is currently false, since this functionality is still
+    experimental.
     NOTE: This channel arg is experimental and will eventually be removed.
           Once hedging functionality has been implemented and proves stable,
           this arg will be removed, and the hedging functionality will
@@ -322,6 +387,12 @@
 #define GRPC_ARG_EXPERIMENTAL_ENABLE_HEDGING "grpc.experimental.enable_hedging"
 /** Per-RPC retry buffer size, in bytes. Default is 256 KiB. */
 #define GRPC_ARG_PER_RPC_RETRY_BUFFER_SIZE "grpc.per_rpc_retry_buffer_size"
+/** If non-zero, calls are rejected on the client, before being queued, when
+    their target answers too many recent calls with UNAVAILABLE,
+    RESOURCE_EXHAUSTED or DEADLINE_EXCEEDED. The history is shared by all the
+    channels to the same target. Default is false. */
+#define GRPC_ARG_ENABLE_CLIENT_ADMISSION_CONTROL \
+  "grpc.enable_client_admission_control"
 /** Channel arg that carries the bridged objective c object for custom metrics
  * logging filter. */
 #define GRPC_ARG_MOBILE_LOG_CONTEXT "grpc.mobile_log_context"
@@ -389,6 +460,12 @@
  *  Defaults to 250ms. */
 #define GRPC_ARG_HAPPY_EYEBALLS_CONNECTION_ATTEMPT_DELAY_MS \
   "grpc.happy_eyeballs_connection_attempt_delay_ms"
+/** If non-zero, pick_first remembers how long connecting to each address
+ *  took and, on the next address list, tries the fastest addresses first and
+ *  the ones that failed last, as per RFC-8305 section 4. Ignored when the
+ *  addresses are shuffled. Defaults to 0. */
+#define GRPC_ARG_HAPPY_EYEBALLS_SORT_BY_CONNECT_TIME \
+  "grpc.happy_eyeballs_sort_by_connect_time"
 /** It accepts a MemoryAllocatorFactory as input and If specified, it forces
  * the default event engine to use memory allocators created using the provided
  * factory. */
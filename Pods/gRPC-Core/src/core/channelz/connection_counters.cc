@@ -0,0 +1,131 @@
+// Copyright 2024 The gRPC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/core/channelz/connection_counters.h"
+
+#include <grpc/support/port_platform.h>
+
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_set.h"
+#include "src/core/util/no_destruct.h"
+#include "src/core/util/sync.h"
+
+namespace grpc_core {
+namespace channelz {
+
+namespace {
+
+// Tracks live counters so that they can be listed. Only construction,
+// destruction and listing take the lock; recording never does.
+template <typename T>
+class CountersRegistry {
+ public:
+  void Register(const T* counters) {
+    MutexLock lock(&mu_);
+    counters_.insert(counters);
+  }
+  void Unregister(const T* counters) {
+    MutexLock lock(&mu_);
+    counters_.erase(counters);
+  }
+  std::vector<typename T::Snapshot> GetAll() {
+    std::vector<typename T::Snapshot> snapshots;
+    MutexLock lock(&mu_);
+    snapshots.reserve(counters_.size());
+    for (const T* counters : counters_) {
+      snapshots.push_back(counters->GetSnapshot());
+    }
+    return snapshots;
+  }
+
+ private:
+  Mutex mu_;
+  absl::flat_hash_set<const T*> counters_ ABSL_GUARDED_BY(mu_);
+};
+
+CountersRegistry<SocketCounters>& SocketRegistry() {
+  static NoDestruct<CountersRegistry<SocketCounters>> registry;
+  return *registry;
+}
+
+CountersRegistry<SubchannelCounters>& SubchannelRegistry() {
+  static NoDestruct<CountersRegistry<SubchannelCounters>> registry;
+  return *registry;
+}
+
+}  // namespace
+
+//
+// SocketCounters
+//
+
+SocketCounters::SocketCounters(std::string local, std::string remote)
+    : local_(std::move(local)), remote_(std::move(remote)) {
+  SocketRegistry().Register(this);
+}
+
+SocketCounters::~SocketCounters() { SocketRegistry().Unregister(this); }
+
+SocketCounters::Snapshot SocketCounters::GetSnapshot() const {
+  Snapshot snapshot;
+  snapshot.local = local_;
+  snapshot.remote = remote_;
+  snapshot.bytes_sent = bytes_sent_.load(std::memory_order_relaxed);
+  snapshot.bytes_received = bytes_received_.load(std::memory_order_relaxed);
+  snapshot.streams_started = streams_started_.load(std::memory_order_relaxed);
+  snapshot.streams_succeeded =
+      streams_succeeded_.load(std::memory_order_relaxed);
+  snapshot.streams_failed = streams_failed_.load(std::memory_order_relaxed);
+  snapshot.messages_sent = messages_sent_.load(std::memory_order_relaxed);
+  snapshot.flow_control_stalls =
+      flow_control_stalls_.load(std::memory_order_relaxed);
+  snapshot.keepalives_sent = keepalives_sent_.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+//
+// SubchannelCounters
+//
+
+SubchannelCounters::SubchannelCounters(std::string target)
+    : target_(std::move(target)) {
+  SubchannelRegistry().Register(this);
+}
+
+SubchannelCounters::~SubchannelCounters() {
+  SubchannelRegistry().Unregister(this);
+}
+
+SubchannelCounters::Snapshot SubchannelCounters::GetSnapshot() const {
+  Snapshot snapshot;
+  snapshot.target = target_;
+  snapshot.connection_attempts =
+      connection_attempts_.load(std::memory_order_relaxed);
+  snapshot.connection_failures =
+      connection_failures_.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+std::vector<SocketCounters::Snapshot> GetAllSocketCounters() {
+  return SocketRegistry().GetAll();
+}
+
+std::vector<SubchannelCounters::Snapshot> GetAllSubchannelCounters() {
+  return SubchannelRegistry().GetAll();
+}
+
+}  // namespace channelz
+}  // namespace grpc_core
@@ -23,9 +23,12 @@
 #include <grpc/support/sync.h>
 #include <inttypes.h>
 
+#include <algorithm>
+
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "src/core/config/config_vars.h"
+#include "src/core/lib/experiments/experiments.h"
 #include "src/core/lib/iomgr/closure.h"
 #include "src/core/lib/iomgr/error.h"
 #include "src/core/lib/iomgr/iomgr.h"
@@ -36,6 +39,9 @@
 #include "src/core/util/time.h"
 
 #define DEFAULT_POLL_INTERVAL_MS 5000
+// While the pollsets are being polled without the backup poller, it backs off
+// up to this many times its poll interval.
+#define MAX_POLL_INTERVAL_BACKOFF 8
 
 namespace {
 struct backup_poller {
@@ -45,6 +51,9 @@ struct backup_poller {
   gpr_mu* pollset_mu;
   grpc_pollset* pollset;  // guarded by pollset_mu
   bool shutting_down;     // guarded by pollset_mu
+  // Only used by run_poller once initialized, which runs once at a time.
+  int64_t interval_ms;
+  uint64_t last_work_count;
   gpr_refcount refs;
   gpr_refcount shutdown_refs;
 };
@@ -66,6 +75,12 @@ void grpc_client_channel_global_init_backup_polling() {
   g_backup_polling_disabled = grpc_core::IsEventEngineClientEnabled() &&
                               grpc_core::IsEventEngineListenerEnabled() &&
                               grpc_core::IsEventEngineDnsEnabled();
+#ifdef GRPC_CFSTREAM
+  // The CFEventEngine drives its client endpoints from CFStream callbacks, so
+  // there is nothing for the backup poller to poll for client channels.
+  g_backup_polling_disabled =
+      g_backup_polling_disabled || grpc_core::IsEventEngineClientEnabled();
+#endif
   if (g_backup_polling_disabled) {
     return;
   }
@@ -128,13 +143,28 @@ static void run_poller(void* arg, grpc_error_handle error) {
     backup_poller_shutdown_unref(p);
     return;
   }
-  grpc_error_handle err =
-      grpc_pollset_work(p->pollset, nullptr, grpc_core::Timestamp::Now());
-  gpr_mu_unlock(p->pollset_mu);
-  GRPC_LOG_IF_ERROR("Run client channel backup poller", err);
-  grpc_timer_init(&p->polling_timer,
-                  grpc_core::Timestamp::Now() + g_poll_interval,
-                  &p->run_poller_closure);
+  // If pollsets have been polled since the last run, the primary poller is
+  // making progress on its own: skip this run and back off, so that an idle
+  // process is not woken up to poll. Otherwise poll, and go back to the
+  // configured interval.
+  if (grpc_pollset_work_count() != p->last_work_count) {
+    gpr_mu_unlock(p->pollset_mu);
+    p->interval_ms =
+        std::min(p->interval_ms * 2,
+                 g_poll_interval.millis() * MAX_POLL_INTERVAL_BACKOFF);
+  } else {
+    grpc_error_handle err =
+        grpc_pollset_work(p->pollset, nullptr, grpc_core::Timestamp::Now());
+    gpr_mu_unlock(p->pollset_mu);
+    GRPC_LOG_IF_ERROR("Run client channel backup poller", err);
+    p->interval_ms = g_poll_interval.millis();
+  }
+  p->last_work_count = grpc_pollset_work_count();
+  grpc_timer_init(
+      &p->polling_timer,
+      grpc_core::Timestamp::Now() +
+          grpc_core::Duration::Milliseconds(p->interval_ms),
+      &p->run_poller_closure);
 }
 
 static void g_poller_init_locked() {
@@ -143,6 +173,8 @@ static void g_poller_init_locked() {
     g_poller->pollset =
         static_cast<grpc_pollset*>(gpr_zalloc(grpc_pollset_size()));
     g_poller->shutting_down = false;
+    g_poller->interval_ms = g_poll_interval.millis();
+    g_poller->last_work_count = grpc_pollset_work_count();
     grpc_pollset_init(g_poller->pollset, &g_poller->pollset_mu);
     gpr_ref_init(&g_poller->refs, 0);
     // one for timer cancellation, one for pollset shutdown, one for g_poller
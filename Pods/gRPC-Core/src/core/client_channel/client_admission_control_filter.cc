@@ -0,0 +1,168 @@
+// Copyright 2024 The gRPC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/core/client_channel/client_admission_control_filter.h"
+
+#include <grpc/impl/channel_arg_names.h>
+#include <grpc/status.h>
+#include <grpc/support/port_platform.h>
+
+#include <utility>
+
+#include "src/core/client_channel/client_channel_filter.h"
+#include "src/core/config/core_configuration.h"
+#include "src/core/lib/channel/channel_stack.h"
+#include "src/core/lib/surface/channel_stack_type.h"
+#include "src/core/lib/transport/metadata_batch.h"
+#include "src/core/util/latent_see.h"
+
+namespace grpc_core {
+
+const NoInterceptor
+    ClientAdmissionControlFilter::Call::OnServerInitialMetadata;
+const NoInterceptor
+    ClientAdmissionControlFilter::Call::OnClientToServerMessage;
+const NoInterceptor
+    ClientAdmissionControlFilter::Call::OnClientToServerHalfClose;
+const NoInterceptor
+    ClientAdmissionControlFilter::Call::OnServerToClientMessage;
+const NoInterceptor ClientAdmissionControlFilter::Call::OnFinalize;
+
+//
+// AdmissionControlTargetData
+//
+
+void AdmissionControlTargetData::MaybeDecayLocked(Timestamp now) {
+  if (now < next_decay_) return;
+  requests_ /= 2;
+  accepts_ /= 2;
+  next_decay_ = now + kDecayPeriod;
+}
+
+absl::Status AdmissionControlTargetData::AdmitCall(Timestamp deadline) {
+  const Timestamp now = Timestamp::Now();
+  MutexLock lock(&mu_);
+  MaybeDecayLocked(now);
+  ++requests_;
+  const uint64_t weighted_accepts = kAcceptsMultiplier * accepts_;
+  if (requests_ <= weighted_accepts) return absl::OkStatus();
+  // Past the soft limit of zero, RED rejects with probability
+  // excess / (requests + 1), which is the adaptive throttling rule.
+  red_.SetLimits(0, requests_ + 1);
+  if (deadline - now < latency_) {
+    return absl::DeadlineExceededError(
+        "Rejected by client admission control: deadline is shorter than the "
+        "latency of the overloaded target");
+  }
+  if (red_.Reject(requests_ - weighted_accepts, bitgen_)) {
+    return absl::UnavailableError(
+        "Rejected by client admission control: target is overloaded");
+  }
+  return absl::OkStatus();
+}
+
+void AdmissionControlTargetData::RecordCallFinished(bool overloaded,
+                                                    Duration latency) {
+  MutexLock lock(&mu_);
+  MaybeDecayLocked(Timestamp::Now());
+  if (overloaded) return;
+  ++accepts_;
+  latency_ = latency_ == Duration::Zero()
+                 ? latency
+                 : latency_ * 0.9 + latency * 0.1;
+}
+
+//
+// AdmissionControlMap
+//
+
+AdmissionControlMap* AdmissionControlMap::Get() {
+  static AdmissionControlMap* m = new AdmissionControlMap();
+  return m;
+}
+
+RefCountedPtr<AdmissionControlTargetData>
+AdmissionControlMap::GetDataForTarget(const std::string& target) {
+  MutexLock lock(&mu_);
+  auto& data = map_[target];
+  if (data == nullptr) data = MakeRefCounted<AdmissionControlTargetData>();
+  return data;
+}
+
+//
+// ClientAdmissionControlFilter
+//
+
+const grpc_channel_filter ClientAdmissionControlFilter::kFilter =
+    MakePromiseBasedFilter<ClientAdmissionControlFilter,
+                           FilterEndpoint::kClient>();
+
+absl::StatusOr<std::unique_ptr<ClientAdmissionControlFilter>>
+ClientAdmissionControlFilter::Create(const ChannelArgs& args,
+                                     ChannelFilter::Args) {
+  auto target = args.GetOwnedString(GRPC_ARG_SERVER_URI);
+  if (!target.has_value()) {
+    return absl::InvalidArgumentError(
+        "client admission control filter requires a target");
+  }
+  return std::make_unique<ClientAdmissionControlFilter>(
+      AdmissionControlMap::Get()->GetDataForTarget(*target));
+}
+
+absl::Status ClientAdmissionControlFilter::Call::OnClientInitialMetadata(
+    ClientMetadata& md, ClientAdmissionControlFilter* filter) {
+  GRPC_LATENT_SEE_INNER_SCOPE(
+      "ClientAdmissionControlFilter::Call::OnClientInitialMetadata");
+  absl::Status status = filter->target_data_->AdmitCall(
+      md.get(GrpcTimeoutMetadata()).value_or(Timestamp::InfFuture()));
+  if (status.ok()) start_time_ = Timestamp::Now();
+  return status;
+}
+
+void ClientAdmissionControlFilter::Call::OnServerTrailingMetadata(
+    ServerMetadata& md, ClientAdmissionControlFilter* filter) {
+  GRPC_LATENT_SEE_INNER_SCOPE(
+      "ClientAdmissionControlFilter::Call::OnServerTrailingMetadata");
+  if (start_time_ == Timestamp::InfPast()) return;
+  // Cancellations say nothing about the target.
+  const grpc_status_code status =
+      md.get(GrpcStatusMetadata()).value_or(GRPC_STATUS_UNKNOWN);
+  if (status == GRPC_STATUS_CANCELLED) return;
+  const bool overloaded = status == GRPC_STATUS_UNAVAILABLE ||
+                          status == GRPC_STATUS_RESOURCE_EXHAUSTED ||
+                          status == GRPC_STATUS_DEADLINE_EXCEEDED;
+  filter->target_data_->RecordCallFinished(overloaded,
+                                           Timestamp::Now() - start_time_);
+}
+
+namespace {
+bool IsClientAdmissionControlEnabled(const ChannelArgs& args) {
+  return args.GetBool(GRPC_ARG_ENABLE_CLIENT_ADMISSION_CONTROL)
+      .value_or(false);
+}
+}  // namespace
+
+void RegisterClientAdmissionControlFilter(
+    CoreConfiguration::Builder* builder) {
+  builder->channel_init()
+      ->RegisterFilter<ClientAdmissionControlFilter>(GRPC_CLIENT_CHANNEL)
+      .ExcludeFromMinimalStack()
+      .If(IsClientAdmissionControlEnabled);
+  builder->channel_init()
+      ->RegisterFilter<ClientAdmissionControlFilter>(GRPC_CLIENT_DIRECT_CHANNEL)
+      .ExcludeFromMinimalStack()
+      .If(IsClientAdmissionControlEnabled);
+}
+
+}  // namespace grpc_core
@@ -76,6 +76,12 @@ class SubchannelConnector : public InternallyRefCounted<SubchannelConnector> {
   // connector.
   virtual void Shutdown(grpc_error_handle error) = 0;
 
+  // Returns a new connector of the same kind, so that a subchannel can make
+  // a connection attempt while its first connection is in use.  Returns null
+  // if the transport does not support more than one connection per
+  // subchannel.
+  virtual OrphanablePtr<SubchannelConnector> Clone() const { return nullptr; }
+
   void Orphan() override {
     Shutdown(GRPC_ERROR_CREATE("Subchannel disconnected"));
     Unref();
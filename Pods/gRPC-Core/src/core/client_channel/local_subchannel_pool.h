@@ -21,8 +21,7 @@
 
 #include <grpc/support/port_platform.h>
 
-#include <map>
-
+#include "absl/container/flat_hash_map.h"
 #include "src/core/client_channel/subchannel_pool_interface.h"
 #include "src/core/util/ref_counted_ptr.h"
 
@@ -51,7 +50,7 @@ class LocalSubchannelPool final : public SubchannelPoolInterface {
 
  private:
   // A map from subchannel key to subchannel.
-  std::map<SubchannelKey, Subchannel*> subchannel_map_;
+  absl::flat_hash_map<SubchannelKey, Subchannel*> subchannel_map_;
 };
 
 }  // namespace grpc_core
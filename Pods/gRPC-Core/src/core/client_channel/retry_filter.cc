@@ -79,8 +79,9 @@
 // CallAttempt object against the state in the CallData object to see
 // which batches need to be sent on the LB call for a given attempt.
 
-// TODO(roth): In subsequent PRs:
-// - implement hedging
+// With a hedging policy, the CallData object keeps several CallAttempt
+// objects in flight at once, and each pending batch is sent on all of them.
+// Once one attempt commits, the others are cancelled.
 
 using grpc_core::internal::RetryGlobalConfig;
 using grpc_core::internal::RetryMethodConfig;
@@ -115,6 +115,9 @@ RetryFilter::LegacyCallData::CallAttempt::CallAttempt(
     RetryFilter::LegacyCallData* calld, bool is_transparent_retry)
     : RefCounted(GRPC_TRACE_FLAG_ENABLED(retry) ? "CallAttempt" : nullptr),
       calld_(calld),
+      num_previous_attempts_(calld->hedging_policy_ != nullptr
+                                 ? calld->num_attempts_started_
+                                 : calld->num_attempts_completed_),
       started_send_initial_metadata_(false),
       completed_send_initial_metadata_(false),
       started_send_trailing_metadata_(false),
@@ -169,10 +172,8 @@ RetryFilter::LegacyCallData::CallAttempt::~CallAttempt() {
 
 void RetryFilter::LegacyCallData::CallAttempt::
     FreeCachedSendOpDataAfterCommit() {
-  // TODO(roth): When we implement hedging, this logic will need to get
-  // a bit more complex, because there may be other (now abandoned) call
-  // attempts still using this data.  We may need to do some sort of
-  // ref-counting instead.
+  // Losing hedged attempts may still have send ops in flight, but those use
+  // their own copies of the cached data, so it can be freed here.
   if (completed_send_initial_metadata_) {
     calld_->FreeCachedSendInitialMetadata();
   }
@@ -213,11 +214,9 @@ bool RetryFilter::LegacyCallData::CallAttempt::HaveSendOpsToReplay() {
 
 void RetryFilter::LegacyCallData::CallAttempt::MaybeSwitchToFastPath() {
   // If we're not yet committed, we can't switch yet.
-  // TODO(roth): As part of implementing hedging, this logic needs to
-  // check that *this* call attempt is the one that we've committed to.
-  // Might need to replace abandoned_ with an enum indicating whether we're
-  // in flight, abandoned, or the winning call attempt.
   if (!calld_->retry_committed_) return;
+  // Only the attempt we committed to can switch.
+  if (calld_->call_attempt_.get() != this) return;
   // If we've already switched to fast path, there's nothing to do here.
   if (calld_->committed_call_ != nullptr) return;
   // If the perAttemptRecvTimeout timer is pending, we can't switch yet.
@@ -533,6 +532,9 @@ bool RetryFilter::LegacyCallData::CallAttempt::ShouldRetry(
     absl::optional<Duration> server_pushback) {
   // If no retry policy, don't retry.
   if (calld_->retry_policy_ == nullptr) return false;
+  if (calld_->hedging_policy_ != nullptr) {
+    return ShouldContinueHedging(status, server_pushback);
+  }
   // Check status.
   if (status.has_value()) {
     if (GPR_LIKELY(*status == GRPC_STATUS_OK)) {
@@ -603,6 +605,74 @@ bool RetryFilter::LegacyCallData::CallAttempt::ShouldRetry(
   return true;
 }
 
+bool RetryFilter::LegacyCallData::CallAttempt::ShouldContinueHedging(
+    absl::optional<grpc_status_code> status,
+    absl::optional<Duration> server_pushback) {
+  if (status.has_value()) {
+    if (GPR_LIKELY(*status == GRPC_STATUS_OK)) {
+      if (calld_->retry_throttle_data_ != nullptr) {
+        calld_->retry_throttle_data_->RecordSuccess();
+      }
+      GRPC_TRACE_LOG(retry, INFO)
+          << "chand=" << calld_->chand_ << " calld=" << calld_
+          << " attempt=" << this << ": call succeeded";
+      return false;
+    }
+    // A fatal status ends the call, even if other attempts are in flight.
+    if (!calld_->hedging_policy_->non_fatal_status_codes().Contains(*status)) {
+      GRPC_TRACE_LOG(retry, INFO)
+          << "chand=" << calld_->chand_ << " calld=" << calld_
+          << " attempt=" << this << ": status "
+          << grpc_status_code_to_string(*status)
+          << " not configured as non-fatal";
+      return false;
+    }
+  }
+  // Throttling and negative server push-back stop further hedged attempts,
+  // but the ones already in flight may still succeed.
+  if (calld_->retry_throttle_data_ != nullptr &&
+      !calld_->retry_throttle_data_->RecordFailure()) {
+    GRPC_TRACE_LOG(retry, INFO)
+        << "chand=" << calld_->chand_ << " calld=" << calld_
+        << " attempt=" << this << ": hedged attempts throttled";
+    calld_->hedging_stopped_ = true;
+  }
+  if (server_pushback.has_value() && *server_pushback < Duration::Zero()) {
+    GRPC_TRACE_LOG(retry, INFO)
+        << "chand=" << calld_->chand_ << " calld=" << calld_
+        << " attempt=" << this << ": no more hedging due to server push-back";
+    calld_->hedging_stopped_ = true;
+  }
+  if (calld_->retry_committed_) {
+    GRPC_TRACE_LOG(retry, INFO)
+        << "chand=" << calld_->chand_ << " calld=" << calld_
+        << " attempt=" << this << ": retries already committed";
+    return false;
+  }
+  if (calld_->NumAttemptsInFlight() > 1) return true;
+  if (calld_->hedging_stopped_ ||
+      calld_->num_attempts_started_ >=
+          calld_->hedging_policy_->max_attempts()) {
+    GRPC_TRACE_LOG(retry, INFO)
+        << "chand=" << calld_->chand_ << " calld=" << calld_
+        << " attempt=" << this << ": last hedged attempt failed";
+    return false;
+  }
+  return true;
+}
+
+void RetryFilter::LegacyCallData::CallAttempt::CancelLosingHedge(
+    CallCombinerClosureList* closures) {
+  GRPC_TRACE_LOG(retry, INFO)
+      << "chand=" << calld_->chand_ << " calld=" << calld_
+      << " attempt=" << this << ": cancelling losing hedged attempt";
+  MaybeAddBatchForCancelOp(
+      grpc_error_set_int(GRPC_ERROR_CREATE("another hedged attempt won"),
+                         StatusIntProperty::kRpcStatus, GRPC_STATUS_CANCELLED),
+      closures);
+  Abandon();
+}
+
 void RetryFilter::LegacyCallData::CallAttempt::Abandon() {
   abandoned_ = true;
   // Unref batches for deferred completion callbacks that will now never
@@ -732,10 +802,8 @@ RetryFilter::LegacyCallData::CallAttempt::BatchData::~BatchData() {
 void RetryFilter::LegacyCallData::CallAttempt::BatchData::
     FreeCachedSendOpDataForCompletedBatch() {
   auto* calld = call_attempt_->calld_;
-  // TODO(roth): When we implement hedging, this logic will need to get
-  // a bit more complex, because there may be other (now abandoned) call
-  // attempts still using this data.  We may need to do some sort of
-  // ref-counting instead.
+  // As in FreeCachedSendOpDataAfterCommit(), losing hedged attempts only
+  // use their own copies of this data.
   if (batch_.send_initial_metadata) {
     calld->FreeCachedSendInitialMetadata();
   }
@@ -1143,7 +1211,12 @@ void RetryFilter::LegacyCallData::CallAttempt::BatchData::
       // call attempt.
       // For configurable retries, start retry timer.
       if (retry == kTransparentRetry) {
+        if (calld->hedging_policy_ != nullptr) {
+          calld->RemoveHedgedAttempt(call_attempt);
+        }
         calld->AddClosureToStartTransparentRetry(&closures);
+      } else if (calld->hedging_policy_ != nullptr) {
+        calld->OnHedgedAttemptFailed(call_attempt, server_pushback);
       } else {
         calld->StartRetryTimer(server_pushback);
       }
@@ -1325,9 +1398,10 @@ void RetryFilter::LegacyCallData::CallAttempt::BatchData::
   // If we've already completed one or more attempts, add the
   // grpc-retry-attempts header.
   call_attempt_->send_initial_metadata_ = calld->send_initial_metadata_.Copy();
-  if (GPR_UNLIKELY(calld->num_attempts_completed_ > 0)) {
-    call_attempt_->send_initial_metadata_.Set(GrpcPreviousRpcAttemptsMetadata(),
-                                              calld->num_attempts_completed_);
+  if (GPR_UNLIKELY(call_attempt_->num_previous_attempts_ > 0)) {
+    call_attempt_->send_initial_metadata_.Set(
+        GrpcPreviousRpcAttemptsMetadata(),
+        call_attempt_->num_previous_attempts_);
   } else {
     call_attempt_->send_initial_metadata_.Remove(
         GrpcPreviousRpcAttemptsMetadata());
@@ -1470,6 +1544,10 @@ RetryFilter::LegacyCallData::LegacyCallData(RetryFilter* chand,
     : chand_(chand),
       retry_throttle_data_(chand->retry_throttle_data()),
       retry_policy_(chand->GetRetryPolicy(args.arena)),
+      hedging_policy_(retry_policy_ != nullptr &&
+                              retry_policy_->hedging_policy().has_value()
+                          ? &*retry_policy_->hedging_policy()
+                          : nullptr),
       retry_backoff_(
           BackOff::Options()
               .set_initial_backoff(retry_policy_ == nullptr
@@ -1494,7 +1572,8 @@ RetryFilter::LegacyCallData::LegacyCallData(RetryFilter* chand,
       pending_send_trailing_metadata_(false),
       retry_committed_(false),
       retry_codepath_started_(false),
-      sent_transparent_retry_not_seen_by_server_(false) {}
+      sent_transparent_retry_not_seen_by_server_(false),
+      hedging_stopped_(false) {}
 
 RetryFilter::LegacyCallData::~LegacyCallData() {
   FreeAllCachedSendOpData();
@@ -1540,17 +1619,14 @@ void RetryFilter::LegacyCallData::StartTransportStreamOpBatch(
     // will not be retried, because we have committed it here.
     if (call_attempt_ != nullptr) {
       RetryCommit(call_attempt_.get());
-      // TODO(roth): When implementing hedging, this will get more
-      // complex, because instead of just passing the batch down to a
-      // single call attempt, we'll need to cancel multiple call
-      // attempts and wait for the cancellation on_complete from each call
-      // attempt before we propagate the on_complete from this batch
-      // back to the surface.
+      // When hedging, committing also cancelled the other attempts, so
+      // the batch only needs to go down to this one.
       // Note: This will release the call combiner.
       call_attempt_->CancelFromSurface(batch);
       return;
     }
-    // Cancel retry timer if needed.
+    // Cancel retry and hedge timers if needed.
+    CancelHedgeTimer();
     if (retry_timer_handle_.has_value()) {
       GRPC_TRACE_LOG(retry, INFO) << "chand=" << chand_ << " calld=" << this
                                   << ": cancelling retry timer";
@@ -1571,7 +1647,9 @@ void RetryFilter::LegacyCallData::StartTransportStreamOpBatch(
   PendingBatch* pending = PendingBatchesAdd(batch);
   // If the timer is pending, yield the call combiner and wait for it to
   // run, since we don't want to start another call attempt until it does.
-  if (retry_timer_handle_.has_value()) {
+  // (A pending hedge timer only matters when no attempt is in flight.)
+  if (retry_timer_handle_.has_value() ||
+      (call_attempt_ == nullptr && hedge_timer_handle_.has_value())) {
     GRPC_CALL_COMBINER_STOP(call_combiner_,
                             "added pending batch while retry timer pending");
     return;
@@ -1622,7 +1700,18 @@ void RetryFilter::LegacyCallData::StartTransportStreamOpBatch(
   GRPC_TRACE_LOG(retry, INFO)
       << "chand=" << chand_ << " calld=" << this
       << ": starting batch on attempt=" << call_attempt_.get();
-  call_attempt_->StartRetriableBatches();
+  if (hedged_attempts_.empty()) {
+    call_attempt_->StartRetriableBatches();
+    return;
+  }
+  // When hedging, every attempt in flight needs the batch.
+  CallCombinerClosureList closures;
+  for (auto& hedged_attempt : hedged_attempts_) {
+    hedged_attempt->AddRetriableBatches(&closures);
+  }
+  call_attempt_->AddRetriableBatches(&closures);
+  // Note: This will yield the call combiner.
+  closures.RunClosures(call_combiner_);
 }
 
 OrphanablePtr<ClientChannelFilter::FilterBasedLoadBalancedCall>
@@ -1640,7 +1729,17 @@ RetryFilter::LegacyCallData::CreateLoadBalancedCall(
 }
 
 void RetryFilter::LegacyCallData::CreateCallAttempt(bool is_transparent_retry) {
+  // Only hedged calls have more than one attempt in flight.
+  if (call_attempt_ != nullptr) {
+    CHECK_NE(hedging_policy_, nullptr);
+    hedged_attempts_.push_back(std::move(call_attempt_));
+  }
   call_attempt_ = MakeRefCounted<CallAttempt>(this, is_transparent_retry);
+  // A transparent retry replaces a hedged attempt rather than adding one.
+  if (hedging_policy_ != nullptr && !is_transparent_retry &&
+      ++num_attempts_started_ < hedging_policy_->max_attempts()) {
+    StartHedgeTimer(hedging_policy_->hedging_delay());
+  }
   call_attempt_->StartRetriableBatches();
 }
 
@@ -1750,14 +1849,13 @@ RetryFilter::LegacyCallData::PendingBatchesAdd(
   if (batch->send_trailing_metadata) {
     pending_send_trailing_metadata_ = true;
   }
-  // TODO(roth): When we implement hedging, if there are currently attempts
-  // in flight, we will need to pick the one on which the max number of send
-  // ops have already been sent, and we commit to that attempt.
   if (GPR_UNLIKELY(bytes_buffered_for_retry_ >
                    chand_->per_rpc_retry_buffer_size())) {
     GRPC_TRACE_LOG(retry, INFO) << "chand=" << chand_ << " calld=" << this
                                 << ": exceeded retry buffer size, committing";
-    RetryCommit(call_attempt_.get());
+    // When hedging, commit to the oldest attempt, which has sent the most.
+    RetryCommit(hedged_attempts_.empty() ? call_attempt_.get()
+                                         : hedged_attempts_.front().get());
   }
   return pending;
 }
@@ -1861,6 +1959,10 @@ void RetryFilter::LegacyCallData::RetryCommit(CallAttempt* call_attempt) {
   retry_committed_ = true;
   GRPC_TRACE_LOG(retry, INFO)
       << "chand=" << chand_ << " calld=" << this << ": committing retries";
+  if (hedging_policy_ != nullptr) {
+    CancelHedgeTimer();
+    if (call_attempt != nullptr) CancelLosingHedges(call_attempt);
+  }
   if (call_attempt != nullptr) {
     // If the call attempt's LB call has been committed, invoke the
     // call's on_commit callback.
@@ -1921,6 +2023,117 @@ void RetryFilter::LegacyCallData::OnRetryTimerLocked(
   GRPC_CALL_STACK_UNREF(calld->owning_call_, "OnRetryTimer");
 }
 
+void RetryFilter::LegacyCallData::StartHedgeTimer(Duration delay) {
+  CancelHedgeTimer();
+  GRPC_TRACE_LOG(retry, INFO)
+      << "chand=" << chand_ << " calld=" << this
+      << ": starting hedged attempt in " << delay.millis() << " ms";
+  GRPC_CALL_STACK_REF(owning_call_, "OnHedgeTimer");
+  hedge_timer_handle_ = chand_->event_engine()->RunAfter(delay, [this] {
+    ApplicationCallbackExecCtx callback_exec_ctx;
+    ExecCtx exec_ctx;
+    OnHedgeTimer();
+  });
+}
+
+void RetryFilter::LegacyCallData::CancelHedgeTimer() {
+  if (!hedge_timer_handle_.has_value()) return;
+  GRPC_TRACE_LOG(retry, INFO)
+      << "chand=" << chand_ << " calld=" << this << ": cancelling hedge timer";
+  if (chand_->event_engine()->Cancel(*hedge_timer_handle_)) {
+    GRPC_CALL_STACK_UNREF(owning_call_, "OnHedgeTimer");
+  }
+  hedge_timer_handle_.reset();
+}
+
+void RetryFilter::LegacyCallData::OnHedgeTimer() {
+  // The timer may be restarted while an earlier run is still waiting for
+  // the call combiner, so each run gets its own closure.
+  grpc_closure* closure = arena_->New<grpc_closure>();
+  GRPC_CLOSURE_INIT(closure, OnHedgeTimerLocked, this, nullptr);
+  GRPC_CALL_COMBINER_START(call_combiner_, closure, absl::OkStatus(),
+                           "hedge timer fired");
+}
+
+void RetryFilter::LegacyCallData::OnHedgeTimerLocked(
+    void* arg, grpc_error_handle /*error*/) {
+  auto* calld = static_cast<RetryFilter::LegacyCallData*>(arg);
+  // With no attempt in flight, the timer replaces one that failed, so it
+  // must start an attempt for the call to complete.
+  if (calld->hedge_timer_handle_.has_value() &&
+      (calld->call_attempt_ == nullptr || calld->CanStartHedgedAttempt())) {
+    calld->hedge_timer_handle_.reset();
+    GRPC_TRACE_LOG(retry, INFO)
+        << "chand=" << calld->chand_ << " calld=" << calld
+        << ": starting hedged attempt " << calld->num_attempts_started_ + 1;
+    calld->CreateCallAttempt(/*is_transparent_retry=*/false);
+  } else {
+    calld->hedge_timer_handle_.reset();
+    GRPC_CALL_COMBINER_STOP(calld->call_combiner_,
+                            "hedge timer fired; no attempt started");
+  }
+  GRPC_CALL_STACK_UNREF(calld->owning_call_, "OnHedgeTimer");
+}
+
+bool RetryFilter::LegacyCallData::CanStartHedgedAttempt() const {
+  return !retry_committed_ && !hedging_stopped_ &&
+         cancelled_from_surface_.ok() &&
+         num_attempts_started_ < hedging_policy_->max_attempts() &&
+         (retry_throttle_data_ == nullptr ||
+          retry_throttle_data_->RetriesAllowed());
+}
+
+void RetryFilter::LegacyCallData::RemoveHedgedAttempt(
+    CallAttempt* call_attempt) {
+  if (call_attempt_.get() == call_attempt) {
+    call_attempt_.reset(DEBUG_LOCATION, "RemoveHedgedAttempt");
+    if (!hedged_attempts_.empty()) {
+      call_attempt_ = std::move(hedged_attempts_.back());
+      hedged_attempts_.pop_back();
+    }
+    return;
+  }
+  for (auto it = hedged_attempts_.begin(); it != hedged_attempts_.end();
+       ++it) {
+    if (it->get() == call_attempt) {
+      hedged_attempts_.erase(it);
+      return;
+    }
+  }
+}
+
+void RetryFilter::LegacyCallData::OnHedgedAttemptFailed(
+    CallAttempt* call_attempt, absl::optional<Duration> server_pushback) {
+  RemoveHedgedAttempt(call_attempt);
+  if (hedging_stopped_ ||
+      num_attempts_started_ >= hedging_policy_->max_attempts()) {
+    CancelHedgeTimer();
+    return;
+  }
+  // A non-fatal failure sends the next hedged attempt right away, or once
+  // the server's push-back has passed.
+  StartHedgeTimer(server_pushback.value_or(Duration::Zero()));
+}
+
+void RetryFilter::LegacyCallData::CancelLosingHedges(CallAttempt* winner) {
+  if (call_attempt_.get() != winner) {
+    for (auto& hedged_attempt : hedged_attempts_) {
+      if (hedged_attempt.get() == winner) {
+        std::swap(hedged_attempt, call_attempt_);
+        break;
+      }
+    }
+  }
+  CHECK_EQ(call_attempt_.get(), winner);
+  if (hedged_attempts_.empty()) return;
+  CallCombinerClosureList closures;
+  for (auto& hedged_attempt : hedged_attempts_) {
+    hedged_attempt->CancelLosingHedge(&closures);
+  }
+  hedged_attempts_.clear();
+  closures.RunClosuresWithoutYielding(call_combiner_);
+}
+
 void RetryFilter::LegacyCallData::AddClosureToStartTransparentRetry(
     CallCombinerClosureList* closures) {
   GRPC_TRACE_LOG(retry, INFO) << "chand=" << chand_ << " calld=" << this
@@ -52,8 +52,32 @@ class RetryGlobalConfig final : public ServiceConfigParser::ParsedConfig {
   uintptr_t milli_token_ratio_ = 0;
 };
 
+// A hedgingPolicy: up to max_attempts copies of the call are started,
+// hedging_delay apart, and the first one to get a response wins.
+class HedgingPolicy final {
+ public:
+  int max_attempts() const { return max_attempts_; }
+  Duration hedging_delay() const { return hedging_delay_; }
+  StatusCodeSet non_fatal_status_codes() const {
+    return non_fatal_status_codes_;
+  }
+
+  static const JsonLoaderInterface* JsonLoader(const JsonArgs&);
+  void JsonPostLoad(const Json& json, const JsonArgs& args,
+                    ValidationErrors* errors);
+
+ private:
+  int max_attempts_ = 0;
+  Duration hedging_delay_;
+  StatusCodeSet non_fatal_status_codes_;
+};
+
 class RetryMethodConfig final : public ServiceConfigParser::ParsedConfig {
  public:
+  RetryMethodConfig() = default;
+  explicit RetryMethodConfig(HedgingPolicy hedging_policy)
+      : hedging_policy_(hedging_policy) {}
+
   int max_attempts() const { return max_attempts_; }
   Duration initial_backoff() const { return initial_backoff_; }
   Duration max_backoff() const { return max_backoff_; }
@@ -64,6 +88,11 @@ class RetryMethodConfig final : public ServiceConfigParser::ParsedConfig {
   absl::optional<Duration> per_attempt_recv_timeout() const {
     return per_attempt_recv_timeout_;
   }
+  // Set if the method is hedged rather than retried, in which case none of
+  // the other fields are used.
+  const absl::optional<HedgingPolicy>& hedging_policy() const {
+    return hedging_policy_;
+  }
 
   static const JsonLoaderInterface* JsonLoader(const JsonArgs&);
   void JsonPostLoad(const Json& json, const JsonArgs& args,
@@ -76,6 +105,7 @@ class RetryMethodConfig final : public ServiceConfigParser::ParsedConfig {
   float backoff_multiplier_ = 0;
   StatusCodeSet retryable_status_codes_;
   absl::optional<Duration> per_attempt_recv_timeout_;
+  absl::optional<HedgingPolicy> hedging_policy_;
 };
 
 class RetryServiceConfigParser final : public ServiceConfigParser::Parser {
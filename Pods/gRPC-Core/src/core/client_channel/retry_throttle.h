@@ -49,6 +49,10 @@ class ServerRetryThrottleData final
   /// Records a success.
   void RecordSuccess();
 
+  /// Returns true if it's okay to send a retry or hedged attempt, without
+  /// recording anything.
+  bool RetriesAllowed();
+
   uintptr_t max_milli_tokens() const { return max_milli_tokens_; }
   uintptr_t milli_token_ratio() const { return milli_token_ratio_; }
 
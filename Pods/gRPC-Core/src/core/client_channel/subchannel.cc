@@ -78,6 +78,10 @@
 #define GRPC_SUBCHANNEL_RECONNECT_MAX_BACKOFF_SECONDS 120
 #define GRPC_SUBCHANNEL_RECONNECT_JITTER 0.2
 
+// How long an extra connection may go without calls before it is closed, at
+// most twice as long.
+#define GRPC_SUBCHANNEL_EXTRA_CONNECTION_IDLE_SECONDS 30
+
 // Conversion between subchannel call and call stack.
 #define SUBCHANNEL_CALL_TO_CALL_STACK(call) \
   (grpc_call_stack*)((char*)(call) +        \
@@ -94,11 +98,13 @@ using ::grpc_event_engine::experimental::EventEngine;
 // ConnectedSubchannel
 //
 
-ConnectedSubchannel::ConnectedSubchannel(const ChannelArgs& args)
+ConnectedSubchannel::ConnectedSubchannel(const ChannelArgs& args,
+                                         RefCountedPtr<ConnectionLoad> load)
     : RefCounted<ConnectedSubchannel>(
           GRPC_TRACE_FLAG_ENABLED(subchannel_refcount) ? "ConnectedSubchannel"
                                                        : nullptr),
-      args_(args) {}
+      args_(args),
+      load_(std::move(load)) {}
 
 //
 // LegacyConnectedSubchannel
@@ -108,8 +114,9 @@ class LegacyConnectedSubchannel : public ConnectedSubchannel {
  public:
   LegacyConnectedSubchannel(
       RefCountedPtr<grpc_channel_stack> channel_stack, const ChannelArgs& args,
+      RefCountedPtr<ConnectionLoad> load,
       RefCountedPtr<channelz::SubchannelNode> channelz_node)
-      : ConnectedSubchannel(args),
+      : ConnectedSubchannel(args, std::move(load)),
         channelz_node_(std::move(channelz_node)),
         channel_stack_(std::move(channel_stack)) {}
 
@@ -191,8 +198,8 @@ class NewConnectedSubchannel : public ConnectedSubchannel {
   NewConnectedSubchannel(
       RefCountedPtr<UnstartedCallDestination> call_destination,
       RefCountedPtr<TransportCallDestination> transport,
-      const ChannelArgs& args)
-      : ConnectedSubchannel(args),
+      const ChannelArgs& args, RefCountedPtr<ConnectionLoad> load)
+      : ConnectedSubchannel(args, std::move(load)),
         call_destination_(std::move(call_destination)),
         transport_(std::move(transport)) {}
 
@@ -242,6 +249,7 @@ SubchannelCall::SubchannelCall(Args args, grpc_error_handle* error)
     : connected_subchannel_(args.connected_subchannel
                                 .TakeAsSubclass<LegacyConnectedSubchannel>()),
       deadline_(args.deadline) {
+  connected_subchannel_->load()->AddCall();
   grpc_call_stack* callstk = SUBCHANNEL_CALL_TO_CALL_STACK(this);
   const grpc_call_element_args call_args = {
       callstk,              // call_stack
@@ -312,6 +320,7 @@ void SubchannelCall::Destroy(void* arg, grpc_error_handle /*error*/) {
   grpc_closure* after_call_stack_destroy = self->after_call_stack_destroy_;
   RefCountedPtr<ConnectedSubchannel> connected_subchannel =
       std::move(self->connected_subchannel_);
+  connected_subchannel->load()->RemoveCall();
   // Destroy the subchannel call.
   self->~SubchannelCall();
   // Destroy the call stack. This should be after destroying the subchannel
@@ -389,9 +398,11 @@ void SubchannelCall::IncrementRefCount(const DebugLocation& /*location*/,
 class Subchannel::ConnectedSubchannelStateWatcher final
     : public AsyncConnectivityStateWatcherInterface {
  public:
-  // Must be instantiated while holding c->mu.
-  explicit ConnectedSubchannelStateWatcher(WeakRefCountedPtr<Subchannel> c)
-      : subchannel_(std::move(c)) {}
+  // Must be instantiated while holding c->mu.  Watches the connection whose
+  // load is `load`.
+  ConnectedSubchannelStateWatcher(WeakRefCountedPtr<Subchannel> c,
+                                  RefCountedPtr<ConnectionLoad> load)
+      : subchannel_(std::move(c)), load_(std::move(load)) {}
 
   ~ConnectedSubchannelStateWatcher() override {
     subchannel_.reset(DEBUG_LOCATION, "state_watcher");
@@ -404,38 +415,68 @@ class Subchannel::ConnectedSubchannelStateWatcher final
     {
       MutexLock lock(&c->mu_);
       // If we're either shutting down or have already seen this connection
-      // failure (i.e., c->connected_subchannel_ is null), do nothing.
+      // failure (i.e., the connection is no longer one of the subchannel's),
+      // do nothing.
       //
       // The transport reports TRANSIENT_FAILURE upon GOAWAY but SHUTDOWN
       // upon connection close.  So if the server gracefully shuts down,
       // we will see TRANSIENT_FAILURE followed by SHUTDOWN, but if not, we
       // will see only SHUTDOWN.  Either way, we react to the first one we
       // see, ignoring anything that happens after that.
-      if (c->connected_subchannel_ == nullptr) return;
-      if (new_state == GRPC_CHANNEL_TRANSIENT_FAILURE ||
-          new_state == GRPC_CHANNEL_SHUTDOWN) {
-        GRPC_TRACE_LOG(subchannel, INFO)
-            << "subchannel " << c << " " << c->key_.ToString()
-            << ": Connected subchannel " << c->connected_subchannel_.get()
-            << " reports " << ConnectivityStateName(new_state) << ": "
-            << status;
-        c->connected_subchannel_.reset();
+      if (new_state != GRPC_CHANNEL_TRANSIENT_FAILURE &&
+          new_state != GRPC_CHANNEL_SHUTDOWN) {
+        return;
+      }
+      if (c->connected_subchannel_ == nullptr ||
+          c->connected_subchannel_->load() != load_.get()) {
+        auto it = std::find_if(
+            c->extra_connections_.begin(), c->extra_connections_.end(),
+            [this](const ExtraConnection& extra) {
+              return extra.connected_subchannel->load() == load_.get();
+            });
+        if (it != c->extra_connections_.end()) {
+          GRPC_TRACE_LOG(subchannel, INFO)
+              << "subchannel " << c << " " << c->key_.ToString()
+              << ": extra connected subchannel "
+              << it->connected_subchannel.get() << " reports "
+              << ConnectivityStateName(new_state) << ": " << status;
+          c->extra_connections_.erase(it);
+        }
+        return;
+      }
+      GRPC_TRACE_LOG(subchannel, INFO)
+          << "subchannel " << c << " " << c->key_.ToString()
+          << ": Connected subchannel " << c->connected_subchannel_.get()
+          << " reports " << ConnectivityStateName(new_state) << ": "
+          << status;
+      // An extra connection takes the place of the failed one, so that the
+      // subchannel stays READY.
+      if (!c->extra_connections_.empty()) {
+        ExtraConnection& extra = c->extra_connections_.front();
+        c->connected_subchannel_ = std::move(extra.connected_subchannel);
         if (c->channelz_node() != nullptr) {
-          c->channelz_node()->SetChildSocket(nullptr);
+          c->channelz_node()->SetChildSocket(std::move(extra.socket_node));
         }
-        // Even though we're reporting IDLE instead of TRANSIENT_FAILURE here,
-        // pass along the status from the transport, since it may have
-        // keepalive info attached to it that the channel needs.
-        // TODO(roth): Consider whether there's a cleaner way to do this.
-        c->SetConnectivityStateLocked(GRPC_CHANNEL_IDLE, status);
-        c->backoff_.Reset();
+        c->extra_connections_.erase(c->extra_connections_.begin());
+        return;
       }
+      c->connected_subchannel_.reset();
+      if (c->channelz_node() != nullptr) {
+        c->channelz_node()->SetChildSocket(nullptr);
+      }
+      // Even though we're reporting IDLE instead of TRANSIENT_FAILURE here,
+      // pass along the status from the transport, since it may have
+      // keepalive info attached to it that the channel needs.
+      // TODO(roth): Consider whether there's a cleaner way to do this.
+      c->SetConnectivityStateLocked(GRPC_CHANNEL_IDLE, status);
+      c->backoff_.Reset();
     }
     // Drain any connectivity state notifications after releasing the mutex.
     c->work_serializer_.DrainQueue();
   }
 
   WeakRefCountedPtr<Subchannel> subchannel_;
+  RefCountedPtr<ConnectionLoad> load_;
 };
 
 //
@@ -518,6 +559,9 @@ Subchannel::Subchannel(SubchannelKey key,
       key_(std::move(key)),
       args_(args),
       pollset_set_(grpc_pollset_set_create()),
+      max_connections_(static_cast<size_t>(std::max(
+          1, args_.GetInt(GRPC_ARG_MAX_CONNECTIONS_PER_SUBCHANNEL)
+                 .value_or(1)))),
       connector_(std::move(connector)),
       watcher_list_(this),
       work_serializer_(args_.GetObjectRef<EventEngine>()),
@@ -535,6 +579,8 @@ Subchannel::Subchannel(SubchannelKey key,
   global_stats().IncrementClientSubchannelsCreated();
   GRPC_CLOSURE_INIT(&on_connecting_finished_, OnConnectingFinished, this,
                     grpc_schedule_on_exec_ctx);
+  GRPC_CLOSURE_INIT(&on_extra_connecting_finished_, OnExtraConnectingFinished,
+                    this, grpc_schedule_on_exec_ctx);
   // Check proxy mapper to determine address to connect to and channel
   // args to use.
   address_for_connect_ = CoreConfiguration::Get()
@@ -557,6 +603,11 @@ Subchannel::Subchannel(SubchannelKey key,
         channelz::ChannelTrace::Severity::Info,
         grpc_slice_from_static_string("subchannel created"));
   }
+  if (args_.GetBool(GRPC_ARG_ENABLE_CHANNELZ_COUNTERS).value_or(false)) {
+    channelz_counters_ = MakeRefCounted<channelz::SubchannelCounters>(
+        grpc_sockaddr_to_uri(&key_.address())
+            .value_or("<unknown address type>"));
+  }
 }
 
 Subchannel::~Subchannel() {
@@ -689,11 +740,37 @@ void Subchannel::Orphaned() {
     shutdown_ = true;
     connector_.reset();
     connected_subchannel_.reset();
+    extra_connector_.reset();
+    extra_connections_.clear();
+    if (idle_timer_handle_.has_value()) {
+      event_engine_->Cancel(*idle_timer_handle_);
+      idle_timer_handle_.reset();
+    }
   }
   // Drain any connectivity state notifications after releasing the mutex.
   work_serializer_.DrainQueue();
 }
 
+RefCountedPtr<ConnectedSubchannel> Subchannel::PickConnectedSubchannel() {
+  MutexLock lock(&mu_);
+  if (connected_subchannel_ == nullptr || max_connections_ == 1 ||
+      !connected_subchannel_->load()->saturated()) {
+    return connected_subchannel_;
+  }
+  ConnectedSubchannel* least_loaded = connected_subchannel_.get();
+  for (const ExtraConnection& extra : extra_connections_) {
+    ConnectionLoad* load = extra.connected_subchannel->load();
+    if (!load->saturated()) return extra.connected_subchannel;
+    if (load->calls() < least_loaded->load()->calls()) {
+      least_loaded = extra.connected_subchannel.get();
+    }
+  }
+  // Every connection is saturated, so the call waits for a stream on
+  // whichever connection it goes to.
+  MaybeStartExtraConnectingLocked();
+  return least_loaded->Ref();
+}
+
 void Subchannel::GetOrAddDataProducer(
     UniqueTypeName type,
     std::function<void(DataProducerInterface**)> get_or_add) {
@@ -772,6 +849,13 @@ void Subchannel::StartConnectingLocked() {
   args.interested_parties = pollset_set_;
   args.deadline = std::max(next_attempt_time_, min_deadline);
   args.channel_args = args_;
+  connecting_load_ = MakeRefCounted<ConnectionLoad>();
+  if (max_connections_ > 1) {
+    args.channel_args = args.channel_args.SetObject(connecting_load_);
+  }
+  if (channelz_counters_ != nullptr) {
+    channelz_counters_->RecordConnectionAttempt();
+  }
   WeakRef(DEBUG_LOCATION, "Connect").release();  // Ref held by callback.
   connector_->Connect(args, &connecting_result_, &on_connecting_finished_);
 }
@@ -804,6 +888,9 @@ void Subchannel::OnConnectingFinishedLocked(grpc_error_handle error) {
         << "subchannel " << this << " " << key_.ToString()
         << ": connect failed (" << StatusToString(error)
         << "), backing off for " << time_until_next_attempt.millis() << " ms";
+    if (channelz_counters_ != nullptr) {
+      channelz_counters_->RecordConnectionFailure();
+    }
     SetConnectivityStateLocked(GRPC_CHANNEL_TRANSIENT_FAILURE,
                                grpc_error_to_absl_status(error));
     retry_timer_handle_ = event_engine_->RunAfter(
@@ -827,31 +914,53 @@ void Subchannel::OnConnectingFinishedLocked(grpc_error_handle error) {
 
 bool Subchannel::PublishTransportLocked() {
   auto socket_node = std::move(connecting_result_.socket_node);
-  if (connecting_result_.transport->filter_stack_transport() != nullptr) {
+  connected_subchannel_ = CreateConnectedSubchannelLocked(
+      &connecting_result_, std::move(connecting_load_));
+  if (connected_subchannel_ == nullptr) return false;
+  // Publish.
+  GRPC_TRACE_LOG(subchannel, INFO)
+      << "subchannel " << this << " " << key_.ToString()
+      << ": new connected subchannel at " << connected_subchannel_.get();
+  if (channelz_node_ != nullptr) {
+    channelz_node_->SetChildSocket(std::move(socket_node));
+  }
+  // Start watching connected subchannel.
+  connected_subchannel_->StartWatch(
+      pollset_set_, MakeOrphanable<ConnectedSubchannelStateWatcher>(
+                        WeakRef(DEBUG_LOCATION, "state_watcher"),
+                        connected_subchannel_->load()->Ref()));
+  // Report initial state.
+  SetConnectivityStateLocked(GRPC_CHANNEL_READY, absl::Status());
+  return true;
+}
+
+RefCountedPtr<ConnectedSubchannel> Subchannel::CreateConnectedSubchannelLocked(
+    SubchannelConnector::Result* result, RefCountedPtr<ConnectionLoad> load) {
+  RefCountedPtr<ConnectedSubchannel> connected_subchannel;
+  if (result->transport->filter_stack_transport() != nullptr) {
     // Construct channel stack.
     // Builder takes ownership of transport.
     ChannelStackBuilderImpl builder(
         "subchannel", GRPC_CLIENT_SUBCHANNEL,
-        connecting_result_.channel_args.SetObject(
-            std::exchange(connecting_result_.transport, nullptr)));
+        result->channel_args.SetObject(
+            std::exchange(result->transport, nullptr)));
     if (!CoreConfiguration::Get().channel_init().CreateStack(&builder)) {
-      return false;
+      return nullptr;
     }
     absl::StatusOr<RefCountedPtr<grpc_channel_stack>> stack = builder.Build();
     if (!stack.ok()) {
-      connecting_result_.Reset();
+      result->Reset();
       LOG(ERROR) << "subchannel " << this << " " << key_.ToString()
                  << ": error initializing subchannel stack: " << stack.status();
-      return false;
+      return nullptr;
     }
-    connected_subchannel_ = MakeRefCounted<LegacyConnectedSubchannel>(
-        std::move(*stack), args_, channelz_node_);
+    connected_subchannel = MakeRefCounted<LegacyConnectedSubchannel>(
+        std::move(*stack), args_, std::move(load), channelz_node_);
   } else {
     OrphanablePtr<ClientTransport> transport(
-        std::exchange(connecting_result_.transport, nullptr)
-            ->client_transport());
+        std::exchange(result->transport, nullptr)->client_transport());
     InterceptionChainBuilder builder(
-        connecting_result_.channel_args.SetObject(transport.get()));
+        result->channel_args.SetObject(transport.get()));
     if (channelz_node_ != nullptr) {
       // TODO(ctiller): If/when we have a good way to access the subchannel
       // from a filter (maybe GetContext<Subchannel>?), consider replacing
@@ -877,30 +986,132 @@ bool Subchannel::PublishTransportLocked() {
             std::move(transport));
     auto call_destination = builder.Build(transport_destination);
     if (!call_destination.ok()) {
-      connecting_result_.Reset();
+      result->Reset();
       LOG(ERROR) << "subchannel " << this << " " << key_.ToString()
                  << ": error initializing subchannel stack: "
                  << call_destination.status();
-      return false;
+      return nullptr;
     }
-    connected_subchannel_ = MakeRefCounted<NewConnectedSubchannel>(
-        std::move(*call_destination), std::move(transport_destination), args_);
+    connected_subchannel = MakeRefCounted<NewConnectedSubchannel>(
+        std::move(*call_destination), std::move(transport_destination), args_,
+        std::move(load));
   }
-  connecting_result_.Reset();
-  // Publish.
+  result->Reset();
+  return connected_subchannel;
+}
+
+void Subchannel::MaybeStartExtraConnectingLocked() {
+  if (shutdown_ || extra_connector_ != nullptr ||
+      1 + extra_connections_.size() >= max_connections_ ||
+      Timestamp::Now() < next_extra_attempt_time_) {
+    return;
+  }
+  extra_connector_ = connector_->Clone();
+  if (extra_connector_ == nullptr) return;
   GRPC_TRACE_LOG(subchannel, INFO)
       << "subchannel " << this << " " << key_.ToString()
-      << ": new connected subchannel at " << connected_subchannel_.get();
-  if (channelz_node_ != nullptr) {
-    channelz_node_->SetChildSocket(std::move(socket_node));
+      << ": all connections saturated, starting extra connection attempt";
+  extra_connecting_load_ = MakeRefCounted<ConnectionLoad>();
+  SubchannelConnector::Args args;
+  args.address = &address_for_connect_;
+  args.interested_parties = pollset_set_;
+  args.deadline = Timestamp::Now() + min_connect_timeout_;
+  args.channel_args = args_.SetObject(extra_connecting_load_);
+  if (channelz_counters_ != nullptr) {
+    channelz_counters_->RecordConnectionAttempt();
   }
-  // Start watching connected subchannel.
-  connected_subchannel_->StartWatch(
+  // Ref held by callback.
+  WeakRef(DEBUG_LOCATION, "ExtraConnect").release();
+  extra_connector_->Connect(args, &extra_connecting_result_,
+                            &on_extra_connecting_finished_);
+}
+
+void Subchannel::OnExtraConnectingFinished(void* arg,
+                                           grpc_error_handle error) {
+  WeakRefCountedPtr<Subchannel> c(static_cast<Subchannel*>(arg));
+  {
+    MutexLock lock(&c->mu_);
+    c->OnExtraConnectingFinishedLocked(error);
+  }
+  c.reset(DEBUG_LOCATION, "ExtraConnect");
+}
+
+void Subchannel::OnExtraConnectingFinishedLocked(grpc_error_handle error) {
+  extra_connector_.reset();
+  RefCountedPtr<ConnectionLoad> load = std::move(extra_connecting_load_);
+  // The extra connection is not needed if the subchannel has lost its main
+  // connection in the meantime; the next one starts out alone.
+  if (shutdown_ || connected_subchannel_ == nullptr) {
+    extra_connecting_result_.Reset();
+    return;
+  }
+  auto socket_node = std::move(extra_connecting_result_.socket_node);
+  RefCountedPtr<ConnectedSubchannel> connected_subchannel;
+  if (extra_connecting_result_.transport != nullptr) {
+    connected_subchannel = CreateConnectedSubchannelLocked(
+        &extra_connecting_result_, std::move(load));
+  }
+  if (connected_subchannel == nullptr) {
+    GRPC_TRACE_LOG(subchannel, INFO)
+        << "subchannel " << this << " " << key_.ToString()
+        << ": extra connection attempt failed (" << StatusToString(error)
+        << ")";
+    if (channelz_counters_ != nullptr) {
+      channelz_counters_->RecordConnectionFailure();
+    }
+    next_extra_attempt_time_ = Timestamp::Now() + min_connect_timeout_;
+    return;
+  }
+  GRPC_TRACE_LOG(subchannel, INFO)
+      << "subchannel " << this << " " << key_.ToString()
+      << ": new extra connected subchannel at " << connected_subchannel.get();
+  connected_subchannel->StartWatch(
       pollset_set_, MakeOrphanable<ConnectedSubchannelStateWatcher>(
-                        WeakRef(DEBUG_LOCATION, "state_watcher")));
-  // Report initial state.
-  SetConnectivityStateLocked(GRPC_CHANNEL_READY, absl::Status());
-  return true;
+                        WeakRef(DEBUG_LOCATION, "state_watcher"),
+                        connected_subchannel->load()->Ref()));
+  extra_connections_.push_back(
+      {std::move(connected_subchannel), std::move(socket_node)});
+  MaybeStartIdleTimerLocked();
+}
+
+void Subchannel::MaybeStartIdleTimerLocked() {
+  if (idle_timer_handle_.has_value() || extra_connections_.empty()) return;
+  idle_timer_handle_ = event_engine_->RunAfter(
+      Duration::Seconds(GRPC_SUBCHANNEL_EXTRA_CONNECTION_IDLE_SECONDS),
+      [self = WeakRef(DEBUG_LOCATION, "IdleTimer")]() mutable {
+        ApplicationCallbackExecCtx callback_exec_ctx;
+        ExecCtx exec_ctx;
+        self->OnIdleTimer();
+        // Subchannel deletion might require an active ExecCtx.
+        self.reset();
+      });
+}
+
+void Subchannel::OnIdleTimer() {
+  MutexLock lock(&mu_);
+  idle_timer_handle_.reset();
+  if (shutdown_) return;
+  // Closes the extra connections that carried no calls at this check and the
+  // one before it.
+  extra_connections_.erase(
+      std::remove_if(extra_connections_.begin(), extra_connections_.end(),
+                     [this](ExtraConnection& extra) {
+                       if (extra.connected_subchannel->load()->calls() > 0) {
+                         extra.idle = false;
+                         return false;
+                       }
+                       if (!extra.idle) {
+                         extra.idle = true;
+                         return false;
+                       }
+                       GRPC_TRACE_LOG(subchannel, INFO)
+                           << "subchannel " << this << " " << key_.ToString()
+                           << ": closing idle extra connected subchannel "
+                           << extra.connected_subchannel.get();
+                       return true;
+                     }),
+      extra_connections_.end());
+  MaybeStartIdleTimerLocked();
 }
 
 ChannelArgs Subchannel::MakeSubchannelArgs(
@@ -25,9 +25,12 @@
 #include <functional>
 #include <map>
 #include <memory>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
+#include "absl/types/optional.h"
+#include "src/core/channelz/connection_counters.h"
 #include "src/core/client_channel/connector.h"
 #include "src/core/client_channel/subchannel_pool_interface.h"
 #include "src/core/lib/address_utils/sockaddr_utils.h"
@@ -42,6 +45,7 @@
 #include "src/core/lib/promise/arena_promise.h"
 #include "src/core/lib/resource_quota/arena.h"
 #include "src/core/lib/slice/slice.h"
+#include "src/core/lib/transport/connection_load.h"
 #include "src/core/lib/transport/connectivity_state.h"
 #include "src/core/lib/transport/metadata_batch.h"
 #include "src/core/lib/transport/transport.h"
@@ -65,6 +69,9 @@ class ConnectedSubchannel : public RefCounted<ConnectedSubchannel> {
  public:
   const ChannelArgs& args() const { return args_; }
 
+  // The calls the connection carries, against the limit its peer sets.
+  ConnectionLoad* load() const { return load_.get(); }
+
   virtual void StartWatch(
       grpc_pollset_set* interested_parties,
       OrphanablePtr<ConnectivityStateWatcherInterface> watcher) = 0;
@@ -80,10 +87,12 @@ class ConnectedSubchannel : public RefCounted<ConnectedSubchannel> {
   virtual void Ping(grpc_closure* on_initiate, grpc_closure* on_ack) = 0;
 
  protected:
-  explicit ConnectedSubchannel(const ChannelArgs& args);
+  ConnectedSubchannel(const ChannelArgs& args,
+                      RefCountedPtr<ConnectionLoad> load);
 
  private:
   ChannelArgs args_;
+  RefCountedPtr<ConnectionLoad> load_;
 };
 
 class LegacyConnectedSubchannel;
@@ -239,6 +248,13 @@ class Subchannel final : public DualRefCounted<Subchannel> {
     return connected_subchannel_;
   }
 
+  // Returns the connection to start a call on: the first one that is not
+  // saturated, or else the least loaded one, in which case another
+  // connection is opened if GRPC_ARG_MAX_CONNECTIONS_PER_SUBCHANNEL allows.
+  // Same as connected_subchannel() for subchannels with one connection.
+  RefCountedPtr<ConnectedSubchannel> PickConnectedSubchannel()
+      ABSL_LOCKS_EXCLUDED(mu_);
+
   RefCountedPtr<UnstartedCallDestination> call_destination() {
     MutexLock lock(&mu_);
     if (connected_subchannel_ == nullptr) return nullptr;
@@ -316,6 +332,15 @@ class Subchannel final : public DualRefCounted<Subchannel> {
 
   class ConnectedSubchannelStateWatcher;
 
+  // A connection opened besides connected_subchannel_ while every other
+  // connection was saturated.
+  struct ExtraConnection {
+    RefCountedPtr<ConnectedSubchannel> connected_subchannel;
+    RefCountedPtr<channelz::SocketNode> socket_node;
+    // Whether the connection carried no calls at the last idle check.
+    bool idle = false;
+  };
+
   // Sets the subchannel's connectivity state to \a state.
   void SetConnectivityStateLocked(grpc_connectivity_state state,
                                   const absl::Status& status)
@@ -330,6 +355,18 @@ class Subchannel final : public DualRefCounted<Subchannel> {
   void OnConnectingFinishedLocked(grpc_error_handle error)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   bool PublishTransportLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  RefCountedPtr<ConnectedSubchannel> CreateConnectedSubchannelLocked(
+      SubchannelConnector::Result* result, RefCountedPtr<ConnectionLoad> load)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Methods for connections beyond the first.
+  void MaybeStartExtraConnectingLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  static void OnExtraConnectingFinished(void* arg, grpc_error_handle error)
+      ABSL_LOCKS_EXCLUDED(mu_);
+  void OnExtraConnectingFinishedLocked(grpc_error_handle error)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void MaybeStartIdleTimerLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void OnIdleTimer() ABSL_LOCKS_EXCLUDED(mu_);
 
   // The subchannel pool this subchannel is in.
   RefCountedPtr<SubchannelPoolInterface> subchannel_pool_;
@@ -344,12 +381,16 @@ class Subchannel final : public DualRefCounted<Subchannel> {
   grpc_pollset_set* pollset_set_;
   // Channelz tracking.
   RefCountedPtr<channelz::SubchannelNode> channelz_node_;
+  RefCountedPtr<channelz::SubchannelCounters> channelz_counters_;
   // Minimum connection timeout.
   Duration min_connect_timeout_;
+  // The most connections to keep open to the address.
+  const size_t max_connections_;
 
   // Connection state.
   OrphanablePtr<SubchannelConnector> connector_;
   SubchannelConnector::Result connecting_result_;
+  RefCountedPtr<ConnectionLoad> connecting_load_;
   grpc_closure on_connecting_finished_;
 
   // Protects the other members.
@@ -374,6 +415,21 @@ class Subchannel final : public DualRefCounted<Subchannel> {
   // Active connection, or null.
   RefCountedPtr<ConnectedSubchannel> connected_subchannel_ ABSL_GUARDED_BY(mu_);
 
+  // Connections beyond the first, which are only open while
+  // connected_subchannel_ is.  If connected_subchannel_ fails, the first of
+  // them takes its place.
+  std::vector<ExtraConnection> extra_connections_ ABSL_GUARDED_BY(mu_);
+  // The connector of the one extra connection attempt that may be in
+  // progress at a time, or null.
+  OrphanablePtr<SubchannelConnector> extra_connector_ ABSL_GUARDED_BY(mu_);
+  SubchannelConnector::Result extra_connecting_result_ ABSL_GUARDED_BY(mu_);
+  RefCountedPtr<ConnectionLoad> extra_connecting_load_ ABSL_GUARDED_BY(mu_);
+  grpc_closure on_extra_connecting_finished_;
+  // No extra connection is attempted before this time after one failed.
+  Timestamp next_extra_attempt_time_ ABSL_GUARDED_BY(mu_);
+  absl::optional<grpc_event_engine::experimental::EventEngine::TaskHandle>
+      idle_timer_handle_ ABSL_GUARDED_BY(mu_);
+
   // Backoff state.
   BackOff backoff_ ABSL_GUARDED_BY(mu_);
   Timestamp next_attempt_time_ ABSL_GUARDED_BY(mu_);
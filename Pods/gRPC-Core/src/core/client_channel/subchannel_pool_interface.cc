@@ -47,6 +47,13 @@ bool SubchannelKey::operator<(const SubchannelKey& other) const {
   return args_ < other.args();
 }
 
+bool SubchannelKey::operator==(const SubchannelKey& other) const {
+  // The args are compared last, as comparing them can walk them in full.
+  return address_.len == other.address_.len &&
+         memcmp(address_.addr, other.address_.addr, address_.len) == 0 &&
+         args_ == other.args_;
+}
+
 std::string SubchannelKey::ToString() const {
   auto addr_uri = grpc_sockaddr_to_uri(&address_);
   return absl::StrCat(
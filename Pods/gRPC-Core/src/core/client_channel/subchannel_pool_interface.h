@@ -22,6 +22,7 @@
 #include <grpc/support/port_platform.h>
 
 #include <string>
+#include <utility>
 
 #include "absl/strings/string_view.h"
 #include "src/core/lib/channel/channel_args.h"
@@ -46,6 +47,15 @@ class SubchannelKey final {
   SubchannelKey& operator=(SubchannelKey&& other) noexcept = default;
 
   bool operator<(const SubchannelKey& other) const;
+  bool operator==(const SubchannelKey& other) const;
+
+  template <typename H>
+  friend H AbslHashValue(H h, const SubchannelKey& key) {
+    return H::combine(
+        std::move(h),
+        absl::string_view(key.address_.addr, key.address_.len),
+        key.args_.Hash());
+  }
 
   const grpc_resolved_address& address() const { return address_; }
   const ChannelArgs& args() const { return args_; }
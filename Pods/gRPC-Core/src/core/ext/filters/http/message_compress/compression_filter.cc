@@ -21,7 +21,9 @@
 #include <grpc/support/port_platform.h>
 #include <inttypes.h>
 
+#include <algorithm>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <utility>
 
@@ -91,6 +93,11 @@ ChannelCompression::ChannelCompression(const ChannelArgs& args)
           CompressionAlgorithmSet::FromChannelArgs(args)),
       enable_compression_(
           args.GetBool(GRPC_ARG_ENABLE_PER_MESSAGE_COMPRESSION).value_or(true)),
+      min_message_size_to_compress_(std::max(
+          0, args.GetInt(GRPC_ARG_MIN_MESSAGE_SIZE_TO_COMPRESS).value_or(0))),
+      skip_incompressible_messages_(
+          args.GetBool(GRPC_ARG_SKIP_COMPRESSING_INCOMPRESSIBLE_MESSAGES)
+              .value_or(false)),
       enable_decompression_(
           args.GetBool(GRPC_ARG_ENABLE_PER_MESSAGE_DECOMPRESSION)
               .value_or(true)) {
@@ -124,9 +131,17 @@ MessageHandle ChannelCompression::CompressMessage(
       (flags & (GRPC_WRITE_NO_COMPRESS | GRPC_WRITE_INTERNAL_COMPRESS))) {
     return message;
   }
+  // Skip messages that would not be worth compressing.
+  SliceBuffer* payload = message->payload();
+  if (payload->Length() < min_message_size_to_compress_ ||
+      (skip_incompressible_messages_ &&
+       grpc_msg_looks_incompressible(payload->c_slice_buffer()))) {
+    GRPC_TRACE_LOG(compression, INFO)
+        << "Not compressing message: len=" << payload->Length();
+    return message;
+  }
   // Try to compress the payload.
   SliceBuffer tmp;
-  SliceBuffer* payload = message->payload();
   bool did_compress = grpc_msg_compress(algorithm, payload->c_slice_buffer(),
                                         tmp.c_slice_buffer());
   // If we achieved compression send it as compressed, otherwise send it as (to
@@ -186,10 +201,22 @@ absl::StatusOr<MessageHandle> ChannelCompression::DecompressMessage(
       (message->flags() & GRPC_WRITE_INTERNAL_COMPRESS) == 0) {
     return std::move(message);
   }
-  // Try to decompress the payload.
+  // Try to decompress the payload. The max message length also applies to
+  // the decompressed message, and inflating stops as soon as it is exceeded.
   SliceBuffer decompressed_slices;
-  if (grpc_msg_decompress(args.algorithm, message->payload()->c_slice_buffer(),
-                          decompressed_slices.c_slice_buffer()) == 0) {
+  const size_t max_decompressed_length =
+      args.max_recv_message_length.has_value()
+          ? static_cast<size_t>(*args.max_recv_message_length)
+          : std::numeric_limits<size_t>::max();
+  int r = grpc_msg_decompress_bounded(
+      args.algorithm, message->payload()->c_slice_buffer(),
+      decompressed_slices.c_slice_buffer(), max_decompressed_length);
+  if (r < 0) {
+    return absl::ResourceExhaustedError(absl::StrFormat(
+        "%s: Received message larger than max when decompressed (over %d)",
+        is_client ? "CLIENT" : "SERVER", *args.max_recv_message_length));
+  }
+  if (r == 0) {
     return absl::InternalError(
         absl::StrCat("Unexpected error decompressing data for algorithm ",
                      CompressionAlgorithmAsString(args.algorithm)));
@@ -25,6 +25,7 @@
 #include <utility>
 
 #include "absl/log/log.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_format.h"
 #include "src/core/config/core_configuration.h"
 #include "src/core/lib/channel/channel_args.h"
@@ -230,26 +231,57 @@ ServerMetadataHandle ClientMessageSizeFilter::Call::OnServerToClientMessage(
 }
 
 namespace {
-// Used for GRPC_CLIENT_DIRECT_CHANNEL and GRPC_SERVER_CHANNEL. Adds the
-// filter only if message size limits or service config is specified.
+// Whether the channel args set a message size limit.
 bool HasMessageSizeLimits(const ChannelArgs& channel_args) {
   MessageSizeParsedConfig limits =
       MessageSizeParsedConfig::GetFromChannelArgs(channel_args);
   return limits.max_send_size().has_value() ||
-         limits.max_recv_size().has_value() ||
-         channel_args.GetString(GRPC_ARG_SERVICE_CONFIG).has_value();
+         limits.max_recv_size().has_value();
+}
+
+// Whether the default service config in the channel args may set a
+// per-method message size limit. Both fields must appear by name in the
+// JSON to be set, so a config that mentions neither needs no filter.
+bool DefaultServiceConfigMayHaveMessageSizeLimits(
+    const ChannelArgs& channel_args) {
+  absl::optional<absl::string_view> service_config =
+      channel_args.GetString(GRPC_ARG_SERVICE_CONFIG);
+  return service_config.has_value() &&
+         (absl::StrContains(*service_config, "maxRequestMessageBytes") ||
+          absl::StrContains(*service_config, "maxResponseMessageBytes"));
+}
+
+// Used for GRPC_CLIENT_SUBCHANNEL. Unless the channel disables service
+// config resolution, the resolver may supply per-method limits at any time,
+// so the filter is then always added.
+bool MayHaveSubchannelMessageSizeLimits(const ChannelArgs& channel_args) {
+  return HasMessageSizeLimits(channel_args) ||
+         !channel_args.GetBool(GRPC_ARG_SERVICE_CONFIG_DISABLE_RESOLUTION)
+              .value_or(false) ||
+         DefaultServiceConfigMayHaveMessageSizeLimits(channel_args);
+}
+
+// Used for GRPC_CLIENT_DIRECT_CHANNEL, where the only service config is the
+// one in the channel args.
+bool MayHaveDirectChannelMessageSizeLimits(const ChannelArgs& channel_args) {
+  return HasMessageSizeLimits(channel_args) ||
+         DefaultServiceConfigMayHaveMessageSizeLimits(channel_args);
 }
 
 }  // namespace
 void RegisterMessageSizeFilter(CoreConfiguration::Builder* builder) {
   MessageSizeParser::Register(builder);
+  // Filters with no limit to enforce are left out of the stack, so that
+  // calls do not pay for them.
   builder->channel_init()
       ->RegisterFilter<ClientMessageSizeFilter>(GRPC_CLIENT_SUBCHANNEL)
-      .ExcludeFromMinimalStack();
+      .ExcludeFromMinimalStack()
+      .If(MayHaveSubchannelMessageSizeLimits);
   builder->channel_init()
       ->RegisterFilter<ClientMessageSizeFilter>(GRPC_CLIENT_DIRECT_CHANNEL)
       .ExcludeFromMinimalStack()
-      .If(HasMessageSizeLimits);
+      .If(MayHaveDirectChannelMessageSizeLimits);
+  // Servers have no per-method config, only the limits in the channel args.
   builder->channel_init()
       ->RegisterFilter<ServerMessageSizeFilter>(GRPC_SERVER_CHANNEL)
       .ExcludeFromMinimalStack()
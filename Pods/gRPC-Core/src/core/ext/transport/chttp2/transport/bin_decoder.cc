@@ -20,12 +20,23 @@
 
 #include <grpc/support/alloc.h>
 #include <grpc/support/port_platform.h>
+#include <string.h>
+
+#include <algorithm>
 
 #include "absl/base/attributes.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "src/core/lib/slice/slice.h"
 
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define GRPC_BASE64_NEON 1
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#define GRPC_BASE64_SSSE3 1
+#endif
+
 static uint8_t decode_table[] = {
     0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,
     0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,
@@ -99,6 +110,88 @@ size_t grpc_chttp2_base64_infer_length_after_decode(const grpc_slice& slice) {
   return (tuples * 3) + tail_xtra[tail_case];
 }
 
+size_t grpc_chttp2_base64_decode_blocks(const uint8_t* input, size_t length,
+                                        uint8_t* output) {
+  size_t decoded = 0;
+#if defined(GRPC_BASE64_NEON)
+  // 64 characters at a time, deinterleaved into the first to fourth
+  // characters of each group. Characters from 64 to 127 are looked up in the
+  // second half of the table, and those from 128 up are invalid.
+  const uint8x16x4_t table_lo = {
+      {vld1q_u8(decode_table), vld1q_u8(decode_table + 16),
+       vld1q_u8(decode_table + 32), vld1q_u8(decode_table + 48)}};
+  const uint8x16x4_t table_hi = {
+      {vld1q_u8(decode_table + 64), vld1q_u8(decode_table + 80),
+       vld1q_u8(decode_table + 96), vld1q_u8(decode_table + 112)}};
+  while (length - decoded >= 64) {
+    const uint8x16x4_t in = vld4q_u8(input + decoded);
+    uint8x16_t bits[4];
+    uint8x16_t invalid = vdupq_n_u8(0);
+    for (int i = 0; i < 4; ++i) {
+      bits[i] = vqtbx4q_u8(vqtbl4q_u8(table_lo, in.val[i]), table_hi,
+                           vsubq_u8(in.val[i], vdupq_n_u8(64)));
+      invalid = vorrq_u8(invalid, bits[i]);
+      invalid = vorrq_u8(invalid, vandq_u8(in.val[i], vdupq_n_u8(0x80)));
+    }
+    if (vmaxvq_u8(invalid) > 63) break;
+    uint8x16x3_t out;
+    out.val[0] = vorrq_u8(vshlq_n_u8(bits[0], 2), vshrq_n_u8(bits[1], 4));
+    out.val[1] = vorrq_u8(vshlq_n_u8(bits[1], 4), vshrq_n_u8(bits[2], 2));
+    out.val[2] = vorrq_u8(vshlq_n_u8(bits[2], 6), bits[3]);
+    vst3q_u8(output, out);
+    output += 48;
+    decoded += 64;
+  }
+#elif defined(GRPC_BASE64_SSSE3)
+  // 16 characters at a time. Each character's nibbles pick a bit from two
+  // small tables; a character is valid when the bits don't overlap, and its
+  // value is the character plus an offset picked by its high nibble.
+  const __m128i lut_lo =
+      _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                    0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+  const __m128i lut_hi =
+      _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10,
+                    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m128i lut_roll =
+      _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i mask_2f = _mm_set1_epi8(0x2f);
+  while (length - decoded >= 16) {
+    __m128i in =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + decoded));
+    const __m128i hi_nibbles =
+        _mm_and_si128(_mm_srli_epi32(in, 4), mask_2f);
+    const __m128i lo_nibbles = _mm_and_si128(in, mask_2f);
+    const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+    const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+    if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi),
+                                         _mm_setzero_si128())) != 0) {
+      break;
+    }
+    const __m128i eq_2f = _mm_cmpeq_epi8(in, mask_2f);
+    in = _mm_add_epi8(
+        in, _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi_nibbles)));
+    // Pack each 4 6-bit values into 3 bytes, in order.
+    const __m128i pairs =
+        _mm_maddubs_epi16(in, _mm_set1_epi32(0x01400140));
+    const __m128i groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+    const __m128i out = _mm_shuffle_epi8(
+        groups, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1,
+                              -1, -1));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(output), out);
+    const uint32_t last = static_cast<uint32_t>(
+        _mm_cvtsi128_si32(_mm_srli_si128(out, 8)));
+    memcpy(output + 8, &last, 4);
+    output += 12;
+    decoded += 16;
+  }
+#else
+  (void)input;
+  (void)length;
+  (void)output;
+#endif
+  return decoded;
+}
+
 bool grpc_base64_decode_partial(struct grpc_base64_decode_context* ctx) {
   size_t input_tail;
 
@@ -106,6 +199,15 @@ bool grpc_base64_decode_partial(struct grpc_base64_decode_context* ctx) {
     return false;
   }
 
+  // Decode what the vector unit can first, as far as the output has room.
+  size_t decoded = grpc_chttp2_base64_decode_blocks(
+      ctx->input_cur,
+      std::min(static_cast<size_t>(ctx->input_end - ctx->input_cur),
+               static_cast<size_t>(ctx->output_end - ctx->output_cur) / 3 * 4),
+      ctx->output_cur);
+  ctx->input_cur += decoded;
+  ctx->output_cur += decoded / 4 * 3;
+
   // Process a block of 4 input characters and 3 output bytes
   while (ctx->input_end >= ctx->input_cur + 4 &&
          ctx->output_end >= ctx->output_cur + 3) {
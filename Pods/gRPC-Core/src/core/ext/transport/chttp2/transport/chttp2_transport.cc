@@ -52,6 +52,7 @@
 #include "absl/strings/cord.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
 #include "absl/types/variant.h"
@@ -215,6 +216,8 @@ static void finish_keepalive_ping(
 static void finish_keepalive_ping_locked(
     grpc_core::RefCountedPtr<grpc_chttp2_transport> t, grpc_error_handle error);
 static void maybe_reset_keepalive_ping_timer_locked(grpc_chttp2_transport* t);
+static void maybe_send_keepalive_ping_with_write_locked(
+    grpc_chttp2_transport* t);
 
 static void send_goaway(grpc_chttp2_transport* t, grpc_error_handle error,
                         bool immediate_disconnect_hint);
@@ -432,11 +435,21 @@ static void read_channel_args(grpc_chttp2_transport* t,
       channel_args.GetInt(GRPC_ARG_HTTP2_HPACK_TABLE_SIZE_ENCODER).value_or(-1);
   if (max_hpack_table_size >= 0) {
     t->hpack_compressor.SetMaxUsableSize(max_hpack_table_size);
+    t->configured_hpack_encoder_table_size = max_hpack_table_size;
+  }
+  const auto hpack_pinned_keys =
+      channel_args.GetString(GRPC_ARG_HTTP2_HPACK_PINNED_KEYS);
+  if (hpack_pinned_keys.has_value()) {
+    t->hpack_compressor.SetPinnedKeys(absl::StrSplit(
+        *hpack_pinned_keys, ',', absl::SkipWhitespace()));
   }
 
   t->write_buffer_size =
       std::max(0, channel_args.GetInt(GRPC_ARG_HTTP2_WRITE_BUFFER_SIZE)
                       .value_or(grpc_core::chttp2::kDefaultWindow));
+  t->write_coalescing_delay = grpc_core::Duration::Milliseconds(
+      std::max(0, channel_args.GetInt(GRPC_ARG_HTTP2_WRITE_COALESCING_DELAY_MS)
+                      .value_or(0)));
   t->keepalive_time =
       std::max(grpc_core::Duration::Milliseconds(1),
                channel_args.GetDurationFromIntMillis(GRPC_ARG_KEEPALIVE_TIME_MS)
@@ -498,6 +511,12 @@ static void read_channel_args(grpc_chttp2_transport* t,
             channel_args
                 .GetObjectRef<grpc_core::channelz::SocketNode::Security>());
   }
+  if (channel_args.GetBool(GRPC_ARG_ENABLE_CHANNELZ_COUNTERS).value_or(false)) {
+    t->channelz_counters =
+        grpc_core::MakeRefCounted<grpc_core::channelz::SocketCounters>(
+            std::string(grpc_endpoint_get_local_address(t->ep.get())),
+            std::string(t->peer_string.as_string_view()));
+  }
 
   t->ack_pings = channel_args.GetBool("grpc.http2.ack_pings").value_or(true);
 
@@ -531,6 +550,8 @@ static void read_channel_args(grpc_chttp2_transport* t,
   if (value >= 0) {
     t->settings.mutable_local().SetHeaderTableSize(value);
   }
+  t->configured_hpack_decoder_table_size =
+      t->settings.local().header_table_size();
   t->settings.mutable_local().SetMaxHeaderListSize(
       grpc_core::GetHardLimitFromChannelArgs(channel_args));
   value = channel_args.GetInt(GRPC_ARG_HTTP2_MAX_FRAME_SIZE).value_or(-1);
@@ -566,6 +587,10 @@ static void read_channel_args(grpc_chttp2_transport* t,
   t->max_concurrent_streams_reject_on_client =
       channel_args.GetBool(GRPC_ARG_MAX_CONCURRENT_STREAMS_REJECT_ON_CLIENT)
           .value_or(false);
+
+  t->start_streams_by_deadline =
+      channel_args.GetBool(GRPC_ARG_HTTP2_START_STREAMS_BY_DEADLINE)
+          .value_or(false);
 }
 
 static void init_keepalive_pings_if_enabled_locked(
@@ -574,8 +599,9 @@ static void init_keepalive_pings_if_enabled_locked(
   DCHECK(error.ok());
   if (t->keepalive_time != grpc_core::Duration::Infinity()) {
     t->keepalive_state = GRPC_CHTTP2_KEEPALIVE_STATE_WAITING;
-    t->keepalive_ping_timer_handle =
-        t->event_engine->RunAfter(t->keepalive_time, [t = t->Ref()]() mutable {
+    t->keepalive_ping_timer_handle = t->event_engine->RunAfter(
+        t->keepalive_scheduler.ScheduleNextPing(t->keepalive_time),
+        [t = t->Ref()]() mutable {
           grpc_core::ApplicationCallbackExecCtx callback_exec_ctx;
           grpc_core::ExecCtx exec_ctx;
           init_keepalive_ping(std::move(t));
@@ -639,6 +665,7 @@ grpc_chttp2_transport::grpc_chttp2_transport(
       next_stream_id(is_client ? 1 : 2),
       ping_abuse_policy(channel_args),
       ping_rate_policy(channel_args, is_client),
+      keepalive_scheduler(channel_args),
       flow_control(
           peer_string.as_string_view(),
           channel_args.GetBool(GRPC_ARG_HTTP2_BDP_PROBE).value_or(true),
@@ -647,6 +674,10 @@ grpc_chttp2_transport::grpc_chttp2_transport(
       is_client(is_client) {
   context_list = new grpc_core::ContextList();
 
+  if (is_client) {
+    connection_load = channel_args.GetObjectRef<grpc_core::ConnectionLoad>();
+  }
+
   if (channel_args.GetBool(GRPC_ARG_TCP_TRACING_ENABLED).value_or(false) &&
       grpc_event_engine::experimental::grpc_is_event_engine_endpoint(
           ep.get())) {
@@ -891,6 +922,13 @@ grpc_chttp2_stream::~grpc_chttp2_stream() {
       t->channelz_socket->RecordStreamFailed();
     }
   }
+  if (t->channelz_counters != nullptr) {
+    if ((t->is_client && eos_received) || (!t->is_client && eos_sent)) {
+      t->channelz_counters->RecordStreamSucceeded();
+    } else {
+      t->channelz_counters->RecordStreamFailed();
+    }
+  }
 
   CHECK((write_closed && read_closed) || id == 0);
   if (id != 0) {
@@ -992,12 +1030,43 @@ static void set_write_state(grpc_chttp2_transport* t,
   }
 }
 
+// Only writes that carry stream data may wait to be coalesced; control frames
+// go out right away.
+static bool write_may_be_coalesced(grpc_chttp2_initiate_write_reason reason) {
+  switch (reason) {
+    case GRPC_CHTTP2_INITIATE_WRITE_START_NEW_STREAM:
+    case GRPC_CHTTP2_INITIATE_WRITE_SEND_MESSAGE:
+    case GRPC_CHTTP2_INITIATE_WRITE_SEND_INITIAL_METADATA:
+    case GRPC_CHTTP2_INITIATE_WRITE_SEND_TRAILING_METADATA:
+      return true;
+    default:
+      return false;
+  }
+}
+
 void grpc_chttp2_initiate_write(grpc_chttp2_transport* t,
                                 grpc_chttp2_initiate_write_reason reason) {
   switch (t->write_state) {
     case GRPC_CHTTP2_WRITE_STATE_IDLE:
       set_write_state(t, GRPC_CHTTP2_WRITE_STATE_WRITING,
                       grpc_chttp2_initiate_write_reason_string(reason));
+      if (t->write_coalescing_delay > grpc_core::Duration::Zero() &&
+          write_may_be_coalesced(reason)) {
+        // Give other streams a moment to queue data so it all goes out in one
+        // endpoint write. Anything initiated meanwhile, including control
+        // frames, is gathered by the same write.
+        t->event_engine->RunAfter(
+            t->write_coalescing_delay, [t = t->Ref()]() mutable {
+              grpc_core::ApplicationCallbackExecCtx callback_exec_ctx;
+              grpc_core::ExecCtx exec_ctx;
+              auto* tp = t.get();
+              tp->combiner->Run(
+                  grpc_core::InitTransportClosure<write_action_begin_locked>(
+                      std::move(t), &tp->write_action_begin_locked),
+                  absl::OkStatus());
+            });
+        break;
+      }
       // Note that the 'write_action_begin_locked' closure is being scheduled
       // on the 'finally_scheduler' of t->combiner. This means that
       // 'write_action_begin_locked' is called only *after* all the other
@@ -1052,6 +1121,7 @@ static void write_action_begin_locked(
   if (!t->closed_with_error.ok()) {
     r.writing = false;
   } else {
+    maybe_send_keepalive_ping_with_write_locked(t.get());
     r = grpc_chttp2_begin_write(t.get());
   }
   if (r.writing) {
@@ -1104,6 +1174,9 @@ static void write_action(grpc_chttp2_transport* t) {
       << (t->is_client ? "CLIENT" : "SERVER") << "[" << t << "]: Write "
       << t->outbuf.Length() << " bytes";
   t->write_size_policy.BeginWrite(t->outbuf.Length());
+  if (t->channelz_counters != nullptr) {
+    t->channelz_counters->RecordBytesSent(t->outbuf.Length());
+  }
   grpc_endpoint_write(t->ep.get(), t->outbuf.c_slice_buffer(),
                       grpc_core::InitTransportClosure<write_action_end>(
                           t->Ref(), &t->write_action_end_locked),
@@ -1412,6 +1485,9 @@ static void send_initial_metadata_locked(
   if (t->is_client && t->channelz_socket != nullptr) {
     t->channelz_socket->RecordStreamStartedFromLocal();
   }
+  if (t->is_client && t->channelz_counters != nullptr) {
+    t->channelz_counters->RecordStreamStarted();
+  }
   CHECK_EQ(s->send_initial_metadata_finished, nullptr);
   on_complete->next_data.scratch |= t->closure_barrier_may_cover_write;
 
@@ -2860,6 +2936,9 @@ static void read_action_locked(
         grpc_core::StatusIntProperty::kOccurredDuringWrite, t->write_state);
   }
   std::swap(err, error);
+  if (t->channelz_counters != nullptr) {
+    t->channelz_counters->RecordBytesReceived(t->read_buffer.length);
+  }
   read_action_parse_loop_locked(std::move(t), std::move(err));
 }
 
@@ -2920,6 +2999,38 @@ static void finish_bdp_ping(grpc_core::RefCountedPtr<grpc_chttp2_transport> t,
                     error);
 }
 
+// Under high memory pressure both HPACK tables are capped, so that indexed
+// headers give way to message data; they return to their configured sizes
+// once the pressure falls. Runs alongside the flow control periodic update,
+// which shrinks the receive windows for the same reason.
+static void update_hpack_table_sizes_for_memory_pressure(
+    grpc_chttp2_transport* t) {
+  constexpr uint32_t kMemoryPressureHpackTableSize = 1024;
+  const bool capped =
+      t->memory_owner.GetPressureInfo().pressure_control_value >= 0.8;
+  if (capped == t->hpack_tables_capped_for_memory_pressure) return;
+  t->hpack_tables_capped_for_memory_pressure = capped;
+  GRPC_TRACE_LOG(http, INFO)
+      << t->peer_string.as_string_view()
+      << (capped ? ": capping" : ": restoring")
+      << " HPACK table sizes for memory pressure";
+  if (capped) {
+    t->hpack_compressor.SetMaxUsableSize(std::min(
+        kMemoryPressureHpackTableSize, t->configured_hpack_encoder_table_size));
+    t->settings.mutable_local().SetHeaderTableSize(std::min(
+        kMemoryPressureHpackTableSize, t->configured_hpack_decoder_table_size));
+  } else {
+    t->hpack_compressor.SetMaxUsableSize(
+        t->configured_hpack_encoder_table_size);
+    t->hpack_compressor.SetMaxTableSize(
+        t->settings.peer().header_table_size());
+    t->settings.mutable_local().SetHeaderTableSize(
+        t->configured_hpack_decoder_table_size);
+  }
+  // The decoder table only changes size once the peer acks the new settings.
+  grpc_chttp2_initiate_write(t, GRPC_CHTTP2_INITIATE_WRITE_SEND_SETTINGS);
+}
+
 static void finish_bdp_ping_locked(
     grpc_core::RefCountedPtr<grpc_chttp2_transport> t,
     grpc_error_handle error) {
@@ -2940,6 +3051,7 @@ static void finish_bdp_ping_locked(
       t->flow_control.bdp_estimator()->CompletePing();
   grpc_chttp2_act_on_flowctl_action(t->flow_control.PeriodicUpdate(), t.get(),
                                     nullptr);
+  update_hpack_table_sizes_for_memory_pressure(t.get());
   CHECK(t->next_bdp_ping_timer_handle == TaskHandle::kInvalid);
   t->next_bdp_ping_timer_handle =
       t->event_engine->RunAfter(next_ping - grpc_core::Timestamp::Now(), [t] {
@@ -3034,14 +3146,15 @@ static void init_keepalive_ping_locked(
   if (t->destroying || !t->closed_with_error.ok()) {
     t->keepalive_state = GRPC_CHTTP2_KEEPALIVE_STATE_DYING;
   } else {
-    if (t->keepalive_permit_without_calls || !t->stream_map.empty()) {
+    if (grpc_core::Chttp2KeepaliveScheduler::ShouldPing(
+            !t->stream_map.empty(), t->keepalive_permit_without_calls)) {
       t->keepalive_state = GRPC_CHTTP2_KEEPALIVE_STATE_PINGING;
       send_keepalive_ping_locked(t);
       grpc_chttp2_initiate_write(t.get(),
                                  GRPC_CHTTP2_INITIATE_WRITE_KEEPALIVE_PING);
     } else {
-      t->keepalive_ping_timer_handle =
-          t->event_engine->RunAfter(t->keepalive_time, [t] {
+      t->keepalive_ping_timer_handle = t->event_engine->RunAfter(
+          t->keepalive_scheduler.ScheduleNextPing(t->keepalive_time), [t] {
             grpc_core::ApplicationCallbackExecCtx callback_exec_ctx;
             grpc_core::ExecCtx exec_ctx;
             init_keepalive_ping(t);
@@ -3072,8 +3185,8 @@ static void finish_keepalive_ping_locked(
       }
       t->keepalive_state = GRPC_CHTTP2_KEEPALIVE_STATE_WAITING;
       CHECK(t->keepalive_ping_timer_handle == TaskHandle::kInvalid);
-      t->keepalive_ping_timer_handle =
-          t->event_engine->RunAfter(t->keepalive_time, [t] {
+      t->keepalive_ping_timer_handle = t->event_engine->RunAfter(
+          t->keepalive_scheduler.ScheduleNextPing(t->keepalive_time), [t] {
             grpc_core::ApplicationCallbackExecCtx callback_exec_ctx;
             grpc_core::ExecCtx exec_ctx;
             init_keepalive_ping(t);
@@ -3092,8 +3205,9 @@ static void maybe_reset_keepalive_ping_timer_locked(grpc_chttp2_transport* t) {
       LOG(INFO) << t->peer_string.as_string_view()
                 << ": Keepalive ping cancelled. Resetting timer.";
     }
-    t->keepalive_ping_timer_handle =
-        t->event_engine->RunAfter(t->keepalive_time, [t = t->Ref()]() mutable {
+    t->keepalive_ping_timer_handle = t->event_engine->RunAfter(
+        t->keepalive_scheduler.ScheduleNextPing(t->keepalive_time),
+        [t = t->Ref()]() mutable {
           grpc_core::ApplicationCallbackExecCtx callback_exec_ctx;
           grpc_core::ExecCtx exec_ctx;
           init_keepalive_ping(std::move(t));
@@ -3101,6 +3215,30 @@ static void maybe_reset_keepalive_ping_timer_locked(grpc_chttp2_transport* t) {
   }
 }
 
+// Sends a keepalive ping that is nearly due along with the write that is
+// starting, rather than on its own a little later.
+static void maybe_send_keepalive_ping_with_write_locked(
+    grpc_chttp2_transport* t) {
+  if (t->keepalive_state != GRPC_CHTTP2_KEEPALIVE_STATE_WAITING ||
+      !t->keepalive_scheduler.ShouldSendWithWrite() ||
+      !grpc_core::Chttp2KeepaliveScheduler::ShouldPing(
+          !t->stream_map.empty(), t->keepalive_permit_without_calls)) {
+    return;
+  }
+  if (t->keepalive_ping_timer_handle == TaskHandle::kInvalid ||
+      !t->event_engine->Cancel(t->keepalive_ping_timer_handle)) {
+    return;
+  }
+  t->keepalive_ping_timer_handle = TaskHandle::kInvalid;
+  if (GRPC_TRACE_FLAG_ENABLED(http) ||
+      GRPC_TRACE_FLAG_ENABLED(http_keepalive)) {
+    LOG(INFO) << t->peer_string.as_string_view()
+              << ": Sending keepalive ping with write";
+  }
+  t->keepalive_state = GRPC_CHTTP2_KEEPALIVE_STATE_PINGING;
+  send_keepalive_ping_locked(t->Ref());
+}
+
 //
 // CALLBACK LOOP
 //
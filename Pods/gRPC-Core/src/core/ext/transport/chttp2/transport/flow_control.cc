@@ -134,10 +134,38 @@ absl::Status StreamFlowControl::IncomingUpdateContext::RecvData(
                                         -incoming_frame_size);
     sfc_->min_progress_size_ -=
         std::min(sfc_->min_progress_size_, incoming_frame_size);
+    sfc_->NoteConsumption(incoming_frame_size);
     return absl::OkStatus();
   });
 }
 
+void StreamFlowControl::NoteConsumption(int64_t incoming_frame_size) {
+  // Long enough to span a few round trips on a slow mobile link.
+  constexpr Duration kAutoTunePeriod = Duration::Milliseconds(250);
+  const Timestamp now = Timestamp::Now();
+  if (consumption_period_start_ == Timestamp::InfPast()) {
+    consumption_period_start_ = now;
+  }
+  consumed_in_period_ += incoming_frame_size;
+  if (now - consumption_period_start_ < kAutoTunePeriod) return;
+  const int64_t window =
+      static_cast<int64_t>(tfc_->acked_init_window()) + auto_window_delta_;
+  if (tfc_->memory_pressure() >= 0.8) {
+    // Under memory pressure the stream falls back to the transport's initial
+    // window, which shrinks with the pressure itself.
+    auto_window_delta_ = 0;
+  } else if (consumed_in_period_ >= window) {
+    // The stream went through its whole window within one period, so the
+    // window rather than the reader is what limits it.
+    auto_window_delta_ = std::min(
+        std::max<int64_t>(2 * auto_window_delta_, window), kMaxWindowDelta);
+  } else if (consumed_in_period_ < window / 4) {
+    auto_window_delta_ /= 2;
+  }
+  consumed_in_period_ = 0;
+  consumption_period_start_ = now;
+}
+
 absl::Status TransportFlowControl::IncomingUpdateContext::RecvData(
     int64_t incoming_frame_size, absl::FunctionRef<absl::Status()> stream) {
   if (incoming_frame_size > tfc_->announced_window_) {
@@ -346,7 +374,8 @@ uint32_t StreamFlowControl::DesiredAnnounceSize() const {
         return announced_window_delta_;
       }
     } else {
-      return std::min(min_progress_size_, kMaxWindowDelta);
+      return std::min(std::max(min_progress_size_, auto_window_delta_),
+                      kMaxWindowDelta);
     }
   }();
   return Clamp(desired_window_delta - announced_window_delta_, int64_t{0},
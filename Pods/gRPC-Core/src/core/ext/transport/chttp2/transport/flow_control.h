@@ -257,6 +257,10 @@ class TransportFlowControl final {
 
   int64_t target_window() const;
   int64_t target_frame_size() const { return target_frame_size_; }
+  // Memory pressure in the transport's resource quota.
+  double memory_pressure() const {
+    return memory_owner_->GetPressureInfo().pressure_control_value;
+  }
   int64_t target_preferred_rx_crypto_frame_size() const {
     return target_preferred_rx_crypto_frame_size_;
   }
@@ -434,6 +438,7 @@ class StreamFlowControl final {
   int64_t remote_window_delta() const { return remote_window_delta_; }
   int64_t announced_window_delta() const { return announced_window_delta_; }
   int64_t min_progress_size() const { return min_progress_size_; }
+  int64_t auto_window_delta() const { return auto_window_delta_; }
 
   // A snapshot of the flow control stats to export.
   struct Stats {
@@ -460,6 +465,18 @@ class StreamFlowControl final {
   int64_t remote_window_delta_ = 0;
   int64_t announced_window_delta_ = 0;
   absl::optional<int64_t> pending_size_;
+  // Extra window, beyond what the reader asks for, that this stream has
+  // earned by consuming data quickly. It grows while the stream keeps using
+  // up its window within an auto-tuning period and shrinks again once it
+  // slows down, so only busy streams hold a large window.
+  int64_t auto_window_delta_ = 0;
+  // Bytes received since consumption_period_start_.
+  int64_t consumed_in_period_ = 0;
+  Timestamp consumption_period_start_ = Timestamp::InfPast();
+
+  // Records incoming data and adjusts auto_window_delta_ at the end of each
+  // period.
+  void NoteConsumption(int64_t incoming_frame_size);
 
   FlowControlAction UpdateAction(FlowControlAction action);
 };
@@ -143,7 +143,9 @@ grpc_error_handle grpc_chttp2_data_parser_parse(void* /*parser*/,
                                                 const grpc_slice& slice,
                                                 int is_last) {
   grpc_core::CSliceRef(slice);
-  grpc_slice_buffer_add(&s->frame_storage, slice);
+  // Reads that end mid-frame leave small pieces of DATA frames; coalesce
+  // them so that messages do not arrive as chains of tiny slices.
+  grpc_slice_buffer_add_coalesced(&s->frame_storage, slice);
   grpc_chttp2_maybe_complete_recv_message(t, s);
 
   if (is_last && s->received_last_frame) {
@@ -117,6 +117,10 @@ grpc_error_handle grpc_chttp2_settings_parser_parse(void* p,
                 .IncrementHttp2PreferredReceiveCryptoMessageSize(
                     target_settings->preferred_receive_crypto_message_size());
             *parser->target_settings = *parser->incoming_settings;
+            if (t->connection_load != nullptr) {
+              t->connection_load->SetMaxConcurrentStreams(
+                  t->settings.peer().max_concurrent_streams());
+            }
             t->num_pending_induced_frames++;
             grpc_slice_buffer_add(&t->qbuf, grpc_chttp2_settings_ack_create());
             grpc_chttp2_initiate_write(t,
@@ -356,14 +356,87 @@ void SliceIndex::EmitTo(absl::string_view key, const Slice& value,
   values_.emplace_back(value.Ref(), index);
 }
 
-void Encoder::Encode(const Slice& key, const Slice& value) {
-  if (absl::EndsWith(key.as_string_view(), "-bin")) {
-    EmitLitHdrWithBinaryStringKeyNotIdx(key.Ref(), value.Ref());
+bool UnknownMetadataIndex::IsPinned(absl::string_view key) const {
+  return std::find(pinned_keys_.begin(), pinned_keys_.end(), key) !=
+         pinned_keys_.end();
+}
+
+bool UnknownMetadataIndex::EvictOne() {
+  auto victim = values_.end();
+  for (auto it = values_.begin(); it != values_.end(); ++it) {
+    if (it->pinned) continue;
+    if (victim == values_.end()) {
+      victim = it;
+      continue;
+    }
+    const bool it_hot = it->uses >= kHotThreshold;
+    const bool victim_hot = victim->uses >= kHotThreshold;
+    if (it_hot != victim_hot) {
+      if (!it_hot) victim = it;
+    } else if (it->last_used < victim->last_used) {
+      victim = it;
+    }
+  }
+  if (victim == values_.end()) return false;
+  values_.erase(victim);
+  return true;
+}
+
+void UnknownMetadataIndex::EmitTo(const Slice& key, const Slice& value,
+                                  Encoder* encoder) {
+  const bool is_binary = absl::EndsWith(key.as_string_view(), "-bin");
+  auto emit_literal = [&]() {
+    if (is_binary) {
+      encoder->EmitLitHdrWithBinaryStringKeyNotIdx(key.Ref(), value.Ref());
+    } else {
+      encoder->EmitLitHdrWithNonBinaryStringKeyNotIdx(key.Ref(), value.Ref());
+    }
+  };
+  auto& table = encoder->hpack_table();
+  // Binary values may be base64 encoded on the wire; size them as if they
+  // were.
+  const size_t value_size =
+      is_binary ? (value.size() + 2) / 3 * 4 : value.size();
+  // An entry taking up more than half of the peer's table would evict most of
+  // what is already there.
+  if (hpack_constants::SizeForEntry(key.size(), value_size) >
+      std::min<size_t>(table.max_size() / 2,
+                       HPackEncoderTable::MaxEntrySize())) {
+    emit_literal();
+    return;
+  }
+  auto it = std::find_if(
+      values_.begin(), values_.end(), [&](const TrackedValue& tracked) {
+        return tracked.key == key && tracked.value == value;
+      });
+  if (it == values_.end()) {
+    if (values_.size() >= kMaxTrackedValues && !EvictOne()) {
+      emit_literal();
+      return;
+    }
+    values_.push_back(TrackedValue{key.Ref(), value.Ref(),
+                                   IsPinned(key.as_string_view()), 0,
+                                   clock_, 0});
+    it = values_.end() - 1;
+  }
+  ++it->uses;
+  it->last_used = ++clock_;
+  if (table.ConvertibleToDynamicIndex(it->index)) {
+    encoder->EmitIndexed(table.DynamicIndex(it->index));
+  } else if (it->pinned || it->uses >= kHotThreshold) {
+    it->index = is_binary ? encoder->EmitLitHdrWithBinaryStringKeyIncIdx(
+                                key.Ref(), value.Ref())
+                          : encoder->EmitLitHdrWithNonBinaryStringKeyIncIdx(
+                                key.Ref(), value.Ref());
   } else {
-    EmitLitHdrWithNonBinaryStringKeyNotIdx(key.Ref(), value.Ref());
+    emit_literal();
   }
 }
 
+void Encoder::Encode(const Slice& key, const Slice& value) {
+  compressor_->unknown_index_.EmitTo(key, value, this);
+}
+
 void Compressor<HttpSchemeMetadata, HttpSchemeCompressor>::EncodeWith(
     HttpSchemeMetadata, HttpSchemeMetadata::ValueType value, Encoder* encoder) {
   switch (value) {
@@ -39,6 +39,7 @@
 #include "absl/types/optional.h"
 #include "absl/types/variant.h"
 #include "src/core/channelz/channelz.h"
+#include "src/core/channelz/connection_counters.h"
 #include "src/core/ext/transport/chttp2/transport/call_tracer_wrapper.h"
 #include "src/core/ext/transport/chttp2/transport/context_list_entry.h"
 #include "src/core/ext/transport/chttp2/transport/flow_control.h"
@@ -48,9 +49,11 @@
 #include "src/core/ext/transport/chttp2/transport/frame_security.h"
 #include "src/core/ext/transport/chttp2/transport/frame_settings.h"
 #include "src/core/ext/transport/chttp2/transport/frame_window_update.h"
+#include "src/core/ext/transport/chttp2/transport/hpack_constants.h"
 #include "src/core/ext/transport/chttp2/transport/hpack_encoder.h"
 #include "src/core/ext/transport/chttp2/transport/hpack_parser.h"
 #include "src/core/ext/transport/chttp2/transport/http2_settings.h"
+#include "src/core/ext/transport/chttp2/transport/keepalive_scheduler.h"
 #include "src/core/ext/transport/chttp2/transport/legacy_frame.h"
 #include "src/core/ext/transport/chttp2/transport/ping_abuse_policy.h"
 #include "src/core/ext/transport/chttp2/transport/ping_callbacks.h"
@@ -68,6 +71,7 @@
 #include "src/core/lib/slice/slice.h"
 #include "src/core/lib/slice/slice_buffer.h"
 #include "src/core/lib/surface/init_internally.h"
+#include "src/core/lib/transport/connection_load.h"
 #include "src/core/lib/transport/connectivity_state.h"
 #include "src/core/lib/transport/metadata_batch.h"
 #include "src/core/lib/transport/transport.h"
@@ -289,6 +293,10 @@ struct grpc_chttp2_transport final : public grpc_core::FilterStackTransport,
   grpc_closure* notify_on_receive_settings = nullptr;
   grpc_closure* notify_on_close = nullptr;
 
+  /// On the client side, told about the peer's MAX_CONCURRENT_STREAMS each
+  /// time it changes, if the subchannel scales its connections.
+  grpc_core::RefCountedPtr<grpc_core::ConnectionLoad> connection_load;
+
   /// has the upper layer closed the transport?
   grpc_error_handle closed_with_error;
 
@@ -384,6 +392,7 @@ struct grpc_chttp2_transport final : public grpc_core::FilterStackTransport,
   /// ping queues for various ping insertion points
   grpc_core::Chttp2PingAbusePolicy ping_abuse_policy;
   grpc_core::Chttp2PingRatePolicy ping_rate_policy;
+  grpc_core::Chttp2KeepaliveScheduler keepalive_scheduler;
   grpc_core::Chttp2PingCallbacks ping_callbacks;
   grpc_event_engine::experimental::EventEngine::TaskHandle
       delayed_ping_timer_handle =
@@ -486,6 +495,9 @@ struct grpc_chttp2_transport final : public grpc_core::FilterStackTransport,
   uint32_t max_header_list_size_soft_limit = 0;
   grpc_core::ContextList* context_list = nullptr;
   grpc_core::RefCountedPtr<grpc_core::channelz::SocketNode> channelz_socket;
+  /// Set if GRPC_ARG_ENABLE_CHANNELZ_COUNTERS is.
+  grpc_core::RefCountedPtr<grpc_core::channelz::SocketCounters>
+      channelz_counters;
   uint32_t num_messages_in_next_write = 0;
   /// The number of pending induced frames (SETTINGS_ACK, PINGS_ACK and
   /// RST_STREAM) in the outgoing buffer (t->qbuf). If this number goes beyond
@@ -511,6 +523,15 @@ struct grpc_chttp2_transport final : public grpc_core::FilterStackTransport,
 
   /// policy for how much data we're willing to put into one http2 write
   grpc_core::Chttp2WriteSizePolicy write_size_policy;
+  /// how long a write of stream data waits for more data to coalesce with
+  grpc_core::Duration write_coalescing_delay;
+  /// HPACK table sizes to return to once memory pressure falls
+  uint32_t configured_hpack_encoder_table_size =
+      grpc_core::hpack_constants::kInitialTableSize;
+  uint32_t configured_hpack_decoder_table_size =
+      grpc_core::hpack_constants::kInitialTableSize;
+  /// whether the HPACK tables are currently capped for memory pressure
+  bool hpack_tables_capped_for_memory_pressure = false;
 
   bool reading_paused_on_pending_induced_frames = false;
   /// Based on channel args, preferred_rx_crypto_frame_sizes are advertised to
@@ -549,6 +570,9 @@ struct grpc_chttp2_transport final : public grpc_core::FilterStackTransport,
   /// MAX_CONCURRENT_STREAMS
   bool max_concurrent_streams_overload_protection = false;
   bool max_concurrent_streams_reject_on_client = false;
+  /// True if streams waiting for MAX_CONCURRENT_STREAMS start earliest
+  /// deadline first rather than in arrival order
+  bool start_streams_by_deadline = false;
 
   // What percentage of rst_stream frames on the server should cause a ping
   // frame to be generated.
@@ -712,6 +736,13 @@ struct grpc_chttp2_stream {
 #define GRPC_ARG_MAX_CONCURRENT_STREAMS_REJECT_ON_CLIENT \
   "grpc.http.max_concurrent_streams_reject_on_client"
 
+// EXPERIMENTAL: When the client is over max concurrent streams, start the
+// waiting streams with the nearest deadline first, so that calls about to
+// expire are not stuck behind calls that can afford to wait. Streams with
+// equal deadlines still start in arrival order.
+#define GRPC_ARG_HTTP2_START_STREAMS_BY_DEADLINE \
+  "grpc.http.start_streams_by_deadline"
+
 /// Transport writing call flow:
 /// grpc_chttp2_initiate_write() is called anywhere that we know bytes need to
 /// go out on the wire.
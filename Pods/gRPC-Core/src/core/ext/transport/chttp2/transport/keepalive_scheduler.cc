@@ -0,0 +1,68 @@
+// Copyright 2024 The gRPC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/core/ext/transport/chttp2/transport/keepalive_scheduler.h"
+
+#include <grpc/grpc.h>
+#include <grpc/impl/channel_arg_names.h>
+#include <grpc/support/port_platform.h>
+
+#include <algorithm>
+#include <atomic>
+
+namespace grpc_core {
+
+namespace {
+std::atomic<bool> g_application_backgrounded{false};
+}  // namespace
+
+Chttp2KeepaliveScheduler::Chttp2KeepaliveScheduler(const ChannelArgs& args)
+    : tolerance_(std::max(
+          Duration::Zero(),
+          args.GetDurationFromIntMillis(GRPC_ARG_KEEPALIVE_TOLERANCE_MS)
+              .value_or(Duration::Zero()))) {}
+
+Duration Chttp2KeepaliveScheduler::ScheduleNextPing(Duration keepalive_time) {
+  const Timestamp now = Timestamp::Now();
+  next_ping_ = now + keepalive_time;
+  if (tolerance_ > Duration::Zero() && next_ping_ != Timestamp::InfFuture()) {
+    // Round up to the grid, so that the ping is late by less than the
+    // tolerance.
+    const uint64_t slot = tolerance_.millis();
+    const uint64_t millis = next_ping_.milliseconds_after_process_epoch();
+    next_ping_ = Timestamp::FromMillisecondsAfterProcessEpoch(
+        (millis + slot - 1) / slot * slot);
+  }
+  return next_ping_ - now;
+}
+
+bool Chttp2KeepaliveScheduler::ShouldSendWithWrite() const {
+  if (tolerance_ == Duration::Zero()) return false;
+  return next_ping_ - tolerance_ <= Timestamp::Now();
+}
+
+void Chttp2KeepaliveScheduler::SetApplicationBackgrounded(bool backgrounded) {
+  g_application_backgrounded.store(backgrounded, std::memory_order_relaxed);
+}
+
+bool Chttp2KeepaliveScheduler::ApplicationBackgrounded() {
+  return g_application_backgrounded.load(std::memory_order_relaxed);
+}
+
+}  // namespace grpc_core
+
+void grpc_set_application_backgrounded(int backgrounded) {
+  grpc_core::Chttp2KeepaliveScheduler::SetApplicationBackgrounded(
+      backgrounded != 0);
+}
@@ -0,0 +1,60 @@
+// Copyright 2024 The gRPC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GRPC_SRC_CORE_EXT_TRANSPORT_CHTTP2_TRANSPORT_KEEPALIVE_SCHEDULER_H
+#define GRPC_SRC_CORE_EXT_TRANSPORT_CHTTP2_TRANSPORT_KEEPALIVE_SCHEDULER_H
+
+#include <grpc/support/port_platform.h>
+
+#include "src/core/lib/channel/channel_args.h"
+#include "src/core/util/time.h"
+
+namespace grpc_core {
+
+// Decides when keepalive pings are sent, so that they wake a cellular radio
+// as rarely as possible. With GRPC_ARG_KEEPALIVE_TOLERANCE_MS set:
+// - pings are due on a process-wide grid with that spacing, so that the
+//   pings of all transports become due together;
+// - a ping due within the tolerance is sent with any write the transport
+//   makes first, while the radio is on anyway.
+// Independently of the arg, pings that only keep an idle connection open
+// are skipped while the application is in the background.
+class Chttp2KeepaliveScheduler {
+ public:
+  explicit Chttp2KeepaliveScheduler(const ChannelArgs& args);
+
+  // Returns how long to wait before the next ping, given that a ping is
+  // wanted no earlier than keepalive_time from now.
+  Duration ScheduleNextPing(Duration keepalive_time);
+
+  // True if a write starting now should carry the next ping.
+  bool ShouldSendWithWrite() const;
+
+  // True if a ping should be sent for a transport with or without streams.
+  static bool ShouldPing(bool has_streams, bool permit_without_calls) {
+    if (has_streams) return true;
+    return permit_without_calls && !ApplicationBackgrounded();
+  }
+
+  static void SetApplicationBackgrounded(bool backgrounded);
+  static bool ApplicationBackgrounded();
+
+ private:
+  const Duration tolerance_;
+  Timestamp next_ping_ = Timestamp::InfFuture();
+};
+
+}  // namespace grpc_core
+
+#endif  // GRPC_SRC_CORE_EXT_TRANSPORT_CHTTP2_TRANSPORT_KEEPALIVE_SCHEDULER_H
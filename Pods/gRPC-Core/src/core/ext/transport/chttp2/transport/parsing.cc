@@ -743,6 +743,9 @@ static grpc_error_handle init_header_frame_parser(grpc_chttp2_transport* t,
     if (t->channelz_socket != nullptr) {
       t->channelz_socket->RecordStreamStartedFromRemote();
     }
+    if (t->channelz_counters != nullptr) {
+      t->channelz_counters->RecordStreamStarted();
+    }
   } else {
     t->incoming_stream = s;
   }
@@ -136,6 +136,36 @@ static bool stream_list_add(grpc_chttp2_transport* t, grpc_chttp2_stream* s,
   return true;
 }
 
+// Inserts s after the last stream whose deadline is not later than its own.
+// Walks from the tail, since deadlines mostly arrive in increasing order.
+static void stream_list_add_by_deadline(grpc_chttp2_transport* t,
+                                        grpc_chttp2_stream* s,
+                                        grpc_chttp2_stream_list_id id) {
+  CHECK(!s->included.is_set(id));
+  grpc_chttp2_stream* prev = t->lists[id].tail;
+  while (prev != nullptr && prev->deadline > s->deadline) {
+    prev = prev->links[id].prev;
+  }
+  if (prev == t->lists[id].tail) {
+    stream_list_add_tail(t, s, id);
+    return;
+  }
+  grpc_chttp2_stream* next =
+      prev == nullptr ? t->lists[id].head : prev->links[id].next;
+  s->links[id].prev = prev;
+  s->links[id].next = next;
+  next->links[id].prev = s;
+  if (prev != nullptr) {
+    prev->links[id].next = s;
+  } else {
+    t->lists[id].head = s;
+  }
+  s->included.set(id);
+  GRPC_TRACE_LOG(http2_stream_state, INFO)
+      << t << "[" << s->id << "][" << (t->is_client ? "cli" : "svr")
+      << "]: insert by deadline into " << stream_list_id_string(id);
+}
+
 // wrappers for specializations
 
 bool grpc_chttp2_list_add_writable_stream(grpc_chttp2_transport* t,
@@ -170,6 +200,13 @@ bool grpc_chttp2_list_pop_writing_stream(grpc_chttp2_transport* t,
 
 void grpc_chttp2_list_add_waiting_for_concurrency(grpc_chttp2_transport* t,
                                                   grpc_chttp2_stream* s) {
+  if (t->start_streams_by_deadline) {
+    if (!s->included.is_set(GRPC_CHTTP2_LIST_WAITING_FOR_CONCURRENCY)) {
+      stream_list_add_by_deadline(t, s,
+                                  GRPC_CHTTP2_LIST_WAITING_FOR_CONCURRENCY);
+    }
+    return;
+  }
   stream_list_add(t, s, GRPC_CHTTP2_LIST_WAITING_FOR_CONCURRENCY);
 }
 
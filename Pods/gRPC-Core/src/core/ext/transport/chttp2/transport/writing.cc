@@ -130,6 +130,9 @@ static void maybe_initiate_ping(grpc_chttp2_transport* t) {
         if (t->channelz_socket != nullptr) {
           t->channelz_socket->RecordKeepaliveSent();
         }
+        if (t->channelz_counters != nullptr) {
+          t->channelz_counters->RecordKeepaliveSent();
+        }
         grpc_core::global_stats().IncrementHttp2PingsSent();
         if (GRPC_TRACE_FLAG_ENABLED(http) ||
             GRPC_TRACE_FLAG_ENABLED(bdp_estimator) ||
@@ -531,10 +534,16 @@ class StreamWriteContext {
       if (t_->flow_control.remote_window() <= 0) {
         grpc_core::global_stats().IncrementHttp2TransportStalls();
         report_stall(t_, s_, "transport");
+        if (t_->channelz_counters != nullptr) {
+          t_->channelz_counters->RecordFlowControlStall();
+        }
         grpc_chttp2_list_add_stalled_by_transport(t_, s_);
       } else if (data_send_context.stream_remote_window() <= 0) {
         grpc_core::global_stats().IncrementHttp2StreamStalls();
         report_stall(t_, s_, "stream");
+        if (t_->channelz_counters != nullptr) {
+          t_->channelz_counters->RecordFlowControlStall();
+        }
         grpc_chttp2_list_add_stalled_by_stream(t_, s_);
       }
       return;  // early out: nothing to do
@@ -741,6 +750,9 @@ void grpc_chttp2_end_write(grpc_chttp2_transport* t, grpc_error_handle error) {
   if (t->channelz_socket != nullptr) {
     t->channelz_socket->RecordMessagesSent(t->num_messages_in_next_write);
   }
+  if (t->channelz_counters != nullptr) {
+    t->channelz_counters->RecordMessagesSent(t->num_messages_in_next_write);
+  }
   t->num_messages_in_next_write = 0;
 
   if (t->ping_callbacks.started_new_ping_without_setting_timeout() &&
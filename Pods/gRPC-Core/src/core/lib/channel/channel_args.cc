@@ -30,8 +30,10 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/hash/hash.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/strings/match.h"
@@ -96,8 +98,14 @@ ChannelArgs::ChannelArgs() = default;
 ChannelArgs::~ChannelArgs() = default;
 ChannelArgs::ChannelArgs(const ChannelArgs& other) = default;
 ChannelArgs& ChannelArgs::operator=(const ChannelArgs& other) = default;
-ChannelArgs::ChannelArgs(ChannelArgs&& other) noexcept = default;
-ChannelArgs& ChannelArgs::operator=(ChannelArgs&& other) noexcept = default;
+// A moved-from ChannelArgs is empty, so its hash must be too.
+ChannelArgs::ChannelArgs(ChannelArgs&& other) noexcept
+    : args_(std::move(other.args_)), hash_(std::exchange(other.hash_, 0)) {}
+ChannelArgs& ChannelArgs::operator=(ChannelArgs&& other) noexcept {
+  args_ = std::move(other.args_);
+  hash_ = std::exchange(other.hash_, 0);
+  return *this;
+}
 
 const ChannelArgs::Value* ChannelArgs::Get(absl::string_view name) const {
   return args_.Lookup(name);
@@ -107,12 +115,20 @@ bool ChannelArgs::Contains(absl::string_view name) const {
   return Get(name) != nullptr;
 }
 
+void ChannelArgs::ForEach(
+    absl::FunctionRef<void(absl::string_view, const Value&)> callback) const {
+  args_.ForEach([callback](const RefCountedStringValue& key,
+                           const Value& value) {
+    callback(key.as_string_view(), value);
+  });
+}
+
 bool ChannelArgs::operator<(const ChannelArgs& other) const {
   return args_ < other.args_;
 }
 
 bool ChannelArgs::operator==(const ChannelArgs& other) const {
-  return args_ == other.args_;
+  return hash_ == other.hash_ && args_ == other.args_;
 }
 
 bool ChannelArgs::operator!=(const ChannelArgs& other) const {
@@ -123,8 +139,32 @@ bool ChannelArgs::WantMinimalStack() const {
   return GetBool(GRPC_ARG_MINIMAL_STACK).value_or(false);
 }
 
-ChannelArgs::ChannelArgs(AVL<RefCountedStringValue, Value> args)
-    : args_(std::move(args)) {}
+ChannelArgs::ChannelArgs(AVL<RefCountedStringValue, Value> args, size_t hash)
+    : args_(std::move(args)), hash_(hash) {}
+
+size_t ChannelArgs::Value::Hash() const {
+  if (rep_.c_vtable() == &int_vtable_) {
+    return absl::HashOf(reinterpret_cast<intptr_t>(rep_.c_pointer()));
+  }
+  if (rep_.c_vtable() == &string_vtable_) {
+    return absl::HashOf(
+        static_cast<RefCountedString*>(rep_.c_pointer())->as_string_view());
+  }
+  return 0;
+}
+
+size_t ChannelArgs::EntryHash(absl::string_view key, const Value& value) {
+  return absl::HashOf(key, value.Hash());
+}
+
+void ChannelArgs::AddInPlace(const RefCountedStringValue& key,
+                             const Value& value) {
+  if (const auto* p = args_.Lookup(key)) {
+    hash_ -= EntryHash(key.as_string_view(), *p);
+  }
+  args_ = args_.Add(key, value);
+  hash_ += EntryHash(key.as_string_view(), value);
+}
 
 ChannelArgs ChannelArgs::Set(grpc_arg arg) const {
   switch (arg.type) {
@@ -185,10 +225,14 @@ ChannelArgs ChannelArgs::Set(absl::string_view name, int value) const {
 }
 
 ChannelArgs ChannelArgs::Set(absl::string_view name, Value value) const {
+  size_t hash = hash_;
   if (const auto* p = args_.Lookup(name)) {
     if (*p == value) return *this;  // already have this value for this key
+    hash -= EntryHash(name, *p);
   }
-  return ChannelArgs(args_.Add(RefCountedStringValue(name), std::move(value)));
+  hash += EntryHash(name, value);
+  return ChannelArgs(args_.Add(RefCountedStringValue(name), std::move(value)),
+                     hash);
 }
 
 ChannelArgs ChannelArgs::Set(absl::string_view name,
@@ -205,17 +249,20 @@ ChannelArgs ChannelArgs::Set(absl::string_view name, std::string value) const {
 }
 
 ChannelArgs ChannelArgs::Remove(absl::string_view name) const {
-  if (args_.Lookup(name) == nullptr) return *this;
-  return ChannelArgs(args_.Remove(name));
+  const auto* p = args_.Lookup(name);
+  if (p == nullptr) return *this;
+  return ChannelArgs(args_.Remove(name), hash_ - EntryHash(name, *p));
 }
 
 ChannelArgs ChannelArgs::RemoveAllKeysWithPrefix(
     absl::string_view prefix) const {
-  auto args = args_;
+  auto result = *this;
   args_.ForEach([&](const RefCountedStringValue& key, const Value&) {
-    if (absl::StartsWith(key.as_string_view(), prefix)) args = args.Remove(key);
+    if (absl::StartsWith(key.as_string_view(), prefix)) {
+      result = result.Remove(key.as_string_view());
+    }
   });
-  return ChannelArgs(std::move(args));
+  return result;
 }
 
 absl::optional<int> ChannelArgs::GetInt(absl::string_view name) const {
@@ -314,7 +361,7 @@ ChannelArgs ChannelArgs::UnionWith(ChannelArgs other) const {
   if (args_.Height() <= other.args_.Height()) {
     args_.ForEach(
         [&other](const RefCountedStringValue& key, const Value& value) {
-          other.args_ = other.args_.Add(key, value);
+          other.AddInPlace(key, value);
         });
     return other;
   } else {
@@ -323,6 +370,7 @@ ChannelArgs ChannelArgs::UnionWith(ChannelArgs other) const {
         [&result](const RefCountedStringValue& key, const Value& value) {
           if (result.args_.Lookup(key) == nullptr) {
             result.args_ = result.args_.Add(key, value);
+            result.hash_ += EntryHash(key.as_string_view(), value);
           }
         });
     return result;
@@ -332,7 +380,7 @@ ChannelArgs ChannelArgs::UnionWith(ChannelArgs other) const {
 ChannelArgs ChannelArgs::FuzzingReferenceUnionWith(ChannelArgs other) const {
   // DO NOT OPTIMIZE THIS!!
   args_.ForEach([&other](const RefCountedStringValue& key, const Value& value) {
-    other.args_ = other.args_.Add(key, value);
+    other.AddInPlace(key, value);
   });
   return other;
 }
@@ -32,6 +32,7 @@
 #include <type_traits>
 #include <utility>
 
+#include "absl/functional/function_ref.h"
 #include "absl/meta/type_traits.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
@@ -371,6 +372,11 @@ class ChannelArgs {
 
     grpc_arg MakeCArg(const char* name) const;
 
+    // Equal values hash equally. Pointers other than ints and strings all
+    // hash the same, as pointers that compare equal can differ in both
+    // address and vtable.
+    size_t Hash() const;
+
     bool operator<(const Value& rhs) const { return rep_ < rhs.rep_; }
     bool operator==(const Value& rhs) const { return rep_ == rhs.rep_; }
     bool operator!=(const Value& rhs) const { return !this->operator==(rhs); }
@@ -487,6 +493,9 @@ class ChannelArgs {
   }
   GRPC_MUST_USE_RESULT ChannelArgs Remove(absl::string_view name) const;
   bool Contains(absl::string_view name) const;
+  // Calls \a callback for each arg, in key order.
+  void ForEach(absl::FunctionRef<void(absl::string_view, const Value&)>
+                   callback) const;
 
   GRPC_MUST_USE_RESULT ChannelArgs
   RemoveAllKeysWithPrefix(absl::string_view prefix) const;
@@ -551,6 +560,15 @@ class ChannelArgs {
   bool operator<(const ChannelArgs& other) const;
   bool operator==(const ChannelArgs& other) const;
 
+  // Equal args hash equally. Kept up to date by every mutation, so it costs
+  // nothing to ask for, and lets == reject most unequal args without walking
+  // them.
+  size_t Hash() const { return hash_; }
+  template <typename H>
+  friend H AbslHashValue(H h, const ChannelArgs& args) {
+    return H::combine(std::move(h), args.hash_);
+  }
+
   // Helpers for commonly accessed things
 
   bool WantMinimalStack() const;
@@ -562,12 +580,19 @@ class ChannelArgs {
   }
 
  private:
-  explicit ChannelArgs(AVL<RefCountedStringValue, Value> args);
+  ChannelArgs(AVL<RefCountedStringValue, Value> args, size_t hash);
 
   GRPC_MUST_USE_RESULT ChannelArgs Set(absl::string_view name,
                                        Value value) const;
+  // Adds or replaces \a key in place, keeping hash_ in step.
+  void AddInPlace(const RefCountedStringValue& key, const Value& value);
+
+  static size_t EntryHash(absl::string_view key, const Value& value);
 
   AVL<RefCountedStringValue, Value> args_;
+  // Sum of EntryHash() over args_, so that it does not depend on the order
+  // in which the args were set.
+  size_t hash_ = 0;
 };
 
 std::ostream& operator<<(std::ostream& out, const ChannelArgs& args);
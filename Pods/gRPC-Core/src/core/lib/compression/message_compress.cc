@@ -25,6 +25,10 @@
 #include <zconf.h>
 #include <zlib.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "src/core/lib/slice/slice.h"
@@ -91,20 +95,85 @@ static void* zalloc_gpr(void* /*opaque*/, unsigned int items,
 
 static void zfree_gpr(void* /*opaque*/, void* address) { gpr_free(address); }
 
+namespace {
+
+// Setting up a z_stream allocates and initializes several hundred KB of
+// deflate state, which costs more than compressing a small message. Each
+// thread keeps one stream per format and direction, and resets it between
+// messages instead.
+class ZlibStreams {
+ public:
+  ZlibStreams() = default;
+  ZlibStreams(const ZlibStreams&) = delete;
+  ZlibStreams& operator=(const ZlibStreams&) = delete;
+
+  ~ZlibStreams() {
+    for (Stream& stream : deflate_) {
+      if (stream.initialized) deflateEnd(&stream.zs);
+    }
+    for (Stream& stream : inflate_) {
+      if (stream.initialized) inflateEnd(&stream.zs);
+    }
+  }
+
+  z_stream* Deflate(int gzip) {
+    Stream& stream = deflate_[gzip ? 1 : 0];
+    if (!stream.initialized) {
+      InitAllocator(&stream.zs);
+      int r = deflateInit2(&stream.zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                           15 | (gzip ? 16 : 0), 8, Z_DEFAULT_STRATEGY);
+      CHECK(r == Z_OK);
+      stream.initialized = true;
+    } else {
+      CHECK(deflateReset(&stream.zs) == Z_OK);
+    }
+    return &stream.zs;
+  }
+
+  z_stream* Inflate(int gzip) {
+    Stream& stream = inflate_[gzip ? 1 : 0];
+    if (!stream.initialized) {
+      InitAllocator(&stream.zs);
+      int r = inflateInit2(&stream.zs, 15 | (gzip ? 16 : 0));
+      CHECK(r == Z_OK);
+      stream.initialized = true;
+    } else {
+      CHECK(inflateReset(&stream.zs) == Z_OK);
+    }
+    return &stream.zs;
+  }
+
+ private:
+  struct Stream {
+    z_stream zs;
+    bool initialized = false;
+  };
+
+  static void InitAllocator(z_stream* zs) {
+    memset(zs, 0, sizeof(*zs));
+    zs->zalloc = zalloc_gpr;
+    zs->zfree = zfree_gpr;
+  }
+
+  Stream deflate_[2];
+  Stream inflate_[2];
+};
+
+ZlibStreams& ThreadZlibStreams() {
+  static thread_local ZlibStreams streams;
+  return streams;
+}
+
+}  // namespace
+
 static int zlib_compress(grpc_slice_buffer* input, grpc_slice_buffer* output,
                          int gzip) {
-  z_stream zs;
   int r;
   size_t i;
   size_t count_before = output->count;
   size_t length_before = output->length;
-  memset(&zs, 0, sizeof(zs));
-  zs.zalloc = zalloc_gpr;
-  zs.zfree = zfree_gpr;
-  r = deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 | (gzip ? 16 : 0),
-                   8, Z_DEFAULT_STRATEGY);
-  CHECK(r == Z_OK);
-  r = zlib_body(&zs, input, output, deflate) && output->length < input->length;
+  z_stream* zs = ThreadZlibStreams().Deflate(gzip);
+  r = zlib_body(zs, input, output, deflate) && output->length < input->length;
   if (!r) {
     for (i = count_before; i < output->count; i++) {
       grpc_core::CSliceUnref(output->slices[i]);
@@ -112,32 +181,75 @@ static int zlib_compress(grpc_slice_buffer* input, grpc_slice_buffer* output,
     output->count = count_before;
     output->length = length_before;
   }
-  deflateEnd(&zs);
   return r;
 }
 
-static int zlib_decompress(grpc_slice_buffer* input, grpc_slice_buffer* output,
+// Allocates the next output chunk of zlib_decompress(), with room for one
+// byte more than the limit allows, so that going over it is noticed without
+// inflating any further. Chunks are never inlined, even when the limit makes
+// them small, as their length is trimmed at the end.
+static grpc_slice new_inflate_chunk(z_stream* zs, size_t chunk_size,
+                                    size_t room) {
+  grpc_slice chunk =
+      grpc_slice_malloc_large(room < chunk_size ? room + 1 : chunk_size);
+  CHECK(GRPC_SLICE_LENGTH(chunk) <= ~uInt{0});
+  zs->avail_out = static_cast<uInt> GRPC_SLICE_LENGTH(chunk);
+  zs->next_out = GRPC_SLICE_START_PTR(chunk);
+  return chunk;
+}
+
+static int zlib_decompress(grpc_slice_buffer* input, size_t chunk_size,
+                           size_t max_output_size,
+                           grpc_msg_decompress_chunk_func on_chunk, void* arg,
                            int gzip) {
-  z_stream zs;
-  int r;
-  size_t i;
-  size_t count_before = output->count;
-  size_t length_before = output->length;
-  memset(&zs, 0, sizeof(zs));
-  zs.zalloc = zalloc_gpr;
-  zs.zfree = zfree_gpr;
-  r = inflateInit2(&zs, 15 | (gzip ? 16 : 0));
-  CHECK(r == Z_OK);
-  r = zlib_body(&zs, input, output, inflate);
-  if (!r) {
-    for (i = count_before; i < output->count; i++) {
-      grpc_core::CSliceUnref(output->slices[i]);
+  z_stream* zs = ThreadZlibStreams().Inflate(gzip);
+  int r = Z_STREAM_END;  // Do not fail on an empty input.
+  int flush = Z_NO_FLUSH;
+  size_t produced = 0;
+  grpc_slice chunk = new_inflate_chunk(zs, chunk_size, max_output_size);
+  for (size_t i = 0; i < input->count; i++) {
+    if (i == input->count - 1) flush = Z_FINISH;
+    CHECK(GRPC_SLICE_LENGTH(input->slices[i]) <= ~uInt{0});
+    zs->avail_in = static_cast<uInt> GRPC_SLICE_LENGTH(input->slices[i]);
+    zs->next_in = GRPC_SLICE_START_PTR(input->slices[i]);
+    do {
+      if (zs->avail_out == 0) {
+        produced += GRPC_SLICE_LENGTH(chunk);
+        if (produced > max_output_size) {
+          VLOG(2) << "zlib: decompressed data exceeds " << max_output_size
+                  << " bytes";
+          grpc_core::CSliceUnref(chunk);
+          return -1;
+        }
+        if (!on_chunk(arg, chunk)) return 0;
+        chunk =
+            new_inflate_chunk(zs, chunk_size, max_output_size - produced);
+      }
+      r = inflate(zs, flush);
+      if (r < 0 && r != Z_BUF_ERROR /* not fatal */) {
+        VLOG(2) << "zlib error (" << r << ")";
+        grpc_core::CSliceUnref(chunk);
+        return 0;
+      }
+    } while (zs->avail_out == 0);
+    if (zs->avail_in) {
+      VLOG(2) << "zlib: not all input consumed";
+      grpc_core::CSliceUnref(chunk);
+      return 0;
     }
-    output->count = count_before;
-    output->length = length_before;
   }
-  inflateEnd(&zs);
-  return r;
+  if (r != Z_STREAM_END) {
+    VLOG(2) << "zlib: Data error";
+    grpc_core::CSliceUnref(chunk);
+    return 0;
+  }
+  CHECK(chunk.refcount);
+  chunk.data.refcounted.length -= zs->avail_out;
+  if (GRPC_SLICE_LENGTH(chunk) == 0) {
+    grpc_core::CSliceUnref(chunk);
+    return 1;
+  }
+  return on_chunk(arg, chunk);
 }
 
 static int copy(grpc_slice_buffer* input, grpc_slice_buffer* output) {
@@ -166,6 +278,32 @@ static int compress_inner(grpc_compression_algorithm algorithm,
   return 0;
 }
 
+int grpc_msg_looks_incompressible(const grpc_slice_buffer* input) {
+  // Below this the byte histogram is too sparse to tell random data apart.
+  constexpr size_t kMinSample = 256;
+  constexpr size_t kMaxSample = 1024;
+  // Deflate rarely gains anything on data above this many bits per byte,
+  // such as images or encrypted or already compressed payloads.
+  constexpr double kMaxCompressibleEntropy = 7.5;
+  if (input->length < kMinSample) return 0;
+  uint32_t counts[256] = {};
+  size_t sampled = 0;
+  for (size_t i = 0; i < input->count && sampled < kMaxSample; i++) {
+    const uint8_t* bytes = GRPC_SLICE_START_PTR(input->slices[i]);
+    const size_t n = std::min(GRPC_SLICE_LENGTH(input->slices[i]),
+                              kMaxSample - sampled);
+    for (size_t j = 0; j < n; j++) ++counts[bytes[j]];
+    sampled += n;
+  }
+  double entropy = 0;
+  for (uint32_t count : counts) {
+    if (count == 0) continue;
+    const double p = static_cast<double>(count) / sampled;
+    entropy -= p * std::log2(p);
+  }
+  return entropy > kMaxCompressibleEntropy;
+}
+
 int grpc_msg_compress(grpc_compression_algorithm algorithm,
                       grpc_slice_buffer* input, grpc_slice_buffer* output) {
   if (!compress_inner(algorithm, input, output)) {
@@ -175,18 +313,57 @@ int grpc_msg_compress(grpc_compression_algorithm algorithm,
   return 1;
 }
 
-int grpc_msg_decompress(grpc_compression_algorithm algorithm,
-                        grpc_slice_buffer* input, grpc_slice_buffer* output) {
+int grpc_msg_decompress_streaming(grpc_compression_algorithm algorithm,
+                                  grpc_slice_buffer* input, size_t chunk_size,
+                                  size_t max_output_size,
+                                  grpc_msg_decompress_chunk_func on_chunk,
+                                  void* arg) {
+  CHECK_GT(chunk_size, 0u);
   switch (algorithm) {
     case GRPC_COMPRESS_NONE:
-      return copy(input, output);
+      if (input->length > max_output_size) return -1;
+      for (size_t i = 0; i < input->count; i++) {
+        if (!on_chunk(arg, grpc_core::CSliceRef(input->slices[i]))) return 0;
+      }
+      return 1;
     case GRPC_COMPRESS_DEFLATE:
-      return zlib_decompress(input, output, 0);
+      return zlib_decompress(input, chunk_size, max_output_size, on_chunk, arg,
+                             0);
     case GRPC_COMPRESS_GZIP:
-      return zlib_decompress(input, output, 1);
+      return zlib_decompress(input, chunk_size, max_output_size, on_chunk, arg,
+                             1);
     case GRPC_COMPRESS_ALGORITHMS_COUNT:
       break;
   }
   LOG(ERROR) << "invalid compression algorithm " << algorithm;
   return 0;
 }
+
+static int append_chunk(void* arg, grpc_slice chunk) {
+  grpc_slice_buffer_add_indexed(static_cast<grpc_slice_buffer*>(arg), chunk);
+  return 1;
+}
+
+int grpc_msg_decompress_bounded(grpc_compression_algorithm algorithm,
+                                grpc_slice_buffer* input,
+                                grpc_slice_buffer* output,
+                                size_t max_output_size) {
+  size_t count_before = output->count;
+  size_t length_before = output->length;
+  int r = grpc_msg_decompress_streaming(algorithm, input, OUTPUT_BLOCK_SIZE,
+                                        max_output_size, append_chunk, output);
+  if (r != 1) {
+    for (size_t i = count_before; i < output->count; i++) {
+      grpc_core::CSliceUnref(output->slices[i]);
+    }
+    output->count = count_before;
+    output->length = length_before;
+  }
+  return r;
+}
+
+int grpc_msg_decompress(grpc_compression_algorithm algorithm,
+                        grpc_slice_buffer* input, grpc_slice_buffer* output) {
+  return grpc_msg_decompress_bounded(algorithm, input, output,
+                                     std::numeric_limits<size_t>::max());
+}
@@ -19,6 +19,7 @@
 #ifdef AVAILABLE_MAC_OS_X_VERSION_10_12_AND_LATER
 
 #include <CoreFoundation/CoreFoundation.h>
+#include <grpc/impl/channel_arg_names.h>
 #include <grpc/support/cpu.h>
 
 #include "absl/log/check.h"
@@ -26,6 +27,7 @@
 #include "src/core/lib/event_engine/cf_engine/cf_engine.h"
 #include "src/core/lib/event_engine/cf_engine/cfstream_endpoint.h"
 #include "src/core/lib/event_engine/cf_engine/dns_service_resolver.h"
+#include "src/core/lib/event_engine/cf_engine/nw_endpoint.h"
 #include "src/core/lib/event_engine/posix_engine/timer_manager.h"
 #include "src/core/lib/event_engine/tcp_socket_utils.h"
 #include "src/core/lib/event_engine/thread_pool/thread_pool.h"
@@ -85,11 +87,27 @@ CFEventEngine::CreateListener(
 
 CFEventEngine::ConnectionHandle CFEventEngine::Connect(
     OnConnectCallback on_connect, const ResolvedAddress& addr,
-    const EndpointConfig& /* args */, MemoryAllocator memory_allocator,
+    const EndpointConfig& args, MemoryAllocator memory_allocator,
     Duration timeout) {
-  auto endpoint_ptr = new CFStreamEndpoint(
-      std::static_pointer_cast<CFEventEngine>(shared_from_this()),
-      std::move(memory_allocator));
+  CFEngineClientEndpoint* endpoint_ptr = nullptr;
+#ifdef GRPC_CF_ENGINE_HAS_NETWORK_FRAMEWORK
+  if (args.GetInt(GRPC_ARG_USE_NETWORK_FRAMEWORK).value_or(0) != 0) {
+    if (__builtin_available(macOS 10.14, iOS 12.0, tvOS 12.0, watchOS 5.0,
+                            *)) {
+      auto tls_server_name =
+          args.GetString(GRPC_ARG_NETWORK_FRAMEWORK_TLS_SERVER_NAME);
+      endpoint_ptr = new NWEndpoint(
+          std::static_pointer_cast<CFEventEngine>(shared_from_this()),
+          std::move(memory_allocator),
+          std::string(tls_server_name.value_or("")));
+    }
+  }
+#endif  // GRPC_CF_ENGINE_HAS_NETWORK_FRAMEWORK
+  if (endpoint_ptr == nullptr) {
+    endpoint_ptr = new CFStreamEndpoint(
+        std::static_pointer_cast<CFEventEngine>(shared_from_this()),
+        std::move(memory_allocator));
+  }
 
   ConnectionHandle handle{reinterpret_cast<intptr_t>(endpoint_ptr), 0};
   {
@@ -116,7 +134,8 @@ CFEventEngine::ConnectionHandle CFEventEngine::Connect(
           that->conn_handles_.erase(handle);
         }
 
-        auto endpoint_ptr = reinterpret_cast<CFStreamEndpoint*>(handle.keys[0]);
+        auto endpoint_ptr =
+            reinterpret_cast<CFEngineClientEndpoint*>(handle.keys[0]);
 
         if (!status.ok()) {
           on_connect(std::move(status));
@@ -151,7 +170,8 @@ bool CFEventEngine::CancelConnectInternal(ConnectionHandle handle,
 
   // keep the `conn_mu_` lock to prevent endpoint_ptr from being deleted
 
-  auto endpoint_ptr = reinterpret_cast<CFStreamEndpoint*>(handle.keys[0]);
+  auto endpoint_ptr =
+      reinterpret_cast<CFEngineClientEndpoint*>(handle.keys[0]);
   return endpoint_ptr->CancelConnect(status);
 }
 
@@ -32,6 +32,15 @@
 namespace grpc_event_engine {
 namespace experimental {
 
+// An endpoint returned by CFEventEngine::Connect, which connects it after
+// creating it.
+class CFEngineClientEndpoint : public EventEngine::Endpoint {
+ public:
+  virtual void Connect(absl::AnyInvocable<void(absl::Status)> on_connect,
+                       EventEngine::ResolvedAddress addr) = 0;
+  virtual bool CancelConnect(absl::Status status) = 0;
+};
+
 class CFEventEngine : public EventEngine,
                       public Scheduler,
                       public grpc_core::KeepsGrpcInitialized {
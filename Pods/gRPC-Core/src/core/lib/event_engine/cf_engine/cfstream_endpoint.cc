@@ -30,6 +30,9 @@ namespace experimental {
 namespace {
 
 int kDefaultReadBufferSize = 8192;
+// Reads shrink towards this size as memory pressure in the resource quota
+// rises.
+int kMinReadBufferSize = 1024;
 
 absl::Status CFErrorToStatus(CFTypeUniqueRef<CFErrorRef> cf_error) {
   if (cf_error == nullptr) {
@@ -281,14 +284,13 @@ void CFStreamEndpointImpl::DoRead(
   GRPC_TRACE_LOG(event_engine_endpoint, INFO)
       << "CFStreamEndpointImpl::DoRead, this: " << this;
 
-  auto buffer_index = buffer->AppendIndexed(
-      Slice(memory_allocator_.MakeSlice(kDefaultReadBufferSize)));
+  auto buffer_index = buffer->AppendIndexed(Slice(memory_allocator_.MakeSlice(
+      MemoryRequest(kMinReadBufferSize, kDefaultReadBufferSize))));
+  MutableSlice& read_slice =
+      internal::SliceCast<MutableSlice>(buffer->MutableSliceAt(buffer_index));
 
-  CFIndex read_size = CFReadStreamRead(
-      cf_read_stream_,
-      internal::SliceCast<MutableSlice>(buffer->MutableSliceAt(buffer_index))
-          .begin(),
-      kDefaultReadBufferSize);
+  CFIndex read_size = CFReadStreamRead(cf_read_stream_, read_slice.begin(),
+                                       read_slice.length());
 
   if (read_size < 0) {
     auto status = CFErrorToStatus(CFReadStreamCopyError(cf_read_stream_));
@@ -0,0 +1,336 @@
+// Copyright 2023 The gRPC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <grpc/support/port_platform.h>
+
+#ifdef GPR_APPLE
+#include <AvailabilityMacros.h>
+#ifdef AVAILABLE_MAC_OS_X_VERSION_10_12_AND_LATER
+
+#include "src/core/lib/event_engine/cf_engine/nw_endpoint.h"
+
+#ifdef GRPC_CF_ENGINE_HAS_NETWORK_FRAMEWORK
+
+#include <grpc/slice.h>
+
+#include <algorithm>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "src/core/lib/event_engine/tcp_socket_utils.h"
+#include "src/core/util/host_port.h"
+
+namespace grpc_event_engine {
+namespace experimental {
+
+namespace {
+
+// The most that a single read asks the OS for, unless the transport hints
+// that it expects more.
+constexpr size_t kDefaultReadSize = 64 * 1024;
+// Reads shrink towards this size as memory pressure in the resource quota
+// rises.
+constexpr size_t kMinReadSize = 4 * 1024;
+
+API_AVAILABLE(macos(10.14), ios(12.0), tvos(12.0), watchos(5.0))
+absl::Status NWErrorToStatus(nw_error_t error) {
+  if (error == nullptr) {
+    return absl::OkStatus();
+  }
+  return absl::UnavailableError(
+      absl::StrFormat("(domain:%d, code:%d)", nw_error_get_error_domain(error),
+                      nw_error_get_error_code(error)));
+}
+
+API_AVAILABLE(macos(10.14), ios(12.0), tvos(12.0), watchos(5.0))
+absl::StatusOr<EventEngine::ResolvedAddress> NWEndpointAddress(
+    nw_endpoint_t endpoint) {
+  if (endpoint == nullptr ||
+      nw_endpoint_get_type(endpoint) != nw_endpoint_type_address) {
+    return absl::InternalError("endpoint has no address");
+  }
+  const sockaddr* addr = nw_endpoint_get_address(endpoint);
+  return EventEngine::ResolvedAddress(addr, addr->sa_len);
+}
+
+// Used as the destroy function of slices that point into received
+// dispatch_data regions.
+void ReleaseDispatchData(void* data) {
+  dispatch_release(static_cast<dispatch_data_t>(data));
+}
+
+}  // namespace
+
+NWEndpointImpl::NWEndpointImpl(std::shared_ptr<CFEventEngine> engine,
+                               MemoryAllocator memory_allocator,
+                               std::string tls_server_name)
+    : engine_(std::move(engine)),
+      memory_allocator_(std::move(memory_allocator)),
+      tls_server_name_(std::move(tls_server_name)),
+      queue_(dispatch_queue_create("grpc.nw_endpoint", DISPATCH_QUEUE_SERIAL)) {
+}
+
+NWEndpointImpl::~NWEndpointImpl() {
+  if (connection_ != nullptr) {
+    nw_release(connection_);
+  }
+  dispatch_release(queue_);
+}
+
+void NWEndpointImpl::Shutdown() {
+  GRPC_TRACE_LOG(event_engine_endpoint, INFO)
+      << "NWEndpointImpl::Shutdown: this: " << this;
+
+  FinishConnect(absl::CancelledError("Shutting down NWEndpointImpl"));
+  if (connection_ != nullptr) {
+    nw_connection_cancel(connection_);
+  }
+}
+
+bool NWEndpointImpl::CancelConnect(absl::Status status) {
+  GRPC_TRACE_LOG(event_engine_endpoint, INFO)
+      << "NWEndpointImpl::CancelConnect: status: " << status
+      << ", this: " << this;
+
+  if (!FinishConnect(std::move(status))) {
+    return false;
+  }
+  nw_connection_cancel(connection_);
+  return true;
+}
+
+bool NWEndpointImpl::FinishConnect(absl::Status status) {
+  absl::AnyInvocable<void(absl::Status)> on_connect;
+  {
+    grpc_core::MutexLock lock(&mu_);
+    on_connect = std::move(on_connect_);
+    on_connect_ = nullptr;
+  }
+  if (on_connect == nullptr) {
+    return false;
+  }
+  engine_->Run([on_connect = std::move(on_connect),
+                status = std::move(status)]() mutable {
+    on_connect(std::move(status));
+  });
+  return true;
+}
+
+void NWEndpointImpl::Connect(
+    absl::AnyInvocable<void(absl::Status)> on_connect,
+    EventEngine::ResolvedAddress addr) {
+  peer_address_ = std::move(addr);
+  auto host_port = ResolvedAddressToNormalizedString(peer_address_);
+  if (!host_port.ok()) {
+    on_connect(std::move(host_port).status());
+    return;
+  }
+
+  GRPC_TRACE_LOG(event_engine_endpoint, INFO)
+      << "NWEndpointImpl::Connect, host_port: " << host_port.value();
+
+  std::string host_string;
+  std::string port_string;
+  grpc_core::SplitHostPort(host_port.value(), &host_string, &port_string);
+  nw_endpoint_t endpoint =
+      nw_endpoint_create_host(host_string.c_str(), port_string.c_str());
+
+  nw_parameters_configure_protocol_block_t configure_tls =
+      NW_PARAMETERS_DISABLE_PROTOCOL;
+  if (!tls_server_name_.empty()) {
+    const char* server_name = tls_server_name_.c_str();
+    configure_tls = ^(nw_protocol_options_t tls_options) {
+      sec_protocol_options_t sec_options =
+          nw_tls_copy_sec_protocol_options(tls_options);
+      sec_protocol_options_set_tls_server_name(sec_options, server_name);
+      sec_protocol_options_add_tls_application_protocol(sec_options, "h2");
+      nw_release(sec_options);
+    };
+  }
+  nw_parameters_t parameters = nw_parameters_create_secure_tcp(
+      configure_tls, ^(nw_protocol_options_t tcp_options) {
+        nw_tcp_options_set_no_delay(tcp_options, true);
+      });
+
+  connection_ = nw_connection_create(endpoint, parameters);
+  nw_release(parameters);
+  nw_release(endpoint);
+
+  {
+    grpc_core::MutexLock lock(&mu_);
+    on_connect_ = std::move(on_connect);
+  }
+
+  // Released once the connection reports that it has been cancelled, after
+  // which the OS makes no more calls into this endpoint.
+  NWEndpointImpl* self = Ref().release();
+  nw_connection_set_queue(connection_, queue_);
+  nw_connection_set_state_changed_handler(
+      connection_, ^(nw_connection_state_t state, nw_error_t error) {
+        self->OnStateChanged(state, error);
+      });
+  nw_connection_start(connection_);
+}
+
+void NWEndpointImpl::OnStateChanged(nw_connection_state_t state,
+                                    nw_error_t error) {
+  GRPC_TRACE_LOG(event_engine_endpoint, INFO)
+      << "NWEndpointImpl::OnStateChanged, state: " << state
+      << ", this: " << this;
+
+  switch (state) {
+    case nw_connection_state_ready: {
+      nw_path_t path = nw_connection_copy_current_path(connection_);
+      nw_endpoint_t local = nw_path_copy_effective_local_endpoint(path);
+      auto local_addr = NWEndpointAddress(local);
+      if (local != nullptr) {
+        nw_release(local);
+      }
+      nw_release(path);
+      if (local_addr.ok()) {
+        local_address_ = local_addr.value();
+      }
+      FinishConnect(absl::OkStatus());
+    } break;
+    case nw_connection_state_waiting:
+      // The OS would wait for a usable network path, but gRPC handles
+      // reconnection itself.
+      ABSL_FALLTHROUGH_INTENDED;
+    case nw_connection_state_failed:
+      if (FinishConnect(NWErrorToStatus(error))) {
+        nw_connection_cancel(connection_);
+      }
+      break;
+    case nw_connection_state_cancelled:
+      FinishConnect(absl::CancelledError("Connection cancelled"));
+      Unref();
+      break;
+    default:
+      break;
+  }
+}
+
+bool NWEndpointImpl::Read(absl::AnyInvocable<void(absl::Status)> on_read,
+                          SliceBuffer* buffer,
+                          const EventEngine::Endpoint::ReadArgs* args) {
+  GRPC_TRACE_LOG(event_engine_endpoint, INFO)
+      << "NWEndpointImpl::Read, this: " << this;
+
+  size_t max_length = kDefaultReadSize;
+  if (args != nullptr && args->read_hint_bytes > 0) {
+    max_length =
+        std::max(max_length, static_cast<size_t>(args->read_hint_bytes));
+  }
+  // The OS allocates the buffers it reads into, so the read is only accounted
+  // against the quota while it is outstanding. The quota scales the
+  // reservation down under memory pressure, which bounds how much any single
+  // read can pull in.
+  const size_t reserved =
+      memory_allocator_.Reserve(MemoryRequest(kMinReadSize, max_length));
+
+  // Blocks copy what they capture, so the move-only callback lives on the
+  // heap until the read completes.
+  auto* callback =
+      new absl::AnyInvocable<void(absl::Status)>(std::move(on_read));
+  NWEndpointImpl* self = Ref().release();
+  nw_connection_receive(
+      connection_, 1, reserved,
+      ^(dispatch_data_t content, nw_content_context_t /* context */,
+        bool is_complete, nw_error_t error) {
+        absl::Status status = NWErrorToStatus(error);
+        if (status.ok() && content != nullptr) {
+          // Hand each region the OS filled to gRPC as-is; the slices keep the
+          // region alive.
+          dispatch_data_apply(
+              content, ^bool(dispatch_data_t region, size_t /* offset */,
+                             const void* bytes, size_t size) {
+                dispatch_retain(region);
+                buffer->Append(Slice(grpc_slice_new_with_user_data(
+                    const_cast<void*>(bytes), size, ReleaseDispatchData,
+                    region)));
+                return true;
+              });
+        } else if (status.ok() && is_complete) {
+          status = absl::UnavailableError("Socket closed");
+        }
+        self->memory_allocator_.Release(reserved);
+        self->engine_->Run([callback, status = std::move(status)]() mutable {
+          (*callback)(std::move(status));
+          delete callback;
+        });
+        self->Unref();
+      });
+
+  return false;
+}
+
+bool NWEndpointImpl::Write(
+    absl::AnyInvocable<void(absl::Status)> on_writable, SliceBuffer* data,
+    const EventEngine::Endpoint::WriteArgs* /* args */) {
+  GRPC_TRACE_LOG(event_engine_endpoint, INFO)
+      << "NWEndpointImpl::Write, this: " << this;
+
+  // Gather the slices into one dispatch_data without copying them; each piece
+  // holds a ref on its slice until the OS is done sending it. Inlined slices
+  // have no refcount and are small, so they are copied instead.
+  dispatch_data_t content = dispatch_data_empty;
+  for (size_t i = 0; i < data->Count(); i++) {
+    grpc_slice slice = data->RefSlice(i).TakeCSlice();
+    if (GRPC_SLICE_LENGTH(slice) == 0) {
+      grpc_slice_unref(slice);
+      continue;
+    }
+    dispatch_data_t piece;
+    if (slice.refcount == nullptr) {
+      piece = dispatch_data_create(GRPC_SLICE_START_PTR(slice),
+                                   GRPC_SLICE_LENGTH(slice), nullptr,
+                                   DISPATCH_DATA_DESTRUCTOR_DEFAULT);
+    } else {
+      piece = dispatch_data_create(GRPC_SLICE_START_PTR(slice),
+                                   GRPC_SLICE_LENGTH(slice), nullptr,
+                                   ^{
+                                     grpc_slice_unref(slice);
+                                   });
+    }
+    dispatch_data_t joined = dispatch_data_create_concat(content, piece);
+    dispatch_release(piece);
+    dispatch_release(content);
+    content = joined;
+  }
+
+  auto* callback =
+      new absl::AnyInvocable<void(absl::Status)>(std::move(on_writable));
+  NWEndpointImpl* self = Ref().release();
+  nw_connection_send(connection_, content,
+                     NW_CONNECTION_DEFAULT_STREAM_CONTEXT, false,
+                     ^(nw_error_t error) {
+                       absl::Status status = NWErrorToStatus(error);
+                       self->engine_->Run(
+                           [callback, status = std::move(status)]() mutable {
+                             (*callback)(std::move(status));
+                             delete callback;
+                           });
+                       self->Unref();
+                     });
+  dispatch_release(content);
+
+  return false;
+}
+
+}  // namespace experimental
+}  // namespace grpc_event_engine
+
+#endif  // GRPC_CF_ENGINE_HAS_NETWORK_FRAMEWORK
+#endif  // AVAILABLE_MAC_OS_X_VERSION_10_12_AND_LATER
+#endif  // GPR_APPLE
@@ -0,0 +1,136 @@
+// Copyright 2023 The gRPC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef GRPC_SRC_CORE_LIB_EVENT_ENGINE_CF_ENGINE_NW_ENDPOINT_H
+#define GRPC_SRC_CORE_LIB_EVENT_ENGINE_CF_ENGINE_NW_ENDPOINT_H
+#include <grpc/support/port_platform.h>
+
+#ifdef GPR_APPLE
+#include <AvailabilityMacros.h>
+#ifdef AVAILABLE_MAC_OS_X_VERSION_10_12_AND_LATER
+#if __has_include(<Network/Network.h>)
+#define GRPC_CF_ENGINE_HAS_NETWORK_FRAMEWORK 1
+
+#include <Network/Network.h>
+#include <grpc/event_engine/event_engine.h>
+
+#include <string>
+
+#include "src/core/lib/event_engine/cf_engine/cf_engine.h"
+#include "src/core/util/ref_counted.h"
+#include "src/core/util/ref_counted_ptr.h"
+#include "src/core/util/sync.h"
+
+namespace grpc_event_engine {
+namespace experimental {
+
+// An endpoint built on a Network.framework nw_connection. Received data is
+// handed to gRPC in the buffers the OS filled, and outgoing slices are passed
+// to the OS without being copied; connections also follow the OS's choice of
+// network path, including Wi-Fi Assist.
+//
+// If tls_server_name is not empty, the OS does TLS for the connection with
+// that server name and offers "h2" through ALPN. This is only meant for
+// channels whose credentials add no TLS of their own.
+class API_AVAILABLE(macos(10.14), ios(12.0), tvos(12.0), watchos(5.0))
+    NWEndpointImpl : public grpc_core::RefCounted<NWEndpointImpl> {
+ public:
+  NWEndpointImpl(std::shared_ptr<CFEventEngine> engine,
+                 MemoryAllocator memory_allocator,
+                 std::string tls_server_name);
+  ~NWEndpointImpl();
+
+  void Shutdown();
+
+  bool Read(absl::AnyInvocable<void(absl::Status)> on_read, SliceBuffer* buffer,
+            const EventEngine::Endpoint::ReadArgs* args);
+  bool Write(absl::AnyInvocable<void(absl::Status)> on_writable,
+             SliceBuffer* data, const EventEngine::Endpoint::WriteArgs* args);
+
+  const EventEngine::ResolvedAddress& GetPeerAddress() const {
+    return peer_address_;
+  }
+  const EventEngine::ResolvedAddress& GetLocalAddress() const {
+    return local_address_;
+  }
+
+  void Connect(absl::AnyInvocable<void(absl::Status)> on_connect,
+               EventEngine::ResolvedAddress addr);
+  bool CancelConnect(absl::Status status);
+
+ private:
+  void OnStateChanged(nw_connection_state_t state, nw_error_t error);
+  // Calls the pending connect callback, if any, on an engine thread.
+  bool FinishConnect(absl::Status status);
+
+  std::shared_ptr<CFEventEngine> engine_;
+  MemoryAllocator memory_allocator_;
+  const std::string tls_server_name_;
+
+  dispatch_queue_t queue_;
+  nw_connection_t connection_ = nullptr;
+
+  EventEngine::ResolvedAddress peer_address_;
+  EventEngine::ResolvedAddress local_address_;
+
+  grpc_core::Mutex mu_;
+  absl::AnyInvocable<void(absl::Status)> on_connect_ ABSL_GUARDED_BY(mu_);
+};
+
+class API_AVAILABLE(macos(10.14), ios(12.0), tvos(12.0), watchos(5.0))
+    NWEndpoint : public CFEngineClientEndpoint {
+ public:
+  NWEndpoint(std::shared_ptr<CFEventEngine> engine,
+             MemoryAllocator memory_allocator, std::string tls_server_name) {
+    impl_ = grpc_core::MakeRefCounted<NWEndpointImpl>(
+        std::move(engine), std::move(memory_allocator),
+        std::move(tls_server_name));
+  }
+  ~NWEndpoint() override { impl_->Shutdown(); }
+
+  bool Read(absl::AnyInvocable<void(absl::Status)> on_read, SliceBuffer* buffer,
+            const ReadArgs* args) override {
+    return impl_->Read(std::move(on_read), buffer, args);
+  }
+  bool Write(absl::AnyInvocable<void(absl::Status)> on_writable,
+             SliceBuffer* data, const WriteArgs* args) override {
+    return impl_->Write(std::move(on_writable), data, args);
+  }
+
+  const EventEngine::ResolvedAddress& GetPeerAddress() const override {
+    return impl_->GetPeerAddress();
+  }
+  const EventEngine::ResolvedAddress& GetLocalAddress() const override {
+    return impl_->GetLocalAddress();
+  }
+
+  void Connect(absl::AnyInvocable<void(absl::Status)> on_connect,
+               EventEngine::ResolvedAddress addr) override {
+    impl_->Connect(std::move(on_connect), std::move(addr));
+  }
+  bool CancelConnect(absl::Status status) override {
+    return impl_->CancelConnect(std::move(status));
+  }
+
+ private:
+  grpc_core::RefCountedPtr<NWEndpointImpl> impl_;
+};
+
+}  // namespace experimental
+}  // namespace grpc_event_engine
+
+#endif  // __has_include(<Network/Network.h>)
+#endif  // AVAILABLE_MAC_OS_X_VERSION_10_12_AND_LATER
+#endif  // GPR_APPLE
+
+#endif  // GRPC_SRC_CORE_LIB_EVENT_ENGINE_CF_ENGINE_NW_ENDPOINT_H
@@ -759,6 +759,8 @@ void PosixEndpointImpl::ProcessZerocopy(struct cmsghdr* cmsg) {
   DCHECK(serr->ee_origin == SO_EE_ORIGIN_ZEROCOPY);
   const uint32_t lo = serr->ee_info;
   const uint32_t hi = serr->ee_data;
+  tcp_zerocopy_send_ctx_->NoteCompletion(
+      (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0);
   for (uint32_t seq = lo; seq <= hi; ++seq) {
     // TODO(arjunroy): It's likely that lo and hi refer to zerocopy sequence
     // numbers that are generated by a single call to grpc_endpoint_write; ie.
@@ -60,6 +60,13 @@ TimerList::TimerList(TimerListHost* host)
             min_timer_.load(std::memory_order_relaxed));
     shard.shard_queue_index = i;
     shard.list.next = shard.list.prev = &shard.list;
+    for (Timer& slot : shard.wheel) {
+      slot.next = slot.prev = &slot;
+    }
+    shard.wheel_cursor =
+        shard.queue_deadline_cap.milliseconds_after_process_epoch() /
+        Shard::kWheelSlotMillis;
+    shard.next_list_scan = shard.wheel_cursor + Shard::kWheelSlots / 2;
     shard.min_deadline = shard.ComputeMinDeadline();
     shard_queue_[i] = &shard;
   }
@@ -128,8 +135,7 @@ void TimerList::TimerInit(Timer* timer, grpc_core::Timestamp deadline,
     if (deadline < shard->queue_deadline_cap) {
       is_first_timer = shard->heap.Add(timer);
     } else {
-      timer->heap_index = kInvalidHeapIndex;
-      ListJoin(&shard->list, timer);
+      shard->AddToWheelOrList(timer);
     }
   }
 
@@ -176,9 +182,21 @@ bool TimerList::TimerCancel(Timer* timer) {
   return false;
 }
 
+void TimerList::Shard::AddToWheelOrList(Timer* timer) {
+  timer->heap_index = kInvalidHeapIndex;
+  const int64_t slot =
+      std::max(timer->deadline / kWheelSlotMillis, wheel_cursor);
+  if (slot < wheel_cursor + kWheelSlots) {
+    ListJoin(&wheel[slot % kWheelSlots], timer);
+  } else {
+    ListJoin(&list, timer);
+  }
+}
+
 // Rebalances the timer shard by computing a new 'queue_deadline_cap' and moving
-// all relevant timers in shard->list (i.e timers with deadlines earlier than
-// 'queue_deadline_cap') into into shard->heap.
+// all relevant timers in the wheel (i.e timers with deadlines earlier than
+// 'queue_deadline_cap') into into shard->heap. Every half turn of the wheel,
+// timers in shard->list that have come within its horizon are moved into it.
 // Returns 'true' if shard->heap has at least ONE element
 bool TimerList::Shard::RefillHeap(grpc_core::Timestamp now) {
   // Compute the new queue window width and bound by the limits:
@@ -191,16 +209,35 @@ bool TimerList::Shard::RefillHeap(grpc_core::Timestamp now) {
   // Compute the new cap and put all timers under it into the queue:
   queue_deadline_cap = std::max(now, queue_deadline_cap) +
                        grpc_core::Duration::FromSecondsAsDouble(deadline_delta);
-
-  for (timer = list.next; timer != &list; timer = next) {
-    next = timer->next;
-    auto timer_deadline =
-        grpc_core::Timestamp::FromMillisecondsAfterProcessEpoch(
-            timer->deadline);
-
-    if (timer_deadline < queue_deadline_cap) {
-      ListRemove(timer);
-      heap.Add(timer);
+  const int64_t cap = queue_deadline_cap.milliseconds_after_process_epoch();
+  const int64_t cap_slot = cap / kWheelSlotMillis;
+
+  // Only the slot the cap falls in can keep any of its timers.
+  const int64_t last_slot = std::min(cap_slot, wheel_cursor + kWheelSlots - 1);
+  for (int64_t slot = wheel_cursor; slot <= last_slot; ++slot) {
+    Timer* head = &wheel[slot % kWheelSlots];
+    for (timer = head->next; timer != head; timer = next) {
+      next = timer->next;
+      if (timer->deadline < cap) {
+        ListRemove(timer);
+        heap.Add(timer);
+      }
+    }
+  }
+  wheel_cursor = std::max(wheel_cursor, cap_slot);
+
+  if (wheel_cursor >= next_list_scan) {
+    next_list_scan = wheel_cursor + kWheelSlots / 2;
+    for (timer = list.next; timer != &list; timer = next) {
+      next = timer->next;
+      if (timer->deadline < cap) {
+        ListRemove(timer);
+        heap.Add(timer);
+      } else if (timer->deadline / kWheelSlotMillis <
+                 wheel_cursor + kWheelSlots) {
+        ListRemove(timer);
+        AddToWheelOrList(timer);
+      }
     }
   }
   return !heap.is_empty();
@@ -101,16 +101,23 @@ class TimerList {
       grpc_core::Timestamp* next);
 
  private:
-  // A "timer shard". Contains a 'heap' and a 'list' of timers. All timers with
-  // deadlines earlier than 'queue_deadline_cap' are maintained in the heap and
-  // others are maintained in the list (unordered). This helps to keep the
-  // number of elements in the heap low.
+  // A "timer shard". Contains a 'heap', a 'wheel' and a 'list' of timers. All
+  // timers with deadlines earlier than 'queue_deadline_cap' are maintained in
+  // the heap. Later timers are bucketed by deadline into the wheel if they are
+  // due within its horizon, and kept in the list (unordered) otherwise. This
+  // helps to keep the number of elements in the heap low, and lets most timers
+  // be cancelled before they ever reach it.
   //
   // The 'queue_deadline_cap' gets recomputed periodically based on the timer
   // stats maintained in 'stats' and the relevant timers are then moved from the
-  // 'list' to 'heap'.
+  // wheel slots it has reached to 'heap'. The list is only rescanned every
+  // half turn of the wheel.
   //
   struct Shard {
+    // Number of wheel slots, and the span of deadlines each one holds.
+    static constexpr int64_t kWheelSlots = 64;
+    static constexpr int64_t kWheelSlotMillis = 128;
+
     Shard();
 
     grpc_core::Timestamp ComputeMinDeadline() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu);
@@ -120,6 +127,8 @@ class TimerList {
                    grpc_core::Timestamp* new_min_deadline,
                    std::vector<experimental::EventEngine::Closure*>* out)
         ABSL_LOCKS_EXCLUDED(mu);
+    // Put a timer due at or after queue_deadline_cap into the wheel or list.
+    void AddToWheelOrList(Timer* timer) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu);
 
     grpc_core::Mutex mu;
     grpc_core::TimeAveragedStats stats ABSL_GUARDED_BY(mu);
@@ -132,7 +141,15 @@ class TimerList {
     // This holds all timers with deadlines < queue_deadline_cap. Timers in this
     // list have the top bit of their deadline set to 0.
     TimerHeap heap ABSL_GUARDED_BY(mu);
-    // This holds timers whose deadline is >= queue_deadline_cap.
+    // Heads of the wheel slots. Slot i holds timers whose deadline is >=
+    // queue_deadline_cap and falls in a kWheelSlotMillis span numbered i modulo
+    // kWheelSlots, starting from wheel_cursor.
+    Timer wheel[kWheelSlots] ABSL_GUARDED_BY(mu);
+    // The span that queue_deadline_cap falls in.
+    int64_t wheel_cursor ABSL_GUARDED_BY(mu);
+    // The wheel_cursor at which the list is next rescanned.
+    int64_t next_list_scan ABSL_GUARDED_BY(mu);
+    // This holds timers whose deadline is beyond the wheel's horizon.
     Timer list ABSL_GUARDED_BY(mu);
   };
 
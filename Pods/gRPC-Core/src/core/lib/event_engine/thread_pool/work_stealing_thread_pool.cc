@@ -17,6 +17,7 @@
 //
 #include "src/core/lib/event_engine/thread_pool/work_stealing_thread_pool.h"
 
+#include <grpc/support/cpu.h>
 #include <grpc/support/port_platform.h>
 #include <grpc/support/thd_id.h>
 #include <inttypes.h>
@@ -51,6 +52,12 @@
 #include <signal.h>
 #endif
 
+#ifdef GPR_APPLE
+#include <pthread.h>
+#include <sys/qos.h>
+#include <sys/sysctl.h>
+#endif
+
 // IWYU pragma: no_include <ratio>
 
 // ## Thread Pool Fork-handling
@@ -100,6 +107,16 @@
 // enable advanced debugging. When the pool takes too long to quiesce, a
 // backtrace will be printed for every running thread, and the process will
 // abort.
+//
+// ## Core affinity
+//
+// Set the environment variable GRPC_THREAD_POOL_AFFINITY=performance to keep
+// worker threads on performance cores. On Apple platforms, which do not let
+// threads be bound to cores, the first workers (one per performance core) ask
+// for the user-initiated QoS class, which the scheduler runs on performance
+// cores and below user-interactive work such as rendering. Workers started
+// beyond that, which only exist because others are blocked, ask for the
+// utility class so that they stay on efficiency cores.
 
 namespace grpc_event_engine {
 namespace experimental {
@@ -149,8 +166,40 @@ constexpr bool g_log_verbose_failures = false;
 constexpr int kDumpStackSignal = -1;
 #endif
 
+const bool g_prefer_performance_cores =
+    grpc_core::GetEnv("GRPC_THREAD_POOL_AFFINITY").value_or("") ==
+    "performance";
+
 std::atomic<size_t> g_reported_dump_count{0};
 
+#ifdef GPR_APPLE
+size_t PerformanceCoreCount() {
+  int count = 0;
+  size_t size = sizeof(count);
+  if (sysctlbyname("hw.perflevel0.logicalcpu", &count, &size, nullptr, 0) ==
+          0 &&
+      count > 0) {
+    return count;
+  }
+  return gpr_cpu_num_cores();
+}
+#endif
+
+// Steers the calling worker thread towards performance cores, given how many
+// workers are running including it.
+void ApplyCoreAffinity(size_t living_threads) {
+  if (!g_prefer_performance_cores) return;
+#ifdef GPR_APPLE
+  static const size_t performance_cores = PerformanceCoreCount();
+  pthread_set_qos_class_self_np(living_threads <= performance_cores
+                                    ? QOS_CLASS_USER_INITIATED
+                                    : QOS_CLASS_UTILITY,
+                                0);
+#else
+  (void)living_threads;
+#endif
+}
+
 void DumpSignalHandler(int /* sig */) {
   const auto trace = grpc_core::GetCurrentStackTrace();
   if (!trace.has_value()) {
@@ -482,6 +531,7 @@ void WorkStealingThreadPool::ThreadState::ThreadBody() {
 #endif
     pool_->TrackThread(gpr_thd_currentid());
   }
+  ApplyCoreAffinity(pool_->living_thread_count()->count());
   g_local_queue = new BasicWorkQueue(pool_.get());
   pool_->theft_registry()->Enroll(g_local_queue);
   ThreadLocal::SetIsEventEngineThread(true);
@@ -20,8 +20,12 @@
 
 #include <grpc/support/port_platform.h>
 
+#include <atomic>
+
 grpc_pollset_vtable* grpc_pollset_impl;
 
+static std::atomic<uint64_t> g_pollset_work_count{0};
+
 void grpc_set_pollset_vtable(grpc_pollset_vtable* vtable) {
   grpc_pollset_impl = vtable;
 }
@@ -45,9 +49,14 @@ void grpc_pollset_destroy(grpc_pollset* pollset) {
 grpc_error_handle grpc_pollset_work(grpc_pollset* pollset,
                                     grpc_pollset_worker** worker,
                                     grpc_core::Timestamp deadline) {
+  g_pollset_work_count.fetch_add(1, std::memory_order_relaxed);
   return grpc_pollset_impl->work(pollset, worker, deadline);
 }
 
+uint64_t grpc_pollset_work_count(void) {
+  return g_pollset_work_count.load(std::memory_order_relaxed);
+}
+
 grpc_error_handle grpc_pollset_kick(grpc_pollset* pollset,
                                     grpc_pollset_worker* specific_worker) {
   return grpc_pollset_impl->kick(pollset, specific_worker);
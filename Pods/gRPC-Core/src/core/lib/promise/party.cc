@@ -16,6 +16,7 @@
 
 #include <grpc/support/port_platform.h>
 
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
 
@@ -23,6 +24,7 @@
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/strip.h"
 #include "src/core/lib/event_engine/event_engine_context.h"
 #include "src/core/lib/iomgr/exec_ctx.h"
 #include "src/core/lib/promise/activity.h"
@@ -36,6 +38,66 @@
 
 namespace grpc_core {
 
+#ifdef GRPC_ENABLE_PARTY_STATS
+///////////////////////////////////////////////////////////////////////////////
+// PartyProfiler
+
+namespace {
+
+std::atomic<PartyProfiler*> g_party_profiler{nullptr};
+std::atomic<uint32_t> g_party_profiler_sample_every{1};
+thread_local uint32_t g_polls_until_sample = 0;
+
+// Extracts the type from the signature returned by party_detail::TypeName().
+absl::string_view PromiseTypeName(absl::string_view signature) {
+#ifdef _MSC_VER
+  constexpr absl::string_view kPrefix = "TypeName<";
+  constexpr absl::string_view kSuffix = ">(void)";
+#else
+  constexpr absl::string_view kPrefix = "T = ";
+  constexpr absl::string_view kSuffix = "]";
+#endif
+  const size_t start = signature.find(kPrefix);
+  if (start == absl::string_view::npos) return signature;
+  signature.remove_prefix(start + kPrefix.size());
+  absl::ConsumeSuffix(&signature, kSuffix);
+  return signature;
+}
+
+}  // namespace
+
+void SetPartyProfiler(PartyProfiler* profiler, uint32_t sample_every) {
+  g_party_profiler_sample_every.store(std::max<uint32_t>(sample_every, 1),
+                                      std::memory_order_relaxed);
+  g_party_profiler.store(profiler, std::memory_order_release);
+}
+
+bool Party::PollParticipantWithStats(Participant* participant) {
+  ++stats_.polls;
+  const uint32_t polls = ++participant->polls;
+  PartyProfiler* profiler = g_party_profiler.load(std::memory_order_acquire);
+  bool done;
+  if (profiler != nullptr && g_polls_until_sample-- == 0) {
+    g_polls_until_sample =
+        g_party_profiler_sample_every.load(std::memory_order_relaxed) - 1;
+    // The participant may delete itself when it completes.
+    const char* type_name = participant->TypeName();
+    const auto start = std::chrono::steady_clock::now();
+    done = participant->PollParticipantPromise();
+    profiler->OnPoll(PromiseTypeName(type_name),
+                     std::chrono::steady_clock::now() - start, polls);
+  } else {
+    done = participant->PollParticipantPromise();
+  }
+  if (done) {
+    ++stats_.participants_completed;
+    stats_.max_polls_per_participant =
+        std::max(stats_.max_polls_per_participant, polls);
+  }
+  return done;
+}
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 // PartySyncUsingAtomics
 
@@ -193,6 +255,9 @@ void Party::ForceImmediateRepoll(WakeupMask mask) {
 
 void Party::RunLockedAndUnref(Party* party, uint64_t prev_state) {
   GRPC_LATENT_SEE_PARENT_SCOPE("Party::RunLocked");
+#ifdef GRPC_ENABLE_PARTY_STATS
+  party->lock_time_ = std::chrono::steady_clock::now();
+#endif
 #ifdef GRPC_MAXIMIZE_THREADYNESS
   Thread thd(
       "RunParty",
@@ -280,6 +345,13 @@ void Party::RunPartyAndUnref(uint64_t prev_state) {
   DCHECK_EQ(prev_state & ~(kRefMask | kAllocatedMask), 0u)
       << "Party should have contained no wakeups on lock";
   prev_state |= kLocked;
+#ifdef GRPC_ENABLE_PARTY_STATS
+  ++stats_.runs;
+  const std::chrono::nanoseconds wakeup_delay =
+      std::chrono::steady_clock::now() - lock_time_;
+  stats_.total_wakeup_delay += wakeup_delay;
+  stats_.max_wakeup_delay = std::max(stats_.max_wakeup_delay, wakeup_delay);
+#endif
   absl::optional<ScopedTimeCache> time_cache;
 #if !TARGET_OS_IPHONE
   if (IsTimeCachingInPartyEnabled()) {
@@ -309,7 +381,11 @@ void Party::RunPartyAndUnref(uint64_t prev_state) {
             << "Party " << this << "                 Run:Wakeup " << i;
         // Poll the participant.
         currently_polling_ = i;
+#ifdef GRPC_ENABLE_PARTY_STATS
+        if (PollParticipantWithStats(participant)) {
+#else
         if (participant->PollParticipantPromise()) {
+#endif
           participants_[i].store(nullptr, std::memory_order_relaxed);
           const uint64_t allocated_bit = (1u << i << kAllocatedShift);
           keep_allocated_mask &= ~allocated_bit;
@@ -447,6 +523,10 @@ void Party::Drop(WakeupMask) { Unref(); }
 
 void Party::PartyIsOver() {
   CancelRemainingParticipants();
+#ifdef GRPC_ENABLE_PARTY_STATS
+  PartyProfiler* profiler = g_party_profiler.load(std::memory_order_acquire);
+  if (profiler != nullptr) profiler->OnPartyOver(stats_);
+#endif
   auto arena = std::move(arena_);
   this->~Party();
 }
@@ -24,6 +24,10 @@
 #include <string>
 #include <utility>
 
+#ifdef GRPC_ENABLE_PARTY_STATS
+#include <chrono>
+#endif
+
 #include "absl/base/attributes.h"
 #include "absl/base/thread_annotations.h"
 #include "absl/log/check.h"
@@ -50,6 +54,20 @@ namespace party_detail {
 // participants.
 static constexpr size_t kMaxParticipants = 16;
 
+#ifdef GRPC_ENABLE_PARTY_STATS
+// Returns a string that names T, for attributing poll time to promise types.
+// Only the pointer is kept on the poll path; the name is extracted from it
+// when a poll is sampled.
+template <typename T>
+const char* TypeName() {
+#ifdef _MSC_VER
+  return __FUNCSIG__;
+#else
+  return __PRETTY_FUNCTION__;
+#endif
+}
+#endif
+
 }  // namespace party_detail
 
 // A Party is an Activity with multiple participant promises.
@@ -71,6 +89,14 @@ class Party : public Activity, private Wakeable {
     // Return a Handle instance for this participant.
     Wakeable* MakeNonOwningWakeable(Party* party);
 
+#ifdef GRPC_ENABLE_PARTY_STATS
+    // The result of party_detail::TypeName() for the participant's promise.
+    virtual const char* TypeName() const = 0;
+
+    // Times the participant has been polled.
+    uint32_t polls = 0;
+#endif
+
    protected:
     ~Participant();
 
@@ -82,6 +108,28 @@ class Party : public Activity, private Wakeable {
   Party(const Party&) = delete;
   Party& operator=(const Party&) = delete;
 
+#ifdef GRPC_ENABLE_PARTY_STATS
+  // Counters kept by each party when built with GRPC_ENABLE_PARTY_STATS,
+  // and handed to the PartyProfiler when the party is over.
+  struct Stats {
+    // Times the party was locked and run.
+    uint64_t runs = 0;
+    // Participant polls over all runs.
+    uint64_t polls = 0;
+    // Participants that ran to completion.
+    uint64_t participants_completed = 0;
+    // Most polls any one participant needed to complete.
+    uint32_t max_polls_per_participant = 0;
+    // Time between a wakeup locking the party and the party running, which
+    // grows when runs are queued behind other parties or offloaded to the
+    // EventEngine.
+    std::chrono::nanoseconds total_wakeup_delay{0};
+    std::chrono::nanoseconds max_wakeup_delay{0};
+  };
+
+  const Stats& stats() const { return stats_; }
+#endif
+
   // When calling into a Party from outside the promises system we often would
   // like to perform more than one action.
   // This class tries to acquire the party lock just once - if it succeeds then
@@ -235,6 +283,12 @@ class Party : public Activity, private Wakeable {
 
     void Destroy() override { delete this; }
 
+#ifdef GRPC_ENABLE_PARTY_STATS
+    const char* TypeName() const override {
+      return party_detail::TypeName<Promise>();
+    }
+#endif
+
    private:
     union {
       GPR_NO_UNIQUE_ADDRESS Factory factory_;
@@ -314,6 +368,12 @@ class Party : public Activity, private Wakeable {
 
     void Destroy() override { this->Unref(); }
 
+#ifdef GRPC_ENABLE_PARTY_STATS
+    const char* TypeName() const override {
+      return party_detail::TypeName<Promise>();
+    }
+#endif
+
    private:
     enum class State : uint8_t { kFactory, kPromise, kResult };
     union {
@@ -414,6 +474,12 @@ class Party : public Activity, private Wakeable {
   void WakeupAsync(WakeupMask wakeup_mask) final;
   void Drop(WakeupMask wakeup_mask) final;
 
+#ifdef GRPC_ENABLE_PARTY_STATS
+  // PollParticipantPromise(), counted into stats_ and sampled for the
+  // profiler.
+  bool PollParticipantWithStats(Participant* participant);
+#endif
+
   // Add a participant (backs Spawn, after type erasure to ParticipantFactory).
   void AddParticipant(Participant* participant);
   void DelayAddParticipant(Participant* participant);
@@ -438,8 +504,36 @@ class Party : public Activity, private Wakeable {
   // If the lower bit is set, then this is a ParticipantFactory*.
   std::atomic<Participant*> participants_[party_detail::kMaxParticipants] = {};
   RefCountedPtr<Arena> arena_;
+#ifdef GRPC_ENABLE_PARTY_STATS
+  Stats stats_;
+  // When the party was last locked to run.
+  std::chrono::steady_clock::time_point lock_time_;
+#endif
 };
 
+#ifdef GRPC_ENABLE_PARTY_STATS
+// Receives the counters of every party, and a sample of individual polls.
+// Methods are called from whichever thread runs the party, so they must be
+// thread safe and quick.
+class PartyProfiler {
+ public:
+  virtual ~PartyProfiler() = default;
+
+  // A sampled poll that took poll_time. promise_type names the promise, and
+  // polls counts the polls of this participant so far, including this one:
+  // a promise type with high counts is spinning.
+  virtual void OnPoll(absl::string_view promise_type,
+                      std::chrono::nanoseconds poll_time, uint32_t polls) = 0;
+
+  // Called once per party, when it is over.
+  virtual void OnPartyOver(const Party::Stats& stats) = 0;
+};
+
+// Installs profiler, which must outlive all parties, or removes it when
+// nullptr. One in sample_every polls is timed and reported.
+void SetPartyProfiler(PartyProfiler* profiler, uint32_t sample_every);
+#endif
+
 template <>
 struct ContextSubclass<Party> {
   using Base = Activity;
@@ -27,16 +27,78 @@
 #include "absl/log/log.h"
 #include "src/core/lib/resource_quota/resource_quota.h"
 #include "src/core/util/alloc.h"
+#include "src/core/util/allocation_stats.h"
 namespace grpc_core {
 
 namespace {
 
+// Calls come and go at a high rate, and their arenas are sized from the
+// learned call size, so a thread tends to free an arena of about the size it
+// is about to allocate next. Keep a few freed initial zones per thread so that
+// steady-state calls don't need the global allocator.
+class ArenaStorageCache {
+ public:
+  ~ArenaStorageCache() {
+    for (size_t i = 0; i < count_; ++i) {
+      gpr_free_aligned(blocks_[i].storage);
+    }
+  }
+
+  // Returns a cached block of at least `size` bytes but not much more, and
+  // sets `size` to its actual size. Returns nullptr if none fits.
+  void* Take(size_t& size) {
+    for (size_t i = 0; i < count_; ++i) {
+      if (blocks_[i].size >= size && blocks_[i].size <= 2 * size) {
+        Block block = blocks_[i];
+        blocks_[i] = blocks_[--count_];
+        size = block.size;
+        return block.storage;
+      }
+    }
+    return nullptr;
+  }
+
+  // Keeps `storage` for reuse if there is room, or frees it.
+  void Give(void* storage, size_t size) {
+    if (size <= kMaxCachedSize) {
+      if (count_ == kMaxCachedBlocks) {
+        // Make room by dropping the oldest block.
+        gpr_free_aligned(blocks_[0].storage);
+        blocks_[0] = blocks_[--count_];
+      }
+      blocks_[count_++] = Block{storage, size};
+      return;
+    }
+    gpr_free_aligned(storage);
+  }
+
+ private:
+  static constexpr size_t kMaxCachedBlocks = 4;
+  static constexpr size_t kMaxCachedSize = 64 * 1024;
+
+  struct Block {
+    void* storage;
+    size_t size;
+  };
+
+  Block blocks_[kMaxCachedBlocks];
+  size_t count_ = 0;
+};
+
+ArenaStorageCache& LocalArenaStorageCache() {
+  static thread_local ArenaStorageCache cache;
+  return cache;
+}
+
 void* ArenaStorage(size_t& initial_size) {
   size_t base_size = Arena::ArenaOverhead() +
                      GPR_ROUND_UP_TO_ALIGNMENT_SIZE(
                          arena_detail::BaseArenaContextTraits::ContextSize());
   initial_size =
       std::max(GPR_ROUND_UP_TO_ALIGNMENT_SIZE(initial_size), base_size);
+  if (void* storage = LocalArenaStorageCache().Take(initial_size)) {
+    return storage;
+  }
   static constexpr size_t alignment =
       (GPR_CACHELINE_SIZE > GPR_MAX_ALIGNMENT &&
        GPR_CACHELINE_SIZE % GPR_MAX_ALIGNMENT == 0)
@@ -56,13 +118,20 @@ Arena::~Arena() {
   arena_factory_->FinalizeArena(this);
   arena_factory_->allocator().Release(
       total_allocated_.load(std::memory_order_relaxed));
+  size_t zones = 1;
   Zone* z = last_zone_;
   while (z) {
     Zone* prev_z = z->prev;
     Destruct(z);
     gpr_free_aligned(z);
     z = prev_z;
+    ++zones;
   }
+  // The initial zone counts as freed even if a thread keeps it for reuse.
+  RecordFree(AllocationSubsystem::kArena,
+             initial_zone_size_ +
+                 total_allocated_.load(std::memory_order_relaxed),
+             zones);
 }
 
 RefCountedPtr<Arena> Arena::Create(size_t initial_size,
@@ -84,6 +153,7 @@ Arena::Arena(size_t initial_size, RefCountedPtr<ArenaFactory> arena_factory)
   }
   CHECK_GE(initial_size, arena_detail::BaseArenaContextTraits::ContextSize());
   arena_factory_->allocator().Reserve(initial_size);
+  RecordAllocation(AllocationSubsystem::kArena, initial_size);
 }
 
 void Arena::DestroyManagedNewObjects() {
@@ -100,8 +170,9 @@ void Arena::DestroyManagedNewObjects() {
 }
 
 void Arena::Destroy() const {
+  const size_t initial_zone_size = initial_zone_size_;
   this->~Arena();
-  gpr_free_aligned(const_cast<Arena*>(this));
+  LocalArenaStorageCache().Give(const_cast<Arena*>(this), initial_zone_size);
 }
 
 void* Arena::AllocZone(size_t size) {
@@ -115,6 +186,7 @@ void* Arena::AllocZone(size_t size) {
   size_t alloc_size = zone_base_size + size;
   arena_factory_->allocator().Reserve(alloc_size);
   total_allocated_.fetch_add(alloc_size, std::memory_order_relaxed);
+  RecordAllocation(AllocationSubsystem::kArena, alloc_size);
   Zone* z = new (gpr_malloc_aligned(alloc_size, GPR_MAX_ALIGNMENT)) Zone();
   auto* prev = last_zone_.load(std::memory_order_relaxed);
   do {
@@ -294,6 +294,7 @@ size_t GrpcMemoryAllocatorImpl::Reserve(MemoryRequest request) {
     // Attempt to reserve memory from our pool.
     auto reservation = TryReserve(request);
     if (reservation.has_value()) {
+      RecordAllocation(AllocationSubsystem::kMemoryAllocator, *reservation);
       size_t new_free = free_bytes_.load(std::memory_order_relaxed);
       memory_quota_->MaybeMoveAllocator(this, old_free, new_free);
       return *reservation;
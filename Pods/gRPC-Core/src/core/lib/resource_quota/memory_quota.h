@@ -40,6 +40,7 @@
 #include "src/core/lib/promise/activity.h"
 #include "src/core/lib/promise/poll.h"
 #include "src/core/lib/resource_quota/periodic_update.h"
+#include "src/core/util/allocation_stats.h"
 #include "src/core/util/orphanable.h"
 #include "src/core/util/ref_counted_ptr.h"
 #include "src/core/util/sync.h"
@@ -408,6 +409,7 @@ class GrpcMemoryAllocatorImpl final : public EventEngineMemoryAllocatorImpl {
     // Add the released memory to our free bytes counter... if this increases
     // from  0 to non-zero, then we have more to do, otherwise, we're actually
     // done.
+    RecordFree(AllocationSubsystem::kMemoryAllocator, n);
     size_t prev_free = free_bytes_.fetch_add(n, std::memory_order_release);
     if ((!IsUnconstrainedMaxQuotaBufferSizeEnabled() &&
          prev_free + n > kMaxQuotaBufferSize) ||
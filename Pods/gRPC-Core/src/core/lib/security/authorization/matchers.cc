@@ -18,6 +18,8 @@
 #include <grpc/support/port_platform.h>
 #include <string.h>
 
+#include <map>
+#include <set>
 #include <string>
 
 #include "absl/log/log.h"
@@ -29,6 +31,94 @@
 
 namespace grpc_core {
 
+namespace {
+
+// Or matchers that have at least this many safe regexes on the same header use
+// an RE2::Set for them.
+constexpr size_t kMinRegexesForSet = 4;
+
+const StringMatcher* PathMatcherOf(const Rbac::Permission& permission) {
+  return &permission.string_matcher;
+}
+
+const StringMatcher* PathMatcherOf(const Rbac::Principal& principal) {
+  return principal.string_matcher.has_value() ? &*principal.string_matcher
+                                              : nullptr;
+}
+
+// Returns whether the rule matches the path or a header, which it then stores
+// in *header_name, by a safe regex alone.
+template <typename Rule>
+bool IsSafeRegexRule(const Rule& rule,
+                     absl::optional<std::string>* header_name) {
+  if (rule.type == Rule::RuleType::kPath) {
+    const StringMatcher* matcher = PathMatcherOf(rule);
+    if (matcher == nullptr ||
+        matcher->type() != StringMatcher::Type::kSafeRegex) {
+      return false;
+    }
+    header_name->reset();
+    return true;
+  }
+  if (rule.type == Rule::RuleType::kHeader &&
+      rule.header_matcher.type() == HeaderMatcher::Type::kSafeRegex &&
+      !rule.header_matcher.invert_match()) {
+    *header_name = rule.header_matcher.name();
+    return true;
+  }
+  return false;
+}
+
+template <typename Rule>
+StringMatcher TakeRegexMatcher(Rule* rule) {
+  if (rule->type == Rule::RuleType::kHeader) {
+    // The pattern compiled before, and its regex is shared rather than
+    // compiled again.
+    const std::string& pattern =
+        rule->header_matcher.regex_matcher()->pattern();
+    return StringMatcher::Create(StringMatcher::Type::kSafeRegex, pattern)
+        .value();
+  }
+  return std::move(*PathMatcherOf(*rule));
+}
+
+// Creates the matcher of an Or rule. Safe regexes on the same path or header
+// are grouped into a RegexSetAuthorizationMatcher when there are enough of
+// them, as the order in which the rules of an Or are evaluated does not
+// matter.
+template <typename Rule>
+std::unique_ptr<AuthorizationMatcher> CreateOrMatcher(
+    std::vector<std::unique_ptr<Rule>> rules) {
+  std::map<absl::optional<std::string>, std::vector<Rule*>> regex_rules;
+  for (auto& rule : rules) {
+    absl::optional<std::string> header_name;
+    if (IsSafeRegexRule(*rule, &header_name)) {
+      regex_rules[std::move(header_name)].push_back(rule.get());
+    }
+  }
+  std::vector<std::unique_ptr<AuthorizationMatcher>> matchers;
+  std::set<const Rule*> grouped;
+  for (auto& header_and_rules : regex_rules) {
+    if (header_and_rules.second.size() < kMinRegexesForSet) continue;
+    std::vector<StringMatcher> regexes;
+    regexes.reserve(header_and_rules.second.size());
+    for (Rule* rule : header_and_rules.second) {
+      regexes.push_back(TakeRegexMatcher(rule));
+      grouped.insert(rule);
+    }
+    matchers.push_back(std::make_unique<RegexSetAuthorizationMatcher>(
+        header_and_rules.first, std::move(regexes)));
+  }
+  for (auto& rule : rules) {
+    if (grouped.count(rule.get()) == 0) {
+      matchers.push_back(AuthorizationMatcher::Create(std::move(*rule)));
+    }
+  }
+  return std::make_unique<OrAuthorizationMatcher>(std::move(matchers));
+}
+
+}  // namespace
+
 std::unique_ptr<AuthorizationMatcher> AuthorizationMatcher::Create(
     Rbac::Permission permission) {
   switch (permission.type) {
@@ -40,14 +130,8 @@ std::unique_ptr<AuthorizationMatcher> AuthorizationMatcher::Create(
       }
       return std::make_unique<AndAuthorizationMatcher>(std::move(matchers));
     }
-    case Rbac::Permission::RuleType::kOr: {
-      std::vector<std::unique_ptr<AuthorizationMatcher>> matchers;
-      matchers.reserve(permission.permissions.size());
-      for (const auto& rule : permission.permissions) {
-        matchers.push_back(AuthorizationMatcher::Create(std::move(*rule)));
-      }
-      return std::make_unique<OrAuthorizationMatcher>(std::move(matchers));
-    }
+    case Rbac::Permission::RuleType::kOr:
+      return CreateOrMatcher(std::move(permission.permissions));
     case Rbac::Permission::RuleType::kNot:
       return std::make_unique<NotAuthorizationMatcher>(
           AuthorizationMatcher::Create(std::move(*permission.permissions[0])));
@@ -84,14 +168,8 @@ std::unique_ptr<AuthorizationMatcher> AuthorizationMatcher::Create(
       }
       return std::make_unique<AndAuthorizationMatcher>(std::move(matchers));
     }
-    case Rbac::Principal::RuleType::kOr: {
-      std::vector<std::unique_ptr<AuthorizationMatcher>> matchers;
-      matchers.reserve(principal.principals.size());
-      for (const auto& id : principal.principals) {
-        matchers.push_back(AuthorizationMatcher::Create(std::move(*id)));
-      }
-      return std::make_unique<OrAuthorizationMatcher>(std::move(matchers));
-    }
+    case Rbac::Principal::RuleType::kOr:
+      return CreateOrMatcher(std::move(principal.principals));
     case Rbac::Principal::RuleType::kNot:
       return std::make_unique<NotAuthorizationMatcher>(
           AuthorizationMatcher::Create(std::move(*principal.principals[0])));
@@ -230,6 +308,46 @@ bool PathAuthorizationMatcher::Matches(const EvaluateArgs& args) const {
   return false;
 }
 
+RegexSetAuthorizationMatcher::RegexSetAuthorizationMatcher(
+    absl::optional<std::string> header_name,
+    std::vector<StringMatcher> matchers)
+    : header_name_(std::move(header_name)), matchers_(std::move(matchers)) {
+  // StringMatcher uses RE2::FullMatch(), so the set is anchored at both ends.
+  auto set = std::make_unique<RE2::Set>(RE2::DefaultOptions, RE2::ANCHOR_BOTH);
+  for (const StringMatcher& matcher : matchers_) {
+    if (set->Add(matcher.regex_matcher()->pattern(), nullptr) < 0) return;
+  }
+  if (set->Compile()) set_ = std::move(set);
+}
+
+bool RegexSetAuthorizationMatcher::Matches(const EvaluateArgs& args) const {
+  if (!header_name_.has_value()) {
+    absl::string_view path = args.GetPath();
+    return !path.empty() && MatchesValue(path);
+  }
+  std::string concatenated_value;
+  absl::optional<absl::string_view> value =
+      args.GetHeaderValue(*header_name_, &concatenated_value);
+  return value.has_value() && MatchesValue(*value);
+}
+
+bool RegexSetAuthorizationMatcher::MatchesValue(
+    absl::string_view value) const {
+  if (set_ != nullptr) {
+    RE2::Set::ErrorInfo error_info;
+    if (set_->Match(re2::StringPiece(value.data(), value.size()), nullptr,
+                    &error_info)) {
+      return true;
+    }
+    // A failed match is only final if the DFA did not run out of memory.
+    if (error_info.kind == RE2::Set::kNoError) return false;
+  }
+  for (const StringMatcher& matcher : matchers_) {
+    if (matcher.Match(value)) return true;
+  }
+  return false;
+}
+
 bool PolicyAuthorizationMatcher::Matches(const EvaluateArgs& args) const {
   return permissions_->Matches(args) && principals_->Matches(args);
 }
@@ -58,8 +58,8 @@ grpc_ssl_credentials::grpc_ssl_credentials(
       root_store_ = grpc_core::DefaultSslRootStore::GetRootStore();
     }
   } else {
-    config_.pem_root_certs = config_.pem_root_certs;
-    root_store_ = nullptr;
+    root_store_ =
+        grpc_core::SslRootStoreCache::GetRootStore(config_.pem_root_certs);
   }
 
   client_handshaker_initialization_status_ = InitializeClientHandshakerFactory(
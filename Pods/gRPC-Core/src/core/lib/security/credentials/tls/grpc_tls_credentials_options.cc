@@ -159,3 +159,16 @@ void grpc_tls_credentials_options_set_max_tls_version(
   CHECK_NE(options, nullptr);
   options->set_max_tls_version(max_tls_version);
 }
+
+void grpc_tls_credentials_options_set_prefer_hardware_ciphers(
+    grpc_tls_credentials_options* options, int prefer_hardware_ciphers) {
+  CHECK_NE(options, nullptr);
+  options->set_prefer_hardware_ciphers(prefer_hardware_ciphers != 0);
+}
+
+void grpc_tls_credentials_options_set_key_exchange_groups(
+    grpc_tls_credentials_options* options, const char* key_exchange_groups) {
+  CHECK_NE(options, nullptr);
+  options->set_key_exchange_groups(
+      key_exchange_groups == nullptr ? "" : key_exchange_groups);
+}
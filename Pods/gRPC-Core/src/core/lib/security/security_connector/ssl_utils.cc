@@ -30,9 +30,11 @@
 #include <string.h>
 
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/strings/match.h"
@@ -47,7 +49,9 @@
 #include "src/core/tsi/transport_security.h"
 #include "src/core/util/host_port.h"
 #include "src/core/util/load_file.h"
+#include "src/core/util/no_destruct.h"
 #include "src/core/util/ref_counted_ptr.h"
+#include "src/core/util/sync.h"
 #include "src/core/util/useful.h"
 
 // -- Constants. --
@@ -415,7 +419,8 @@ grpc_security_status grpc_ssl_tsi_client_handshaker_factory_init(
     tsi::TlsSessionKeyLoggerCache::TlsSessionKeyLogger* tls_session_key_logger,
     const char* crl_directory,
     std::shared_ptr<grpc_core::experimental::CrlProvider> crl_provider,
-    tsi_ssl_client_handshaker_factory** handshaker_factory) {
+    tsi_ssl_client_handshaker_factory** handshaker_factory,
+    bool prefer_hardware_ciphers, const char* key_exchange_groups) {
   const char* root_certs;
   const tsi_ssl_root_certs_store* root_store;
   if (pem_root_certs == nullptr && !skip_server_certificate_verification) {
@@ -431,7 +436,13 @@ grpc_security_status grpc_ssl_tsi_client_handshaker_factory_init(
     root_store = grpc_core::DefaultSslRootStore::GetRootStore();
   } else {
     root_certs = pem_root_certs;
-    root_store = nullptr;
+    // Loading a CRL directory modifies the store, so it cannot be shared.
+    bool has_crl_directory =
+        crl_directory != nullptr && crl_directory[0] != '\0';
+    root_store =
+        pem_root_certs != nullptr && !has_crl_directory
+            ? grpc_core::SslRootStoreCache::GetRootStore(pem_root_certs)
+            : nullptr;
   }
   bool has_key_cert_pair = pem_key_cert_pair != nullptr &&
                            pem_key_cert_pair->private_key != nullptr &&
@@ -453,6 +464,8 @@ grpc_security_status grpc_ssl_tsi_client_handshaker_factory_init(
   options.max_tls_version = max_tls_version;
   options.crl_directory = crl_directory;
   options.crl_provider = std::move(crl_provider);
+  options.prefer_hardware_ciphers = prefer_hardware_ciphers;
+  options.key_exchange_groups = key_exchange_groups;
   const tsi_result result =
       tsi_create_ssl_client_handshaker_factory_with_options(&options,
                                                             handshaker_factory);
@@ -473,7 +486,8 @@ grpc_security_status grpc_ssl_tsi_server_handshaker_factory_init(
     tsi::TlsSessionKeyLoggerCache::TlsSessionKeyLogger* tls_session_key_logger,
     const char* crl_directory, bool send_client_ca_list,
     std::shared_ptr<grpc_core::experimental::CrlProvider> crl_provider,
-    tsi_ssl_server_handshaker_factory** handshaker_factory) {
+    tsi_ssl_server_handshaker_factory** handshaker_factory,
+    bool prefer_hardware_ciphers, const char* key_exchange_groups) {
   size_t num_alpn_protocols = 0;
   const char** alpn_protocol_strings =
       grpc_fill_alpn_protocol_strings(&num_alpn_protocols);
@@ -492,6 +506,8 @@ grpc_security_status grpc_ssl_tsi_server_handshaker_factory_init(
   options.crl_directory = crl_directory;
   options.crl_provider = std::move(crl_provider);
   options.send_client_ca_list = send_client_ca_list;
+  options.prefer_hardware_ciphers = prefer_hardware_ciphers;
+  options.key_exchange_groups = key_exchange_groups;
   const tsi_result result =
       tsi_create_ssl_server_handshaker_factory_with_options(&options,
                                                             handshaker_factory);
@@ -511,6 +527,13 @@ grpc_ssl_session_cache* grpc_ssl_session_cache_create_lru(size_t capacity) {
   return reinterpret_cast<grpc_ssl_session_cache*>(cache);
 }
 
+grpc_ssl_session_cache* grpc_ssl_session_cache_create_lru_with_store(
+    size_t capacity, grpc_ssl_session_store store) {
+  tsi_ssl_session_cache* cache =
+      tsi_ssl_session_cache_create_lru_with_store(capacity, store);
+  return reinterpret_cast<grpc_ssl_session_cache*>(cache);
+}
+
 void grpc_ssl_session_cache_destroy(grpc_ssl_session_cache* cache) {
   tsi_ssl_session_cache* tsi_cache =
       reinterpret_cast<tsi_ssl_session_cache*>(cache);
@@ -625,4 +648,26 @@ void DefaultSslRootStore::InitRootStoreOnce() {
   }
 }
 
+// --- SSL root store cache implementation. ---
+
+const tsi_ssl_root_certs_store* SslRootStoreCache::GetRootStore(
+    absl::string_view pem_root_certs) {
+  // A process normally uses one or two root bundles. The limit only guards
+  // against unbounded growth when roots are generated at runtime.
+  static constexpr size_t kMaxEntries = 16;
+  static NoDestruct<Mutex> mu;
+  static NoDestruct<absl::flat_hash_map<std::string, tsi_ssl_root_certs_store*>>
+      stores;
+  MutexLock lock(mu.get());
+  auto it = stores->find(pem_root_certs);
+  if (it != stores->end()) return it->second;
+  if (stores->size() >= kMaxEntries) return nullptr;
+  std::string pem(pem_root_certs);
+  tsi_ssl_root_certs_store* store =
+      tsi_ssl_root_certs_store_create(pem.c_str());
+  if (store == nullptr) return nullptr;
+  stores->emplace(std::move(pem), store);
+  return store;
+}
+
 }  // namespace grpc_core
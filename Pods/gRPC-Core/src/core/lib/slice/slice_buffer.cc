@@ -83,6 +83,16 @@ Slice SliceBuffer::JoinIntoSlice() const {
   return Slice(slice);
 }
 
+absl::string_view SliceBuffer::ContiguousView() {
+  if (slice_buffer_.count == 0) return absl::string_view();
+  if (slice_buffer_.count > 1) {
+    Slice joined = JoinIntoSlice();
+    Clear();
+    Append(std::move(joined));
+  }
+  return StringViewFromSlice(slice_buffer_.slices[0]);
+}
+
 }  // namespace grpc_core
 
 // grow a buffer; requires GRPC_SLICE_BUFFER_INLINE_ELEMENTS > 1
@@ -238,6 +248,105 @@ void grpc_slice_buffer_add(grpc_slice_buffer* sb, grpc_slice s) {
   grpc_slice_buffer_add_indexed(sb, s);
 }
 
+namespace {
+
+// Slices shorter than this are copied by grpc_slice_buffer_add_coalesced().
+constexpr size_t kCoalesceMaxSliceSize = 512;
+constexpr size_t kCoalesceBlockSize = 4096;
+// Free blocks kept by each thread.
+constexpr size_t kMaxPooledBlocks = 16;
+
+// The refcount and storage of a coalescing block. used is the end of the
+// bytes handed out so far: only the slice buffer holding the sole reference
+// may write beyond it.
+struct CoalescingBlock : public grpc_slice_refcount {
+  CoalescingBlock();
+  size_t used = 0;
+  CoalescingBlock* next_free = nullptr;
+  uint8_t data[kCoalesceBlockSize];
+};
+
+// Per-thread free list. Blocks go back to the list of whichever thread drops
+// their last reference. Trivially destructible, so that blocks released
+// while the thread's other thread_locals are destroyed are still handled.
+thread_local CoalescingBlock* g_free_blocks = nullptr;
+thread_local size_t g_num_free_blocks = 0;
+thread_local bool g_block_pool_closed = false;
+
+struct BlockPoolCloser {
+  ~BlockPoolCloser() {
+    g_block_pool_closed = true;
+    while (g_free_blocks != nullptr) {
+      gpr_free(std::exchange(g_free_blocks, g_free_blocks->next_free));
+    }
+    g_num_free_blocks = 0;
+  }
+};
+thread_local BlockPoolCloser g_block_pool_closer;
+
+void DestroyCoalescingBlock(grpc_slice_refcount* refcount) {
+  auto* block = static_cast<CoalescingBlock*>(refcount);
+  block->~CoalescingBlock();
+  if (g_block_pool_closed || g_num_free_blocks == kMaxPooledBlocks) {
+    gpr_free(block);
+    return;
+  }
+  block->next_free = std::exchange(g_free_blocks, block);
+  ++g_num_free_blocks;
+}
+
+CoalescingBlock::CoalescingBlock()
+    : grpc_slice_refcount(DestroyCoalescingBlock) {}
+
+CoalescingBlock* NewCoalescingBlock() {
+  (void)&g_block_pool_closer;  // Registers the closer for this thread.
+  void* memory;
+  if (g_free_blocks != nullptr) {
+    memory = std::exchange(g_free_blocks, g_free_blocks->next_free);
+    --g_num_free_blocks;
+  } else {
+    memory = gpr_malloc(sizeof(CoalescingBlock));
+  }
+  return new (memory) CoalescingBlock();
+}
+
+}  // namespace
+
+void grpc_slice_buffer_add_coalesced(grpc_slice_buffer* sb, grpc_slice s) {
+  const size_t length = GRPC_SLICE_LENGTH(s);
+  if (s.refcount == nullptr || length == 0 ||
+      length >= kCoalesceMaxSliceSize) {
+    grpc_slice_buffer_add(sb, s);
+    return;
+  }
+  if (sb->count != 0) {
+    grpc_slice* back = &sb->slices[sb->count - 1];
+    if (back->refcount != nullptr &&
+        back->refcount->HasDestroyer(DestroyCoalescingBlock) &&
+        back->refcount->IsUnique()) {
+      auto* block = static_cast<CoalescingBlock*>(back->refcount);
+      if (GRPC_SLICE_END_PTR(*back) == block->data + block->used &&
+          block->used + length <= kCoalesceBlockSize) {
+        memcpy(block->data + block->used, GRPC_SLICE_START_PTR(s), length);
+        block->used += length;
+        back->data.refcounted.length += length;
+        sb->length += length;
+        grpc_core::CSliceUnref(s);
+        return;
+      }
+    }
+  }
+  CoalescingBlock* block = NewCoalescingBlock();
+  memcpy(block->data, GRPC_SLICE_START_PTR(s), length);
+  block->used = length;
+  grpc_slice copy;
+  copy.refcount = block;
+  copy.data.refcounted.bytes = block->data;
+  copy.data.refcounted.length = length;
+  grpc_core::CSliceUnref(s);
+  grpc_slice_buffer_add_indexed(sb, copy);
+}
+
 void grpc_slice_buffer_addn(grpc_slice_buffer* sb, grpc_slice* s, size_t n) {
   size_t i;
   for (i = 0; i < n; i++) {
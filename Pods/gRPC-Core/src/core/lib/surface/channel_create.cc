@@ -20,7 +20,10 @@
 #include <grpc/impl/channel_arg_names.h>
 #include <grpc/support/port_platform.h>
 
+#include <vector>
+
 #include "absl/log/check.h"
+#include "absl/strings/str_split.h"
 #include "src/core/channelz/channelz.h"
 #include "src/core/client_channel/client_channel.h"
 #include "src/core/client_channel/direct_channel.h"
@@ -31,6 +34,7 @@
 #include "src/core/lib/surface/channel_stack_type.h"
 #include "src/core/lib/surface/lame_client.h"
 #include "src/core/lib/surface/legacy_channel.h"
+#include "src/core/lib/transport/metadata_batch.h"
 #include "src/core/telemetry/stats.h"
 #include "src/core/telemetry/stats_data.h"
 
@@ -56,6 +60,13 @@ absl::StatusOr<RefCountedPtr<Channel>> ChannelCreate(
                       std::string(ssl_override.value()));
     }
   }
+  // Intern the keys of application metadata before any call is made.
+  auto interned_keys = args.GetString(GRPC_ARG_INTERNED_METADATA_KEYS);
+  if (interned_keys.has_value()) {
+    std::vector<absl::string_view> keys =
+        absl::StrSplit(*interned_keys, ',', absl::SkipWhitespace());
+    InternMetadataKeys(keys);
+  }
   // Check whether channelz is enabled.
   if (args.GetBool(GRPC_ARG_ENABLE_CHANNELZ)
           .value_or(GRPC_ENABLE_CHANNELZ_DEFAULT)) {
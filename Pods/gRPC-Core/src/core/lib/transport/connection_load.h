@@ -0,0 +1,70 @@
+// Copyright 2024 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GRPC_SRC_CORE_LIB_TRANSPORT_CONNECTION_LOAD_H
+#define GRPC_SRC_CORE_LIB_TRANSPORT_CONNECTION_LOAD_H
+
+#include <grpc/support/port_platform.h>
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+#include "absl/strings/string_view.h"
+#include "src/core/util/ref_counted.h"
+#include "src/core/util/useful.h"
+
+namespace grpc_core {
+
+// The calls a client connection carries, against the number of concurrent
+// streams its peer allows.  A subchannel that opens more than one connection
+// to its address passes one to the transport of each connection in the
+// channel args, and the transport updates the limit each time the peer's
+// SETTINGS change it.  Calls beyond the limit wait in the transport for a
+// stream to free up, so a saturated connection is one that makes new calls
+// wait.
+class ConnectionLoad final : public RefCounted<ConnectionLoad> {
+ public:
+  static absl::string_view ChannelArgName() {
+    return "grpc.internal.connection_load";
+  }
+  static int ChannelArgsCompare(const ConnectionLoad* a,
+                                const ConnectionLoad* b) {
+    return QsortCompare(a, b);
+  }
+
+  void SetMaxConcurrentStreams(uint32_t max_concurrent_streams) {
+    max_concurrent_streams_.store(max_concurrent_streams,
+                                  std::memory_order_relaxed);
+  }
+
+  void AddCall() { calls_.fetch_add(1, std::memory_order_relaxed); }
+  void RemoveCall() { calls_.fetch_sub(1, std::memory_order_relaxed); }
+
+  uint32_t calls() const { return calls_.load(std::memory_order_relaxed); }
+
+  bool saturated() const {
+    return calls() >= max_concurrent_streams_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<uint32_t> calls_{0};
+  // Until the peer's first SETTINGS, there is no limit.
+  std::atomic<uint32_t> max_concurrent_streams_{
+      std::numeric_limits<uint32_t>::max()};
+};
+
+}  // namespace grpc_core
+
+#endif  // GRPC_SRC_CORE_LIB_TRANSPORT_CONNECTION_LOAD_H
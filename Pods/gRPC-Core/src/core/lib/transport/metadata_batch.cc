@@ -18,6 +18,8 @@
 #include <string.h>
 
 #include <algorithm>
+#include <atomic>
+#include <memory>
 #include <string>
 
 #include "absl/base/no_destructor.h"
@@ -27,6 +29,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "src/core/lib/transport/timeout_encoding.h"
+#include "src/core/util/sync.h"
 
 namespace grpc_core {
 namespace metadata_detail {
@@ -102,8 +105,27 @@ bool DebugStringBuilder::IsAllowListed(const absl::string_view key) const {
   return allow_list->contains(key);
 }
 
+namespace {
+
+// Registration replaces the whole set, so that lookups need no lock. Sets
+// that have been replaced are leaked, as a lookup may still be reading them;
+// a set is only replaced when new keys are added, so there are few.
+std::atomic<const absl::flat_hash_set<absl::string_view>*> g_interned_keys{
+    nullptr};
+
+}  // namespace
+
+Slice InternedKeyOrCopy(absl::string_view key) {
+  const auto* interned = g_interned_keys.load(std::memory_order_acquire);
+  if (interned != nullptr) {
+    auto it = interned->find(key);
+    if (it != interned->end()) return Slice::FromStaticString(*it);
+  }
+  return Slice::FromCopiedString(key);
+}
+
 void UnknownMap::Append(absl::string_view key, Slice value) {
-  unknown_.emplace_back(Slice::FromCopiedString(key), value.Ref());
+  unknown_.emplace_back(InternedKeyOrCopy(key), value.Ref());
 }
 
 void UnknownMap::Remove(absl::string_view key) {
@@ -131,6 +153,27 @@ absl::optional<absl::string_view> UnknownMap::GetStringValue(
 
 }  // namespace metadata_detail
 
+void InternMetadataKeys(absl::Span<const absl::string_view> keys) {
+  static absl::NoDestructor<Mutex> mu;
+  MutexLock lock(mu.get());
+  const auto* current =
+      metadata_detail::g_interned_keys.load(std::memory_order_relaxed);
+  auto next = current == nullptr
+                  ? std::make_unique<absl::flat_hash_set<absl::string_view>>()
+                  : std::make_unique<absl::flat_hash_set<absl::string_view>>(
+                        *current);
+  bool added = false;
+  for (absl::string_view key : keys) {
+    if (key.empty() || next->contains(key)) continue;
+    // Slices of interned keys point into this copy, so it is never freed.
+    next->insert(*new std::string(key));
+    added = true;
+  }
+  if (!added) return;
+  metadata_detail::g_interned_keys.store(next.release(),
+                                         std::memory_order_release);
+}
+
 ContentTypeMetadata::MementoType ContentTypeMetadata::ParseMemento(
     Slice value, bool, MetadataParseErrorFn /*on_error*/) {
   auto out = kInvalid;
@@ -22,6 +22,7 @@
 #include <map>
 
 #include "absl/strings/string_view.h"
+#include "src/core/util/upb_utils.h"
 #include "upb/base/string_view.h"
 #include "upb/mem/arena.hpp"
 #include "upb/message/map.h"
@@ -57,7 +58,7 @@ std::map<absl::string_view, double> ParseMap(
 const BackendMetricData* ParseBackendMetricData(
     absl::string_view serialized_load_report,
     BackendMetricAllocatorInterface* allocator) {
-  upb::Arena upb_arena;
+  UpbParseArena upb_arena;
   xds_data_orca_v3_OrcaLoadReport* msg = xds_data_orca_v3_OrcaLoadReport_parse(
       serialized_load_report.data(), serialized_load_report.size(),
       upb_arena.ptr());
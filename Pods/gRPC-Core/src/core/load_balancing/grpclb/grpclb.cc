@@ -138,6 +138,7 @@
 #include "src/core/util/status_helper.h"
 #include "src/core/util/string.h"
 #include "src/core/util/time.h"
+#include "src/core/util/upb_utils.h"
 #include "src/core/util/useful.h"
 #include "src/core/util/validation_errors.h"
 #include "src/core/util/work_serializer.h"
@@ -1153,7 +1154,7 @@ void GrpcLb::BalancerCallState::OnBalancerMessageReceivedLocked() {
   grpc_byte_buffer_destroy(recv_message_payload_);
   recv_message_payload_ = nullptr;
   GrpcLbResponse response;
-  upb::Arena arena;
+  UpbParseArena arena;
   if (!GrpcLbResponseParse(response_slice, arena.ptr(), &response) ||
       (response.type == response.INITIAL && seen_initial_response_)) {
     if (absl::MinLogLevel() <= absl::LogSeverityAtLeast::kError) {
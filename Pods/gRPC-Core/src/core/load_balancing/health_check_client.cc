@@ -56,6 +56,7 @@
 #include "src/core/util/orphanable.h"
 #include "src/core/util/ref_counted_ptr.h"
 #include "src/core/util/sync.h"
+#include "src/core/util/upb_utils.h"
 #include "src/core/util/work_serializer.h"
 #include "src/proto/grpc/health/v1/health.upb.h"
 #include "upb/base/string_view.h"
@@ -265,7 +266,7 @@ class HealthProducer::HealthChecker::HealthStreamEventHandler final
   static absl::StatusOr<bool> DecodeResponse(
       absl::string_view serialized_message) {
     // Deserialize message.
-    upb::Arena arena;
+    UpbParseArena arena;
     auto* response = grpc_health_v1_HealthCheckResponse_parse(
         serialized_message.data(), serialized_message.size(), arena.ptr());
     if (response == nullptr) {
@@ -0,0 +1,640 @@
+//
+// Copyright 2024 The gRPC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// A client-side least-latency policy. Each endpoint keeps a "peak EWMA" of
+// the latency of its calls: the average jumps straight to any call slower
+// than it and otherwise decays towards recent latencies. Its cost is that
+// latency times the number of calls outstanding on it, so that a backend
+// that slows down or queues work is avoided before its latency shows in
+// the average. Picks compare the cost of two random READY endpoints and
+// take the cheaper one ("power of two choices"), which avoids the herding
+// onto a single endpoint that picking the global minimum would cause.
+
+#include <grpc/impl/connectivity_state.h>
+#include <grpc/support/port_platform.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/random/random.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "absl/types/variant.h"
+#include "src/core/config/core_configuration.h"
+#include "src/core/lib/channel/channel_args.h"
+#include "src/core/lib/debug/trace.h"
+#include "src/core/lib/transport/connectivity_state.h"
+#include "src/core/load_balancing/endpoint_list.h"
+#include "src/core/load_balancing/lb_policy.h"
+#include "src/core/load_balancing/lb_policy_factory.h"
+#include "src/core/resolver/endpoint_addresses.h"
+#include "src/core/util/debug_location.h"
+#include "src/core/util/json/json.h"
+#include "src/core/util/json/json_args.h"
+#include "src/core/util/json/json_object_loader.h"
+#include "src/core/util/orphanable.h"
+#include "src/core/util/ref_counted.h"
+#include "src/core/util/ref_counted_ptr.h"
+#include "src/core/util/sync.h"
+#include "src/core/util/time.h"
+#include "src/core/util/validation_errors.h"
+#include "src/core/util/work_serializer.h"
+
+namespace grpc_core {
+
+namespace {
+
+constexpr absl::string_view kPeakEwma = "peak_ewma";
+
+// Cost of an endpoint that has calls outstanding but has not completed one
+// yet. It is large enough that such an endpoint is only picked over one that
+// has reported latencies when the latter is badly overloaded, so that a new
+// backend gets a first call rather than a burst of them.
+constexpr double kUnknownLatencyPenaltyMillis = 1e6;
+
+// Config for peak EWMA policy.
+class PeakEwmaConfig final : public LoadBalancingPolicy::Config {
+ public:
+  PeakEwmaConfig() = default;
+
+  PeakEwmaConfig(const PeakEwmaConfig&) = delete;
+  PeakEwmaConfig& operator=(const PeakEwmaConfig&) = delete;
+
+  PeakEwmaConfig(PeakEwmaConfig&&) = delete;
+  PeakEwmaConfig& operator=(PeakEwmaConfig&&) = delete;
+
+  absl::string_view name() const override { return kPeakEwma; }
+
+  // How quickly old latencies stop counting: an observation loses 1/e of its
+  // weight in the average over this period.
+  Duration decay_time() const { return decay_time_; }
+
+  static const JsonLoaderInterface* JsonLoader(const JsonArgs&) {
+    static const auto* loader =
+        JsonObjectLoader<PeakEwmaConfig>()
+            .OptionalField("decayTime", &PeakEwmaConfig::decay_time_)
+            .Finish();
+    return loader;
+  }
+
+  void JsonPostLoad(const Json&, const JsonArgs&, ValidationErrors* errors) {
+    if (decay_time_ <= Duration::Zero()) {
+      ValidationErrors::ScopedField field(errors, ".decayTime");
+      errors->AddError("must be positive");
+    }
+  }
+
+ private:
+  Duration decay_time_ = Duration::Seconds(10);
+};
+
+// Latency and load of one endpoint, shared by the endpoint, the pickers
+// that include it and the trackers of calls in flight on it.
+class EndpointLoad final : public RefCounted<EndpointLoad> {
+ public:
+  explicit EndpointLoad(Duration decay_time) : decay_time_(decay_time) {}
+
+  void OnCallStarted() { outstanding_.fetch_add(1, std::memory_order_relaxed); }
+
+  // Records a completed call that took latency. A call that failed records
+  // twice the current average if that is slower, so that a backend that
+  // fails fast does not look fast.
+  void OnCallFinished(Duration latency, bool failed);
+
+  // Records a call that ended without telling anything about the backend.
+  void OnCallCancelled() {
+    outstanding_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  // Returns the endpoint's cost for a new call. Lower is better.
+  double Cost();
+
+ private:
+  // Weight that an average last updated at last_update_ keeps at now.
+  double DecayLocked(Timestamp now) ABSL_EXCLUSIVE_LOCKS_REQUIRED(&mu_) {
+    const double elapsed = std::max<double>(0, (now - last_update_).millis());
+    return std::exp(-elapsed / decay_time_.millis());
+  }
+
+  const Duration decay_time_;
+  std::atomic<int64_t> outstanding_{0};
+  Mutex mu_;
+  // Zero until the first call completes.
+  double ewma_millis_ ABSL_GUARDED_BY(&mu_) = 0;
+  Timestamp last_update_ ABSL_GUARDED_BY(&mu_);
+};
+
+void EndpointLoad::OnCallFinished(Duration latency, bool failed) {
+  outstanding_.fetch_sub(1, std::memory_order_relaxed);
+  double millis = std::max<double>(latency.millis(), 1);
+  const Timestamp now = Timestamp::Now();
+  MutexLock lock(&mu_);
+  if (failed) millis = std::max(millis, ewma_millis_ * 2);
+  if (millis > ewma_millis_) {
+    ewma_millis_ = millis;
+  } else {
+    const double weight = DecayLocked(now);
+    ewma_millis_ = ewma_millis_ * weight + millis * (1 - weight);
+  }
+  last_update_ = now;
+}
+
+double EndpointLoad::Cost() {
+  const int64_t outstanding = outstanding_.load(std::memory_order_relaxed);
+  double ewma_millis;
+  {
+    MutexLock lock(&mu_);
+    if (ewma_millis_ == 0) {
+      return outstanding > 0 ? kUnknownLatencyPenaltyMillis + outstanding : 0;
+    }
+    // Decay towards zero while the endpoint gets no completions, so that
+    // one that was slow is eventually tried again.
+    ewma_millis = ewma_millis_ * DecayLocked(Timestamp::Now());
+  }
+  return ewma_millis * (outstanding + 1);
+}
+
+class PeakEwma final : public LoadBalancingPolicy {
+ public:
+  explicit PeakEwma(Args args);
+
+  absl::string_view name() const override { return kPeakEwma; }
+
+  absl::Status UpdateLocked(UpdateArgs args) override;
+  void ResetBackoffLocked() override;
+
+ private:
+  class PeakEwmaEndpointList final : public EndpointList {
+   public:
+    PeakEwmaEndpointList(RefCountedPtr<PeakEwma> peak_ewma,
+                         EndpointAddressesIterator* endpoints,
+                         const ChannelArgs& args,
+                         std::vector<std::string>* errors)
+        : EndpointList(std::move(peak_ewma),
+                       GRPC_TRACE_FLAG_ENABLED(peak_ewma_lb)
+                           ? "PeakEwmaEndpointList"
+                           : nullptr) {
+      Init(endpoints, args,
+           [&](RefCountedPtr<EndpointList> endpoint_list,
+               const EndpointAddresses& addresses, const ChannelArgs& args) {
+             return MakeOrphanable<PeakEwmaEndpoint>(
+                 std::move(endpoint_list), addresses, args,
+                 policy<PeakEwma>()->work_serializer(), errors);
+           });
+    }
+
+    class PeakEwmaEndpoint final : public Endpoint {
+     public:
+      PeakEwmaEndpoint(RefCountedPtr<EndpointList> endpoint_list,
+                       const EndpointAddresses& addresses,
+                       const ChannelArgs& args,
+                       std::shared_ptr<WorkSerializer> work_serializer,
+                       std::vector<std::string>* errors)
+          : Endpoint(std::move(endpoint_list)),
+            load_(MakeRefCounted<EndpointLoad>(
+                policy<PeakEwma>()->config_->decay_time())) {
+        absl::Status status = Init(addresses, args, std::move(work_serializer));
+        if (!status.ok()) {
+          errors->emplace_back(absl::StrCat("endpoint ", addresses.ToString(),
+                                            ": ", status.ToString()));
+        }
+      }
+
+      RefCountedPtr<EndpointLoad> load() const { return load_; }
+
+     private:
+      // Called when the child policy reports a connectivity state update.
+      void OnStateUpdate(absl::optional<grpc_connectivity_state> old_state,
+                         grpc_connectivity_state new_state,
+                         const absl::Status& status) override;
+
+      RefCountedPtr<EndpointLoad> load_;
+    };
+
+   private:
+    LoadBalancingPolicy::ChannelControlHelper* channel_control_helper()
+        const override {
+      return policy<PeakEwma>()->channel_control_helper();
+    }
+
+    // Updates the counters of children in each state when a
+    // child transitions from old_state to new_state.
+    void UpdateStateCountersLocked(
+        absl::optional<grpc_connectivity_state> old_state,
+        grpc_connectivity_state new_state);
+
+    // Ensures that the right child list is used and then updates
+    // the policy's connectivity state based on the child list's
+    // state counters.
+    void MaybeUpdatePeakEwmaConnectivityStateLocked(
+        absl::Status status_for_tf);
+
+    std::string CountersString() const {
+      return absl::StrCat("num_children=", size(), " num_ready=", num_ready_,
+                          " num_connecting=", num_connecting_,
+                          " num_transient_failure=", num_transient_failure_);
+    }
+
+    size_t num_ready_ = 0;
+    size_t num_connecting_ = 0;
+    size_t num_transient_failure_ = 0;
+
+    absl::Status last_failure_;
+  };
+
+  class Picker final : public SubchannelPicker {
+   public:
+    struct EndpointInfo {
+      RefCountedPtr<SubchannelPicker> picker;
+      RefCountedPtr<EndpointLoad> load;
+    };
+
+    Picker(PeakEwma* parent, std::vector<EndpointInfo> endpoints);
+
+    PickResult Pick(PickArgs args) override;
+
+   private:
+    // Tracks a call on the endpoint that was picked for it.
+    class SubchannelCallTracker final : public SubchannelCallTrackerInterface {
+     public:
+      SubchannelCallTracker(
+          RefCountedPtr<EndpointLoad> load,
+          std::unique_ptr<SubchannelCallTrackerInterface> child_tracker)
+          : load_(std::move(load)), child_tracker_(std::move(child_tracker)) {}
+
+      void Start() override;
+
+      void Finish(FinishArgs args) override;
+
+     private:
+      RefCountedPtr<EndpointLoad> load_;
+      std::unique_ptr<SubchannelCallTrackerInterface> child_tracker_;
+      Timestamp start_time_;
+    };
+
+    // Returns the index into endpoints_ to be picked.
+    size_t PickIndex();
+
+    // Using pointer value only, no ref held -- do not dereference!
+    PeakEwma* parent_;
+
+    std::vector<EndpointInfo> endpoints_;
+
+    Mutex bit_gen_mu_;
+    absl::BitGen bit_gen_ ABSL_GUARDED_BY(&bit_gen_mu_);
+  };
+
+  ~PeakEwma() override;
+
+  void ShutdownLocked() override;
+
+  RefCountedPtr<PeakEwmaConfig> config_;
+
+  // Current child list.
+  OrphanablePtr<PeakEwmaEndpointList> endpoint_list_;
+  // Latest pending child list.
+  // When we get an updated address list, we create a new child list
+  // for it here, and we wait to swap it into endpoint_list_ until the new
+  // list becomes READY.
+  OrphanablePtr<PeakEwmaEndpointList> latest_pending_endpoint_list_;
+
+  bool shutdown_ = false;
+};
+
+//
+// PeakEwma::Picker::SubchannelCallTracker
+//
+
+void PeakEwma::Picker::SubchannelCallTracker::Start() {
+  if (child_tracker_ != nullptr) child_tracker_->Start();
+  start_time_ = Timestamp::Now();
+  load_->OnCallStarted();
+}
+
+void PeakEwma::Picker::SubchannelCallTracker::Finish(FinishArgs args) {
+  if (child_tracker_ != nullptr) child_tracker_->Finish(args);
+  // A call the application cancelled says nothing about the backend.
+  if (absl::IsCancelled(args.status)) {
+    load_->OnCallCancelled();
+    return;
+  }
+  load_->OnCallFinished(Timestamp::Now() - start_time_, !args.status.ok());
+}
+
+//
+// PeakEwma::Picker
+//
+
+PeakEwma::Picker::Picker(PeakEwma* parent, std::vector<EndpointInfo> endpoints)
+    : parent_(parent), endpoints_(std::move(endpoints)) {
+  GRPC_TRACE_LOG(peak_ewma_lb, INFO)
+      << "[PEAK_EWMA " << parent_ << " picker " << this
+      << "] created picker from endpoint_list=" << parent_->endpoint_list_.get()
+      << " with " << endpoints_.size() << " READY children";
+}
+
+PeakEwma::PickResult PeakEwma::Picker::Pick(PickArgs args) {
+  size_t index = PickIndex();
+  auto& endpoint_info = endpoints_[index];
+  GRPC_TRACE_LOG(peak_ewma_lb, INFO)
+      << "[PEAK_EWMA " << parent_ << " picker " << this
+      << "] using picker index " << index
+      << ", picker=" << endpoint_info.picker.get();
+  auto result = endpoint_info.picker->Pick(args);
+  auto* complete = absl::get_if<PickResult::Complete>(&result.result);
+  if (complete != nullptr) {
+    complete->subchannel_call_tracker = std::make_unique<SubchannelCallTracker>(
+        endpoint_info.load, std::move(complete->subchannel_call_tracker));
+  }
+  return result;
+}
+
+size_t PeakEwma::Picker::PickIndex() {
+  if (endpoints_.size() == 1) return 0;
+  size_t first;
+  size_t second;
+  {
+    MutexLock lock(&bit_gen_mu_);
+    first = absl::Uniform<size_t>(bit_gen_, 0, endpoints_.size());
+    // Draw from the other endpoints, so that the two are always distinct.
+    second = absl::Uniform<size_t>(bit_gen_, 0, endpoints_.size() - 1);
+  }
+  if (second >= first) ++second;
+  return endpoints_[second].load->Cost() < endpoints_[first].load->Cost()
+             ? second
+             : first;
+}
+
+//
+// PeakEwma
+//
+
+PeakEwma::PeakEwma(Args args) : LoadBalancingPolicy(std::move(args)) {
+  GRPC_TRACE_LOG(peak_ewma_lb, INFO) << "[PEAK_EWMA " << this << "] Created";
+}
+
+PeakEwma::~PeakEwma() {
+  GRPC_TRACE_LOG(peak_ewma_lb, INFO)
+      << "[PEAK_EWMA " << this << "] Destroying peak EWMA policy";
+  CHECK(endpoint_list_ == nullptr);
+  CHECK(latest_pending_endpoint_list_ == nullptr);
+}
+
+void PeakEwma::ShutdownLocked() {
+  GRPC_TRACE_LOG(peak_ewma_lb, INFO)
+      << "[PEAK_EWMA " << this << "] Shutting down";
+  shutdown_ = true;
+  endpoint_list_.reset();
+  latest_pending_endpoint_list_.reset();
+}
+
+void PeakEwma::ResetBackoffLocked() {
+  endpoint_list_->ResetBackoffLocked();
+  if (latest_pending_endpoint_list_ != nullptr) {
+    latest_pending_endpoint_list_->ResetBackoffLocked();
+  }
+}
+
+absl::Status PeakEwma::UpdateLocked(UpdateArgs args) {
+  config_ = args.config.TakeAsSubclass<PeakEwmaConfig>();
+  EndpointAddressesIterator* addresses = nullptr;
+  if (args.addresses.ok()) {
+    GRPC_TRACE_LOG(peak_ewma_lb, INFO)
+        << "[PEAK_EWMA " << this << "] received update";
+    addresses = args.addresses->get();
+  } else {
+    GRPC_TRACE_LOG(peak_ewma_lb, INFO)
+        << "[PEAK_EWMA " << this
+        << "] received update with address error: " << args.addresses.status();
+    // If we already have a child list, then keep using the existing
+    // list, but still report back that the update was not accepted.
+    if (endpoint_list_ != nullptr) return args.addresses.status();
+  }
+  // Create new child list, replacing the previous pending list, if any.
+  if (GRPC_TRACE_FLAG_ENABLED(peak_ewma_lb) &&
+      latest_pending_endpoint_list_ != nullptr) {
+    LOG(INFO) << "[PEAK_EWMA " << this
+              << "] replacing previous pending child list "
+              << latest_pending_endpoint_list_.get();
+  }
+  std::vector<std::string> errors;
+  latest_pending_endpoint_list_ = MakeOrphanable<PeakEwmaEndpointList>(
+      RefAsSubclass<PeakEwma>(DEBUG_LOCATION, "PeakEwmaEndpointList"),
+      addresses, args.args, &errors);
+  // If the new list is empty, immediately promote it to
+  // endpoint_list_ and report TRANSIENT_FAILURE.
+  if (latest_pending_endpoint_list_->size() == 0) {
+    if (GRPC_TRACE_FLAG_ENABLED(peak_ewma_lb) && endpoint_list_ != nullptr) {
+      LOG(INFO) << "[PEAK_EWMA " << this << "] replacing previous child list "
+                << endpoint_list_.get();
+    }
+    endpoint_list_ = std::move(latest_pending_endpoint_list_);
+    absl::Status status =
+        args.addresses.ok() ? absl::UnavailableError(absl::StrCat(
+                                  "empty address list: ", args.resolution_note))
+                            : args.addresses.status();
+    channel_control_helper()->UpdateState(
+        GRPC_CHANNEL_TRANSIENT_FAILURE, status,
+        MakeRefCounted<TransientFailurePicker>(status));
+    return status;
+  }
+  // Otherwise, if this is the initial update, immediately promote it to
+  // endpoint_list_.
+  if (endpoint_list_ == nullptr) {
+    endpoint_list_ = std::move(latest_pending_endpoint_list_);
+  }
+  if (!errors.empty()) {
+    return absl::UnavailableError(absl::StrCat(
+        "errors from children: [", absl::StrJoin(errors, "; "), "]"));
+  }
+  return absl::OkStatus();
+}
+
+//
+// PeakEwma::PeakEwmaEndpointList::PeakEwmaEndpoint
+//
+
+void PeakEwma::PeakEwmaEndpointList::PeakEwmaEndpoint::OnStateUpdate(
+    absl::optional<grpc_connectivity_state> old_state,
+    grpc_connectivity_state new_state, const absl::Status& status) {
+  auto* ewma_endpoint_list = endpoint_list<PeakEwmaEndpointList>();
+  auto* peak_ewma = policy<PeakEwma>();
+  GRPC_TRACE_LOG(peak_ewma_lb, INFO)
+      << "[PEAK_EWMA " << peak_ewma << "] connectivity changed for child "
+      << this << ", endpoint_list " << ewma_endpoint_list << " (index "
+      << Index() << " of " << ewma_endpoint_list->size() << "): prev_state="
+      << (old_state.has_value() ? ConnectivityStateName(*old_state) : "N/A")
+      << " new_state=" << ConnectivityStateName(new_state) << " (" << status
+      << ")";
+  if (new_state == GRPC_CHANNEL_IDLE) {
+    GRPC_TRACE_LOG(peak_ewma_lb, INFO)
+        << "[PEAK_EWMA " << peak_ewma << "] child " << this
+        << " reported IDLE; requesting connection";
+    ExitIdleLocked();
+  }
+  // If state changed, update state counters.
+  if (!old_state.has_value() || *old_state != new_state) {
+    ewma_endpoint_list->UpdateStateCountersLocked(old_state, new_state);
+  }
+  // Update the policy state.
+  ewma_endpoint_list->MaybeUpdatePeakEwmaConnectivityStateLocked(status);
+}
+
+//
+// PeakEwma::PeakEwmaEndpointList
+//
+
+void PeakEwma::PeakEwmaEndpointList::UpdateStateCountersLocked(
+    absl::optional<grpc_connectivity_state> old_state,
+    grpc_connectivity_state new_state) {
+  // We treat IDLE the same as CONNECTING, since it will immediately
+  // transition into that state anyway.
+  if (old_state.has_value()) {
+    CHECK(*old_state != GRPC_CHANNEL_SHUTDOWN);
+    if (*old_state == GRPC_CHANNEL_READY) {
+      CHECK_GT(num_ready_, 0u);
+      --num_ready_;
+    } else if (*old_state == GRPC_CHANNEL_CONNECTING ||
+               *old_state == GRPC_CHANNEL_IDLE) {
+      CHECK_GT(num_connecting_, 0u);
+      --num_connecting_;
+    } else if (*old_state == GRPC_CHANNEL_TRANSIENT_FAILURE) {
+      CHECK_GT(num_transient_failure_, 0u);
+      --num_transient_failure_;
+    }
+  }
+  CHECK(new_state != GRPC_CHANNEL_SHUTDOWN);
+  if (new_state == GRPC_CHANNEL_READY) {
+    ++num_ready_;
+  } else if (new_state == GRPC_CHANNEL_CONNECTING ||
+             new_state == GRPC_CHANNEL_IDLE) {
+    ++num_connecting_;
+  } else if (new_state == GRPC_CHANNEL_TRANSIENT_FAILURE) {
+    ++num_transient_failure_;
+  }
+}
+
+void PeakEwma::PeakEwmaEndpointList::
+    MaybeUpdatePeakEwmaConnectivityStateLocked(absl::Status status_for_tf) {
+  auto* peak_ewma = policy<PeakEwma>();
+  // If this is latest_pending_endpoint_list_, then swap it into
+  // endpoint_list_ in the following cases:
+  // - endpoint_list_ has no READY children.
+  // - This list has at least one READY child and we have seen the
+  //   initial connectivity state notification for all children.
+  // - All of the children in this list are in TRANSIENT_FAILURE.
+  //   (This may cause the channel to go from READY to TRANSIENT_FAILURE,
+  //   but we're doing what the control plane told us to do.)
+  if (peak_ewma->latest_pending_endpoint_list_.get() == this &&
+      (peak_ewma->endpoint_list_->num_ready_ == 0 ||
+       (num_ready_ > 0 && AllEndpointsSeenInitialState()) ||
+       num_transient_failure_ == size())) {
+    if (GRPC_TRACE_FLAG_ENABLED(peak_ewma_lb)) {
+      LOG(INFO) << "[PEAK_EWMA " << peak_ewma << "] swapping out child list "
+                << peak_ewma->endpoint_list_.get() << " ("
+                << peak_ewma->endpoint_list_->CountersString()
+                << ") in favor of " << this << " (" << CountersString() << ")";
+    }
+    peak_ewma->endpoint_list_ =
+        std::move(peak_ewma->latest_pending_endpoint_list_);
+  }
+  // Only set connectivity state if this is the current child list.
+  if (peak_ewma->endpoint_list_.get() != this) return;
+  // First matching rule wins:
+  // 1) ANY child is READY => policy is READY.
+  // 2) ANY child is CONNECTING => policy is CONNECTING.
+  // 3) ALL children are TRANSIENT_FAILURE => policy is TRANSIENT_FAILURE.
+  if (num_ready_ > 0) {
+    GRPC_TRACE_LOG(peak_ewma_lb, INFO)
+        << "[PEAK_EWMA " << peak_ewma << "] reporting READY with child list "
+        << this;
+    std::vector<Picker::EndpointInfo> endpoints;
+    for (const auto& endpoint : this->endpoints()) {
+      auto state = endpoint->connectivity_state();
+      if (state.has_value() && *state == GRPC_CHANNEL_READY) {
+        endpoints.push_back(
+            {endpoint->picker(),
+             static_cast<PeakEwmaEndpoint*>(endpoint.get())->load()});
+      }
+    }
+    CHECK(!endpoints.empty());
+    peak_ewma->channel_control_helper()->UpdateState(
+        GRPC_CHANNEL_READY, absl::OkStatus(),
+        MakeRefCounted<Picker>(peak_ewma, std::move(endpoints)));
+  } else if (num_connecting_ > 0) {
+    GRPC_TRACE_LOG(peak_ewma_lb, INFO)
+        << "[PEAK_EWMA " << peak_ewma
+        << "] reporting CONNECTING with child list " << this;
+    peak_ewma->channel_control_helper()->UpdateState(
+        GRPC_CHANNEL_CONNECTING, absl::Status(),
+        MakeRefCounted<QueuePicker>(nullptr));
+  } else if (num_transient_failure_ == size()) {
+    GRPC_TRACE_LOG(peak_ewma_lb, INFO)
+        << "[PEAK_EWMA " << peak_ewma
+        << "] reporting TRANSIENT_FAILURE with child list " << this << ": "
+        << status_for_tf;
+    if (!status_for_tf.ok()) {
+      last_failure_ = absl::UnavailableError(
+          absl::StrCat("connections to all backends failing; last error: ",
+                       status_for_tf.message()));
+    }
+    peak_ewma->channel_control_helper()->UpdateState(
+        GRPC_CHANNEL_TRANSIENT_FAILURE, last_failure_,
+        MakeRefCounted<TransientFailurePicker>(last_failure_));
+  }
+}
+
+//
+// factory
+//
+
+class PeakEwmaFactory final : public LoadBalancingPolicyFactory {
+ public:
+  OrphanablePtr<LoadBalancingPolicy> CreateLoadBalancingPolicy(
+      LoadBalancingPolicy::Args args) const override {
+    return MakeOrphanable<PeakEwma>(std::move(args));
+  }
+
+  absl::string_view name() const override { return kPeakEwma; }
+
+  absl::StatusOr<RefCountedPtr<LoadBalancingPolicy::Config>>
+  ParseLoadBalancingConfig(const Json& json) const override {
+    return LoadFromJson<RefCountedPtr<PeakEwmaConfig>>(
+        json, JsonArgs(), "errors validating peak_ewma LB policy config");
+  }
+};
+
+}  // namespace
+
+void RegisterPeakEwmaLbPolicy(CoreConfiguration::Builder* builder) {
+  builder->lb_policy_registry()->RegisterLoadBalancingPolicyFactory(
+      std::make_unique<PeakEwmaFactory>());
+}
+
+}  // namespace grpc_core
@@ -23,6 +23,7 @@
 #include <inttypes.h>
 #include <string.h>
 
+#include <algorithm>
 #include <memory>
 #include <set>
 #include <string>
@@ -31,6 +32,7 @@
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/random/random.h"
@@ -204,6 +206,7 @@ class PickFirst final : public LoadBalancingPolicy {
       };
 
       SubchannelData(SubchannelList* subchannel_list, size_t index,
+                     const grpc_resolved_address& address,
                      RefCountedPtr<SubchannelInterface> subchannel);
 
       absl::optional<grpc_connectivity_state> connectivity_state() const {
@@ -236,12 +239,16 @@ class PickFirst final : public LoadBalancingPolicy {
       SubchannelList* subchannel_list_;
       // Our index within subchannel_list_.
       const size_t index_;
+      // The address the subchannel connects to.
+      const grpc_resolved_address address_;
       // Subchannel state.
       OrphanablePtr<SubchannelState> subchannel_state_;
       // Data updated by the watcher.
       absl::optional<grpc_connectivity_state> connectivity_state_;
       absl::Status connectivity_status_;
       bool seen_transient_failure_ = false;
+      // When the subchannel last went into CONNECTING.
+      absl::optional<Timestamp> connecting_since_;
     };
 
     SubchannelList(RefCountedPtr<PickFirst> policy,
@@ -365,6 +372,13 @@ class PickFirst final : public LoadBalancingPolicy {
 
   void GoIdle();
 
+  // Records how long a connection attempt to address took, or
+  // Duration::Infinity() if it failed.
+  void NoteConnectTime(const grpc_resolved_address& address, Duration time);
+  // Stable-sorts endpoints so that the addresses that connected fastest come
+  // first and the ones whose last attempt failed come last.
+  void SortByConnectTime(EndpointAddressesList& endpoints) const;
+
   // When ExitIdleLocked() is called, we create a subchannel_list_ and start
   // trying to connect, but we don't actually change state_ until the first
   // subchannel reports CONNECTING.  So in order to know if we're really
@@ -379,6 +393,11 @@ class PickFirst final : public LoadBalancingPolicy {
   const bool omit_status_message_prefix_;
   // Connection Attempt Delay for Happy Eyeballs.
   const Duration connection_attempt_delay_;
+  // Whether addresses are ordered by how long they took to connect.
+  const bool sort_by_connect_time_;
+  // How long the last connection attempt to each address took, keyed by the
+  // address string.
+  absl::flat_hash_map<std::string, Duration> connect_times_;
 
   // Lateset update args.
   UpdateArgs latest_update_args_;
@@ -417,7 +436,11 @@ PickFirst::PickFirst(Args args)
           Clamp(channel_args()
                     .GetInt(GRPC_ARG_HAPPY_EYEBALLS_CONNECTION_ATTEMPT_DELAY_MS)
                     .value_or(250),
-                100, 2000))) {
+                100, 2000))),
+      sort_by_connect_time_(
+          channel_args()
+              .GetBool(GRPC_ARG_HAPPY_EYEBALLS_SORT_BY_CONNECT_TIME)
+              .value_or(false)) {
   GRPC_TRACE_LOG(pick_first, INFO) << "Pick First " << this << " created.";
 }
 
@@ -533,24 +556,27 @@ absl::Status PickFirst::UpdateLocked(UpdateArgs args) {
         absl::c_shuffle(endpoints, bit_gen_);
       }
       // Flatten the list so that we have one address per endpoint.
-      // While we're iterating, also determine the desired address family
-      // order and the index of the first element of each family, for use in
-      // the interleaving below.
-      std::set<absl::string_view> address_families;
-      std::vector<AddressFamilyIterator> address_family_order;
       EndpointAddressesList flattened_endpoints;
       for (const auto& endpoint : endpoints) {
         for (const auto& address : endpoint.addresses()) {
           flattened_endpoints.emplace_back(address, endpoint.args());
-          absl::string_view scheme = GetAddressFamily(address);
-          bool inserted = address_families.insert(scheme).second;
-          if (inserted) {
-            address_family_order.emplace_back(scheme,
-                                              flattened_endpoints.size() - 1);
-          }
         }
       }
       endpoints = std::move(flattened_endpoints);
+      // Shuffling spreads load across backends, which ordering by connect
+      // time would undo.
+      if (sort_by_connect_time_ && !config->shuffle_addresses()) {
+        SortByConnectTime(endpoints);
+      }
+      // Determine the desired address family order and the index of the
+      // first element of each family, for use in the interleaving below.
+      std::set<absl::string_view> address_families;
+      std::vector<AddressFamilyIterator> address_family_order;
+      for (size_t i = 0; i < endpoints.size(); ++i) {
+        absl::string_view scheme = GetAddressFamily(endpoints[i].address());
+        bool inserted = address_families.insert(scheme).second;
+        if (inserted) address_family_order.emplace_back(scheme, i);
+      }
       // Interleave addresses as per RFC-8305 section 4.
       EndpointAddressesList interleaved_endpoints;
       interleaved_endpoints.reserve(endpoints.size());
@@ -585,6 +611,50 @@ absl::Status PickFirst::UpdateLocked(UpdateArgs args) {
   return status;
 }
 
+void PickFirst::NoteConnectTime(const grpc_resolved_address& address,
+                                Duration time) {
+  if (!sort_by_connect_time_) return;
+  auto key = grpc_sockaddr_to_string(&address, false);
+  if (!key.ok()) return;
+  // Bound the memory; an address list this long is rare for pick_first.
+  constexpr size_t kMaxConnectTimes = 64;
+  if (connect_times_.size() >= kMaxConnectTimes &&
+      !connect_times_.contains(*key)) {
+    connect_times_.clear();
+  }
+  GRPC_TRACE_LOG(pick_first, INFO)
+      << "Pick First " << this << " connect time for " << *key << ": "
+      << time.ToString();
+  connect_times_[*key] = time;
+}
+
+void PickFirst::SortByConnectTime(EndpointAddressesList& endpoints) const {
+  if (connect_times_.empty()) return;
+  // Addresses that connected come first, fastest first; then the ones never
+  // tried; then the ones whose last attempt failed.
+  auto rank = [this](const EndpointAddresses& endpoint) {
+    auto key = grpc_sockaddr_to_string(&endpoint.address(), false);
+    if (!key.ok()) return std::make_pair(1, Duration::Zero());
+    auto it = connect_times_.find(*key);
+    if (it == connect_times_.end()) return std::make_pair(1, Duration::Zero());
+    if (it->second == Duration::Infinity()) {
+      return std::make_pair(2, Duration::Zero());
+    }
+    return std::make_pair(0, it->second);
+  };
+  std::vector<std::pair<std::pair<int, Duration>, EndpointAddresses>> ranked;
+  ranked.reserve(endpoints.size());
+  for (auto& endpoint : endpoints) {
+    auto endpoint_rank = rank(endpoint);
+    ranked.emplace_back(endpoint_rank, std::move(endpoint));
+  }
+  std::stable_sort(
+      ranked.begin(), ranked.end(),
+      [](const auto& a, const auto& b) { return a.first < b.first; });
+  endpoints.clear();
+  for (auto& entry : ranked) endpoints.push_back(std::move(entry.second));
+}
+
 void PickFirst::UpdateState(grpc_connectivity_state state,
                             const absl::Status& status,
                             RefCountedPtr<SubchannelPicker> picker) {
@@ -722,6 +792,11 @@ void PickFirst::SubchannelList::SubchannelData::SubchannelState::Select() {
     stats_plugins.AddCounter(
         kMetricConnectionAttemptsSucceeded, 1,
         {pick_first_->channel_control_helper()->GetTarget()}, {});
+    if (subchannel_data_->connecting_since_.has_value()) {
+      pick_first_->NoteConnectTime(
+          subchannel_data_->address_,
+          Timestamp::Now() - *subchannel_data_->connecting_since_);
+    }
   }
   // Drop our pointer to subchannel_data_, so that we know not to
   // interact with it on subsequent connectivity state updates.
@@ -778,8 +853,9 @@ void PickFirst::SubchannelList::SubchannelData::SubchannelState::
 
 PickFirst::SubchannelList::SubchannelData::SubchannelData(
     SubchannelList* subchannel_list, size_t index,
+    const grpc_resolved_address& address,
     RefCountedPtr<SubchannelInterface> subchannel)
-    : subchannel_list_(subchannel_list), index_(index) {
+    : subchannel_list_(subchannel_list), index_(index), address_(address) {
   GRPC_TRACE_LOG(pick_first, INFO)
       << "[PF " << subchannel_list_->policy_.get() << "] subchannel list "
       << subchannel_list_ << " index " << index_
@@ -820,9 +896,16 @@ void PickFirst::SubchannelList::SubchannelData::OnConnectivityStateChange(
   // Make sure we note when a subchannel has seen TRANSIENT_FAILURE.
   bool prev_seen_transient_failure = seen_transient_failure_;
   if (new_state == GRPC_CHANNEL_TRANSIENT_FAILURE) {
+    if (!seen_transient_failure_ && old_state == GRPC_CHANNEL_CONNECTING) {
+      p->NoteConnectTime(address_, Duration::Infinity());
+    }
     seen_transient_failure_ = true;
     subchannel_list_->last_failure_ = connectivity_status_;
   }
+  if (new_state == GRPC_CHANNEL_CONNECTING &&
+      old_state != GRPC_CHANNEL_CONNECTING) {
+    connecting_since_ = Timestamp::Now();
+  }
   // If this is the initial connectivity state update for this subchannel,
   // increment the counter in the subchannel list.
   if (!old_state.has_value()) {
@@ -1008,7 +1091,7 @@ PickFirst::SubchannelList::SubchannelList(RefCountedPtr<PickFirst> policy,
         << subchannels_.size() << ": Created subchannel " << subchannel.get()
         << " for address " << address.ToString();
     subchannels_.emplace_back(std::make_unique<SubchannelData>(
-        this, subchannels_.size(), std::move(subchannel)));
+        this, subchannels_.size(), address.address(), std::move(subchannel)));
   });
 }
 
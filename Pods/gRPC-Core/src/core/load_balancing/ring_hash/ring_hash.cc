@@ -25,8 +25,11 @@
 
 #include <algorithm>
 #include <cmath>
+#include <iterator>
+#include <limits>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -144,15 +147,39 @@ class RingHash final : public LoadBalancingPolicy {
    public:
     struct RingEntry {
       uint64_t hash;
-      size_t endpoint_index;  // Index into RingHash::endpoints_.
+      uint32_t endpoint_index;  // Index into RingHash::endpoints_.
+      uint32_t replica;         // Which of the endpoint's hashes this is.
     };
 
-    Ring(RingHash* ring_hash, RingHashLbConfig* config);
+    // If previous is not null, the entries of endpoints that are in both
+    // rings are taken from it rather than hashed again.
+    Ring(RingHash* ring_hash, RingHashLbConfig* config, const Ring* previous);
 
     const std::vector<RingEntry>& ring() const { return ring_; }
 
+    // Returns the index of the first entry whose hash is at least
+    // request_hash, wrapping around to 0. The ring must not be empty.
+    size_t FindIndex(uint64_t request_hash) const;
+
    private:
+    // Adds the entries of endpoint_index for replicas [begin, end).
+    void AddEntries(uint32_t endpoint_index, uint32_t begin, uint32_t end,
+                    std::vector<RingEntry>* entries) const;
+    // Builds the ring from the entries of previous that are still wanted,
+    // together with the ones that are new. Returns false if endpoints can not
+    // be told apart by their address, which hashes are derived from.
+    bool BuildFromPrevious(const Ring& previous);
+    void BuildLookupTable();
+
+    // Keyed by endpoint index.
+    std::vector<std::string> addresses_;
+    std::vector<uint32_t> hash_counts_;
+    bool addresses_unique_ = true;
     std::vector<RingEntry> ring_;
+    // lookup_[b] is the index of the first entry whose hash, shifted right by
+    // lookup_shift_, is at least b. It has one more element than buckets.
+    std::vector<uint32_t> lookup_;
+    int lookup_shift_ = 63;
   };
 
   // State for a particular endpoint.  Delegates to a pick_first child policy.
@@ -305,33 +332,7 @@ RingHash::PickResult RingHash::Picker::Pick(PickArgs args) {
   uint64_t request_hash = hash_attribute->request_hash();
   const auto& ring = ring_->ring();
   // Find the index in the ring to use for this RPC.
-  // Ported from https://github.com/RJ/ketama/blob/master/libketama/ketama.c
-  // (ketama_get_server) NOTE: The algorithm depends on using signed integers
-  // for lowp, highp, and index. Do not change them!
-  int64_t lowp = 0;
-  int64_t highp = ring.size();
-  int64_t index = 0;
-  while (true) {
-    index = (lowp + highp) / 2;
-    if (index == static_cast<int64_t>(ring.size())) {
-      index = 0;
-      break;
-    }
-    uint64_t midval = ring[index].hash;
-    uint64_t midval1 = index == 0 ? 0 : ring[index - 1].hash;
-    if (request_hash <= midval && request_hash > midval1) {
-      break;
-    }
-    if (midval < request_hash) {
-      lowp = index + 1;
-    } else {
-      highp = index - 1;
-    }
-    if (lowp > highp) {
-      index = 0;
-      break;
-    }
-  }
+  const size_t index = ring_->FindIndex(request_hash);
   // Find the first endpoint we can use from the selected index.
   for (size_t i = 0; i < ring.size(); ++i) {
     const auto& entry = ring[(index + i) % ring.size()];
@@ -359,10 +360,10 @@ RingHash::PickResult RingHash::Picker::Pick(PickArgs args) {
 // RingHash::Ring
 //
 
-RingHash::Ring::Ring(RingHash* ring_hash, RingHashLbConfig* config) {
+RingHash::Ring::Ring(RingHash* ring_hash, RingHashLbConfig* config,
+                     const Ring* previous) {
   // Store the weights while finding the sum.
   struct EndpointWeight {
-    std::string address;  // Key by endpoint's first address.
     // Default weight is 1 for the cases where a weight is not provided,
     // each occurrence of the address will be counted a weight value of 1.
     uint32_t weight = 1;
@@ -372,10 +373,12 @@ RingHash::Ring::Ring(RingHash* ring_hash, RingHashLbConfig* config) {
   size_t sum = 0;
   const EndpointAddressesList& endpoints = ring_hash->endpoints_;
   endpoint_weights.reserve(endpoints.size());
+  addresses_.reserve(endpoints.size());
   for (const auto& endpoint : endpoints) {
     EndpointWeight endpoint_weight;
-    endpoint_weight.address =
-        grpc_sockaddr_to_string(&endpoint.addresses().front(), false).value();
+    // Key by endpoint's first address.
+    addresses_.push_back(
+        grpc_sockaddr_to_string(&endpoint.addresses().front(), false).value());
     // Weight should never be zero, but ignore it just in case, since
     // that value would screw up the ring-building algorithm.
     auto weight_arg = endpoint.args().GetInt(GRPC_ARG_ADDRESS_WEIGHT);
@@ -411,46 +414,144 @@ RingHash::Ring::Ring(RingHash* ring_hash, RingHashLbConfig* config) {
   const double scale = std::min(
       std::ceil(min_normalized_weight * min_ring_size) / min_normalized_weight,
       static_cast<double>(max_ring_size));
-  // Reserve memory for the entire ring up front.
-  const uint64_t ring_size = std::ceil(scale);
-  ring_.reserve(ring_size);
-  // Populate the hash ring by walking through the (host, weight) pairs in
-  // normalized_host_weights, and generating (scale * weight) hashes for each
-  // host. Since these aren't necessarily whole numbers, we maintain running
-  // sums -- current_hashes and target_hashes -- which allows us to populate the
-  // ring in a mostly stable way.
-  absl::InlinedVector<char, 196> hash_key_buffer;
+  // Find the number of hashes of each host by walking through the (host,
+  // weight) pairs, giving each (scale * weight) hashes. Since these aren't
+  // necessarily whole numbers, we maintain running sums -- current_hashes and
+  // target_hashes -- which allows us to populate the ring in a mostly stable
+  // way.
+  hash_counts_.reserve(endpoints.size());
   double current_hashes = 0.0;
   double target_hashes = 0.0;
-  uint64_t min_hashes_per_host = ring_size;
-  uint64_t max_hashes_per_host = 0;
   for (size_t i = 0; i < endpoints.size(); ++i) {
-    const std::string& address_string = endpoint_weights[i].address;
-    hash_key_buffer.assign(address_string.begin(), address_string.end());
-    hash_key_buffer.emplace_back('_');
-    auto offset_start = hash_key_buffer.end();
     target_hashes += scale * endpoint_weights[i].normalized_weight;
-    size_t count = 0;
+    uint32_t count = 0;
     while (current_hashes < target_hashes) {
-      const std::string count_str = absl::StrCat(count);
-      hash_key_buffer.insert(offset_start, count_str.begin(), count_str.end());
-      absl::string_view hash_key(hash_key_buffer.data(),
-                                 hash_key_buffer.size());
-      const uint64_t hash = XXH64(hash_key.data(), hash_key.size(), 0);
-      ring_.push_back({hash, i});
       ++count;
       ++current_hashes;
-      hash_key_buffer.erase(offset_start, hash_key_buffer.end());
     }
-    min_hashes_per_host =
-        std::min(static_cast<uint64_t>(i), min_hashes_per_host);
-    max_hashes_per_host =
-        std::max(static_cast<uint64_t>(i), max_hashes_per_host);
-  }
-  std::sort(ring_.begin(), ring_.end(),
-            [](const RingEntry& lhs, const RingEntry& rhs) -> bool {
-              return lhs.hash < rhs.hash;
-            });
+    hash_counts_.push_back(count);
+  }
+  // Endpoints whose first addresses are equal get the same hashes, which
+  // can only be told apart by hashing them again.
+  {
+    std::set<absl::string_view> seen;
+    for (const std::string& address : addresses_) {
+      if (!seen.insert(address).second) {
+        addresses_unique_ = false;
+        break;
+      }
+    }
+  }
+  if (previous == nullptr || !addresses_unique_ ||
+      !BuildFromPrevious(*previous)) {
+    // Reserve memory for the entire ring up front.
+    ring_.reserve(static_cast<size_t>(std::ceil(scale)));
+    for (size_t i = 0; i < endpoints.size(); ++i) {
+      AddEntries(i, 0, hash_counts_[i], &ring_);
+    }
+    std::sort(ring_.begin(), ring_.end(),
+              [](const RingEntry& lhs, const RingEntry& rhs) -> bool {
+                return lhs.hash < rhs.hash;
+              });
+  }
+  BuildLookupTable();
+}
+
+void RingHash::Ring::AddEntries(uint32_t endpoint_index, uint32_t begin,
+                                uint32_t end,
+                                std::vector<RingEntry>* entries) const {
+  // The hash of each replica is that of "<address>_<replica>".
+  const std::string& address_string = addresses_[endpoint_index];
+  absl::InlinedVector<char, 196> hash_key_buffer(address_string.begin(),
+                                                 address_string.end());
+  hash_key_buffer.emplace_back('_');
+  const size_t prefix_size = hash_key_buffer.size();
+  for (uint32_t replica = begin; replica < end; ++replica) {
+    const absl::AlphaNum replica_str(replica);
+    hash_key_buffer.resize(prefix_size);
+    hash_key_buffer.insert(hash_key_buffer.end(), replica_str.data(),
+                           replica_str.data() + replica_str.size());
+    const uint64_t hash =
+        XXH64(hash_key_buffer.data(), hash_key_buffer.size(), 0);
+    entries->push_back({hash, endpoint_index, replica});
+  }
+}
+
+bool RingHash::Ring::BuildFromPrevious(const Ring& previous) {
+  if (!previous.addresses_unique_) return false;
+  std::map<absl::string_view, uint32_t> indices;
+  for (size_t i = 0; i < addresses_.size(); ++i) {
+    indices.emplace(addresses_[i], i);
+  }
+  // Maps the endpoint indices of the previous ring to those of this one.
+  constexpr uint32_t kRemoved = std::numeric_limits<uint32_t>::max();
+  std::vector<uint32_t> new_indices(previous.addresses_.size(), kRemoved);
+  std::vector<uint32_t> previous_counts(addresses_.size(), 0);
+  for (size_t i = 0; i < previous.addresses_.size(); ++i) {
+    auto it = indices.find(previous.addresses_[i]);
+    if (it != indices.end()) {
+      new_indices[i] = it->second;
+      previous_counts[it->second] = previous.hash_counts_[i];
+    }
+  }
+  // Only the entries of endpoints that are new or got more hashes are
+  // computed and sorted, the rest of the ring is merged in as it is.
+  std::vector<RingEntry> added;
+  for (size_t i = 0; i < addresses_.size(); ++i) {
+    if (previous_counts[i] < hash_counts_[i]) {
+      AddEntries(i, previous_counts[i], hash_counts_[i], &added);
+    }
+  }
+  auto hash_less = [](const RingEntry& lhs, const RingEntry& rhs) {
+    return lhs.hash < rhs.hash;
+  };
+  std::sort(added.begin(), added.end(), hash_less);
+  std::vector<RingEntry> kept;
+  kept.reserve(previous.ring_.size());
+  for (const RingEntry& entry : previous.ring_) {
+    const uint32_t index = new_indices[entry.endpoint_index];
+    if (index != kRemoved && entry.replica < hash_counts_[index]) {
+      kept.push_back({entry.hash, index, entry.replica});
+    }
+  }
+  ring_.reserve(kept.size() + added.size());
+  std::merge(kept.begin(), kept.end(), added.begin(), added.end(),
+             std::back_inserter(ring_), hash_less);
+  return true;
+}
+
+void RingHash::Ring::BuildLookupTable() {
+  // About one entry per bucket, so that a lookup rarely compares more than a
+  // few hashes, but with no more than 64K buckets.
+  int bits = 1;
+  while (bits < 16 && (static_cast<size_t>(1) << bits) < ring_.size()) {
+    ++bits;
+  }
+  lookup_shift_ = 64 - bits;
+  const size_t num_buckets = static_cast<size_t>(1) << bits;
+  lookup_.resize(num_buckets + 1);
+  size_t index = 0;
+  for (size_t bucket = 0; bucket < num_buckets; ++bucket) {
+    while (index < ring_.size() &&
+           (ring_[index].hash >> lookup_shift_) < bucket) {
+      ++index;
+    }
+    lookup_[bucket] = index;
+  }
+  lookup_[num_buckets] = ring_.size();
+}
+
+size_t RingHash::Ring::FindIndex(uint64_t request_hash) const {
+  // Entries before the bucket of request_hash have smaller hashes and entries
+  // after it bigger ones, so only the bucket itself has to be searched.
+  const size_t bucket = request_hash >> lookup_shift_;
+  auto it = std::lower_bound(
+      ring_.begin() + lookup_[bucket], ring_.begin() + lookup_[bucket + 1],
+      request_hash, [](const RingEntry& entry, uint64_t hash) {
+        return entry.hash < hash;
+      });
+  const size_t index = it - ring_.begin();
+  return index == ring_.size() ? 0 : index;
 }
 
 //
@@ -654,7 +755,7 @@ absl::Status RingHash::UpdateLocked(UpdateArgs args) {
   args_ = std::move(args.args);
   // Build new ring.
   ring_ = MakeRefCounted<Ring>(
-      this, static_cast<RingHashLbConfig*>(args.config.get()));
+      this, static_cast<RingHashLbConfig*>(args.config.get()), ring_.get());
   // Update endpoint map.
   std::map<EndpointAddressSet, OrphanablePtr<RingHashEndpoint>> endpoint_map;
   std::vector<std::string> errors;
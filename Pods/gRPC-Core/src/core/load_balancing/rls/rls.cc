@@ -1902,7 +1902,7 @@ grpc_byte_buffer* RlsLb::RlsRequest::MakeRequestProto() {
 
 RlsLb::ResponseInfo RlsLb::RlsRequest::ParseResponseProto() {
   ResponseInfo response_info;
-  upb::Arena arena;
+  UpbParseArena arena;
   grpc_byte_buffer_reader bbr;
   grpc_byte_buffer_reader_init(&bbr, recv_message_);
   grpc_slice recv_slice = grpc_byte_buffer_reader_readall(&bbr);
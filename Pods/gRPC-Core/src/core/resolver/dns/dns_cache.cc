@@ -0,0 +1,139 @@
+// Copyright 2024 The gRPC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/core/resolver/dns/dns_cache.h"
+
+#include <grpc/support/port_platform.h>
+#include <stdio.h>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/log/log.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "src/core/lib/address_utils/parse_address.h"
+#include "src/core/lib/address_utils/sockaddr_utils.h"
+#include "src/core/lib/debug/trace.h"
+#include "src/core/util/load_file.h"
+#include "src/core/util/no_destruct.h"
+
+namespace grpc_core {
+
+namespace {
+
+// How long an answer can be used at all, while it is refreshed.
+constexpr absl::Duration kMaxStaleness = absl::Hours(24);
+// Channels use only a handful of targets, so keep the cache (and its file)
+// small rather than tracking usage.
+constexpr size_t kMaxEntries = 64;
+
+}  // namespace
+
+DnsCache& DnsCache::Get() {
+  static NoDestruct<DnsCache> cache;
+  return *cache;
+}
+
+absl::optional<DnsCache::Answer> DnsCache::Find(absl::string_view name,
+                                                Duration ttl) {
+  MutexLock lock(&mu_);
+  auto it = entries_.find(name);
+  if (it == entries_.end()) return absl::nullopt;
+  const absl::Duration age = absl::Now() - it->second.resolved_at;
+  if (age > kMaxStaleness) {
+    entries_.erase(it);
+    return absl::nullopt;
+  }
+  // If the clock went backwards we cannot tell how old the answer is.
+  const bool stale =
+      age < absl::ZeroDuration() || age > absl::Milliseconds(ttl.millis());
+  return Answer{it->second.addresses, stale};
+}
+
+void DnsCache::Insert(absl::string_view name,
+                      std::vector<grpc_resolved_address> addresses) {
+  MutexLock lock(&mu_);
+  if (entries_.size() >= kMaxEntries && !entries_.contains(name)) {
+    entries_.clear();
+  }
+  entries_[name] = Entry{std::move(addresses), absl::Now()};
+  GRPC_TRACE_VLOG(dns_resolver, 2) << "[dns_cache] cached answer for " << name;
+  SaveLocked();
+}
+
+void DnsCache::SetPersistencePath(absl::string_view path) {
+  MutexLock lock(&mu_);
+  if (path == path_) return;
+  path_ = std::string(path);
+  LoadLocked();
+}
+
+// The file holds one answer per line: the name, the time it was resolved in
+// seconds since the epoch, and its addresses, separated by spaces.
+void DnsCache::LoadLocked() {
+  auto contents = LoadFile(path_, /*add_null_terminator=*/false);
+  if (!contents.ok()) return;
+  for (absl::string_view line :
+       absl::StrSplit(contents->as_string_view(), '\n', absl::SkipEmpty())) {
+    std::vector<absl::string_view> fields = absl::StrSplit(line, ' ');
+    int64_t resolved_at;
+    if (fields.size() < 3 || !absl::SimpleAtoi(fields[1], &resolved_at)) {
+      continue;
+    }
+    Entry entry;
+    entry.resolved_at = absl::FromUnixSeconds(resolved_at);
+    for (size_t i = 2; i < fields.size(); ++i) {
+      auto address = StringToSockaddr(fields[i]);
+      if (address.ok()) entry.addresses.push_back(*address);
+    }
+    if (entry.addresses.empty() || entries_.size() >= kMaxEntries) continue;
+    entries_.emplace(fields[0], std::move(entry));
+  }
+  GRPC_TRACE_VLOG(dns_resolver, 2)
+      << "[dns_cache] loaded " << entries_.size() << " answers from " << path_;
+}
+
+void DnsCache::SaveLocked() {
+  if (path_.empty()) return;
+  std::string contents;
+  for (const auto& name_and_entry : entries_) {
+    absl::StrAppend(&contents, name_and_entry.first, " ",
+                    absl::ToUnixSeconds(name_and_entry.second.resolved_at));
+    for (const auto& address : name_and_entry.second.addresses) {
+      auto address_string = grpc_sockaddr_to_string(&address, false);
+      if (address_string.ok()) absl::StrAppend(&contents, " ", *address_string);
+    }
+    contents.push_back('\n');
+  }
+  // Write a new file and move it into place, so that a crash mid-write
+  // leaves the previous answers rather than a partial file.
+  const std::string temp_path = absl::StrCat(path_, ".tmp");
+  FILE* file = fopen(temp_path.c_str(), "w");
+  if (file == nullptr) {
+    VLOG(2) << "[dns_cache] cannot write " << temp_path;
+    return;
+  }
+  const bool written =
+      fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+  if (fclose(file) != 0 || !written ||
+      rename(temp_path.c_str(), path_.c_str()) != 0) {
+    VLOG(2) << "[dns_cache] cannot save answers to " << path_;
+    remove(temp_path.c_str());
+  }
+}
+
+}  // namespace grpc_core
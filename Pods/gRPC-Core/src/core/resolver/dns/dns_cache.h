@@ -0,0 +1,78 @@
+// Copyright 2024 The gRPC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef GRPC_SRC_CORE_RESOLVER_DNS_DNS_CACHE_H
+#define GRPC_SRC_CORE_RESOLVER_DNS_DNS_CACHE_H
+#include <grpc/support/port_platform.h>
+
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "src/core/lib/iomgr/resolved_address.h"
+#include "src/core/util/sync.h"
+#include "src/core/util/time.h"
+
+namespace grpc_core {
+
+// A process-wide cache of DNS answers, shared by all channels that opt in.
+//
+// An answer younger than the caller's TTL is fresh and can be used without a
+// lookup. An older one is stale: it can still be used for up to a day, while
+// the caller refreshes it in the background, so that connecting to a name that
+// resolved recently never waits on DNS. The cache can be backed by a file, so
+// that this also holds for the first connect after a process restart.
+class DnsCache final {
+ public:
+  struct Answer {
+    std::vector<grpc_resolved_address> addresses;
+    bool stale;
+  };
+
+  static DnsCache& Get();
+
+  // Returns the cached answer for name, if there is one that is recent enough
+  // to be used at all.
+  absl::optional<Answer> Find(absl::string_view name, Duration ttl);
+
+  // Caches a successful lookup of name, and saves the cache to its file, if
+  // it has one.
+  void Insert(absl::string_view name,
+              std::vector<grpc_resolved_address> addresses);
+
+  // Backs the cache with the file at path. The first call loads the answers
+  // saved in the file; answers already in memory take precedence.
+  void SetPersistencePath(absl::string_view path);
+
+ private:
+  struct Entry {
+    std::vector<grpc_resolved_address> addresses;
+    // Wall-clock time, so that it stays meaningful across restarts.
+    absl::Time resolved_at;
+  };
+
+  void LoadLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void SaveLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Mutex mu_;
+  absl::flat_hash_map<std::string, Entry> entries_ ABSL_GUARDED_BY(mu_);
+  std::string path_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace grpc_core
+
+#endif  // GRPC_SRC_CORE_RESOLVER_DNS_DNS_CACHE_H
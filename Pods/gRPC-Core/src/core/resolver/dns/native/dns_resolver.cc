@@ -35,6 +35,7 @@
 #include "src/core/lib/debug/trace.h"
 #include "src/core/lib/iomgr/resolve_address.h"
 #include "src/core/lib/iomgr/resolved_address.h"
+#include "src/core/resolver/dns/dns_cache.h"
 #include "src/core/resolver/endpoint_addresses.h"
 #include "src/core/resolver/polling_resolver.h"
 #include "src/core/resolver/resolver.h"
@@ -58,7 +59,8 @@ namespace {
 class NativeClientChannelDNSResolver final : public PollingResolver {
  public:
   NativeClientChannelDNSResolver(ResolverArgs args,
-                                 Duration min_time_between_resolutions);
+                                 Duration min_time_between_resolutions,
+                                 absl::optional<Duration> cache_ttl);
   ~NativeClientChannelDNSResolver() override;
 
   OrphanablePtr<Orphanable> StartRequest() override;
@@ -76,10 +78,20 @@ class NativeClientChannelDNSResolver final : public PollingResolver {
 
   void OnResolved(
       absl::StatusOr<std::vector<grpc_resolved_address>> addresses_or);
+
+  // Looks the name up again to refresh a stale answer in DnsCache. The
+  // resolver has already returned that answer, so the lookup only updates
+  // the cache, which the next resolution will find.
+  void RefreshCachedAnswer();
+
+  // How long a cached answer is used without a lookup, if answers are cached
+  // at all.
+  const absl::optional<Duration> cache_ttl_;
 };
 
 NativeClientChannelDNSResolver::NativeClientChannelDNSResolver(
-    ResolverArgs args, Duration min_time_between_resolutions)
+    ResolverArgs args, Duration min_time_between_resolutions,
+    absl::optional<Duration> cache_ttl)
     : PollingResolver(std::move(args), min_time_between_resolutions,
                       BackOff::Options()
                           .set_initial_backoff(Duration::Milliseconds(
@@ -88,7 +100,8 @@ NativeClientChannelDNSResolver::NativeClientChannelDNSResolver(
                           .set_jitter(GRPC_DNS_RECONNECT_JITTER)
                           .set_max_backoff(Duration::Milliseconds(
                               GRPC_DNS_RECONNECT_MAX_BACKOFF_SECONDS * 1000)),
-                      &dns_resolver_trace) {
+                      &dns_resolver_trace),
+      cache_ttl_(cache_ttl) {
   GRPC_TRACE_VLOG(dns_resolver, 2) << "[dns_resolver=" << this << "] created";
 }
 
@@ -97,6 +110,24 @@ NativeClientChannelDNSResolver::~NativeClientChannelDNSResolver() {
 }
 
 OrphanablePtr<Orphanable> NativeClientChannelDNSResolver::StartRequest() {
+  if (cache_ttl_.has_value()) {
+    auto answer = DnsCache::Get().Find(name_to_resolve(), *cache_ttl_);
+    if (answer.has_value()) {
+      GRPC_TRACE_VLOG(dns_resolver, 2)
+          << "[dns_resolver=" << this << "] using "
+          << (answer->stale ? "stale" : "fresh") << " cached answer";
+      if (answer->stale) RefreshCachedAnswer();
+      EndpointAddressesList addresses;
+      for (auto& addr : answer->addresses) {
+        addresses.emplace_back(addr, ChannelArgs());
+      }
+      Result result;
+      result.addresses = std::move(addresses);
+      result.args = channel_args();
+      OnRequestComplete(std::move(result));
+      return MakeOrphanable<Request>();
+    }
+  }
   Ref(DEBUG_LOCATION, "dns_request").release();
   auto dns_request_handle = GetDNSResolver()->LookupHostname(
       absl::bind_front(&NativeClientChannelDNSResolver::OnResolved, this),
@@ -108,6 +139,18 @@ OrphanablePtr<Orphanable> NativeClientChannelDNSResolver::StartRequest() {
   return MakeOrphanable<Request>();
 }
 
+void NativeClientChannelDNSResolver::RefreshCachedAnswer() {
+  GetDNSResolver()->LookupHostname(
+      [name = name_to_resolve()](
+          absl::StatusOr<std::vector<grpc_resolved_address>> addresses_or) {
+        if (addresses_or.ok() && !addresses_or->empty()) {
+          DnsCache::Get().Insert(name, std::move(*addresses_or));
+        }
+      },
+      name_to_resolve(), kDefaultSecurePort, kDefaultDNSRequestTimeout,
+      interested_parties(), /*name_server=*/"");
+}
+
 void NativeClientChannelDNSResolver::OnResolved(
     absl::StatusOr<std::vector<grpc_resolved_address>> addresses_or) {
   GRPC_TRACE_VLOG(dns_resolver, 2)
@@ -116,6 +159,9 @@ void NativeClientChannelDNSResolver::OnResolved(
   // Convert result from iomgr DNS API into Resolver::Result.
   Result result;
   if (addresses_or.ok()) {
+    if (cache_ttl_.has_value() && !addresses_or->empty()) {
+      DnsCache::Get().Insert(name_to_resolve(), *addresses_or);
+    }
     EndpointAddressesList addresses;
     for (auto& addr : *addresses_or) {
       addresses.emplace_back(addr, ChannelArgs());
@@ -158,8 +204,16 @@ class NativeClientChannelDNSResolverFactory final : public ResolverFactory {
                               .GetDurationFromIntMillis(
                                   GRPC_ARG_DNS_MIN_TIME_BETWEEN_RESOLUTIONS_MS)
                               .value_or(Duration::Seconds(30)));
+    absl::optional<Duration> cache_ttl =
+        args.args.GetDurationFromIntMillis(GRPC_ARG_DNS_CACHE_TTL_MS);
+    if (cache_ttl.has_value()) {
+      auto cache_path = args.args.GetOwnedString(GRPC_ARG_DNS_CACHE_PATH);
+      if (cache_path.has_value()) {
+        DnsCache::Get().SetPersistencePath(*cache_path);
+      }
+    }
     return MakeOrphanable<NativeClientChannelDNSResolver>(
-        std::move(args), min_time_between_resolutions);
+        std::move(args), min_time_between_resolutions, cache_ttl);
   }
 };
 
@@ -22,6 +22,8 @@
 #include <string>
 #include <utility>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -30,12 +32,15 @@
 #include "src/core/lib/slice/slice.h"
 #include "src/core/lib/slice/slice_internal.h"
 #include "src/core/service_config/service_config_parser.h"
+#include "src/core/util/down_cast.h"
 #include "src/core/util/json/json.h"
 #include "src/core/util/json/json_args.h"
 #include "src/core/util/json/json_object_loader.h"
 #include "src/core/util/json/json_reader.h"
 #include "src/core/util/json/json_writer.h"
 #include "src/core/util/memory.h"
+#include "src/core/util/no_destruct.h"
+#include "src/core/util/sync.h"
 #include "src/core/util/validation_errors.h"
 
 namespace grpc_core {
@@ -78,10 +83,74 @@ struct MethodConfig {
   }
 };
 
+// Service configs parsed from text, keyed by that text and the args they
+// were parsed with, so that channels and resolvers that get the same config
+// share one parse. Entries are weak: a config removes itself when destroyed.
+class ServiceConfigCache {
+ public:
+  static ServiceConfigCache& Get() {
+    static NoDestruct<ServiceConfigCache> cache;
+    return *cache;
+  }
+
+  RefCountedPtr<ServiceConfig> Find(absl::string_view json_string,
+                                    const ChannelArgs& args) {
+    MutexLock lock(&mu_);
+    auto it = map_.find(Key{std::string(json_string), args});
+    if (it == map_.end()) return nullptr;
+    return it->second->RefIfNonZero();
+  }
+
+  void Insert(std::string json_string, ChannelArgs args,
+              ServiceConfig* service_config) {
+    MutexLock lock(&mu_);
+    map_[Key{std::move(json_string), std::move(args)}] = service_config;
+  }
+
+  void Remove(absl::string_view json_string, const ChannelArgs& args,
+              ServiceConfig* service_config) {
+    MutexLock lock(&mu_);
+    auto it = map_.find(Key{std::string(json_string), args});
+    // A config that was replaced after its last unref leaves the new entry.
+    if (it != map_.end() && it->second == service_config) map_.erase(it);
+  }
+
+ private:
+  struct Key {
+    std::string json_string;
+    ChannelArgs args;
+
+    bool operator==(const Key& other) const {
+      return json_string == other.json_string && args == other.args;
+    }
+    template <typename H>
+    friend H AbslHashValue(H h, const Key& key) {
+      return H::combine(std::move(h), key.json_string, key.args);
+    }
+  };
+
+  Mutex mu_;
+  absl::flat_hash_map<Key, ServiceConfig*> map_ ABSL_GUARDED_BY(mu_);
+};
+
+// Parsers read int and string args, such as the ones that enable optional
+// method config fields. Pointer args, such as the channelz node, differ
+// between channels, so they are left out of the cache key.
+ChannelArgs CacheKeyArgs(const ChannelArgs& args) {
+  ChannelArgs key_args = args;
+  args.ForEach([&](absl::string_view key, const ChannelArgs::Value& value) {
+    if (value.GetIfPointer() != nullptr) key_args = key_args.Remove(key);
+  });
+  return key_args;
+}
+
 }  // namespace
 
 absl::StatusOr<RefCountedPtr<ServiceConfig>> ServiceConfigImpl::Create(
     const ChannelArgs& args, absl::string_view json_string) {
+  ChannelArgs key_args = CacheKeyArgs(args);
+  auto cached = ServiceConfigCache::Get().Find(json_string, key_args);
+  if (cached != nullptr) return cached;
   auto json = JsonParse(json_string);
   if (!json.ok()) return json.status();
   ValidationErrors errors;
@@ -90,6 +159,10 @@ absl::StatusOr<RefCountedPtr<ServiceConfig>> ServiceConfigImpl::Create(
     return errors.status(absl::StatusCode::kInvalidArgument,
                          "errors validating service config");
   }
+  DownCast<ServiceConfigImpl*>(service_config.get())->cache_key_args_ =
+      key_args;
+  ServiceConfigCache::Get().Insert(std::string(json_string),
+                                   std::move(key_args), service_config.get());
   return service_config;
 }
 
@@ -167,6 +240,9 @@ RefCountedPtr<ServiceConfig> ServiceConfigImpl::Create(
 }
 
 ServiceConfigImpl::~ServiceConfigImpl() {
+  if (cache_key_args_.has_value()) {
+    ServiceConfigCache::Get().Remove(json_string_, *cache_key_args_, this);
+  }
   for (auto& p : parsed_method_configs_map_) {
     CSliceUnref(p.first);
   }
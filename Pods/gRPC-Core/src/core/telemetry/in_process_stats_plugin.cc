@@ -0,0 +1,239 @@
+// Copyright 2024 The gRPC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/core/telemetry/in_process_stats_plugin.h"
+
+#include <grpc/support/port_platform.h>
+#include <grpc/support/time.h>
+
+#include <algorithm>
+#include <limits>
+
+#include "absl/numeric/bits.h"
+#include "src/core/ext/transport/chttp2/transport/chttp2_transport.h"
+#include "src/core/lib/promise/context.h"
+#include "src/core/lib/resource_quota/arena.h"
+#include "src/core/lib/slice/slice_buffer.h"
+#include "src/core/util/time.h"
+
+namespace grpc_core {
+
+namespace {
+
+// Bounds the memory used for channels whose method names are not fixed.
+constexpr size_t kMaxMethods = 100;
+constexpr absl::string_view kOtherMethod = "other";
+
+const int kBucketBoundaries[InProcessStatsPlugin::kNumBuckets + 1] = {
+    0,       1,       2,       4,       8,       16,      32,
+    64,      128,     256,     512,     1024,    2048,    4096,
+    8192,    16384,   32768,   65536,   131072,  262144,  524288,
+    1 << 20, 1 << 21, 1 << 22, 1 << 23, 1 << 24, 1 << 25};
+
+int BucketFor(int value) {
+  if (value <= 0) return 0;
+  return std::min(absl::bit_width(static_cast<unsigned>(value)),
+                  InProcessStatsPlugin::kNumBuckets - 1);
+}
+
+}  // namespace
+
+//
+// InProcessStatsPlugin::Histogram
+//
+
+HistogramView InProcessStatsPlugin::Histogram::view() const {
+  return HistogramView{&BucketFor, kBucketBoundaries, kNumBuckets, buckets_};
+}
+
+uint64_t InProcessStatsPlugin::Histogram::count() const {
+  uint64_t count = 0;
+  for (uint64_t bucket : buckets_) count += bucket;
+  return count;
+}
+
+//
+// InProcessStatsPlugin::HistogramRecorder
+//
+
+void InProcessStatsPlugin::HistogramRecorder::Record(int64_t value) {
+  const int clamped = static_cast<int>(
+      std::min<int64_t>(value, std::numeric_limits<int>::max()));
+  buckets_[BucketFor(clamped)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void InProcessStatsPlugin::HistogramRecorder::Collect(
+    Histogram* histogram) const {
+  for (int i = 0; i < kNumBuckets; ++i) {
+    histogram->buckets_[i] = buckets_[i].load(std::memory_order_relaxed);
+  }
+}
+
+//
+// InProcessStatsPlugin::CallTracer
+//
+
+// Arena-allocated with the call, so the destructor runs once the call stack
+// is done with every attempt.
+class InProcessStatsPlugin::CallTracer final : public ClientCallTracer {
+ public:
+  class AttemptTracer final : public CallAttemptTracer {
+   public:
+    explicit AttemptTracer(CallTracer* call_tracer)
+        : call_tracer_(call_tracer) {}
+
+    void RecordSendInitialMetadata(
+        grpc_metadata_batch* /*send_initial_metadata*/) override {}
+    void RecordSendTrailingMetadata(
+        grpc_metadata_batch* /*send_trailing_metadata*/) override {}
+    void RecordSendMessage(const SliceBuffer& send_message) override {
+      recorder()->sent_message_bytes.Record(send_message.Length());
+    }
+    void RecordSendCompressedMessage(
+        const SliceBuffer& /*send_compressed_message*/) override {}
+    void RecordReceivedInitialMetadata(
+        grpc_metadata_batch* /*recv_initial_metadata*/) override {}
+    void RecordReceivedMessage(const SliceBuffer& recv_message) override {
+      recorder()->received_message_bytes.Record(recv_message.Length());
+    }
+    void RecordReceivedDecompressedMessage(
+        const SliceBuffer& /*recv_decompressed_message*/) override {}
+    void RecordCancel(grpc_error_handle /*cancel_error*/) override {}
+    void RecordIncomingBytes(
+        const TransportByteSize& /*transport_byte_size*/) override {}
+    void RecordOutgoingBytes(
+        const TransportByteSize& /*transport_byte_size*/) override {}
+    std::shared_ptr<TcpTracerInterface> StartNewTcpTrace() override {
+      return nullptr;
+    }
+    void RecordReceivedTrailingMetadata(
+        absl::Status /*status*/,
+        grpc_metadata_batch* /*recv_trailing_metadata*/,
+        const grpc_transport_stream_stats* /*transport_stream_stats*/)
+        override {}
+    void RecordEnd(const gpr_timespec& /*latency*/) override {
+      call_tracer_->end_time_ = Timestamp::Now();
+    }
+    void SetOptionalLabel(OptionalLabelKey /*key*/,
+                          RefCountedStringValue /*value*/) override {}
+
+    void RecordAnnotation(absl::string_view /*annotation*/) override {}
+    void RecordAnnotation(const Annotation& annotation) override {
+      if (annotation.type() != AnnotationType::kHttpTransport) return;
+      const auto& http_annotation =
+          static_cast<const HttpAnnotation&>(annotation);
+      switch (http_annotation.http_type()) {
+        case HttpAnnotation::Type::kStart:
+          transport_start_ = http_annotation.time();
+          break;
+        case HttpAnnotation::Type::kEnd:
+          if (transport_start_.has_value()) {
+            recorder()->transport_send_ms.Record(gpr_time_to_millis(
+                gpr_time_sub(http_annotation.time(), *transport_start_)));
+          }
+          break;
+        default:
+          break;
+      }
+    }
+    std::string TraceId() override { return ""; }
+    std::string SpanId() override { return ""; }
+    // The transport only reports its annotations to sampled attempts.
+    bool IsSampled() override { return true; }
+
+   private:
+    MethodRecorder* recorder() const { return call_tracer_->recorder_; }
+
+    CallTracer* const call_tracer_;
+    absl::optional<gpr_timespec> transport_start_;
+  };
+
+  explicit CallTracer(MethodRecorder* recorder)
+      : recorder_(recorder), start_time_(Timestamp::Now()) {}
+
+  ~CallTracer() override {
+    recorder_->attempts.Record(num_attempts_);
+    if (end_time_.has_value()) {
+      recorder_->latency_ms.Record((*end_time_ - start_time_).millis());
+    }
+  }
+
+  CallAttemptTracer* StartNewAttempt(bool /*is_transparent_retry*/) override {
+    ++num_attempts_;
+    return GetContext<Arena>()->ManagedNew<AttemptTracer>(this);
+  }
+
+  void RecordAnnotation(absl::string_view /*annotation*/) override {}
+  void RecordAnnotation(const Annotation& /*annotation*/) override {}
+  std::string TraceId() override { return ""; }
+  std::string SpanId() override { return ""; }
+  bool IsSampled() override { return false; }
+
+ private:
+  MethodRecorder* const recorder_;
+  const Timestamp start_time_;
+  absl::optional<Timestamp> end_time_;
+  int num_attempts_ = 0;
+};
+
+//
+// InProcessStatsPlugin
+//
+
+InProcessStatsPlugin& InProcessStatsPlugin::Get() {
+  // The registry keeps the plugin for the life of the process.
+  static InProcessStatsPlugin* plugin = [] {
+    auto plugin = std::make_shared<InProcessStatsPlugin>();
+    InProcessStatsPlugin* ptr = plugin.get();
+    GlobalStatsPluginRegistry::RegisterStatsPlugin(std::move(plugin));
+    return ptr;
+  }();
+  return *plugin;
+}
+
+std::map<std::string, InProcessStatsPlugin::MethodStats>
+InProcessStatsPlugin::Snapshot() const {
+  std::map<std::string, MethodStats> snapshot;
+  MutexLock lock(&mu_);
+  for (const auto& method_and_recorder : methods_) {
+    const MethodRecorder& recorder = *method_and_recorder.second;
+    MethodStats& stats = snapshot[method_and_recorder.first];
+    recorder.latency_ms.Collect(&stats.latency_ms);
+    recorder.attempts.Collect(&stats.attempts);
+    recorder.sent_message_bytes.Collect(&stats.sent_message_bytes);
+    recorder.received_message_bytes.Collect(&stats.received_message_bytes);
+    recorder.transport_send_ms.Collect(&stats.transport_send_ms);
+  }
+  return snapshot;
+}
+
+ClientCallTracer* InProcessStatsPlugin::GetClientCallTracer(
+    const Slice& path, bool /*registered_method*/,
+    std::shared_ptr<ScopeConfig> /*scope_config*/) {
+  return GetContext<Arena>()->ManagedNew<CallTracer>(
+      GetMethodRecorder(path.as_string_view()));
+}
+
+InProcessStatsPlugin::MethodRecorder* InProcessStatsPlugin::GetMethodRecorder(
+    absl::string_view method) {
+  MutexLock lock(&mu_);
+  auto it = methods_.find(method);
+  if (it != methods_.end()) return it->second.get();
+  if (methods_.size() >= kMaxMethods) method = kOtherMethod;
+  auto& recorder = methods_[method];
+  if (recorder == nullptr) recorder = std::make_unique<MethodRecorder>();
+  return recorder.get();
+}
+
+}  // namespace grpc_core
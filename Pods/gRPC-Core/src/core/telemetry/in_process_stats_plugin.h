@@ -0,0 +1,163 @@
+// Copyright 2024 The gRPC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GRPC_SRC_CORE_TELEMETRY_IN_PROCESS_STATS_PLUGIN_H
+#define GRPC_SRC_CORE_TELEMETRY_IN_PROCESS_STATS_PLUGIN_H
+
+#include <grpc/support/port_platform.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "src/core/lib/channel/channel_args.h"
+#include "src/core/lib/slice/slice.h"
+#include "src/core/telemetry/call_tracer.h"
+#include "src/core/telemetry/histogram_view.h"
+#include "src/core/telemetry/metrics.h"
+#include "src/core/util/sync.h"
+
+namespace grpc_core {
+
+// A stats plugin that keeps per-method client histograms in memory, for
+// processes that cannot export metrics through OpenTelemetry. It records,
+// for each method:
+// - the latency of each call, from its start to the end of its last attempt
+// - the number of attempts each call made, whether retries or hedges
+// - the size of each message sent and received
+// - how long the transport held each attempt's outgoing data before its last
+//   byte was written, which includes any wait for flow control
+//
+// Each call takes a lock once, to find its method; recording into the
+// histograms is lock-free.
+class InProcessStatsPlugin final : public StatsPlugin {
+ public:
+  // Power-of-two buckets: bucket 0 holds 0, and bucket i holds values in
+  // [2^(i-1), 2^i), with larger values in the last bucket.
+  static constexpr int kNumBuckets = 26;
+
+  class Histogram {
+   public:
+    HistogramView view() const;
+    uint64_t count() const;
+
+   private:
+    friend class InProcessStatsPlugin;
+
+    uint64_t buckets_[kNumBuckets]{};
+  };
+
+  struct MethodStats {
+    Histogram latency_ms;
+    Histogram attempts;
+    Histogram sent_message_bytes;
+    Histogram received_message_bytes;
+    Histogram transport_send_ms;
+  };
+
+  // Registers the plugin with the GlobalStatsPluginRegistry on first use.
+  // Only channels created afterwards are recorded.
+  static InProcessStatsPlugin& Get();
+
+  // Returns the stats recorded so far, by method. Past a limit on distinct
+  // methods, the rest are recorded under "other".
+  std::map<std::string, MethodStats> Snapshot() const;
+
+  // StatsPlugin implementation.
+  std::pair<bool, std::shared_ptr<ScopeConfig>> IsEnabledForChannel(
+      const experimental::StatsPluginChannelScope& /*scope*/) const override {
+    return {true, nullptr};
+  }
+  std::pair<bool, std::shared_ptr<ScopeConfig>> IsEnabledForServer(
+      const ChannelArgs& /*args*/) const override {
+    return {false, nullptr};
+  }
+  std::shared_ptr<ScopeConfig> GetChannelScopeConfig(
+      const experimental::StatsPluginChannelScope& /*scope*/) const override {
+    return nullptr;
+  }
+  std::shared_ptr<ScopeConfig> GetServerScopeConfig(
+      const ChannelArgs& /*args*/) const override {
+    return nullptr;
+  }
+  // Instruments registered with the GlobalInstrumentsRegistry are left to
+  // other plugins.
+  void AddCounter(
+      GlobalInstrumentsRegistry::GlobalInstrumentHandle /*handle*/,
+      uint64_t /*value*/, absl::Span<const absl::string_view> /*label_values*/,
+      absl::Span<const absl::string_view> /*optional_values*/) override {}
+  void AddCounter(
+      GlobalInstrumentsRegistry::GlobalInstrumentHandle /*handle*/,
+      double /*value*/, absl::Span<const absl::string_view> /*label_values*/,
+      absl::Span<const absl::string_view> /*optional_values*/) override {}
+  void RecordHistogram(
+      GlobalInstrumentsRegistry::GlobalInstrumentHandle /*handle*/,
+      uint64_t /*value*/, absl::Span<const absl::string_view> /*label_values*/,
+      absl::Span<const absl::string_view> /*optional_values*/) override {}
+  void RecordHistogram(
+      GlobalInstrumentsRegistry::GlobalInstrumentHandle /*handle*/,
+      double /*value*/, absl::Span<const absl::string_view> /*label_values*/,
+      absl::Span<const absl::string_view> /*optional_values*/) override {}
+  void AddCallback(RegisteredMetricCallback* /*callback*/) override {}
+  void RemoveCallback(RegisteredMetricCallback* /*callback*/) override {}
+  bool IsInstrumentEnabled(
+      GlobalInstrumentsRegistry::GlobalInstrumentHandle /*handle*/)
+      const override {
+    return false;
+  }
+  ClientCallTracer* GetClientCallTracer(
+      const Slice& path, bool registered_method,
+      std::shared_ptr<ScopeConfig> scope_config) override;
+  ServerCallTracer* GetServerCallTracer(
+      std::shared_ptr<ScopeConfig> /*scope_config*/) override {
+    return nullptr;
+  }
+
+ private:
+  class HistogramRecorder {
+   public:
+    void Record(int64_t value);
+    void Collect(Histogram* histogram) const;
+
+   private:
+    std::atomic<uint64_t> buckets_[kNumBuckets]{};
+  };
+
+  struct MethodRecorder {
+    HistogramRecorder latency_ms;
+    HistogramRecorder attempts;
+    HistogramRecorder sent_message_bytes;
+    HistogramRecorder received_message_bytes;
+    HistogramRecorder transport_send_ms;
+  };
+
+  class CallTracer;
+
+  MethodRecorder* GetMethodRecorder(absl::string_view method);
+
+  mutable Mutex mu_;
+  absl::flat_hash_map<std::string, std::unique_ptr<MethodRecorder>> methods_
+      ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace grpc_core
+
+#endif  // GRPC_SRC_CORE_TELEMETRY_IN_PROCESS_STATS_PLUGIN_H
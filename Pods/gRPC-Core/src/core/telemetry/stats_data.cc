@@ -232,6 +232,8 @@ const absl::string_view
         "work_serializer_work_time_ms",
         "work_serializer_work_time_per_item_ms",
         "work_serializer_items_per_run",
+        "work_serializer_queue_latency_ms",
+        "mutex_contention_wait_us",
         "chaotic_good_sendmsgs_per_write_control",
         "chaotic_good_recvmsgs_per_read_control",
         "chaotic_good_sendmsgs_per_write_data",
@@ -276,6 +278,10 @@ const absl::string_view GlobalStats::histogram_doc[static_cast<int>(
     "work",
     "How long do individual items take to process in work serializers",
     "How many callbacks are executed when a work serializer runs",
+    "How many milliseconds callbacks wait in work serializer queues before "
+    "they run",
+    "How many microseconds threads waited for contended mutexes, for the "
+    "contentions sampled while mutex contention profiling is enabled",
     "Number of sendmsgs per control channel endpoint write",
     "Number of recvmsgs per control channel endpoint read",
     "Number of sendmsgs per data channel endpoint write",
@@ -601,6 +607,12 @@ HistogramView GlobalStats::histogram(Histogram which) const {
     case Histogram::kWorkSerializerItemsPerRun:
       return HistogramView{&Histogram_10000_20::BucketFor, kStatsTable10, 20,
                            work_serializer_items_per_run.buckets()};
+    case Histogram::kWorkSerializerQueueLatencyMs:
+      return HistogramView{&Histogram_100000_20::BucketFor, kStatsTable0, 20,
+                           work_serializer_queue_latency_ms.buckets()};
+    case Histogram::kMutexContentionWaitUs:
+      return HistogramView{&Histogram_100000_20::BucketFor, kStatsTable0, 20,
+                           mutex_contention_wait_us.buckets()};
     case Histogram::kChaoticGoodSendmsgsPerWriteControl:
       return HistogramView{&Histogram_100_20::BucketFor, kStatsTable4, 20,
                            chaotic_good_sendmsgs_per_write_control.buckets()};
@@ -754,6 +766,9 @@ std::unique_ptr<GlobalStats> GlobalStatsCollector::Collect() const {
         &result->work_serializer_work_time_per_item_ms);
     data.work_serializer_items_per_run.Collect(
         &result->work_serializer_items_per_run);
+    data.work_serializer_queue_latency_ms.Collect(
+        &result->work_serializer_queue_latency_ms);
+    data.mutex_contention_wait_us.Collect(&result->mutex_contention_wait_us);
     data.chaotic_good_sendmsgs_per_write_control.Collect(
         &result->chaotic_good_sendmsgs_per_write_control);
     data.chaotic_good_recvmsgs_per_read_control.Collect(
@@ -887,6 +902,10 @@ std::unique_ptr<GlobalStats> GlobalStats::Diff(const GlobalStats& other) const {
       other.work_serializer_work_time_per_item_ms;
   result->work_serializer_items_per_run =
       work_serializer_items_per_run - other.work_serializer_items_per_run;
+  result->work_serializer_queue_latency_ms =
+      work_serializer_queue_latency_ms - other.work_serializer_queue_latency_ms;
+  result->mutex_contention_wait_us =
+      mutex_contention_wait_us - other.mutex_contention_wait_us;
   result->chaotic_good_sendmsgs_per_write_control =
       chaotic_good_sendmsgs_per_write_control -
       other.chaotic_good_sendmsgs_per_write_control;
@@ -18,8 +18,11 @@
 
 #include "src/core/tsi/ssl/session_cache/ssl_session_cache.h"
 
+#include <grpc/slice.h>
 #include <grpc/support/port_platform.h>
 #include <grpc/support/string_util.h>
+#include <stdint.h>
+#include <time.h>
 
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -30,6 +33,33 @@
 
 namespace tsi {
 
+namespace {
+
+grpc_slice SerializeSession(SSL_SESSION* session) {
+  const int length = i2d_SSL_SESSION(session, nullptr);
+  if (length <= 0) return grpc_empty_slice();
+  grpc_slice serialized = GRPC_SLICE_MALLOC(static_cast<size_t>(length));
+  uint8_t* data = GRPC_SLICE_START_PTR(serialized);
+  i2d_SSL_SESSION(session, &data);
+  return serialized;
+}
+
+// Returns null if \a serialized does not hold a session that can still be
+// resumed.
+SslSessionPtr DeserializeSession(const grpc_slice& serialized) {
+  const uint8_t* data = GRPC_SLICE_START_PTR(serialized);
+  SslSessionPtr session(d2i_SSL_SESSION(
+      nullptr, &data, static_cast<long>(GRPC_SLICE_LENGTH(serialized))));
+  if (session == nullptr) return nullptr;
+  const int64_t expiry =
+      static_cast<int64_t>(SSL_SESSION_get_time(session.get())) +
+      static_cast<int64_t>(SSL_SESSION_get_timeout(session.get()));
+  if (expiry <= static_cast<int64_t>(time(nullptr))) return nullptr;
+  return session;
+}
+
+}  // namespace
+
 /// Node for single cached session.
 class SslSessionLRUCache::Node {
  public:
@@ -68,6 +98,13 @@ SslSessionLRUCache::SslSessionLRUCache(size_t capacity) : capacity_(capacity) {
   }
 }
 
+SslSessionLRUCache::SslSessionLRUCache(size_t capacity,
+                                       grpc_ssl_session_store store)
+    : capacity_(capacity), store_(store) {
+  CHECK(store.load != nullptr);
+  CHECK(store.store != nullptr);
+}
+
 SslSessionLRUCache::~SslSessionLRUCache() {
   Node* node = use_order_list_head_;
   while (node) {
@@ -75,6 +112,9 @@ SslSessionLRUCache::~SslSessionLRUCache() {
     delete node;
     node = next;
   }
+  if (store_.has_value() && store_->destroy != nullptr) {
+    store_->destroy(store_->user_data);
+  }
 }
 
 size_t SslSessionLRUCache::Size() {
@@ -101,7 +141,20 @@ void SslSessionLRUCache::Put(const char* key, SslSessionPtr session) {
     LOG(ERROR) << "Attempted to put null SSL session in session cache.";
     return;
   }
-  grpc_core::MutexLock lock(&lock_);
+  grpc_slice serialized = store_.has_value() ? SerializeSession(session.get())
+                                             : grpc_empty_slice();
+  {
+    grpc_core::MutexLock lock(&lock_);
+    InsertLocked(key, std::move(session));
+  }
+  if (!GRPC_SLICE_IS_EMPTY(serialized)) {
+    store_->store(store_->user_data, key, serialized);
+  }
+  grpc_slice_unref(serialized);
+}
+
+void SslSessionLRUCache::InsertLocked(const std::string& key,
+                                      SslSessionPtr session) {
   Node* node = FindLocked(key);
   if (node != nullptr) {
     node->SetSession(std::move(session));
@@ -123,13 +176,34 @@ void SslSessionLRUCache::Put(const char* key, SslSessionPtr session) {
 }
 
 SslSessionPtr SslSessionLRUCache::Get(const char* key) {
+  {
+    grpc_core::MutexLock lock(&lock_);
+    // Key is only used for lookups.
+    Node* node = FindLocked(key);
+    if (node != nullptr) {
+      return node->CopySession();
+    }
+  }
+  if (!store_.has_value()) {
+    return nullptr;
+  }
+  grpc_slice serialized = store_->load(store_->user_data, key);
+  SslSessionPtr session = GRPC_SLICE_IS_EMPTY(serialized)
+                              ? nullptr
+                              : DeserializeSession(serialized);
+  grpc_slice_unref(serialized);
+  if (session == nullptr) {
+    return nullptr;
+  }
   grpc_core::MutexLock lock(&lock_);
-  // Key is only used for lookups.
+  // A concurrent Put may have added a newer session meanwhile.
   Node* node = FindLocked(key);
   if (node == nullptr) {
-    return nullptr;
+    InsertLocked(key, std::move(session));
+    node = FindLocked(key);
   }
-  return node->CopySession();
+  // The node is gone if the capacity is zero.
+  return node != nullptr ? node->CopySession() : nullptr;
 }
 
 void SslSessionLRUCache::Remove(SslSessionLRUCache::Node* node) {
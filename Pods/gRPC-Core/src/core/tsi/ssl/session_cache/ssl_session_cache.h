@@ -19,6 +19,7 @@
 #ifndef GRPC_SRC_CORE_TSI_SSL_SESSION_CACHE_SSL_SESSION_CACHE_H
 #define GRPC_SRC_CORE_TSI_SSL_SESSION_CACHE_SSL_SESSION_CACHE_H
 
+#include <grpc/credentials.h>
 #include <grpc/impl/grpc_types.h>
 #include <grpc/slice.h>
 #include <grpc/support/port_platform.h>
@@ -30,6 +31,9 @@
 #endif
 
 #include <map>
+#include <string>
+
+#include "absl/types/optional.h"
 
 #include "src/core/tsi/ssl/session_cache/ssl_session.h"
 #include "src/core/util/cpp_impl_of.h"
@@ -44,6 +48,10 @@
 /// name. Note that servers are required to share session ticket encryption keys
 /// in order for cache to be effective.
 ///
+/// If a grpc_ssl_session_store is given, new sessions are also written to it,
+/// and sessions missing from the cache are looked up there, so that they
+/// survive process restarts. Expired sessions from the store are ignored.
+///
 /// This class is thread safe.
 
 namespace tsi {
@@ -57,9 +65,15 @@ class SslSessionLRUCache
   static grpc_core::RefCountedPtr<SslSessionLRUCache> Create(size_t capacity) {
     return grpc_core::MakeRefCounted<SslSessionLRUCache>(capacity);
   }
+  /// Create new LRU cache with the given capacity, backed by \a store.
+  static grpc_core::RefCountedPtr<SslSessionLRUCache> Create(
+      size_t capacity, grpc_ssl_session_store store) {
+    return grpc_core::MakeRefCounted<SslSessionLRUCache>(capacity, store);
+  }
 
   // Use Create function instead of using this directly.
   explicit SslSessionLRUCache(size_t capacity);
+  SslSessionLRUCache(size_t capacity, grpc_ssl_session_store store);
   ~SslSessionLRUCache() override;
 
   // Not copyable nor movable.
@@ -83,12 +97,15 @@ class SslSessionLRUCache
   class Node;
 
   Node* FindLocked(const std::string& key);
+  void InsertLocked(const std::string& key, SslSessionPtr session);
   void Remove(Node* node);
   void PushFront(Node* node);
   void AssertInvariants();
 
   grpc_core::Mutex lock_;
   size_t capacity_;
+  // Only accessed outside lock_, since its functions may block.
+  const absl::optional<grpc_ssl_session_store> store_;
 
   Node* use_order_list_head_ = nullptr;
   Node* use_order_list_tail_ = nullptr;
@@ -84,29 +84,49 @@
   #include <openssl/x509v3.h>
 #endif
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "src/core/lib/event_engine/default_event_engine.h"
 #include "src/core/lib/security/credentials/tls/grpc_tls_crl_provider.h"
+#include "src/core/lib/slice/slice.h"
 #include "src/core/tsi/ssl/key_logging/ssl_key_logging.h"
 #include "src/core/tsi/ssl/session_cache/ssl_session_cache.h"
 #include "src/core/tsi/ssl_transport_security_utils.h"
 #include "src/core/tsi/ssl_types.h"
 #include "src/core/tsi/transport_security.h"
+#include "src/core/tsi/transport_security_grpc.h"
 #include "src/core/util/crash.h"
 #include "src/core/util/useful.h"
 
 // --- Constants. ---
 
 #define TSI_SSL_MAX_BIO_WRITE_ATTEMPTS 100
-#define TSI_SSL_MAX_PROTECTED_FRAME_SIZE_UPPER_BOUND 16384
+// A protected frame may span several TLS records, each of which holds up to
+// TSI_SSL_MAX_RECORD_PLAINTEXT_SIZE bytes. Frames default to a single record.
+#define TSI_SSL_MAX_RECORD_PLAINTEXT_SIZE 16384
+#define TSI_SSL_DEFAULT_PROTECTED_FRAME_SIZE TSI_SSL_MAX_RECORD_PLAINTEXT_SIZE
+#define TSI_SSL_MAX_PROTECTED_FRAME_SIZE_UPPER_BOUND \
+  (4 * TSI_SSL_MAX_RECORD_PLAINTEXT_SIZE)
 #define TSI_SSL_MAX_PROTECTED_FRAME_SIZE_LOWER_BOUND 1024
 #define TSI_SSL_HANDSHAKER_OUTGOING_BUFFER_INITIAL_SIZE 1024
+// Slices at least this large are passed to SSL_write in place. Smaller ones
+// are copied together first.
+#define TSI_SSL_ZERO_COPY_COALESCE_BUFFER_SIZE 1024
+// The size of the slices SSL_read decrypts into.
+#define TSI_SSL_ZERO_COPY_READ_SLICE_SIZE TSI_SSL_MAX_RECORD_PLAINTEXT_SIZE
+// How many key shares of each group are generated ahead of handshakes. Each
+// one costs a key generation whether or not a handshake ends up using it.
+#define TSI_SSL_PREGENERATED_KEY_SHARES 2
 const size_t kMaxChainLength = 100;
 
 // Putting a macro like this and littering the source file with #if is really
@@ -118,6 +138,7 @@ const size_t kMaxChainLength = 100;
 
 // TODO(jboeuf): I have not found a way to get this number dynamically from the
 // SSL structure. This is what we would ultimately want though...
+// This is the overhead of a single TLS record.
 #define TSI_SSL_MAX_PROTECTION_OVERHEAD 100
 
 using TlsSessionKeyLogger = tsi::TlsSessionKeyLoggerCache::TlsSessionKeyLogger;
@@ -140,6 +161,10 @@ struct tsi_ssl_client_handshaker_factory {
   size_t alpn_protocol_list_length;
   grpc_core::RefCountedPtr<tsi::SslSessionLRUCache> session_cache;
   grpc_core::RefCountedPtr<TlsSessionKeyLogger> key_logger;
+  // The groups of the key shares that the ClientHello carries, for which key
+  // shares are generated ahead of handshakes.
+  uint16_t pregenerated_key_share_groups[2];
+  size_t num_pregenerated_key_share_groups;
 };
 
 struct tsi_ssl_server_handshaker_factory {
@@ -179,11 +204,25 @@ struct tsi_ssl_frame_protector {
   size_t buffer_size;
   size_t buffer_offset;
 };
+struct tsi_ssl_zero_copy_grpc_protector {
+  tsi_zero_copy_grpc_protector base;
+  SSL* ssl;
+  BIO* network_io;
+  size_t max_frame_size;
+  // The most plaintext a single SSL_write may take.
+  size_t max_plaintext_size;
+  // Small slices are gathered here so that they do not each become a record.
+  unsigned char* coalesce_buffer;
+  size_t coalesce_buffer_offset;
+  // The unused tail of the last slice SSL_read wrote into.
+  grpc_slice read_slice;
+};
 // --- Library Initialization. ---
 
 static gpr_once g_init_openssl_once = GPR_ONCE_INIT;
 static int g_ssl_ctx_ex_factory_index = -1;
 static int g_ssl_ctx_ex_crl_provider_index = -1;
+static int g_ssl_ctx_ex_verified_chain_cache_index = -1;
 static const unsigned char kSslSessionIdContext[] = {'g', 'r', 'p', 'c'};
 static int g_ssl_ex_verified_root_cert_index = -1;
 #if !defined(OPENSSL_IS_BORINGSSL) && !defined(OPENSSL_NO_ENGINE)
@@ -218,6 +257,14 @@ static void verified_root_cert_free(void* /*parent*/, void* ptr,
   X509_free(static_cast<X509*>(ptr));
 }
 
+#if OPENSSL_VERSION_NUMBER >= 0x10100000 && !defined(LIBRESSL_VERSION_NUMBER)
+static void verified_chain_cache_free(void* /*parent*/, void* ptr,
+                                      CRYPTO_EX_DATA* /*ad*/, int /*index*/,
+                                      long /*argl*/, void* /*argp*/) {
+  delete static_cast<grpc_core::VerifiedChainCache*>(ptr);
+}
+#endif
+
 static void init_openssl(void) {
 #if OPENSSL_VERSION_NUMBER >= 0x10100000
   OPENSSL_init_ssl(0, nullptr);
@@ -254,6 +301,12 @@ static void init_openssl(void) {
       SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
   CHECK_NE(g_ssl_ctx_ex_crl_provider_index, -1);
 
+#if OPENSSL_VERSION_NUMBER >= 0x10100000 && !defined(LIBRESSL_VERSION_NUMBER)
+  g_ssl_ctx_ex_verified_chain_cache_index = SSL_CTX_get_ex_new_index(
+      0, nullptr, nullptr, nullptr, verified_chain_cache_free);
+  CHECK_NE(g_ssl_ctx_ex_verified_chain_cache_index, -1);
+#endif
+
   g_ssl_ex_verified_root_cert_index = SSL_get_ex_new_index(
       0, nullptr, nullptr, nullptr, verified_root_cert_free);
   CHECK_NE(g_ssl_ex_verified_root_cert_index, -1);
@@ -817,11 +870,20 @@ static tsi_result ssl_ctx_load_verification_certs(SSL_CTX* context,
                                root_name);
 }
 
+// Returns the cipher list to configure on an SSL_CTX, reordered for this
+// machine's AES support if requested.
+static std::string ssl_cipher_list_for_context(const char* cipher_suites,
+                                               bool prefer_hardware_ciphers) {
+  if (!prefer_hardware_ciphers) return cipher_suites;
+  return grpc_core::PreferHardwareCiphers(cipher_suites,
+                                          grpc_core::SslHasAesHardware());
+}
+
 // Populates the SSL context with a private key and a cert chain, and sets the
-// cipher list and the ephemeral ECDH key.
+// cipher list and the ephemeral ECDH key, or the key exchange groups if given.
 static tsi_result populate_ssl_context(
     SSL_CTX* context, const tsi_ssl_pem_key_cert_pair* key_cert_pair,
-    const char* cipher_list) {
+    const char* cipher_list, const char* key_exchange_groups) {
   tsi_result result = TSI_OK;
   if (key_cert_pair != nullptr) {
     if (key_cert_pair->cert_chain != nullptr) {
@@ -862,11 +924,50 @@ static tsi_result populate_ssl_context(
       return TSI_INTERNAL_ERROR;
     }
     SSL_CTX_set_options(context, SSL_OP_SINGLE_ECDH_USE);
+#endif
+  }
+  if (key_exchange_groups != nullptr) {
+#if OPENSSL_VERSION_NUMBER >= 0x10100000
+    if (!SSL_CTX_set1_groups_list(context, key_exchange_groups)) {
+      LOG(ERROR) << "Invalid key exchange groups: " << key_exchange_groups;
+      return TSI_INVALID_ARGUMENT;
+    }
+#else
+    LOG(ERROR) << "Key exchange groups require OpenSSL 1.1 or later.";
+    return TSI_UNIMPLEMENTED;
 #endif
   }
   return TSI_OK;
 }
 
+// Tops up BoringSSL's pools of pre-generated key shares for the groups that the
+// factory's ClientHello offers, on a background thread. Only one refill runs at
+// a time, as the pools are shared by the whole process.
+static void ssl_client_handshaker_factory_pregenerate_key_shares(
+    const tsi_ssl_client_handshaker_factory* factory) {
+#if defined(OPENSSL_IS_BORINGSSL)
+  static std::atomic<bool> refill_pending{false};
+  if (factory->num_pregenerated_key_share_groups == 0 ||
+      refill_pending.exchange(true)) {
+    return;
+  }
+  std::vector<uint16_t> group_ids(
+      factory->pregenerated_key_share_groups,
+      factory->pregenerated_key_share_groups +
+          factory->num_pregenerated_key_share_groups);
+  grpc_event_engine::experimental::GetDefaultEventEngine()->Run(
+      [group_ids = std::move(group_ids)]() {
+        for (uint16_t group_id : group_ids) {
+          SSL_pregenerate_key_shares(group_id,
+                                     TSI_SSL_PREGENERATED_KEY_SHARES);
+        }
+        refill_pending.store(false);
+      });
+#else
+  (void)factory;
+#endif
+}
+
 // Extracts the CN and the SANs from an X509 cert as a peer object.
 tsi_result tsi_ssl_extract_x509_subject_names_from_pem_cert(
     const char* pem_cert, tsi_peer* peer) {
@@ -949,32 +1050,9 @@ static int NullVerifyCallback(X509_STORE_CTX* /*ctx*/, void* /*arg*/) {
   return 1;
 }
 
-static int RootCertExtractCallback(X509_STORE_CTX* ctx, void* /*arg*/) {
-  int ret = 1;
-  // Verification was successful. Get the verified chain from the X509_STORE_CTX
-  // and put the root on the SSL object so that we have access to it when
-  // populating the tsi_peer. On error extracting the root, we return success
-  // anyway and proceed with the connection, to preserve the behavior of an
-  // older version of this code.
-#if OPENSSL_VERSION_NUMBER >= 0x10100000
-  STACK_OF(X509)* chain = X509_STORE_CTX_get0_chain(ctx);
-#else
-  STACK_OF(X509)* chain = X509_STORE_CTX_get_chain(ctx);
-#endif
-  if (chain == nullptr) {
-    return ret;
-  }
-
-  // The root cert is the last in the chain
-  size_t chain_length = sk_X509_num(chain);
-  if (chain_length == 0) {
-    return ret;
-  }
-  X509* root_cert = sk_X509_value(chain, chain_length - 1);
-  if (root_cert == nullptr) {
-    return ret;
-  }
-
+// Puts |root_cert| on the SSL object of |ctx|, taking a new reference to it,
+// so that we have access to it when populating the tsi_peer.
+static void SaveVerifiedRootCert(X509_STORE_CTX* ctx, X509* root_cert) {
   ERR_clear_error();
   int ssl_index = SSL_get_ex_data_X509_STORE_CTX_idx();
   if (ssl_index < 0) {
@@ -982,11 +1060,11 @@ static int RootCertExtractCallback(X509_STORE_CTX* ctx, void* /*arg*/) {
     ERR_error_string_n(ERR_get_error(), err_str, sizeof(err_str));
     LOG(ERROR) << "error getting the SSL index from the X509_STORE_CTX: "
                << err_str;
-    return ret;
+    return;
   }
   SSL* ssl = static_cast<SSL*>(X509_STORE_CTX_get_ex_data(ctx, ssl_index));
   if (ssl == nullptr) {
-    return ret;
+    return;
   }
 
   // Free the old root and save the new one. There should not be an old root,
@@ -1008,6 +1086,33 @@ static int RootCertExtractCallback(X509_STORE_CTX* ctx, void* /*arg*/) {
     CRYPTO_add(&root_cert->references, 1, CRYPTO_LOCK_X509);
 #endif
   }
+}
+
+static int RootCertExtractCallback(X509_STORE_CTX* ctx, void* /*arg*/) {
+  int ret = 1;
+  // Verification was successful. Get the verified chain from the X509_STORE_CTX
+  // and put the root on the SSL object. On error extracting the root, we
+  // return success anyway and proceed with the connection, to preserve the
+  // behavior of an older version of this code.
+#if OPENSSL_VERSION_NUMBER >= 0x10100000
+  STACK_OF(X509)* chain = X509_STORE_CTX_get0_chain(ctx);
+#else
+  STACK_OF(X509)* chain = X509_STORE_CTX_get_chain(ctx);
+#endif
+  if (chain == nullptr) {
+    return ret;
+  }
+
+  // The root cert is the last in the chain
+  size_t chain_length = sk_X509_num(chain);
+  if (chain_length == 0) {
+    return ret;
+  }
+  X509* root_cert = sk_X509_value(chain, chain_length - 1);
+  if (root_cert == nullptr) {
+    return ret;
+  }
+  SaveVerifiedRootCert(ctx, root_cert);
   return ret;
 }
 
@@ -1036,6 +1141,20 @@ static grpc_core::experimental::CrlProvider* GetCrlProvider(
   return provider;
 }
 
+#if OPENSSL_VERSION_NUMBER >= 0x10100000 && !defined(LIBRESSL_VERSION_NUMBER)
+// Returns the verified chain cache of the SSL_CTX that |ctx| verifies for, or
+// nullptr if the context does not cache verification results.
+static grpc_core::VerifiedChainCache* GetVerifiedChainCache(
+    X509_STORE_CTX* ctx) {
+  int ssl_index = SSL_get_ex_data_X509_STORE_CTX_idx();
+  if (ssl_index < 0) return nullptr;
+  SSL* ssl = static_cast<SSL*>(X509_STORE_CTX_get_ex_data(ctx, ssl_index));
+  if (ssl == nullptr) return nullptr;
+  return static_cast<grpc_core::VerifiedChainCache*>(SSL_CTX_get_ex_data(
+      SSL_get_SSL_CTX(ssl), g_ssl_ctx_ex_verified_chain_cache_index));
+}
+#endif
+
 // If a CRL is returned, the caller is the owner of the CRL and must make sure
 // it is freed.
 static absl::StatusOr<X509_CRL*> GetCrlFromProvider(
@@ -1187,8 +1306,22 @@ static int CheckChainRevocation(
 // (X509_verify_cert), then also extracts the root certificate in the built
 // chain and does revocation checks when a user has configured CrlProviders.
 // returns 1 on success, indicating a trusted chain to a root of trust was
-// found, 0 if a trusted chain could not be built.
+// found, 0 if a trusted chain could not be built. Chains that were accepted
+// before are not verified again when the SSL_CTX has a verified chain cache.
 static int CustomVerificationFunction(X509_STORE_CTX* ctx, void* arg) {
+#if OPENSSL_VERSION_NUMBER >= 0x10100000 && !defined(LIBRESSL_VERSION_NUMBER)
+  grpc_core::VerifiedChainCache* cache = GetVerifiedChainCache(ctx);
+  std::string cache_key;
+  if (cache != nullptr) {
+    cache_key = grpc_core::VerifiedChainCache::ChainKey(ctx);
+    X509* root_cert = cache_key.empty() ? nullptr : cache->Lookup(cache_key);
+    if (root_cert != nullptr) {
+      SaveVerifiedRootCert(ctx, root_cert);
+      X509_free(root_cert);
+      return 1;
+    }
+  }
+#endif
   int ret = X509_verify_cert(ctx);
   if (ret <= 0) {
     VLOG(2) << "Failed to verify cert chain.";
@@ -1205,6 +1338,11 @@ static int CustomVerificationFunction(X509_STORE_CTX* ctx, void* arg) {
       return ret;
     }
   }
+#if OPENSSL_VERSION_NUMBER >= 0x10100000 && !defined(LIBRESSL_VERSION_NUMBER)
+  if (cache != nullptr && !cache_key.empty()) {
+    cache->Insert(cache_key, ctx);
+  }
+#endif
   return RootCertExtractCallback(ctx, arg);
 }
 
@@ -1313,6 +1451,12 @@ tsi_ssl_session_cache* tsi_ssl_session_cache_create_lru(size_t capacity) {
   return tsi::SslSessionLRUCache::Create(capacity).release()->c_ptr();
 }
 
+tsi_ssl_session_cache* tsi_ssl_session_cache_create_lru_with_store(
+    size_t capacity, grpc_ssl_session_store store) {
+  // Pointer will be dereferenced by unref call.
+  return tsi::SslSessionLRUCache::Create(capacity, store).release()->c_ptr();
+}
+
 void tsi_ssl_session_cache_ref(tsi_ssl_session_cache* cache) {
   // Pointer will be dereferenced by unref call.
   tsi::SslSessionLRUCache::FromC(cache)->Ref().release();
@@ -1376,6 +1520,187 @@ static const tsi_frame_protector_vtable frame_protector_vtable = {
     ssl_protector_destroy,
 };
 
+// --- tsi_zero_copy_grpc_protector methods implementation. ---
+
+// Moves the records SSL has written to the BIO pair into protected_slices.
+static tsi_result ssl_zero_copy_protector_drain(
+    tsi_ssl_zero_copy_grpc_protector* impl,
+    grpc_slice_buffer* protected_slices) {
+  size_t pending = BIO_pending(impl->network_io);
+  if (pending == 0) return TSI_OK;
+  CHECK_LE(pending, static_cast<size_t>(INT_MAX));
+  grpc_slice slice = GRPC_SLICE_MALLOC(pending);
+  int read_from_ssl = BIO_read(impl->network_io, GRPC_SLICE_START_PTR(slice),
+                               static_cast<int>(pending));
+  if (read_from_ssl != static_cast<int>(pending)) {
+    LOG(ERROR) << "Could not read from BIO after SSL_write.";
+    grpc_core::CSliceUnref(slice);
+    return TSI_INTERNAL_ERROR;
+  }
+  grpc_slice_buffer_add(protected_slices, slice);
+  return TSI_OK;
+}
+
+// Seals bytes with SSL_write straight from the caller's memory, a frame at a
+// time so that the records always fit in the BIO pair.
+static tsi_result ssl_zero_copy_protector_write(
+    tsi_ssl_zero_copy_grpc_protector* impl, const unsigned char* bytes,
+    size_t size, grpc_slice_buffer* protected_slices) {
+  while (size > 0) {
+    size_t to_write = std::min(size, impl->max_plaintext_size);
+    tsi_result result = grpc_core::DoSslWrite(
+        impl->ssl, const_cast<unsigned char*>(bytes), to_write);
+    if (result != TSI_OK) return result;
+    result = ssl_zero_copy_protector_drain(impl, protected_slices);
+    if (result != TSI_OK) return result;
+    bytes += to_write;
+    size -= to_write;
+  }
+  return TSI_OK;
+}
+
+static tsi_result ssl_zero_copy_protector_flush_coalesced(
+    tsi_ssl_zero_copy_grpc_protector* impl,
+    grpc_slice_buffer* protected_slices) {
+  if (impl->coalesce_buffer_offset == 0) return TSI_OK;
+  tsi_result result =
+      ssl_zero_copy_protector_write(impl, impl->coalesce_buffer,
+                                    impl->coalesce_buffer_offset,
+                                    protected_slices);
+  impl->coalesce_buffer_offset = 0;
+  return result;
+}
+
+static tsi_result ssl_zero_copy_grpc_protector_protect(
+    tsi_zero_copy_grpc_protector* self, grpc_slice_buffer* unprotected_slices,
+    grpc_slice_buffer* protected_slices) {
+  if (self == nullptr || unprotected_slices == nullptr ||
+      protected_slices == nullptr) {
+    return TSI_INVALID_ARGUMENT;
+  }
+  tsi_ssl_zero_copy_grpc_protector* impl =
+      reinterpret_cast<tsi_ssl_zero_copy_grpc_protector*>(self);
+  tsi_result result = TSI_OK;
+  for (size_t i = 0; i < unprotected_slices->count && result == TSI_OK; i++) {
+    const grpc_slice& slice = unprotected_slices->slices[i];
+    const unsigned char* bytes = GRPC_SLICE_START_PTR(slice);
+    size_t size = GRPC_SLICE_LENGTH(slice);
+    if (size <= TSI_SSL_ZERO_COPY_COALESCE_BUFFER_SIZE -
+                    impl->coalesce_buffer_offset) {
+      memcpy(impl->coalesce_buffer + impl->coalesce_buffer_offset, bytes,
+             size);
+      impl->coalesce_buffer_offset += size;
+      continue;
+    }
+    result = ssl_zero_copy_protector_flush_coalesced(impl, protected_slices);
+    if (result != TSI_OK) break;
+    if (size < TSI_SSL_ZERO_COPY_COALESCE_BUFFER_SIZE) {
+      memcpy(impl->coalesce_buffer, bytes, size);
+      impl->coalesce_buffer_offset = size;
+      continue;
+    }
+    result = ssl_zero_copy_protector_write(impl, bytes, size, protected_slices);
+  }
+  if (result == TSI_OK) {
+    result = ssl_zero_copy_protector_flush_coalesced(impl, protected_slices);
+  }
+  grpc_slice_buffer_reset_and_unref(unprotected_slices);
+  return result;
+}
+
+// Decrypts whatever SSL can into slices, with no intermediate buffer, and adds
+// them to unprotected_slices. Sets *progress if anything was decrypted.
+static tsi_result ssl_zero_copy_protector_read(
+    tsi_ssl_zero_copy_grpc_protector* impl,
+    grpc_slice_buffer* unprotected_slices, bool* progress) {
+  for (;;) {
+    if (GRPC_SLICE_LENGTH(impl->read_slice) == 0) {
+      grpc_core::CSliceUnref(impl->read_slice);
+      impl->read_slice = GRPC_SLICE_MALLOC(TSI_SSL_ZERO_COPY_READ_SLICE_SIZE);
+    }
+    size_t read_size = GRPC_SLICE_LENGTH(impl->read_slice);
+    tsi_result result = grpc_core::DoSslRead(
+        impl->ssl, GRPC_SLICE_START_PTR(impl->read_slice), &read_size);
+    if (result != TSI_OK || read_size == 0) return result;
+    *progress = true;
+    grpc_slice_buffer_add(unprotected_slices,
+                          grpc_slice_split_head(&impl->read_slice, read_size));
+  }
+}
+
+static tsi_result ssl_zero_copy_grpc_protector_unprotect(
+    tsi_zero_copy_grpc_protector* self, grpc_slice_buffer* protected_slices,
+    grpc_slice_buffer* unprotected_slices, int* min_progress_size) {
+  if (self == nullptr || unprotected_slices == nullptr ||
+      protected_slices == nullptr) {
+    return TSI_INVALID_ARGUMENT;
+  }
+  tsi_ssl_zero_copy_grpc_protector* impl =
+      reinterpret_cast<tsi_ssl_zero_copy_grpc_protector*>(self);
+  tsi_result result = TSI_OK;
+  for (size_t i = 0; i < protected_slices->count && result == TSI_OK; i++) {
+    const grpc_slice& slice = protected_slices->slices[i];
+    const unsigned char* bytes = GRPC_SLICE_START_PTR(slice);
+    size_t size = GRPC_SLICE_LENGTH(slice);
+    while (size > 0) {
+      size_t to_write = std::min(size, static_cast<size_t>(INT_MAX));
+      int written_into_ssl =
+          BIO_write(impl->network_io, bytes, static_cast<int>(to_write));
+      if (written_into_ssl < 0 && !BIO_should_retry(impl->network_io)) {
+        LOG(ERROR) << "Sending protected frame to ssl failed with "
+                   << written_into_ssl;
+        result = TSI_INTERNAL_ERROR;
+        break;
+      }
+      size_t written = static_cast<size_t>(std::max(written_into_ssl, 0));
+      bytes += written;
+      size -= written;
+      // Reading makes room in the BIO pair for the rest of the slice.
+      bool progress = false;
+      result = ssl_zero_copy_protector_read(impl, unprotected_slices,
+                                            &progress);
+      if (result != TSI_OK) break;
+      if (written == 0 && !progress) {
+        LOG(ERROR) << "No progress writing protected frame to ssl.";
+        result = TSI_INTERNAL_ERROR;
+        break;
+      }
+    }
+  }
+  grpc_slice_buffer_reset_and_unref(protected_slices);
+  if (min_progress_size != nullptr) *min_progress_size = 1;
+  return result;
+}
+
+static void ssl_zero_copy_grpc_protector_destroy(
+    tsi_zero_copy_grpc_protector* self) {
+  if (self == nullptr) return;
+  tsi_ssl_zero_copy_grpc_protector* impl =
+      reinterpret_cast<tsi_ssl_zero_copy_grpc_protector*>(self);
+  gpr_free(impl->coalesce_buffer);
+  grpc_core::CSliceUnref(impl->read_slice);
+  if (impl->ssl != nullptr) SSL_free(impl->ssl);
+  if (impl->network_io != nullptr) BIO_free(impl->network_io);
+  gpr_free(self);
+}
+
+static tsi_result ssl_zero_copy_grpc_protector_max_frame_size(
+    tsi_zero_copy_grpc_protector* self, size_t* max_frame_size) {
+  if (self == nullptr || max_frame_size == nullptr) return TSI_INVALID_ARGUMENT;
+  tsi_ssl_zero_copy_grpc_protector* impl =
+      reinterpret_cast<tsi_ssl_zero_copy_grpc_protector*>(self);
+  *max_frame_size = impl->max_frame_size;
+  return TSI_OK;
+}
+
+static const tsi_zero_copy_grpc_protector_vtable
+    zero_copy_grpc_protector_vtable = {
+        ssl_zero_copy_grpc_protector_protect,
+        ssl_zero_copy_grpc_protector_unprotect,
+        ssl_zero_copy_grpc_protector_destroy,
+        ssl_zero_copy_grpc_protector_max_frame_size,
+};
+
 // --- tsi_server_handshaker_factory methods implementation. ---
 
 static void tsi_ssl_handshaker_factory_destroy(
@@ -1528,27 +1853,29 @@ static tsi_result ssl_handshaker_result_extract_peer(
 static tsi_result ssl_handshaker_result_get_frame_protector_type(
     const tsi_handshaker_result* /*self*/,
     tsi_frame_protector_type* frame_protector_type) {
-  *frame_protector_type = TSI_FRAME_PROTECTOR_NORMAL;
+  *frame_protector_type = TSI_FRAME_PROTECTOR_NORMAL_OR_ZERO_COPY;
   return TSI_OK;
 }
 
-static tsi_result ssl_handshaker_result_create_frame_protector(
-    const tsi_handshaker_result* self, size_t* max_output_protected_frame_size,
-    tsi_frame_protector** protector) {
+// Clamps the requested frame size, if any, and returns the frame size to use
+// for a protector created from impl.
+static size_t ssl_handshaker_result_protected_frame_size(
+    const tsi_ssl_handshaker_result* impl,
+    size_t* max_output_protected_frame_size) {
   size_t actual_max_output_protected_frame_size =
-      TSI_SSL_MAX_PROTECTED_FRAME_SIZE_UPPER_BOUND;
-  tsi_ssl_handshaker_result* impl =
-      reinterpret_cast<tsi_ssl_handshaker_result*>(
-          const_cast<tsi_handshaker_result*>(self));
-  tsi_ssl_frame_protector* protector_impl =
-      static_cast<tsi_ssl_frame_protector*>(
-          gpr_zalloc(sizeof(*protector_impl)));
-
+      TSI_SSL_DEFAULT_PROTECTED_FRAME_SIZE;
   if (max_output_protected_frame_size != nullptr) {
-    if (*max_output_protected_frame_size >
-        TSI_SSL_MAX_PROTECTED_FRAME_SIZE_UPPER_BOUND) {
-      *max_output_protected_frame_size =
-          TSI_SSL_MAX_PROTECTED_FRAME_SIZE_UPPER_BOUND;
+    // Everything one SSL_write produces must fit in the BIO pair, so frames
+    // larger than a record are limited to the whole records that fit in the
+    // buffer the handshaker was created with.
+    size_t bio_records = BIO_ctrl_get_write_guarantee(SSL_get_wbio(impl->ssl)) /
+                         TSI_SSL_MAX_RECORD_PLAINTEXT_SIZE;
+    size_t upper_bound =
+        std::min<size_t>(TSI_SSL_MAX_PROTECTED_FRAME_SIZE_UPPER_BOUND,
+                         std::max<size_t>(bio_records, 1) *
+                             TSI_SSL_MAX_RECORD_PLAINTEXT_SIZE);
+    if (*max_output_protected_frame_size > upper_bound) {
+      *max_output_protected_frame_size = upper_bound;
     } else if (*max_output_protected_frame_size <
                TSI_SSL_MAX_PROTECTED_FRAME_SIZE_LOWER_BOUND) {
       *max_output_protected_frame_size =
@@ -1556,8 +1883,30 @@ static tsi_result ssl_handshaker_result_create_frame_protector(
     }
     actual_max_output_protected_frame_size = *max_output_protected_frame_size;
   }
-  protector_impl->buffer_size =
-      actual_max_output_protected_frame_size - TSI_SSL_MAX_PROTECTION_OVERHEAD;
+  return actual_max_output_protected_frame_size;
+}
+
+// Returns how much plaintext one SSL_write may take so that its output fits in
+// a frame of frame_size bytes, leaving room for the overhead of every record.
+static size_t ssl_protector_max_plaintext_size(size_t frame_size) {
+  size_t num_records =
+      (frame_size + TSI_SSL_MAX_RECORD_PLAINTEXT_SIZE - 1) /
+      TSI_SSL_MAX_RECORD_PLAINTEXT_SIZE;
+  return frame_size - num_records * TSI_SSL_MAX_PROTECTION_OVERHEAD;
+}
+
+static tsi_result ssl_handshaker_result_create_frame_protector(
+    const tsi_handshaker_result* self, size_t* max_output_protected_frame_size,
+    tsi_frame_protector** protector) {
+  tsi_ssl_handshaker_result* impl =
+      reinterpret_cast<tsi_ssl_handshaker_result*>(
+          const_cast<tsi_handshaker_result*>(self));
+  tsi_ssl_frame_protector* protector_impl =
+      static_cast<tsi_ssl_frame_protector*>(
+          gpr_zalloc(sizeof(*protector_impl)));
+  protector_impl->buffer_size = ssl_protector_max_plaintext_size(
+      ssl_handshaker_result_protected_frame_size(
+          impl, max_output_protected_frame_size));
   protector_impl->buffer =
       static_cast<unsigned char*>(gpr_malloc(protector_impl->buffer_size));
   if (protector_impl->buffer == nullptr) {
@@ -1576,6 +1925,31 @@ static tsi_result ssl_handshaker_result_create_frame_protector(
   return TSI_OK;
 }
 
+static tsi_result ssl_handshaker_result_create_zero_copy_grpc_protector(
+    const tsi_handshaker_result* self, size_t* max_output_protected_frame_size,
+    tsi_zero_copy_grpc_protector** protector) {
+  tsi_ssl_handshaker_result* impl =
+      reinterpret_cast<tsi_ssl_handshaker_result*>(
+          const_cast<tsi_handshaker_result*>(self));
+  tsi_ssl_zero_copy_grpc_protector* protector_impl =
+      grpc_core::Zalloc<tsi_ssl_zero_copy_grpc_protector>();
+  protector_impl->max_frame_size = ssl_handshaker_result_protected_frame_size(
+      impl, max_output_protected_frame_size);
+  protector_impl->max_plaintext_size =
+      ssl_protector_max_plaintext_size(protector_impl->max_frame_size);
+  protector_impl->coalesce_buffer = static_cast<unsigned char*>(
+      gpr_malloc(TSI_SSL_ZERO_COPY_COALESCE_BUFFER_SIZE));
+  protector_impl->read_slice = grpc_empty_slice();
+  // Transfer ownership of ssl and network_io to the frame protector.
+  protector_impl->ssl = impl->ssl;
+  impl->ssl = nullptr;
+  protector_impl->network_io = impl->network_io;
+  impl->network_io = nullptr;
+  protector_impl->base.vtable = &zero_copy_grpc_protector_vtable;
+  *protector = &protector_impl->base;
+  return TSI_OK;
+}
+
 static tsi_result ssl_handshaker_result_get_unused_bytes(
     const tsi_handshaker_result* self, const unsigned char** bytes,
     size_t* bytes_size) {
@@ -1598,7 +1972,7 @@ static void ssl_handshaker_result_destroy(tsi_handshaker_result* self) {
 static const tsi_handshaker_result_vtable handshaker_result_vtable = {
     ssl_handshaker_result_extract_peer,
     ssl_handshaker_result_get_frame_protector_type,
-    nullptr,  // create_zero_copy_grpc_protector
+    ssl_handshaker_result_create_zero_copy_grpc_protector,
     ssl_handshaker_result_create_frame_protector,
     ssl_handshaker_result_get_unused_bytes,
     ssl_handshaker_result_destroy,
@@ -2031,9 +2405,14 @@ tsi_result tsi_ssl_client_handshaker_factory_create_handshaker(
     tsi_ssl_client_handshaker_factory* factory,
     const char* server_name_indication, size_t network_bio_buf_size,
     size_t ssl_bio_buf_size, tsi_handshaker** handshaker) {
-  return create_tsi_ssl_handshaker(
+  tsi_result result = create_tsi_ssl_handshaker(
       factory->ssl_context, 1, server_name_indication, network_bio_buf_size,
       ssl_bio_buf_size, &factory->base, handshaker);
+  // Replaces the key shares that this handshake is about to take.
+  if (result == TSI_OK) {
+    ssl_client_handshaker_factory_pregenerate_key_shares(factory);
+  }
+  return result;
 }
 
 void tsi_ssl_client_handshaker_factory_unref(
@@ -2084,6 +2463,12 @@ tsi_result tsi_ssl_server_handshaker_factory_create_handshaker(
                                    &factory->base, handshaker);
 }
 
+size_t tsi_ssl_bio_buf_size_for_max_frame_size(size_t max_frame_size) {
+  if (max_frame_size <= TSI_SSL_DEFAULT_PROTECTED_FRAME_SIZE) return 0;
+  return std::min<size_t>(max_frame_size,
+                          TSI_SSL_MAX_PROTECTED_FRAME_SIZE_UPPER_BOUND);
+}
+
 void tsi_ssl_server_handshaker_factory_unref(
     tsi_ssl_server_handshaker_factory* factory) {
   if (factory == nullptr) return;
@@ -2315,9 +2700,17 @@ tsi_result tsi_create_ssl_client_handshaker_factory_with_options(
     SSL_CTX_set_ex_data(ssl_context, g_ssl_ctx_ex_factory_index, impl);
   }
 
+  std::string cipher_list;
+  if (options->cipher_suites != nullptr) {
+    cipher_list = ssl_cipher_list_for_context(
+        options->cipher_suites, options->prefer_hardware_ciphers);
+  }
+
   do {
-    result = populate_ssl_context(ssl_context, options->pem_key_cert_pair,
-                                  options->cipher_suites);
+    result = populate_ssl_context(
+        ssl_context, options->pem_key_cert_pair,
+        options->cipher_suites != nullptr ? cipher_list.c_str() : nullptr,
+        options->key_exchange_groups);
     if (result != TSI_OK) break;
 
 #if OPENSSL_VERSION_NUMBER >= 0x10100000
@@ -2398,6 +2791,26 @@ tsi_result tsi_create_ssl_client_handshaker_factory_with_options(
       X509_VERIFY_PARAM_set_flags(
           param, X509_V_FLAG_CRL_CHECK | X509_V_FLAG_CRL_CHECK_ALL);
     }
+  } else if (!options->skip_server_certificate_verification) {
+    // Without revocation checks, a chain that verified once stays valid until
+    // it expires, so repeated handshakes with the same server can skip it.
+    SSL_CTX_set_ex_data(impl->ssl_context,
+                        g_ssl_ctx_ex_verified_chain_cache_index,
+                        new grpc_core::VerifiedChainCache());
+  }
+#endif
+
+#if defined(OPENSSL_IS_BORINGSSL)
+  if (options->key_exchange_groups != nullptr) {
+    std::vector<uint16_t> group_ids =
+        grpc_core::PregeneratedKeyShareGroups(options->key_exchange_groups);
+    for (uint16_t group_id : group_ids) {
+      impl->pregenerated_key_share_groups
+          [impl->num_pregenerated_key_share_groups++] = group_id;
+    }
+    // Channels usually connect soon after their credentials are created, so
+    // the first handshake can already use these.
+    ssl_client_handshaker_factory_pregenerate_key_shares(impl);
   }
 #endif
 
@@ -2485,6 +2898,12 @@ tsi_result tsi_create_ssl_server_handshaker_factory_with_options(
     impl->key_logger = options->key_logger->Ref();
   }
 
+  std::string cipher_list;
+  if (options->cipher_suites != nullptr) {
+    cipher_list = ssl_cipher_list_for_context(
+        options->cipher_suites, options->prefer_hardware_ciphers);
+  }
+
   for (i = 0; i < options->num_key_cert_pairs; i++) {
     do {
 #if OPENSSL_VERSION_NUMBER >= 0x10100000
@@ -2507,9 +2926,10 @@ tsi_result tsi_create_ssl_server_handshaker_factory_with_options(
                                                 options->max_tls_version);
       if (result != TSI_OK) return result;
 
-      result = populate_ssl_context(impl->ssl_contexts[i],
-                                    &options->pem_key_cert_pairs[i],
-                                    options->cipher_suites);
+      result = populate_ssl_context(
+          impl->ssl_contexts[i], &options->pem_key_cert_pairs[i],
+          options->cipher_suites != nullptr ? cipher_list.c_str() : nullptr,
+          options->key_exchange_groups);
       if (result != TSI_OK) break;
 
       // TODO(elessar): Provide ability to disable session ticket keys.
@@ -2596,6 +3016,10 @@ tsi_result tsi_create_ssl_server_handshaker_factory_with_options(
           X509_VERIFY_PARAM_set_flags(
               param, X509_V_FLAG_CRL_CHECK | X509_V_FLAG_CRL_CHECK_ALL);
         }
+      } else {
+        SSL_CTX_set_ex_data(impl->ssl_contexts[i],
+                            g_ssl_ctx_ex_verified_chain_cache_index,
+                            new grpc_core::VerifiedChainCache());
       }
 #endif
 
@@ -54,6 +54,11 @@
 #else
   #include <openssl/rsa.h>
 #endif
+#if COCOAPODS==1
+  #include <openssl_grpc/sha.h>
+#else
+  #include <openssl/sha.h>
+#endif
 #if COCOAPODS==1
   #include <openssl_grpc/ssl.h>
 #else
@@ -69,11 +74,27 @@
 #else
   #include <openssl/x509v3.h>
 #endif
+#if defined(OPENSSL_IS_BORINGSSL)
+#if COCOAPODS==1
+  #include <openssl_grpc/aead.h>
+#else
+  #include <openssl/aead.h>
+#endif
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
 
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
 #include "src/core/tsi/transport_security_interface.h"
 
 namespace grpc_core {
@@ -468,4 +489,163 @@ absl::StatusOr<EVP_PKEY*> ParsePemPrivateKey(
   return pkey;
 }
 
+bool SslHasAesHardware() {
+#if defined(OPENSSL_IS_BORINGSSL)
+  return EVP_has_aes_hardware() != 0;
+#else
+  return true;
+#endif
+}
+
+std::string PreferHardwareCiphers(absl::string_view cipher_list,
+                                  bool has_aes_hardware) {
+  std::vector<std::string> suites =
+      absl::StrSplit(cipher_list, ':', absl::SkipEmpty());
+  if (!has_aes_hardware) {
+    for (absl::string_view kex : {"ECDHE-ECDSA-", "ECDHE-RSA-"}) {
+      bool has_aes_gcm = false;
+      bool has_chacha = false;
+      for (const std::string& suite : suites) {
+        if (!absl::StartsWith(suite, kex)) continue;
+        has_aes_gcm |= absl::StrContains(suite, "GCM");
+        has_chacha |= absl::StrContains(suite, "CHACHA20");
+      }
+      if (has_aes_gcm && !has_chacha) {
+        suites.push_back(absl::StrCat(kex, "CHACHA20-POLY1305"));
+      }
+    }
+  }
+  absl::string_view preferred = has_aes_hardware ? "GCM" : "CHACHA20";
+  std::stable_partition(suites.begin(), suites.end(),
+                        [preferred](const std::string& suite) {
+                          return absl::StrContains(suite, preferred);
+                        });
+  return absl::StrJoin(suites, ":");
+}
+
+#if defined(OPENSSL_IS_BORINGSSL)
+std::vector<uint16_t> PregeneratedKeyShareGroups(
+    absl::string_view key_exchange_groups) {
+  auto is_post_quantum = [](absl::string_view name) {
+    return name == "X25519MLKEM768" || name == "X25519Kyber768Draft00";
+  };
+  std::vector<absl::string_view> names =
+      absl::StrSplit(key_exchange_groups, ':', absl::SkipEmpty());
+  std::vector<absl::string_view> offered;
+  for (absl::string_view name : names) {
+    if (offered.empty() ||
+        is_post_quantum(name) != is_post_quantum(offered.front())) {
+      offered.push_back(name);
+      if (offered.size() == 2) break;
+    }
+  }
+  std::vector<uint16_t> group_ids;
+  for (absl::string_view name : offered) {
+    if (name == "X25519MLKEM768") {
+      group_ids.push_back(SSL_GROUP_X25519_MLKEM768);
+    } else if (name == "X25519" || name == "x25519") {
+      group_ids.push_back(SSL_GROUP_X25519);
+    }
+  }
+  return group_ids;
+}
+#endif
+
+#if OPENSSL_VERSION_NUMBER >= 0x10100000 && !defined(LIBRESSL_VERSION_NUMBER)
+namespace {
+
+constexpr size_t kVerifiedChainCacheMaxEntries = 64;
+constexpr std::chrono::seconds kVerifiedChainCacheMaxAge{3600};
+
+bool AddCertToDigest(SHA256_CTX* sha, X509* cert) {
+  unsigned char* der = nullptr;
+  int der_len = i2d_X509(cert, &der);
+  if (der_len <= 0) return false;
+  SHA256_Update(sha, der, static_cast<size_t>(der_len));
+  OPENSSL_free(der);
+  return true;
+}
+
+}  // namespace
+
+VerifiedChainCache::~VerifiedChainCache() {
+  MutexLock lock(&mu_);
+  for (auto& entry : entries_) {
+    X509_free(entry.second.root);
+  }
+}
+
+std::string VerifiedChainCache::ChainKey(X509_STORE_CTX* ctx) {
+  X509* cert = X509_STORE_CTX_get0_cert(ctx);
+  if (cert == nullptr) return "";
+  SHA256_CTX sha;
+  SHA256_Init(&sha);
+  if (!AddCertToDigest(&sha, cert)) return "";
+  STACK_OF(X509)* untrusted = X509_STORE_CTX_get0_untrusted(ctx);
+  if (untrusted != nullptr) {
+    for (size_t i = 0; i < static_cast<size_t>(sk_X509_num(untrusted)); i++) {
+      if (!AddCertToDigest(&sha, sk_X509_value(untrusted, i))) return "";
+    }
+  }
+  unsigned char digest[SHA256_DIGEST_LENGTH];
+  SHA256_Final(digest, &sha);
+  return std::string(reinterpret_cast<char*>(digest), sizeof(digest));
+}
+
+X509* VerifiedChainCache::Lookup(const std::string& key) {
+  MutexLock lock(&mu_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) return nullptr;
+  if (it->second.expiry <= std::chrono::steady_clock::now()) {
+    X509_free(it->second.root);
+    entries_.erase(it);
+    return nullptr;
+  }
+  X509_up_ref(it->second.root);
+  return it->second.root;
+}
+
+void VerifiedChainCache::Insert(const std::string& key, X509_STORE_CTX* ctx) {
+  STACK_OF(X509)* chain = X509_STORE_CTX_get0_chain(ctx);
+  if (chain == nullptr || sk_X509_num(chain) <= 0) return;
+  // The entry is only as good as the certificate that expires first.
+  std::chrono::seconds ttl = kVerifiedChainCacheMaxAge;
+  size_t chain_length = sk_X509_num(chain);
+  for (size_t i = 0; i < chain_length; i++) {
+    int days = 0;
+    int seconds = 0;
+    if (!ASN1_TIME_diff(&days, &seconds, nullptr,
+                        X509_get0_notAfter(sk_X509_value(chain, i)))) {
+      return;
+    }
+    ttl = std::min(ttl, std::chrono::seconds(int64_t{days} * 86400 + seconds));
+  }
+  if (ttl.count() <= 0) return;
+  X509* root = sk_X509_value(chain, chain_length - 1);
+  auto now = std::chrono::steady_clock::now();
+  MutexLock lock(&mu_);
+  if (entries_.size() >= kVerifiedChainCacheMaxEntries &&
+      entries_.find(key) == entries_.end()) {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      if (it->second.expiry <= now) {
+        X509_free(it->second.root);
+        entries_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+    if (entries_.size() >= kVerifiedChainCacheMaxEntries) {
+      X509_free(entries_.begin()->second.root);
+      entries_.erase(entries_.begin());
+    }
+  }
+  X509_up_ref(root);
+  auto result = entries_.insert({key, Entry{root, now + ttl}});
+  if (!result.second) {
+    X509_free(result.first->second.root);
+    result.first->second = Entry{root, now + ttl};
+  }
+}
+#endif
+
 }  // namespace grpc_core
@@ -32,11 +32,18 @@
   #include <openssl/x509.h>
 #endif
 
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "src/core/tsi/ssl/key_logging/ssl_key_logging.h"
 #include "src/core/tsi/transport_security_interface.h"
+#include "src/core/util/sync.h"
 
 namespace grpc_core {
 
@@ -185,6 +192,66 @@ absl::StatusOr<std::vector<X509*>> ParsePemCertificateChain(
 // Returns an EVP_PKEY instance parsed from the non-empty PEM private key block
 // in private_key_pem. Caller takes ownership of the EVP_PKEY pointer.
 absl::StatusOr<EVP_PKEY*> ParsePemPrivateKey(absl::string_view private_key_pem);
+
+// Returns true if the SSL library has fast, constant-time AES-GCM on this
+// machine. Only BoringSSL reports this; other libraries are assumed to have it.
+bool SslHasAesHardware();
+
+// Reorders the colon-separated cipher_list so that AES-GCM suites come first
+// when has_aes_hardware is true, and ChaCha20-Poly1305 suites come first
+// otherwise. The relative order within each group is kept. Without AES
+// hardware, an ECDHE-ECDSA or ECDHE-RSA ChaCha20-Poly1305 suite is added for
+// each of those key exchanges that only has AES-GCM suites in the list.
+std::string PreferHardwareCiphers(absl::string_view cipher_list,
+                                  bool has_aes_hardware);
+
+#if defined(OPENSSL_IS_BORINGSSL)
+// Returns the groups, out of the colon-separated key_exchange_groups, whose key
+// shares a BoringSSL client sends in its first ClientHello and that
+// SSL_pregenerate_key_shares supports. BoringSSL sends a key share for the most
+// preferred group and for the first group that differs from it in being
+// post-quantum or not. At most two groups are returned.
+std::vector<uint16_t> PregeneratedKeyShareGroups(
+    absl::string_view key_exchange_groups);
+#endif
+
+#if OPENSSL_VERSION_NUMBER >= 0x10100000 && !defined(LIBRESSL_VERSION_NUMBER)
+// A cache of peer certificate chains that X509_verify_cert has accepted, so
+// that repeated handshakes with the same peer skip building and checking the
+// chain. Entries are keyed by ChainKey() and expire at the earliest notAfter in
+// the verified chain, or an hour after they were added if that is sooner.
+// A cache must only be used with a single trust store whose verification
+// result cannot change over time, i.e. without CRL checks.
+class VerifiedChainCache {
+ public:
+  VerifiedChainCache() = default;
+  ~VerifiedChainCache();
+
+  VerifiedChainCache(const VerifiedChainCache&) = delete;
+  VerifiedChainCache& operator=(const VerifiedChainCache&) = delete;
+
+  // Returns a SHA-256 digest of the DER encoding of the peer certificate and
+  // the untrusted certificates it was sent with, or an empty string on error.
+  static std::string ChainKey(X509_STORE_CTX* ctx);
+
+  // Returns the root of the verified chain cached under key, or nullptr if
+  // there is no unexpired entry. The caller owns a reference to the result.
+  X509* Lookup(const std::string& key);
+
+  // Caches the chain that X509_verify_cert built in ctx under key.
+  void Insert(const std::string& key, X509_STORE_CTX* ctx);
+
+ private:
+  struct Entry {
+    X509* root;
+    std::chrono::steady_clock::time_point expiry;
+  };
+
+  Mutex mu_;
+  absl::flat_hash_map<std::string, Entry> entries_ ABSL_GUARDED_BY(mu_);
+};
+#endif
+
 }  // namespace grpc_core
 
 #endif  // GRPC_SRC_CORE_TSI_SSL_TRANSPORT_SECURITY_UTILS_H
@@ -0,0 +1,119 @@
+// Copyright 2024 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/core/util/allocation_stats.h"
+
+#include <grpc/support/port_platform.h>
+
+#include <atomic>
+
+#include "absl/strings/str_format.h"
+
+namespace grpc_core {
+
+namespace {
+
+const char* SubsystemName(AllocationSubsystem subsystem) {
+  switch (subsystem) {
+    case AllocationSubsystem::kArena:
+      return "arena";
+    case AllocationSubsystem::kMemoryAllocator:
+      return "memory_allocator";
+    case AllocationSubsystem::kCount:
+      break;
+  }
+  return "unknown";
+}
+
+}  // namespace
+
+#ifdef GRPC_ENABLE_ALLOCATION_STATS
+
+namespace {
+
+struct SubsystemCounters {
+  std::atomic<int64_t> live_bytes{0};
+  std::atomic<int64_t> peak_bytes{0};
+  std::atomic<int64_t> live_allocations{0};
+  std::atomic<int64_t> total_allocations{0};
+};
+
+// Trivially destructible, so that frees recorded during shutdown stay valid.
+SubsystemCounters g_counters[static_cast<size_t>(AllocationSubsystem::kCount)];
+
+}  // namespace
+
+namespace allocation_stats_detail {
+
+void Record(AllocationSubsystem subsystem, int64_t bytes, int64_t count) {
+  SubsystemCounters& counters = g_counters[static_cast<size_t>(subsystem)];
+  int64_t live =
+      counters.live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  counters.live_allocations.fetch_add(count, std::memory_order_relaxed);
+  if (count <= 0) return;
+  counters.total_allocations.fetch_add(count, std::memory_order_relaxed);
+  int64_t peak = counters.peak_bytes.load(std::memory_order_relaxed);
+  while (live > peak && !counters.peak_bytes.compare_exchange_weak(
+                            peak, live, std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace allocation_stats_detail
+
+bool AllocationStatsAvailable() { return true; }
+
+AllocationCounters GetAllocationCounters(AllocationSubsystem subsystem) {
+  const SubsystemCounters& counters =
+      g_counters[static_cast<size_t>(subsystem)];
+  AllocationCounters result;
+  result.live_bytes = counters.live_bytes.load(std::memory_order_relaxed);
+  result.peak_bytes = counters.peak_bytes.load(std::memory_order_relaxed);
+  result.live_allocations =
+      counters.live_allocations.load(std::memory_order_relaxed);
+  result.total_allocations =
+      counters.total_allocations.load(std::memory_order_relaxed);
+  return result;
+}
+
+#else  // !GRPC_ENABLE_ALLOCATION_STATS
+
+bool AllocationStatsAvailable() { return false; }
+
+AllocationCounters GetAllocationCounters(AllocationSubsystem /*subsystem*/) {
+  return AllocationCounters();
+}
+
+#endif  // GRPC_ENABLE_ALLOCATION_STATS
+
+std::string AllocationStatsReport() {
+  if (!AllocationStatsAvailable()) {
+    return "allocation stats are not compiled in; build with "
+           "-DGRPC_ENABLE_ALLOCATION_STATS\n";
+  }
+  std::string report =
+      absl::StrFormat("%-18s %12s %12s %11s %12s\n", "subsystem", "live",
+                      "peak", "live_allocs", "total_allocs");
+  for (size_t i = 0; i < static_cast<size_t>(AllocationSubsystem::kCount);
+       ++i) {
+    auto subsystem = static_cast<AllocationSubsystem>(i);
+    AllocationCounters counters = GetAllocationCounters(subsystem);
+    absl::StrAppendFormat(&report, "%-18s %12d %12d %11d %12d\n",
+                          SubsystemName(subsystem), counters.live_bytes,
+                          counters.peak_bytes, counters.live_allocations,
+                          counters.total_allocations);
+  }
+  return report;
+}
+
+}  // namespace grpc_core
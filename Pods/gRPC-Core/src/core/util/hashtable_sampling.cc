@@ -0,0 +1,236 @@
+// Copyright 2024 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/core/util/hashtable_sampling.h"
+
+#include <grpc/support/port_platform.h>
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#include "absl/container/internal/hashtablez_sampler.h"
+#include "absl/debugging/symbolize.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "src/core/util/no_destruct.h"
+
+namespace grpc_core {
+
+namespace {
+
+void MergeHashtableSiteStats(const HashtableSiteStats& from,
+                             HashtableSiteStats* to) {
+  to->sampled_tables += from.sampled_tables;
+  to->estimated_tables += from.estimated_tables;
+  to->live_tables += from.live_tables;
+  to->size += from.size;
+  to->capacity += from.capacity;
+  to->total_probe_length += from.total_probe_length;
+  to->num_rehashes += from.num_rehashes;
+  to->num_erases += from.num_erases;
+  to->max_size = std::max(to->max_size, from.max_size);
+  to->max_probe_length = std::max(to->max_probe_length, from.max_probe_length);
+  to->max_reserve = std::max(to->max_reserve, from.max_reserve);
+}
+
+}  // namespace
+
+#if defined(ABSL_INTERNAL_HASHTABLEZ_SAMPLE)
+
+namespace {
+
+using absl::container_internal::GlobalHashtablezSampler;
+using absl::container_internal::HashtablezInfo;
+
+// Sampled tables are keyed by the stack that created them until the report is
+// built, so that symbolization stays off the table destruction path.
+using StackKey = std::vector<void*>;
+using StatsByStack = std::map<StackKey, HashtableSiteStats>;
+
+// A std::map rather than a Swiss table, so that it is never sampled itself.
+struct DisposedStats {
+  absl::Mutex mu;
+  StatsByStack stats ABSL_GUARDED_BY(mu);
+};
+
+DisposedStats& GetDisposedStats() {
+  static NoDestruct<DisposedStats> disposed_stats;
+  return *disposed_stats;
+}
+
+HashtableSiteStats StatsFromInfo(const HashtablezInfo& info, bool live) {
+  HashtableSiteStats stats;
+  stats.sampled_tables = 1;
+  stats.estimated_tables =
+      static_cast<size_t>(std::max<int64_t>(info.weight, 1));
+  stats.live_tables = live ? 1 : 0;
+  stats.size = info.size.load(std::memory_order_relaxed);
+  stats.capacity = info.capacity.load(std::memory_order_relaxed);
+  stats.total_probe_length =
+      info.total_probe_length.load(std::memory_order_relaxed);
+  stats.num_rehashes = info.num_rehashes.load(std::memory_order_relaxed);
+  stats.num_erases = info.num_erases.load(std::memory_order_relaxed);
+  stats.max_size = stats.size;
+  stats.max_probe_length =
+      info.max_probe_length.load(std::memory_order_relaxed);
+  stats.max_reserve = info.max_reserve.load(std::memory_order_relaxed);
+  return stats;
+}
+
+StackKey StackFromInfo(const HashtablezInfo& info) {
+  return StackKey(info.stack, info.stack + std::max<int32_t>(info.depth, 0));
+}
+
+void OnHashtableDisposed(const HashtablezInfo& info) {
+  HashtableSiteStats stats = StatsFromInfo(info, /*live=*/false);
+  StackKey stack = StackFromInfo(info);
+  DisposedStats& disposed = GetDisposedStats();
+  absl::MutexLock lock(&disposed.mu);
+  MergeHashtableSiteStats(stats, &disposed.stats[std::move(stack)]);
+}
+
+bool IsLibraryFrame(absl::string_view symbol) {
+  return absl::StartsWith(symbol, "absl::") ||
+         absl::StartsWith(symbol, "std::");
+}
+
+// Returns the allocation site of a sampled stack: the first frame outside
+// Abseil and the standard library. The first frames are always the sampler and
+// the table itself, so without symbols the leading addresses are reported.
+std::string SiteFromStack(const StackKey& stack,
+                          std::map<void*, std::string>* symbols) {
+  for (void* pc : stack) {
+    auto it = symbols->find(pc);
+    if (it == symbols->end()) {
+      char buf[1024];
+      std::string symbol;
+      // Symbolize() wants the address of the call, not the return address.
+      if (absl::Symbolize(static_cast<char*>(pc) - 1, buf, sizeof(buf))) {
+        symbol = buf;
+      }
+      it = symbols->emplace(pc, std::move(symbol)).first;
+    }
+    if (!it->second.empty() && !IsLibraryFrame(it->second)) return it->second;
+  }
+  constexpr size_t kUnsymbolizedFrames = 8;
+  std::vector<std::string> addresses;
+  for (size_t i = 0; i < std::min(stack.size(), kUnsymbolizedFrames); ++i) {
+    addresses.push_back(absl::StrFormat("%p", stack[i]));
+  }
+  return absl::StrJoin(addresses, " ");
+}
+
+}  // namespace
+
+bool HashtableSamplingAvailable() { return true; }
+
+void StartHashtableSampling(int32_t sample_rate) {
+  GlobalHashtablezSampler().SetDisposeCallback(OnHashtableDisposed);
+  absl::container_internal::SetHashtablezSampleParameter(
+      std::max<int32_t>(sample_rate, 1));
+  absl::container_internal::SetHashtablezEnabled(true);
+}
+
+void StopHashtableSampling() {
+  absl::container_internal::SetHashtablezEnabled(false);
+}
+
+std::vector<HashtableSiteStats> CollectHashtableSiteStats() {
+  StatsByStack by_stack;
+  {
+    DisposedStats& disposed = GetDisposedStats();
+    absl::MutexLock lock(&disposed.mu);
+    by_stack = disposed.stats;
+  }
+  // The sampler holds the lock of each table while calling back, so only copy
+  // the data out here.
+  std::vector<std::pair<StackKey, HashtableSiteStats>> live;
+  GlobalHashtablezSampler().Iterate([&live](const HashtablezInfo& info) {
+    live.emplace_back(StackFromInfo(info), StatsFromInfo(info, /*live=*/true));
+  });
+  for (const auto& stack_and_stats : live) {
+    MergeHashtableSiteStats(stack_and_stats.second,
+                            &by_stack[stack_and_stats.first]);
+  }
+  std::map<void*, std::string> symbols;
+  std::map<std::string, HashtableSiteStats> by_site;
+  for (const auto& stack_and_stats : by_stack) {
+    std::string site = SiteFromStack(stack_and_stats.first, &symbols);
+    HashtableSiteStats& stats = by_site[site];
+    stats.site = site;
+    MergeHashtableSiteStats(stack_and_stats.second, &stats);
+  }
+  std::vector<HashtableSiteStats> result;
+  result.reserve(by_site.size());
+  for (auto& site_and_stats : by_site) {
+    result.push_back(std::move(site_and_stats.second));
+  }
+  std::sort(result.begin(), result.end(),
+            [](const HashtableSiteStats& a, const HashtableSiteStats& b) {
+              return a.capacity > b.capacity;
+            });
+  return result;
+}
+
+void ResetHashtableSiteStats() {
+  DisposedStats& disposed = GetDisposedStats();
+  absl::MutexLock lock(&disposed.mu);
+  disposed.stats.clear();
+}
+
+#else  // !defined(ABSL_INTERNAL_HASHTABLEZ_SAMPLE)
+
+bool HashtableSamplingAvailable() { return false; }
+
+void StartHashtableSampling(int32_t /*sample_rate*/) {}
+
+void StopHashtableSampling() {}
+
+std::vector<HashtableSiteStats> CollectHashtableSiteStats() { return {}; }
+
+void ResetHashtableSiteStats() {}
+
+#endif  // defined(ABSL_INTERNAL_HASHTABLEZ_SAMPLE)
+
+std::string HashtableSiteStatsReport(size_t max_sites) {
+  if (!HashtableSamplingAvailable()) {
+    return "hashtable sampling is not compiled in; build with "
+           "-DABSL_OPTION_HASHTABLEZ_SAMPLING=1\n";
+  }
+  std::vector<HashtableSiteStats> sites = CollectHashtableSiteStats();
+  std::string report = absl::StrFormat(
+      "%8s %8s %6s %10s %10s %6s %7s %6s %9s %8s  %s\n", "sampled", "est",
+      "live", "size", "capacity", "load", "probe", "max", "rehashes",
+      "reserve", "site");
+  for (size_t i = 0; i < std::min(sites.size(), max_sites); ++i) {
+    const HashtableSiteStats& s = sites[i];
+    absl::StrAppendFormat(&report,
+                          "%8u %8u %6u %10u %10u %6.2f %7.2f %6u %9u %8u  %s\n",
+                          s.sampled_tables, s.estimated_tables, s.live_tables,
+                          s.size, s.capacity, s.LoadFactor(),
+                          s.MeanProbeLength(), s.max_probe_length,
+                          s.num_rehashes, s.max_reserve, s.site);
+  }
+  if (sites.size() > max_sites) {
+    absl::StrAppend(&report, "... ", sites.size() - max_sites,
+                    " more sites\n");
+  }
+  return report;
+}
+
+}  // namespace grpc_core
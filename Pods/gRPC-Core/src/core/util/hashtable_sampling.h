@@ -0,0 +1,88 @@
+// Copyright 2024 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GRPC_SRC_CORE_UTIL_HASHTABLE_SAMPLING_H
+#define GRPC_SRC_CORE_UTIL_HASHTABLE_SAMPLING_H
+
+#include <grpc/support/port_platform.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+// Per allocation site statistics for Abseil Swiss tables (flat_hash_map,
+// flat_hash_set and the node variants), gathered by Abseil's hashtablez
+// sampler. Used to right-size and pre-reserve hot maps.
+//
+// The sampler is compiled out unless every target is built with
+// -DABSL_OPTION_HASHTABLEZ_SAMPLING=1, in which case the functions below do
+// nothing and report nothing. Sampling covers all tables in the process,
+// including those owned by libraries built on top of gRPC.
+
+namespace grpc_core {
+
+struct HashtableSiteStats {
+  // The first caller outside Abseil and the standard library that constructed
+  // the tables, or its address if it could not be symbolized.
+  std::string site;
+  // Number of sampled tables, and an estimate of all tables created here.
+  size_t sampled_tables = 0;
+  size_t estimated_tables = 0;
+  // Sampled tables that are still alive. Tables that were destroyed report
+  // their state at destruction.
+  size_t live_tables = 0;
+  // Sums over the sampled tables.
+  size_t size = 0;
+  size_t capacity = 0;
+  size_t total_probe_length = 0;
+  size_t num_rehashes = 0;
+  size_t num_erases = 0;
+  // Maxima over the sampled tables.
+  size_t max_size = 0;
+  size_t max_probe_length = 0;
+  size_t max_reserve = 0;
+
+  double LoadFactor() const {
+    return capacity == 0 ? 0 : static_cast<double>(size) / capacity;
+  }
+  // Mean number of probed groups per element.
+  double MeanProbeLength() const {
+    return size == 0 ? 0 : static_cast<double>(total_probe_length) / size;
+  }
+};
+
+// Returns true if the sampler is compiled in.
+bool HashtableSamplingAvailable();
+
+// Starts sampling one in every `sample_rate` tables created from now on, on
+// average. Statistics of tables destroyed while sampling is on are kept until
+// ResetHashtableSiteStats() is called.
+void StartHashtableSampling(int32_t sample_rate = 1024);
+// Stops sampling new tables. Tables already sampled keep being tracked.
+void StopHashtableSampling();
+
+// Returns the statistics of all sampled tables, grouped by allocation site,
+// with the largest total capacity first.
+std::vector<HashtableSiteStats> CollectHashtableSiteStats();
+// Forgets the statistics of destroyed tables.
+void ResetHashtableSiteStats();
+
+// Returns CollectHashtableSiteStats() as a human readable table, with at most
+// `max_sites` rows.
+std::string HashtableSiteStatsReport(size_t max_sites = 32);
+
+}  // namespace grpc_core
+
+#endif  // GRPC_SRC_CORE_UTIL_HASHTABLE_SAMPLING_H
@@ -14,7 +14,8 @@
 
 #include "src/core/util/latent_see.h"
 
-#ifdef GRPC_ENABLE_LATENT_SEE
+#if defined(GRPC_ENABLE_LATENT_SEE) || defined(GRPC_ENABLE_LATENT_SEE_RING)
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
@@ -30,13 +31,71 @@
 namespace grpc_core {
 namespace latent_see {
 
+namespace {
+
+const std::chrono::steady_clock::time_point start_time =
+    std::chrono::steady_clock::now();
+
+// Appends one event in Chrome trace format. extra_args, if not empty, must
+// start with a comma.
+void AppendEventJson(const Metadata* metadata, EventType type, uint64_t id,
+                     std::chrono::steady_clock::time_point timestamp,
+                     uint64_t thread_id, absl::string_view extra_args,
+                     std::string* json) {
+  using Nanos = std::chrono::duration<unsigned long long, std::nano>;
+  absl::string_view phase;
+  bool has_id;
+  switch (type) {
+    case EventType::kBegin:
+      phase = "B";
+      has_id = false;
+      break;
+    case EventType::kEnd:
+      phase = "E";
+      has_id = false;
+      break;
+    case EventType::kFlowStart:
+      phase = "s";
+      has_id = true;
+      break;
+    case EventType::kFlowEnd:
+      phase = "f";
+      has_id = true;
+      break;
+    case EventType::kMark:
+      phase = "i";
+      has_id = false;
+      break;
+  }
+  if (metadata->name[0] != '"') {
+    absl::StrAppend(json, "{\"name\": \"", metadata->name, "\", \"ph\": \"",
+                    phase, "\", \"ts\": ",
+                    Nanos(timestamp - start_time).count() / 1000.0,
+                    ", \"pid\": 0, \"tid\": ", thread_id);
+  } else {
+    absl::StrAppend(json, "{\"name\": ", metadata->name, ", \"ph\": \"", phase,
+                    "\", \"ts\": ",
+                    Nanos(timestamp - start_time).count() / 1000.0,
+                    ", \"pid\": 0, \"tid\": ", thread_id);
+  }
+  if (has_id) {
+    absl::StrAppend(json, ", \"id\": ", id);
+  }
+  if (type == EventType::kFlowEnd) {
+    absl::StrAppend(json, ", \"bp\": \"e\"");
+  }
+  absl::StrAppend(json, ", \"args\": {\"file\": \"", metadata->file,
+                  "\", \"line\": ", metadata->line, extra_args, "}}");
+}
+
+}  // namespace
+
+#ifdef GRPC_ENABLE_LATENT_SEE
 thread_local uint64_t Log::thread_id_ = Log::Get().next_thread_id_.fetch_add(1);
 thread_local Bin* Log::bin_ = nullptr;
 thread_local void* Log::bin_owner_ = nullptr;
 std::atomic<uint64_t> Flow::next_flow_id_{1};
 std::atomic<uintptr_t> Log::free_bins_{0};
-const std::chrono::steady_clock::time_point start_time =
-    std::chrono::steady_clock::now();
 
 void Log::TryPullEventsAndFlush(
     absl::FunctionRef<void(absl::Span<const RecordedEvent>)> callback) {
@@ -76,65 +135,19 @@ void Log::TryPullEventsAndFlush(
 }
 
 absl::optional<std::string> Log::TryGenerateJson() {
-  using Nanos = std::chrono::duration<unsigned long long, std::nano>;
   std::string json = "[\n";
   bool first = true;
   int callbacks = 0;
   TryPullEventsAndFlush([&](absl::Span<const RecordedEvent> events) {
     ++callbacks;
     for (const auto& event : events) {
-      absl::string_view phase;
-      bool has_id;
-      switch (event.event.type) {
-        case EventType::kBegin:
-          phase = "B";
-          has_id = false;
-          break;
-        case EventType::kEnd:
-          phase = "E";
-          has_id = false;
-          break;
-        case EventType::kFlowStart:
-          phase = "s";
-          has_id = true;
-          break;
-        case EventType::kFlowEnd:
-          phase = "f";
-          has_id = true;
-          break;
-        case EventType::kMark:
-          phase = "i";
-          has_id = false;
-          break;
-      }
       if (!first) {
         absl::StrAppend(&json, ",\n");
       }
       first = false;
-      if (event.event.metadata->name[0] != '"') {
-        absl::StrAppend(
-            &json, "{\"name\": \"", event.event.metadata->name,
-            "\", \"ph\": \"", phase, "\", \"ts\": ",
-            Nanos(event.event.timestamp - start_time).count() / 1000.0,
-            ", \"pid\": 0, \"tid\": ", event.thread_id);
-      } else {
-        absl::StrAppend(
-            &json, "{\"name\": ", event.event.metadata->name, ", \"ph\": \"",
-            phase, "\", \"ts\": ",
-            Nanos(event.event.timestamp - start_time).count() / 1000.0,
-            ", \"pid\": 0, \"tid\": ", event.thread_id);
-      }
-
-      if (has_id) {
-        absl::StrAppend(&json, ", \"id\": ", event.event.id);
-      }
-      if (event.event.type == EventType::kFlowEnd) {
-        absl::StrAppend(&json, ", \"bp\": \"e\"");
-      }
-      absl::StrAppend(&json, ", \"args\": {\"file\": \"",
-                      event.event.metadata->file,
-                      "\", \"line\": ", event.event.metadata->line,
-                      ", \"batch\": ", event.batch_id, "}}");
+      AppendEventJson(event.event.metadata, event.event.type, event.event.id,
+                      event.event.timestamp, event.thread_id,
+                      absl::StrCat(", \"batch\": ", event.batch_id), &json);
     }
   });
   if (callbacks == 0) return absl::nullopt;
@@ -158,6 +171,141 @@ void Log::FlushBin(Bin* bin) {
   bin->events.clear();
 }
 
+#else  // GRPC_ENABLE_LATENT_SEE_RING
+
+namespace {
+
+// One thread's most recent events. Only the owning thread writes; any thread
+// may read. The writer reserves a slot before overwriting it, so a reader
+// that copies slots and then sees how far the writer has reserved can drop
+// the slots that may have changed under it.
+struct Ring {
+  struct Slot {
+    std::atomic<const Metadata*> metadata{nullptr};
+    std::atomic<int64_t> timestamp{0};
+    std::atomic<uint64_t> id{0};
+    std::atomic<EventType> type{EventType::kMark};
+  };
+
+  explicit Ring(uint64_t thread_id) : thread_id(thread_id) {}
+
+  const uint64_t thread_id;
+  std::atomic<bool> in_use{true};
+  // Number of events reserved, and of those fully written.
+  std::atomic<uint64_t> reserved{0};
+  std::atomic<uint64_t> written{0};
+  Ring* next = nullptr;
+  Slot slots[RingLog::kEventsPerThread];
+};
+
+// Rings are never freed, so that readers can walk this list without locks.
+std::atomic<Ring*> rings{nullptr};
+std::atomic<uint64_t> next_thread_id{1};
+
+Ring* AcquireRing() {
+  for (Ring* ring = rings.load(std::memory_order_acquire); ring != nullptr;
+       ring = ring->next) {
+    bool in_use = false;
+    if (ring->in_use.compare_exchange_strong(in_use, true,
+                                             std::memory_order_acquire)) {
+      return ring;
+    }
+  }
+  Ring* ring =
+      new Ring(next_thread_id.fetch_add(1, std::memory_order_relaxed));
+  ring->next = rings.load(std::memory_order_relaxed);
+  while (!rings.compare_exchange_weak(ring->next, ring,
+                                      std::memory_order_acq_rel,
+                                      std::memory_order_relaxed)) {
+  }
+  return ring;
+}
+
+// Hands the ring back when the thread exits.
+struct ThreadRing {
+  ~ThreadRing() {
+    if (ring != nullptr) ring->in_use.store(false, std::memory_order_release);
+  }
+  Ring* ring = nullptr;
+};
+
+thread_local ThreadRing thread_ring;
+
+}  // namespace
+
+thread_local int RingLog::parent_depth_ = 0;
+thread_local bool RingLog::recording_ = false;
+thread_local uint32_t RingLog::sample_counter_ = 0;
+std::atomic<uint32_t> RingLog::sample_every_{RingLog::kDefaultSampleEvery};
+std::atomic<uint64_t> Flow::next_flow_id_{1};
+
+void RingLog::Append(const Metadata* metadata, EventType type, uint64_t id) {
+  Ring* ring = thread_ring.ring;
+  if (ring == nullptr) ring = thread_ring.ring = AcquireRing();
+  const uint64_t index = ring->reserved.load(std::memory_order_relaxed);
+  ring->reserved.store(index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  Ring::Slot& slot = ring->slots[index % kEventsPerThread];
+  slot.metadata.store(metadata, std::memory_order_relaxed);
+  slot.timestamp.store(
+      std::chrono::steady_clock::now().time_since_epoch().count(),
+      std::memory_order_relaxed);
+  slot.id.store(id, std::memory_order_relaxed);
+  slot.type.store(type, std::memory_order_relaxed);
+  ring->written.store(index + 1, std::memory_order_release);
+}
+
+void RingLog::SetSampleEvery(uint32_t sample_every) {
+  sample_every_.store(std::max<uint32_t>(sample_every, 1),
+                      std::memory_order_relaxed);
+}
+
+std::string RingLog::GenerateJson(std::chrono::nanoseconds window) {
+  struct Event {
+    const Metadata* metadata;
+    std::chrono::steady_clock::time_point timestamp;
+    uint64_t id;
+    EventType type;
+  };
+  const auto cutoff = std::chrono::steady_clock::now() - window;
+  std::string json = "[\n";
+  bool first = true;
+  std::vector<Event> events;
+  for (Ring* ring = rings.load(std::memory_order_acquire); ring != nullptr;
+       ring = ring->next) {
+    const uint64_t end = ring->written.load(std::memory_order_acquire);
+    uint64_t begin = end > kEventsPerThread ? end - kEventsPerThread : 0;
+    events.clear();
+    for (uint64_t i = begin; i < end; ++i) {
+      const Ring::Slot& slot = ring->slots[i % kEventsPerThread];
+      events.push_back(Event{
+          slot.metadata.load(std::memory_order_relaxed),
+          std::chrono::steady_clock::time_point(
+              std::chrono::steady_clock::duration(
+                  slot.timestamp.load(std::memory_order_relaxed))),
+          slot.id.load(std::memory_order_relaxed),
+          slot.type.load(std::memory_order_relaxed)});
+    }
+    // Drop the events whose slots the writer may have reused meanwhile.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t reserved = ring->reserved.load(std::memory_order_relaxed);
+    const uint64_t first_valid =
+        reserved > kEventsPerThread ? reserved - kEventsPerThread : 0;
+    for (uint64_t i = std::max(begin, first_valid); i < end; ++i) {
+      const Event& event = events[i - begin];
+      if (event.timestamp < cutoff) continue;
+      if (!first) absl::StrAppend(&json, ",\n");
+      first = false;
+      AppendEventJson(event.metadata, event.type, event.id, event.timestamp,
+                      ring->thread_id, "", &json);
+    }
+  }
+  absl::StrAppend(&json, "\n]");
+  return json;
+}
+
+#endif  // GRPC_ENABLE_LATENT_SEE
+
 }  // namespace latent_see
 }  // namespace grpc_core
 #endif
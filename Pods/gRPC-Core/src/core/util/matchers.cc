@@ -16,17 +16,68 @@
 
 #include <grpc/support/port_platform.h>
 
+#include <memory>
 #include <utility>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "src/core/util/no_destruct.h"
+#include "src/core/util/sync.h"
 
 namespace grpc_core {
 
+namespace {
+
+// Process-wide cache of compiled regexes, keyed by pattern. Entries only
+// refer weakly to the regexes and are removed when the last matcher using
+// them goes away.
+class RegexCache {
+ public:
+  static RegexCache& Get() {
+    static NoDestruct<RegexCache> cache;
+    return *cache;
+  }
+
+  // Returns the compiled regex for pattern, which may not be ok().
+  std::shared_ptr<const RE2> GetOrCompile(absl::string_view pattern) {
+    MutexLock lock(&mu_);
+    auto it = regexes_.find(pattern);
+    if (it != regexes_.end()) {
+      std::shared_ptr<const RE2> regex = it->second.lock();
+      if (regex != nullptr) return regex;
+    }
+    std::shared_ptr<const RE2> regex(
+        new RE2(re2::StringPiece(pattern.data(), pattern.size())),
+        [](const RE2* regex) {
+          RegexCache::Get().Remove(regex->pattern());
+          delete regex;
+        });
+    // Invalid patterns are not cached, their error is reported right away.
+    if (regex->ok()) regexes_[pattern] = regex;
+    return regex;
+  }
+
+ private:
+  void Remove(const std::string& pattern) {
+    MutexLock lock(&mu_);
+    auto it = regexes_.find(pattern);
+    // The pattern may have been compiled again after the regex expired.
+    if (it != regexes_.end() && it->second.expired()) regexes_.erase(it);
+  }
+
+  Mutex mu_;
+  absl::flat_hash_map<std::string, std::weak_ptr<const RE2>> regexes_
+      ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace
+
 //
 // StringMatcher
 //
@@ -35,7 +86,7 @@ absl::StatusOr<StringMatcher> StringMatcher::Create(Type type,
                                                     absl::string_view matcher,
                                                     bool case_sensitive) {
   if (type == Type::kSafeRegex) {
-    auto regex_matcher = std::make_unique<RE2>(std::string(matcher));
+    auto regex_matcher = RegexCache::Get().GetOrCompile(matcher);
     if (!regex_matcher->ok()) {
       return absl::InvalidArgumentError(
           absl::StrCat("Invalid regex string specified in matcher: ",
@@ -51,13 +102,13 @@ StringMatcher::StringMatcher(Type type, absl::string_view matcher,
                              bool case_sensitive)
     : type_(type), string_matcher_(matcher), case_sensitive_(case_sensitive) {}
 
-StringMatcher::StringMatcher(std::unique_ptr<RE2> regex_matcher)
+StringMatcher::StringMatcher(std::shared_ptr<const RE2> regex_matcher)
     : type_(Type::kSafeRegex), regex_matcher_(std::move(regex_matcher)) {}
 
 StringMatcher::StringMatcher(const StringMatcher& other)
     : type_(other.type_), case_sensitive_(other.case_sensitive_) {
   if (type_ == Type::kSafeRegex) {
-    regex_matcher_ = std::make_unique<RE2>(other.regex_matcher_->pattern());
+    regex_matcher_ = other.regex_matcher_;
   } else {
     string_matcher_ = other.string_matcher_;
   }
@@ -66,7 +117,7 @@ StringMatcher::StringMatcher(const StringMatcher& other)
 StringMatcher& StringMatcher::operator=(const StringMatcher& other) {
   type_ = other.type_;
   if (type_ == Type::kSafeRegex) {
-    regex_matcher_ = std::make_unique<RE2>(other.regex_matcher_->pattern());
+    regex_matcher_ = other.regex_matcher_;
   } else {
     string_matcher_ = other.string_matcher_;
   }
@@ -123,7 +174,8 @@ bool StringMatcher::Match(absl::string_view value) const {
                  : absl::StrContains(absl::AsciiStrToLower(value),
                                      absl::AsciiStrToLower(string_matcher_));
     case StringMatcher::Type::kSafeRegex:
-      return RE2::FullMatch(std::string(value), *regex_matcher_);
+      return RE2::FullMatch(re2::StringPiece(value.data(), value.size()),
+                            *regex_matcher_);
     default:
       return false;
   }
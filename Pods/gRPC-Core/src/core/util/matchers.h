@@ -61,17 +61,19 @@ class StringMatcher {
   const std::string& string_matcher() const { return string_matcher_; }
 
   // Valid for kSafeRegex.
-  RE2* regex_matcher() const { return regex_matcher_.get(); }
+  const RE2* regex_matcher() const { return regex_matcher_.get(); }
 
   bool case_sensitive() const { return case_sensitive_; }
 
  private:
   StringMatcher(Type type, absl::string_view matcher, bool case_sensitive);
-  explicit StringMatcher(std::unique_ptr<RE2> regex_matcher);
+  explicit StringMatcher(std::shared_ptr<const RE2> regex_matcher);
 
   Type type_ = Type::kExact;
   std::string string_matcher_;
-  std::unique_ptr<RE2> regex_matcher_;
+  // Compiled regexes are shared by all matchers with the same pattern in the
+  // process, so that copying a matcher does not compile its regex again.
+  std::shared_ptr<const RE2> regex_matcher_;
   bool case_sensitive_ = true;
 };
 
@@ -137,7 +139,9 @@ class HeaderMatcher {
   }
 
   // Valid for kSafeRegex.
-  RE2* regex_matcher() const { return matcher_.regex_matcher(); }
+  const RE2* regex_matcher() const { return matcher_.regex_matcher(); }
+
+  bool invert_match() const { return invert_match_; }
 
   bool Match(const absl::optional<absl::string_view>& value) const;
 
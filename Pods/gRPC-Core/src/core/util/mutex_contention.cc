@@ -0,0 +1,161 @@
+// Copyright 2024 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/core/util/mutex_contention.h"
+
+#include <grpc/support/port_platform.h>
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "absl/base/internal/cycleclock.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "src/core/telemetry/stats.h"
+#include "src/core/telemetry/stats_data.h"
+#include "src/core/util/sync.h"
+
+namespace grpc_core {
+
+namespace {
+
+// Distinct sites past which contention is recorded under "unnamed".
+constexpr size_t kMaxSites = 256;
+
+// Recording runs inside the unlock of absl::Mutex, so the state is guarded
+// by a std::mutex, whose contention is not reported back here.
+struct State {
+  std::mutex mu;
+  absl::flat_hash_map<const void*, std::string> site_by_mutex;
+  std::map<std::string, MutexContentionCounters> counters;
+};
+
+State& GetState() {
+  // Never destroyed, so that locks released during shutdown can still record.
+  static State* state = new State();
+  return *state;
+}
+
+void OnAbslMutexContention(const char* /*msg*/, const void* obj,
+                           int64_t wait_cycles) {
+  const double cycles_per_us =
+      absl::base_internal::CycleClock::Frequency() / 1e6;
+  mutex_contention_detail::MaybeRecord(
+      obj, static_cast<int64_t>(wait_cycles / cycles_per_us));
+}
+
+}  // namespace
+
+namespace mutex_contention_detail {
+
+std::atomic<uint32_t> g_sample_every{0};
+
+void MaybeRecord(const void* mutex, int64_t wait_us) {
+  const uint32_t sample_every = g_sample_every.load(std::memory_order_relaxed);
+  if (sample_every == 0) return;
+  static thread_local uint32_t countdown = 0;
+  if (countdown > 0) {
+    --countdown;
+    return;
+  }
+  countdown = sample_every - 1;
+  wait_us = std::max<int64_t>(wait_us, 0);
+  global_stats().IncrementMutexContentionWaitUs(static_cast<int>(
+      std::min<int64_t>(wait_us, std::numeric_limits<int>::max())));
+  State& state = GetState();
+  std::lock_guard<std::mutex> lock(state.mu);
+  auto site = state.site_by_mutex.find(mutex);
+  std::string name = site != state.site_by_mutex.end()
+                         ? site->second
+                         : absl::StrFormat("%p", mutex);
+  auto it = state.counters.find(name);
+  if (it == state.counters.end()) {
+    if (state.counters.size() >= kMaxSites) name = "unnamed";
+    it = state.counters.emplace(std::move(name), MutexContentionCounters())
+             .first;
+  }
+  MutexContentionCounters& counters = it->second;
+  ++counters.contentions;
+  counters.wait_us += wait_us;
+  counters.max_wait_us =
+      std::max(counters.max_wait_us, static_cast<uint64_t>(wait_us));
+}
+
+}  // namespace mutex_contention_detail
+
+#ifndef GPR_ABSEIL_SYNC
+void Mutex::LockAndRecordContention() {
+  if (gpr_mu_trylock(&mu_) != 0) return;
+  const auto start = std::chrono::steady_clock::now();
+  gpr_mu_lock(&mu_);
+  mutex_contention_detail::MaybeRecord(
+      this, std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start)
+                .count());
+}
+#endif  // GPR_ABSEIL_SYNC
+
+void EnableMutexContentionProfiling(uint32_t sample_every) {
+  static std::once_flag install_tracer;
+  if (sample_every != 0) {
+    std::call_once(install_tracer,
+                   [] { absl::RegisterMutexTracer(&OnAbslMutexContention); });
+  }
+  mutex_contention_detail::g_sample_every.store(sample_every,
+                                                std::memory_order_relaxed);
+}
+
+bool NameMutexContentionSite(const void* mutex, absl::string_view site) {
+  if (!MutexContentionProfilingEnabled()) return false;
+  State& state = GetState();
+  std::lock_guard<std::mutex> lock(state.mu);
+  state.site_by_mutex[mutex] = std::string(site);
+  return true;
+}
+
+void ForgetMutexContentionSite(const void* mutex) {
+  State& state = GetState();
+  std::lock_guard<std::mutex> lock(state.mu);
+  state.site_by_mutex.erase(mutex);
+}
+
+std::map<std::string, MutexContentionCounters> GetMutexContentionCounters() {
+  State& state = GetState();
+  std::lock_guard<std::mutex> lock(state.mu);
+  return state.counters;
+}
+
+std::string MutexContentionReport() {
+  auto counters = GetMutexContentionCounters();
+  std::vector<std::pair<std::string, MutexContentionCounters>> sites(
+      counters.begin(), counters.end());
+  std::sort(sites.begin(), sites.end(), [](const auto& a, const auto& b) {
+    return a.second.wait_us > b.second.wait_us;
+  });
+  std::string report = absl::StrFormat("%-48s %12s %14s %12s\n", "site",
+                                       "contentions", "wait_us", "max_wait_us");
+  for (const auto& site : sites) {
+    absl::StrAppendFormat(&report, "%-48s %12d %14d %12d\n", site.first,
+                          site.second.contentions, site.second.wait_us,
+                          site.second.max_wait_us);
+  }
+  return report;
+}
+
+}  // namespace grpc_core
@@ -0,0 +1,87 @@
+// Copyright 2024 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GRPC_SRC_CORE_UTIL_MUTEX_CONTENTION_H
+#define GRPC_SRC_CORE_UTIL_MUTEX_CONTENTION_H
+
+#include <grpc/support/port_platform.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <map>
+#include <string>
+
+#include "absl/strings/string_view.h"
+
+// Opt-in sampling of lock contention by lock site, to give evidence before
+// and after concurrency changes.
+//
+// Once enabled, one in every `sample_every` contended lock acquisitions
+// records how long the thread waited: in the mutex_contention_wait_us
+// histogram of the global stats, and in the counters of the lock's site.
+//
+// absl::Mutex reports contention through absl's mutex tracer hook, which
+// enabling installs, so the absl::Mutexes of other libraries in the process
+// are covered too. Where gRPC's Mutex wraps gpr_mu instead (without
+// GPR_ABSEIL_SYNC, as on Apple platforms), it reports its own contention.
+// absl's hook can only be installed once: if something else installed one
+// first, only gpr_mu based Mutexes are recorded.
+
+namespace grpc_core {
+
+struct MutexContentionCounters {
+  // Sampled contended acquisitions, and the total and the longest time that
+  // they waited for the lock.
+  uint64_t contentions = 0;
+  uint64_t wait_us = 0;
+  uint64_t max_wait_us = 0;
+};
+
+namespace mutex_contention_detail {
+// Zero while profiling is disabled.
+extern std::atomic<uint32_t> g_sample_every;
+// Records that acquiring `mutex` waited `wait_us`, if the acquisition is
+// sampled.
+void MaybeRecord(const void* mutex, int64_t wait_us);
+}  // namespace mutex_contention_detail
+
+inline bool MutexContentionProfilingEnabled() {
+  return mutex_contention_detail::g_sample_every.load(
+             std::memory_order_relaxed) != 0;
+}
+
+// Starts recording one in every `sample_every` contended acquisitions, or
+// stops recording if it is zero. The counters are kept across restarts.
+void EnableMutexContentionProfiling(uint32_t sample_every);
+
+// Records the contention on `mutex` under `site` until
+// ForgetMutexContentionSite() is called for it, which has to happen before
+// the mutex is destroyed. Several mutexes can share a site. Does nothing
+// while profiling is disabled, so mutexes named before it is enabled stay
+// unnamed. Returns whether the mutex was named.
+bool NameMutexContentionSite(const void* mutex, absl::string_view site);
+void ForgetMutexContentionSite(const void* mutex);
+
+// Returns the counters of each lock site. Contention on mutexes without a
+// site is recorded under the mutex's address, and past a limit on distinct
+// sites under "unnamed".
+std::map<std::string, MutexContentionCounters> GetMutexContentionCounters();
+
+// Formats the counters of every site, one per line, longest total wait
+// first.
+std::string MutexContentionReport();
+
+}  // namespace grpc_core
+
+#endif  // GRPC_SRC_CORE_UTIL_MUTEX_CONTENTION_H
@@ -27,6 +27,7 @@
 #include "absl/synchronization/mutex.h"
 
 #ifndef GPR_ABSEIL_SYNC
+#include "src/core/util/mutex_contention.h"
 #include "src/core/util/time_util.h"
 #endif
 
@@ -65,7 +66,13 @@ class ABSL_LOCKABLE Mutex {
   Mutex(const Mutex&) = delete;
   Mutex& operator=(const Mutex&) = delete;
 
-  void Lock() ABSL_EXCLUSIVE_LOCK_FUNCTION() { gpr_mu_lock(&mu_); }
+  void Lock() ABSL_EXCLUSIVE_LOCK_FUNCTION() {
+    if (GPR_UNLIKELY(MutexContentionProfilingEnabled())) {
+      LockAndRecordContention();
+      return;
+    }
+    gpr_mu_lock(&mu_);
+  }
   void Unlock() ABSL_UNLOCK_FUNCTION() { gpr_mu_unlock(&mu_); }
   bool TryLock() ABSL_EXCLUSIVE_TRYLOCK_FUNCTION(true) {
     return gpr_mu_trylock(&mu_) != 0;
@@ -73,6 +80,10 @@ class ABSL_LOCKABLE Mutex {
   void AssertHeld() ABSL_ASSERT_EXCLUSIVE_LOCK() {}
 
  private:
+  // Lock() while mutex contention profiling is enabled, which times the wait
+  // if the mutex is already held. Defined in mutex_contention.cc.
+  void LockAndRecordContention() ABSL_EXCLUSIVE_LOCK_FUNCTION();
+
   gpr_mu mu_;
 
   friend class CondVar;
@@ -21,6 +21,7 @@
 
 #include "absl/strings/string_view.h"
 #include "upb/base/string_view.h"
+#include "upb/mem/arena.hpp"
 
 namespace grpc_core {
 
@@ -38,6 +39,12 @@ inline std::string UpbStringToStdString(const upb_StringView& str) {
   return std::string(str.data, str.size);
 }
 
+// An arena for decoding a received proto. Its first block is part of the
+// object, so declared on the stack it is reused by every parse, and a typical
+// control plane or load report message is decoded without touching the heap.
+// Larger messages grow the arena from the heap as usual.
+using UpbParseArena = upb::InlinedArena<4096>;
+
 }  // namespace grpc_core
 
 #endif  // GRPC_SRC_CORE_UTIL_UPB_UTILS_H
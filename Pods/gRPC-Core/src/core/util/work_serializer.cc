@@ -20,7 +20,6 @@
 #include <grpc/support/port_platform.h>
 #include <stdint.h>
 
-#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <functional>
@@ -28,7 +27,6 @@
 #include <thread>
 #include <utility>
 
-#include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "src/core/lib/debug/trace.h"
@@ -40,7 +38,6 @@
 #include "src/core/util/latent_see.h"
 #include "src/core/util/mpscq.h"
 #include "src/core/util/orphanable.h"
-#include "src/core/util/sync.h"
 
 namespace grpc_core {
 
@@ -269,7 +266,13 @@ void WorkSerializer::LegacyWorkSerializer::DrainQueueOwned() {
 // One at a time guarantees that fixed size thread pools in EventEngine
 // implementations are not starved of threads by long running work
 // serializers. We implement EventEngine::Closure directly to avoid allocating
-// once per callback in the queue when scheduling.
+// once per callback when dispatching.
+//
+// Callbacks are queued on a lock-free MPSC queue, and a single atomic word
+// tracks how many are queued and whether some thread owns the serializer, so
+// neither Run() nor the work loop takes a lock. Callbacks added with
+// Schedule() run inline in DrainQueue() if no other thread owns the
+// serializer, which saves the EventEngine hop on the uncontended path.
 class WorkSerializer::DispatchingWorkSerializer final
     : public WorkSerializerImpl,
       public grpc_event_engine::experimental::EventEngine::Closure {
@@ -281,12 +284,8 @@ class WorkSerializer::DispatchingWorkSerializer final
   void Run(std::function<void()> callback,
            const DebugLocation& location) override;
   void Schedule(std::function<void()> callback,
-                const DebugLocation& location) override {
-    // We always dispatch to event engine, so Schedule and Run share
-    // semantics.
-    Run(callback, location);
-  }
-  void DrainQueue() override {}
+                const DebugLocation& location) override;
+  void DrainQueue() override;
   void Orphan() override;
 
   // Override EventEngine::Closure
@@ -299,27 +298,44 @@ class WorkSerializer::DispatchingWorkSerializer final
 #endif
 
  private:
-  // Wrapper to capture DebugLocation for the callback.
+  // Wrapper to capture DebugLocation for the callback, and when it was
+  // queued.
   struct CallbackWrapper {
     CallbackWrapper(std::function<void()> cb, const DebugLocation& loc)
-        : callback(std::move(cb)), location(loc) {}
+        : callback(std::move(cb)),
+          location(loc),
+          enqueue_time(std::chrono::steady_clock::now()) {}
+
+    MultiProducerSingleConsumerQueue::Node mpscq_node;
     std::function<void()> callback;
     // GPR_NO_UNIQUE_ADDRESS means this is 0 sized in release builds.
     GPR_NO_UNIQUE_ADDRESS DebugLocation location;
+    const std::chrono::steady_clock::time_point enqueue_time;
   };
-  using CallbackVector = absl::InlinedVector<CallbackWrapper, 1>;
 
-  // Refill processing_ from incoming_
-  // If processing_ is empty, also update running_ and return false.
-  // If additionally orphaned, will also delete this (therefore, it's not safe
-  // to touch any member variables if Refill returns false).
-  bool Refill();
+  // The top bit of state_ is set once the work serializer is orphaned, the
+  // next one while a thread owns it, and the rest count the callbacks that
+  // are queued or running.
+  static constexpr uint64_t kOrphaned = uint64_t{1} << 63;
+  static constexpr uint64_t kOwned = uint64_t{1} << 62;
+  static constexpr uint64_t kSizeMask = kOwned - 1;
 
-  // Perform the parts of Refill that need to acquire mu_
-  // Returns a tri-state indicating whether we were refilled successfully (=>
-  // keep running), or finished, and then if we were orphaned.
-  enum class RefillResult { kRefilled, kFinished, kFinishedAndOrphaned };
-  RefillResult RefillInner();
+  // Queues the callback, and returns true if the caller took ownership of
+  // the work serializer in doing so, which makes it responsible for running
+  // the queue.
+  bool Enqueue(std::function<void()> callback, const DebugLocation& location,
+               bool take_ownership);
+
+  // Runs the callback at the front of the queue. Requires ownership.
+  void RunNext();
+
+  // Accounts for the callback RunNext() ran. Returns true if there are more
+  // callbacks to run. Otherwise gives up ownership and returns false; if
+  // additionally orphaned, also deletes this (therefore, it's not safe to
+  // touch any member variables if FinishNext returns false).
+  bool FinishNext();
+
+  void StartRunning();
 
 #ifndef NDEBUG
   void SetCurrentThread() { running_work_serializer_ = this; }
@@ -329,39 +345,15 @@ class WorkSerializer::DispatchingWorkSerializer final
   void ClearCurrentThread() {}
 #endif
 
-  // Member variables are roughly sorted to keep processing cache lines
-  // separated from incoming cache lines.
-
-  // Callbacks that are currently being processed.
-  // Only accessed by: a Run() call going from not-running to running, or a
-  // work item being executed in EventEngine -- ie this does not need a mutex
-  // because all access is serialized. Stored in reverse execution order so
-  // that callbacks can be `pop_back()`'d on completion to free up any
-  // resources they hold.
-  CallbackVector processing_;
   // EventEngine instance upon which we'll do our work.
   const std::shared_ptr<grpc_event_engine::experimental::EventEngine>
       event_engine_;
-  std::chrono::steady_clock::time_point running_start_time_
-      ABSL_GUARDED_BY(mu_);
+  // Only accessed by the owner of the work serializer.
+  std::chrono::steady_clock::time_point running_start_time_;
   std::chrono::steady_clock::duration time_running_items_;
   uint64_t items_processed_during_run_;
-  // Flags containing run state:
-  // - running_ goes from false->true whenever the first callback is scheduled
-  //   on an idle WorkSerializer, and transitions back to false after the last
-  //   callback scheduled is completed and the WorkSerializer is again idle.
-  // - orphaned_ transitions to true once upon Orphan being called.
-  // When orphaned_ is true and running_ is false, the
-  // DispatchingWorkSerializer instance is deleted.
-  bool running_ ABSL_GUARDED_BY(mu_) = false;
-  bool orphaned_ ABSL_GUARDED_BY(mu_) = false;
-  Mutex mu_;
-  // Queued callbacks. New work items land here, and when processing_ is
-  // drained we move this entire queue into processing_ and work on draining
-  // it again. In low traffic scenarios this gives two mutex acquisitions per
-  // work item, but as load increases we get some natural batching and the
-  // rate of mutex acquisitions per work item tends towards 1.
-  CallbackVector incoming_ ABSL_GUARDED_BY(mu_);
+  MultiProducerSingleConsumerQueue queue_;
+  std::atomic<uint64_t> state_{0};
 
   GPR_NO_UNIQUE_ADDRESS latent_see::Flow flow_;
 
@@ -377,15 +369,60 @@ thread_local WorkSerializer::DispatchingWorkSerializer*
 #endif
 
 void WorkSerializer::DispatchingWorkSerializer::Orphan() {
-  ReleasableMutexLock lock(&mu_);
-  // If we're not running, then we can delete immediately.
-  if (!running_) {
-    lock.Release();
-    delete this;
-    return;
+  uint64_t state = state_.load(std::memory_order_relaxed);
+  while (true) {
+    // If some thread owns the work serializer, it deletes this once the
+    // queue is drained.
+    if ((state & kOwned) != 0) {
+      if (state_.compare_exchange_weak(state, state | kOrphaned,
+                                       std::memory_order_acq_rel)) {
+        return;
+      }
+      continue;
+    }
+    // If we're not running and nothing is queued, then we can delete
+    // immediately.
+    if ((state & kSizeMask) == 0) {
+      delete this;
+      return;
+    }
+    // Callbacks scheduled without a DrainQueue() after them still run, on
+    // EventEngine, before this is deleted.
+    if (state_.compare_exchange_weak(state, state | kOwned | kOrphaned,
+                                     std::memory_order_acq_rel)) {
+      StartRunning();
+      event_engine_->Run(this);
+      return;
+    }
+  }
+}
+
+bool WorkSerializer::DispatchingWorkSerializer::Enqueue(
+    std::function<void()> callback, const DebugLocation& location,
+    bool take_ownership) {
+  global_stats().IncrementWorkSerializerItemsEnqueued();
+  CallbackWrapper* cb_wrapper =
+      new CallbackWrapper(std::move(callback), location);
+  queue_.Push(&cb_wrapper->mpscq_node);
+  if (!take_ownership) {
+    state_.fetch_add(1, std::memory_order_acq_rel);
+    return false;
+  }
+  uint64_t state = state_.load(std::memory_order_relaxed);
+  while (!state_.compare_exchange_weak(state, (state + 1) | kOwned,
+                                       std::memory_order_acq_rel)) {
   }
-  // Otherwise store a flag to delete when we're done.
-  orphaned_ = true;
+  // The work serializer should not have been orphaned.
+  DCHECK_EQ(state & kOrphaned, 0u);
+  if ((state & kOwned) != 0) return false;
+  StartRunning();
+  return true;
+}
+
+void WorkSerializer::DispatchingWorkSerializer::StartRunning() {
+  running_start_time_ = std::chrono::steady_clock::now();
+  items_processed_during_run_ = 0;
+  time_running_items_ = std::chrono::steady_clock::duration();
 }
 
 // Implementation of WorkSerializerImpl::Run
@@ -394,25 +431,36 @@ void WorkSerializer::DispatchingWorkSerializer::Run(
   GRPC_TRACE_LOG(work_serializer, INFO)
       << "WorkSerializer[" << this << "] Scheduling callback ["
       << location.file() << ":" << location.line() << "]";
-  global_stats().IncrementWorkSerializerItemsEnqueued();
-  MutexLock lock(&mu_);
-  if (!running_) {
-    // If we were previously idle, insert this callback directly into the
-    // empty processing_ list and start running.
-    running_ = true;
-    running_start_time_ = std::chrono::steady_clock::now();
-    items_processed_during_run_ = 0;
-    time_running_items_ = std::chrono::steady_clock::duration();
-    CHECK(processing_.empty());
-    processing_.emplace_back(std::move(callback), location);
+  // If we were previously idle, start running on EventEngine. Otherwise the
+  // work loop will eventually get to the callback.
+  if (Enqueue(std::move(callback), location, /*take_ownership=*/true)) {
     event_engine_->Run(this);
-  } else {
-    // We are already running, so add this callback to the incoming_ list.
-    // The work loop will eventually get to it.
-    incoming_.emplace_back(std::move(callback), location);
   }
 }
 
+void WorkSerializer::DispatchingWorkSerializer::Schedule(
+    std::function<void()> callback, const DebugLocation& location) {
+  GRPC_TRACE_LOG(work_serializer, INFO)
+      << "WorkSerializer[" << this << "] Scheduling callback for drain ["
+      << location.file() << ":" << location.line() << "]";
+  Enqueue(std::move(callback), location, /*take_ownership=*/false);
+}
+
+void WorkSerializer::DispatchingWorkSerializer::DrainQueue() {
+  // Only take ownership if nobody holds it and there is something to run.
+  uint64_t state = state_.load(std::memory_order_relaxed);
+  do {
+    if ((state & kOwned) != 0 || (state & kSizeMask) == 0) return;
+  } while (!state_.compare_exchange_weak(state, state | kOwned,
+                                         std::memory_order_acq_rel));
+  GRPC_TRACE_LOG(work_serializer, INFO)
+      << "WorkSerializer[" << this << "] Draining queue inline";
+  StartRunning();
+  do {
+    RunNext();
+  } while (FinishNext());
+}
+
 // Implementation of EventEngine::Closure::Run - our actual work loop
 void WorkSerializer::DispatchingWorkSerializer::Run() {
   GRPC_LATENT_SEE_PARENT_SCOPE("WorkSerializer::Run");
@@ -420,20 +468,38 @@ void WorkSerializer::DispatchingWorkSerializer::Run() {
   // TODO(ctiller): remove these when we can deprecate ExecCtx
   ApplicationCallbackExecCtx app_exec_ctx;
   ExecCtx exec_ctx;
-  // Grab the last element of processing_ - which is the next item in our
-  // queue since processing_ is stored in reverse order.
-  auto& cb = processing_.back();
+  RunNext();
+  // Check if we've drained the queue.
+  if (!FinishNext()) return;
+  // There's still work queued, so schedule ourselves again on EventEngine.
+  flow_.Begin(GRPC_LATENT_SEE_METADATA("WorkSerializer::Link"));
+  event_engine_->Run(this);
+}
+
+void WorkSerializer::DispatchingWorkSerializer::RunNext() {
+  CallbackWrapper* cb_wrapper = nullptr;
+  bool empty_unused;
+  while ((cb_wrapper = reinterpret_cast<CallbackWrapper*>(
+              queue_.PopAndCheckEnd(&empty_unused))) == nullptr) {
+    // This can happen due to a race condition within the mpscq
+    // implementation, while another callback is being pushed.
+  }
+  const auto start = std::chrono::steady_clock::now();
+  global_stats().IncrementWorkSerializerQueueLatencyMs(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          start - cb_wrapper->enqueue_time)
+          .count());
   GRPC_TRACE_LOG(work_serializer, INFO)
       << "WorkSerializer[" << this << "] Executing callback ["
-      << cb.location.file() << ":" << cb.location.line() << "]";
+      << cb_wrapper->location.file() << ":" << cb_wrapper->location.line()
+      << "]";
   // Run the work item.
-  const auto start = std::chrono::steady_clock::now();
   SetCurrentThread();
-  cb.callback();
-  // pop_back here destroys the callback - freeing any resources it might
-  // hold. We do so before clearing the current thread in case the callback
-  // destructor wants to check that it's in the WorkSerializer too.
-  processing_.pop_back();
+  cb_wrapper->callback();
+  // Deleting the wrapper destroys the callback - freeing any resources it
+  // might hold. We do so before clearing the current thread in case the
+  // callback destructor wants to check that it's in the WorkSerializer too.
+  delete cb_wrapper;
   ClearCurrentThread();
   global_stats().IncrementWorkSerializerItemsDequeued();
   const auto work_time = std::chrono::steady_clock::now() - start;
@@ -441,65 +507,34 @@ void WorkSerializer::DispatchingWorkSerializer::Run() {
       std::chrono::duration_cast<std::chrono::milliseconds>(work_time).count());
   time_running_items_ += work_time;
   ++items_processed_during_run_;
-  // Check if we've drained the queue and if so refill it.
-  if (processing_.empty() && !Refill()) return;
-  // There's still work in processing_, so schedule ourselves again on
-  // EventEngine.
-  flow_.Begin(GRPC_LATENT_SEE_METADATA("WorkSerializer::Link"));
-  event_engine_->Run(this);
 }
 
-WorkSerializer::DispatchingWorkSerializer::RefillResult
-WorkSerializer::DispatchingWorkSerializer::RefillInner() {
-  // Recover any memory held by processing_, so that we don't grow forever.
-  // Do so before acquiring a lock so we don't cause inadvertent contention.
-  processing_.shrink_to_fit();
-  MutexLock lock(&mu_);
-  // Swap incoming_ into processing_ - effectively lets us release memory
-  // (outside the lock) once per iteration for the storage vectors.
-  processing_.swap(incoming_);
-  // If there were no items, then we've finished running.
-  if (processing_.empty()) {
-    running_ = false;
-    global_stats().IncrementWorkSerializerRunTimeMs(
-        std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::steady_clock::now() - running_start_time_)
-            .count());
-    global_stats().IncrementWorkSerializerWorkTimeMs(
-        std::chrono::duration_cast<std::chrono::milliseconds>(
-            time_running_items_)
-            .count());
-    global_stats().IncrementWorkSerializerItemsPerRun(
-        items_processed_during_run_);
-    // And if we're also orphaned then it's time to delete this object.
-    if (orphaned_) {
-      return RefillResult::kFinishedAndOrphaned;
-    } else {
-      return RefillResult::kFinished;
+bool WorkSerializer::DispatchingWorkSerializer::FinishNext() {
+  uint64_t state = state_.fetch_sub(1, std::memory_order_acq_rel) - 1;
+  if ((state & kSizeMask) != 0) return true;
+  // Take the stats of the run before giving up ownership, since the next
+  // owner resets them.
+  const auto run_time = std::chrono::steady_clock::now() - running_start_time_;
+  const auto time_running_items = time_running_items_;
+  const uint64_t items_processed = items_processed_during_run_;
+  while ((state & kOrphaned) == 0) {
+    if (state_.compare_exchange_weak(state, state & ~kOwned,
+                                     std::memory_order_acq_rel)) {
+      break;
     }
+    // A callback was queued in the meantime, so keep running.
+    if ((state & kSizeMask) != 0) return true;
   }
-  return RefillResult::kRefilled;
-}
-
-bool WorkSerializer::DispatchingWorkSerializer::Refill() {
-  const auto result = RefillInner();
-  switch (result) {
-    case RefillResult::kRefilled:
-      // Reverse processing_ so that we can pop_back() items in the correct
-      // order. (note that this is mostly pointer swaps inside the
-      // std::function's, so should be relatively cheap even for longer
-      // lists). Do so here so we're outside of the RefillInner lock.
-      std::reverse(processing_.begin(), processing_.end());
-      return true;
-    case RefillResult::kFinished:
-      return false;
-    case RefillResult::kFinishedAndOrphaned:
-      // Orphaned and finished - finally delete this object.
-      // Here so that the mutex lock in RefillInner is released.
-      delete this;
-      return false;
-  }
-  GPR_UNREACHABLE_CODE(return false);
+  global_stats().IncrementWorkSerializerRunTimeMs(
+      std::chrono::duration_cast<std::chrono::milliseconds>(run_time).count());
+  global_stats().IncrementWorkSerializerWorkTimeMs(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          time_running_items)
+          .count());
+  global_stats().IncrementWorkSerializerItemsPerRun(items_processed);
+  // And if we're also orphaned then it's time to delete this object.
+  if ((state & kOrphaned) != 0) delete this;
+  return false;
 }
 
 //
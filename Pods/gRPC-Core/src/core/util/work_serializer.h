@@ -85,6 +85,10 @@ class ABSL_LOCKABLE WorkSerializer {
   // drained.
   void Schedule(std::function<void()> callback, const DebugLocation& location);
   // Drains the queue of callbacks.
+  //
+  // If experiment `work_serializer_dispatch` is enabled, the scheduled
+  // callbacks run inline if no other thread is currently executing the
+  // WorkSerializer, and otherwise after the callbacks ahead of them.
   void DrainQueue();
 
 #ifndef NDEBUG
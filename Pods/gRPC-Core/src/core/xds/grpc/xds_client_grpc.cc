@@ -61,6 +61,7 @@
 #include "src/core/xds/xds_client/xds_bootstrap.h"
 #include "src/core/xds/xds_client/xds_channel_args.h"
 #include "src/core/xds/xds_client/xds_client.h"
+#include "src/core/xds/xds_client/xds_resource_cache.h"
 #include "src/core/xds/xds_client/xds_transport.h"
 #include "upb/base/string_view.h"
 
@@ -262,6 +263,11 @@ absl::StatusOr<RefCountedPtr<GrpcXdsClient>> GrpcXdsClient::GetOrCreate(
         GetStatsPluginGroupForKeyAndChannelArgs(key, args));
   }
   // Otherwise, use the global instance.
+  absl::optional<absl::string_view> resource_cache_path =
+      args.GetString(GRPC_ARG_XDS_RESOURCE_CACHE_PATH);
+  if (resource_cache_path.has_value()) {
+    XdsResourceCache::Get().SetPersistencePath(*resource_cache_path);
+  }
   MutexLock lock(g_mu);
   auto it = g_xds_client_map->find(key);
   if (it != g_xds_client_map->end()) {
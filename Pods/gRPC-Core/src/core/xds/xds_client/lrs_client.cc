@@ -1254,7 +1254,7 @@ absl::Status LrsClient::ParseLrsResponse(absl::string_view encoded_response,
                                          bool* send_all_clusters,
                                          std::set<std::string>* cluster_names,
                                          Duration* load_reporting_interval) {
-  upb::Arena arena;
+  UpbParseArena arena;
   // Decode the response.
   const envoy_service_load_stats_v3_LoadStatsResponse* decoded_response =
       envoy_service_load_stats_v3_LoadStatsResponse_parse(
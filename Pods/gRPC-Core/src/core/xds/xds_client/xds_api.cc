@@ -283,7 +283,7 @@ void MaybeLogDiscoveryResponse(
 
 absl::Status XdsApi::ParseAdsResponse(absl::string_view encoded_response,
                                       AdsResponseParserInterface* parser) {
-  upb::Arena arena;
+  UpbParseArena arena;
   const XdsApiContext context = {client_, tracer_, def_pool_->ptr(),
                                  arena.ptr()};
   // Decode the response.
@@ -53,6 +53,7 @@
 #include "src/core/xds/xds_client/xds_api.h"
 #include "src/core/xds/xds_client/xds_bootstrap.h"
 #include "src/core/xds/xds_client/xds_locality.h"
+#include "src/core/xds/xds_client/xds_resource_cache.h"
 #include "upb/base/string_view.h"
 #include "upb/mem/arena.h"
 
@@ -236,10 +237,12 @@ class XdsClient::XdsChannel::AdsCall final
       // ADS stream restart).  If so, we don't start the timer, because
       // (a) we already have the resource and (b) the server may
       // optimize by not resending the resource that we already have.
+      // A resource loaded from the resource cache still needs the timer,
+      // since the server has not confirmed it yet.
       auto& authority_state =
           ads_call->xds_client()->authority_state_map_[name_.authority];
       ResourceState& state = authority_state.resource_map[type_][name_.key];
-      if (state.resource != nullptr) return;
+      if (state.resource != nullptr && !state.from_resource_cache) return;
       // Start timer.
       ads_call_ = std::move(ads_call);
       timer_handle_ = ads_call_->xds_client()->engine()->RunAfter(
@@ -260,7 +263,7 @@ class XdsClient::XdsChannel::AdsCall final
         ResourceState& state = authority_state.resource_map[type_][name_.key];
         // We might have received the resource after the timer fired but before
         // the callback ran.
-        if (state.resource == nullptr) {
+        if (state.resource == nullptr || state.from_resource_cache) {
           GRPC_TRACE_LOG(xds_client, INFO)
               << "[xds_client " << ads_call_->xds_client() << "] xds server "
               << ads_call_->xds_channel()->server_.server_uri()
@@ -270,6 +273,15 @@ class XdsClient::XdsChannel::AdsCall final
                      name_.authority, type_->type_url(), name_.key)
               << "} from xds server";
           resource_seen_ = true;
+          if (state.from_resource_cache) {
+            // The server did not confirm the saved resource.
+            state.resource.reset();
+            state.from_resource_cache = false;
+            XdsResourceCache::Get().Remove(
+                type_->type_url(),
+                XdsClient::ConstructFullXdsResourceName(
+                    name_.authority, type_->type_url(), name_.key));
+          }
           state.meta.client_status = XdsApi::ResourceMetadata::DOES_NOT_EXIST;
           ads_call_->xds_client()->NotifyWatchersOnResourceDoesNotExist(
               state.watchers, ReadDelayHandle::NoWait());
@@ -846,6 +858,17 @@ void XdsClient::XdsChannel::AdsCall::AdsResponseParser::ParseResource(
   }
   // Resource is valid.
   ++result_.num_valid_resources;
+  const bool from_resource_cache = resource_state.from_resource_cache;
+  resource_state.from_resource_cache = false;
+  auto save_to_resource_cache = [&]() {
+    XdsResourceCache::Get().Insert(
+        result_.type_url,
+        XdsClient::ConstructFullXdsResourceName(parsed_resource_name->authority,
+                                                result_.type_url,
+                                                parsed_resource_name->key),
+        ads_call_->xds_channel()->server_.server_uri(), result_.version,
+        serialized_resource);
+  };
   // If it didn't change, ignore it.
   if (resource_state.resource != nullptr &&
       result_.type->ResourcesEqual(resource_state.resource.get(),
@@ -853,12 +876,20 @@ void XdsClient::XdsChannel::AdsCall::AdsResponseParser::ParseResource(
     GRPC_TRACE_LOG(xds_client, INFO)
         << "[xds_client " << xds_client() << "] " << result_.type_url
         << " resource " << resource_name << " identical to current, ignoring.";
+    // The watchers already have the resource loaded from the resource
+    // cache, but CSDS should now show the server's version.
+    if (from_resource_cache) {
+      resource_state.meta = CreateResourceMetadataAcked(
+          std::string(serialized_resource), result_.version, update_time_);
+      save_to_resource_cache();
+    }
     return;
   }
   // Update the resource state.
   resource_state.resource = std::move(*decode_result.resource);
   resource_state.meta = CreateResourceMetadataAcked(
       std::string(serialized_resource), result_.version, update_time_);
+  save_to_resource_cache();
   // Notify watchers.
   auto& watchers_list = resource_state.watchers;
   xds_client()->work_serializer_.Schedule(
@@ -1091,7 +1122,11 @@ void XdsClient::XdsChannel::AdsCall::OnRecvMessage(absl::string_view payload) {
               // its absence from the response does not necessarily indicate
               // that the resource does not exist.  For that case, we rely on
               // the request timeout instead.
-              if (resource_state.resource == nullptr) continue;
+              // The same goes for a resource loaded from the resource cache.
+              if (resource_state.resource == nullptr ||
+                  resource_state.from_resource_cache) {
+                continue;
+              }
               if (xds_channel()->server_.IgnoreResourceDeletion()) {
                 if (!resource_state.ignored_deletion) {
                   LOG(ERROR)
@@ -1107,6 +1142,10 @@ void XdsClient::XdsChannel::AdsCall::OnRecvMessage(absl::string_view payload) {
                 resource_state.resource.reset();
                 resource_state.meta.client_status =
                     XdsApi::ResourceMetadata::DOES_NOT_EXIST;
+                XdsResourceCache::Get().Remove(
+                    result.type_url,
+                    XdsClient::ConstructFullXdsResourceName(
+                        authority, result.type_url.c_str(), resource_key));
                 xds_client()->NotifyWatchersOnResourceDoesNotExist(
                     resource_state.watchers, read_delay_handle);
               }
@@ -1340,6 +1379,8 @@ void XdsClient::WatchResource(const XdsResourceType* type,
           }
         }
       }
+      MaybeLoadFromResourceCacheLocked(type, *resource_name, xds_servers,
+                                       resource_state);
       for (const auto& channel : authority_state.xds_channels) {
         channel->SubscribeLocked(type, *resource_name);
       }
@@ -1520,6 +1561,49 @@ void XdsClient::ResetBackoff() {
   }
 }
 
+void XdsClient::MaybeLoadFromResourceCacheLocked(
+    const XdsResourceType* type, const XdsResourceName& resource_name,
+    const std::vector<const XdsBootstrap::XdsServer*>& xds_servers,
+    ResourceState& resource_state) {
+  const std::string name = ConstructFullXdsResourceName(
+      resource_name.authority, type->type_url(), resource_name.key);
+  auto entry = XdsResourceCache::Get().Find(type->type_url(), name);
+  if (!entry.has_value()) return;
+  // Only use the resource if it came from a server we would still ask.
+  auto server_it = std::find_if(
+      xds_servers.begin(), xds_servers.end(),
+      [&](const XdsBootstrap::XdsServer* server) {
+        return server->server_uri() == entry->server_uri;
+      });
+  if (server_it == xds_servers.end()) return;
+  UpbParseArena arena;
+  XdsResourceType::DecodeContext context = {this, **server_it,
+                                            &xds_client_trace, def_pool_.ptr(),
+                                            arena.ptr()};
+  XdsResourceType::DecodeResult decode_result =
+      type->Decode(context, entry->serialized_resource);
+  if (!decode_result.resource.ok()) {
+    XdsResourceCache::Get().Remove(type->type_url(), name);
+    return;
+  }
+  GRPC_TRACE_LOG(xds_client, INFO)
+      << "[xds_client " << this << "] using saved version "
+      << entry->version << " of " << type->type_url() << " resource " << name;
+  // The metadata is left as REQUESTED until the server confirms the
+  // resource.
+  resource_state.resource = std::move(*decode_result.resource);
+  resource_state.from_resource_cache = true;
+  work_serializer_.Schedule(
+      [watchers = resource_state.watchers, value = resource_state.resource]()
+          ABSL_EXCLUSIVE_LOCKS_REQUIRED(&work_serializer_) {
+            for (const auto& p : watchers) {
+              p.first->OnGenericResourceChanged(value,
+                                                ReadDelayHandle::NoWait());
+            }
+          },
+      DEBUG_LOCATION);
+}
+
 void XdsClient::NotifyWatchersOnErrorLocked(
     const std::map<ResourceWatcherInterface*,
                    RefCountedPtr<ResourceWatcherInterface>>& watchers,
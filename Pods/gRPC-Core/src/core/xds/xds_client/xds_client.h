@@ -260,6 +260,9 @@ class XdsClient : public DualRefCounted<XdsClient> {
     std::shared_ptr<const XdsResourceType::ResourceData> resource;
     XdsApi::ResourceMetadata meta;
     bool ignored_deletion = false;
+    // True if resource was loaded from the XdsResourceCache and has not
+    // yet been confirmed by the xDS server.
+    bool from_resource_cache = false;
   };
 
   struct AuthorityState {
@@ -268,6 +271,13 @@ class XdsClient : public DualRefCounted<XdsClient> {
         resource_map;
   };
 
+  // Gives the watchers of a newly watched resource the version saved in the
+  // XdsResourceCache, if it came from one of xds_servers.
+  void MaybeLoadFromResourceCacheLocked(
+      const XdsResourceType* type, const XdsResourceName& resource_name,
+      const std::vector<const XdsBootstrap::XdsServer*>& xds_servers,
+      ResourceState& resource_state) ABSL_EXCLUSIVE_LOCKS_REQUIRED(&mu_);
+
   // Sends an error notification to a specific set of watchers.
   void NotifyWatchersOnErrorLocked(
       const std::map<ResourceWatcherInterface*,
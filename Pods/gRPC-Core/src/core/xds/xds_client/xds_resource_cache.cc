@@ -0,0 +1,180 @@
+// Copyright 2024 The gRPC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/core/xds/xds_client/xds_resource_cache.h"
+
+#include <grpc/event_engine/event_engine.h>
+#include <grpc/support/port_platform.h>
+#include <stdio.h>
+
+#include <chrono>
+
+#include "absl/log/log.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "src/core/lib/debug/trace.h"
+#include "src/core/lib/event_engine/default_event_engine.h"
+#include "src/core/util/load_file.h"
+#include "src/core/util/no_destruct.h"
+
+namespace grpc_core {
+
+namespace {
+
+// Files written by a different format version are ignored.
+constexpr absl::string_view kFileHeader = "grpc-xds-resource-cache 1\n";
+// Bounds the size of the file. Resources beyond this are not saved.
+constexpr size_t kMaxEntries = 512;
+// How long to wait before writing the file after a change.
+constexpr auto kSaveDelay = std::chrono::seconds(1);
+
+// Each field is written as its length in decimal, a colon and its bytes, so
+// that it can hold the binary serialized resources.
+void AppendField(absl::string_view field, std::string* out) {
+  absl::StrAppend(out, field.size(), ":", field);
+}
+
+bool ConsumeField(absl::string_view* input, absl::string_view* field) {
+  const size_t colon = input->find(':');
+  if (colon == absl::string_view::npos) return false;
+  size_t size;
+  if (!absl::SimpleAtoi(input->substr(0, colon), &size) ||
+      size > input->size() - colon - 1) {
+    return false;
+  }
+  *field = input->substr(colon + 1, size);
+  input->remove_prefix(colon + 1 + size);
+  return true;
+}
+
+}  // namespace
+
+XdsResourceCache& XdsResourceCache::Get() {
+  static NoDestruct<XdsResourceCache> cache;
+  return *cache;
+}
+
+absl::optional<XdsResourceCache::Entry> XdsResourceCache::Find(
+    absl::string_view type_url, absl::string_view name) {
+  MutexLock lock(&mu_);
+  auto it = entries_.find(Key(type_url, name));
+  if (it == entries_.end()) return absl::nullopt;
+  return it->second;
+}
+
+void XdsResourceCache::Insert(absl::string_view type_url,
+                              absl::string_view name,
+                              absl::string_view server_uri,
+                              absl::string_view version,
+                              absl::string_view serialized_resource) {
+  MutexLock lock(&mu_);
+  if (path_.empty()) return;
+  Key key(type_url, name);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    if (entries_.size() >= kMaxEntries) return;
+    it = entries_.emplace(std::move(key), Entry()).first;
+  } else if (it->second.server_uri == server_uri &&
+             it->second.version == version &&
+             it->second.serialized_resource == serialized_resource) {
+    return;
+  }
+  it->second.server_uri = std::string(server_uri);
+  it->second.version = std::string(version);
+  it->second.serialized_resource = std::string(serialized_resource);
+  MaybeScheduleSaveLocked();
+}
+
+void XdsResourceCache::Remove(absl::string_view type_url,
+                              absl::string_view name) {
+  MutexLock lock(&mu_);
+  if (entries_.erase(Key(type_url, name)) > 0) MaybeScheduleSaveLocked();
+}
+
+void XdsResourceCache::SetPersistencePath(absl::string_view path) {
+  MutexLock lock(&mu_);
+  if (path == path_) return;
+  path_ = std::string(path);
+  LoadLocked();
+}
+
+// After kFileHeader, the file holds five fields per resource: its type URL,
+// name, server URI, version and serialized proto.
+void XdsResourceCache::LoadLocked() {
+  auto contents = LoadFile(path_, /*add_null_terminator=*/false);
+  if (!contents.ok()) return;
+  absl::string_view input = contents->as_string_view();
+  if (!absl::ConsumePrefix(&input, kFileHeader)) {
+    VLOG(2) << "[xds_resource_cache] ignoring " << path_
+            << ": unknown format";
+    return;
+  }
+  while (!input.empty() && entries_.size() < kMaxEntries) {
+    absl::string_view type_url, name, server_uri, version, resource;
+    if (!ConsumeField(&input, &type_url) || !ConsumeField(&input, &name) ||
+        !ConsumeField(&input, &server_uri) ||
+        !ConsumeField(&input, &version) || !ConsumeField(&input, &resource)) {
+      VLOG(2) << "[xds_resource_cache] " << path_ << " is truncated";
+      break;
+    }
+    entries_.emplace(Key(type_url, name),
+                     Entry{std::string(server_uri), std::string(version),
+                           std::string(resource)});
+  }
+  GRPC_TRACE_LOG(xds_client, INFO)
+      << "[xds_resource_cache] loaded " << entries_.size()
+      << " resources from " << path_;
+}
+
+void XdsResourceCache::MaybeScheduleSaveLocked() {
+  if (path_.empty() || save_pending_) return;
+  save_pending_ = true;
+  grpc_event_engine::experimental::GetDefaultEventEngine()->RunAfter(
+      kSaveDelay, [this]() { Save(); });
+}
+
+void XdsResourceCache::Save() {
+  MutexLock save_lock(&save_mu_);
+  std::string path;
+  std::string contents(kFileHeader);
+  {
+    MutexLock lock(&mu_);
+    save_pending_ = false;
+    path = path_;
+    for (const auto& key_and_entry : entries_) {
+      AppendField(key_and_entry.first.first, &contents);
+      AppendField(key_and_entry.first.second, &contents);
+      AppendField(key_and_entry.second.server_uri, &contents);
+      AppendField(key_and_entry.second.version, &contents);
+      AppendField(key_and_entry.second.serialized_resource, &contents);
+    }
+  }
+  // Write a new file and move it into place, so that a crash mid-write
+  // leaves the previous resources rather than a partial file.
+  const std::string temp_path = absl::StrCat(path, ".tmp");
+  FILE* file = fopen(temp_path.c_str(), "wb");
+  if (file == nullptr) {
+    VLOG(2) << "[xds_resource_cache] cannot write " << temp_path;
+    return;
+  }
+  const bool written =
+      fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+  if (fclose(file) != 0 || !written ||
+      rename(temp_path.c_str(), path.c_str()) != 0) {
+    VLOG(2) << "[xds_resource_cache] cannot save resources to " << path;
+    remove(temp_path.c_str());
+  }
+}
+
+}  // namespace grpc_core
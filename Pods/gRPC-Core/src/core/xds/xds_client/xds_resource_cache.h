@@ -0,0 +1,84 @@
+// Copyright 2024 The gRPC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GRPC_SRC_CORE_XDS_XDS_CLIENT_XDS_RESOURCE_CACHE_H
+#define GRPC_SRC_CORE_XDS_XDS_CLIENT_XDS_RESOURCE_CACHE_H
+
+#include <grpc/support/port_platform.h>
+
+#include <string>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "src/core/util/sync.h"
+
+namespace grpc_core {
+
+// A file that keeps the xDS resources a process has accepted, so that the
+// next process can hand them to its watchers right away instead of waiting
+// for the xDS server. The XdsClient still subscribes as usual: the server's
+// answer replaces a saved resource, and a saved resource the server never
+// confirms is reported as not existing once the request times out.
+//
+// Does nothing until SetPersistencePath() is called.
+class XdsResourceCache final {
+ public:
+  struct Entry {
+    // The server the resource came from. A resource is only used if that
+    // server is still configured for its authority.
+    std::string server_uri;
+    std::string version;
+    std::string serialized_resource;
+  };
+
+  static XdsResourceCache& Get();
+
+  // Returns the resource saved for type_url and name, if there is one.
+  absl::optional<Entry> Find(absl::string_view type_url,
+                             absl::string_view name);
+
+  // Saves a resource accepted from server_uri. The file is written shortly
+  // after, so that the updates of one response are written together.
+  void Insert(absl::string_view type_url, absl::string_view name,
+              absl::string_view server_uri, absl::string_view version,
+              absl::string_view serialized_resource);
+
+  // Forgets a resource that no longer exists.
+  void Remove(absl::string_view type_url, absl::string_view name);
+
+  // Backs the cache with the file at path. The first call loads the
+  // resources saved in the file.
+  void SetPersistencePath(absl::string_view path);
+
+ private:
+  using Key = std::pair<std::string /*type_url*/, std::string /*name*/>;
+
+  void LoadLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void MaybeScheduleSaveLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void Save() ABSL_LOCKS_EXCLUDED(mu_);
+
+  Mutex mu_;
+  absl::flat_hash_map<Key, Entry> entries_ ABSL_GUARDED_BY(mu_);
+  std::string path_ ABSL_GUARDED_BY(mu_);
+  bool save_pending_ ABSL_GUARDED_BY(mu_) = false;
+  // Held while writing the file, so that two saves do not interleave.
+  Mutex save_mu_;
+};
+
+}  // namespace grpc_core
+
+#endif  // GRPC_SRC_CORE_XDS_XDS_CLIENT_XDS_RESOURCE_CACHE_H
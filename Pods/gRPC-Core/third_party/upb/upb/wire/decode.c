@@ -126,8 +126,11 @@ const char* _upb_FastDecoder_ErrorJmp(upb_Decoder* d, int status) {
   return NULL;
 }
 
-static void _upb_Decoder_VerifyUtf8(upb_Decoder* d, const char* buf, int len) {
-  if (!_upb_Decoder_VerifyUtf8Inline(buf, len)) {
+UPB_NOINLINE
+void _upb_Decoder_FlushUtf8(upb_Decoder* d) {
+  int count = d->utf8_count;
+  d->utf8_count = 0;
+  if (!utf8_range_IsValidSpans(d->utf8_pending, count)) {
     _upb_Decoder_ErrorJmp(d, kUpb_DecodeStatus_BadUtf8);
   }
 }
@@ -548,14 +551,16 @@ static const char* _upb_Decoder_DecodeToArray(
       memcpy(mem, val, 1 << op);
       return ptr;
     case kUpb_DecodeOp_String:
-      _upb_Decoder_VerifyUtf8(d, ptr, val->size);
-      /* Fallthrough. */
     case kUpb_DecodeOp_Bytes: {
       /* Append bytes. */
       upb_StringView* str = (upb_StringView*)upb_Array_MutableDataPtr(arr) +
                             arr->UPB_PRIVATE(size);
       arr->UPB_PRIVATE(size)++;
-      return _upb_Decoder_ReadString(d, ptr, val->size, str);
+      ptr = _upb_Decoder_ReadString(d, ptr, val->size, str);
+      if (op == kUpb_DecodeOp_String) {
+        _upb_Decoder_VerifyUtf8(d, str->data, str->size);
+      }
+      return ptr;
     }
     case kUpb_DecodeOp_SubMessage: {
       /* Append submessage / group. */
@@ -734,10 +739,14 @@ static const char* _upb_Decoder_DecodeToSubMessage(
       break;
     }
     case kUpb_DecodeOp_String:
-      _upb_Decoder_VerifyUtf8(d, ptr, val->size);
-      /* Fallthrough. */
-    case kUpb_DecodeOp_Bytes:
-      return _upb_Decoder_ReadString(d, ptr, val->size, mem);
+    case kUpb_DecodeOp_Bytes: {
+      upb_StringView* str = mem;
+      ptr = _upb_Decoder_ReadString(d, ptr, val->size, str);
+      if (op == kUpb_DecodeOp_String) {
+        _upb_Decoder_VerifyUtf8(d, str->data, str->size);
+      }
+      return ptr;
+    }
     case kUpb_DecodeOp_Scalar8Byte:
       memcpy(mem, val, 8);
       break;
@@ -1348,6 +1357,7 @@ static upb_DecodeStatus _upb_Decoder_DecodeTop(struct upb_Decoder* d,
   if (!_upb_Decoder_TryFastDispatch(d, &buf, msg, m)) {
     _upb_Decoder_DecodeMessage(d, buf, msg, m);
   }
+  _upb_Decoder_FlushUtf8(d);
   if (d->end_group != DECODE_NOGROUP) return kUpb_DecodeStatus_Malformed;
   if (d->missing_required) return kUpb_DecodeStatus_MissingRequired;
   return kUpb_DecodeStatus_Ok;
@@ -1394,6 +1404,7 @@ upb_DecodeStatus upb_Decode(const char* buf, size_t size, upb_Message* msg,
   decoder.options = (uint16_t)options;
   decoder.missing_required = false;
   decoder.status = kUpb_DecodeStatus_Ok;
+  decoder.utf8_count = 0;
 
   // Violating the encapsulation of the arena for performance reasons.
   // This is a temporary arena that we swap into and swap out of when we are
@@ -24,6 +24,9 @@
 
 #define DECODE_NOGROUP (uint32_t) - 1
 
+// Number of string fields that are queued before their UTF-8 is validated.
+#define UPB_DECODER_UTF8_BATCH 16
+
 typedef struct upb_Decoder {
   upb_EpsCopyInputStream input;
   const upb_ExtensionRegistry* extreg;
@@ -38,6 +41,9 @@ typedef struct upb_Decoder {
     void* foo[UPB_ARENA_SIZE_HACK];
   };
   upb_DecodeStatus status;
+  int utf8_count;
+  // Strings that still have to be validated, see _upb_Decoder_VerifyUtf8().
+  utf8_range_Span utf8_pending[UPB_DECODER_UTF8_BATCH];
   jmp_buf err;
 
 #ifndef NDEBUG
@@ -57,9 +63,19 @@ const char* _upb_FastDecoder_ErrorJmp(upb_Decoder* d, int status);
 
 extern const uint8_t upb_utf8_offsets[];
 
+// Validates the queued strings, failing the decode if one of them is not
+// valid UTF-8.
+void _upb_Decoder_FlushUtf8(upb_Decoder* d);
+
+// Queues a string for UTF-8 validation. Strings are validated in batches, at
+// the latest when the decode finishes, so "ptr" must point into the input
+// buffer or the arena rather than into the patch buffer.
 UPB_INLINE
-bool _upb_Decoder_VerifyUtf8Inline(const char* ptr, int len) {
-  return utf8_range_IsValid(ptr, len);
+void _upb_Decoder_VerifyUtf8(upb_Decoder* d, const char* ptr, size_t len) {
+  if (d->utf8_count == UPB_DECODER_UTF8_BATCH) _upb_Decoder_FlushUtf8(d);
+  d->utf8_pending[d->utf8_count].data = ptr;
+  d->utf8_pending[d->utf8_count].len = len;
+  d->utf8_count++;
 }
 
 const char* _upb_Decoder_CheckRequired(upb_Decoder* d, const char* ptr,
@@ -465,3 +465,29 @@ int utf8_range_IsValid(const char* data, size_t len) {
 size_t utf8_range_ValidPrefix(const char* data, size_t len) {
   return utf8_range_Validate(data, len, /*return_position=*/1);
 }
+
+int utf8_range_IsValidSpans(const utf8_range_Span* spans, size_t count) {
+  /* Strings are mostly short and ASCII, so first OR together the bytes of all
+     of them, in a loop without early exits that the compiler vectorizes. Only
+     if some byte is not ASCII are the spans validated one by one.
+   */
+  uint64_t bits = 0;
+  for (size_t i = 0; i < count; ++i) {
+    const char* data = spans[i].data;
+    const char* const end = data + spans[i].len;
+    for (; 8 <= end - data; data += 8) {
+      bits |= utf8_range_UnalignedLoad64(data);
+    }
+    for (; data < end; ++data) {
+      bits |= (unsigned char)*data;
+    }
+  }
+  if ((bits & 0x8080808080808080) == 0) return 1;
+  for (size_t i = 0; i < count; ++i) {
+    if (utf8_range_Validate(spans[i].data, spans[i].len,
+                            /*return_position=*/0) == 0) {
+      return 0;
+    }
+  }
+  return 1;
+}
@@ -6,41 +6,68 @@
 
 #include "db/dbformat.h"
 #include "db/filename.h"
+#include "db/range_del.h"
 #include "db/table_cache.h"
 #include "db/version_edit.h"
 #include "leveldb/db.h"
 #include "leveldb/env.h"
 #include "leveldb/iterator.h"
+#include "util/rate_limiter_imp.h"
 
 namespace leveldb {
 
+void BlockCompressionStats::Add(const TableBuilder& builder) {
+  blocks += builder.NumBlocks();
+  compressed_blocks += builder.NumCompressedBlocks();
+  raw_bytes += builder.RawBlockBytes();
+  stored_bytes += builder.StoredBlockBytes();
+}
+
 Status BuildTable(const std::string& dbname, Env* env, const Options& options,
-                  TableCache* table_cache, Iterator* iter, FileMetaData* meta) {
+                  TableCache* table_cache, Iterator* iter,
+                  const std::vector<RangeTombstone>& range_dels,
+                  FileMetaData* meta, BlockCompressionStats* compression) {
   Status s;
   meta->file_size = 0;
   iter->SeekToFirst();
 
   std::string fname = TableFileName(dbname, meta->number);
-  if (iter->Valid()) {
+  if (iter->Valid() || !range_dels.empty()) {
     WritableFile* file;
     s = env->NewWritableFile(fname, &file);
     if (!s.ok()) {
       return s;
     }
+    file = NewRateLimitedWritableFile(file, options.rate_limiter,
+                                      RateLimiter::kFlush);
 
     TableBuilder* builder = new TableBuilder(options, file);
-    meta->smallest.DecodeFrom(iter->key());
+    bool empty = !iter->Valid();
+    if (!empty) {
+      meta->smallest.DecodeFrom(iter->key());
+    }
     for (; iter->Valid(); iter->Next()) {
       Slice key = iter->key();
       meta->largest.DecodeFrom(key);
       builder->Add(key, iter->value());
     }
+    // Tables of a DB are always built with an InternalKeyComparator.
+    const InternalKeyComparator& icmp =
+        *static_cast<const InternalKeyComparator*>(options.comparator);
+    for (const RangeTombstone& t : range_dels) {
+      builder->AddRangeDeletion(RangeTombstoneKey(t), t.end);
+      ExtendRangeToTombstone(icmp, t, &empty, &meta->smallest,
+                             &meta->largest);
+    }
 
     // Finish and check for builder errors
     s = builder->Finish();
     if (s.ok()) {
       meta->file_size = builder->FileSize();
       assert(meta->file_size > 0);
+      if (compression != nullptr) {
+        compression->Add(*builder);
+      }
     }
     delete builder;
 
@@ -55,9 +82,10 @@ Status BuildTable(const std::string& dbname, Env* env, const Options& options,
     file = nullptr;
 
     if (s.ok()) {
-      // Verify that the table is usable
+      // Verify that the table is usable.  Tables built from a memtable
+      // almost always end up in level-0, so open it as a level-0 table.
       Iterator* it = table_cache->NewIterator(ReadOptions(), meta->number,
-                                              meta->file_size);
+                                              meta->file_size, 0);
       s = it->status();
       delete it;
     }
@@ -5,6 +5,9 @@
 #ifndef STORAGE_LEVELDB_DB_BUILDER_H_
 #define STORAGE_LEVELDB_DB_BUILDER_H_
 
+#include <cstdint>
+#include <vector>
+
 #include "leveldb/status.h"
 
 namespace leveldb {
@@ -14,16 +17,44 @@ struct FileMetaData;
 
 class Env;
 class Iterator;
+struct RangeTombstone;
+class TableBuilder;
 class TableCache;
 class VersionEdit;
 
-// Build a Table file from the contents of *iter.  The generated file
-// will be named according to meta->number.  On success, the rest of
-// *meta will be filled with metadata about the generated table.
-// If no data is present in *iter, meta->file_size will be set to
-// zero, and no Table file will be produced.
+// Totals of the blocks written by one or more TableBuilders.
+struct BlockCompressionStats {
+  BlockCompressionStats()
+      : blocks(0), compressed_blocks(0), raw_bytes(0), stored_bytes(0) {}
+
+  void Add(const BlockCompressionStats& c) {
+    blocks += c.blocks;
+    compressed_blocks += c.compressed_blocks;
+    raw_bytes += c.raw_bytes;
+    stored_bytes += c.stored_bytes;
+  }
+
+  // Add the blocks written so far by *builder.
+  void Add(const TableBuilder& builder);
+
+  int64_t blocks;
+  int64_t compressed_blocks;
+  int64_t raw_bytes;
+  int64_t stored_bytes;
+};
+
+// Build a Table file from the contents of *iter and the range deletions
+// "range_dels".  The generated file will be named according to
+// meta->number.  On success, the rest of *meta will be filled with metadata
+// about the generated table, whose key range includes that of the range
+// deletions.  If there is neither data in *iter nor a range deletion,
+// meta->file_size will be set to zero, and no Table file will be produced.
+// If compression is non-null, the blocks of the generated table are added
+// to it.
 Status BuildTable(const std::string& dbname, Env* env, const Options& options,
-                  TableCache* table_cache, Iterator* iter, FileMetaData* meta);
+                  TableCache* table_cache, Iterator* iter,
+                  const std::vector<RangeTombstone>& range_dels,
+                  FileMetaData* meta, BlockCompressionStats* compression);
 
 }  // namespace leveldb
 
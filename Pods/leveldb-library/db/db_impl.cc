@@ -8,6 +8,7 @@
 #include <atomic>
 #include <cstdint>
 #include <cstdio>
+#include <deque>
 #include <set>
 #include <string>
 #include <vector>
@@ -19,9 +20,11 @@
 #include "db/log_reader.h"
 #include "db/log_writer.h"
 #include "db/memtable.h"
+#include "db/range_del.h"
 #include "db/table_cache.h"
 #include "db/version_set.h"
 #include "db/write_batch_internal.h"
+#include "leveldb/compaction_filter.h"
 #include "leveldb/db.h"
 #include "leveldb/env.h"
 #include "leveldb/status.h"
@@ -31,9 +34,13 @@
 #include "table/block.h"
 #include "table/merger.h"
 #include "table/two_level_iterator.h"
+#include "util/allocation_stats.h"
+#include "util/arena.h"
 #include "util/coding.h"
 #include "util/logging.h"
 #include "util/mutexlock.h"
+#include "util/perf_context_imp.h"
+#include "util/rate_limiter_imp.h"
 
 namespace leveldb {
 
@@ -42,15 +49,24 @@ const int kNumNonTableCacheFiles = 10;
 // Information kept for every waiting writer
 struct DBImpl::Writer {
   explicit Writer(port::Mutex* mu)
-      : batch(nullptr), sync(false), done(false), cv(mu) {}
+      : batch(nullptr), sync(false), done(false), insert_mem(nullptr), cv(mu) {}
 
   Status status;
   WriteBatch* batch;
   bool sync;
   bool done;
+  MemTable* insert_mem;  // Non-null while this writer must insert its batch
   port::CondVar cv;
 };
 
+// A write group that has been appended to the log and is waiting for, or
+// running, its memtable insertion.  Only used for pipelined writes.
+struct DBImpl::MemTableGroup {
+  Writer* leader;
+  std::vector<Writer*> followers;
+  SequenceNumber last_sequence;  // Last sequence number used by the group
+};
+
 struct DBImpl::CompactionState {
   // Files produced by compaction
   struct Output {
@@ -76,6 +92,11 @@ struct DBImpl::CompactionState {
   // we can drop all entries for the same key with sequence numbers < S.
   SequenceNumber smallest_snapshot;
 
+  // Entries with larger sequence numbers are seen by no snapshot, only by
+  // reads of the latest state, so the compaction filter may drop them.
+  // Zero if there are no snapshots.
+  SequenceNumber newest_snapshot = 0;
+
   std::vector<Output> outputs;
 
   // State kept for output being generated
@@ -83,6 +104,18 @@ struct DBImpl::CompactionState {
   TableBuilder* builder;
 
   uint64_t total_bytes;
+  BlockCompressionStats compression;  // Blocks of the finished outputs
+
+  // The range deletions of the compaction inputs.
+  std::vector<RangeTombstone> range_dels;
+
+  // The range deletions that are still needed, clipped to the key range
+  // being compacted.  Each output gets the parts of them from
+  // output_lower, where the previous output ended, to where the next one
+  // starts, so outputs never overlap.
+  std::vector<RangeTombstone> output_range_dels;
+  std::string output_lower;
+  bool has_output_lower = false;
 };
 
 // Fix user-supplied options to be reasonable
@@ -100,8 +133,16 @@ Options SanitizeOptions(const std::string& dbname,
   result.filter_policy = (src.filter_policy != nullptr) ? ipolicy : nullptr;
   ClipToRange(&result.max_open_files, 64 + kNumNonTableCacheFiles, 50000);
   ClipToRange(&result.write_buffer_size, 64 << 10, 1 << 30);
+  if (result.memtable_arena_block_size != 0) {
+    // A memtable should take several blocks before it is full.
+    ClipToRange(&result.memtable_arena_block_size, size_t{4 << 10},
+                result.write_buffer_size / 8);
+  }
   ClipToRange(&result.max_file_size, 1 << 20, 1 << 30);
   ClipToRange(&result.block_size, 1 << 10, 4 << 20);
+  ClipToRange(&result.max_background_compactions, 1, 64);
+  ClipToRange(&result.max_subcompactions, 1, 64);
+  ClipToRange(&result.format_version, 0, 1);
   if (result.info_log == nullptr) {
     // Open a log file in the same directory as the db
     src.env->CreateDir(dbname);  // In case it does not exist
@@ -123,6 +164,18 @@ static int TableCacheSize(const Options& sanitized_options) {
   return sanitized_options.max_open_files - kNumNonTableCacheFiles;
 }
 
+static ArenaBlockPool* NewMemTableArenaPool(const Options& sanitized_options) {
+  const size_t block_size = sanitized_options.memtable_arena_block_size;
+  if (block_size == 0) {
+    return nullptr;
+  }
+  // Keep enough free blocks for the next memtable.
+  const size_t max_free_blocks =
+      sanitized_options.write_buffer_size / block_size + 1;
+  return new ArenaBlockPool(block_size, max_free_blocks,
+                            sanitized_options.memtable_huge_pages);
+}
+
 DBImpl::DBImpl(const Options& raw_options, const std::string& dbname)
     : env_(raw_options.env),
       internal_comparator_(raw_options.comparator),
@@ -133,6 +186,7 @@ DBImpl::DBImpl(const Options& raw_options, const std::string& dbname)
       owns_cache_(options_.block_cache != raw_options.block_cache),
       dbname_(dbname),
       table_cache_(new TableCache(dbname_, options_, TableCacheSize(options_))),
+      arena_pool_(NewMemTableArenaPool(options_)),
       db_lock_(nullptr),
       shutting_down_(false),
       background_work_finished_signal_(&mutex_),
@@ -144,18 +198,60 @@ DBImpl::DBImpl(const Options& raw_options, const std::string& dbname)
       log_(nullptr),
       seed_(0),
       tmp_batch_(new WriteBatch),
-      background_compaction_scheduled_(false),
+      pending_memtable_inserts_(0),
+      memtable_inserts_done_signal_(&mutex_),
+      log_bytes_(0),
+      log_synced_bytes_(0),
+      log_sync_requested_bytes_(0),
+      log_sync_request_micros_(0),
+      log_sync_thread_running_(false),
+      log_sync_requested_signal_(&mutex_),
+      log_synced_signal_(&mutex_),
+      background_compactions_scheduled_(0),
+      running_table_compactions_(0),
+      imm_compaction_running_(false),
+      preloading_tables_(false),
+      ingestion_running_(false),
+      manifest_write_running_(false),
+      manifest_write_finished_signal_(&mutex_),
+      pending_subcompactions_(0),
+      subcompactions_finished_signal_(&mutex_),
       manual_compaction_(nullptr),
       versions_(new VersionSet(dbname_, &options_, table_cache_,
-                               &internal_comparator_)) {}
+                               &internal_comparator_)) {
+  if (options_.max_background_compactions > 1) {
+    env_->SetBackgroundThreads(options_.max_background_compactions);
+  }
+  for (int i = 0; i < kNumOpTypes; i++) {
+    op_latency_[i].Clear();
+  }
+}
 
 DBImpl::~DBImpl() {
   // Wait for background work to finish.
   mutex_.Lock();
+  if (options_.flush_on_close) {
+    // Shutting down aborts the flush of imm_, so let it finish first.
+    while (imm_ != nullptr && bg_error_.ok() &&
+           background_compactions_scheduled_ > 0) {
+      background_work_finished_signal_.Wait();
+    }
+  }
   shutting_down_.store(true, std::memory_order_release);
-  while (background_compaction_scheduled_) {
+  while (background_compactions_scheduled_ > 0 || preloading_tables_) {
     background_work_finished_signal_.Wait();
   }
+  log_sync_requested_signal_.Signal();
+  while (log_sync_thread_running_) {
+    log_synced_signal_.Wait();
+  }
+  if (options_.flush_on_close && log_ != nullptr && bg_error_.ok()) {
+    Status s = FlushMemTablesForClose();
+    if (!s.ok()) {
+      // The logs are still there, and are replayed by the next open.
+      Log(options_.info_log, "Flush on close failed: %s", s.ToString().c_str());
+    }
+  }
   mutex_.Unlock();
 
   if (db_lock_ != nullptr) {
@@ -169,6 +265,7 @@ DBImpl::~DBImpl() {
   delete log_;
   delete logfile_;
   delete table_cache_;
+  delete arena_pool_;
 
   if (owns_info_log_) {
     delete options_.info_log;
@@ -178,6 +275,50 @@ DBImpl::~DBImpl() {
   }
 }
 
+Status DBImpl::FlushMemTablesForClose() {
+  mutex_.AssertHeld();
+  // Background work is over, so imm_ is not being written.  Both go to
+  // level-0, where imm_ gets the older table.
+  std::vector<MemTable*> mems;
+  if (imm_ != nullptr) {
+    mems.push_back(imm_);
+  }
+  {
+    std::vector<RangeTombstone> range_dels;
+    mem_->GetRangeTombstones(&range_dels);
+    Iterator* iter = mem_->NewIterator();
+    iter->SeekToFirst();
+    if (iter->Valid() || !range_dels.empty()) {
+      mems.push_back(mem_);
+    }
+    delete iter;
+  }
+  if (mems.empty()) {
+    return Status::OK();
+  }
+
+  VersionEdit edit;
+  Status s;
+  for (size_t i = 0; i < mems.size() && s.ok(); i++) {
+    s = WriteLevel0Table(mems[i], &edit, nullptr, nullptr);
+  }
+  if (s.ok()) {
+    // No log, not even the current one, holds updates that are not in a
+    // table any more.
+    edit.SetPrevLogNumber(0);
+    edit.SetLogNumber(versions_->NewFileNumber());
+    s = LogAndApply(&edit);
+  }
+  if (s.ok()) {
+    delete log_;
+    delete logfile_;
+    log_ = nullptr;
+    logfile_ = nullptr;
+    RemoveObsoleteFiles();
+  }
+  return s;
+}
+
 Status DBImpl::NewDB() {
   VersionEdit new_db;
   new_db.SetComparatorName(user_comparator()->Name());
@@ -357,10 +498,14 @@ Status DBImpl::Recover(VersionEdit* edit, bool* save_manifest) {
 
   // Recover in the order in which the logs were generated
   std::sort(logs.begin(), logs.end());
+  MemTable* mem = nullptr;
   for (size_t i = 0; i < logs.size(); i++) {
     s = RecoverLogFile(logs[i], (i == logs.size() - 1), save_manifest, edit,
-                       &max_sequence);
+                       &max_sequence, &mem);
     if (!s.ok()) {
+      if (mem != nullptr) {
+        mem->Unref();
+      }
       return s;
     }
 
@@ -374,12 +519,151 @@ Status DBImpl::Recover(VersionEdit* edit, bool* save_manifest) {
     versions_->SetLastSequence(max_sequence);
   }
 
+  if (mem != nullptr) {
+    // Deferred: DB::Open() keeps the logs, and the memtable is written to a
+    // table like any other full memtable.
+    imm_ = mem;
+    has_imm_.store(true, std::memory_order_release);
+  }
+
   return Status::OK();
 }
 
+namespace {
+
+// Logs at least this large are read on a thread of their own.
+const uint64_t kRecoveryReadaheadLogSize = 256 << 10;
+
+// Up to this many bytes of records are read ahead of the memtable inserts.
+const size_t kRecoveryReadaheadBytes = 4 << 20;
+
+// Reads the records of a log during recovery, optionally on a thread of its
+// own, so that reading and checksumming the log overlaps with inserting the
+// records into the memtable.  Records are returned in log order.
+class RecoveryLogReader {
+ public:
+  // *status is set by "reporter", on the reading thread, and reading stops
+  // at the first error.  It may only be looked at once Finish() returned.
+  RecoveryLogReader(Env* env, log::Reader* reader,
+                    log::Reader::Reporter* reporter, const Status* status,
+                    bool threaded)
+      : reader_(reader),
+        reporter_(reporter),
+        status_(status),
+        threaded_(threaded),
+        cv_(&mu_),
+        buffered_bytes_(0),
+        done_(false),
+        stopped_(false) {
+    if (threaded_) {
+      env->StartThread(&RecoveryLogReader::ReadMain, this);
+    }
+  }
+
+  RecoveryLogReader(const RecoveryLogReader&) = delete;
+  RecoveryLogReader& operator=(const RecoveryLogReader&) = delete;
+
+  ~RecoveryLogReader() { Finish(); }
+
+  // Stores the next record in *record.  Returns false at the end of the
+  // log or at the first error.
+  bool Next(std::string* record) {
+    if (!threaded_) {
+      return ReadRecord(record);
+    }
+    MutexLock l(&mu_);
+    while (records_.empty() && !done_) {
+      cv_.Wait();
+    }
+    if (records_.empty()) {
+      return false;
+    }
+    record->swap(records_.front());
+    records_.pop_front();
+    buffered_bytes_ -= record->size();
+    cv_.SignalAll();
+    return true;
+  }
+
+  // Stops reading and waits for the reading thread to exit.
+  void Finish() {
+    if (!threaded_) {
+      return;
+    }
+    MutexLock l(&mu_);
+    stopped_ = true;
+    cv_.SignalAll();
+    while (!done_) {
+      cv_.Wait();
+    }
+  }
+
+ private:
+  static void ReadMain(void* arg) {
+    reinterpret_cast<RecoveryLogReader*>(arg)->ReadAll();
+  }
+
+  void ReadAll() {
+    std::string record;
+    bool more = true;
+    while (more) {
+      more = ReadRecord(&record);
+      MutexLock l(&mu_);
+      if (more) {
+        buffered_bytes_ += record.size();
+        records_.emplace_back();
+        records_.back().swap(record);
+        cv_.SignalAll();
+        // Keep one record ahead even if it is larger than the budget.
+        while (!stopped_ && buffered_bytes_ > kRecoveryReadaheadBytes &&
+               records_.size() > 1) {
+          cv_.Wait();
+        }
+        more = !stopped_;
+      }
+    }
+    MutexLock l(&mu_);
+    done_ = true;
+    cv_.SignalAll();
+  }
+
+  // Reads the next well-formed record.
+  bool ReadRecord(std::string* result) {
+    Slice record;
+    while (status_->ok() && reader_->ReadRecord(&record, &scratch_)) {
+      if (!status_->ok()) {
+        break;
+      }
+      if (record.size() < 12) {
+        reporter_->Corruption(record.size(),
+                              Status::Corruption("log record too small"));
+        continue;
+      }
+      result->assign(record.data(), record.size());
+      return true;
+    }
+    return false;
+  }
+
+  log::Reader* const reader_;
+  log::Reader::Reporter* const reporter_;
+  const Status* const status_;
+  const bool threaded_;
+  std::string scratch_;  // Only used by the reading thread
+
+  port::Mutex mu_;
+  port::CondVar cv_ GUARDED_BY(mu_);
+  std::deque<std::string> records_ GUARDED_BY(mu_);
+  size_t buffered_bytes_ GUARDED_BY(mu_);
+  bool done_ GUARDED_BY(mu_);
+  bool stopped_ GUARDED_BY(mu_);
+};
+
+}  // namespace
+
 Status DBImpl::RecoverLogFile(uint64_t log_number, bool last_log,
                               bool* save_manifest, VersionEdit* edit,
-                              SequenceNumber* max_sequence) {
+                              SequenceNumber* max_sequence, MemTable** memptr) {
   struct LogReporter : public log::Reader::Reporter {
     Env* env;
     Logger* info_log;
@@ -403,13 +687,17 @@ Status DBImpl::RecoverLogFile(uint64_t log_number, bool last_log,
     MaybeIgnoreError(&status);
     return status;
   }
+  uint64_t file_size = 0;
+  env_->GetFileSize(fname, &file_size);
 
-  // Create the log reader.
+  // Create the log reader.  Errors it reports go to read_status, which the
+  // reading thread owns until it finishes.
+  Status read_status;
   LogReporter reporter;
   reporter.env = env_;
   reporter.info_log = options_.info_log;
   reporter.fname = fname.c_str();
-  reporter.status = (options_.paranoid_checks ? &status : nullptr);
+  reporter.status = (options_.paranoid_checks ? &read_status : nullptr);
   // We intentionally make log::Reader do checksumming even if
   // paranoid_checks==false so that corruptions cause entire commits
   // to be skipped instead of propagating bad information (like overly
@@ -419,21 +707,21 @@ Status DBImpl::RecoverLogFile(uint64_t log_number, bool last_log,
       (unsigned long long)log_number);
 
   // Read all the records and add to a memtable
-  std::string scratch;
-  Slice record;
+  RecoveryLogReader records(env_, &reader, &reporter, &read_status,
+                            file_size >= kRecoveryReadaheadLogSize);
+  std::string record;
   WriteBatch batch;
   int compactions = 0;
-  MemTable* mem = nullptr;
-  while (reader.ReadRecord(&record, &scratch) && status.ok()) {
-    if (record.size() < 12) {
-      reporter.Corruption(record.size(),
-                          Status::Corruption("log record too small"));
-      continue;
-    }
+  MemTable* mem = *memptr;
+  *memptr = nullptr;
+  // Updates of earlier logs that are in mem, if recovery flushes are
+  // deferred.  Their logs must outlive mem, so this one is not reused.
+  const bool has_earlier_logs = (mem != nullptr);
+  while (status.ok() && records.Next(&record)) {
     WriteBatchInternal::SetContents(&batch, record);
 
     if (mem == nullptr) {
-      mem = new MemTable(internal_comparator_);
+      mem = new MemTable(internal_comparator_, options_, arena_pool_);
       mem->Ref();
     }
     status = WriteBatchInternal::InsertInto(&batch, mem);
@@ -450,7 +738,7 @@ Status DBImpl::RecoverLogFile(uint64_t log_number, bool last_log,
     if (mem->ApproximateMemoryUsage() > options_.write_buffer_size) {
       compactions++;
       *save_manifest = true;
-      status = WriteLevel0Table(mem, edit, nullptr);
+      status = WriteLevel0Table(mem, edit, nullptr, nullptr);
       mem->Unref();
       mem = nullptr;
       if (!status.ok()) {
@@ -460,11 +748,16 @@ Status DBImpl::RecoverLogFile(uint64_t log_number, bool last_log,
       }
     }
   }
+  records.Finish();
+  if (status.ok()) {
+    status = read_status;
+  }
 
   delete file;
 
   // See if we should keep reusing the last log file.
-  if (status.ok() && options_.reuse_logs && last_log && compactions == 0) {
+  if (status.ok() && options_.reuse_logs && last_log && compactions == 0 &&
+      !has_earlier_logs) {
     assert(logfile_ == nullptr);
     assert(log_ == nullptr);
     assert(mem_ == nullptr);
@@ -479,17 +772,23 @@ Status DBImpl::RecoverLogFile(uint64_t log_number, bool last_log,
         mem = nullptr;
       } else {
         // mem can be nullptr if lognum exists but was empty.
-        mem_ = new MemTable(internal_comparator_);
+        mem_ = new MemTable(internal_comparator_, options_, arena_pool_);
         mem_->Ref();
       }
     }
   }
 
+  if (mem != nullptr && status.ok() && options_.defer_recovery_flush) {
+    // Left for the next log, or for DB::Open() to flush in the background.
+    *memptr = mem;
+    mem = nullptr;
+  }
+
   if (mem != nullptr) {
     // mem did not get reused; compact it.
     if (status.ok()) {
       *save_manifest = true;
-      status = WriteLevel0Table(mem, edit, nullptr);
+      status = WriteLevel0Table(mem, edit, nullptr, nullptr);
     }
     mem->Unref();
   }
@@ -498,20 +797,24 @@ Status DBImpl::RecoverLogFile(uint64_t log_number, bool last_log,
 }
 
 Status DBImpl::WriteLevel0Table(MemTable* mem, VersionEdit* edit,
-                                Version* base) {
+                                Version* base, uint64_t* pending_output) {
   mutex_.AssertHeld();
   const uint64_t start_micros = env_->NowMicros();
   FileMetaData meta;
   meta.number = versions_->NewFileNumber();
   pending_outputs_.insert(meta.number);
   Iterator* iter = mem->NewIterator();
+  std::vector<RangeTombstone> range_dels;
+  mem->GetRangeTombstones(&range_dels);
   Log(options_.info_log, "Level-0 table #%llu: started",
       (unsigned long long)meta.number);
 
+  CompactionStats stats;
   Status s;
   {
     mutex_.Unlock();
-    s = BuildTable(dbname_, env_, options_, table_cache_, iter, &meta);
+    s = BuildTable(dbname_, env_, options_, table_cache_, iter, range_dels,
+                   &meta, &stats.compression);
     mutex_.Lock();
   }
 
@@ -519,7 +822,11 @@ Status DBImpl::WriteLevel0Table(MemTable* mem, VersionEdit* edit,
       (unsigned long long)meta.number, (unsigned long long)meta.file_size,
       s.ToString().c_str());
   delete iter;
-  pending_outputs_.erase(meta.number);
+  if (pending_output != nullptr) {
+    *pending_output = meta.number;
+  } else {
+    pending_outputs_.erase(meta.number);
+  }
 
   // Note that if file_size is zero, the file has been deleted and
   // should not be added to the manifest.
@@ -534,7 +841,6 @@ Status DBImpl::WriteLevel0Table(MemTable* mem, VersionEdit* edit,
                   meta.largest);
   }
 
-  CompactionStats stats;
   stats.micros = env_->NowMicros() - start_micros;
   stats.bytes_written = meta.file_size;
   stats_[level].Add(stats);
@@ -544,12 +850,15 @@ Status DBImpl::WriteLevel0Table(MemTable* mem, VersionEdit* edit,
 void DBImpl::CompactMemTable() {
   mutex_.AssertHeld();
   assert(imm_ != nullptr);
+  assert(!imm_compaction_running_);
+  imm_compaction_running_ = true;
 
   // Save the contents of the memtable as a new Table
   VersionEdit edit;
   Version* base = versions_->current();
   base->Ref();
-  Status s = WriteLevel0Table(imm_, &edit, base);
+  uint64_t file_number;
+  Status s = WriteLevel0Table(imm_, &edit, base, &file_number);
   base->Unref();
 
   if (s.ok() && shutting_down_.load(std::memory_order_acquire)) {
@@ -560,8 +869,12 @@ void DBImpl::CompactMemTable() {
   if (s.ok()) {
     edit.SetPrevLogNumber(0);
     edit.SetLogNumber(logfile_number_);  // Earlier logs no longer needed
-    s = versions_->LogAndApply(&edit, &mutex_);
+    // Another thread may be writing to the MANIFEST and remove obsolete
+    // files in the meantime, so the new table stays pending until here.
+    s = LogAndApply(&edit);
   }
+  pending_outputs_.erase(file_number);
+  imm_compaction_running_ = false;
 
   if (s.ok()) {
     // Commit to the new state
@@ -601,6 +914,7 @@ void DBImpl::TEST_CompactRange(int level, const Slice* begin,
   ManualCompaction manual;
   manual.level = level;
   manual.done = false;
+  manual.in_progress = false;
   if (begin == nullptr) {
     manual.begin = nullptr;
   } else {
@@ -654,19 +968,53 @@ void DBImpl::RecordBackgroundError(const Status& s) {
   }
 }
 
+Status DBImpl::LogAndApply(VersionEdit* edit) {
+  mutex_.AssertHeld();
+  // VersionSet::LogAndApply() releases mutex_ while it writes to the
+  // MANIFEST, and does not support concurrent callers.
+  while (manifest_write_running_) {
+    manifest_write_finished_signal_.Wait();
+  }
+  manifest_write_running_ = true;
+  Status s = versions_->LogAndApply(edit, &mutex_);
+  manifest_write_running_ = false;
+  manifest_write_finished_signal_.SignalAll();
+  if (options_.rate_limiter != nullptr) {
+    options_.rate_limiter->SetLevel0Pressure(
+        static_cast<double>(versions_->NumLevelFiles(0)) /
+        config::kL0_SlowdownWritesTrigger);
+  }
+  return s;
+}
+
+bool DBImpl::HasBackgroundWork() {
+  mutex_.AssertHeld();
+  if (ingestion_running_) {
+    // IngestExternalFile() reschedules compactions when it is done.
+    return false;
+  }
+  if (imm_ != nullptr && !imm_compaction_running_) {
+    return true;
+  }
+  if (manual_compaction_ != nullptr) {
+    return !manual_compaction_->in_progress;
+  }
+  return versions_->NeedsCompaction();
+}
+
 void DBImpl::MaybeScheduleCompaction() {
   mutex_.AssertHeld();
-  if (background_compaction_scheduled_) {
+  if (background_compactions_scheduled_ >=
+      options_.max_background_compactions) {
     // Already scheduled
   } else if (shutting_down_.load(std::memory_order_acquire)) {
     // DB is being deleted; no more background compactions
   } else if (!bg_error_.ok()) {
     // Already got an error; no more changes
-  } else if (imm_ == nullptr && manual_compaction_ == nullptr &&
-             !versions_->NeedsCompaction()) {
+  } else if (!HasBackgroundWork()) {
     // No work to be done
   } else {
-    background_compaction_scheduled_ = true;
+    background_compactions_scheduled_++;
     env_->Schedule(&DBImpl::BGWork, this);
   }
 }
@@ -677,29 +1025,39 @@ void DBImpl::BGWork(void* db) {
 
 void DBImpl::BackgroundCall() {
   MutexLock l(&mutex_);
-  assert(background_compaction_scheduled_);
+  assert(background_compactions_scheduled_ > 0);
+  bool did_work = false;
   if (shutting_down_.load(std::memory_order_acquire)) {
     // No more background work when shutting down.
   } else if (!bg_error_.ok()) {
     // No more background work after a background error.
   } else {
-    BackgroundCompaction();
+    did_work = BackgroundCompaction();
   }
 
-  background_compaction_scheduled_ = false;
+  background_compactions_scheduled_--;
 
   // Previous compaction may have produced too many files in a level,
-  // so reschedule another compaction if needed.
-  MaybeScheduleCompaction();
+  // so reschedule another compaction if needed.  A thread that found
+  // nothing to do (because the remaining work conflicts with running
+  // compactions) does not reschedule; the running compactions will.
+  if (did_work) {
+    MaybeScheduleCompaction();
+  }
   background_work_finished_signal_.SignalAll();
 }
 
-void DBImpl::BackgroundCompaction() {
+bool DBImpl::BackgroundCompaction() {
   mutex_.AssertHeld();
 
-  if (imm_ != nullptr) {
+  if (ingestion_running_) {
+    // The versions must not change under IngestExternalFile().
+    return false;
+  }
+
+  if (imm_ != nullptr && !imm_compaction_running_) {
     CompactMemTable();
-    return;
+    return true;
   }
 
   Compaction* c;
@@ -707,6 +1065,13 @@ void DBImpl::BackgroundCompaction() {
   InternalKey manual_end;
   if (is_manual) {
     ManualCompaction* m = manual_compaction_;
+    if (m->in_progress || running_table_compactions_ > 0) {
+      // A manual compaction picks its inputs without regard for other
+      // compactions, so it only starts once they have all finished.  New
+      // automatic compactions are held back until then.
+      return false;
+    }
+    m->in_progress = true;
     c = versions_->CompactRange(m->level, m->begin, m->end);
     m->done = (c == nullptr);
     if (c != nullptr) {
@@ -719,28 +1084,44 @@ void DBImpl::BackgroundCompaction() {
         (m->done ? "(end)" : manual_end.DebugString().c_str()));
   } else {
     c = versions_->PickCompaction();
+    if (c == nullptr) {
+      return false;
+    }
   }
 
   Status status;
   if (c == nullptr) {
     // Nothing to do
   } else if (!is_manual && c->IsTrivialMove()) {
-    // Move file to next level
-    assert(c->num_input_files(0) == 1);
-    FileMetaData* f = c->input(0, 0);
-    c->edit()->RemoveFile(c->level(), f->number);
-    c->edit()->AddFile(c->level() + 1, f->number, f->file_size, f->smallest,
-                       f->largest);
-    status = versions_->LogAndApply(c->edit(), &mutex_);
+    // Move files to next level.  Only tiered compactions move more than
+    // one file, a whole run at a time.
+    assert(c->num_input_files(0) >= 1);
+    uint64_t moved_bytes = 0;
+    for (int i = 0; i < c->num_input_files(0); i++) {
+      FileMetaData* f = c->input(0, i);
+      c->edit()->RemoveFile(c->level(), f->number);
+      c->edit()->AddFile(c->level() + 1, f->number, f->file_size, f->smallest,
+                         f->largest);
+      moved_bytes += f->file_size;
+    }
+    running_table_compactions_++;
+    status = LogAndApply(c->edit());
+    running_table_compactions_--;
     if (!status.ok()) {
       RecordBackgroundError(status);
     }
     VersionSet::LevelSummaryStorage tmp;
-    Log(options_.info_log, "Moved #%lld to level-%d %lld bytes %s: %s\n",
-        static_cast<unsigned long long>(f->number), c->level() + 1,
-        static_cast<unsigned long long>(f->file_size),
+    Log(options_.info_log,
+        "Moved #%lld (%d files) to level-%d %lld bytes %s: %s\n",
+        static_cast<unsigned long long>(c->input(0, 0)->number),
+        c->num_input_files(0), c->level() + 1,
+        static_cast<unsigned long long>(moved_bytes),
         status.ToString().c_str(), versions_->LevelSummary(&tmp));
   } else {
+    running_table_compactions_++;
+    // Let another background thread pick up work that does not conflict
+    // with this compaction.
+    MaybeScheduleCompaction();
     CompactionState* compact = new CompactionState(c);
     status = DoCompactionWork(compact);
     if (!status.ok()) {
@@ -749,6 +1130,7 @@ void DBImpl::BackgroundCompaction() {
     CleanupCompaction(compact);
     c->ReleaseInputs();
     RemoveObsoleteFiles();
+    running_table_compactions_--;
   }
   delete c;
 
@@ -771,8 +1153,10 @@ void DBImpl::BackgroundCompaction() {
       m->tmp_storage = manual_end;
       m->begin = &m->tmp_storage;
     }
+    m->in_progress = false;
     manual_compaction_ = nullptr;
   }
+  return true;
 }
 
 void DBImpl::CleanupCompaction(CompactionState* compact) {
@@ -812,13 +1196,43 @@ Status DBImpl::OpenCompactionOutputFile(CompactionState* compact) {
   std::string fname = TableFileName(dbname_, file_number);
   Status s = env_->NewWritableFile(fname, &compact->outfile);
   if (s.ok()) {
+    compact->outfile = NewRateLimitedWritableFile(
+        compact->outfile, options_.rate_limiter, RateLimiter::kCompaction);
     compact->builder = new TableBuilder(options_, compact->outfile);
   }
   return s;
 }
 
+void DBImpl::AddOutputRangeDeletions(CompactionState* compact,
+                                     const Slice* next_user_key) {
+  const Comparator* ucmp = user_comparator();
+  CompactionState::Output* out = compact->current_output();
+  bool empty = compact->builder->NumEntries() == 0;
+  for (const RangeTombstone& t : compact->output_range_dels) {
+    RangeTombstone part = t;
+    if (compact->has_output_lower &&
+        ucmp->Compare(part.start, compact->output_lower) < 0) {
+      part.start = compact->output_lower;
+    }
+    if (next_user_key != nullptr &&
+        ucmp->Compare(part.end, *next_user_key) > 0) {
+      part.end = next_user_key->ToString();
+    }
+    if (ucmp->Compare(part.start, part.end) < 0) {
+      compact->builder->AddRangeDeletion(RangeTombstoneKey(part), part.end);
+      ExtendRangeToTombstone(internal_comparator_, part, &empty,
+                             &out->smallest, &out->largest);
+    }
+  }
+  if (next_user_key != nullptr) {
+    compact->output_lower = next_user_key->ToString();
+    compact->has_output_lower = true;
+  }
+}
+
 Status DBImpl::FinishCompactionOutputFile(CompactionState* compact,
-                                          Iterator* input) {
+                                          Iterator* input,
+                                          const Slice* next_user_key) {
   assert(compact != nullptr);
   assert(compact->outfile != nullptr);
   assert(compact->builder != nullptr);
@@ -828,7 +1242,11 @@ Status DBImpl::FinishCompactionOutputFile(CompactionState* compact,
 
   // Check for iterator errors
   Status s = input->status();
-  const uint64_t current_entries = compact->builder->NumEntries();
+  if (s.ok()) {
+    AddOutputRangeDeletions(compact, next_user_key);
+  }
+  const uint64_t current_entries = compact->builder->NumEntries() +
+                                   compact->builder->NumRangeDeletions();
   if (s.ok()) {
     s = compact->builder->Finish();
   } else {
@@ -837,6 +1255,7 @@ Status DBImpl::FinishCompactionOutputFile(CompactionState* compact,
   const uint64_t current_bytes = compact->builder->FileSize();
   compact->current_output()->file_size = current_bytes;
   compact->total_bytes += current_bytes;
+  compact->compression.Add(*compact->builder);
   delete compact->builder;
   compact->builder = nullptr;
 
@@ -853,7 +1272,8 @@ Status DBImpl::FinishCompactionOutputFile(CompactionState* compact,
   if (s.ok() && current_entries > 0) {
     // Verify that the table is usable
     Iterator* iter =
-        table_cache_->NewIterator(ReadOptions(), output_number, current_bytes);
+        table_cache_->NewIterator(ReadOptions(), output_number, current_bytes,
+                                  compact->compaction->level() + 1);
     s = iter->status();
     delete iter;
     if (s.ok()) {
@@ -881,7 +1301,77 @@ Status DBImpl::InstallCompactionResults(CompactionState* compact) {
     compact->compaction->edit()->AddFile(level + 1, out.number, out.file_size,
                                          out.smallest, out.largest);
   }
-  return versions_->LogAndApply(compact->compaction->edit(), &mutex_);
+  return LogAndApply(compact->compaction->edit());
+}
+
+// State of one subcompaction that runs on its own thread.  The calling
+// thread of DoCompactionWork() compacts the first key range itself.
+struct DBImpl::SubcompactionState {
+  SubcompactionState(DBImpl* db, Compaction* c,
+                     SequenceNumber smallest_snapshot)
+      : db(db), compaction(c), compact(c), input(nullptr), has_end(false) {
+    compact.smallest_snapshot = smallest_snapshot;
+  }
+
+  DBImpl* const db;
+  Compaction* const compaction;  // Owned; see Compaction::NewSubcompaction()
+  CompactionState compact;
+  Iterator* input;
+  std::string begin;
+  std::string end;
+  bool has_end;
+  Status status;
+};
+
+void DBImpl::GenSubcompactionBoundaries(Compaction* c,
+                                        std::vector<std::string>* boundaries) {
+  if (options_.max_subcompactions <= 1 ||
+      c->num_input_files(0) + c->num_input_files(1) < 2) {
+    return;
+  }
+
+  // Use the largest user key of every input file as a candidate boundary.
+  // Splitting only on user key boundaries keeps all entries for a user key
+  // in one subcompaction, which the drop logic relies on.
+  const Comparator* ucmp = user_comparator();
+  std::vector<Slice> keys;
+  for (int which = 0; which < 2; which++) {
+    for (int i = 0; i < c->num_input_files(which); i++) {
+      keys.push_back(c->input(which, i)->largest.user_key());
+    }
+  }
+  std::sort(keys.begin(), keys.end(), [ucmp](const Slice& a, const Slice& b) {
+    return ucmp->Compare(a, b) < 0;
+  });
+  keys.erase(std::unique(keys.begin(), keys.end(),
+                         [ucmp](const Slice& a, const Slice& b) {
+                           return ucmp->Compare(a, b) == 0;
+                         }),
+             keys.end());
+  // Nothing sorts after the largest key, so it would end an empty range.
+  keys.pop_back();
+
+  const size_t ranges = std::min(
+      static_cast<size_t>(options_.max_subcompactions), keys.size() + 1);
+  for (size_t i = 1; i < ranges; i++) {
+    boundaries->push_back(keys[i * keys.size() / ranges].ToString());
+  }
+  boundaries->erase(std::unique(boundaries->begin(), boundaries->end()),
+                    boundaries->end());
+}
+
+void DBImpl::SubcompactionThread(void* arg) {
+  SubcompactionState* sub = reinterpret_cast<SubcompactionState*>(arg);
+  DBImpl* db = sub->db;
+  Slice begin(sub->begin);
+  Slice end(sub->end);
+  sub->status = db->DoCompactionWorkInRange(
+      &sub->compact, sub->input, &begin, sub->has_end ? &end : nullptr, nullptr);
+
+  MutexLock l(&db->mutex_);
+  if (--db->pending_subcompactions_ == 0) {
+    db->subcompactions_finished_signal_.SignalAll();
+  }
 }
 
 Status DBImpl::DoCompactionWork(CompactionState* compact) {
@@ -900,42 +1390,211 @@ Status DBImpl::DoCompactionWork(CompactionState* compact) {
     compact->smallest_snapshot = versions_->LastSequence();
   } else {
     compact->smallest_snapshot = snapshots_.oldest()->sequence_number();
+    compact->newest_snapshot = snapshots_.newest()->sequence_number();
+  }
+
+  // Split the key range into subcompactions.  This thread handles the
+  // range before the first boundary, the others get a thread each.
+  std::vector<std::string> boundaries;
+  GenSubcompactionBoundaries(compact->compaction, &boundaries);
+  std::vector<SubcompactionState*> subs;
+  for (size_t i = 0; i < boundaries.size(); i++) {
+    SubcompactionState* sub =
+        new SubcompactionState(this, compact->compaction->NewSubcompaction(),
+                               compact->smallest_snapshot);
+    sub->compact.newest_snapshot = compact->newest_snapshot;
+    sub->begin = boundaries[i];
+    sub->has_end = (i + 1 < boundaries.size());
+    if (sub->has_end) {
+      sub->end = boundaries[i + 1];
+    }
+    sub->input = versions_->MakeInputIterator(compact->compaction);
+    subs.push_back(sub);
+  }
+  if (!subs.empty()) {
+    Log(options_.info_log, "Compaction split into %d subcompactions",
+        static_cast<int>(subs.size() + 1));
   }
 
   Iterator* input = versions_->MakeInputIterator(compact->compaction);
+  pending_subcompactions_ += static_cast<int>(subs.size());
 
   // Release mutex while we're actually doing the compaction work
   mutex_.Unlock();
 
-  input->SeekToFirst();
+  Status range_del_status = versions_->GetCompactionRangeTombstones(
+      compact->compaction, &compact->range_dels);
+  if (!range_del_status.ok()) {
+    // Compacting without them would bring back deleted entries.
+    delete input;
+    input = NewErrorIterator(range_del_status);
+  }
+  for (size_t i = 0; i < subs.size(); i++) {
+    subs[i]->compact.range_dels = compact->range_dels;
+    if (!range_del_status.ok()) {
+      delete subs[i]->input;
+      subs[i]->input = NewErrorIterator(range_del_status);
+    }
+  }
+
+  for (size_t i = 0; i < subs.size(); i++) {
+    env_->StartThread(&DBImpl::SubcompactionThread, subs[i]);
+  }
+  Slice first_end;
+  if (!boundaries.empty()) {
+    first_end = boundaries[0];
+  }
+  Status status = DoCompactionWorkInRange(
+      compact, input, nullptr, boundaries.empty() ? nullptr : &first_end,
+      &imm_micros);
+  delete input;
+  input = nullptr;
+
+  mutex_.Lock();
+  while (pending_subcompactions_ > 0) {
+    subcompactions_finished_signal_.Wait();
+  }
+
+  // Gather the outputs of the subcompactions.  Their outputs are added
+  // to compact->outputs so that CleanupCompaction() releases them.
+  for (size_t i = 0; i < subs.size(); i++) {
+    SubcompactionState* sub = subs[i];
+    if (status.ok()) {
+      status = sub->status;
+    }
+    if (sub->compact.builder != nullptr) {
+      sub->compact.builder->Abandon();
+      delete sub->compact.builder;
+      sub->compact.builder = nullptr;
+    }
+    delete sub->compact.outfile;
+    sub->compact.outfile = nullptr;
+    compact->outputs.insert(compact->outputs.end(),
+                            sub->compact.outputs.begin(),
+                            sub->compact.outputs.end());
+    compact->total_bytes += sub->compact.total_bytes;
+    compact->compression.Add(sub->compact.compression);
+    delete sub->input;
+    delete sub->compaction;
+    delete sub;
+  }
+
+  CompactionStats stats;
+  stats.micros = env_->NowMicros() - start_micros - imm_micros;
+  for (int which = 0; which < 2; which++) {
+    for (int i = 0; i < compact->compaction->num_input_files(which); i++) {
+      stats.bytes_read += compact->compaction->input(which, i)->file_size;
+    }
+  }
+  for (size_t i = 0; i < compact->outputs.size(); i++) {
+    stats.bytes_written += compact->outputs[i].file_size;
+  }
+  stats.compression = compact->compression;
+
+  stats_[compact->compaction->level() + 1].Add(stats);
+
+  if (status.ok()) {
+    status = InstallCompactionResults(compact);
+  }
+  if (!status.ok()) {
+    RecordBackgroundError(status);
+  }
+  VersionSet::LevelSummaryStorage tmp;
+  Log(options_.info_log, "compacted to: %s", versions_->LevelSummary(&tmp));
+  return status;
+}
+
+Status DBImpl::DoCompactionWorkInRange(CompactionState* compact,
+                                       Iterator* input, const Slice* begin,
+                                       const Slice* end, int64_t* imm_micros) {
+  if (begin == nullptr) {
+    input->SeekToFirst();
+  } else {
+    InternalKey start(*begin, kMaxSequenceNumber, kValueTypeForSeek);
+    input->Seek(start.Encode());
+  }
   Status status;
   ParsedInternalKey ikey;
   std::string current_user_key;
   bool has_current_user_key = false;
   SequenceNumber last_sequence_for_key = kMaxSequenceNumber;
+
+  // Entries that a range deletion older than every snapshot covers are
+  // dropped.  Such a range deletion is itself dropped once no deeper level
+  // has anything for it to delete.  The others are kept by the outputs.
+  const Comparator* ucmp = user_comparator();
+  RangeDelAggregator range_dels(ucmp);
+  range_dels.AddAll(compact->range_dels);
+  for (const RangeTombstone& t : compact->range_dels) {
+    if (t.seq <= compact->smallest_snapshot &&
+        compact->compaction->IsBaseLevelForRange(t.start, t.end)) {
+      continue;
+    }
+    RangeTombstone part = t;
+    if (begin != nullptr && ucmp->Compare(part.start, *begin) < 0) {
+      part.start = begin->ToString();
+    }
+    if (end != nullptr && ucmp->Compare(part.end, *end) > 0) {
+      part.end = end->ToString();
+    }
+    if (ucmp->Compare(part.start, part.end) < 0) {
+      compact->output_range_dels.push_back(part);
+    }
+  }
+  if (begin != nullptr) {
+    compact->output_lower = begin->ToString();
+    compact->has_output_lower = true;
+  }
+  // With range deletions to keep, outputs only end between user keys, and
+  // the range deletions are split where they do.  A full output is closed
+  // once the next key is known.
+  const bool split_range_dels = !compact->output_range_dels.empty();
+  bool output_full = false;
+
+  const CompactionFilter* filter = options_.compaction_filter;
+  const int output_level = compact->compaction->level() + 1;
+  std::string filtered_key;
+
   while (input->Valid() && !shutting_down_.load(std::memory_order_acquire)) {
     // Prioritize immutable compaction work
-    if (has_imm_.load(std::memory_order_relaxed)) {
+    if (imm_micros != nullptr && has_imm_.load(std::memory_order_relaxed)) {
       const uint64_t imm_start = env_->NowMicros();
       mutex_.Lock();
-      if (imm_ != nullptr) {
+      if (imm_ != nullptr && !imm_compaction_running_) {
         CompactMemTable();
         // Wake up MakeRoomForWrite() if necessary.
         background_work_finished_signal_.SignalAll();
       }
       mutex_.Unlock();
-      imm_micros += (env_->NowMicros() - imm_start);
+      *imm_micros += (env_->NowMicros() - imm_start);
     }
 
     Slice key = input->key();
-    if (compact->compaction->ShouldStopBefore(key) &&
-        compact->builder != nullptr) {
-      status = FinishCompactionOutputFile(compact, input);
-      if (!status.ok()) {
-        break;
+    Slice value = input->value();
+    if (end != nullptr && key.size() >= 8 &&
+        user_comparator()->Compare(ExtractUserKey(key), *end) >= 0) {
+      // The rest of the input belongs to the next subcompaction.
+      break;
+    }
+    const bool stop_before = compact->compaction->ShouldStopBefore(key);
+    if ((stop_before || output_full) && compact->builder != nullptr) {
+      if (!split_range_dels) {
+        status = FinishCompactionOutputFile(compact, input, nullptr);
+        if (!status.ok()) {
+          break;
+        }
+      } else if (key.size() >= 8 &&
+                 ucmp->Compare(ExtractUserKey(key),
+                               compact->current_output()->largest.user_key()) >
+                     0) {
+        const Slice next_user_key = ExtractUserKey(key);
+        status = FinishCompactionOutputFile(compact, input, &next_user_key);
+        output_full = false;
+        if (!status.ok()) {
+          break;
+        }
       }
     }
-
     // Handle key/value, add to state, etc.
     bool drop = false;
     if (!ParseInternalKey(key, &ikey)) {
@@ -967,6 +1626,27 @@ Status DBImpl::DoCompactionWork(CompactionState* compact) {
         //     few iterations of this loop (by rule (A) above).
         // Therefore this deletion marker is obsolete and can be dropped.
         drop = true;
+      } else if (range_dels.ShouldDelete(ikey.user_key, ikey.sequence,
+                                         compact->smallest_snapshot)) {
+        // Deleted by a range deletion that every snapshot sees.
+        drop = true;
+      } else if (filter != nullptr && ikey.type == kTypeValue &&
+                 last_sequence_for_key == kMaxSequenceNumber &&
+                 ikey.sequence > compact->newest_snapshot &&
+                 filter->Filter(output_level, ikey.user_key, value)) {
+        // The newest entry for the key, which only the latest state sees.
+        if (ikey.sequence <= compact->smallest_snapshot &&
+            compact->compaction->IsBaseLevelForKey(ikey.user_key)) {
+          // Nothing older for the key survives, as for a deletion.
+          drop = true;
+        } else {
+          filtered_key.clear();
+          AppendInternalKey(&filtered_key,
+                            ParsedInternalKey(ikey.user_key, ikey.sequence,
+                                              kTypeDeletion));
+          key = filtered_key;
+          value = Slice();
+        }
       }
 
       last_sequence_for_key = ikey.sequence;
@@ -993,14 +1673,18 @@ Status DBImpl::DoCompactionWork(CompactionState* compact) {
         compact->current_output()->smallest.DecodeFrom(key);
       }
       compact->current_output()->largest.DecodeFrom(key);
-      compact->builder->Add(key, input->value());
+      compact->builder->Add(key, value);
 
       // Close output file if it is big enough
       if (compact->builder->FileSize() >=
           compact->compaction->MaxOutputFileSize()) {
-        status = FinishCompactionOutputFile(compact, input);
-        if (!status.ok()) {
-          break;
+        if (split_range_dels) {
+          output_full = true;
+        } else {
+          status = FinishCompactionOutputFile(compact, input, nullptr);
+          if (!status.ok()) {
+            break;
+          }
         }
       }
     }
@@ -1011,37 +1695,24 @@ Status DBImpl::DoCompactionWork(CompactionState* compact) {
   if (status.ok() && shutting_down_.load(std::memory_order_acquire)) {
     status = Status::IOError("Deleting DB during compaction");
   }
-  if (status.ok() && compact->builder != nullptr) {
-    status = FinishCompactionOutputFile(compact, input);
-  }
-  if (status.ok()) {
-    status = input->status();
-  }
-  delete input;
-  input = nullptr;
-
-  CompactionStats stats;
-  stats.micros = env_->NowMicros() - start_micros - imm_micros;
-  for (int which = 0; which < 2; which++) {
-    for (int i = 0; i < compact->compaction->num_input_files(which); i++) {
-      stats.bytes_read += compact->compaction->input(which, i)->file_size;
+  if (status.ok() && compact->builder == nullptr && split_range_dels) {
+    // The range deletions after the last output need one of their own.
+    bool remaining = !compact->has_output_lower;
+    for (size_t i = 0; !remaining && i < compact->output_range_dels.size();
+         i++) {
+      remaining = ucmp->Compare(compact->output_range_dels[i].end,
+                                compact->output_lower) > 0;
+    }
+    if (remaining) {
+      status = OpenCompactionOutputFile(compact);
     }
   }
-  for (size_t i = 0; i < compact->outputs.size(); i++) {
-    stats.bytes_written += compact->outputs[i].file_size;
+  if (status.ok() && compact->builder != nullptr) {
+    status = FinishCompactionOutputFile(compact, input, nullptr);
   }
-
-  mutex_.Lock();
-  stats_[compact->compaction->level() + 1].Add(stats);
-
   if (status.ok()) {
-    status = InstallCompactionResults(compact);
-  }
-  if (!status.ok()) {
-    RecordBackgroundError(status);
+    status = input->status();
   }
-  VersionSet::LevelSummaryStorage tmp;
-  Log(options_.info_log, "compacted to: %s", versions_->LevelSummary(&tmp));
   return status;
 }
 
@@ -1071,7 +1742,8 @@ static void CleanupIteratorState(void* arg1, void* arg2) {
 
 Iterator* DBImpl::NewInternalIterator(const ReadOptions& options,
                                       SequenceNumber* latest_snapshot,
-                                      uint32_t* seed) {
+                                      uint32_t* seed,
+                                      RangeDelAggregator* range_dels) {
   mutex_.Lock();
   *latest_snapshot = versions_->LastSequence();
 
@@ -1083,7 +1755,15 @@ Iterator* DBImpl::NewInternalIterator(const ReadOptions& options,
     list.push_back(imm_->NewIterator());
     imm_->Ref();
   }
-  versions_->current()->AddIterators(options, &list);
+  if (range_dels != nullptr) {
+    std::vector<RangeTombstone> tombstones;
+    mem_->GetRangeTombstones(&tombstones);
+    if (imm_ != nullptr) {
+      imm_->GetRangeTombstones(&tombstones);
+    }
+    range_dels->AddAll(tombstones);
+  }
+  versions_->current()->AddIterators(options, &list, range_dels);
   Iterator* internal_iter =
       NewMergingIterator(&internal_comparator_, &list[0], (uint32_t)list.size());
   versions_->current()->Ref();
@@ -1109,6 +1789,24 @@ int64_t DBImpl::TEST_MaxNextLevelOverlappingBytes() {
 
 Status DBImpl::Get(const ReadOptions& options, const Slice& key,
                    std::string* value) {
+  return GetImpl(options, key, value, nullptr);
+}
+
+Status DBImpl::Get(const ReadOptions& options, const Slice& key,
+                   PinnableSlice* value) {
+  value->Reset();
+  Status s = GetImpl(options, key, nullptr, value);
+  if (!s.ok()) {
+    value->Reset();
+  }
+  return s;
+}
+
+Status DBImpl::GetImpl(const ReadOptions& options, const Slice& key,
+                       std::string* value, PinnableSlice* pinned) {
+  OpTimer op_timer(this, kGetOp);
+  PERF_TIMER_GUARD(get_nanos);
+  PERF_COUNTER_ADD(get_count, 1);
   Status s;
   MutexLock l(&mutex_);
   SequenceNumber snapshot;
@@ -1133,13 +1831,25 @@ Status DBImpl::Get(const ReadOptions& options, const Slice& key,
   {
     mutex_.Unlock();
     // First look in the memtable, then in the immutable memtable (if any).
+    // Memtable entries are copied even when pinning: releasing a memtable
+    // needs the mutex.
     LookupKey lkey(key, snapshot);
-    if (mem->Get(lkey, value, &s)) {
-      // Done
-    } else if (imm != nullptr && imm->Get(lkey, value, &s)) {
-      // Done
-    } else {
-      s = current->Get(options, lkey, value, &stats);
+    std::string* mem_value = value != nullptr ? value : pinned->GetSelf();
+    bool in_memtable;
+    {
+      PERF_TIMER_GUARD(memtable_get_nanos);
+      in_memtable = mem->Get(lkey, mem_value, &s) ||
+                    (imm != nullptr && imm->Get(lkey, mem_value, &s));
+    }
+    if (in_memtable) {
+      if (pinned != nullptr && s.ok()) {
+        pinned->PinSelf();
+      }
+    } else if (value != nullptr) {
+      s = current->Get(options, lkey, value, &stats);
+      have_stat_update = true;
+    } else {
+      s = current->Get(options, lkey, pinned, &stats);
       have_stat_update = true;
     }
     mutex_.Lock();
@@ -1154,16 +1864,123 @@ Status DBImpl::Get(const ReadOptions& options, const Slice& key,
   return s;
 }
 
+std::vector<Status> DBImpl::MultiGet(const ReadOptions& options,
+                                     const std::vector<Slice>& keys,
+                                     std::vector<std::string>* values) {
+  OpTimer op_timer(this, kMultiGetOp);
+  PERF_TIMER_GUARD(get_nanos);
+  PERF_COUNTER_ADD(get_count, keys.size());
+  const size_t n = keys.size();
+  values->clear();
+  values->resize(n);
+  std::vector<Status> statuses(n);
+  if (n == 0) {
+    return statuses;
+  }
+
+  // Visit the keys in order, so that the lookups of keys that share a
+  // table or a block go together.
+  const Comparator* ucmp = user_comparator();
+  std::vector<size_t> order(n);
+  for (size_t i = 0; i < n; i++) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return ucmp->Compare(keys[a], keys[b]) < 0;
+  });
+
+  MutexLock l(&mutex_);
+  SequenceNumber snapshot;
+  if (options.snapshot != nullptr) {
+    snapshot =
+        static_cast<const SnapshotImpl*>(options.snapshot)->sequence_number();
+  } else {
+    snapshot = versions_->LastSequence();
+  }
+
+  MemTable* mem = mem_;
+  MemTable* imm = imm_;
+  Version* current = versions_->current();
+  mem->Ref();
+  if (imm != nullptr) imm->Ref();
+  current->Ref();
+
+  bool have_stat_update = false;
+  Version::GetStats stats;
+
+  // Unlock while reading from files and memtables
+  {
+    mutex_.Unlock();
+    // Look each distinct key up in the memtable, then in the immutable
+    // memtable (if any), and pass the rest on to the current version.
+    std::vector<LookupKey*> lkeys;
+    std::vector<const LookupKey*> version_keys;
+    std::vector<std::string*> version_values;
+    std::vector<size_t> version_indices;
+    for (size_t j = 0; j < n; j++) {
+      const size_t i = order[j];
+      if (j > 0 && ucmp->Compare(keys[i], keys[order[j - 1]]) == 0) {
+        continue;  // Copied from the first instance of the key below.
+      }
+      LookupKey* lkey = new LookupKey(keys[i], snapshot);
+      lkeys.push_back(lkey);
+      bool in_memtable;
+      {
+        PERF_TIMER_GUARD(memtable_get_nanos);
+        in_memtable = mem->Get(*lkey, &(*values)[i], &statuses[i]) ||
+                      (imm != nullptr &&
+                       imm->Get(*lkey, &(*values)[i], &statuses[i]));
+      }
+      if (!in_memtable) {
+        version_keys.push_back(lkey);
+        version_values.push_back(&(*values)[i]);
+        version_indices.push_back(i);
+      }
+    }
+    if (!version_keys.empty()) {
+      std::vector<Status> version_statuses;
+      current->MultiGet(options, version_keys, version_values,
+                        &version_statuses, &stats);
+      for (size_t k = 0; k < version_indices.size(); k++) {
+        statuses[version_indices[k]] = version_statuses[k];
+      }
+      have_stat_update = true;
+    }
+    for (size_t j = 1; j < n; j++) {
+      const size_t i = order[j];
+      const size_t prev = order[j - 1];
+      if (ucmp->Compare(keys[i], keys[prev]) == 0) {
+        statuses[i] = statuses[prev];
+        (*values)[i] = (*values)[prev];
+      }
+    }
+    for (LookupKey* lkey : lkeys) {
+      delete lkey;
+    }
+    mutex_.Lock();
+  }
+
+  if (have_stat_update && current->UpdateStats(stats)) {
+    MaybeScheduleCompaction();
+  }
+  mem->Unref();
+  if (imm != nullptr) imm->Unref();
+  current->Unref();
+  return statuses;
+}
+
 Iterator* DBImpl::NewIterator(const ReadOptions& options) {
   SequenceNumber latest_snapshot;
   uint32_t seed;
-  Iterator* iter = NewInternalIterator(options, &latest_snapshot, &seed);
+  RangeDelAggregator* range_dels = new RangeDelAggregator(user_comparator());
+  Iterator* iter =
+      NewInternalIterator(options, &latest_snapshot, &seed, range_dels);
   return NewDBIterator(this, user_comparator(), iter,
                        (options.snapshot != nullptr
                             ? static_cast<const SnapshotImpl*>(options.snapshot)
                                   ->sequence_number()
                             : latest_snapshot),
-                       seed);
+                       seed, range_dels);
 }
 
 void DBImpl::RecordReadSample(Slice key) {
@@ -1193,6 +2010,13 @@ Status DBImpl::Delete(const WriteOptions& options, const Slice& key) {
 }
 
 Status DBImpl::Write(const WriteOptions& options, WriteBatch* updates) {
+  OpTimer op_timer(this, kWriteOp);
+  PERF_TIMER_GUARD(write_nanos);
+  PERF_COUNTER_ADD(write_count, 1);
+  if (options_.enable_pipelined_write) {
+    return PipelinedWrite(options, updates);
+  }
+
   Writer w(&mutex_);
   w.batch = updates;
   w.sync = options.sync;
@@ -1200,19 +2024,34 @@ Status DBImpl::Write(const WriteOptions& options, WriteBatch* updates) {
 
   MutexLock l(&mutex_);
   writers_.push_back(&w);
-  while (!w.done && &w != writers_.front()) {
+  while (!w.done && w.insert_mem == nullptr && &w != writers_.front()) {
     w.cv.Wait();
   }
+  if (w.insert_mem != nullptr) {
+    InsertFollowerBatch(&w);
+  }
   if (w.done) {
     return w.status;
   }
 
+  // Sync writes leave the sync to the log sync thread if it is enabled.
+  const bool defer_sync =
+      options.sync && options_.log_sync_interval_micros > 0;
+  uint64_t log_sync_offset = 0;
+
   // May temporarily unlock and wait.
   Status status = MakeRoomForWrite(updates == nullptr);
   uint64_t last_sequence = versions_->LastSequence();
   Writer* last_writer = &w;
   if (status.ok() && updates != nullptr) {  // nullptr batch is for compactions
     WriteBatch* write_batch = BuildBatchGroup(&last_writer);
+    // A group with several writers was merged into tmp_batch_.  Let each
+    // writer apply its own batch in parallel if the options allow it.
+    const bool concurrent_insert =
+        options_.allow_concurrent_memtable_write && write_batch == tmp_batch_;
+    if (concurrent_insert) {
+      SetGroupSequences(last_writer, last_sequence + 1);
+    }
     WriteBatchInternal::SetSequence(write_batch, last_sequence + 1);
     last_sequence += WriteBatchInternal::Count(write_batch);
 
@@ -1222,15 +2061,21 @@ Status DBImpl::Write(const WriteOptions& options, WriteBatch* updates) {
     // into mem_.
     {
       mutex_.Unlock();
-      status = log_->AddRecord(WriteBatchInternal::Contents(write_batch));
+      {
+        PERF_TIMER_GUARD(wal_write_nanos);
+        status = log_->AddRecord(WriteBatchInternal::Contents(write_batch));
+      }
       bool sync_error = false;
-      if (status.ok() && options.sync) {
-        status = logfile_->Sync();
+      if (status.ok() && options.sync && !defer_sync) {
+        PERF_TIMER_GUARD(wal_sync_nanos);
+        status = SyncLogFile(logfile_);
         if (!status.ok()) {
           sync_error = true;
         }
       }
-      if (status.ok()) {
+      const bool logged = status.ok();
+      if (status.ok() && !concurrent_insert) {
+        PERF_TIMER_GUARD(memtable_insert_nanos);
         status = WriteBatchInternal::InsertInto(write_batch, mem_);
       }
       mutex_.Lock();
@@ -1240,31 +2085,237 @@ Status DBImpl::Write(const WriteOptions& options, WriteBatch* updates) {
         // So we force the DB into a mode where all future writes fail.
         RecordBackgroundError(status);
       }
+      if (logged) {
+        const uint64_t offset =
+            RecordLogAppend(WriteBatchInternal::ByteSize(write_batch));
+        if (defer_sync) {
+          log_sync_offset = offset;
+        }
+      }
+    }
+    if (status.ok() && concurrent_insert) {
+      std::vector<Writer*> followers;
+      for (Writer* writer : writers_) {
+        if (writer != &w) followers.push_back(writer);
+        if (writer == last_writer) break;
+      }
+      status = InsertBatchGroupConcurrently(&w, followers);
     }
     if (write_batch == tmp_batch_) tmp_batch_->Clear();
 
     versions_->SetLastSequence(last_sequence);
   }
 
+  if (log_sync_offset == 0) {
+    while (true) {
+      Writer* ready = writers_.front();
+      writers_.pop_front();
+      if (ready != &w) {
+        ready->status = status;
+        ready->done = true;
+        ready->cv.Signal();
+      }
+      if (ready == last_writer) break;
+    }
+
+    // Notify new head of write queue
+    if (!writers_.empty()) {
+      writers_.front()->cv.Signal();
+    }
+    return status;
+  }
+
+  // Hand the log to the next group before waiting for the sync, so that
+  // its writes can be covered by the same sync.
+  std::vector<Writer*> followers;
   while (true) {
     Writer* ready = writers_.front();
     writers_.pop_front();
-    if (ready != &w) {
-      ready->status = status;
-      ready->done = true;
-      ready->cv.Signal();
-    }
+    if (ready != &w) followers.push_back(ready);
     if (ready == last_writer) break;
   }
+  if (!writers_.empty()) {
+    writers_.front()->cv.Signal();
+  }
+  if (status.ok()) {
+    status = AwaitLogSync(log_sync_offset);
+  }
+  for (Writer* follower : followers) {
+    follower->status = status;
+    follower->done = true;
+    follower->cv.Signal();
+  }
+  return status;
+}
+
+Status DBImpl::PipelinedWrite(const WriteOptions& options,
+                              WriteBatch* updates) {
+  Writer w(&mutex_);
+  w.batch = updates;
+  w.sync = options.sync;
+  w.done = false;
+
+  MutexLock l(&mutex_);
+  writers_.push_back(&w);
+  while (!w.done && w.insert_mem == nullptr && &w != writers_.front()) {
+    w.cv.Wait();
+  }
+  if (w.insert_mem != nullptr) {
+    InsertFollowerBatch(&w);
+  }
+  if (w.done) {
+    return w.status;
+  }
+
+  // We lead the log stage.  May temporarily unlock and wait.
+  const bool defer_sync =
+      options.sync && options_.log_sync_interval_micros > 0;
+  uint64_t log_sync_offset = 0;
+  Status status = MakeRoomForWrite(updates == nullptr);
+  if (!status.ok() || updates == nullptr) {  // nullptr batch is for compactions
+    writers_.pop_front();
+    if (!writers_.empty()) {
+      writers_.front()->cv.Signal();
+    }
+    return status;
+  }
+
+  // Groups that are still waiting for the memtable stage have consumed
+  // sequence numbers that are not yet published through the VersionSet.
+  uint64_t last_sequence = memtable_groups_.empty()
+                               ? versions_->LastSequence()
+                               : memtable_groups_.back()->last_sequence;
+  Writer* last_writer = &w;
+  WriteBatch* write_batch = BuildBatchGroup(&last_writer);
+  SetGroupSequences(last_writer, last_sequence + 1);
+  WriteBatchInternal::SetSequence(write_batch, last_sequence + 1);
+  last_sequence += WriteBatchInternal::Count(write_batch);
+
+  {
+    mutex_.Unlock();
+    {
+      PERF_TIMER_GUARD(wal_write_nanos);
+      status = log_->AddRecord(WriteBatchInternal::Contents(write_batch));
+    }
+    bool sync_error = false;
+    if (status.ok() && options.sync && !defer_sync) {
+      PERF_TIMER_GUARD(wal_sync_nanos);
+      status = SyncLogFile(logfile_);
+      if (!status.ok()) {
+        sync_error = true;
+      }
+    }
+    mutex_.Lock();
+    if (sync_error) {
+      // See the comment in Write().
+      RecordBackgroundError(status);
+    }
+    if (status.ok()) {
+      const uint64_t offset =
+          RecordLogAppend(WriteBatchInternal::ByteSize(write_batch));
+      if (defer_sync) {
+        log_sync_offset = offset;
+      }
+    }
+  }
+  if (write_batch == tmp_batch_) tmp_batch_->Clear();
 
-  // Notify new head of write queue
+  // Leave the log stage so that the next group can start its log write
+  // while this one is applied to the memtable.
+  MemTableGroup group;
+  group.leader = &w;
+  group.last_sequence = last_sequence;
+  while (true) {
+    Writer* ready = writers_.front();
+    writers_.pop_front();
+    if (ready != &w) group.followers.push_back(ready);
+    if (ready == last_writer) break;
+  }
   if (!writers_.empty()) {
     writers_.front()->cv.Signal();
   }
 
+  if (status.ok()) {
+    // Groups are applied one at a time in log order, so sequence numbers
+    // become visible in order too.
+    memtable_groups_.push_back(&group);
+    while (memtable_groups_.front() != &group) {
+      w.cv.Wait();
+    }
+
+    if (options_.allow_concurrent_memtable_write && !group.followers.empty()) {
+      status = InsertBatchGroupConcurrently(&w, group.followers);
+    } else {
+      // mem_ cannot be switched while memtable_groups_ is non-empty.
+      MemTable* mem = mem_;
+      mutex_.Unlock();
+      PERF_TIMER_GUARD(memtable_insert_nanos);
+      status = WriteBatchInternal::InsertInto(w.batch, mem);
+      for (Writer* follower : group.followers) {
+        if (!status.ok()) break;
+        if (follower->batch != nullptr) {
+          status = WriteBatchInternal::InsertInto(follower->batch, mem);
+        }
+      }
+      mutex_.Lock();
+    }
+    versions_->SetLastSequence(group.last_sequence);
+
+    memtable_groups_.pop_front();
+    if (!memtable_groups_.empty()) {
+      memtable_groups_.front()->leader->cv.Signal();
+    } else {
+      memtable_inserts_done_signal_.SignalAll();
+    }
+  }
+
+  if (status.ok() && log_sync_offset != 0) {
+    status = AwaitLogSync(log_sync_offset);
+  }
+  for (Writer* follower : group.followers) {
+    follower->status = status;
+    follower->done = true;
+    follower->cv.Signal();
+  }
   return status;
 }
 
+void DBImpl::SetGroupSequences(Writer* last_writer, SequenceNumber sequence) {
+  mutex_.AssertHeld();
+  for (Writer* writer : writers_) {
+    if (writer->batch != nullptr) {
+      WriteBatchInternal::SetSequence(writer->batch, sequence);
+      sequence += WriteBatchInternal::Count(writer->batch);
+    }
+    if (writer == last_writer) break;
+  }
+}
+
+void DBImpl::InsertFollowerBatch(Writer* w) {
+  mutex_.AssertHeld();
+  // The leader of our group has logged our batch and asked us to insert
+  // it into the memtable ourselves.  See InsertBatchGroupConcurrently().
+  MemTable* mem = w->insert_mem;
+  w->insert_mem = nullptr;
+  mutex_.Unlock();
+  Status s;
+  {
+    PERF_TIMER_GUARD(memtable_insert_nanos);
+    s = WriteBatchInternal::InsertIntoConcurrently(w->batch, mem);
+  }
+  mutex_.Lock();
+  if (!s.ok() && memtable_insert_status_.ok()) {
+    memtable_insert_status_ = s;
+  }
+  if (--pending_memtable_inserts_ == 0) {
+    // MakeRoomForWrite() may be waiting on the same signal.
+    memtable_inserts_done_signal_.SignalAll();
+  }
+  while (!w->done) {
+    w->cv.Wait();
+  }
+}
+
 // REQUIRES: Writer list must be non-empty
 // REQUIRES: First writer must have a non-null batch
 WriteBatch* DBImpl::BuildBatchGroup(Writer** last_writer) {
@@ -1294,31 +2345,195 @@ WriteBatch* DBImpl::BuildBatchGroup(Writer** last_writer) {
       break;
     }
 
-    if (w->batch != nullptr) {
-      size += WriteBatchInternal::ByteSize(w->batch);
-      if (size > max_size) {
-        // Do not make batch too big
-        break;
-      }
+    if (w->batch == nullptr) {
+      // Writers without a batch (memtable compactions and file ingestion)
+      // must get to the front of the queue themselves.
+      break;
+    }
 
-      // Append to *result
-      if (result == first->batch) {
-        // Switch to temporary batch instead of disturbing caller's batch
-        result = tmp_batch_;
-        assert(WriteBatchInternal::Count(result) == 0);
-        WriteBatchInternal::Append(result, first->batch);
-      }
-      WriteBatchInternal::Append(result, w->batch);
+    size += WriteBatchInternal::ByteSize(w->batch);
+    if (size > max_size) {
+      // Do not make batch too big
+      break;
     }
+
+    // Append to *result
+    if (result == first->batch) {
+      // Switch to temporary batch instead of disturbing caller's batch
+      result = tmp_batch_;
+      assert(WriteBatchInternal::Count(result) == 0);
+      WriteBatchInternal::Append(result, first->batch);
+    }
+    WriteBatchInternal::Append(result, w->batch);
     *last_writer = w;
   }
   return result;
 }
 
+// REQUIRES: sequence numbers have been assigned to every batch in the group
+Status DBImpl::InsertBatchGroupConcurrently(
+    Writer* leader, const std::vector<Writer*>& followers) {
+  mutex_.AssertHeld();
+  assert(pending_memtable_inserts_ == 0);
+  memtable_insert_status_ = Status::OK();
+
+  // mem_ cannot be switched while the group is being applied, so every
+  // writer in the group inserts into the same memtable.
+  for (Writer* follower : followers) {
+    if (follower->batch != nullptr) {
+      follower->insert_mem = mem_;
+      pending_memtable_inserts_++;
+      follower->cv.Signal();
+    }
+  }
+
+  MemTable* mem = mem_;
+  mutex_.Unlock();
+  Status status;
+  {
+    PERF_TIMER_GUARD(memtable_insert_nanos);
+    status = WriteBatchInternal::InsertIntoConcurrently(leader->batch, mem);
+  }
+  mutex_.Lock();
+
+  while (pending_memtable_inserts_ > 0) {
+    memtable_inserts_done_signal_.Wait();
+  }
+  if (status.ok()) {
+    status = memtable_insert_status_;
+  }
+  return status;
+}
+
 // REQUIRES: mutex_ is held
 // REQUIRES: this thread is currently at the front of the writer queue
+uint64_t DBImpl::RecordLogAppend(size_t n) {
+  mutex_.AssertHeld();
+  log_bytes_ += n;
+  if (log_sync_requested_bytes_ > log_synced_bytes_ && LogSyncBytesReached()) {
+    log_sync_requested_signal_.Signal();
+  }
+  return log_bytes_;
+}
+
+bool DBImpl::LogSyncBytesReached() const {
+  return options_.log_sync_bytes > 0 &&
+         log_bytes_ - log_synced_bytes_ >= options_.log_sync_bytes;
+}
+
+Status DBImpl::AwaitLogSync(uint64_t offset) {
+  mutex_.AssertHeld();
+  PERF_TIMER_GUARD(wal_sync_nanos);
+  if (!log_sync_thread_running_) {
+    log_sync_thread_running_ = true;
+    env_->StartThread(&DBImpl::LogSyncThreadMain, this);
+  }
+  if (offset > log_sync_requested_bytes_) {
+    if (log_sync_requested_bytes_ <= log_synced_bytes_) {
+      // No other write is waiting, so the interval starts now.
+      log_sync_request_micros_ = env_->NowMicros();
+    }
+    log_sync_requested_bytes_ = offset;
+    log_sync_requested_signal_.Signal();
+  }
+  while (log_synced_bytes_ < offset && bg_error_.ok()) {
+    log_synced_signal_.Wait();
+  }
+  return (log_synced_bytes_ >= offset) ? Status::OK() : bg_error_;
+}
+
+Status DBImpl::SyncLogFile(WritableFile* file) const {
+  return options_.sync_mode == kSyncBarrier ? file->SyncBarrier()
+                                            : file->Sync();
+}
+
+Status DBImpl::SyncLog() {
+  mutex_.AssertHeld();
+  const uint64_t offset = log_bytes_;
+  WritableFile* file = logfile_;
+  mutex_.Unlock();
+  Status s = SyncLogFile(file);
+  mutex_.Lock();
+  if (s.ok()) {
+    log_synced_bytes_ = offset;
+  } else {
+    // See the comment in Write().
+    RecordBackgroundError(s);
+  }
+  log_synced_signal_.SignalAll();
+  return s;
+}
+
+void DBImpl::PreloadTablesMain(void* db) {
+  reinterpret_cast<DBImpl*>(db)->PreloadTables();
+}
+
+void DBImpl::PreloadTables() {
+  mutex_.Lock();
+  // Holding on to the version keeps its files from being deleted.
+  Version* v = versions_->current();
+  v->Ref();
+  mutex_.Unlock();
+
+  // Opening more tables than the cache holds would evict the first ones.
+  int budget = TableCacheSize(options_);
+  for (int level = 0; level < config::kNumLevels && budget > 0; level++) {
+    for (const FileMetaData* f : v->files(level)) {
+      if (budget-- == 0 || shutting_down_.load(std::memory_order_acquire)) {
+        break;
+      }
+      // Errors show up again when the table is read.
+      table_cache_->Preload(f->number, f->file_size, level);
+    }
+  }
+
+  mutex_.Lock();
+  v->Unref();
+  preloading_tables_ = false;
+  background_work_finished_signal_.SignalAll();
+  mutex_.Unlock();
+}
+
+void DBImpl::LogSyncThreadMain(void* db) {
+  reinterpret_cast<DBImpl*>(db)->LogSyncThread();
+}
+
+void DBImpl::LogSyncThread() {
+  MutexLock l(&mutex_);
+  while (!shutting_down_.load(std::memory_order_acquire)) {
+    if (log_sync_requested_bytes_ <= log_synced_bytes_ || !bg_error_.ok()) {
+      log_sync_requested_signal_.Wait();
+      continue;
+    }
+    // Let more writes join the sync until the oldest waiter is due.
+    const uint64_t deadline =
+        log_sync_request_micros_ + options_.log_sync_interval_micros;
+    const uint64_t now = env_->NowMicros();
+    if (now < deadline && !LogSyncBytesReached()) {
+      log_sync_requested_signal_.TimedWait(deadline - now);
+      continue;
+    }
+
+    // The log must not be appended to or switched during the sync, so
+    // take the log stage like a writer.
+    Writer w(&mutex_);
+    writers_.push_back(&w);
+    while (&w != writers_.front()) {
+      w.cv.Wait();
+    }
+    SyncLog();
+    writers_.pop_front();
+    if (!writers_.empty()) {
+      writers_.front()->cv.Signal();
+    }
+  }
+  log_sync_thread_running_ = false;
+  log_synced_signal_.SignalAll();
+}
+
 Status DBImpl::MakeRoomForWrite(bool force) {
   mutex_.AssertHeld();
+  PERF_TIMER_GUARD(write_delay_nanos);
   assert(!writers_.empty());
   bool allow_delay = !force;
   Status s;
@@ -1352,7 +2567,18 @@ Status DBImpl::MakeRoomForWrite(bool force) {
       // There are too many level-0 files.
       Log(options_.info_log, "Too many L0 files; waiting...\n");
       background_work_finished_signal_.Wait();
+    } else if (!memtable_groups_.empty()) {
+      // Pipelined writes are still applying earlier groups to mem_; let
+      // them finish before switching to a new memtable.
+      memtable_inserts_done_signal_.Wait();
     } else {
+      if (log_sync_requested_bytes_ > log_synced_bytes_) {
+        // Sync writes are still waiting for the log that is closed below.
+        s = SyncLog();
+        if (!s.ok()) {
+          break;
+        }
+      }
       // Attempt to switch to a new memtable and trigger compaction of old
       assert(versions_->PrevLogNumber() == 0);
       uint64_t new_log_number = versions_->NewFileNumber();
@@ -1370,7 +2596,7 @@ Status DBImpl::MakeRoomForWrite(bool force) {
       log_ = new log::Writer(lfile);
       imm_ = mem_;
       has_imm_.store(true, std::memory_order_release);
-      mem_ = new MemTable(internal_comparator_);
+      mem_ = new MemTable(internal_comparator_, options_, arena_pool_);
       mem_->Ref();
       force = false;  // Do not force another compaction if have room
       MaybeScheduleCompaction();
@@ -1379,6 +2605,52 @@ Status DBImpl::MakeRoomForWrite(bool force) {
   return s;
 }
 
+static const char* CompressionName(CompressionType type) {
+  switch (type) {
+    case kNoCompression:
+      return "none";
+    case kSnappyCompression:
+      return "snappy";
+    case kZstdCompression:
+      return "zstd";
+    case kLZ4Compression:
+      return "lz4";
+  }
+  return "unknown";
+}
+
+// Returns true if blocks can be compressed with options.compression in this
+// build.  Otherwise TableBuilder silently stores them uncompressed.
+static bool CompressionAvailable(const Options& options) {
+  const char kInput[] = "leveldb";
+  std::string output;
+  switch (options.compression) {
+    case kNoCompression:
+      return true;
+    case kSnappyCompression:
+      return port::Snappy_Compress(kInput, sizeof(kInput), &output);
+    case kZstdCompression:
+      return port::Zstd_Compress(options.zstd_compression_level, nullptr, 0,
+                                 kInput, sizeof(kInput), &output);
+    case kLZ4Compression:
+      return port::Lz4_Compress(kInput, sizeof(kInput), &output);
+  }
+  return false;
+}
+
+static void AppendCompressionStats(const BlockCompressionStats& c,
+                                   std::string* value) {
+  char buf[100];
+  std::snprintf(buf, sizeof(buf), " %8lld %10lld %8.1f %10.1f %5.2f\n",
+                static_cast<long long>(c.blocks),
+                static_cast<long long>(c.compressed_blocks),
+                c.raw_bytes / 1048576.0, c.stored_bytes / 1048576.0,
+                c.raw_bytes > 0
+                    ? static_cast<double>(c.stored_bytes) / c.raw_bytes
+                    : 1.0);
+  value->append(buf);
+}
+
 bool DBImpl::GetProperty(const Slice& property, std::string* value) {
   value->clear();
 
@@ -1420,6 +2692,30 @@ bool DBImpl::GetProperty(const Slice& property, std::string* value) {
       }
     }
     return true;
+  } else if (in == "compression") {
+    char buf[200];
+    std::snprintf(buf, sizeof(buf),
+                  "Compression: %s (%s)\n"
+                  "                     Blocks written\n"
+                  "Level   Blocks Compressed  Raw(MB) Stored(MB) Ratio\n"
+                  "----------------------------------------------------\n",
+                  CompressionName(options_.compression),
+                  CompressionAvailable(options_) ? "available"
+                                                 : "not compiled in");
+    value->append(buf);
+    BlockCompressionStats total;
+    for (int level = 0; level < config::kNumLevels; level++) {
+      const BlockCompressionStats& c = stats_[level].compression;
+      if (c.blocks > 0) {
+        std::snprintf(buf, sizeof(buf), "%5d", level);
+        value->append(buf);
+        AppendCompressionStats(c, value);
+        total.Add(c);
+      }
+    }
+    value->append("Total");
+    AppendCompressionStats(total, value);
+    return true;
   } else if (in == "sstables") {
     *value = versions_->current()->DebugString();
     return true;
@@ -1436,11 +2732,38 @@ bool DBImpl::GetProperty(const Slice& property, std::string* value) {
                   static_cast<unsigned long long>(total_usage));
     value->append(buf);
     return true;
+  } else if (in == "allocation-stats") {
+    AppendAllocationStats(value);
+    return true;
+  } else if (in.starts_with("latency")) {
+    if (!options_.record_op_latencies) {
+      return false;
+    }
+    static const char* const kOpNames[kNumOpTypes] = {"get", "multiget",
+                                                      "write", "seek"};
+    in.remove_prefix(strlen("latency"));
+    MutexLock hl(&op_latency_mutex_);
+    for (int i = 0; i < kNumOpTypes; i++) {
+      if (in.empty()) {
+        value->append(kOpNames[i]);
+        value->append(" (micros):\n");
+        value->append(op_latency_[i].ToString());
+      } else if (in == Slice(std::string(".") + kOpNames[i])) {
+        *value = op_latency_[i].ToString();
+        return true;
+      }
+    }
+    return in.empty();
   }
 
   return false;
 }
 
+void DBImpl::RecordOpLatency(OpType type, uint64_t micros) {
+  MutexLock l(&op_latency_mutex_);
+  op_latency_[type].Add(static_cast<double>(micros));
+}
+
 void DBImpl::GetApproximateSizes(const Range* range, int n, uint64_t* sizes) {
   // TODO(opt): better implementation
   MutexLock l(&mutex_);
@@ -1459,6 +2782,361 @@ void DBImpl::GetApproximateSizes(const Range* range, int n, uint64_t* sizes) {
   v->Unref();
 }
 
+// A table file being added by IngestExternalFile()
+struct DBImpl::IngestedFile {
+  std::string path;
+  bool moved = false;        // Renamed, rather than copied, into the DB
+  uint64_t copy_number = 0;  // Number of the file's copy in the DB
+  int level = 0;             // Level the table is added to
+  FileMetaData meta;         // The table added to the DB
+};
+
+namespace {
+
+// Presents the entries of an ingested file, whose sequence numbers are
+// all zero, with sequence number "sequence" instead.
+class SequenceAssigningIterator : public Iterator {
+ public:
+  SequenceAssigningIterator(Iterator* iter, SequenceNumber sequence)
+      : iter_(iter), sequence_(sequence) {}
+
+  ~SequenceAssigningIterator() override { delete iter_; }
+
+  bool Valid() const override { return iter_->Valid(); }
+  void Seek(const Slice& target) override {
+    iter_->Seek(target);
+    Update();
+  }
+  void SeekToFirst() override {
+    iter_->SeekToFirst();
+    Update();
+  }
+  void SeekToLast() override {
+    iter_->SeekToLast();
+    Update();
+  }
+  void Next() override {
+    iter_->Next();
+    Update();
+  }
+  void Prev() override {
+    iter_->Prev();
+    Update();
+  }
+  Slice key() const override { return key_.Encode(); }
+  Slice value() const override { return iter_->value(); }
+  Status status() const override { return iter_->status(); }
+
+ private:
+  void Update() {
+    if (iter_->Valid()) {
+      key_.SetFrom(ParsedInternalKey(ExtractUserKey(iter_->key()), sequence_,
+                                     kTypeValue));
+    }
+  }
+
+  Iterator* const iter_;
+  const SequenceNumber sequence_;
+  InternalKey key_;
+};
+
+}  // anonymous namespace
+
+// Copy the file "src" to "dst" and sync the copy.
+static Status CopyFile(Env* env, const std::string& src,
+                       const std::string& dst) {
+  SequentialFile* in;
+  Status s = env->NewSequentialFile(src, &in);
+  if (!s.ok()) {
+    return s;
+  }
+  WritableFile* out;
+  s = env->NewWritableFile(dst, &out);
+  if (s.ok()) {
+    static const size_t kBufferSize = 1 << 20;
+    std::string buffer(kBufferSize, '\0');
+    while (true) {
+      Slice chunk;
+      s = in->Read(kBufferSize, &chunk, &buffer[0]);
+      if (!s.ok() || chunk.empty()) {
+        break;
+      }
+      s = out->Append(chunk);
+      if (!s.ok()) {
+        break;
+      }
+    }
+    if (s.ok()) {
+      s = out->Sync();
+    }
+    if (s.ok()) {
+      s = out->Close();
+    }
+    delete out;
+    if (!s.ok()) {
+      env->RemoveFile(dst);
+    }
+  }
+  delete in;
+  return s;
+}
+
+Status DBImpl::InspectExternalFile(IngestedFile* file) {
+  uint64_t file_size;
+  Status s = env_->GetFileSize(file->path, &file_size);
+  RandomAccessFile* source = nullptr;
+  if (s.ok()) {
+    s = env_->NewRandomAccessFile(file->path, &source);
+  }
+  if (!s.ok()) {
+    return s;
+  }
+
+  // The file is read once from start to end, so it neither uses the block
+  // cache nor loads its filter.
+  Options table_options = options_;
+  table_options.block_cache = nullptr;
+  table_options.filter_policy = nullptr;
+  table_options.cache_index_and_filter_blocks = false;
+  Table* table = nullptr;
+  s = Table::Open(table_options, source, file_size, &table);
+  if (s.ok()) {
+    ReadOptions read_options;
+    read_options.verify_checksums = true;
+    read_options.fill_cache = false;
+    Iterator* iter = table->NewIterator(read_options);
+    const Comparator* user_comparator = internal_comparator_.user_comparator();
+    bool empty = true;
+    ParsedInternalKey ikey;
+    for (iter->SeekToFirst(); s.ok() && iter->Valid(); iter->Next()) {
+      if (!ParseInternalKey(iter->key(), &ikey) || ikey.sequence != 0 ||
+          ikey.type != kTypeValue) {
+        s = Status::Corruption("not a file built by SstFileWriter",
+                               file->path);
+      } else if (!empty && user_comparator->Compare(
+                               ikey.user_key,
+                               file->meta.largest.user_key()) <= 0) {
+        s = Status::Corruption("keys out of order", file->path);
+      } else {
+        if (empty) {
+          file->meta.smallest.DecodeFrom(iter->key());
+          empty = false;
+        }
+        file->meta.largest.DecodeFrom(iter->key());
+      }
+    }
+    if (s.ok()) {
+      s = iter->status();
+    }
+    if (s.ok() && empty) {
+      s = Status::InvalidArgument("external file has no entries", file->path);
+    }
+    delete iter;
+    delete table;
+  }
+  delete source;
+  file->meta.file_size = file_size;
+  return s;
+}
+
+bool DBImpl::MemTablesOverlap(const Slice& smallest_user_key,
+                              const Slice& largest_user_key) {
+  mutex_.AssertHeld();
+  const Comparator* user_comparator = internal_comparator_.user_comparator();
+  InternalKey start(smallest_user_key, kMaxSequenceNumber, kValueTypeForSeek);
+  MemTable* mems[] = {mem_, imm_};
+  for (MemTable* mem : mems) {
+    if (mem == nullptr) {
+      continue;
+    }
+    Iterator* iter = mem->NewIterator();
+    iter->Seek(start.Encode());
+    const bool overlap =
+        iter->Valid() && user_comparator->Compare(ExtractUserKey(iter->key()),
+                                                  largest_user_key) <= 0;
+    delete iter;
+    if (overlap) {
+      return true;
+    }
+    std::vector<RangeTombstone> range_dels;
+    mem->GetRangeTombstones(&range_dels);
+    for (const RangeTombstone& t : range_dels) {
+      if (user_comparator->Compare(t.start, largest_user_key) <= 0 &&
+          user_comparator->Compare(t.end, smallest_user_key) > 0) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+Status DBImpl::IngestExternalFile(const IngestExternalFileOptions& options,
+                                  const std::vector<std::string>& paths) {
+  std::vector<IngestedFile> files(paths.size());
+  Status s;
+  for (size_t i = 0; i < files.size() && s.ok(); i++) {
+    files[i].path = paths[i];
+    s = InspectExternalFile(&files[i]);
+  }
+  if (!s.ok() || files.empty()) {
+    return s;
+  }
+
+  const Comparator* user_comparator = internal_comparator_.user_comparator();
+  std::sort(files.begin(), files.end(),
+            [this](const IngestedFile& a, const IngestedFile& b) {
+              return internal_comparator_.Compare(a.meta.smallest,
+                                                  b.meta.smallest) < 0;
+            });
+  for (size_t i = 1; i < files.size(); i++) {
+    if (user_comparator->Compare(files[i - 1].meta.largest.user_key(),
+                                 files[i].meta.smallest.user_key()) >= 0) {
+      return Status::InvalidArgument("external files overlap", files[i].path);
+    }
+  }
+
+  // Bring the files into the DB directory without holding the lock.  The
+  // copies stay in pending_outputs_ until they are no longer needed.
+  mutex_.Lock();
+  for (IngestedFile& f : files) {
+    f.copy_number = versions_->NewFileNumber();
+    f.meta.number = f.copy_number;
+    pending_outputs_.insert(f.copy_number);
+  }
+  mutex_.Unlock();
+  for (IngestedFile& f : files) {
+    const std::string fname = TableFileName(dbname_, f.copy_number);
+    f.moved = options.move_files && env_->RenameFile(f.path, fname).ok();
+    if (!f.moved) {
+      s = CopyFile(env_, f.path, fname);
+      if (!s.ok()) {
+        break;
+      }
+    }
+  }
+
+  MutexLock l(&mutex_);
+  Writer w(&mutex_);
+  if (s.ok()) {
+    // Stop writes by taking the front of the write queue.  A writer without
+    // a batch is never part of another writer's group.
+    writers_.push_back(&w);
+    while (&w != writers_.front()) {
+      w.cv.Wait();
+    }
+    while (!memtable_groups_.empty()) {
+      memtable_inserts_done_signal_.Wait();
+    }
+    s = bg_error_;
+  }
+
+  // The ingested entries must be newer than every entry of their keys, so
+  // the memtables must not hold any.
+  bool memtables_overlap = false;
+  for (size_t i = 0; s.ok() && i < files.size(); i++) {
+    memtables_overlap |= MemTablesOverlap(files[i].meta.smallest.user_key(),
+                                          files[i].meta.largest.user_key());
+  }
+  if (memtables_overlap) {
+    s = MakeRoomForWrite(true /* force compaction */);
+    while (s.ok() && imm_ != nullptr) {
+      background_work_finished_signal_.Wait();
+      s = bg_error_;
+    }
+  }
+
+  if (s.ok()) {
+    // Keep the levels stable while the files are placed.
+    ingestion_running_ = true;
+    while (running_table_compactions_ > 0 || imm_compaction_running_) {
+      background_work_finished_signal_.Wait();
+    }
+
+    // A file that does not overlap the DB goes to the last level as it is,
+    // unless a snapshot would see its entries.  Any other file gets a new
+    // sequence number and goes to the deepest level above the first one
+    // it overlaps.
+    const SequenceNumber sequence = versions_->LastSequence() + 1;
+    std::vector<IngestedFile*> rewrites;
+    Version* current = versions_->current();
+    for (IngestedFile& f : files) {
+      const Slice smallest = f.meta.smallest.user_key();
+      const Slice largest = f.meta.largest.user_key();
+      f.level = config::kNumLevels - 1;
+      bool overlap = false;
+      for (int level = 0; level < config::kNumLevels; level++) {
+        if (current->OverlapInLevel(level, &smallest, &largest)) {
+          f.level = std::max(level - 1, 0);
+          overlap = true;
+          break;
+        }
+      }
+      if (overlap || !snapshots_.empty()) {
+        f.meta.number = versions_->NewFileNumber();
+        pending_outputs_.insert(f.meta.number);
+        rewrites.push_back(&f);
+      }
+    }
+
+    if (!rewrites.empty()) {
+      mutex_.Unlock();
+      for (IngestedFile* f : rewrites) {
+        Iterator* iter = new SequenceAssigningIterator(
+            table_cache_->NewCompactionIterator(ReadOptions(), f->copy_number,
+                                                f->meta.file_size, -1),
+            sequence);
+        s = BuildTable(dbname_, env_, options_, table_cache_, iter,
+                       std::vector<RangeTombstone>(), &f->meta, nullptr);
+        delete iter;
+        table_cache_->Evict(f->copy_number);
+        if (!s.ok()) {
+          break;
+        }
+      }
+      mutex_.Lock();
+      if (s.ok()) {
+        // Recorded in the MANIFEST by LogAndApply(), so that the sequence
+        // number is not handed out again after a restart.
+        versions_->SetLastSequence(sequence);
+      }
+    }
+
+    if (s.ok()) {
+      VersionEdit edit;
+      for (const IngestedFile& f : files) {
+        edit.AddFile(f.level, f.meta.number, f.meta.file_size, f.meta.smallest,
+                     f.meta.largest);
+      }
+      s = LogAndApply(&edit);
+      if (!s.ok()) {
+        RecordBackgroundError(s);
+      }
+    }
+    Log(options_.info_log, "Ingested %d external files: %s",
+        static_cast<int>(files.size()), s.ToString().c_str());
+  }
+
+  for (const IngestedFile& f : files) {
+    pending_outputs_.erase(f.copy_number);
+    pending_outputs_.erase(f.meta.number);
+    if (!s.ok() && f.moved) {
+      // Give the file back to the caller.
+      env_->RenameFile(TableFileName(dbname_, f.copy_number), f.path);
+    }
+  }
+  ingestion_running_ = false;
+  if (!writers_.empty() && writers_.front() == &w) {
+    writers_.pop_front();
+    if (!writers_.empty()) {
+      writers_.front()->cv.Signal();
+    }
+  }
+  // Deletes the copies that were rewritten, or all of them on failure.
+  RemoveObsoleteFiles();
+  MaybeScheduleCompaction();
+  return s;
+}
+
 // Default implementations of convenience methods that subclasses of DB
 // can call if they wish
 Status DB::Put(const WriteOptions& opt, const Slice& key, const Slice& value) {
@@ -1473,6 +3151,41 @@ Status DB::Delete(const WriteOptions& opt, const Slice& key) {
   return Write(opt, &batch);
 }
 
+Status DB::DeleteRange(const WriteOptions& opt, const Slice& begin,
+                       const Slice& end) {
+  WriteBatch batch;
+  batch.DeleteRange(begin, end);
+  return Write(opt, &batch);
+}
+
+Status DB::Get(const ReadOptions& options, const Slice& key,
+               PinnableSlice* value) {
+  value->Reset();
+  Status s = Get(options, key, value->GetSelf());
+  if (s.ok()) {
+    value->PinSelf();
+  }
+  return s;
+}
+
+std::vector<Status> DB::MultiGet(const ReadOptions& options,
+                                 const std::vector<Slice>& keys,
+                                 std::vector<std::string>* values) {
+  values->clear();
+  values->resize(keys.size());
+  std::vector<Status> statuses;
+  statuses.reserve(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    statuses.push_back(Get(options, keys[i], &(*values)[i]));
+  }
+  return statuses;
+}
+
+Status DB::IngestExternalFile(const IngestExternalFileOptions& options,
+                              const std::vector<std::string>& paths) {
+  return Status::NotSupported("IngestExternalFile");
+}
+
 DB::~DB() = default;
 
 Status DB::Open(const Options& options, const std::string& dbname, DB** dbptr) {
@@ -1491,22 +3204,30 @@ Status DB::Open(const Options& options, const std::string& dbname, DB** dbptr) {
     s = options.env->NewWritableFile(LogFileName(dbname, new_log_number),
                                      &lfile);
     if (s.ok()) {
-      edit.SetLogNumber(new_log_number);
       impl->logfile_ = lfile;
       impl->logfile_number_ = new_log_number;
       impl->log_ = new log::Writer(lfile);
-      impl->mem_ = new MemTable(impl->internal_comparator_);
+      impl->mem_ = new MemTable(impl->internal_comparator_, impl->options_,
+                                 impl->arena_pool_);
       impl->mem_->Ref();
     }
   }
   if (s.ok() && save_manifest) {
-    edit.SetPrevLogNumber(0);  // No older logs needed after recovery.
-    edit.SetLogNumber(impl->logfile_number_);
+    // A deferred recovery memtable still needs the recovered logs, until it
+    // is written to a table.
+    if (impl->imm_ == nullptr) {
+      edit.SetPrevLogNumber(0);  // No older logs needed after recovery.
+      edit.SetLogNumber(impl->logfile_number_);
+    }
     s = impl->versions_->LogAndApply(&edit, &impl->mutex_);
   }
   if (s.ok()) {
     impl->RemoveObsoleteFiles();
     impl->MaybeScheduleCompaction();
+    if (impl->options_.preload_tables) {
+      impl->preloading_tables_ = true;
+      impl->env_->StartThread(&DBImpl::PreloadTablesMain, impl);
+    }
   }
   impl->mutex_.Unlock();
   if (s.ok()) {
@@ -1520,6 +3241,8 @@ Status DB::Open(const Options& options, const std::string& dbname, DB** dbptr) {
 
 Snapshot::~Snapshot() = default;
 
+CompactionFilter::~CompactionFilter() = default;
+
 Status DestroyDB(const std::string& dbname, const Options& options) {
   Env* env = options.env;
   std::vector<std::string> filenames;
@@ -9,7 +9,9 @@
 #include <deque>
 #include <set>
 #include <string>
+#include <vector>
 
+#include "db/builder.h"
 #include "db/dbformat.h"
 #include "db/log_writer.h"
 #include "db/snapshot.h"
@@ -17,15 +19,20 @@
 #include "leveldb/env.h"
 #include "port/port.h"
 #include "port/thread_annotations.h"
+#include "util/histogram.h"
 
 namespace leveldb {
 
+class ArenaBlockPool;
+class Compaction;
 class MemTable;
 class TableCache;
 class Version;
 class VersionEdit;
 class VersionSet;
 
+class RangeDelAggregator;
+
 class DBImpl : public DB {
  public:
   DBImpl(const Options& options, const std::string& dbname);
@@ -42,12 +49,19 @@ class DBImpl : public DB {
   Status Write(const WriteOptions& options, WriteBatch* updates) override;
   Status Get(const ReadOptions& options, const Slice& key,
              std::string* value) override;
+  Status Get(const ReadOptions& options, const Slice& key,
+             PinnableSlice* value) override;
+  std::vector<Status> MultiGet(const ReadOptions& options,
+                               const std::vector<Slice>& keys,
+                               std::vector<std::string>* values) override;
   Iterator* NewIterator(const ReadOptions&) override;
   const Snapshot* GetSnapshot() override;
   void ReleaseSnapshot(const Snapshot* snapshot) override;
   bool GetProperty(const Slice& property, std::string* value) override;
   void GetApproximateSizes(const Range* range, int n, uint64_t* sizes) override;
   void CompactRange(const Slice* begin, const Slice* end) override;
+  Status IngestExternalFile(const IngestExternalFileOptions& options,
+                            const std::vector<std::string>& paths) override;
 
   // Extra methods (for testing) that are not in the public DB interface
 
@@ -71,15 +85,47 @@ class DBImpl : public DB {
   // bytes.
   void RecordReadSample(Slice key);
 
+  // Operations whose latencies are kept in histograms if
+  // options_.record_op_latencies is set.
+  enum OpType { kGetOp, kMultiGetOp, kWriteOp, kIterSeekOp, kNumOpTypes };
+
+  // Records the time from its construction to its destruction as the
+  // latency of one operation of the given type.
+  class OpTimer {
+   public:
+    OpTimer(DBImpl* db, OpType type)
+        : db_(db->options_.record_op_latencies ? db : nullptr),
+          type_(type),
+          start_micros_(db_ != nullptr ? db_->env_->NowMicros() : 0) {}
+
+    OpTimer(const OpTimer&) = delete;
+    OpTimer& operator=(const OpTimer&) = delete;
+
+    ~OpTimer() {
+      if (db_ != nullptr) {
+        db_->RecordOpLatency(type_, db_->env_->NowMicros() - start_micros_);
+      }
+    }
+
+   private:
+    DBImpl* const db_;
+    const OpType type_;
+    const uint64_t start_micros_;
+  };
+
  private:
   friend class DB;
   struct CompactionState;
+  struct IngestedFile;
+  struct MemTableGroup;
+  struct SubcompactionState;
   struct Writer;
 
   // Information for a manual compaction
   struct ManualCompaction {
     int level;
     bool done;
+    bool in_progress;          // Picked up by a background thread
     const InternalKey* begin;  // null means beginning of key range
     const InternalKey* end;    // null means end of key range
     InternalKey tmp_storage;   // Used to keep track of compaction progress
@@ -94,16 +140,27 @@ class DBImpl : public DB {
       this->micros += c.micros;
       this->bytes_read += c.bytes_read;
       this->bytes_written += c.bytes_written;
+      this->compression.Add(c.compression);
     }
 
     int64_t micros;
     int64_t bytes_read;
     int64_t bytes_written;
+    BlockCompressionStats compression;  // Blocks of the tables written
   };
 
+  // If "range_dels" is non-null, the range deletions of the memtables and
+  // of the files that the iterator reaches are added to it.  It must
+  // outlive the iterator.
   Iterator* NewInternalIterator(const ReadOptions&,
                                 SequenceNumber* latest_snapshot,
-                                uint32_t* seed);
+                                uint32_t* seed,
+                                RangeDelAggregator* range_dels = nullptr);
+
+  // Implements both Get()s: copies the value into *value if it is non-null,
+  // and pins it in *pinned otherwise.
+  Status GetImpl(const ReadOptions& options, const Slice& key,
+                 std::string* value, PinnableSlice* pinned);
 
   Status NewDB();
 
@@ -123,11 +180,22 @@ class DBImpl : public DB {
   // Errors are recorded in bg_error_.
   void CompactMemTable() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Replays the log into *mem, which is created if null.  *mem is written
+  // to a table and reset unless options_.defer_recovery_flush is set, in
+  // which case it is left for the next log or for the caller.
   Status RecoverLogFile(uint64_t log_number, bool last_log, bool* save_manifest,
-                        VersionEdit* edit, SequenceNumber* max_sequence)
-      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
-
-  Status WriteLevel0Table(MemTable* mem, VersionEdit* edit, Version* base)
+                        VersionEdit* edit, SequenceNumber* max_sequence,
+                        MemTable** mem) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Writes the memtables to level-0 tables and records in the MANIFEST
+  // that no log needs to be replayed, for Options::flush_on_close.
+  Status FlushMemTablesForClose() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // If pending_output is non-null, the number of the new table is stored
+  // there and left in pending_outputs_, so that the table is not deleted
+  // before the caller has applied *edit; the caller must then erase it.
+  Status WriteLevel0Table(MemTable* mem, VersionEdit* edit, Version* base,
+                          uint64_t* pending_output)
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
   Status MakeRoomForWrite(bool force /* compact even if there is room? */)
@@ -135,19 +203,104 @@ class DBImpl : public DB {
   WriteBatch* BuildBatchGroup(Writer** last_writer)
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Write() variant used when Options::enable_pipelined_write is set.
+  Status PipelinedWrite(const WriteOptions& options, WriteBatch* updates)
+      LOCKS_EXCLUDED(mutex_);
+
+  // Assign consecutive sequence numbers, starting at "sequence", to the
+  // batches of the writers from the front of the queue up to last_writer.
+  void SetGroupSequences(Writer* last_writer, SequenceNumber sequence)
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Hand the batches of "followers" to their own threads for insertion into
+  // mem_, insert the leader's batch, and wait for all of them to finish.
+  // REQUIRES: the group has already been appended to the log.
+  Status InsertBatchGroupConcurrently(Writer* leader,
+                                      const std::vector<Writer*>& followers)
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Run by a follower whose leader asked it to insert its own batch.
+  // Returns once the leader has marked the follower done.
+  void InsertFollowerBatch(Writer* w) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Check that the table file described by *file can be ingested, and
+  // fill in its size and key range.
+  Status InspectExternalFile(IngestedFile* file) LOCKS_EXCLUDED(mutex_);
+
+  // Does mem_ or imm_ hold an entry of a user key in [smallest,largest]?
+  bool MemTablesOverlap(const Slice& smallest_user_key,
+                        const Slice& largest_user_key)
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Account for "n" bytes appended to the log by the current write group.
+  // Returns the offset a sync must reach to cover them.
+  uint64_t RecordLogAppend(size_t n) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Have enough bytes been appended since the last sync to sync right away?
+  bool LogSyncBytesReached() const EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Wait until the log sync thread has synced the log up to "offset".
+  Status AwaitLogSync(uint64_t offset) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Sync a log file as options_.sync_mode asks.
+  Status SyncLogFile(WritableFile* file) const;
+
+  // Sync logfile_ up to everything appended so far, and wake the writes
+  // that wait for it.  May temporarily unlock.
+  // REQUIRES: the caller is at the front of writers_
+  Status SyncLog() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Open the tables of the current version into table_cache_.  Run on its
+  // own thread if Options::preload_tables is set.
+  static void PreloadTablesMain(void* db);
+  void PreloadTables();
+
+  static void LogSyncThreadMain(void* db);
+  void LogSyncThread();
+
   void RecordBackgroundError(const Status& s);
 
+  void RecordOpLatency(OpType type, uint64_t micros)
+      LOCKS_EXCLUDED(op_latency_mutex_);
+
+  // Apply *edit to the current version and persist it in the MANIFEST.
+  // Waits for any other thread that is doing the same.
+  Status LogAndApply(VersionEdit* edit) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   void MaybeScheduleCompaction() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  bool HasBackgroundWork() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
   static void BGWork(void* db);
   void BackgroundCall();
-  void BackgroundCompaction() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Returns false if there was no work this thread could pick up.
+  bool BackgroundCompaction() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
   void CleanupCompaction(CompactionState* compact)
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
   Status DoCompactionWork(CompactionState* compact)
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Compact the entries of compact->compaction whose user keys fall in
+  // [*begin,*end) into new output files.  A null bound is unbounded.  If
+  // imm_micros is non-null, memtable compactions are done in between and
+  // their duration is added to *imm_micros.
+  Status DoCompactionWorkInRange(CompactionState* compact, Iterator* input,
+                                 const Slice* begin, const Slice* end,
+                                 int64_t* imm_micros) LOCKS_EXCLUDED(mutex_);
+
+  // Pick user keys that split the compaction into at most
+  // options_.max_subcompactions ranges of similar size.
+  void GenSubcompactionBoundaries(Compaction* c,
+                                  std::vector<std::string>* boundaries);
+
+  static void SubcompactionThread(void* arg);
+
   Status OpenCompactionOutputFile(CompactionState* compact);
-  Status FinishCompactionOutputFile(CompactionState* compact, Iterator* input);
+  // The current output gets the range deletions that must be kept up to
+  // "next_user_key", where the next output starts, or all the remaining
+  // ones if it is null.
+  Status FinishCompactionOutputFile(CompactionState* compact, Iterator* input,
+                                    const Slice* next_user_key);
+  void AddOutputRangeDeletions(CompactionState* compact,
+                               const Slice* next_user_key);
   Status InstallCompactionResults(CompactionState* compact)
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
@@ -167,6 +320,10 @@ class DBImpl : public DB {
   // table_cache_ provides its own synchronization
   TableCache* const table_cache_;
 
+  // Memory for the memtables; null unless memtable_arena_block_size is set.
+  // Provides its own synchronization.
+  ArenaBlockPool* const arena_pool_;
+
   // Lock over the persistent DB state.  Non-null iff successfully acquired.
   FileLock* db_lock_;
 
@@ -186,14 +343,56 @@ class DBImpl : public DB {
   std::deque<Writer*> writers_ GUARDED_BY(mutex_);
   WriteBatch* tmp_batch_ GUARDED_BY(mutex_);
 
+  // State of the concurrent memtable insertion of the current write group.
+  // See Options::allow_concurrent_memtable_write.
+  int pending_memtable_inserts_ GUARDED_BY(mutex_);
+  Status memtable_insert_status_ GUARDED_BY(mutex_);
+  port::CondVar memtable_inserts_done_signal_ GUARDED_BY(mutex_);
+
+  // Logged groups waiting for their memtable stage, in log order.
+  // See Options::enable_pipelined_write.
+  std::deque<MemTableGroup*> memtable_groups_ GUARDED_BY(mutex_);
+
+  // State of the log sync thread.  See Options::log_sync_interval_micros.
+  // Offsets count the bytes appended to all logs since the DB was opened.
+  uint64_t log_bytes_ GUARDED_BY(mutex_);                 // Appended so far
+  uint64_t log_synced_bytes_ GUARDED_BY(mutex_);          // Known synced
+  uint64_t log_sync_requested_bytes_ GUARDED_BY(mutex_);  // Waited for
+  uint64_t log_sync_request_micros_ GUARDED_BY(mutex_);   // Oldest waiter
+  bool log_sync_thread_running_ GUARDED_BY(mutex_);
+  port::CondVar log_sync_requested_signal_ GUARDED_BY(mutex_);
+  port::CondVar log_synced_signal_ GUARDED_BY(mutex_);
+
   SnapshotList snapshots_ GUARDED_BY(mutex_);
 
   // Set of table files to protect from deletion because they are
   // part of ongoing compactions.
   std::set<uint64_t> pending_outputs_ GUARDED_BY(mutex_);
 
-  // Has a background compaction been scheduled or is running?
-  bool background_compaction_scheduled_ GUARDED_BY(mutex_);
+  // Number of background compactions that are scheduled or running.
+  int background_compactions_scheduled_ GUARDED_BY(mutex_);
+
+  // Number of table compactions (as opposed to memtable compactions)
+  // currently running.  See Options::max_background_compactions.
+  int running_table_compactions_ GUARDED_BY(mutex_);
+
+  // Is a background thread compacting imm_?
+  bool imm_compaction_running_ GUARDED_BY(mutex_);
+
+  // Is a thread running PreloadTables()?
+  bool preloading_tables_ GUARDED_BY(mutex_);
+
+  // Is IngestExternalFile() placing files?  No compactions start while it
+  // is set.
+  bool ingestion_running_ GUARDED_BY(mutex_);
+
+  // Is a thread writing to the MANIFEST in LogAndApply()?
+  bool manifest_write_running_ GUARDED_BY(mutex_);
+  port::CondVar manifest_write_finished_signal_ GUARDED_BY(mutex_);
+
+  // Subcompactions of the running compactions that have not finished yet.
+  int pending_subcompactions_ GUARDED_BY(mutex_);
+  port::CondVar subcompactions_finished_signal_ GUARDED_BY(mutex_);
 
   ManualCompaction* manual_compaction_ GUARDED_BY(mutex_);
 
@@ -203,6 +402,11 @@ class DBImpl : public DB {
   Status bg_error_ GUARDED_BY(mutex_);
 
   CompactionStats stats_[config::kNumLevels] GUARDED_BY(mutex_);
+
+  // Latency histograms, in microseconds, per OpType.  Kept apart from
+  // mutex_ so that recording does not contend with the write path.
+  port::Mutex op_latency_mutex_;
+  Histogram op_latency_[kNumOpTypes] GUARDED_BY(op_latency_mutex_);
 };
 
 // Sanitize db options.  The caller should delete result.info_log if
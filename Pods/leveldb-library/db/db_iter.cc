@@ -7,11 +7,13 @@
 #include "db/db_impl.h"
 #include "db/dbformat.h"
 #include "db/filename.h"
+#include "db/range_del.h"
 #include "leveldb/env.h"
 #include "leveldb/iterator.h"
 #include "port/port.h"
 #include "util/logging.h"
 #include "util/mutexlock.h"
+#include "util/perf_context_imp.h"
 #include "util/random.h"
 
 namespace leveldb {
@@ -46,10 +48,11 @@ class DBIter : public Iterator {
   enum Direction { kForward, kReverse };
 
   DBIter(DBImpl* db, const Comparator* cmp, Iterator* iter, SequenceNumber s,
-         uint32_t seed)
+         uint32_t seed, RangeDelAggregator* range_dels)
       : db_(db),
         user_comparator_(cmp),
         iter_(iter),
+        range_dels_(range_dels),
         sequence_(s),
         direction_(kForward),
         valid_(false),
@@ -59,7 +62,10 @@ class DBIter : public Iterator {
   DBIter(const DBIter&) = delete;
   DBIter& operator=(const DBIter&) = delete;
 
-  ~DBIter() override { delete iter_; }
+  ~DBIter() override {
+    delete iter_;
+    delete range_dels_;
+  }
   bool Valid() const override { return valid_; }
   Slice key() const override {
     assert(valid_);
@@ -88,6 +94,16 @@ class DBIter : public Iterator {
   void FindPrevUserEntry();
   bool ParseKey(ParsedInternalKey* key);
 
+  // Returns the type of the entry *ikey, counting values deleted by a range
+  // deletion as deletions.
+  ValueType EntryType(const ParsedInternalKey& ikey) {
+    if (ikey.type == kTypeValue &&
+        range_dels_->ShouldDelete(ikey.user_key, ikey.sequence, sequence_)) {
+      return kTypeDeletion;
+    }
+    return ikey.type;
+  }
+
   inline void SaveKey(const Slice& k, std::string* dst) {
     dst->assign(k.data(), k.size());
   }
@@ -109,6 +125,7 @@ class DBIter : public Iterator {
   DBImpl* db_;
   const Comparator* const user_comparator_;
   Iterator* const iter_;
+  RangeDelAggregator* const range_dels_;
   SequenceNumber const sequence_;
   Status status_;
   std::string saved_key_;    // == current key when direction_==kReverse
@@ -140,6 +157,8 @@ inline bool DBIter::ParseKey(ParsedInternalKey* ikey) {
 
 void DBIter::Next() {
   assert(valid_);
+  PERF_TIMER_GUARD(iter_next_nanos);
+  PERF_COUNTER_ADD(iter_next_count, 1);
 
   if (direction_ == kReverse) {  // Switch directions?
     direction_ = kForward;
@@ -181,17 +200,20 @@ void DBIter::FindNextUserEntry(bool skipping, std::string* skip) {
   do {
     ParsedInternalKey ikey;
     if (ParseKey(&ikey) && ikey.sequence <= sequence_) {
-      switch (ikey.type) {
+      switch (EntryType(ikey)) {
         case kTypeDeletion:
+        case kTypeRangeDeletion:
           // Arrange to skip all upcoming entries for this key since
           // they are hidden by this deletion.
           SaveKey(ikey.user_key, skip);
           skipping = true;
+          PERF_COUNTER_ADD(internal_delete_skipped_count, 1);
           break;
         case kTypeValue:
           if (skipping &&
               user_comparator_->Compare(ikey.user_key, *skip) <= 0) {
             // Entry hidden
+            PERF_COUNTER_ADD(internal_key_skipped_count, 1);
           } else {
             valid_ = true;
             saved_key_.clear();
@@ -208,6 +230,8 @@ void DBIter::FindNextUserEntry(bool skipping, std::string* skip) {
 
 void DBIter::Prev() {
   assert(valid_);
+  PERF_TIMER_GUARD(iter_next_nanos);
+  PERF_COUNTER_ADD(iter_next_count, 1);
 
   if (direction_ == kForward) {  // Switch directions?
     // iter_ is pointing at the current entry.  Scan backwards until
@@ -246,7 +270,7 @@ void DBIter::FindPrevUserEntry() {
           // We encountered a non-deleted value in entries for previous keys,
           break;
         }
-        value_type = ikey.type;
+        value_type = EntryType(ikey);
         if (value_type == kTypeDeletion) {
           saved_key_.clear();
           ClearSavedValue();
@@ -276,6 +300,9 @@ void DBIter::FindPrevUserEntry() {
 }
 
 void DBIter::Seek(const Slice& target) {
+  DBImpl::OpTimer op_timer(db_, DBImpl::kIterSeekOp);
+  PERF_TIMER_GUARD(iter_seek_nanos);
+  PERF_COUNTER_ADD(iter_seek_count, 1);
   direction_ = kForward;
   ClearSavedValue();
   saved_key_.clear();
@@ -290,6 +317,9 @@ void DBIter::Seek(const Slice& target) {
 }
 
 void DBIter::SeekToFirst() {
+  DBImpl::OpTimer op_timer(db_, DBImpl::kIterSeekOp);
+  PERF_TIMER_GUARD(iter_seek_nanos);
+  PERF_COUNTER_ADD(iter_seek_count, 1);
   direction_ = kForward;
   ClearSavedValue();
   iter_->SeekToFirst();
@@ -301,6 +331,9 @@ void DBIter::SeekToFirst() {
 }
 
 void DBIter::SeekToLast() {
+  DBImpl::OpTimer op_timer(db_, DBImpl::kIterSeekOp);
+  PERF_TIMER_GUARD(iter_seek_nanos);
+  PERF_COUNTER_ADD(iter_seek_count, 1);
   direction_ = kReverse;
   ClearSavedValue();
   iter_->SeekToLast();
@@ -311,8 +344,9 @@ void DBIter::SeekToLast() {
 
 Iterator* NewDBIterator(DBImpl* db, const Comparator* user_key_comparator,
                         Iterator* internal_iter, SequenceNumber sequence,
-                        uint32_t seed) {
-  return new DBIter(db, user_key_comparator, internal_iter, sequence, seed);
+                        uint32_t seed, RangeDelAggregator* range_dels) {
+  return new DBIter(db, user_key_comparator, internal_iter, sequence, seed,
+                    range_dels);
 }
 
 }  // namespace leveldb
@@ -13,13 +13,16 @@
 namespace leveldb {
 
 class DBImpl;
+class RangeDelAggregator;
 
 // Return a new iterator that converts internal keys (yielded by
 // "*internal_iter") that were live at the specified "sequence" number
-// into appropriate user keys.
+// into appropriate user keys.  Entries deleted by the range deletions
+// collected in "*range_dels" are skipped.  Takes ownership of
+// "range_dels", which is deleted after "internal_iter".
 Iterator* NewDBIterator(DBImpl* db, const Comparator* user_key_comparator,
                         Iterator* internal_iter, SequenceNumber sequence,
-                        uint32_t seed);
+                        uint32_t seed, RangeDelAggregator* range_dels);
 
 }  // namespace leveldb
 
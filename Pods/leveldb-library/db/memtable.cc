@@ -3,6 +3,10 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include "db/memtable.h"
+
+#include <cstring>
+#include <new>
+
 #include "db/dbformat.h"
 #include "leveldb/comparator.h"
 #include "leveldb/env.h"
@@ -18,19 +22,21 @@ static Slice GetLengthPrefixedSlice(const char* data) {
   return Slice(p, len);
 }
 
-MemTable::MemTable(const InternalKeyComparator& comparator)
-    : comparator_(comparator), refs_(0), table_(comparator_, &arena_) {}
-
-MemTable::~MemTable() { assert(refs_ == 0); }
-
-size_t MemTable::ApproximateMemoryUsage() { return arena_.MemoryUsage(); }
+MemTable::MemTable(const InternalKeyComparator& comparator,
+                   const Options& options, ArenaBlockPool* arena_pool)
+    : comparator_(comparator),
+      refs_(0),
+      arena_(arena_pool),
+      table_(NewMemTableRep(options, comparator_, &arena_)),
+      range_dels_(nullptr) {}
+
+MemTable::~MemTable() {
+  assert(refs_ == 0);
+  delete table_;
+}
 
-int MemTable::KeyComparator::operator()(const char* aptr,
-                                        const char* bptr) const {
-  // Internal keys are encoded as length-prefixed strings.
-  Slice a = GetLengthPrefixedSlice(aptr);
-  Slice b = GetLengthPrefixedSlice(bptr);
-  return comparator.Compare(a, b);
+size_t MemTable::ApproximateMemoryUsage() {
+  return arena_.MemoryUsage() + table_->ApproximateMemoryUsage();
 }
 
 // Encode a suitable internal key target for "target" and return it.
@@ -45,64 +51,149 @@ static const char* EncodeKey(std::string* scratch, const Slice& target) {
 
 class MemTableIterator : public Iterator {
  public:
-  explicit MemTableIterator(MemTable::Table* table) : iter_(table) {}
+  explicit MemTableIterator(MemTableRep::Iterator* iter) : iter_(iter) {}
 
   MemTableIterator(const MemTableIterator&) = delete;
   MemTableIterator& operator=(const MemTableIterator&) = delete;
 
-  ~MemTableIterator() override = default;
+  ~MemTableIterator() override { delete iter_; }
 
-  bool Valid() const override { return iter_.Valid(); }
-  void Seek(const Slice& k) override { iter_.Seek(EncodeKey(&tmp_, k)); }
-  void SeekToFirst() override { iter_.SeekToFirst(); }
-  void SeekToLast() override { iter_.SeekToLast(); }
-  void Next() override { iter_.Next(); }
-  void Prev() override { iter_.Prev(); }
-  Slice key() const override { return GetLengthPrefixedSlice(iter_.key()); }
+  bool Valid() const override { return iter_->Valid(); }
+  void Seek(const Slice& k) override { iter_->Seek(EncodeKey(&tmp_, k)); }
+  void SeekToFirst() override { iter_->SeekToFirst(); }
+  void SeekToLast() override { iter_->SeekToLast(); }
+  void Next() override { iter_->Next(); }
+  void Prev() override { iter_->Prev(); }
+  Slice key() const override { return GetLengthPrefixedSlice(iter_->key()); }
   Slice value() const override {
-    Slice key_slice = GetLengthPrefixedSlice(iter_.key());
+    Slice key_slice = GetLengthPrefixedSlice(iter_->key());
     return GetLengthPrefixedSlice(key_slice.data() + key_slice.size());
   }
 
   Status status() const override { return Status::OK(); }
 
  private:
-  MemTable::Table::Iterator iter_;
+  MemTableRep::Iterator* const iter_;
   std::string tmp_;  // For passing to EncodeKey
 };
 
-Iterator* MemTable::NewIterator() { return new MemTableIterator(&table_); }
+Iterator* MemTable::NewIterator() {
+  return new MemTableIterator(table_->NewIterator());
+}
 
-void MemTable::Add(SequenceNumber s, ValueType type, const Slice& key,
-                   const Slice& value) {
-  // Format of an entry is concatenation of:
-  //  key_size     : varint32 of internal_key.size()
-  //  key bytes    : char[internal_key.size()]
-  //  value_size   : varint32 of value.size()
-  //  value bytes  : char[value.size()]
+// Format of an entry is concatenation of:
+//  key_size     : varint32 of internal_key.size()
+//  key bytes    : char[internal_key.size()]
+//  value_size   : varint32 of value.size()
+//  value bytes  : char[value.size()]
+static size_t EncodedEntryLength(const Slice& key, const Slice& value) {
+  size_t internal_key_size = key.size() + 8;
+  return VarintLength(internal_key_size) + internal_key_size +
+         VarintLength(value.size()) + value.size();
+}
+
+static void EncodeEntry(char* buf, SequenceNumber s, ValueType type,
+                        const Slice& key, const Slice& value) {
   size_t key_size = key.size();
   size_t val_size = value.size();
-  size_t internal_key_size = key_size + 8;
-  const size_t encoded_len = VarintLength(internal_key_size) +
-                             internal_key_size + VarintLength(val_size) +
-                             val_size;
-  char* buf = arena_.Allocate(encoded_len);
-  char* p = EncodeVarint32(buf, (uint32_t)internal_key_size);
+  char* p = EncodeVarint32(buf, (uint32_t)(key_size + 8));
   std::memcpy(p, key.data(), key_size);
   p += key_size;
   EncodeFixed64(p, (s << 8) | type);
   p += 8;
   p = EncodeVarint32(p, (uint32_t)val_size);
   std::memcpy(p, value.data(), val_size);
-  assert(p + val_size == buf + encoded_len);
-  table_.Insert(buf);
+  assert(p + val_size == buf + EncodedEntryLength(key, value));
+}
+
+void MemTable::Add(SequenceNumber s, ValueType type, const Slice& key,
+                   const Slice& value) {
+  char* buf = arena_.Allocate(EncodedEntryLength(key, value));
+  EncodeEntry(buf, s, type, key, value);
+  table_->Insert(buf);
+}
+
+void MemTable::AddConcurrently(SequenceNumber s, ValueType type,
+                               const Slice& key, const Slice& value) {
+  char* buf = arena_.AllocateConcurrently(EncodedEntryLength(key, value));
+  EncodeEntry(buf, s, type, key, value);
+  table_->InsertConcurrently(buf);
+}
+
+MemTable::RangeDelNode* MemTable::NewRangeDelNode(char* buf, SequenceNumber seq,
+                                                  const Slice& begin,
+                                                  const Slice& end) {
+  char* keys = buf + sizeof(RangeDelNode);
+  std::memcpy(keys, begin.data(), begin.size());
+  std::memcpy(keys + begin.size(), end.data(), end.size());
+  RangeDelNode* node = new (buf) RangeDelNode;
+  node->seq = seq;
+  node->begin = Slice(keys, begin.size());
+  node->end = Slice(keys + begin.size(), end.size());
+  return node;
+}
+
+void MemTable::PushRangeDelNode(RangeDelNode* node) {
+  node->next = range_dels_.load(std::memory_order_relaxed);
+  while (!range_dels_.compare_exchange_weak(node->next, node,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+  }
+}
+
+void MemTable::AddRangeDeletion(SequenceNumber seq, const Slice& begin,
+                                const Slice& end) {
+  if (comparator_.comparator.user_comparator()->Compare(begin, end) >= 0) {
+    return;
+  }
+  char* buf = arena_.AllocateAligned(sizeof(RangeDelNode) + begin.size() +
+                                     end.size());
+  PushRangeDelNode(NewRangeDelNode(buf, seq, begin, end));
+}
+
+void MemTable::AddRangeDeletionConcurrently(SequenceNumber seq,
+                                            const Slice& begin,
+                                            const Slice& end) {
+  if (comparator_.comparator.user_comparator()->Compare(begin, end) >= 0) {
+    return;
+  }
+  char* buf = arena_.AllocateAlignedConcurrently(sizeof(RangeDelNode) +
+                                                 begin.size() + end.size());
+  PushRangeDelNode(NewRangeDelNode(buf, seq, begin, end));
+}
+
+void MemTable::GetRangeTombstones(std::vector<RangeTombstone>* result) const {
+  for (const RangeDelNode* node = range_dels_.load(std::memory_order_acquire);
+       node != nullptr; node = node->next) {
+    result->emplace_back(node->begin, node->end, node->seq);
+  }
+}
+
+SequenceNumber MemTable::MaxCoveringRangeDeletion(
+    const Slice& user_key, SequenceNumber snapshot) const {
+  const Comparator* ucmp = comparator_.comparator.user_comparator();
+  SequenceNumber result = 0;
+  for (const RangeDelNode* node = range_dels_.load(std::memory_order_acquire);
+       node != nullptr; node = node->next) {
+    if (node->seq <= snapshot && node->seq > result &&
+        ucmp->Compare(user_key, node->begin) >= 0 &&
+        ucmp->Compare(user_key, node->end) < 0) {
+      result = node->seq;
+    }
+  }
+  return result;
 }
 
 bool MemTable::Get(const LookupKey& key, std::string* value, Status* s) {
+  // Entries older than a range deletion that covers the key are deleted,
+  // and so is everything for the key in older memtables and in tables.
+  const Slice ikey = key.internal_key();
+  const SequenceNumber covering = MaxCoveringRangeDeletion(
+      key.user_key(), DecodeFixed64(ikey.data() + ikey.size() - 8) >> 8);
+
   Slice memkey = key.memtable_key();
-  Table::Iterator iter(&table_);
-  iter.Seek(memkey.data());
-  if (iter.Valid()) {
+  const char* entry = table_->FindGreaterOrEqual(memkey.data());
+  if (entry != nullptr) {
     // entry format is:
     //    klength  varint32
     //    userkey  char[klength]
@@ -112,13 +203,16 @@ bool MemTable::Get(const LookupKey& key, std::string* value, Status* s) {
     // Check that it belongs to same user key.  We do not check the
     // sequence number since the Seek() call above should have skipped
     // all entries with overly large sequence numbers.
-    const char* entry = iter.key();
     uint32_t key_length;
     const char* key_ptr = GetVarint32Ptr(entry, entry + 5, &key_length);
     if (comparator_.comparator.user_comparator()->Compare(
             Slice(key_ptr, key_length - 8), key.user_key()) == 0) {
       // Correct user key
       const uint64_t tag = DecodeFixed64(key_ptr + key_length - 8);
+      if ((tag >> 8) < covering) {
+        *s = Status::NotFound(Slice());
+        return true;
+      }
       switch (static_cast<ValueType>(tag & 0xff)) {
         case kTypeValue: {
           Slice v = GetLengthPrefixedSlice(key_ptr + key_length);
@@ -128,9 +222,15 @@ bool MemTable::Get(const LookupKey& key, std::string* value, Status* s) {
         case kTypeDeletion:
           *s = Status::NotFound(Slice());
           return true;
+        case kTypeRangeDeletion:
+          break;
       }
     }
   }
+  if (covering > 0) {
+    *s = Status::NotFound(Slice());
+    return true;
+  }
   return false;
 }
 
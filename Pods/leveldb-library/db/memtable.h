@@ -5,10 +5,13 @@
 #ifndef STORAGE_LEVELDB_DB_MEMTABLE_H_
 #define STORAGE_LEVELDB_DB_MEMTABLE_H_
 
+#include <atomic>
 #include <string>
+#include <vector>
 
 #include "db/dbformat.h"
-#include "db/skiplist.h"
+#include "db/memtable_rep.h"
+#include "db/range_del.h"
 #include "leveldb/db.h"
 #include "util/arena.h"
 
@@ -20,8 +23,12 @@ class MemTableIterator;
 class MemTable {
  public:
   // MemTables are reference counted.  The initial reference count
-  // is zero and the caller must call Ref() at least once.
-  explicit MemTable(const InternalKeyComparator& comparator);
+  // is zero and the caller must call Ref() at least once.  The entries are
+  // kept in the data structure selected by options.memtable_rep.  If
+  // "arena_pool" is non-null, the memtable's memory comes from it, and it
+  // must outlive the memtable.
+  MemTable(const InternalKeyComparator& comparator, const Options& options,
+           ArenaBlockPool* arena_pool = nullptr);
 
   MemTable(const MemTable&) = delete;
   MemTable& operator=(const MemTable&) = delete;
@@ -56,30 +63,58 @@ class MemTable {
   void Add(SequenceNumber seq, ValueType type, const Slice& key,
            const Slice& value);
 
+  // Like Add(), but may be called from several threads at once.
+  // REQUIRES: no thread is calling Add() at the same time.
+  void AddConcurrently(SequenceNumber seq, ValueType type, const Slice& key,
+                       const Slice& value);
+
+  // Add a deletion of the user keys in [begin, end) at the specified
+  // sequence number.  Range deletions are not returned by NewIterator();
+  // readers get them from GetRangeTombstones().
+  void AddRangeDeletion(SequenceNumber seq, const Slice& begin,
+                        const Slice& end);
+
+  // Like AddRangeDeletion(), but may be called from several threads at once,
+  // like AddConcurrently().
+  void AddRangeDeletionConcurrently(SequenceNumber seq, const Slice& begin,
+                                    const Slice& end);
+
+  // Appends the range deletions of the memtable to *result.  It is safe to
+  // call when the MemTable is being modified.
+  void GetRangeTombstones(std::vector<RangeTombstone>* result) const;
+
   // If memtable contains a value for key, store it in *value and return true.
-  // If memtable contains a deletion for key, store a NotFound() error
-  // in *status and return true.
+  // If memtable contains a deletion for key, or a range deletion that covers
+  // it, store a NotFound() error in *status and return true.
   // Else, return false.
   bool Get(const LookupKey& key, std::string* value, Status* s);
 
  private:
-  friend class MemTableIterator;
-  friend class MemTableBackwardIterator;
-
-  struct KeyComparator {
-    const InternalKeyComparator comparator;
-    explicit KeyComparator(const InternalKeyComparator& c) : comparator(c) {}
-    int operator()(const char* a, const char* b) const;
+  // A range deletion; its keys are stored in the arena as well.  The list
+  // is prepended to, so readers need no lock.
+  struct RangeDelNode {
+    SequenceNumber seq;
+    Slice begin;
+    Slice end;
+    RangeDelNode* next;
   };
 
-  typedef SkipList<const char*, KeyComparator> Table;
-
   ~MemTable();  // Private since only Unref() should be used to delete it
 
-  KeyComparator comparator_;
+  RangeDelNode* NewRangeDelNode(char* buf, SequenceNumber seq,
+                                const Slice& begin, const Slice& end);
+  void PushRangeDelNode(RangeDelNode* node);
+
+  // Returns the largest sequence number at most "snapshot" of the range
+  // deletions that cover "user_key", or 0 if there is none.
+  SequenceNumber MaxCoveringRangeDeletion(const Slice& user_key,
+                                          SequenceNumber snapshot) const;
+
+  MemTableKeyComparator comparator_;
   int refs_;
   Arena arena_;
-  Table table_;
+  MemTableRep* const table_;
+  std::atomic<RangeDelNode*> range_dels_;
 };
 
 }  // namespace leveldb
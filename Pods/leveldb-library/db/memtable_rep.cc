@@ -0,0 +1,328 @@
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+
+#include "db/memtable_rep.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "db/skiplist.h"
+#include "leveldb/options.h"
+#include "port/port.h"
+#include "port/thread_annotations.h"
+#include "util/arena.h"
+#include "util/coding.h"
+#include "util/hash.h"
+#include "util/mutexlock.h"
+
+namespace leveldb {
+
+static Slice GetLengthPrefixedSlice(const char* data) {
+  uint32_t len;
+  const char* p = data;
+  p = GetVarint32Ptr(p, p + 5, &len);  // +5: we assume "p" is not corrupted
+  return Slice(p, len);
+}
+
+int MemTableKeyComparator::operator()(const char* aptr,
+                                      const char* bptr) const {
+  // Internal keys are encoded as length-prefixed strings.
+  Slice a = GetLengthPrefixedSlice(aptr);
+  Slice b = GetLengthPrefixedSlice(bptr);
+  return comparator.Compare(a, b);
+}
+
+namespace {
+
+typedef SkipList<const char*, MemTableKeyComparator> EntryList;
+
+class SkipListIterator : public MemTableRep::Iterator {
+ public:
+  explicit SkipListIterator(const EntryList* list) : iter_(list) {}
+
+  bool Valid() const override { return iter_.Valid(); }
+  const char* key() const override { return iter_.key(); }
+  void Next() override { iter_.Next(); }
+  void Prev() override { iter_.Prev(); }
+  void Seek(const char* target) override { iter_.Seek(target); }
+  void SeekToFirst() override { iter_.SeekToFirst(); }
+  void SeekToLast() override { iter_.SeekToLast(); }
+
+ private:
+  EntryList::Iterator iter_;
+};
+
+// Returns the first entry of "list" at or after "target", or null.
+const char* ListFindGreaterOrEqual(const EntryList* list,
+                                   const char* target) {
+  EntryList::Iterator iter(list);
+  iter.Seek(target);
+  return iter.Valid() ? iter.key() : nullptr;
+}
+
+class SkipListRep : public MemTableRep {
+ public:
+  SkipListRep(const MemTableKeyComparator& comparator, Arena* arena)
+      : list_(comparator, arena) {}
+
+  void Insert(const char* entry) override { list_.Insert(entry); }
+
+  void InsertConcurrently(const char* entry) override {
+    list_.InsertConcurrently(entry);
+  }
+
+  const char* FindGreaterOrEqual(const char* target) const override {
+    return ListFindGreaterOrEqual(&list_, target);
+  }
+
+  // All of the list lives in the MemTable's arena.
+  size_t ApproximateMemoryUsage() const override { return 0; }
+
+  Iterator* NewIterator() const override {
+    return new SkipListIterator(&list_);
+  }
+
+ private:
+  EntryList list_;
+};
+
+typedef std::shared_ptr<const std::vector<const char*>> SortedEntries;
+
+// Iterates over a sorted copy of the entries of a rep.
+class SortedEntriesIterator : public MemTableRep::Iterator {
+ public:
+  SortedEntriesIterator(SortedEntries entries,
+                        const MemTableKeyComparator& comparator)
+      : entries_(std::move(entries)),
+        comparator_(comparator),
+        pos_(entries_->size()) {}
+
+  bool Valid() const override { return pos_ < entries_->size(); }
+  const char* key() const override {
+    assert(Valid());
+    return (*entries_)[pos_];
+  }
+  void Next() override {
+    assert(Valid());
+    pos_++;
+  }
+  void Prev() override {
+    assert(Valid());
+    pos_ = (pos_ == 0) ? entries_->size() : pos_ - 1;
+  }
+  void Seek(const char* target) override {
+    pos_ = LowerBound(*entries_, comparator_, target) - entries_->begin();
+  }
+  void SeekToFirst() override { pos_ = 0; }
+  void SeekToLast() override {
+    pos_ = entries_->empty() ? 0 : entries_->size() - 1;
+  }
+
+  static std::vector<const char*>::const_iterator LowerBound(
+      const std::vector<const char*>& entries,
+      const MemTableKeyComparator& comparator, const char* target) {
+    return std::lower_bound(entries.begin(), entries.end(), target,
+                            [&comparator](const char* a, const char* b) {
+                              return comparator(a, b) < 0;
+                            });
+  }
+
+ private:
+  const SortedEntries entries_;
+  const MemTableKeyComparator& comparator_;
+  size_t pos_;  // entries_->size() if not valid
+};
+
+// Keeps a small skiplist per hash bucket of user key prefixes.  Lookups
+// only search the list of their bucket; ordered iteration sorts a copy of
+// all entries.  The lists are allocated from the rep's own arena, under
+// insert_mutex_ when inserting concurrently, so that concurrent inserts
+// never mix with the MemTable's unsynchronized arena allocations.
+class HashSkipListRep : public MemTableRep {
+ public:
+  HashSkipListRep(const MemTableKeyComparator& comparator,
+                  size_t prefix_length, size_t bucket_count)
+      : comparator_(comparator),
+        prefix_length_(prefix_length),
+        bucket_count_(bucket_count),
+        buckets_(new std::atomic<EntryList*>[bucket_count]),
+        count_(0),
+        snapshot_count_(0) {
+    for (size_t i = 0; i < bucket_count_; i++) {
+      buckets_[i].store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  ~HashSkipListRep() override {
+    for (size_t i = 0; i < bucket_count_; i++) {
+      delete buckets_[i].load(std::memory_order_relaxed);
+    }
+    delete[] buckets_;
+  }
+
+  void Insert(const char* entry) override {
+    std::atomic<EntryList*>* bucket = BucketFor(entry);
+    EntryList* list = bucket->load(std::memory_order_relaxed);
+    if (list == nullptr) {
+      list = new EntryList(comparator_, &arena_);
+      bucket->store(list, std::memory_order_release);
+    }
+    list->Insert(entry);
+    count_.fetch_add(1, std::memory_order_release);
+  }
+
+  void InsertConcurrently(const char* entry) override {
+    MutexLock l(&insert_mutex_);
+    Insert(entry);
+  }
+
+  const char* FindGreaterOrEqual(const char* target) const override {
+    const EntryList* list =
+        BucketFor(target)->load(std::memory_order_acquire);
+    return list == nullptr ? nullptr : ListFindGreaterOrEqual(list, target);
+  }
+
+  size_t ApproximateMemoryUsage() const override {
+    return arena_.MemoryUsage() + bucket_count_ * sizeof(buckets_[0]);
+  }
+
+  Iterator* NewIterator() const override {
+    return new SortedEntriesIterator(Sorted(), comparator_);
+  }
+
+ private:
+  std::atomic<EntryList*>* BucketFor(const char* entry) const {
+    Slice user_key = ExtractUserKey(GetLengthPrefixedSlice(entry));
+    if (prefix_length_ > 0 && user_key.size() > prefix_length_) {
+      user_key = Slice(user_key.data(), prefix_length_);
+    }
+    return &buckets_[Hash(user_key.data(), user_key.size(), 0xbc9f1d34) %
+                     bucket_count_];
+  }
+
+  // Returns all entries in order.  The result is reused until more entries
+  // are inserted.
+  SortedEntries Sorted() const {
+    MutexLock l(&snapshot_mutex_);
+    const size_t count = count_.load(std::memory_order_acquire);
+    if (snapshot_ != nullptr && snapshot_count_ == count) {
+      return snapshot_;
+    }
+    std::vector<const char*>* entries = new std::vector<const char*>;
+    entries->reserve(count);
+    for (size_t i = 0; i < bucket_count_; i++) {
+      const EntryList* list = buckets_[i].load(std::memory_order_acquire);
+      if (list != nullptr) {
+        EntryList::Iterator iter(list);
+        for (iter.SeekToFirst(); iter.Valid(); iter.Next()) {
+          entries->push_back(iter.key());
+        }
+      }
+    }
+    const MemTableKeyComparator& comparator = comparator_;
+    std::sort(entries->begin(), entries->end(),
+              [&comparator](const char* a, const char* b) {
+                return comparator(a, b) < 0;
+              });
+    // Entries inserted while the buckets were walked may be missing, so
+    // the snapshot only counts as current for the count read up front.
+    snapshot_.reset(entries);
+    snapshot_count_ = count;
+    return snapshot_;
+  }
+
+  const MemTableKeyComparator comparator_;
+  const size_t prefix_length_;
+  const size_t bucket_count_;
+  std::atomic<EntryList*>* const buckets_;
+  std::atomic<size_t> count_;  // Number of entries inserted
+
+  port::Mutex insert_mutex_;
+  Arena arena_;  // Protected by insert_mutex_ for concurrent inserts
+
+  mutable port::Mutex snapshot_mutex_;
+  mutable SortedEntries snapshot_ GUARDED_BY(snapshot_mutex_);
+  mutable size_t snapshot_count_ GUARDED_BY(snapshot_mutex_);
+};
+
+// Appends entries to a vector, which is only sorted when it is read.  This
+// makes inserts as cheap as possible for memtables that are written and
+// then flushed without being read, such as during bulk loads.  Every read
+// after new inserts sorts the whole vector again.
+class VectorRep : public MemTableRep {
+ public:
+  explicit VectorRep(const MemTableKeyComparator& comparator)
+      : comparator_(comparator), memory_usage_(0) {}
+
+  void Insert(const char* entry) override {
+    MutexLock l(&mutex_);
+    entries_.push_back(entry);
+    sorted_.reset();
+    memory_usage_.store(entries_.capacity() * sizeof(entries_[0]),
+                        std::memory_order_relaxed);
+  }
+
+  void InsertConcurrently(const char* entry) override { Insert(entry); }
+
+  const char* FindGreaterOrEqual(const char* target) const override {
+    SortedEntries entries = Sorted();
+    auto iter =
+        SortedEntriesIterator::LowerBound(*entries, comparator_, target);
+    return iter == entries->end() ? nullptr : *iter;
+  }
+
+  size_t ApproximateMemoryUsage() const override {
+    // The sorted copy briefly doubles this, but is only made when the
+    // memtable is read.
+    return memory_usage_.load(std::memory_order_relaxed);
+  }
+
+  Iterator* NewIterator() const override {
+    return new SortedEntriesIterator(Sorted(), comparator_);
+  }
+
+ private:
+  SortedEntries Sorted() const {
+    MutexLock l(&mutex_);
+    if (sorted_ == nullptr) {
+      // Sorting in place leaves already sorted runs for the next sort.
+      const MemTableKeyComparator& comparator = comparator_;
+      std::sort(entries_.begin(), entries_.end(),
+                [&comparator](const char* a, const char* b) {
+                  return comparator(a, b) < 0;
+                });
+      sorted_ = std::make_shared<const std::vector<const char*>>(entries_);
+    }
+    return sorted_;
+  }
+
+  const MemTableKeyComparator comparator_;
+
+  mutable port::Mutex mutex_;
+  mutable std::vector<const char*> entries_ GUARDED_BY(mutex_);
+  mutable SortedEntries sorted_ GUARDED_BY(mutex_);  // Null after inserts
+  std::atomic<size_t> memory_usage_;
+};
+
+}  // namespace
+
+MemTableRep* NewMemTableRep(const Options& options,
+                            const MemTableKeyComparator& comparator,
+                            Arena* arena) {
+  switch (options.memtable_rep) {
+    case kHashSkipListRep:
+      return new HashSkipListRep(
+          comparator, options.memtable_prefix_length,
+          std::max<size_t>(1024, options.write_buffer_size / 1024));
+    case kVectorRep:
+      return new VectorRep(comparator);
+    case kSkipListRep:
+    default:
+      return new SkipListRep(comparator, arena);
+  }
+}
+
+}  // namespace leveldb
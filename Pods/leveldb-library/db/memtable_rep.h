@@ -0,0 +1,97 @@
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+//
+// A MemTableRep is the data structure a MemTable keeps its entries in.
+// Entries are pointers to encoded memtable entries (see memtable.cc),
+// which are allocated by the MemTable and outlive the rep.
+//
+// Thread safety: like SkipList, Insert() requires external
+// synchronization, InsertConcurrently() may be called from several threads
+// as long as no thread calls Insert() at the same time, and reads may run
+// at the same time as either.
+
+#ifndef STORAGE_LEVELDB_DB_MEMTABLE_REP_H_
+#define STORAGE_LEVELDB_DB_MEMTABLE_REP_H_
+
+#include <cstddef>
+
+#include "db/dbformat.h"
+
+namespace leveldb {
+
+class Arena;
+struct Options;
+
+// Orders encoded memtable entries by their internal keys.
+struct MemTableKeyComparator {
+  const InternalKeyComparator comparator;
+  explicit MemTableKeyComparator(const InternalKeyComparator& c)
+      : comparator(c) {}
+  int operator()(const char* a, const char* b) const;
+};
+
+class MemTableRep {
+ public:
+  // Iteration over the entries in comparator order.  An iterator may or may
+  // not see the entries inserted after it was created.
+  class Iterator {
+   public:
+    virtual ~Iterator() = default;
+
+    virtual bool Valid() const = 0;
+
+    // REQUIRES: Valid()
+    virtual const char* key() const = 0;
+
+    // REQUIRES: Valid()
+    virtual void Next() = 0;
+
+    // REQUIRES: Valid()
+    virtual void Prev() = 0;
+
+    // Advance to the first entry with a key >= target.
+    virtual void Seek(const char* target) = 0;
+
+    virtual void SeekToFirst() = 0;
+    virtual void SeekToLast() = 0;
+  };
+
+  MemTableRep() = default;
+
+  MemTableRep(const MemTableRep&) = delete;
+  MemTableRep& operator=(const MemTableRep&) = delete;
+
+  virtual ~MemTableRep() = default;
+
+  // Insert an entry.
+  // REQUIRES: nothing that compares equal to entry is in the rep.
+  virtual void Insert(const char* entry) = 0;
+
+  // Like Insert(), but may be called from several threads at once.
+  virtual void InsertConcurrently(const char* entry) = 0;
+
+  // Returns the first entry at or after "target", which must be encoded
+  // like LookupKey::memtable_key(), or null if there is none.  Entries of
+  // user keys other than the one in "target" may be skipped over, so the
+  // caller must check the user key of the result.
+  virtual const char* FindGreaterOrEqual(const char* target) const = 0;
+
+  // Returns the memory used by the rep itself, not counting its entries or
+  // what it allocated from the MemTable's arena.
+  virtual size_t ApproximateMemoryUsage() const = 0;
+
+  // Returns a new iterator over the rep.  The caller must delete it before
+  // the rep is destroyed.
+  virtual Iterator* NewIterator() const = 0;
+};
+
+// Returns the rep selected by options.memtable_rep.  Nodes of skiplist reps
+// are allocated from "arena", which must outlive the rep.
+MemTableRep* NewMemTableRep(const Options& options,
+                            const MemTableKeyComparator& comparator,
+                            Arena* arena);
+
+}  // namespace leveldb
+
+#endif  // STORAGE_LEVELDB_DB_MEMTABLE_REP_H_
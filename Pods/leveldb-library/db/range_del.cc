@@ -0,0 +1,125 @@
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+
+#include "db/range_del.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "util/coding.h"
+
+namespace leveldb {
+
+std::string RangeTombstoneKey(const RangeTombstone& t) {
+  std::string key;
+  AppendInternalKey(&key,
+                    ParsedInternalKey(t.start, t.seq, kTypeRangeDeletion));
+  return key;
+}
+
+bool ParseRangeTombstone(const Slice& key, const Slice& value,
+                         RangeTombstone* t) {
+  if (key.size() < 8) {
+    return false;
+  }
+  const uint64_t tag = DecodeFixed64(key.data() + key.size() - 8);
+  if ((tag & 0xff) != kTypeRangeDeletion) {
+    return false;
+  }
+  t->start.assign(key.data(), key.size() - 8);
+  t->end.assign(value.data(), value.size());
+  t->seq = tag >> 8;
+  return true;
+}
+
+void ExtendRangeToTombstone(const InternalKeyComparator& icmp,
+                            const RangeTombstone& t, bool* empty,
+                            InternalKey* smallest, InternalKey* largest) {
+  InternalKey start(t.start, kMaxSequenceNumber, kValueTypeForSeek);
+  InternalKey end(t.end, kMaxSequenceNumber, kTypeRangeDeletion);
+  if (*empty || icmp.Compare(start, *smallest) < 0) {
+    *smallest = start;
+  }
+  if (*empty || icmp.Compare(end, *largest) > 0) {
+    *largest = end;
+  }
+  *empty = false;
+}
+
+void RangeDelAggregator::Add(const RangeTombstone& t) {
+  if (ucmp_->Compare(t.start, t.end) < 0) {
+    tombstones_.push_back(t);
+    fragmented_ = false;
+  }
+}
+
+void RangeDelAggregator::AddAll(const std::vector<RangeTombstone>& tombstones) {
+  for (const RangeTombstone& t : tombstones) {
+    Add(t);
+  }
+}
+
+void RangeDelAggregator::Fragment() {
+  auto less = [this](const std::string& a, const std::string& b) {
+    return ucmp_->Compare(a, b) < 0;
+  };
+  boundaries_.clear();
+  for (const RangeTombstone& t : tombstones_) {
+    boundaries_.push_back(t.start);
+    boundaries_.push_back(t.end);
+  }
+  std::sort(boundaries_.begin(), boundaries_.end(), less);
+  boundaries_.erase(
+      std::unique(boundaries_.begin(), boundaries_.end(),
+                  [this](const std::string& a, const std::string& b) {
+                    return ucmp_->Compare(a, b) == 0;
+                  }),
+      boundaries_.end());
+
+  seqs_.assign(boundaries_.empty() ? 0 : boundaries_.size() - 1,
+               std::vector<SequenceNumber>());
+  for (const RangeTombstone& t : tombstones_) {
+    size_t i = std::lower_bound(boundaries_.begin(), boundaries_.end(),
+                                t.start, less) -
+               boundaries_.begin();
+    for (; ucmp_->Compare(boundaries_[i], t.end) < 0; i++) {
+      seqs_[i].push_back(t.seq);
+    }
+  }
+  for (std::vector<SequenceNumber>& seqs : seqs_) {
+    std::sort(seqs.begin(), seqs.end(), std::greater<SequenceNumber>());
+  }
+  fragmented_ = true;
+}
+
+SequenceNumber RangeDelAggregator::MaxCoveringSequence(
+    const Slice& user_key, SequenceNumber snapshot) {
+  if (tombstones_.empty()) {
+    return 0;
+  }
+  if (!fragmented_) {
+    Fragment();
+  }
+  // The fragment that starts at the last boundary not after user_key.
+  auto iter = std::upper_bound(boundaries_.begin(), boundaries_.end(),
+                               user_key,
+                               [this](const Slice& a, const std::string& b) {
+                                 return ucmp_->Compare(a, b) < 0;
+                               });
+  if (iter == boundaries_.begin()) {
+    return 0;
+  }
+  const size_t i = (iter - boundaries_.begin()) - 1;
+  if (i >= seqs_.size()) {
+    return 0;
+  }
+  for (SequenceNumber seq : seqs_[i]) {
+    if (seq <= snapshot) {
+      return seq;
+    }
+  }
+  return 0;
+}
+
+}  // namespace leveldb
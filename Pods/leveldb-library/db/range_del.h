@@ -0,0 +1,109 @@
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+//
+// Range deletions, as written by WriteBatch::DeleteRange(), are kept apart
+// from the point entries: memtables hold them in a list of their own, and
+// tables in a "leveldb.range_del" meta block.  Readers look up the newest
+// tombstone covering a key and treat entries older than it as deleted.
+
+#ifndef STORAGE_LEVELDB_DB_RANGE_DEL_H_
+#define STORAGE_LEVELDB_DB_RANGE_DEL_H_
+
+#include <string>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "leveldb/comparator.h"
+
+namespace leveldb {
+
+// Deletes every entry whose user key is in [start, end) and whose sequence
+// number is less than "seq".
+struct RangeTombstone {
+  RangeTombstone() : seq(0) {}
+  RangeTombstone(const Slice& start, const Slice& end, SequenceNumber seq)
+      : start(start.ToString()), end(end.ToString()), seq(seq) {}
+
+  std::string start;  // Inclusive
+  std::string end;    // Exclusive
+  SequenceNumber seq;
+};
+
+// The range deletion block of a table maps the internal key
+// (start, seq, kTypeRangeDeletion) of each tombstone to its end user key.
+// Returns the key of the entry of "t" in a range deletion block.
+std::string RangeTombstoneKey(const RangeTombstone& t);
+
+// Parses an entry of a range deletion block into *t.  Returns false if the
+// entry is malformed.
+bool ParseRangeTombstone(const Slice& key, const Slice& value,
+                         RangeTombstone* t);
+
+// Returns true if "t" covers "user_key", whatever its sequence number.
+inline bool RangeTombstoneCovers(const Comparator* ucmp,
+                                 const RangeTombstone& t,
+                                 const Slice& user_key) {
+  return ucmp->Compare(user_key, t.start) >= 0 &&
+         ucmp->Compare(user_key, t.end) < 0;
+}
+
+// Widens the key range [*smallest, *largest] of a table file to cover "t".
+// Its end is exclusive, so the largest key becomes the internal key
+// (t.end, kMaxSequenceNumber, kTypeRangeDeletion), which sorts before every
+// entry for t.end and before the smallest key of a file starting there.
+// If *empty, the range has no keys yet; it is cleared.
+void ExtendRangeToTombstone(const InternalKeyComparator& icmp,
+                            const RangeTombstone& t, bool* empty,
+                            InternalKey* smallest, InternalKey* largest);
+
+// Collects the tombstones that apply to a read, and answers which of them
+// covers a key.  Tombstones may be added at any time; they are split into
+// non-overlapping fragments, which can be binary searched, when the next
+// question is asked.
+//
+// Not safe for concurrent use.
+class RangeDelAggregator {
+ public:
+  explicit RangeDelAggregator(const Comparator* ucmp)
+      : ucmp_(ucmp), fragmented_(true) {}
+
+  RangeDelAggregator(const RangeDelAggregator&) = delete;
+  RangeDelAggregator& operator=(const RangeDelAggregator&) = delete;
+
+  void Add(const RangeTombstone& t);
+  void AddAll(const std::vector<RangeTombstone>& tombstones);
+
+  bool empty() const { return tombstones_.empty(); }
+  const std::vector<RangeTombstone>& tombstones() const { return tombstones_; }
+
+  // Returns the largest sequence number no greater than "snapshot" of the
+  // tombstones that cover "user_key", or 0 if there is none.
+  SequenceNumber MaxCoveringSequence(const Slice& user_key,
+                                     SequenceNumber snapshot);
+
+  // Returns true if the entry for "user_key" at "seq" is deleted by a
+  // tombstone that is visible at "snapshot".
+  bool ShouldDelete(const Slice& user_key, SequenceNumber seq,
+                    SequenceNumber snapshot) {
+    return !tombstones_.empty() &&
+           MaxCoveringSequence(user_key, snapshot) > seq;
+  }
+
+ private:
+  void Fragment();
+
+  const Comparator* const ucmp_;
+  std::vector<RangeTombstone> tombstones_;
+
+  // Fragment i is [boundaries_[i], boundaries_[i + 1]), and is covered by
+  // the tombstones with sequence numbers seqs_[i], largest first.  Only
+  // valid if fragmented_.
+  bool fragmented_;
+  std::vector<std::string> boundaries_;
+  std::vector<std::vector<SequenceNumber>> seqs_;
+};
+
+}  // namespace leveldb
+
+#endif  // STORAGE_LEVELDB_DB_RANGE_DEL_H_
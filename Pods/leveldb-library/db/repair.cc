@@ -31,6 +31,7 @@
 #include "db/log_reader.h"
 #include "db/log_writer.h"
 #include "db/memtable.h"
+#include "db/range_del.h"
 #include "db/table_cache.h"
 #include "db/version_edit.h"
 #include "db/write_batch_internal.h"
@@ -177,7 +178,7 @@ class Repairer {
     std::string scratch;
     Slice record;
     WriteBatch batch;
-    MemTable* mem = new MemTable(icmp_);
+    MemTable* mem = new MemTable(icmp_, options_);
     mem->Ref();
     int counter = 0;
     while (reader.ReadRecord(&record, &scratch)) {
@@ -203,7 +204,10 @@ class Repairer {
     FileMetaData meta;
     meta.number = next_file_number_++;
     Iterator* iter = mem->NewIterator();
-    status = BuildTable(dbname_, env_, options_, table_cache_, iter, &meta);
+    std::vector<RangeTombstone> range_dels;
+    mem->GetRangeTombstones(&range_dels);
+    status = BuildTable(dbname_, env_, options_, table_cache_, iter,
+                        range_dels, &meta, nullptr);
     delete iter;
     mem->Unref();
     mem = nullptr;
@@ -229,7 +233,7 @@ class Repairer {
     // on checksum verification.
     ReadOptions r;
     r.verify_checksums = options_.paranoid_checks;
-    return table_cache_->NewIterator(r, meta.number, meta.file_size);
+    return table_cache_->NewIterator(r, meta.number, meta.file_size, -1);
   }
 
   void ScanTable(uint64_t number) {
@@ -281,6 +285,20 @@ class Repairer {
       status = iter->status();
     }
     delete iter;
+
+    // The key range of the table also covers its range deletions.
+    std::vector<RangeTombstone> range_dels;
+    if (status.ok()) {
+      status = table_cache_->GetRangeTombstones(
+          t.meta.number, t.meta.file_size, -1, &range_dels);
+    }
+    for (const RangeTombstone& d : range_dels) {
+      ExtendRangeToTombstone(icmp_, d, &empty, &t.meta.smallest,
+                             &t.meta.largest);
+      if (d.seq > t.max_sequence) {
+        t.max_sequence = d.seq;
+      }
+    }
     Log(options_.info_log, "Table #%llu: %d entries %s",
         (unsigned long long)t.meta.number, counter, status.ToString().c_str());
 
@@ -313,6 +331,18 @@ class Repairer {
     }
     delete iter;
 
+    // Keep the range deletions too, if they can still be read.
+    std::vector<RangeTombstone> range_dels;
+    if (table_cache_
+            ->GetRangeTombstones(t.meta.number, t.meta.file_size, -1,
+                                 &range_dels)
+            .ok()) {
+      for (const RangeTombstone& d : range_dels) {
+        builder->AddRangeDeletion(RangeTombstoneKey(d), d.end);
+        counter++;
+      }
+    }
+
     ArchiveFile(src);
     if (counter == 0) {
       builder->Abandon();  // Nothing to save
@@ -0,0 +1,120 @@
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+
+#include "leveldb/sst_file_writer.h"
+
+#include "db/dbformat.h"
+#include "leveldb/env.h"
+#include "leveldb/table_builder.h"
+
+namespace leveldb {
+
+// The file holds internal keys, like the tables of a DB, so that it can
+// be ingested without being rewritten.  Every entry gets sequence number
+// zero; DB::IngestExternalFile() assigns a real one if the entries must
+// be ordered against data already in the DB.
+struct SstFileWriter::Rep {
+  explicit Rep(const Options& opt)
+      : internal_comparator(opt.comparator),
+        internal_filter_policy(opt.filter_policy),
+        options(opt),
+        file(nullptr),
+        builder(nullptr),
+        status(Status::InvalidArgument("SstFileWriter is not open")) {
+    options.comparator = &internal_comparator;
+    options.filter_policy =
+        (opt.filter_policy != nullptr) ? &internal_filter_policy : nullptr;
+  }
+
+  const InternalKeyComparator internal_comparator;
+  const InternalFilterPolicy internal_filter_policy;
+  Options options;
+  std::string fname;
+  WritableFile* file;
+  TableBuilder* builder;
+  std::string last_key;  // User key of the last entry
+  Status status;
+};
+
+SstFileWriter::SstFileWriter(const Options& options)
+    : rep_(new Rep(options)) {}
+
+SstFileWriter::~SstFileWriter() {
+  if (rep_->builder != nullptr) {
+    // Open() was called without a successful Finish().
+    rep_->builder->Abandon();
+    delete rep_->builder;
+    delete rep_->file;
+    rep_->options.env->RemoveFile(rep_->fname);
+  }
+  delete rep_;
+}
+
+Status SstFileWriter::Open(const std::string& fname) {
+  Rep* r = rep_;
+  if (r->builder != nullptr) {
+    return Status::InvalidArgument("SstFileWriter is already open");
+  }
+  r->status = r->options.env->NewWritableFile(fname, &r->file);
+  if (r->status.ok()) {
+    r->fname = fname;
+    r->last_key.clear();
+    r->builder = new TableBuilder(r->options, r->file);
+  }
+  return r->status;
+}
+
+Status SstFileWriter::Put(const Slice& key, const Slice& value) {
+  Rep* r = rep_;
+  if (!r->status.ok()) {
+    return r->status;
+  }
+  if (r->builder->NumEntries() > 0 &&
+      r->internal_comparator.user_comparator()->Compare(key, r->last_key) <=
+          0) {
+    return Status::InvalidArgument("keys must be added in increasing order",
+                                   key);
+  }
+  InternalKey ikey(key, 0, kTypeValue);
+  r->builder->Add(ikey.Encode(), value);
+  r->last_key.assign(key.data(), key.size());
+  r->status = r->builder->status();
+  return r->status;
+}
+
+Status SstFileWriter::Finish(uint64_t* file_size) {
+  Rep* r = rep_;
+  if (!r->status.ok()) {
+    return r->status;
+  }
+  if (r->builder->NumEntries() == 0) {
+    return Status::InvalidArgument("cannot finish a file without entries");
+  }
+  Status s = r->builder->Finish();
+  if (s.ok() && file_size != nullptr) {
+    *file_size = r->builder->FileSize();
+  }
+  delete r->builder;
+  r->builder = nullptr;
+  if (s.ok()) {
+    s = r->file->Sync();
+  }
+  if (s.ok()) {
+    s = r->file->Close();
+  }
+  delete r->file;
+  r->file = nullptr;
+  if (!s.ok()) {
+    r->options.env->RemoveFile(r->fname);
+  }
+  // The writer can only be reused by opening another file.
+  r->status = s.ok() ? Status::InvalidArgument("SstFileWriter is not open") : s;
+  return s;
+}
+
+uint64_t SstFileWriter::NumEntries() const {
+  return (rep_->builder != nullptr) ? rep_->builder->NumEntries() : 0;
+}
+
+}  // namespace leveldb
@@ -4,10 +4,18 @@
 
 #include "db/table_cache.h"
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
 #include "db/filename.h"
 #include "leveldb/env.h"
+#include "leveldb/pinnable_slice.h"
 #include "leveldb/table.h"
+#include "port/thread_annotations.h"
 #include "util/coding.h"
+#include "util/mutexlock.h"
+#include "util/perf_context_imp.h"
 
 namespace leveldb {
 
@@ -29,6 +37,84 @@ static void UnrefEntry(void* arg1, void* arg2) {
   cache->Release(h);
 }
 
+static void DeleteTableAndFile(void* arg1, void* arg2) {
+  delete reinterpret_cast<Table*>(arg1);
+  delete reinterpret_cast<RandomAccessFile*>(arg2);
+}
+
+namespace {
+
+// Serves the small block reads of a compaction, which walks a table from
+// start to end, out of a buffer filled by large reads of the file.  Results
+// are always copied into the caller's scratch, as the buffer is refilled
+// while blocks read earlier are still in use.
+class ReadaheadRandomAccessFile : public RandomAccessFile {
+ public:
+  // Takes ownership of "file", which is "file_size" bytes long.
+  ReadaheadRandomAccessFile(RandomAccessFile* file, uint64_t file_size,
+                            size_t readahead_size)
+      : file_(file),
+        file_size_(file_size),
+        readahead_size_(readahead_size),
+        buffer_(new char[readahead_size]),
+        buffer_offset_(0),
+        buffer_size_(0) {}
+
+  ~ReadaheadRandomAccessFile() override { delete file_; }
+
+  Status Read(uint64_t offset, size_t n, Slice* result,
+              char* scratch) const override {
+    if (n >= readahead_size_) {
+      return file_->Read(offset, n, result, scratch);
+    }
+
+    MutexLock l(&mutex_);
+    if (offset < buffer_offset_ ||
+        offset + n > buffer_offset_ + buffer_size_) {
+      buffer_offset_ = offset;
+      buffer_size_ = 0;
+      if (offset < file_size_) {
+        // Reads past the end of the file fail for mmap-ed files.
+        const size_t size = static_cast<size_t>(
+            std::min<uint64_t>(readahead_size_, file_size_ - offset));
+        Slice data;
+        Status s = file_->Read(offset, size, &data, buffer_.get());
+        if (!s.ok()) {
+          *result = Slice();
+          return s;
+        }
+        if (data.data() != buffer_.get()) {
+          std::memcpy(buffer_.get(), data.data(), data.size());
+        }
+        buffer_size_ = data.size();
+      }
+    }
+
+    const uint64_t skip = offset - buffer_offset_;
+    const size_t available =
+        skip < buffer_size_
+            ? std::min(n, buffer_size_ - static_cast<size_t>(skip))
+            : 0;
+    std::memcpy(scratch, buffer_.get() + skip, available);
+    *result = Slice(scratch, available);
+    return Status::OK();
+  }
+
+  void Hint(AccessPattern pattern) override { file_->Hint(pattern); }
+
+ private:
+  RandomAccessFile* const file_;
+  const uint64_t file_size_;
+  const size_t readahead_size_;
+
+  mutable port::Mutex mutex_;
+  const std::unique_ptr<char[]> buffer_ GUARDED_BY(mutex_);
+  mutable uint64_t buffer_offset_ GUARDED_BY(mutex_);
+  mutable size_t buffer_size_ GUARDED_BY(mutex_);
+};
+
+}  // namespace
+
 TableCache::TableCache(const std::string& dbname, const Options& options,
                        int entries)
     : env_(options.env),
@@ -38,57 +124,174 @@ TableCache::TableCache(const std::string& dbname, const Options& options,
 
 TableCache::~TableCache() { delete cache_; }
 
+Status TableCache::OpenTableFile(uint64_t file_number, bool uncached,
+                                 RandomAccessFile** file) {
+  std::string fname = TableFileName(dbname_, file_number);
+  Status s = uncached ? env_->NewUncachedRandomAccessFile(fname, file)
+                      : env_->NewRandomAccessFile(fname, file);
+  if (!s.ok()) {
+    std::string old_fname = SSTTableFileName(dbname_, file_number);
+    Status old_s = uncached ? env_->NewUncachedRandomAccessFile(old_fname, file)
+                            : env_->NewRandomAccessFile(old_fname, file);
+    if (old_s.ok()) {
+      s = Status::OK();
+    }
+  }
+  return s;
+}
+
+struct TableCache::PendingOpen {
+  explicit PendingOpen(port::Mutex* mu) : done(false), cv(mu) {}
+
+  bool done;
+  Status status;
+  port::CondVar cv;  // Signalled when done
+};
+
 Status TableCache::FindTable(uint64_t file_number, uint64_t file_size,
-                             Cache::Handle** handle) {
-  Status s;
+                             int level, Cache::Handle** handle) {
   char buf[sizeof(file_number)];
   EncodeFixed64(buf, file_number);
   Slice key(buf, sizeof(buf));
   *handle = cache_->Lookup(key);
-  if (*handle == nullptr) {
-    std::string fname = TableFileName(dbname_, file_number);
-    RandomAccessFile* file = nullptr;
-    Table* table = nullptr;
-    s = env_->NewRandomAccessFile(fname, &file);
-    if (!s.ok()) {
-      std::string old_fname = SSTTableFileName(dbname_, file_number);
-      if (env_->NewRandomAccessFile(old_fname, &file).ok()) {
-        s = Status::OK();
+  if (*handle != nullptr) {
+    return Status::OK();
+  }
+
+  std::shared_ptr<PendingOpen> open;
+  {
+    MutexLock l(&mutex_);
+    auto iter = pending_opens_.find(file_number);
+    if (iter == pending_opens_.end()) {
+      // The table may have been inserted since the lookup above.
+      *handle = cache_->Lookup(key);
+      if (*handle != nullptr) {
+        return Status::OK();
+      }
+      open = std::make_shared<PendingOpen>(&mutex_);
+      pending_opens_.emplace(file_number, open);
+    } else {
+      std::shared_ptr<PendingOpen> other = iter->second;
+      while (!other->done) {
+        other->cv.Wait();
       }
+      if (!other->status.ok()) {
+        return other->status;
+      }
+      *handle = cache_->Lookup(key);
+      if (*handle != nullptr) {
+        return Status::OK();
+      }
+      // Already evicted again; open it without waiting for anybody.
     }
-    if (s.ok()) {
-      s = Table::Open(options_, file, file_size, &table);
+  }
+
+  Status s = OpenTable(key, file_number, file_size, level, handle);
+  if (open != nullptr) {
+    MutexLock l(&mutex_);
+    open->status = s;
+    open->done = true;
+    pending_opens_.erase(file_number);
+    open->cv.SignalAll();
+  }
+  return s;
+}
+
+Status TableCache::OpenTable(const Slice& key, uint64_t file_number,
+                             uint64_t file_size, int level,
+                             Cache::Handle** handle) {
+  PERF_TIMER_GUARD(table_open_nanos);
+  PERF_COUNTER_ADD(table_open_count, 1);
+  RandomAccessFile* file = nullptr;
+  Table* table = nullptr;
+  Status s = OpenTableFile(file_number, /*uncached=*/false, &file);
+  if (s.ok()) {
+    if (options_.advise_random_on_open) {
+      file->Hint(RandomAccessFile::kRandom);
     }
+    s = Table::Open(options_, file, file_size, level, &table);
+  }
 
-    if (!s.ok()) {
-      assert(table == nullptr);
-      delete file;
-      // We do not cache error results so that if the error is transient,
-      // or somebody repairs the file, we recover automatically.
-    } else {
-      TableAndFile* tf = new TableAndFile;
-      tf->file = file;
-      tf->table = table;
-      *handle = cache_->Insert(key, tf, 1, &DeleteEntry);
+  if (!s.ok()) {
+    assert(table == nullptr);
+    delete file;
+    // We do not cache error results so that if the error is transient,
+    // or somebody repairs the file, we recover automatically.
+  } else {
+    TableAndFile* tf = new TableAndFile;
+    tf->file = file;
+    tf->table = table;
+    *handle = cache_->Insert(key, tf, 1, &DeleteEntry);
+  }
+  return s;
+}
+
+Status TableCache::ReadRangeTombstones(const Table* table,
+                                       std::vector<RangeTombstone>* result) {
+  Iterator* iter = table->NewRangeDeletionIterator();
+  if (iter == nullptr) {
+    return Status::OK();
+  }
+  RangeTombstone t;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    if (!ParseRangeTombstone(iter->key(), iter->value(), &t)) {
+      delete iter;
+      return Status::Corruption("corrupted range deletion in table");
     }
+    result->push_back(t);
   }
+  Status s = iter->status();
+  delete iter;
   return s;
 }
 
+void TableCache::UpdateCoveringSequence(const Table* table, const Slice& k,
+                                        SequenceNumber* covering_seq) const {
+  Iterator* iter = table->NewRangeDeletionIterator();
+  if (iter == nullptr) {
+    return;
+  }
+  // Tables of a DB are always opened with an InternalKeyComparator.
+  const Comparator* ucmp =
+      static_cast<const InternalKeyComparator*>(options_.comparator)
+          ->user_comparator();
+  const Slice user_key = ExtractUserKey(k);
+  const SequenceNumber snapshot = DecodeFixed64(k.data() + k.size() - 8) >> 8;
+  RangeTombstone t;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    if (ParseRangeTombstone(iter->key(), iter->value(), &t) &&
+        t.seq <= snapshot && t.seq > *covering_seq &&
+        RangeTombstoneCovers(ucmp, t, user_key)) {
+      *covering_seq = t.seq;
+    }
+  }
+  delete iter;
+}
+
 Iterator* TableCache::NewIterator(const ReadOptions& options,
                                   uint64_t file_number, uint64_t file_size,
-                                  Table** tableptr) {
+                                  int level, Table** tableptr,
+                                  RangeDelAggregator* range_dels) {
   if (tableptr != nullptr) {
     *tableptr = nullptr;
   }
 
   Cache::Handle* handle = nullptr;
-  Status s = FindTable(file_number, file_size, &handle);
+  Status s = FindTable(file_number, file_size, level, &handle);
   if (!s.ok()) {
     return NewErrorIterator(s);
   }
 
   Table* table = reinterpret_cast<TableAndFile*>(cache_->Value(handle))->table;
+  if (range_dels != nullptr) {
+    std::vector<RangeTombstone> tombstones;
+    s = ReadRangeTombstones(table, &tombstones);
+    if (!s.ok()) {
+      cache_->Release(handle);
+      return NewErrorIterator(s);
+    }
+    range_dels->AddAll(tombstones);
+  }
   Iterator* result = table->NewIterator(options);
   result->RegisterCleanup(&UnrefEntry, cache_, handle);
   if (tableptr != nullptr) {
@@ -97,15 +300,104 @@ Iterator* TableCache::NewIterator(const ReadOptions& options,
   return result;
 }
 
+Iterator* TableCache::NewCompactionIterator(const ReadOptions& options,
+                                            uint64_t file_number,
+                                            uint64_t file_size, int level) {
+  if (options_.compaction_readahead_size == 0) {
+    return NewIterator(options, file_number, file_size, level);
+  }
+
+  RandomAccessFile* file = nullptr;
+  Status s = OpenTableFile(file_number,
+                           options_.use_direct_reads_for_compaction, &file);
+  if (!s.ok()) {
+    return NewErrorIterator(s);
+  }
+  file->Hint(RandomAccessFile::kSequential);
+  file = new ReadaheadRandomAccessFile(file, file_size,
+                                       options_.compaction_readahead_size);
+
+  // A compaction reads every block once and never consults the filter, so
+  // the private table neither uses the block cache nor loads its filter.
+  Options table_options = options_;
+  table_options.block_cache = nullptr;
+  table_options.filter_policy = nullptr;
+  table_options.cache_index_and_filter_blocks = false;
+  Table* table = nullptr;
+  s = Table::Open(table_options, file, file_size, &table);
+  if (!s.ok()) {
+    assert(table == nullptr);
+    delete file;
+    return NewErrorIterator(s);
+  }
+
+  Iterator* result = table->NewIterator(options);
+  result->RegisterCleanup(&DeleteTableAndFile, table, file);
+  return result;
+}
+
 Status TableCache::Get(const ReadOptions& options, uint64_t file_number,
-                       uint64_t file_size, const Slice& k, void* arg,
+                       uint64_t file_size, int level, const Slice& k, void* arg,
                        void (*handle_result)(void*, const Slice&,
-                                             const Slice&)) {
+                                             const Slice&),
+                       SequenceNumber* covering_seq, PinnableSlice* pinned) {
+  Cache::Handle* handle = nullptr;
+  Status s = FindTable(file_number, file_size, level, &handle);
+  if (s.ok()) {
+    Table* t = reinterpret_cast<TableAndFile*>(cache_->Value(handle))->table;
+    if (covering_seq != nullptr) {
+      UpdateCoveringSequence(t, k, covering_seq);
+    }
+    s = t->InternalGet(options, k, arg, handle_result, pinned);
+    if (pinned != nullptr && pinned->IsPinned()) {
+      // The file may be mapped into memory that the block points into.
+      pinned->RegisterCleanup(&UnrefEntry, cache_, handle);
+    } else {
+      cache_->Release(handle);
+    }
+  }
+  return s;
+}
+
+Status TableCache::MultiGet(const ReadOptions& options, uint64_t file_number,
+                            uint64_t file_size, int level, const Slice* keys,
+                            int n, void* const* args,
+                            void (*handle_result)(void*, const Slice&,
+                                                  const Slice&),
+                            SequenceNumber* const* covering_seqs) {
   Cache::Handle* handle = nullptr;
-  Status s = FindTable(file_number, file_size, &handle);
+  Status s = FindTable(file_number, file_size, level, &handle);
   if (s.ok()) {
     Table* t = reinterpret_cast<TableAndFile*>(cache_->Value(handle))->table;
-    s = t->InternalGet(options, k, arg, handle_result);
+    if (covering_seqs != nullptr) {
+      for (int i = 0; i < n; i++) {
+        UpdateCoveringSequence(t, keys[i], covering_seqs[i]);
+      }
+    }
+    s = t->InternalMultiGet(options, keys, n, args, handle_result);
+    cache_->Release(handle);
+  }
+  return s;
+}
+
+Status TableCache::GetRangeTombstones(uint64_t file_number,
+                                      uint64_t file_size, int level,
+                                      std::vector<RangeTombstone>* result) {
+  Cache::Handle* handle = nullptr;
+  Status s = FindTable(file_number, file_size, level, &handle);
+  if (s.ok()) {
+    Table* t = reinterpret_cast<TableAndFile*>(cache_->Value(handle))->table;
+    s = ReadRangeTombstones(t, result);
+    cache_->Release(handle);
+  }
+  return s;
+}
+
+Status TableCache::Preload(uint64_t file_number, uint64_t file_size,
+                           int level) {
+  Cache::Handle* handle = nullptr;
+  Status s = FindTable(file_number, file_size, level, &handle);
+  if (s.ok()) {
     cache_->Release(handle);
   }
   return s;
@@ -8,12 +8,17 @@
 #define STORAGE_LEVELDB_DB_TABLE_CACHE_H_
 
 #include <cstdint>
+#include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "db/dbformat.h"
+#include "db/range_del.h"
 #include "leveldb/cache.h"
 #include "leveldb/table.h"
 #include "port/port.h"
+#include "port/thread_annotations.h"
 
 namespace leveldb {
 
@@ -31,25 +36,91 @@ class TableCache {
   // underlies the returned iterator.  The returned "*tableptr" object is owned
   // by the cache and should not be deleted, and is valid for as long as the
   // returned iterator is live.
+  //
+  // "level" is the level the file belongs to, or -1 if it is not known.
+  // It only decides whether the index and filter blocks of the table are
+  // pinned in the block cache when the table is first opened.
+  //
+  // If "range_dels" is non-null, the range deletions of the file are added
+  // to it, and an error iterator is returned if they cannot be read.
   Iterator* NewIterator(const ReadOptions& options, uint64_t file_number,
-                        uint64_t file_size, Table** tableptr = nullptr);
+                        uint64_t file_size, int level,
+                        Table** tableptr = nullptr,
+                        RangeDelAggregator* range_dels = nullptr);
+
+  // Return an iterator over the specified file for use by a compaction.  If
+  // options_.compaction_readahead_size is zero this is NewIterator().
+  // Otherwise the file is opened separately from the cached table: it is
+  // read in chunks of that size, bypassing the block cache, and bypassing
+  // the OS page cache too if options_.use_direct_reads_for_compaction is set.
+  Iterator* NewCompactionIterator(const ReadOptions& options,
+                                  uint64_t file_number, uint64_t file_size,
+                                  int level);
 
   // If a seek to internal key "k" in specified file finds an entry,
   // call (*handle_result)(arg, found_key, found_value).
+  //
+  // If "covering_seq" is non-null, it is raised to the largest sequence
+  // number, no greater than that of "k", of the range deletions of the file
+  // that cover the user key of "k".
+  //
+  // If "pinned" is non-null and (*handle_result) pins it to the value it is
+  // passed (see Table::InternalGet()), the table and the block holding the
+  // value are kept until *pinned is released.
   Status Get(const ReadOptions& options, uint64_t file_number,
-             uint64_t file_size, const Slice& k, void* arg,
-             void (*handle_result)(void*, const Slice&, const Slice&));
+             uint64_t file_size, int level, const Slice& k, void* arg,
+             void (*handle_result)(void*, const Slice&, const Slice&),
+             SequenceNumber* covering_seq = nullptr,
+             PinnableSlice* pinned = nullptr);
+
+  // Like Get() for each of the "n" internal keys, which must be in
+  // increasing order, passing args[i] to the calls made for keys[i] and
+  // raising *covering_seqs[i] if "covering_seqs" is non-null.
+  Status MultiGet(const ReadOptions& options, uint64_t file_number,
+                  uint64_t file_size, int level, const Slice* keys, int n,
+                  void* const* args,
+                  void (*handle_result)(void*, const Slice&, const Slice&),
+                  SequenceNumber* const* covering_seqs = nullptr);
+
+  // Appends the range deletions of the specified file to *result.
+  Status GetRangeTombstones(uint64_t file_number, uint64_t file_size,
+                            int level, std::vector<RangeTombstone>* result);
+
+  // Open the table of the specified file and keep it in the cache, unless
+  // it is there already, so that later reads need not open it.
+  Status Preload(uint64_t file_number, uint64_t file_size, int level);
 
   // Evict any entry for the specified file number
   void Evict(uint64_t file_number);
 
  private:
-  Status FindTable(uint64_t file_number, uint64_t file_size, Cache::Handle**);
+  struct PendingOpen;
+
+  Status OpenTableFile(uint64_t file_number, bool uncached,
+                       RandomAccessFile** file);
+  Status FindTable(uint64_t file_number, uint64_t file_size, int level,
+                   Cache::Handle**);
+  // Open the table and insert it into cache_.
+  Status OpenTable(const Slice& key, uint64_t file_number, uint64_t file_size,
+                   int level, Cache::Handle**);
+
+  static Status ReadRangeTombstones(const Table* table,
+                                    std::vector<RangeTombstone>* result);
+  // Raises *covering_seq for the range deletions of "table", like Get().
+  void UpdateCoveringSequence(const Table* table, const Slice& k,
+                              SequenceNumber* covering_seq) const;
 
   Env* const env_;
   const std::string dbname_;
   const Options& options_;
   Cache* cache_;
+
+  // Tables that are being opened after a cache miss, by file number.  Other
+  // threads that miss on the same table wait for that open instead of
+  // reading the footer, index and filter of the table again.
+  port::Mutex mutex_;
+  std::map<uint64_t, std::shared_ptr<PendingOpen>> pending_opens_
+      GUARDED_BY(mutex_);
 };
 
 }  // namespace leveldb
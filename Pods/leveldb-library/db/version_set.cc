@@ -5,6 +5,7 @@
 #include "db/version_set.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdio>
 
 #include "db/filename.h"
@@ -13,11 +14,13 @@
 #include "db/memtable.h"
 #include "db/table_cache.h"
 #include "leveldb/env.h"
+#include "leveldb/pinnable_slice.h"
 #include "leveldb/table_builder.h"
 #include "table/merger.h"
 #include "table/two_level_iterator.h"
 #include "util/coding.h"
 #include "util/logging.h"
+#include "util/mutexlock.h"
 
 namespace leveldb {
 
@@ -51,6 +54,14 @@ static double MaxBytesForLevel(const Options* options, int level) {
   return result;
 }
 
+// With kTieredCompaction, a run is merged into the next level once that
+// level holds at most this many times its size.
+static const int kTieredSizeRatio = 2;
+
+// With kTieredCompaction, the score of moving a run into an empty level.
+// Moves are preferred to merges, since they do not rewrite any data.
+static const double kTieredMoveScore = 2;
+
 static uint64_t MaxFileSizeForLevel(const Options* options, int level) {
   // We could vary per level to reduce number of files?
   return TargetFileSize(options);
@@ -214,24 +225,84 @@ static Iterator* GetFileIterator(void* arg, const ReadOptions& options,
     return NewErrorIterator(
         Status::Corruption("FileReader invoked with unexpected value"));
   } else {
+    // Only files above level-0 are reached through a LevelFileNumIterator.
     return cache->NewIterator(options, DecodeFixed64(file_value.data()),
-                              DecodeFixed64(file_value.data() + 8));
+                              DecodeFixed64(file_value.data() + 8), -1);
+  }
+}
+
+namespace {
+
+// The argument of GetFileIteratorWithRangeDels().
+struct FileIteratorArg {
+  TableCache* table_cache;
+  RangeDelAggregator* range_dels;
+};
+
+void DeleteFileIteratorArg(void* arg, void* ignored) {
+  delete reinterpret_cast<FileIteratorArg*>(arg);
+}
+
+}  // namespace
+
+// Like GetFileIterator(), but also adds the range deletions of the file to
+// those of the iterator.
+static Iterator* GetFileIteratorWithRangeDels(void* arg,
+                                              const ReadOptions& options,
+                                              const Slice& file_value) {
+  FileIteratorArg* state = reinterpret_cast<FileIteratorArg*>(arg);
+  if (file_value.size() != 16) {
+    return NewErrorIterator(
+        Status::Corruption("FileReader invoked with unexpected value"));
+  } else {
+    return state->table_cache->NewIterator(
+        options, DecodeFixed64(file_value.data()),
+        DecodeFixed64(file_value.data() + 8), -1, nullptr, state->range_dels);
   }
 }
 
-Iterator* Version::NewConcatenatingIterator(const ReadOptions& options,
-                                            int level) const {
-  return NewTwoLevelIterator(
-      new LevelFileNumIterator(vset_->icmp_, &files_[level]), &GetFileIterator,
-      vset_->table_cache_, options);
+static Iterator* GetCompactionFileIterator(void* arg,
+                                           const ReadOptions& options,
+                                           const Slice& file_value) {
+  TableCache* cache = reinterpret_cast<TableCache*>(arg);
+  if (file_value.size() != 16) {
+    return NewErrorIterator(
+        Status::Corruption("FileReader invoked with unexpected value"));
+  } else {
+    return cache->NewCompactionIterator(options,
+                                        DecodeFixed64(file_value.data()),
+                                        DecodeFixed64(file_value.data() + 8),
+                                        -1);
+  }
+}
+
+Iterator* Version::NewConcatenatingIterator(
+    const ReadOptions& options, int level,
+    RangeDelAggregator* range_dels) const {
+  if (range_dels == nullptr) {
+    return NewTwoLevelIterator(
+        new LevelFileNumIterator(vset_->icmp_, &files_[level]),
+        &GetFileIterator, vset_->table_cache_, options);
+  }
+  // The files are opened as the iterator reaches them, and every file
+  // covers the range deletions it holds, so they are known before any of
+  // the keys they cover is returned.
+  FileIteratorArg* arg = new FileIteratorArg{vset_->table_cache_, range_dels};
+  Iterator* result = NewTwoLevelIterator(
+      new LevelFileNumIterator(vset_->icmp_, &files_[level]),
+      &GetFileIteratorWithRangeDels, arg, options);
+  result->RegisterCleanup(&DeleteFileIteratorArg, arg, nullptr);
+  return result;
 }
 
 void Version::AddIterators(const ReadOptions& options,
-                           std::vector<Iterator*>* iters) {
+                           std::vector<Iterator*>* iters,
+                           RangeDelAggregator* range_dels) {
   // Merge all level zero files together since they may overlap
   for (size_t i = 0; i < files_[0].size(); i++) {
     iters->push_back(vset_->table_cache_->NewIterator(
-        options, files_[0][i]->number, files_[0][i]->file_size));
+        options, files_[0][i]->number, files_[0][i]->file_size, 0, nullptr,
+        range_dels));
   }
 
   // For levels > 0, we can use a concatenating iterator that sequentially
@@ -239,7 +310,7 @@ void Version::AddIterators(const ReadOptions& options,
   // lazily.
   for (int level = 1; level < config::kNumLevels; level++) {
     if (!files_[level].empty()) {
-      iters->push_back(NewConcatenatingIterator(options, level));
+      iters->push_back(NewConcatenatingIterator(options, level, range_dels));
     }
   }
 }
@@ -256,7 +327,11 @@ struct Saver {
   SaverState state;
   const Comparator* ucmp;
   Slice user_key;
-  std::string* value;
+  std::string* value;     // Where a found value is copied, or nullptr
+  PinnableSlice* pinned;  // Where it is pinned if "value" is nullptr
+  // The largest sequence number of the range deletions that cover the key
+  // in the files looked at so far.  Entries older than it are deleted.
+  SequenceNumber covering_seq;
 };
 }  // namespace
 static void SaveValue(void* arg, const Slice& ikey, const Slice& v) {
@@ -266,9 +341,16 @@ static void SaveValue(void* arg, const Slice& ikey, const Slice& v) {
     s->state = kCorrupt;
   } else {
     if (s->ucmp->Compare(parsed_key.user_key, s->user_key) == 0) {
-      s->state = (parsed_key.type == kTypeValue) ? kFound : kDeleted;
+      s->state = (parsed_key.type == kTypeValue &&
+                  parsed_key.sequence >= s->covering_seq)
+                     ? kFound
+                     : kDeleted;
       if (s->state == kFound) {
-        s->value->assign(v.data(), v.size());
+        if (s->value != nullptr) {
+          s->value->assign(v.data(), v.size());
+        } else {
+          s->pinned->PinSlice(v);
+        }
       }
     }
   }
@@ -323,6 +405,17 @@ void Version::ForEachOverlapping(Slice user_key, Slice internal_key, void* arg,
 
 Status Version::Get(const ReadOptions& options, const LookupKey& k,
                     std::string* value, GetStats* stats) {
+  return Get(options, k, value, nullptr, stats);
+}
+
+Status Version::Get(const ReadOptions& options, const LookupKey& k,
+                    PinnableSlice* value, GetStats* stats) {
+  return Get(options, k, nullptr, value, stats);
+}
+
+Status Version::Get(const ReadOptions& options, const LookupKey& k,
+                    std::string* value, PinnableSlice* pinned,
+                    GetStats* stats) {
   stats->seek_file = nullptr;
   stats->seek_file_level = -1;
 
@@ -351,9 +444,10 @@ Status Version::Get(const ReadOptions& options, const LookupKey& k,
       state->last_file_read = f;
       state->last_file_read_level = level;
 
-      state->s = state->vset->table_cache_->Get(*state->options, f->number,
-                                                f->file_size, state->ikey,
-                                                &state->saver, SaveValue);
+      state->s = state->vset->table_cache_->Get(
+          *state->options, f->number, f->file_size, level, state->ikey,
+          &state->saver, SaveValue, &state->saver.covering_seq,
+          state->saver.pinned);
       if (!state->s.ok()) {
         state->found = true;
         return false;
@@ -393,14 +487,222 @@ Status Version::Get(const ReadOptions& options, const LookupKey& k,
   state.saver.ucmp = vset_->icmp_.user_comparator();
   state.saver.user_key = k.user_key();
   state.saver.value = value;
+  state.saver.pinned = pinned;
+  state.saver.covering_seq = 0;
 
   ForEachOverlapping(state.saver.user_key, state.ikey, &state, &State::Match);
 
   return state.found ? state.s : Status::NotFound(Slice());
 }
 
+namespace {
+
+// The keys of a Version::MultiGet() that are looked up in one table file.
+struct MultiGetBatch {
+  TableCache* table_cache;
+  const ReadOptions* options;
+  FileMetaData* file;
+  int level;
+  std::vector<size_t> key_indices;  // Indices into the MultiGet() keys
+  std::vector<Slice> ikeys;
+  std::vector<void*> savers;
+  std::vector<SequenceNumber*> covering_seqs;
+  Status status;
+
+  void Run() {
+    status = table_cache->MultiGet(
+        *options, file->number, file->file_size, level, ikeys.data(),
+        static_cast<int>(ikeys.size()), savers.data(), SaveValue,
+        covering_seqs.data());
+  }
+};
+
+// Batches of one level that are shared out among several threads.
+struct MultiGetWork {
+  explicit MultiGetWork(std::vector<MultiGetBatch>* b)
+      : batches(b), next(0), done_cv(&mu), running(0) {}
+
+  // Runs batches until none are left.
+  void RunBatches() {
+    size_t i;
+    while ((i = next.fetch_add(1, std::memory_order_relaxed)) <
+           batches->size()) {
+      (*batches)[i].Run();
+    }
+  }
+
+  static void Thread(void* arg) {
+    MultiGetWork* work = reinterpret_cast<MultiGetWork*>(arg);
+    work->RunBatches();
+    MutexLock l(&work->mu);
+    work->running--;
+    work->done_cv.SignalAll();
+  }
+
+  std::vector<MultiGetBatch>* const batches;
+  std::atomic<size_t> next;
+  port::Mutex mu;
+  port::CondVar done_cv;
+  int running GUARDED_BY(mu);
+};
+
+}  // namespace
+
+void Version::MultiGet(const ReadOptions& options,
+                       const std::vector<const LookupKey*>& keys,
+                       const std::vector<std::string*>& vals,
+                       std::vector<Status>* statuses, GetStats* stats) {
+  stats->seek_file = nullptr;
+  stats->seek_file_level = -1;
+
+  // Per-key state, like that of a Get().
+  struct KeyState {
+    Saver saver;
+    FileMetaData* last_file_read;
+    int last_file_read_level;
+    bool done;
+  };
+
+  const Comparator* ucmp = vset_->icmp_.user_comparator();
+  const size_t n = keys.size();
+  statuses->assign(n, Status::NotFound(Slice()));
+  std::vector<KeyState> state(n);
+  for (size_t i = 0; i < n; i++) {
+    state[i].saver.state = kNotFound;
+    state[i].saver.ucmp = ucmp;
+    state[i].saver.user_key = keys[i]->user_key();
+    state[i].saver.value = vals[i];
+    state[i].saver.pinned = nullptr;
+    state[i].saver.covering_seq = 0;
+    state[i].last_file_read = nullptr;
+    state[i].last_file_read_level = -1;
+    state[i].done = false;
+  }
+  size_t pending = n;
+
+  auto add_key = [&](MultiGetBatch* batch, size_t i) {
+    KeyState* k = &state[i];
+    if (stats->seek_file == nullptr && k->last_file_read != nullptr) {
+      // More than one seek for this key.  Charge its 1st file.
+      stats->seek_file = k->last_file_read;
+      stats->seek_file_level = k->last_file_read_level;
+    }
+    k->last_file_read = batch->file;
+    k->last_file_read_level = batch->level;
+    batch->key_indices.push_back(i);
+    batch->ikeys.push_back(keys[i]->internal_key());
+    batch->savers.push_back(&k->saver);
+    batch->covering_seqs.push_back(&k->saver.covering_seq);
+  };
+
+  auto finish_batch = [&](const MultiGetBatch& batch) {
+    for (size_t i : batch.key_indices) {
+      KeyState* k = &state[i];
+      if (k->saver.state == kNotFound && !batch.status.ok()) {
+        (*statuses)[i] = batch.status;
+      } else if (k->saver.state == kFound) {
+        (*statuses)[i] = Status::OK();
+      } else if (k->saver.state == kCorrupt) {
+        (*statuses)[i] =
+            Status::Corruption("corrupted key for ", k->saver.user_key);
+      } else if (k->saver.state == kNotFound) {
+        continue;  // Keep searching in other files
+      }
+      k->done = true;
+      pending--;
+    }
+  };
+
+  auto new_batch = [&](FileMetaData* f, int level) {
+    MultiGetBatch batch;
+    batch.table_cache = vset_->table_cache_;
+    batch.options = &options;
+    batch.file = f;
+    batch.level = level;
+    return batch;
+  };
+
+  // Search level-0 in order from newest to oldest.  The keys of one file
+  // form a batch, and the files are searched one after another.
+  std::vector<FileMetaData*> tmp(files_[0]);
+  std::sort(tmp.begin(), tmp.end(), NewestFirst);
+  for (size_t j = 0; j < tmp.size() && pending > 0; j++) {
+    FileMetaData* f = tmp[j];
+    MultiGetBatch batch = new_batch(f, 0);
+    for (size_t i = 0; i < n; i++) {
+      if (!state[i].done &&
+          ucmp->Compare(state[i].saver.user_key, f->smallest.user_key()) >=
+              0 &&
+          ucmp->Compare(state[i].saver.user_key, f->largest.user_key()) <=
+              0) {
+        add_key(&batch, i);
+      }
+    }
+    if (!batch.ikeys.empty()) {
+      batch.Run();
+      finish_batch(batch);
+    }
+  }
+
+  // Search other levels.  Each key is in at most one file of a level, so
+  // the batches of a level hold distinct keys and can run in parallel.
+  const int max_threads = vset_->options_->max_multiget_threads;
+  std::vector<MultiGetBatch> batches;
+  for (int level = 1; level < config::kNumLevels && pending > 0; level++) {
+    const std::vector<FileMetaData*>& files = files_[level];
+    if (files.empty()) continue;
+
+    batches.clear();
+    for (size_t i = 0; i < n; i++) {
+      if (state[i].done) continue;
+      uint32_t index = FindFile(vset_->icmp_, files, keys[i]->internal_key());
+      if (index >= files.size()) {
+        // Neither this key nor any later one is in the level.
+        break;
+      }
+      FileMetaData* f = files[index];
+      if (ucmp->Compare(state[i].saver.user_key, f->smallest.user_key()) < 0) {
+        // All of "f" is past any data for this key
+        continue;
+      }
+      if (batches.empty() || batches.back().file != f) {
+        batches.push_back(new_batch(f, level));
+      }
+      add_key(&batches.back(), i);
+    }
+
+    const int threads =
+        std::min(max_threads, static_cast<int>(batches.size())) - 1;
+    if (threads > 0) {
+      MultiGetWork work(&batches);
+      work.mu.Lock();
+      work.running = threads;
+      work.mu.Unlock();
+      for (int t = 0; t < threads; t++) {
+        vset_->env_->StartThread(&MultiGetWork::Thread, &work);
+      }
+      work.RunBatches();
+      MutexLock l(&work.mu);
+      while (work.running > 0) {
+        work.done_cv.Wait();
+      }
+    } else {
+      for (MultiGetBatch& batch : batches) {
+        batch.Run();
+      }
+    }
+    for (const MultiGetBatch& batch : batches) {
+      finish_batch(batch);
+    }
+  }
+}
+
 bool Version::UpdateStats(const GetStats& stats) {
   FileMetaData* f = stats.seek_file;
+  if (vset_->options_->compaction_style == kTieredCompaction) {
+    // Tiered compactions merge whole runs, picked by their sizes only.
+    return false;
+  }
   if (f != nullptr) {
     f->allowed_seeks--;
     if (f->allowed_seeks <= 0 && file_to_compact_ == nullptr) {
@@ -470,6 +772,10 @@ bool Version::OverlapInLevel(int level, const Slice* smallest_user_key,
 int Version::PickLevelForMemTableOutput(const Slice& smallest_user_key,
                                         const Slice& largest_user_key) {
   int level = 0;
+  if (vset_->options_->compaction_style == kTieredCompaction) {
+    // Every memtable starts a new run in level-0.
+    return level;
+  }
   if (!OverlapInLevel(0, &smallest_user_key, &largest_user_key)) {
     // Push to next level if there is no overlap in next level,
     // and the #bytes overlapping in the level after that are limited.
@@ -824,7 +1130,11 @@ Status VersionSet::LogAndApply(VersionEdit* edit, port::Mutex* mu) {
       edit->EncodeTo(&record);
       s = descriptor_log_->AddRecord(record);
       if (s.ok()) {
-        s = descriptor_file_->Sync();
+        // A new MANIFEST is the checkpoint that recovery starts from, so
+        // it is always synced fully.
+        s = new_manifest_file.empty() && options_->sync_mode == kSyncBarrier
+                ? descriptor_file_->SyncBarrier()
+                : descriptor_file_->Sync();
       }
       if (!s.ok()) {
         Log(options_->info_log, "MANIFEST write: %s\n", s.ToString().c_str());
@@ -1023,34 +1333,73 @@ void VersionSet::MarkFileNumberUsed(uint64_t number) {
   }
 }
 
+static double LevelCompactionScore(const Options* options,
+                                   const std::vector<FileMetaData*>& files,
+                                   int level) {
+  if (level == 0) {
+    // We treat level-0 specially by bounding the number of files
+    // instead of number of bytes for two reasons:
+    //
+    // (1) With larger write-buffer sizes, it is nice not to do too
+    // many level-0 compactions.
+    //
+    // (2) The files in level-0 are merged on every read and
+    // therefore we wish to avoid too many files when the individual
+    // file size is small (perhaps because of a small write-buffer
+    // setting, or very high compression ratios, or lots of
+    // overwrites/deletions).
+    return files.size() / static_cast<double>(config::kL0_CompactionTrigger);
+  } else {
+    // Compute the ratio of current size to size limit.
+    const uint64_t level_bytes = TotalFileSize(files);
+    return static_cast<double>(level_bytes) / MaxBytesForLevel(options, level);
+  }
+}
+
+// Levels above level-0 hold one sorted run each under kTieredCompaction,
+// the newest in level-1.  Returns the score of compacting "level" into
+// "level + 1", which is at least 1 if that is needed:
+//
+// - A run sinks into the next level while it is empty, so that level-1
+//   is free for a new run.  Moves do not rewrite any data.
+// - Level-0 files are merged into a run once there are
+//   kL0_CompactionTrigger of them, unless level-1 is about to sink.
+// - A run is merged into the next one once it has grown to at least
+//   1/kTieredSizeRatio of its size.  Each merge rewrites at most
+//   1 + kTieredSizeRatio times the data of the newer run, and runs grow
+//   geometrically towards the last level.
+static double TieredCompactionScore(const std::vector<FileMetaData*>* files,
+                                    int level) {
+  if (level == 0) {
+    if (!files[1].empty()) {
+      for (int i = 2; i < config::kNumLevels; i++) {
+        if (files[i].empty()) {
+          return 0;
+        }
+      }
+    }
+    return files[0].size() / static_cast<double>(config::kL0_CompactionTrigger);
+  }
+  if (files[level].empty()) {
+    return 0;
+  }
+  if (files[level + 1].empty()) {
+    return kTieredMoveScore;
+  }
+  return static_cast<double>(TotalFileSize(files[level])) * kTieredSizeRatio /
+         TotalFileSize(files[level + 1]);
+}
+
 void VersionSet::Finalize(Version* v) {
   // Precomputed best level for next compaction
   int best_level = -1;
   double best_score = -1;
 
   for (int level = 0; level < config::kNumLevels - 1; level++) {
-    double score;
-    if (level == 0) {
-      // We treat level-0 specially by bounding the number of files
-      // instead of number of bytes for two reasons:
-      //
-      // (1) With larger write-buffer sizes, it is nice not to do too
-      // many level-0 compactions.
-      //
-      // (2) The files in level-0 are merged on every read and
-      // therefore we wish to avoid too many files when the individual
-      // file size is small (perhaps because of a small write-buffer
-      // setting, or very high compression ratios, or lots of
-      // overwrites/deletions).
-      score = v->files_[level].size() /
-              static_cast<double>(config::kL0_CompactionTrigger);
-    } else {
-      // Compute the ratio of current size to size limit.
-      const uint64_t level_bytes = TotalFileSize(v->files_[level]);
-      score =
-          static_cast<double>(level_bytes) / MaxBytesForLevel(options_, level);
-    }
-
+    double score =
+        options_->compaction_style == kTieredCompaction
+            ? TieredCompactionScore(v->files_, level)
+            : LevelCompactionScore(options_, v->files_[level], level);
     if (score > best_score) {
       best_level = level;
       best_score = score;
@@ -1129,8 +1478,9 @@ uint64_t VersionSet::ApproximateOffsetOf(Version* v, const InternalKey& ikey) {
         // "ikey" falls in the range for this table.  Add the
         // approximate offset of "ikey" within the table.
         Table* tableptr;
-        Iterator* iter = table_cache_->NewIterator(
-            ReadOptions(), files[i]->number, files[i]->file_size, &tableptr);
+        Iterator* iter =
+            table_cache_->NewIterator(ReadOptions(), files[i]->number,
+                                      files[i]->file_size, level, &tableptr);
         if (tableptr != nullptr) {
           result += tableptr->ApproximateOffsetOf(ikey.Encode());
         }
@@ -1211,6 +1561,19 @@ void VersionSet::GetRange2(const std::vector<FileMetaData*>& inputs1,
   GetRange(all, smallest, largest);
 }
 
+Status VersionSet::GetCompactionRangeTombstones(
+    Compaction* c, std::vector<RangeTombstone>* result) {
+  Status s;
+  for (int which = 0; which < 2 && s.ok(); which++) {
+    for (size_t i = 0; i < c->inputs_[which].size() && s.ok(); i++) {
+      const FileMetaData* f = c->inputs_[which][i];
+      s = table_cache_->GetRangeTombstones(f->number, f->file_size,
+                                           c->level() + which, result);
+    }
+  }
+  return s;
+}
+
 Iterator* VersionSet::MakeInputIterator(Compaction* c) {
   ReadOptions options;
   options.verify_checksums = options_->paranoid_checks;
@@ -1227,14 +1590,14 @@ Iterator* VersionSet::MakeInputIterator(Compaction* c) {
       if (c->level() + which == 0) {
         const std::vector<FileMetaData*>& files = c->inputs_[which];
         for (size_t i = 0; i < files.size(); i++) {
-          list[num++] = table_cache_->NewIterator(options, files[i]->number,
-                                                  files[i]->file_size);
+          list[num++] = table_cache_->NewCompactionIterator(
+              options, files[i]->number, files[i]->file_size, 0);
         }
       } else {
         // Create concatenating iterator for the files from this level
         list[num++] = NewTwoLevelIterator(
             new Version::LevelFileNumIterator(icmp_, &c->inputs_[which]),
-            &GetFileIterator, table_cache_, options);
+            &GetCompactionFileIterator, table_cache_, options);
       }
     }
   }
@@ -1244,41 +1607,99 @@ Iterator* VersionSet::MakeInputIterator(Compaction* c) {
   return result;
 }
 
+static bool AnyBeingCompacted(const std::vector<FileMetaData*>& files) {
+  for (size_t i = 0; i < files.size(); i++) {
+    if (files[i]->being_compacted) {
+      return true;
+    }
+  }
+  return false;
+}
+
 Compaction* VersionSet::PickCompaction() {
-  Compaction* c;
-  int level;
+  if (options_->compaction_style == kTieredCompaction) {
+    return PickTieredCompaction();
+  }
 
   // We prefer compactions triggered by too much data in a level over
-  // the compactions triggered by seeks.
-  const bool size_compaction = (current_->compaction_score_ >= 1);
-  const bool seek_compaction = (current_->file_to_compact_ != nullptr);
-  if (size_compaction) {
-    level = current_->compaction_level_;
-    assert(level >= 0);
-    assert(level + 1 < config::kNumLevels);
-    c = new Compaction(options_, level);
-
-    // Pick the first file that comes after compact_pointer_[level]
-    for (size_t i = 0; i < current_->files_[level].size(); i++) {
-      FileMetaData* f = current_->files_[level][i];
-      if (compact_pointer_[level].empty() ||
-          icmp_.Compare(f->largest.Encode(), compact_pointer_[level]) > 0) {
-        c->inputs_[0].push_back(f);
-        break;
+  // the compactions triggered by seeks.  Levels are tried in decreasing
+  // order of their score, so a level whose best candidate conflicts with
+  // a running compaction does not block work on the other levels.
+  if (current_->compaction_score_ >= 1) {
+    std::vector<std::pair<double, int>> levels;
+    for (int level = 0; level < config::kNumLevels - 1; level++) {
+      const double score =
+          LevelCompactionScore(options_, current_->files_[level], level);
+      if (score >= 1) {
+        levels.push_back(std::make_pair(-score, level));
+      }
+    }
+    std::sort(levels.begin(), levels.end());
+    for (size_t i = 0; i < levels.size(); i++) {
+      Compaction* c = PickSizeCompaction(levels[i].second);
+      if (c != nullptr) {
+        return c;
       }
     }
-    if (c->inputs_[0].empty()) {
-      // Wrap-around to the beginning of the key space
-      c->inputs_[0].push_back(current_->files_[level][0]);
+  }
+
+  if (current_->file_to_compact_ != nullptr &&
+      !current_->file_to_compact_->being_compacted) {
+    const int level = current_->file_to_compact_level_;
+    if (level == 0 && AnyBeingCompacted(current_->files_[0])) {
+      return nullptr;
     }
-  } else if (seek_compaction) {
-    level = current_->file_to_compact_level_;
-    c = new Compaction(options_, level);
+    Compaction* c = new Compaction(options_, level);
     c->inputs_[0].push_back(current_->file_to_compact_);
-  } else {
+    c->input_version_ = current_;
+    c->input_version_->Ref();
+    if (level == 0) {
+      InternalKey smallest, largest;
+      GetRange(c->inputs_[0], &smallest, &largest);
+      current_->GetOverlappingInputs(0, &smallest, &largest, &c->inputs_[0]);
+      assert(!c->inputs_[0].empty());
+    }
+    SetupOtherInputs(c);
+    return ClaimInputs(c);
+  }
+  return nullptr;
+}
+
+Compaction* VersionSet::PickSizeCompaction(int level) {
+  assert(level >= 0);
+  assert(level + 1 < config::kNumLevels);
+  const std::vector<FileMetaData*>& files = current_->files_[level];
+
+  // Level-0 files may overlap each other, so only one level-0 compaction
+  // may run at a time.
+  if (level == 0 && AnyBeingCompacted(files)) {
     return nullptr;
   }
 
+  // Pick the first file that comes after compact_pointer_[level] and is
+  // not already part of a running compaction, wrapping around to the
+  // beginning of the key space if needed.
+  FileMetaData* picked = nullptr;
+  for (size_t i = 0; i < files.size(); i++) {
+    FileMetaData* f = files[i];
+    if (!f->being_compacted &&
+        (compact_pointer_[level].empty() ||
+         icmp_.Compare(f->largest.Encode(), compact_pointer_[level]) > 0)) {
+      picked = f;
+      break;
+    }
+  }
+  for (size_t i = 0; picked == nullptr && i < files.size(); i++) {
+    if (!files[i]->being_compacted) {
+      picked = files[i];
+    }
+  }
+  if (picked == nullptr) {
+    return nullptr;
+  }
+
+  Compaction* c = new Compaction(options_, level);
+  c->inputs_[0].push_back(picked);
   c->input_version_ = current_;
   c->input_version_->Ref();
 
@@ -1295,6 +1716,18 @@ Compaction* VersionSet::PickCompaction() {
 
   SetupOtherInputs(c);
 
+  return ClaimInputs(c);
+}
+
+Compaction* VersionSet::ClaimInputs(Compaction* c) {
+  // Two compactions that share no input file also write disjoint key
+  // ranges of their output level: any output level file overlapping both
+  // would have been picked up as an input by both.
+  if (AnyBeingCompacted(c->inputs_[0]) || AnyBeingCompacted(c->inputs_[1])) {
+    delete c;
+    return nullptr;
+  }
+  c->MarkInputsBeingCompacted(true);
   return c;
 }
 
@@ -1386,6 +1819,10 @@ void VersionSet::SetupOtherInputs(Compaction* c) {
 
   current_->GetOverlappingInputs(level + 1, &smallest, &largest,
                                  &c->inputs_[1]);
+  // A level+1 file that starts with the last user key of the picked ones
+  // has to be compacted along with them, or a deletion marker for that key
+  // could be dropped while an older value survives in the skipped file.
+  AddBoundaryInputs(icmp_, current_->files_[level + 1], &c->inputs_[1]);
 
   // Get entire range covered by compaction
   InternalKey all_start, all_limit;
@@ -1408,6 +1845,7 @@ void VersionSet::SetupOtherInputs(Compaction* c) {
       std::vector<FileMetaData*> expanded1;
       current_->GetOverlappingInputs(level + 1, &new_start, &new_limit,
                                      &expanded1);
+      AddBoundaryInputs(icmp_, current_->files_[level + 1], &expanded1);
       if (expanded1.size() == c->inputs_[1].size()) {
         Log(options_->info_log,
             "Expanding@%d %d+%d (%ld+%ld bytes) to %d+%d (%ld+%ld bytes)\n",
@@ -1438,6 +1876,45 @@ void VersionSet::SetupOtherInputs(Compaction* c) {
   c->edit_.SetCompactPointer(level, largest);
 }
 
+Compaction* VersionSet::PickTieredCompaction() {
+  if (current_->compaction_score_ < 1) {
+    return nullptr;
+  }
+  std::vector<std::pair<double, int>> levels;
+  for (int level = 0; level < config::kNumLevels - 1; level++) {
+    const double score = TieredCompactionScore(current_->files_, level);
+    if (score >= 1) {
+      levels.push_back(std::make_pair(-score, level));
+    }
+  }
+  std::sort(levels.begin(), levels.end());
+  for (size_t i = 0; i < levels.size(); i++) {
+    const int level = levels[i].second;
+    if (AnyBeingCompacted(current_->files_[level])) {
+      continue;
+    }
+
+    // The whole run (or all of level-0) is compacted, along with the files
+    // of the next run that it overlaps.  If there are none, the run is
+    // moved instead.  There are no grandparents: splitting the outputs by
+    // them would only leave small files in a run that is merged as a whole.
+    Compaction* c = new Compaction(options_, level);
+    c->inputs_[0] = current_->files_[level];
+    c->input_version_ = current_;
+    c->input_version_->Ref();
+    InternalKey smallest, largest;
+    GetRange(c->inputs_[0], &smallest, &largest);
+    current_->GetOverlappingInputs(level + 1, &smallest, &largest,
+                                   &c->inputs_[1]);
+    AddBoundaryInputs(icmp_, current_->files_[level + 1], &c->inputs_[1]);
+    c = ClaimInputs(c);
+    if (c != nullptr) {
+      return c;
+    }
+  }
+  return nullptr;
+}
+
 Compaction* VersionSet::CompactRange(int level, const InternalKey* begin,
                                      const InternalKey* end) {
   std::vector<FileMetaData*> inputs;
@@ -1468,7 +1945,7 @@ Compaction* VersionSet::CompactRange(int level, const InternalKey* begin,
   c->input_version_->Ref();
   c->inputs_[0] = inputs;
   SetupOtherInputs(c);
-  return c;
+  return ClaimInputs(c);
 }
 
 Compaction::Compaction(const Options* options, int level)
@@ -1477,16 +1954,33 @@ Compaction::Compaction(const Options* options, int level)
       input_version_(nullptr),
       grandparent_index_(0),
       seen_key_(false),
-      overlapped_bytes_(0) {
+      overlapped_bytes_(0),
+      owns_inputs_(false) {
   for (int i = 0; i < config::kNumLevels; i++) {
     level_ptrs_[i] = 0;
   }
 }
 
-Compaction::~Compaction() {
-  if (input_version_ != nullptr) {
-    input_version_->Unref();
+Compaction::~Compaction() { ReleaseInputs(); }
+
+Compaction* Compaction::NewSubcompaction() const {
+  Compaction* c = new Compaction(input_version_->vset_->options_, level_);
+  c->input_version_ = input_version_;
+  c->input_version_->Ref();
+  c->inputs_[0] = inputs_[0];
+  c->inputs_[1] = inputs_[1];
+  c->grandparents_ = grandparents_;
+  return c;
+}
+
+void Compaction::MarkInputsBeingCompacted(bool being_compacted) {
+  for (int which = 0; which < 2; which++) {
+    for (size_t i = 0; i < inputs_[which].size(); i++) {
+      assert(inputs_[which][i]->being_compacted != being_compacted);
+      inputs_[which][i]->being_compacted = being_compacted;
+    }
   }
+  owns_inputs_ = being_compacted;
 }
 
 bool Compaction::IsTrivialMove() const {
@@ -1494,6 +1988,11 @@ bool Compaction::IsTrivialMove() const {
   // Avoid a move if there is lots of overlapping grandparent data.
   // Otherwise, the move could create a parent file that will require
   // a very expensive merge later on.
+  if (vset->options_->compaction_style == kTieredCompaction) {
+    // A whole run moves into an empty part of the next level; level-0 files
+    // may overlap each other, so they only move one at a time.
+    return num_input_files(1) == 0 && (level_ > 0 || num_input_files(0) == 1);
+  }
   return (num_input_files(0) == 1 && num_input_files(1) == 0 &&
           TotalFileSize(grandparents_) <=
               MaxGrandParentOverlapBytes(vset->options_));
@@ -1528,6 +2027,20 @@ bool Compaction::IsBaseLevelForKey(const Slice& user_key) {
   return true;
 }
 
+bool Compaction::IsBaseLevelForRange(const Slice& begin,
+                                     const Slice& end) const {
+  const Comparator* user_cmp = input_version_->vset_->icmp_.user_comparator();
+  for (int lvl = level_ + 2; lvl < config::kNumLevels; lvl++) {
+    for (const FileMetaData* f : input_version_->files_[lvl]) {
+      if (user_cmp->Compare(f->largest.user_key(), begin) >= 0 &&
+          user_cmp->Compare(f->smallest.user_key(), end) < 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 bool Compaction::ShouldStopBefore(const Slice& internal_key) {
   const VersionSet* vset = input_version_->vset_;
   // Scan to find earliest grandparent file that contains key.
@@ -1554,6 +2067,11 @@ bool Compaction::ShouldStopBefore(const Slice& internal_key) {
 
 void Compaction::ReleaseInputs() {
   if (input_version_ != nullptr) {
+    // The input version keeps the input files alive, so clear their flags
+    // before dropping it.
+    if (owns_inputs_) {
+      MarkInputsBeingCompacted(false);
+    }
     input_version_->Unref();
     input_version_ = nullptr;
   }
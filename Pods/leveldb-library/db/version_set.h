@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "db/dbformat.h"
+#include "db/range_del.h"
 #include "db/version_edit.h"
 #include "port/port.h"
 #include "port/thread_annotations.h"
@@ -33,6 +34,7 @@ class Writer;
 class Compaction;
 class Iterator;
 class MemTable;
+class PinnableSlice;
 class TableBuilder;
 class TableCache;
 class Version;
@@ -68,13 +70,32 @@ class Version {
   };
 
   // Append to *iters a sequence of iterators that will
-  // yield the contents of this Version when merged together.
+  // yield the contents of this Version when merged together.  If
+  // "range_dels" is non-null, the range deletions of every file that the
+  // iterators open are added to it, which must outlive the iterators.
   // REQUIRES: This version has been saved (see VersionSet::SaveTo)
-  void AddIterators(const ReadOptions&, std::vector<Iterator*>* iters);
+  void AddIterators(const ReadOptions&, std::vector<Iterator*>* iters,
+                    RangeDelAggregator* range_dels = nullptr);
 
   Status Get(const ReadOptions&, const LookupKey& key, std::string* val,
              GetStats* stats);
 
+  // Like Get(), but pins the value in *val instead of copying it, where it
+  // is found in a table.
+  // REQUIRES: !val->IsPinned()
+  Status Get(const ReadOptions&, const LookupKey& key, PinnableSlice* val,
+             GetStats* stats);
+
+  // Like Get() for each of "keys", which must be sorted by user key and
+  // must not repeat a user key.  Stores the result for keys[i] in
+  // (*statuses)[i] and, if found, *vals[i].  Keys that fall in the same
+  // table are looked up together, and tables of the same level may be
+  // read in parallel (see Options::max_multiget_threads).
+  // REQUIRES: lock is not held
+  void MultiGet(const ReadOptions&, const std::vector<const LookupKey*>& keys,
+                const std::vector<std::string*>& vals,
+                std::vector<Status>* statuses, GetStats* stats);
+
   // Adds "stats" into the current state.  Returns true if a new
   // compaction may need to be triggered, false otherwise.
   // REQUIRES: lock is held
@@ -111,6 +132,11 @@ class Version {
 
   int NumFiles(int level) const { return (uint32_t)files_[level].size(); }
 
+  // The files of the specified level, in key order for levels above 0.
+  const std::vector<FileMetaData*>& files(int level) const {
+    return files_[level];
+  }
+
   // Return a human readable string that describes this version's contents.
   std::string DebugString() const;
 
@@ -133,9 +159,15 @@ class Version {
   Version(const Version&) = delete;
   Version& operator=(const Version&) = delete;
 
+  // Implements both Get()s: copies a found value into *value if it is
+  // non-null, and pins it in *pinned otherwise.
+  Status Get(const ReadOptions&, const LookupKey& key, std::string* value,
+             PinnableSlice* pinned, GetStats* stats);
+
   ~Version();
 
-  Iterator* NewConcatenatingIterator(const ReadOptions&, int level) const;
+  Iterator* NewConcatenatingIterator(const ReadOptions&, int level,
+                                     RangeDelAggregator* range_dels) const;
 
   // Call func(arg, level, f) for every file that overlaps user_key in
   // order from newest to oldest.  If an invocation of func returns
@@ -231,12 +263,19 @@ class VersionSet {
   // Returns nullptr if there is no compaction to be done.
   // Otherwise returns a pointer to a heap-allocated object that
   // describes the compaction.  Caller should delete the result.
+  //
+  // Files that are inputs of other running compactions are never picked,
+  // so several compactions returned by this method may run at the same
+  // time.  Level-0 compactions are never run in parallel with each other.
+  // The inputs of the result stay marked as being compacted until it is
+  // released (see Compaction::ReleaseInputs()) or deleted.
   Compaction* PickCompaction();
 
   // Return a compaction object for compacting the range [begin,end] in
   // the specified level.  Returns nullptr if there is nothing in that
   // level that overlaps the specified range.  Caller should delete
   // the result.
+  // REQUIRES: no other compaction is running.
   Compaction* CompactRange(int level, const InternalKey* begin,
                            const InternalKey* end);
 
@@ -248,6 +287,10 @@ class VersionSet {
   // The caller should delete the iterator when no longer needed.
   Iterator* MakeInputIterator(Compaction* c);
 
+  // Appends the range deletions of the input files of "*c" to *result.
+  Status GetCompactionRangeTombstones(Compaction* c,
+                                      std::vector<RangeTombstone>* result);
+
   // Returns true iff some level needs a compaction.
   bool NeedsCompaction() const {
     Version* v = current_;
@@ -288,6 +331,19 @@ class VersionSet {
 
   void SetupOtherInputs(Compaction* c);
 
+  // Try to build a size-triggered compaction for "level".  Returns nullptr
+  // if every candidate conflicts with a running compaction.
+  Compaction* PickSizeCompaction(int level);
+
+  // PickCompaction() for kTieredCompaction.  Returns nullptr if no run
+  // needs to be compacted, or if every one that does conflicts with a
+  // running compaction.
+  Compaction* PickTieredCompaction();
+
+  // Return nullptr and delete "c" if any of its inputs is already being
+  // compacted.  Otherwise mark its inputs as being compacted and return c.
+  Compaction* ClaimInputs(Compaction* c);
+
   // Save current contents to *log
   Status WriteSnapshot(log::Writer* log);
 
@@ -349,6 +405,9 @@ class Compaction {
   // in levels greater than "level+1".
   bool IsBaseLevelForKey(const Slice& user_key);
 
+  // Like IsBaseLevelForKey() for all user keys in ["begin", "end").
+  bool IsBaseLevelForRange(const Slice& begin, const Slice& end) const;
+
   // Returns true iff we should stop building the current output
   // before processing "internal_key".
   bool ShouldStopBefore(const Slice& internal_key);
@@ -357,12 +416,21 @@ class Compaction {
   // is successful.
   void ReleaseInputs();
 
+  // Return a new compaction over the same inputs as this one, but with its
+  // own copy of the per-key state used by IsBaseLevelForKey() and
+  // ShouldStopBefore().  Used to let several threads compact disjoint key
+  // ranges of this compaction.  Caller should delete the result, which
+  // does not mark or release the inputs.
+  Compaction* NewSubcompaction() const;
+
  private:
   friend class Version;
   friend class VersionSet;
 
   Compaction(const Options* options, int level);
 
+  void MarkInputsBeingCompacted(bool being_compacted);
+
   int level_;
   uint64_t max_output_file_size_;
   Version* input_version_;
@@ -386,6 +454,9 @@ class Compaction {
   // higher level than the ones involved in this compaction (i.e. for
   // all L >= level_ + 2).
   size_t level_ptrs_[config::kNumLevels];
+
+  // True iff this compaction marked its inputs as being compacted.
+  bool owns_inputs_;
 };
 
 }  // namespace leveldb
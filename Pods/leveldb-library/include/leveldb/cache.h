@@ -31,6 +31,40 @@ class LEVELDB_EXPORT Cache;
 // of Cache uses a least-recently-used eviction policy.
 LEVELDB_EXPORT Cache* NewLRUCache(size_t capacity);
 
+// Like NewLRUCache(capacity), but splits the cache into
+// 2^num_shard_bits independently locked shards instead of the default 16.
+// A negative num_shard_bits selects the default.
+LEVELDB_EXPORT Cache* NewLRUCache(size_t capacity, int num_shard_bits);
+
+// Like NewLRUCache(), but with a midpoint insertion policy that keeps scans
+// from flushing the entries that are hit repeatedly.  New entries are
+// inserted into a probationary segment and only move to the protected
+// segment when they are looked up again, so a scan that touches each block
+// once only evicts other probationary entries.  Entries are evicted from
+// the probationary segment first.  The protected segment is limited to
+// (1 - probation_ratio) of the capacity; its least recently used entries
+// are moved back to probation when it overflows.  A probation_ratio outside
+// (0, 1) selects the default of 3/8.
+LEVELDB_EXPORT Cache* NewScanResistantLRUCache(size_t capacity,
+                                               double probation_ratio = -1,
+                                               int num_shard_bits = -1);
+
+// Create a new cache with a fixed size capacity that uses a CLOCK
+// eviction policy.  Lookup() and Release() never take a lock: a hit costs
+// a single atomic update of the entry, so many threads can read from the
+// cache at once without contending on shard mutexes.  Insertions are still
+// serialized per shard.
+//
+// Each shard keeps its entries in a fixed-size table sized for
+// capacity / estimated_entry_charge entries, so estimated_entry_charge
+// should be close to the typical charge of an entry (e.g. block_size for
+// a block cache).  If a shard runs out of table slots, new entries are
+// returned to the caller without being cached.  A negative num_shard_bits
+// selects the default of 16 shards.
+LEVELDB_EXPORT Cache* NewClockCache(size_t capacity,
+                                    size_t estimated_entry_charge,
+                                    int num_shard_bits = -1);
+
 class LEVELDB_EXPORT Cache {
  public:
   Cache() = default;
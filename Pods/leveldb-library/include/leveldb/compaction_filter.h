@@ -0,0 +1,41 @@
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+//
+// A CompactionFilter lets the embedder drop entries it no longer needs
+// while compactions rewrite them, instead of deleting them with writes of
+// its own.  Entries that are dropped this way still read as present until
+// a compaction reaches them.
+
+#ifndef STORAGE_LEVELDB_INCLUDE_COMPACTION_FILTER_H_
+#define STORAGE_LEVELDB_INCLUDE_COMPACTION_FILTER_H_
+
+#include "leveldb/export.h"
+#include "leveldb/slice.h"
+
+namespace leveldb {
+
+class LEVELDB_EXPORT CompactionFilter {
+ public:
+  virtual ~CompactionFilter();
+
+  // Return the name of this filter, for the info log.
+  virtual const char* Name() const = 0;
+
+  // Return true if the entry for "key" with "value" should be dropped by a
+  // compaction into "level".
+  //
+  // Only the newest entry of a key is passed, and only if no snapshot sees
+  // it; snapshots taken after the compaction started are not checked.  A
+  // dropped entry reads as deleted: if older entries for the key may remain
+  // deeper in the tree, it is replaced by a deletion marker rather than
+  // removed.  Entries that are never compacted again are never passed.
+  //
+  // Called from the compaction threads without any lock held, possibly
+  // concurrently, so implementations must be thread-safe.
+  virtual bool Filter(int level, const Slice& key, const Slice& value) const = 0;
+};
+
+}  // namespace leveldb
+
+#endif  // STORAGE_LEVELDB_INCLUDE_COMPACTION_FILTER_H_
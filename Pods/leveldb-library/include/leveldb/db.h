@@ -7,10 +7,13 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <string>
+#include <vector>
 
 #include "leveldb/export.h"
 #include "leveldb/iterator.h"
 #include "leveldb/options.h"
+#include "leveldb/pinnable_slice.h"
 
 namespace leveldb {
 
@@ -72,6 +75,15 @@ class LEVELDB_EXPORT DB {
   // Note: consider setting options.sync = true.
   virtual Status Delete(const WriteOptions& options, const Slice& key) = 0;
 
+  // Remove the database entries (if any) for all keys in ["begin", "end").
+  // The deletion is a single record however many entries it removes; the
+  // entries themselves are dropped by later compactions.  Returns OK on
+  // success, and a non-OK status on error.
+  //
+  // The default implementation writes a batch with WriteBatch::DeleteRange().
+  virtual Status DeleteRange(const WriteOptions& options, const Slice& begin,
+                             const Slice& end);
+
   // Apply the specified updates to the database.
   // Returns OK on success, non-OK on failure.
   // Note: consider setting options.sync = true.
@@ -87,6 +99,28 @@ class LEVELDB_EXPORT DB {
   virtual Status Get(const ReadOptions& options, const Slice& key,
                      std::string* value) = 0;
 
+  // Like Get() above, but "value" points straight into the block that holds
+  // the entry rather than at a copy of it, where it can.  The block is kept
+  // in memory until *value is reset or destroyed (see PinnableSlice).  On
+  // error, *value is left empty.
+  //
+  // The default implementation copies the value into *value's own buffer.
+  virtual Status Get(const ReadOptions& options, const Slice& key,
+                     PinnableSlice* value);
+
+  // Look up all of "keys" at once, as if by calling Get() for each of them
+  // against the same snapshot.  Returns one status per key and sets
+  // (*values)[i] to the value of keys[i] if its status is OK.  *values is
+  // resized to keys.size(), and the values of missing keys are left empty.
+  //
+  // This is faster than a sequence of Get() calls, since keys that fall in
+  // the same table or data block share the work of reading it.
+  //
+  // The default implementation calls Get() for each key.
+  virtual std::vector<Status> MultiGet(const ReadOptions& options,
+                                       const std::vector<Slice>& keys,
+                                       std::vector<std::string>* values);
+
   // Return a heap-allocated iterator over the contents of the database.
   // The result of NewIterator() is initially invalid (caller must
   // call one of the Seek methods on the iterator before using it).
@@ -119,8 +153,19 @@ class LEVELDB_EXPORT DB {
   //     about the internal operation of the DB.
   //  "leveldb.sstables" - returns a multi-line string that describes all
   //     of the sstables that make up the db contents.
+  //  "leveldb.compression" - returns a multi-line string that describes the
+  //     configured compression, whether it is compiled in, and how much the
+  //     blocks written at each level since the DB was opened were compressed.
   //  "leveldb.approximate-memory-usage" - returns the approximate number of
   //     bytes of memory in use by the DB.
+  //  "leveldb.latency.<op>" - returns a histogram of the latencies, in
+  //     microseconds, of the <op> operations since the DB was opened, where
+  //     <op> is one of "get", "multiget", "write" or "seek".  Only valid if
+  //     Options::record_op_latencies is set.
+  //  "leveldb.latency" - returns the histograms of all operations.
+  //  "leveldb.allocation-stats" - returns the bytes held by memtable arenas
+  //     and block caches of all DBs in the process, now and at their peak.
+  //     Only counted if leveldb is built with LEVELDB_ALLOCATION_STATS.
   virtual bool GetProperty(const Slice& property, std::string* value) = 0;
 
   // For each i in [0,n-1], store in "sizes[i]", the approximate
@@ -145,6 +190,24 @@ class LEVELDB_EXPORT DB {
   // Therefore the following call will compact the entire database:
   //    db->CompactRange(nullptr, nullptr);
   virtual void CompactRange(const Slice* begin, const Slice* end) = 0;
+
+  // Add the table files named by "paths", which must have been built by
+  // SstFileWriter with this DB's comparator, to the DB.  The key ranges of
+  // the files must not overlap each other.  Their entries replace earlier
+  // values of the same keys, as if they had been written by a single
+  // Write(), but they are not written to the log or the memtable: each
+  // file is placed directly into the deepest level it can go to.
+  //
+  // Files whose keys do not overlap anything in the DB are used as they
+  // are when no snapshot is alive; otherwise they are rewritten with a
+  // new sequence number before being placed.  Writes are blocked while
+  // the files are placed.
+  //
+  // On failure the DB is unchanged and the files are left at "paths".
+  //
+  // The default implementation returns Status::NotSupported().
+  virtual Status IngestExternalFile(const IngestExternalFileOptions& options,
+                                    const std::vector<std::string>& paths);
 };
 
 // Destroy the contents of the specified database.
@@ -85,6 +85,15 @@ class LEVELDB_EXPORT Env {
   virtual Status NewRandomAccessFile(const std::string& fname,
                                      RandomAccessFile** result) = 0;
 
+  // Like NewRandomAccessFile(), except that reads of the returned file
+  // bypass the operating system's page cache where the platform supports it
+  // (O_DIRECT, or F_NOCACHE on Apple platforms).  Reading a large file once
+  // this way does not evict pages that other readers depend on.
+  //
+  // The default implementation calls NewRandomAccessFile().
+  virtual Status NewUncachedRandomAccessFile(const std::string& fname,
+                                             RandomAccessFile** result);
+
   // Create an object that writes to a new file with the specified
   // name.  Deletes any existing file with the same name and creates a
   // new file.  On success, stores a pointer to the new file in
@@ -197,6 +206,11 @@ class LEVELDB_EXPORT Env {
   // serialized.
   virtual void Schedule(void (*function)(void* arg), void* arg) = 0;
 
+  // Allow up to "number" functions passed to Schedule() to run at the same
+  // time.  Never lowers the current limit.  The default implementation
+  // ignores the request.
+  virtual void SetBackgroundThreads(int number);
+
   // Start a new thread, invoking "function(arg)" within the new thread.
   // When "function(arg)" returns, the thread will be destroyed.
   virtual void StartThread(void (*function)(void* arg), void* arg) = 0;
@@ -269,6 +283,33 @@ class LEVELDB_EXPORT RandomAccessFile {
   // Safe for concurrent use by multiple threads.
   virtual Status Read(uint64_t offset, size_t n, Slice* result,
                       char* scratch) const = 0;
+
+  // One of the reads of a MultiRead() call.
+  struct ReadRequest {
+    uint64_t offset;  // Like the arguments of Read()
+    size_t n;
+    char* scratch;
+
+    Slice result;  // Set by MultiRead() like the results of Read()
+    Status status;
+  };
+
+  // Performs each of reqs[0..num_reqs-1] as if by Read(), setting its
+  // result and status.  Implementations may keep several of the reads in
+  // flight at once, and return once all of them are done.
+  //
+  // The default implementation calls Read() for each request in turn.
+  //
+  // Safe for concurrent use by multiple threads.
+  virtual void MultiRead(ReadRequest* reqs, size_t num_reqs) const;
+
+  // How the file is expected to be read from now on.
+  enum AccessPattern { kNormal, kSequential, kRandom };
+
+  // Advise the operating system of the expected access pattern, e.g. so
+  // that it reads ahead for sequential files and not for random ones.  The
+  // default implementation does nothing.
+  virtual void Hint(AccessPattern pattern);
 };
 
 // A file abstraction for sequential writing.  The implementation
@@ -287,6 +328,14 @@ class LEVELDB_EXPORT WritableFile {
   virtual Status Close() = 0;
   virtual Status Flush() = 0;
   virtual Status Sync() = 0;
+
+  // Like Sync(), but only guarantees that the data reaches durable media
+  // before anything written after this call does, not that it has reached
+  // it when this returns.  A power failure may then lose the most recent
+  // data synced this way, but never keeps later writes without it.
+  //
+  // The default implementation calls Sync().
+  virtual Status SyncBarrier();
 };
 
 // An interface for writing log messages.
@@ -349,6 +398,10 @@ class LEVELDB_EXPORT EnvWrapper : public Env {
                              RandomAccessFile** r) override {
     return target_->NewRandomAccessFile(f, r);
   }
+  Status NewUncachedRandomAccessFile(const std::string& f,
+                                     RandomAccessFile** r) override {
+    return target_->NewUncachedRandomAccessFile(f, r);
+  }
   Status NewWritableFile(const std::string& f, WritableFile** r) override {
     return target_->NewWritableFile(f, r);
   }
@@ -384,6 +437,9 @@ class LEVELDB_EXPORT EnvWrapper : public Env {
   void Schedule(void (*f)(void*), void* a) override {
     return target_->Schedule(f, a);
   }
+  void SetBackgroundThreads(int number) override {
+    return target_->SetBackgroundThreads(number);
+  }
   void StartThread(void (*f)(void*), void* a) override {
     return target_->StartThread(f, a);
   }
@@ -49,6 +49,12 @@ class LEVELDB_EXPORT FilterPolicy {
   // This method may return true or false if the key was not on the
   // list, but it should aim to return false with a high probability.
   virtual bool KeyMayMatch(const Slice& key, const Slice& filter) const = 0;
+
+  // If true, each table stores a single filter built from all of its keys
+  // instead of one filter per 2KB of data blocks.  A lookup then probes
+  // that filter once before it reads the table's index, which pays off
+  // when many lookups are for keys that are not present.
+  virtual bool UseWholeTableFilter() const;
 };
 
 // Return a new filter policy that uses a bloom filter with approximately
@@ -67,6 +73,18 @@ class LEVELDB_EXPORT FilterPolicy {
 // trailing spaces in keys.
 LEVELDB_EXPORT const FilterPolicy* NewBloomFilterPolicy(int bits_per_key);
 
+// Return a new filter policy that builds one bloom filter per table and
+// confines all the probes for a key to a single 64-byte block of the
+// filter, so that checking a key touches about one cache line.  At the
+// same number of bits per key its false positive rate is slightly higher
+// than that of NewBloomFilterPolicy(); 10 bits per key gives about 1%.
+//
+// The same caveats about custom comparators as for NewBloomFilterPolicy()
+// apply.  Callers must delete the result after any database that is using
+// the result has been closed.
+LEVELDB_EXPORT const FilterPolicy* NewBlockedBloomFilterPolicy(
+    int bits_per_key);
+
 }  // namespace leveldb
 
 #endif  // STORAGE_LEVELDB_INCLUDE_FILTER_POLICY_H_
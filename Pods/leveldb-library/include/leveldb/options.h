@@ -12,10 +12,12 @@
 namespace leveldb {
 
 class Cache;
+class CompactionFilter;
 class Comparator;
 class Env;
 class FilterPolicy;
 class Logger;
+class RateLimiter;
 class Snapshot;
 
 // DB contents are stored in a set of blocks, each of which holds a
@@ -26,7 +28,47 @@ enum CompressionType {
   // NOTE: do not change the values of existing entries, as these are
   // part of the persistent format on disk.
   kNoCompression = 0x0,
-  kSnappyCompression = 0x1
+  kSnappyCompression = 0x1,
+  kZstdCompression = 0x2,
+  kLZ4Compression = 0x3
+};
+
+// The data structure a memtable keeps its entries in.
+enum MemTableRepType {
+  // A skiplist, which keeps the entries sorted as they are inserted.
+  kSkipListRep = 0,
+  // A hash table of small skiplists, one per hash bucket of user key
+  // prefixes.  Point lookups only search one bucket, but iterating over
+  // the memtable sorts a copy of all of its entries.
+  kHashSkipListRep = 1,
+  // An unsorted vector of the entries, sorted when the memtable is read or
+  // flushed.  Inserts are as cheap as possible, but every read that follows
+  // an insert sorts the whole vector again.
+  kVectorRep = 2
+};
+
+// How syncs of the log and the MANIFEST are made durable.
+enum SyncMode {
+  // WritableFile::Sync(): synced data survives a power failure.
+  kSyncFull = 0,
+  // WritableFile::SyncBarrier(): a power failure may lose the most recent
+  // synced writes, but the database still recovers to a consistent state
+  // that includes every write synced before them.
+  kSyncBarrier = 1
+};
+
+// How table compactions decide which files to merge.
+enum CompactionStyle {
+  // Each level above level-0 is kept about 10 times larger than the one
+  // before it, and files are merged into the next level a few at a time.
+  // Reads touch few files, but data is rewritten about 10 times per level.
+  kLeveledCompaction = 0,
+  // Each level above level-0 holds one sorted run, newer runs in lower
+  // levels.  Runs sink into empty levels without being rewritten, and a
+  // run is merged into the next one only once it has grown to at least
+  // half of its size.  Data is rewritten far less often than with
+  // kLeveledCompaction, but reads may have to look at every level.
+  kTieredCompaction = 1
 };
 
 // Options to control the behavior of a database (passed to DB::Open)
@@ -81,6 +123,40 @@ struct LEVELDB_EXPORT Options {
   // the next time the database is opened.
   size_t write_buffer_size = 4 * 1024 * 1024;
 
+  // The data structure used for memtables.  kHashSkipListRep suits
+  // workloads dominated by point lookups, and kVectorRep bulk loads
+  // whose keys are not read before they are flushed.  Only kSkipListRep
+  // inserts in parallel when allow_concurrent_memtable_write is set.
+  //
+  // Default: kSkipListRep
+  MemTableRepType memtable_rep = kSkipListRep;
+
+  // If non-zero and memtable_rep is kHashSkipListRep, user keys are hashed
+  // by their first memtable_prefix_length bytes only, so that keys that
+  // share a prefix land in the same bucket.  If zero, whole user keys are
+  // hashed.
+  //
+  // Default: 0
+  size_t memtable_prefix_length = 0;
+
+  // If non-zero, memtables allocate their memory in blocks of this many
+  // bytes, instead of 4KB, from a pool shared by the memtables of the DB.
+  // At most an eighth of write_buffer_size is used.
+  // The pool keeps the blocks of flushed memtables for the next ones.
+  // Allocating memtable memory in a few large blocks cuts the time spent in
+  // malloc and, with memtable_huge_pages, TLB misses while searching
+  // memtables.
+  //
+  // Default: 0
+  size_t memtable_arena_block_size = 0;
+
+  // If true and memtable_arena_block_size is a multiple of 2MB, memtable
+  // blocks are backed by huge pages where the OS supports that (transparent
+  // huge pages on Linux).  Ignored otherwise.
+  //
+  // Default: false
+  bool memtable_huge_pages = false;
+
   // Number of open files that can be used by the DB.  You may need to
   // increase this if your database has a large working set (budget
   // one open file per 2MB of working set).
@@ -114,6 +190,54 @@ struct LEVELDB_EXPORT Options {
   // initially populating a large database.
   size_t max_file_size = 2 * 1024 * 1024;
 
+  // How table compactions pick their inputs; see CompactionStyle.  A DB may
+  // be reopened with a different style.  The levels it finds are reshaped
+  // by the compactions of the new style over time.
+  //
+  // Default: kLeveledCompaction
+  CompactionStyle compaction_style = kLeveledCompaction;
+
+  // If non-zero, compactions read their input tables in chunks of this many
+  // bytes instead of one block at a time, through tables opened just for
+  // the compaction that bypass block_cache.  A few hundred KB works well
+  // for most storage; it mostly helps when reads have a high fixed cost.
+  //
+  // Default: 0
+  size_t compaction_readahead_size = 0;
+
+  // If true and compaction_readahead_size is non-zero, compaction input is
+  // read past the OS page cache where the platform supports it (O_DIRECT,
+  // or F_NOCACHE on Apple platforms), so long compactions do not evict the
+  // pages that foreground reads depend on.
+  //
+  // Default: false
+  bool use_direct_reads_for_compaction = false;
+
+  // If non-null, the table files written by memtable compactions (flushes)
+  // and table compactions are written no faster than the limiter allows,
+  // so that they leave I/O bandwidth to foreground reads.  See
+  // NewRateLimiter() in leveldb/rate_limiter.h.  The DB does not take
+  // ownership of the limiter.
+  //
+  // Default: nullptr
+  RateLimiter* rate_limiter = nullptr;
+
+  // If true, the OS is advised that table files opened for reads are
+  // accessed randomly, which turns off its readahead for them.  Tables read
+  // by compactions with compaction_readahead_size set are advised as
+  // sequential instead.
+  //
+  // Default: false
+  bool advise_random_on_open = false;
+
+  // If true, DB::Open() starts a thread that opens the table files of the
+  // DB, level-0 first, until the table cache (see max_open_files) is full,
+  // so that the first reads after opening do not each have to open their
+  // tables.  Reads that need a table the thread is opening wait for it.
+  //
+  // Default: false
+  bool preload_tables = false;
+
   // Compress blocks using the specified compression algorithm.  This
   // parameter can be changed dynamically.
   //
@@ -130,16 +254,187 @@ struct LEVELDB_EXPORT Options {
   // efficiently detect that and will switch to uncompressed mode.
   CompressionType compression = kSnappyCompression;
 
+  // Compression level for zstd.
+  // Currently only the range [-5,22] is supported.  Default is 1.
+  int zstd_compression_level = 1;
+
+  // If non-zero and compression is kZstdCompression, every new table gets
+  // its own zstd dictionary of up to this many bytes, stored in a meta
+  // block and used to compress its data blocks.  The dictionary is trained
+  // on the first data blocks of the table, which are buffered in memory
+  // (up to 100 times this size) until training is done.  Dictionaries help
+  // most when blocks are small and their values are similar, e.g. encoded
+  // protocol buffers of the same few types.
+  //
+  // Default: 0
+  size_t zstd_max_dict_bytes = 0;
+
   // EXPERIMENTAL: If true, append to existing MANIFEST and log files
   // when a database is opened.  This can significantly speed up open.
   //
   // Default: currently false, but may become true later.
   bool reuse_logs = false;
 
+  // If true, writers that DB::Write groups behind a single leader insert
+  // their own batches into the memtable in parallel once the leader has
+  // appended the whole group to the log.  The log append itself stays
+  // serialized.  This helps when many threads write at the same time and
+  // applying the group to the memtable dominates the cost of a write.
+  //
+  // Default: false
+  bool allow_concurrent_memtable_write = false;
+
+  // If true, DB::Write splits each write group into a log stage and a
+  // memtable stage, so the next group can append to the log while the
+  // previous one is still being applied to the memtable.  Sequence numbers
+  // still become visible to readers in log order.
+  //
+  // Default: false
+  bool enable_pipelined_write = false;
+
+  // If greater than zero, writes with WriteOptions::sync set do not sync
+  // the log themselves.  A background thread syncs it on behalf of all of
+  // them at once, at most this many microseconds after the oldest write
+  // started waiting, or sooner once log_sync_bytes have been appended
+  // since the previous sync.  A sync write still returns only after a sync
+  // that covers it, but while it waits other writes can append to the
+  // log, and readers may already see its updates.
+  //
+  // This trades up to log_sync_interval_micros of latency per sync write
+  // for far fewer syncs when many threads write with sync set.
+  //
+  // Default: 0
+  int log_sync_interval_micros = 0;
+
+  // If log_sync_interval_micros is set and at least this many bytes have
+  // been appended to the log since the previous sync, a waiting sync write
+  // gets its sync right away.  Zero means that only the interval counts.
+  //
+  // Default: 0
+  size_t log_sync_bytes = 0;
+
+  // How the log is synced for writes with WriteOptions::sync set, and how
+  // the MANIFEST is synced when it records a new version.  On Apple
+  // platforms a full sync flushes the whole drive cache and may take tens
+  // of milliseconds, while kSyncBarrier only orders writes.  Elsewhere the
+  // two are the same.
+  //
+  // Table files, and the MANIFEST written when the DB is opened, are
+  // always synced fully, so that they act as checkpoints.
+  //
+  // Default: kSyncFull
+  SyncMode sync_mode = kSyncFull;
+
+  // Maximum number of compactions that may run at the same time on
+  // background threads.  Compactions that run together never share input
+  // files, and at most one of them compacts level-0.
+  //
+  // Default: 1
+  int max_background_compactions = 1;
+
+  // If greater than one, a single compaction is split by key range into up
+  // to this many subcompactions that run on separate threads.  This mostly
+  // shortens large level-0 to level-1 compactions, which otherwise stall
+  // writes for their whole duration.
+  //
+  // Default: 1
+  int max_subcompactions = 1;
+
+  // If greater than one, DB::MultiGet() looks up keys that fall in
+  // different table files of the same level on up to this many threads.
+  // This pays off when the tables have to be read from storage; lookups
+  // that are served from block_cache are faster on a single thread.
+  //
+  // Default: 1
+  int max_multiget_threads = 1;
+
+  // If true, DB::Open() keeps the updates it recovers from the logs in a
+  // memtable that is written to a level-0 table in the background, instead
+  // of writing the table before it returns.  The logs are kept until then.
+  // Tables are still written during recovery if the logs hold more than
+  // write_buffer_size of updates.
+  //
+  // Default: false
+  bool defer_recovery_flush = false;
+
+  // If true, deleting the DB writes the memtables to level-0 tables, so
+  // that the next DB::Open() has no log to replay.  Closing takes longer,
+  // and processes that are killed instead of closing the DB still replay
+  // their logs.
+  //
+  // Default: false
+  bool flush_on_close = false;
+
   // If non-null, use the specified filter policy to reduce disk reads.
   // Many applications will benefit from passing the result of
   // NewBloomFilterPolicy() here.
   const FilterPolicy* filter_policy = nullptr;
+
+  // If non-null, compactions ask it whether to drop each entry they
+  // rewrite.  See leveldb/compaction_filter.h.
+  const CompactionFilter* compaction_filter = nullptr;
+
+  // If true, the index and filter blocks of open tables are stored in
+  // block_cache and charged against its capacity, instead of being held
+  // on the heap for as long as the table stays open.  This bounds the
+  // memory used by tables when max_open_files is large, at the cost of
+  // re-reading those blocks after they are evicted.
+  //
+  // Default: false
+  bool cache_index_and_filter_blocks = false;
+
+  // If true and cache_index_and_filter_blocks is set, the index and filter
+  // blocks of level-0 tables stay pinned in block_cache while the table is
+  // open.  Every read checks each level-0 table, so evicting their index
+  // and filter blocks is rarely worthwhile.
+  //
+  // Default: false
+  bool pin_l0_filter_and_index_blocks_in_cache = false;
+
+  // If true, new tables split their index, and their filter if a
+  // filter_policy is set, into partitions of about metadata_block_size
+  // bytes.  Only a small top-level index is held per open table; a lookup
+  // loads just the partitions it needs through block_cache.  Tables
+  // written with this option cannot be read by older versions of leveldb.
+  //
+  // Default: false
+  bool partition_index_and_filters = false;
+
+  // Approximate size of an index partition when partition_index_and_filters
+  // is set.  This parameter can be changed dynamically.
+  size_t metadata_block_size = 4 * 1024;
+
+  // If true, each new data block ends with a small hash index from user
+  // keys to restart points, at a cost of about 1.33 bytes per key.  A
+  // point lookup (DB::Get) then finds its restart run through the hash
+  // index instead of binary searching the block.  Blocks with more than
+  // 254 restart points are written without one.  Tables written with this
+  // option cannot be read by older versions of leveldb.
+  //
+  // Default: false
+  bool data_block_hash_index = false;
+
+  // Format version of new tables.  Version 0 tables can be read by any
+  // version of leveldb.  Version 1 tables store the keys of data blocks
+  // more compactly: the 8-byte sequence number and type of a key is varint
+  // encoded, and keys at restart points are delta encoded against the first
+  // key of their block instead of being stored in full.  This pays off for
+  // keys with long shared prefixes, such as ones built from hierarchical
+  // paths.  Tables written with version 1 cannot be read by older versions
+  // of leveldb.  Only tables written by a DB, whose keys all carry a
+  // sequence number and type, may use version 1.
+  //
+  // Default: 0
+  int format_version = 0;
+
+  // If true, the DB keeps latency histograms of Get(), MultiGet(), Write()
+  // and iterator seeks, readable through DB::GetProperty().  Recording reads
+  // the clock twice per operation and takes a lock shared by all threads.
+  // See also leveldb/perf_context.h for a per-thread breakdown of where
+  // the time of individual operations goes.
+  //
+  // Default: false
+  bool record_op_latencies = false;
 };
 
 // Options that control read operations
@@ -154,6 +449,15 @@ struct LEVELDB_EXPORT ReadOptions {
   // Callers may wish to set this field to false for bulk scans.
   bool fill_cache = true;
 
+  // If non-zero, an iterator that has moved forward from one data block of
+  // a table into the next a few times in a row reads the next this many
+  // blocks of the table together, ahead of when they are needed.  Scans
+  // then wait for storage once per batch instead of once per block.  The
+  // blocks read ahead are held by the iterator until it reaches them.
+  //
+  // Default: 0
+  int readahead_blocks = 0;
+
   // If "snapshot" is non-null, read as of the supplied snapshot
   // (which must belong to the DB that is being read and which must
   // not have been released).  If "snapshot" is null, use an implicit
@@ -182,6 +486,17 @@ struct LEVELDB_EXPORT WriteOptions {
   bool sync = false;
 };
 
+// Options that control DB::IngestExternalFile()
+struct LEVELDB_EXPORT IngestExternalFileOptions {
+  IngestExternalFileOptions() = default;
+
+  // If true, the files are renamed into the DB directory instead of being
+  // copied, and are gone from their original paths when the call succeeds.
+  // Files that cannot be renamed, e.g. because they are on another file
+  // system, are copied.
+  bool move_files = false;
+};
+
 }  // namespace leveldb
 
 #endif  // STORAGE_LEVELDB_INCLUDE_OPTIONS_H_
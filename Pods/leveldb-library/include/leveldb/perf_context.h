@@ -0,0 +1,91 @@
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+//
+// A PerfContext breaks down where the time of the DB operations run by
+// one thread goes.  Each thread has its own PerfContext, which only
+// collects data while the thread's perf level is above kDisable:
+//
+//   leveldb::SetPerfLevel(leveldb::kEnableTime);
+//   leveldb::GetPerfContext()->Reset();
+//   db->Get(leveldb::ReadOptions(), key, &value);
+//   std::string breakdown = leveldb::GetPerfContext()->ToString();
+//   leveldb::SetPerfLevel(leveldb::kDisable);
+//
+// Work done on behalf of the thread by other threads, such as compactions
+// or the lookups of DB::MultiGet() that run on extra threads, is not
+// counted.
+
+#ifndef STORAGE_LEVELDB_INCLUDE_PERF_CONTEXT_H_
+#define STORAGE_LEVELDB_INCLUDE_PERF_CONTEXT_H_
+
+#include <cstdint>
+#include <string>
+
+#include "leveldb/export.h"
+
+namespace leveldb {
+
+enum PerfLevel {
+  // Collect nothing.  This is the default.
+  kDisable = 0,
+  // Only update the counts.
+  kEnableCount = 1,
+  // Update the counts and time the work.  This reads a clock twice per
+  // timed step.
+  kEnableTime = 2
+};
+
+struct LEVELDB_EXPORT PerfContext {
+  // Set all counters to zero.
+  void Reset();
+
+  // Return the non-zero counters, one "name = value" pair per line.
+  std::string ToString() const;
+
+  uint64_t get_count = 0;       // Calls to DB::Get() and keys of MultiGet()
+  uint64_t get_nanos = 0;       // Total time of DB::Get() and MultiGet()
+  uint64_t memtable_get_nanos = 0;  // Looking keys up in the memtables
+
+  uint64_t table_open_count = 0;  // Tables opened on table cache misses
+  uint64_t table_open_nanos = 0;  // Including their index and filter blocks
+
+  uint64_t block_cache_hit_count = 0;  // Blocks found in the block cache
+  uint64_t block_read_count = 0;       // Blocks read from table files
+  uint64_t block_read_bytes = 0;
+  uint64_t block_read_nanos = 0;      // Time spent in RandomAccessFile::Read()
+  uint64_t block_checksum_nanos = 0;  // Verifying block checksums
+  uint64_t decompress_nanos = 0;      // Uncompressing blocks
+
+  uint64_t filter_check_count = 0;   // Bloom filter probes
+  uint64_t filter_useful_count = 0;  // Probes that avoided a block read
+  uint64_t filter_check_nanos = 0;
+
+  uint64_t write_count = 0;           // Calls to DB::Write()
+  uint64_t write_nanos = 0;           // Total time of DB::Write()
+  uint64_t write_delay_nanos = 0;     // Waiting for room in the memtable
+  uint64_t wal_write_nanos = 0;       // Appending to the log
+  uint64_t wal_sync_nanos = 0;        // Syncing the log
+  uint64_t memtable_insert_nanos = 0;  // Applying batches to the memtable
+
+  uint64_t iter_seek_count = 0;  // Seek(), SeekToFirst() and SeekToLast()
+  uint64_t iter_seek_nanos = 0;
+  uint64_t iter_next_count = 0;  // Next() and Prev()
+  uint64_t iter_next_nanos = 0;
+  uint64_t internal_key_skipped_count = 0;  // Hidden or overwritten entries
+  uint64_t internal_delete_skipped_count = 0;  // Deletion markers skipped
+};
+
+// Set the perf level of the calling thread.
+LEVELDB_EXPORT void SetPerfLevel(PerfLevel level);
+
+// Return the perf level of the calling thread.
+LEVELDB_EXPORT PerfLevel GetPerfLevel();
+
+// Return the PerfContext of the calling thread.  The result belongs to
+// leveldb and lives as long as the thread.
+LEVELDB_EXPORT PerfContext* GetPerfContext();
+
+}  // namespace leveldb
+
+#endif  // STORAGE_LEVELDB_INCLUDE_PERF_CONTEXT_H_
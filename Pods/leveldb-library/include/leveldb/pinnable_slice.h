@@ -0,0 +1,88 @@
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+//
+// A PinnableSlice holds a value read with DB::Get() without copying it
+// where it can: the slice points straight into the block in the block cache
+// that holds the value, and keeps that block alive until the slice is
+// Reset() or destroyed.  Values that cannot be pinned, such as those in a
+// memtable, are copied into a buffer of the slice's own.
+//
+//   leveldb::PinnableSlice value;
+//   leveldb::Status s = db->Get(leveldb::ReadOptions(), key, &value);
+//   if (s.ok()) Parse(value.data(), value.size());
+//
+// A pinned slice must be reset or destroyed before the DB is deleted.
+//
+// Like a Slice, a PinnableSlice is not safe to change from multiple threads
+// without external synchronization.
+
+#ifndef STORAGE_LEVELDB_INCLUDE_PINNABLE_SLICE_H_
+#define STORAGE_LEVELDB_INCLUDE_PINNABLE_SLICE_H_
+
+#include <string>
+
+#include "leveldb/export.h"
+#include "leveldb/slice.h"
+
+namespace leveldb {
+
+class LEVELDB_EXPORT PinnableSlice : public Slice {
+ public:
+  PinnableSlice();
+
+  PinnableSlice(const PinnableSlice&) = delete;
+  PinnableSlice& operator=(const PinnableSlice&) = delete;
+
+  ~PinnableSlice();
+
+  // Points the slice at "s", whose memory is kept valid by the cleanup
+  // functions that are registered for it.
+  // REQUIRES: !IsPinned()
+  void PinSlice(const Slice& s);
+
+  // Copies "s" into the slice's own buffer and points the slice at it.
+  void PinSelf(const Slice& s);
+
+  // Points the slice at its own buffer, as filled through GetSelf().
+  void PinSelf();
+
+  // The slice's own buffer, for callers that fill it in place before
+  // calling PinSelf().
+  std::string* GetSelf() { return &buf_; }
+
+  // Returns true if the slice points at memory that it does not own.
+  bool IsPinned() const { return pinned_; }
+
+  // Releases the memory the slice points at and empties it.
+  void Reset();
+
+  // Arranges for (*function)(arg1, arg2) to be called when the pinned
+  // memory is released.
+  // REQUIRES: IsPinned()
+  using CleanupFunction = void (*)(void* arg1, void* arg2);
+  void RegisterCleanup(CleanupFunction function, void* arg1, void* arg2);
+
+ private:
+  // Cleanup functions are stored in a single-linked list, as they are by
+  // Iterator.  The list's head node is inlined in the slice.
+  struct CleanupNode {
+    // True if the node is not used. Only head nodes might be unused.
+    bool IsEmpty() const { return function == nullptr; }
+
+    CleanupFunction function;
+    void* arg1;
+    void* arg2;
+    CleanupNode* next;
+  };
+
+  void RunCleanups();
+
+  std::string buf_;
+  bool pinned_;
+  CleanupNode cleanup_head_;
+};
+
+}  // namespace leveldb
+
+#endif  // STORAGE_LEVELDB_INCLUDE_PINNABLE_SLICE_H_
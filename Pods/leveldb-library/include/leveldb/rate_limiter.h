@@ -0,0 +1,65 @@
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+//
+// A RateLimiter caps the rate at which the background work of a DB writes
+// table files, so that flushes and compactions do not starve foreground
+// reads of I/O bandwidth.  Flushes (memtable compactions) and table
+// compactions have separate budgets:
+//
+//   options.rate_limiter = leveldb::NewRateLimiter(
+//       8 << 20 /* flush bytes/s */, 4 << 20 /* compaction bytes/s */,
+//       true /* auto-tune */);
+//
+// A RateLimiter may be shared by several DBs, whose background writes then
+// share the budgets.
+
+#ifndef STORAGE_LEVELDB_INCLUDE_RATE_LIMITER_H_
+#define STORAGE_LEVELDB_INCLUDE_RATE_LIMITER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "leveldb/export.h"
+
+namespace leveldb {
+
+class LEVELDB_EXPORT RateLimiter {
+ public:
+  // The kind of background write a request is made for.
+  enum IOType { kFlush = 0, kCompaction = 1 };
+
+  RateLimiter() = default;
+
+  RateLimiter(const RateLimiter&) = delete;
+  RateLimiter& operator=(const RateLimiter&) = delete;
+
+  virtual ~RateLimiter();
+
+  // Block until "bytes" may be written for "type".  Requests larger than
+  // the budget of a second are let through, and later requests wait until
+  // the budget has caught up.
+  virtual void Request(size_t bytes, IOType type) = 0;
+
+  // Called by the DB with the number of level-0 files divided by the
+  // number at which writes are slowed down.  Limiters that tune themselves
+  // raise their budgets as this grows, so that the background work keeps
+  // up before writes have to be delayed.  The default does nothing.
+  virtual void SetLevel0Pressure(double pressure);
+};
+
+// Return a token bucket limiter that lets through up to
+// flush_bytes_per_second of flush output and compaction_bytes_per_second of
+// compaction output.  A budget of zero or less is unlimited.
+//
+// If auto_tune is true, both budgets grow linearly with the level-0
+// pressure reported by the DB, up to eight times their base when it
+// reaches one.  Once level-0 has more files than that, the limits are
+// lifted until it recovers.
+LEVELDB_EXPORT RateLimiter* NewRateLimiter(int64_t flush_bytes_per_second,
+                                           int64_t compaction_bytes_per_second,
+                                           bool auto_tune);
+
+}  // namespace leveldb
+
+#endif  // STORAGE_LEVELDB_INCLUDE_RATE_LIMITER_H_
@@ -0,0 +1,74 @@
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+//
+// SstFileWriter builds a table file outside of any DB, which can then be
+// added to a DB with DB::IngestExternalFile().  This is much faster than
+// writing the same keys through DB::Write(), since the entries skip the
+// log, the memtable and the compactions that would move them down the
+// levels:
+//
+//   leveldb::SstFileWriter writer(options);
+//   leveldb::Status s = writer.Open("/tmp/bulk.ldb");
+//   for (...) s = writer.Put(key, value);  // In increasing key order
+//   if (s.ok()) s = writer.Finish();
+//   if (s.ok()) s = db->IngestExternalFile(IngestExternalFileOptions(),
+//                                          {"/tmp/bulk.ldb"});
+//
+// Multiple threads can invoke const methods on an SstFileWriter without
+// external synchronization, but if any of the threads may call a
+// non-const method, all threads accessing the same SstFileWriter must use
+// external synchronization.
+
+#ifndef STORAGE_LEVELDB_INCLUDE_SST_FILE_WRITER_H_
+#define STORAGE_LEVELDB_INCLUDE_SST_FILE_WRITER_H_
+
+#include <cstdint>
+#include <string>
+
+#include "leveldb/export.h"
+#include "leveldb/options.h"
+#include "leveldb/slice.h"
+#include "leveldb/status.h"
+
+namespace leveldb {
+
+class LEVELDB_EXPORT SstFileWriter {
+ public:
+  // "options" must use the same comparator and filter policy as the DB
+  // the file will be ingested into.  Its block, compression and filter
+  // settings are used for the file.
+  explicit SstFileWriter(const Options& options);
+
+  SstFileWriter(const SstFileWriter&) = delete;
+  SstFileWriter& operator=(const SstFileWriter&) = delete;
+
+  // Deletes the file if it was opened but not finished.
+  ~SstFileWriter();
+
+  // Create the file named "fname", replacing any existing file.
+  Status Open(const std::string& fname);
+
+  // Add an entry to the file.
+  // REQUIRES: Open() succeeded, Finish() has not been called
+  // REQUIRES: key is after any previously added key according to the
+  // comparator.
+  Status Put(const Slice& key, const Slice& value);
+
+  // Write the rest of the file, sync and close it.  If file_size is
+  // non-null, stores the size of the file in *file_size.  A file without
+  // entries cannot be ingested, so Finish() fails if none were added.
+  // REQUIRES: Open() succeeded, Finish() has not been called
+  Status Finish(uint64_t* file_size = nullptr);
+
+  // Number of entries added so far.
+  uint64_t NumEntries() const;
+
+ private:
+  struct Rep;
+  Rep* rep_;
+};
+
+}  // namespace leveldb
+
+#endif  // STORAGE_LEVELDB_INCLUDE_SST_FILE_WRITER_H_
@@ -5,17 +5,21 @@
 #ifndef STORAGE_LEVELDB_INCLUDE_TABLE_H_
 #define STORAGE_LEVELDB_INCLUDE_TABLE_H_
 
+#include <cstddef>
 #include <cstdint>
 
+#include "leveldb/cache.h"
 #include "leveldb/export.h"
 #include "leveldb/iterator.h"
 
 namespace leveldb {
 
 class Block;
+struct BlockContents;
 class BlockHandle;
 class Footer;
 struct Options;
+class PinnableSlice;
 class RandomAccessFile;
 struct ReadOptions;
 class TableCache;
@@ -64,17 +68,95 @@ class LEVELDB_EXPORT Table {
 
   static Iterator* BlockReader(void*, const ReadOptions&, const Slice&);
 
+  // Like BlockReader() for each of index_values[0..n-1], reading the blocks
+  // together with ReadDataBlocks().
+  static void BatchBlockReader(void*, const ReadOptions&,
+                               const Slice* index_values, int n,
+                               Iterator** iters);
+
+  // Like BlockReader(), for index blocks and index partitions.
+  static Iterator* IndexBlockReader(void*, const ReadOptions&, const Slice&);
+
+  // Like BlockReader().  If point_lookup, the returned iterator must only
+  // be used for the Seek()s done by InternalGet() and InternalMultiGet().
+  // data_block is false for index blocks, whose keys are always encoded
+  // plainly.
+  static Iterator* ReadBlockIterator(Table* table, const ReadOptions&,
+                                     const Slice& index_value,
+                                     bool point_lookup, bool data_block);
+
+  // Like the public Open(), but is also given the level of the table so that
+  // the index and filter blocks of level-0 tables can be pinned in the
+  // block cache.  "level" is -1 if it is not known.
+  static Status Open(const Options& options, RandomAccessFile* file,
+                     uint64_t file_size, int level, Table** table);
+
   explicit Table(Rep* rep) : rep_(rep) {}
 
+  // Fetches the "n" data blocks described by handles[0..n-1], reading the
+  // ones that are not in the block cache from the file together.  Sets
+  // blocks[i] to the block, or to null if it could not be read, and
+  // cache_handles[i] to its cache handle, or to null if the caller owns
+  // the block.  Blocks must be given back with ReleaseDataBlock().  Returns
+  // the status of the first block that could not be read.
+  Status ReadDataBlocks(const ReadOptions&, const BlockHandle* handles,
+                        size_t n, Block** blocks,
+                        Cache::Handle** cache_handles) const;
+  void ReleaseDataBlock(Block* block, Cache::Handle* cache_handle) const;
+
+  // Returns an iterator over the range deletion block of the table, in the
+  // format of db/range_del.h, or null if the table has none.
+  Iterator* NewRangeDeletionIterator() const;
+
+  // Returns an iterator over the index entries of all data blocks.
+  Iterator* NewIndexIterator(const ReadOptions&) const;
+
+  // Returns false if the table's whole-table filter says that "key" is not
+  // in the table.
+  bool FullFilterMayMatch(const ReadOptions&, const Slice& key) const;
+
+  // Returns false if the filter block says that "key" is not in the data
+  // block at "block_offset".
+  bool KeyMayMatch(const ReadOptions&, uint64_t block_offset,
+                   const Slice& key) const;
+
+  // Returns false if the filter of the index partition described by the
+  // top-level index entry "partition_value" says that "key" is not there.
+  bool PartitionKeyMayMatch(const ReadOptions&, const Slice& partition_value,
+                            const Slice& key) const;
+
+  // Reads filter data through the block cache.  The caller must pass the
+  // results to ReleaseFilterContents() once it is done with them.
+  Status ReadFilterContents(const ReadOptions&, const BlockHandle& handle,
+                            BlockContents* contents,
+                            Cache::Handle** cache_handle) const;
+  void ReleaseFilterContents(const BlockContents& contents,
+                             Cache::Handle* cache_handle) const;
+
   // Calls (*handle_result)(arg, ...) with the entry found after a call
   // to Seek(key).  May not make such a call if filter policy says
   // that key is not present.
+  //
+  // If "pinned" is non-null and (*handle_result) pins it to the value it is
+  // passed, the block holding the value is kept until *pinned is released.
+  // REQUIRES: pinned == nullptr || !pinned->IsPinned()
   Status InternalGet(const ReadOptions&, const Slice& key, void* arg,
                      void (*handle_result)(void* arg, const Slice& k,
-                                           const Slice& v));
-
-  void ReadMeta(const Footer& footer);
-  void ReadFilter(const Slice& filter_handle_value);
+                                           const Slice& v),
+                     PinnableSlice* pinned = nullptr);
+
+  // Like InternalGet() for each of the "n" keys, which must be in
+  // increasing order, passing args[i] to the calls made for keys[i].  Keys
+  // that fall in the same data block share a single read of it, and the
+  // blocks needed by different keys are read with ReadDataBlocks().
+  Status InternalMultiGet(const ReadOptions&, const Slice* keys, int n,
+                          void* const* args,
+                          void (*handle_result)(void* arg, const Slice& k,
+                                                const Slice& v));
+
+  Status ReadMeta(const Footer& footer, bool use_cache, bool pin);
+  void ReadFilter(const Slice& filter_handle_value, bool full, bool use_cache,
+                  bool pin);
 
   Rep* const rep_;
 };
@@ -51,6 +51,11 @@ class LEVELDB_EXPORT TableBuilder {
   // REQUIRES: Finish(), Abandon() have not been called
   void Add(const Slice& key, const Slice& value);
 
+  // Add an entry to the range deletion block of the table, which is kept
+  // apart from the data blocks.  Unlike Add(), may be called in any order.
+  // REQUIRES: Finish(), Abandon() have not been called
+  void AddRangeDeletion(const Slice& key, const Slice& value);
+
   // Advanced operation: flush any buffered key/value pairs to file.
   // Can be used to ensure that two adjacent entries never live in
   // the same data block.  Most clients should not need to use this method.
@@ -75,14 +80,32 @@ class LEVELDB_EXPORT TableBuilder {
   // Number of calls to Add() so far.
   uint64_t NumEntries() const;
 
+  // Number of calls to AddRangeDeletion() so far.
+  uint64_t NumRangeDeletions() const;
+
   // Size of the file generated so far.  If invoked after a successful
   // Finish() call, returns the size of the final generated file.
   uint64_t FileSize() const;
 
+  // Number of data and index blocks written so far, and how many of them
+  // were stored compressed.  Blocks that did not shrink by at least 12.5%,
+  // or that could not be compressed because the configured compression is
+  // not compiled in, are stored uncompressed.
+  uint64_t NumBlocks() const;
+  uint64_t NumCompressedBlocks() const;
+
+  // Total size of those blocks before and after compression.
+  uint64_t RawBlockBytes() const;
+  uint64_t StoredBlockBytes() const;
+
  private:
   bool ok() const { return status().ok(); }
   void WriteBlock(BlockBuilder* block, BlockHandle* handle);
   void WriteRawBlock(const Slice& data, CompressionType, BlockHandle* handle);
+  void FlushIndexPartition();
+  void BufferForDictionary(const Slice& key, const Slice& value);
+  void AddDictionarySample();
+  void FinishDictionary();
 
   struct Rep;
   Rep* rep_;
@@ -51,6 +51,11 @@ class CondVar {
   // REQUIRES: this thread holds *mu
   void Wait();
 
+  // Like Wait(), but also returns after about "micros" microseconds if
+  // the condition variable was not signalled.  May return earlier.
+  // REQUIRES: this thread holds *mu
+  void TimedWait(uint64_t micros);
+
   // If there are some threads waiting, wake up at least one of them.
   void Signal();
 
@@ -81,6 +86,45 @@ bool Snappy_GetUncompressedLength(const char* input, size_t length,
 bool Snappy_Uncompress(const char* input_data, size_t input_length,
                        char* output);
 
+// Store the zstd compression of "input[0,input_length-1]" at the given
+// level in *output, using dict[0,dict_length-1] as the dictionary if
+// dict_length > 0.  Returns false if zstd is not supported by this port.
+bool Zstd_Compress(int level, const char* dict, size_t dict_length,
+                   const char* input, size_t input_length,
+                   std::string* output);
+
+// If input[0,input_length-1] looks like a valid zstd compressed
+// buffer, store the size of the uncompressed data in *result and
+// return true.  Else return false.
+bool Zstd_GetUncompressedLength(const char* input, size_t length,
+                                size_t* result);
+
+// Attempt to zstd uncompress input[0,input_length-1] into *output, using
+// the dictionary it was compressed with.  Returns true if successful.
+//
+// REQUIRES: at least the first "n" bytes of output[] must be writable
+// where "n" is the result of a successful call to
+// Zstd_GetUncompressedLength.
+bool Zstd_Uncompress(const char* dict, size_t dict_length,
+                     const char* input_data, size_t input_length,
+                     char* output);
+
+// Train a zstd dictionary of at most max_dict_bytes on the concatenation of
+// samples whose sizes are given by sample_sizes, and store it in *dict.
+// Returns false if zstd is not supported or training failed.
+bool Zstd_TrainDictionary(const std::string& samples,
+                          const std::vector<size_t>& sample_sizes,
+                          size_t max_dict_bytes, std::string* dict);
+
+// Like the Snappy_ functions above, for LZ4.  The compressed form starts
+// with the uncompressed length as a fixed 32-bit value.
+bool Lz4_Compress(const char* input, size_t input_length,
+                  std::string* output);
+bool Lz4_GetUncompressedLength(const char* input, size_t length,
+                               size_t* result);
+bool Lz4_Uncompress(const char* input_data, size_t input_length,
+                    char* output);
+
 // ------------------ Miscellaneous -------------------
 
 // If heap profiling is not supported, returns false.
@@ -24,17 +24,31 @@
 
 #if HAVE_CRC32C
 #include <crc32c/crc32c.h>
+#elif HAVE_ABSL_CRC32C
+#include "absl/crc/crc32c.h"
+#include "absl/strings/string_view.h"
 #endif  // HAVE_CRC32C
 #if HAVE_SNAPPY
 #include <snappy.h>
+#elif HAVE_BUNDLED_SNAPPY
+#include "util/snappy_codec.h"
 #endif  // HAVE_SNAPPY
+#if HAVE_ZSTD
+#include <zdict.h>
+#include <zstd.h>
+#endif  // HAVE_ZSTD
+#if HAVE_LZ4
+#include <lz4.h>
+#endif  // HAVE_LZ4
 
 #include <cassert>
+#include <chrono>  // NOLINT
 #include <condition_variable>  // NOLINT
 #include <cstddef>
 #include <cstdint>
 #include <mutex>  // NOLINT
 #include <string>
+#include <vector>
 
 #include "port/thread_annotations.h"
 
@@ -75,6 +89,11 @@ class CondVar {
     cv_.wait(lock);
     lock.release();
   }
+  void TimedWait(uint64_t micros) {
+    std::unique_lock<std::mutex> lock(mu_->mu_, std::adopt_lock);
+    cv_.wait_for(lock, std::chrono::microseconds(micros));
+    lock.release();
+  }
   void Signal() { cv_.notify_one(); }
   void SignalAll() { cv_.notify_all(); }
 
@@ -91,6 +110,8 @@ inline bool Snappy_Compress(const char* input, size_t length,
   snappy::RawCompress(input, length, &(*output)[0], &outlen);
   output->resize(outlen);
   return true;
+#elif HAVE_BUNDLED_SNAPPY
+  return snappy_codec::Compress(input, length, output);
 #else
   // Silence compiler warnings about unused arguments.
   (void)input;
@@ -105,6 +126,8 @@ inline bool Snappy_GetUncompressedLength(const char* input, size_t length,
                                          size_t* result) {
 #if HAVE_SNAPPY
   return snappy::GetUncompressedLength(input, length, result);
+#elif HAVE_BUNDLED_SNAPPY
+  return snappy_codec::GetUncompressedLength(input, length, result);
 #else
   // Silence compiler warnings about unused arguments.
   (void)input;
@@ -117,6 +140,8 @@ inline bool Snappy_GetUncompressedLength(const char* input, size_t length,
 inline bool Snappy_Uncompress(const char* input, size_t length, char* output) {
 #if HAVE_SNAPPY
   return snappy::RawUncompress(input, length, output);
+#elif HAVE_BUNDLED_SNAPPY
+  return snappy_codec::Uncompress(input, length, output);
 #else
   // Silence compiler warnings about unused arguments.
   (void)input;
@@ -126,6 +151,179 @@ inline bool Snappy_Uncompress(const char* input, size_t length, char* output) {
 #endif  // HAVE_SNAPPY
 }
 
+inline bool Zstd_Compress(int level, const char* dict, size_t dict_length,
+                          const char* input, size_t length,
+                          std::string* output) {
+#if HAVE_ZSTD
+  // Get the MaxCompressedLength.
+  size_t outlen = ZSTD_compressBound(length);
+  if (ZSTD_isError(outlen)) {
+    return false;
+  }
+  output->resize(outlen);
+  ZSTD_CCtx* ctx = ZSTD_createCCtx();
+  if (dict_length > 0) {
+    outlen = ZSTD_compress_usingDict(ctx, &(*output)[0], output->size(), input,
+                                     length, dict, dict_length, level);
+  } else {
+    outlen = ZSTD_compressCCtx(ctx, &(*output)[0], output->size(), input,
+                               length, level);
+  }
+  ZSTD_freeCCtx(ctx);
+  if (ZSTD_isError(outlen)) {
+    return false;
+  }
+  output->resize(outlen);
+  return true;
+#else
+  // Silence compiler warnings about unused arguments.
+  (void)level;
+  (void)dict;
+  (void)dict_length;
+  (void)input;
+  (void)length;
+  (void)output;
+  return false;
+#endif  // HAVE_ZSTD
+}
+
+inline bool Zstd_GetUncompressedLength(const char* input, size_t length,
+                                       size_t* result) {
+#if HAVE_ZSTD
+  unsigned long long size = ZSTD_getFrameContentSize(input, length);
+  if (size == ZSTD_CONTENTSIZE_UNKNOWN || size == ZSTD_CONTENTSIZE_ERROR) {
+    return false;
+  }
+  *result = static_cast<size_t>(size);
+  return true;
+#else
+  // Silence compiler warnings about unused arguments.
+  (void)input;
+  (void)length;
+  (void)result;
+  return false;
+#endif  // HAVE_ZSTD
+}
+
+// "dict" must be the dictionary the input was compressed with, if any.
+inline bool Zstd_Uncompress(const char* dict, size_t dict_length,
+                            const char* input, size_t length, char* output) {
+#if HAVE_ZSTD
+  size_t outlen;
+  if (!Zstd_GetUncompressedLength(input, length, &outlen)) {
+    return false;
+  }
+  ZSTD_DCtx* ctx = ZSTD_createDCtx();
+  const size_t result =
+      ZSTD_decompress_usingDict(ctx, output, outlen, input, length, dict,
+                                dict_length);
+  ZSTD_freeDCtx(ctx);
+  return !ZSTD_isError(result) && result == outlen;
+#else
+  // Silence compiler warnings about unused arguments.
+  (void)dict;
+  (void)dict_length;
+  (void)input;
+  (void)length;
+  (void)output;
+  return false;
+#endif  // HAVE_ZSTD
+}
+
+// Trains a zstd dictionary of at most max_dict_bytes on the concatenated
+// "samples", whose sizes are listed in "sample_sizes".
+inline bool Zstd_TrainDictionary(const std::string& samples,
+                                 const std::vector<size_t>& sample_sizes,
+                                 size_t max_dict_bytes, std::string* dict) {
+#if HAVE_ZSTD
+  dict->resize(max_dict_bytes);
+  const size_t dict_length = ZDICT_trainFromBuffer(
+      &(*dict)[0], dict->size(), samples.data(), sample_sizes.data(),
+      static_cast<unsigned>(sample_sizes.size()));
+  if (ZDICT_isError(dict_length)) {
+    dict->clear();
+    return false;
+  }
+  dict->resize(dict_length);
+  return true;
+#else
+  // Silence compiler warnings about unused arguments.
+  (void)samples;
+  (void)sample_sizes;
+  (void)max_dict_bytes;
+  (void)dict;
+  return false;
+#endif  // HAVE_ZSTD
+}
+
+// LZ4 blocks do not record their uncompressed length, so Lz4_Compress()
+// prepends it as a fixed 32-bit little-endian value.
+inline bool Lz4_Compress(const char* input, size_t length,
+                         std::string* output) {
+#if HAVE_LZ4
+  if (length > static_cast<size_t>(LZ4_MAX_INPUT_SIZE)) {
+    return false;
+  }
+  const int bound = LZ4_compressBound(static_cast<int>(length));
+  output->resize(4 + bound);
+  for (int i = 0; i < 4; i++) {
+    (*output)[i] = static_cast<char>((length >> (8 * i)) & 0xff);
+  }
+  const int outlen = LZ4_compress_default(input, &(*output)[4],
+                                          static_cast<int>(length), bound);
+  if (outlen <= 0) {
+    return false;
+  }
+  output->resize(4 + outlen);
+  return true;
+#else
+  // Silence compiler warnings about unused arguments.
+  (void)input;
+  (void)length;
+  (void)output;
+  return false;
+#endif  // HAVE_LZ4
+}
+
+inline bool Lz4_GetUncompressedLength(const char* input, size_t length,
+                                      size_t* result) {
+#if HAVE_LZ4
+  if (length < 4) {
+    return false;
+  }
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(input);
+  *result = static_cast<size_t>(p[0]) | (static_cast<size_t>(p[1]) << 8) |
+            (static_cast<size_t>(p[2]) << 16) |
+            (static_cast<size_t>(p[3]) << 24);
+  return *result <= static_cast<size_t>(LZ4_MAX_INPUT_SIZE);
+#else
+  // Silence compiler warnings about unused arguments.
+  (void)input;
+  (void)length;
+  (void)result;
+  return false;
+#endif  // HAVE_LZ4
+}
+
+inline bool Lz4_Uncompress(const char* input, size_t length, char* output) {
+#if HAVE_LZ4
+  size_t outlen;
+  if (!Lz4_GetUncompressedLength(input, length, &outlen)) {
+    return false;
+  }
+  const int result =
+      LZ4_decompress_safe(input + 4, output, static_cast<int>(length - 4),
+                          static_cast<int>(outlen));
+  return result >= 0 && static_cast<size_t>(result) == outlen;
+#else
+  // Silence compiler warnings about unused arguments.
+  (void)input;
+  (void)length;
+  (void)output;
+  return false;
+#endif  // HAVE_LZ4
+}
+
 inline bool GetHeapProfile(void (*func)(void*, const char*, int), void* arg) {
   // Silence compiler warnings about unused arguments.
   (void)func;
@@ -136,6 +334,11 @@ inline bool GetHeapProfile(void (*func)(void*, const char*, int), void* arg) {
 inline uint32_t AcceleratedCRC32C(uint32_t crc, const char* buf, size_t size) {
 #if HAVE_CRC32C
   return ::crc32c::Extend(crc, reinterpret_cast<const uint8_t*>(buf), size);
+#elif HAVE_ABSL_CRC32C
+  // Uses the ARMv8 CRC32 / SSE4.2 instructions when the CPU has them, and
+  // abseil's table-driven code otherwise.
+  return static_cast<uint32_t>(
+      absl::ExtendCrc32c(absl::crc32c_t{crc}, absl::string_view(buf, size)));
 #else
   // Silence compiler warnings about unused arguments.
   (void)crc;
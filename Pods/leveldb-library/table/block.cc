@@ -13,29 +13,52 @@
 #include "leveldb/comparator.h"
 #include "table/format.h"
 #include "util/coding.h"
+#include "util/hash.h"
 #include "util/logging.h"
 
 namespace leveldb {
 
-inline uint32_t Block::NumRestarts() const {
-  assert(size_ >= sizeof(uint32_t));
-  return DecodeFixed32(data_ + size_ - sizeof(uint32_t));
-}
-
-Block::Block(const BlockContents& contents)
+Block::Block(const BlockContents& contents, BlockKeyEncoding encoding)
     : data_(contents.data.data()),
       size_(contents.data.size()),
+      num_restarts_(0),
+      hash_buckets_(nullptr),
+      num_hash_buckets_(0),
+      encoding_(encoding),
       owned_(contents.heap_allocated) {
   if (size_ < sizeof(uint32_t)) {
     size_ = 0;  // Error marker
-  } else {
-    size_t max_restarts_allowed = (size_ - sizeof(uint32_t)) / sizeof(uint32_t);
-    if (NumRestarts() > max_restarts_allowed) {
-      // The size is too small for NumRestarts()
+    return;
+  }
+
+  // "end" is the offset just past the restart array.
+  size_t end = size_ - sizeof(uint32_t);
+  num_restarts_ = DecodeFixed32(data_ + end);
+  if ((num_restarts_ & kBlockHashIndexFlag) != 0) {
+    num_restarts_ &= ~kBlockHashIndexFlag;
+    if (end < sizeof(uint16_t)) {
       size_ = 0;
-    } else {
-      restart_offset_ = (uint32_t)size_ - (1 + NumRestarts()) * sizeof(uint32_t);
+      return;
+    }
+    end -= sizeof(uint16_t);
+    num_hash_buckets_ = static_cast<uint8_t>(data_[end]) |
+                        (static_cast<uint8_t>(data_[end + 1]) << 8);
+    if (num_hash_buckets_ == 0 || end < num_hash_buckets_ ||
+        num_restarts_ > kBlockHashMaxRestarts) {
+      size_ = 0;
+      return;
     }
+    end -= num_hash_buckets_;
+    hash_buckets_ = reinterpret_cast<const uint8_t*>(data_ + end);
+  }
+
+  size_t max_restarts_allowed = end / sizeof(uint32_t);
+  if (num_restarts_ > max_restarts_allowed) {
+    // The size is too small for num_restarts_
+    size_ = 0;
+  } else {
+    restart_offset_ = static_cast<uint32_t>(end) -
+                      num_restarts_ * static_cast<uint32_t>(sizeof(uint32_t));
   }
 }
 
@@ -74,6 +97,23 @@ static inline const char* DecodeEntry(const char* p, const char* limit,
   return p;
 }
 
+// Like DecodeEntry(), for the tagged key encoding: also stores the tag
+// that follows the three lengths in "*tag".
+static inline const char* DecodeTaggedEntry(const char* p, const char* limit,
+                                            uint32_t* shared,
+                                            uint32_t* non_shared,
+                                            uint32_t* value_length,
+                                            uint64_t* tag) {
+  if ((p = GetVarint32Ptr(p, limit, shared)) == nullptr) return nullptr;
+  if ((p = GetVarint32Ptr(p, limit, non_shared)) == nullptr) return nullptr;
+  if ((p = GetVarint32Ptr(p, limit, value_length)) == nullptr) return nullptr;
+  if ((p = GetVarint64Ptr(p, limit, tag)) == nullptr) return nullptr;
+  if (static_cast<uint32_t>(limit - p) < (*non_shared + *value_length)) {
+    return nullptr;
+  }
+  return p;
+}
+
 class Block::Iter : public Iterator {
  private:
   const Comparator* const comparator_;
@@ -81,6 +121,16 @@ class Block::Iter : public Iterator {
   uint32_t const restarts_;      // Offset of restart array (list of fixed32)
   uint32_t const num_restarts_;  // Number of uint32_t entries in restart array
 
+  // Hash index used by Seek() for point lookups, if any.
+  const uint8_t* const hash_buckets_;
+  uint32_t const num_hash_buckets_;
+
+  // For the tagged key encoding, restart keys are delta encoded against
+  // the user key of the first entry, which is kept in first_user_key_.
+  BlockKeyEncoding const encoding_;
+  std::string first_user_key_;
+  std::string restart_key_;  // Scratch space for RestartKey()
+
   // current_ is offset in data_ of current entry.  >= restarts_ if !Valid
   uint32_t current_;
   uint32_t restart_index_;  // Index of restart block in which current_ falls
@@ -112,16 +162,53 @@ class Block::Iter : public Iterator {
     value_ = Slice(data_ + offset, 0);
   }
 
+  // Decode the key of the entry at restart point "index" into "*key".
+  // Returns false if the entry is corrupt.
+  bool RestartKey(uint32_t index, Slice* key) {
+    const char* p = data_ + GetRestartPoint(index);
+    const char* limit = data_ + restarts_;
+    uint32_t shared, non_shared, value_length;
+    if (encoding_ == kPlainKeys) {
+      p = DecodeEntry(p, limit, &shared, &non_shared, &value_length);
+      if (p == nullptr || shared != 0) return false;
+      *key = Slice(p, non_shared);
+      return true;
+    }
+    uint64_t tag;
+    p = DecodeTaggedEntry(p, limit, &shared, &non_shared, &value_length, &tag);
+    if (p == nullptr || shared > first_user_key_.size()) return false;
+    restart_key_.assign(first_user_key_.data(), shared);
+    restart_key_.append(p, non_shared);
+    PutFixed64(&restart_key_, tag);
+    *key = restart_key_;
+    return true;
+  }
+
  public:
   Iter(const Comparator* comparator, const char* data, uint32_t restarts,
-       uint32_t num_restarts)
+       uint32_t num_restarts, const uint8_t* hash_buckets,
+       uint32_t num_hash_buckets, BlockKeyEncoding encoding)
       : comparator_(comparator),
         data_(data),
         restarts_(restarts),
         num_restarts_(num_restarts),
+        hash_buckets_(hash_buckets),
+        num_hash_buckets_(num_hash_buckets),
+        encoding_(encoding),
         current_(restarts_),
         restart_index_(num_restarts_) {
     assert(num_restarts_ > 0);
+    if (encoding_ == kTaggedKeys && restarts_ > 0) {
+      uint32_t shared, non_shared, value_length;
+      uint64_t tag;
+      const char* p = DecodeTaggedEntry(data_, data_ + restarts_, &shared,
+                                        &non_shared, &value_length, &tag);
+      if (p == nullptr || shared != 0) {
+        CorruptionError();
+      } else {
+        first_user_key_.assign(p, non_shared);
+      }
+    }
   }
 
   bool Valid() const override { return current_ < restarts_; }
@@ -162,22 +249,36 @@ class Block::Iter : public Iterator {
   }
 
   void Seek(const Slice& target) override {
+    if (hash_buckets_ != nullptr && target.size() >= 8) {
+      const uint32_t h = Hash(target.data(), target.size() - 8, kBlockHashSeed);
+      const uint8_t bucket = hash_buckets_[h % num_hash_buckets_];
+      if (bucket == kBlockHashNoEntry) {
+        // The user key is not in this block.
+        current_ = restarts_;
+        restart_index_ = num_restarts_;
+        return;
+      }
+      if (bucket != kBlockHashCollision && bucket < num_restarts_) {
+        // All entries for the user key are in this restart run, so the
+        // first entry >= target is in it or is the first one after it.
+        SeekToRestartPoint(bucket);
+        while (ParseNextKey() && Compare(key_, target) < 0) {
+        }
+        return;
+      }
+    }
+
     // Binary search in restart array to find the last restart point
     // with a key < target
     uint32_t left = 0;
     uint32_t right = num_restarts_ - 1;
     while (left < right) {
       uint32_t mid = (left + right + 1) / 2;
-      uint32_t region_offset = GetRestartPoint(mid);
-      uint32_t shared, non_shared, value_length;
-      const char* key_ptr =
-          DecodeEntry(data_ + region_offset, data_ + restarts_, &shared,
-                      &non_shared, &value_length);
-      if (key_ptr == nullptr || (shared != 0)) {
+      Slice mid_key;
+      if (!RestartKey(mid, &mid_key)) {
         CorruptionError();
         return;
       }
-      Slice mid_key(key_ptr, non_shared);
       if (Compare(mid_key, target) < 0) {
         // Key at "mid" is smaller than "target".  Therefore all
         // blocks before "mid" are uninteresting.
@@ -233,6 +334,10 @@ class Block::Iter : public Iterator {
       return false;
     }
 
+    if (encoding_ == kTaggedKeys) {
+      return ParseNextTaggedKey(p, limit);
+    }
+
     // Decode next entry
     uint32_t shared, non_shared, value_length;
     p = DecodeEntry(p, limit, &shared, &non_shared, &value_length);
@@ -250,17 +355,68 @@ class Block::Iter : public Iterator {
       return true;
     }
   }
+
+  // ParseNextKey() for the tagged key encoding.  "p" points at the entry
+  // at current_.
+  bool ParseNextTaggedKey(const char* p, const char* limit) {
+    uint32_t shared, non_shared, value_length;
+    uint64_t tag;
+    p = DecodeTaggedEntry(p, limit, &shared, &non_shared, &value_length, &tag);
+    if (p == nullptr) {
+      CorruptionError();
+      return false;
+    }
+    while (restart_index_ + 1 < num_restarts_ &&
+           GetRestartPoint(restart_index_ + 1) < current_) {
+      ++restart_index_;
+    }
+    const bool at_restart =
+        GetRestartPoint(restart_index_) == current_ ||
+        (restart_index_ + 1 < num_restarts_ &&
+         GetRestartPoint(restart_index_ + 1) == current_);
+    if (at_restart) {
+      // Shares a prefix with the first key of the block.
+      if (shared > first_user_key_.size()) {
+        CorruptionError();
+        return false;
+      }
+      key_.assign(first_user_key_.data(), shared);
+    } else {
+      // Shares a prefix with the user key of the previous entry.
+      if (key_.size() < 8 || shared > key_.size() - 8) {
+        CorruptionError();
+        return false;
+      }
+      key_.resize(shared);
+    }
+    key_.append(p, non_shared);
+    PutFixed64(&key_, tag);
+    value_ = Slice(p + non_shared, value_length);
+    return true;
+  }
 };
 
 Iterator* Block::NewIterator(const Comparator* comparator) {
   if (size_ < sizeof(uint32_t)) {
     return NewErrorIterator(Status::Corruption("bad block contents"));
   }
-  const uint32_t num_restarts = NumRestarts();
-  if (num_restarts == 0) {
+  if (num_restarts_ == 0) {
+    return NewEmptyIterator();
+  } else {
+    return new Iter(comparator, data_, restart_offset_, num_restarts_, nullptr,
+                    0, encoding_);
+  }
+}
+
+Iterator* Block::NewPointLookupIterator(const Comparator* comparator) {
+  if (size_ < sizeof(uint32_t)) {
+    return NewErrorIterator(Status::Corruption("bad block contents"));
+  }
+  if (num_restarts_ == 0) {
     return NewEmptyIterator();
   } else {
-    return new Iter(comparator, data_, restart_offset_, num_restarts);
+    return new Iter(comparator, data_, restart_offset_, num_restarts_,
+                    hash_buckets_, num_hash_buckets_, encoding_);
   }
 }
 
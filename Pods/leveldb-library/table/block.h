@@ -15,10 +15,18 @@ namespace leveldb {
 struct BlockContents;
 class Comparator;
 
+// How the entries of a block encode their keys; see block_builder.cc.
+enum BlockKeyEncoding {
+  kPlainKeys = 0,
+  // Data blocks of tables with format version 1.
+  kTaggedKeys = 1
+};
+
 class Block {
  public:
   // Initialize the block with the specified contents.
-  explicit Block(const BlockContents& contents);
+  explicit Block(const BlockContents& contents,
+                 BlockKeyEncoding encoding = kPlainKeys);
 
   Block(const Block&) = delete;
   Block& operator=(const Block&) = delete;
@@ -28,15 +36,23 @@ class Block {
   size_t size() const { return size_; }
   Iterator* NewIterator(const Comparator* comparator);
 
+  // Returns an iterator meant for a single Seek() to an internal key
+  // during a point lookup.  If the block has a hash index, the Seek()
+  // uses it to go straight to the restart run holding the key's user key,
+  // and leaves the iterator invalid if the user key is not in the block.
+  Iterator* NewPointLookupIterator(const Comparator* comparator);
+
  private:
   class Iter;
 
-  uint32_t NumRestarts() const;
-
   const char* data_;
   size_t size_;
   uint32_t restart_offset_;  // Offset in data_ of restart array
-  bool owned_;               // Block owns data_[]
+  uint32_t num_restarts_;
+  const uint8_t* hash_buckets_;  // Hash index buckets; null if none
+  uint32_t num_hash_buckets_;
+  BlockKeyEncoding encoding_;
+  bool owned_;  // Block owns data_[]
 };
 
 }  // namespace leveldb
@@ -21,6 +21,21 @@
 //     value: char[value_length]
 // shared_bytes == 0 for restart points.
 //
+// Data blocks of tables with format version 1 use the "tagged" key
+// encoding instead.  Their keys are internal keys, and only the user key
+// part is delta encoded; the trailing 8-byte sequence number and type
+// ("tag") is stored as a varint64:
+//     shared_bytes: varint32
+//     unshared_bytes: varint32
+//     value_length: varint32
+//     tag: varint64
+//     user_key_delta: char[unshared_bytes]
+//     value: char[value_length]
+// At restart points other than the first, shared_bytes counts bytes shared
+// with the user key of the first entry of the block rather than being 0.
+// Keys in a block usually share a long prefix, which restart keys would
+// otherwise repeat in full.
+//
 // The trailer of the block has the form:
 //     restarts: uint32[num_restarts]
 //     num_restarts: uint32
@@ -33,12 +48,18 @@
 
 #include "leveldb/comparator.h"
 #include "leveldb/options.h"
+#include "table/format.h"
 #include "util/coding.h"
+#include "util/hash.h"
 
 namespace leveldb {
 
 BlockBuilder::BlockBuilder(const Options* options)
-    : options_(options), restarts_(), counter_(0), finished_(false) {
+    : options_(options),
+      restarts_(),
+      counter_(0),
+      finished_(false),
+      hash_index_valid_(true) {
   assert(options->block_restart_interval >= 1);
   restarts_.push_back(0);  // First restart point is at offset 0
 }
@@ -50,12 +71,24 @@ void BlockBuilder::Reset() {
   counter_ = 0;
   finished_ = false;
   last_key_.clear();
+  first_user_key_.clear();
+  hashes_.clear();
+  hash_restarts_.clear();
+  hash_index_valid_ = true;
 }
 
+// Each user key gets about 1.33 buckets.
+static size_t NumHashBuckets(size_t num_keys) { return num_keys * 4 / 3 + 1; }
+
 size_t BlockBuilder::CurrentSizeEstimate() const {
-  return (buffer_.size() +                       // Raw data buffer
-          restarts_.size() * sizeof(uint32_t) +  // Restart array
-          sizeof(uint32_t));                     // Restart array length
+  size_t estimate = (buffer_.size() +                       // Raw data buffer
+                     restarts_.size() * sizeof(uint32_t) +  // Restart array
+                     sizeof(uint32_t));                     // Restart count
+  if (!hashes_.empty()) {
+    // Hash buckets and their count
+    estimate += NumHashBuckets(hashes_.size()) + sizeof(uint16_t);
+  }
+  return estimate;
 }
 
 Slice BlockBuilder::Finish() {
@@ -63,45 +96,117 @@ Slice BlockBuilder::Finish() {
   for (size_t i = 0; i < restarts_.size(); i++) {
     PutFixed32(&buffer_, restarts_[i]);
   }
-  PutFixed32(&buffer_, (uint32_t)restarts_.size());
+  if (hash_index_valid_ && !hashes_.empty() &&
+      restarts_.size() <= kBlockHashMaxRestarts &&
+      NumHashBuckets(hashes_.size()) <= UINT16_MAX) {
+    AppendHashIndex();
+    PutFixed32(&buffer_, (uint32_t)restarts_.size() | kBlockHashIndexFlag);
+  } else {
+    PutFixed32(&buffer_, (uint32_t)restarts_.size());
+  }
   finished_ = true;
   return Slice(buffer_);
 }
 
+void BlockBuilder::AppendHashIndex() {
+  const size_t num_buckets = NumHashBuckets(hashes_.size());
+  std::vector<uint8_t> buckets(num_buckets, kBlockHashNoEntry);
+  for (size_t i = 0; i < hashes_.size(); i++) {
+    uint8_t& bucket = buckets[hashes_[i] % num_buckets];
+    const uint8_t restart = static_cast<uint8_t>(hash_restarts_[i]);
+    if (bucket == kBlockHashNoEntry) {
+      bucket = restart;
+    } else if (bucket != restart) {
+      // Also covers a user key whose entries span several restart runs.
+      bucket = kBlockHashCollision;
+    }
+  }
+  buffer_.append(reinterpret_cast<const char*>(buckets.data()), num_buckets);
+  const uint16_t encoded_buckets = static_cast<uint16_t>(num_buckets);
+  buffer_.push_back(static_cast<char>(encoded_buckets & 0xff));
+  buffer_.push_back(static_cast<char>(encoded_buckets >> 8));
+}
+
 void BlockBuilder::Add(const Slice& key, const Slice& value) {
   Slice last_key_piece(last_key_);
   assert(!finished_);
   assert(counter_ <= options_->block_restart_interval);
   assert(buffer_.empty()  // No values yet?
          || options_->comparator->Compare(key, last_key_piece) > 0);
-  uint32_t shared = 0;
-  if (counter_ < options_->block_restart_interval) {
-    // See how much sharing to do with previous string
-    const size_t min_length = std::min(last_key_piece.size(), key.size());
-    while ((shared < min_length) && (last_key_piece[shared] == key[shared])) {
-      shared++;
+  if (options_->format_version >= 1) {
+    AddTagged(key, value);
+  } else {
+    uint32_t shared = 0;
+    if (counter_ < options_->block_restart_interval) {
+      // See how much sharing to do with previous string
+      const size_t min_length = std::min(last_key_piece.size(), key.size());
+      while ((shared < min_length) && (last_key_piece[shared] == key[shared])) {
+        shared++;
+      }
+    } else {
+      // Restart compression
+      restarts_.push_back((uint32_t)buffer_.size());
+      counter_ = 0;
     }
+    const size_t non_shared = key.size() - shared;
+
+    // Add "<shared><non_shared><value_size>" to buffer_
+    PutVarint32(&buffer_, shared);
+    PutVarint32(&buffer_, (uint32_t)non_shared);
+    PutVarint32(&buffer_, (uint32_t)value.size());
+
+    // Add string delta to buffer_ followed by value
+    buffer_.append(key.data() + shared, non_shared);
+    buffer_.append(value.data(), value.size());
+
+    // Update state
+    last_key_.resize(shared);
+    last_key_.append(key.data() + shared, non_shared);
+    assert(Slice(last_key_) == key);
+  }
+  counter_++;
+
+  if (options_->data_block_hash_index && hash_index_valid_) {
+    // Keys of tables written by a DB are internal keys: the user key
+    // followed by an 8-byte sequence number and type.
+    if (key.size() < 8) {
+      hash_index_valid_ = false;
+    } else {
+      hashes_.push_back(Hash(key.data(), key.size() - 8, kBlockHashSeed));
+      hash_restarts_.push_back(static_cast<uint32_t>(restarts_.size() - 1));
+    }
+  }
+}
+
+void BlockBuilder::AddTagged(const Slice& key, const Slice& value) {
+  assert(key.size() >= 8);
+  const Slice user_key(key.data(), key.size() - 8);
+  Slice base;
+  if (buffer_.empty()) {
+    first_user_key_.assign(user_key.data(), user_key.size());
+  } else if (counter_ < options_->block_restart_interval) {
+    base = Slice(last_key_.data(), last_key_.size() - 8);
   } else {
-    // Restart compression
     restarts_.push_back((uint32_t)buffer_.size());
     counter_ = 0;
+    base = first_user_key_;
   }
-  const size_t non_shared = key.size() - shared;
 
-  // Add "<shared><non_shared><value_size>" to buffer_
+  uint32_t shared = 0;
+  const size_t min_length = std::min(base.size(), user_key.size());
+  while ((shared < min_length) && (base[shared] == user_key[shared])) {
+    shared++;
+  }
+  const size_t non_shared = user_key.size() - shared;
+
   PutVarint32(&buffer_, shared);
   PutVarint32(&buffer_, (uint32_t)non_shared);
   PutVarint32(&buffer_, (uint32_t)value.size());
-
-  // Add string delta to buffer_ followed by value
-  buffer_.append(key.data() + shared, non_shared);
+  PutVarint64(&buffer_, DecodeFixed64(user_key.data() + user_key.size()));
+  buffer_.append(user_key.data() + shared, non_shared);
   buffer_.append(value.data(), value.size());
 
-  // Update state
-  last_key_.resize(shared);
-  last_key_.append(key.data() + shared, non_shared);
-  assert(Slice(last_key_) == key);
-  counter_++;
+  last_key_.assign(key.data(), key.size());
 }
 
 }  // namespace leveldb
@@ -41,12 +41,25 @@ class BlockBuilder {
   bool empty() const { return buffer_.empty(); }
 
  private:
+  void AppendHashIndex();
+
+  // Add() for blocks that use the tagged key encoding.
+  void AddTagged(const Slice& key, const Slice& value);
+
   const Options* options_;
   std::string buffer_;              // Destination buffer
   std::vector<uint32_t> restarts_;  // Restart points
   int counter_;                     // Number of entries emitted since restart
   bool finished_;                   // Has Finish() been called?
   std::string last_key_;
+  std::string first_user_key_;  // Only kept for the tagged key encoding
+
+  // Hash of the user key and restart index of every entry added, if
+  // options_->data_block_hash_index is set.  A hash index is only
+  // appended if every key is long enough to be an internal key.
+  std::vector<uint32_t> hashes_;
+  std::vector<uint32_t> hash_restarts_;
+  bool hash_index_valid_;
 };
 
 }  // namespace leveldb
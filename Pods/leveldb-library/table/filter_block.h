@@ -49,6 +49,33 @@ class FilterBlockBuilder {
   std::vector<uint32_t> filter_offsets_;
 };
 
+// A FullFilterBlockBuilder builds one filter over every key added since
+// the previous call to Finish().  Tables with partitioned filters use it
+// to build the filter for all the keys of a single index partition.
+//
+// The sequence of calls to FullFilterBlockBuilder must match the regexp:
+//      (AddKey* Finish)*
+class FullFilterBlockBuilder {
+ public:
+  explicit FullFilterBlockBuilder(const FilterPolicy*);
+
+  FullFilterBlockBuilder(const FullFilterBlockBuilder&) = delete;
+  FullFilterBlockBuilder& operator=(const FullFilterBlockBuilder&) = delete;
+
+  void AddKey(const Slice& key);
+
+  // Returns the filter for the keys added since the previous call.  The
+  // returned slice remains valid until the next call to Finish().
+  Slice Finish();
+
+ private:
+  const FilterPolicy* policy_;
+  std::string keys_;             // Flattened key contents
+  std::vector<size_t> start_;    // Starting index in keys_ of each key
+  std::string result_;           // Filter data built by the last Finish()
+  std::vector<Slice> tmp_keys_;  // policy_->CreateFilter() argument
+};
+
 class FilterBlockReader {
  public:
   // REQUIRES: "contents" and *policy must stay live while *this is live.
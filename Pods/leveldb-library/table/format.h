@@ -62,12 +62,19 @@ class Footer {
   const BlockHandle& index_handle() const { return index_handle_; }
   void set_index_handle(const BlockHandle& h) { index_handle_ = h; }
 
+  // The table format version (see kLatestTableFormatVersion).  It is
+  // recorded through the magic number, so that older versions of leveldb
+  // reject newer tables instead of misreading them.
+  uint32_t format_version() const { return format_version_; }
+  void set_format_version(uint32_t v) { format_version_ = v; }
+
   void EncodeTo(std::string* dst) const;
   Status DecodeFrom(Slice* input);
 
  private:
   BlockHandle metaindex_handle_;
   BlockHandle index_handle_;
+  uint32_t format_version_ = 0;
 };
 
 // kTableMagicNumber was picked by running
@@ -75,9 +82,29 @@ class Footer {
 // and taking the leading 64 bits.
 static const uint64_t kTableMagicNumber = 0xdb4775248b80fb57ull;
 
+// Magic number of tables with format version 1, whose data blocks use the
+// tagged key encoding described in block_builder.cc.  Tables with the
+// original format have version 0 and kTableMagicNumber.
+static const uint64_t kTableMagicNumberV1 = 0x3f0c9a6be5d17a42ull;
+static const uint32_t kLatestTableFormatVersion = 1;
+
 // 1-byte type + 32-bit crc
 static const size_t kBlockTrailerSize = 5;
 
+// A block may end with a hash index that maps the hash of each user key
+// in the block to the restart run holding all of its entries:
+//    restarts: uint32[num_restarts]
+//    buckets: uint8[num_buckets]
+//    num_buckets: uint16
+//    num_restarts | kBlockHashIndexFlag: uint32
+// A bucket holds a restart index, kBlockHashNoEntry if no key hashes to
+// it, or kBlockHashCollision if keys in more than one run do.
+static const uint32_t kBlockHashIndexFlag = 1u << 31;
+static const uint8_t kBlockHashNoEntry = 255;
+static const uint8_t kBlockHashCollision = 254;
+static const uint32_t kBlockHashMaxRestarts = 254;
+static const uint32_t kBlockHashSeed = 0x4f1b2d73;
+
 struct BlockContents {
   Slice data;           // Actual contents of data
   bool cachable;        // True iff data can be cached
@@ -85,9 +112,19 @@ struct BlockContents {
 };
 
 // Read the block identified by "handle" from "file".  On failure
-// return non-OK.  On success fill *result and return OK.
+// return non-OK.  On success fill *result and return OK.  Data blocks of
+// tables with a compression dictionary must be read with that dictionary.
 Status ReadBlock(RandomAccessFile* file, const ReadOptions& options,
-                 const BlockHandle& handle, BlockContents* result);
+                 const BlockHandle& handle, BlockContents* result,
+                 const Slice& compression_dict = Slice());
+
+// Finish reading a block: "contents" is what reading
+// handle.size() + kBlockTrailerSize bytes at handle.offset() into "buf"
+// returned.  Verifies and uncompresses the block like ReadBlock().  Takes
+// ownership of "buf", which must have been allocated with new[].
+Status DecodeBlock(const ReadOptions& options, const BlockHandle& handle,
+                   char* buf, const Slice& contents, BlockContents* result,
+                   const Slice& compression_dict = Slice());
 
 // Implementation details follow.  Clients should ignore,
 
@@ -4,39 +4,129 @@
 
 #include "leveldb/table.h"
 
+#include <vector>
+
 #include "leveldb/cache.h"
 #include "leveldb/comparator.h"
 #include "leveldb/env.h"
 #include "leveldb/filter_policy.h"
 #include "leveldb/options.h"
+#include "leveldb/pinnable_slice.h"
 #include "table/block.h"
 #include "table/filter_block.h"
 #include "table/format.h"
 #include "table/two_level_iterator.h"
+#include "util/allocation_stats.h"
 #include "util/coding.h"
+#include "util/perf_context_imp.h"
 
 namespace leveldb {
 
 struct Table::Rep {
   ~Rep() {
     delete filter;
-    delete[] filter_data;
-    delete index_block;
+    if (filter_cache_handle != nullptr) {
+      options.block_cache->Release(filter_cache_handle);
+    } else {
+      delete[] filter_data;
+    }
+    if (index_cache_handle != nullptr) {
+      options.block_cache->Release(index_cache_handle);
+    } else {
+      delete index_block;
+    }
+    delete range_del_block;
   }
 
   Options options;
   Status status;
   RandomAccessFile* file;
   uint64_t cache_id;
+  // Holds a filter on behalf of the table; "contents" must stay live.
+  void HoldFilter(const Slice& contents) {
+    if (full_filter) {
+      full_filter_data = contents;
+    } else {
+      filter = new FilterBlockReader(options.filter_policy, contents);
+    }
+  }
+
   FilterBlockReader* filter;
   const char* filter_data;
 
+  // If full_filter, the table has a single filter over all of its keys,
+  // which is held in full_filter_data instead of "filter".
+  bool full_filter;
+  Slice full_filter_data;
+
+  // If cached_filter, the filter is not held by the table but only stored
+  // in block_cache, and has to be looked up on every read.
+  bool cached_filter;
+  BlockHandle filter_handle;
+  Cache::Handle* filter_cache_handle;  // Non-null if the filter is pinned
+
   BlockHandle metaindex_handle;  // Handle to metaindex_block: saved from footer
+
+  // If index_block is null, the index block is only stored in block_cache.
+  // If partitioned, index_block is the top-level index over the index
+  // partitions and is always held by the table.
+  BlockHandle index_handle;
   Block* index_block;
+  Cache::Handle* index_cache_handle;  // Non-null if the index is pinned
+  bool partitioned;
+  bool partitioned_filters;
+
+  // Key encoding of the data blocks, from the table's format version.
+  BlockKeyEncoding data_block_encoding;
+
+  // Dictionary the data blocks were compressed with; empty if none.
+  std::string compression_dict;
+
+  // The range deletions of the table, if it has any, or null.
+  Block* range_del_block;
 };
 
+// Block cache keys are the table's cache id followed by the block offset.
+static Slice BlockCacheKey(uint64_t cache_id, const BlockHandle& handle,
+                           char* buf) {
+  EncodeFixed64(buf, cache_id);
+  EncodeFixed64(buf + 8, handle.offset());
+  return Slice(buf, 16);
+}
+
+static void DeleteCachedBlock(const Slice& key, void* value) {
+  Block* block = reinterpret_cast<Block*>(value);
+  RecordFree(kBlockCacheAllocations, block->size());
+  delete block;
+}
+
+static void DeleteCachedFilter(const Slice& key, void* value) {
+  BlockContents* contents = reinterpret_cast<BlockContents*>(value);
+  RecordFree(kBlockCacheAllocations, contents->data.size());
+  delete[] contents->data.data();
+  delete contents;
+}
+
+static Cache::Handle* CacheBlock(Cache* cache, const Slice& key,
+                                 Block* block) {
+  RecordAllocation(kBlockCacheAllocations, block->size());
+  return cache->Insert(key, block, block->size(), &DeleteCachedBlock);
+}
+
+static Cache::Handle* CacheFilter(Cache* cache, const Slice& key,
+                                  BlockContents* contents) {
+  RecordAllocation(kBlockCacheAllocations, contents->data.size());
+  return cache->Insert(key, contents, contents->data.size(),
+                       &DeleteCachedFilter);
+}
+
 Status Table::Open(const Options& options, RandomAccessFile* file,
                    uint64_t size, Table** table) {
+  return Open(options, file, size, -1, table);
+}
+
+Status Table::Open(const Options& options, RandomAccessFile* file,
+                   uint64_t size, int level, Table** table) {
   *table = nullptr;
   if (size < Footer::kEncodedLength) {
     return Status::Corruption("file is too short to be an sstable");
@@ -68,47 +158,152 @@ Status Table::Open(const Options& options, RandomAccessFile* file,
     rep->options = options;
     rep->file = file;
     rep->metaindex_handle = footer.metaindex_handle();
+    rep->index_handle = footer.index_handle();
     rep->index_block = index_block;
+    rep->index_cache_handle = nullptr;
+    rep->partitioned = false;
+    rep->partitioned_filters = false;
+    rep->data_block_encoding =
+        footer.format_version() >= 1 ? kTaggedKeys : kPlainKeys;
     rep->cache_id = (options.block_cache ? options.block_cache->NewId() : 0);
     rep->filter_data = nullptr;
     rep->filter = nullptr;
+    rep->full_filter = false;
+    rep->cached_filter = false;
+    rep->filter_cache_handle = nullptr;
+    rep->range_del_block = nullptr;
     *table = new Table(rep);
-    (*table)->ReadMeta(footer);
+
+    // Index and filter blocks are only worth pinning for level-0 tables,
+    // which every read has to consult.
+    Cache* block_cache = options.block_cache;
+    const bool use_cache =
+        options.cache_index_and_filter_blocks && block_cache != nullptr;
+    const bool pin =
+        use_cache && options.pin_l0_filter_and_index_blocks_in_cache &&
+        level == 0;
+    s = (*table)->ReadMeta(footer, use_cache, pin);
+    if (!s.ok()) {
+      delete *table;
+      *table = nullptr;
+      return s;
+    }
+
+    // The top-level index of a partitioned table is small, so it always
+    // stays with the table.  Blocks that are not cachable point into an
+    // mmap()ed file and cannot outlive the table either.
+    if (use_cache && !rep->partitioned && index_block_contents.cachable) {
+      char cache_key_buffer[16];
+      Cache::Handle* h = CacheBlock(
+          block_cache,
+          BlockCacheKey(rep->cache_id, rep->index_handle, cache_key_buffer),
+          index_block);
+      if (pin) {
+        rep->index_cache_handle = h;
+      } else {
+        block_cache->Release(h);
+        rep->index_block = nullptr;
+      }
+    }
   }
 
   return s;
 }
 
-void Table::ReadMeta(const Footer& footer) {
-  if (rep_->options.filter_policy == nullptr) {
-    return;  // Do not need any metadata
+Status Table::ReadMeta(const Footer& footer, bool use_cache, bool pin) {
+  // An empty metaindex block holds nothing but its single restart point
+  // and the restart count, so there is no need to read it.
+  if (footer.metaindex_handle().size() <= 2 * sizeof(uint32_t)) {
+    return Status::OK();
   }
 
-  // TODO(sanjay): Skip this if footer.metaindex_handle() size indicates
-  // it is an empty block.
   ReadOptions opt;
   if (rep_->options.paranoid_checks) {
     opt.verify_checksums = true;
   }
   BlockContents contents;
-  if (!ReadBlock(rep_->file, opt, footer.metaindex_handle(), &contents).ok()) {
-    // Do not propagate errors since meta info is not needed for operation
-    return;
+  Status s = ReadBlock(rep_->file, opt, footer.metaindex_handle(), &contents);
+  if (!s.ok()) {
+    // The metaindex records whether the index is partitioned, which is
+    // needed to interpret the index block at all.
+    return s;
   }
   Block* meta = new Block(contents);
 
   Iterator* iter = meta->NewIterator(BytewiseComparator());
-  std::string key = "filter.";
-  key.append(rep_->options.filter_policy->Name());
-  iter->Seek(key);
-  if (iter->Valid() && iter->key() == Slice(key)) {
-    ReadFilter(iter->value());
+  const Slice partitioned_key("index.partitioned");
+  iter->Seek(partitioned_key);
+  rep_->partitioned = iter->Valid() && iter->key() == partitioned_key;
+
+  const Slice dict_key("compression.zstd.dictionary");
+  iter->Seek(dict_key);
+  if (iter->Valid() && iter->key() == dict_key) {
+    // Like the metaindex, the dictionary is needed to read any data block.
+    Slice v = iter->value();
+    BlockHandle dict_handle;
+    BlockContents dict;
+    s = dict_handle.DecodeFrom(&v);
+    if (s.ok()) {
+      s = ReadBlock(rep_->file, opt, dict_handle, &dict);
+    }
+    if (!s.ok()) {
+      delete iter;
+      delete meta;
+      return s;
+    }
+    rep_->compression_dict.assign(dict.data.data(), dict.data.size());
+    if (dict.heap_allocated) {
+      delete[] dict.data.data();
+    }
+  }
+
+  const Slice range_del_key("leveldb.range_del");
+  iter->Seek(range_del_key);
+  if (iter->Valid() && iter->key() == range_del_key) {
+    // Without its range deletions, deleted keys of the table would reappear.
+    Slice v = iter->value();
+    BlockHandle range_del_handle;
+    BlockContents range_dels;
+    s = range_del_handle.DecodeFrom(&v);
+    if (s.ok()) {
+      s = ReadBlock(rep_->file, opt, range_del_handle, &range_dels);
+    }
+    if (!s.ok()) {
+      delete iter;
+      delete meta;
+      return s;
+    }
+    rep_->range_del_block = new Block(range_dels);
+  }
+  if (rep_->options.filter_policy != nullptr) {
+    std::string key = "filter.";
+    key.append(rep_->options.filter_policy->Name());
+    iter->Seek(key);
+    if (iter->Valid() && iter->key() == Slice(key)) {
+      ReadFilter(iter->value(), false, use_cache, pin);
+    }
+
+    key = "fullfilter.";
+    key.append(rep_->options.filter_policy->Name());
+    iter->Seek(key);
+    if (iter->Valid() && iter->key() == Slice(key)) {
+      ReadFilter(iter->value(), true, use_cache, pin);
+    }
+
+    key = "partitionedfilter.";
+    key.append(rep_->options.filter_policy->Name());
+    iter->Seek(key);
+    if (iter->Valid() && iter->key() == Slice(key)) {
+      rep_->partitioned_filters = rep_->partitioned;
+    }
   }
   delete iter;
   delete meta;
+  return Status::OK();
 }
 
-void Table::ReadFilter(const Slice& filter_handle_value) {
+void Table::ReadFilter(const Slice& filter_handle_value, bool full,
+                       bool use_cache, bool pin) {
   Slice v = filter_handle_value;
   BlockHandle filter_handle;
   if (!filter_handle.DecodeFrom(&v).ok()) {
@@ -125,21 +320,46 @@ void Table::ReadFilter(const Slice& filter_handle_value) {
   if (!ReadBlock(rep_->file, opt, filter_handle, &block).ok()) {
     return;
   }
+  rep_->full_filter = full;
+  if (use_cache && block.cachable) {
+    Cache* block_cache = rep_->options.block_cache;
+    char cache_key_buffer[16];
+    Cache::Handle* h = CacheFilter(
+        block_cache,
+        BlockCacheKey(rep_->cache_id, filter_handle, cache_key_buffer),
+        new BlockContents(block));
+    if (pin) {
+      rep_->filter_cache_handle = h;
+      rep_->filter_data = block.data.data();
+      rep_->HoldFilter(block.data);
+    } else {
+      block_cache->Release(h);
+      rep_->cached_filter = true;
+      rep_->filter_handle = filter_handle;
+    }
+    return;
+  }
   if (block.heap_allocated) {
     rep_->filter_data = block.data.data();  // Will need to delete later
   }
-  rep_->filter = new FilterBlockReader(rep_->options.filter_policy, block.data);
+  rep_->HoldFilter(block.data);
 }
 
 Table::~Table() { delete rep_; }
 
+Iterator* Table::NewRangeDeletionIterator() const {
+  if (rep_->range_del_block == nullptr) {
+    return nullptr;
+  }
+  return rep_->range_del_block->NewIterator(rep_->options.comparator);
+}
+
 static void DeleteBlock(void* arg, void* ignored) {
   delete reinterpret_cast<Block*>(arg);
 }
 
-static void DeleteCachedBlock(const Slice& key, void* value) {
-  Block* block = reinterpret_cast<Block*>(value);
-  delete block;
+static void DeleteIterator(void* arg, void* ignored) {
+  delete reinterpret_cast<Iterator*>(arg);
 }
 
 static void ReleaseBlock(void* arg, void* h) {
@@ -152,8 +372,61 @@ static void ReleaseBlock(void* arg, void* h) {
 // into an iterator over the contents of the corresponding block.
 Iterator* Table::BlockReader(void* arg, const ReadOptions& options,
                              const Slice& index_value) {
+  return ReadBlockIterator(reinterpret_cast<Table*>(arg), options, index_value,
+                           false, true);
+}
+
+void Table::BatchBlockReader(void* arg, const ReadOptions& options,
+                             const Slice* index_values, int n,
+                             Iterator** iters) {
   Table* table = reinterpret_cast<Table*>(arg);
+  std::vector<BlockHandle> handles(n);
+  for (int i = 0; i < n; i++) {
+    Slice input = index_values[i];
+    Status s = handles[i].DecodeFrom(&input);
+    if (!s.ok()) {
+      // Let the two-level iterator fall back to reading them one by one.
+      for (int j = 0; j < n; j++) {
+        iters[j] = BlockReader(arg, options, index_values[j]);
+      }
+      return;
+    }
+  }
+
+  std::vector<Block*> blocks(n);
+  std::vector<Cache::Handle*> cache_handles(n);
+  Status s = table->ReadDataBlocks(options, handles.data(), n, blocks.data(),
+                                   cache_handles.data());
   Cache* block_cache = table->rep_->options.block_cache;
+  const Comparator* comparator = table->rep_->options.comparator;
+  for (int i = 0; i < n; i++) {
+    if (blocks[i] == nullptr) {
+      iters[i] = NewErrorIterator(s);
+      continue;
+    }
+    iters[i] = blocks[i]->NewIterator(comparator);
+    if (cache_handles[i] == nullptr) {
+      iters[i]->RegisterCleanup(&DeleteBlock, blocks[i], nullptr);
+    } else {
+      iters[i]->RegisterCleanup(&ReleaseBlock, block_cache, cache_handles[i]);
+    }
+  }
+}
+
+Iterator* Table::IndexBlockReader(void* arg, const ReadOptions& options,
+                                  const Slice& index_value) {
+  return ReadBlockIterator(reinterpret_cast<Table*>(arg), options, index_value,
+                           false, false);
+}
+
+Iterator* Table::ReadBlockIterator(Table* table, const ReadOptions& options,
+                                   const Slice& index_value,
+                                   bool point_lookup, bool data_block) {
+  Cache* block_cache = table->rep_->options.block_cache;
+  const BlockKeyEncoding encoding =
+      data_block ? table->rep_->data_block_encoding : kPlainKeys;
+  const Slice compression_dict =
+      data_block ? Slice(table->rep_->compression_dict) : Slice();
   Block* block = nullptr;
   Cache::Handle* cache_handle = nullptr;
 
@@ -167,33 +440,36 @@ Iterator* Table::BlockReader(void* arg, const ReadOptions& options,
     BlockContents contents;
     if (block_cache != nullptr) {
       char cache_key_buffer[16];
-      EncodeFixed64(cache_key_buffer, table->rep_->cache_id);
-      EncodeFixed64(cache_key_buffer + 8, handle.offset());
-      Slice key(cache_key_buffer, sizeof(cache_key_buffer));
+      Slice key =
+          BlockCacheKey(table->rep_->cache_id, handle, cache_key_buffer);
       cache_handle = block_cache->Lookup(key);
       if (cache_handle != nullptr) {
+        PERF_COUNTER_ADD(block_cache_hit_count, 1);
         block = reinterpret_cast<Block*>(block_cache->Value(cache_handle));
       } else {
-        s = ReadBlock(table->rep_->file, options, handle, &contents);
+        s = ReadBlock(table->rep_->file, options, handle, &contents,
+                      compression_dict);
         if (s.ok()) {
-          block = new Block(contents);
+          block = new Block(contents, encoding);
           if (contents.cachable && options.fill_cache) {
-            cache_handle = block_cache->Insert(key, block, block->size(),
-                                               &DeleteCachedBlock);
+            cache_handle = CacheBlock(block_cache, key, block);
           }
         }
       }
     } else {
-      s = ReadBlock(table->rep_->file, options, handle, &contents);
+      s = ReadBlock(table->rep_->file, options, handle, &contents,
+                    compression_dict);
       if (s.ok()) {
-        block = new Block(contents);
+        block = new Block(contents, encoding);
       }
     }
   }
 
   Iterator* iter;
   if (block != nullptr) {
-    iter = block->NewIterator(table->rep_->options.comparator);
+    const Comparator* comparator = table->rep_->options.comparator;
+    iter = point_lookup ? block->NewPointLookupIterator(comparator)
+                        : block->NewIterator(comparator);
     if (cache_handle == nullptr) {
       iter->RegisterCleanup(&DeleteBlock, block, nullptr);
     } else {
@@ -205,36 +481,387 @@ Iterator* Table::BlockReader(void* arg, const ReadOptions& options,
   return iter;
 }
 
+Status Table::ReadDataBlocks(const ReadOptions& options,
+                             const BlockHandle* handles, size_t n,
+                             Block** blocks,
+                             Cache::Handle** cache_handles) const {
+  Cache* block_cache = rep_->options.block_cache;
+  std::vector<RandomAccessFile::ReadRequest> reqs;
+  std::vector<size_t> req_blocks;  // Index of the block each request reads
+  for (size_t i = 0; i < n; i++) {
+    blocks[i] = nullptr;
+    cache_handles[i] = nullptr;
+    if (block_cache != nullptr) {
+      char cache_key_buffer[16];
+      Slice key = BlockCacheKey(rep_->cache_id, handles[i], cache_key_buffer);
+      cache_handles[i] = block_cache->Lookup(key);
+      if (cache_handles[i] != nullptr) {
+        PERF_COUNTER_ADD(block_cache_hit_count, 1);
+        blocks[i] = reinterpret_cast<Block*>(block_cache->Value(
+            cache_handles[i]));
+        continue;
+      }
+    }
+    RandomAccessFile::ReadRequest req;
+    req.offset = handles[i].offset();
+    req.n = static_cast<size_t>(handles[i].size()) + kBlockTrailerSize;
+    req.scratch = new char[req.n];
+    reqs.push_back(req);
+    req_blocks.push_back(i);
+  }
+  if (reqs.empty()) {
+    return Status::OK();
+  }
+
+  {
+    PERF_TIMER_GUARD(block_read_nanos);
+    rep_->file->MultiRead(reqs.data(), reqs.size());
+  }
+  PERF_COUNTER_ADD(block_read_count, reqs.size());
+
+  Status result;
+  for (size_t r = 0; r < reqs.size(); r++) {
+    RandomAccessFile::ReadRequest& req = reqs[r];
+    PERF_COUNTER_ADD(block_read_bytes, req.result.size());
+    Status s = req.status;
+    BlockContents contents;
+    if (s.ok()) {
+      s = DecodeBlock(options, handles[req_blocks[r]], req.scratch, req.result,
+                      &contents, rep_->compression_dict);
+    } else {
+      delete[] req.scratch;
+    }
+    if (!s.ok()) {
+      if (result.ok()) {
+        result = s;
+      }
+      continue;
+    }
+
+    const size_t i = req_blocks[r];
+    blocks[i] = new Block(contents, rep_->data_block_encoding);
+    if (block_cache != nullptr && contents.cachable && options.fill_cache) {
+      char cache_key_buffer[16];
+      Slice key = BlockCacheKey(rep_->cache_id, handles[i], cache_key_buffer);
+      cache_handles[i] = CacheBlock(block_cache, key, blocks[i]);
+    }
+  }
+  return result;
+}
+
+void Table::ReleaseDataBlock(Block* block, Cache::Handle* cache_handle) const {
+  if (cache_handle != nullptr) {
+    rep_->options.block_cache->Release(cache_handle);
+  } else {
+    delete block;
+  }
+}
+
+Status Table::ReadFilterContents(const ReadOptions& options,
+                                 const BlockHandle& handle,
+                                 BlockContents* contents,
+                                 Cache::Handle** cache_handle) const {
+  Cache* block_cache = rep_->options.block_cache;
+  *cache_handle = nullptr;
+  char cache_key_buffer[16];
+  Slice key;
+  if (block_cache != nullptr) {
+    key = BlockCacheKey(rep_->cache_id, handle, cache_key_buffer);
+    *cache_handle = block_cache->Lookup(key);
+    if (*cache_handle != nullptr) {
+      PERF_COUNTER_ADD(block_cache_hit_count, 1);
+      *contents =
+          *reinterpret_cast<BlockContents*>(block_cache->Value(*cache_handle));
+      return Status::OK();
+    }
+  }
+
+  Status s = ReadBlock(rep_->file, options, handle, contents);
+  if (s.ok() && block_cache != nullptr && contents->cachable &&
+      options.fill_cache) {
+    *cache_handle =
+        CacheFilter(block_cache, key, new BlockContents(*contents));
+  }
+  return s;
+}
+
+void Table::ReleaseFilterContents(const BlockContents& contents,
+                                  Cache::Handle* cache_handle) const {
+  if (cache_handle != nullptr) {
+    rep_->options.block_cache->Release(cache_handle);
+  } else if (contents.heap_allocated) {
+    delete[] contents.data.data();
+  }
+}
+
+// Counts a filter probe that returned "may_match" and returns it.
+static bool CountFilterCheck(bool may_match) {
+  PERF_COUNTER_ADD(filter_check_count, 1);
+  if (!may_match) {
+    PERF_COUNTER_ADD(filter_useful_count, 1);
+  }
+  return may_match;
+}
+
+bool Table::FullFilterMayMatch(const ReadOptions& options,
+                               const Slice& key) const {
+  if (!rep_->full_filter) {
+    return true;
+  }
+  PERF_TIMER_GUARD(filter_check_nanos);
+  const FilterPolicy* policy = rep_->options.filter_policy;
+  if (!rep_->cached_filter) {
+    return CountFilterCheck(policy->KeyMayMatch(key, rep_->full_filter_data));
+  }
+
+  BlockContents contents;
+  Cache::Handle* cache_handle;
+  if (!ReadFilterContents(options, rep_->filter_handle, &contents,
+                          &cache_handle)
+           .ok()) {
+    return true;
+  }
+  const bool may_match = policy->KeyMayMatch(key, contents.data);
+  ReleaseFilterContents(contents, cache_handle);
+  return CountFilterCheck(may_match);
+}
+
+bool Table::KeyMayMatch(const ReadOptions& options, uint64_t block_offset,
+                        const Slice& key) const {
+  if (rep_->full_filter) {
+    return true;  // Already checked by FullFilterMayMatch()
+  }
+  if (rep_->filter == nullptr && !rep_->cached_filter) {
+    return true;
+  }
+  PERF_TIMER_GUARD(filter_check_nanos);
+  if (rep_->filter != nullptr) {
+    return CountFilterCheck(rep_->filter->KeyMayMatch(block_offset, key));
+  }
+
+  BlockContents contents;
+  Cache::Handle* cache_handle;
+  if (!ReadFilterContents(options, rep_->filter_handle, &contents,
+                          &cache_handle)
+           .ok()) {
+    return true;
+  }
+  FilterBlockReader filter(rep_->options.filter_policy, contents.data);
+  const bool may_match = filter.KeyMayMatch(block_offset, key);
+  ReleaseFilterContents(contents, cache_handle);
+  return CountFilterCheck(may_match);
+}
+
+bool Table::PartitionKeyMayMatch(const ReadOptions& options,
+                                 const Slice& partition_value,
+                                 const Slice& key) const {
+  if (!rep_->partitioned_filters) {
+    return true;
+  }
+  PERF_TIMER_GUARD(filter_check_nanos);
+
+  // The top-level index value is the index partition handle followed by
+  // the handle of the partition's filter.
+  Slice input = partition_value;
+  BlockHandle index_handle, filter_handle;
+  if (!index_handle.DecodeFrom(&input).ok() ||
+      !filter_handle.DecodeFrom(&input).ok()) {
+    return true;
+  }
+
+  BlockContents contents;
+  Cache::Handle* cache_handle;
+  if (!ReadFilterContents(options, filter_handle, &contents, &cache_handle)
+           .ok()) {
+    return true;
+  }
+  const bool may_match =
+      rep_->options.filter_policy->KeyMayMatch(key, contents.data);
+  ReleaseFilterContents(contents, cache_handle);
+  return CountFilterCheck(may_match);
+}
+
+Iterator* Table::NewIndexIterator(const ReadOptions& options) const {
+  if (rep_->partitioned) {
+    // Each top-level entry points at an index partition, which
+    // IndexBlockReader loads through the block cache just like a data block.
+    return NewTwoLevelIterator(
+        rep_->index_block->NewIterator(rep_->options.comparator),
+        &Table::IndexBlockReader, const_cast<Table*>(this), options);
+  }
+  if (rep_->index_block != nullptr) {
+    return rep_->index_block->NewIterator(rep_->options.comparator);
+  }
+  std::string handle_encoding;
+  rep_->index_handle.EncodeTo(&handle_encoding);
+  return IndexBlockReader(const_cast<Table*>(this), options, handle_encoding);
+}
+
 Iterator* Table::NewIterator(const ReadOptions& options) const {
-  return NewTwoLevelIterator(
-      rep_->index_block->NewIterator(rep_->options.comparator),
-      &Table::BlockReader, const_cast<Table*>(this), options);
+  return NewTwoLevelIterator(NewIndexIterator(options), &Table::BlockReader,
+                             const_cast<Table*>(this), options,
+                             &Table::BatchBlockReader);
 }
 
 Status Table::InternalGet(const ReadOptions& options, const Slice& k, void* arg,
                           void (*handle_result)(void*, const Slice&,
-                                                const Slice&)) {
+                                                const Slice&),
+                          PinnableSlice* pinned) {
+  // A whole-table filter answers most lookups for missing keys without
+  // touching the index at all.
+  if (!FullFilterMayMatch(options, k)) {
+    return Status::OK();
+  }
+
   Status s;
-  Iterator* iiter = rep_->index_block->NewIterator(rep_->options.comparator);
+  Iterator* iiter = nullptr;
+  if (rep_->partitioned) {
+    // Only load the index partition that may hold "k", and skip it
+    // altogether if the partition's filter rules the key out.
+    Iterator* top_iter =
+        rep_->index_block->NewIterator(rep_->options.comparator);
+    top_iter->Seek(k);
+    if (top_iter->Valid() &&
+        PartitionKeyMayMatch(options, top_iter->value(), k)) {
+      iiter = IndexBlockReader(this, options, top_iter->value());
+    }
+    s = top_iter->status();
+    delete top_iter;
+    if (iiter == nullptr) {
+      return s;
+    }
+  } else {
+    iiter = NewIndexIterator(options);
+  }
+
   iiter->Seek(k);
   if (iiter->Valid()) {
     Slice handle_value = iiter->value();
-    FilterBlockReader* filter = rep_->filter;
     BlockHandle handle;
-    if (filter != nullptr && handle.DecodeFrom(&handle_value).ok() &&
-        !filter->KeyMayMatch(handle.offset(), k)) {
+    if (handle.DecodeFrom(&handle_value).ok() &&
+        !KeyMayMatch(options, handle.offset(), k)) {
       // Not found
     } else {
-      Iterator* block_iter = BlockReader(this, options, iiter->value());
+      Iterator* block_iter = ReadBlockIterator(this, options, iiter->value(),
+                                               true, true);
       block_iter->Seek(k);
       if (block_iter->Valid()) {
         (*handle_result)(arg, block_iter->key(), block_iter->value());
       }
       s = block_iter->status();
+      if (pinned != nullptr && pinned->IsPinned()) {
+        // The block iterator holds on to the block the value points into.
+        pinned->RegisterCleanup(&DeleteIterator, block_iter, nullptr);
+      } else {
+        delete block_iter;
+      }
+    }
+  }
+  if (s.ok()) {
+    s = iiter->status();
+  }
+  delete iiter;
+  return s;
+}
+
+Status Table::InternalMultiGet(const ReadOptions& options, const Slice* keys,
+                               int n, void* const* args,
+                               void (*handle_result)(void*, const Slice&,
+                                                     const Slice&)) {
+  Status s;
+  if (rep_->partitioned) {
+    // Each key only loads the index partition it needs.
+    for (int i = 0; i < n && s.ok(); i++) {
+      s = InternalGet(options, keys[i], args[i], handle_result);
+    }
+    return s;
+  }
+
+  // The handles of up to kMaxBatchBlocks data blocks are collected before
+  // the blocks are read together.
+  static const size_t kMaxBatchBlocks = 32;
+  std::vector<BlockHandle> handles;
+  std::vector<int> batch_keys;    // Keys that may be in the batch's blocks
+  std::vector<size_t> key_block;  // Index into "handles" of each batch key
+  Block* blocks[kMaxBatchBlocks];
+  Cache::Handle* cache_handles[kMaxBatchBlocks];
+
+  // Looks the batch's keys up in their blocks and empties the batch.
+  auto flush = [&]() {
+    if (handles.empty()) {
+      return;
+    }
+    Status read_status = ReadDataBlocks(options, handles.data(),
+                                        handles.size(), blocks, cache_handles);
+    const Comparator* comparator = rep_->options.comparator;
+    for (size_t j = 0; j < batch_keys.size() && s.ok(); j++) {
+      Block* block = blocks[key_block[j]];
+      if (block == nullptr) {
+        s = read_status;
+        break;
+      }
+      const int i = batch_keys[j];
+      Iterator* block_iter = block->NewPointLookupIterator(comparator);
+      block_iter->Seek(keys[i]);
+      if (block_iter->Valid()) {
+        (*handle_result)(args[i], block_iter->key(), block_iter->value());
+      }
+      s = block_iter->status();
       delete block_iter;
     }
+    for (size_t b = 0; b < handles.size(); b++) {
+      if (blocks[b] != nullptr) {
+        ReleaseDataBlock(blocks[b], cache_handles[b]);
+      }
+    }
+    handles.clear();
+    batch_keys.clear();
+    key_block.clear();
+  };
+
+  Iterator* iiter = nullptr;
+  for (int i = 0; i < n && s.ok(); i++) {
+    const Slice& k = keys[i];
+    if (!FullFilterMayMatch(options, k)) {
+      continue;
+    }
+
+    // The keys are sorted, so the index entry found for an earlier key
+    // still covers "k" unless "k" is past it.
+    if (iiter == nullptr) {
+      iiter = NewIndexIterator(options);
+      iiter->Seek(k);
+    } else if (!iiter->Valid() ||
+               rep_->options.comparator->Compare(k, iiter->key()) > 0) {
+      iiter->Seek(k);
+    }
+    if (!iiter->Valid()) {
+      // So are all later keys.
+      break;
+    }
+
+    Slice handle_value = iiter->value();
+    BlockHandle handle;
+    s = handle.DecodeFrom(&handle_value);
+    if (!s.ok() || !KeyMayMatch(options, handle.offset(), k)) {
+      continue;
+    }
+    if (handles.empty() || handles.back().offset() != handle.offset()) {
+      if (handles.size() == kMaxBatchBlocks) {
+        flush();
+        if (!s.ok()) {
+          break;
+        }
+      }
+      handles.push_back(handle);
+    }
+    batch_keys.push_back(i);
+    key_block.push_back(handles.size() - 1);
   }
   if (s.ok()) {
+    flush();
+  }
+  if (s.ok() && iiter != nullptr) {
     s = iiter->status();
   }
   delete iiter;
@@ -242,8 +869,7 @@ Status Table::InternalGet(const ReadOptions& options, const Slice& k, void* arg,
 }
 
 uint64_t Table::ApproximateOffsetOf(const Slice& key) const {
-  Iterator* index_iter =
-      rep_->index_block->NewIterator(rep_->options.comparator);
+  Iterator* index_iter = NewIndexIterator(ReadOptions());
   index_iter->Seek(key);
   uint64_t result;
   if (index_iter->Valid()) {
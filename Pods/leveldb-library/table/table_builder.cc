@@ -4,7 +4,10 @@
 
 #include "leveldb/table_builder.h"
 
+#include <algorithm>
 #include <cassert>
+#include <utility>
+#include <vector>
 
 #include "leveldb/comparator.h"
 #include "leveldb/env.h"
@@ -18,6 +21,17 @@
 
 namespace leveldb {
 
+// Name of the metaindex entry for a table's compression dictionary.
+static const char kCompressionDictKey[] = "compression.zstd.dictionary";
+
+// Name of the metaindex entry for a table's range deletion block.
+static const char kRangeDelKey[] = "leveldb.range_del";
+
+// A dictionary of N bytes is trained on up to 100 * N bytes of entries,
+// as recommended by zstd, taken from at least kMinDictionarySamples blocks.
+static const size_t kDictTrainingBytesPerDictByte = 100;
+static const size_t kMinDictionarySamples = 8;
+
 struct TableBuilder::Rep {
   Rep(const Options& opt, WritableFile* f)
       : options(opt),
@@ -27,12 +41,26 @@ struct TableBuilder::Rep {
         data_block(&options),
         index_block(&index_block_options),
         num_entries(0),
+        num_blocks(0),
+        num_compressed_blocks(0),
+        raw_block_bytes(0),
+        stored_block_bytes(0),
         closed(false),
-        filter_block(opt.filter_policy == nullptr
+        partitioned(opt.partition_index_and_filters),
+        top_level_index(&index_block_options),
+        filter_block(opt.filter_policy == nullptr || partitioned ||
+                             opt.filter_policy->UseWholeTableFilter()
                          ? nullptr
                          : new FilterBlockBuilder(opt.filter_policy)),
-        pending_index_entry(false) {
+        full_filter(filter_block != nullptr || opt.filter_policy == nullptr
+                        ? nullptr
+                        : new FullFilterBlockBuilder(opt.filter_policy)),
+        pending_index_entry(false),
+        dict_buffering(opt.compression == kZstdCompression &&
+                       opt.zstd_max_dict_bytes > 0) {
     index_block_options.block_restart_interval = 1;
+    index_block_options.data_block_hash_index = false;
+    index_block_options.format_version = 0;
   }
 
   Options options;
@@ -44,8 +72,26 @@ struct TableBuilder::Rep {
   BlockBuilder index_block;
   std::string last_key;
   int64_t num_entries;
+  // Blocks that went through options.compression, and their sizes before
+  // and after it.
+  uint64_t num_blocks;
+  uint64_t num_compressed_blocks;
+  uint64_t raw_block_bytes;
+  uint64_t stored_block_bytes;
   bool closed;  // Either Finish() or Abandon() has been called.
+
+  // If partitioned, index_block holds the current index partition and
+  // top_level_index maps the last key of every finished partition to the
+  // handle of that partition, followed by the handle of its filter
+  // partition when full_filter is non-null.
+  const bool partitioned;
+  BlockBuilder top_level_index;
+
+  // At most one of these is non-null.  full_filter builds the filter for
+  // the current index partition if partitioned, and otherwise a single
+  // filter for the whole table.
   FilterBlockBuilder* filter_block;
+  FullFilterBlockBuilder* full_filter;
 
   // We do not emit the index entry for a block until we have seen the
   // first key for the next data block.  This allows us to use shorter
@@ -60,6 +106,23 @@ struct TableBuilder::Rep {
   BlockHandle pending_handle;  // Handle to add to index block
 
   std::string compressed_output;
+
+  // While dict_buffering, the compression dictionary has not been trained
+  // yet, so added entries are only buffered (as length-prefixed keys and
+  // values) and nothing is written.  The data blocks built from them serve
+  // as training samples.  Once enough have been seen, FinishDictionary()
+  // trains the dictionary and replays the buffered entries.
+  bool dict_buffering;
+  std::string buffered_entries;
+  std::vector<uint64_t> buffered_flushes;  // num_entries at each Flush()
+  std::string dict_samples;
+  std::vector<size_t> dict_sample_sizes;
+
+  // Dictionary used to compress data blocks; empty if none.
+  std::string compression_dict;
+
+  // Entries of the range deletion block, written by Finish().
+  std::vector<std::pair<std::string, std::string>> range_dels;
 };
 
 TableBuilder::TableBuilder(const Options& options, WritableFile* file)
@@ -72,6 +135,7 @@ TableBuilder::TableBuilder(const Options& options, WritableFile* file)
 TableBuilder::~TableBuilder() {
   assert(rep_->closed);  // Catch errors where caller forgot to call Finish()
   delete rep_->filter_block;
+  delete rep_->full_filter;
   delete rep_;
 }
 
@@ -82,12 +146,22 @@ Status TableBuilder::ChangeOptions(const Options& options) {
   if (options.comparator != rep_->options.comparator) {
     return Status::InvalidArgument("changing comparator while building table");
   }
+  if (options.partition_index_and_filters != rep_->partitioned) {
+    return Status::InvalidArgument(
+        "changing index partitioning while building table");
+  }
+  if (options.format_version != rep_->options.format_version) {
+    return Status::InvalidArgument(
+        "changing format version while building table");
+  }
 
   // Note that any live BlockBuilders point to rep_->options and therefore
   // will automatically pick up the updated options.
   rep_->options = options;
   rep_->index_block_options = options;
   rep_->index_block_options.block_restart_interval = 1;
+  rep_->index_block_options.data_block_hash_index = false;
+  rep_->index_block_options.format_version = 0;
   return Status::OK();
 }
 
@@ -98,6 +172,10 @@ void TableBuilder::Add(const Slice& key, const Slice& value) {
   if (r->num_entries > 0) {
     assert(r->options.comparator->Compare(key, Slice(r->last_key)) > 0);
   }
+  if (r->dict_buffering) {
+    BufferForDictionary(key, value);
+    return;
+  }
 
   if (r->pending_index_entry) {
     assert(r->data_block.empty());
@@ -106,11 +184,18 @@ void TableBuilder::Add(const Slice& key, const Slice& value) {
     r->pending_handle.EncodeTo(&handle_encoding);
     r->index_block.Add(r->last_key, Slice(handle_encoding));
     r->pending_index_entry = false;
+    if (r->partitioned && r->index_block.CurrentSizeEstimate() >=
+                              r->options.metadata_block_size) {
+      FlushIndexPartition();
+    }
   }
 
   if (r->filter_block != nullptr) {
     r->filter_block->AddKey(key);
   }
+  if (r->full_filter != nullptr) {
+    r->full_filter->AddKey(key);
+  }
 
   r->last_key.assign(key.data(), key.size());
   r->num_entries++;
@@ -127,6 +212,12 @@ void TableBuilder::Flush() {
   assert(!r->closed);
   if (!ok()) return;
   if (r->data_block.empty()) return;
+  if (r->dict_buffering) {
+    // Replayed by FinishDictionary().
+    AddDictionarySample();
+    r->buffered_flushes.push_back(r->num_entries);
+    return;
+  }
   assert(!r->pending_index_entry);
   WriteBlock(&r->data_block, &r->pending_handle);
   if (ok()) {
@@ -168,7 +259,47 @@ void TableBuilder::WriteBlock(BlockBuilder* block, BlockHandle* handle) {
       }
       break;
     }
+
+    case kZstdCompression: {
+      // Only data blocks use the dictionary, since readers load it from
+      // the metaindex after they have read the index block.
+      const Slice dict = block == &r->data_block ? Slice(r->compression_dict)
+                                                 : Slice();
+      std::string* compressed = &r->compressed_output;
+      if (port::Zstd_Compress(r->options.zstd_compression_level, dict.data(),
+                              dict.size(), raw.data(), raw.size(),
+                              compressed) &&
+          compressed->size() < raw.size() - (raw.size() / 8u)) {
+        block_contents = *compressed;
+      } else {
+        // Zstd not supported, or compressed less than 12.5%, so just
+        // store uncompressed form
+        block_contents = raw;
+        type = kNoCompression;
+      }
+      break;
+    }
+
+    case kLZ4Compression: {
+      std::string* compressed = &r->compressed_output;
+      if (port::Lz4_Compress(raw.data(), raw.size(), compressed) &&
+          compressed->size() < raw.size() - (raw.size() / 8u)) {
+        block_contents = *compressed;
+      } else {
+        // LZ4 not supported, or compressed less than 12.5%, so just
+        // store uncompressed form
+        block_contents = raw;
+        type = kNoCompression;
+      }
+      break;
+    }
+  }
+  r->num_blocks++;
+  if (type != kNoCompression) {
+    r->num_compressed_blocks++;
   }
+  r->raw_block_bytes += raw.size();
+  r->stored_block_bytes += block_contents.size();
   WriteRawBlock(block_contents, type, handle);
   r->compressed_output.clear();
   block->Reset();
@@ -193,25 +324,152 @@ void TableBuilder::WriteRawBlock(const Slice& block_contents,
   }
 }
 
+void TableBuilder::FlushIndexPartition() {
+  Rep* r = rep_;
+  assert(r->partitioned && !r->index_block.empty());
+  if (!ok()) return;
+
+  // The partition's filter covers every key added since the previous
+  // partition was flushed, i.e. exactly the keys of the data blocks that
+  // this partition indexes.
+  BlockHandle filter_handle, index_handle;
+  if (r->full_filter != nullptr) {
+    WriteRawBlock(r->full_filter->Finish(), kNoCompression, &filter_handle);
+  }
+  if (ok()) {
+    WriteBlock(&r->index_block, &index_handle);
+  }
+  if (ok()) {
+    // r->last_key is the key of the partition's last index entry, so it is
+    // >= every key in the partition and < every key in the next one.
+    std::string handle_encoding;
+    index_handle.EncodeTo(&handle_encoding);
+    if (r->full_filter != nullptr) {
+      filter_handle.EncodeTo(&handle_encoding);
+    }
+    r->top_level_index.Add(r->last_key, Slice(handle_encoding));
+  }
+}
+
+void TableBuilder::BufferForDictionary(const Slice& key, const Slice& value) {
+  Rep* r = rep_;
+  PutLengthPrefixedSlice(&r->buffered_entries, key);
+  PutLengthPrefixedSlice(&r->buffered_entries, value);
+  r->last_key.assign(key.data(), key.size());
+  r->num_entries++;
+  r->data_block.Add(key, value);
+  if (r->data_block.CurrentSizeEstimate() >= r->options.block_size) {
+    AddDictionarySample();
+  }
+  if (r->buffered_entries.size() >=
+      kDictTrainingBytesPerDictByte * r->options.zstd_max_dict_bytes) {
+    FinishDictionary();
+  }
+}
+
+void TableBuilder::AddDictionarySample() {
+  Rep* r = rep_;
+  Slice raw = r->data_block.Finish();
+  r->dict_samples.append(raw.data(), raw.size());
+  r->dict_sample_sizes.push_back(raw.size());
+  r->data_block.Reset();
+}
+
+void TableBuilder::FinishDictionary() {
+  Rep* r = rep_;
+  assert(r->dict_buffering);
+  if (!r->data_block.empty()) {
+    AddDictionarySample();
+  }
+  r->dict_buffering = false;
+  if (r->dict_sample_sizes.size() >= kMinDictionarySamples) {
+    // Without a dictionary, blocks are still compressed on their own.
+    port::Zstd_TrainDictionary(r->dict_samples, r->dict_sample_sizes,
+                               r->options.zstd_max_dict_bytes,
+                               &r->compression_dict);
+  }
+  std::string().swap(r->dict_samples);
+  std::vector<size_t>().swap(r->dict_sample_sizes);
+
+  // Replay the buffered entries, now for real.
+  std::string entries;
+  entries.swap(r->buffered_entries);
+  std::vector<uint64_t> flushes;
+  flushes.swap(r->buffered_flushes);
+  r->last_key.clear();
+  r->num_entries = 0;
+  Slice input(entries);
+  Slice key, value;
+  size_t next_flush = 0;
+  while (GetLengthPrefixedSlice(&input, &key) &&
+         GetLengthPrefixedSlice(&input, &value)) {
+    Add(key, value);
+    while (next_flush < flushes.size() &&
+           flushes[next_flush] == static_cast<uint64_t>(r->num_entries)) {
+      Flush();
+      next_flush++;
+    }
+  }
+}
+
+void TableBuilder::AddRangeDeletion(const Slice& key, const Slice& value) {
+  Rep* r = rep_;
+  assert(!r->closed);
+  r->range_dels.emplace_back(key.ToString(), value.ToString());
+}
+
 Status TableBuilder::status() const { return rep_->status; }
 
 Status TableBuilder::Finish() {
   Rep* r = rep_;
+  if (r->dict_buffering) {
+    FinishDictionary();
+  }
   Flush();
   assert(!r->closed);
   r->closed = true;
 
   BlockHandle filter_block_handle, metaindex_block_handle, index_block_handle;
+  BlockHandle dict_block_handle, range_del_block_handle;
+
+  // Write compression dictionary
+  if (ok() && !r->compression_dict.empty()) {
+    WriteRawBlock(r->compression_dict, kNoCompression, &dict_block_handle);
+  }
 
   // Write filter block
   if (ok() && r->filter_block != nullptr) {
     WriteRawBlock(r->filter_block->Finish(), kNoCompression,
                   &filter_block_handle);
+  } else if (ok() && r->full_filter != nullptr && !r->partitioned) {
+    WriteRawBlock(r->full_filter->Finish(), kNoCompression,
+                  &filter_block_handle);
+  }
+
+  // Write range deletion block
+  if (ok() && !r->range_dels.empty()) {
+    const Comparator* cmp = r->options.comparator;
+    std::sort(r->range_dels.begin(), r->range_dels.end(),
+              [cmp](const std::pair<std::string, std::string>& a,
+                    const std::pair<std::string, std::string>& b) {
+                return cmp->Compare(a.first, b.first) < 0;
+              });
+    BlockBuilder range_del_block(&r->index_block_options);
+    for (const auto& entry : r->range_dels) {
+      range_del_block.Add(entry.first, entry.second);
+    }
+    WriteRawBlock(range_del_block.Finish(), kNoCompression,
+                  &range_del_block_handle);
   }
 
   // Write metaindex block
   if (ok()) {
-    BlockBuilder meta_index_block(&r->options);
+    BlockBuilder meta_index_block(&r->index_block_options);
+    if (!r->compression_dict.empty()) {
+      std::string handle_encoding;
+      dict_block_handle.EncodeTo(&handle_encoding);
+      meta_index_block.Add(kCompressionDictKey, handle_encoding);
+    }
     if (r->filter_block != nullptr) {
       // Add mapping from "filter.Name" to location of filter data
       std::string key = "filter.";
@@ -219,6 +477,29 @@ Status TableBuilder::Finish() {
       std::string handle_encoding;
       filter_block_handle.EncodeTo(&handle_encoding);
       meta_index_block.Add(key, handle_encoding);
+    } else if (r->full_filter != nullptr && !r->partitioned) {
+      // Add mapping from "fullfilter.Name" to location of filter data
+      std::string key = "fullfilter.";
+      key.append(r->options.filter_policy->Name());
+      std::string handle_encoding;
+      filter_block_handle.EncodeTo(&handle_encoding);
+      meta_index_block.Add(key, handle_encoding);
+    }
+    // Keys must be added in sorted order.
+    if (r->partitioned) {
+      meta_index_block.Add("index.partitioned", Slice());
+    }
+    if (!r->range_dels.empty()) {
+      std::string handle_encoding;
+      range_del_block_handle.EncodeTo(&handle_encoding);
+      meta_index_block.Add(kRangeDelKey, handle_encoding);
+    }
+    if (r->partitioned) {
+      if (r->full_filter != nullptr) {
+        std::string key = "partitionedfilter.";
+        key.append(r->options.filter_policy->Name());
+        meta_index_block.Add(key, Slice());
+      }
     }
 
     // TODO(postrelease): Add stats and other meta blocks
@@ -234,7 +515,16 @@ Status TableBuilder::Finish() {
       r->index_block.Add(r->last_key, Slice(handle_encoding));
       r->pending_index_entry = false;
     }
-    WriteBlock(&r->index_block, &index_block_handle);
+    if (r->partitioned) {
+      if (!r->index_block.empty()) {
+        FlushIndexPartition();
+      }
+      if (ok()) {
+        WriteBlock(&r->top_level_index, &index_block_handle);
+      }
+    } else {
+      WriteBlock(&r->index_block, &index_block_handle);
+    }
   }
 
   // Write footer
@@ -242,6 +532,7 @@ Status TableBuilder::Finish() {
     Footer footer;
     footer.set_metaindex_handle(metaindex_block_handle);
     footer.set_index_handle(index_block_handle);
+    footer.set_format_version(r->options.format_version);
     std::string footer_encoding;
     footer.EncodeTo(&footer_encoding);
     r->status = r->file->Append(footer_encoding);
@@ -260,6 +551,25 @@ void TableBuilder::Abandon() {
 
 uint64_t TableBuilder::NumEntries() const { return rep_->num_entries; }
 
-uint64_t TableBuilder::FileSize() const { return rep_->offset; }
+uint64_t TableBuilder::NumRangeDeletions() const {
+  return rep_->range_dels.size();
+}
+
+uint64_t TableBuilder::NumBlocks() const { return rep_->num_blocks; }
+
+uint64_t TableBuilder::NumCompressedBlocks() const {
+  return rep_->num_compressed_blocks;
+}
+
+uint64_t TableBuilder::RawBlockBytes() const { return rep_->raw_block_bytes; }
+
+uint64_t TableBuilder::StoredBlockBytes() const {
+  return rep_->stored_block_bytes;
+}
+
+uint64_t TableBuilder::FileSize() const {
+  // Entries buffered for dictionary training count at their raw size.
+  return rep_->offset + rep_->buffered_entries.size();
+}
 
 }  // namespace leveldb
@@ -4,6 +4,9 @@
 
 #include "table/two_level_iterator.h"
 
+#include <deque>
+#include <vector>
+
 #include "leveldb/table.h"
 #include "table/block.h"
 #include "table/format.h"
@@ -14,11 +17,18 @@ namespace leveldb {
 namespace {
 
 typedef Iterator* (*BlockFunction)(void*, const ReadOptions&, const Slice&);
+typedef void (*BatchBlockFunction)(void*, const ReadOptions&, const Slice*,
+                                   int, Iterator**);
+
+// Number of moves in a row from one block into the next one that make a
+// scan count as sequential.
+static const int kSequentialBlockMoves = 2;
 
 class TwoLevelIterator : public Iterator {
  public:
   TwoLevelIterator(Iterator* index_iter, BlockFunction block_function,
-                   void* arg, const ReadOptions& options);
+                   void* arg, const ReadOptions& options,
+                   BatchBlockFunction batch_function);
 
   ~TwoLevelIterator() override;
 
@@ -56,8 +66,11 @@ class TwoLevelIterator : public Iterator {
   void SkipEmptyDataBlocksBackward();
   void SetDataIterator(Iterator* data_iter);
   void InitDataBlock();
+  void ReadAhead();
+  void ClearReadahead();
 
   BlockFunction block_function_;
+  BatchBlockFunction batch_function_;
   void* arg_;
   const ReadOptions options_;
   Status status_;
@@ -66,20 +79,34 @@ class TwoLevelIterator : public Iterator {
   // If data_iter_ is non-null, then "data_block_handle_" holds the
   // "index_value" passed to block_function_ to create the data_iter_.
   std::string data_block_handle_;
+
+  // Iterators over the blocks read ahead of the current one, in index
+  // order, along with their index values.
+  struct ReadaheadBlock {
+    std::string handle;
+    Iterator* iter;
+  };
+  std::deque<ReadaheadBlock> readahead_;
+  int forward_block_moves_;  // Moves in a row into the next block
 };
 
 TwoLevelIterator::TwoLevelIterator(Iterator* index_iter,
                                    BlockFunction block_function, void* arg,
-                                   const ReadOptions& options)
+                                   const ReadOptions& options,
+                                   BatchBlockFunction batch_function)
     : block_function_(block_function),
+      batch_function_(options.readahead_blocks > 0 ? batch_function
+                                                   : nullptr),
       arg_(arg),
       options_(options),
       index_iter_(index_iter),
-      data_iter_(nullptr) {}
+      data_iter_(nullptr),
+      forward_block_moves_(0) {}
 
-TwoLevelIterator::~TwoLevelIterator() = default;
+TwoLevelIterator::~TwoLevelIterator() { ClearReadahead(); }
 
 void TwoLevelIterator::Seek(const Slice& target) {
+  forward_block_moves_ = 0;
   index_iter_.Seek(target);
   InitDataBlock();
   if (data_iter_.iter() != nullptr) data_iter_.Seek(target);
@@ -87,6 +114,7 @@ void TwoLevelIterator::Seek(const Slice& target) {
 }
 
 void TwoLevelIterator::SeekToFirst() {
+  forward_block_moves_ = 0;
   index_iter_.SeekToFirst();
   InitDataBlock();
   if (data_iter_.iter() != nullptr) data_iter_.SeekToFirst();
@@ -94,6 +122,7 @@ void TwoLevelIterator::SeekToFirst() {
 }
 
 void TwoLevelIterator::SeekToLast() {
+  forward_block_moves_ = 0;
   index_iter_.SeekToLast();
   InitDataBlock();
   if (data_iter_.iter() != nullptr) data_iter_.SeekToLast();
@@ -120,6 +149,10 @@ void TwoLevelIterator::SkipEmptyDataBlocksForward() {
       return;
     }
     index_iter_.Next();
+    if (batch_function_ != nullptr && readahead_.empty() &&
+        ++forward_block_moves_ >= kSequentialBlockMoves) {
+      ReadAhead();
+    }
     InitDataBlock();
     if (data_iter_.iter() != nullptr) data_iter_.SeekToFirst();
   }
@@ -132,6 +165,7 @@ void TwoLevelIterator::SkipEmptyDataBlocksBackward() {
       SetDataIterator(nullptr);
       return;
     }
+    forward_block_moves_ = 0;
     index_iter_.Prev();
     InitDataBlock();
     if (data_iter_.iter() != nullptr) data_iter_.SeekToLast();
@@ -152,7 +186,14 @@ void TwoLevelIterator::InitDataBlock() {
         handle.compare(data_block_handle_) == 0) {
       // data_iter_ is already constructed with this iterator, so
       // no need to change anything
+    } else if (!readahead_.empty() &&
+               handle.compare(readahead_.front().handle) == 0) {
+      SetDataIterator(readahead_.front().iter);
+      data_block_handle_.swap(readahead_.front().handle);
+      readahead_.pop_front();
     } else {
+      // The iterator left the blocks read ahead behind.
+      ClearReadahead();
       Iterator* iter = (*block_function_)(arg_, options_, handle);
       data_block_handle_.assign(handle.data(), handle.size());
       SetDataIterator(iter);
@@ -160,12 +201,54 @@ void TwoLevelIterator::InitDataBlock() {
   }
 }
 
+// Reads the block at index_iter_ and up to options_.readahead_blocks - 1
+// blocks after it.  Leaves index_iter_ where it was.
+void TwoLevelIterator::ReadAhead() {
+  std::vector<std::string> handles;
+  while (index_iter_.Valid() &&
+         static_cast<int>(handles.size()) < options_.readahead_blocks) {
+    const Slice handle = index_iter_.value();
+    handles.emplace_back(handle.data(), handle.size());
+    index_iter_.Next();
+  }
+  // Step back onto the first block.
+  for (size_t i = 0; i < handles.size(); i++) {
+    if (index_iter_.Valid()) {
+      index_iter_.Prev();
+    } else {
+      index_iter_.SeekToLast();
+    }
+  }
+  if (handles.size() < 2 || !index_iter_.status().ok() ||
+      index_iter_.value().compare(handles[0]) != 0) {
+    // Not worth a batch, or the index cannot be walked reliably.
+    return;
+  }
+
+  std::vector<Slice> index_values(handles.begin(), handles.end());
+  std::vector<Iterator*> iters(handles.size());
+  (*batch_function_)(arg_, options_, index_values.data(),
+                     static_cast<int>(index_values.size()), iters.data());
+  for (size_t i = 0; i < handles.size(); i++) {
+    readahead_.push_back(ReadaheadBlock{std::move(handles[i]), iters[i]});
+  }
+}
+
+void TwoLevelIterator::ClearReadahead() {
+  for (const ReadaheadBlock& block : readahead_) {
+    delete block.iter;
+  }
+  readahead_.clear();
+}
+
 }  // namespace
 
 Iterator* NewTwoLevelIterator(Iterator* index_iter,
                               BlockFunction block_function, void* arg,
-                              const ReadOptions& options) {
-  return new TwoLevelIterator(index_iter, block_function, arg, options);
+                              const ReadOptions& options,
+                              BatchBlockFunction batch_function) {
+  return new TwoLevelIterator(index_iter, block_function, arg, options,
+                              batch_function);
 }
 
 }  // namespace leveldb
@@ -20,11 +20,18 @@ struct ReadOptions;
 //
 // Uses a supplied function to convert an index_iter value into
 // an iterator over the contents of the corresponding block.
+//
+// If "batch_function" is non-null and options.readahead_blocks is
+// non-zero, forward scans use it to convert several upcoming index_iter
+// values at once, setting iters[i] to the iterator for index_values[i].
 Iterator* NewTwoLevelIterator(
     Iterator* index_iter,
     Iterator* (*block_function)(void* arg, const ReadOptions& options,
                                 const Slice& index_value),
-    void* arg, const ReadOptions& options);
+    void* arg, const ReadOptions& options,
+    void (*batch_function)(void* arg, const ReadOptions& options,
+                           const Slice* index_values, int n,
+                           Iterator** iters) = nullptr);
 
 }  // namespace leveldb
 
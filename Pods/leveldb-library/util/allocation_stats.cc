@@ -0,0 +1,92 @@
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+
+#include "util/allocation_stats.h"
+
+#include <atomic>
+#include <cstdio>
+
+namespace leveldb {
+
+#if defined(LEVELDB_ALLOCATION_STATS)
+
+namespace {
+
+struct SubsystemCounters {
+  std::atomic<int64_t> live_bytes{0};
+  std::atomic<int64_t> peak_bytes{0};
+  std::atomic<int64_t> live_allocations{0};
+  std::atomic<int64_t> total_allocations{0};
+};
+
+// Trivially destructible, so that frees during static destruction are safe.
+SubsystemCounters counters[kNumAllocationSubsystems];
+
+}  // namespace
+
+namespace allocation_internal {
+
+void Record(AllocationSubsystem subsystem, int64_t bytes, int64_t count) {
+  SubsystemCounters& c = counters[subsystem];
+  const int64_t live =
+      c.live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  c.live_allocations.fetch_add(count, std::memory_order_relaxed);
+  if (count <= 0) {
+    return;
+  }
+  c.total_allocations.fetch_add(count, std::memory_order_relaxed);
+  int64_t peak = c.peak_bytes.load(std::memory_order_relaxed);
+  while (live > peak &&
+         !c.peak_bytes.compare_exchange_weak(peak, live,
+                                             std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace allocation_internal
+
+AllocationCounters GetAllocationCounters(AllocationSubsystem subsystem) {
+  const SubsystemCounters& c = counters[subsystem];
+  AllocationCounters result;
+  result.live_bytes = c.live_bytes.load(std::memory_order_relaxed);
+  result.peak_bytes = c.peak_bytes.load(std::memory_order_relaxed);
+  result.live_allocations = c.live_allocations.load(std::memory_order_relaxed);
+  result.total_allocations =
+      c.total_allocations.load(std::memory_order_relaxed);
+  return result;
+}
+
+#else
+
+AllocationCounters GetAllocationCounters(AllocationSubsystem subsystem) {
+  return AllocationCounters();
+}
+
+#endif  // defined(LEVELDB_ALLOCATION_STATS)
+
+void AppendAllocationStats(std::string* output) {
+#if defined(LEVELDB_ALLOCATION_STATS)
+  static const char* const kNames[kNumAllocationSubsystems] = {"arena",
+                                                               "block-cache"};
+  char buf[200];
+  std::snprintf(buf, sizeof(buf), "%-12s %12s %12s %11s %12s\n", "subsystem",
+                "live", "peak", "live-allocs", "total-allocs");
+  output->append(buf);
+  for (int i = 0; i < kNumAllocationSubsystems; i++) {
+    AllocationCounters c =
+        GetAllocationCounters(static_cast<AllocationSubsystem>(i));
+    std::snprintf(buf, sizeof(buf), "%-12s %12lld %12lld %11lld %12lld\n",
+                  kNames[i], static_cast<long long>(c.live_bytes),
+                  static_cast<long long>(c.peak_bytes),
+                  static_cast<long long>(c.live_allocations),
+                  static_cast<long long>(c.total_allocations));
+    output->append(buf);
+  }
+#else
+  output->append(
+      "allocation stats are not compiled in; build with "
+      "-DLEVELDB_ALLOCATION_STATS\n");
+#endif  // defined(LEVELDB_ALLOCATION_STATS)
+}
+
+}  // namespace leveldb
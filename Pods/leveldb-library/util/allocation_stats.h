@@ -0,0 +1,68 @@
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+//
+// Process wide accounting of the memory held by memtable arenas and by the
+// blocks in block caches, with the most held at any time.  The accounting is
+// compiled out unless leveldb is built with -DLEVELDB_ALLOCATION_STATS, in
+// which case recording costs nothing and the counters stay at zero.
+
+#ifndef STORAGE_LEVELDB_UTIL_ALLOCATION_STATS_H_
+#define STORAGE_LEVELDB_UTIL_ALLOCATION_STATS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace leveldb {
+
+enum AllocationSubsystem {
+  // Blocks of memtable arenas, including those taken from a block pool.
+  kArenaAllocations = 0,
+  // Data, index and filter blocks held by block caches.
+  kBlockCacheAllocations = 1,
+  kNumAllocationSubsystems = 2
+};
+
+struct AllocationCounters {
+  int64_t live_bytes = 0;
+  int64_t peak_bytes = 0;
+  int64_t live_allocations = 0;
+  int64_t total_allocations = 0;
+};
+
+#if defined(LEVELDB_ALLOCATION_STATS)
+
+namespace allocation_internal {
+void Record(AllocationSubsystem subsystem, int64_t bytes, int64_t count);
+}  // namespace allocation_internal
+
+inline void RecordAllocation(AllocationSubsystem subsystem, size_t bytes) {
+  allocation_internal::Record(subsystem, static_cast<int64_t>(bytes), 1);
+}
+
+// Records that "count" allocations totalling "bytes" were freed.
+inline void RecordFree(AllocationSubsystem subsystem, size_t bytes,
+                       size_t count = 1) {
+  allocation_internal::Record(subsystem, -static_cast<int64_t>(bytes),
+                              -static_cast<int64_t>(count));
+}
+
+#else
+
+inline void RecordAllocation(AllocationSubsystem subsystem, size_t bytes) {}
+inline void RecordFree(AllocationSubsystem subsystem, size_t bytes,
+                       size_t count = 1) {}
+
+#endif  // defined(LEVELDB_ALLOCATION_STATS)
+
+// Returns the counters of "subsystem", all zero if the accounting is not
+// compiled in.
+AllocationCounters GetAllocationCounters(AllocationSubsystem subsystem);
+
+// Appends the counters of every subsystem, one per line, to *output.
+void AppendAllocationStats(std::string* output);
+
+}  // namespace leveldb
+
+#endif  // STORAGE_LEVELDB_UTIL_ALLOCATION_STATS_H_
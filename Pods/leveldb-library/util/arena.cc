@@ -4,21 +4,130 @@
 
 #include "util/arena.h"
 
+#if defined(LEVELDB_PLATFORM_POSIX)
+#include <sys/mman.h>
+#endif  // defined(LEVELDB_PLATFORM_POSIX)
+
+#include <cstdlib>
+
+#include "util/allocation_stats.h"
+#include "util/mutexlock.h"
+
 namespace leveldb {
 
 static const int kBlockSize = 4096;
 
+// Size of the huge pages blocks are aligned to.  2MB is the smallest huge
+// page size on the platforms that have them.
+static const size_t kHugePageSize = 2 << 20;
+
+ArenaBlockPool::ArenaBlockPool(size_t block_size, size_t max_free_blocks,
+                               bool huge_pages)
+#if defined(LEVELDB_PLATFORM_POSIX) && defined(MADV_HUGEPAGE)
+    : huge_pages_(huge_pages && block_size % kHugePageSize == 0),
+#else
+    : huge_pages_(false),
+#endif  // defined(LEVELDB_PLATFORM_POSIX) && defined(MADV_HUGEPAGE)
+      block_size_(block_size),
+      max_free_blocks_(max_free_blocks) {
+  assert(block_size_ > 0);
+}
+
+ArenaBlockPool::~ArenaBlockPool() {
+  for (char* block : free_blocks_) {
+    FreeBlock(block);
+  }
+}
+
+char* ArenaBlockPool::Acquire() {
+  {
+    MutexLock l(&mutex_);
+    if (!free_blocks_.empty()) {
+      char* block = free_blocks_.back();
+      free_blocks_.pop_back();
+      return block;
+    }
+  }
+  return NewBlock();
+}
+
+void ArenaBlockPool::Release(char* block) {
+  {
+    MutexLock l(&mutex_);
+    if (free_blocks_.size() < max_free_blocks_) {
+      free_blocks_.push_back(block);
+      return;
+    }
+  }
+  FreeBlock(block);
+}
+
+char* ArenaBlockPool::NewBlock() {
+#if defined(LEVELDB_PLATFORM_POSIX) && defined(MADV_HUGEPAGE)
+  if (huge_pages_) {
+    // Map an extra huge page so that an aligned block fits, then unmap what
+    // lies outside of it.
+    const size_t mapped_size = block_size_ + kHugePageSize;
+    void* mapped = ::mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapped == MAP_FAILED) {
+      std::abort();  // Like new[] failing without exceptions.
+    }
+    char* start = reinterpret_cast<char*>(mapped);
+    char* block = reinterpret_cast<char*>(
+        (reinterpret_cast<uintptr_t>(start) + kHugePageSize - 1) &
+        ~(kHugePageSize - 1));
+    if (block != start) {
+      ::munmap(start, block - start);
+    }
+    char* end = start + mapped_size;
+    if (block + block_size_ != end) {
+      ::munmap(block + block_size_, end - (block + block_size_));
+    }
+    ::madvise(block, block_size_, MADV_HUGEPAGE);
+    return block;
+  }
+#endif  // defined(LEVELDB_PLATFORM_POSIX) && defined(MADV_HUGEPAGE)
+  return new char[block_size_];
+}
+
+void ArenaBlockPool::FreeBlock(char* block) {
+#if defined(LEVELDB_PLATFORM_POSIX) && defined(MADV_HUGEPAGE)
+  if (huge_pages_) {
+    ::munmap(block, block_size_);
+    return;
+  }
+#endif  // defined(LEVELDB_PLATFORM_POSIX) && defined(MADV_HUGEPAGE)
+  delete[] block;
+}
+
 Arena::Arena()
-    : alloc_ptr_(nullptr), alloc_bytes_remaining_(0), memory_usage_(0) {}
+    : alloc_ptr_(nullptr),
+      alloc_bytes_remaining_(0),
+      pool_(nullptr),
+      block_size_(kBlockSize),
+      memory_usage_(0) {}
+
+Arena::Arena(ArenaBlockPool* pool)
+    : alloc_ptr_(nullptr),
+      alloc_bytes_remaining_(0),
+      pool_(pool),
+      block_size_(pool != nullptr ? pool->block_size() : kBlockSize),
+      memory_usage_(0) {}
 
 Arena::~Arena() {
+  RecordFree(kArenaAllocations, MemoryUsage(),
+             blocks_.size() + pool_blocks_.size());
   for (size_t i = 0; i < blocks_.size(); i++) {
     delete[] blocks_[i];
   }
+  for (size_t i = 0; i < pool_blocks_.size(); i++) {
+    pool_->Release(pool_blocks_[i]);
+  }
 }
 
 char* Arena::AllocateFallback(size_t bytes) {
-  if (bytes > kBlockSize / 4) {
+  if (bytes > block_size_ / 4) {
     // Object is more than a quarter of our block size.  Allocate it separately
     // to avoid wasting too much space in leftover bytes.
     char* result = AllocateNewBlock(bytes);
@@ -26,8 +135,16 @@ char* Arena::AllocateFallback(size_t bytes) {
   }
 
   // We waste the remaining space in the current block.
-  alloc_ptr_ = AllocateNewBlock(kBlockSize);
-  alloc_bytes_remaining_ = kBlockSize;
+  if (pool_ != nullptr) {
+    alloc_ptr_ = pool_->Acquire();
+    pool_blocks_.push_back(alloc_ptr_);
+    memory_usage_.fetch_add(block_size_ + sizeof(char*),
+                            std::memory_order_relaxed);
+    RecordAllocation(kArenaAllocations, block_size_ + sizeof(char*));
+  } else {
+    alloc_ptr_ = AllocateNewBlock(block_size_);
+  }
+  alloc_bytes_remaining_ = block_size_;
 
   char* result = alloc_ptr_;
   alloc_ptr_ += bytes;
@@ -55,11 +172,22 @@ char* Arena::AllocateAligned(size_t bytes) {
   return result;
 }
 
+char* Arena::AllocateConcurrently(size_t bytes) {
+  MutexLock l(&concurrent_mutex_);
+  return Allocate(bytes);
+}
+
+char* Arena::AllocateAlignedConcurrently(size_t bytes) {
+  MutexLock l(&concurrent_mutex_);
+  return AllocateAligned(bytes);
+}
+
 char* Arena::AllocateNewBlock(size_t block_bytes) {
   char* result = new char[block_bytes];
   blocks_.push_back(result);
   memory_usage_.fetch_add(block_bytes + sizeof(char*),
                           std::memory_order_relaxed);
+  RecordAllocation(kArenaAllocations, block_bytes + sizeof(char*));
   return result;
 }
 
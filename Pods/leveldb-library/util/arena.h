@@ -11,12 +11,57 @@
 #include <cstdint>
 #include <vector>
 
+#include "port/port.h"
+#include "port/thread_annotations.h"
+
 namespace leveldb {
 
+// Hands out the blocks of the arenas created with it, and keeps the blocks
+// of destroyed arenas for reuse by later ones, so that replacing a memtable
+// does not free and reallocate all of its memory.  Thread-safe.
+class ArenaBlockPool {
+ public:
+  // Blocks are "block_size" bytes, and up to "max_free_blocks" released
+  // blocks are kept for reuse.  If "huge_pages" and "block_size" is a
+  // multiple of 2MB, blocks are aligned on 2MB boundaries and the OS is
+  // asked to back them with huge pages where it supports that.
+  ArenaBlockPool(size_t block_size, size_t max_free_blocks, bool huge_pages);
+
+  ArenaBlockPool(const ArenaBlockPool&) = delete;
+  ArenaBlockPool& operator=(const ArenaBlockPool&) = delete;
+
+  // REQUIRES: All blocks have been released.
+  ~ArenaBlockPool();
+
+  size_t block_size() const { return block_size_; }
+
+  // Returns a block of block_size() bytes.
+  char* Acquire() LOCKS_EXCLUDED(mutex_);
+
+  // Gives back a block returned by Acquire().
+  void Release(char* block) LOCKS_EXCLUDED(mutex_);
+
+ private:
+  char* NewBlock();
+  void FreeBlock(char* block);
+
+  const bool huge_pages_;
+  const size_t block_size_;
+  const size_t max_free_blocks_;
+
+  port::Mutex mutex_;
+  std::vector<char*> free_blocks_ GUARDED_BY(mutex_);
+};
+
 class Arena {
  public:
   Arena();
 
+  // Takes its blocks from "pool", which must outlive the arena.  Only
+  // allocations too large to share a block are made separately.  A null
+  // "pool" gives an arena like Arena().
+  explicit Arena(ArenaBlockPool* pool);
+
   Arena(const Arena&) = delete;
   Arena& operator=(const Arena&) = delete;
 
@@ -28,6 +73,13 @@ class Arena {
   // Allocate memory with the normal alignment guarantees provided by malloc.
   char* AllocateAligned(size_t bytes);
 
+  // Variants of Allocate() and AllocateAligned() that may be called from
+  // several threads at once.  They must not be mixed with concurrent calls
+  // to the unsynchronized variants.
+  char* AllocateConcurrently(size_t bytes) LOCKS_EXCLUDED(concurrent_mutex_);
+  char* AllocateAlignedConcurrently(size_t bytes)
+      LOCKS_EXCLUDED(concurrent_mutex_);
+
   // Returns an estimate of the total memory usage of data allocated
   // by the arena.
   size_t MemoryUsage() const {
@@ -42,14 +94,23 @@ class Arena {
   char* alloc_ptr_;
   size_t alloc_bytes_remaining_;
 
+  ArenaBlockPool* const pool_;  // May be null
+  const size_t block_size_;
+
   // Array of new[] allocated memory blocks
   std::vector<char*> blocks_;
 
+  // Blocks taken from pool_
+  std::vector<char*> pool_blocks_;
+
   // Total memory usage of the arena.
   //
   // TODO(costan): This member is accessed via atomics, but the others are
   //               accessed without any locking. Is this OK?
   std::atomic<size_t> memory_usage_;
+
+  // Serializes the *Concurrently() allocation variants.
+  port::Mutex concurrent_mutex_;
 };
 
 inline char* Arena::Allocate(size_t bytes) {
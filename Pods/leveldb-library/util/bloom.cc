@@ -83,10 +83,94 @@ class BloomFilterPolicy : public FilterPolicy {
   size_t bits_per_key_;
   size_t k_;
 };
+// Splits the filter into 64-byte blocks and sets all the bits for a key
+// within a single block, so that a probe reads one cache line instead of
+// up to k of them.  The filter is built over the keys of a whole table.
+class BlockedBloomFilterPolicy : public FilterPolicy {
+ public:
+  explicit BlockedBloomFilterPolicy(int bits_per_key)
+      : bits_per_key_(bits_per_key) {
+    // Same rounding as BloomFilterPolicy.
+    k_ = static_cast<size_t>(bits_per_key * 0.69);  // 0.69 =~ ln(2)
+    if (k_ < 1) k_ = 1;
+    if (k_ > 30) k_ = 30;
+  }
+
+  const char* Name() const override { return "leveldb.BlockedBloomFilter"; }
+
+  bool UseWholeTableFilter() const override { return true; }
+
+  void CreateFilter(const Slice* keys, int n, std::string* dst) const override {
+    // Round up to a whole number of blocks.
+    const size_t bits = n * bits_per_key_;
+    size_t blocks = (bits + kBlockBits - 1) / kBlockBits;
+    if (blocks < 1) blocks = 1;
+
+    const size_t init_size = dst->size();
+    dst->resize(init_size + blocks * kBlockBytes, 0);
+    dst->push_back(static_cast<char>(k_));  // Remember # of probes in filter
+    char* array = &(*dst)[init_size];
+    for (int i = 0; i < n; i++) {
+      char* block = array + BlockIndex(keys[i], blocks) * kBlockBytes;
+      uint32_t h = BloomHash(keys[i]);
+      const uint32_t delta = (h >> 17) | (h << 15);  // Rotate right 17 bits
+      for (size_t j = 0; j < k_; j++) {
+        const uint32_t bitpos = h % kBlockBits;
+        block[bitpos / 8] |= (1 << (bitpos % 8));
+        h += delta;
+      }
+    }
+  }
+
+  bool KeyMayMatch(const Slice& key, const Slice& bloom_filter) const override {
+    const size_t len = bloom_filter.size();
+    if (len < kBlockBytes + 1 || (len - 1) % kBlockBytes != 0) {
+      // Not a filter written by CreateFilter(); consider it a match.
+      return true;
+    }
+
+    const char* array = bloom_filter.data();
+    const size_t blocks = (len - 1) / kBlockBytes;
+    const size_t k = array[len - 1];
+    if (k > 30) {
+      // Reserved for potentially new encodings.  Consider it a match.
+      return true;
+    }
+
+    const char* block = array + BlockIndex(key, blocks) * kBlockBytes;
+    uint32_t h = BloomHash(key);
+    const uint32_t delta = (h >> 17) | (h << 15);  // Rotate right 17 bits
+    for (size_t j = 0; j < k; j++) {
+      const uint32_t bitpos = h % kBlockBits;
+      if ((block[bitpos / 8] & (1 << (bitpos % 8))) == 0) return false;
+      h += delta;
+    }
+    return true;
+  }
+
+ private:
+  static constexpr size_t kBlockBytes = 64;
+  static constexpr size_t kBlockBits = kBlockBytes * 8;
+
+  // Picks the block from a second, independent hash.  Deriving it from
+  // the probe hash as well correlates the block with the probe positions
+  // inside it and noticeably raises the false positive rate.
+  static size_t BlockIndex(const Slice& key, size_t blocks) {
+    const uint32_t h = Hash(key.data(), key.size(), 0x5bd1e995);
+    return static_cast<size_t>((static_cast<uint64_t>(h) * blocks) >> 32);
+  }
+
+  size_t bits_per_key_;
+  size_t k_;
+};
 }  // namespace
 
 const FilterPolicy* NewBloomFilterPolicy(int bits_per_key) {
   return new BloomFilterPolicy(bits_per_key);
 }
 
+const FilterPolicy* NewBlockedBloomFilterPolicy(int bits_per_key) {
+  return new BlockedBloomFilterPolicy(bits_per_key);
+}
+
 }  // namespace leveldb
@@ -4,9 +4,12 @@
 
 #include "leveldb/cache.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 #include "port/port.h"
 #include "port/thread_annotations.h"
@@ -37,6 +40,11 @@ namespace {
 // Elements are moved between these lists by the Ref() and Unref() methods,
 // when they detect an element in the cache acquiring or losing its only
 // external reference.
+//
+// With midpoint insertion (see NewScanResistantLRUCache), the LRU list is
+// split in two: entries that were looked up since they were inserted are
+// "protected" and go to the protected list when they are released; all
+// others stay on the probationary LRU list, which is evicted from first.
 
 // An entry is a variable length heap-allocated structure.  Entries
 // are kept in a circular doubly linked list ordered by access time.
@@ -49,6 +57,7 @@ struct LRUHandle {
   size_t charge;  // TODO(opt): Only allow uint32_t?
   size_t key_length;
   bool in_cache;     // Whether entry is in the cache.
+  bool is_protected;  // Whether entry was hit since its insertion.
   uint32_t refs;     // References, including cache reference, if present.
   uint32_t hash;     // Hash of key(); used for fast sharding and comparisons
   char key_data[1];  // Beginning of key
@@ -156,6 +165,13 @@ class LRUCache {
   // Separate from constructor so caller can easily make an array of LRUCache
   void SetCapacity(size_t capacity) { capacity_ = capacity; }
 
+  // Enables midpoint insertion, with at most protected_capacity of charge
+  // in protected entries.
+  void SetProtectedCapacity(size_t protected_capacity) {
+    midpoint_insertion_ = true;
+    protected_capacity_ = protected_capacity;
+  }
+
   // Like Cache methods, but with an extra "hash" parameter.
   Cache::Handle* Insert(const Slice& key, uint32_t hash, void* value,
                         size_t charge,
@@ -175,19 +191,31 @@ class LRUCache {
   void Ref(LRUHandle* e);
   void Unref(LRUHandle* e);
   bool FinishErase(LRUHandle* e) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void Protect(LRUHandle* e) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void DemoteProtected() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  LRUHandle* OldestUnused() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
   // Initialized before use.
   size_t capacity_;
+  bool midpoint_insertion_;
+  size_t protected_capacity_;
 
   // mutex_ protects the following state.
   mutable port::Mutex mutex_;
   size_t usage_ GUARDED_BY(mutex_);
+  // Charge of the protected entries, in use or not.
+  size_t protected_usage_ GUARDED_BY(mutex_);
 
   // Dummy head of LRU list.
   // lru.prev is newest entry, lru.next is oldest entry.
   // Entries have refs==1 and in_cache==true.
   LRUHandle lru_ GUARDED_BY(mutex_);
 
+  // Dummy head of the protected list, ordered like lru_ and only used with
+  // midpoint insertion.
+  // Entries have refs==1, in_cache==true and is_protected==true.
+  LRUHandle protected_ GUARDED_BY(mutex_);
+
   // Dummy head of in-use list.
   // Entries are in use by clients, and have refs >= 2 and in_cache==true.
   LRUHandle in_use_ GUARDED_BY(mutex_);
@@ -195,23 +223,32 @@ class LRUCache {
   HandleTable table_ GUARDED_BY(mutex_);
 };
 
-LRUCache::LRUCache() : capacity_(0), usage_(0) {
+LRUCache::LRUCache()
+    : capacity_(0),
+      midpoint_insertion_(false),
+      protected_capacity_(0),
+      usage_(0),
+      protected_usage_(0) {
   // Make empty circular linked lists.
   lru_.next = &lru_;
   lru_.prev = &lru_;
+  protected_.next = &protected_;
+  protected_.prev = &protected_;
   in_use_.next = &in_use_;
   in_use_.prev = &in_use_;
 }
 
 LRUCache::~LRUCache() {
   assert(in_use_.next == &in_use_);  // Error if caller has an unreleased handle
-  for (LRUHandle* e = lru_.next; e != &lru_;) {
-    LRUHandle* next = e->next;
-    assert(e->in_cache);
-    e->in_cache = false;
-    assert(e->refs == 1);  // Invariant of lru_ list.
-    Unref(e);
-    e = next;
+  for (LRUHandle* list : {&lru_, &protected_}) {
+    for (LRUHandle* e = list->next; e != list;) {
+      LRUHandle* next = e->next;
+      assert(e->in_cache);
+      e->in_cache = false;
+      assert(e->refs == 1);  // Invariant of lru_ and protected_ lists.
+      Unref(e);
+      e = next;
+    }
   }
 }
 
@@ -231,12 +268,40 @@ void LRUCache::Unref(LRUHandle* e) {
     (*e->deleter)(e->key(), e->value);
     free(e);
   } else if (e->in_cache && e->refs == 1) {
-    // No longer in use; move to lru_ list.
+    // No longer in use; move to lru_ list, or to protected_ if it was hit.
     LRU_Remove(e);
+    LRU_Append(e->is_protected ? &protected_ : &lru_, e);
+    DemoteProtected();
+  }
+}
+
+void LRUCache::Protect(LRUHandle* e) {
+  if (midpoint_insertion_ && e->in_cache && !e->is_protected) {
+    e->is_protected = true;
+    protected_usage_ += e->charge;
+  }
+}
+
+void LRUCache::DemoteProtected() {
+  // Only unused entries can be demoted, so protected_usage_ may stay above
+  // protected_capacity_ while clients hold on to protected entries.
+  while (protected_usage_ > protected_capacity_ &&
+         protected_.next != &protected_) {
+    LRUHandle* e = protected_.next;
+    LRU_Remove(e);
+    e->is_protected = false;
+    protected_usage_ -= e->charge;
+    // Demoted entries are the newest probationary ones.
     LRU_Append(&lru_, e);
   }
 }
 
+LRUHandle* LRUCache::OldestUnused() {
+  if (lru_.next != &lru_) return lru_.next;
+  if (protected_.next != &protected_) return protected_.next;
+  return nullptr;
+}
+
 void LRUCache::LRU_Remove(LRUHandle* e) {
   e->next->prev = e->prev;
   e->prev->next = e->next;
@@ -254,6 +319,7 @@ Cache::Handle* LRUCache::Lookup(const Slice& key, uint32_t hash) {
   MutexLock l(&mutex_);
   LRUHandle* e = table_.Lookup(key, hash);
   if (e != nullptr) {
+    Protect(e);
     Ref(e);
   }
   return reinterpret_cast<Cache::Handle*>(e);
@@ -278,6 +344,7 @@ Cache::Handle* LRUCache::Insert(const Slice& key, uint32_t hash, void* value,
   e->key_length = key.size();
   e->hash = hash;
   e->in_cache = false;
+  e->is_protected = false;
   e->refs = 1;  // for the returned handle.
   std::memcpy(e->key_data, key.data(), key.size());
 
@@ -291,8 +358,8 @@ Cache::Handle* LRUCache::Insert(const Slice& key, uint32_t hash, void* value,
     // next is read by key() in an assert, so it must be initialized
     e->next = nullptr;
   }
-  while (usage_ > capacity_ && lru_.next != &lru_) {
-    LRUHandle* old = lru_.next;
+  LRUHandle* old;
+  while (usage_ > capacity_ && (old = OldestUnused()) != nullptr) {
     assert(old->refs == 1);
     bool erased = FinishErase(table_.Remove(old->key(), old->hash));
     if (!erased) {  // to avoid unused variable when compiled NDEBUG
@@ -311,6 +378,9 @@ bool LRUCache::FinishErase(LRUHandle* e) {
     LRU_Remove(e);
     e->in_cache = false;
     usage_ -= e->charge;
+    if (e->is_protected) {
+      protected_usage_ -= e->charge;
+    }
     Unref(e);
   }
   return e != nullptr;
@@ -323,8 +393,8 @@ void LRUCache::Erase(const Slice& key, uint32_t hash) {
 
 void LRUCache::Prune() {
   MutexLock l(&mutex_);
-  while (lru_.next != &lru_) {
-    LRUHandle* e = lru_.next;
+  LRUHandle* e;
+  while ((e = OldestUnused()) != nullptr) {
     assert(e->refs == 1);
     bool erased = FinishErase(table_.Remove(e->key(), e->hash));
     if (!erased) {  // to avoid unused variable when compiled NDEBUG
@@ -333,12 +403,23 @@ void LRUCache::Prune() {
   }
 }
 
-static const int kNumShardBits = 4;
-static const int kNumShards = 1 << kNumShardBits;
+static const int kDefaultNumShardBits = 4;
+static const int kMaxNumShardBits = 16;
+
+// Share of a scan resistant cache's capacity left to probationary entries.
+static const double kDefaultProbationRatio = 0.375;
+
+static int SanitizeNumShardBits(int num_shard_bits) {
+  if (num_shard_bits < 0) return kDefaultNumShardBits;
+  if (num_shard_bits > kMaxNumShardBits) return kMaxNumShardBits;
+  return num_shard_bits;
+}
 
 class ShardedLRUCache : public Cache {
  private:
-  LRUCache shard_[kNumShards];
+  const int num_shard_bits_;
+  const int num_shards_;
+  LRUCache* const shard_;
   port::Mutex id_mutex_;
   uint64_t last_id_;
 
@@ -346,16 +427,28 @@ class ShardedLRUCache : public Cache {
     return Hash(s.data(), s.size(), 0);
   }
 
-  static uint32_t Shard(uint32_t hash) { return hash >> (32 - kNumShardBits); }
+  uint32_t Shard(uint32_t hash) const {
+    return num_shard_bits_ == 0 ? 0 : hash >> (32 - num_shard_bits_);
+  }
 
  public:
-  explicit ShardedLRUCache(size_t capacity) : last_id_(0) {
-    const size_t per_shard = (capacity + (kNumShards - 1)) / kNumShards;
-    for (int s = 0; s < kNumShards; s++) {
+  // A probation_ratio in (0, 1) enables midpoint insertion.
+  ShardedLRUCache(size_t capacity, int num_shard_bits,
+                  double probation_ratio = 0)
+      : num_shard_bits_(SanitizeNumShardBits(num_shard_bits)),
+        num_shards_(1 << num_shard_bits_),
+        shard_(new LRUCache[num_shards_]),
+        last_id_(0) {
+    const size_t per_shard = (capacity + (num_shards_ - 1)) / num_shards_;
+    for (int s = 0; s < num_shards_; s++) {
       shard_[s].SetCapacity(per_shard);
+      if (probation_ratio > 0 && probation_ratio < 1) {
+        shard_[s].SetProtectedCapacity(
+            static_cast<size_t>(per_shard * (1 - probation_ratio)));
+      }
     }
   }
-  ~ShardedLRUCache() override {}
+  ~ShardedLRUCache() override { delete[] shard_; }
   Handle* Insert(const Slice& key, void* value, size_t charge,
                  void (*deleter)(const Slice& key, void* value)) override {
     const uint32_t hash = HashSlice(key);
@@ -381,13 +474,498 @@ class ShardedLRUCache : public Cache {
     return ++(last_id_);
   }
   void Prune() override {
-    for (int s = 0; s < kNumShards; s++) {
+    for (int s = 0; s < num_shards_; s++) {
+      shard_[s].Prune();
+    }
+  }
+  size_t TotalCharge() const override {
+    size_t total = 0;
+    for (int s = 0; s < num_shards_; s++) {
+      total += shard_[s].TotalCharge();
+    }
+    return total;
+  }
+};
+
+// CLOCK cache implementation
+//
+// Each shard stores its entries directly in a fixed-size open-addressed
+// table.  The state of an entry, its reference count and its CLOCK counter
+// all live in one atomic word ("meta"), so a lookup takes a reference with
+// a single fetch_add and a release drops it with another; neither touches a
+// mutex or any list.
+//
+// The meta word holds, from the low bits up:
+// - a 30-bit acquire counter, bumped by every Lookup() for the entry,
+// - a 30-bit release counter, bumped by every Release(),
+// - a 3-bit state: empty, under construction, visible (can be found by
+//   Lookup) or invisible (erased, but still referenced by clients).
+// The number of outstanding references is acquire - release.  When the clock
+// hand passes an unreferenced visible entry, it resets both counters to
+// min(acquire - 1, kMaxCountdown - 1).  Every hit since the last pass thus
+// buys the entry another pass, up to kMaxCountdown, and an entry whose
+// counters have reached zero is evicted.
+//
+// An entry can only leave the shareable (visible or invisible) states
+// through a compare-and-swap from a meta word with no references, so a
+// client holding a reference may read the entry's fields without locking.
+//
+// Since the table cannot shrink its probe sequences on removal, every slot
+// also counts how many entries are stored past it on their probe sequence
+// ("displacements").  A lookup stops at the first slot with no
+// displacements.
+struct ClockHandle {
+  std::atomic<uint64_t> meta{0};
+  std::atomic<uint32_t> displacements{0};
+  uint32_t hash = 0;  // Hash of key(); used for probing and sharding
+  void* value = nullptr;
+  void (*deleter)(const Slice&, void* value) = nullptr;
+  size_t charge = 0;
+  size_t key_length = 0;
+  char* key_data = nullptr;  // Points at key_inline unless the key is long
+  char key_inline[16];
+
+  Slice key() const { return Slice(key_data, key_length); }
+
+  void SetKey(const Slice& k) {
+    key_length = k.size();
+    key_data = k.size() <= sizeof(key_inline)
+                   ? key_inline
+                   : reinterpret_cast<char*>(malloc(k.size()));
+    std::memcpy(key_data, k.data(), k.size());
+  }
+
+  void FreeKey() {
+    if (key_data != key_inline) free(key_data);
+    key_data = nullptr;
+  }
+};
+
+static const int kCounterBits = 30;
+static const uint64_t kCounterMask = (uint64_t{1} << kCounterBits) - 1;
+static const int kAcquireShift = 0;
+static const int kReleaseShift = kCounterBits;
+static const uint64_t kAcquireIncrement = uint64_t{1} << kAcquireShift;
+static const uint64_t kReleaseIncrement = uint64_t{1} << kReleaseShift;
+static const int kStateShift = 2 * kCounterBits + 1;
+
+static const uint64_t kStateOccupiedBit = 1;
+static const uint64_t kStateShareableBit = 2;
+static const uint64_t kStateVisibleBit = 4;
+static const uint64_t kStateEmpty = 0;
+static const uint64_t kStateConstruction = kStateOccupiedBit;
+static const uint64_t kStateInvisible = kStateOccupiedBit | kStateShareableBit;
+static const uint64_t kStateVisible =
+    kStateOccupiedBit | kStateShareableBit | kStateVisibleBit;
+
+// Number of clock passes an entry survives after being hit.
+static const uint64_t kMaxCountdown = 3;
+// Counter value new entries start with: evicted on the second pass unless
+// they are hit in between.
+static const uint64_t kInitialCountdown = 1;
+// Counters are shifted back down once the acquire counter reaches this, so
+// that hot entries never overflow into the release counter.
+static const uint64_t kCounterResetThreshold = uint64_t{1} << (kCounterBits - 1);
+
+// Entries per table slot when the table is sized, and the limit above which
+// an insertion must evict before it may claim a slot.
+static const double kLoadFactor = 0.7;
+static const double kStrictLoadFactor = 0.84;
+
+static inline uint64_t AcquireCount(uint64_t meta) {
+  return (meta >> kAcquireShift) & kCounterMask;
+}
+static inline uint64_t ReleaseCount(uint64_t meta) {
+  return (meta >> kReleaseShift) & kCounterMask;
+}
+static inline uint64_t StateOf(uint64_t meta) { return meta >> kStateShift; }
+static inline uint64_t MakeMeta(uint64_t state, uint64_t acquire,
+                                uint64_t release) {
+  return (state << kStateShift) | (acquire << kAcquireShift) |
+         (release << kReleaseShift);
+}
+
+// A single shard of sharded clock cache.
+class ClockCacheShard {
+ public:
+  ClockCacheShard();
+  ~ClockCacheShard();
+
+  // Separate from constructor so caller can easily make an array of
+  // ClockCacheShard.
+  void Init(size_t capacity, size_t estimated_entry_charge);
+
+  // Like Cache methods, but with an extra "hash" parameter.
+  Cache::Handle* Insert(const Slice& key, uint32_t hash, void* value,
+                        size_t charge,
+                        void (*deleter)(const Slice& key, void* value));
+  Cache::Handle* Lookup(const Slice& key, uint32_t hash);
+  void Release(Cache::Handle* handle);
+  void Erase(const Slice& key, uint32_t hash);
+  void Prune();
+  size_t TotalCharge() const {
+    return usage_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  uint32_t ProbeStart(uint32_t hash) const { return hash & length_mask_; }
+  static uint32_t ProbeIncrement(uint32_t hash) {
+    // Odd, so that probing visits every slot of the power-of-two table.
+    return ((hash * 0x85ebca6bu) >> 7) | 1;
+  }
+  uint32_t ProbeNext(uint32_t index, uint32_t hash) const {
+    return (index + ProbeIncrement(hash)) & length_mask_;
+  }
+
+  bool IsStandalone(const ClockHandle* h) const {
+    return h < table_ || h >= table_ + length_;
+  }
+
+  // Try to claim the empty slot *h for an insertion.
+  static bool TryClaim(ClockHandle* h) {
+    uint64_t old = h->meta.fetch_or(kStateOccupiedBit << kStateShift,
+                                    std::memory_order_acq_rel);
+    return StateOf(old) == kStateEmpty;
+  }
+
+  // Advance the clock hand over one slot.  Returns true if an entry was
+  // evicted.
+  bool ClockStep() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Evict entries until "charge" more fits within the capacity and a table
+  // slot is available, or until every entry has had its chance.
+  void EvictForInsert(size_t charge) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // If *h holds no references, take it over for destruction.  "meta" is
+  // the last value read from h->meta.
+  static bool TryTakeForFree(ClockHandle* h, uint64_t meta) {
+    return h->meta.compare_exchange_strong(
+        meta, MakeMeta(kStateConstruction, 0, 0), std::memory_order_acquire,
+        std::memory_order_relaxed);
+  }
+
+  // Destroy the entry in *h and return the slot to the empty state.
+  // REQUIRES: *h is under construction and owned by the caller.
+  void FreeSlot(ClockHandle* h);
+
+  // Shift the counters of *h down once they grow large.
+  static void CorrectNearOverflow(ClockHandle* h, uint64_t meta);
+
+  // Initialized before use.
+  size_t capacity_;
+  size_t occupancy_limit_;
+  uint32_t length_;
+  uint32_t length_mask_;
+  ClockHandle* table_;
+
+  std::atomic<size_t> usage_;
+  std::atomic<uint32_t> occupancy_;
+
+  // mutex_ serializes insertions and eviction.  Lookup(), Release() and
+  // Erase() never take it.
+  port::Mutex mutex_;
+  uint32_t clock_pointer_ GUARDED_BY(mutex_);
+};
+
+ClockCacheShard::ClockCacheShard()
+    : capacity_(0),
+      occupancy_limit_(0),
+      length_(0),
+      length_mask_(0),
+      table_(nullptr),
+      usage_(0),
+      occupancy_(0),
+      clock_pointer_(0) {}
+
+ClockCacheShard::~ClockCacheShard() {
+  for (uint32_t i = 0; i < length_; i++) {
+    ClockHandle* h = &table_[i];
+    const uint64_t meta = h->meta.load(std::memory_order_acquire);
+    if ((StateOf(meta) & kStateShareableBit) != 0) {
+      // Error if caller has an unreleased handle
+      assert(AcquireCount(meta) == ReleaseCount(meta));
+      (*h->deleter)(h->key(), h->value);
+      h->FreeKey();
+    }
+  }
+  delete[] table_;
+}
+
+void ClockCacheShard::Init(size_t capacity, size_t estimated_entry_charge) {
+  assert(table_ == nullptr);
+  if (estimated_entry_charge == 0) estimated_entry_charge = 1;
+  const double entries =
+      static_cast<double>(capacity) / estimated_entry_charge / kLoadFactor;
+  uint32_t length = 16;
+  while (length < entries && length < (uint32_t{1} << 30)) {
+    length *= 2;
+  }
+  capacity_ = capacity;
+  length_ = length;
+  length_mask_ = length - 1;
+  occupancy_limit_ = static_cast<size_t>(length * kStrictLoadFactor);
+  table_ = new ClockHandle[length];
+}
+
+Cache::Handle* ClockCacheShard::Lookup(const Slice& key, uint32_t hash) {
+  uint32_t index = ProbeStart(hash);
+  for (uint32_t probes = 0; probes < length_; probes++) {
+    ClockHandle* h = &table_[index];
+    uint64_t meta = h->meta.load(std::memory_order_acquire);
+    if ((StateOf(meta) & kStateShareableBit) != 0) {
+      meta = h->meta.fetch_add(kAcquireIncrement, std::memory_order_acquire);
+      const uint64_t state = StateOf(meta);
+      if (state == kStateVisible) {
+        if (h->hash == hash && h->key() == key) {
+          return reinterpret_cast<Cache::Handle*>(h);
+        }
+        h->meta.fetch_sub(kAcquireIncrement, std::memory_order_release);
+      } else if (state == kStateInvisible) {
+        h->meta.fetch_sub(kAcquireIncrement, std::memory_order_release);
+      }
+      // Otherwise the slot left the shareable states before our increment.
+      // Counters of empty slots and slots under construction are
+      // overwritten when the slot is filled, so there is nothing to undo
+      // (and undoing could corrupt the new entry).
+    }
+    if (h->displacements.load(std::memory_order_relaxed) == 0) {
+      break;
+    }
+    index = ProbeNext(index, hash);
+  }
+  return nullptr;
+}
+
+void ClockCacheShard::Release(Cache::Handle* handle) {
+  ClockHandle* h = reinterpret_cast<ClockHandle*>(handle);
+  if (IsStandalone(h)) {
+    (*h->deleter)(h->key(), h->value);
+    h->FreeKey();
+    delete h;
+    return;
+  }
+  uint64_t meta =
+      h->meta.fetch_add(kReleaseIncrement, std::memory_order_acq_rel) +
+      kReleaseIncrement;
+  assert(AcquireCount(meta) >= ReleaseCount(meta));
+  if (StateOf(meta) == kStateInvisible &&
+      AcquireCount(meta) == ReleaseCount(meta)) {
+    // Last reference to an erased entry.
+    if (TryTakeForFree(h, meta)) {
+      FreeSlot(h);
+    }
+  } else if (AcquireCount(meta) >= kCounterResetThreshold) {
+    CorrectNearOverflow(h, meta);
+  }
+}
+
+void ClockCacheShard::CorrectNearOverflow(ClockHandle* h, uint64_t meta) {
+  while (AcquireCount(meta) >= kCounterResetThreshold &&
+         ReleaseCount(meta) > kMaxCountdown) {
+    // Keep the reference count and the maximum countdown.
+    const uint64_t shift = ReleaseCount(meta) - kMaxCountdown;
+    const uint64_t updated =
+        meta - shift * kAcquireIncrement - shift * kReleaseIncrement;
+    if (h->meta.compare_exchange_weak(meta, updated,
+                                      std::memory_order_relaxed)) {
+      break;
+    }
+  }
+}
+
+Cache::Handle* ClockCacheShard::Insert(const Slice& key, uint32_t hash,
+                                       void* value, size_t charge,
+                                       void (*deleter)(const Slice& key,
+                                                       void* value)) {
+  MutexLock l(&mutex_);
+
+  // Replace any existing mapping for key.
+  Erase(key, hash);
+
+  ClockHandle* e = nullptr;
+  if (capacity_ > 0) {
+    EvictForInsert(charge);
+    if (occupancy_.load(std::memory_order_relaxed) < occupancy_limit_) {
+      uint32_t index = ProbeStart(hash);
+      uint32_t probes = 0;
+      for (; probes < length_; probes++) {
+        ClockHandle* h = &table_[index];
+        if (TryClaim(h)) {
+          e = h;
+          break;
+        }
+        h->displacements.fetch_add(1, std::memory_order_relaxed);
+        index = ProbeNext(index, hash);
+      }
+      if (e == nullptr) {
+        // Slots freed by other threads may not be empty yet.
+        index = ProbeStart(hash);
+        for (uint32_t i = 0; i < probes; i++) {
+          table_[index].displacements.fetch_sub(1, std::memory_order_relaxed);
+          index = ProbeNext(index, hash);
+        }
+      }
+    }
+  }
+
+  if (e == nullptr) {
+    // Don't cache: the shard is disabled, or full of referenced entries.
+    e = new ClockHandle;
+  }
+  e->hash = hash;
+  e->value = value;
+  e->deleter = deleter;
+  e->charge = charge;
+  e->SetKey(key);
+
+  if (IsStandalone(e)) {
+    e->meta.store(MakeMeta(kStateInvisible, 1, 0), std::memory_order_relaxed);
+  } else {
+    usage_.fetch_add(charge, std::memory_order_relaxed);
+    occupancy_.fetch_add(1, std::memory_order_relaxed);
+    // One reference for the returned handle.
+    e->meta.store(
+        MakeMeta(kStateVisible, kInitialCountdown + 1, kInitialCountdown),
+        std::memory_order_release);
+  }
+  return reinterpret_cast<Cache::Handle*>(e);
+}
+
+bool ClockCacheShard::ClockStep() {
+  ClockHandle* h = &table_[clock_pointer_];
+  clock_pointer_ = (clock_pointer_ + 1) & length_mask_;
+
+  const uint64_t meta = h->meta.load(std::memory_order_relaxed);
+  const uint64_t state = StateOf(meta);
+  if ((state & kStateShareableBit) == 0) {
+    return false;
+  }
+  const uint64_t acquire = AcquireCount(meta);
+  if (acquire != ReleaseCount(meta)) {
+    return false;  // In use
+  }
+  if (state == kStateVisible && acquire > 0) {
+    // Used since the last pass (or still new); count down instead.
+    const uint64_t countdown = std::min(acquire - 1, kMaxCountdown - 1);
+    uint64_t expected = meta;
+    h->meta.compare_exchange_strong(
+        expected, MakeMeta(kStateVisible, countdown, countdown),
+        std::memory_order_relaxed);
+    return false;
+  }
+  if (TryTakeForFree(h, meta)) {
+    FreeSlot(h);
+    return true;
+  }
+  return false;
+}
+
+void ClockCacheShard::EvictForInsert(size_t charge) {
+  const uint32_t max_steps = length_ * (kMaxCountdown + 1);
+  for (uint32_t steps = 0; steps < max_steps; steps++) {
+    if (usage_.load(std::memory_order_relaxed) + charge <= capacity_ &&
+        occupancy_.load(std::memory_order_relaxed) < occupancy_limit_) {
+      break;
+    }
+    ClockStep();
+  }
+}
+
+void ClockCacheShard::FreeSlot(ClockHandle* h) {
+  // Undo the displacements recorded by the insertion of *h.
+  uint32_t index = ProbeStart(h->hash);
+  while (&table_[index] != h) {
+    table_[index].displacements.fetch_sub(1, std::memory_order_relaxed);
+    index = ProbeNext(index, h->hash);
+  }
+  usage_.fetch_sub(h->charge, std::memory_order_relaxed);
+  (*h->deleter)(h->key(), h->value);
+  h->FreeKey();
+  h->meta.store(MakeMeta(kStateEmpty, 0, 0), std::memory_order_release);
+  occupancy_.fetch_sub(1, std::memory_order_release);
+}
+
+void ClockCacheShard::Erase(const Slice& key, uint32_t hash) {
+  Cache::Handle* handle = Lookup(key, hash);
+  if (handle != nullptr) {
+    ClockHandle* h = reinterpret_cast<ClockHandle*>(handle);
+    h->meta.fetch_and(~(kStateVisibleBit << kStateShift),
+                      std::memory_order_acq_rel);
+    Release(handle);
+  }
+}
+
+void ClockCacheShard::Prune() {
+  MutexLock l(&mutex_);
+  for (uint32_t i = 0; i < length_; i++) {
+    ClockHandle* h = &table_[i];
+    const uint64_t meta = h->meta.load(std::memory_order_relaxed);
+    if ((StateOf(meta) & kStateShareableBit) != 0 &&
+        AcquireCount(meta) == ReleaseCount(meta) && TryTakeForFree(h, meta)) {
+      FreeSlot(h);
+    }
+  }
+}
+
+class ShardedClockCache : public Cache {
+ private:
+  const int num_shard_bits_;
+  const int num_shards_;
+  ClockCacheShard* const shard_;
+  std::atomic<uint64_t> last_id_;
+
+  static inline uint32_t HashSlice(const Slice& s) {
+    return Hash(s.data(), s.size(), 0);
+  }
+
+  uint32_t Shard(uint32_t hash) const {
+    return num_shard_bits_ == 0 ? 0 : hash >> (32 - num_shard_bits_);
+  }
+
+ public:
+  ShardedClockCache(size_t capacity, size_t estimated_entry_charge,
+                    int num_shard_bits)
+      : num_shard_bits_(SanitizeNumShardBits(num_shard_bits)),
+        num_shards_(1 << num_shard_bits_),
+        shard_(new ClockCacheShard[num_shards_]),
+        last_id_(0) {
+    const size_t per_shard = (capacity + (num_shards_ - 1)) / num_shards_;
+    for (int s = 0; s < num_shards_; s++) {
+      shard_[s].Init(per_shard, estimated_entry_charge);
+    }
+  }
+  ~ShardedClockCache() override { delete[] shard_; }
+  Handle* Insert(const Slice& key, void* value, size_t charge,
+                 void (*deleter)(const Slice& key, void* value)) override {
+    const uint32_t hash = HashSlice(key);
+    return shard_[Shard(hash)].Insert(key, hash, value, charge, deleter);
+  }
+  Handle* Lookup(const Slice& key) override {
+    const uint32_t hash = HashSlice(key);
+    return shard_[Shard(hash)].Lookup(key, hash);
+  }
+  void Release(Handle* handle) override {
+    ClockHandle* h = reinterpret_cast<ClockHandle*>(handle);
+    shard_[Shard(h->hash)].Release(handle);
+  }
+  void Erase(const Slice& key) override {
+    const uint32_t hash = HashSlice(key);
+    shard_[Shard(hash)].Erase(key, hash);
+  }
+  void* Value(Handle* handle) override {
+    return reinterpret_cast<ClockHandle*>(handle)->value;
+  }
+  uint64_t NewId() override {
+    return last_id_.fetch_add(1, std::memory_order_relaxed) + 1;
+  }
+  void Prune() override {
+    for (int s = 0; s < num_shards_; s++) {
       shard_[s].Prune();
     }
   }
   size_t TotalCharge() const override {
     size_t total = 0;
-    for (int s = 0; s < kNumShards; s++) {
+    for (int s = 0; s < num_shards_; s++) {
       total += shard_[s].TotalCharge();
     }
     return total;
@@ -396,6 +974,26 @@ class ShardedLRUCache : public Cache {
 
 }  // end anonymous namespace
 
-Cache* NewLRUCache(size_t capacity) { return new ShardedLRUCache(capacity); }
+Cache* NewLRUCache(size_t capacity) {
+  return new ShardedLRUCache(capacity, kDefaultNumShardBits);
+}
+
+Cache* NewLRUCache(size_t capacity, int num_shard_bits) {
+  return new ShardedLRUCache(capacity, num_shard_bits);
+}
+
+Cache* NewScanResistantLRUCache(size_t capacity, double probation_ratio,
+                                int num_shard_bits) {
+  if (!(probation_ratio > 0 && probation_ratio < 1)) {
+    probation_ratio = kDefaultProbationRatio;
+  }
+  return new ShardedLRUCache(capacity, num_shard_bits, probation_ratio);
+}
+
+Cache* NewClockCache(size_t capacity, size_t estimated_entry_charge,
+                     int num_shard_bits) {
+  return new ShardedClockCache(capacity, estimated_entry_charge,
+                               num_shard_bits);
+}
 
 }  // namespace leveldb
@@ -22,6 +22,13 @@ Status Env::NewAppendableFile(const std::string& fname, WritableFile** result) {
   return Status::NotSupported("NewAppendableFile", fname);
 }
 
+Status Env::NewUncachedRandomAccessFile(const std::string& fname,
+                                        RandomAccessFile** result) {
+  return NewRandomAccessFile(fname, result);
+}
+
+void Env::SetBackgroundThreads(int number) {}
+
 Status Env::RemoveDir(const std::string& dirname) { return DeleteDir(dirname); }
 Status Env::DeleteDir(const std::string& dirname) { return RemoveDir(dirname); }
 
@@ -32,8 +39,19 @@ SequentialFile::~SequentialFile() = default;
 
 RandomAccessFile::~RandomAccessFile() = default;
 
+void RandomAccessFile::MultiRead(ReadRequest* reqs, size_t num_reqs) const {
+  for (size_t i = 0; i < num_reqs; i++) {
+    ReadRequest* req = &reqs[i];
+    req->status = Read(req->offset, req->n, &req->result, req->scratch);
+  }
+}
+
+void RandomAccessFile::Hint(AccessPattern pattern) {}
+
 WritableFile::~WritableFile() = default;
 
+Status WritableFile::SyncBarrier() { return Sync(); }
+
 Logger::~Logger() = default;
 
 FileLock::~FileLock() = default;
@@ -12,6 +12,12 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#if defined(HAVE_IO_URING)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif  // defined(HAVE_IO_URING)
+
+#include <algorithm>
 #include <atomic>
 #include <cerrno>
 #include <cstddef>
@@ -20,6 +26,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <limits>
+#include <memory>
 #include <queue>
 #include <set>
 #include <string>
@@ -33,6 +40,7 @@
 #include "port/port.h"
 #include "port/thread_annotations.h"
 #include "util/env_posix_test_helper.h"
+#include "util/mutexlock.h"
 #include "util/posix_logger.h"
 
 namespace leveldb {
@@ -55,6 +63,16 @@ constexpr const int kOpenBaseFlags = O_CLOEXEC;
 constexpr const int kOpenBaseFlags = 0;
 #endif  // defined(HAVE_O_CLOEXEC)
 
+// Flag passed to open() for files whose reads bypass the page cache.
+#if defined(O_DIRECT)
+constexpr const int kUncachedOpenFlags = O_DIRECT;
+#else
+constexpr const int kUncachedOpenFlags = 0;
+#endif  // defined(O_DIRECT)
+
+// Alignment of the offset, size and buffer of reads from O_DIRECT files.
+constexpr const size_t kDirectIOAlignment = 4096;
+
 constexpr const size_t kWritableFileBufferSize = 65536;
 
 Status PosixError(const std::string& context, int error_number) {
@@ -65,6 +83,38 @@ Status PosixError(const std::string& context, int error_number) {
   }
 }
 
+// Opens |filename| for reads that bypass the page cache where the platform
+// supports it.  Returns the file descriptor, or -1 with errno set.
+int OpenUncached(const std::string& filename) {
+  int fd =
+      ::open(filename.c_str(), O_RDONLY | kOpenBaseFlags | kUncachedOpenFlags);
+#if defined(F_NOCACHE)
+  if (fd >= 0) {
+    ::fcntl(fd, F_NOCACHE, 1);
+  }
+#endif  // defined(F_NOCACHE)
+  return fd;
+}
+
+// Advises the kernel of the access pattern of reads from |fd|.
+void AdviseAccessPattern(int fd, RandomAccessFile::AccessPattern pattern) {
+#if defined(POSIX_FADV_NORMAL)
+  int advice = POSIX_FADV_NORMAL;
+  if (pattern == RandomAccessFile::kSequential) {
+    advice = POSIX_FADV_SEQUENTIAL;
+  } else if (pattern == RandomAccessFile::kRandom) {
+    advice = POSIX_FADV_RANDOM;
+  }
+  ::posix_fadvise(fd, 0, 0, advice);
+#elif defined(F_RDAHEAD)
+  // Apple platforms have no posix_fadvise(), but readahead can be turned off.
+  ::fcntl(fd, F_RDAHEAD, pattern == RandomAccessFile::kRandom ? 0 : 1);
+#else
+  (void)fd;
+  (void)pattern;
+#endif  // defined(POSIX_FADV_NORMAL)
+}
+
 // Helper class to limit resource usage to avoid exhaustion.
 // Currently used to limit read-only file descriptors and mmap file usage
 // so that we do not run out of file descriptors or virtual memory, or run into
@@ -101,6 +151,297 @@ class Limiter {
   std::atomic<int> acquires_allowed_;
 };
 
+// Runs the reads of MultiRead() calls on a few shared threads, so that
+// several reads are in flight at once.  Used where io_uring is missing.
+class PosixReadPool {
+ public:
+  PosixReadPool() : queue_cv_(&queue_mutex_), started_threads_(0) {}
+
+  PosixReadPool(const PosixReadPool&) = delete;
+  PosixReadPool& operator=(const PosixReadPool&) = delete;
+
+  // The pool never shuts down, so it lives for the whole process.
+  static PosixReadPool* Default() {
+    static PosixReadPool* pool = new PosixReadPool;
+    return pool;
+  }
+
+  // Performs all of reqs[0..num_reqs-1] with file->Read(), on this thread
+  // and on up to kMaxThreads pool threads.
+  void ReadAll(const RandomAccessFile* file,
+               RandomAccessFile::ReadRequest* reqs, size_t num_reqs) {
+    std::shared_ptr<Batch> batch =
+        std::make_shared<Batch>(file, reqs, num_reqs);
+    const size_t helpers =
+        std::min(num_reqs - 1, static_cast<size_t>(kMaxThreads));
+    queue_mutex_.Lock();
+    for (size_t i = 0; i < helpers; i++) {
+      if (started_threads_ < kMaxThreads) {
+        started_threads_++;
+        std::thread pool_thread(&PosixReadPool::ThreadMain, this);
+        pool_thread.detach();
+      }
+      queue_.push(batch);
+    }
+    queue_cv_.SignalAll();
+    queue_mutex_.Unlock();
+
+    // Pool threads that only get to the batch after all of its reads have
+    // been claimed drop it without touching "reqs", so there is no need
+    // to wait for them.
+    batch->Work();
+    MutexLock l(&batch->mutex);
+    while (batch->done < num_reqs) {
+      batch->done_cv.Wait();
+    }
+  }
+
+ private:
+  static constexpr int kMaxThreads = 4;
+
+  struct Batch {
+    Batch(const RandomAccessFile* f, RandomAccessFile::ReadRequest* r,
+          size_t n)
+        : file(f), reqs(r), num_reqs(n), next(0), done_cv(&mutex), done(0) {}
+
+    // Performs unclaimed reads until none are left.
+    void Work() {
+      size_t finished = 0;
+      size_t i;
+      while ((i = next.fetch_add(1, std::memory_order_relaxed)) < num_reqs) {
+        RandomAccessFile::ReadRequest* req = &reqs[i];
+        req->status = file->Read(req->offset, req->n, &req->result,
+                                 req->scratch);
+        finished++;
+      }
+      if (finished > 0) {
+        MutexLock l(&mutex);
+        done += finished;
+        if (done == num_reqs) {
+          done_cv.SignalAll();
+        }
+      }
+    }
+
+    const RandomAccessFile* const file;
+    RandomAccessFile::ReadRequest* const reqs;
+    const size_t num_reqs;
+    std::atomic<size_t> next;
+
+    port::Mutex mutex;
+    port::CondVar done_cv GUARDED_BY(mutex);
+    size_t done GUARDED_BY(mutex);
+  };
+
+  void ThreadMain() {
+    while (true) {
+      queue_mutex_.Lock();
+      while (queue_.empty()) {
+        queue_cv_.Wait();
+      }
+      std::shared_ptr<Batch> batch = std::move(queue_.front());
+      queue_.pop();
+      queue_mutex_.Unlock();
+      batch->Work();
+    }
+  }
+
+  port::Mutex queue_mutex_;
+  port::CondVar queue_cv_ GUARDED_BY(queue_mutex_);
+  std::queue<std::shared_ptr<Batch>> queue_ GUARDED_BY(queue_mutex_);
+  int started_threads_ GUARDED_BY(queue_mutex_);
+};
+
+#if defined(HAVE_IO_URING)
+// A minimal io_uring instance, driven through the raw system calls, that
+// submits a batch of reads at once and waits for all of them.  Each thread
+// that calls MultiRead() gets its own, so no locking is needed.
+class PosixIoUring {
+ public:
+  // Returns the calling thread's instance, or nullptr if the kernel does
+  // not support io_uring reads.
+  static PosixIoUring* ForThisThread() {
+    static std::atomic<bool> unsupported(false);
+    thread_local std::unique_ptr<PosixIoUring> ring;
+    if (ring == nullptr && !unsupported.load(std::memory_order_relaxed)) {
+      ring.reset(new PosixIoUring);
+      if (!ring->Init()) {
+        ring.reset();
+        unsupported.store(true, std::memory_order_relaxed);
+      }
+    }
+    return ring.get();
+  }
+
+  PosixIoUring(const PosixIoUring&) = delete;
+  PosixIoUring& operator=(const PosixIoUring&) = delete;
+
+  ~PosixIoUring() {
+    if (sqes_ != nullptr) ::munmap(sqes_, sqes_size_);
+    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+      ::munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != nullptr) ::munmap(sq_ring_, sq_ring_size_);
+    if (ring_fd_ >= 0) ::close(ring_fd_);
+  }
+
+  // Reads all of reqs[0..num_reqs-1] from "fd".
+  void ReadAll(int fd, const std::string& filename,
+               RandomAccessFile::ReadRequest* reqs, size_t num_reqs) {
+    for (size_t start = 0; start < num_reqs; start += entries_) {
+      const unsigned count =
+          static_cast<unsigned>(std::min<size_t>(entries_, num_reqs - start));
+      const unsigned old_tail = *sq_tail_;
+      for (unsigned i = 0; i < count; i++) {
+        const RandomAccessFile::ReadRequest& req = reqs[start + i];
+        const unsigned index = (old_tail + i) & *sq_mask_;
+        struct io_uring_sqe* sqe = &sqes_[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(req.scratch);
+        sqe->len = static_cast<uint32_t>(req.n);
+        sqe->off = req.offset;
+        sqe->user_data = start + i;
+        sq_array_[index] = index;
+      }
+      __atomic_store_n(sq_tail_, old_tail + count, __ATOMIC_RELEASE);
+
+      int submitted;
+      do {
+        submitted = Enter(count, count);
+      } while (submitted < 0 && errno == EINTR);
+      if (submitted < 0) submitted = 0;
+      if (submitted < static_cast<int>(count)) {
+        // The kernel did not take the rest of the entries (e.g. it is short
+        // of memory), so withdraw them and read them directly.
+        __atomic_store_n(sq_tail_, old_tail + submitted, __ATOMIC_RELEASE);
+        for (unsigned i = submitted; i < count; i++) {
+          PlainRead(fd, filename, &reqs[start + i]);
+        }
+      }
+
+      unsigned reaped = 0;
+      while (reaped < static_cast<unsigned>(submitted)) {
+        unsigned head = *cq_head_;
+        const unsigned cq_tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        if (head == cq_tail) {
+          // Reads still in flight write into their scratch buffers, so
+          // there is no way out of this wait short of completing it.
+          if (Enter(0, submitted - reaped) < 0 && errno != EINTR) {
+            std::fprintf(stderr, "leveldb: io_uring wait failed: %s\n",
+                         std::strerror(errno));
+            std::abort();
+          }
+          continue;
+        }
+        for (; head != cq_tail; head++, reaped++) {
+          const struct io_uring_cqe* cqe = &cqes_[head & *cq_mask_];
+          RandomAccessFile::ReadRequest* req = &reqs[cqe->user_data];
+          if (cqe->res < 0) {
+            req->result = Slice(req->scratch, 0);
+            req->status = PosixError(filename, -cqe->res);
+          } else {
+            req->result = Slice(req->scratch, cqe->res);
+            req->status = Status::OK();
+          }
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+      }
+    }
+  }
+
+ private:
+  PosixIoUring()
+      : ring_fd_(-1),
+        sq_ring_(nullptr),
+        cq_ring_(nullptr),
+        sqes_(nullptr),
+        sq_ring_size_(0),
+        cq_ring_size_(0),
+        sqes_size_(0) {}
+
+  bool Init() {
+    struct io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    ring_fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, kEntries,
+                                          &params));
+    // IORING_FEAT_RW_CUR_POS came with the kernel that added
+    // IORING_OP_READ.
+    if (ring_fd_ < 0 || (params.features & IORING_FEAT_RW_CUR_POS) == 0) {
+      return false;
+    }
+    entries_ = params.sq_entries;
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ring_ = Map(sq_ring_size_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == nullptr) return false;
+    cq_ring_ = single_mmap ? sq_ring_ : Map(cq_ring_size_, IORING_OFF_CQ_RING);
+    if (cq_ring_ == nullptr) return false;
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    sqes_ = reinterpret_cast<struct io_uring_sqe*>(
+        Map(sqes_size_, IORING_OFF_SQES));
+    if (sqes_ == nullptr) return false;
+
+    char* sq = reinterpret_cast<char*>(sq_ring_);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    char* cq = reinterpret_cast<char*>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  void* Map(size_t size, off_t offset) {
+    void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, ring_fd_, offset);
+    return p == MAP_FAILED ? nullptr : p;
+  }
+
+  int Enter(unsigned to_submit, unsigned min_complete) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, ring_fd_,
+                                      to_submit, min_complete,
+                                      IORING_ENTER_GETEVENTS, nullptr, 0));
+  }
+
+  static void PlainRead(int fd, const std::string& filename,
+                        RandomAccessFile::ReadRequest* req) {
+    ssize_t read_size = ::pread(fd, req->scratch, req->n,
+                                static_cast<off_t>(req->offset));
+    req->result = Slice(req->scratch, (read_size < 0) ? 0 : read_size);
+    req->status = read_size < 0 ? PosixError(filename, errno) : Status::OK();
+  }
+
+  static constexpr unsigned kEntries = 64;
+
+  int ring_fd_;
+  void* sq_ring_;
+  void* cq_ring_;
+  struct io_uring_sqe* sqes_;
+  size_t sq_ring_size_;
+  size_t cq_ring_size_;
+  size_t sqes_size_;
+  unsigned entries_;
+
+  unsigned* sq_tail_;
+  unsigned* sq_mask_;
+  unsigned* sq_array_;
+  unsigned* cq_head_;
+  unsigned* cq_tail_;
+  unsigned* cq_mask_;
+  struct io_uring_cqe* cqes_;
+};
+#endif  // defined(HAVE_IO_URING)
+
 // Implements sequential read access in a file using read().
 //
 // Instances of this class are thread-friendly but not thread-safe, as required
@@ -149,9 +490,14 @@ class PosixRandomAccessFile final : public RandomAccessFile {
  public:
   // The new instance takes ownership of |fd|. |fd_limiter| must outlive this
   // instance, and will be used to determine if .
-  PosixRandomAccessFile(std::string filename, int fd, Limiter* fd_limiter)
+  //
+  // If |uncached| is true, |fd| was returned by OpenUncached(), and the file
+  // is reopened the same way whenever it is read without a permanent fd.
+  PosixRandomAccessFile(std::string filename, int fd, Limiter* fd_limiter,
+                        bool uncached = false)
       : has_permanent_fd_(fd_limiter->Acquire()),
         fd_(has_permanent_fd_ ? fd : -1),
+        uncached_(uncached),
         fd_limiter_(fd_limiter),
         filename_(std::move(filename)) {
     if (!has_permanent_fd_) {
@@ -172,7 +518,8 @@ class PosixRandomAccessFile final : public RandomAccessFile {
               char* scratch) const override {
     int fd = fd_;
     if (!has_permanent_fd_) {
-      fd = ::open(filename_.c_str(), O_RDONLY | kOpenBaseFlags);
+      fd = uncached_ ? OpenUncached(filename_)
+                     : ::open(filename_.c_str(), O_RDONLY | kOpenBaseFlags);
       if (fd < 0) {
         return PosixError(filename_, errno);
       }
@@ -181,11 +528,15 @@ class PosixRandomAccessFile final : public RandomAccessFile {
     assert(fd != -1);
 
     Status status;
-    ssize_t read_size = ::pread(fd, scratch, n, static_cast<off_t>(offset));
-    *result = Slice(scratch, (read_size < 0) ? 0 : read_size);
-    if (read_size < 0) {
-      // An error: return a non-ok status.
-      status = PosixError(filename_, errno);
+    if (uncached_ && kUncachedOpenFlags != 0) {
+      status = ReadAligned(fd, offset, n, result, scratch);
+    } else {
+      ssize_t read_size = ::pread(fd, scratch, n, static_cast<off_t>(offset));
+      *result = Slice(scratch, (read_size < 0) ? 0 : read_size);
+      if (read_size < 0) {
+        // An error: return a non-ok status.
+        status = PosixError(filename_, errno);
+      }
     }
     if (!has_permanent_fd_) {
       // Close the temporary file descriptor opened earlier.
@@ -195,9 +546,80 @@ class PosixRandomAccessFile final : public RandomAccessFile {
     return status;
   }
 
+  void MultiRead(ReadRequest* reqs, size_t num_reqs) const override {
+    if (num_reqs <= 1) {
+      RandomAccessFile::MultiRead(reqs, num_reqs);
+      return;
+    }
+#if defined(HAVE_IO_URING)
+    // Uncached reads go through ReadAligned()'s bounce buffers instead.
+    PosixIoUring* ring =
+        (uncached_ && kUncachedOpenFlags != 0) ? nullptr
+                                               : PosixIoUring::ForThisThread();
+    if (ring != nullptr) {
+      int fd = fd_;
+      if (!has_permanent_fd_) {
+        fd = uncached_ ? OpenUncached(filename_)
+                       : ::open(filename_.c_str(), O_RDONLY | kOpenBaseFlags);
+        if (fd < 0) {
+          const Status status = PosixError(filename_, errno);
+          for (size_t i = 0; i < num_reqs; i++) {
+            reqs[i].result = Slice(reqs[i].scratch, 0);
+            reqs[i].status = status;
+          }
+          return;
+        }
+      }
+      ring->ReadAll(fd, filename_, reqs, num_reqs);
+      if (!has_permanent_fd_) {
+        ::close(fd);
+      }
+      return;
+    }
+#endif  // defined(HAVE_IO_URING)
+    PosixReadPool::Default()->ReadAll(this, reqs, num_reqs);
+  }
+
+  void Hint(AccessPattern pattern) override {
+    // Advice given to a temporary file descriptor dies with it.
+    if (has_permanent_fd_) {
+      AdviseAccessPattern(fd_, pattern);
+    }
+  }
+
  private:
+  // O_DIRECT reads must be aligned, so read the aligned range that covers
+  // [offset, offset + n) into a bounce buffer and copy out the part asked for.
+  Status ReadAligned(int fd, uint64_t offset, size_t n, Slice* result,
+                     char* scratch) const {
+    const uint64_t aligned_offset = offset & ~uint64_t{kDirectIOAlignment - 1};
+    const size_t skip = static_cast<size_t>(offset - aligned_offset);
+    const size_t aligned_size =
+        (skip + n + kDirectIOAlignment - 1) & ~(kDirectIOAlignment - 1);
+    void* buffer;
+    if (::posix_memalign(&buffer, kDirectIOAlignment, aligned_size) != 0) {
+      *result = Slice();
+      return Status::IOError(filename_, "cannot allocate read buffer");
+    }
+
+    Status status;
+    size_t copied = 0;
+    ssize_t read_size = ::pread(fd, buffer, aligned_size,
+                                static_cast<off_t>(aligned_offset));
+    if (read_size < 0) {
+      status = PosixError(filename_, errno);
+    } else if (static_cast<size_t>(read_size) > skip) {
+      copied = std::min(n, static_cast<size_t>(read_size) - skip);
+      std::memcpy(scratch, static_cast<char*>(buffer) + skip, copied);
+    }
+    std::free(buffer);
+    *result = Slice(scratch, copied);
+    return status;
+  }
+
   const bool has_permanent_fd_;  // If false, the file is opened on every read.
   const int fd_;                 // -1 if has_permanent_fd_ is false.
+  const bool uncached_;          // If true, reads bypass the page cache.
   Limiter* const fd_limiter_;
   const std::string filename_;
 };
@@ -239,6 +661,16 @@ class PosixMmapReadableFile final : public RandomAccessFile {
     return Status::OK();
   }
 
+  void Hint(AccessPattern pattern) override {
+    int advice = MADV_NORMAL;
+    if (pattern == kSequential) {
+      advice = MADV_SEQUENTIAL;
+    } else if (pattern == kRandom) {
+      advice = MADV_RANDOM;
+    }
+    ::madvise(static_cast<void*>(mmap_base_), length_, advice);
+  }
+
  private:
   char* const mmap_base_;
   const size_t length_;
@@ -303,13 +735,18 @@ class PosixWritableFile final : public WritableFile {
 
   Status Flush() override { return FlushBuffer(); }
 
-  Status Sync() override {
+  Status Sync() override { return SyncImpl(/*barrier=*/false); }
+
+  Status SyncBarrier() override { return SyncImpl(/*barrier=*/true); }
+
+ private:
+  Status SyncImpl(bool barrier) {
     // Ensure new files referred to by the manifest are in the filesystem.
     //
     // This needs to happen before the manifest file is flushed to disk, to
     // avoid crashing in a state where the manifest refers to files that are not
     // yet on disk.
-    Status status = SyncDirIfManifest();
+    Status status = SyncDirIfManifest(barrier);
     if (!status.ok()) {
       return status;
     }
@@ -319,10 +756,9 @@ class PosixWritableFile final : public WritableFile {
       return status;
     }
 
-    return SyncFd(fd_, filename_);
+    return barrier ? BarrierSyncFd(fd_, filename_) : SyncFd(fd_, filename_);
   }
 
- private:
   Status FlushBuffer() {
     Status status = WriteUnbuffered(buf_, pos_);
     pos_ = 0;
@@ -344,7 +780,7 @@ class PosixWritableFile final : public WritableFile {
     return Status::OK();
   }
 
-  Status SyncDirIfManifest() {
+  Status SyncDirIfManifest(bool barrier) {
     Status status;
     if (!is_manifest_) {
       return status;
@@ -354,7 +790,7 @@ class PosixWritableFile final : public WritableFile {
     if (fd < 0) {
       status = PosixError(dirname_, errno);
     } else {
-      status = SyncFd(fd, dirname_);
+      status = barrier ? BarrierSyncFd(fd, dirname_) : SyncFd(fd, dirname_);
       ::close(fd);
     }
     return status;
@@ -389,6 +825,22 @@ class PosixWritableFile final : public WritableFile {
     return PosixError(fd_path, errno);
   }
 
+  // Ensures that the data written to the given file descriptor so far
+  // reaches durable media before anything written after it.
+  //
+  // On macOS and iOS fcntl(F_BARRIERFSYNC) does this without waiting for the
+  // drive cache to be flushed.  Elsewhere, or if the filesystem doesn't
+  // support it, this falls back to SyncFd().
+  static Status BarrierSyncFd(int fd, const std::string& fd_path) {
+#if HAVE_FULLFSYNC && defined(F_BARRIERFSYNC)
+    if (::fcntl(fd, F_BARRIERFSYNC) == 0) {
+      return Status::OK();
+    }
+#endif  // HAVE_FULLFSYNC && defined(F_BARRIERFSYNC)
+
+    return SyncFd(fd, fd_path);
+  }
+
   // Returns the directory name in a path pointing to a file.
   //
   // Returns "." if the path does not contain any directory separator.
@@ -542,6 +994,27 @@ class PosixEnv : public Env {
     return status;
   }
 
+  Status NewUncachedRandomAccessFile(const std::string& filename,
+                                     RandomAccessFile** result) override {
+#if defined(O_DIRECT) || defined(F_NOCACHE)
+    *result = nullptr;
+    int fd = OpenUncached(filename);
+    if (fd < 0) {
+      if (errno == EINVAL) {
+        // The file system does not support O_DIRECT.
+        return NewRandomAccessFile(filename, result);
+      }
+      return PosixError(filename, errno);
+    }
+
+    *result = new PosixRandomAccessFile(filename, fd, &fd_limiter_,
+                                        /*uncached=*/true);
+    return Status::OK();
+#else
+    return NewRandomAccessFile(filename, result);
+#endif  // defined(O_DIRECT) || defined(F_NOCACHE)
+  }
+
   Status NewWritableFile(const std::string& filename,
                          WritableFile** result) override {
     int fd = ::open(filename.c_str(),
@@ -663,6 +1136,8 @@ class PosixEnv : public Env {
   void Schedule(void (*background_work_function)(void* background_work_arg),
                 void* background_work_arg) override;
 
+  void SetBackgroundThreads(int number) override;
+
   void StartThread(void (*thread_main)(void* thread_main_arg),
                    void* thread_main_arg) override {
     std::thread new_thread(thread_main, thread_main_arg);
@@ -739,7 +1214,9 @@ class PosixEnv : public Env {
 
   port::Mutex background_work_mutex_;
   port::CondVar background_work_cv_ GUARDED_BY(background_work_mutex_);
-  bool started_background_thread_ GUARDED_BY(background_work_mutex_);
+  // Background threads are started lazily, up to background_threads_.
+  int started_background_threads_ GUARDED_BY(background_work_mutex_);
+  int background_threads_ GUARDED_BY(background_work_mutex_);
 
   std::queue<BackgroundWorkItem> background_work_queue_
       GUARDED_BY(background_work_mutex_);
@@ -774,7 +1251,8 @@ int MaxOpenFiles() {
 
 PosixEnv::PosixEnv()
     : background_work_cv_(&background_work_mutex_),
-      started_background_thread_(false),
+      started_background_threads_(0),
+      background_threads_(1),
       mmap_limiter_(MaxMmaps()),
       fd_limiter_(MaxOpenFiles()) {}
 
@@ -783,22 +1261,29 @@ void PosixEnv::Schedule(
     void* background_work_arg) {
   background_work_mutex_.Lock();
 
-  // Start the background thread, if we haven't done so already.
-  if (!started_background_thread_) {
-    started_background_thread_ = true;
+  // Start another background thread, if we haven't started all of them.
+  if (started_background_threads_ < background_threads_) {
+    started_background_threads_++;
     std::thread background_thread(PosixEnv::BackgroundThreadEntryPoint, this);
     background_thread.detach();
   }
 
-  // If the queue is empty, the background thread may be waiting for work.
-  if (background_work_queue_.empty()) {
-    background_work_cv_.Signal();
-  }
+  // Wake up a waiting background thread.  With several threads, one may be
+  // waiting even if the queue is not empty.
+  background_work_cv_.Signal();
 
   background_work_queue_.emplace(background_work_function, background_work_arg);
   background_work_mutex_.Unlock();
 }
 
+void PosixEnv::SetBackgroundThreads(int number) {
+  background_work_mutex_.Lock();
+  if (number > background_threads_) {
+    background_threads_ = number;
+  }
+  background_work_mutex_.Unlock();
+}
+
 void PosixEnv::BackgroundThreadMain() {
   while (true) {
     background_work_mutex_.Lock();
@@ -8,4 +8,6 @@ namespace leveldb {
 
 FilterPolicy::~FilterPolicy() {}
 
+bool FilterPolicy::UseWholeTableFilter() const { return false; }
+
 }  // namespace leveldb
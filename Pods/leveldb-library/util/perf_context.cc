@@ -0,0 +1,67 @@
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+
+#include "leveldb/perf_context.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+#include "util/perf_context_imp.h"
+
+namespace leveldb {
+
+namespace perf_internal {
+
+thread_local PerfLevel perf_level = kDisable;
+thread_local PerfContext perf_context;
+
+}  // namespace perf_internal
+
+void PerfContext::Reset() { *this = PerfContext(); }
+
+std::string PerfContext::ToString() const {
+  std::string r;
+  char buf[100];
+  auto append = [&](const char* name, uint64_t value) {
+    if (value != 0) {
+      std::snprintf(buf, sizeof(buf), "%s = %" PRIu64 "\n", name, value);
+      r.append(buf);
+    }
+  };
+  append("get_count", get_count);
+  append("get_nanos", get_nanos);
+  append("memtable_get_nanos", memtable_get_nanos);
+  append("table_open_count", table_open_count);
+  append("table_open_nanos", table_open_nanos);
+  append("block_cache_hit_count", block_cache_hit_count);
+  append("block_read_count", block_read_count);
+  append("block_read_bytes", block_read_bytes);
+  append("block_read_nanos", block_read_nanos);
+  append("block_checksum_nanos", block_checksum_nanos);
+  append("decompress_nanos", decompress_nanos);
+  append("filter_check_count", filter_check_count);
+  append("filter_useful_count", filter_useful_count);
+  append("filter_check_nanos", filter_check_nanos);
+  append("write_count", write_count);
+  append("write_nanos", write_nanos);
+  append("write_delay_nanos", write_delay_nanos);
+  append("wal_write_nanos", wal_write_nanos);
+  append("wal_sync_nanos", wal_sync_nanos);
+  append("memtable_insert_nanos", memtable_insert_nanos);
+  append("iter_seek_count", iter_seek_count);
+  append("iter_seek_nanos", iter_seek_nanos);
+  append("iter_next_count", iter_next_count);
+  append("iter_next_nanos", iter_next_nanos);
+  append("internal_key_skipped_count", internal_key_skipped_count);
+  append("internal_delete_skipped_count", internal_delete_skipped_count);
+  return r;
+}
+
+void SetPerfLevel(PerfLevel level) { perf_internal::perf_level = level; }
+
+PerfLevel GetPerfLevel() { return perf_internal::perf_level; }
+
+PerfContext* GetPerfContext() { return &perf_internal::perf_context; }
+
+}  // namespace leveldb
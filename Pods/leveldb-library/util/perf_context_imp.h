@@ -0,0 +1,66 @@
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+
+#ifndef STORAGE_LEVELDB_UTIL_PERF_CONTEXT_IMP_H_
+#define STORAGE_LEVELDB_UTIL_PERF_CONTEXT_IMP_H_
+
+#include <chrono>
+#include <cstdint>
+
+#include "leveldb/perf_context.h"
+
+namespace leveldb {
+
+namespace perf_internal {
+
+extern thread_local PerfLevel perf_level;
+extern thread_local PerfContext perf_context;
+
+inline uint64_t NowNanos() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+}  // namespace perf_internal
+
+// Adds the time between its construction and its destruction to *metric
+// if the calling thread's perf level is kEnableTime.
+class PerfTimer {
+ public:
+  explicit PerfTimer(uint64_t* metric)
+      : metric_(perf_internal::perf_level >= kEnableTime ? metric : nullptr),
+        start_(metric_ != nullptr ? perf_internal::NowNanos() : 0) {}
+
+  PerfTimer(const PerfTimer&) = delete;
+  PerfTimer& operator=(const PerfTimer&) = delete;
+
+  ~PerfTimer() {
+    if (metric_ != nullptr) {
+      *metric_ += perf_internal::NowNanos() - start_;
+    }
+  }
+
+ private:
+  uint64_t* const metric_;
+  const uint64_t start_;
+};
+
+}  // namespace leveldb
+
+// Times the rest of the enclosing scope into PerfContext::metric.
+#define PERF_TIMER_GUARD(metric)                                            \
+  ::leveldb::PerfTimer perf_timer_##metric(                                 \
+      &::leveldb::perf_internal::perf_context.metric)
+
+// Adds "value" to PerfContext::metric.
+#define PERF_COUNTER_ADD(metric, value)                                     \
+  do {                                                                      \
+    if (::leveldb::perf_internal::perf_level >= ::leveldb::kEnableCount) {  \
+      ::leveldb::perf_internal::perf_context.metric += (value);             \
+    }                                                                       \
+  } while (0)
+
+#endif  // STORAGE_LEVELDB_UTIL_PERF_CONTEXT_IMP_H_
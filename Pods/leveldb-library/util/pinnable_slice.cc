@@ -0,0 +1,73 @@
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+
+#include "leveldb/pinnable_slice.h"
+
+#include <cassert>
+
+namespace leveldb {
+
+PinnableSlice::PinnableSlice() : pinned_(false) {
+  cleanup_head_.function = nullptr;
+  cleanup_head_.next = nullptr;
+}
+
+PinnableSlice::~PinnableSlice() { RunCleanups(); }
+
+void PinnableSlice::PinSlice(const Slice& s) {
+  assert(!pinned_);
+  pinned_ = true;
+  Slice::operator=(s);
+}
+
+void PinnableSlice::PinSelf(const Slice& s) {
+  Reset();
+  buf_.assign(s.data(), s.size());
+  Slice::operator=(Slice(buf_));
+}
+
+void PinnableSlice::PinSelf() {
+  assert(!pinned_);
+  Slice::operator=(Slice(buf_));
+}
+
+void PinnableSlice::Reset() {
+  RunCleanups();
+  pinned_ = false;
+  clear();
+}
+
+void PinnableSlice::RegisterCleanup(CleanupFunction function, void* arg1,
+                                    void* arg2) {
+  assert(pinned_);
+  assert(function != nullptr);
+  CleanupNode* node;
+  if (cleanup_head_.IsEmpty()) {
+    node = &cleanup_head_;
+  } else {
+    node = new CleanupNode();
+    node->next = cleanup_head_.next;
+    cleanup_head_.next = node;
+  }
+  node->function = function;
+  node->arg1 = arg1;
+  node->arg2 = arg2;
+}
+
+void PinnableSlice::RunCleanups() {
+  if (cleanup_head_.IsEmpty()) {
+    return;
+  }
+  (*cleanup_head_.function)(cleanup_head_.arg1, cleanup_head_.arg2);
+  for (CleanupNode* node = cleanup_head_.next; node != nullptr;) {
+    (*node->function)(node->arg1, node->arg2);
+    CleanupNode* next_node = node->next;
+    delete node;
+    node = next_node;
+  }
+  cleanup_head_.function = nullptr;
+  cleanup_head_.next = nullptr;
+}
+
+}  // namespace leveldb
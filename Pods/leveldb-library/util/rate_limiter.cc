@@ -0,0 +1,136 @@
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+
+#include "leveldb/rate_limiter.h"
+
+#include <algorithm>
+
+#include "leveldb/env.h"
+#include "port/port.h"
+#include "port/thread_annotations.h"
+#include "util/mutexlock.h"
+#include "util/rate_limiter_imp.h"
+
+namespace leveldb {
+
+RateLimiter::~RateLimiter() = default;
+
+void RateLimiter::SetLevel0Pressure(double pressure) {}
+
+namespace {
+
+// Budgets grow to this multiple of their base at a level-0 pressure of one.
+static const double kMaxAutoTuneScale = 8.0;
+
+class TokenBucketRateLimiter : public RateLimiter {
+ public:
+  TokenBucketRateLimiter(int64_t flush_bytes_per_second,
+                         int64_t compaction_bytes_per_second, bool auto_tune)
+      : env_(Env::Default()), auto_tune_(auto_tune), scale_(1.0) {
+    const uint64_t now = env_->NowMicros();
+    const int64_t rates[] = {flush_bytes_per_second,
+                             compaction_bytes_per_second};
+    for (int i = 0; i < 2; i++) {
+      buckets_[i].base_rate = std::max<int64_t>(rates[i], 0);
+      buckets_[i].available = 0;
+      buckets_[i].refill_micros = now;
+    }
+  }
+
+  void Request(size_t bytes, IOType type) override {
+    uint64_t wait_micros = 0;
+    {
+      MutexLock l(&mutex_);
+      Bucket* b = &buckets_[type];
+      if (b->base_rate == 0 || scale_ == 0) {
+        return;  // Unlimited
+      }
+      const double rate = b->base_rate * scale_;
+      const uint64_t now = env_->NowMicros();
+      // Up to a tenth of a second of unused budget is saved for bursts.
+      b->available = std::min(
+          b->available + (now - b->refill_micros) * rate / 1e6, rate / 10);
+      b->refill_micros = now;
+      b->available -= bytes;
+      if (b->available < 0) {
+        // The debt includes the requests of threads that are still waiting,
+        // so concurrent requests wait in turn.
+        wait_micros = static_cast<uint64_t>(-b->available * 1e6 / rate);
+      }
+    }
+    if (wait_micros > 0) {
+      env_->SleepForMicroseconds(
+          static_cast<int>(std::min<uint64_t>(wait_micros, 1000000)));
+    }
+  }
+
+  void SetLevel0Pressure(double pressure) override {
+    if (!auto_tune_) {
+      return;
+    }
+    MutexLock l(&mutex_);
+    if (pressure > 1) {
+      scale_ = 0;  // Lift the limits until level-0 recovers
+    } else {
+      scale_ = 1 + (kMaxAutoTuneScale - 1) * std::max(pressure, 0.0);
+    }
+  }
+
+ private:
+  struct Bucket {
+    int64_t base_rate;       // Bytes per second, or zero if unlimited
+    double available;        // Bytes that may be written right away
+    uint64_t refill_micros;  // Time "available" was last brought up to date
+  };
+
+  Env* const env_;
+  const bool auto_tune_;
+
+  port::Mutex mutex_;
+  Bucket buckets_[2] GUARDED_BY(mutex_);
+  double scale_ GUARDED_BY(mutex_);  // Of the base rates; zero if unlimited
+};
+
+class RateLimitedWritableFile : public WritableFile {
+ public:
+  RateLimitedWritableFile(WritableFile* file, RateLimiter* limiter,
+                          RateLimiter::IOType type)
+      : file_(file), limiter_(limiter), type_(type) {}
+
+  ~RateLimitedWritableFile() override { delete file_; }
+
+  Status Append(const Slice& data) override {
+    limiter_->Request(data.size(), type_);
+    return file_->Append(data);
+  }
+  Status Close() override { return file_->Close(); }
+  Status Flush() override { return file_->Flush(); }
+  Status Sync() override { return file_->Sync(); }
+  Status SyncBarrier() override { return file_->SyncBarrier(); }
+
+ private:
+  WritableFile* const file_;
+  RateLimiter* const limiter_;
+  const RateLimiter::IOType type_;
+};
+
+}  // namespace
+
+RateLimiter* NewRateLimiter(int64_t flush_bytes_per_second,
+                            int64_t compaction_bytes_per_second,
+                            bool auto_tune) {
+  return new TokenBucketRateLimiter(flush_bytes_per_second,
+                                    compaction_bytes_per_second, auto_tune);
+}
+
+WritableFile* NewRateLimitedWritableFile(WritableFile* file,
+                                         RateLimiter* limiter,
+                                         RateLimiter::IOType type) {
+  if (limiter == nullptr) {
+    return file;
+  }
+  return new RateLimitedWritableFile(file, limiter, type);
+}
+
+}  // namespace leveldb
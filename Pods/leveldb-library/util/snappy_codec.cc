@@ -0,0 +1,303 @@
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+
+#include "util/snappy_codec.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include "util/coding.h"
+
+namespace leveldb {
+namespace snappy_codec {
+
+namespace {
+
+// The input is compressed in independent fragments of this size, so that
+// positions in the hash table fit in 16 bits.
+const size_t kBlockSize = 1 << 16;
+
+const int kMinHashTableBits = 8;
+const int kMaxHashTableBits = 14;
+
+// No match is looked for in the last bytes of a fragment, so that the four
+// byte loads below never read past its end.
+const size_t kInputMarginBytes = 15;
+
+// The low two bits of each tag.
+enum ElementType {
+  kLiteral = 0,
+  kCopy1ByteOffset = 1,
+  kCopy2ByteOffset = 2,
+  kCopy4ByteOffset = 3
+};
+
+inline uint32_t Load32(const char* p) {
+  uint32_t result;
+  std::memcpy(&result, p, sizeof(result));
+  return result;
+}
+
+inline uint32_t HashBytes(uint32_t bytes, int shift) {
+  return (bytes * 0x1e35a7bd) >> shift;
+}
+
+// Upper bound of the compressed size of "length" bytes, the same as
+// snappy::MaxCompressedLength().
+inline size_t MaxCompressedLength(size_t length) {
+  return 32 + length + length / 6;
+}
+
+// Return the number of bytes that s1 and s2 have in common, reading s2 up
+// to s2_limit. s1 must come before s2.
+inline size_t FindMatchLength(const char* s1, const char* s2,
+                              const char* s2_limit) {
+  size_t matched = 0;
+  while (s2 + 8 <= s2_limit) {
+    uint64_t a, b;
+    std::memcpy(&a, s1 + matched, sizeof(a));
+    std::memcpy(&b, s2, sizeof(b));
+    if (a != b) break;
+    s2 += 8;
+    matched += 8;
+  }
+  while (s2 < s2_limit && s1[matched] == *s2) {
+    ++s2;
+    ++matched;
+  }
+  return matched;
+}
+
+char* EmitLiteral(char* op, const char* literal, size_t length) {
+  size_t n = length - 1;
+  if (n < 60) {
+    *op++ = static_cast<char>(kLiteral | (n << 2));
+  } else {
+    // The length follows the tag as 1 to 4 little-endian bytes.
+    char* base = op++;
+    int count = 0;
+    while (n > 0) {
+      *op++ = static_cast<char>(n & 0xff);
+      n >>= 8;
+      count++;
+    }
+    *base = static_cast<char>(kLiteral | ((59 + count) << 2));
+  }
+  std::memcpy(op, literal, length);
+  return op + length;
+}
+
+// REQUIRES: 4 <= length <= 64, offset < 65536
+char* EmitCopyAtMost64(char* op, size_t offset, size_t length) {
+  if (length < 12 && offset < 2048) {
+    *op++ = static_cast<char>(kCopy1ByteOffset | ((length - 4) << 2) |
+                              ((offset >> 8) << 5));
+    *op++ = static_cast<char>(offset & 0xff);
+  } else {
+    *op++ = static_cast<char>(kCopy2ByteOffset | ((length - 1) << 2));
+    *op++ = static_cast<char>(offset & 0xff);
+    *op++ = static_cast<char>(offset >> 8);
+  }
+  return op;
+}
+
+// REQUIRES: length >= 4
+char* EmitCopy(char* op, size_t offset, size_t length) {
+  // Emit 64 byte copies, but leave at least four bytes for the last one.
+  while (length >= 68) {
+    op = EmitCopyAtMost64(op, offset, 64);
+    length -= 64;
+  }
+  if (length > 64) {
+    op = EmitCopyAtMost64(op, offset, 60);
+    length -= 60;
+  }
+  return EmitCopyAtMost64(op, offset, length);
+}
+
+// Compress input[0,length-1], with length <= kBlockSize, into op and return
+// the end of the output. "table" must hold 1 << table_bits zeroes.
+char* CompressFragment(const char* input, size_t length, char* op,
+                       uint16_t* table, int table_bits) {
+  const int shift = 32 - table_bits;
+  const char* ip = input;
+  const char* ip_end = input + length;
+  const char* next_emit = ip;
+  if (length >= kInputMarginBytes) {
+    const char* ip_limit = input + length - kInputMarginBytes;
+    uint32_t next_hash = HashBytes(Load32(++ip), shift);
+    for (;;) {
+      // Look for a four byte match, probing more sparsely the longer none is
+      // found, so that incompressible data is skipped quickly.
+      uint32_t skip = 32;
+      const char* next_ip = ip;
+      const char* candidate;
+      do {
+        ip = next_ip;
+        uint32_t hash = next_hash;
+        next_ip = ip + (skip++ >> 5);
+        if (next_ip > ip_limit) {
+          goto emit_remainder;
+        }
+        next_hash = HashBytes(Load32(next_ip), shift);
+        candidate = input + table[hash];
+        table[hash] = static_cast<uint16_t>(ip - input);
+      } while (Load32(ip) != Load32(candidate));
+
+      op = EmitLiteral(op, next_emit, ip - next_emit);
+
+      // Emit copies for as long as the bytes after a match start another one.
+      do {
+        const char* base = ip;
+        size_t matched = 4 + FindMatchLength(candidate + 4, ip + 4, ip_end);
+        ip += matched;
+        op = EmitCopy(op, base - candidate, matched);
+        next_emit = ip;
+        if (ip >= ip_limit) {
+          goto emit_remainder;
+        }
+        table[HashBytes(Load32(ip - 1), shift)] =
+            static_cast<uint16_t>(ip - 1 - input);
+        uint32_t hash = HashBytes(Load32(ip), shift);
+        candidate = input + table[hash];
+        table[hash] = static_cast<uint16_t>(ip - input);
+      } while (Load32(ip) == Load32(candidate));
+
+      next_hash = HashBytes(Load32(++ip), shift);
+    }
+  }
+
+emit_remainder:
+  if (next_emit < ip_end) {
+    op = EmitLiteral(op, next_emit, ip_end - next_emit);
+  }
+  return op;
+}
+
+}  // namespace
+
+bool Compress(const char* input, size_t length, std::string* output) {
+  if (length > std::numeric_limits<uint32_t>::max()) {
+    return false;
+  }
+  output->resize(MaxCompressedLength(length));
+  char* const start = &(*output)[0];
+  char* op = EncodeVarint32(start, static_cast<uint32_t>(length));
+
+  uint16_t table[1 << kMaxHashTableBits];
+  while (length > 0) {
+    const size_t fragment_size = std::min(length, kBlockSize);
+    int table_bits = kMinHashTableBits;
+    while (table_bits < kMaxHashTableBits &&
+           (static_cast<size_t>(1) << table_bits) < fragment_size) {
+      table_bits++;
+    }
+    std::memset(table, 0, sizeof(table[0]) << table_bits);
+    op = CompressFragment(input, fragment_size, op, table, table_bits);
+    input += fragment_size;
+    length -= fragment_size;
+  }
+  output->resize(op - start);
+  return true;
+}
+
+bool GetUncompressedLength(const char* input, size_t length, size_t* result) {
+  uint32_t value;
+  if (GetVarint32Ptr(input, input + length, &value) == nullptr) {
+    return false;
+  }
+  *result = value;
+  return true;
+}
+
+bool Uncompress(const char* input, size_t length, char* output) {
+  const char* ip = input;
+  const char* const ip_end = input + length;
+  uint32_t uncompressed_length;
+  ip = GetVarint32Ptr(ip, ip_end, &uncompressed_length);
+  if (ip == nullptr) {
+    return false;
+  }
+
+  char* op = output;
+  char* const op_end = output + uncompressed_length;
+  while (ip < ip_end) {
+    const uint8_t tag = static_cast<uint8_t>(*ip++);
+    const size_t input_left = ip_end - ip;
+    size_t copy_length;
+    size_t offset;
+    switch (tag & 3) {
+      case kLiteral: {
+        size_t literal_length = tag >> 2;
+        if (literal_length >= 60) {
+          const size_t length_bytes = literal_length - 59;
+          if (input_left < length_bytes) {
+            return false;
+          }
+          literal_length = 0;
+          for (size_t i = 0; i < length_bytes; i++) {
+            literal_length |= static_cast<size_t>(static_cast<uint8_t>(ip[i]))
+                              << (8 * i);
+          }
+          ip += length_bytes;
+        }
+        literal_length += 1;
+        if (static_cast<size_t>(ip_end - ip) < literal_length ||
+            static_cast<size_t>(op_end - op) < literal_length) {
+          return false;
+        }
+        std::memcpy(op, ip, literal_length);
+        ip += literal_length;
+        op += literal_length;
+        continue;
+      }
+      case kCopy1ByteOffset:
+        if (input_left < 1) {
+          return false;
+        }
+        copy_length = 4 + ((tag >> 2) & 7);
+        offset = (static_cast<size_t>(tag >> 5) << 8) |
+                 static_cast<uint8_t>(ip[0]);
+        ip += 1;
+        break;
+      case kCopy2ByteOffset:
+        if (input_left < 2) {
+          return false;
+        }
+        copy_length = (tag >> 2) + 1;
+        offset = static_cast<uint8_t>(ip[0]) |
+                 (static_cast<size_t>(static_cast<uint8_t>(ip[1])) << 8);
+        ip += 2;
+        break;
+      default:
+        if (input_left < 4) {
+          return false;
+        }
+        copy_length = (tag >> 2) + 1;
+        offset = DecodeFixed32(ip);
+        ip += 4;
+        break;
+    }
+    if (offset == 0 || offset > static_cast<size_t>(op - output) ||
+        copy_length > static_cast<size_t>(op_end - op)) {
+      return false;
+    }
+    const char* src = op - offset;
+    if (offset >= copy_length) {
+      std::memcpy(op, src, copy_length);
+    } else {
+      // The copy overlaps its own output, repeating the last offset bytes.
+      for (size_t i = 0; i < copy_length; i++) {
+        op[i] = src[i];
+      }
+    }
+    op += copy_length;
+  }
+  return op == op_end;
+}
+
+}  // namespace snappy_codec
+}  // namespace leveldb
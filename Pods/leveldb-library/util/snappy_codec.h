@@ -0,0 +1,34 @@
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+
+#ifndef STORAGE_LEVELDB_UTIL_SNAPPY_CODEC_H_
+#define STORAGE_LEVELDB_UTIL_SNAPPY_CODEC_H_
+
+#include <cstddef>
+#include <string>
+
+namespace leveldb {
+namespace snappy_codec {
+
+// A self-contained implementation of the Snappy raw format, for builds that
+// cannot link the Snappy library (HAVE_BUNDLED_SNAPPY). Blocks written by it
+// are read by the Snappy library and vice versa, so a database does not
+// depend on which of the two was compiled in.
+
+// Store the compression of "input[0,length-1]" in *output.
+bool Compress(const char* input, size_t length, std::string* output);
+
+// If input[0,length-1] looks like a valid compressed buffer, store the size
+// of the uncompressed data in *result and return true. Else return false.
+bool GetUncompressedLength(const char* input, size_t length, size_t* result);
+
+// Attempt to uncompress input[0,length-1] into *output. Returns true if
+// successful, false if the input is invalid. *output must have room for
+// GetUncompressedLength() bytes.
+bool Uncompress(const char* input, size_t length, char* output);
+
+}  // namespace snappy_codec
+}  // namespace leveldb
+
+#endif  // STORAGE_LEVELDB_UTIL_SNAPPY_CODEC_H_
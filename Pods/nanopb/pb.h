@@ -375,6 +375,21 @@ struct pb_extension_s {
 /* Memory allocation functions to use. You can define pb_realloc and
  * pb_free to custom functions if you want. */
 #ifdef PB_ENABLE_MALLOC
+/* With PB_ALLOCATION_HOOKS, allocations go through functions that the
+ * application provides, for example to account for the memory held by
+ * decoded messages. The library and the application must agree on it. */
+#   ifdef PB_ALLOCATION_HOOKS
+#       ifdef __cplusplus
+extern "C" {
+#       endif
+void *pb_hooked_realloc(void *ptr, size_t size);
+void pb_hooked_free(void *ptr);
+#       ifdef __cplusplus
+}
+#       endif
+#       define pb_realloc(ptr, size) pb_hooked_realloc(ptr, size)
+#       define pb_free(ptr) pb_hooked_free(ptr)
+#   endif
 #   ifndef pb_realloc
 #       define pb_realloc(ptr, size) realloc(ptr, size)
 #   endif
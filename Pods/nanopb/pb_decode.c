@@ -23,11 +23,22 @@
 
 typedef bool (*pb_decoder_t)(pb_istream_t *stream, const pb_field_t *field, void *dest) checkreturn;
 
+/* Storage reserved ahead for the unpacked repeated pointer field that is
+ * being decoded, so that its array grows geometrically instead of by one
+ * entry per element. Only arrays grown by the same pb_decode_noinit() call
+ * are tracked, as the capacity of any other array is not known. */
+typedef struct {
+    void *pData;
+    pb_size_t *pSize;
+    size_t data_size;
+    size_t capacity;
+} pb_array_reserve_t;
+
 static bool checkreturn buf_read(pb_istream_t *stream, pb_byte_t *buf, size_t count);
 static bool checkreturn read_raw_value(pb_istream_t *stream, pb_wire_type_t wire_type, pb_byte_t *buf, size_t *size);
 static bool checkreturn decode_static_field(pb_istream_t *stream, pb_wire_type_t wire_type, pb_field_iter_t *iter);
 static bool checkreturn decode_callback_field(pb_istream_t *stream, pb_wire_type_t wire_type, pb_field_iter_t *iter);
-static bool checkreturn decode_field(pb_istream_t *stream, pb_wire_type_t wire_type, pb_field_iter_t *iter);
+static bool checkreturn decode_field(pb_istream_t *stream, pb_wire_type_t wire_type, pb_field_iter_t *iter, pb_array_reserve_t *reserve);
 static void iter_from_extension(pb_field_iter_t *iter, pb_extension_t *extension);
 static bool checkreturn default_extension_decoder(pb_istream_t *stream, pb_extension_t *extension, uint32_t tag, pb_wire_type_t wire_type);
 static bool checkreturn decode_extension(pb_istream_t *stream, uint32_t tag, pb_wire_type_t wire_type, pb_field_iter_t *iter);
@@ -50,6 +61,7 @@ static bool checkreturn pb_skip_string(pb_istream_t *stream);
 
 #ifdef PB_ENABLE_MALLOC
 static bool checkreturn allocate_field(pb_istream_t *stream, void *pData, size_t data_size, size_t array_size);
+static void trim_reserved_field(pb_array_reserve_t *reserve);
 static bool checkreturn pb_release_union_field(pb_istream_t *stream, pb_field_iter_t *iter);
 static void pb_release_single_field(const pb_field_iter_t *iter);
 #endif
@@ -532,6 +544,27 @@ static bool checkreturn allocate_field(pb_istream_t *stream, void *pData, size_t
     return true;
 }
 
+/* Give back the storage reserved beyond the entries of the tracked field,
+ * and stop tracking it. */
+static void trim_reserved_field(pb_array_reserve_t *reserve)
+{
+    size_t size;
+    void *ptr;
+
+    if (reserve->pData == NULL)
+        return;
+
+    size = *reserve->pSize;
+    if (size > 0 && size < reserve->capacity)
+    {
+        /* If shrinking fails, the larger allocation is simply kept. */
+        ptr = pb_realloc(*(void**)reserve->pData, size * reserve->data_size);
+        if (ptr != NULL)
+            *(void**)reserve->pData = ptr;
+    }
+    reserve->pData = NULL;
+}
+
 /* Clear a newly allocated item in case it contains a pointer, or is a submessage. */
 static void initialize_pointer_field(void *pItem, pb_field_iter_t *iter)
 {
@@ -550,11 +583,12 @@ static void initialize_pointer_field(void *pItem, pb_field_iter_t *iter)
 }
 #endif
 
-static bool checkreturn decode_pointer_field(pb_istream_t *stream, pb_wire_type_t wire_type, pb_field_iter_t *iter)
+static bool checkreturn decode_pointer_field(pb_istream_t *stream, pb_wire_type_t wire_type, pb_field_iter_t *iter, pb_array_reserve_t *reserve)
 {
 #ifndef PB_ENABLE_MALLOC
     PB_UNUSED(wire_type);
     PB_UNUSED(iter);
+    PB_UNUSED(reserve);
     PB_RETURN_ERROR(stream, "no malloc support");
 #else
     pb_type_t type;
@@ -607,6 +641,11 @@ static bool checkreturn decode_pointer_field(pb_istream_t *stream, pb_wire_type_
                 
                 if (!pb_make_string_substream(stream, &substream))
                     return false;
+
+                /* The packed entries are allocated below, which may shrink
+                 * storage reserved for unpacked entries of the same field. */
+                if (reserve != NULL && reserve->pData == iter->pData)
+                    reserve->pData = NULL;
                 
                 while (substream.bytes_left)
                 {
@@ -668,8 +707,37 @@ static bool checkreturn decode_pointer_field(pb_istream_t *stream, pb_wire_type_
                 if (*size == PB_SIZE_MAX)
                     PB_RETURN_ERROR(stream, "too many array entries");
                 
-                if (!allocate_field(stream, iter->pData, iter->pos->data_size, (size_t)(*size + 1)))
-                    return false;
+                if (reserve == NULL)
+                {
+                    if (!allocate_field(stream, iter->pData, iter->pos->data_size, (size_t)(*size + 1)))
+                        return false;
+                }
+                else if (reserve->pData != iter->pData || *size >= reserve->capacity)
+                {
+                    size_t capacity;
+
+                    if (reserve->pData != iter->pData)
+                    {
+                        /* Start tracking this field. Its array, if any, is
+                         * not known to have room for more entries. */
+                        trim_reserved_field(reserve);
+                        capacity = (size_t)*size + 1;
+                    }
+                    else
+                    {
+                        capacity = (size_t)*size * 2;
+                        if (capacity > PB_SIZE_MAX)
+                            capacity = PB_SIZE_MAX;
+                    }
+
+                    if (!allocate_field(stream, iter->pData, iter->pos->data_size, capacity))
+                        return false;
+
+                    reserve->pData = iter->pData;
+                    reserve->pSize = size;
+                    reserve->data_size = iter->pos->data_size;
+                    reserve->capacity = capacity;
+                }
             
                 pItem = *(char**)iter->pData + iter->pos->data_size * (*size);
                 (*size)++;
@@ -737,7 +805,7 @@ static bool checkreturn decode_callback_field(pb_istream_t *stream, pb_wire_type
     }
 }
 
-static bool checkreturn decode_field(pb_istream_t *stream, pb_wire_type_t wire_type, pb_field_iter_t *iter)
+static bool checkreturn decode_field(pb_istream_t *stream, pb_wire_type_t wire_type, pb_field_iter_t *iter, pb_array_reserve_t *reserve)
 {
 #ifdef PB_ENABLE_MALLOC
     /* When decoding an oneof field, check if there is old data that must be
@@ -755,7 +823,7 @@ static bool checkreturn decode_field(pb_istream_t *stream, pb_wire_type_t wire_t
             return decode_static_field(stream, wire_type, iter);
         
         case PB_ATYPE_POINTER:
-            return decode_pointer_field(stream, wire_type, iter);
+            return decode_pointer_field(stream, wire_type, iter, reserve);
         
         case PB_ATYPE_CALLBACK:
             return decode_callback_field(stream, wire_type, iter);
@@ -797,7 +865,7 @@ static bool checkreturn default_extension_decoder(pb_istream_t *stream,
     
     iter_from_extension(&iter, extension);
     extension->found = true;
-    return decode_field(stream, wire_type, &iter);
+    return decode_field(stream, wire_type, &iter, NULL);
 }
 
 /* Try to decode an unknown field as an extension field. Tries each extension
@@ -945,6 +1013,8 @@ bool checkreturn pb_decode_noinit(pb_istream_t *stream, const pb_field_t fields[
     const pb_field_t *fixed_count_field = NULL;
     pb_size_t fixed_count_size = 0;
 
+    pb_array_reserve_t reserve = {NULL, NULL, 0, 0};
+
     /* Return value ignored, as empty message types will be correctly handled by
      * pb_field_iter_find() anyway. */
     (void)pb_field_iter_begin(&iter, fields, dest_struct);
@@ -1025,10 +1095,14 @@ bool checkreturn pb_decode_noinit(pb_istream_t *stream, const pb_field_t fields[
             fields_seen[iter.required_field_index >> 5] |= tmp;
         }
 
-        if (!decode_field(stream, wire_type, &iter))
+        if (!decode_field(stream, wire_type, &iter, &reserve))
             return false;
     }
 
+#ifdef PB_ENABLE_MALLOC
+    trim_reserved_field(&reserve);
+#endif
+
     /* Check that all elements of the last decoded fixed count field were present. */
     if (fixed_count_field != NULL &&
         fixed_count_size != fixed_count_field->array_size)
@@ -714,13 +714,62 @@ bool checkreturn pb_encode_string(pb_ostream_t *stream, const pb_byte_t *buffer,
     return pb_write(stream, buffer, size);
 }
 
-bool checkreturn pb_encode_submessage(pb_ostream_t *stream, const pb_field_t fields[], const void *src_struct)
+#if defined(PB_ENABLE_MALLOC) && !defined(PB_BUFFER_ONLY)
+/* State of the streams used with a pb_size_cache_t. These streams are told
+ * apart from others by their callbacks, and their substreams share the same
+ * state. */
+typedef struct {
+    pb_size_cache_t *cache;
+    pb_ostream_t *target; /* Stream written to, NULL when only sizing. */
+} pb_size_cache_state_t;
+
+static bool checkreturn size_cache_sizing_callback(pb_ostream_t *stream, const pb_byte_t *buf, size_t count)
+{
+    PB_UNUSED(stream);
+    PB_UNUSED(buf);
+    PB_UNUSED(count);
+    return true;
+}
+
+static bool checkreturn size_cache_writing_callback(pb_ostream_t *stream, const pb_byte_t *buf, size_t count)
 {
-    /* First calculate the message size using a non-writing substream. */
+    pb_size_cache_state_t *state = (pb_size_cache_state_t*)stream->state;
+    return pb_write(state->target, buf, count);
+}
+
+/* Size a submessage and store its size in the cache. The submessage itself
+ * is only counted in the stream, not written. */
+static bool checkreturn size_submessage_into_cache(pb_ostream_t *stream, const pb_field_t fields[], const void *src_struct)
+{
+    pb_size_cache_state_t *state = (pb_size_cache_state_t*)stream->state;
+    pb_size_cache_t *cache = state->cache;
     pb_ostream_t substream = PB_OSTREAM_SIZING;
+    size_t index = cache->count;
     size_t size;
-    bool status;
-    
+
+    /* Take the slot before sizing the inner submessages, as this one is
+     * written first. */
+    if (cache->count == cache->capacity)
+    {
+        size_t capacity = cache->capacity ? cache->capacity * 2 : 16;
+        size_t *sizes;
+
+        if (capacity < cache->capacity || capacity > (size_t)-1 / sizeof(size_t))
+            PB_RETURN_ERROR(stream, "size cache too large");
+
+        sizes = (size_t*)pb_realloc(cache->sizes, capacity * sizeof(size_t));
+        if (sizes == NULL)
+            PB_RETURN_ERROR(stream, "realloc failed");
+
+        cache->sizes = sizes;
+        cache->capacity = capacity;
+    }
+    cache->count++;
+
+    substream.callback = stream->callback;
+    substream.state = stream->state;
+    substream.max_size = SIZE_MAX;
+
     if (!pb_encode(&substream, fields, src_struct))
     {
 #ifndef PB_NO_ERRMSG
@@ -728,8 +777,115 @@ bool checkreturn pb_encode_submessage(pb_ostream_t *stream, const pb_field_t fie
 #endif
         return false;
     }
-    
+
     size = substream.bytes_written;
+    cache->sizes[index] = size;
+
+    if (!pb_encode_varint(stream, (pb_uint64_t)size))
+        return false;
+
+    if (stream->bytes_written + size < stream->bytes_written ||
+        stream->bytes_written + size > stream->max_size)
+    {
+        PB_RETURN_ERROR(stream, "stream full");
+    }
+
+    stream->bytes_written += size;
+    return true;
+}
+
+bool pb_get_encoded_size_cached(size_t *size, pb_size_cache_t *cache, const pb_field_t fields[], const void *src_struct)
+{
+    pb_size_cache_state_t state;
+    pb_ostream_t stream = PB_OSTREAM_SIZING;
+
+    state.cache = cache;
+    state.target = NULL;
+    cache->count = 0;
+    cache->next = 0;
+
+    stream.callback = &size_cache_sizing_callback;
+    stream.state = &state;
+    stream.max_size = SIZE_MAX;
+
+    if (!pb_encode(&stream, fields, src_struct))
+        return false;
+
+    *size = stream.bytes_written;
+    return true;
+}
+
+bool pb_encode_with_size_cache(pb_ostream_t *stream, pb_size_cache_t *cache, const pb_field_t fields[], const void *src_struct)
+{
+    pb_size_cache_state_t state;
+    pb_ostream_t substream = PB_OSTREAM_SIZING;
+    bool status;
+
+    state.cache = cache;
+    state.target = stream;
+    cache->next = 0;
+
+    substream.callback = &size_cache_writing_callback;
+    substream.state = &state;
+    substream.max_size = SIZE_MAX;
+
+    status = pb_encode(&substream, fields, src_struct);
+
+#ifndef PB_NO_ERRMSG
+    /* An error of the target stream itself is the more specific one. */
+    if (!status && stream->errmsg == NULL)
+        stream->errmsg = substream.errmsg;
+#endif
+
+    if (status && cache->next != cache->count)
+        PB_RETURN_ERROR(stream, "size cache mismatch");
+
+    return status;
+}
+
+void pb_release_size_cache(pb_size_cache_t *cache)
+{
+    pb_free(cache->sizes);
+    cache->sizes = NULL;
+    cache->count = 0;
+    cache->capacity = 0;
+    cache->next = 0;
+}
+#endif
+
+bool checkreturn pb_encode_submessage(pb_ostream_t *stream, const pb_field_t fields[], const void *src_struct)
+{
+    pb_ostream_t substream = PB_OSTREAM_SIZING;
+    size_t size;
+    bool status;
+
+#if defined(PB_ENABLE_MALLOC) && !defined(PB_BUFFER_ONLY)
+    if (stream->callback == &size_cache_sizing_callback)
+    {
+        return size_submessage_into_cache(stream, fields, src_struct);
+    }
+    else if (stream->callback == &size_cache_writing_callback)
+    {
+        pb_size_cache_t *cache = ((pb_size_cache_state_t*)stream->state)->cache;
+        if (cache->next >= cache->count)
+            PB_RETURN_ERROR(stream, "size cache mismatch");
+
+        size = cache->sizes[cache->next++];
+    }
+    else
+#endif
+    {
+        /* First calculate the message size using a non-writing substream. */
+        if (!pb_encode(&substream, fields, src_struct))
+        {
+#ifndef PB_NO_ERRMSG
+            stream->errmsg = substream.errmsg;
+#endif
+            return false;
+        }
+
+        size = substream.bytes_written;
+    }
     
     if (!pb_encode_varint(stream, (pb_uint64_t)size))
         return false;
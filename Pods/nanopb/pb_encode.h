@@ -81,6 +81,45 @@ bool pb_encode_nullterminated(pb_ostream_t *stream, const pb_field_t fields[], c
  * the data. */
 bool pb_get_encoded_size(size_t *size, const pb_field_t fields[], const void *src_struct);
 
+#if defined(PB_ENABLE_MALLOC) && !defined(PB_BUFFER_ONLY)
+/* Sizes of the submessages of a message, in the order in which they are
+ * encoded. pb_encode() sizes every submessage before writing it, and does
+ * so again for each enclosing submessage, so the work grows with the depth
+ * of the message. With a size cache each submessage is sized only once.
+ *
+ * Example usage:
+ *    pb_size_cache_t cache = PB_SIZE_CACHE_INIT;
+ *    size_t size;
+ *    if (pb_get_encoded_size_cached(&size, &cache, MyMessage_fields, &msg))
+ *    {
+ *        pb_ostream_t stream = pb_ostream_from_buffer(buffer, size);
+ *        pb_encode_with_size_cache(&stream, &cache, MyMessage_fields, &msg);
+ *    }
+ *    pb_release_size_cache(&cache);
+ */
+typedef struct pb_size_cache_s
+{
+    size_t *sizes;
+    size_t count;
+    size_t capacity;
+    size_t next; /* Next size to be used by pb_encode_with_size_cache(). */
+} pb_size_cache_t;
+
+#define PB_SIZE_CACHE_INIT {NULL, 0, 0, 0}
+
+/* Same as pb_get_encoded_size, but also stores the size of every submessage
+ * in the cache. */
+bool pb_get_encoded_size_cached(size_t *size, pb_size_cache_t *cache, const pb_field_t fields[], const void *src_struct);
+
+/* Same as pb_encode, but takes the submessage sizes from a cache filled by
+ * pb_get_encoded_size_cached() for the same, unchanged message. The cache
+ * can be used any number of times. */
+bool pb_encode_with_size_cache(pb_ostream_t *stream, pb_size_cache_t *cache, const pb_field_t fields[], const void *src_struct);
+
+/* Release the memory allocated by pb_get_encoded_size_cached(). */
+void pb_release_size_cache(pb_size_cache_t *cache);
+#endif
+
 /**************************************
  * Functions for manipulating streams *
  **************************************/
@@ -159,7 +198,8 @@ bool pb_encode_fixed64(pb_ostream_t *stream, const void *value);
 /* Encode a submessage field.
  * You need to pass the pb_field_t array and pointer to struct, just like
  * with pb_encode(). This internally encodes the submessage twice, first to
- * calculate message size and then to actually write it out.
+ * calculate message size and then to actually write it out, unless the size
+ * comes from a pb_size_cache_t.
  */
 bool pb_encode_submessage(pb_ostream_t *stream, const pb_field_t fields[], const void *src_struct);
 